@@ -74,6 +74,7 @@ limitations under the License.
 // The implementation below is at the top level instead of the
 // brain namespace because we are defining 'extern "C"' functions.
 using tensorflow::AllocationDescription;
+using tensorflow::CallableOptions;
 using tensorflow::DataType;
 using tensorflow::ExtendSessionGraphHelper;
 using tensorflow::Graph;
@@ -406,6 +407,21 @@ static TF_Tensor* EmptyTensor(TF_DataType dtype,
       reinterpret_cast<void*>(&empty), 0, [](void*, size_t, void*) {}, nullptr);
 }
 
+static void TF_Run_Outputs(const std::vector<Tensor>& outputs,
+                           TF_Tensor** c_outputs, TF_Status* status) {
+  const int noutputs = outputs.size();
+  for (int i = 0; i < noutputs; ++i) {
+    const Tensor& src = outputs[i];
+    if (!src.IsInitialized() || src.NumElements() == 0) {
+      c_outputs[i] =
+          EmptyTensor(static_cast<TF_DataType>(src.dtype()), src.shape());
+      continue;
+    }
+    c_outputs[i] = TF_TensorFromTensor(src, status);
+    if (TF_GetCode(status) != TF_OK) return;
+  }
+}
+
 static void TF_Run_Helper(
     Session* session, const char* handle, const TF_Buffer* run_options,
     // Input tensors
@@ -451,16 +467,7 @@ static void TF_Run_Helper(
   }
 
   // Store results in c_outputs[]
-  for (int i = 0; i < noutputs; ++i) {
-    const Tensor& src = outputs[i];
-    if (!src.IsInitialized() || src.NumElements() == 0) {
-      c_outputs[i] =
-          EmptyTensor(static_cast<TF_DataType>(src.dtype()), src.shape());
-      continue;
-    }
-    c_outputs[i] = TF_TensorFromTensor(src, status);
-    if (TF_GetCode(status) != TF_OK) return;
-  }
+  TF_Run_Outputs(outputs, c_outputs, status);
 }
 
 extern "C" {
@@ -2376,6 +2383,76 @@ void TF_SessionPRun(TF_Session* session, const char* handle,
                 output_values, target_names, nullptr, status);
 }
 
+TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session, const TF_Output* inputs, int ninputs,
+    const TF_Output* outputs, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    const TF_Buffer* run_options, TF_Status* status) {
+  if (session->extend_before_run &&
+      !ExtendSessionGraphHelper(session, status)) {
+    return nullptr;
+  }
+
+  CallableOptions callable_options;
+  if (run_options != nullptr &&
+      !callable_options.mutable_run_options()->ParseFromArray(
+          run_options->data, run_options->length)) {
+    status->status = InvalidArgument("Unparseable RunOptions proto");
+    return nullptr;
+  }
+  for (int i = 0; i < ninputs; ++i) {
+    callable_options.add_feed(OutputName(inputs[i]));
+  }
+  for (int i = 0; i < noutputs; ++i) {
+    callable_options.add_fetch(OutputName(outputs[i]));
+  }
+  for (int i = 0; i < ntargets; ++i) {
+    callable_options.add_target(target_opers[i]->node.name());
+  }
+
+  Session::CallableHandle handle;
+  status->status = session->session->MakeCallable(callable_options, &handle);
+  if (TF_GetCode(status) != TF_OK) return nullptr;
+  return new TF_SessionCallable{handle, ninputs, noutputs};
+}
+
+void TF_SessionRunCallable(TF_Session* session, TF_SessionCallable* callable,
+                           TF_Tensor* const* input_values,
+                           TF_Tensor** output_values, TF_Buffer* run_metadata,
+                           TF_Status* status) {
+  TF_Run_Setup(callable->noutputs, output_values, status);
+  if (run_metadata != nullptr && run_metadata->data != nullptr) {
+    status->status =
+        InvalidArgument("Passing non-empty run_metadata is invalid.");
+    return;
+  }
+
+  std::vector<Tensor> feed_tensors(callable->ninputs);
+  for (int i = 0; i < callable->ninputs; ++i) {
+    status->status = TF_TensorToTensor(input_values[i], &feed_tensors[i]);
+    if (TF_GetCode(status) != TF_OK) return;
+  }
+
+  std::vector<Tensor> fetch_tensors;
+  RunMetadata run_metadata_proto;
+  status->status = session->session->RunCallable(
+      callable->handle, feed_tensors, &fetch_tensors, &run_metadata_proto);
+  if (TF_GetCode(status) != TF_OK) return;
+
+  if (run_metadata != nullptr) {
+    status->status = MessageToBuffer(run_metadata_proto, run_metadata);
+    if (TF_GetCode(status) != TF_OK) return;
+  }
+  TF_Run_Outputs(fetch_tensors, output_values, status);
+}
+
+void TF_SessionReleaseCallable(TF_Session* session,
+                               TF_SessionCallable* callable,
+                               TF_Status* status) {
+  status->status = session->session->ReleaseCallable(callable->handle);
+  delete callable;
+}
+
 unsigned char TF_TryEvaluateConstant(TF_Graph* graph, TF_Output output,
                                      TF_Tensor** result, TF_Status* status) {
   *result = nullptr;
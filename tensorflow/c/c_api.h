@@ -1305,6 +1305,57 @@ TF_CAPI_EXPORT extern void TF_SessionPRun(
 // Once called, no more calls to TF_SessionPRun should be made.
 TF_CAPI_EXPORT extern void TF_DeletePRunHandle(const char* handle);
 
+// A subgraph of a session's graph with fixed feeds, fetches and targets, that
+// can be run repeatedly without looking up tensor names or pruning the graph
+// on every call. Useful for language bindings that run the same step in a
+// loop.
+typedef struct TF_SessionCallable TF_SessionCallable;
+
+// Prepares the subgraph that feeds `inputs`, fetches `outputs` and runs
+// `target_opers`, with the given RunOptions (which may be NULL), for
+// subsequent calls to TF_SessionRunCallable.
+//
+// On success, returns a callable that must be released with
+// TF_SessionReleaseCallable. On failure, returns nullptr and sets `status`.
+TF_CAPI_EXPORT extern TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session*,
+    // Input names
+    const TF_Output* inputs, int ninputs,
+    // Output names
+    const TF_Output* outputs, int noutputs,
+    // Target operations
+    const TF_Operation* const* target_opers, int ntargets,
+    // RunOptions
+    const TF_Buffer* run_options,
+    // Output status
+    TF_Status*);
+
+// Runs `callable` with one input tensor for each of the inputs it was made
+// with, in the same order, and stores one tensor for each of its outputs in
+// `output_values`. The caller takes ownership of the output tensors.
+//
+// Input tensors whose buffers are suitably aligned are passed to the runtime
+// without copies, and the output tensors share the buffers computed by the
+// runtime, so no tensor data other than strings is copied by this call.
+//
+// `run_metadata` may be NULL; otherwise it must be an empty buffer that
+// receives the serialized RunMetadata.
+TF_CAPI_EXPORT extern void TF_SessionRunCallable(
+    TF_Session*, TF_SessionCallable* callable,
+    // Input tensors
+    TF_Tensor* const* input_values,
+    // Output tensors
+    TF_Tensor** output_values,
+    // RunMetadata
+    TF_Buffer* run_metadata,
+    // Output status
+    TF_Status*);
+
+// Releases the resources held by `callable`, which must not be used
+// afterwards. `callable` is deleted even if `status` is set.
+TF_CAPI_EXPORT extern void TF_SessionReleaseCallable(
+    TF_Session*, TF_SessionCallable* callable, TF_Status*);
+
 // --------------------------------------------------------------------------
 // The deprecated session API.  Please switch to the above instead of
 // TF_ExtendGraph(). This deprecated API can be removed at any time without
@@ -1127,6 +1127,53 @@ TEST(CAPI, SessionPRun) {
   TF_DeleteStatus(s);
 }
 
+TEST(CAPI, SessionCallable) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+
+  // Construct the graph: A + 2
+  TF_Operation* a = Placeholder(graph, s, "A");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Operation* plus2 = Add(a, two, graph, s, "plus2");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* sess = TF_NewSession(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+
+  TF_Output feeds[] = {TF_Output{a, 0}};
+  TF_Output fetches[] = {TF_Output{plus2, 0}};
+  TF_SessionCallable* callable =
+      TF_SessionMakeCallable(sess, feeds, 1, fetches, 1, nullptr, 0,
+                             /*run_options=*/nullptr, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  ASSERT_TRUE(callable != nullptr);
+
+  // Run the same callable several times.
+  for (int32 i = 0; i < 3; ++i) {
+    TF_Tensor* feed_values[] = {Int32Tensor(i)};
+    TF_Tensor* fetch_values[1];
+    TF_SessionRunCallable(sess, callable, feed_values, fetch_values,
+                          /*run_metadata=*/nullptr, s);
+    ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+    EXPECT_EQ(i + 2, *(static_cast<int32*>(TF_TensorData(fetch_values[0]))));
+    TF_DeleteTensor(feed_values[0]);
+    TF_DeleteTensor(fetch_values[0]);
+  }
+
+  // Clean up.
+  TF_SessionReleaseCallable(sess, callable, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(sess, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 TEST(CAPI, ShapeInferenceError) {
   // TF_FinishOperation should fail if the shape of the added operation cannot
   // be inferred.
@@ -1034,6 +1034,117 @@ void Execute_MatMul_CPU(bool async) {
 TEST(CAPI, Execute_MatMul_CPU) { Execute_MatMul_CPU(false); }
 TEST(CAPI, Execute_MatMul_CPUAsync) { Execute_MatMul_CPU(true); }
 
+// Executes the same op several times, which reuses its kernel, also after the
+// kernel cache is cleared.
+void Execute_MatMul_CPU_Reused(bool async) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_ContextOptionsSetAsync(opts, static_cast<unsigned char>(async));
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle();
+  TFE_Op* matmul = MatMulOp(ctx, m, m);
+  for (int i = 0; i < 3; ++i) {
+    if (i == 2) TFE_ContextClearCaches(ctx);
+    TFE_TensorHandle* retvals[1] = {nullptr};
+    int num_retvals = 1;
+    TFE_Execute(matmul, &retvals[0], &num_retvals, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TF_Tensor* t = TFE_TensorHandleResolve(retvals[0], status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteTensorHandle(retvals[0]);
+    float product[4] = {0};
+    EXPECT_EQ(sizeof(product), TF_TensorByteSize(t));
+    memcpy(&product[0], TF_TensorData(t), TF_TensorByteSize(t));
+    TF_DeleteTensor(t);
+    EXPECT_EQ(7, product[0]);
+    EXPECT_EQ(22, product[3]);
+  }
+  TFE_DeleteOp(matmul);
+  TFE_DeleteTensorHandle(m);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+TEST(CAPI, Execute_MatMul_CPU_Reused) { Execute_MatMul_CPU_Reused(false); }
+TEST(CAPI, Execute_MatMul_CPU_ReusedAsync) {
+  Execute_MatMul_CPU_Reused(true);
+}
+
+// Executes MatMul, BiasAdd and Relu ops, which the async executor can fuse
+// when they are pending together.
+TEST(CAPI, Execute_MatMulBiasAddRelu_CPUAsyncFused) {
+  setenv("TF_EAGER_FUSION_WINDOW", "3", /*overwrite=*/1);
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_ContextOptionsSetAsync(opts, static_cast<unsigned char>(true));
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+  unsetenv("TF_EAGER_FUSION_WINDOW");
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle();
+  int64_t dims[] = {2};
+  float data[] = {-10.0f, 1.0f};
+  TF_Tensor* bias_tensor = TF_AllocateTensor(TF_FLOAT, &dims[0], 1,
+                                             sizeof(data));
+  memcpy(TF_TensorData(bias_tensor), &data[0], sizeof(data));
+  TFE_TensorHandle* bias = TFE_NewTensorHandle(bias_tensor, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_DeleteTensor(bias_tensor);
+
+  std::vector<TFE_TensorHandle*> results;
+  for (int i = 0; i < 10; ++i) {
+    TFE_Op* matmul = MatMulOp(ctx, m, m);
+    TFE_TensorHandle* product = nullptr;
+    int num_retvals = 1;
+    TFE_Execute(matmul, &product, &num_retvals, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteOp(matmul);
+
+    TFE_Op* bias_add = TFE_NewOp(ctx, "BiasAdd", status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpAddInput(bias_add, product, status);
+    TFE_OpAddInput(bias_add, bias, status);
+    TFE_OpSetAttrType(bias_add, "T", TF_FLOAT);
+    TFE_TensorHandle* sum = nullptr;
+    TFE_Execute(bias_add, &sum, &num_retvals, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteOp(bias_add);
+    TFE_DeleteTensorHandle(product);
+
+    TFE_Op* relu = TFE_NewOp(ctx, "Relu", status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpAddInput(relu, sum, status);
+    TFE_OpSetAttrType(relu, "T", TF_FLOAT);
+    TFE_TensorHandle* result = nullptr;
+    TFE_Execute(relu, &result, &num_retvals, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteOp(relu);
+    TFE_DeleteTensorHandle(sum);
+    results.push_back(result);
+  }
+
+  for (TFE_TensorHandle* result : results) {
+    TF_Tensor* t = TFE_TensorHandleResolve(result, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteTensorHandle(result);
+    float values[4] = {0};
+    EXPECT_EQ(sizeof(values), TF_TensorByteSize(t));
+    memcpy(&values[0], TF_TensorData(t), TF_TensorByteSize(t));
+    TF_DeleteTensor(t);
+    EXPECT_EQ(0, values[0]);
+    EXPECT_EQ(11, values[1]);
+    EXPECT_EQ(5, values[2]);
+    EXPECT_EQ(23, values[3]);
+  }
+  TFE_DeleteTensorHandle(bias);
+  TFE_DeleteTensorHandle(m);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 void Execute_MatMul_CPU_Runtime_Error(bool async) {
   TF_Status* status = TF_NewStatus();
   TFE_ContextOptions* opts = TFE_NewContextOptions();
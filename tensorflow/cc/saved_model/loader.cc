@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
+#include <map>
 #include <unordered_set>
 
 #include "tensorflow/cc/saved_model/constants.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/graph/default_device.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -37,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
@@ -266,6 +270,28 @@ Status GetInitOp(const string& export_dir, const MetaGraphDef& meta_graph_def,
   return Status::OK();
 }
 
+// Marks the RestoreV2 nodes of "meta_graph_def", including those of its
+// functions, to restore the variables as read-only aliases of the
+// memory-mapped checkpoint instead of copies.  The variables are then shared
+// with the page cache, and copied only if they are updated.
+void MarkRestoreReadOnly(MetaGraphDef* meta_graph_def) {
+  auto mark = [](NodeDef* node) {
+    if (node->op() == "RestoreV2") {
+      (*node->mutable_attr())["_read_only_memmap"].set_b(true);
+    }
+  };
+  GraphDef* graph_def = meta_graph_def->mutable_graph_def();
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    mark(&node);
+  }
+  for (FunctionDef& function :
+       *graph_def->mutable_library()->mutable_function()) {
+    for (NodeDef& node : *function.mutable_node_def()) {
+      mark(&node);
+    }
+  }
+}
+
 Status RunRestore(const RunOptions& run_options, const string& export_dir,
                   const StringPiece restore_op_name,
                   const StringPiece variable_filename_const_op_name,
@@ -356,6 +382,15 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
     lsession_options.config.mutable_gpu_options()->clear_allocator_type();
   }
 
+  // Models only used for inference can map their variables instead of
+  // reading them.
+  bool memmap_variables;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_SAVED_MODEL_MEMMAP_VARIABLES",
+                                        false, &memmap_variables));
+  if (memmap_variables) {
+    MarkRestoreReadOnly(&bundle->meta_graph_def);
+  }
+
   TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
       bundle->meta_graph_def, lsession_options, &bundle->session));
 
@@ -388,8 +423,109 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   return Status::OK();
 }
 
+// Sets 'output' to 'input' with a 0th dimension of 'batch_size', filled by
+// repeating the rows of 'input'. Scalars are left as is.
+Status ResizeBatch(const Tensor& input, int64 batch_size, Tensor* output) {
+  if (input.dims() == 0 || input.dim_size(0) == batch_size) {
+    *output = input;
+    return Status::OK();
+  }
+  const int64 input_batch_size = input.dim_size(0);
+  if (input_batch_size == 0) {
+    return errors::InvalidArgument(
+        "Can't resize an empty warm-up input to batch size ", batch_size);
+  }
+  const std::vector<Tensor> copies(
+      (batch_size + input_batch_size - 1) / input_batch_size, input);
+  Tensor repeated;
+  TF_RETURN_IF_ERROR(tensor::Concat(copies, &repeated));
+  if (repeated.dim_size(0) == batch_size) {
+    *output = repeated;
+    return Status::OK();
+  }
+  std::vector<Tensor> splits;
+  TF_RETURN_IF_ERROR(tensor::Split(
+      repeated, {batch_size, repeated.dim_size(0) - batch_size}, &splits));
+  *output = splits[0];
+  return Status::OK();
+}
+
+// Runs 'request' once on 'session', with the inputs resized to 'batch_size'
+// unless it is 0. The outputs are fetched in the order of their aliases, like
+// the requests served later will, so that they reuse the same executors.
+Status RunWarmupRequest(const RunOptions& run_options,
+                        const MetaGraphDef& meta_graph_def,
+                        const SavedModelWarmupRequest& request,
+                        int64 batch_size, Session* session) {
+  const auto signature_it =
+      meta_graph_def.signature_def().find(request.signature_key);
+  if (signature_it == meta_graph_def.signature_def().end()) {
+    return errors::InvalidArgument("Warm-up request for unknown signature ",
+                                   request.signature_key);
+  }
+  const SignatureDef& signature_def = signature_it->second;
+
+  std::vector<std::pair<string, Tensor>> inputs;
+  for (const auto& alias_and_tensor : request.inputs) {
+    const auto input_it = signature_def.inputs().find(alias_and_tensor.first);
+    if (input_it == signature_def.inputs().end()) {
+      return errors::InvalidArgument("Warm-up request for signature ",
+                                     request.signature_key,
+                                     " has unknown input ",
+                                     alias_and_tensor.first);
+    }
+    Tensor input = alias_and_tensor.second;
+    if (batch_size > 0) {
+      TF_RETURN_IF_ERROR(
+          ResizeBatch(alias_and_tensor.second, batch_size, &input));
+    }
+    inputs.emplace_back(input_it->second.name(), input);
+  }
+  std::map<string, string> sorted_outputs;
+  for (const auto& output : signature_def.outputs()) {
+    sorted_outputs[output.first] = output.second.name();
+  }
+  std::vector<string> output_names;
+  output_names.reserve(sorted_outputs.size());
+  for (const auto& alias_and_name : sorted_outputs) {
+    output_names.push_back(alias_and_name.second);
+  }
+
+  std::vector<Tensor> outputs;
+  RunMetadata run_metadata;
+  return session->Run(run_options, inputs, output_names, {}, &outputs,
+                      &run_metadata);
+}
+
 }  // namespace
 
+Status WarmupSavedModel(const RunOptions& run_options,
+                        const std::vector<SavedModelWarmupRequest>& requests,
+                        const std::vector<int64>& batch_sizes,
+                        SavedModelBundle* bundle) {
+  const uint64 start_microseconds = Env::Default()->NowMicros();
+  // Running the largest batch size last leaves the allocators grown to the
+  // peak memory of the model.
+  std::vector<int64> sorted_batch_sizes(batch_sizes.begin(), batch_sizes.end());
+  std::sort(sorted_batch_sizes.begin(), sorted_batch_sizes.end());
+  if (sorted_batch_sizes.empty()) sorted_batch_sizes.push_back(0);
+  for (const int64 batch_size : sorted_batch_sizes) {
+    if (batch_size < 0) {
+      return errors::InvalidArgument("Invalid warm-up batch size ",
+                                     batch_size);
+    }
+    for (const SavedModelWarmupRequest& request : requests) {
+      TF_RETURN_IF_ERROR(RunWarmupRequest(run_options, bundle->meta_graph_def,
+                                          request, batch_size,
+                                          bundle->session.get()));
+    }
+  }
+  LOG(INFO) << "SavedModel warm-up with " << requests.size()
+            << " requests and " << batch_sizes.size() << " batch sizes took "
+            << GetLatencyMicroseconds(start_microseconds) << " microseconds.";
+  return Status::OK();
+}
+
 Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
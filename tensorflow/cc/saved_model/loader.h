@@ -20,6 +20,8 @@ limitations under the License.
 
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -52,6 +54,25 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundle* const bundle);
 
+/// A sample request to replay when warming up a SavedModel: the inputs of the
+/// signature `signature_key`, keyed by their aliases in the signature.
+struct SavedModelWarmupRequest {
+  string signature_key;
+  std::vector<std::pair<string, Tensor>> inputs;
+};
+
+/// Runs the sample `requests` on the session of a loaded SavedModel, once for
+/// each batch size in `batch_sizes` (the batch dimension of the inputs is
+/// filled by repeating their rows), or once as is if `batch_sizes` is empty.
+/// This pays the costs of the first requests before the model serves: the
+/// creation of the executors for the feeds and fetches of each signature, the
+/// kernel autotuning for the shapes of each batch size, and the growth of the
+/// allocators to the peak memory of the largest batch.
+Status WarmupSavedModel(const RunOptions& run_options,
+                        const std::vector<SavedModelWarmupRequest>& requests,
+                        const std::vector<int64>& batch_sizes,
+                        SavedModelBundle* bundle);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
@@ -126,6 +126,29 @@ TEST_F(LoaderTest, TagMatch) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, Warmup) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+
+  SavedModelWarmupRequest request;
+  request.signature_key = "regress_x_to_y";
+  request.inputs.emplace_back(
+      kRegressInputs, test::AsTensor<tstring>({MakeSerializedExample(1),
+                                               MakeSerializedExample(2)},
+                                              TensorShape({2})));
+  TF_ASSERT_OK(WarmupSavedModel(run_options, {request}, {1, 3, 8}, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+
+  request.signature_key = "missing-signature";
+  EXPECT_FALSE(WarmupSavedModel(run_options, {request}, {}, &bundle).ok());
+}
+
 TEST_F(LoaderTest, NoTagMatch) {
   SavedModelBundle bundle;
   RunOptions run_options;
@@ -120,6 +120,7 @@ Status CompileGraph(const GraphDef& graph_def, const tf2xla::Config& config,
       flags.target_triple, flags.target_cpu, flags.target_features,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
+  aot_opts.set_share_constants(flags.share_constants);
 
   return CompileXla(client, computation, aot_opts, compile_result);
 }
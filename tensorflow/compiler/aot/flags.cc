@@ -59,6 +59,10 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "namespaces may precede the class name, separated by double-colons.  "
        "The class will be generated in the given namespace(s), or if no "
        "namespaces are given, within the global namespace."},
+      {"share_constants", &flags->share_constants,
+       "Emit constants so that the linker keeps a single copy of identical "
+       "ones across tfcompile'd objects linked into the same binary, e.g. the "
+       "weights of several batch sizes or signatures of one model."},
       {"out_function_object", &flags->out_function_object,
        "Output object file containing the generated function for the "
        "TensorFlow model."},
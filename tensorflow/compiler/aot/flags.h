@@ -38,6 +38,7 @@ struct MainFlags {
   string out_metadata_object;
   string out_header;
   string out_session_module;
+  bool share_constants = false;
 
   // C++ codegen options
   bool gen_name_to_index = false;
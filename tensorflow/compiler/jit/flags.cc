@@ -124,7 +124,14 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags
                 ->tf_xla_disable_resource_variable_safety_checks_for_debugging,
            "Disable resource variables related safety checks when clustering "
-           "(this is unsound).")};
+           "(this is unsound)."),
+      Flag("tf_xla_shape_buckets",
+           &mark_for_compilation_flags->tf_xla_shape_buckets,
+           "(experimental) Pad the inputs of clusters made only of elementwise "
+           "operations so that each dimension is rounded up to a bucket, and "
+           "slice the outputs back. This bounds the number of shapes such a "
+           "cluster is compiled for. \"pow2\" rounds up to powers of two; "
+           "otherwise list the bucket sizes, separated with commas.")};
   flag_list->insert(flag_list->end(), new_flags.begin(), new_flags.end());
 }
 
@@ -152,6 +159,7 @@ void AllocateAndParseFlags() {
       ->tf_xla_disable_deadness_safety_checks_for_debugging = false;
   mark_for_compilation_flags
       ->tf_xla_disable_resource_variable_safety_checks_for_debugging = false;
+  mark_for_compilation_flags->tf_xla_shape_buckets = "";
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -159,6 +167,8 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_donate_resource_variables = false;
+  ops_flags->tf_xla_share_executables = false;
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -198,6 +208,15 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts"
             "the cluster compilation in the background, and the fallback path"
             "is executed until the compilation has finished"),
+       Flag("tf_xla_donate_resource_variables",
+            &ops_flags->tf_xla_donate_resource_variables,
+            "Update resource variables in place in the buffers of their "
+            "input values, instead of allocating new buffers for the updated "
+            "values. Only applies to clusters on CPU and GPU."),
+       Flag("tf_xla_share_executables", &ops_flags->tf_xla_share_executables,
+            "Share the executables compiled for identical clusters between "
+            "the sessions of the process, instead of compiling them for each "
+            "session."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
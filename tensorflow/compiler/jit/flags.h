@@ -78,6 +78,11 @@ struct MarkForCompilationPassFlags {
   // variable concurrency semantics.  This is unsound in general, but can be
   // used as a debugging aid.
   bool tf_xla_disable_resource_variable_safety_checks_for_debugging;
+
+  // If non-empty, pad the inputs of elementwise clusters so that each of their
+  // dimensions is rounded up to a bucket. "pow2" rounds up to powers of two;
+  // otherwise this is a comma separated list of bucket sizes.
+  string tf_xla_shape_buckets;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
@@ -97,6 +102,14 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fall back path is taken while compilation happens
   bool tf_xla_async_compilation;
+  // If true, resource variables updated by a cluster on CPU or GPU donate
+  // their buffers to the computation, which writes the updated values in
+  // place instead of into newly allocated buffers. Defaults to false.
+  bool tf_xla_donate_resource_variables;
+  // If true, the executables compiled for identical clusters are shared by
+  // all the sessions of the process instead of being compiled by each of
+  // them. Defaults to false.
+  bool tf_xla_share_executables;
 };
 
 // Flags for the build_xla_ops pass.
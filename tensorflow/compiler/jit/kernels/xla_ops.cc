@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_ops.h"
 
+#include <algorithm>
+
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/jit/defs.h"
@@ -124,6 +127,9 @@ class XlaExecutableClosure {
   const std::map<int, OptionalTensor>& resource_var_snapshots() const {
     return resource_var_snapshots_;
   }
+  std::map<int, OptionalTensor>* mutable_resource_var_snapshots() {
+    return &resource_var_snapshots_;
+  }
   int num_constant_args() const { return num_constant_args_; }
 
  private:
@@ -325,6 +331,11 @@ static Status CompileToLocalExecutable(
   // Optimization: where possible, have the computation return a naked array
   // rather than a one-element tuple.
   compile_options.always_return_tuple = false;
+  // Update resource variables in place in their input buffers. Variables on
+  // XLA devices are backed by XlaTensors, which are not donated.
+  compile_options.alias_resource_update =
+      GetXlaOpsCommonFlags().tf_xla_donate_resource_variables &&
+      !platform_info.is_on_xla_device();
 
   std::vector<XlaCompiler::Argument> args;
   TF_RETURN_IF_ERROR(XlaComputationLaunchContext::BuildXlaCompilerArguments(
@@ -372,6 +383,9 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
       client, allocator,
       /*allocate_xla_tensors=*/platform_info_.is_on_xla_device(),
       platform_info_.UseMultipleStreams());
+  OP_REQUIRES_OK(ctx, launch_context.PrepareDonatedVariables(
+                          ctx, kernel, &variables,
+                          /*missing_ctx_input_prefix=*/0));
   launch_context.PopulateInputs(ctx, kernel, variables,
                                 /*missing_ctx_input_prefix=*/0);
 
@@ -577,6 +591,12 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       /*allocate_xla_tensors=*/platform_info_.is_on_xla_device(),
       /*use_multiple_streams=*/platform_info_.UseMultipleStreams());
 
+  OP_REQUIRES_OK(ctx, launch_context.PrepareDonatedVariables(
+                          ctx, closure.compilation_result(),
+                          closure.mutable_resource_var_snapshots(),
+                          /*missing_ctx_input_prefix=*/
+                          closure.num_constant_args()));
+
   // We're missing the must-be-constant inputs, tell `PopulateInputs`
   // about this.  We don't actually need these inputs because they've
   // already been baked into the compiled kernel.
@@ -652,6 +672,40 @@ void XlaMergeOp::Compute(OpKernelContext* ctx) {
   }
 }
 
+XlaBucketShapeOp::XlaBucketShapeOp(OpKernelConstruction* ctx)
+    : OpKernel(ctx) {
+  std::vector<int32> buckets;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr("buckets", &buckets));
+  buckets_.assign(buckets.begin(), buckets.end());
+  std::sort(buckets_.begin(), buckets_.end());
+}
+
+void XlaBucketShapeOp::Compute(OpKernelContext* ctx) {
+  const Tensor& shape = ctx->input(0);
+  OP_REQUIRES(ctx, TensorShapeUtils::IsVector(shape.shape()),
+              errors::InvalidArgument("shape must be a vector, got ",
+                                      shape.shape().DebugString()));
+  Tensor* bucketed_shape;
+  OP_REQUIRES_OK(ctx,
+                 ctx->allocate_output(0, shape.shape(), &bucketed_shape));
+  auto dims = shape.vec<int64>();
+  auto bucketed_dims = bucketed_shape->vec<int64>();
+  for (int64 i = 0; i < dims.size(); ++i) {
+    const int64 dim = dims(i);
+    int64 bucket = dim;
+    if (dim > 1) {
+      if (buckets_.empty()) {
+        bucket = 1;
+        while (bucket < dim) bucket <<= 1;
+      } else {
+        auto it = std::lower_bound(buckets_.begin(), buckets_.end(), dim);
+        if (it != buckets_.end()) bucket = *it;
+      }
+    }
+    bucketed_dims(i) = bucket;
+  }
+}
+
 REGISTER_KERNEL_BUILDER(Name("XlaLaunch").Device(DEVICE_CPU), XlaLocalLaunchOp);
 
 REGISTER_KERNEL_BUILDER(Name("XlaLaunch")
@@ -676,4 +730,7 @@ REGISTER_KERNEL_BUILDER(Name("_XlaRun").Device(DEVICE_GPU).HostMemory("key"),
 REGISTER_KERNEL_BUILDER(Name("_XlaMerge").Device(DEVICE_CPU), XlaMergeOp);
 REGISTER_KERNEL_BUILDER(Name("_XlaMerge").Device(DEVICE_GPU), XlaMergeOp);
 
+REGISTER_KERNEL_BUILDER(Name("_XlaBucketShape").Device(DEVICE_CPU),
+                        XlaBucketShapeOp);
+
 }  // namespace tensorflow
@@ -181,6 +181,17 @@ class XlaMergeOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override;
 };
 
+class XlaBucketShapeOp : public OpKernel {
+ public:
+  explicit XlaBucketShapeOp(OpKernelConstruction* ctx);
+
+  void Compute(OpKernelContext* ctx) override;
+
+ private:
+  // The sorted buckets. Empty if dimensions are rounded up to powers of two.
+  std::vector<int64> buckets_;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_COMPILER_JIT_KERNELS_XLA_LAUNCH_OP_H_
@@ -114,4 +114,20 @@ particluar when an XLA cluster has int32 outputs. The _XlaMerge up does not
 have a value_index output that identifies the chosen input.
 )");
 
+REGISTER_OP("_XlaBucketShape")
+    .Input("shape: int64")
+    .Output("bucketed_shape: int64")
+    .Attr("buckets: list(int) >= 0 = []")
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->input(0));
+      return Status::OK();
+    })
+    .Doc(R"(XLA Bucket Shape Op. For use by the XLA JIT only.
+
+Rounds every dimension of `shape` larger than one up to the smallest of
+`buckets` that holds it, or to the next power of two if `buckets` is empty.
+Dimensions larger than every bucket are kept as they are. Used to pad the
+inputs of an XLA cluster so that it is compiled for a few shapes only.
+)");
+
 }  // namespace tensorflow
@@ -0,0 +1,263 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing_pass.h"
+
+#include <map>
+#include <set>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/cc/framework/scope_internal.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/xla_cluster_util.h"
+#include "tensorflow/compiler/tf2xla/cc/ops/xla_jit_ops.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/dump_graph.h"
+
+namespace tensorflow {
+namespace {
+
+// Operations whose outputs depend only on the elements of their inputs at the
+// same (broadcast) index, and which do not fail on any input value.
+bool IsElementwise(const Node& n) {
+  static const auto* const kElementwiseOps = new absl::flat_hash_set<string>{
+      // Unary
+      "Abs", "Cast", "Ceil", "Cos", "Elu", "Exp", "Expm1", "Floor", "Identity",
+      "Log", "Log1p", "Neg", "Relu", "Relu6", "Rsqrt", "Selu", "Sigmoid",
+      "Sign", "Sin", "Softplus", "Softsign", "Sqrt", "Square", "Tanh",
+      // Binary
+      "Add", "AddV2", "Maximum", "Minimum", "Mul", "SquaredDifference", "Sub"};
+  return kElementwiseOps->contains(n.type_string());
+}
+
+// Returns true if `n` is a constant that broadcasts against any shape, i.e. all
+// of its dimensions are one.
+bool IsBroadcastableConstant(const Node& n) {
+  if (!n.IsConstant()) {
+    return false;
+  }
+  const TensorProto* proto = nullptr;
+  if (!GetNodeAttr(n.def(), "value", &proto).ok()) {
+    return false;
+  }
+  for (const auto& dim : proto->tensor_shape().dim()) {
+    if (dim.size() != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status ParseBuckets(absl::string_view flag, std::vector<int>* buckets) {
+  if (flag == "pow2") {
+    return Status::OK();
+  }
+  for (absl::string_view bucket_str : absl::StrSplit(flag, ',')) {
+    int bucket;
+    if (!absl::SimpleAtoi(bucket_str, &bucket) || bucket <= 0) {
+      return errors::InvalidArgument("Invalid --tf_xla_shape_buckets: ", flag);
+    }
+    buckets->push_back(bucket);
+  }
+  return Status::OK();
+}
+
+// An output of a node, identified by the node and the output index.
+using OutputPort = std::pair<Node*, int>;
+
+// Returns the indices in `input_index` of the cluster inputs `n` depends on.
+const std::set<int>& GetInputDeps(
+    const Node* n, const absl::flat_hash_set<const Node*>& in_cluster,
+    const std::map<OutputPort, int>& input_index,
+    absl::flat_hash_map<const Node*, std::set<int>>* deps) {
+  auto it = deps->find(n);
+  if (it != deps->end()) {
+    return it->second;
+  }
+  std::set<int> result;
+  for (const Edge* e : n->in_edges()) {
+    if (e->IsControlEdge()) continue;
+    if (in_cluster.contains(e->src())) {
+      const std::set<int>& src_deps =
+          GetInputDeps(e->src(), in_cluster, input_index, deps);
+      result.insert(src_deps.begin(), src_deps.end());
+    } else {
+      result.insert(input_index.at({e->src(), e->src_output()}));
+    }
+  }
+  return (*deps)[n] = std::move(result);
+}
+
+// Pads the inputs and slices the outputs of the elementwise cluster made of
+// `cluster_nodes`. Sets `*changed` if the graph was rewritten.
+Status BucketCluster(Graph* g, absl::string_view cluster_name,
+                     const std::vector<Node*>& cluster_nodes,
+                     const std::vector<int>& buckets, bool* changed) {
+  *changed = false;
+  absl::flat_hash_set<const Node*> in_cluster(cluster_nodes.begin(),
+                                              cluster_nodes.end());
+  for (const Node* n : cluster_nodes) {
+    if (!IsElementwise(*n) && !IsBroadcastableConstant(*n)) {
+      VLOG(3) << "Not bucketing cluster " << cluster_name << " because of "
+              << n->name() << " (" << n->type_string() << ")";
+      return Status::OK();
+    }
+  }
+
+  // Tensors flowing into and out of the cluster, with the edges that carry
+  // them.
+  std::map<OutputPort, std::vector<const Edge*>> inputs;
+  std::map<OutputPort, std::vector<const Edge*>> outputs;
+  for (Node* n : cluster_nodes) {
+    for (const Edge* e : n->in_edges()) {
+      if (!e->IsControlEdge() && !in_cluster.contains(e->src())) {
+        inputs[{e->src(), e->src_output()}].push_back(e);
+      }
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (!e->IsControlEdge() && !in_cluster.contains(e->dst())) {
+        outputs[{n, e->src_output()}].push_back(e);
+      }
+    }
+  }
+  if (inputs.empty() || outputs.empty()) {
+    return Status::OK();
+  }
+
+  // Find the inputs each output depends on before the inputs are rewired.
+  std::map<OutputPort, int> input_index;
+  for (const auto& input : inputs) {
+    input_index.emplace(input.first, input_index.size());
+  }
+  absl::flat_hash_map<const Node*, std::set<int>> deps;
+  std::vector<std::set<int>> output_deps;
+  for (const auto& output : outputs) {
+    output_deps.push_back(
+        GetInputDeps(output.first.first, in_cluster, input_index, &deps));
+  }
+
+  const string& device = cluster_nodes.front()->assigned_device_name();
+  string host_name;
+  TF_RETURN_IF_ERROR(
+      DeviceNameUtils::DeviceNameToCpuDeviceName(device, &host_name));
+
+  Status status;
+  Scope device_scope =
+      NewInternalScope(g, &status, /*refiner=*/nullptr)
+          .NewSubScope(absl::StrCat(cluster_name, "/shape_bucketing"))
+          .WithAssignedDevice(device);
+  Scope host_scope = device_scope.WithAssignedDevice(host_name);
+
+  // Pad every input to its bucketed shape and remember its original shape.
+  std::vector<Output> input_shapes;
+  for (const auto& input : inputs) {
+    Output tensor(input.first.first, input.first.second);
+    Output shape = ops::Shape(device_scope.WithOpName("shape"), tensor,
+                              ops::Shape::OutType(DT_INT64));
+    Output bucketed_shape = ops::_XlaBucketShape(
+        host_scope.WithOpName("bucketed_shape"), shape,
+        ops::_XlaBucketShape::Buckets(buckets));
+    Output paddings = ops::Stack(
+        host_scope.WithOpName("paddings"),
+        {ops::ZerosLike(host_scope.WithOpName("zeros"), shape),
+         ops::Sub(host_scope.WithOpName("padding"), bucketed_shape, shape)},
+        ops::Stack::Axis(1));
+    Output padded = ops::Pad(device_scope.WithOpName("pad"), tensor, paddings);
+    TF_RETURN_IF_ERROR(status);
+
+    for (const Edge* e : input.second) {
+      Node* dst = e->dst();
+      int dst_input = e->dst_input();
+      g->RemoveEdge(e);
+      g->AddEdge(padded.node(), padded.index(), dst, dst_input);
+    }
+    input_shapes.push_back(shape);
+  }
+
+  // Slice every output back to the shape it has without padding, which is
+  // the broadcast shape of the inputs it depends on.
+  int output_number = 0;
+  for (const auto& output : outputs) {
+    const std::set<int>& output_inputs = output_deps[output_number++];
+    if (output_inputs.empty()) {
+      // Computed from constants only, so not affected by the padding.
+      continue;
+    }
+    auto it = output_inputs.begin();
+    Output shape = input_shapes[*it];
+    for (++it; it != output_inputs.end(); ++it) {
+      shape = ops::BroadcastArgs(host_scope.WithOpName("output_shape"), shape,
+                                 input_shapes[*it]);
+    }
+    Output sliced = ops::Slice(
+        device_scope.WithOpName("slice"),
+        Output(output.first.first, output.first.second),
+        ops::ZerosLike(host_scope.WithOpName("begin"), shape), shape);
+    TF_RETURN_IF_ERROR(status);
+
+    for (const Edge* e : output.second) {
+      Node* dst = e->dst();
+      int dst_input = e->dst_input();
+      g->RemoveEdge(e);
+      g->AddEdge(sliced.node(), sliced.index(), dst, dst_input);
+    }
+  }
+
+  VLOG(2) << "Bucketed the shapes of cluster " << cluster_name;
+  *changed = true;
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ShapeBucketingPass::Run(const GraphOptimizationPassOptions& options) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  if (flags->tf_xla_shape_buckets.empty()) {
+    return Status::OK();
+  }
+  std::vector<int> buckets;
+  TF_RETURN_IF_ERROR(ParseBuckets(flags->tf_xla_shape_buckets, &buckets));
+
+  Graph* g = options.graph->get();
+  std::map<string, std::vector<Node*>> clusters;
+  for (Node* n : g->op_nodes()) {
+    absl::optional<absl::string_view> cluster = GetXlaClusterForNode(*n);
+    if (cluster.has_value()) {
+      clusters[string(*cluster)].push_back(n);
+    }
+  }
+
+  bool changed = false;
+  for (const auto& cluster : clusters) {
+    bool cluster_changed;
+    TF_RETURN_IF_ERROR(BucketCluster(g, cluster.first, cluster.second, buckets,
+                                     &cluster_changed));
+    changed |= cluster_changed;
+  }
+
+  if (changed && flags->tf_xla_clustering_debug) {
+    DumpGraphToFile("shape_bucketing_pass", *g, options.flib_def);
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,46 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+namespace tensorflow {
+
+// Bounds the number of shapes an XLA cluster is compiled for by padding its
+// inputs to a few bucketed shapes. Enabled by --tf_xla_shape_buckets.
+//
+// Only clusters made of elementwise operations (and scalar constants) are
+// rewritten. Every element of their outputs depends only on the elements of
+// their inputs at the same (broadcast) index, so padding the inputs with zeros
+// does not change the elements that are kept. For such a cluster:
+//
+//   cluster(x, y) =>
+//     Slice(cluster(Pad(x, bucket(Shape(x))), Pad(y, bucket(Shape(y)))),
+//           0, BroadcastArgs(Shape(x), Shape(y)))
+//
+// where bucket rounds every dimension larger than one up to its bucket (see
+// the _XlaBucketShape op). Dimensions of size one are kept, so broadcasting
+// inside the cluster is unaffected. The padding and slicing are placed
+// outside of the cluster, which is then versioned only on the bucketed shapes.
+class ShapeBucketingPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_PASS_H_
@@ -0,0 +1,116 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing_pass.h"
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/node_matchers.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using testing::matchers::AssignedDevice;
+using testing::matchers::Inputs;
+using testing::matchers::Name;
+using testing::matchers::NodeWith;
+using testing::matchers::Op;
+using testing::matchers::Out;
+
+const char* kHostName = "/job:worker/replica:0/task:0/device:CPU:0";
+const char* kDeviceName = "/job:worker/replica:0/task:0/device:GPU:0";
+
+Status BucketShapes(const Scope& s, const string& buckets,
+                    std::unique_ptr<Graph>* result) {
+  auto graph = absl::make_unique<Graph>(OpRegistry::Global());
+  std::unordered_map<string, string> assigned_device_names;
+  for (Node* n : s.graph()->nodes()) {
+    assigned_device_names[n->name()] = n->assigned_device_name();
+  }
+  TF_RETURN_IF_ERROR(s.ToGraph(graph.get()));
+  for (Node* n : graph->nodes()) {
+    n->set_assigned_device_name(assigned_device_names[n->name()]);
+  }
+
+  GraphOptimizationPassOptions options;
+  options.graph = &graph;
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  string old_buckets = flags->tf_xla_shape_buckets;
+  flags->tf_xla_shape_buckets = buckets;
+  Status status = ShapeBucketingPass().Run(options);
+  flags->tf_xla_shape_buckets = old_buckets;
+  *result = std::move(graph);
+  return status;
+}
+
+TEST(ShapeBucketingPassTest, PadsInputsAndSlicesOutputs) {
+  Scope root = Scope::NewRootScope().ExitOnError().WithAssignedDevice(
+      kDeviceName);
+  Output a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT);
+  Output b = ops::Placeholder(root.WithOpName("b"), DT_FLOAT);
+  Scope cluster = root.WithXlaCluster("cluster_0");
+  Output add = ops::Add(cluster.WithOpName("add"), a, b);
+  Output tanh = ops::Tanh(cluster.WithOpName("tanh"), add);
+  Output neg = ops::Neg(root.WithOpName("neg"), tanh);
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(BucketShapes(root, "pow2", &graph));
+
+  auto m_padded = [](const char* name) {
+    auto m_input = Out(NodeWith(Name(name)));
+    return Out(NodeWith(
+        Op("Pad"), AssignedDevice(kDeviceName),
+        Inputs(m_input,
+               Out(NodeWith(Op("Pack"), AssignedDevice(kHostName))))));
+  };
+  auto m_add = NodeWith(Name("add"), Inputs(m_padded("a"), m_padded("b")));
+  auto m_slice = NodeWith(
+      Op("Slice"), AssignedDevice(kDeviceName),
+      Inputs(Out(NodeWith(Name("tanh"))), Out(NodeWith(Op("ZerosLike"))),
+             Out(NodeWith(Op("BroadcastArgs"), AssignedDevice(kHostName)))));
+
+  EXPECT_THAT(testing::FindNodeByName(graph.get(), "add"), m_add);
+  EXPECT_THAT(testing::FindNodeByName(graph.get(), "neg"),
+              NodeWith(Inputs(Out(m_slice))));
+}
+
+TEST(ShapeBucketingPassTest, SkipsNonElementwiseClusters) {
+  Scope root = Scope::NewRootScope().ExitOnError().WithAssignedDevice(
+      kDeviceName);
+  Output a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT);
+  Scope cluster = root.WithXlaCluster("cluster_0");
+  Output sum = ops::Sum(cluster.WithOpName("sum"), a,
+                        ops::Const(cluster.WithOpName("axis"), 0));
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(BucketShapes(root, "16,32", &graph));
+
+  EXPECT_THAT(testing::FindNodeByName(graph.get(), "sum"),
+              NodeWith(Inputs(Out(NodeWith(Name("a"))), Out(NodeWith()))));
+}
+
+TEST(ShapeBucketingPassTest, RejectsInvalidBuckets) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  std::unique_ptr<Graph> graph;
+  EXPECT_FALSE(BucketShapes(root, "16,x", &graph).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
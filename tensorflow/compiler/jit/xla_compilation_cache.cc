@@ -20,6 +20,7 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
@@ -158,6 +159,8 @@ Status XlaCompilationCache::BuildExecutable(
                                        : client_->default_device_ordinal());
   build_options.set_result_layout(result.xla_output_shape);
   build_options.set_device_allocator(options.device_allocator.get());
+  build_options.set_share_executables(
+      GetXlaOpsCommonFlags().tf_xla_share_executables);
 
   TF_ASSIGN_OR_RETURN(
       auto executables,
@@ -323,7 +326,16 @@ Status XlaCompilationCache::CompileAsynchronous(
       Entry tmp;
       VLOG(2) << "Starting asynchronous compilation of cluster "
               << function_name << '.';
-      (void)CompileStrict(&tmp, options, args, function_name, compile_fn);
+      Status status =
+          CompileStrict(&tmp, options, args, function_name, compile_fn);
+      if (status.ok()) {
+        status = tmp.compilation_status;
+      }
+      if (!status.ok()) {
+        LOG(WARNING) << "Asynchronous compilation of cluster " << function_name
+                     << " failed, falling back to TF function call: "
+                     << status;
+      }
       VLOG(2) << "Finished asynchronous compililation of cluster "
               << function_name << '.';
       {
@@ -332,7 +344,7 @@ Status XlaCompilationCache::CompileAsynchronous(
       }
       { // populate original entry with compilation result
         mutex_lock entry_lock(entry->mu);
-        entry->compilation_result = tmp.compilation_result;
+        entry->compilation_result = std::move(tmp.compilation_result);
         entry->compile_state = tmp.compile_state;
         entry->compilation_status = tmp.compilation_status;
         entry->executable = std::move(tmp.executable);
@@ -477,6 +489,15 @@ Status XlaCompilationCache::CompileImpl(
   } else if (state == CompileState::kCompiled) {
       VLOG(2) << "Already Compiled for signature: " << human_signature;
   }
+  if (state == CompileState::kCompiled &&
+      compile_mode == CompileMode::kAsync &&
+      !entry->compilation_status.ok()) {
+    // The failure was logged by the background compilation; keep running the
+    // fallback path instead of failing every step.
+    VLOG(2) << "Asynchronous compilation failed for signature: "
+            << human_signature;
+    return_null = true;
+  }
   if (return_null) {
     *out_compilation_result = nullptr;
     *out_executable = nullptr;
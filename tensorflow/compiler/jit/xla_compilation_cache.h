@@ -68,9 +68,11 @@ class XlaCompilationCache : public ResourceBase {
   // heuristics, the compilation cache may decide not to compile the cluster at
   // this time.  In this case it returns null into both `out_compilation_result`
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
-  // cache always attempts the compilation on a cache miss. if compilation mode
-  // is 'kAsync' compilation of the cluster happens in the background while the
-  // fall
+  // cache always attempts the compilation on a cache miss. If `compile_mode` is
+  // `kAsync` then a cache miss starts the compilation on a background thread
+  // and returns null, so that the caller runs its fallback path until the
+  // compilation has finished. A failed background compilation also returns
+  // null rather than an error, so the caller keeps using the fallback path.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
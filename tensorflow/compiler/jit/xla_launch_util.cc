@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
+#include <cstring>
 #include <memory>
 
 #include "absl/algorithm/container.h"
@@ -247,6 +248,91 @@ void XlaComputationLaunchContext::PopulateInputs(
   }
 }
 
+// Looks up, or creates, the variables updated by `kernel`, in the order of
+// its `resource_updates`.
+static Status GetUpdatedVariables(OpKernelContext* ctx,
+                                  const XlaCompiler::CompilationResult* kernel,
+                                  int missing_ctx_input_prefix,
+                                  std::vector<VariableInfo>* variable_infos) {
+  variable_infos->reserve(kernel->resource_updates.size());
+  for (const XlaCompiler::ResourceUpdate& write : kernel->resource_updates) {
+    int actual_input_index = write.input_index - missing_ctx_input_prefix;
+    if (actual_input_index < 0 || actual_input_index >= ctx->num_inputs()) {
+      return errors::Internal("Invalid input index for variable write.");
+    }
+
+    // TODO(b/35625933): tensorflow::Var should contain a PersistentTensor,
+    // not a Tensor.
+    Var* variable = nullptr;
+    TF_RETURN_IF_ERROR(LookupOrCreateResource<Var>(
+        ctx, HandleFromInput(ctx, actual_input_index), &variable,
+        [&write](Var** ptr) {
+          *ptr = new Var(write.type);
+          return Status::OK();
+        }));
+    variable_infos->emplace_back(actual_input_index, variable);
+  }
+  return Status::OK();
+}
+
+Status XlaComputationLaunchContext::PrepareDonatedVariables(
+    OpKernelContext* ctx, const XlaCompiler::CompilationResult* kernel,
+    std::map<int, OptionalTensor>* variables, int missing_ctx_input_prefix) {
+  if (!absl::c_any_of(kernel->resource_updates,
+                      [](const XlaCompiler::ResourceUpdate& write) {
+                        return write.aliases_input;
+                      })) {
+    return Status::OK();
+  }
+  TF_RET_CHECK(!allocate_xla_tensors_)
+      << "Variables backed by XlaTensors cannot be updated in place.";
+  TF_RETURN_IF_ERROR(GetUpdatedVariables(ctx, kernel, missing_ctx_input_prefix,
+                                         &updated_variables_));
+  TF_RETURN_IF_ERROR(LockVariables(absl::MakeSpan(updated_variables_)));
+
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  for (int i = 0; i < kernel->resource_updates.size(); ++i) {
+    const XlaCompiler::ResourceUpdate& write = kernel->resource_updates[i];
+    if (!write.aliases_input) {
+      continue;
+    }
+    auto it = variables->find(write.input_index);
+    TF_RET_CHECK(it != variables->end() && it->second.present)
+        << "No snapshot of the variable updated in place by input "
+        << write.input_index;
+    Tensor* variable_tensor = updated_variables_[i].var()->tensor();
+
+    // Drop the references held by the snapshot and the variable, so that the
+    // buffer is only referenced by `donated` unless another op holds it.
+    Tensor donated = it->second.value;
+    it->second.value = Tensor();
+    if (variable_tensor->SharesBufferWith(donated)) {
+      *variable_tensor = Tensor();
+    }
+    if (!donated.RefCountIsOne() && donated.TotalBytes() > 0) {
+      VLOG(2) << "Copying the buffer of variable " << it->second.name
+              << " because it is shared with another tensor.";
+      Tensor copy;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_temp(donated.dtype(), donated.shape(), &copy));
+      if (stream) {
+        se::DeviceMemoryBase copy_mem = XlaTensor::DeviceMemoryFromTensor(copy);
+        stream->ThenMemcpy(&copy_mem,
+                           XlaTensor::DeviceMemoryFromTensor(donated),
+                           donated.TotalBytes());
+      } else {
+        memcpy(DMAHelper::base(&copy), DMAHelper::base(&donated),
+               donated.TotalBytes());
+      }
+      donated = copy;
+    }
+    it->second.value = donated;
+    *variable_tensor = donated;
+  }
+  return Status::OK();
+}
+
 Status XlaComputationLaunchContext::PopulateOutputs(
     OpKernelContext* ctx, const XlaCompiler::CompilationResult* kernel,
     ScopedShapedBuffer output, int missing_ctx_input_prefix) {
@@ -376,33 +462,30 @@ Status XlaComputationLaunchContext::PopulateOutputs(
   // Apply variable updates, if any.
   VLOG(2) << "Applying variable updates";
   std::vector<VariableInfo> variable_infos;
-  variable_infos.reserve(kernel->resource_updates.size());
-
-  for (int i = 0; i < kernel->resource_updates.size(); ++i) {
-    const XlaCompiler::ResourceUpdate& write = kernel->resource_updates[i];
-    int actual_input_index = write.input_index - missing_ctx_input_prefix;
-    if (actual_input_index < 0 || actual_input_index >= ctx->num_inputs()) {
-      return errors::Internal("Invalid input index for variable write.");
-    }
-
-    // TODO(b/35625933): tensorflow::Var should contain a PersistentTensor,
-    // not a Tensor.
-    Var* variable = nullptr;
-    TF_RETURN_IF_ERROR(LookupOrCreateResource<Var>(
-        ctx, HandleFromInput(ctx, actual_input_index), &variable,
-        [&write](Var** ptr) {
-          *ptr = new Var(write.type);
-          return Status::OK();
-        }));
-    variable_infos.emplace_back(actual_input_index, variable);
+  if (updated_variables_.empty()) {
+    TF_RETURN_IF_ERROR(GetUpdatedVariables(
+        ctx, kernel, missing_ctx_input_prefix, &variable_infos));
+    TF_RETURN_IF_ERROR(LockVariables(absl::MakeSpan(variable_infos)));
+  } else {
+    // Already locked by PrepareDonatedVariables().
+    variable_infos = std::move(updated_variables_);
+    updated_variables_.clear();
   }
 
-  TF_RETURN_IF_ERROR(LockVariables(absl::MakeSpan(variable_infos)));
-
   for (int i = 0; i < kernel->resource_updates.size(); ++i) {
     Allocator* allocator = ctx->device()->GetAllocator({});
     const XlaCompiler::ResourceUpdate& write = kernel->resource_updates[i];
 
+    if (write.aliases_input) {
+      // The result was written to the donated input buffer, which the variable
+      // already holds. XLA leaves the aliased output buffer empty.
+      TF_RET_CHECK(output.buffer({output_num}).is_null())
+          << "Expected the update of input " << write.input_index
+          << " to be written in place";
+      ++output_num;
+      continue;
+    }
+
     if (variable_infos[i].var()->tensor()->dtype() != write.type) {
       return errors::Internal("Mismatched type in variable write");
     }
@@ -139,6 +139,28 @@ class XlaComputationLaunchContext {
                       const std::map<int, OptionalTensor>& variables,
                       int missing_ctx_input_prefix);
 
+  // Prepares the resource variables whose updates alias their input buffers in
+  // `kernel` (see XlaCompiler::ResourceUpdate::aliases_input) so that the
+  // computation may overwrite their values in place. Must be called before
+  // PopulateInputs().
+  //
+  // Locks all the variables updated by `kernel`, not only the donated ones,
+  // until PopulateOutputs() returns, so that no other op observes a buffer
+  // while the computation writes to it. They are locked in a single
+  // LockVariables() call, since acquiring the rest later could deadlock with
+  // another op that locks the same variables. The buffer of each
+  // snapshot in `variables` is donated to the computation if neither the
+  // variable nor any other tensor holds a reference to it, and copied
+  // otherwise. Both the snapshot and the variable are set to the donated
+  // buffer.
+  //
+  // Assumes that the first `missing_ctx_input_prefix` inputs to the kernel are
+  // missing and adjusts input indices accordingly.
+  Status PrepareDonatedVariables(OpKernelContext* ctx,
+                                 const XlaCompiler::CompilationResult* kernel,
+                                 std::map<int, OptionalTensor>* variables,
+                                 int missing_ctx_input_prefix);
+
   // Given the XLA output in `output`, populate all outputs of `ctx`.  Also
   // writes out the resource variable updates.
   //
@@ -165,6 +187,10 @@ class XlaComputationLaunchContext {
   bool use_multiple_streams_;
   std::vector<std::unique_ptr<xla::ShapedBuffer>> arg_buffers_;
   std::vector<xla::ShapedBuffer*> arg_ptrs_;
+
+  // The variables updated by the computation, in the order of
+  // `resource_updates`, if they were locked by PrepareDonatedVariables().
+  std::vector<VariableInfo> updated_variables_;
 };
 
 // A simple TensorBuffer implementation that allows us to create Tensors that
@@ -0,0 +1,153 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_launch_util.h"
+
+#include <functional>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// An op whose kernel runs `*compute_fn` on its context, which gives the test
+// an OpKernelContext with resource inputs.
+REGISTER_OP("XlaLaunchUtilTestOp")
+    .Input("resources: N * resource")
+    .Attr("N: int >= 1");
+
+std::function<void(OpKernelContext*)>* compute_fn = nullptr;
+
+class XlaLaunchUtilTestOp : public OpKernel {
+ public:
+  explicit XlaLaunchUtilTestOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+  void Compute(OpKernelContext* ctx) override { (*compute_fn)(ctx); }
+};
+
+REGISTER_KERNEL_BUILDER(Name("XlaLaunchUtilTestOp").Device(DEVICE_CPU),
+                        XlaLaunchUtilTestOp);
+
+XlaCompiler::ResourceUpdate MakeUpdate(int input_index, bool aliases_input) {
+  XlaCompiler::ResourceUpdate update;
+  update.input_index = input_index;
+  update.type = DT_FLOAT;
+  update.shape = TensorShape({2});
+  update.modified = true;
+  update.aliases_input = aliases_input;
+  return update;
+}
+
+class XlaLaunchUtilTest : public OpsTestBase {
+ protected:
+  void AddVariable(const string& name, Var** var) {
+    *var = new Var(DT_FLOAT);
+    *(*var)->tensor() = test::AsTensor<float>({1, 2});
+    (*var)->is_initialized = true;
+    (*var)->Ref();
+    AddResourceInput<Var>("", name, *var);
+  }
+};
+
+// Returns whether the lock of `var` is held.
+bool IsLocked(Var* var) {
+  if (var->mu()->try_lock()) {
+    var->mu()->unlock();
+    return false;
+  }
+  return true;
+}
+
+TEST_F(XlaLaunchUtilTest, PrepareDonatedVariablesLocksAllUpdates) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "XlaLaunchUtilTestOp")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  Var* donated = nullptr;
+  Var* not_donated = nullptr;
+  AddVariable("donated", &donated);
+  AddVariable("not_donated", &not_donated);
+  core::ScopedUnref donated_unref(donated);
+  core::ScopedUnref not_donated_unref(not_donated);
+
+  // The first variable is updated in place, the second one is not.
+  XlaCompiler::CompilationResult kernel;
+  kernel.resource_updates = {MakeUpdate(0, /*aliases_input=*/true),
+                             MakeUpdate(1, /*aliases_input=*/false)};
+
+  std::function<void(OpKernelContext*)> fn = [&](OpKernelContext* ctx) {
+    std::map<int, OptionalTensor> variables;
+    variables[0].name = "donated";
+    variables[0].present = true;
+    variables[0].value = *donated->tensor();
+    {
+      XlaComputationLaunchContext launch_context(
+          /*client=*/nullptr, /*xla_allocator=*/nullptr,
+          /*allocate_xla_tensors=*/false, /*use_multiple_streams=*/false);
+      TF_ASSERT_OK(launch_context.PrepareDonatedVariables(
+          ctx, &kernel, &variables, /*missing_ctx_input_prefix=*/0));
+      // Both variables stay locked until the outputs are populated, so that
+      // all the locks of the op are acquired in one deadlock-free call.
+      EXPECT_TRUE(IsLocked(donated));
+      EXPECT_TRUE(IsLocked(not_donated));
+      // The variable and its snapshot share the donated buffer.
+      EXPECT_TRUE(donated->tensor()->SharesBufferWith(variables[0].value));
+      test::ExpectTensorEqual<float>(variables[0].value,
+                                     test::AsTensor<float>({1, 2}));
+    }
+    EXPECT_FALSE(IsLocked(donated));
+    EXPECT_FALSE(IsLocked(not_donated));
+  };
+  compute_fn = &fn;
+  TF_ASSERT_OK(RunOpKernel());
+  compute_fn = nullptr;
+}
+
+TEST_F(XlaLaunchUtilTest, PrepareDonatedVariablesWithoutDonation) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "XlaLaunchUtilTestOp")
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  Var* var = nullptr;
+  AddVariable("var", &var);
+  core::ScopedUnref var_unref(var);
+
+  XlaCompiler::CompilationResult kernel;
+  kernel.resource_updates = {MakeUpdate(0, /*aliases_input=*/false)};
+
+  std::function<void(OpKernelContext*)> fn = [&](OpKernelContext* ctx) {
+    std::map<int, OptionalTensor> variables;
+    XlaComputationLaunchContext launch_context(
+        /*client=*/nullptr, /*xla_allocator=*/nullptr,
+        /*allocate_xla_tensors=*/false, /*use_multiple_streams=*/false);
+    TF_ASSERT_OK(launch_context.PrepareDonatedVariables(
+        ctx, &kernel, &variables, /*missing_ctx_input_prefix=*/0));
+    // Without donated variables, locking is left to PopulateOutputs().
+    EXPECT_FALSE(IsLocked(var));
+  };
+  compute_fn = &fn;
+  TF_ASSERT_OK(RunOpKernel());
+  compute_fn = nullptr;
+}
+
+}  // namespace
+}  // namespace tensorflow
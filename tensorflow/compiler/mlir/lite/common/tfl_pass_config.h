@@ -36,7 +36,8 @@ struct PassConfig {
         form_clusters(false),
         inline_functions(true),
         unfold_batch_matmul(true),
-        legalize_tf_while(true) {}
+        legalize_tf_while(true),
+        shuffle_fully_connected_weights(true) {}
 
   // If `emit_builtin_tflite_ops` is true, TF Lite legalization passes will be
   // added, which produces TF Lite ops.
@@ -66,6 +67,10 @@ struct PassConfig {
   // Note: This is staging step and will be removed.
   // TODO(b/137395003): Remove post switching legalization.
   bool legalize_tf_while;
+  // If `shuffle_fully_connected_weights` is true, the weights of quantized
+  // fully connected ops that the runtime evaluates with the shuffled kernel are
+  // stored in its shuffled layout.
+  bool shuffle_fully_connected_weights;
 };
 
 }  // namespace TFL
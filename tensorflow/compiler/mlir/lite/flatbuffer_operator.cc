@@ -178,7 +178,8 @@ ConvertTFL_FullyConnectedOptionsWeightFormatAttrForOptionWriter(
   return llvm::StringSwitch<tflite::FullyConnectedOptionsWeightsFormat>(str)
       .Case("DEFAULT", tflite::FullyConnectedOptionsWeightsFormat_DEFAULT)
       .Case("SHUFFLED4x16INT8",
-            tflite::FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8);
+            tflite::FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8)
+      .Case("SPARSE1x4", tflite::FullyConnectedOptionsWeightsFormat_SPARSE1x4);
 }
 
 static tflite::LSTMKernelType ConvertTFL_LSTMKernelTypeAttrForOptionWriter(
@@ -0,0 +1,40 @@
+// RUN: tf-opt %s -tfl-dense-to-sparse | FileCheck %s
+
+// CHECK-LABEL: blockSparseWeights
+func @blockSparseWeights(%arg0: tensor<1x8xf32>, %arg1: tensor<2xf32>) -> tensor<1x2xf32> {
+  %0 = "tfl.pseudo_const"() {value = dense<[[1.0, 2.0, 3.0, 4.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0]]> : tensor<2x8xf32>} : () -> tensor<2x8xf32>
+  %1 = "tfl.fully_connected"(%arg0, %0, %arg1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x8xf32>, tensor<2x8xf32>, tensor<2xf32>) -> tensor<1x2xf32>
+  return %1 : tensor<1x2xf32>
+
+// CHECK: "tfl.fully_connected"
+// CHECK-SAME: weights_format = "SPARSE1x4"
+}
+
+// CHECK-LABEL: blockSparseInt8Weights
+func @blockSparseInt8Weights(%arg0: tensor<1x8x!quant.uniform<i8:f32, 0.1>>, %arg1: tensor<2x!quant.uniform<i32:f32, 0.01>>) -> tensor<1x2x!quant.uniform<i8:f32, 0.1>> {
+  %0 = "tfl.pseudo_qconst"() {qtype = tensor<2x8x!quant.uniform<i8:f32, 0.1>>, value = dense<[[0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 0, 5, 0, 0, 0]]> : tensor<2x8xi8>} : () -> tensor<2x8x!quant.uniform<i8:f32, 0.1>>
+  %1 = "tfl.fully_connected"(%arg0, %0, %arg1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x8x!quant.uniform<i8:f32, 0.1>>, tensor<2x8x!quant.uniform<i8:f32, 0.1>>, tensor<2x!quant.uniform<i32:f32, 0.01>>) -> tensor<1x2x!quant.uniform<i8:f32, 0.1>>
+  return %1 : tensor<1x2x!quant.uniform<i8:f32, 0.1>>
+
+// CHECK: "tfl.fully_connected"
+// CHECK-SAME: weights_format = "SPARSE1x4"
+}
+
+// CHECK-LABEL: denseWeights
+func @denseWeights(%arg0: tensor<1x8xf32>, %arg1: tensor<2xf32>) -> tensor<1x2xf32> {
+  %0 = "tfl.pseudo_const"() {value = dense<[[1.0, 2.0, 3.0, 4.0, 0.0, 0.0, 0.0, 0.0], [0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0]]> : tensor<2x8xf32>} : () -> tensor<2x8xf32>
+  %1 = "tfl.fully_connected"(%arg0, %0, %arg1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x8xf32>, tensor<2x8xf32>, tensor<2xf32>) -> tensor<1x2xf32>
+  return %1 : tensor<1x2xf32>
+
+// CHECK: "tfl.fully_connected"
+// CHECK-SAME: weights_format = "DEFAULT"
+}
+
+// CHECK-LABEL: nonConstantWeights
+func @nonConstantWeights(%arg0: tensor<1x8xf32>, %arg1: tensor<2x8xf32>, %arg2: tensor<2xf32>) -> tensor<1x2xf32> {
+  %0 = "tfl.fully_connected"(%arg0, %arg1, %arg2) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x8xf32>, tensor<2x8xf32>, tensor<2xf32>) -> tensor<1x2xf32>
+  return %0 : tensor<1x2xf32>
+
+// CHECK: "tfl.fully_connected"
+// CHECK-SAME: weights_format = "DEFAULT"
+}
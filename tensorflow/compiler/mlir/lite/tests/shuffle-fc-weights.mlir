@@ -0,0 +1,31 @@
+// RUN: tf-opt %s -tfl-shuffle-fc-weights | FileCheck %s
+
+// CHECK-LABEL: shuffleWeights
+func @shuffleWeights(%arg0: tensor<1x16x!quant.uniform<u8:f32, 0.1:128>>, %arg1: tensor<4x!quant.uniform<i32:f32, 0.01>>) -> tensor<1x4x!quant.uniform<i16:f32, 0.01>> {
+  %0 = "tfl.pseudo_qconst"() {qtype = tensor<4x16x!quant.uniform<u8:f32, 0.1:128>>, value = dense<1> : tensor<4x16xi8>} : () -> tensor<4x16x!quant.uniform<u8:f32, 0.1:128>>
+  %1 = "tfl.fully_connected"(%arg0, %0, %arg1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x16x!quant.uniform<u8:f32, 0.1:128>>, tensor<4x16x!quant.uniform<u8:f32, 0.1:128>>, tensor<4x!quant.uniform<i32:f32, 0.01>>) -> tensor<1x4x!quant.uniform<i16:f32, 0.01>>
+  return %1 : tensor<1x4x!quant.uniform<i16:f32, 0.01>>
+
+// CHECK: %[[cst:.*]] = "tfl.pseudo_qconst"() {qtype = tensor<4x16x!quant.uniform<u8:f32, 1.000000e-01:128>>, value = dense<-127> : tensor<4x16xi8>}
+// CHECK: %[[fc:.*]]:2 = "tfl.fully_connected"(%arg0, %[[cst]], %arg1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "SHUFFLED4x16INT8"}
+// CHECK-SAME: -> (tensor<1x4x!quant.uniform<i16:f32, 1.000000e-02>>, tensor<1x16x!quant.uniform<u8:f32, 1.000000e-01:128>>)
+// CHECK: return %[[fc]]#0
+}
+
+// CHECK-LABEL: notShuffleIncompleteBlocks
+func @notShuffleIncompleteBlocks(%arg0: tensor<1x16x!quant.uniform<u8:f32, 0.1:128>>, %arg1: tensor<3x!quant.uniform<i32:f32, 0.01>>) -> tensor<1x3x!quant.uniform<i16:f32, 0.01>> {
+  %0 = "tfl.pseudo_qconst"() {qtype = tensor<3x16x!quant.uniform<u8:f32, 0.1:128>>, value = dense<1> : tensor<3x16xi8>} : () -> tensor<3x16x!quant.uniform<u8:f32, 0.1:128>>
+  %1 = "tfl.fully_connected"(%arg0, %0, %arg1) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x16x!quant.uniform<u8:f32, 0.1:128>>, tensor<3x16x!quant.uniform<u8:f32, 0.1:128>>, tensor<3x!quant.uniform<i32:f32, 0.01>>) -> tensor<1x3x!quant.uniform<i16:f32, 0.01>>
+  return %1 : tensor<1x3x!quant.uniform<i16:f32, 0.01>>
+
+// CHECK: value = dense<1> : tensor<3x16xi8>
+// CHECK: weights_format = "DEFAULT"
+}
+
+// CHECK-LABEL: notShuffleFloatWeights
+func @notShuffleFloatWeights(%arg0: tensor<1x16xf32>, %arg1: tensor<4x16xf32>, %arg2: tensor<4xf32>) -> tensor<1x4xf32> {
+  %0 = "tfl.fully_connected"(%arg0, %arg1, %arg2) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x16xf32>, tensor<4x16xf32>, tensor<4xf32>) -> tensor<1x4xf32>
+  return %0 : tensor<1x4xf32>
+
+// CHECK: weights_format = "DEFAULT"
+}
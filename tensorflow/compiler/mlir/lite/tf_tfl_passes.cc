@@ -156,6 +156,13 @@ void AddTFToTFLConversionPasses(const mlir::TFL::PassConfig& pass_config,
     if (pass_config.quant_specs.RunPropagationAndRewriteQuantizationPasses()) {
       AddQuantizationPasses(pass_config.quant_specs, pass_manager);
     }
+    // Like TOCO, mark the fully connected weights that the runtime multiplies
+    // with its block sparse kernel.
+    pass_manager->addPass(mlir::TFL::CreateDenseToSparsePass());
+    if (pass_config.shuffle_fully_connected_weights) {
+      pass_manager->addPass(
+          mlir::TFL::CreateShuffleFullyConnectedWeightsPass());
+    }
   }
 }
 
@@ -15,11 +15,20 @@ limitations under the License.
 
 // This transformation pass convert dense tensor to sparse format.
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/APInt.h"
+#include "mlir/Dialect/QuantOps/QuantTypes.h"  // TF:llvm-project
 #include "mlir/IR/Attributes.h"  // TF:llvm-project
 #include "mlir/IR/Builders.h"  // TF:llvm-project
+#include "mlir/IR/StandardTypes.h"  // TF:llvm-project
+#include "mlir/IR/TypeUtilities.h"  // TF:llvm-project
 #include "mlir/Pass/Pass.h"  // TF:llvm-project
 #include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
 
 //===----------------------------------------------------------------------===//
 // The DenseToSparse Pass.
@@ -29,6 +38,62 @@ namespace TFL {
 
 namespace {
 
+// The fraction of all-zero 1x4 blocks above which the block sparse fully
+// connected kernel of the runtime beats the dense one.
+constexpr float kMinZeroBlockFraction = 0.75f;
+
+// Returns true if `value` holds constant fully connected weights with enough
+// all-zero blocks of 1x4 consecutive values along the input depth for the
+// runtime to multiply them with its block sparse kernel. The kernel takes
+// float weights and int8 weights with a zero point of 0.
+bool IsBlockSparse1x4(Value value) {
+  Operation* inst = value.getDefiningOp();
+  if (!inst) return false;
+  ElementsAttr attr;
+  if (auto cst = dyn_cast<ConstOp>(inst)) {
+    attr = cst.value();
+  } else if (auto cst = dyn_cast<QConstOp>(inst)) {
+    auto qtype = getElementTypeOrSelf(cst.qtype())
+                     .dyn_cast<quant::UniformQuantizedType>();
+    if (!qtype || !qtype.isSigned() ||
+        qtype.getStorageTypeIntegralWidth() != 8 || qtype.getZeroPoint() != 0) {
+      return false;
+    }
+    attr = cst.value();
+  } else {
+    return false;
+  }
+  auto dense_attr = attr.dyn_cast<DenseElementsAttr>();
+  if (!dense_attr) return false;
+  ShapedType type = dense_attr.getType();
+  if (!type.hasRank() || type.getRank() != 2 || type.getDimSize(1) % 4 != 0) {
+    return false;
+  }
+
+  std::vector<bool> is_zero;
+  is_zero.reserve(type.getNumElements());
+  if (type.getElementType().isF32()) {
+    for (const APFloat& v : dense_attr.getValues<APFloat>()) {
+      is_zero.push_back(v.isZero());
+    }
+  } else if (type.getElementType().isInteger(8)) {
+    for (const APInt& v : dense_attr.getValues<APInt>()) {
+      is_zero.push_back(v.isNullValue());
+    }
+  } else {
+    return false;
+  }
+  const int64_t num_elements = is_zero.size();
+  int64_t zero_blocks = 0;
+  for (int64_t i = 0; i + 4 <= num_elements; i += 4) {
+    if (is_zero[i] && is_zero[i + 1] && is_zero[i + 2] && is_zero[i + 3]) {
+      ++zero_blocks;
+    }
+  }
+  const int64_t num_blocks = num_elements / 4;
+  return num_blocks > 0 && zero_blocks >= kMinZeroBlockFraction * num_blocks;
+}
+
 struct DenseToSparse : public FunctionPass<DenseToSparse> {
   void runOnFunction() override;
 };
@@ -58,6 +123,15 @@ void DenseToSparse::runOnFunction() {
       }
     }
   });
+
+  // The fully connected kernel of the runtime skips the all-zero 1x4 blocks of
+  // weights marked as SPARSE1x4, which stay dense in the flatbuffer.
+  func.walk([&](FullyConnectedOp fc_op) {
+    if (fc_op.weights_format() == "DEFAULT" &&
+        IsBlockSparse1x4(fc_op.filter())) {
+      fc_op.setAttr("weights_format", builder.getStringAttr("SPARSE1x4"));
+    }
+  });
 }
 
 }  // namespace
@@ -85,6 +85,10 @@ std::unique_ptr<OpPassBase<FuncOp>> CreateDefaultQuantParamsPass(
 // tensor to sparse format.
 std::unique_ptr<OpPassBase<FuncOp>> CreateDenseToSparsePass();
 
+// Creates an instance of the TensorFlow Lite dialect pass to store the weights
+// of quantized fully connected ops in the shuffled layout of the runtime.
+std::unique_ptr<OpPassBase<FuncOp>> CreateShuffleFullyConnectedWeightsPass();
+
 // Creates function pass to legalize TF While to TFL While.
 std::unique_ptr<OpPassBase<FuncOp>> CreateLegalizeTFWhilePass();
 
@@ -0,0 +1,170 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This transformation pass stores the weights of quantized fully connected ops
+// in the shuffled 4x16 block layout that the TensorFlow Lite kernel reads
+// directly, so that the layout does not need to be computed at runtime.
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "llvm/ADT/APInt.h"
+#include "mlir/Dialect/QuantOps/QuantTypes.h"  // TF:llvm-project
+#include "mlir/IR/Attributes.h"  // TF:llvm-project
+#include "mlir/IR/Builders.h"  // TF:llvm-project
+#include "mlir/IR/StandardTypes.h"  // TF:llvm-project
+#include "mlir/IR/TypeUtilities.h"  // TF:llvm-project
+#include "mlir/Pass/Pass.h"  // TF:llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+#include "tensorflow/compiler/mlir/lite/transforms/passes.h"
+
+//===----------------------------------------------------------------------===//
+// The ShuffleFullyConnectedWeights Pass.
+//
+namespace mlir {
+namespace TFL {
+
+namespace {
+
+constexpr char kShuffledWeightsFormat[] = "SHUFFLED4x16INT8";
+
+// Returns true if `type` is a quantized tensor type with the given storage
+// signedness and width.
+bool IsQuantizedType(Type type, bool is_signed, unsigned width) {
+  auto quantized_type =
+      getElementTypeOrSelf(type).dyn_cast<quant::QuantizedType>();
+  return quantized_type && quantized_type.isSigned() == is_signed &&
+         quantized_type.getStorageTypeIntegralWidth() == width;
+}
+
+struct ShuffleFullyConnectedWeights
+    : public FunctionPass<ShuffleFullyConnectedWeights> {
+  void runOnFunction() override;
+};
+
+// Same conditions as the ShuffleFCWeights graph transformation of TOCO: the
+// shuffled kernel only supports uint8 inputs and weights with int16 outputs,
+// and only speeds up matrix * vector products.
+bool CanShuffleWeights(FullyConnectedOp fc_op) {
+  if (fc_op.weights_format() != "DEFAULT" ||
+      fc_op.getOperation()->getNumResults() != 1) {
+    return false;
+  }
+  auto input_type = fc_op.input().getType().dyn_cast<RankedTensorType>();
+  auto filter_type = fc_op.filter().getType().dyn_cast<RankedTensorType>();
+  Type output_type = fc_op.getResult(0).getType();
+  if (!input_type || !filter_type || !input_type.hasStaticShape() ||
+      !filter_type.hasStaticShape() ||
+      !IsQuantizedType(input_type, /*is_signed=*/false, 8) ||
+      !IsQuantizedType(filter_type, /*is_signed=*/false, 8) ||
+      !IsQuantizedType(output_type, /*is_signed=*/true, 16)) {
+    return false;
+  }
+
+  // The input activations must have a single column, for a batch size of 1
+  // or 4.
+  ArrayRef<int64_t> input_shape = input_type.getShape();
+  if (input_shape.empty()) return false;
+  for (int i = 1; i < static_cast<int>(input_shape.size()) - 1; ++i) {
+    if (input_shape[i] != 1) return false;
+  }
+  if (input_shape[0] != 1 && input_shape[0] != 4) return false;
+
+  // The weights must be a constant consumed by this op only, whose shape is a
+  // multiple of the 4x16 block shape.
+  if (filter_type.getRank() != 2 || filter_type.getDimSize(0) % 4 != 0 ||
+      filter_type.getDimSize(1) % 16 != 0 || !fc_op.filter().hasOneUse()) {
+    return false;
+  }
+  auto filter_op = dyn_cast_or_null<QConstOp>(fc_op.filter().getDefiningOp());
+  return filter_op && filter_op.value().isa<DenseElementsAttr>();
+}
+
+// Returns the weights in blocks of 4 rows and 16 columns, each stored row by
+// row, with the sign bit flipped so that the kernel can read them as int8
+// values with a zero point of 0.
+DenseElementsAttr ShuffleWeights(DenseElementsAttr weights) {
+  auto type = weights.getType();
+  const int64_t rows = type.getDimSize(0);
+  const int64_t cols = type.getDimSize(1);
+  std::vector<uint8_t> values;
+  values.reserve(rows * cols);
+  for (const APInt& value : weights.getValues<APInt>()) {
+    values.push_back(static_cast<uint8_t>(value.getZExtValue()));
+  }
+  std::vector<uint8_t> shuffled;
+  shuffled.reserve(rows * cols);
+  for (int64_t r = 0; r < rows; r += 4) {
+    for (int64_t c = 0; c < cols; c += 16) {
+      for (int64_t i = 0; i < 4; ++i) {
+        const uint8_t* src = values.data() + (r + i) * cols + c;
+        for (int64_t j = 0; j < 16; ++j) {
+          shuffled.push_back(src[j] ^ 0x80);
+        }
+      }
+    }
+  }
+  return DenseElementsAttr::get(type, ArrayRef<uint8_t>(shuffled));
+}
+
+void ShuffleFullyConnectedWeights::runOnFunction() {
+  FuncOp func = getFunction();
+  OpBuilder builder(func);
+
+  llvm::SmallVector<FullyConnectedOp, 4> fc_ops;
+  func.walk([&](FullyConnectedOp fc_op) {
+    if (CanShuffleWeights(fc_op)) fc_ops.push_back(fc_op);
+  });
+
+  for (FullyConnectedOp fc_op : fc_ops) {
+    auto filter_op = cast<QConstOp>(fc_op.filter().getDefiningOp());
+    builder.setInsertionPoint(filter_op);
+    auto shuffled_filter = builder.create<QConstOp>(
+        filter_op.getLoc(), filter_op.qtypeAttr(),
+        ShuffleWeights(filter_op.value().cast<DenseElementsAttr>()));
+
+    // The shuffled kernel has a second output, a workspace with the shape and
+    // type of the input into which it shuffles the input activations.
+    builder.setInsertionPoint(fc_op);
+    Type result_types[] = {fc_op.getResult(0).getType(),
+                           fc_op.input().getType()};
+    Value operands[] = {fc_op.input(), shuffled_filter.getResult(),
+                        fc_op.bias()};
+    auto shuffled_fc_op = builder.create<FullyConnectedOp>(
+        fc_op.getLoc(), result_types, operands, fc_op.getAttrs());
+    shuffled_fc_op.setAttr("weights_format",
+                           builder.getStringAttr(kShuffledWeightsFormat));
+
+    fc_op.getResult(0).replaceAllUsesWith(shuffled_fc_op.getResult(0));
+    fc_op.erase();
+    filter_op.erase();
+  }
+}
+
+}  // namespace
+
+// Creates an instance of the TensorFlow Lite dialect
+// ShuffleFullyConnectedWeights pass.
+std::unique_ptr<OpPassBase<FuncOp>> CreateShuffleFullyConnectedWeightsPass() {
+  return absl::make_unique<ShuffleFullyConnectedWeights>();
+}
+
+static PassRegistration<ShuffleFullyConnectedWeights> pass(
+    "tfl-shuffle-fc-weights",
+    "Store quantized fully connected weights in the shuffled 4x16 layout.");
+
+}  // namespace TFL
+}  // namespace mlir
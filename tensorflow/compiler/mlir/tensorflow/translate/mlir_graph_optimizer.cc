@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/mlir/tensorflow/translate/mlir_graph_optimizer.h"
+
+#include <memory>
+#include <unordered_set>
+
+#include "mlir/Analysis/Verifier.h"  // TF:llvm-project
+#include "mlir/IR/MLIRContext.h"  // TF:llvm-project
+#include "mlir/IR/Module.h"  // TF:llvm-project
+#include "mlir/Pass/PassManager.h"  // TF:llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/transforms/passes.h"
+#include "tensorflow/compiler/mlir/tensorflow/translate/export_graphdef.h"
+#include "tensorflow/compiler/mlir/tensorflow/translate/import_model.h"
+#include "tensorflow/compiler/mlir/tensorflow/translate/mlir_roundtrip_flags.h"
+#include "tensorflow/compiler/mlir/tensorflow/utils/error_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/graph_debug_info.pb.h"
+
+namespace tensorflow {
+
+Status MlirGraphOptimizer::Init(
+    const RewriterConfig_CustomGraphOptimizer* config) {
+  if (config == nullptr) {
+    return Status::OK();
+  }
+  const auto& params = config->parameter_map();
+  if (params.count("enable_inliner")) {
+    enable_inliner_ = params.at("enable_inliner").b();
+  }
+  return Status::OK();
+}
+
+Status MlirGraphOptimizer::OptimizeWithMlir(const grappler::GrapplerItem& item,
+                                            GraphDef* optimized_graph) const {
+  mlir::MLIRContext context;
+  GraphDebugInfo debug_info;
+  GraphImportConfig specs;
+  // The graph has no fetches in MLIR, so the pipeline does not prune any node:
+  // Grappler already removes the nodes that are not needed for the fetches.
+  TF_ASSIGN_OR_RETURN(
+      mlir::OwningModuleRef module,
+      ConvertGraphdefToMlir(item.graph, debug_info, specs, &context));
+
+  mlir::StatusScopedDiagnosticHandler status_handler(&context);
+  mlir::PassManager pm(&context);
+  mlir::TF::StandardPipelineOptions pipeline_options;
+  pipeline_options.enable_inliner = enable_inliner_;
+  mlir::TF::CreateTFStandardPipeline(pm, pipeline_options);
+  if (failed(pm.run(*module)) || failed(mlir::verify(*module))) {
+    if (VLOG_IS_ON(1)) module->dump();
+    return status_handler.Combine(
+        errors::Internal("MLIR TensorFlow graph optimization failed"));
+  }
+
+  GraphExportConfig confs;
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<GraphDef> graph,
+                      ConvertMlirToGraphdef(*module, confs));
+
+  // Fetches, feeds and other nodes that Grappler must keep may not be folded
+  // away or renamed.
+  std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  for (const NodeDef& node : graph->node()) {
+    nodes_to_preserve.erase(node.name());
+  }
+  if (!nodes_to_preserve.empty()) {
+    return errors::Internal("MLIR TensorFlow graph optimization removed node ",
+                            *nodes_to_preserve.begin());
+  }
+  optimized_graph->Swap(graph.get());
+  return Status::OK();
+}
+
+Status MlirGraphOptimizer::Optimize(grappler::Cluster* cluster,
+                                    const grappler::GrapplerItem& item,
+                                    GraphDef* optimized_graph) {
+  Status status = OptimizeWithMlir(item, optimized_graph);
+  if (!status.ok()) {
+    VLOG(1) << "Falling back to the original graph of " << item.id << ": "
+            << status;
+    *optimized_graph = item.graph;
+  }
+  return Status::OK();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MlirGraphOptimizer, "mlir_graph_optimizer");
+
+}  // namespace tensorflow
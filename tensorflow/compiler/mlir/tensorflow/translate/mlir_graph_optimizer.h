@@ -0,0 +1,64 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_MLIR_TENSORFLOW_TRANSLATE_MLIR_GRAPH_OPTIMIZER_H_
+#define TENSORFLOW_COMPILER_MLIR_TENSORFLOW_TRANSLATE_MLIR_GRAPH_OPTIMIZER_H_
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// A Grappler optimizer that imports the graph into the MLIR TensorFlow
+// dialect, runs the standard TensorFlow MLIR pipeline on it (island
+// coarsening, canonicalization and constant folding, shape inference, the
+// tf-optimize fusion patterns and CSE) and exports the result back to a
+// GraphDef.
+//
+// The optimizer never fails the Grappler pipeline: if the graph can't be
+// imported, optimized or exported, or if the optimized graph lost a node that
+// must be preserved, the original graph is returned unchanged.
+//
+// Enable it with a custom optimizer named "mlir_graph_optimizer" in the
+// RewriterConfig. The "enable_inliner" parameter inlines function calls.
+class MlirGraphOptimizer : public grappler::CustomGraphOptimizer {
+ public:
+  string name() const override { return "mlir_graph_optimizer"; }
+
+  // The function library is imported and exported along with the graph.
+  bool UsesFunctionLibrary() const override { return true; }
+
+  Status Init(
+      const RewriterConfig_CustomGraphOptimizer* config = nullptr) override;
+
+  Status Optimize(grappler::Cluster* cluster,
+                  const grappler::GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(grappler::Cluster* cluster, const grappler::GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override {}
+
+ private:
+  // Optimizes `item` through MLIR, returning an error on any failure.
+  Status OptimizeWithMlir(const grappler::GrapplerItem& item,
+                          GraphDef* optimized_graph) const;
+
+  bool enable_inliner_ = false;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_MLIR_TENSORFLOW_TRANSLATE_MLIR_GRAPH_OPTIMIZER_H_
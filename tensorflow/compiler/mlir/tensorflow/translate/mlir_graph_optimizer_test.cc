@@ -0,0 +1,84 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/mlir/tensorflow/translate/mlir_graph_optimizer.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class MlirGraphOptimizerTest : public grappler::GrapplerTest {};
+
+TEST_F(MlirGraphOptimizerTest, IsRegistered) {
+  EXPECT_NE(grappler::CustomGraphOptimizerRegistry::CreateByNameOrNull(
+                "mlir_graph_optimizer"),
+            nullptr);
+}
+
+TEST_F(MlirGraphOptimizerTest, FoldsConstants) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), {1.0f, 2.0f}, {2});
+  Output b = ops::Const(s.WithOpName("b"), {3.0f, 4.0f}, {2});
+  Output add = ops::Add(s.WithOpName("add"), a, b);
+  Output out = ops::Identity(s.WithOpName("out"), add);
+
+  grappler::GrapplerItem item;
+  item.fetch = {"out"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  MlirGraphOptimizer optimizer;
+  TF_ASSERT_OK(optimizer.Init());
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  bool found_out = false;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "Add") << node.DebugString();
+    if (node.name() == "out") found_out = true;
+  }
+  EXPECT_TRUE(found_out);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0],
+                                 test::AsTensor<float>({4.0f, 6.0f}, {2}));
+}
+
+TEST_F(MlirGraphOptimizerTest, FallsBackToOriginalGraph) {
+  // The importer rejects ops that are not registered, so the optimizer must
+  // return the graph unchanged instead of failing.
+  grappler::GrapplerItem item;
+  NodeDef* node = item.graph.add_node();
+  node->set_name("unknown");
+  node->set_op("MlirGraphOptimizerTestUnregisteredOp");
+  item.fetch = {"unknown"};
+
+  MlirGraphOptimizer optimizer;
+  TF_ASSERT_OK(optimizer.Init());
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  CompareGraphs(item.graph, output);
+}
+
+}  // namespace
+}  // namespace tensorflow
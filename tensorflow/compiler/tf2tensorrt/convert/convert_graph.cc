@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2tensorrt/convert/convert_graph.h"
 
+#include <algorithm>
 #include <fstream>
 #include <list>
 #include <map>
@@ -37,8 +38,12 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
@@ -76,6 +81,29 @@ Status BuildNodeMap(const Graph& graph,
   return Status::OK();
 }
 
+// Estimated overhead of passing a tensor between TensorFlow and a TensorRT
+// engine, besides reading or writing it: binding it to the engine, and
+// allocating it for the engine outputs.
+constexpr int64 kTransitionOverheadNs = 5000;
+
+// Gets the properties of the first GPU of `cluster` that has what the
+// OpLevelCostEstimator needs. Returns false if there is none.
+bool GetGpuProperties(const grappler::Cluster* cluster,
+                      DeviceProperties* properties) {
+  if (cluster == nullptr) return false;
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& device_properties = device.second;
+    if (device_properties.type() == "GPU" &&
+        device_properties.num_cores() > 0 &&
+        device_properties.frequency() > 0 &&
+        device_properties.environment().count("architecture")) {
+      *properties = device_properties;
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 struct EdgePtrCompare {
@@ -633,6 +661,57 @@ Status ConvertAfterShapes(const ConversionParams& params) {
     segment_options.exclude_node_list.insert(node);
   }
   segment_options.minimum_segment_size = params.minimum_segment_size;
+  // For cost-aware segmentation, the times of the nodes are estimated with the
+  // analytical model of Grappler for a GPU of the cluster, and the times of
+  // the transitions from the tensor sizes and the GPU memory bandwidth.
+  grappler::OpLevelCostEstimator cost_estimator;
+  DeviceProperties gpu_properties;
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  if (params.cost_aware_segmentation) {
+    if (GetGpuProperties(params.cluster, &gpu_properties)) {
+      for (const NodeDef& node : params.input_graph_def->node()) {
+        name_to_node[node.name()] = &node;
+      }
+      const grappler::GraphProperties& graph_properties =
+          *params.graph_properties;
+      segment_options.node_cost_fn = [&](const Node* node) -> int64 {
+        if (!graph_properties.HasInputProperties(node->name())) return 0;
+        grappler::OpContext op_context;
+        op_context.name = node->name();
+        op_context.op_info = grappler::BuildOpInfoWithoutDevice(
+            node->def(), name_to_node,
+            graph_properties.GetInputProperties(node->name()));
+        if (graph_properties.HasOutputProperties(node->name())) {
+          for (const auto& output :
+               graph_properties.GetOutputProperties(node->name())) {
+            *op_context.op_info.add_outputs() = output;
+          }
+        }
+        *op_context.op_info.mutable_device() = gpu_properties;
+        return cost_estimator.PredictCosts(op_context).execution_time.count();
+      };
+      // The bandwidth is in KB/s.
+      const double bytes_per_ns = gpu_properties.bandwidth() > 0
+                                      ? gpu_properties.bandwidth() * 1e-6
+                                      : 100.0;
+      segment_options.transition_cost_fn =
+          [&graph_properties, bytes_per_ns](const Edge* edge) -> int64 {
+        int64 bytes = 0;
+        const string& src_name = edge->src()->name();
+        if (graph_properties.HasOutputProperties(src_name)) {
+          const auto& outputs = graph_properties.GetOutputProperties(src_name);
+          if (edge->src_output() < outputs.size()) {
+            bytes = std::max<int64>(
+                0, grappler::CalculateTensorSize(outputs[edge->src_output()]));
+          }
+        }
+        return kTransitionOverheadNs + static_cast<int64>(bytes / bytes_per_ns);
+      };
+    } else {
+      LOG(WARNING) << "The cluster has no GPU with known properties, "
+                   << "segmenting by size only";
+    }
+  }
   segment::SegmentNodesVector initial_segments;
   TrtNodeValidator validator(*params.graph_properties, params.precision_mode,
                              params.use_calibration);
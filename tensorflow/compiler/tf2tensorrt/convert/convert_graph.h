@@ -47,6 +47,10 @@ struct ConversionParams {
   // maximum number of cached engines
   int max_cached_engines = 1;
   bool use_calibration = true;
+  // Whether to drop the segments whose estimated transitions between
+  // TensorFlow and TensorRT outweigh their estimated computation. Needs a
+  // cluster with the properties of its GPUs.
+  bool cost_aware_segmentation = false;
 };
 
 // Method to call from optimization pass
@@ -67,6 +67,9 @@ Status TRTOptimizationPass::Init(
   if (params.count("use_calibration")) {
     use_calibration_ = params.at("use_calibration").b();
   }
+  if (params.count("cost_aware_segmentation")) {
+    cost_aware_segmentation_ = params.at("cost_aware_segmentation").b();
+  }
   return Status::OK();
 }
 
@@ -255,6 +258,7 @@ Status TRTOptimizationPass::Optimize(grappler::Cluster* cluster,
   cp.is_dyn_op = is_dynamic_op_;
   cp.max_cached_engines = max_cached_batches_;
   cp.use_calibration = use_calibration_;
+  cp.cost_aware_segmentation = cost_aware_segmentation_;
   auto status = ConvertAfterShapes(cp);
   VLOG(1) << "Returning from " << name_;
   return status;
@@ -40,7 +40,8 @@ class TRTOptimizationPass : public grappler::CustomGraphOptimizer {
         is_dynamic_op_(false),
         max_cached_batches_(1),
         max_workspace_size_bytes_(256LL << 20),
-        use_calibration_(true) {
+        use_calibration_(true),
+        cost_aware_segmentation_(false) {
     VLOG(1) << "Constructing " << name_;
   }
 
@@ -71,6 +72,7 @@ class TRTOptimizationPass : public grappler::CustomGraphOptimizer {
   int max_cached_batches_;
   int64_t max_workspace_size_bytes_;
   bool use_calibration_;
+  bool cost_aware_segmentation_;
 
 };
 
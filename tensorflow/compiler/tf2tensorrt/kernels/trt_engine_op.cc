@@ -35,13 +35,19 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/stream_executor/lib/statusor.h"
 
 #if GOOGLE_CUDA
@@ -132,6 +138,13 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& actual_input_shapes,
       std::vector<TensorShape>* engine_input_shapes);
 
+  // Returns the file of engine_cache_dir_ for the engine built for
+  // `engine_input_shapes` on the GPU of `ctx`, or an empty string if the
+  // engine can't be persisted.
+  string GetEngineCacheFile(OpKernelContext* ctx,
+                            const std::vector<TensorShape>& engine_input_shapes,
+                            int batch_size) const;
+
   std::vector<string> input_nodes_;
   std::vector<string> output_nodes_;
 
@@ -157,6 +170,14 @@ class TRTEngineOp : public AsyncOpKernel {
   // Maximum number of cached engines
   int max_cached_engines_;
 
+  // Directory where the engines built at runtime are persisted, so that they
+  // are not built again after a restart. Empty if they are not persisted.
+  string engine_cache_dir_;
+
+  // Fingerprint of segment_graph_, identifying the segment in
+  // engine_cache_dir_.
+  uint64 segment_fingerprint_ = 0;
+
   int64 workspace_size_;
   mutex engine_mutex_;
   FunctionLibraryRuntime::Handle func_handle_;
@@ -289,6 +310,17 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   }
   OP_REQUIRES_OK(context, context->GetAttr("max_cached_engines_count",
                                            &max_cached_engines_));
+  OP_REQUIRES_OK(context, ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR", "",
+                                               &engine_cache_dir_));
+  if (!engine_cache_dir_.empty() && !static_engine_) {
+    string serialized_graph;
+    OP_REQUIRES(context,
+                SerializeToStringDeterministic(segment_graph_,
+                                               &serialized_graph),
+                errors::Internal("Failed to serialize the segment of ",
+                                 name()));
+    segment_fingerprint_ = Fingerprint64(serialized_graph);
+  }
 }
 
 void TRTEngineOp::ExecuteNativeSegment(OpKernelContext* ctx,
@@ -662,6 +694,65 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
       }});
 }
 
+string TRTEngineOp::GetEngineCacheFile(
+    OpKernelContext* ctx, const std::vector<TensorShape>& engine_input_shapes,
+    int batch_size) const {
+  // The INT8 engines depend on calibration data which is not part of the key.
+  if (engine_cache_dir_.empty() ||
+      (precision_mode_ == TrtPrecisionMode::INT8 && use_calibration_)) {
+    return "";
+  }
+  const int platform_gpu_id =
+      ctx->device()->tensorflow_gpu_device_info()->gpu_id;
+  cudaDeviceProp device_prop;
+  if (cudaGetDeviceProperties(&device_prop, platform_gpu_id) != cudaSuccess) {
+    return "";
+  }
+  // An engine is only valid for the TensorRT version and the GPU model it was
+  // built with.
+  const string key = StrCat(
+      segment_fingerprint_, ";", static_cast<int>(precision_mode_), ";",
+      use_calibration_, ";", workspace_size_, ";", batch_size, ";",
+      TensorShapeUtils::ShapeListString(engine_input_shapes), ";",
+      getInferLibVersion(), ";", device_prop.name, ";", device_prop.major, ".",
+      device_prop.minor);
+  return io::JoinPath(engine_cache_dir_,
+                      StrCat(strings::FpToString(Fingerprint64(key)), ".trt"));
+}
+
+// Returns the engine serialized in `path`, or nullptr if there is none or it
+// can't be deserialized.
+TrtUniquePtrType<nvinfer1::ICudaEngine> ReadCachedEngine(
+    const string& path, TRTBaseAllocator* allocator) {
+  Env* env = Env::Default();
+  string serialized_engine;
+  if (!env->FileExists(path).ok() ||
+      !ReadFileToString(env, path, &serialized_engine).ok()) {
+    return nullptr;
+  }
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(allocator);
+  return TrtUniquePtrType<nvinfer1::ICudaEngine>(infer->deserializeCudaEngine(
+      serialized_engine.data(), serialized_engine.size(), nullptr));
+}
+
+// Serializes `engine` to `path`. The engine is written to a temporary file
+// first, so that processes sharing the directory never read a partial file.
+Status WriteCachedEngine(const string& path, nvinfer1::ICudaEngine* engine) {
+  TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(engine->serialize());
+  if (engine_data == nullptr) {
+    return errors::Internal("Failed to serialize the engine");
+  }
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(io::Dirname(path).ToString()));
+  const string tmp_path = StrCat(path, ".tmp", env->NowMicros());
+  TF_RETURN_IF_ERROR(WriteStringToFile(
+      env, tmp_path,
+      StringPiece(static_cast<const char*>(engine_data->data()),
+                  engine_data->size())));
+  return env->RenameFile(tmp_path, path);
+}
+
 StatusOr<EngineContext*> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -729,6 +820,24 @@ StatusOr<EngineContext*> TRTEngineOp::GetEngine(
   // exact shape and possibly create a new engine if it is not in cache.
   if (!cache.count(engine_input_shapes)) {
     TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
+    const string cache_file =
+        GetEngineCacheFile(ctx, engine_input_shapes, batch_size);
+    if (!cache_file.empty()) {
+      engine = ReadCachedEngine(cache_file, allocator);
+    }
+    if (engine) {
+      LOG(INFO) << "Loaded the TensorRT engine for " << name()
+                << " input shapes: "
+                << TensorShapeUtils::ShapeListString(engine_input_shapes)
+                << " from " << cache_file;
+      TrtUniquePtrType<nvinfer1::IExecutionContext> exec_context(
+          engine->createExecutionContext());
+      cache.emplace(engine_input_shapes,
+                    absl::make_unique<EngineContext>(std::move(engine),
+                                                     std::move(exec_context)));
+      return cache.at(engine_input_shapes).get();
+    }
+
     bool convert_successfully = false;
     LOG(INFO) << "Building a new TensorRT engine for " << name()
               << " input shapes: "
@@ -753,6 +862,13 @@ StatusOr<EngineContext*> TRTEngineOp::GetEngine(
       cache.emplace(engine_input_shapes, absl::make_unique<EngineContext>());
       return &empty_context;
     }
+    if (!cache_file.empty()) {
+      Status write_status = WriteCachedEngine(cache_file, engine.get());
+      if (!write_status.ok()) {
+        LOG(WARNING) << "Failed to persist the TensorRT engine for " << name()
+                     << ": " << write_status;
+      }
+    }
     TrtUniquePtrType<nvinfer1::IExecutionContext> exec_context(
         engine->createExecutionContext());
     cache.emplace(engine_input_shapes,
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/cc/ops/function_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
@@ -37,6 +38,8 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 
 #if GOOGLE_CUDA
@@ -166,6 +169,35 @@ TEST_F(TRTEngineOpTestBase, DynamicShapes) {
   EXPECT_EQ(1, cache->count({TensorShape({10, 10})}));
 }
 
+TEST_F(TRTEngineOpTestBase, EngineCacheDir) {
+  const string cache_dir = io::JoinPath(testing::TmpDir(), "trt_engine_cache");
+  setenv("TF_TRT_ENGINE_CACHE_DIR", cache_dir.c_str(), /*overwrite=*/1);
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT);
+  unsetenv("TF_TRT_ENGINE_CACHE_DIR");
+
+  // The engine built for the first input is persisted.
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({2, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &children));
+  ASSERT_EQ(1, children.size());
+  EXPECT_TRUE(absl::EndsWith(children[0], ".trt"));
+
+  // A new op for the same segment loads it instead of building it.
+  setenv("TF_TRT_ENGINE_CACHE_DIR", cache_dir.c_str(), /*overwrite=*/1);
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT);
+  unsetenv("TF_TRT_ENGINE_CACHE_DIR");
+  ResetInputs();
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({2, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  Tensor* output = OpsTestBase::GetOutput(0);
+  EXPECT_THAT(absl::Span<const float>(output->flat<float>().data(),
+                                      output->NumElements()),
+              ElementsAre(0.0f, 2.0f, 4.0f, 6.0f));
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &children));
+  EXPECT_EQ(1, children.size());
+}
+
 template <typename T>
 class TRTEngineOpTest : public TRTEngineOpTestBase {};
 
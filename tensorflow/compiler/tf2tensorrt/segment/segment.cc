@@ -18,6 +18,7 @@ limitations under the License.
 #include <queue>
 #include <set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
@@ -721,6 +722,45 @@ Status SegmentGraph(const Graph* tf_graph,
       continue;
     }
 
+    if (options.node_cost_fn && options.transition_cost_fn) {
+      int64 compute_cost = 0;
+      for (const Node* node : segment_nodes) {
+        compute_cost += options.node_cost_fn(node);
+      }
+      // An output consumed by several nodes outside of the segment is only
+      // passed once.
+      int64 transition_cost = 0;
+      int num_inputs = 0;
+      std::set<std::pair<const Node*, int>> outputs;
+      for (const Node* node : segment_nodes) {
+        for (const Edge* edge : node->in_edges()) {
+          if (!edge->IsControlEdge() && !edge->src()->IsSource() &&
+              !segment_nodes.count(edge->src())) {
+            transition_cost += options.transition_cost_fn(edge);
+            ++num_inputs;
+          }
+        }
+        for (const Edge* edge : node->out_edges()) {
+          if (!edge->IsControlEdge() && !edge->dst()->IsSink() &&
+              !segment_nodes.count(edge->dst()) &&
+              outputs.emplace(node, edge->src_output()).second) {
+            transition_cost += options.transition_cost_fn(edge);
+          }
+        }
+      }
+      VLOG(1) << "Segment " << segments->size() << " with parent "
+              << segment_root << ": " << segment_nodes.size()
+              << " nodes, estimated time " << compute_cost
+              << "ns, estimated transition overhead " << transition_cost
+              << "ns for " << num_inputs << " inputs and " << outputs.size()
+              << " outputs";
+      if (compute_cost < transition_cost) {
+        VLOG(1) << "Dropping segment " << segments->size()
+                << " because its transitions outweigh its computation";
+        continue;
+      }
+    }
+
     const auto& dev_itr = device_maps.find(segment_root);
     if (dev_itr == device_maps.end() || dev_itr->second.empty()) {
       VLOG(1) << "No device assigned to segment " << segments->size();
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_TF2TENSORRT_SEGMENT_SEGMENT_H_
 #define TENSORFLOW_COMPILER_TF2TENSORRT_SEGMENT_SEGMENT_H_
 
+#include <functional>
 #include <set>
 #include <vector>
 
@@ -38,6 +39,12 @@ struct SegmentOptions {
   // Segment must contain at least this many nodes.
   int minimum_segment_size = 2;
   std::set<string> exclude_node_list;
+  // If both are set, a segment is kept only if the estimated time of its nodes
+  // outweighs the overhead of its transitions from and to TensorFlow, i.e. the
+  // estimated time to pass the tensors of its input and output edges. The
+  // times are in nanoseconds.
+  std::function<int64(const Node*)> node_cost_fn;
+  std::function<int64(const Edge*)> transition_cost_fn;
 };
 
 // Get the subgraphs of a graph that can be handled by TensorRT.
@@ -157,6 +157,36 @@ TEST_F(SegmentTest, Simple) {
   RunTest(&g, all_adds, all_adds, without_add3, {all_adds});
 }
 
+TEST_F(SegmentTest, TransitionCost) {
+  //   feed
+  //   //
+  //  add0
+  //   |
+  //  add1
+  //   |
+  //  add2
+  Scope s = Scope::NewRootScope();
+  auto feed = ops::Placeholder(s.WithOpName("feed"), DT_FLOAT);
+  auto add0 = ops::Add(s.WithOpName("add0"), feed, feed);
+  auto add1 = ops::Add(s.WithOpName("add1"), add0, add0);
+  auto add2 = ops::Add(s.WithOpName("add2"), add1, add1);
+  Graph g(OpRegistry::Global());
+  TF_EXPECT_OK(s.ToGraph(&g));
+
+  // The segment computes for 30ns and has two input edges.
+  const std::set<string> all_adds = {"add0", "add1", "add2"};
+  default_options_.node_cost_fn = [](const Node* node) -> int64 { return 10; };
+  int64 edge_cost = 10;
+  default_options_.transition_cost_fn = [&edge_cost](const Edge* edge) {
+    return edge_cost;
+  };
+  RunTest(&g, all_adds, all_adds, all_adds, {all_adds});
+
+  // The segment is dropped when its inputs cost more than its computation.
+  edge_cost = 20;
+  RunTest(&g, all_adds, all_adds, all_adds, {});
+}
+
 TEST_F(SegmentTest, AvoidCycle) {
   //           feed
   //          //  \\
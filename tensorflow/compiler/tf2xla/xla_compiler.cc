@@ -18,6 +18,7 @@ limitations under the License.
 #include <numeric>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/types/variant.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -152,6 +153,8 @@ Status ExecuteGraph(XlaContext* xla_context, std::unique_ptr<Graph> graph,
 //   `resource_updates` is a ResourceUpdate, whose `index` is the index of a
 //   resource variable argument to the computation to be updated, and `type` is
 //   the type of the final output.
+// - If `alias_resource_update` is true, variable updates are aliased to the
+//   parameters of their input values, given by `input_mapping`.
 Status BuildComputation(
     const std::vector<XlaCompiler::Argument>& args,
     const std::vector<XlaExpression>& retvals,
@@ -161,6 +164,7 @@ Status BuildComputation(
     std::unique_ptr<xla::XlaOp> token_output,
     const XlaCompiler::ShapeRepresentationFn& shape_representation_fn,
     bool return_updated_values_for_all_resources, bool always_return_tuple,
+    bool alias_resource_update, const std::vector<int>& input_mapping,
     xla::XlaBuilder* builder, xla::XlaComputation* computation,
     int* num_computation_outputs, int* num_nonconst_outputs,
     std::vector<XlaCompiler::OutputDescription>* outputs,
@@ -262,6 +266,9 @@ Status BuildComputation(
               return a->arg_num() < b->arg_num();
             });
 
+  // Pairs of output index and parameter number of resource updates computed
+  // in place.
+  std::vector<std::pair<int64, int64>> aliased_updates;
   for (const XlaResource* resource : arg_resources) {
     DCHECK_LT(resource->arg_num(), args.size());
     const XlaCompiler::Argument& arg = args[resource->arg_num()];
@@ -285,6 +292,16 @@ Status BuildComputation(
       for (const auto& grad : resource->tensor_array_gradients()) {
         update.tensor_array_gradients_accessed.insert(grad.first);
       }
+      auto parameter = absl::c_find(input_mapping, resource->arg_num());
+      if (alias_resource_update && modified &&
+          resource->kind() == XlaResource::kVariable && arg.initialized &&
+          parameter != input_mapping.end() && arg.type == update.type &&
+          absl::holds_alternative<TensorShape>(arg.shape) &&
+          absl::get<TensorShape>(arg.shape) == update.shape) {
+        update.aliases_input = true;
+        aliased_updates.emplace_back(elems.size(),
+                                     parameter - input_mapping.begin());
+      }
 
       // Request that the value be returned on a specific core.
       xla::XlaScopedShardingAssignment assign_sharding(
@@ -338,6 +355,14 @@ Status BuildComputation(
   if (!always_return_tuple && elems.size() == 1) {
     xla::GetTupleElement(tuple, 0);
   }
+  for (const auto& aliased_update : aliased_updates) {
+    xla::ShapeIndex output_index;
+    if (always_return_tuple || elems.size() != 1) {
+      output_index.push_back(aliased_update.first);
+    }
+    builder->SetUpAlias(output_index, aliased_update.second,
+                        /*param_index=*/{});
+  }
 
   xla::StatusOr<xla::XlaComputation> computation_status = builder->Build();
   if (!computation_status.ok()) {
@@ -1299,7 +1324,10 @@ Status XlaCompiler::CompileGraph(
       options.is_entry_computation ? options_.shape_representation_fn
                                    : ShapeRepresentationFn{},
       options.return_updated_values_for_all_resources,
-      options.always_return_tuple, &builder, result->computation.get(),
+      options.always_return_tuple,
+      options.alias_resource_update && options.is_entry_computation &&
+          !options.use_tuple_arg,
+      result->input_mapping, &builder, result->computation.get(),
       &num_computation_outputs, &num_nonconst_outputs, &result->outputs,
       &result->resource_updates, &result->xla_output_shape));
 
@@ -212,6 +212,13 @@ class XlaCompiler {
 
     // True when we should add XLA input & output to the graph/function.
     bool add_token_input_output = false;
+
+    // If 'alias_resource_update' is true, the updated values of resource
+    // variables are written in place into the parameter buffers of their input
+    // values, which the caller must donate to the computation. Only applies to
+    // entry computations with untupled arguments, and to variables whose type
+    // and shape are not changed by the computation.
+    bool alias_resource_update = false;
   };
 
   struct OutputDescription {
@@ -250,6 +257,10 @@ class XlaCompiler {
 
     // If the resource is a TensorArray, the set of gradients read or written.
     std::set<string> tensor_array_gradients_accessed;
+
+    // True if the updated value is written in place into the parameter buffer
+    // of the input value (see CompileOptions::alias_resource_update).
+    bool aliases_input = false;
   };
 
   struct CompilationResult {
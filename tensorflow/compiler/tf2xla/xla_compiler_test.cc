@@ -1065,6 +1065,50 @@ TEST_F(XlaCompilerTest, Variables) {
   RunAndCheckVariablesComputation(client_, result);
 }
 
+// Tests that variable updates are aliased to their input parameters.
+TEST_F(XlaCompilerTest, AliasResourceUpdate) {
+  Scope scope = Scope::NewRootScope().ExitOnError();
+  auto a = ops::_Arg(scope.WithOpName("A"), DT_INT32, 0);
+  auto var = ops::_Arg(scope.WithOpName("V"), DT_RESOURCE, 1);
+  auto write = ops::AssignAddVariableOp(scope, var, a);
+  auto read = ops::ReadVariableOp(
+      scope.WithControlDependencies(std::vector<Operation>{write}), var,
+      DT_INT32);
+  auto d = ops::_Retval(scope.WithOpName("D"), read, 0);
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(scope.ToGraph(graph.get()));
+
+  // Builds a description of the arguments.
+  std::vector<XlaCompiler::Argument> args(2);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_INT32;
+  args[0].shape = TensorShape({2});
+  args[1].kind = XlaCompiler::Argument::kResource;
+  args[1].resource_kind = XlaResource::kVariable;
+  args[1].initialized = true;
+  args[1].type = DT_INT32;
+  args[1].shape = TensorShape({2});
+
+  // Compiles the graph.
+  XlaCompiler compiler(DefaultOptions());
+
+  XlaCompiler::CompileOptions compile_options;
+  compile_options.alias_resource_update = true;
+  XlaCompiler::CompilationResult result;
+  TF_ASSERT_OK(compiler.CompileGraph(compile_options, "add", std::move(graph),
+                                     args, /*user_aliases=*/{}, &result));
+
+  ASSERT_EQ(1, result.resource_updates.size());
+  EXPECT_TRUE(result.resource_updates[0].aliases_input);
+  const xla::HloInputOutputAliasProto& alias_proto =
+      result.computation->proto().input_output_alias();
+  ASSERT_EQ(1, alias_proto.entries_size());
+  EXPECT_THAT(alias_proto.entries(0).output_shape_index(),
+              ::testing::ElementsAre(1));
+  EXPECT_EQ(1, alias_proto.entries(0).parameter_number());
+  EXPECT_EQ(0, alias_proto.entries(0).parameter_shape_index_size());
+}
+
 TEST_F(XlaCompilerTest, ResultLayoutSingle) {
   Scope scope = Scope::NewRootScope().ExitOnError();
   auto a = ops::_Arg(scope.WithOpName("A"), DT_INT32, 0);
@@ -96,6 +96,15 @@ class ExecutableBuildOptions {
     alias_passthrough_params_ = alias_passthrough_params;
   }
 
+  // Whether the executables may be shared with the other clients of the same
+  // service. If set, compiling a computation that is identical to one compiled
+  // before, with identical argument layouts and options, returns the
+  // executables built then if they are still in use.
+  bool share_executables() const { return share_executables_; }
+  void set_share_executables(bool share_executables) {
+    share_executables_ = share_executables;
+  }
+
  private:
   int device_ordinal_ = -1;
   Shape result_layout_;
@@ -106,6 +115,7 @@ class ExecutableBuildOptions {
   int num_partitions_ = 1;
   absl::optional<DeviceAssignment> device_assignment_;
   bool alias_passthrough_params_ = false;
+  bool share_executables_ = false;
 };
 
 }  // namespace xla
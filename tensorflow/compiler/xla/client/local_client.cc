@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/client/local_client.h"
 
+#include <iterator>
 #include <utility>
 
 #include "absl/memory/memory.h"
@@ -41,7 +42,7 @@ StatusOr<StreamPool::Ptr> BorrowStreamForDevice(int device_ordinal,
 }
 }  // namespace
 
-LocalExecutable::LocalExecutable(std::unique_ptr<Executable> executable,
+LocalExecutable::LocalExecutable(std::shared_ptr<Executable> executable,
                                  Backend* backend,
                                  ExecutableBuildOptions build_options)
     : executable_(std::move(executable)),
@@ -347,9 +348,18 @@ StatusOr<std::vector<std::unique_ptr<LocalExecutable>>> LocalClient::Compile(
     VLOG(3) << "Set device ordinal to default value of: "
             << updated_options.device_ordinal();
   }
-  TF_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<Executable>> executables,
-                      local_service_->CompileExecutables(
-                          computation, argument_layouts, updated_options));
+  std::vector<std::shared_ptr<Executable>> executables;
+  if (updated_options.share_executables()) {
+    TF_ASSIGN_OR_RETURN(executables,
+                        local_service_->CompileSharedExecutables(
+                            computation, argument_layouts, updated_options));
+  } else {
+    TF_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<Executable>> owned,
+                        local_service_->CompileExecutables(
+                            computation, argument_layouts, updated_options));
+    executables.assign(std::make_move_iterator(owned.begin()),
+                       std::make_move_iterator(owned.end()));
+  }
 
   std::vector<std::unique_ptr<LocalExecutable>> local_executables;
   local_executables.reserve(executables.size());
@@ -42,7 +42,7 @@ class LocalExecutable {
  public:
   // Low-level constructor; LocalClient::Compile() is the usual way to create
   // executables.
-  LocalExecutable(std::unique_ptr<Executable> executable, Backend* backend,
+  LocalExecutable(std::shared_ptr<Executable> executable, Backend* backend,
                   ExecutableBuildOptions build_options);
 
   // Run the compiled computation with the given arguments and options and
@@ -91,8 +91,9 @@ class LocalExecutable {
   // Backend::devices_equivalent).
   int build_device_ordinal() const { return build_options_.device_ordinal(); }
 
-  // Compiled computation.
-  std::unique_ptr<Executable> executable_;
+  // Compiled computation, which may be shared with other LocalExecutables if
+  // the build options allow it.
+  std::shared_ptr<Executable> executable_;
 
   // Execution backend.
   Backend* backend_ = nullptr;
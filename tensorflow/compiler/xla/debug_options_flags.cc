@@ -39,6 +39,8 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_cuda_data_dir("./cuda_sdk_lib");
   opts.set_xla_gpu_asm_extra_flags("");
   opts.set_xla_gpu_persistent_cache_dir("");
+  opts.set_xla_cpu_persistent_cache_dir("");
+  opts.set_xla_cpu_parallel_codegen_split_count(0);
   opts.set_xla_eliminate_hlo_implicit_broadcast(true);
   opts.set_xla_dump_hlo_as_html(false);
   opts.set_xla_dump_include_timestamp(true);
@@ -67,6 +69,12 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_allow_excess_precision(true);
   opts.set_xla_force_host_platform_device_count(1);
   opts.set_xla_gpu_deterministic_reductions(false);
+  opts.set_xla_gpu_autotune_reductions(false);
+  opts.set_xla_gpu_host_offload_min_buffer_size_mib(0);
+  opts.set_xla_cpu_enable_xprof_traceme(false);
+  opts.set_xla_hlo_pass_skip_unchanged(false);
+  opts.set_xla_fusion_use_cost_model(false);
+  opts.set_xla_gpu_rematerialization_free_memory_percent(0);
   opts.set_xla_multiheap_size_constraint_per_heap(-1);
   return opts;
 }
@@ -457,6 +465,21 @@ static void AllocateFlags() {
           string_setter_for(
 	     &DebugOptions::set_xla_gpu_persistent_cache_dir), "",
           "The directory for the persistent compilation cache."),
+      tensorflow::Flag(
+          "xla_cpu_persistent_cache_dir",
+          string_setter_for(&DebugOptions::set_xla_cpu_persistent_cache_dir),
+          "",
+          "The directory for the persistent cache of XLA:CPU object code. "
+          "Object code found there is reused instead of running the LLVM "
+          "optimizer and code generator."),
+      tensorflow::Flag(
+          "xla_cpu_parallel_codegen_split_count",
+          int32_setter_for(
+              &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+          flag_values->xla_cpu_parallel_codegen_split_count(),
+          "If greater than one, the LLVM module of a computation is split "
+          "into up to this many parts which are optimized and compiled to "
+          "machine code in parallel."),
       tensorflow::Flag(
           "xla_fuel", setter_for_xla_fuel, /*default_value_for_display=*/"",
           "Sets compiler fuel, useful for bisecting bugs in passes.  Format "
@@ -573,6 +596,47 @@ static void AllocateFlags() {
           bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_reductions),
           flag_values->xla_gpu_deterministic_reductions(),
           "Always run deterministic reductions on GPU"),
+      tensorflow::Flag(
+          "xla_gpu_autotune_reductions",
+          bool_setter_for(&DebugOptions::set_xla_gpu_autotune_reductions),
+          flag_values->xla_gpu_autotune_reductions(),
+          "Compile and time a few candidate tilings for every reduction on "
+          "GPU and use the fastest one. Requires xla_gpu_autotune_level > 0."),
+      tensorflow::Flag(
+          "xla_gpu_host_offload_min_buffer_size_mib",
+          int32_setter_for(
+              &DebugOptions::set_xla_gpu_host_offload_min_buffer_size_mib),
+          flag_values->xla_gpu_host_offload_min_buffer_size_mib(),
+          "Offload GPU buffers of at least this many MiB to pinned host memory "
+          "between distant uses when the copies can be overlapped with "
+          "compute. 0 disables offloading."),
+      tensorflow::Flag(
+          "xla_cpu_enable_xprof_traceme",
+          bool_setter_for(&DebugOptions::set_xla_cpu_enable_xprof_traceme),
+          flag_values->xla_cpu_enable_xprof_traceme(),
+          "Record a profiler TraceMe activity for every instruction of the "
+          "entry computation on CPU."),
+      tensorflow::Flag(
+          "xla_hlo_pass_skip_unchanged",
+          bool_setter_for(&DebugOptions::set_xla_hlo_pass_skip_unchanged),
+          flag_values->xla_hlo_pass_skip_unchanged(),
+          "Skip an HLO pass if it did not change a module with the same "
+          "fingerprint the last time the same pipeline ran it."),
+      tensorflow::Flag(
+          "xla_fusion_use_cost_model",
+          bool_setter_for(&DebugOptions::set_xla_fusion_use_cost_model),
+          flag_values->xla_fusion_use_cost_model(),
+          "Fuse instructions that are recomputed by the fusion only if the "
+          "memory traffic saved outweighs the recomputation, according to the "
+          "roofline of the target."),
+      tensorflow::Flag(
+          "xla_gpu_rematerialization_free_memory_percent",
+          int32_setter_for(
+              &DebugOptions::set_xla_gpu_rematerialization_free_memory_percent),
+          flag_values->xla_gpu_rematerialization_free_memory_percent(),
+          "Rematerialize instructions on GPU until the peak memory use fits "
+          "in this percentage of the free device memory. 0 disables "
+          "rematerialization."),
       tensorflow::Flag(
           "xla_multiheap_size_constraint_per_heap",
           int32_setter_for(
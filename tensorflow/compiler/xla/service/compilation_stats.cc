@@ -35,6 +35,8 @@ class NoopStats : public CompilationStats {
 
   void EndPass(absl::string_view pass_name) override {}
 
+  void SkipPass(absl::string_view pass_name) override {}
+
   void CompilationReport() override {}
 };
 
@@ -46,6 +48,8 @@ class Stats : public CompilationStats {
 
   void EndPass(absl::string_view pass_name) override;
 
+  void SkipPass(absl::string_view pass_name) override;
+
   void CompilationReport() override;
 
  private:
@@ -60,6 +64,8 @@ class Stats : public CompilationStats {
 
   // Info about the passes that have been run so far.
   std::vector<PassInfo> passes_;
+  // The number of times each pass was skipped.
+  absl::flat_hash_map<absl::string_view, int> num_skips_;
   // Used to avoid nested calls to StartPass.
   bool pass_running_ = false;
   absl::string_view current_pass_;
@@ -94,6 +100,12 @@ void Stats::EndPass(absl::string_view pass_name) {
   passes_.push_back(PassInfo(current_pass_, duration_ms));
 }
 
+void Stats::SkipPass(absl::string_view pass_name) {
+  CHECK(!pass_running_) << "Can't skip " << pass_name << " while running "
+                        << current_pass_;
+  ++num_skips_[pass_name];
+}
+
 void Stats::CompilationReport() {
   CHECK(!pass_running_) << "EndPass never called for " << current_pass_;
   absl::flat_hash_map<absl::string_view, PassInfo> summary;
@@ -122,9 +134,11 @@ void Stats::CompilationReport() {
            std::make_pair(a.duration_ms, b.name);
   });
   LOG(INFO) << "Total runtime (ms) of HLO passes: " << total_duration;
-  LOG(INFO) << "Pass name, num runs, time (ms)";
+  LOG(INFO) << "Pass name, num runs, num skips, time (ms)";
   for (auto& pass_info : sorted_summary) {
+    auto it = num_skips_.find(pass_info.name);
     LOG(INFO) << pass_info.name << ", " << pass_info.num_runs << ", "
+              << (it == num_skips_.end() ? 0 : it->second) << ", "
               << pass_info.duration_ms;
   }
 }
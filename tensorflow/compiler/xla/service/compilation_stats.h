@@ -25,9 +25,10 @@ namespace xla {
 
 // This class is used to collect information about HLO passes and print some
 // statistics at the end of compilation. From HloPassPipeline, we call StartPass
-// before the execution of a pass, and EndPass after. Currently, we only collect
-// timing information and how many times each pass was run. In the future, we
-// can add more things, such as the size of the HLO graph after each pass.
+// before the execution of a pass, and EndPass after, or SkipPass if the pass is
+// skipped. Currently, we only collect timing information and how many times
+// each pass was run or skipped. In the future, we can add more things, such as
+// the size of the HLO graph after each pass.
 class CompilationStats {
  public:
   virtual ~CompilationStats() = default;
@@ -40,6 +41,9 @@ class CompilationStats {
 
   virtual void EndPass(absl::string_view pass_name) = 0;
 
+  // Called instead of StartPass and EndPass when the pipeline skips a pass.
+  virtual void SkipPass(absl::string_view pass_name) = 0;
+
   virtual void CompilationReport() = 0;
 };
 
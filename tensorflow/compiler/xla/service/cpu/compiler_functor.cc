@@ -23,7 +23,9 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/LegacyPassManager.h"
@@ -42,6 +44,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -92,6 +97,16 @@ std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::operator()(
     pre_optimization_hook_(module);
   }
 
+  uint64 cache_key = 0;
+  if (!persistent_cache_dir_.empty()) {
+    cache_key = PersistentCacheKey(module);
+    if (std::unique_ptr<llvm::MemoryBuffer> cached =
+            LookupPersistentCache(cache_key)) {
+      RunPostCodegenHook(*cached);
+      return cached;
+    }
+  }
+
   // Add the appropriate TargetLibraryInfo and TargetTransformInfo.
   AddTargetInfoPasses(&module_passes);
 
@@ -145,19 +160,109 @@ std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::operator()(
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer(
       new llvm::SmallVectorMemoryBuffer(std::move(stream_buffer)));
 
-  if (post_codegen_hook_) {
-    llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
-        llvm::object::ObjectFile::createObjectFile(*memory_buffer);
-    if (obj_file) {
-      post_codegen_hook_(*obj_file.get());
-    } else {
-      LOG(WARNING) << "Could convert memory buffer to object file!";
-    }
+  if (!persistent_cache_dir_.empty()) {
+    AddToPersistentCache(cache_key, *memory_buffer);
   }
+  RunPostCodegenHook(*memory_buffer);
 
   return memory_buffer;
 }
 
+void CompilerFunctor::RunPostCodegenHook(
+    const llvm::MemoryBuffer& object) const {
+  if (!post_codegen_hook_) {
+    return;
+  }
+  llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
+      llvm::object::ObjectFile::createObjectFile(object.getMemBufferRef());
+  if (obj_file) {
+    post_codegen_hook_(*obj_file.get());
+  } else {
+    llvm::consumeError(obj_file.takeError());
+    LOG(WARNING) << "Could convert memory buffer to object file!";
+  }
+}
+
+uint64 CompilerFunctor::PersistentCacheKey(const llvm::Module& module) const {
+  uint64 key = tensorflow::Fingerprint64(llvm_ir::DumpModuleToString(module));
+  key = tensorflow::FingerprintCat64(
+      key, tensorflow::Fingerprint64(LLVM_VERSION_STRING));
+  key = tensorflow::FingerprintCat64(
+      key, tensorflow::Fingerprint64(
+               target_machine_->getTargetTriple().getTriple()));
+  key = tensorflow::FingerprintCat64(
+      key, tensorflow::Fingerprint64(target_machine_->getTargetCPU().str()));
+  key = tensorflow::FingerprintCat64(
+      key, tensorflow::Fingerprint64(
+               target_machine_->getTargetFeatureString().str()));
+  key = tensorflow::FingerprintCat64(key, opt_level_);
+  key = tensorflow::FingerprintCat64(key, optimize_for_size_);
+  key = tensorflow::FingerprintCat64(key, disable_expensive_passes_);
+  const bool fast_math_flags[] = {
+      fast_math_flags_.allowReassoc(),    fast_math_flags_.noNaNs(),
+      fast_math_flags_.noInfs(),          fast_math_flags_.noSignedZeros(),
+      fast_math_flags_.allowReciprocal(), fast_math_flags_.allowContract(),
+      fast_math_flags_.approxFunc()};
+  for (bool flag : fast_math_flags) {
+    key = tensorflow::FingerprintCat64(key, flag);
+  }
+  return key;
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompilerFunctor::LookupPersistentCache(
+    uint64 key) const {
+  const string path =
+      tensorflow::io::JoinPath(persistent_cache_dir_, absl::StrCat(key, ".o"));
+  string object;
+  if (!tensorflow::ReadFileToString(tensorflow::Env::Default(), path, &object)
+           .ok()) {
+    VLOG(2) << "Object file " << path << " is not in the persistent cache.";
+    return nullptr;
+  }
+  std::unique_ptr<llvm::MemoryBuffer> buffer =
+      llvm::MemoryBuffer::getMemBufferCopy(object);
+  // The entry may have been truncated or otherwise damaged on disk, in which
+  // case it is recompiled and overwritten.
+  llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
+      llvm::object::ObjectFile::createObjectFile(buffer->getMemBufferRef());
+  if (!obj_file) {
+    LOG(WARNING) << "Ignoring invalid object file " << path
+                 << " in the persistent cache: "
+                 << llvm::toString(obj_file.takeError());
+    return nullptr;
+  }
+  VLOG(1) << "Loaded object file " << path << " from the persistent cache.";
+  return buffer;
+}
+
+void CompilerFunctor::AddToPersistentCache(
+    uint64 key, const llvm::MemoryBuffer& object) const {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  // Write to a temporary file first and rename it, so that concurrent
+  // compilations in other processes never read a partially written entry.
+  string tmp_path = tensorflow::io::JoinPath(persistent_cache_dir_, "!");
+  if (!env->CreateUniqueFileName(&tmp_path, ".o")) {
+    LOG(WARNING) << "Cannot create a temporary file name in the persistent "
+                 << "cache " << persistent_cache_dir_;
+    return;
+  }
+  const string path =
+      tensorflow::io::JoinPath(persistent_cache_dir_, absl::StrCat(key, ".o"));
+  Status status = tensorflow::WriteStringToFile(
+      env, tmp_path,
+      absl::string_view(object.getBufferStart(), object.getBufferSize()));
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Cannot add " << path << " to the persistent cache: "
+                 << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+    return;
+  }
+  VLOG(1) << "Added object file " << path << " to the persistent cache.";
+}
+
 static std::vector<llvm::VecDesc> VectorFunctionsForTargetLibraryInfoImpl() {
   std::vector<llvm::VecDesc> result = {
       {"tanhf", runtime::kTanhV4F32SymbolName, 4},
@@ -22,6 +22,7 @@ limitations under the License.
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/llvm_compiler.h"
+#include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -38,7 +39,8 @@ class CompilerFunctor {
       LLVMCompiler::ModuleHook pre_optimization_hook = nullptr,
       LLVMCompiler::ModuleHook post_optimization_hook = nullptr,
       std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook =
-          nullptr)
+          nullptr,
+      string persistent_cache_dir = "")
       : target_machine_(target_machine),
         opt_level_(opt_level),
         optimize_for_size_(optimize_for_size),
@@ -46,9 +48,17 @@ class CompilerFunctor {
         fast_math_flags_(fast_math_flags),
         pre_optimization_hook_(std::move(pre_optimization_hook)),
         post_optimization_hook_(std::move(post_optimization_hook)),
-        post_codegen_hook_(std::move(post_codegen_hook)) {}
+        post_codegen_hook_(std::move(post_codegen_hook)),
+        persistent_cache_dir_(std::move(persistent_cache_dir)) {}
 
   // Compile a Module to an ObjectFile.
+  //
+  // If a persistent cache directory was given, the object file is looked up
+  // there first, keyed by the unoptimized IR and the code generation options,
+  // and newly compiled object files are added to it. On a cache hit the LLVM
+  // optimizer and code generator are skipped, so the post-optimization hook
+  // does not run. Cached files that do not parse as object files are
+  // recompiled and replaced.
   std::unique_ptr<llvm::MemoryBuffer> operator()(
       llvm::Module& module) const;  // NOLINT
 
@@ -62,6 +72,19 @@ class CompilerFunctor {
                              llvm::legacy::FunctionPassManager* function_passes,
                              unsigned opt_level, unsigned size_level) const;
 
+  // Returns the key of `module` in the persistent cache.
+  uint64 PersistentCacheKey(const llvm::Module& module) const;
+
+  // Reads the object file cached under `key`, or returns nullptr if there is
+  // none or it is not a valid object file.
+  std::unique_ptr<llvm::MemoryBuffer> LookupPersistentCache(uint64 key) const;
+
+  // Stores `object` under `key`. Failures are logged and otherwise ignored.
+  void AddToPersistentCache(uint64 key, const llvm::MemoryBuffer& object) const;
+
+  // Runs the post codegen hook, if any, on `object`.
+  void RunPostCodegenHook(const llvm::MemoryBuffer& object) const;
+
   llvm::TargetMachine* target_machine_;
   const unsigned opt_level_;
   const bool optimize_for_size_;
@@ -70,6 +93,7 @@ class CompilerFunctor {
   LLVMCompiler::ModuleHook pre_optimization_hook_;
   LLVMCompiler::ModuleHook post_optimization_hook_;
   std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook_;
+  const string persistent_cache_dir_;
 };
 
 }  // namespace cpu
@@ -0,0 +1,143 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/TargetSelect.h"
+#include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CompilerFunctorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    target_machine_ = SimpleOrcJIT::InferTargetMachineForJIT(
+        llvm::TargetOptions(), llvm::CodeGenOpt::Default);
+    cache_dir_ = tensorflow::io::JoinPath(
+        tensorflow::testing::TmpDir(),
+        ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    TF_ASSERT_OK(tensorflow::Env::Default()->RecursivelyCreateDir(cache_dir_));
+  }
+
+  // Compiles a module whose function "f" returns `value`, and returns the
+  // object file. `optimized` is set to whether the module went through the
+  // LLVM optimizer, i.e. whether it missed the cache.
+  string Compile(int value, bool* optimized) {
+    llvm::LLVMContext context;
+    llvm::Module module("compiler_functor_test", context);
+    llvm::Function* function = llvm::Function::Create(
+        llvm::FunctionType::get(llvm::Type::getInt32Ty(context), false),
+        llvm::GlobalValue::ExternalLinkage, "f", &module);
+    llvm::IRBuilder<> builder(
+        llvm::BasicBlock::Create(context, "entry", function));
+    builder.CreateRet(builder.getInt32(value));
+
+    *optimized = false;
+    CompilerFunctor compiler(
+        target_machine_.get(), /*opt_level=*/2, /*optimize_for_size=*/false,
+        /*disable_expensive_passes=*/false, llvm::FastMathFlags(),
+        /*pre_optimization_hook=*/nullptr,
+        /*post_optimization_hook=*/
+        [optimized](const llvm::Module&) { *optimized = true; },
+        /*post_codegen_hook=*/nullptr, cache_dir_);
+    std::unique_ptr<llvm::MemoryBuffer> object = compiler(module);
+    return string(object->getBufferStart(), object->getBufferSize());
+  }
+
+  // Returns the paths of the files in the cache directory.
+  std::vector<string> CacheFiles() {
+    std::vector<string> children;
+    TF_CHECK_OK(tensorflow::Env::Default()->GetChildren(cache_dir_, &children));
+    std::vector<string> paths;
+    for (const string& child : children) {
+      paths.push_back(tensorflow::io::JoinPath(cache_dir_, child));
+    }
+    return paths;
+  }
+
+  std::unique_ptr<llvm::TargetMachine> target_machine_;
+  string cache_dir_;
+};
+
+TEST_F(CompilerFunctorTest, MissThenHit) {
+  bool optimized;
+  const string object = Compile(42, &optimized);
+  EXPECT_TRUE(optimized);
+  std::vector<string> files = CacheFiles();
+  ASSERT_EQ(files.size(), 1);
+  string cached;
+  TF_ASSERT_OK(tensorflow::ReadFileToString(tensorflow::Env::Default(),
+                                            files[0], &cached));
+  EXPECT_EQ(cached, object);
+
+  // The same module is loaded from the cache.
+  EXPECT_EQ(Compile(42, &optimized), object);
+  EXPECT_FALSE(optimized);
+  EXPECT_EQ(CacheFiles().size(), 1);
+
+  // Another module misses and gets its own entry.
+  EXPECT_NE(Compile(43, &optimized), object);
+  EXPECT_TRUE(optimized);
+  EXPECT_EQ(CacheFiles().size(), 2);
+}
+
+TEST_F(CompilerFunctorTest, CorruptEntryIsRecompiled) {
+  bool optimized;
+  const string object = Compile(42, &optimized);
+  std::vector<string> files = CacheFiles();
+  ASSERT_EQ(files.size(), 1);
+
+  // A truncated object file is not used, and is replaced.
+  TF_ASSERT_OK(tensorflow::WriteStringToFile(
+      tensorflow::Env::Default(), files[0], object.substr(0, 16)));
+  EXPECT_EQ(Compile(42, &optimized), object);
+  EXPECT_TRUE(optimized);
+  EXPECT_EQ(CacheFiles(), files);
+  string cached;
+  TF_ASSERT_OK(tensorflow::ReadFileToString(tensorflow::Env::Default(),
+                                            files[0], &cached));
+  EXPECT_EQ(cached, object);
+
+  // So is a file that is not an object file at all.
+  TF_ASSERT_OK(tensorflow::WriteStringToFile(tensorflow::Env::Default(),
+                                             files[0], "not an object file"));
+  EXPECT_EQ(Compile(42, &optimized), object);
+  EXPECT_TRUE(optimized);
+
+  // The replaced entry is then a hit again.
+  EXPECT_EQ(Compile(42, &optimized), object);
+  EXPECT_FALSE(optimized);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
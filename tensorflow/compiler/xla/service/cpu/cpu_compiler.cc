@@ -73,6 +73,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/dump.h"
 #include "tensorflow/compiler/xla/service/dynamic_index_splitter.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
+#include "tensorflow/compiler/xla/service/fusion_cost_model.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
@@ -112,7 +113,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/dynamic_annotations.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace xla {
 namespace cpu {
@@ -231,6 +235,25 @@ class CollectProfileCandidates : public DfsHloVisitorWithDefault {
   const std::unordered_map<const HloInstruction*, int64>& assigned_indices_;
 };
 
+// Returns the fusion cost model for the roofline of a single core, which
+// computes a fused loop: one FMA per vector register and cycle at the nominal
+// frequency, against the memory bandwidth one core typically sustains.
+std::unique_ptr<FusionCostModel> CreateFusionCostModel(
+    const TargetMachineFeatures& target_machine_features) {
+  constexpr double kBytesPerSecondPerCore = 10e9;
+  constexpr double kMinCyclesPerSecond = 1e9;
+  const int vector_floats = std::max(
+      1, target_machine_features.vectorization_factor_in_bytes() /
+             static_cast<int>(sizeof(float)));
+  FusionCostModel::Roofline roofline;
+  roofline.flops_per_second =
+      2 * vector_floats *
+      std::max(tensorflow::port::NominalCPUFrequency(), kMinCyclesPerSecond);
+  roofline.bytes_per_second = kBytesPerSecondPerCore;
+  return absl::make_unique<FusionCostModel>(CpuExecutable::ShapeSizeBytes,
+                                            roofline);
+}
+
 }  // namespace
 
 Status CpuCompiler::RunHloPassesThroughLayoutAssn(
@@ -329,7 +352,12 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
       module->mutable_entry_computation_layout(),
       LayoutAssignment::InstructionCanChangeLayout, target_machine_features);
 
-  pipeline.AddPass<CpuInstructionFusion>();
+  if (module->config().debug_options().xla_fusion_use_cost_model()) {
+    pipeline.AddPass<CpuInstructionFusion>(
+        CreateFusionCostModel(*target_machine_features));
+  } else {
+    pipeline.AddPass<CpuInstructionFusion>();
+  }
 
   return pipeline.Run(module).status();
 }
@@ -588,7 +616,8 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
       module->config().debug_options().xla_llvm_disable_expensive_passes(),
       llvm_ir::GetCpuFastMathFlags(module->config()), pre_optimization_ir_hook,
       post_optimization_ir_hook,
-      OrcJITPostCompilationHook::Create(module.get()));
+      OrcJITPostCompilationHook::Create(module.get()),
+      module->config().debug_options().xla_cpu_persistent_cache_dir());
   llvm_module->setDataLayout(jit->data_layout());
   llvm_module->setTargetTriple(jit->target_triple().getTriple());
 
@@ -609,6 +638,8 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   // ownership is std::moved.
   const bool embed_ir_in_executable =
       module->config().debug_options().xla_embed_ir_in_executable();
+  const int parallel_codegen_split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
 
   // Select an order for emitting the HLO instructions for each
   // computation. Using this sequence enables tighter buffer liveness analysis
@@ -683,7 +714,15 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
   // JIT compile the LLVM IR module to in-memory machine code.
-  jit->AddModule(std::move(llvm_module));
+  if (parallel_codegen_split_count > 1) {
+    tensorflow::thread::ThreadPool thread_pool(
+        tensorflow::Env::Default(), "xla_cpu_codegen",
+        parallel_codegen_split_count);
+    jit->AddModuleInParallel(std::move(llvm_module),
+                             parallel_codegen_split_count, &thread_pool);
+  } else {
+    jit->AddModule(std::move(llvm_module));
+  }
   cpu_executable.reset(new CpuExecutable(
       std::move(jit), std::move(assignment), std::move(module), function_name,
       std::move(hlo_profile_printer_data), std::move(hlo_profile_index_map)));
@@ -844,7 +883,8 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
                          // TODO(b/66051036): Run full msan for AOT.
                          /*emit_code_for_msan=*/false);
 
-    TF_RETURN_IF_ERROR(ir_emitter.EmitConstantGlobals());
+    TF_RETURN_IF_ERROR(
+        ir_emitter.EmitConstantGlobals(options.share_constants()));
 
     HloComputation* computation = module->entry_computation();
     for (auto embedded_computation :
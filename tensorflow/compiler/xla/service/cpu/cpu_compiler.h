@@ -70,12 +70,21 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   // The relocation model used for compilation.
   RelocationModel relocation_model() const { return relocation_model_; }
 
+  // Whether constants are emitted so that identical ones in different object
+  // files, e.g. the weights of several compilations of one model, are folded
+  // into one by the linker.
+  bool share_constants() const { return share_constants_; }
+  void set_share_constants(bool share_constants) {
+    share_constants_ = share_constants;
+  }
+
  private:
   const string triple_;
   const string cpu_name_;
   const string features_;
   const string entry_point_name_;
   const RelocationModel relocation_model_;
+  bool share_constants_ = false;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {
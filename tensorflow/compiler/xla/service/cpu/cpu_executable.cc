@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/stream_executor/device_memory_allocator.h"
 #include "tensorflow/stream_executor/host/host_stream.h"
 
@@ -203,8 +204,13 @@ Status CpuExecutable::ExecuteComputeFunction(
     VLOG(3) << absl::StrFormat("    profile_counters = %p", profile_counters);
   }
 
-  compute_function_(result_buffer, run_options, nullptr, buffer_pointers.data(),
-                    profile_counters);
+  {
+    tensorflow::profiler::TraceMe hlo_module_activity(
+        [&] { return absl::StrCat(module().name(), ":XLA CPU module"); },
+        tensorflow::profiler::TraceMeLevel::kInfo);
+    compute_function_(result_buffer, run_options, nullptr,
+                      buffer_pointers.data(), profile_counters);
+  }
 
   uint64 end_micros = tensorflow::Env::Default()->NowMicros();
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
 
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
@@ -66,6 +68,42 @@ bool CanBeOutputFusedIntoSomeOperand(const HloInstruction* consumer) {
          (CanBeOutputFused(consumer->operand(0), consumer) ||
           CanBeOutputFused(consumer->operand(1), consumer));
 }
+
+// Returns true if `hlo` widens a row-major int8 matrix to int32.
+bool IsInt8MatrixConversion(const HloInstruction* hlo) {
+  if (hlo->opcode() != HloOpcode::kConvert) {
+    return false;
+  }
+  const Shape& operand_shape = hlo->operand(0)->shape();
+  return operand_shape.element_type() == S8 &&
+         hlo->shape().element_type() == S32 && operand_shape.rank() == 2 &&
+         LayoutUtil::IsMonotonicWithDim0Major(operand_shape.layout());
+}
+
+// Returns true if the int8 to int32 conversion `producer` can be fused into
+// the int32 matrix-matrix product `consumer`, so that the runtime GEMM reads
+// the int8 operands directly. `consumer` is either a dot whose operands are
+// both such conversions, or the output fusion of a dot into which the other
+// conversion has already been fused.
+bool CanBeInt8DotFused(const HloInstruction* producer,
+                       const HloInstruction* consumer) {
+  if (!IsInt8MatrixConversion(producer)) {
+    return false;
+  }
+  if (consumer->opcode() == HloOpcode::kFusion) {
+    const HloInstruction* root = consumer->fused_expression_root();
+    return consumer->IsOutputFusion() && root->opcode() == HloOpcode::kDot &&
+           absl::c_any_of(root->operands(), [](const HloInstruction* operand) {
+             return operand->opcode() == HloOpcode::kConvert;
+           });
+  }
+  return consumer->opcode() == HloOpcode::kDot &&
+         consumer->shape().element_type() == S32 &&
+         consumer->shape().rank() == 2 &&
+         consumer->dot_dimension_numbers().lhs_batch_dimensions_size() == 0 &&
+         IsInt8MatrixConversion(consumer->operand(0)) &&
+         IsInt8MatrixConversion(consumer->operand(1));
+}
 }  // namespace
 
 bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
@@ -81,6 +119,11 @@ bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
     return true;
   }
 
+  if (CanBeInt8DotFused(producer, consumer)) {
+    VLOG(2) << "Fusion OK: Can fuse int8 conversion into dot.";
+    return true;
+  }
+
   if (CanBeOutputFusedIntoSomeOperand(producer)) {
     VLOG(2)
         << "Bailing because producer can be output-fused into some operand.";
@@ -93,8 +136,8 @@ bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
   }
 
   // Cost condition: not fuse (simple, expensive producers) and (consumers who
-  // reuse operand elements).
-  if (producer->opcode() != HloOpcode::kFusion &&
+  // reuse operand elements). The cost model, if any, weighs these itself.
+  if (!has_cost_model() && producer->opcode() != HloOpcode::kFusion &&
       consumer->ReusesOperandElements(operand_index) &&
       is_expensive(*producer)) {
     VLOG(2) << "Fusion is not profitable.";
@@ -198,7 +241,8 @@ bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
 
 HloInstruction::FusionKind CpuInstructionFusion::ChooseKind(
     const HloInstruction* producer, const HloInstruction* consumer) {
-  return CanBeOutputFused(producer, consumer)
+  return CanBeOutputFused(producer, consumer) ||
+                 CanBeInt8DotFused(producer, consumer)
              ? HloInstruction::FusionKind::kOutput
              : HloInstruction::FusionKind::kLoop;
 }
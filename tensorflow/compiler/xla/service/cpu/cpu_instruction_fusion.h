@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_INSTRUCTION_FUSION_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_INSTRUCTION_FUSION_H_
 
+#include <memory>
+#include <utility>
+
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/service/fusion_cost_model.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
@@ -26,8 +30,11 @@ namespace cpu {
 
 class CpuInstructionFusion : public InstructionFusion {
  public:
-  CpuInstructionFusion()
-      : InstructionFusion(CpuInstructionFusion::IsExpensive) {}
+  explicit CpuInstructionFusion(
+      std::unique_ptr<FusionCostModel> cost_model = nullptr)
+      : InstructionFusion(CpuInstructionFusion::IsExpensive,
+                          /*may_duplicate=*/true, FusionConfigCollection::kOff,
+                          std::move(cost_model)) {}
   ~CpuInstructionFusion() override = default;
 
   StatusOr<bool> Run(HloModule* module) override {
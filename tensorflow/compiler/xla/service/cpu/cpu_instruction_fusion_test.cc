@@ -257,6 +257,32 @@ ENTRY DotOperationFusion_TransposeFusion {
                       /*lhs_contracting_dim=*/1, /*rhs_contracting_dim=*/0));
 }
 
+TEST_F(InstructionFusionTest, DotOperationFusion_Int8) {
+  string hlo_string = R"(
+HloModule DotOperationFusion_Int8
+
+ENTRY DotOperationFusion_Int8 {
+  arg0 = s8[64,256] parameter(0)
+  arg1 = s8[256,128] parameter(1)
+  convert0 = s32[64,256] convert(arg0)
+  convert1 = s32[256,128] convert(arg1)
+  ROOT dot = s32[64,128] dot(convert0, convert1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  EXPECT_TRUE(CpuInstructionFusion().Run(module.get()).ValueOrDie());
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Fusion());
+  EXPECT_THAT(root->operands(), ::testing::UnorderedElementsAre(
+                                    op::Parameter(0), op::Parameter(1)));
+  EXPECT_EQ(root->fusion_kind(), HloInstruction::FusionKind::kOutput);
+  EXPECT_THAT(root->fused_expression_root(),
+              op::Dot(op::Convert(op::Parameter()),
+                      op::Convert(op::Parameter())));
+}
+
 class OpcodeFusionTest : public InstructionFusionTest {
  protected:
   // Runs CPU instruction fusion on the given module, and tests that the result
@@ -18,12 +18,15 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/array2d.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul_mkl.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
@@ -236,5 +239,44 @@ INSTANTIATE_TEST_CASE_P(MKLMatMulTestInstantiaion, MKLMatMulTest,
                         MKLMatMulTest::Name);
 #endif  // INTEL_MKL
 
+// Increments the elements of the int32 array in buffer_table[0] in the range
+// given by the partition.
+void IncrementPartition(void* /*result*/, const void* /*run_options*/,
+                        const void** /*params*/, void** buffer_table,
+                        int64* partition, uint64* /*prof_counters*/) {
+  int32* elements = static_cast<int32*>(buffer_table[0]);
+  for (int64 i = partition[0]; i < partition[1]; ++i) {
+    ++elements[i];
+  }
+}
+
+TEST_F(CpuRuntimeTest, ParallelForkJoinRunsEveryPartitionOnce) {
+  // More partitions than threads, so threads must run several of them.
+  constexpr int32 kNumPartitions = 64;
+  constexpr int64 kPartitionSize = 100;
+  Eigen::ThreadPool pool(4);
+  Eigen::ThreadPoolDevice device(&pool, pool.NumThreads());
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+
+  std::vector<int64> partitions;
+  for (int64 i = 0; i < kNumPartitions; ++i) {
+    partitions.push_back(i * kPartitionSize);
+    partitions.push_back((i + 1) * kPartitionSize);
+  }
+  std::vector<int32> elements(kNumPartitions * kPartitionSize, 0);
+  void* buffer_table[] = {elements.data()};
+
+  __xla_cpu_runtime_ParallelForkJoin(
+      /*result_ptr=*/nullptr, &run_options, /*params=*/nullptr, buffer_table,
+      /*prof_counters=*/nullptr, kNumPartitions, partitions.data(),
+      /*num_partitioned_dims=*/1,
+      reinterpret_cast<void*>(&IncrementPartition));
+
+  for (int32 element : elements) {
+    EXPECT_EQ(element, 1);
+  }
+}
+
 }  // namespace
 }  // namespace xla
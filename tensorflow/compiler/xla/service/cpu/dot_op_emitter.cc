@@ -404,6 +404,15 @@ Status DotOpEmitter::Emit() {
     return EmitScalarDot();
   }
 
+  // Fused int8 dots read their int8 operands directly, which only the runtime
+  // GEMM supports.
+  if (lhs_shape.element_type() == S8) {
+    TF_RET_CHECK(rhs_shape.element_type() == S8 &&
+                 target_array_.GetShape().element_type() == S32 &&
+                 addend_array_ == nullptr);
+    return EmitCallToRuntime();
+  }
+
   switch (GetDotImplementationStrategy(hlo_module_config_, dot_info_,
                                        target_machine_features_)) {
     case DotImplementationStrategy::kNaiveLlvmIr:
@@ -651,13 +660,23 @@ Status DotOpEmitter::EmitCallToRuntime() {
                            PrimitiveType_Name(type));
   }
 
+  // The operands have the type of the result, except for int8 dots.
+  llvm::Type* operand_type = float_type;
+  if (lhs_array_.GetShape().element_type() == S8) {
+    fn_name = multi_threaded
+                  ? runtime::kEigenMatMulS8S32SymbolName
+                  : runtime::kEigenSingleThreadedMatMulS8S32SymbolName;
+    operand_type = b_->getInt8Ty();
+  }
+
   llvm::Type* float_ptr_type = float_type->getPointerTo();
+  llvm::Type* operand_ptr_type = operand_type->getPointerTo();
   llvm::Type* int64_type = b_->getInt64Ty();
   llvm::Type* int32_type = b_->getInt32Ty();
   llvm::Type* int8_ptr_type = b_->getInt8Ty()->getPointerTo();
   llvm::FunctionType* matmul_type = llvm::FunctionType::get(
       b_->getVoidTy(),
-      {int8_ptr_type, float_ptr_type, float_ptr_type, float_ptr_type,
+      {int8_ptr_type, float_ptr_type, operand_ptr_type, operand_ptr_type,
        int64_type, int64_type, int64_type, int32_type, int32_type},
       /*isVarArg=*/false);
 
@@ -702,8 +721,8 @@ Status DotOpEmitter::EmitCallToRuntime() {
       matmul_func,
       {b_->CreateBitCast(executable_run_options_value_, int8_ptr_type),
        b_->CreateBitCast(target_array_.GetBasePointer(), float_ptr_type),
-       b_->CreateBitCast(lhs->GetBasePointer(), float_ptr_type),
-       b_->CreateBitCast(rhs->GetBasePointer(), float_ptr_type),
+       b_->CreateBitCast(lhs->GetBasePointer(), operand_ptr_type),
+       b_->CreateBitCast(rhs->GetBasePointer(), operand_ptr_type),
        b_->getInt64(mat_mult_dims.m), b_->getInt64(mat_mult_dims.n),
        b_->getInt64(mat_mult_dims.k), b_->getInt32(transpose_lhs),
        b_->getInt32(transpose_rhs)});
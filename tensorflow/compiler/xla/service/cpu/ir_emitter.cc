@@ -30,6 +30,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/CodeGen/TargetRegisterInfo.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/BasicBlock.h"
@@ -75,6 +76,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/math/math_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -182,9 +184,10 @@ StatusOr<llvm::Function*> IrEmitter::EmitComputation(
   profiling_state_ = ProfilingState(use_rdtscp);
 
   bool emit_tracing =
-      hlo_module_config_.hlo_profiling_enabled() &&
-      hlo_module_config_.debug_options().xla_backend_extra_options().count(
-          "xla_hlo_trace");
+      hlo_module_config_.debug_options().xla_cpu_enable_xprof_traceme() ||
+      (hlo_module_config_.hlo_profiling_enabled() &&
+       hlo_module_config_.debug_options().xla_backend_extra_options().count(
+           "xla_hlo_trace"));
   tracing_state_.set_enabled(emit_tracing);
 
   TF_RETURN_IF_ERROR(computation->AcceptOrdered(this, instruction_order));
@@ -231,23 +234,55 @@ Status IrEmitter::HandleBitcast(HloInstruction* bitcast) {
   return Status::OK();
 }
 
-llvm::Constant* IrEmitter::EmitGlobalForLiteral(const Literal& literal) {
+llvm::Constant* IrEmitter::EmitGlobalForLiteral(const Literal& literal,
+                                                 bool share_across_objects) {
   llvm::Constant* initializer =
       llvm_ir::ConvertLiteralToIrConstant(literal, module_);
-  llvm::GlobalVariable* result_global = new llvm::GlobalVariable(
-      /*Module=*/*module_,
-      /*Type=*/initializer->getType(),
-      /*isConstant=*/true,
-      /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
-      /*Initializer=*/initializer,
-      /*Name=*/"");
+  llvm::GlobalVariable* result_global = nullptr;
+  if (share_across_objects && literal.shape().IsArray()) {
+    // Constants with the same shape and contents get the same name, and the
+    // linker folds their definitions into one.
+    const tensorflow::Fprint128 data_fingerprint = tensorflow::Fingerprint128(
+        absl::string_view(static_cast<const char*>(literal.untyped_data()),
+                          literal.size_bytes()));
+    const uint64 shape_fingerprint = tensorflow::Fingerprint64(
+        ShapeUtil::HumanStringWithLayout(literal.shape()));
+    string name = absl::StrCat(
+        "__xla_constant_", absl::Hex(data_fingerprint.high64, absl::kZeroPad16),
+        absl::Hex(data_fingerprint.low64, absl::kZeroPad16), "_",
+        absl::Hex(shape_fingerprint, absl::kZeroPad16));
+    result_global = module_->getGlobalVariable(name);
+    if (result_global != nullptr) {
+      return llvm::ConstantExpr::getBitCast(
+          result_global, IrShapeType(literal.shape())->getPointerTo());
+    }
+    result_global = new llvm::GlobalVariable(
+        /*Module=*/*module_,
+        /*Type=*/initializer->getType(),
+        /*isConstant=*/true,
+        /*Linkage=*/llvm::GlobalValue::LinkOnceODRLinkage,
+        /*Initializer=*/initializer,
+        /*Name=*/name);
+    result_global->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    if (llvm::Triple(module_->getTargetTriple()).supportsCOMDAT()) {
+      result_global->setComdat(module_->getOrInsertComdat(name));
+    }
+  } else {
+    result_global = new llvm::GlobalVariable(
+        /*Module=*/*module_,
+        /*Type=*/initializer->getType(),
+        /*isConstant=*/true,
+        /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+        /*Initializer=*/initializer,
+        /*Name=*/"");
+    result_global->setUnnamedAddr(llvm::GlobalVariable::UnnamedAddr::Global);
+  }
   result_global->setAlignment(MinimumAlignmentForShape(literal.shape()));
-  result_global->setUnnamedAddr(llvm::GlobalVariable::UnnamedAddr::Global);
   return llvm::ConstantExpr::getBitCast(
       result_global, IrShapeType(literal.shape())->getPointerTo());
 }
 
-Status IrEmitter::EmitConstantGlobals() {
+Status IrEmitter::EmitConstantGlobals(bool share_across_objects) {
   for (const BufferAllocation& allocation : assignment_.Allocations()) {
     if (!allocation.is_constant()) {
       continue;
@@ -259,7 +294,7 @@ Status IrEmitter::EmitConstantGlobals() {
     if (it != emitted_literals_.end()) {
       global_for_const = it->second;
     } else {
-      global_for_const = EmitGlobalForLiteral(literal);
+      global_for_const = EmitGlobalForLiteral(literal, share_across_objects);
       InsertOrDie(&emitted_literals_, &literal, global_for_const);
     }
 
@@ -2412,6 +2447,9 @@ Status IrEmitter::HandleFusion(HloInstruction* fusion) {
     TF_RETURN_IF_ERROR(fusion->fused_expression_root()->Accept(&fused_emitter));
 
     return EmitTargetElementLoop(fusion, fused_emitter.GetRootGenerator());
+  } else if (fusion->IsOutputFusion() && root->opcode() == HloOpcode::kDot) {
+    VLOG(3) << "HandleFusion int8 dot";
+    return HandleInt8DotFusion(fusion);
   } else if (fusion->IsOutputFusion()) {
     VLOG(3) << "HandleFusion kOutput";
     int64 dot_op_index = root->operand(0)->opcode() == HloOpcode::kDot ? 0 : 1;
@@ -2446,6 +2484,38 @@ Status IrEmitter::HandleFusion(HloInstruction* fusion) {
   }
 }
 
+Status IrEmitter::HandleInt8DotFusion(HloInstruction* fusion) {
+  HloInstruction* dot = fusion->fused_expression_root();
+  // Returns the int8 operand of `fusion` that is converted to the dot operand
+  // `operand`, if the conversion was fused.
+  auto get_int8_operand =
+      [&](const HloInstruction* operand) -> const HloInstruction* {
+    if (operand->opcode() != HloOpcode::kConvert ||
+        operand->operand(0)->opcode() != HloOpcode::kParameter) {
+      return nullptr;
+    }
+    return fusion->operand(operand->operand(0)->parameter_number());
+  };
+  const HloInstruction* lhs = get_int8_operand(dot->operand(0));
+  const HloInstruction* rhs = get_int8_operand(dot->operand(1));
+
+  if (lhs == nullptr || rhs == nullptr) {
+    // Only one of the conversions was fused, so the runtime GEMM can't read
+    // both operands. Compute the dot elementally instead.
+    CpuElementalIrEmitter elemental_emitter(hlo_module_config_, this, module_);
+    FusedIrEmitter fused_emitter(GetGeneratorForOperandIrArrays(fusion),
+                                 &elemental_emitter);
+    TF_RETURN_IF_ERROR(dot->Accept(&fused_emitter));
+    return EmitTargetElementLoop(fusion, fused_emitter.GetRootGenerator());
+  }
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(fusion));
+  return EmitDotOperation(*dot, GetIrArrayFor(fusion), GetIrArrayFor(lhs),
+                          GetIrArrayFor(rhs), /*addend_array=*/nullptr,
+                          GetExecutableRunOptionsArgument(), &b_,
+                          hlo_module_config_, target_machine_features_);
+}
+
 Status IrEmitter::HandleCall(HloInstruction* call) {
   HloComputation* computation = call->to_apply();
   llvm::Function* call_ir_function = FindOrDie(emitted_functions_, computation);
@@ -3060,7 +3130,17 @@ void IrEmitter::TracingState::EmitTracingStart(llvm::IRBuilder<>* b,
     fn->setDoesNotThrow();
     fn->setOnlyAccessesArgMemory();
   }
-  auto* hlo_name = b->CreateGlobalStringPtr(hlo->name());
+  // Encode the HLO and the TF op it came from as TraceMe metadata.
+  string name = absl::StrCat(hlo->name(), "#hlo_op=", hlo->name(),
+                             ",hlo_module=", hlo->GetModule()->name());
+  if (!hlo->metadata().op_name().empty()) {
+    absl::StrAppend(&name, ",tf_op=", hlo->metadata().op_name());
+  }
+  if (!hlo->metadata().op_type().empty()) {
+    absl::StrAppend(&name, ",tf_op_type=", hlo->metadata().op_type());
+  }
+  absl::StrAppend(&name, "#");
+  auto* hlo_name = b->CreateGlobalStringPtr(name);
   auto* activity_id =
       b->CreateCall(trace_func, {b->CreateBitCast(run_options, void_ptr_type),
                                  b->CreateBitCast(hlo_name, int8_ptr_type)});
@@ -3095,12 +3175,35 @@ void IrEmitter::TracingState::EmitTracingEnd(llvm::IRBuilder<>* b,
                 {b->CreateBitCast(run_options, void_ptr_type), activity_id});
 }
 
+bool IrEmitter::ShouldTrace(const HloInstruction& hlo) const {
+  // Trace the same HLOs that the profiler does, if it is enabled.
+  if (!instruction_to_profile_idx_.empty()) {
+    return instruction_to_profile_idx_.count(&hlo);
+  }
+  // Otherwise trace the entry computation, whose instructions run once per
+  // execution, skipping the ones that don't run any code.
+  if (!is_top_level_computation_) {
+    return false;
+  }
+  switch (hlo.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return false;
+    default:
+      return true;
+  }
+}
+
 Status IrEmitter::Preprocess(HloInstruction* hlo) {
   VLOG(3) << "Visiting: " << hlo->ToString();
-  if (instruction_to_profile_idx_.count(hlo)) {
-    // Only trace the same HLOs that the profiler does.
+  if (ShouldTrace(*hlo)) {
     tracing_state_.EmitTracingStart(&b_, hlo,
                                     GetExecutableRunOptionsArgument());
+  }
+  if (instruction_to_profile_idx_.count(hlo)) {
     profiling_state_.RecordCycleStart(&b_, hlo);
   }
   return Status::OK();
@@ -3110,8 +3213,7 @@ Status IrEmitter::Postprocess(HloInstruction* hlo) {
   if (auto* prof_counter = GetProfileCounterFor(*hlo)) {
     profiling_state_.RecordCycleDelta(&b_, hlo, prof_counter);
   }
-  // Only trace the same HLOs that the profiler does.
-  if (instruction_to_profile_idx_.count(hlo)) {
+  if (ShouldTrace(*hlo)) {
     tracing_state_.EmitTracingEnd(&b_, hlo, GetExecutableRunOptionsArgument());
   }
   return Status::OK();
@@ -111,7 +111,11 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   llvm::IRBuilder<>* builder() { return &b_; }
 
   // Emit an LLVM global variable for every constant buffer allocation.
-  Status EmitConstantGlobals();
+  //
+  // If `share_across_objects` is true, array constants are named after their
+  // contents and given linkonce_odr linkage, so that the linker keeps a
+  // single copy of each across all the object files linked into a binary.
+  Status EmitConstantGlobals(bool share_across_objects = false);
 
   // Emit code to map one element according to `map_instr`.
   llvm::Value* EmitElementalMap(
@@ -190,6 +194,10 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   Status Preprocess(HloInstruction* hlo) override;
   Status Postprocess(HloInstruction* hlo) override;
 
+  // Returns whether a TraceMe activity is recorded around `hlo` when tracing
+  // is enabled.
+  bool ShouldTrace(const HloInstruction& hlo) const;
+
   // A convenient helper for calling BufferAssignment::GetUniqueSlice.
   BufferAllocation::Slice GetAllocationSlice(
       const HloInstruction& hlo, const ShapeIndex& index = {}) const {
@@ -200,6 +208,10 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   Status HandleAllReduceSingleReplica(HloInstruction* crs);
   Status HandleAllReduceMultipleReplica(HloInstruction* crs);
 
+  // Emits an output fusion of an int32 dot with the int8 to int32 conversions
+  // of its operands, created by CpuInstructionFusion.
+  Status HandleInt8DotFusion(HloInstruction* fusion);
+
   // Private helper to initialize an IR function for the computation.
   void InitializeIrFunction(const string& function_name);
 
@@ -581,7 +593,8 @@ class IrEmitter : public DfsHloVisitorWithDefault,
                            llvm::Value* program_buffer_address);
 
   // Returns a ConstExpr bitcast.
-  llvm::Constant* EmitGlobalForLiteral(const Literal& literal);
+  llvm::Constant* EmitGlobalForLiteral(const Literal& literal,
+                                       bool share_across_objects);
 
   const HloModuleConfig& hlo_module_config_;
 
@@ -0,0 +1,139 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/module_splitter.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/GlobalValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Functions with local linkage and at most this many instructions are cloned
+// into every part instead of being assigned to a single one.
+constexpr int64 kMaxClonedFunctionSize = 64;
+
+int64 InstructionCount(const llvm::Function& function) {
+  int64 count = 0;
+  for (const llvm::BasicBlock& block : function) {
+    count += block.size();
+  }
+  return count;
+}
+
+// Makes `value` visible to the other parts.
+void Externalize(llvm::GlobalValue* value) {
+  if (!value->hasLocalLinkage()) {
+    return;
+  }
+  if (!value->hasName()) {
+    value->setName("__xla_cpu_split");
+  }
+  value->setLinkage(llvm::GlobalValue::ExternalLinkage);
+}
+
+}  // namespace
+
+std::vector<string> SplitModuleForParallelCodegen(llvm::Module* module,
+                                                  int num_parts) {
+  // Appending globals such as llvm.used can't be defined in only one part, and
+  // aliases would have to be placed with their aliasees.
+  if (!module->alias_empty() || !module->ifunc_empty()) {
+    return {};
+  }
+  for (const llvm::GlobalVariable& global : module->globals()) {
+    if (global.hasAppendingLinkage()) {
+      return {};
+    }
+  }
+
+  absl::flat_hash_set<const llvm::GlobalValue*> cloned;
+  std::vector<std::pair<int64, llvm::Function*>> assigned;
+  for (llvm::Function& function : *module) {
+    if (function.isDeclaration()) {
+      continue;
+    }
+    int64 size = InstructionCount(function);
+    if (function.hasLocalLinkage() && size <= kMaxClonedFunctionSize) {
+      cloned.insert(&function);
+    } else {
+      assigned.push_back({size, &function});
+    }
+  }
+  num_parts = std::min<int64>(num_parts, assigned.size());
+  if (num_parts < 2) {
+    return {};
+  }
+
+  // Assign the largest functions first, each to the smallest part so far.
+  std::stable_sort(assigned.begin(), assigned.end(),
+                   [](const std::pair<int64, llvm::Function*>& a,
+                      const std::pair<int64, llvm::Function*>& b) {
+                     return a.first > b.first;
+                   });
+  absl::flat_hash_map<const llvm::GlobalValue*, int> part_of;
+  std::vector<int64> part_sizes(num_parts, 0);
+  for (const auto& function : assigned) {
+    int part = std::min_element(part_sizes.begin(), part_sizes.end()) -
+               part_sizes.begin();
+    part_sizes[part] += function.first;
+    part_of[function.second] = part;
+    Externalize(function.second);
+  }
+  for (llvm::GlobalVariable& global : module->globals()) {
+    if (!global.isDeclaration()) {
+      part_of[&global] = 0;
+      Externalize(&global);
+    }
+  }
+
+  std::vector<string> parts;
+  for (int part = 0; part < num_parts; ++part) {
+    llvm::ValueToValueMapTy value_map;
+    std::unique_ptr<llvm::Module> part_module = llvm::CloneModule(
+        *module, value_map, [&](const llvm::GlobalValue* value) {
+          if (cloned.contains(value)) {
+            return true;
+          }
+          auto it = part_of.find(value);
+          return it != part_of.end() && it->second == part;
+        });
+    part_module->setModuleIdentifier(
+        absl::StrCat(module->getModuleIdentifier(), ".", part));
+
+    string bitcode;
+    llvm::raw_string_ostream stream(bitcode);
+    llvm::WriteBitcodeToFile(*part_module, stream);
+    stream.flush();
+    parts.push_back(std::move(bitcode));
+    VLOG(2) << "Part " << part << " of " << module->getModuleIdentifier()
+            << " has " << part_sizes[part] << " instructions";
+  }
+  return parts;
+}
+
+}  // namespace cpu
+}  // namespace xla
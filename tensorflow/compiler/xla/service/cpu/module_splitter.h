@@ -0,0 +1,45 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_SPLITTER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_SPLITTER_H_
+
+#include <vector>
+
+#include "llvm/IR/Module.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+namespace cpu {
+
+// Splits `module` into at most `num_parts` modules that can be optimized and
+// compiled to object files independently, and returns them serialized as
+// bitcode so that each one can be loaded into its own LLVMContext. Returns an
+// empty vector, leaving `module` untouched, if it has too few functions to be
+// split or contains constructs that cannot be split.
+//
+// Small functions with local linkage are cloned into every part so that they
+// can still be inlined. Every other function is defined in exactly one part,
+// balancing the number of instructions per part, and all global variables are
+// defined in the first part. The remaining symbols with local linkage are
+// given external linkage in `module`, so the object files compiled from the
+// parts must be linked together.
+std::vector<string> SplitModuleForParallelCodegen(llvm::Module* module,
+                                                  int num_parts);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_SPLITTER_H_
@@ -51,6 +51,9 @@ class SimpleCostModel : public ParallelCostModel {
 
 class DefaultCostModel : public ParallelCostModel {
  public:
+  // The maximum number of tasks per thread for compute bound instructions.
+  static constexpr int64 kTasksPerThread = 4;
+
   DefaultCostModel(const int64 max_parallelism,
                    const HloCostAnalysis::ShapeSizeFunction& shape_size,
                    std::unique_ptr<HloCostAnalysis> cost_analysis)
@@ -82,8 +85,11 @@ class DefaultCostModel : public ParallelCostModel {
       instruction_cost = shape_size_(instruction->shape());
       min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     } else {
-      // Use max parallelism for compute bound instructions.
-      max_parallelism = max_parallelism_;
+      // Split compute bound instructions into several tasks per thread. The
+      // fork/join runtime hands tasks out to threads as they become free, so
+      // smaller tasks balance the load between threads that start late or
+      // run slowly.
+      max_parallelism = max_parallelism_ * kTasksPerThread;
       // Calculate the instruction cost in cycles.
       // TODO(b/29630486) Improve on this linear cost model.
       // Consider making 'min_cost_per_thread' be a function of the target
@@ -95,7 +101,7 @@ class DefaultCostModel : public ParallelCostModel {
       // Minimum per-thread cost is 100us of work on a 2GHz core.
       min_cost_per_thread = 100000;
     }
-    // Return target parallel task count in [1, max_parallelism_].
+    // Return target parallel task count in [1, max_parallelism].
     return std::min(max_parallelism,
                     std::max(int64{1}, instruction_cost / min_cost_per_thread));
   }
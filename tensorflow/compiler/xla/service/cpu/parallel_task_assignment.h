@@ -34,7 +34,9 @@ class ParallelCostModel {
 // ParallelTaskAssignment computes parallel task counts for HLOs in 'module'.
 class ParallelTaskAssignment {
  public:
-  // 'max_parallelism': the maximum parallel task count per instruction.
+  // 'max_parallelism': the number of threads available to an instruction.
+  //                    Compute bound instructions may be split into a few
+  //                    tasks per thread.
   // 'shape_size': shape size function used by HloCostAnalysis during parallel
   //               task assignment.
   // 'module': the containing HloModule.
@@ -62,7 +64,7 @@ class ParallelTaskAssignment {
 // a runtime parallel fork/join call.
 class ParallelTaskAssigner : public HloModulePass {
  public:
-  // 'max_parallelism': the maximum parallel task count per instruction.
+  // 'max_parallelism': the number of threads available to an instruction.
   // 'shape_size': shape size function used by HloCostAnalysis during parallel
   //               task assignment.
   ParallelTaskAssigner(const int64 max_parallelism,
@@ -17,6 +17,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/executable_run_options.h"
 #include "tensorflow/core/platform/blocking_counter.h"
@@ -31,9 +35,15 @@ using tensorflow::uint64;
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      int64*, uint64*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+// Calls 'function_ptr' once for each of the 'num_partitions' partitions, using
+// the calling thread and up to 'num_partitions - 1' threads of the intra-op
+// thread pool.
+//
+// Partitions are not bound to threads: every participating thread repeatedly
+// claims the next unclaimed partition until none are left, so threads that
+// start late or run slowly get fewer partitions. The caller returns once every
+// partition has run, without waiting for pool threads that never got to claim
+// one.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -81,24 +91,36 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   // Compute partition stride in 'partitions' array.
   const int64 stride = 2 * num_partitioned_dims;
 
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tensorflow::BlockingCounter bc(num_partitions - 1);
-  for (int32 i = 1; i < num_partitions; ++i) {
-    const int64 offset = i * stride;
+  // Shared with the pool threads, which may only start running after this
+  // function has returned.
+  struct State {
+    explicit State(int32 num_partitions) : done(num_partitions) {}
+    std::atomic<int32> next_partition{0};
+    tensorflow::BlockingCounter done;
+  };
+  auto state = std::make_shared<State>(num_partitions);
+
+  // Runs partitions until there are none left to claim.
+  auto run_partitions = [function, result_ptr, run_options_ptr, buffer_table,
+                         prof_counters, partitions, stride,
+                         num_partitions](State* state) {
+    for (int32 i = state->next_partition.fetch_add(1); i < num_partitions;
+         i = state->next_partition.fetch_add(1)) {
+      function(result_ptr, run_options_ptr, nullptr, buffer_table,
+               &partitions[i * stride], prof_counters);
+      VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+      state->done.DecrementCount();
+    }
+  };
+
+  const int32 num_helpers = std::min<int32>(
+      num_partitions - 1, run_options->intra_op_thread_pool()->numThreads());
+  for (int32 i = 0; i < num_helpers; ++i) {
     run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
+        [state, run_partitions]() { run_partitions(state.get()); });
   }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &partitions[0],
-           prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  run_partitions(state.get());
+  state->done.Wait();
   VLOG(2) << "ParallelForkJoin EXIT";
 }
@@ -25,6 +25,7 @@ limitations under the License.
 
 using tensorflow::int32;
 using tensorflow::int64;
+using tensorflow::int8;
 
 namespace {
 
@@ -81,6 +82,38 @@ void SingleThreadedMatMulDispatch(const void* run_options_ptr, T* out, T* lhs,
                               transpose_lhs, transpose_rhs);
 }
 
+// Multiplies int8 matrices and accumulates the products in int32. The
+// operands are widened while Eigen packs them, so they are only read in int8.
+template <Eigen::AlignmentType Alignment>
+void MatMulS8S32(int32* out, int8* lhs, int8* rhs, int64 m, int64 n, int64 k,
+                 int32 transpose_lhs, int32 transpose_rhs) {
+  int64 lhs_rows = m;
+  int64 lhs_cols = k;
+  if (transpose_lhs) {
+    std::swap(lhs_rows, lhs_cols);
+  }
+
+  int64 rhs_rows = k;
+  int64 rhs_cols = n;
+  if (transpose_rhs) {
+    std::swap(rhs_rows, rhs_cols);
+  }
+
+  const Eigen::TensorMap<Eigen::Tensor<const int8, 2>, Alignment> A(
+      lhs, lhs_rows, lhs_cols);
+  const Eigen::TensorMap<Eigen::Tensor<const int8, 2>, Alignment> B(
+      rhs, rhs_rows, rhs_cols);
+  Eigen::TensorMap<Eigen::Tensor<int32, 2>, Alignment> C(out, m, n);
+
+  typedef Eigen::Tensor<int32, 2>::DimensionPair DimPair;
+  int lhs_contract_dim = transpose_lhs ? 0 : 1;
+  int rhs_contract_dim = transpose_rhs ? 1 : 0;
+  const Eigen::array<DimPair, 1> dims(
+      {DimPair(lhs_contract_dim, rhs_contract_dim)});
+
+  C = A.template cast<int32>().contract(B.template cast<int32>(), dims);
+}
+
 }  // namespace
 
 TF_ATTRIBUTE_NO_SANITIZE_MEMORY void
@@ -121,3 +154,17 @@ __xla_cpu_runtime_EigenSingleThreadedMatMulS32(const void* run_options_ptr,
   SingleThreadedMatMulDispatch<int32>(run_options_ptr, out, lhs, rhs, m, n, k,
                                       transpose_lhs, transpose_rhs);
 }
+
+TF_ATTRIBUTE_NO_SANITIZE_MEMORY void
+__xla_cpu_runtime_EigenSingleThreadedMatMulS8S32(
+    const void* run_options_ptr, int32* out, int8* lhs, int8* rhs, int64 m,
+    int64 n, int64 k, int32 transpose_lhs, int32 transpose_rhs) {
+  if (Is16BytesAligned(out) && Is16BytesAligned(lhs) &&
+      Is16BytesAligned(rhs)) {
+    MatMulS8S32<Eigen::Aligned16>(out, lhs, rhs, m, n, k, transpose_lhs,
+                                  transpose_rhs);
+  } else {
+    MatMulS8S32<Eigen::Unaligned>(out, lhs, rhs, m, n, k, transpose_lhs,
+                                  transpose_rhs);
+  }
+}
@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Host.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
+#include "tensorflow/compiler/xla/service/cpu/module_splitter.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d_mkl.h"
@@ -45,6 +47,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -88,12 +91,25 @@ SimpleOrcJIT::SimpleOrcJIT(
     bool disable_expensive_passes, llvm::FastMathFlags fast_math_flags,
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
-    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+    string persistent_cache_dir)
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      disable_expensive_passes_(disable_expensive_passes),
+      fast_math_flags_(fast_math_flags),
+      pre_optimization_hook_(pre_optimization_hook),
+      persistent_cache_dir_(persistent_cache_dir),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       data_layout_(target_machine_->createDataLayout()),
       symbol_resolver_(llvm::orc::createLegacyLookupResolver(
           execution_session_,
           [this](llvm::StringRef name) -> llvm::JITSymbol {
+            // The parts of a split module refer to each other.
+            if (auto symbol = this->FindSymbolInObjects(
+                    std::string(name), /*exported_symbols_only=*/false)) {
+              return symbol;
+            }
             return this->ResolveRuntimeSymbol(std::string(name));
           },
           [](llvm::Error Err) {
@@ -125,7 +141,8 @@ SimpleOrcJIT::SimpleOrcJIT(
                           disable_expensive_passes, fast_math_flags,
                           std::move(pre_optimization_hook),
                           std::move(post_optimization_hook),
-                          std::move(post_codegen_hook))),
+                          std::move(post_codegen_hook),
+                          std::move(persistent_cache_dir))),
       gdb_jit_event_listener_(
           llvm::JITEventListener::createGDBRegistrationListener()) {
   VLOG(1) << "CPU target: " << target_machine_->getTargetCPU().str()
@@ -179,6 +196,51 @@ SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModule(
   return key;
 }
 
+void SimpleOrcJIT::AddModuleInParallel(
+    std::unique_ptr<llvm::Module> module, int num_parts,
+    tensorflow::thread::ThreadPool* thread_pool) {
+  std::vector<string> parts =
+      SplitModuleForParallelCodegen(module.get(), num_parts);
+  if (parts.empty()) {
+    AddModule(std::move(module));
+    return;
+  }
+  VLOG(1) << "Compiling " << module->getModuleIdentifier() << " in "
+          << parts.size() << " parts";
+  if (pre_optimization_hook_) {
+    pre_optimization_hook_(*module);
+  }
+  module.reset();
+
+  // LLVMContexts and TargetMachines are not thread-safe, so every part is
+  // compiled with its own.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(parts.size());
+  tensorflow::BlockingCounter counter(parts.size());
+  for (int i = 0; i < parts.size(); ++i) {
+    thread_pool->Schedule([&, i] {
+      llvm::LLVMContext context;
+      std::unique_ptr<llvm::Module> part = cantFail(llvm::parseBitcodeFile(
+          llvm::MemoryBufferRef(parts[i], "xla_cpu_split"), context));
+      std::unique_ptr<llvm::TargetMachine> target_machine =
+          InferTargetMachineForJIT(target_options_, opt_level_);
+      objects[i] = CompilerFunctor(
+          target_machine.get(), opt_level_, optimize_for_size_,
+          disable_expensive_passes_, fast_math_flags_,
+          /*pre_optimization_hook=*/nullptr,
+          /*post_optimization_hook=*/nullptr,
+          /*post_codegen_hook=*/nullptr, persistent_cache_dir_)(*part);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (std::unique_ptr<llvm::MemoryBuffer>& object : objects) {
+    auto key = execution_session_.allocateVModule();
+    cantFail(object_layer_.addObject(key, std::move(object)));
+    object_keys_.push_back(key);
+  }
+}
+
 void SimpleOrcJIT::RemoveModule(SimpleOrcJIT::VModuleKeyT key) {
   module_keys_.erase(std::remove(module_keys_.begin(), module_keys_.end(), key),
                      module_keys_.end());
@@ -209,6 +271,17 @@ llvm::JITSymbol SimpleOrcJIT::FindCompiledSymbol(const std::string& name) {
     }
   }
 
+  return FindSymbolInObjects(name, exported_symbols_only);
+}
+
+llvm::JITSymbol SimpleOrcJIT::FindSymbolInObjects(const std::string& name,
+                                                  bool exported_symbols_only) {
+  for (auto& key : object_keys_) {
+    if (auto symbol =
+            object_layer_.findSymbolIn(key, name, exported_symbols_only)) {
+      return symbol;
+    }
+  }
   return nullptr;
 }
 
@@ -246,6 +319,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(EigenMatMulF32);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenMatMulF64);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenMatMulS32);
+  REGISTER_CPU_RUNTIME_SYMBOL(EigenMatMulS8S32);
   REGISTER_CPU_RUNTIME_SYMBOL(MKLMatMulF32);
   REGISTER_CPU_RUNTIME_SYMBOL(MKLMatMulF64);
   REGISTER_CPU_RUNTIME_SYMBOL(MKLSingleThreadedMatMulF32);
@@ -257,6 +331,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulF32);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulF64);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulS32);
+  REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulS8S32);
   REGISTER_CPU_RUNTIME_SYMBOL(ParallelForkJoin);
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseInfeedBufferAfterDequeue);
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseOutfeedBufferAfterPopulation);
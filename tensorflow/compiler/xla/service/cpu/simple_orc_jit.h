@@ -30,6 +30,7 @@ limitations under the License.
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -39,7 +40,8 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
+// Supports JIT-ing multiple modules but without cross-module linking, except
+// between the parts of a module added with AddModuleInParallel.
 // Implements eager compilation - the module is lowered to binary as soon as
 // it's added to the JIT.
 class SimpleOrcJIT {
@@ -54,14 +56,16 @@ class SimpleOrcJIT {
   //
   // {pre,post}_optimization_hook is invoked on the module before/after all
   // LLVM IR-level optimizations.  post_codegen_hook is invoked after
-  // compiling to machine code.
+  // compiling to machine code. If persistent_cache_dir is not empty, object
+  // files are shared through that directory across processes.
   SimpleOrcJIT(
       const llvm::TargetOptions& target_options,
       llvm::CodeGenOpt::Level opt_level, bool optimize_for_size,
       bool disable_expensive_passes, llvm::FastMathFlags fast_math_flags,
       LLVMCompiler::ModuleHook pre_optimization_hook,
       LLVMCompiler::ModuleHook post_optimization_hook,
-      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook);
+      std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook,
+      string persistent_cache_dir = "");
 
   const llvm::DataLayout& data_layout() const { return data_layout_; }
 
@@ -73,6 +77,16 @@ class SimpleOrcJIT {
   // remove this module.
   VModuleKeyT AddModule(std::unique_ptr<llvm::Module> module);
 
+  // Splits a module into up to `num_parts` parts (see
+  // SplitModuleForParallelCodegen), compiles them concurrently on
+  // `thread_pool` and adds the resulting object files to the JIT. Falls back
+  // to AddModule if the module can't be split.
+  //
+  // The pre-optimization hook runs on the whole module; the post-optimization
+  // and post-codegen hooks are not run on the parts. Parts can't be removed.
+  void AddModuleInParallel(std::unique_ptr<llvm::Module> module, int num_parts,
+                           tensorflow::thread::ThreadPool* thread_pool);
+
   // Remove a module from the JIT and free the memory associated with it.
   void RemoveModule(VModuleKeyT key);
 
@@ -91,12 +105,26 @@ class SimpleOrcJIT {
  private:
   llvm::JITSymbol ResolveRuntimeSymbol(const std::string& name);
 
+  // Looks up `name` in the object files added by AddModuleInParallel.
+  llvm::JITSymbol FindSymbolInObjects(const std::string& name,
+                                      bool exported_symbols_only);
+
   void NotifyObjectFinalized(
       const llvm::object::ObjectFile& object,
       const llvm::RuntimeDyld::LoadedObjectInfo& object_info);
   void NotifyObjectFreed(const llvm::object::ObjectFile& object);
 
+  // Options used to compile the parts of modules in AddModuleInParallel.
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const llvm::FastMathFlags fast_math_flags_;
+  const LLVMCompiler::ModuleHook pre_optimization_hook_;
+  const string persistent_cache_dir_;
+
   std::vector<VModuleKeyT> module_keys_;
+  std::vector<VModuleKeyT> object_keys_;
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   const llvm::DataLayout data_layout_;
   llvm::orc::ExecutionSession execution_session_;
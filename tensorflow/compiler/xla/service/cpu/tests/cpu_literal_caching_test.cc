@@ -120,6 +120,38 @@ CHECK-NOT: private unnamed_addr constant [8 x i8]
                                 /*match_optimized_ir=*/false);
 }
 
+TEST_F(CpuDuplicateConstantsTest, SharedArrayConstants) {
+  const string hlo_text = R"(
+HloModule SharedConstants
+
+ENTRY main {
+  param = f32[2,3,2] parameter(0)
+  const_a = f32[2,3,2] constant(
+    {{{1, 2}, {1001, 1002}, {2001, 2002}},
+     {{2, 1}, {2001, 3002}, {2001, 2002}}})
+  ROOT add = f32[2,3,2] add(param, const_a)
+}
+)";
+
+  string filecheck_pattern = R"(
+CHECK: $[[NAME:__xla_constant_[0-9a-f]+_[0-9a-f]+]] = comdat any
+CHECK: @[[NAME]] = linkonce_odr hidden constant [48 x i8]{{.*}}, comdat
+CHECK-NOT: private unnamed_addr constant [48 x i8]
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_text));
+
+  CpuAotCompilationOptions options{
+      /*triple=*/"x86_64-pc-linux", /*cpu_name=*/"", /*features=*/"",
+      /*entry_point_name=*/"entry",
+      /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+  options.set_share_constants(true);
+
+  CompileAheadOfTimeAndVerifyIr(std::move(module), options, filecheck_pattern,
+                                /*match_optimized_ir=*/false);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
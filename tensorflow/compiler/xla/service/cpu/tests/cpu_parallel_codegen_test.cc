@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuParallelCodegenTest : public HloTestBase {
+ private:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    return debug_options;
+  }
+};
+
+// The embedded computations of the while loop, the reduction and the sort end
+// up in different parts of the split module and call each other.
+TEST_F(CpuParallelCodegenTest, WhileReduceAndSort) {
+  const char* const hlo_text = R"(
+HloModule WhileReduceAndSort
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+less_than {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT lt = pred[] compare(lhs, rhs), direction=LT
+}
+
+body {
+  state = (s32[], f32[64]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  values = f32[64] get-tuple-element(state), index=1
+  zero = f32[] constant(0)
+  sum = f32[] reduce(values, zero), dimensions={0}, to_apply=add
+  sum_broadcast = f32[64] broadcast(sum), dimensions={}
+  scaled = f32[64] divide(values, sum_broadcast)
+  sorted = f32[64] sort(scaled), dimensions={0}, to_apply=less_than
+  ROOT next_state = (s32[], f32[64]) tuple(next_i, sorted)
+}
+
+cond {
+  state = (s32[], f32[64]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(3)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+ENTRY main {
+  values = f32[64] parameter(0)
+  zero = s32[] constant(0)
+  init = (s32[], f32[64]) tuple(zero, values)
+  ROOT while = (s32[], f32[64]) while(init), condition=cond, body=body
+}
+)";
+
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
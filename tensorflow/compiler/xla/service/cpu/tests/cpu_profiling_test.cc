@@ -110,6 +110,40 @@ INSTANTIATE_TEST_SUITE_P(CpuProfilingTestInstantiation, CpuProfilingTest,
                          ::testing::ValuesIn(CpuProfilingTestCases),
                          CpuProfilingTest::Name);
 
+using CpuTraceMeTest = CpuCodegenTest;
+
+// Tests that TraceMe activities are emitted around the instructions of the
+// entry computation, and not inside the reduction computation.
+TEST_F(CpuTraceMeTest, TracesEntryComputation) {
+  constexpr char hlo_text[] = R"(HloModule test
+    add {
+      x = f32[] parameter(0)
+      y = f32[] parameter(1)
+      ROOT add = f32[] add(x, y)
+    }
+
+    ENTRY test {
+      p = f32[1024] parameter(0)
+      sin = f32[1024] sine(p), metadata={op_type="Sin" op_name="model/sin"}
+      zero = f32[] constant(0)
+      ROOT reduce = f32[] reduce(sin, zero), dimensions={0}, to_apply=add
+    })";
+
+  auto config = GetModuleConfigForTest();
+  auto debug_options = config.debug_options();
+  debug_options.set_xla_cpu_enable_xprof_traceme(true);
+  config.set_debug_options(debug_options);
+  auto hlo_module = ParseAndReturnVerifiedModule(hlo_text, config);
+
+  CompileAndVerifyIr(
+      std::move(hlo_module).ValueOrDie(),
+      R"(CHECK-DAG: sin#hlo_op=sin,hlo_module=test,tf_op=model/sin,tf_op_type=Sin#
+         CHECK-DAG: reduce#hlo_op=reduce,hlo_module=test#
+         CHECK-COUNT-2: call i64 @__xla_cpu_runtime_TracingStart
+         CHECK-NOT: call i64 @__xla_cpu_runtime_TracingStart)",
+      /*match_optimized_ir=*/false);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
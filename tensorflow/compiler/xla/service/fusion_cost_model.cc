@@ -0,0 +1,124 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/fusion_cost_model.h"
+
+#include <algorithm>
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+
+namespace {
+
+// HloCostAnalysis counts transcendental functions separately from flops. They
+// are expanded to polynomial approximations of several flops each.
+constexpr double kFlopsPerTranscendental = 4;
+
+// Returns true if the result of `producer` is materialized even if it is
+// fused into `consumer`.
+bool HasOtherUsers(const HloInstruction& producer,
+                   const HloInstruction& consumer) {
+  return producer.user_count() != 1 || producer.users()[0] != &consumer ||
+         producer.parent()->root_instruction() == &producer;
+}
+
+// Returns how many times `consumer` reads each element of its operand
+// `operand_index`, i.e. how many times a fused producer is recomputed.
+double EstimateReuse(const HloInstruction& consumer, int64 operand_index) {
+  if (!consumer.ReusesOperandElements(operand_index)) {
+    return 1;
+  }
+  if (consumer.opcode() == HloOpcode::kReduceWindow) {
+    double window_size = 1;
+    for (const WindowDimension& dimension : consumer.window().dimensions()) {
+      window_size *= dimension.size();
+    }
+    return std::max(1.0, window_size);
+  }
+  // Otherwise assume that each element of the operand is read equally often,
+  // by the computation of each output element and, for dots, by each step of
+  // the contraction.
+  double reads = ShapeUtil::ElementsInRecursive(consumer.shape());
+  if (consumer.opcode() == HloOpcode::kDot) {
+    const Shape& lhs_shape = consumer.operand(0)->shape();
+    for (int64 dimension :
+         consumer.dot_dimension_numbers().lhs_contracting_dimensions()) {
+      reads *= lhs_shape.dimensions(dimension);
+    }
+  }
+  const Shape& operand_shape = consumer.operand(operand_index)->shape();
+  const double operand_elements =
+      std::max<int64>(1, ShapeUtil::ElementsInRecursive(operand_shape));
+  return std::max(1.0, reads / operand_elements);
+}
+
+}  // namespace
+
+bool FusionCostModel::ShouldFuse(HloInstruction* consumer,
+                                 int64 operand_index) const {
+  const HloInstruction* producer = consumer->operand(operand_index);
+  if (!HasOtherUsers(*producer, *consumer) &&
+      !consumer->ReusesOperandElements(operand_index)) {
+    // Nothing is recomputed, and the intermediate result is not written.
+    return true;
+  }
+  return EstimateSavedSeconds(consumer, operand_index) >= 0;
+}
+
+double FusionCostModel::EstimateSavedSeconds(HloInstruction* consumer,
+                                             int64 operand_index) const {
+  HloInstruction* producer = consumer->mutable_operand(operand_index);
+  HloCostAnalysis analysis(shape_size_);
+  ConstDfsHloVisitor* visitor = &analysis;
+  Status status = analysis.Preprocess(producer);
+  if (status.ok()) status = producer->Visit(visitor);
+  if (status.ok()) status = analysis.Postprocess(producer);
+  if (!status.ok()) {
+    VLOG(2) << "No cost estimate for " << producer->name() << ": " << status;
+    return 0;
+  }
+
+  const double flops =
+      analysis.flop_count(*producer) +
+      kFlopsPerTranscendental * analysis.transcendental_count(*producer);
+  // Operands that the consumer reads anyway are not read again by the
+  // recomputed producer.
+  double operand_bytes = 0;
+  for (int64 i = 0; i < producer->operand_count(); ++i) {
+    if (!absl::c_linear_search(consumer->operands(), producer->operand(i))) {
+      operand_bytes += analysis.operand_bytes_accessed(*producer, i);
+    }
+  }
+  const double output_bytes = analysis.output_bytes_accessed(*producer);
+
+  const bool has_other_users = HasOtherUsers(*producer, *consumer);
+  const double saved_bytes = has_other_users ? output_bytes : 2 * output_bytes;
+  const double extra_runs =
+      EstimateReuse(*consumer, operand_index) - (has_other_users ? 0 : 1);
+  const double seconds_per_run = flops / roofline_.flops_per_second +
+                                 operand_bytes / roofline_.bytes_per_second;
+  const double saved_seconds =
+      saved_bytes / roofline_.bytes_per_second - extra_runs * seconds_per_run;
+  VLOG(3) << "Fusing " << producer->name() << " into " << consumer->name()
+          << " saves " << saved_seconds << "s";
+  return saved_seconds;
+}
+
+}  // namespace xla
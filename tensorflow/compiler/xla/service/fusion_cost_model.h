@@ -0,0 +1,62 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_FUSION_COST_MODEL_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_FUSION_COST_MODEL_H_
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+
+namespace xla {
+
+// Decides whether fusing a producer into its consumer pays off, by comparing
+// the memory traffic the fusion saves against the computation it duplicates.
+// Both are estimated with HloCostAnalysis and converted to time with the
+// roofline of the target.
+class FusionCostModel {
+ public:
+  // Peak compute and memory bandwidth of the target.
+  struct Roofline {
+    double flops_per_second;
+    double bytes_per_second;
+  };
+
+  FusionCostModel(const HloCostAnalysis::ShapeSizeFunction& shape_size,
+                  const Roofline& roofline)
+      : shape_size_(shape_size), roofline_(roofline) {}
+
+  // Returns true if fusing operand `operand_index` of `consumer` into
+  // `consumer` is estimated not to be slower than leaving it unfused.
+  //
+  // Without fusion the producer runs once, writes its result and the consumer
+  // reads it back (the read is saved only if the consumer is the sole user).
+  // With fusion the producer runs once per element of its result the consumer
+  // reads, plus once more for its other users, and each extra run reads the
+  // producer's operands that the consumer does not read anyway.
+  bool ShouldFuse(HloInstruction* consumer, int64 operand_index) const;
+
+  // Returns the estimated time in seconds saved by fusing operand
+  // `operand_index` into `consumer`. Negative if the fusion is a loss.
+  double EstimateSavedSeconds(HloInstruction* consumer,
+                              int64 operand_index) const;
+
+ private:
+  const HloCostAnalysis::ShapeSizeFunction shape_size_;
+  const Roofline roofline_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_FUSION_COST_MODEL_H_
@@ -0,0 +1,101 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/fusion_cost_model.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace {
+
+class FusionCostModelTest : public HloTestBase {
+ protected:
+  static int64 ShapeSize(const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+  }
+
+  // A target that computes 1000 flops in the time it moves 1 byte.
+  FusionCostModel cost_model_{ShapeSize, {/*flops_per_second=*/1e12,
+                                          /*bytes_per_second=*/1e9}};
+};
+
+TEST_F(FusionCostModelTest, FusesSoleUser) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    p0 = f32[1000]{0} parameter(0)
+    exp = f32[1000]{0} exponential(p0)
+    ROOT neg = f32[1000]{0} negate(exp)
+  })")
+                    .ValueOrDie();
+  HloInstruction* neg = module->entry_computation()->root_instruction();
+  EXPECT_TRUE(cost_model_.ShouldFuse(neg, 0));
+}
+
+TEST_F(FusionCostModelTest, DuplicatesProducerOfSharedOperands) {
+  // The consumer reads p0 anyway, so recomputing exp only costs flops.
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    p0 = f32[1000]{0} parameter(0)
+    exp = f32[1000]{0} exponential(p0)
+    add = f32[1000]{0} add(p0, exp)
+    ROOT tuple = (f32[1000]{0}, f32[1000]{0}) tuple(exp, add)
+  })")
+                    .ValueOrDie();
+  HloInstruction* add =
+      module->entry_computation()->root_instruction()->mutable_operand(1);
+  EXPECT_GT(cost_model_.EstimateSavedSeconds(add, 1), 0);
+  EXPECT_TRUE(cost_model_.ShouldFuse(add, 1));
+}
+
+TEST_F(FusionCostModelTest, DoesNotDuplicateProducerReadingMoreThanItWrites) {
+  // Recomputing add reads p0 and p1 again, which costs more than reading add.
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    p0 = f32[1000]{0} parameter(0)
+    p1 = f32[1000]{0} parameter(1)
+    p2 = f32[1000]{0} parameter(2)
+    add = f32[1000]{0} add(p0, p1)
+    mul = f32[1000]{0} multiply(add, p2)
+    ROOT tuple = (f32[1000]{0}, f32[1000]{0}) tuple(add, mul)
+  })")
+                    .ValueOrDie();
+  HloInstruction* mul =
+      module->entry_computation()->root_instruction()->mutable_operand(1);
+  EXPECT_LT(cost_model_.EstimateSavedSeconds(mul, 0), 0);
+  EXPECT_FALSE(cost_model_.ShouldFuse(mul, 0));
+}
+
+TEST_F(FusionCostModelTest, DoesNotFuseReusedProducer) {
+  // The broadcast reads each element of exp 1000 times.
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    p0 = f32[100]{0} parameter(0)
+    exp = f32[100]{0} exponential(p0)
+    ROOT broadcast = f32[100,1000]{1,0} broadcast(exp), dimensions={0}
+  })")
+                    .ValueOrDie();
+  HloInstruction* broadcast = module->entry_computation()->root_instruction();
+  EXPECT_FALSE(cost_model_.ShouldFuse(broadcast, 0));
+}
+
+}  // namespace
+}  // namespace xla
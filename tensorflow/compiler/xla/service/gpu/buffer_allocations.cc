@@ -71,6 +71,10 @@ StatusOr<std::unique_ptr<BufferAllocations>> BufferAllocations::Builder::Build(
       continue;
     }
 
+    if (allocation.color().value() == kHostMemorySpace) {
+      return InternalError("Host buffer %d must be registered", i);
+    }
+
     // Allocate each allocation that might escape, or is the temp buffer.
     bool seen_temp_buffer = false;
     if (allocation.maybe_live_out() || allocation.IsPreallocatedTempBuffer()) {
@@ -135,6 +139,10 @@ Status BufferAllocations::TearDown(
   const int64 num_buffers = buffer_assignment_->Allocations().size();
   for (BufferAllocation::Index i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = buffer_assignment_->GetAllocation(i);
+    if (allocation.color().value() == kHostMemorySpace) {
+      // Host buffers are registered, and owned, by the caller.
+      continue;
+    }
     se::DeviceMemoryBase buffer_address = GetDeviceAddress(allocation.index());
     // Deallocate buffers marked "maybe_live_out" but aren't actually live out,
     // and temp buffers.
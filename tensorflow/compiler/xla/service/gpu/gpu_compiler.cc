@@ -22,8 +22,10 @@ limitations under the License.
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/LLVMContext.h"
@@ -43,6 +45,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/dump.h"
 #include "tensorflow/compiler/xla/service/dynamic_index_splitter.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
+#include "tensorflow/compiler/xla/service/fusion_cost_model.h"
 #include "tensorflow/compiler/xla/service/gpu/alias_passthrough_params.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_softmax_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_batchnorm_rewriter.h"
@@ -58,6 +61,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_input_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_loop_fusion.h"
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
@@ -68,6 +72,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/reduction_degenerate_dim_remover.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_dimension_grouper.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_layout_normalizer.h"
+#include "tensorflow/compiler/xla/service/gpu/reduction_tiling_picker.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 #include "tensorflow/compiler/xla/service/gpu/target_constants.h"
@@ -82,9 +87,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_element_type_converter.h"
 #include "tensorflow/compiler/xla/service/hlo_get_dimension_size_rewriter.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
@@ -107,6 +114,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/regexp.h"
@@ -127,6 +135,114 @@ GpuCompiler::GpuCompiler(se::Platform::Id platform_id,
       pointer_size_(llvm::DataLayout(data_layout)
                         .getPointerSize(0 /* default address space */)) {}
 
+GpuDeviceInfo GetGpuDeviceInfo(se::StreamExecutor* stream_exec) {
+  GpuDeviceInfo gpu_device_info;
+  gpu_device_info.threads_per_block_limit =
+      stream_exec->GetDeviceDescription().threads_per_block_limit();
+  gpu_device_info.threads_per_warp =
+      stream_exec->GetDeviceDescription().threads_per_warp();
+  gpu_device_info.shared_memory_per_block =
+      stream_exec->GetDeviceDescription().shared_memory_per_block();
+  gpu_device_info.threads_per_core_limit =
+      stream_exec->GetDeviceDescription().threads_per_core_limit();
+  gpu_device_info.core_count = stream_exec->GetDeviceDescription().core_count();
+  gpu_device_info.block_dim_limit_x =
+      stream_exec->GetDeviceDescription().block_dim_limit().x;
+  gpu_device_info.block_dim_limit_y =
+      stream_exec->GetDeviceDescription().block_dim_limit().y;
+  gpu_device_info.block_dim_limit_z =
+      stream_exec->GetDeviceDescription().block_dim_limit().z;
+  gpu_device_info.memory_bandwidth =
+      stream_exec->GetDeviceDescription().memory_bandwidth();
+  gpu_device_info.clock_rate_ghz =
+      stream_exec->GetDeviceDescription().clock_rate_ghz();
+  return gpu_device_info;
+}
+
+// Returns the fusion cost model for the roofline of the device, or null if the
+// device is unknown or the cost model is disabled.
+static std::unique_ptr<FusionCostModel> CreateFusionCostModel(
+    const HloModule& module, se::StreamExecutor* stream_exec,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  if (stream_exec == nullptr ||
+      !module.config().debug_options().xla_fusion_use_cost_model()) {
+    return nullptr;
+  }
+  // Each core issues one FMA per cycle on each of its FP32 lanes.
+  constexpr int kFp32LanesPerCore = 64;
+  const GpuDeviceInfo device_info = GetGpuDeviceInfo(stream_exec);
+  if (device_info.memory_bandwidth <= 0 || device_info.clock_rate_ghz <= 0) {
+    return nullptr;
+  }
+  FusionCostModel::Roofline roofline;
+  roofline.flops_per_second = 2.0 * kFp32LanesPerCore * device_info.core_count *
+                              device_info.clock_rate_ghz * 1e9;
+  roofline.bytes_per_second = device_info.memory_bandwidth;
+  return absl::make_unique<FusionCostModel>(shape_size, roofline);
+}
+
+// Rematerializes instructions of `hlo_module` until its peak memory use fits
+// in `memory_percent` percent of the memory that is currently free on the
+// device of `stream_exec`.
+static Status RematerializeToFreeMemory(
+    HloModule* hlo_module, se::StreamExecutor* stream_exec,
+    int64 memory_percent,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  using tensorflow::strings::HumanReadableNumBytes;
+  int64 free_bytes = 0;
+  int64 total_bytes = 0;
+  if (!stream_exec->DeviceMemoryUsage(&free_bytes, &total_bytes)) {
+    LOG(WARNING) << "Skipping rematerialization of " << hlo_module->name()
+                 << ": failed to query the free device memory.";
+    return Status::OK();
+  }
+  const int64 memory_limit_bytes = free_bytes / 100 * memory_percent;
+
+  // Rematerialization works on a sequential order of the instructions. The
+  // order is dropped again afterwards, since the passes that follow do not
+  // maintain it, and GpuHloSchedule recomputes it with the same memory
+  // minimizing scheduler.
+  HloPassPipeline pipeline("rematerialization");
+  pipeline.AddPass<HloMemoryScheduler>(
+      [&shape_size](const BufferValue& buffer) {
+        return shape_size(buffer.shape());
+      },
+      ComputationSchedulerToModuleScheduler(DefaultMemoryScheduler));
+  HloRematerialization::RematerializationSizes sizes;
+  pipeline.AddPass<HloRematerialization>(
+      shape_size, memory_limit_bytes, &sizes,
+      HloRematerialization::RematerializationPass::kPostFusion,
+      /*block_size_limit=*/1);
+  TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
+  hlo_module->clear_schedule();
+
+  std::vector<string> rematerialized;
+  for (const HloComputation* computation : hlo_module->computations()) {
+    for (const HloInstruction* instruction : computation->instructions()) {
+      if (absl::StrContains(instruction->name(), ".remat")) {
+        rematerialized.push_back(instruction->name());
+      }
+    }
+  }
+  if (rematerialized.empty()) {
+    VLOG(1) << "Peak memory of " << hlo_module->name() << " ("
+            << HumanReadableNumBytes(sizes.before_bytes)
+            << ") fits in the rematerialization limit of "
+            << HumanReadableNumBytes(memory_limit_bytes);
+    return Status::OK();
+  }
+  // HloRematerialization itself warns if the limit could not be reached.
+  LOG(INFO) << "Rematerialized " << rematerialized.size()
+            << " instructions of " << hlo_module->name() << " to fit in "
+            << HumanReadableNumBytes(memory_limit_bytes)
+            << " of device memory; peak memory went from "
+            << HumanReadableNumBytes(sizes.before_bytes) << " to "
+            << HumanReadableNumBytes(sizes.after_bytes);
+  VLOG(1) << "Rematerialized instructions: "
+          << absl::StrJoin(rematerialized, ", ");
+  return Status::OK();
+}
+
 // Runs optimization passes on the given HLO module.
 Status GpuCompiler::OptimizeHloModule(
     HloModule* hlo_module, se::StreamExecutor* stream_exec,
@@ -287,8 +403,14 @@ Status GpuCompiler::OptimizeHloModule(
         /*layout_sensitive=*/true,
         /*allow_mixed_precision=*/false,
         LayoutAssignment::InstructionCanChangeLayout);
-    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false);
-    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true);
+    fusion.AddPass<GpuInstructionFusion>(
+        /*may_duplicate=*/false,
+        CreateFusionCostModel(*hlo_module, stream_exec,
+                              ShapeSizeBytesFunction()));
+    fusion.AddPass<GpuInstructionFusion>(
+        /*may_duplicate=*/true,
+        CreateFusionCostModel(*hlo_module, stream_exec,
+                              ShapeSizeBytesFunction()));
     fusion.AddPass<FusionMerger>();
     fusion.AddPass<GpuMultiOutputFusion>();
     fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
@@ -304,6 +426,28 @@ Status GpuCompiler::OptimizeHloModule(
     horizontal_fusion.AddPass<HloDCE>();
     TF_RETURN_IF_ERROR(horizontal_fusion.Run(hlo_module).status());
   }
+  if (stream_exec != nullptr &&
+      hlo_module->config().debug_options().xla_gpu_autotune_reductions()) {
+    // Reductions are timed in their final fused form, so this runs after
+    // fusion.
+    HloPassPipeline pipeline("reduction tiling");
+    pipeline.AddPass<ReductionTilingPicker>(this, stream_exec,
+                                            device_allocator);
+    TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
+  }
+  const int64 host_offload_min_bytes =
+      int64{hlo_module->config()
+                .debug_options()
+                .xla_gpu_host_offload_min_buffer_size_mib()}
+      << 20;
+  if (stream_exec != nullptr && host_offload_min_bytes > 0) {
+    // Offloading decisions depend on the final, fused instructions.
+    HloPassPipeline pipeline("host offload");
+    pipeline.AddPass<HostMemoryOffloader>(
+        host_offload_min_bytes,
+        stream_exec->GetDeviceDescription().memory_bandwidth());
+    TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
+  }
   {
     HloPassPipeline pipeline("all_reduce_combiner");
     pipeline.AddPass<AllReduceCombiner>(
@@ -311,6 +455,17 @@ Status GpuCompiler::OptimizeHloModule(
         /*combine_threshold_count=*/256);
     TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
   }
+  const int64 remat_memory_percent =
+      hlo_module->config()
+          .debug_options()
+          .xla_gpu_rematerialization_free_memory_percent();
+  if (stream_exec != nullptr && remat_memory_percent > 0) {
+    // Peak memory is only final once every pass that creates or merges
+    // buffers has run.
+    TF_RETURN_IF_ERROR(RematerializeToFreeMemory(
+        hlo_module, stream_exec, remat_memory_percent,
+        ShapeSizeBytesFunction()));
+  }
   return Status::OK();
 }
 
@@ -496,26 +651,6 @@ static Status CompileModuleToLlvmIrImpl(
   return Status::OK();
 }
 
-GpuDeviceInfo GetGpuDeviceInfo(se::StreamExecutor* stream_exec) {
-  GpuDeviceInfo gpu_device_info;
-  gpu_device_info.threads_per_block_limit =
-      stream_exec->GetDeviceDescription().threads_per_block_limit();
-  gpu_device_info.threads_per_warp =
-      stream_exec->GetDeviceDescription().threads_per_warp();
-  gpu_device_info.shared_memory_per_block =
-      stream_exec->GetDeviceDescription().shared_memory_per_block();
-  gpu_device_info.threads_per_core_limit =
-      stream_exec->GetDeviceDescription().threads_per_core_limit();
-  gpu_device_info.core_count = stream_exec->GetDeviceDescription().core_count();
-  gpu_device_info.block_dim_limit_x =
-      stream_exec->GetDeviceDescription().block_dim_limit().x;
-  gpu_device_info.block_dim_limit_y =
-      stream_exec->GetDeviceDescription().block_dim_limit().y;
-  gpu_device_info.block_dim_limit_z =
-      stream_exec->GetDeviceDescription().block_dim_limit().z;
-  return gpu_device_info;
-}
-
 StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
     std::unique_ptr<HloModule> module, se::StreamExecutor* stream_exec,
     se::DeviceMemoryAllocator* device_allocator) {
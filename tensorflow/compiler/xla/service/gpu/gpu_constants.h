@@ -31,6 +31,11 @@ extern const int64 kXlaAllocatedBufferAlignBytes;
 // Minimum alignment for constant buffers.
 extern const int64 kConstantBufferAlignBytes;
 
+// Layout memory space of buffers that live in pinned host memory. Buffer
+// assignment colors them accordingly, and only asynchronous copies access
+// them.
+extern const int64 kHostMemorySpace;
+
 }  // namespace gpu
 }  // namespace xla
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_debug_info_manager.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/annotation.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -75,17 +77,17 @@ bool GpuGraphCaptureEnabled(absl::string_view module_name) {
     string enabled_names;
     TF_CHECK_OK(
         tensorflow::ReadStringFromEnvVar("TF_XLA_GPU_GRAPH_CLUSTER_NAME",
-					 /*default_val=*/"", &enabled_names));
+                                         /*default_val=*/"", &enabled_names));
     return enabled_names;
   }();
   if (!enabled_names.empty() && is_enabled) {
-    for (auto cluster_name: absl::StrSplit(enabled_names, ',')) {
+    for (auto cluster_name : absl::StrSplit(enabled_names, ',')) {
       if (absl::StartsWith(module_name, cluster_name)) {
-	VLOG(0) << "CUDA GRAPH ENABLED FOR CLUSTER " << module_name;
-	return true;
+        VLOG(1) << "GPU graph capture enabled for cluster " << module_name;
+        return true;
       }
     }
-    VLOG(0) << "CUDA GRAPH NOT ENABLED FOR CLUSTER " << module_name;
+    VLOG(1) << "GPU graph capture not enabled for cluster " << module_name;
     return false;
   }
   return is_enabled;
@@ -235,6 +237,7 @@ bool GpuExecutable::CanUseGpuGraphCapture() {
   if (!can_use_gpu_graph_capture_.first) {
     can_use_gpu_graph_capture_.first = true;
     SetCanUseGraphCaptureFlag(
+        GpuGraphCaptureEnabled(module().name()) &&
         GpuExecutableSafeForGraphCapture(thunk_schedule_.get()));
   }
   return GetCanUseGraphCaptureFlag();
@@ -315,7 +318,7 @@ Status GpuExecutable::ExecuteThunks(
   se::Stream* capture_stream = main_stream;
   StreamPool::Ptr private_capture_stream;
   bool use_gpu_graph_capture =
-      GpuGraphCaptureEnabled(module().name()) && CanUseGpuGraphCapture() &&
+      CanUseGpuGraphCapture() &&
       executor->platform_kind() == stream_executor::PlatformKind::kCuda &&
       !is_graph_capture_costly_;
   if (use_gpu_graph_capture) {
@@ -359,10 +362,9 @@ Status GpuExecutable::ExecuteThunks(
     // If there is a cache hit, simply launch the existing executable graph.
     if (exec_graph) {
       // The temp_buffer_base should match the temp_buff_base of the bufs_key
-      // that is cached.
-      auto buf_keys_set =
-          temp_buffer_base_to_bufs_keys_map_[temp_buf_key.hash()];
-      DCHECK(buf_keys_set.find(bufs_key) == buf_keys_set.end())
+      // that is cached. This runs on every launch, so don't copy the set.
+      DCHECK(temp_buffer_base_to_bufs_keys_map_[temp_buf_key.hash()].count(
+          bufs_key))
           << " The temp_buffer_base should match the temp_buff_base of "
              "the bufs_key that is cached.";
       graph_stats_.cache_hits++;
@@ -424,14 +426,19 @@ Status GpuExecutable::ExecuteThunks(
       // Begin capture template graph
       capture_stream->ThenBeginGraphCapture();
 
-      TF_RETURN_IF_ERROR(ExecuteThunkSequence(
+      Status capture_status = ExecuteThunkSequence(
           run_options, buffer_allocations, profiler, main_stream,
-          capture_stream, sub_streams, deferred_host_callbacks));
+          capture_stream, sub_streams, deferred_host_callbacks);
 
       void* graph = nullptr;
 
-      // End capture template graph
+      // End capture template graph. This must happen even if enqueueing a
+      // thunk failed, or the capture stream is left unusable.
       capture_stream->ThenEndGraphCapture(graph);
+      if (!capture_status.ok()) {
+        GetExecutor()->DestroyGraph(gpu_context, graph);
+        return capture_status;
+      }
 
       // Instantiate exec graph
       StatusOr<void*> status =
@@ -457,17 +464,15 @@ Status GpuExecutable::ExecuteThunks(
                 << graph_stats_.get_cache_hit_rate()
                 << ". Hence aborting graph capture for executable " << this;
         is_graph_capture_costly_ = true;
-        }
-
-        temp_buffer_base_to_bufs_keys_map_[temp_buf_key.hash()].insert(
-            bufs_key);
+      }
 
-        // Launch exec graph
-        main_stream->ThenLaunchGraph(exec_graph);
+      temp_buffer_base_to_bufs_keys_map_[temp_buf_key.hash()].insert(bufs_key);
 
-        // Destroy template graph
-        GetExecutor()->DestroyGraph(gpu_context, graph);
+      // Launch exec graph
+      main_stream->ThenLaunchGraph(exec_graph);
 
+      // Destroy template graph
+      GetExecutor()->DestroyGraph(gpu_context, graph);
     }  // End of graph launch conditional.
   }
 
@@ -691,7 +696,7 @@ StatusOr<ScopedShapedBuffer> GpuExecutable::ExecuteAsyncOnStreamImpl(
                                         module().name(), ")"));
   se::DeviceMemoryAllocator* const memory_allocator = run_options->allocator();
   // Force synchronous execution if the allocator requires it.
-  const bool block_host_until_done =
+  bool block_host_until_done =
       !memory_allocator->AllowsAsynchronousDeallocation();
 
   if (GetRootValueSet().IsAmbiguous()) {
@@ -712,6 +717,19 @@ StatusOr<ScopedShapedBuffer> GpuExecutable::ExecuteAsyncOnStreamImpl(
 
   std::unique_ptr<BufferAllocations> buffer_allocations;
 
+  // Buffers offloaded to host memory live in pinned memory that is freed when
+  // this function returns, so the execution must have finished by then.
+  std::vector<void*> host_buffers;
+  auto free_host_buffers = tensorflow::gtl::MakeCleanup([&] {
+    if (host_buffers.empty()) {
+      return;
+    }
+    run_options->stream()->BlockHostUntilDone().IgnoreError();
+    for (void* host_buffer : host_buffers) {
+      executor->HostMemoryDeallocate(host_buffer);
+    }
+  });
+
   {
     tensorflow::profiler::TraceMe hlo_module_activity(
         [&] { return std::string("Build buffer allocations"); },
@@ -748,6 +766,19 @@ StatusOr<ScopedShapedBuffer> GpuExecutable::ExecuteAsyncOnStreamImpl(
       if (allocation.is_constant()) {
         buffer_allocations_builder.RegisterBuffer(i, FindOrDie(*globals, i));
       }
+
+      if (allocation.color().value() == kHostMemorySpace) {
+        void* host_buffer = executor->HostMemoryAllocate(allocation.size());
+        if (host_buffer == nullptr) {
+          return ResourceExhausted(
+              "Failed to allocate %d bytes of pinned host memory for buffer %d",
+              allocation.size(), i);
+        }
+        host_buffers.push_back(host_buffer);
+        block_host_until_done = true;
+        buffer_allocations_builder.RegisterBuffer(
+            i, se::DeviceMemoryBase(host_buffer, allocation.size()));
+      }
     }
 
     TF_ASSIGN_OR_RETURN(
@@ -141,8 +141,8 @@ class GpuExecutable : public Executable {
   Status CheckCompatibilityWithServiceExecutableRunOptions(
       const ServiceExecutableRunOptions* run_options);
 
-  // Returns whether GPU graph capture can safely be used for execution of
-  // this executable.
+  // Returns whether GPU graph capture is enabled for this executable and can
+  // safely be used to execute it. Computed on the first call only.
   bool CanUseGpuGraphCapture();
 
   // The LLVM IR, in string format, of the unoptimized module generated for this
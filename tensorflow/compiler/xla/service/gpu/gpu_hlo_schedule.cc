@@ -161,25 +161,32 @@ void BFSLaunchOrder(const HloComputation* computation,
   std::deque<HloInstruction*> queue;
   std::unordered_map<const HloInstruction*, int64> incoming_edge_count;
   for (auto* hlo : computation->instructions()) {
-    if (hlo->operand_count() == 0) {
+    if (hlo->operand_count() == 0 && hlo->control_predecessors().empty()) {
       queue.push_back(hlo);
     } else {
       incoming_edge_count[hlo] =
           std::set<HloInstruction*>(hlo->operands().begin(),
                                     hlo->operands().end())
-              .size();
+              .size() +
+          hlo->control_predecessors().size();
     }
   }
 
+  auto remove_edge = [&](HloInstruction* y) {
+    --incoming_edge_count[y];
+    if (incoming_edge_count[y] == 0) {
+      queue.push_back(y);
+    }
+  };
   while (!queue.empty()) {
     HloInstruction* x = queue.front();
     queue.pop_front();
     launch_order->push_back(x);
     for (HloInstruction* y : x->users()) {
-      --incoming_edge_count[y];
-      if (incoming_edge_count[y] == 0) {
-        queue.push_back(y);
-      }
+      remove_edge(y);
+    }
+    for (HloInstruction* y : x->control_successors()) {
+      remove_edge(y);
     }
   }
 }
@@ -0,0 +1,189 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/layout_util.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Bandwidth assumed for copies between pinned host memory and the device,
+// about what a PCIe 3.0 x16 link sustains in each direction.
+constexpr double kHostBandwidthBytesPerSecond = 12e9;
+
+// Returns whether the buffer defined by `instr` can be offloaded.
+bool CanOffload(const HloInstruction& instr) {
+  if (!instr.shape().IsArray() || !LayoutUtil::HasLayout(instr.shape()) ||
+      instr.parent()->root_instruction() == &instr) {
+    return false;
+  }
+  switch (instr.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kCopyDone:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+      return false;
+    default:
+      break;
+  }
+  // Users that alias the buffer keep it alive for as long as they are alive.
+  return absl::c_none_of(instr.users(), [](const HloInstruction* user) {
+    return user->opcode() == HloOpcode::kBitcast ||
+           user->opcode() == HloOpcode::kGetTupleElement ||
+           user->opcode() == HloOpcode::kTuple;
+  });
+}
+
+}  // namespace
+
+StatusOr<bool> HostMemoryOffloader::Run(HloModule* module) {
+  if (device_memory_bandwidth_ <= 0) {
+    return false;
+  }
+  HloComputation* computation = module->entry_computation();
+  HloCostAnalysis cost_analysis([](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+  });
+  Status status = computation->Accept(&cost_analysis);
+  if (!status.ok()) {
+    VLOG(1) << "Not offloading any buffers: " << status;
+    return false;
+  }
+
+  // end_time[i] is the estimated time at which sequence[i] finishes.
+  std::vector<HloInstruction*> sequence =
+      computation->MakeInstructionPostOrder();
+  absl::flat_hash_map<const HloInstruction*, int64> position;
+  std::vector<double> end_time(sequence.size());
+  double time = 0;
+  for (int64 i = 0; i < sequence.size(); ++i) {
+    position[sequence[i]] = i;
+    time += static_cast<double>(cost_analysis.bytes_accessed(*sequence[i])) /
+            device_memory_bandwidth_;
+    end_time[i] = time;
+  }
+  // Returns the estimated run time of the instructions strictly between
+  // sequence[begin] and sequence[end].
+  auto time_between = [&](int64 begin, int64 end) {
+    return end - begin > 1 ? end_time[end - 1] - end_time[begin] : 0.0;
+  };
+
+  bool changed = false;
+  for (int64 defined_at = 0; defined_at < sequence.size(); ++defined_at) {
+    HloInstruction* instr = sequence[defined_at];
+    const int64 size = ShapeUtil::ByteSizeOf(instr->shape());
+    if (size < min_size_in_bytes_ || !CanOffload(*instr)) {
+      continue;
+    }
+    std::vector<int64> uses;
+    for (const HloInstruction* user : instr->users()) {
+      auto it = position.find(user);
+      if (it == position.end()) {
+        break;
+      }
+      uses.push_back(it->second);
+    }
+    if (uses.empty() || uses.size() != instr->user_count()) {
+      continue;
+    }
+    absl::c_sort(uses);
+
+    // Offload the buffer during the longest gap between two uses, counting
+    // the definition as the first use, if it hides both copies.
+    int64 gap_begin = defined_at;
+    int64 gap_end = uses.front();
+    for (int64 i = 1; i < uses.size(); ++i) {
+      if (time_between(uses[i - 1], uses[i]) >
+          time_between(gap_begin, gap_end)) {
+        gap_begin = uses[i - 1];
+        gap_end = uses[i];
+      }
+    }
+    const double copy_time = size / kHostBandwidthBytesPerSecond;
+    if (time_between(gap_begin, gap_end) < 2 * copy_time) {
+      continue;
+    }
+    // The copy to the host overlaps with the instructions before
+    // `evicted_before`, and the copy back with the ones after
+    // `prefetched_after`.
+    int64 evicted_before = gap_begin + 1;
+    while (evicted_before < gap_end &&
+           time_between(gap_begin, evicted_before) < copy_time) {
+      ++evicted_before;
+    }
+    int64 prefetched_after = gap_end - 1;
+    while (prefetched_after > gap_begin &&
+           time_between(prefetched_after, gap_end) < copy_time) {
+      --prefetched_after;
+    }
+    if (evicted_before > prefetched_after) {
+      continue;
+    }
+
+    VLOG(2) << "Offloading " << instr->name() << " (" << size
+            << " bytes) between " << sequence[gap_begin]->name() << " and "
+            << sequence[gap_end]->name();
+    Shape host_shape = instr->shape();
+    host_shape.mutable_layout()->set_memory_space(kHostMemorySpace);
+    const Shape context_shape = ShapeUtil::MakeShape(U32, {});
+    HloInstruction* to_host_start =
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            ShapeUtil::MakeTupleShape(
+                {host_shape, instr->shape(), context_shape}),
+            HloOpcode::kCopyStart, instr));
+    HloInstruction* to_host_done = computation->AddInstruction(
+        HloInstruction::CreateUnary(host_shape, HloOpcode::kCopyDone,
+                                    to_host_start));
+    HloInstruction* from_host_start =
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            ShapeUtil::MakeTupleShape(
+                {instr->shape(), host_shape, context_shape}),
+            HloOpcode::kCopyStart, to_host_done));
+    HloInstruction* from_host_done = computation->AddInstruction(
+        HloInstruction::CreateUnary(instr->shape(), HloOpcode::kCopyDone,
+                                    from_host_start));
+
+    std::vector<HloInstruction*> users = instr->users();
+    for (HloInstruction* user : users) {
+      if (position.at(user) >= gap_end) {
+        TF_RETURN_IF_ERROR(instr->ReplaceUseWith(user, from_host_done));
+      }
+    }
+    TF_RETURN_IF_ERROR(
+        to_host_done->AddControlDependencyTo(sequence[evicted_before]));
+    TF_RETURN_IF_ERROR(
+        sequence[prefetched_after]->AddControlDependencyTo(from_host_start));
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
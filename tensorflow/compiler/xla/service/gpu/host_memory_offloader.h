@@ -0,0 +1,58 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Frees device memory by moving large buffers of the entry computation to
+// pinned host memory while they are not used, e.g. activations of the forward
+// pass that are only used again by the backward pass.
+//
+// A buffer is offloaded when the instructions between two of its uses take
+// long enough to hide a copy to the host and a copy back. The copies are
+// copy-start/copy-done pairs whose host-side shape has kHostMemorySpace in its
+// layout, and which run on their own streams. Control dependencies make the
+// instructions after the first copy wait for it, so that they can reuse the
+// buffer, and delay the second copy until shortly before the next use.
+//
+// Run times are estimated from the bytes each instruction accesses, assuming
+// the instructions run in post order.
+class HostMemoryOffloader : public HloModulePass {
+ public:
+  // Buffers smaller than `min_size_in_bytes` stay on the device.
+  // `device_memory_bandwidth` is in bytes per second.
+  HostMemoryOffloader(int64 min_size_in_bytes, int64 device_memory_bandwidth)
+      : min_size_in_bytes_(min_size_in_bytes),
+        device_memory_bandwidth_(device_memory_bandwidth) {}
+
+  absl::string_view name() const override { return "host-memory-offloader"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 min_size_in_bytes_;
+  const int64 device_memory_bandwidth_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
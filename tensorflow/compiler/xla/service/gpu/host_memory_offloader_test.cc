@@ -0,0 +1,92 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class HostMemoryOffloaderTest : public HloTestBase {};
+
+// `activation` is used by `negate` and again by `add`, after four
+// elementwise ops on twice as much data.
+const char* const kLongGapHlo = R"(
+HloModule LongGap
+
+ENTRY entry {
+  p0 = f32[1024,1024]{1,0} parameter(0)
+  activation = f32[1024,1024]{1,0} exponential(p0)
+  negate = f32[1024,1024]{1,0} negate(activation)
+  e1 = f32[1024,1024]{1,0} exponential(negate)
+  e2 = f32[1024,1024]{1,0} exponential(e1)
+  e3 = f32[1024,1024]{1,0} exponential(e2)
+  e4 = f32[1024,1024]{1,0} exponential(e3)
+  ROOT add = f32[1024,1024]{1,0} add(e4, activation)
+}
+)";
+
+TEST_F(HostMemoryOffloaderTest, OffloadsBetweenDistantUses) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kLongGapHlo));
+  HostMemoryOffloader offloader(/*min_size_in_bytes=*/1 << 20,
+                                /*device_memory_bandwidth=*/int64{1} << 30);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* activation = FindInstruction(module.get(), "activation");
+  HloInstruction* add = module->entry_computation()->root_instruction();
+  EXPECT_THAT(add, op::Add(op::Exp(), op::CopyDone(op::CopyStart(op::CopyDone(
+                                          op::CopyStart(activation))))));
+  const HloInstruction* to_host_done = add->operand(1)->operand(0)->operand(0);
+  EXPECT_EQ(to_host_done->shape().layout().memory_space(), kHostMemorySpace);
+  EXPECT_THAT(FindInstruction(module.get(), "negate"), op::Negate(activation));
+
+  // The copy to the host finishes before e2, and the copy back starts after
+  // e3.
+  EXPECT_THAT(FindInstruction(module.get(), "e2")->control_predecessors(),
+              ::testing::ElementsAre(to_host_done));
+  EXPECT_THAT(FindInstruction(module.get(), "e3")->control_successors(),
+              ::testing::ElementsAre(add->operand(1)->operand(0)));
+}
+
+TEST_F(HostMemoryOffloaderTest, KeepsBuffersIfCopiesCannotBeHidden) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kLongGapHlo));
+  HostMemoryOffloader offloader(/*min_size_in_bytes=*/1 << 20,
+                                /*device_memory_bandwidth=*/int64{1} << 43);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(HostMemoryOffloaderTest, KeepsSmallBuffers) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kLongGapHlo));
+  HostMemoryOffloader offloader(/*min_size_in_bytes=*/8 << 20,
+                                /*device_memory_bandwidth=*/int64{1} << 30);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
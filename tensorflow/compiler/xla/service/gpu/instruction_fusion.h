@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INSTRUCTION_FUSION_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INSTRUCTION_FUSION_H_
 
+#include <memory>
+#include <utility>
+
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/service/fusion_cost_model.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
@@ -26,8 +30,11 @@ namespace gpu {
 
 class GpuInstructionFusion : public InstructionFusion {
  public:
-  explicit GpuInstructionFusion(bool may_duplicate)
-      : InstructionFusion(GpuInstructionFusion::IsExpensive, may_duplicate) {}
+  explicit GpuInstructionFusion(
+      bool may_duplicate, std::unique_ptr<FusionCostModel> cost_model = nullptr)
+      : InstructionFusion(GpuInstructionFusion::IsExpensive, may_duplicate,
+                          FusionConfigCollection::kOff, std::move(cost_model)) {
+  }
 
   static bool IsExpensive(const HloInstruction& instruction);
 
@@ -540,6 +540,23 @@ Status IrEmitterUnnested::HandleCopy(HloInstruction* copy) {
   return IrEmitter::HandleCopy(copy);
 }
 
+Status IrEmitterUnnested::HandleCopyStart(HloInstruction* copy_start) {
+  // Copies between device and host memory are plain memcpys on the stream of
+  // the copy-start; the buffers are pinned and mapped into the device address
+  // space.
+  AddThunkToThunkSequence(absl::make_unique<DeviceToDeviceCopyThunk>(
+      /*source_buffer=*/GetAllocationSlice(*copy_start->operand(0)),
+      /*destination_buffer=*/GetAllocationSlice(*copy_start, {0}),
+      /*mem_size=*/ByteSizeOf(copy_start->operand(0)->shape()), copy_start));
+  return Status::OK();
+}
+
+Status IrEmitterUnnested::HandleCopyDone(HloInstruction*) {
+  // The output of copy-done is the destination buffer of its copy-start, and
+  // its users wait for the copy through the thunk schedule.
+  return Status::OK();
+}
+
 Status IrEmitterUnnested::EmitExtraOutputsForReduce(
     const HloInstruction* unnested_hlo, const IrArray::Index& index,
     bool use_linear_index,
@@ -3253,6 +3270,14 @@ ReductionCodegenInfo IrEmitterUnnested::ComputeReductionCodegenInfo(
   std::array<int64, 3> reduction_tiling =
       GetReductionTiling(reduction_dimensions, smallest_input_dtype_bits,
                          ir_emitter_context_->cuda_compute_capability());
+  // ReductionTilingPicker may have measured a better tile along the reduced
+  // dimension.
+  auto reduction_config =
+      unnested_hlo->backend_config<ReductionBackendConfig>();
+  if (reduction_config.ok() && reduction_config.ValueOrDie().tile_size() > 0) {
+    reduction_tiling[reduction_dimensions.is_row_reduction ? 2 : 1] =
+        reduction_config.ValueOrDie().tile_size();
+  }
 
   int64 num_threads_y = reduction_dimensions.is_row_reduction ? 1 : kWarpSize;
   int64 num_threads_x = [&] {
@@ -0,0 +1,299 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/reduction_tiling_picker.h"
+
+#include <iterator>
+#include <limits>
+#include <tuple>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/error_spec.h"
+#include "tensorflow/compiler/xla/literal_comparison.h"
+#include "tensorflow/compiler/xla/primitive_util.h"
+#include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
+#include "tensorflow/compiler/xla/service/hlo_clone_context.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/service_executable_run_options.h"
+#include "tensorflow/compiler/xla/service/shaped_buffer.h"
+#include "tensorflow/compiler/xla/service/transfer_manager.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Candidate tile sizes along the reduced dimension, see GetReductionTiling for
+// the defaults.
+constexpr int64 kRowReductionTileSizes[] = {4, 8, 16, 32, 64};
+constexpr int64 kColumnReductionTileSizes[] = {16, 32, 64, 128, 256, 512};
+
+using ReductionCacheKey = std::tuple<se::StreamExecutor*, std::string>;
+
+static tensorflow::mutex autotune_cache_mu(tensorflow::LINKER_INITIALIZED);
+static auto& autotune_cache TF_GUARDED_BY(autotune_cache_mu) =
+    *new absl::flat_hash_map<ReductionCacheKey, int64>();
+
+// Returns the reduction IrEmitterUnnested derives the tiling of `instr` from,
+// or nullptr if `instr` is not emitted as a tiled reduction.
+const HloInstruction* GetFirstReduce(const HloInstruction& instr) {
+  if (instr.opcode() == HloOpcode::kReduce) {
+    return IsReductionFromOrToContiguousDimensions(instr) ? &instr : nullptr;
+  }
+  if (instr.opcode() != HloOpcode::kFusion || !instr.IsInputFusion()) {
+    return nullptr;
+  }
+  const HloInstruction* root = instr.fused_expression_root();
+  if (root->opcode() != HloOpcode::kTuple) {
+    return IsReductionFromOrToContiguousDimensions(*root) ? root : nullptr;
+  }
+  for (const HloInstruction* output : root->operands()) {
+    if (IsReductionFromOrToContiguousDimensions(*output)) {
+      return output;
+    }
+  }
+  return nullptr;
+}
+
+// Returns a module that computes `instr` from parameters, with `tile_size`
+// in its ReductionBackendConfig.
+StatusOr<std::unique_ptr<HloModule>> ExtractInstruction(
+    const HloInstruction& instr, int64 tile_size) {
+  ProgramShape program_shape;
+  for (const HloInstruction* operand : instr.operands()) {
+    *program_shape.add_parameters() = operand->shape();
+    program_shape.add_parameter_names(
+        absl::StrCat("p", program_shape.parameters_size() - 1));
+  }
+  *program_shape.mutable_result() = instr.shape();
+
+  HloModuleConfig config(program_shape, /*ignore_layouts=*/false);
+  DebugOptions debug_options = instr.GetModule()->config().debug_options();
+  debug_options.set_xla_gpu_autotune_reductions(false);
+  debug_options.set_xla_dump_to("");
+  config.set_debug_options(debug_options);
+  auto module = absl::make_unique<HloModule>(
+      absl::StrCat("reduction_tiling_", instr.name()), config);
+
+  HloComputation::Builder builder("entry");
+  std::vector<HloInstruction*> parameters;
+  for (int64 i = 0; i < instr.operand_count(); ++i) {
+    parameters.push_back(builder.AddInstruction(HloInstruction::CreateParameter(
+        i, instr.operand(i)->shape(), program_shape.parameter_names(i))));
+  }
+  HloCloneContext context(module.get());
+  std::unique_ptr<HloInstruction> clone =
+      instr.CloneWithNewOperands(instr.shape(), parameters, &context);
+  ReductionBackendConfig reduction_config;
+  reduction_config.set_tile_size(tile_size);
+  TF_RETURN_IF_ERROR(clone->set_backend_config(reduction_config));
+  builder.AddInstruction(std::move(clone));
+  module->AddEntryComputation(builder.Build());
+  return std::move(module);
+}
+
+}  // namespace
+
+/* static */ Status ReductionTilingPicker::CompareOutputs(
+    const Literal& reference, const Literal& output) {
+  // Tile sizes change the order in which elements are accumulated, so floating
+  // point results may differ by rounding. Integral results must be equal.
+  return literal_comparison::Near(reference, output,
+                                  ErrorSpec(/*aabs=*/1e-2, /*arel=*/1e-2),
+                                  /*detailed_message=*/false,
+                                  /*miscompare_callback=*/nullptr);
+}
+
+StatusOr<uint64> ReductionTilingPicker::TimeTileSize(
+    const HloInstruction& instr, int64 tile_size, se::Stream* stream,
+    absl::Span<const ShapedBuffer* const> arguments, Literal* output) {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                      ExtractInstruction(instr, tile_size));
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<Executable> executable,
+      compiler_->RunBackend(std::move(module), stream_exec_, allocator_));
+
+  ExecutableRunOptions run_options;
+  run_options.set_stream(stream);
+  run_options.set_allocator(allocator_);
+  run_options.set_device_ordinal(stream_exec_->device_ordinal());
+  ServiceExecutableRunOptions service_run_options(run_options);
+
+  // Don't run autotuning concurrently on the same GPU.
+  tensorflow::mutex_lock gpu_lock = LockGpu(stream_exec_);
+
+  // The first run loads the kernels.
+  TF_RETURN_IF_ERROR(executable
+                         ->ExecuteOnStream(&service_run_options, arguments,
+                                           /*hlo_execution_profile=*/nullptr)
+                         .status());
+
+  se::Timer timer(stream_exec_);
+  stream->InitTimer(&timer).ThenStartTimer(&timer);
+  TF_ASSIGN_OR_RETURN(
+      ScopedShapedBuffer result,
+      executable->ExecuteAsyncOnStream(&service_run_options, arguments,
+                                       /*hlo_execution_profile=*/nullptr));
+  stream->ThenStopTimer(&timer);
+  TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+
+  TF_ASSIGN_OR_RETURN(
+      TransferManager * transfer_manager,
+      TransferManager::GetForPlatform(stream_exec_->platform()));
+  TF_ASSIGN_OR_RETURN(
+      *output, transfer_manager->TransferLiteralFromDevice(stream, result));
+  return timer.Nanoseconds();
+}
+
+StatusOr<int64> ReductionTilingPicker::PickTileSize(const HloInstruction& instr,
+                                                    bool is_row_reduction) {
+  ReductionCacheKey key(stream_exec_,
+                        instr.ToString(HloPrintOptions::Canonical()));
+  {
+    tensorflow::mutex_lock cache_lock(autotune_cache_mu);
+    auto it = autotune_cache.find(key);
+    if (it != autotune_cache.end()) {
+      VLOG(4) << "Autotuning cache hit, using tile size " << it->second;
+      return it->second;
+    }
+  }
+
+  TF_ASSIGN_OR_RETURN(se::Stream* const stream,
+                      allocator_->GetStream(stream_exec_->device_ordinal()));
+  int64 rng_state = 0;
+  std::vector<ScopedShapedBuffer> argument_buffers;
+  for (const HloInstruction* operand : instr.operands()) {
+    const Shape& shape = operand->shape();
+    TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory memory,
+                        allocator_->Allocate(stream_exec_->device_ordinal(),
+                                             ShapeUtil::ByteSizeOf(shape)));
+    if (primitive_util::IsFloatingPointType(shape.element_type())) {
+      InitializeBuffer(stream, shape.element_type(), &rng_state, *memory);
+    } else {
+      se::DeviceMemoryBase buffer = *memory;
+      stream->ThenMemZero(&buffer, buffer.size());
+    }
+    argument_buffers.emplace_back(shape, shape, allocator_,
+                                  stream_exec_->device_ordinal());
+    argument_buffers.back().set_buffer(std::move(memory), {});
+  }
+  std::vector<const ShapedBuffer*> arguments;
+  for (const ScopedShapedBuffer& buffer : argument_buffers) {
+    arguments.push_back(&buffer);
+  }
+
+  // Tile size 0 is the default heuristic, which is kept unless another
+  // candidate is faster. Its output is the reference the other candidates are
+  // checked against, so if it fails, no other candidate is tried.
+  int64 best_tile_size = 0;
+  uint64 best_time = std::numeric_limits<uint64>::max();
+  Literal reference;
+  StatusOr<uint64> default_time =
+      TimeTileSize(instr, /*tile_size=*/0, stream, arguments, &reference);
+  if (default_time.ok()) {
+    VLOG(3) << instr.name() << " with the default tiling: "
+            << default_time.ValueOrDie() << "ns";
+    best_time = default_time.ValueOrDie();
+  } else {
+    VLOG(1) << "The default tiling failed for " << instr.name() << ": "
+            << default_time.status();
+  }
+
+  std::vector<int64> candidates;
+  if (default_time.ok() && is_row_reduction) {
+    absl::c_copy(kRowReductionTileSizes, std::back_inserter(candidates));
+  } else if (default_time.ok()) {
+    absl::c_copy(kColumnReductionTileSizes, std::back_inserter(candidates));
+  }
+  for (int64 tile_size : candidates) {
+    Literal output;
+    StatusOr<uint64> time =
+        TimeTileSize(instr, tile_size, stream, arguments, &output);
+    if (!time.ok()) {
+      VLOG(1) << "Tile size " << tile_size << " failed for " << instr.name()
+              << ": " << time.status();
+      continue;
+    }
+    Status compare_status = CompareOutputs(reference, output);
+    if (!compare_status.ok()) {
+      LOG(ERROR) << "Results mismatch between tile size " << tile_size
+                 << " and the default tiling of " << instr.name()
+                 << ", ignoring that tile size: " << compare_status;
+      continue;
+    }
+    VLOG(3) << instr.name() << " with tile size " << tile_size << ": "
+            << time.ValueOrDie() << "ns";
+    if (time.ValueOrDie() < best_time) {
+      best_time = time.ValueOrDie();
+      best_tile_size = tile_size;
+    }
+  }
+
+  tensorflow::mutex_lock cache_lock(autotune_cache_mu);
+  autotune_cache.emplace(key, best_tile_size);
+  return best_tile_size;
+}
+
+StatusOr<bool> ReductionTilingPicker::Run(HloModule* module) {
+  XLA_SCOPED_LOGGING_TIMER("ReductionTilingPicker");
+  const DebugOptions& debug_options = module->config().debug_options();
+  if (!debug_options.xla_gpu_autotune_reductions() ||
+      debug_options.xla_gpu_autotune_level() == 0) {
+    return false;
+  }
+  if (allocator_ == nullptr) {
+    allocator_ = stream_exec_->GetAllocator();
+  }
+
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    for (HloInstruction* instr : computation->instructions()) {
+      const HloInstruction* first_reduce = GetFirstReduce(*instr);
+      if (first_reduce == nullptr ||
+          absl::c_any_of(instr->operands(), [](const HloInstruction* operand) {
+            return !operand->shape().IsArray();
+          })) {
+        continue;
+      }
+      bool is_row_reduction =
+          GetReductionKindAndContiguousComponents(*first_reduce)
+              .is_row_reduction;
+      TF_ASSIGN_OR_RETURN(int64 tile_size,
+                          PickTileSize(*instr, is_row_reduction));
+      if (tile_size == 0) {
+        continue;
+      }
+      VLOG(2) << "Using tile size " << tile_size << " for " << instr->name();
+      ReductionBackendConfig reduction_config;
+      reduction_config.set_tile_size(tile_size);
+      TF_RETURN_IF_ERROR(instr->set_backend_config(reduction_config));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
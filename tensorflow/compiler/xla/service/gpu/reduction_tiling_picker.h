@@ -0,0 +1,77 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_TILING_PICKER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_TILING_PICKER_H_
+
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/service/compiler.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/service/shaped_buffer.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/stream_executor/device_memory_allocator.h"
+
+namespace xla {
+namespace gpu {
+
+// Picks the tile size along the reduced dimension of reductions (unnested or
+// fused) by compiling each one on its own with a few candidate tile sizes and
+// timing it on `stream_exec`. Candidates whose output differs from that of the
+// default tiling are rejected. The choice is recorded in the reduction's
+// ReductionBackendConfig, which IrEmitterUnnested honors, and cached for the
+// lifetime of the process.
+//
+// Runs only if xla_gpu_autotune_reductions is set, after fusion.
+class ReductionTilingPicker : public HloModulePass {
+ public:
+  // `compiler` is used to compile the candidates and must outlive this pass.
+  ReductionTilingPicker(Compiler* compiler, se::StreamExecutor* stream_exec,
+                        se::DeviceMemoryAllocator* allocator)
+      : compiler_(compiler), stream_exec_(stream_exec), allocator_(allocator) {}
+
+  absl::string_view name() const override { return "reduction-tiling-picker"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+  // Returns an error if `output`, computed with a candidate tile size, differs
+  // from `reference`, computed with the default tiling, by more than floating
+  // point reassociation can explain.
+  static Status CompareOutputs(const Literal& reference, const Literal& output);
+
+ private:
+  // Returns the fastest tile size for `instr` among those whose output matches
+  // that of the default heuristic, or 0 if the default heuristic is the
+  // fastest.
+  StatusOr<int64> PickTileSize(const HloInstruction& instr,
+                               bool is_row_reduction);
+
+  // Compiles `instr` with the given tile size and returns the time it takes to
+  // run on `stream` with `arguments`, in nanoseconds. The result of the run is
+  // copied to `output`.
+  StatusOr<uint64> TimeTileSize(
+      const HloInstruction& instr, int64 tile_size, se::Stream* stream,
+      absl::Span<const ShapedBuffer* const> arguments, Literal* output);
+
+  Compiler* compiler_;
+  se::StreamExecutor* stream_exec_;
+  se::DeviceMemoryAllocator* allocator_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_TILING_PICKER_H_
@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/reduction_tiling_picker.h"
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+TEST(ReductionTilingPickerTest, AcceptsSameOutput) {
+  Literal reference = LiteralUtil::CreateR1<float>({1.5f, -2.0f, 1024.0f});
+  TF_EXPECT_OK(ReductionTilingPicker::CompareOutputs(reference,
+                                                     reference.Clone()));
+}
+
+TEST(ReductionTilingPickerTest, AcceptsReassociatedOutput) {
+  // Summing in another order changes the last bits of the result.
+  Literal reference = LiteralUtil::CreateR1<float>({1.0f, 1000.0f});
+  Literal output = LiteralUtil::CreateR1<float>({1.0000001f, 1000.0001f});
+  TF_EXPECT_OK(ReductionTilingPicker::CompareOutputs(reference, output));
+}
+
+TEST(ReductionTilingPickerTest, RejectsWrongOutput) {
+  Literal reference = LiteralUtil::CreateR1<float>({1.0f, 1000.0f});
+  Literal output = LiteralUtil::CreateR1<float>({1.0f, 1100.0f});
+  EXPECT_FALSE(ReductionTilingPicker::CompareOutputs(reference, output).ok());
+}
+
+TEST(ReductionTilingPickerTest, RejectsDifferentIntegralOutput) {
+  Literal reference = LiteralUtil::CreateR1<int32>({1, 1000});
+  Literal output = LiteralUtil::CreateR1<int32>({1, 1001});
+  EXPECT_FALSE(ReductionTilingPicker::CompareOutputs(reference, output).ok());
+}
+
+TEST(ReductionTilingPickerTest, RejectsWrongTupleElement) {
+  // Multi-output fusions produce tuples, all elements of which are checked.
+  Literal reference =
+      LiteralUtil::MakeTupleOwned(LiteralUtil::CreateR1<float>({1.0f, 2.0f}),
+                                  LiteralUtil::CreateR1<float>({3.0f, 4.0f}));
+  Literal output =
+      LiteralUtil::MakeTupleOwned(LiteralUtil::CreateR1<float>({1.0f, 2.0f}),
+                                  LiteralUtil::CreateR1<float>({3.0f, 5.0f}));
+  EXPECT_FALSE(ReductionTilingPicker::CompareOutputs(reference, output).ok());
+  TF_EXPECT_OK(
+      ReductionTilingPicker::CompareOutputs(reference, reference.Clone()));
+}
+
+TEST(ReductionTilingPickerTest, RejectsDifferentShape) {
+  Literal reference = LiteralUtil::CreateR1<float>({1.0f, 2.0f});
+  Literal output = LiteralUtil::CreateR1<float>({1.0f, 2.0f, 3.0f});
+  EXPECT_FALSE(ReductionTilingPicker::CompareOutputs(reference, output).ok());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -18,6 +18,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/map_util.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
@@ -58,14 +59,23 @@ inline bool IsStreamNumValid(int stream_num) {
   return stream_num != kInvalidStreamNum;
 }
 
+// Returns whether `copy_start` copies its operand to host memory.
+bool IsCopyToHost(const HloInstruction& copy_start) {
+  const Shape& destination = copy_start.shape().tuple_shapes(0);
+  return destination.has_layout() &&
+         destination.layout().memory_space() == kHostMemorySpace;
+}
+
 // Returns which existing stream to assign to `hlo`, or -1 if a stream is not
 // needed. `stream_assignment` is the existing stream assignment for all
 // instructions topologically before `hlo`. `seen_gemms` contains all GEMMs that
-// are topologically before `hlo`.
+// are topologically before `hlo`. `copy_streams` are the streams reserved for
+// asynchronous copies, which no other instruction is assigned to.
 int ComputeStreamToAssign(
     const HloInstruction& hlo, const StreamAssignment& stream_assignment,
     const HloReachabilityMap& reachability,
-    const std::vector<const HloInstruction*>& seen_gemms) {
+    const std::vector<const HloInstruction*>& seen_gemms,
+    const absl::flat_hash_set<int>& copy_streams) {
   if (hlo.opcode() == HloOpcode::kParameter ||
       hlo.opcode() == HloOpcode::kConstant) {
     // kParameter and kConstant do not need a thunk.
@@ -84,7 +94,9 @@ int ComputeStreamToAssign(
     // avoid excessive synchronization.
     int stream_num = -1;
     for (const auto* operand : hlo.operands()) {
-      if (stream_assignment.HasStreamAssigned(*operand)) {
+      if (stream_assignment.HasStreamAssigned(*operand) &&
+          !copy_streams.contains(
+              stream_assignment.StreamNumberForHlo(*operand))) {
         stream_num = std::max(stream_num,
                               stream_assignment.StreamNumberForHlo(*operand));
       }
@@ -99,7 +111,7 @@ int ComputeStreamToAssign(
   // greedy approach. First, we compute as forbidden_stream_numbers the
   // streams assigned to GEMMs that are concurrent with `hlo`. Then, we assign
   // `hlo` a different stream.
-  absl::flat_hash_set<int> forbidden_stream_numbers;
+  absl::flat_hash_set<int> forbidden_stream_numbers = copy_streams;
   for (const auto* seen_gemm : seen_gemms) {
     int stream_num = stream_assignment.StreamNumberForHlo(*seen_gemm);
     if (!forbidden_stream_numbers.contains(stream_num) &&
@@ -132,14 +144,38 @@ std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
   // TODO(b/111791052): If we remove such a common variable, we will need to
   // clean up the code here.
   int stream_num_for_rng = kInvalidStreamNum;
+  // Copies to and from host memory run on two streams of their own, so that
+  // they overlap with compute and with each other.
+  const bool multi_streaming =
+      !module.config().debug_options().xla_gpu_disable_multi_streaming();
+  int stream_num_for_copies_to_host = kInvalidStreamNum;
+  int stream_num_for_copies_from_host = kInvalidStreamNum;
+  absl::flat_hash_set<int> copy_streams;
   for (const auto* hlo : computation.MakeInstructionPostOrder()) {
-    // If we ever enable fusion of RNG instructions, we will need to extend this
-    // code to look inside a fused instruction.
-    int stream_num = (hlo->opcode() == HloOpcode::kRng &&
-                      IsStreamNumValid(stream_num_for_rng))
-                         ? stream_num_for_rng
-                         : ComputeStreamToAssign(*hlo, *stream_assignment,
-                                                 *reachability, seen_gemms);
+    int stream_num;
+    if (hlo->opcode() == HloOpcode::kCopyStart && multi_streaming) {
+      int& copy_stream = IsCopyToHost(*hlo) ? stream_num_for_copies_to_host
+                                            : stream_num_for_copies_from_host;
+      if (!IsStreamNumValid(copy_stream)) {
+        // Never share stream 0, which runs everything else.
+        copy_stream = std::max(stream_assignment->StreamCount(), 1);
+        copy_streams.insert(copy_stream);
+      }
+      stream_num = copy_stream;
+    } else if (hlo->opcode() == HloOpcode::kCopyDone && multi_streaming) {
+      // CopyDone has no thunk of its own; keeping it on the stream of the copy
+      // makes its users wait for the copy.
+      stream_num = stream_assignment->StreamNumberForHlo(*hlo->operand(0));
+    } else if (hlo->opcode() == HloOpcode::kRng &&
+               IsStreamNumValid(stream_num_for_rng)) {
+      // If we ever enable fusion of RNG instructions, we will need to extend
+      // this code to look inside a fused instruction.
+      stream_num = stream_num_for_rng;
+    } else {
+      stream_num = ComputeStreamToAssign(*hlo, *stream_assignment,
+                                         *reachability, seen_gemms,
+                                         copy_streams);
+    }
     if (IsStreamNumValid(stream_num)) {
       stream_assignment->AssignStreamToHlo(hlo, stream_num);
       if (hlo->opcode() == HloOpcode::kRng &&
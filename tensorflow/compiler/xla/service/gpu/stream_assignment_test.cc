@@ -139,5 +139,41 @@ TEST_F(StreamAssignmentTest, LatticeMatMul) {
             assignment->StreamNumberForHlo(*d31));
 }
 
+TEST_F(StreamAssignmentTest, CopiesToAndFromHost) {
+  const char* const hlo_text = R"(
+HloModule CopiesToAndFromHost
+
+ENTRY entry {
+  x = f32[2,2]{1,0} parameter(0)
+  negate = f32[2,2]{1,0} negate(x)
+  to_host = (f32[2,2]{1,0:S(1)}, f32[2,2]{1,0}, u32[]) copy-start(negate)
+  on_host = f32[2,2]{1,0:S(1)} copy-done(to_host)
+  from_host = (f32[2,2]{1,0}, f32[2,2]{1,0:S(1)}, u32[]) copy-start(on_host)
+  on_device = f32[2,2]{1,0} copy-done(from_host)
+  exp = f32[2,2]{1,0} exponential(negate)
+  ROOT add = f32[2,2]{1,0} add(exp, on_device)
+}
+)";
+  HloModuleConfig config;
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_disable_multi_streaming(false);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text, config));
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  auto stream = [&](absl::string_view name) {
+    return assignment->StreamNumberForHlo(*FindInstruction(module.get(), name));
+  };
+  EXPECT_EQ(stream("negate"), 0);
+  EXPECT_NE(stream("to_host"), 0);
+  EXPECT_NE(stream("from_host"), 0);
+  EXPECT_NE(stream("to_host"), stream("from_host"));
+  EXPECT_EQ(stream("on_host"), stream("to_host"));
+  EXPECT_EQ(stream("on_device"), stream("from_host"));
+  // Users of the copies stay on the compute stream.
+  EXPECT_EQ(stream("add"), 0);
+}
+
 }  // namespace gpu
 }  // namespace xla
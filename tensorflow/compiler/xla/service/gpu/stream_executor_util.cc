@@ -207,11 +207,13 @@ StatusOr<std::unique_ptr<se::KernelBase>> CreateKernel(
   return std::move(kernel_base);
 }
 
-Status ExecuteKernelOnStream(const se::KernelBase& kernel,
-                             absl::Span<const se::DeviceMemoryBase> args,
-                             const LaunchDimensions& dims, se::Stream* stream) {
-  static constexpr int kKernelArgsLimit = 1024;
-  auto kernel_args = absl::make_unique<se::KernelArgsArray<kKernelArgsLimit>>();
+namespace {
+
+template <typename KernelArgs>
+Status LaunchWithArgs(const se::KernelBase& kernel,
+                      absl::Span<const se::DeviceMemoryBase> args,
+                      const LaunchDimensions& dims, se::Stream* stream,
+                      KernelArgs* kernel_args) {
   for (const se::DeviceMemoryBase& buf : args) {
     kernel_args->add_device_memory_argument(buf);
   }
@@ -223,6 +225,23 @@ Status ExecuteKernelOnStream(const se::KernelBase& kernel,
       *kernel_args);
 }
 
+}  // namespace
+
+Status ExecuteKernelOnStream(const se::KernelBase& kernel,
+                             absl::Span<const se::DeviceMemoryBase> args,
+                             const LaunchDimensions& dims, se::Stream* stream) {
+  // Most kernels take few arguments, whose list is kept on the stack rather
+  // than heap allocated for every launch.
+  static constexpr int kSmallKernelArgsLimit = 64;
+  static constexpr int kKernelArgsLimit = 1024;
+  if (args.size() <= kSmallKernelArgsLimit) {
+    se::KernelArgsArray<kSmallKernelArgsLimit> kernel_args;
+    return LaunchWithArgs(kernel, args, dims, stream, &kernel_args);
+  }
+  auto kernel_args = absl::make_unique<se::KernelArgsArray<kKernelArgsLimit>>();
+  return LaunchWithArgs(kernel, args, dims, stream, kernel_args.get());
+}
+
 se::cuda::PtxCompilationOptions PtxOptsFromConfig(
     const HloModuleConfig& hlo_module_config) {
   string extra_string = hlo_module_config.debug_options().xla_gpu_asm_extra_flags();
@@ -39,11 +39,14 @@ void ThunkSchedule::AddDependenciesOnTransitiveOperands(
     }
   } else {
     // If `operand` doesn't need a thunk (e.g. bitcast), continue with its
-    // operands.
+    // operands and control predecessors.
     for (const auto* operand_of_operand : operand.operands()) {
       AddDependenciesOnTransitiveOperands(thunk, *operand_of_operand,
                                           hlo_to_thunk);
     }
+    for (const auto* predecessor : operand.control_predecessors()) {
+      AddDependenciesOnTransitiveOperands(thunk, *predecessor, hlo_to_thunk);
+    }
   }
 }
 
@@ -70,6 +73,11 @@ ThunkSchedule::ThunkSchedule(
     for (const auto* src : dst->operands()) {
       AddDependenciesOnTransitiveOperands(*thunk, *src, hlo_to_thunk);
     }
+    // Control predecessors have to finish first too, e.g. before an
+    // asynchronous copy overwrites buffers they use.
+    for (const auto* src : dst->control_predecessors()) {
+      AddDependenciesOnTransitiveOperands(*thunk, *src, hlo_to_thunk);
+    }
   }
 
   RemoveRedundantDependencyEdges();
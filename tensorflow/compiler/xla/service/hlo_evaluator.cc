@@ -49,7 +49,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/bitmap.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -2450,13 +2454,45 @@ Status HloEvaluator::HandleReduce(HloInstruction* instr) {
     results[i] = Literal(is_tuple ? out_shape.tuple_shapes(i) : out_shape);
   }
 
-  TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
-      output_shape, [&](absl::Span<const int64> output_index) {
-        return GenerateReduceOutputElement(
-            output_index, init_values, input_args, absl::Span<Literal>(results),
-            function, &embedded_evaluator, arg_dim_steps, arg_dim_counts,
-            result_to_arg_index);
-      }));
+  if (!is_tuple && ShapeUtil::ElementIsFloating(init_values[0]->shape()) &&
+      IsScalarAdd(function)) {
+    // Floating point sums do not run the embedded computation, so the output
+    // elements are computed independently and can be sharded.
+    int64 reduced_elements = 1;
+    for (const int64 dim : dimensions_to_reduce) {
+      reduced_elements *= arg_dimensions[dim];
+    }
+    tensorflow::mutex mu;
+    Status status;
+    ParallelFor(
+        ShapeUtil::ElementsIn(output_shape),
+        kElementwiseCostPerUnit * std::max<int64>(reduced_elements, 1),
+        [&](int64 begin, int64 end) {
+          for (int64 i = begin; i < end; ++i) {
+            const std::vector<int64> output_index =
+                IndexUtil::LinearIndexToMultidimensionalIndex(output_shape, i);
+            StatusOr<bool> result = GenerateReduceOutputElement(
+                output_index, init_values, input_args,
+                absl::Span<Literal>(results), function,
+                /*embedded_evaluator=*/nullptr, arg_dim_steps, arg_dim_counts,
+                result_to_arg_index);
+            if (!result.ok()) {
+              tensorflow::mutex_lock lock(mu);
+              status.Update(result.status());
+              return;
+            }
+          }
+        });
+    TF_RETURN_IF_ERROR(status);
+  } else {
+    TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
+        output_shape, [&](absl::Span<const int64> output_index) {
+          return GenerateReduceOutputElement(
+              output_index, init_values, input_args,
+              absl::Span<Literal>(results), function, &embedded_evaluator,
+              arg_dim_steps, arg_dim_counts, result_to_arg_index);
+        }));
+  }
 
   if (is_tuple) {
     Literal tuple_result(inferred_return_shape);
@@ -2514,6 +2550,37 @@ Status HloEvaluator::Postprocess(HloInstruction* hlo) {
   return Status::OK();
 }
 
+/* static */ void HloEvaluator::ParallelFor(
+    int64 total, int64 cost_per_unit,
+    const std::function<void(int64, int64)>& fn) {
+  // Below this many cycles, scheduling shards costs more than it saves.
+  constexpr int64 kMinParallelCost = 1 << 20;
+  if (total <= 1 || total * cost_per_unit < kMinParallelCost) {
+    fn(0, total);
+    return;
+  }
+  static tensorflow::thread::ThreadPool* pool =
+      new tensorflow::thread::ThreadPool(tensorflow::Env::Default(),
+                                         "hlo_evaluator",
+                                         tensorflow::port::MaxParallelism());
+  pool->ParallelFor(total, cost_per_unit, fn);
+}
+
+/* static */ bool HloEvaluator::HasSameDenseLayout(
+    const Shape& shape, absl::Span<const Literal* const> literals) {
+  if (!LayoutUtil::IsDenseArray(shape)) {
+    return false;
+  }
+  for (const Literal* literal : literals) {
+    if (!LayoutUtil::IsDenseArray(literal->shape()) ||
+        !ShapeUtil::SameDimensions(shape, literal->shape()) ||
+        !LayoutUtil::Equal(shape.layout(), literal->shape().layout())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 namespace {
 template <typename T>
 std::unique_ptr<Array2D<T>> MatmulArray2DImpl(
@@ -326,6 +326,28 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   // Use fast path that uses eigen in the evaluator.
   bool use_fast_path_ = false;
 
+  // Rough cost in cycles of computing one element of an elementwise op
+  // through a std::function, used to decide whether to shard the op.
+  static constexpr int64 kElementwiseCostPerUnit = 32;
+
+  // Number of multiply-adds above which the elements of a dot are computed in
+  // parallel.
+  static constexpr int64 kMinParallelDotMultiplies = 1 << 20;
+
+  // Calls `fn` on shards of [0, total) on a thread pool shared by all
+  // evaluators, or once on the whole range if the work is too small to be
+  // worth sharding. `cost_per_unit` is the rough cost in cycles of one unit.
+  //
+  // `fn` must be thread-safe and must not evaluate HLO.
+  static void ParallelFor(int64 total, int64 cost_per_unit,
+                          const std::function<void(int64, int64)>& fn);
+
+  // Returns true if `literals` are dense arrays with the same layout as the
+  // array `shape`. Elementwise ops over literals with the same dimensions and
+  // layout can then walk their data linearly instead of by multi-index.
+  static bool HasSameDenseLayout(const Shape& shape,
+                                 absl::Span<const Literal* const> literals);
+
  private:
   template <typename ReturnT, typename NativeT>
   static StatusOr<Literal> ElementWiseUnaryOpImpl(
@@ -337,6 +359,18 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (HasSameDenseLayout(result.shape(), {&operand_literal})) {
+      absl::Span<const NativeT> operand_data =
+          operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      ParallelFor(result_data.size(), kElementwiseCostPerUnit,
+                  [&](int64 begin, int64 end) {
+                    for (int64 i = begin; i < end; ++i) {
+                      result_data[i] = unary_op(operand_data[i]);
+                    }
+                  });
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
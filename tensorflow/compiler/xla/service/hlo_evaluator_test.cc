@@ -321,6 +321,32 @@ TEST_F(HloEvaluatorTest, DoesAdd) {
   TestBinaryOp(HloOpcode::kAdd, std::move(expected), std::move(lhs),
                std::move(rhs));
 }
+// Verifies element-wise addition of operands large enough to be sharded, and
+// of operands with different layouts, which are indexed element by element.
+TEST_F(HloEvaluatorTest, DoesAddLargeAndMixedLayouts) {
+  Array2D<float> lhs_array(1024, 1024);
+  lhs_array.FillUnique(1.0f);
+  Array2D<float> rhs_array(1024, 1024, 0.5f);
+  Array2D<float> expected_array(1024, 1024);
+  for (int64 i = 0; i < 1024; ++i) {
+    for (int64 j = 0; j < 1024; ++j) {
+      expected_array(i, j) = lhs_array(i, j) + rhs_array(i, j);
+    }
+  }
+  TestBinaryOp(HloOpcode::kAdd,
+               LiteralUtil::CreateR2FromArray2D<float>(expected_array),
+               LiteralUtil::CreateR2FromArray2D<float>(lhs_array),
+               LiteralUtil::CreateR2FromArray2D<float>(rhs_array));
+
+  m_ = CreateNewVerifiedModule();
+  auto lhs = LiteralUtil::CreateR2WithLayout<float>(
+      {{1, 2}, {3, 4}}, LayoutUtil::MakeLayout({0, 1}));
+  auto rhs = LiteralUtil::CreateR2<float>({{10, 20}, {30, 40}});
+  auto expected = LiteralUtil::CreateR2<float>({{11, 22}, {33, 44}});
+  TestBinaryOp(HloOpcode::kAdd, std::move(expected), std::move(lhs),
+               std::move(rhs));
+}
+
 // Verifies that HloEvaluator evaluates a HLO instruction that performs
 // element-wise and with 2 operands.
 TEST_P(HloEvaluatorBf16Test, DoesAnd) {
@@ -919,6 +945,54 @@ TEST_P(HloEvaluatorBf16Test, DotRank2AndRank2) {
   EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
 }
 
+// Verifies a batched dot large enough for its elements to be computed in
+// parallel.
+TEST_F(HloEvaluatorTest, DotLargeBatched) {
+  HloComputation::Builder b(TestName());
+  constexpr int64 kBatch = 2;
+  constexpr int64 kSize = 128;
+  Array3D<float> lhs_array(kBatch, kSize, kSize);
+  Array3D<float> rhs_array(kBatch, kSize, kSize);
+  lhs_array.Each([](absl::Span<const int64> index, float* value) {
+    *value = (index[0] + index[1] * 3 + index[2] * 7) % 5;
+  });
+  rhs_array.Each([](absl::Span<const int64> index, float* value) {
+    *value = (index[0] * 2 + index[1] + index[2] * 5) % 3;
+  });
+  HloInstruction* lhs_instruction = b.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateFromArray(lhs_array)));
+  HloInstruction* rhs_instruction = b.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateFromArray(rhs_array)));
+
+  Shape shape = ShapeUtil::MakeShape(F32, {kBatch, kSize, kSize});
+  DotDimensionNumbers dot_dnums;
+  dot_dnums.add_lhs_batch_dimensions(0);
+  dot_dnums.add_rhs_batch_dimensions(0);
+  dot_dnums.add_lhs_contracting_dimensions(2);
+  dot_dnums.add_rhs_contracting_dimensions(1);
+  b.AddInstruction(HloInstruction::CreateDot(shape, lhs_instruction,
+                                             rhs_instruction, dot_dnums,
+                                             DefaultPrecisionConfig(2)));
+  m_->AddEntryComputation(b.Build());
+
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate());
+
+  Array3D<float> expected_array(kBatch, kSize, kSize);
+  for (int64 batch = 0; batch < kBatch; ++batch) {
+    for (int64 i = 0; i < kSize; ++i) {
+      for (int64 j = 0; j < kSize; ++j) {
+        float sum = 0;
+        for (int64 k = 0; k < kSize; ++k) {
+          sum += lhs_array(batch, i, k) * rhs_array(batch, k, j);
+        }
+        expected_array(batch, i, j) = sum;
+      }
+    }
+  }
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateFromArray(expected_array), result));
+}
+
 TEST_P(HloEvaluatorBf16Test, DotRank4AndRank4) {
   HloComputation::Builder b(TestName());
 
@@ -2624,6 +2698,51 @@ TEST_P(HloEvaluatorBf16Test, ReduceAdd) {
   EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
 }
 
+// Verifies a floating point sum large enough for its output elements to be
+// computed in parallel.
+TEST_F(HloEvaluatorTest, ReduceAddLarge) {
+  HloComputation::Builder b(TestName());
+  constexpr int64 kRows = 512;
+  constexpr int64 kCols = 2048;
+  Array2D<float> arg_array(kRows, kCols);
+  arg_array.Each([](int64 row, int64 col, float* value) {
+    *value = (row + col) % 4;
+  });
+  HloInstruction* arg_instruction = b.AddInstruction(
+      HloInstruction::CreateConstant(
+          LiteralUtil::CreateR2FromArray2D<float>(arg_array)));
+  auto init_value = b.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR0<float>(1.f)));
+
+  HloComputation::Builder add_computation("add");
+  Shape scalar_shape = ShapeUtil::MakeShape(F32, {});
+  auto param_lhs = add_computation.AddInstruction(
+      HloInstruction::CreateParameter(0, scalar_shape, "lhs"));
+  auto param_rhs = add_computation.AddInstruction(
+      HloInstruction::CreateParameter(1, scalar_shape, "rhs"));
+  add_computation.AddInstruction(HloInstruction::CreateBinary(
+      scalar_shape, HloOpcode::kAdd, param_lhs, param_rhs));
+  auto add_func = m_->AddEmbeddedComputation(add_computation.Build());
+
+  Shape shape = ShapeUtil::MakeShape(F32, {kRows});
+  b.AddInstruction(
+      HloInstruction::CreateReduce(shape, arg_instruction, init_value,
+                                   /*dimensions_to_reduce=*/{1}, add_func));
+  m_->AddEntryComputation(b.Build());
+
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate());
+
+  std::vector<float> expected(kRows);
+  for (int64 row = 0; row < kRows; ++row) {
+    expected[row] = 1.f;
+    for (int64 col = 0; col < kCols; ++col) {
+      expected[row] += arg_array(row, col);
+    }
+  }
+  EXPECT_TRUE(LiteralTestUtil::Equal(LiteralUtil::CreateR1<float>(expected),
+                                     result));
+}
+
 TEST_P(HloEvaluatorBf16Test, ReduceWindowMax) {
   HloComputation::Builder b(TestName());
 
@@ -1321,12 +1321,13 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     CHECK_EQ(dnums.lhs_batch_dimensions_size(),
              dnums.rhs_batch_dimensions_size());
 
-    DimensionVector lhs_index(lhs_rank);
-    DimensionVector rhs_index(rhs_rank);
-
-    // result_index_locations[i] contains one or two pointers to the locations
-    // in lhs_index or rhs_index where the i'th result index should go.
-    absl::InlinedVector<std::pair<int64*, int64*>, kInlineRank>
+    // The lhs and rhs indices are kept together, the lhs index first, so that
+    // every element of the result can be computed with its own copy.
+    //
+    // result_index_locations[i] contains one or two positions in that index
+    // where the i'th result index should go, the second one being -1 if
+    // unused.
+    absl::InlinedVector<std::pair<int64, int64>, kInlineRank>
         result_index_locations;
     result_index_locations.reserve(
         (lhs_rank - dnums.lhs_contracting_dimensions_size()) +
@@ -1336,80 +1337,94 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     // dimensions:
     for (int64 i = 0; i < dnums.lhs_batch_dimensions_size(); i++) {
       result_index_locations.push_back(
-          {&lhs_index[dnums.lhs_batch_dimensions(i)],
-           &rhs_index[dnums.rhs_batch_dimensions(i)]});
+          {dnums.lhs_batch_dimensions(i),
+           lhs_rank + dnums.rhs_batch_dimensions(i)});
     }
 
     // Then we have the LHS and RHS non-contracting dimensions, if any:
     for (int64 i = 0; i < lhs_rank; i++) {
       if (!absl::c_linear_search(dnums.lhs_contracting_dimensions(), i) &&
           !absl::c_linear_search(dnums.lhs_batch_dimensions(), i)) {
-        result_index_locations.push_back({&lhs_index[i], nullptr});
+        result_index_locations.push_back({i, -1});
       }
     }
     for (int64 i = 0; i < rhs_rank; i++) {
       if (!absl::c_linear_search(dnums.rhs_contracting_dimensions(), i) &&
           !absl::c_linear_search(dnums.rhs_batch_dimensions(), i)) {
-        result_index_locations.push_back({&rhs_index[i], nullptr});
+        result_index_locations.push_back({lhs_rank + i, -1});
       }
     }
 
     absl::InlinedVector<int64, kInlineRank> accumulate_index_sizes;
     accumulate_index_sizes.reserve(dnums.lhs_contracting_dimensions_size());
-    absl::InlinedVector<std::pair<int64*, int64*>, kInlineRank>
+    absl::InlinedVector<std::pair<int64, int64>, kInlineRank>
         accumulate_index_locations;
     accumulate_index_locations.reserve(dnums.lhs_contracting_dimensions_size());
     for (int64 i = 0; i < dnums.lhs_contracting_dimensions_size(); ++i) {
       const int64 lhs_dnum = dnums.lhs_contracting_dimensions(i);
       const int64 rhs_dnum = dnums.rhs_contracting_dimensions(i);
-      accumulate_index_locations.push_back(
-          {&lhs_index[lhs_dnum], &rhs_index[rhs_dnum]});
+      accumulate_index_locations.push_back({lhs_dnum, lhs_rank + rhs_dnum});
       const int64 dim_size = lhs->shape().dimensions(lhs_dnum);
       accumulate_index_sizes.push_back(dim_size);
     }
     const int64 total_contraction_size = Product(accumulate_index_sizes);
-    Literal result(dot->shape());
-    TF_RETURN_IF_ERROR(
-        result.Populate<ReturnT>([&](absl::Span<const int64> result_index) {
-          ElementwiseT result_val = static_cast<ElementwiseT>(0);
-
-          for (int64 i = 0; i < result_index.size(); i++) {
-            *result_index_locations[i].first = result_index[i];
-            if (result_index_locations[i].second) {
-              *result_index_locations[i].second = result_index[i];
-            }
-          }
+    auto generator = [&](absl::Span<const int64> result_index) {
+      ElementwiseT result_val = static_cast<ElementwiseT>(0);
 
-          // Accumulates resulting product along the contracted dimension.
-          absl::InlinedVector<int64, kInlineRank> accumulate_index(
-              accumulate_index_sizes.size(), 0);
-          for (int64 k = 0; k < total_contraction_size; k++) {
-            for (int64 i = 0; i < accumulate_index_sizes.size(); ++i) {
-              *(accumulate_index_locations[i].first) = accumulate_index[i];
-              *(accumulate_index_locations[i].second) = accumulate_index[i];
-            }
+      DimensionVector lhs_rhs_index(lhs_rank + rhs_rank);
+      for (int64 i = 0; i < result_index.size(); i++) {
+        lhs_rhs_index[result_index_locations[i].first] = result_index[i];
+        if (result_index_locations[i].second >= 0) {
+          lhs_rhs_index[result_index_locations[i].second] = result_index[i];
+        }
+      }
+      const absl::Span<const int64> lhs_index =
+          absl::MakeConstSpan(lhs_rhs_index).subspan(0, lhs_rank);
+      const absl::Span<const int64> rhs_index =
+          absl::MakeConstSpan(lhs_rhs_index).subspan(lhs_rank);
+
+      // Accumulates resulting product along the contracted dimension.
+      absl::InlinedVector<int64, kInlineRank> accumulate_index(
+          accumulate_index_sizes.size(), 0);
+      for (int64 k = 0; k < total_contraction_size; k++) {
+        for (int64 i = 0; i < accumulate_index_sizes.size(); ++i) {
+          lhs_rhs_index[accumulate_index_locations[i].first] =
+              accumulate_index[i];
+          lhs_rhs_index[accumulate_index_locations[i].second] =
+              accumulate_index[i];
+        }
 
-            ElementwiseT lhs_val(lhs_literal.Get<ReturnT>(lhs_index));
-            ElementwiseT rhs_val(rhs_literal.Get<ReturnT>(rhs_index));
-            result_val +=
-                ToArithmeticSafeType(lhs_val) * ToArithmeticSafeType(rhs_val);
-
-            // If there are no contracting dimension accumulate_index_sizes is
-            // empty, do not try to count down from -1 to 0 since it is and
-            // infinite loop.
-            if (!accumulate_index_sizes.empty()) {
-              for (int64 i = accumulate_index_sizes.size() - 1; i >= 0; --i) {
-                int64 value = ++accumulate_index[i];
-                if (value != accumulate_index_sizes[i]) {
-                  break;
-                }
-                accumulate_index[i] = 0;
-              }
+        ElementwiseT lhs_val(lhs_literal.Get<ReturnT>(lhs_index));
+        ElementwiseT rhs_val(rhs_literal.Get<ReturnT>(rhs_index));
+        result_val +=
+            ToArithmeticSafeType(lhs_val) * ToArithmeticSafeType(rhs_val);
+
+        // If there are no contracting dimension accumulate_index_sizes is
+        // empty, do not try to count down from -1 to 0 since it is and
+        // infinite loop.
+        if (!accumulate_index_sizes.empty()) {
+          for (int64 i = accumulate_index_sizes.size() - 1; i >= 0; --i) {
+            int64 value = ++accumulate_index[i];
+            if (value != accumulate_index_sizes[i]) {
+              break;
             }
+            accumulate_index[i] = 0;
           }
+        }
+      }
 
-          return static_cast<ReturnT>(result_val);
-        }));
+      return static_cast<ReturnT>(result_val);
+    };
+
+    Literal result(dot->shape());
+    // Every result element is computed independently, so large dots are
+    // computed in parallel; small ones are not worth the thread pool.
+    if (ShapeUtil::ElementsIn(dot->shape()) * total_contraction_size >=
+        HloEvaluator::kMinParallelDotMultiplies) {
+      TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(generator));
+    } else {
+      TF_RETURN_IF_ERROR(result.Populate<ReturnT>(generator));
+    }
 
     parent_->evaluated_[dot] = std::move(result);
     return Status::OK();
@@ -2839,6 +2854,22 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
+    if (HloEvaluator::HasSameDenseLayout(result.shape(),
+                                         {&lhs_literal, &rhs_literal})) {
+      auto op = ConvertBinaryFunction(binary_op);
+      absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+      absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      HloEvaluator::ParallelFor(
+          result_data.size(), HloEvaluator::kElementwiseCostPerUnit,
+          [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              result_data[i] = op(lhs_data[i], rhs_data[i]);
+            }
+          });
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return ConvertBinaryFunction(binary_op)(
@@ -2866,6 +2897,23 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
+    if (HloEvaluator::HasSameDenseLayout(
+            result.shape(), {&lhs_literal, &rhs_literal, &ehs_literal})) {
+      absl::Span<const LhsType> lhs_data = lhs_literal.data<LhsType>();
+      absl::Span<const RhsType> rhs_data = rhs_literal.data<RhsType>();
+      absl::Span<const EhsType> ehs_data = ehs_literal.data<EhsType>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      HloEvaluator::ParallelFor(
+          result_data.size(), HloEvaluator::kElementwiseCostPerUnit,
+          [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              result_data[i] =
+                  ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+            }
+          });
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return ternary_op(lhs_literal.Get<LhsType>(multi_index),
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_module_group.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_metrics.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -50,10 +51,12 @@ class HloPassFix : public Pass {
         LOG(WARNING) << "Unexpectedly high number of iterations in HLO passes '"
 		     << Pass::name()
 		     << "' exiting fixed point loop.";
+        RecordHloPassFixIterations(Pass::name(), iteration_count);
         // Return false in case this is fixed point is nested.
         return false;
       }
     }
+    RecordHloPassFixIterations(Pass::name(), iteration_count);
     return changed;
   }
 
@@ -72,10 +75,12 @@ class HloPassFix : public Pass {
       if (iteration_count == kLimit) {
         LOG(WARNING) << "Unexpectedly high number of iterations in HLO passes, "
                         "exiting fixed point loop.";
+        RecordHloPassFixIterations(Pass::name(), iteration_count);
         // Return false in case this is fixed point is nested.
         return false;
       }
     }
+    RecordHloPassFixIterations(Pass::name(), iteration_count);
     return changed;
   }
 };
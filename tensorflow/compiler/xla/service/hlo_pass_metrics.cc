@@ -0,0 +1,68 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/hlo_pass_metrics.h"
+
+#include <string>
+
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+
+namespace xla {
+namespace {
+
+auto* hlo_pass_runs = tensorflow::monitoring::Counter<2>::New(
+    "/xla/service/hlo_pass/runs",
+    "The number of runs of each HLO pass, by whether the run changed the HLO.",
+    "pass", "changed");
+
+auto* hlo_pass_duration_usecs = tensorflow::monitoring::Sampler<1>::New(
+    {"/xla/service/hlo_pass/duration_usecs",
+     "The wall time of the runs of each HLO pass.", "pass"},
+    // Power of 2 with bucket count 25 (> 30 seconds)
+    {tensorflow::monitoring::Buckets::Exponential(1, 2, 25)});
+
+auto* hlo_pass_skipped = tensorflow::monitoring::Counter<1>::New(
+    "/xla/service/hlo_pass/skipped",
+    "The number of times each HLO pass was skipped because it did not change "
+    "an identical module before.",
+    "pass");
+
+auto* hlo_pass_fix_iterations = tensorflow::monitoring::Sampler<1>::New(
+    {"/xla/service/hlo_pass/fix_iterations",
+     "The number of iterations of the fixed-point runs of each HLO pass.",
+     "pass"},
+    {tensorflow::monitoring::Buckets::Explicit(
+        {1., 2., 3., 4., 6., 8., 12., 16., 24.})});
+
+}  // namespace
+
+void RecordHloPassRun(absl::string_view pass_name, bool changed,
+                      uint64 duration_usecs) {
+  const std::string name(pass_name);
+  hlo_pass_runs->GetCell(name, changed ? "true" : "false")->IncrementBy(1);
+  hlo_pass_duration_usecs->GetCell(name)->Add(duration_usecs);
+}
+
+void RecordHloPassSkipped(absl::string_view pass_name) {
+  hlo_pass_skipped->GetCell(std::string(pass_name))->IncrementBy(1);
+}
+
+void RecordHloPassFixIterations(absl::string_view pass_name,
+                                int64 iterations) {
+  hlo_pass_fix_iterations->GetCell(std::string(pass_name))->Add(iterations);
+}
+
+}  // namespace xla
@@ -0,0 +1,39 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_METRICS_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_METRICS_H_
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+
+// Records a run of the HLO pass `pass_name` which took `duration_usecs` of
+// wall time, and whether it changed the HLO.
+void RecordHloPassRun(absl::string_view pass_name, bool changed,
+                      uint64 duration_usecs);
+
+// Records that a pipeline skipped the HLO pass `pass_name`, because it did
+// not change an identical module before.
+void RecordHloPassSkipped(absl::string_view pass_name);
+
+// Records the number of iterations a fixed-point run of the HLO pass
+// `pass_name` took.
+void RecordHloPassFixIterations(absl::string_view pass_name, int64 iterations);
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_METRICS_H_
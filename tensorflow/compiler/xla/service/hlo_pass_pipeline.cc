@@ -21,16 +21,52 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/optional.h"
 #include "tensorflow/compiler/xla/service/dump.h"
 #include "tensorflow/compiler/xla/service/hlo_graph_dumper.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_metrics.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
 
+namespace {
+
+const DebugOptions& GetDebugOptions(const HloModule& module) {
+  return module.config().debug_options();
+}
+
+const DebugOptions& GetDebugOptions(const HloModuleGroup& module_group) {
+  return module_group.module(0).config().debug_options();
+}
+
+// Returns a fingerprint of the module which passes can depend on, that is of
+// everything but the metadata.
+uint64 Fingerprint(const HloModule& module) {
+  HloPrintOptions options = HloPrintOptions::Fingerprint();
+  options.set_print_backend_config(true)
+      .set_print_control_dependencies(true)
+      .set_print_operand_names(true)
+      .set_canonicalize_instruction_names(false);
+  return tensorflow::Fingerprint64(module.ToString(options));
+}
+
+uint64 Fingerprint(const HloModuleGroup& module_group) {
+  uint64 fingerprint = 0;
+  for (const HloModule* module : module_group.modules()) {
+    fingerprint =
+        tensorflow::FingerprintCat64(fingerprint, Fingerprint(*module));
+  }
+  return fingerprint;
+}
+
+}  // namespace
+
 template <typename HloT>
 Status HloPassPipeline::RunInvariantCheckers(
     HloT* hlo, absl::string_view after_pass_name) {
@@ -56,9 +92,28 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     HloT* hlo, absl::Span<HloPassInterface* const> passes) {
   string last_pass_name = "pipeline-start";
   TF_RETURN_IF_ERROR(RunInvariantCheckers(hlo, last_pass_name));
+  const bool skip_unchanged =
+      GetDebugOptions(*hlo).xla_hlo_pass_skip_unchanged();
+  // The fingerprint of `hlo`, computed when needed and reset by changes.
+  absl::optional<uint64> fingerprint;
   bool changed = false;
   for (HloPassInterface* pass : passes) {
     absl::string_view pass_name = pass->name();
+    // Nested pipelines skip their own passes.
+    const bool skippable = skip_unchanged && !pass->IsPassPipeline();
+    if (skippable) {
+      if (!fingerprint.has_value()) {
+        fingerprint = Fingerprint(*hlo);
+      }
+      auto it = unchanged_fingerprints_.find(pass);
+      if (it != unchanged_fingerprints_.end() && it->second == *fingerprint) {
+        VLOG(1) << "  Skipping HLO pass " << pass_name
+                << ", it did not change the same module before";
+        compilation_stats_->SkipPass(pass_name);
+        RecordHloPassSkipped(pass_name);
+        continue;
+      }
+    }
     VLOG(1) << "  HLO pass " << pass_name;
     VLOG(2) << "  Module hash " << hlo->Hash();
     MaybeDumpHlo(*hlo,
@@ -67,10 +122,19 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     if (!pass->IsPassPipeline()) {
       compilation_stats_->StartPass(pass_name);
     }
+    const uint64 start_micros = tensorflow::Env::Default()->NowMicros();
     TF_ASSIGN_OR_RETURN(bool pass_changed, RunHelper(pass, hlo));
+    if (!pass->IsPassPipeline()) {
+      RecordHloPassRun(pass_name, pass_changed,
+                       tensorflow::Env::Default()->NowMicros() - start_micros);
+    }
     changed |= pass_changed;
     if (pass_changed) {
       VLOG(3) << "  Changes caused by pass " << pass->name();
+      fingerprint.reset();
+      unchanged_fingerprints_.erase(pass);
+    } else if (skippable) {
+      unchanged_fingerprints_[pass] = *fingerprint;
     }
     TF_RETURN_IF_ERROR(RunInvariantCheckers(hlo, pass_name));
     last_pass_name = string(pass_name);
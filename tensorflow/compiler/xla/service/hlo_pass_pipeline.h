@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/service/compilation_stats.h"
@@ -120,6 +121,11 @@ class HloPassPipeline : public HloPassInterface {
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
   bool run_called_ = false;
 
+  // The fingerprint of the HLO the last run of each pass did not change, for
+  // --xla_hlo_pass_skip_unchanged. Kept across runs, so that fixed-point
+  // pipelines skip the passes which have converged.
+  absl::flat_hash_map<const HloPassInterface*, uint64> unchanged_fingerprints_;
+
   CompilationStats* compilation_stats_;
   // Default stats instance for when one is not passed in the constructor.
   // Use via compilation_stats_, not directly.
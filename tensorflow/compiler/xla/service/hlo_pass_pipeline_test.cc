@@ -95,6 +95,21 @@ class BarBlowerUpper : public HloModulePass {
   }
 };
 
+// A module pass which counts its runs and never changes the module.
+class CountingModulePass : public HloModulePass {
+ public:
+  explicit CountingModulePass(int* num_runs) : num_runs_(num_runs) {}
+  absl::string_view name() const override { return "counting"; }
+
+  StatusOr<bool> Run(HloModule* module) override {
+    ++*num_runs_;
+    return false;
+  }
+
+ private:
+  int* num_runs_;
+};
+
 TEST_F(HloPassPipelineTest, ModulePassChanged) {
   // Test an HLO module pass which changes a module.
   const string module_str = R"(
@@ -138,6 +153,42 @@ ENTRY main {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(HloPassPipelineTest, SkipUnchanged) {
+  const string module_str = R"(
+HloModule SkipUnchanged
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT foo = f32[] multiply(a, b)
+}
+)";
+  HloModuleConfig config = GetModuleConfigForTest();
+  DebugOptions debug_options = config.debug_options();
+  debug_options.set_xla_hlo_pass_skip_unchanged(true);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(module_str, config));
+
+  int num_runs = 0;
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<CountingModulePass>(&num_runs);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(num_runs, 1);
+
+  // The module did not change, so the pass is skipped.
+  TF_ASSERT_OK_AND_ASSIGN(changed, pipeline.Run(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(num_runs, 1);
+
+  // The pass runs again once the module changed.
+  module->entry_computation()->root_instruction()->SetAndSanitizeName("bar");
+  TF_ASSERT_OK_AND_ASSIGN(changed, pipeline.Run(module.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(num_runs, 2);
+}
+
 TEST_F(HloPassPipelineTest, MixedPipeline) {
   // Test a pipeline with both a module pass and a module group pass.
   const string module_0_str = R"(
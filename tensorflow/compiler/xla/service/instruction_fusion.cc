@@ -686,10 +686,18 @@ bool InstructionFusion::ShouldFuse(HloInstruction* consumer,
                                    int64 operand_index) {
   HloInstruction* producer = consumer->mutable_operand(operand_index);
 
-  // Cost condition: don't duplicate expensive instructions.
-  if (FusionWouldDuplicate(*producer, *consumer) &&
-      (!may_duplicate_ || is_expensive_(*producer)) &&
-      !IsAlwaysDuplicable(*producer)) {
+  if (cost_model_ != nullptr) {
+    // Cost condition: don't recompute instructions when it costs more time
+    // than the memory traffic of the intermediate result.
+    if (!IsAlwaysDuplicable(*producer) &&
+        ((FusionWouldDuplicate(*producer, *consumer) && !may_duplicate_) ||
+         !cost_model_->ShouldFuse(consumer, operand_index))) {
+      return false;
+    }
+  } else if (FusionWouldDuplicate(*producer, *consumer) &&
+             (!may_duplicate_ || is_expensive_(*producer)) &&
+             !IsAlwaysDuplicable(*producer)) {
+    // Cost condition: don't duplicate expensive instructions.
     return false;
   }
 
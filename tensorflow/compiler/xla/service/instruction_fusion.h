@@ -18,8 +18,10 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_INSTRUCTION_FUSION_H_
 
 #include <functional>
+#include <memory>
 #include <utility>
 
+#include "tensorflow/compiler/xla/service/fusion_cost_model.h"
 #include "tensorflow/compiler/xla/service/fusion_queue.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -41,10 +43,12 @@ class InstructionFusion : public HloModulePass {
       std::function<bool(const HloInstruction& instruction)> is_expensive,
       bool may_duplicate = true,
       FusionConfigCollection config_collection_mode =
-          FusionConfigCollection::kOff)
+          FusionConfigCollection::kOff,
+      std::unique_ptr<FusionCostModel> cost_model = nullptr)
       : is_expensive_(is_expensive),
         may_duplicate_(may_duplicate),
-        config_collection_mode_(config_collection_mode) {}
+        config_collection_mode_(config_collection_mode),
+        cost_model_(std::move(cost_model)) {}
   ~InstructionFusion() override = default;
   absl::string_view name() const override { return "fusion"; }
 
@@ -124,6 +128,10 @@ class InstructionFusion : public HloModulePass {
     return is_expensive_(instruction);
   }
 
+  // Whether fusion decisions that recompute the producer are made by a
+  // FusionCostModel instead of by is_expensive().
+  bool has_cost_model() const { return cost_model_ != nullptr; }
+
   // Whether multi-output fusion would introduce a cycle into the HLO graph.
   bool MultiOutputFusionCreatesCycle(HloInstruction* producer,
                                      HloInstruction* consumer);
@@ -172,6 +180,10 @@ class InstructionFusion : public HloModulePass {
   // Configuration mode.
   FusionConfigCollection config_collection_mode_;
 
+  // If set, weighs the memory traffic saved by fusions against the work they
+  // duplicate, instead of refusing to duplicate expensive instructions.
+  std::unique_ptr<FusionCostModel> cost_model_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(InstructionFusion);
 };
 
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/local_service.h"
 
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -39,6 +41,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 
@@ -208,6 +211,77 @@ LocalService::CompileExecutables(
   }
 }
 
+StatusOr<std::vector<std::shared_ptr<Executable>>>
+LocalService::CompileSharedExecutables(
+    const XlaComputation& computation,
+    const absl::Span<const Shape* const> argument_layouts,
+    const ExecutableBuildOptions& build_options) {
+  const HloModuleProto& proto = computation.proto();
+  TF_RET_CHECK(proto.has_host_program_shape());
+  ProgramShape program_shape(proto.host_program_shape());
+  ExecutionOptions execution_options =
+      CreateExecutionOptions(build_options, &program_shape);
+
+  // The execution options hold all the build options that affect compilation
+  // except for the device ordinal.
+  std::vector<string> key_parts(2);
+  if (!tensorflow::SerializeToStringDeterministic(proto, &key_parts[0]) ||
+      !tensorflow::SerializeToStringDeterministic(execution_options,
+                                                  &key_parts[1])) {
+    return InternalError("Failed to serialize computation %s",
+                         computation.proto().name());
+  }
+  for (const Shape* argument_layout : argument_layouts) {
+    key_parts.push_back(argument_layout->ToProto().SerializeAsString());
+  }
+  key_parts.push_back(absl::StrCat(build_options.device_ordinal()));
+  string key_string;
+  for (const string& key_part : key_parts) {
+    absl::StrAppend(&key_string, key_part.size(), ":", key_part);
+  }
+  const tensorflow::Fprint128 key = tensorflow::Fingerprint128(key_string);
+
+  {
+    tensorflow::mutex_lock lock(shared_executables_mu_);
+    auto it = shared_executables_.find(key);
+    if (it != shared_executables_.end()) {
+      std::vector<std::shared_ptr<Executable>> executables;
+      for (const std::weak_ptr<Executable>& weak_executable : it->second) {
+        if (std::shared_ptr<Executable> executable = weak_executable.lock()) {
+          executables.push_back(std::move(executable));
+        }
+      }
+      if (executables.size() == it->second.size()) {
+        VLOG(1) << "Sharing the executables of computation "
+                << computation.proto().name();
+        return executables;
+      }
+    }
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      std::vector<std::unique_ptr<Executable>> compiled_executables,
+      CompileExecutables(computation, argument_layouts, build_options));
+  std::vector<std::shared_ptr<Executable>> executables(
+      std::make_move_iterator(compiled_executables.begin()),
+      std::make_move_iterator(compiled_executables.end()));
+
+  tensorflow::mutex_lock lock(shared_executables_mu_);
+  // Drop the executables that are no longer in use before adding new ones.
+  for (auto it = shared_executables_.begin();
+       it != shared_executables_.end();) {
+    if (absl::c_any_of(it->second, [](const std::weak_ptr<Executable>& e) {
+          return e.expired();
+        })) {
+      shared_executables_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  shared_executables_[key].assign(executables.begin(), executables.end());
+  return executables;
+}
+
 StatusOr<int> LocalService::ReplicaNumberToDeviceOrdinal(int replica_number) {
   return backend().computation_placer()->DeviceId(
       replica_number, /*computation=*/0, options_.number_of_replicas(),
@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/client/executable_build_options.h"
 #include "tensorflow/compiler/xla/client/xla_computation.h"
@@ -29,7 +30,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/shaped_buffer.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/stream_executor/device_memory_allocator.h"
 
 namespace xla {
@@ -52,6 +56,14 @@ class LocalService : public Service {
       const absl::Span<const Shape* const> argument_layouts,
       const ExecutableBuildOptions& build_options);
 
+  // Same as CompileExecutables, but returns the executables built by a previous
+  // call with an identical computation, argument layouts and build options if
+  // they are still in use, so that the clients of this service share them.
+  StatusOr<std::vector<std::shared_ptr<Executable>>> CompileSharedExecutables(
+      const XlaComputation& computation,
+      const absl::Span<const Shape* const> argument_layouts,
+      const ExecutableBuildOptions& build_options);
+
   // Returns the device ordinal that corresponds to the given replica number.
   //
   // This returns an error if there is not a one-to-one correspondence of
@@ -74,6 +86,16 @@ class LocalService : public Service {
                         std::unique_ptr<Backend> backend);
   LocalService(const LocalService&) = delete;
   void operator=(const LocalService&) = delete;
+
+  tensorflow::mutex shared_executables_mu_;
+
+  // The executables returned by CompileSharedExecutables, keyed by the
+  // fingerprint of the computation, argument layouts and build options. The
+  // executables are owned by the clients and expire when none uses them.
+  absl::flat_hash_map<tensorflow::Fprint128,
+                      std::vector<std::weak_ptr<Executable>>,
+                      tensorflow::Fprint128Hasher>
+      shared_executables_ TF_GUARDED_BY(shared_executables_mu_);
 };
 
 }  // namespace xla
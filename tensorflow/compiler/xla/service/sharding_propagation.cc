@@ -0,0 +1,273 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/sharding_propagation.h"
+
+#include <iterator>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/array.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+
+namespace {
+
+// Returns the sharding of an array whose dimension i is dimension
+// `source_dims[i]` of an array sharded with `sharding`, or a new dimension if
+// `source_dims[i]` is -1. Returns nullopt if a dimension of the source array
+// that is dropped is split across devices.
+absl::optional<HloSharding> RemapTiledDimensions(
+    const HloSharding& sharding, absl::Span<const int64> source_dims) {
+  if (sharding.IsTileMaximal()) {
+    return sharding;
+  }
+  const Array<int64>& tiles = sharding.tile_assignment();
+  std::vector<bool> kept(tiles.num_dimensions(), false);
+  std::vector<int64> new_dims;
+  for (int64 source_dim : source_dims) {
+    new_dims.push_back(source_dim < 0 ? 1 : tiles.dim(source_dim));
+    if (source_dim >= 0) {
+      kept[source_dim] = true;
+    }
+  }
+  for (int64 i = 0; i < tiles.num_dimensions(); ++i) {
+    if (!kept[i] && tiles.dim(i) != 1) {
+      return absl::nullopt;
+    }
+  }
+  Array<int64> new_tiles(new_dims);
+  new_tiles.Each([&](absl::Span<const int64> index, int64* device) {
+    std::vector<int64> source_index(tiles.num_dimensions(), 0);
+    for (int64 i = 0; i < index.size(); ++i) {
+      if (source_dims[i] >= 0) {
+        source_index[source_dims[i]] = index[i];
+      }
+    }
+    *device = tiles(source_index);
+  });
+  if (new_tiles.num_elements() == 1) {
+    return HloSharding::AssignDevice(*new_tiles.begin());
+  }
+  return HloSharding::Tile(new_tiles);
+}
+
+// If `output_to_input`, returns the input dimension of `reduce` for each of
+// its output dimensions. Otherwise returns the output dimension for each input
+// dimension, or -1 for the reduced dimensions.
+std::vector<int64> ReduceDimensionMap(const HloInstruction& reduce,
+                                      bool output_to_input) {
+  const int64 input_rank = reduce.operand(0)->shape().rank();
+  std::vector<int64> to_output(input_rank, -1);
+  std::vector<int64> from_output;
+  for (int64 i = 0; i < input_rank; ++i) {
+    if (!absl::c_linear_search(reduce.dimensions(), i)) {
+      to_output[i] = from_output.size();
+      from_output.push_back(i);
+    }
+  }
+  return output_to_input ? from_output : to_output;
+}
+
+// Returns true if shardings may be propagated between `instruction` and its
+// operands.
+bool PropagatesSharding(const HloInstruction& instruction) {
+  switch (instruction.opcode()) {
+    case HloOpcode::kCall:
+    case HloOpcode::kConditional:
+    case HloOpcode::kDomain:
+    case HloOpcode::kWhile:
+      return false;
+    default:
+      return true;
+  }
+}
+
+// Returns `sharding` if it applies to an array of any shape.
+absl::optional<HloSharding> ShapeIndependentSharding(
+    const HloSharding& sharding, const Shape& from, const Shape& to) {
+  if (sharding.IsTuple() || !sharding.IsTileMaximal() || from.IsTuple() ||
+      to.IsTuple()) {
+    return absl::nullopt;
+  }
+  return sharding;
+}
+
+}  // namespace
+
+/*static*/ absl::optional<HloSharding> ShardingPropagation::InferFromOperand(
+    const HloInstruction& instruction, int64 operand_index) {
+  const HloInstruction* operand = instruction.operand(operand_index);
+  const HloSharding& sharding = operand->sharding();
+  switch (instruction.opcode()) {
+    case HloOpcode::kGetTupleElement:
+      if (!sharding.IsTuple()) {
+        return sharding;
+      }
+      return sharding.GetSubSharding(operand->shape(),
+                                     {instruction.tuple_index()});
+    case HloOpcode::kTuple: {
+      std::vector<HloSharding> leaves;
+      for (const HloInstruction* element : instruction.operands()) {
+        if (!element->has_sharding()) {
+          return absl::nullopt;
+        }
+        if (element->sharding().IsTuple()) {
+          absl::c_copy(element->sharding().tuple_elements(),
+                       std::back_inserter(leaves));
+        } else {
+          leaves.insert(leaves.end(),
+                        ShapeUtil::GetLeafCount(element->shape()),
+                        element->sharding());
+        }
+      }
+      return HloSharding::Tuple(instruction.shape(), leaves);
+    }
+    case HloOpcode::kTranspose:
+      return RemapTiledDimensions(sharding, instruction.dimensions());
+    case HloOpcode::kBroadcast: {
+      std::vector<int64> source_dims(instruction.shape().rank(), -1);
+      for (int64 i = 0; i < instruction.dimensions().size(); ++i) {
+        source_dims[instruction.dimensions(i)] = i;
+      }
+      return RemapTiledDimensions(sharding, source_dims);
+    }
+    case HloOpcode::kReduce:
+      if (instruction.shape().IsTuple()) {
+        return absl::nullopt;
+      }
+      if (operand_index != 0) {
+        return ShapeIndependentSharding(sharding, operand->shape(),
+                                        instruction.shape());
+      }
+      return RemapTiledDimensions(
+          sharding, ReduceDimensionMap(instruction, /*output_to_input=*/true));
+    default:
+      if (!PropagatesSharding(instruction)) {
+        return absl::nullopt;
+      }
+      if (instruction.IsElementwise() && !sharding.IsTuple() &&
+          operand->shape().rank() == instruction.shape().rank()) {
+        return sharding;
+      }
+      return ShapeIndependentSharding(sharding, operand->shape(),
+                                      instruction.shape());
+  }
+}
+
+/*static*/ absl::optional<HloSharding> ShardingPropagation::InferFromUser(
+    const HloInstruction& user, int64 operand_index) {
+  const HloInstruction* operand = user.operand(operand_index);
+  const HloSharding& sharding = user.sharding();
+  switch (user.opcode()) {
+    case HloOpcode::kGetTupleElement:
+      return absl::nullopt;
+    case HloOpcode::kTuple:
+      if (!sharding.IsTuple()) {
+        return sharding;
+      }
+      return sharding.GetSubSharding(user.shape(), {operand_index});
+    case HloOpcode::kTranspose: {
+      std::vector<int64> source_dims(user.shape().rank());
+      for (int64 i = 0; i < user.dimensions().size(); ++i) {
+        source_dims[user.dimensions(i)] = i;
+      }
+      return RemapTiledDimensions(sharding, source_dims);
+    }
+    case HloOpcode::kBroadcast:
+      return RemapTiledDimensions(sharding, user.dimensions());
+    case HloOpcode::kReduce:
+      if (user.shape().IsTuple()) {
+        return absl::nullopt;
+      }
+      if (operand_index != 0) {
+        return ShapeIndependentSharding(sharding, user.shape(),
+                                        operand->shape());
+      }
+      return RemapTiledDimensions(
+          sharding, ReduceDimensionMap(user, /*output_to_input=*/false));
+    default:
+      if (!PropagatesSharding(user)) {
+        return absl::nullopt;
+      }
+      if (user.IsElementwise() && !sharding.IsTuple() &&
+          operand->shape().rank() == user.shape().rank()) {
+        return sharding;
+      }
+      return ShapeIndependentSharding(sharding, user.shape(),
+                                      operand->shape());
+  }
+}
+
+StatusOr<bool> ShardingPropagation::Run(HloModule* module) {
+  bool changed = false;
+  bool changed_in_iteration = true;
+  while (changed_in_iteration) {
+    changed_in_iteration = false;
+    for (HloComputation* computation : module->MakeNonfusionComputations()) {
+      std::vector<HloInstruction*> instructions =
+          computation->MakeInstructionPostOrder();
+      // Forward propagation, from operands to users.
+      for (HloInstruction* instruction : instructions) {
+        if (instruction->has_sharding()) {
+          continue;
+        }
+        for (int64 i = 0; i < instruction->operand_count(); ++i) {
+          if (!instruction->operand(i)->has_sharding()) {
+            continue;
+          }
+          absl::optional<HloSharding> sharding =
+              InferFromOperand(*instruction, i);
+          if (sharding.has_value()) {
+            VLOG(3) << "Forward propagated " << sharding->ToString() << " to "
+                    << instruction->name();
+            instruction->set_sharding(*sharding);
+            changed_in_iteration = true;
+            break;
+          }
+        }
+      }
+      // Backward propagation, from users to operands.
+      for (auto it = instructions.rbegin(); it != instructions.rend(); ++it) {
+        HloInstruction* instruction = *it;
+        if (instruction->has_sharding()) {
+          continue;
+        }
+        for (const HloInstruction* user : instruction->users()) {
+          if (!user->has_sharding()) {
+            continue;
+          }
+          absl::optional<HloSharding> sharding =
+              InferFromUser(*user, user->operand_index(instruction));
+          if (sharding.has_value()) {
+            VLOG(3) << "Backward propagated " << sharding->ToString() << " to "
+                    << instruction->name();
+            instruction->set_sharding(*sharding);
+            changed_in_iteration = true;
+            break;
+          }
+        }
+      }
+    }
+    changed |= changed_in_iteration;
+  }
+  return changed;
+}
+
+}  // namespace xla
@@ -0,0 +1,58 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_SHARDING_PROPAGATION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_SHARDING_PROPAGATION_H_
+
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/service/hlo_sharding.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// Propagates the shardings of a few annotated instructions to the
+// instructions without a sharding, so that a partitioner can split every
+// instruction of the module across devices.
+//
+// Shardings are propagated forward from operands to users and backward from
+// users to operands until a fixed point is reached. Existing shardings are
+// never changed. Tiled shardings are propagated through elementwise ops,
+// transposes, broadcasts, reduces and tuples, with their tile assignment
+// permuted, extended or reduced along the dimensions the op maps; replicated
+// and maximal shardings are propagated through any op on arrays. Shardings are
+// not propagated across kDomain instructions and control flow.
+class ShardingPropagation : public HloModulePass {
+ public:
+  absl::string_view name() const override { return "sharding-propagation"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+  // Returns the sharding of `instruction` inferred from the sharding of its
+  // operand `operand_index`, if any.
+  static absl::optional<HloSharding> InferFromOperand(
+      const HloInstruction& instruction, int64 operand_index);
+
+  // Returns the sharding of operand `operand_index` of `user` inferred from the
+  // sharding of `user`, if any.
+  static absl::optional<HloSharding> InferFromUser(const HloInstruction& user,
+                                                   int64 operand_index);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_SHARDING_PROPAGATION_H_
@@ -0,0 +1,118 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/sharding_propagation.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace {
+
+class ShardingPropagationTest : public HloTestBase {
+ protected:
+  string ShardingOf(const HloModule& module, absl::string_view name) {
+    for (const HloInstruction* instruction :
+         module.entry_computation()->instructions()) {
+      if (instruction->name() == name) {
+        return instruction->has_sharding() ? instruction->sharding().ToString()
+                                           : "none";
+      }
+    }
+    return "not found";
+  }
+};
+
+TEST_F(ShardingPropagationTest, ElementwiseForwardAndBackward) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    p0 = f32[8,4]{1,0} parameter(0)
+    p1 = f32[8,4]{1,0} parameter(1)
+    neg = f32[8,4]{1,0} negate(p0), sharding={devices=[2,1]0,1}
+    ROOT add = f32[8,4]{1,0} add(neg, p1)
+  })")
+                    .ValueOrDie();
+  EXPECT_TRUE(ShardingPropagation().Run(module.get()).ValueOrDie());
+  EXPECT_EQ(ShardingOf(*module, "p0"), "{devices=[2,1]0,1}");
+  EXPECT_EQ(ShardingOf(*module, "add"), "{devices=[2,1]0,1}");
+  EXPECT_EQ(ShardingOf(*module, "p1"), "{devices=[2,1]0,1}");
+}
+
+TEST_F(ShardingPropagationTest, Transpose) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    p0 = f32[8,4]{1,0} parameter(0), sharding={devices=[2,1]0,1}
+    ROOT transpose = f32[4,8]{1,0} transpose(p0), dimensions={1,0}
+  })")
+                    .ValueOrDie();
+  EXPECT_TRUE(ShardingPropagation().Run(module.get()).ValueOrDie());
+  EXPECT_EQ(ShardingOf(*module, "transpose"), "{devices=[1,2]0,1}");
+}
+
+TEST_F(ShardingPropagationTest, BroadcastAndReduce) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+  ENTRY entry_computation {
+    p0 = f32[8]{0} parameter(0), sharding={devices=[2]0,1}
+    broadcast = f32[8,4]{1,0} broadcast(p0), dimensions={0}
+    zero = f32[] constant(0)
+    reduce = f32[8]{0} reduce(broadcast, zero), dimensions={1}, to_apply=add
+    ROOT reduce.all = f32[] reduce(reduce, zero), dimensions={0}, to_apply=add
+  })")
+                    .ValueOrDie();
+  EXPECT_TRUE(ShardingPropagation().Run(module.get()).ValueOrDie());
+  EXPECT_EQ(ShardingOf(*module, "broadcast"), "{devices=[2,1]0,1}");
+  EXPECT_EQ(ShardingOf(*module, "reduce"), "{devices=[2]0,1}");
+  // Reducing a split dimension needs a cross-device reduction.
+  EXPECT_EQ(ShardingOf(*module, "reduce.all"), "none");
+}
+
+TEST_F(ShardingPropagationTest, TupleAndGetTupleElement) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    p0 = f32[8]{0} parameter(0), sharding={devices=[2]0,1}
+    p1 = f32[4]{0} parameter(1), sharding={replicated}
+    tuple = (f32[8]{0}, f32[4]{0}) tuple(p0, p1)
+    ROOT gte = f32[4]{0} get-tuple-element(tuple), index=1
+  })")
+                    .ValueOrDie();
+  EXPECT_TRUE(ShardingPropagation().Run(module.get()).ValueOrDie());
+  EXPECT_EQ(ShardingOf(*module, "tuple"), "{{devices=[2]0,1}, {replicated}}");
+  EXPECT_EQ(ShardingOf(*module, "gte"), "{replicated}");
+}
+
+TEST_F(ShardingPropagationTest, DoesNotChangeExistingShardings) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    p0 = f32[8]{0} parameter(0), sharding={devices=[2]0,1}
+    ROOT neg = f32[8]{0} negate(p0), sharding={replicated}
+  })")
+                    .ValueOrDie();
+  EXPECT_FALSE(ShardingPropagation().Run(module.get()).ValueOrDie());
+  EXPECT_EQ(ShardingOf(*module, "neg"), "{replicated}");
+}
+
+}  // namespace
+}  // namespace xla
@@ -781,6 +781,50 @@ XLA_TEST_F(LocalClientExecuteTest, CompileExecutable) {
       {2.0f, 4.0f, 6.0f}, ShapedBufferToLiteral(result), error_spec_);
 }
 
+XLA_TEST_F(LocalClientExecuteTest, CompileSharedExecutable) {
+  XlaBuilder builder(TestName());
+  auto x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {3}), "x");
+  auto y = ConstantR1<float>(&builder, {2.0f, 3.0f, 4.0f});
+  Add(x, y);
+  XlaComputation computation = builder.Build().ValueOrDie();
+
+  Shape argument_layout =
+      ShapeUtil::MakeShapeWithLayout(F32, /*dimensions=*/{3}, {0});
+  ExecutableBuildOptions build_options;
+  build_options.set_share_executables(true);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto executables,
+      local_client_->Compile(computation, {&argument_layout}, build_options));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto shared_executables,
+      local_client_->Compile(computation, {&argument_layout}, build_options));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto unshared_executables,
+      local_client_->Compile(computation, {&argument_layout},
+                             ExecutableBuildOptions()));
+  ASSERT_EQ(1, executables.size());
+  ASSERT_EQ(1, shared_executables.size());
+  ASSERT_EQ(1, unshared_executables.size());
+  EXPECT_EQ(executables[0]->executable(), shared_executables[0]->executable());
+  EXPECT_NE(executables[0]->executable(),
+            unshared_executables[0]->executable());
+
+  auto x_array =
+      LiteralToShapedBuffer(LiteralUtil::CreateR1<float>({0.0f, 1.0f, 2.0f}));
+  executables.clear();
+  ScopedShapedBuffer result =
+      shared_executables[0]
+          ->Run({&x_array}, DefaultExecutableRunOptions())
+          .ConsumeValueOrDie();
+  ASSERT_IS_OK(local_client_->mutable_backend()
+                   ->BorrowStream(0)
+                   .ValueOrDie()
+                   ->BlockHostUntilDone());
+
+  LiteralTestUtil::ExpectR1Near<float>(
+      {2.0f, 4.0f, 6.0f}, ShapedBufferToLiteral(result), error_spec_);
+}
+
 XLA_TEST_F(LocalClientExecuteTest, CompilePartitionedExecutable) {
   if (local_client_->device_count() < 2) {
     GTEST_SKIP_("requires two devices");
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -617,6 +618,19 @@ RemoteMemoryManager* CreateRemoteMemoryManager(const string& host,
   return new GdrMemoryManager(host, port);
 }
 
+int64 MinOutOfBandTensorBytes() {
+  static const int64 min_bytes = []() {
+    int64 value;
+    Status s = ReadInt64FromEnvVar("TF_GDR_MIN_TENSOR_BYTES", 1024, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      value = 1024;
+    }
+    return value;
+  }();
+  return min_bytes;
+}
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_USE_GDR
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "google/protobuf/any.pb.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 
@@ -55,6 +56,12 @@ class RemoteMemoryManager {
 RemoteMemoryManager* CreateRemoteMemoryManager(const string& host,
                                                const string& port);
 
+// Returns the size in bytes above which a tensor is sent out of band. Smaller
+// tensors are sent inline in the RPC response, where the cost of an extra
+// RDMA round trip outweighs that of the copy. Defaults to 1024 and can be set
+// with the TF_GDR_MIN_TENSOR_BYTES environment variable.
+int64 MinOutOfBandTensorBytes();
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CONTRIB_GDR_GDR_MEMORY_MANAGER_H_
@@ -57,8 +57,10 @@ class GdrRecvTensorCall : public BaseRecvTensorCall {
     req_.set_dma_ok(true);
     resp_.InitAlloc(dst_device_, recv_args_.alloc_attrs);
     StatusCallback cb = [this, recv_done](const Status& s) {
+      // The sender decides whether the tensor is sent out of band, so the
+      // presence of transport options is the only signal to act on.
       bool dma_ok = resp_.metadata().has_transport_options();
-      if (s.ok() && tensor().TotalBytes() > 1024 && (!is_dead()) && dma_ok) {
+      if (s.ok() && (!is_dead()) && dma_ok) {
         auto transport_options = resp_.metadata().transport_options();
         const bool on_host = recv_args_.alloc_attrs.on_host();
         remote_memory_manager_->TensorFromTransportOptions(
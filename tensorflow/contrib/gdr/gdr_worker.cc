@@ -42,7 +42,7 @@ GdrWorker::GdrWorker(WorkerEnv* worker_env, const ConfigProto& config,
                      RemoteMemoryManager* remote_memory_manager)
     : GrpcWorker(worker_env, config),
       remote_memory_manager_(remote_memory_manager),
-      recent_request_ids_(100000) {}
+      recent_request_ids_(100000, /*num_shards=*/32) {}
 
 void GdrWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                     const RecvTensorRequest* request,
@@ -89,7 +89,7 @@ void GdrWorker::GrpcRecvTensorAsync(CallOptions* opts,
           // i.e. it's in CPU RAM *independent of its assigned
           // device type*.
           const bool on_host = send_args.alloc_attrs.on_host();
-          if (val.TotalBytes() > 1024 && (!is_dead) &&
+          if (val.TotalBytes() > MinOutOfBandTensorBytes() && (!is_dead) &&
               DMAHelper::CanUseDMA(&val) && dma_ok) {
             // DMA cases.
             RecvTensorResponse* proto = new RecvTensorResponse;
@@ -26,9 +26,94 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Sizes served by the thread caches: powers of two and the midpoints between
+// them, from kMinAllocationSize up to kMaxThreadCachedBytes. Rounding a
+// request up to its class wastes at most a third of the chunk.
+constexpr size_t kThreadCacheClassBytes[] = {
+    256,        384,        512,        768,        1 << 10,    3 << 9,
+    2 << 10,    3 << 10,    4 << 10,    6 << 10,    8 << 10,    12 << 10,
+    16 << 10,   24 << 10,   32 << 10,   48 << 10,   64 << 10};
+constexpr int kNumThreadCacheClasses =
+    sizeof(kThreadCacheClassBytes) / sizeof(kThreadCacheClassBytes[0]);
+
+// Each magazine holds about this many bytes, within the bounds below.
+constexpr size_t kThreadCacheBytesPerClass = 256 << 10;
+constexpr int kMinMagazineSize = 4;
+constexpr int kMaxMagazineSize = 64;
+
+int MagazineSize(int size_class) {
+  const int n =
+      kThreadCacheBytesPerClass / kThreadCacheClassBytes[size_class];
+  return std::max(kMinMagazineSize, std::min(kMaxMagazineSize, n));
+}
+
+bool UseThreadCachesFromEnv() {
+  bool use_thread_caches = false;
+  Status status = ReadBoolFromEnvVar("TF_BFC_ALLOCATOR_THREAD_CACHE",
+                                     /*default_val=*/false,
+                                     &use_thread_caches);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetThreadCacheFromEnv: " << status.error_message();
+  }
+  return use_thread_caches;
+}
+
+std::atomic<int64> next_thread_cache_id{0};
+
+}  // namespace
+
+constexpr size_t BFCAllocator::kMaxThreadCachedBytes;
+constexpr int BFCAllocator::kNumThreadCachedChunkShards;
+
+// The free chunks one thread keeps for one allocator, by size class.
+struct BFCAllocator::ThreadCache {
+  // Only contended when another thread flushes the caches or collects stats.
+  mutex mu;
+  // Set to nullptr when the allocator is destroyed before the thread exits.
+  BFCAllocator* allocator GUARDED_BY(mu);
+  std::array<std::vector<void*>, kNumThreadCacheClasses> magazines
+      GUARDED_BY(mu);
+  int64 bytes GUARDED_BY(mu) = 0;
+  int64 hits GUARDED_BY(mu) = 0;
+
+  explicit ThreadCache(BFCAllocator* a) : allocator(a) {}
+
+  // Moves all cached chunks into 'ptrs'.
+  void TakeAll(std::vector<void*>* ptrs) EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    for (auto& magazine : magazines) {
+      ptrs->insert(ptrs->end(), magazine.begin(), magazine.end());
+      magazine.clear();
+    }
+    bytes = 0;
+  }
+};
+
+// The caches of the current thread, one per allocator it has used. Returns
+// the cached chunks to their allocators when the thread exits.
+struct BFCAllocator::ThreadCacheList {
+  std::vector<std::pair<int64, std::shared_ptr<ThreadCache>>> caches;
+
+  ~ThreadCacheList() {
+    for (auto& entry : caches) {
+      ThreadCache* cache = entry.second.get();
+      mutex_lock l(cache->mu);
+      if (cache->allocator == nullptr) continue;
+      std::vector<void*> ptrs;
+      cache->TakeAll(&ptrs);
+      if (ptrs.empty()) continue;
+      // Holding cache->mu keeps the allocator from being destroyed meanwhile.
+      cache->allocator->UnregisterThreadCachedChunks(ptrs);
+      cache->allocator->DeallocateChunksFromThreadCache(ptrs);
+    }
+  }
+};
+
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
                            bool garbage_collection)
@@ -36,7 +121,9 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
       sub_allocator_(sub_allocator),
       name_(name),
       free_chunks_list_(kInvalidChunkHandle),
-      next_allocation_id_(1) {
+      next_allocation_id_(1),
+      use_thread_caches_(UseThreadCachesFromEnv()),
+      thread_cache_id_(next_thread_cache_id.fetch_add(1)) {
   if (allow_growth) {
     // 1MiB smallest initial allocation, unless total memory available
     // is less.
@@ -71,6 +158,17 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
 }
 
 BFCAllocator::~BFCAllocator() {
+  // Detach the thread caches; their chunks go away with the regions below.
+  {
+    mutex_lock l(thread_caches_mu_);
+    for (auto& cache : thread_caches_) {
+      mutex_lock cl(cache->mu);
+      cache->allocator = nullptr;
+      for (auto& magazine : cache->magazines) magazine.clear();
+      cache->bytes = 0;
+    }
+  }
+
   // Return memory back.
   VLOG(2) << "Number of regions allocated: "
           << region_manager_.regions().size();
@@ -203,6 +301,10 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   }
   void* r =
       AllocateRawInternal(unused_alignment, num_bytes, false, freed_by_count);
+  if (r == nullptr && use_thread_caches_ && FlushThreadCaches()) {
+    r = AllocateRawInternal(unused_alignment, num_bytes, false,
+                            freed_by_count);
+  }
   if (r != nullptr) {
     return r;
   } else {
@@ -224,6 +326,17 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
   void* result = nullptr;
+  if (use_thread_caches_ && num_bytes > 0 &&
+      num_bytes <= kMaxThreadCachedBytes &&
+      allocation_attr.freed_by_func == nullptr &&
+      timing_counter_ == nullptr) {
+    result = AllocateFromThreadCache(num_bytes);
+    if (result != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " "
+              << result << " (thread cache)";
+      return result;
+    }
+  }
   if (allocation_attr.no_retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -234,6 +347,10 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
     }
     result = AllocateRawInternal(unused_alignment, num_bytes,
                                  dump_log_on_failure, freed_by_count);
+    if (result == nullptr && use_thread_caches_ && FlushThreadCaches()) {
+      result = AllocateRawInternal(unused_alignment, num_bytes,
+                                   dump_log_on_failure, freed_by_count);
+    }
     if (result == nullptr) {
       static std::atomic<int32> log_counter{0};
       int32 counter_value = log_counter.load(std::memory_order_relaxed);
@@ -537,6 +654,9 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (use_thread_caches_ && ptr != nullptr && DeallocateToThreadCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -547,7 +667,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   mutex_lock l(lock_);
+  FreeChunkForPtr(ptr);
+}
 
+void BFCAllocator::FreeChunkForPtr(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -942,17 +1065,208 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
 }
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
+  int64 bytes_in_thread_caches = 0;
+  int64 num_thread_cache_hits = 0;
+  if (use_thread_caches_) {
+    mutex_lock l(thread_caches_mu_);
+    for (const auto& cache : thread_caches_) {
+      mutex_lock cl(cache->mu);
+      bytes_in_thread_caches += cache->bytes;
+      num_thread_cache_hits += cache->hits;
+    }
+  }
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.bytes_in_thread_caches = bytes_in_thread_caches;
+  stats.num_thread_cache_hits = num_thread_cache_hits;
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
+  if (use_thread_caches_) {
+    mutex_lock l(thread_caches_mu_);
+    for (const auto& cache : thread_caches_) {
+      mutex_lock cl(cache->mu);
+      cache->hits = 0;
+    }
+  }
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
 }
 
+// static
+int BFCAllocator::ThreadCacheSizeClass(size_t num_bytes) {
+  DCHECK_LE(num_bytes, kMaxThreadCachedBytes);
+  return std::lower_bound(kThreadCacheClassBytes,
+                          kThreadCacheClassBytes + kNumThreadCacheClasses,
+                          num_bytes) -
+         kThreadCacheClassBytes;
+}
+
+BFCAllocator::ThreadCache* BFCAllocator::GetThreadCache() {
+  static thread_local ThreadCacheList thread_caches;
+  for (const auto& entry : thread_caches.caches) {
+    if (entry.first == thread_cache_id_) return entry.second.get();
+  }
+  auto cache = std::make_shared<ThreadCache>(this);
+  {
+    mutex_lock l(thread_caches_mu_);
+    // Drop the caches of threads that have exited; their chunks were
+    // returned when they did.
+    thread_caches_.erase(
+        std::remove_if(thread_caches_.begin(), thread_caches_.end(),
+                       [](const std::shared_ptr<ThreadCache>& c) {
+                         return c.use_count() == 1;
+                       }),
+        thread_caches_.end());
+    thread_caches_.push_back(cache);
+  }
+  thread_caches.caches.emplace_back(thread_cache_id_, cache);
+  return cache.get();
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t num_bytes) {
+  const int size_class = ThreadCacheSizeClass(num_bytes);
+  const size_t class_bytes = kThreadCacheClassBytes[size_class];
+  ThreadCache* cache = GetThreadCache();
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& magazine = cache->magazines[size_class];
+    if (!magazine.empty()) {
+      void* ptr = magazine.back();
+      magazine.pop_back();
+      cache->bytes -= class_bytes;
+      ++cache->hits;
+      return ptr;
+    }
+  }
+
+  // Refill half a magazine at once, keeping the first chunk for the caller.
+  void* ptrs[kMaxMagazineSize];
+  const int n = AllocateChunksForThreadCache(
+      class_bytes, std::max(1, MagazineSize(size_class) / 2), ptrs);
+  if (n == 0) return nullptr;
+  RegisterThreadCachedChunks(ptrs, n, size_class);
+  if (n > 1) {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& magazine = cache->magazines[size_class];
+    magazine.insert(magazine.end(), ptrs + 1, ptrs + n);
+    cache->bytes += (n - 1) * class_bytes;
+  }
+  return ptrs[0];
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  const int size_class = ThreadCachedChunkSizeClass(ptr);
+  if (size_class < 0) return false;
+  const size_t class_bytes = kThreadCacheClassBytes[size_class];
+  ThreadCache* cache = GetThreadCache();
+  std::vector<void*> to_drain;
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& magazine = cache->magazines[size_class];
+    if (magazine.size() < MagazineSize(size_class)) {
+      magazine.push_back(ptr);
+      cache->bytes += class_bytes;
+      return true;
+    }
+    // The magazine is full: send the older half back to the bins, together
+    // with 'ptr'.
+    const size_t keep = magazine.size() / 2;
+    to_drain.assign(magazine.begin(), magazine.begin() + keep);
+    magazine.erase(magazine.begin(), magazine.begin() + keep);
+    cache->bytes -= keep * class_bytes;
+  }
+  to_drain.push_back(ptr);
+  UnregisterThreadCachedChunks(to_drain);
+  DeallocateChunksFromThreadCache(to_drain);
+  retry_helper_.NotifyDealloc();
+  return true;
+}
+
+int BFCAllocator::AllocateChunksForThreadCache(size_t class_bytes, int n,
+                                               void** ptrs) {
+  const BinNum bin_num = BinNumForSize(class_bytes);
+  mutex_lock l(lock_);
+  int i = 0;
+  for (; i < n; ++i) {
+    void* ptr = FindChunkPtr(bin_num, class_bytes, class_bytes, 0);
+    if (ptr == nullptr) {
+      // Only grow the pool for the first chunk; the rest of the batch is
+      // opportunistic.
+      if (i > 0 || !Extend(kAllocatorAlignment, class_bytes)) break;
+      ptr = FindChunkPtr(bin_num, class_bytes, class_bytes, 0);
+      if (ptr == nullptr) break;
+    }
+    ptrs[i] = ptr;
+  }
+  return i;
+}
+
+void BFCAllocator::DeallocateChunksFromThreadCache(
+    const std::vector<void*>& ptrs) {
+  mutex_lock l(lock_);
+  for (void* ptr : ptrs) {
+    FreeChunkForPtr(ptr);
+  }
+}
+
+bool BFCAllocator::FlushThreadCaches() {
+  std::vector<void*> ptrs;
+  {
+    mutex_lock l(thread_caches_mu_);
+    for (const auto& cache : thread_caches_) {
+      mutex_lock cl(cache->mu);
+      cache->TakeAll(&ptrs);
+    }
+  }
+  if (ptrs.empty()) return false;
+  VLOG(1) << "Flushing " << ptrs.size()
+          << " chunks from the thread caches of " << Name();
+  UnregisterThreadCachedChunks(ptrs);
+  DeallocateChunksFromThreadCache(ptrs);
+  return true;
+}
+
+namespace {
+
+inline int ShardForPtr(const void* ptr, int num_shards) {
+  // Chunks are at least kMinAllocationSize apart, so ignore the low bits.
+  return (reinterpret_cast<std::uintptr_t>(ptr) >> 8) % num_shards;
+}
+
+}  // namespace
+
+void BFCAllocator::RegisterThreadCachedChunks(void* const* ptrs, int n,
+                                              int size_class) {
+  for (int i = 0; i < n; ++i) {
+    ThreadCachedChunkShard& shard = thread_cached_chunk_shards_[ShardForPtr(
+        ptrs[i], kNumThreadCachedChunkShards)];
+    mutex_lock l(shard.mu);
+    shard.chunks[ptrs[i]] = size_class;
+  }
+}
+
+void BFCAllocator::UnregisterThreadCachedChunks(
+    const std::vector<void*>& ptrs) {
+  for (const void* ptr : ptrs) {
+    ThreadCachedChunkShard& shard = thread_cached_chunk_shards_[ShardForPtr(
+        ptr, kNumThreadCachedChunkShards)];
+    mutex_lock l(shard.mu);
+    shard.chunks.erase(ptr);
+  }
+}
+
+int BFCAllocator::ThreadCachedChunkSizeClass(const void* ptr) {
+  ThreadCachedChunkShard& shard = thread_cached_chunk_shards_[ShardForPtr(
+      ptr, kNumThreadCachedChunkShards)];
+  mutex_lock l(shard.mu);
+  auto it = shard.chunks.find(ptr);
+  return it == shard.chunks.end() ? -1 : it->second;
+}
+
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
 BFCAllocator::get_bin_debug_info() {
   std::array<BinDebugInfo, kNumBins> bin_infos;
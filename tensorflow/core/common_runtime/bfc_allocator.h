@@ -44,6 +44,18 @@ namespace tensorflow {
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// If the environment variable TF_BFC_ALLOCATOR_THREAD_CACHE is set to true
+// when the allocator is constructed, allocations of at most
+// kMaxThreadCachedBytes are served from per-thread caches of free chunks.
+// Each cache holds a small "magazine" of chunks per size class that is
+// refilled from, and drained to, the bins in batches, so that most small
+// allocations and deallocations do not take the allocator-wide lock. Chunks
+// held by a cache are counted as in use by the allocator; the amount is
+// reported in AllocatorStats::bytes_in_thread_caches. Caches are flushed back
+// to the bins before the allocator reports that it is out of memory. For
+// cached allocations, RequestedSize() reports the size class rather than the
+// exact requested size.
 class BFCAllocator : public Allocator {
  public:
   // Takes ownership of sub_allocator.
@@ -79,8 +91,13 @@ class BFCAllocator : public Allocator {
 
   void SetSafeFrontier(uint64 count) override;
 
+  // Largest allocation that is served from the per-thread caches.
+  static constexpr size_t kMaxThreadCachedBytes = 64 << 10;
+
  private:
   struct Bin;
+  struct ThreadCache;
+  struct ThreadCacheList;
 
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
@@ -92,6 +109,50 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Frees the chunk holding 'ptr', coalescing it with its neighbors unless
+  // a timing counter is in use.
+  void FreeChunkForPtr(void* ptr) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the index of the thread cache size class that serves
+  // allocations of 'num_bytes' bytes. REQUIRES: num_bytes <=
+  // kMaxThreadCachedBytes.
+  static int ThreadCacheSizeClass(size_t num_bytes);
+
+  // Returns the calling thread's cache for this allocator, creating it if
+  // necessary.
+  ThreadCache* GetThreadCache();
+
+  // Serves an allocation of 'num_bytes' from the calling thread's cache,
+  // refilling it from the bins if it is empty. Returns nullptr if no memory
+  // could be obtained without going through the slow path.
+  void* AllocateFromThreadCache(size_t num_bytes);
+
+  // If 'ptr' is owned by the thread cache layer, returns it to the calling
+  // thread's cache (draining part of the cache to the bins if it is full)
+  // and returns true. Otherwise returns false.
+  bool DeallocateToThreadCache(void* ptr);
+
+  // Takes up to 'n' chunks of 'class_bytes' bytes from the bins under a
+  // single acquisition of lock_, stores them in 'ptrs' and returns how many
+  // were obtained.
+  int AllocateChunksForThreadCache(size_t class_bytes, int n, void** ptrs);
+
+  // Returns the chunks in 'ptrs' to the bins under a single acquisition of
+  // lock_.
+  void DeallocateChunksFromThreadCache(const std::vector<void*>& ptrs);
+
+  // Returns the chunks held by all thread caches to the bins. Returns true if
+  // any chunk was returned.
+  bool FlushThreadCaches();
+
+  // Bookkeeping of the chunks currently owned by the thread cache layer, so
+  // that DeallocateRaw() can recognize them without taking lock_. Sharded by
+  // pointer to keep contention low.
+  void RegisterThreadCachedChunks(void* const* ptrs, int n, int size_class);
+  void UnregisterThreadCachedChunks(const std::vector<void*>& ptrs);
+  // Returns the size class of 'ptr', or -1 if the cache layer does not own it.
+  int ThreadCachedChunkSizeClass(const void* ptr);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -515,6 +576,29 @@ class BFCAllocator : public Allocator {
   // Stats.
   AllocatorStats stats_ GUARDED_BY(lock_);
 
+  // Whether small allocations go through per-thread caches.
+  const bool use_thread_caches_;
+
+  // Identifies this allocator in the per-thread lists of caches. Unlike the
+  // allocator's address, it is never reused.
+  const int64 thread_cache_id_;
+
+  // All thread caches of this allocator, including those of threads that
+  // have exited (pruned lazily). Lock order: thread_caches_mu_ before any
+  // ThreadCache::mu; a ThreadCache::mu may be held while acquiring lock_.
+  mutex thread_caches_mu_;
+  std::vector<std::shared_ptr<ThreadCache>> thread_caches_
+      GUARDED_BY(thread_caches_mu_);
+
+  static constexpr int kNumThreadCachedChunkShards = 32;
+  struct ThreadCachedChunkShard {
+    mutex mu;
+    // Maps a chunk pointer to its thread cache size class.
+    std::unordered_map<const void*, int> chunks GUARDED_BY(mu);
+  };
+  std::array<ThreadCachedChunkShard, kNumThreadCachedChunkShards>
+      thread_cached_chunk_shards_;
+
   friend class GPUBFCAllocatorPrivateMethodsTest;
   TF_DISALLOW_COPY_AND_ASSIGN(BFCAllocator);
 };
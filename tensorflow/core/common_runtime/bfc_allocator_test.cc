@@ -0,0 +1,155 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<BFCAllocator> NewCPUBFCAllocator(bool thread_cache,
+                                                 size_t total_memory) {
+  setenv("TF_BFC_ALLOCATOR_THREAD_CACHE", thread_cache ? "1" : "0",
+         /*overwrite=*/1);
+  std::unique_ptr<BFCAllocator> a(new BFCAllocator(
+      new BasicCPUAllocator(port::kNUMANoAffinity, {}, {}), total_memory,
+      /*allow_growth=*/true, "cpu_bfc"));
+  unsetenv("TF_BFC_ALLOCATOR_THREAD_CACHE");
+  return a;
+}
+
+TEST(BFCAllocatorThreadCacheTest, ReusesFreedChunks) {
+  auto a = NewCPUBFCAllocator(/*thread_cache=*/true, 1 << 30);
+  void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  ASSERT_NE(p, nullptr);
+  a->DeallocateRaw(p);
+  void* q = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_EQ(p, q);
+  // Requests of the same size class share chunks.
+  EXPECT_EQ(1024, a->RequestedSize(q));
+  a->DeallocateRaw(q);
+
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_GT(stats->num_thread_cache_hits, 0);
+  EXPECT_GT(stats->bytes_in_thread_caches, 0);
+  // Cached chunks still count as in use by the bins.
+  EXPECT_GE(stats->bytes_in_use, stats->bytes_in_thread_caches);
+}
+
+TEST(BFCAllocatorThreadCacheTest, LargeAllocationsBypassCache) {
+  auto a = NewCPUBFCAllocator(/*thread_cache=*/true, 1 << 30);
+  const size_t kBytes = BFCAllocator::kMaxThreadCachedBytes + 1;
+  void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, kBytes);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(kBytes, a->RequestedSize(p));
+  a->DeallocateRaw(p);
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(0, stats->bytes_in_thread_caches);
+}
+
+TEST(BFCAllocatorThreadCacheTest, DisabledByDefault) {
+  auto a = NewCPUBFCAllocator(/*thread_cache=*/false, 1 << 30);
+  void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_EQ(1000, a->RequestedSize(p));
+  a->DeallocateRaw(p);
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(0, stats->num_thread_cache_hits);
+}
+
+TEST(BFCAllocatorThreadCacheTest, FlushesCachesBeforeOOM) {
+  // Fill the whole pool with small chunks, free them into this thread's
+  // cache, then ask for one large block: it can only be satisfied once the
+  // cached chunks are returned to the bins.
+  const size_t kTotal = 1 << 20;
+  auto a = NewCPUBFCAllocator(/*thread_cache=*/true, kTotal);
+  std::vector<void*> ptrs;
+  AllocationAttributes no_retry;
+  no_retry.no_retry_on_failure = true;
+  while (true) {
+    void* p =
+        a->AllocateRaw(Allocator::kAllocatorAlignment, 4096, no_retry);
+    if (p == nullptr) break;
+    ptrs.push_back(p);
+  }
+  ASSERT_GT(ptrs.size(), 0);
+  for (void* p : ptrs) a->DeallocateRaw(p);
+  void* big = a->AllocateRaw(Allocator::kAllocatorAlignment, kTotal / 2);
+  EXPECT_NE(big, nullptr);
+  a->DeallocateRaw(big);
+  EXPECT_EQ(0, a->GetStats()->bytes_in_use);
+}
+
+TEST(BFCAllocatorThreadCacheTest, CrossThreadFreeAndThreadExit) {
+  auto a = NewCPUBFCAllocator(/*thread_cache=*/true, 1 << 30);
+  const int kThreads = 4;
+  const int kAllocsPerThread = 1000;
+  std::vector<std::vector<void*>> ptrs(kThreads);
+  {
+    // Allocate on one set of threads ...
+    thread::ThreadPool pool(Env::Default(), "alloc", kThreads);
+    for (int t = 0; t < kThreads; ++t) {
+      pool.Schedule([&a, &ptrs, t]() {
+        random::PhiloxRandom philox(t, 17);
+        random::SimplePhilox rnd(&philox);
+        for (int i = 0; i < kAllocsPerThread; ++i) {
+          size_t bytes = 1 + rnd.Uniform(BFCAllocator::kMaxThreadCachedBytes);
+          void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, bytes);
+          CHECK(p != nullptr);
+          ptrs[t].push_back(p);
+        }
+      });
+    }
+  }
+  {
+    // ... and free on another, in a different order.
+    thread::ThreadPool pool(Env::Default(), "free", kThreads);
+    for (int t = 0; t < kThreads; ++t) {
+      pool.Schedule([&a, &ptrs, t]() {
+        for (void* p : ptrs[(t + 1) % kThreads]) a->DeallocateRaw(p);
+      });
+    }
+  }
+  // All threads have exited and returned their caches.
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(0, stats->bytes_in_thread_caches);
+}
+
+static void BM_AllocateSmall(int iters, int thread_cache) {
+  testing::StopTiming();
+  auto a = NewCPUBFCAllocator(thread_cache != 0, 1 << 30);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    void* p = a->AllocateRaw(Allocator::kAllocatorAlignment, 512);
+    a->DeallocateRaw(p);
+  }
+}
+BENCHMARK(BM_AllocateSmall)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace tensorflow
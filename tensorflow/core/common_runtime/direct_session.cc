@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
+#include "tensorflow/core/common_runtime/memory_planner.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
@@ -45,6 +46,8 @@ limitations under the License.
 #include "tensorflow/core/framework/logging.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/run_handler.h"
+#include "tensorflow/core/framework/step_arena_allocator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -70,6 +73,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
@@ -140,6 +144,31 @@ thread::ThreadPool* GlobalThreadPool(const SessionOptions& options) {
   return thread_pool;
 }
 
+// Returns one inter-op thread-pool per NUMA node, whose threads are bound to
+// that node. The inter-op threads are split evenly between the nodes.
+const std::vector<thread::ThreadPool*>& GlobalNumaThreadPools(
+    const SessionOptions& options) {
+  static const std::vector<thread::ThreadPool*>* const thread_pools = [&]() {
+    auto* pools = new std::vector<thread::ThreadPool*>;
+    const int num_numa_nodes = port::NUMANumNodes();
+    const int num_threads = std::max(
+        1, NumInterOpThreadsFromSessionOptions(options) / num_numa_nodes);
+    for (int node = 0; node < num_numa_nodes; ++node) {
+      VLOG(1) << "Direct session inter op parallelism threads for NUMA node "
+              << node << ": " << num_threads;
+      ThreadOptions thread_options;
+      thread_options.numa_node = node;
+      pools->push_back(new thread::ThreadPool(
+          options.env, thread_options, strings::StrCat("ComputeNuma", node),
+          num_threads,
+          !options.config.experimental().disable_thread_spinning(),
+          /*allocator=*/nullptr));
+    }
+    return pools;
+  }();
+  return *thread_pools;
+}
+
 // TODO(vrv): Figure out how to unify the many different functions
 // that generate RendezvousKey, since many of them have to be
 // consistent with each other.
@@ -152,6 +181,25 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Adds the op times in `step_stats` to the sampled op time metric. The op
+// types are parsed from the timeline labels, "<node> = <op>(<inputs>)".
+void RecordSampledOpTimes(const StepStats& step_stats) {
+  for (const DeviceStepStats& device_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : device_stats.node_stats()) {
+      const string& label = node_stats.timeline_label();
+      const size_t op_begin = label.find(" = ");
+      if (op_begin == string::npos) continue;
+      const size_t op_end = label.find('(', op_begin);
+      if (op_end == string::npos) continue;
+      const int64 op_time_usecs =
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+      metrics::RecordSampledOpTime(
+          label.substr(op_begin + 3, op_end - op_begin - 3),
+          std::max<int64>(op_time_usecs, 0));
+    }
+  }
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -337,6 +385,14 @@ DirectSession::DirectSession(const SessionOptions& options,
       run_in_caller_thread_ = true;
     }
   }
+  if (options_.config.experimental().use_numa_inter_op_thread_pools()) {
+    if (port::NUMAEnabled()) {
+      numa_thread_pools_ = GlobalNumaThreadPools(options_);
+    } else {
+      LOG(WARNING) << "use_numa_inter_op_thread_pools is set, but NUMA is not "
+                      "supported on this platform.";
+    }
+  }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
   const Status status =
@@ -344,6 +400,11 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  const Status sampling_status = ReadInt64FromEnvVar(
+      "TF_OP_TIME_SAMPLING_PERIOD", 0, &op_time_sampling_period_);
+  if (!sampling_status.ok()) {
+    LOG(ERROR) << sampling_status.error_message();
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   int devices_added = 0;
@@ -491,9 +552,11 @@ Status DirectSession::RunInternal(
     int64 step_id, const RunOptions& run_options,
     CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
     RunMetadata* run_metadata,
-    const thread::ThreadPoolOptions& threadpool_options) {
+    const thread::ThreadPoolOptions& threadpool_options,
+    const std::vector<Tensor>* fetch_buffers) {
   const uint64 start_time_usecs = options_.env->NowMicros();
-  const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
+  const int64 executor_step_count =
+      executors_and_keys->step_count.fetch_add(1, std::memory_order_relaxed);
   RunState run_state(step_id, &devices_);
 
   profiler::TraceMe activity(
@@ -578,6 +641,22 @@ Status DirectSession::RunInternal(
   args.sync_on_finish = sync_on_finish_;
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
 
+  StepArenaAllocator* step_arena = nullptr;
+  if (options_.config.experimental().use_step_arena()) {
+    // Kernel temporaries on the CPU devices of this step are bump-allocated
+    // from an arena that is sized by the previous steps.
+    for (const auto& item : executors_and_keys->items) {
+      if (item.device->device_type() == DEVICE_CPU) {
+        step_arena = new StepArenaAllocator(
+            item.device->GetAllocator(AllocatorAttributes()),
+            executors_and_keys->step_arena_bytes.load(
+                std::memory_order_relaxed));
+        run_state.step_container.set_step_arena(step_arena);
+        break;
+      }
+    }
+  }
+
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
 
   bool update_cost_model = false;
@@ -592,11 +671,23 @@ Status DirectSession::RunInternal(
           ((measure_step_count + 1) % build_cost_model_every == 0);
     }
   }
+  // The op times of sampled steps are read from the step stats, which are
+  // only collected into the RunMetadata if they are requested.
+  const bool sample_op_times =
+      op_time_sampling_period_ > 0 &&
+      executor_step_count % op_time_sampling_period_ == 0;
+  StepStats sampled_step_stats;
+  const StepStats* step_stats = nullptr;
   if (do_trace || update_cost_model ||
       run_options.report_tensor_allocations_upon_oom()) {
     run_state.collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
+    step_stats = &run_metadata->step_stats();
+  } else if (sample_op_times) {
+    run_state.collector.reset(new StepStatsCollector(&sampled_step_stats));
+    args.stats_collector = run_state.collector.get();
+    step_stats = &sampled_step_stats;
   }
 
   std::unique_ptr<ProfilerSession> profiler_session;
@@ -658,7 +749,8 @@ Status DirectSession::RunInternal(
   if (ShouldUseRunHandlerPool(run_options) &&
       run_options.experimental().use_run_handler_pool()) {
     VLOG(1) << "Using RunHandler to scheduler inter-op closures.";
-    handler = GetOrCreateRunHandlerPool(options_)->Get(step_id);
+    handler = GetOrCreateRunHandlerPool(options_)->Get(
+        step_id, run_options.experimental().run_handler_pool_options());
   }
   auto* handler_ptr = handler.get();
 
@@ -676,15 +768,35 @@ Status DirectSession::RunInternal(
     };
   }
 
-  for (const auto& item : executors_and_keys->items) {
+  // Partitions run on the inter-op pool of their device's NUMA node, unless
+  // the caller picked a pool for this step.
+  const bool use_numa_thread_pools =
+      !numa_thread_pools_.empty() && pool != nullptr &&
+      handler_ptr == nullptr &&
+      threadpool_options.inter_op_threadpool == nullptr &&
+      run_options.inter_op_thread_pool() <= 0;
+
+  // The caller-owned fetch buffers, handed to the partitions producing them.
+  std::vector<std::vector<Executor::Args::OutputBuffer>> output_buffers(
+      fetch_buffers != nullptr ? num_executors : 0);
+
+  for (size_t i = 0; i < num_executors; ++i) {
+    const auto& item = executors_and_keys->items[i];
     // TODO(azaks): support partial run.
     // TODO(azaks): if the device picks its own threadpool, we need to assign
     //     less threads to the main compute pool by default.
     thread::ThreadPool* device_thread_pool =
         item.device->tensorflow_device_thread_pool();
+    const int numa_node = item.device->attributes().locality().numa_node();
     // TODO(crk): Investigate usage of RunHandlerPool when using device specific
     // thread pool(s).
-    if (!device_thread_pool) {
+    if (!device_thread_pool && use_numa_thread_pools && numa_node >= 0 &&
+        numa_node < numa_thread_pools_.size()) {
+      thread::ThreadPool* numa_pool = numa_thread_pools_[numa_node];
+      args.runner = [numa_pool](Executor::Args::Closure c) {
+        numa_pool->Schedule(std::move(c));
+      };
+    } else if (!device_thread_pool) {
       args.runner = default_runner;
     } else {
       args.runner = [this, device_thread_pool](Executor::Args::Closure c) {
@@ -694,6 +806,17 @@ Status DirectSession::RunInternal(
     if (handler != nullptr) {
       args.user_intra_op_threadpool = handler->AsIntraThreadPoolInterface();
     }
+    args.output_buffers = nullptr;
+    if (fetch_buffers != nullptr && !item.fetch_producers.empty()) {
+      for (const auto& producer : item.fetch_producers) {
+        const Tensor& buffer = (*fetch_buffers)[producer.fetch_index];
+        if (buffer.IsInitialized()) {
+          output_buffers[i].push_back(
+              {producer.node_id, producer.output, buffer});
+        }
+      }
+      args.output_buffers = &output_buffers[i];
+    }
 
     item.executor->RunAsync(args, barrier->Get());
   }
@@ -703,6 +826,16 @@ Status DirectSession::RunInternal(
                           ? run_options.timeout_in_ms()
                           : operation_timeout_in_ms_);
 
+  if (step_arena != nullptr) {
+    const int64 bytes = step_arena->BytesRequested();
+    int64 reserved =
+        executors_and_keys->step_arena_bytes.load(std::memory_order_relaxed);
+    while (bytes > reserved &&
+           !executors_and_keys->step_arena_bytes.compare_exchange_weak(
+               reserved, bytes, std::memory_order_relaxed)) {
+    }
+  }
+
   if (!cancellation_manager_->DeregisterCallback(cancellation_token)) {
     // The step has been cancelled: make sure we don't attempt to receive the
     // outputs as this would make it block forever.
@@ -729,6 +862,9 @@ Status DirectSession::RunInternal(
 
   if (run_state.collector) {
     run_state.collector->Finalize();
+    if (sample_op_times) {
+      RecordSampledOpTimes(*step_stats);
+    }
   }
 
   // Build and return the cost model as instructed.
@@ -1354,6 +1490,31 @@ Status DirectSession::CreateExecutors(
     TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device->device_type()),
                                          device->name(),
                                          partition_graph.get()));
+
+    if (options_.config.experimental().use_static_memory_plan() &&
+        device->device_type() == DEVICE_CPU) {
+      auto memory_plan = std::make_shared<MemoryPlan>();
+      TF_RETURN_IF_ERROR(PlanGraphMemory(*partition_graph, memory_plan.get()));
+      params.memory_plan = std::move(memory_plan);
+    }
+
+    if (callable_options.fetch_into_caller_buffers() &&
+        device->device_type() == DEVICE_CPU) {
+      for (const Node* n : partition_graph->nodes()) {
+        if (!n->IsRetval()) continue;
+        int index;
+        TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+        const Edge* edge;
+        TF_RETURN_IF_ERROR(n->input_edge(0, &edge));
+        if (edge->src()->IsArg() ||
+            IsRefType(edge->src()->output_type(edge->src_output()))) {
+          continue;
+        }
+        item->fetch_producers.push_back(
+            {index, edge->src()->id(), edge->src_output()});
+      }
+    }
+
     // NewLocalExecutor takes ownership of partition_graph.
     item->graph = partition_graph.get();
     item->executor = nullptr;
@@ -1688,11 +1849,7 @@ Status DirectSession::CreateGraphs(
 
 ::tensorflow::Status DirectSession::Close() {
   cancellation_manager_->StartCancel();
-  {
-    mutex_lock l(closed_lock_);
-    if (closed_) return ::tensorflow::Status::OK();
-    closed_ = true;
-  }
+  if (closed_.exchange(true)) return ::tensorflow::Status::OK();
   if (factory_ != nullptr) factory_->Deregister(this);
   return ::tensorflow::Status::OK();
 }
@@ -1791,10 +1948,21 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
     mutex_lock l(callables_lock_);
     *out_handle = next_callable_handle_++;
     callables_[*out_handle] = {std::move(ek), std::move(func_info)};
+    PublishCallableTableLocked();
   }
   return Status::OK();
 }
 
+void DirectSession::PublishCallableTableLocked() {
+  auto table = std::make_shared<CallableTable>();
+  table->reserve(callables_.size());
+  for (const auto& p : callables_) {
+    table->emplace(p.first, p.second.executors_and_keys);
+  }
+  std::atomic_store(&callable_table_,
+                    std::shared_ptr<const CallableTable>(std::move(table)));
+}
+
 class DirectSession::RunCallableCallFrame : public CallFrameInterface {
  public:
   RunCallableCallFrame(DirectSession* session,
@@ -1857,14 +2025,22 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
 
   // Check if we already have an executor for these arguments.
   std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
-  const int64 step_id = step_id_counter_.fetch_add(1);
+  const int64 step_id =
+      step_id_counter_.fetch_add(1, std::memory_order_relaxed);
 
-  {
-    tf_shared_lock l(callables_lock_);
+  std::shared_ptr<const CallableTable> callable_table =
+      std::atomic_load(&callable_table_);
+  if (callable_table != nullptr) {
+    auto it = callable_table->find(handle);
+    if (it != callable_table->end()) {
+      executors_and_keys = it->second.lock();
+    }
+  }
+  if (!executors_and_keys) {
+    mutex_lock l(callables_lock_);
     if (handle >= next_callable_handle_) {
       return errors::InvalidArgument("No such callable handle: ", handle);
     }
-    executors_and_keys = callables_[handle].executors_and_keys;
   }
 
   if (!executors_and_keys) {
@@ -1884,6 +2060,24 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "Expected ", executors_and_keys->input_types.size(),
         " feed tensors, but got ", feed_tensors.size());
   }
+  // The caller-owned buffers for the fetches. These are copies of the
+  // caller's tensors, which share their memory.
+  std::vector<Tensor> fetch_buffers;
+  if (fetch_tensors != nullptr &&
+      executors_and_keys->callable_options.fetch_into_caller_buffers()) {
+    fetch_buffers = *fetch_tensors;
+    fetch_buffers.resize(executors_and_keys->output_types.size());
+    std::unordered_set<const void*> buffer_data;
+    for (int i = 0; i < fetch_buffers.size(); ++i) {
+      Tensor& buffer = fetch_buffers[i];
+      if (!buffer.IsInitialized()) continue;
+      // A buffer is only used for a single fetch of the expected type.
+      if (buffer.dtype() != executors_and_keys->output_types[i] ||
+          !buffer_data.insert(buffer.tensor_data().data()).second) {
+        buffer = Tensor();
+      }
+    }
+  }
   if (fetch_tensors != nullptr) {
     fetch_tensors->resize(executors_and_keys->output_types.size());
   } else if (!executors_and_keys->output_types.empty()) {
@@ -1910,7 +2104,8 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
 
   TF_RETURN_IF_ERROR(RunInternal(
       step_id, executors_and_keys->callable_options.run_options(), &call_frame,
-      executors_and_keys.get(), run_metadata, threadpool_options));
+      executors_and_keys.get(), run_metadata, threadpool_options,
+      fetch_buffers.empty() ? nullptr : &fetch_buffers));
 
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
@@ -1929,6 +2124,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     return errors::InvalidArgument("No such callable handle: ", handle);
   }
   callables_.erase(handle);
+  PublishCallableTableLocked();
   return Status::OK();
 }
 
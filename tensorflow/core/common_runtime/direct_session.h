@@ -138,6 +138,15 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+
+    // The node outputs of this partition that produce fetches, when
+    // CallableOptions.fetch_into_caller_buffers is set.
+    struct FetchProducer {
+      int fetch_index;
+      int node_id;
+      int output;
+    };
+    std::vector<FetchProducer> fetch_producers;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -149,9 +158,13 @@ class DirectSession : public Session {
   // 'input_keys' are the rendezvous keys for the feeds and 'output_keys'
   // are rendezvous keys for the fetches.
   struct ExecutorsAndKeys {
-    ExecutorsAndKeys() : step_count(0) {}
+    ExecutorsAndKeys() : step_count(0), step_arena_bytes(0) {}
 
     std::atomic_int_fast64_t step_count;
+    // The largest number of bytes of kernel temporaries requested by a step,
+    // which is reserved up front for the next step when
+    // ConfigProto.Experimental.use_step_arena is set.
+    std::atomic<int64> step_arena_bytes;
     std::unique_ptr<Graph> graph;
     NameNodeMap name_to_node;
     std::vector<PerPartitionExecutorsAndLib> items;
@@ -251,7 +264,8 @@ class DirectSession : public Session {
       int64 step_id, const RunOptions& run_options,
       CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
       RunMetadata* run_metadata,
-      const thread::ThreadPoolOptions& threadpool_options);
+      const thread::ThreadPoolOptions& threadpool_options,
+      const std::vector<Tensor>* fetch_buffers = nullptr);
 
   // Returns whether inter-op execution uses a global pool or the input
   // `run_options` requests being run on inter_op_thread_pool = 0 in case
@@ -294,14 +308,14 @@ class DirectSession : public Session {
                            int64 timeout_in_ms);
 
   ::tensorflow::Status CheckNotClosed() {
-    mutex_lock l(closed_lock_);
-    if (closed_) return errors::Cancelled("Session has been closed.");
+    if (closed_.load(std::memory_order_acquire)) {
+      return errors::Cancelled("Session has been closed.");
+    }
     return ::tensorflow::Status::OK();
   }
 
   ::tensorflow::Status CheckGraphCreated(const char* method) {
-    mutex_lock l(graph_state_lock_);
-    if (!graph_created_) {
+    if (!graph_created_.load(std::memory_order_acquire)) {
       return errors::InvalidArgument(
           "Session was not created with a graph before ", method, "!");
     }
@@ -326,12 +340,19 @@ class DirectSession : public Session {
   // Unique session identifier.
   string session_handle_;
   mutex graph_state_lock_;
-  bool graph_created_ GUARDED_BY(graph_state_lock_) = false;
+  // Only set under graph_state_lock_, but read without it by
+  // CheckGraphCreated().
+  std::atomic<bool> graph_created_{false};
 
   // The thread-pools to use for running ops, with a bool indicating if the pool
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
 
+  // If ConfigProto.Experimental.use_numa_inter_op_thread_pools is set, one
+  // (process-wide) inter-op thread-pool per NUMA node, indexed by node. Not
+  // owned.
+  std::vector<thread::ThreadPool*> numa_thread_pools_;
+
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
@@ -359,6 +380,17 @@ class DirectSession : public Session {
   int64 next_callable_handle_ GUARDED_BY(callables_lock_) = 0;
   std::unordered_map<int64, Callable> callables_ GUARDED_BY(callables_lock_);
 
+  // RunCallable() looks up the executors of a callable in an immutable
+  // snapshot of `callables_`, without taking `callables_lock_`. The snapshot
+  // only holds weak references, so a released callable is not kept alive by
+  // it. MakeCallable() and ReleaseCallable() publish a new snapshot; a
+  // replaced one is freed once the last concurrent run reading it is done.
+  // Only accessed through std::atomic_load() and std::atomic_store().
+  typedef std::unordered_map<int64, std::weak_ptr<ExecutorsAndKeys>>
+      CallableTable;
+  void PublishCallableTableLocked() EXCLUSIVE_LOCKS_REQUIRED(callables_lock_);
+  std::shared_ptr<const CallableTable> callable_table_;
+
   // Holds mappings from handle to partial run state.
   std::unordered_map<string, std::unique_ptr<RunState>> partial_runs_
       GUARDED_BY(executor_lock_);
@@ -387,8 +419,7 @@ class DirectSession : public Session {
   std::unique_ptr<FunctionLibraryDefinition> flib_def_;
 
   // true if the Session has been Closed.
-  mutex closed_lock_;
-  bool closed_ GUARDED_BY(closed_lock_) = false;
+  std::atomic<bool> closed_{false};
 
   // For generating unique names for this session instance.
   std::atomic<int64> edge_name_counter_ = {0};
@@ -419,6 +450,12 @@ class DirectSession : public Session {
   // pool according to other specifications of RunOptions and ConfigProto.
   bool run_in_caller_thread_ = false;
 
+  // If positive, the op times of one step in every op_time_sampling_period_
+  // steps of an executor are collected and added to the
+  // /tensorflow/core/sampled_op_time_usecs metric. Set by the environment
+  // variable TF_OP_TIME_SAMPLING_PERIOD.
+  int64 op_time_sampling_period_ = 0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(DirectSession);
 
   // EXPERIMENTAL: debugger (tfdbg) related
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
@@ -226,6 +227,127 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
       absl::StrContains(s.error_message(), "optimize_for_static_graph"));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_IncrementalOptimization) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  RewriterConfig* rewrite_options =
+      options.config.mutable_graph_options()->mutable_rewrite_options();
+  rewrite_options->set_incremental_optimization(true);
+  rewrite_options->set_debug_stripper(RewriterConfig::ON);
+  rewrite_options->set_min_graph_nodes(-1);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  // Every extension only reads from nodes fetched before, so the previously
+  // optimized graph is reused.
+  auto make_extension = [this](const string& name, const string& input) {
+    GraphDef extension;
+    *extension.mutable_versions() = def_.versions();
+    NodeDef* check = extension.add_node();
+    check->set_name(strings::StrCat(name, "/check"));
+    check->set_op("CheckNumerics");
+    check->add_input(input);
+    (*check->mutable_attr())["T"].set_type(DT_FLOAT);
+    (*check->mutable_attr())["message"].set_s("");
+    NodeDef* neg = extension.add_node();
+    neg->set_name(name);
+    neg->set_op("Neg");
+    neg->add_input(check->name());
+    (*neg->mutable_attr())["T"].set_type(DT_FLOAT);
+    return extension;
+  };
+
+  TF_ASSERT_OK(session->Extend(make_extension("w", y_)));
+  TF_ASSERT_OK(session->Run({}, {"w:0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-5.0, outputs[0].matrix<float>()(0, 0));
+
+  TF_ASSERT_OK(session->Extend(make_extension("v", "w")));
+  TF_ASSERT_OK(session->Run({}, {"v:0", y_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(2, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(5.0, outputs[1].matrix<float>()(0, 0));
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_UseStepArena) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_use_step_arena(true);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // Later steps reserve the arena size measured by the earlier ones. Keep the
+  // outputs of every step alive past the end of the following steps.
+  std::vector<Tensor> all_outputs;
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    all_outputs.push_back(outputs[0]);
+  }
+  for (const Tensor& t : all_outputs) {
+    EXPECT_FLOAT_EQ(5.0, t.matrix<float>()(0, 0));
+  }
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_UseStaticMemoryPlan) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_use_static_memory_plan(true);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0", y_neg_ + ":0"}, {}, &outputs));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(-5.0, outputs[1].matrix<float>()(0, 0));
+  }
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_SampleOpTimes) {
+  setenv("TF_OP_TIME_SAMPLING_PERIOD", "2", /*overwrite=*/1);
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  unsetenv("TF_OP_TIME_SAMPLING_PERIOD");
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The first and third steps are sampled.
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    TF_ASSERT_OK(session->Run(RunOptions(), {}, {y_ + ":0"}, {y_neg_},
+                              &outputs, &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    // The sampled step stats are not returned.
+    EXPECT_EQ(0, run_metadata.step_stats().dev_stats_size());
+  }
+
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  std::unique_ptr<monitoring::CollectedMetrics> metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics(options);
+  const monitoring::PointSet& point_set =
+      *metrics->point_set_map.at("/tensorflow/core/sampled_op_time_usecs");
+  double num_matmuls = 0;
+  for (const auto& point : point_set.points) {
+    if (point->labels[0].value == "MatMul") {
+      num_matmuls = point->histogram_value.num();
+    }
+  }
+  EXPECT_GE(num_matmuls, 2);
+}
+
 TEST_F(DirectSessionMinusAXTest, TestTensorConnection) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -440,6 +562,44 @@ TEST_F(DirectSessionMinusAXTest, TestFeed_Callable) {
   EXPECT_FLOAT_EQ(39.0, mat(1, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, TestFeed_CallableFetchIntoCallerBuffers) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({x_}, {y_ + ":0"}, {});
+  callable_options.set_fetch_into_caller_buffers(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+  Tensor t(DT_FLOAT, TensorShape({2, 1}));
+  t.matrix<float>()(0, 0) = 5;
+  t.matrix<float>()(1, 0) = 6;
+  std::vector<Tensor> inputs = {t};
+
+  // The MatMul producing y writes directly into the caller's buffer.
+  Tensor buffer(DT_FLOAT, TensorShape({2, 1}));
+  std::vector<Tensor> outputs = {buffer};
+  TF_ASSERT_OK(session->RunCallable(handle, inputs, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_EQ(buffer.tensor_data().data(), outputs[0].tensor_data().data());
+  EXPECT_FLOAT_EQ(17.0, buffer.matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(39.0, buffer.matrix<float>()(1, 0));
+
+  // A buffer of the wrong shape is ignored.
+  Tensor wrong_shape(DT_FLOAT, TensorShape({3}));
+  outputs = {wrong_shape};
+  TF_ASSERT_OK(session->RunCallable(handle, inputs, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_NE(wrong_shape.tensor_data().data(),
+            outputs[0].tensor_data().data());
+  EXPECT_EQ(TensorShape({2, 1}), outputs[0].shape());
+  EXPECT_FLOAT_EQ(17.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(39.0, outputs[0].matrix<float>()(1, 0));
+}
+
 TEST_F(DirectSessionMinusAXTest, TestConcurrency) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -505,6 +665,47 @@ TEST_F(DirectSessionMinusAXTest, TestConcurrency_Callable) {
   delete tp;
 }
 
+// Runs a callable concurrently with the creation and release of others, which
+// replace the table of callables that RunCallable() reads.
+TEST_F(DirectSessionMinusAXTest, TestConcurrency_MakeAndReleaseCallable) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(
+      session->MakeCallable(MakeCallableOptions({}, {y_ + ":0"}, {}), &handle));
+
+  auto run_fn = [&session, handle]() {
+    for (int i = 0; i < 1000; ++i) {
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+      ASSERT_EQ(1, outputs.size());
+      auto mat = outputs[0].matrix<float>();
+      EXPECT_FLOAT_EQ(3.0, mat(0, 0));
+    }
+  };
+  auto make_and_release_fn = [this, &session]() {
+    for (int i = 0; i < 100; ++i) {
+      Session::CallableHandle other_handle;
+      TF_ASSERT_OK(session->MakeCallable(
+          MakeCallableOptions({}, {y_ + ":0"}, {}), &other_handle));
+      TF_ASSERT_OK(session->ReleaseCallable(other_handle));
+    }
+  };
+
+  for (int i = 0; i < 3; ++i) {
+    tp->Schedule(run_fn);
+  }
+  tp->Schedule(make_and_release_fn);
+
+  // Wait for the functions to finish.
+  delete tp;
+}
+
 TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   Initialize({1, 2, 3, 4});
 
@@ -542,6 +743,26 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestNumaInterOpThreadPools) {
+  Initialize({1, 2, 3, 4});
+
+  // Falls back to the default thread-pool where NUMA is not supported.
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_inter_op_thread_pools(
+      true);
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  for (int i = 0; i < 10; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -885,6 +1106,54 @@ TEST(DirectSessionTest, MultipleFeedTest_Callable) {
   EXPECT_TRUE(absl::StrContains(s.error_message(), "fed more than once"));
 }
 
+TEST(DirectSessionTest, ConstantFeedTest_Callable) {
+  GraphDef def;
+  Graph g(OpRegistry::Global());
+
+  Node* is_training;
+  TF_ASSERT_OK(NodeBuilder("is_training", "Placeholder")
+                   .Attr("dtype", DT_BOOL)
+                   .Attr("shape", TensorShape({}))
+                   .Finalize(&g, &is_training));
+  Tensor value(DT_FLOAT, TensorShape({}));
+  value.scalar<float>()() = 3.0;
+  Node* x = test::graph::Constant(&g, value);
+  Node* switch_node = test::graph::Switch(&g, x, is_training);
+  Node* inference = test::graph::Identity(&g, switch_node, 0);
+  Node* training = test::graph::Unary(&g, "Neg", switch_node, 1);
+  Node* merge = test::graph::Merge(&g, inference, training);
+  g.ToGraphDef(&def);
+
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  for (bool flag : {false, true}) {
+    CallableOptions callable_options =
+        MakeCallableOptions({}, {merge->name() + ":0"}, {});
+    Tensor flag_value(flag);
+    flag_value.AsProtoTensorContent(
+        &(*callable_options.mutable_constant_feed())["is_training:0"]);
+
+    Session::CallableHandle handle;
+    TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(flag ? -3.0 : 3.0, outputs[0].scalar<float>()());
+    TF_ASSERT_OK(session->ReleaseCallable(handle));
+  }
+
+  // A tensor cannot be both fed and constant fed.
+  CallableOptions callable_options =
+      MakeCallableOptions({"is_training:0"}, {merge->name() + ":0"}, {});
+  Tensor(false).AsProtoTensorContent(
+      &(*callable_options.mutable_constant_feed())["is_training"]);
+  Session::CallableHandle handle;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->MakeCallable(callable_options, &handle)));
+}
+
 TEST(DirectSessionTest, TestTensorConnectionUseTwice) {
   Graph graph(OpRegistry::Global());
 
@@ -16,11 +16,22 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
+namespace {
+
+int64 FusionWindow() {
+  int64 fusion_window;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_FUSION_WINDOW", 0, &fusion_window));
+  return fusion_window;
+}
+
+}  // namespace
 
 EagerExecutor::EagerExecutor(bool async)
-    : thread_(async ? tensorflow::Env::Default()->StartThread(
+    : fusion_window_(FusionWindow()),
+      thread_(async ? tensorflow::Env::Default()->StartThread(
                           tensorflow::ThreadOptions(), "eager_async_executor",
                           std::bind(&EagerExecutor::Run, this))
                     : nullptr) {}
@@ -68,7 +79,7 @@ void EagerExecutor::WaitForOrDestroyAllPendingNodes(mutex_lock* lock) {
     }
     while (!node_queue_.empty()) {
       node_queue_.front()->Abort(status);
-      node_queue_.pop();
+      node_queue_.pop_front();
     }
     return;
   }
@@ -110,7 +121,7 @@ Status EagerExecutor::Add(std::unique_ptr<EagerNode> node) {
       DCHECK(thread_) << "EnableAsync should have been called before Add";
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(node));
+        node_queue_.push_back(std::move(node));
 
         // If there were no previous nodes pending, wake the run thread to start
         // processing requests again.
@@ -169,6 +180,9 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     EagerNode* curr_node_raw;
+    // Runs instead of the front node and the next `num_fused` nodes.
+    std::unique_ptr<EagerNode> fused_node;
+    int num_fused = 0;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -183,8 +197,18 @@ void EagerExecutor::Run() {
       // WaitForAllPendingNodes where we get the top EagerNode pointer
       // and register a notification for its completion.
       curr_node_raw = node_queue_.front().get();
+      if (fusion_window_ > 1 && node_queue_.size() > 1) {
+        std::vector<EagerNode*> next;
+        for (auto it = node_queue_.begin() + 1;
+             it != node_queue_.end() && static_cast<int64>(next.size()) + 1 < fusion_window_;
+             ++it) {
+          next.push_back(it->get());
+        }
+        fused_node = curr_node_raw->Fuse(next, &num_fused);
+      }
     }
-    tensorflow::Status status = curr_node_raw->Run();
+    tensorflow::Status status =
+        fused_node != nullptr ? fused_node->Run() : curr_node_raw->Run();
     const bool ok = status.ok();
 
     std::unique_ptr<EagerNode> curr_node;
@@ -192,7 +216,16 @@ void EagerExecutor::Run() {
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       curr_node = std::move(node_queue_.front());
-      node_queue_.pop();
+      node_queue_.pop_front();
+      // The fused nodes were run or aborted by `fused_node`.
+      std::vector<EagerNode*> done_nodes = {curr_node_raw};
+      if (fused_node != nullptr) {
+        for (int i = 0; i < num_fused; ++i) {
+          done_nodes.push_back(node_queue_.front().get());
+          nodes_to_destroy.push_back(std::move(node_queue_.front()));
+          node_queue_.pop_front();
+        }
+      }
       if (!ok) {
         status_ = status;
         // We remove any pending ops so that we don't try to execute them if
@@ -205,27 +238,34 @@ void EagerExecutor::Run() {
         while (!node_queue_.empty()) {
           node_queue_.front()->Abort(status);
           nodes_to_destroy.push_back(std::move(node_queue_.front()));
-          node_queue_.pop();
+          node_queue_.pop_front();
         }
       }
       if (!node_done_notifications_.empty()) {
         // Note that we notify all waiting threads in case an error has
         // occurred. These calling threads are responsible for checking status_
         // before proceeding.
-        const auto range =
-            ok ? node_done_notifications_.equal_range(curr_node_raw)
-               : make_pair(node_done_notifications_.begin(),
-                           node_done_notifications_.end());
-        for (auto it = range.first; it != range.second; ++it) {
-          it->second->notify_all();
+        if (ok) {
+          for (EagerNode* done_node : done_nodes) {
+            const auto range =
+                node_done_notifications_.equal_range(done_node);
+            for (auto it = range.first; it != range.second; ++it) {
+              it->second->notify_all();
+            }
+            node_done_notifications_.erase(range.first, range.second);
+          }
+        } else {
+          for (auto& notification : node_done_notifications_) {
+            notification.second->notify_all();
+          }
+          node_done_notifications_.clear();
         }
-        node_done_notifications_.erase(range.first, range.second);
       }
     }
-    // curr_node and nodes_to_destroy will be destructed here, while not holding
-    // node_queue_mutex_. This is important because, unfortunately, some nodes'
-    // destructors can enqueue more operations onto this executor and cause
-    // a deadlock.
+    // curr_node, fused_node and nodes_to_destroy will be destructed here, while
+    // not holding node_queue_mutex_. This is important because, unfortunately,
+    // some nodes' destructors can enqueue more operations onto this executor
+    // and cause a deadlock.
   }
 }
 
@@ -17,9 +17,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
@@ -36,6 +36,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class ExecuteNode;
+
 // A unit of execution for the EagerExecutor class below. Example subclasses
 // encapsulate execution of a TFE_Op, or copying a TFE_TensorHandle from one
 // device to another.
@@ -57,6 +59,19 @@ class EagerNode {
   // For example, if the node would have computed some tensors in the Run(),
   // it should poison the corresponding tensor handles in this method.
   virtual void Abort(Status status) = 0;
+
+  // Returns this node if it runs an op, nullptr otherwise.
+  virtual ExecuteNode* AsExecuteNode() { return nullptr; }
+
+  // Returns a node computing the outputs of this node and of the first
+  // `*num_fused` nodes of `next`, the nodes queued after this one, or nullptr
+  // if this node doesn't fuse with them.  The returned node is run instead of
+  // these nodes, and must run or abort them if it can't compute their outputs.
+  // Called with the node queue lock held, so it must not block.
+  virtual std::unique_ptr<EagerNode> Fuse(const std::vector<EagerNode*>& next,
+                                          int* num_fused) {
+    return nullptr;
+  }
 };
 
 // A class for handling async execution (see TFE_ContextSetAsync).
@@ -67,7 +82,12 @@ class EagerNode {
 // TODO(agarwal): Implement support for control dependencies.
 // TODO(agarwal): Support out-of-order execution and dispatching multiple
 // EagerNode in parallel.
-// TODO(agarwal): Implement optimizations over EagerNode traces.
+//
+// In async mode, the executor can fuse the front node of the queue with the
+// nodes queued after it, see EagerNode::Fuse().  TF_EAGER_FUSION_WINDOW sets
+// the maximum number of nodes fused together (0, the default, disables the
+// fusion).  Only the nodes already queued are fused: their execution is never
+// delayed to wait for more nodes.
 class EagerExecutor {
  public:
   explicit EagerExecutor(bool async);
@@ -147,9 +167,12 @@ class EagerExecutor {
   condition_variable nodes_pending_ GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending EagerNodes.
-  std::queue<std::unique_ptr<EagerNode>> node_queue_
+  std::deque<std::unique_ptr<EagerNode>> node_queue_
       GUARDED_BY(node_queue_mutex_);
 
+  // Maximum number of nodes fused together by Run().
+  const int64 fusion_window_;
+
   // `status_` is set based on any errors raised during execution of a
   // EagerNode.  It remains set until ClearError is called.
   Status status_ GUARDED_BY(node_queue_mutex_);
@@ -43,6 +43,26 @@ void EagerOperation::ConsumeInput(tensorflow::TensorHandle* h) {
   attrs_.NumInputs(static_cast<int>(inputs_.size()));
 }
 
+core::RefCountPtr<KernelAndDevice> EagerOperation::GetMemoizedKernel(
+    const Fprint128& cache_key, int64 cache_generation) const {
+  if (memoized_kernel_ == nullptr || !(memoized_kernel_key_ == cache_key) ||
+      memoized_kernel_generation_ != cache_generation) {
+    return nullptr;
+  }
+  memoized_kernel_->Ref();
+  return core::RefCountPtr<KernelAndDevice>(memoized_kernel_.get());
+}
+
+void EagerOperation::MemoizeKernel(const Fprint128& cache_key,
+                                   int64 cache_generation,
+                                   KernelAndDevice* kernel) {
+  memoized_kernel_key_ = cache_key;
+  memoized_kernel_generation_ = cache_generation;
+  if (memoized_kernel_.get() == kernel) return;
+  kernel->Ref();
+  memoized_kernel_.reset(kernel);
+}
+
 string EagerOperation::DebugString() const {
   string out;
   VLOG(1) << "EagerOperation::DebugString() over " << this;
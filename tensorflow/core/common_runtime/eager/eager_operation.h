@@ -84,6 +84,16 @@ class EagerOperation {
 
   EagerExecutor* Executor() { return executor_; }
 
+  // Returns the kernel memoized by MemoizeKernel() for "cache_key", or nullptr
+  // if there is none or the kernel cache of the context was cleared since.
+  // Saves the kernel cache lookup when the operation is executed again.
+  core::RefCountPtr<KernelAndDevice> GetMemoizedKernel(
+      const Fprint128& cache_key, int64 cache_generation) const;
+  // Memoizes the kernel of "cache_key", looked up in the kernel cache of
+  // generation "cache_generation".
+  void MemoizeKernel(const Fprint128& cache_key, int64 cache_generation,
+                     KernelAndDevice* kernel);
+
   string DebugString() const;
 
  private:
@@ -98,6 +108,9 @@ class EagerOperation {
   const bool is_function_;
   CancellationManager* cancellation_manager_ = nullptr;  // Not owned.
   EagerExecutor* const executor_;                        // Not owned.
+  core::RefCountPtr<KernelAndDevice> memoized_kernel_;
+  Fprint128 memoized_kernel_key_{0, 0};
+  int64 memoized_kernel_generation_ = -1;
 };
 }  // namespace tensorflow
 
@@ -465,8 +465,10 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
   Fprint128 cache_key = op->MutableAttrs()->CacheKey(
       DeviceNameOrUnspecified(op->GetDeviceName()));
 
+  // Primitive ops never are multi-device functions, which saves the function
+  // library lookup.
   bool is_multi_device_function =
-      IsMultiDevice(ctx->FindFunctionDef(op->Name()));
+      op->is_function() && IsMultiDevice(ctx->FindFunctionDef(op->Name()));
 
   std::vector<Device*> input_dev_ptrs;
   // `input_tensor_shapes` contains (potentially a subset of) non DT_RESOURCE
@@ -543,7 +545,14 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
     }
   }
 
-  core::RefCountPtr<KernelAndDevice> kernel = ctx->GetCachedKernel(cache_key);
+  // Operations executed several times reuse their kernel without locking the
+  // kernel cache, until it is cleared.
+  const int64 cache_generation = ctx->KernelCacheGeneration();
+  core::RefCountPtr<KernelAndDevice> kernel =
+      op->GetMemoizedKernel(cache_key, cache_generation);
+  if (kernel == nullptr) {
+    kernel = ctx->GetCachedKernel(cache_key);
+  }
   if (kernel == nullptr) {
     VLOG(2) << "Creating new kernel for " << op->Name() << " on device "
             << DeviceNameOrUnspecified(op->Device());
@@ -618,6 +627,7 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
 
     ctx->AddKernelToCache(cache_key, kernel.get());
   }
+  op->MemoizeKernel(cache_key, cache_generation, kernel.get());
   const DataTypeVector& output_dtypes = kernel->output_dtypes();
   const size_t num_outputs = static_cast<int>(output_dtypes.size());
   if (num_outputs > *num_retvals) {
@@ -0,0 +1,215 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/execute_node.h"
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+// Runs a MatMul node, the BiasAdd node consuming its output and an optional
+// activation node as a single _FusedMatMul kernel, like the Grappler remapper
+// does for graphs.
+class FusedMatMulNode : public EagerNode {
+ public:
+  // `nodes` are the MatMul, BiasAdd and activation nodes, in order.
+  FusedMatMulNode(std::vector<ExecuteNode*> nodes,
+                  std::vector<string> fused_ops)
+      : EagerNode(),
+        nodes_(std::move(nodes)),
+        fused_ops_(std::move(fused_ops)) {}
+
+  Status Run() override {
+    core::RefCountPtr<KernelAndDevice> kernel;
+    Status status = GetKernel(&kernel);
+    if (!status.ok()) {
+      VLOG(1) << "Running " << fused_ops_.size() + 1
+              << " nodes unfused: " << status;
+      return RunUnfused();
+    }
+
+    ExecuteNode* matmul = nodes_.front();
+    ExecuteNode* bias_add = nodes_[1];
+    const gtl::InlinedVector<TensorHandle*, 4> inputs = {
+        matmul->inputs_[0], matmul->inputs_[1], bias_add->inputs_[1]};
+    status = EagerKernelExecute(matmul->ctx_, inputs, kernel,
+                                /*maybe_stats=*/nullptr,
+                                /*maybe_step_stats=*/nullptr,
+                                /*graph_collector=*/nullptr,
+                                matmul->cancellation_manager_,
+                                absl::MakeSpan(nodes_.back()->retvals_));
+    if (!status.ok()) {
+      Abort(status);
+      return status;
+    }
+
+    // The intermediate outputs have no other users, and are left unset.
+    for (ExecuteNode* node : nodes_) {
+      node->Release();
+    }
+    return status;
+  }
+
+  void Abort(Status status) override {
+    for (ExecuteNode* node : nodes_) {
+      node->Abort(status);
+    }
+  }
+
+  // Returns true if `node` runs `op` with float inputs on the same CPU device
+  // as `producer`, without collecting stats or graphs.
+  static bool CanFuse(const ExecuteNode* producer, const ExecuteNode* node,
+                      const string& op) {
+    if (node == nullptr || node->kernel_->kernel() == nullptr ||
+        node->kernel_->kernel()->type_string() != op ||
+        node->kernel_->num_inputs() == 0 ||
+        node->kernel_->input_type(0) != DT_FLOAT ||
+        node->kernel_->device() == nullptr ||
+        node->kernel_->device()->device_type() != DEVICE_CPU ||
+        node->maybe_stats_ != nullptr || node->maybe_step_stats_ != nullptr ||
+        node->graph_collector_ != nullptr) {
+      return false;
+    }
+    return producer == node ||
+           (node->ctx_ == producer->ctx_ &&
+            node->kernel_->device() == producer->kernel_->device() &&
+            node->cancellation_manager_ == producer->cancellation_manager_);
+  }
+
+  // Returns true if the single output of `producer` is the first input of
+  // `consumer`, and has no other users.
+  static bool IsIntermediate(const ExecuteNode* producer,
+                             const ExecuteNode* consumer) {
+    if (producer->retvals_.size() != 1 || consumer->inputs_.empty()) {
+      return false;
+    }
+    TensorHandle* handle = producer->retvals_[0];
+    for (int i = 0; i < consumer->inputs_.size(); ++i) {
+      if ((consumer->inputs_[i] == handle) != (i == 0)) return false;
+    }
+    // The handle is referenced by the producer and by the consumer. The
+    // producer reference keeps it alive while the consumer one is dropped.
+    handle->Unref();
+    const bool no_other_users = handle->RefCountIsOne();
+    handle->Ref();
+    return no_other_users;
+  }
+
+ private:
+  // Returns the _FusedMatMul kernel, from the kernel cache of the context.
+  Status GetKernel(core::RefCountPtr<KernelAndDevice>* kernel) {
+    const ExecuteNode* matmul = nodes_.front();
+    EagerContext* ctx = matmul->ctx_;
+    Device* device = matmul->kernel_->device();
+    const NodeDef& matmul_def = matmul->kernel_->kernel()->def();
+    bool transpose_a = false;
+    bool transpose_b = false;
+    TryGetNodeAttr(matmul_def, "transpose_a", &transpose_a);
+    TryGetNodeAttr(matmul_def, "transpose_b", &transpose_b);
+
+    const Fprint128 cache_key = Fingerprint128(absl::StrCat(
+        "_FusedMatMul:", device->name(), ":", transpose_a, ":", transpose_b,
+        ":", absl::StrJoin(fused_ops_, ",")));
+    *kernel = ctx->GetCachedKernel(cache_key);
+    if (*kernel != nullptr) return Status::OK();
+
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(
+        OpRegistry::Global()->LookUpOpDef("_FusedMatMul", &op_def));
+    NodeDef ndef;
+    ndef.set_name("_FusedMatMul");
+    ndef.set_op("_FusedMatMul");
+    AddNodeAttr("T", DT_FLOAT, &ndef);
+    AddNodeAttr("transpose_a", transpose_a, &ndef);
+    AddNodeAttr("transpose_b", transpose_b, &ndef);
+    AddNodeAttr("num_args", 1, &ndef);
+    AddNodeAttr("fused_ops", fused_ops_, &ndef);
+    AddDefaultsToNodeDef(*op_def, &ndef);
+
+    FunctionLibraryRuntime* flr = ctx->func_lib(device);
+    if (flr == nullptr) {
+      return errors::Unavailable(
+          "Unable to find a FunctionLibraryRuntime corresponding to device ",
+          device->name());
+    }
+    auto runner = flr->runner() != nullptr ? flr->runner() : ctx->runner();
+    kernel->reset(new KernelAndDeviceOp(
+        ctx->GetRendezvous(), ctx->LogMemory(), flr, runner,
+        ctx->GetCollectiveExecutorHandle(), ctx->HostCPU()));
+    TF_RETURN_IF_ERROR((*kernel)->Init(ndef, /*graph_collector=*/nullptr));
+    ctx->AddKernelToCache(cache_key, kernel->get());
+    return Status::OK();
+  }
+
+  // Runs the nodes one after the other.
+  Status RunUnfused() {
+    for (int i = 0; i < nodes_.size(); ++i) {
+      const Status status = nodes_[i]->Run();
+      if (!status.ok()) {
+        for (int j = i + 1; j < nodes_.size(); ++j) {
+          nodes_[j]->Abort(status);
+        }
+        return status;
+      }
+    }
+    return Status::OK();
+  }
+
+  const std::vector<ExecuteNode*> nodes_;
+  const std::vector<string> fused_ops_;
+};
+
+std::unique_ptr<EagerNode> ExecuteNode::Fuse(
+    const std::vector<EagerNode*>& next, int* num_fused) {
+  *num_fused = 0;
+  if (next.empty() || !FusedMatMulNode::CanFuse(this, this, "MatMul")) {
+    return nullptr;
+  }
+  ExecuteNode* bias_add = next[0]->AsExecuteNode();
+  string data_format = "NHWC";
+  if (!FusedMatMulNode::CanFuse(this, bias_add, "BiasAdd") ||
+      (TryGetNodeAttr(bias_add->kernel_->kernel()->def(), "data_format",
+                      &data_format) &&
+       data_format != "NHWC") ||
+      !FusedMatMulNode::IsIntermediate(this, bias_add)) {
+    return nullptr;
+  }
+  std::vector<ExecuteNode*> nodes = {this, bias_add};
+  std::vector<string> fused_ops = {"BiasAdd"};
+  if (next.size() > 1) {
+    ExecuteNode* activation = next[1]->AsExecuteNode();
+    for (const char* op : {"Relu", "Relu6", "Elu"}) {
+      if (FusedMatMulNode::CanFuse(this, activation, op) &&
+          FusedMatMulNode::IsIntermediate(bias_add, activation)) {
+        nodes.push_back(activation);
+        fused_ops.push_back(op);
+        break;
+      }
+    }
+  }
+  *num_fused = nodes.size() - 1;
+  return absl::make_unique<FusedMatMulNode>(std::move(nodes),
+                                            std::move(fused_ops));
+}
+
+}  // namespace tensorflow
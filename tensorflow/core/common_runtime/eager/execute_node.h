@@ -73,21 +73,34 @@ class ExecuteNode : public EagerNode {
 
     // If status is ok, EagerKernelExecute would have called SetTensor on
     // all the output handles.
+    Release();
+    return status;
+  }
 
+  void Abort(Status status) override {
     for (auto handle : retvals_) {
+      handle->Poison(status);
       handle->Unref();
     }
 
     for (auto handle : inputs_) {
       handle->Unref();
     }
-
-    return status;
   }
 
-  void Abort(Status status) override {
+  ExecuteNode* AsExecuteNode() override { return this; }
+
+  // Fuses a CPU MatMul with the BiasAdd, and the optional Relu, Relu6 or Elu,
+  // consuming its output, when the intermediate outputs have no other users.
+  std::unique_ptr<EagerNode> Fuse(const std::vector<EagerNode*>& next,
+                                  int* num_fused) override;
+
+ private:
+  friend class FusedMatMulNode;
+
+  // Releases the handles once the output handles are set.
+  void Release() {
     for (auto handle : retvals_) {
-      handle->Poison(status);
       handle->Unref();
     }
 
@@ -96,7 +109,6 @@ class ExecuteNode : public EagerNode {
     }
   }
 
- private:
   EagerContext* ctx_;
   gtl::InlinedVector<TensorHandle*, 4> inputs_;
   core::RefCountPtr<KernelAndDevice> kernel_;
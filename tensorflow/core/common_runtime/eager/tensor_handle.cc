@@ -123,8 +123,6 @@ TensorHandle::TensorHandle(std::unique_ptr<LocalTensorHandleData> t,
       is_remote_(false),
       tensor_handle_data_(std::move(t)) {
   VLOG(3) << "Creating Local TensorHandle: " << this << " device: " << device_;
-  // Notify immediately since this handle is already ready.
-  is_ready_notification_.Notify();
 }
 
 TensorHandle::TensorHandle(std::unique_ptr<LocalTensorHandleData> t,
@@ -143,8 +141,6 @@ TensorHandle::TensorHandle(std::unique_ptr<LocalTensorHandleData> t,
       handle_dtypes_and_shapes_(resource_handle.dtypes_and_shapes()),
       tensor_handle_data_(std::move(t)) {
   VLOG(3) << "Creating Local TensorHandle: " << this << " device: " << device_;
-  // Notify immediately since this handle is already ready.
-  is_ready_notification_.Notify();
 }
 
 Status TensorHandle::CreateAsyncLocalHandle(Device* d, Device* op_device,
@@ -170,6 +166,7 @@ TensorHandle::TensorHandle(std::unique_ptr<AsyncLocalTensorHandleData> t,
       remote_output_num_(kInvalidOutputNum),
 #endif
       ctx_(ctx),
+      is_ready_notification_(new Notification),
       is_remote_(false),
       tensor_handle_data_(std::move(t)) {
   VLOG(3) << "Creating Async Local TensorHandle: " << this
@@ -211,8 +208,6 @@ TensorHandle::TensorHandle(std::unique_ptr<RemoteTensorHandleData> t,
       is_remote_(true),
       tensor_handle_data_(std::move(t)) {
   VLOG(3) << "Creating Remote TensorHandle: " << this << " device: " << device_;
-  // Notify immediately since this handle is already ready.
-  is_ready_notification_.Notify();
 }
 
 Status TensorHandle::CreateUnshapedRemoteHandle(
@@ -244,6 +239,7 @@ TensorHandle::TensorHandle(std::unique_ptr<UnshapedRemoteTensorHandleData> t,
       remote_eager_client_(t->eager_client()),
       remote_context_id_(t->context_id()),
       ctx_(ctx),
+      is_ready_notification_(new Notification),
       is_remote_(true),
       tensor_handle_data_(std::move(t)) {
   VLOG(3) << "Creating Unshaped Remote TensorHandle: " << this
@@ -264,15 +260,22 @@ TensorHandle::TensorHandle(OutputGraphNode symbolic_tensor, DataType dtype)
       is_remote_(false),
       symbolic_tensor_(new OutputGraphNode(symbolic_tensor)) {
   VLOG(3) << "Creating Symbolic TensorHandle: " << this;
-  // Notify immediately since this handle is already ready.
-  is_ready_notification_.Notify();
 }
 
 Status TensorHandle::WaitReady() {
-  is_ready_notification_.WaitForNotification();
+  if (is_ready_notification_ != nullptr) {
+    is_ready_notification_->WaitForNotification();
+  }
   return is_poisoned_;
 }
 
+void TensorHandle::NotifyReady() {
+  DCHECK(is_ready_notification_ != nullptr &&
+         !is_ready_notification_->HasBeenNotified())
+      << "Only non-ready handles can be made ready.";
+  if (is_ready_notification_ != nullptr) is_ready_notification_->Notify();
+}
+
 Status TensorHandle::Tensor(const tensorflow::Tensor** t) {
   TF_RETURN_IF_ERROR(WaitReady());
   return tensor_handle_data_->Tensor(t);
@@ -421,8 +424,6 @@ Status TensorHandle::SetRemoteShape(const TensorShape& shape,
   }
 
   DCHECK(is_remote_) << "SeRemoteShape is only called on remote handles.";
-  DCHECK(!is_ready_notification_.HasBeenNotified())
-      << "SetRemoteShape is only called on non-ready handles.";
 
   UnshapedRemoteTensorHandleData* p =
       reinterpret_cast<UnshapedRemoteTensorHandleData*>(
@@ -432,7 +433,7 @@ Status TensorHandle::SetRemoteShape(const TensorShape& shape,
       remote_op_id_, remote_output_num_, shape, remote_eager_client_,
       remote_context_id_, ctx_);
   is_poisoned_ = Status::OK();
-  is_ready_notification_.Notify();
+  NotifyReady();
 
   return Status::OK();
 }
@@ -440,8 +441,6 @@ Status TensorHandle::SetRemoteShape(const TensorShape& shape,
 
 Status TensorHandle::SetTensor(const tensorflow::Tensor& tensor) {
   DCHECK(!is_remote_) << "SetTensor is not called on remote handles.";
-  DCHECK(!is_ready_notification_.HasBeenNotified())
-      << "SetTensor is only called on non-ready handles.";
 
   VLOG(3) << "SetTensor on TensorHandle: " << this;
 
@@ -451,15 +450,13 @@ Status TensorHandle::SetTensor(const tensorflow::Tensor& tensor) {
   }
   tensor_handle_data_ = absl::make_unique<LocalTensorHandleData>(tensor);
   is_poisoned_ = Status::OK();
-  is_ready_notification_.Notify();
+  NotifyReady();
   return Status::OK();
 }
 
 void TensorHandle::Poison(Status status) {
-  DCHECK(!is_ready_notification_.HasBeenNotified())
-      << "Poison(status) can only be called on non-ready handles.";
   is_poisoned_ = status;
-  is_ready_notification_.Notify();
+  NotifyReady();
 }
 
 Status TensorHandle::CopyToDevice(EagerContext* ctx, tensorflow::Device* dstd,
@@ -209,6 +209,9 @@ class TensorHandle : public core::RefCounted {
   // done and the handle is "ready".
   Status WaitReady();
 
+  // Makes this non-ready handle ready.
+  void NotifyReady();
+
   // TODO(b/136608821): device_ == nullptr iff Host CPU:0
   // This was expedient, but perhaps worth revisiting ('device_' should always
   // be a valid pointer?)
@@ -254,10 +257,13 @@ class TensorHandle : public core::RefCounted {
   // `ctx` object is not owned and should outlive this handle.
   EagerContext* const ctx_;
 
+  // Notified when a non-ready handle becomes ready. Handles created ready,
+  // like the outputs of ops executed synchronously, don't have any.
   // Explanation for NOLINT below: absl has clang-tidy macro to rename
   // 'tensorflow::Notification' to 'absl::Notification'. TF does not use
   // absl::Notification in open source now, so we can't follow clang-tidy
-  tensorflow::Notification is_ready_notification_;  // NOLINT
+  const std::unique_ptr<tensorflow::Notification>  // NOLINT
+      is_ready_notification_;
   // Does not need synchronization because it can be accessed only after
   // WaitReady() has returned. At that point, is_poisoned_ is immutable.
   Status is_poisoned_;
@@ -0,0 +1,83 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+
+#include <memory>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(TensorHandleTest, LocalHandleIsReady) {
+  // A handle created from a tensor has no notification to wait for.
+  TensorHandle* h;
+  TF_ASSERT_OK(TensorHandle::CreateLocalHandle(
+      test::AsTensor<float>({1, 2, 3}), &h));
+  core::ScopedUnref unref(h);
+
+  const Tensor* t;
+  TF_ASSERT_OK(h->Tensor(&t));
+  test::ExpectTensorEqual<float>(*t, test::AsTensor<float>({1, 2, 3}));
+  int64 num_elements;
+  TF_ASSERT_OK(h->NumElements(&num_elements));
+  EXPECT_EQ(num_elements, 3);
+}
+
+TEST(TensorHandleTest, AsyncHandleWaitsForTensor) {
+  TensorHandle* h;
+  TF_ASSERT_OK(TensorHandle::CreateAsyncLocalHandle(
+      /*d=*/nullptr, /*op_device=*/nullptr, /*resource_device=*/nullptr,
+      DT_FLOAT, /*ctx=*/nullptr, &h));
+  core::ScopedUnref unref(h);
+
+  Notification read;
+  const Tensor* t = nullptr;
+  Status status;
+  std::unique_ptr<Thread> reader(Env::Default()->StartThread(
+      ThreadOptions(), "reader", [h, &t, &status, &read]() {
+        status = h->Tensor(&t);
+        read.Notify();
+      }));
+  // The reader blocks until the handle is ready.
+  EXPECT_FALSE(WaitForNotificationWithTimeout(&read, 10 * 1000));
+  TF_ASSERT_OK(h->SetTensor(test::AsTensor<float>({4, 5})));
+  read.WaitForNotification();
+  TF_ASSERT_OK(status);
+  test::ExpectTensorEqual<float>(*t, test::AsTensor<float>({4, 5}));
+}
+
+TEST(TensorHandleTest, PoisonedAsyncHandle) {
+  TensorHandle* h;
+  TF_ASSERT_OK(TensorHandle::CreateAsyncLocalHandle(
+      /*d=*/nullptr, /*op_device=*/nullptr, /*resource_device=*/nullptr,
+      DT_FLOAT, /*ctx=*/nullptr, &h));
+  core::ScopedUnref unref(h);
+
+  h->Poison(errors::Internal("poisoned"));
+  const Tensor* t;
+  Status status = h->Tensor(&t);
+  EXPECT_TRUE(errors::IsInternal(status)) << status;
+  EXPECT_EQ(status.error_message(), "poisoned");
+}
+
+}  // namespace
+}  // namespace tensorflow
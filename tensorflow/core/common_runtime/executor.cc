@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -27,10 +29,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/memory_plan.h"
 #include "tensorflow/core/common_runtime/node_shape_info.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -63,6 +67,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -73,14 +78,39 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/internal/traceme_recorder.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
 namespace tensorflow {
 namespace {
 
+// Node attribute set by grappler's CriticalPathPriority optimizer.
+constexpr char kCriticalPathPriorityAttr[] = "_critical_path_priority";
+
 // 1-D, 0 element tensor.
 static const Tensor* const kEmptyTensor = new Tensor;
 
+// When enabled, the kernels of graphs with at least this many nodes are created
+// in parallel.
+constexpr int kMinNodesForParallelKernelCreation = 256;
+// Rough cost of creating a kernel in cycles, used to shard the nodes.
+constexpr int64 kKernelCreationCost = 100000;
+
+// Returns the thread pool creating kernels in parallel, or nullptr unless
+// TF_EXECUTOR_PARALLEL_KERNEL_CREATION is true. Parallel creation is opt-in,
+// since it requires every kernel constructor to be thread-safe.
+thread::ThreadPool* KernelCreationThreadPool() {
+  bool parallel_kernel_creation;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_EXECUTOR_PARALLEL_KERNEL_CREATION",
+                                 false, &parallel_kernel_creation));
+  if (!parallel_kernel_creation || port::MaxParallelism() < 2) {
+    return nullptr;
+  }
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "kernel_creation", port::MaxParallelism());
+  return pool;
+}
+
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
@@ -94,6 +124,11 @@ void SetScheduled(NodeExecStatsInterface* stats, int64 micros) {
   stats->SetScheduled(micros * EnvTime::kMicrosToNanos);
 }
 
+void SetRanInline(NodeExecStatsInterface* stats, bool ran_inline) {
+  if (!stats) return;
+  stats->SetRanInline(ran_inline);
+}
+
 void SetAllStart(NodeExecStatsInterface* stats) {
   if (!stats) return;
   stats->RecordExecutorStarted();
@@ -135,6 +170,19 @@ void SetReferencedTensors(NodeExecStatsInterface* stats,
 class ExecutorImpl;
 class GraphView;
 
+// Maximum number of ready nodes held by each work-stealing queue. Nodes that
+// do not fit are handed to the runner directly.
+constexpr size_t kReadyQueueCapacity = 1024;
+
+// Identifies the work-stealing queue owned by the current thread, if it is
+// running ExecutorState::WorkStealingLoop. `owner` is the ExecutorState the
+// queue belongs to, since one thread may serve several concurrent steps.
+struct CurrentReadyWorker {
+  const void* owner = nullptr;
+  int queue = -1;
+};
+thread_local CurrentReadyWorker current_ready_worker;
+
 struct EdgeInfo {
   int dst_id;
   int output_slot : 31;
@@ -153,6 +201,53 @@ struct KernelTimer {
   }
 };
 
+// Online estimate of the run time (in CPU cycles) of every synchronous
+// kernel in a graph, shared by all steps of an executor. Used to decide
+// whether a ready node is run inline on the thread that activated it or
+// dispatched to another thread.
+//
+// Unlike OpKernel::IsExpensive(), which only keeps timing kernels while they
+// are expensive, every execution is measured, so the estimate follows the
+// kernel in both directions. The kernel's own flag is only used until the
+// first measurement is available.
+class KernelCostEstimator {
+ public:
+  void Initialize(int num_nodes) {
+    estimates_.reset(new std::atomic<uint64>[num_nodes]);
+    for (int i = 0; i < num_nodes; ++i) {
+      estimates_[i].store(kUnmeasured, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns true iff the node with the given id and kernel should be
+  // dispatched rather than run inline.
+  bool IsExpensive(int id, OpKernel* kernel) const {
+    const uint64 estimate = estimates_[id].load(std::memory_order_relaxed);
+    if (estimate == kUnmeasured) return kernel->IsExpensive();
+    return estimate > OpKernel::kOpIsExpensiveThresholdCycles;
+  }
+
+  // Folds the latest run time of the node with the given id into its
+  // estimate, as a weighted average with the previous estimate.
+  void Update(int id, uint64 elapsed_cycles) {
+    // As in OpKernel::UpdateCostEstimate, concurrent updates may be lost,
+    // which only slows down the adaptation.
+    const uint64 estimate = estimates_[id].load(std::memory_order_relaxed);
+    const uint64 kCostDecay = OpKernel::kCostDecay;
+    estimates_[id].store(
+        estimate == kUnmeasured
+            ? std::min(elapsed_cycles, kUnmeasured - 1)
+            : (kCostDecay - 1) * (estimate / kCostDecay) +
+                  elapsed_cycles / kCostDecay,
+        std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr uint64 kUnmeasured = std::numeric_limits<uint64>::max();
+
+  std::unique_ptr<std::atomic<uint64>[]> estimates_;
+};
+
 struct NodeItem {
   NodeItem() {}
 
@@ -172,6 +267,8 @@ struct NodeItem {
   bool is_sink : 1;             // True iff IsSink(node)
   // True iff IsEnter(node) || IsExit(node) || IsNextIteration(node)
   bool is_enter_exit_or_next_iter : 1;
+  // True iff IsMerge(dst) for any out edge of node.
+  bool is_any_consumer_merge : 1;
 
   // Cached values of node->num_inputs() and node->num_outputs(), to
   // avoid levels of indirection.
@@ -187,6 +284,10 @@ struct NodeItem {
 
   PendingCounts::Handle pending_id;
 
+  // Critical-path priority of the node: among the nodes that become ready
+  // together, the ones with the highest priority are scheduled first.
+  int64 priority = 0;
+
   const EdgeInfo* output_edge_list() const { return output_edge_base(); }
 
   // ith output edge.
@@ -296,8 +397,12 @@ class GraphView {
 
 class ExecutorImpl : public Executor {
  public:
-  ExecutorImpl(const LocalExecutorParams& p, std::unique_ptr<const Graph> g)
-      : params_(p), graph_(std::move(g)), gview_() {
+  ExecutorImpl(const LocalExecutorParams& p, std::unique_ptr<const Graph> g,
+               bool work_stealing = false)
+      : params_(p),
+        graph_(std::move(g)),
+        gview_(),
+        work_stealing_(work_stealing) {
     CHECK(p.create_kernel != nullptr);
     CHECK(p.delete_kernel != nullptr);
   }
@@ -316,6 +421,11 @@ class ExecutorImpl : public Executor {
 
   Status Initialize();
 
+  // Creates the kernels of all the nodes, in parallel for large graphs if
+  // TF_EXECUTOR_PARALLEL_KERNEL_CREATION is true. If several fail, returns the
+  // error of the first node, like a serial creation would.
+  Status CreateKernels();
+
   // Process all Nodes in the current graph, attempting to infer the
   // memory allocation attributes to be used wherever they may allocate
   // a tensor buffer.
@@ -378,9 +488,21 @@ class ExecutorImpl : public Executor {
   std::unique_ptr<const Graph> graph_;
   GraphView gview_;
 
+  // If true, each ExecutorState dispatches expensive ready nodes through
+  // per-worker work-stealing queues instead of handing every node to the
+  // runner. Set for executors created with the "WORK_STEALING" type.
+  const bool work_stealing_;
+
   // A cached value of params_
   bool device_record_tensor_accesses_ = false;
 
+  // True if any node has a critical-path priority.
+  bool has_priorities_ = false;
+
+  // Learned run times of the kernels, indexed by node id. Updated by the
+  // steps, which only hold a const pointer to the executor.
+  mutable KernelCostEstimator cost_estimator_;
+
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const Node*> root_nodes_;
 
@@ -604,8 +726,51 @@ void GetMaxPendingCounts(const Node* n, size_t* max_pending,
   *max_dead_count = num_in_edges;
 }
 
+Status ExecutorImpl::CreateKernels() {
+  const std::vector<const Node*> nodes(graph_->nodes().begin(),
+                                       graph_->nodes().end());
+  std::vector<Status> statuses(nodes.size());
+  auto create_kernels = [this, &nodes, &statuses](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      NodeItem* item = gview_.node(nodes[i]->id());
+      statuses[i] = params_.create_kernel(nodes[i]->def(), &item->kernel);
+      if (!statuses[i].ok()) {
+        params_.delete_kernel(item->kernel);
+        item->kernel = nullptr;
+      }
+    }
+  };
+  thread::ThreadPool* pool = nullptr;
+  if (nodes.size() >= kMinNodesForParallelKernelCreation) {
+    pool = KernelCreationThreadPool();
+  }
+  if (pool != nullptr) {
+    pool->ParallelFor(nodes.size(), kKernelCreationCost, create_kernels);
+  } else {
+    // Like before parallel creation, no kernel is created after a failure.
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      create_kernels(i, i + 1);
+      if (!statuses[i].ok()) break;
+    }
+  }
+
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (!statuses[i].ok()) {
+      const Status s = AttachDef(statuses[i], *nodes[i]);
+      LOG(ERROR) << "Executor failed to create kernel. " << s;
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
 Status ExecutorImpl::Initialize() {
   gview_.Initialize(graph_.get());
+  cost_estimator_.Initialize(graph_->num_node_ids());
+
+  // The kernels are only owned by the node items, which release them in
+  // ~ExecutorImpl() even if the initialization fails.
+  TF_RETURN_IF_ERROR(CreateKernels());
 
   // Build the information about frames in this subgraph.
   ControlFlowInfo cf_info;
@@ -620,8 +785,7 @@ Status ExecutorImpl::Initialize() {
     EnsureFrameInfo(it)->nodes = new std::vector<const Node*>;
   }
 
-  // Preprocess every node in the graph to create an instance of op
-  // kernel for each node.
+  // Preprocess every node in the graph.
   for (const Node* n : graph_->nodes()) {
     const int id = n->id();
     const string& frame_name = cf_info.frame_names[id];
@@ -638,14 +802,6 @@ Status ExecutorImpl::Initialize() {
     item->input_start = frame_info->total_inputs;
     frame_info->total_inputs += n->num_inputs();
 
-    Status s = params_.create_kernel(n->def(), &item->kernel);
-    if (!s.ok()) {
-      params_.delete_kernel(item->kernel);
-      item->kernel = nullptr;
-      s = AttachDef(s, *n);
-      LOG(ERROR) << "Executor failed to create kernel. " << s;
-      return s;
-    }
     CHECK(item->kernel);
     item->kernel_is_async = (item->kernel->AsAsync() != nullptr);
     item->is_merge = IsMerge(n);
@@ -663,6 +819,17 @@ Status ExecutorImpl::Initialize() {
     item->is_sink = IsSink(n);
     item->is_enter_exit_or_next_iter =
         (IsEnter(n) || IsExit(n) || IsNextIteration(n));
+    item->is_any_consumer_merge = false;
+    for (const Edge* e : n->out_edges()) {
+      if (IsMerge(e->dst())) {
+        item->is_any_consumer_merge = true;
+        break;
+      }
+    }
+    if (TryGetNodeAttr(n->attrs(), kCriticalPathPriorityAttr,
+                       &item->priority)) {
+      has_priorities_ = true;
+    }
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -682,6 +849,22 @@ Status ExecutorImpl::Initialize() {
     }
   }
 
+  // The sends added by graph partitioning run with the priority of the node
+  // whose output they send.
+  if (has_priorities_) {
+    for (const Node* n : graph_->nodes()) {
+      if (!IsSend(n) || HasNodeAttr(n->def(), kCriticalPathPriorityAttr)) {
+        continue;
+      }
+      NodeItem* item = gview_.node(n->id());
+      for (const Edge* e : n->in_edges()) {
+        if (e->IsControlEdge()) continue;
+        item->priority =
+            std::max(item->priority, gview_.node(e->src()->id())->priority);
+      }
+    }
+  }
+
   // Initialize PendingCounts only after item->pending_id is initialized for
   // all nodes.
   InitializePending(graph_.get(), cf_info);
@@ -975,7 +1158,11 @@ class ExecutorState {
     Entry* input_tensors;
 
     // The number of outstanding ops for each iteration.
-    size_t outstanding_ops;
+    //
+    // Updated with atomic operations while holding the frame's mu in shared
+    // mode, but only ever brought down to zero while holding it exclusively,
+    // so that iteration and frame cleanup stay serialized.
+    std::atomic<size_t> outstanding_ops;
 
     // The number of outstanding frames for each iteration.
     int outstanding_frame_count;
@@ -1003,6 +1190,12 @@ class ExecutorState {
       counts_.adjust_for_activation(h, increment_dead, pending_result,
                                     dead_result);
     }
+    void adjust_for_activation_atomic(PendingCounts::Handle h,
+                                      bool increment_dead, int* pending_result,
+                                      int* dead_result) {
+      counts_.adjust_for_activation_atomic(h, increment_dead, pending_result,
+                                           dead_result);
+    }
 
     ~IterationState() { delete[] input_tensors; }
 
@@ -1103,6 +1296,10 @@ class ExecutorState {
 
     // Lock ordering: ExecutorState.mu_ < mu;
     // during structured traversal: parent_frame->mu < mu.
+    //
+    // Nodes whose outputs need no control-flow handling are propagated while
+    // holding mu in shared mode (see ActivateNodesAndAdjustOutstanding);
+    // everything else takes it exclusively.
     mutex mu;
 
     void InitializeFrameInfo(const string& enter_name) {
@@ -1115,8 +1312,7 @@ class ExecutorState {
       nodes = finfo->nodes;
     }
 
-    inline IterationState* GetIteration(int64 iter)
-        EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    inline IterationState* GetIteration(int64 iter) SHARED_LOCKS_REQUIRED(mu) {
       size_t index = iter % iterations.size();
       return iterations[index];
     }
@@ -1150,6 +1346,19 @@ class ExecutorState {
       }
     }
 
+    // Activates the successors of "item", which must be neither an Enter, Exit
+    // nor NextIteration node, in iteration "iter" and accounts for its
+    // completion. Return true iff the execution of the frame is done.
+    //
+    // Unless a successor is a Merge node, this only takes mu in shared mode
+    // and updates the pending and outstanding op counts atomically, so that
+    // many threads can propagate outputs in the same frame concurrently.
+    bool ActivateNodesAndAdjustOutstanding(const NodeItem* item,
+                                           const bool is_dead, int64 iter,
+                                           EntryVector* outputs,
+                                           TaggedNodeSeq* ready)
+        LOCKS_EXCLUDED(mu);
+
     // Returns true if the computation in the frame is completed.
     inline bool IsFrameDone() EXCLUSIVE_LOCKS_REQUIRED(mu) {
       return (num_pending_inputs == 0 && num_outstanding_iterations == 0);
@@ -1181,6 +1390,13 @@ class ExecutorState {
                        EntryVector* outputs, TaggedNodeSeq* ready)
         EXCLUSIVE_LOCKS_REQUIRED(mu);
 
+    // As ActivateNodes, for a node without Merge successors, but only
+    // requires mu in shared mode. Does not update the outstanding op count of
+    // the iteration; returns the number of nodes added to *ready instead.
+    int ActivateNodesFastPath(const NodeItem* item, const bool is_dead,
+                              int64 iter, EntryVector* outputs,
+                              TaggedNodeSeq* ready) SHARED_LOCKS_REQUIRED(mu);
+
     // Cleanup iterations of this frame starting from iteration iter.
     bool CleanupIterations(const GraphView* gview, int64 iter,
                            TaggedNodeSeq* ready) EXCLUSIVE_LOCKS_REQUIRED(mu);
@@ -1200,6 +1416,7 @@ class ExecutorState {
     int64 input_iter = -1;
     bool is_dead = false;
 
+    TaggedNode() {}
     TaggedNode(const Node* t_node, FrameState* in_frame, int64 in_iter,
                bool dead) {
       node = t_node;
@@ -1244,6 +1461,14 @@ class ExecutorState {
     int front_index_;
   };
 
+  // A ready node waiting in one of the work-stealing queues, together with
+  // the time it became ready (for step stats).
+  struct QueuedNode {
+    TaggedNode tagged_node;
+    int64 scheduled_nsec = 0;
+  };
+  typedef WorkStealingQueue<QueuedNode> ReadyQueue;
+
   struct AsyncState;
 
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
@@ -1262,6 +1487,12 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  // Memory for the planned outputs of this step, if the executor has a
+  // memory plan.
+  MemoryPlanArena* memory_plan_arena_ = nullptr;
+  // Caller-owned buffers for node outputs (see Executor::Args), indexed by
+  // node id and then by output.
+  gtl::FlatMap<int, std::vector<const Tensor*>> output_buffers_;
   StepStatsCollectorInterface* const stats_collector_;
   const tracing::EventCollector* const event_collector_;
   Context context_;
@@ -1291,6 +1522,15 @@ class ExecutorState {
 
   std::atomic_int_fast32_t num_outstanding_ops_;
 
+  // Only used when impl_->work_stealing_ is true. ready_queues_[i] is owned
+  // by the worker running WorkStealingLoop(i), which is running iff
+  // worker_active_[i] is true. Every running worker holds a reference on
+  // num_outstanding_ops_, so this state outlives all of its workers.
+  std::vector<std::unique_ptr<ReadyQueue>> ready_queues_;
+  std::unique_ptr<std::atomic<bool>[]> worker_active_;
+  std::atomic<int> num_active_workers_{0};
+  std::atomic<uint32> next_ready_queue_{0};
+
   // Available via OpKernelContext to every OpKernel invocation.
   mutex num_deferred_ops_mu_;
   int64 num_deferred_ops_ GUARDED_BY(num_deferred_ops_mu_) = 0;
@@ -1356,6 +1596,25 @@ class ExecutorState {
   void ScheduleReady(const TaggedNodeSeq& ready,
                      TaggedNodeReadyQueue* inline_ready);
 
+  // Runs 'tagged_node' on another thread. In work-stealing mode the node is
+  // pushed onto the calling worker's queue (or, from a non-worker thread,
+  // onto a queue picked round-robin); otherwise it is passed to runner_.
+  void ScheduleNode(const TaggedNode& tagged_node, int64 scheduled_nsec);
+
+  // Starts the worker for ready_queues_[queue] if it is not already running.
+  void MaybeStartWorker(int queue);
+
+  // Starts a worker for some idle queue, so that it can steal from the
+  // queues of busy workers. No-op if all workers are running.
+  void MaybeStartIdleWorker(int queue_hint);
+
+  // Drains ready_queues_[queue], stealing from the other queues when it is
+  // empty, until there is no work left.
+  void WorkStealingLoop(int queue);
+
+  // Removes the oldest node from any queue other than 'queue'.
+  bool StealReady(int queue, QueuedNode* node);
+
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter, int64 id);
 
@@ -1415,6 +1674,41 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
 
+  if (impl_->work_stealing_) {
+    const int num_queues = std::max(port::MaxParallelism(), 1);
+    ready_queues_.reserve(num_queues);
+    for (int i = 0; i < num_queues; ++i) {
+      ready_queues_.emplace_back(new ReadyQueue(kReadyQueueCapacity));
+    }
+    worker_active_.reset(new std::atomic<bool>[num_queues]);
+    for (int i = 0; i < num_queues; ++i) {
+      worker_active_[i].store(false, std::memory_order_relaxed);
+    }
+  }
+
+  if (impl_->params_.memory_plan != nullptr &&
+      impl_->params_.memory_plan->total_bytes > 0) {
+    memory_plan_arena_ = new MemoryPlanArena(
+        impl_->params_.memory_plan,
+        impl_->params_.device->GetAllocator(AllocatorAttributes()));
+  }
+
+  if (args.output_buffers != nullptr) {
+    for (const Executor::Args::OutputBuffer& b : *args.output_buffers) {
+      if (b.node_id < 0 || b.node_id >= impl_->graph_->num_node_ids()) {
+        continue;
+      }
+      const NodeItem* item = impl_->gview_.node(b.node_id);
+      if (item == nullptr || b.output < 0 || b.output >= item->num_outputs ||
+          !b.buffer.IsInitialized()) {
+        continue;
+      }
+      std::vector<const Tensor*>& buffers = output_buffers_[b.node_id];
+      buffers.resize(item->num_outputs, nullptr);
+      if (buffers[b.output] == nullptr) buffers[b.output] = &b.buffer;
+    }
+  }
+
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
   // We assume root_frame_->frame_name.empty().
@@ -1438,6 +1732,7 @@ ExecutorState::~ExecutorState() {
     it->Unref();
   }
   delete slice_reader_cache_;
+  if (memory_plan_arena_ != nullptr) memory_plan_arena_->Release();
 }
 
 Status ExecutorImpl::BuildControlFlowInfo(const Graph* g,
@@ -1658,6 +1953,8 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
   params.function_library = impl_->params_.function_library;
   params.resource_manager = device->resource_manager();
   params.step_container = step_container_;
+  params.step_arena =
+      step_container_ != nullptr ? step_container_->step_arena() : nullptr;
   params.slice_reader_cache = slice_reader_cache_;
   params.inputs = &inputs;
   params.input_device_contexts = &input_device_contexts;
@@ -1688,6 +1985,9 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
 
   EntryVector outputs;
   bool completed = false;
+  // Only the first node was dispatched to this thread; the others are run
+  // inline after the node that activated them.
+  bool ran_inline = false;
   inline_ready.push_back(tagged_node);
   while (!inline_ready.empty()) {
     tagged_node = inline_ready.front();
@@ -1718,8 +2018,10 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
       // `stats` object is expecting allocations to be tracked.
       params.track_allocations = stats ? stats->TrackAllocations() : false;
       nodestats::SetScheduled(stats, scheduled_nsec);
+      nodestats::SetRanInline(stats, ran_inline);
       nodestats::SetAllStart(stats);
     }
+    ran_inline = true;
 
     if (vlog_) {
       VLOG(1) << "Process node: " << id << " step " << params.step_id << " "
@@ -1772,6 +2074,17 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
       params.forward_from_array = item.forward_from();
+      params.planned_output_allocators =
+          memory_plan_arena_ != nullptr
+              ? memory_plan_arena_->OutputAllocators(id)
+              : nullptr;
+      params.output_buffers = nullptr;
+      if (!output_buffers_.empty() && input_frame == root_frame_) {
+        auto it = output_buffers_.find(id);
+        if (it != output_buffers_.end()) {
+          params.output_buffers = it->second.data();
+        }
+      }
 
       if (item.kernel_is_async) {
         // Asynchronous computes.
@@ -1860,13 +2173,12 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
           device->Compute(op_kernel, &ctx);
         } else {
           // In the common case, avoid creating any tracing objects.
-          if (op_kernel->IsExpensive()) {
-            KernelTimer timer;
-            device->Compute(op_kernel, &ctx);
-            op_kernel->UpdateCostEstimate(timer.ElapsedCycles());
-          } else {
-            device->Compute(op_kernel, &ctx);
-          }
+          const bool was_expensive = op_kernel->IsExpensive();
+          KernelTimer timer;
+          device->Compute(op_kernel, &ctx);
+          const uint64 elapsed_cycles = timer.ElapsedCycles();
+          impl_->cost_estimator_.Update(id, elapsed_cycles);
+          if (was_expensive) op_kernel->UpdateCostEstimate(elapsed_cycles);
         }
 
         nodestats::SetOpEnd(stats);
@@ -2170,10 +2482,8 @@ void ExecutorState::PropagateOutputs(const TaggedNode& tagged_node,
     // Fast path for nodes types that don't need special handling
     DCHECK_EQ(input_frame, output_frame);
     // Normal path for most nodes
-    mutex_lock l(input_frame->mu);
-    output_frame->ActivateNodes(item, is_dead, output_iter, outputs, ready);
-    is_frame_done = input_frame->DecrementOutstandingOpsLocked(
-        &impl_->gview_, input_iter, ready);
+    is_frame_done = input_frame->ActivateNodesAndAdjustOutstanding(
+        item, is_dead, output_iter, outputs, ready);
   } else if (item->is_enter) {
     FindOrCreateChildFrame(input_frame, input_iter, node, &output_frame);
     output_iter = 0;
@@ -2329,27 +2639,41 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     scheduled_nsec = nodestats::NowInNsec();
   }
 
+  const GraphView& gview = impl_->gview_;
+  const TaggedNodeSeq* ordered_ready = &ready;
+  TaggedNodeSeq prioritized_ready;
+  if (impl_->has_priorities_ && ready.size() > 1) {
+    // Dispatch the expensive nodes, and queue the inexpensive ones, from the
+    // highest to the lowest priority.
+    prioritized_ready = ready;
+    std::stable_sort(prioritized_ready.begin(), prioritized_ready.end(),
+                     [&gview](const TaggedNode& a, const TaggedNode& b) {
+                       return gview.node(a.node->id())->priority >
+                              gview.node(b.node->id())->priority;
+                     });
+    ordered_ready = &prioritized_ready;
+  }
+
   if (inline_ready == nullptr) {
     // Schedule to run all the ready ops in thread pool.
-    for (auto& tagged_node : ready) {
-      runner_([=]() { Process(tagged_node, scheduled_nsec); });
+    for (auto& tagged_node : *ordered_ready) {
+      ScheduleNode(tagged_node, scheduled_nsec);
     }
     return;
   }
 
-  const GraphView& gview = impl_->gview_;
   const TaggedNode* curr_expensive_node = nullptr;
-  for (auto& tagged_node : ready) {
+  for (auto& tagged_node : *ordered_ready) {
     const NodeItem& item = *gview.node(tagged_node.node->id());
-    if (tagged_node.is_dead || !item.kernel->IsExpensive()) {
+    if (tagged_node.is_dead ||
+        !impl_->cost_estimator_.IsExpensive(item.node->id(), item.kernel)) {
       // Inline this inexpensive node.
       inline_ready->push_back(tagged_node);
     } else {
       if (curr_expensive_node) {
         // Dispatch to another thread since there is plenty of work to
         // do for this thread.
-        runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_nsec));
+        ScheduleNode(*curr_expensive_node, scheduled_nsec);
       }
       curr_expensive_node = &tagged_node;
     }
@@ -2361,12 +2685,91 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     } else {
       // There are inline nodes to run already. We dispatch this expensive
       // node to other thread.
-      runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                        scheduled_nsec));
+      ScheduleNode(*curr_expensive_node, scheduled_nsec);
+    }
+  }
+}
+
+void ExecutorState::ScheduleNode(const TaggedNode& tagged_node,
+                                 int64 scheduled_nsec) {
+  if (!ready_queues_.empty()) {
+    const bool on_worker = current_ready_worker.owner == this;
+    const int queue = on_worker ? current_ready_worker.queue
+                                : next_ready_queue_.fetch_add(
+                                      1, std::memory_order_relaxed) %
+                                      ready_queues_.size();
+    if (ready_queues_[queue]->PushBack({tagged_node, scheduled_nsec})) {
+      if (on_worker) {
+        // The calling worker is busy with the node that produced this one;
+        // make sure someone is around to steal it if that takes a while.
+        MaybeStartIdleWorker(queue + 1);
+      } else {
+        MaybeStartWorker(queue);
+      }
+      return;
+    }
+    // The queue is full: fall back to the runner.
+  }
+  runner_(std::bind(&ExecutorState::Process, this, tagged_node,
+                    scheduled_nsec));
+}
+
+void ExecutorState::MaybeStartWorker(int queue) {
+  if (worker_active_[queue].exchange(true)) return;
+  num_active_workers_.fetch_add(1, std::memory_order_relaxed);
+  // The worker holds a reference on the outstanding ops until it exits, so
+  // that Finish() cannot run while it is still looking at the queues.
+  num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+  runner_([this, queue]() { WorkStealingLoop(queue); });
+}
+
+void ExecutorState::MaybeStartIdleWorker(int queue_hint) {
+  const int num_queues = ready_queues_.size();
+  if (num_active_workers_.load(std::memory_order_relaxed) >= num_queues) {
+    return;
+  }
+  for (int i = 0; i < num_queues; ++i) {
+    const int queue = (queue_hint + i) % num_queues;
+    if (!worker_active_[queue].load(std::memory_order_relaxed)) {
+      MaybeStartWorker(queue);
+      return;
     }
   }
 }
 
+bool ExecutorState::StealReady(int queue, QueuedNode* node) {
+  const int num_queues = ready_queues_.size();
+  for (int i = 1; i < num_queues; ++i) {
+    if (ready_queues_[(queue + i) % num_queues]->PopFront(node)) return true;
+  }
+  return false;
+}
+
+void ExecutorState::WorkStealingLoop(int queue) {
+  // Runners may run closures inline, so restore the caller's worker identity
+  // on the way out rather than clearing it.
+  const CurrentReadyWorker saved_worker = current_ready_worker;
+  current_ready_worker.owner = this;
+  current_ready_worker.queue = queue;
+  ReadyQueue* own_queue = ready_queues_[queue].get();
+  QueuedNode node;
+  while (true) {
+    // Newest first from our own queue, so that successors run on the thread
+    // that produced their inputs; oldest first from everybody else's.
+    while (own_queue->PopBack(&node) || StealReady(queue, &node)) {
+      Process(node.tagged_node, node.scheduled_nsec);
+    }
+    worker_active_[queue].store(false);
+    // A producer that pushed onto our queue after the last PopBack() but
+    // before the store above saw this worker as active and did not start a
+    // new one, so look again before leaving.
+    if (own_queue->Empty() || worker_active_[queue].exchange(true)) break;
+  }
+  num_active_workers_.fetch_sub(1, std::memory_order_relaxed);
+  current_ready_worker = saved_worker;
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
                                               int64 node_id) {
   // TODO(misard) Replace with a finer-grain enabling flag once we
@@ -2819,6 +3222,84 @@ void ExecutorState::FrameState::ActivateNodes(const NodeItem* item,
   }
 }
 
+int ExecutorState::FrameState::ActivateNodesFastPath(const NodeItem* item,
+                                                     const bool is_dead,
+                                                     int64 iter,
+                                                     EntryVector* outputs,
+                                                     TaggedNodeSeq* ready) {
+  const GraphView& gview = executor->gview_;
+  IterationState* iter_state = GetIteration(iter);
+  const size_t num_output_edges = item->num_output_edges;
+  const EdgeInfo* edges = item->output_edge_list();
+  Entry* input_tensors = iter_state->input_tensors;
+  int num_activated = 0;
+  for (size_t out_index = 0; out_index < num_output_edges; out_index++) {
+    const EdgeInfo& e = edges[out_index];
+    const NodeItem* dst_item = gview.node(e.dst_id);
+    const int src_slot = e.output_slot;
+    if (dst_item->is_sink) continue;
+    DCHECK(!dst_item->is_merge);
+
+    const bool is_control_edge = (src_slot == Graph::kControlSlot);
+    const bool increment_dead =
+        (is_dead || (!is_control_edge && !(*outputs)[src_slot].has_value));
+    // The input must be in place before the pending count is decremented,
+    // since the thread that brings it to zero may start dst right away.
+    if (!is_control_edge) {
+      const int dst_loc = dst_item->input_start + e.input_slot;
+      if (e.is_last) {
+        input_tensors[dst_loc] = std::move((*outputs)[src_slot]);
+      } else {
+        input_tensors[dst_loc] = (*outputs)[src_slot];
+      }
+    }
+    int pending, dead;
+    iter_state->adjust_for_activation_atomic(dst_item->pending_id,
+                                             increment_dead, &pending, &dead);
+    if (pending == 0) {
+      const bool dst_dead = (dead > 0) && !dst_item->is_control_trigger;
+      ready->emplace_back(dst_item->node, this, iter, dst_dead);
+      ++num_activated;
+    }
+  }
+  return num_activated;
+}
+
+bool ExecutorState::FrameState::ActivateNodesAndAdjustOutstanding(
+    const NodeItem* item, const bool is_dead, int64 iter,
+    EntryVector* outputs, TaggedNodeSeq* ready) {
+  const GraphView* gview = &executor->gview_;
+  if (item->is_any_consumer_merge) {
+    mutex_lock l(mu);
+    ActivateNodes(item, is_dead, iter, outputs, ready);
+    return DecrementOutstandingOpsLocked(gview, iter, ready);
+  }
+
+  int delta;
+  {
+    tf_shared_lock l(mu);
+    delta = ActivateNodesFastPath(item, is_dead, iter, outputs, ready) - 1;
+    // The op being propagated is still counted, so the iteration (and the
+    // frame) stay alive while mu is held in shared mode. Only bring the
+    // count down to zero under the exclusive lock below, where the
+    // iteration may be cleaned up.
+    std::atomic<size_t>* outstanding = &GetIteration(iter)->outstanding_ops;
+    size_t old_val = outstanding->load(std::memory_order_relaxed);
+    while (old_val + delta != 0) {
+      if (outstanding->compare_exchange_weak(old_val, old_val + delta,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+        return false;
+      }
+    }
+  }
+  mutex_lock l(mu);
+  IterationState* istate = GetIteration(iter);
+  istate->outstanding_ops += delta;
+  if (istate->outstanding_ops != 0) return false;
+  return CleanupIterations(gview, iter, ready);
+}
+
 void ExecutorState::FrameState::ActivateNexts(const GraphView* gview,
                                               int64 iter,
                                               TaggedNodeSeq* ready) {
@@ -2922,10 +3403,13 @@ void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
 
 }  // namespace
 
-Status NewLocalExecutor(const LocalExecutorParams& params,
-                        std::unique_ptr<const Graph> graph,
-                        Executor** executor) {
-  ExecutorImpl* impl = new ExecutorImpl(params, std::move(graph));
+namespace {
+
+Status NewLocalExecutorImpl(const LocalExecutorParams& params,
+                            std::unique_ptr<const Graph> graph,
+                            bool work_stealing, Executor** executor) {
+  ExecutorImpl* impl =
+      new ExecutorImpl(params, std::move(graph), work_stealing);
   const Status s = impl->Initialize();
   if (s.ok()) {
     *executor = impl;
@@ -2935,6 +3419,15 @@ Status NewLocalExecutor(const LocalExecutorParams& params,
   return s;
 }
 
+}  // namespace
+
+Status NewLocalExecutor(const LocalExecutorParams& params,
+                        std::unique_ptr<const Graph> graph,
+                        Executor** executor) {
+  return NewLocalExecutorImpl(params, std::move(graph),
+                              /*work_stealing=*/false, executor);
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const NodeDef& ndef, int graph_def_version,
                              OpKernel** kernel) {
@@ -2970,6 +3463,31 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the executor used when ConfigProto.experimental.executor_type is
+// "WORK_STEALING". It runs the same graph as the default executor, but
+// expensive ready nodes are dispatched through per-worker work-stealing
+// queues rather than one runner closure each.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params,
+                       std::unique_ptr<const Graph> graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewLocalExecutorImpl(params, std::move(graph),
+                                              /*work_stealing=*/true, &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
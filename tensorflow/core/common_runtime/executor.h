@@ -32,6 +32,7 @@ limitations under the License.
 namespace tensorflow {
 
 class StepStatsCollector;
+struct MemoryPlan;
 
 // Executor runs a graph computation.
 // Example:
@@ -100,6 +101,19 @@ class Executor {
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
 
+    // Caller-owned buffers for the outputs of particular nodes. If the kernel
+    // of node `node_id` allocates output `output` with the type and shape of
+    // `buffer`, the output shares the memory of `buffer` instead of being
+    // newly allocated (see OpKernelContext::Params::output_buffers). Only
+    // nodes outside of loops, which run once per step, write into their
+    // buffer. Distinct entries must not share memory.
+    struct OutputBuffer {
+      int node_id;
+      int output;
+      Tensor buffer;
+    };
+    const std::vector<OutputBuffer>* output_buffers = nullptr;
+
     // If true, calls Sync() on the device.
     bool sync_on_finish = false;
 
@@ -145,6 +159,11 @@ struct LocalExecutorParams {
   std::function<void(OpKernel*)> delete_kernel;
 
   Executor::RendezvousFactory rendezvous_factory;
+
+  // If not null, the statically-shaped outputs listed in the plan are
+  // allocated from one buffer per step, at the planned offsets. Only
+  // supported on CPU devices.
+  std::shared_ptr<const MemoryPlan> memory_plan;
 };
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       std::unique_ptr<const Graph> graph,
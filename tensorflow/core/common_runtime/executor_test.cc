@@ -16,9 +16,13 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <unordered_set>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
@@ -57,19 +61,29 @@ class ExecutorTest : public ::testing::Test {
   }
 
   // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
+    TF_CHECK_OK(TryCreate(std::move(graph), executor_type));
+  }
+
+  // Like Create(), but returns the error if the executor can't be created.
+  Status TryCreate(std::unique_ptr<const Graph> graph,
+                   const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
     params.create_kernel = [this, version](const NodeDef& ndef,
                                            OpKernel** kernel) {
+      if (failing_kernels_.count(ndef.name()) > 0) {
+        return errors::InvalidArgument("Failed to create ", ndef.name());
+      }
       return CreateNonCachedKernel(device_.get(), nullptr, ndef, version,
                                    kernel);
     };
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
-    rendez_ = NewLocalRendezvous();
+    if (rendez_ == nullptr) rendez_ = NewLocalRendezvous();
     params.rendezvous_factory = [this](const int64, const DeviceMgr*,
                                        Rendezvous** r) {
       *r = rendez_;
@@ -77,8 +91,13 @@ class ExecutorTest : public ::testing::Test {
       return Status::OK();
     };
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, std::move(graph), &exec_));
+    exec_ = nullptr;
+    std::unique_ptr<Executor> executor;
+    TF_RETURN_IF_ERROR(
+        NewExecutor(executor_type, params, std::move(graph), &executor));
+    exec_ = executor.release();
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
+    return Status::OK();
   }
 
   Status Run(Rendezvous* rendez) {
@@ -96,6 +115,8 @@ class ExecutorTest : public ::testing::Test {
   StepStats step_stats_;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  // Names of the nodes whose kernels fail to be created.
+  std::unordered_set<string> failing_kernels_;
 };
 
 // A float val -> Tensor<float>
@@ -200,6 +221,44 @@ TEST_F(ExecutorTest, SelfAdd) {
   EXPECT_EQ(1024.0, V(out));  // b=v10=2*v9=4*v8=...=1024*a=1024.0
 }
 
+TEST_F(ExecutorTest, StepStatsRecordInlineDecision) {
+  // A chain of adds, where each add is the only node made ready by its
+  // predecessor and is therefore always run inline. Only the first add,
+  // which is made ready by the asynchronous Recv, is dispatched.
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  const int N = 10;
+  for (int i = 1; i <= N; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(1024.0, V(out));
+
+  step_stats_collector_.Finalize();
+  int num_adds = 0;
+  int num_inline_adds = 0;
+  for (const auto& dev_stats : step_stats_.dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      if (node_stats.timeline_label().find(" = Add(") == string::npos) {
+        continue;
+      }
+      ++num_adds;
+      if (node_stats.ran_inline()) ++num_inline_adds;
+    }
+  }
+  EXPECT_EQ(N, num_adds);
+  EXPECT_EQ(N - 1, num_inline_adds);
+}
+
 // Builds a graph which adds N copies of one variable "in". I.e.,
 //     a + a + a + ... + a
 // The returned graph is parenthesized ramdonly. I.e.,
@@ -250,6 +309,93 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, RandomTreeWithPriorities) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  BuildTree(4096, g.get());
+  // Prioritize the nodes in the reverse order of their creation.
+  for (Node* n : g->nodes()) {
+    n->AddAttr("_critical_path_priority", static_cast<int64>(-n->id()));
+  }
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+// Enables the parallel creation of kernels while in scope.
+class ScopedParallelKernelCreation {
+ public:
+  ScopedParallelKernelCreation() {
+    setenv("TF_EXECUTOR_PARALLEL_KERNEL_CREATION", "true", /*overwrite=*/1);
+  }
+  ~ScopedParallelKernelCreation() {
+    unsetenv("TF_EXECUTOR_PARALLEL_KERNEL_CREATION");
+  }
+};
+
+TEST_F(ExecutorTest, RandomTreeParallelKernelCreation) {
+  ScopedParallelKernelCreation parallel_kernel_creation;
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  // Well above the 256 nodes from which kernels are created in parallel.
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, ParallelKernelCreationReportsFirstError) {
+  ScopedParallelKernelCreation parallel_kernel_creation;
+  for (int iter = 0; iter < 10; ++iter) {
+    std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+    string first_failing_node;
+    for (int i = 0; i < 1024; ++i) {
+      Node* n = test::graph::NoOp(g.get(), {});
+      // Several nodes fail, which are likely created by different threads.
+      if (i % 200 == 150) {
+        failing_kernels_.insert(n->name());
+        if (first_failing_node.empty()) first_failing_node = n->name();
+      }
+    }
+    // Whichever kernel fails first, the error names the first failing node
+    // in graph order, like a serial creation.
+    Status s = TryCreate(std::move(g));
+    EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+    EXPECT_TRUE(absl::StartsWith(
+        s.error_message(),
+        strings::StrCat("Failed to create ", first_failing_node, "\n")))
+        << s;
+    failing_kernels_.clear();
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
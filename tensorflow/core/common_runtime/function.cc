@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 // See core/kernels/function_ops.cc for related kernels.
 
@@ -911,6 +912,52 @@ void PruneFunctionBody(const FunctionDef& fdef, Graph* g) {
     FixupSourceAndSinkEdges(g);
   }
 }
+
+// Name of the executor running the kernels of a graph one after the other on
+// the caller thread (see core/kernels/data/single_threaded_executor.h).
+constexpr char kSingleThreadedExecutor[] = "SINGLE_THREADED_EXECUTOR";
+
+// Maximum number of ops of the function bodies run with the single-threaded
+// executor when the function doesn't request any executor. Set with
+// TF_SINGLE_THREADED_FUNCTION_MAX_NODES; this is opt-in, since kernels that
+// expect to run on an inter-op thread may then block the caller, so the
+// default of 0 disables it.
+int64 SingleThreadedFunctionMaxNodes() {
+  int64 max_nodes;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_SINGLE_THREADED_FUNCTION_MAX_NODES", 0,
+                                  &max_nodes));
+  return max_nodes;
+}
+
+// Returns true if the function body `g` is small and simple enough for the
+// single-threaded executor to run it faster than the default executor, whose
+// scheduling costs more than the ops of such bodies. The ops must be stateless
+// and must not call functions, which could block the caller thread.
+bool UseSingleThreadedExecutor(const Graph& g, const Device& device,
+                               const FunctionLibraryDefinition& lib_def) {
+  const int64 max_nodes = SingleThreadedFunctionMaxNodes();
+  if (max_nodes <= 0 || g.num_op_nodes() > max_nodes ||
+      device.device_type() != DEVICE_CPU) {
+    return false;
+  }
+  ExecutorFactory* factory;
+  if (!ExecutorFactory::GetFactory(kSingleThreadedExecutor, &factory).ok()) {
+    return false;
+  }
+  for (const Node* n : g.op_nodes()) {
+    if (n->IsArg() || n->IsRetval()) continue;
+    if (n->op_def().is_stateful() || n->IsControlFlow() || n->IsSend() ||
+        n->IsRecv() || n->IsCollective() || n->IsPartitionedCall() ||
+        n->type_string() == kGradientOp ||
+        lib_def.Find(n->type_string()) != nullptr) {
+      return false;
+    }
+    for (DataType dt : n->output_types()) {
+      if (IsRefType(dt)) return false;
+    }
+  }
+  return true;
+}
 }  // namespace
 
 Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
@@ -934,6 +981,12 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
   optimizer_.Optimize(this, env(), device(), &g, /*shape_map=*/nullptr);
   TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device()->device_type()),
                                        device()->name(), g.get()));
+  if (executor_type.empty() &&
+      UseSingleThreadedExecutor(*g, *device(), *lib_def)) {
+    VLOG(2) << "Running function body " << fbody->fdef.signature().name()
+            << " with the single-threaded executor";
+    executor_type = kSingleThreadedExecutor;
+  }
 
   // Creates an executor based on the g. This must be done without
   // holding mu_ because create_kernel_ calls back into the library.
@@ -687,6 +687,61 @@ TEST_F(FunctionLibraryRuntimeTest, ExecutorFactory) {
   }
 }
 
+TEST_F(FunctionLibraryRuntimeTest, SmallFunctionExecutor) {
+  Init({test::function::XTimesTwo()});
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+
+  // Returns the output of XTimesTwo, and the number of closures passed to the
+  // runner, when instantiated under `state_handle`.
+  auto run = [this, &x](const string& state_handle, int* runner_calls) {
+    FunctionLibraryRuntime::InstantiateOptions instantiate_opts;
+    instantiate_opts.state_handle = state_handle;
+    FunctionLibraryRuntime::Handle handle;
+    TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}},
+                            instantiate_opts, &handle));
+    std::atomic<int32> call_count(0);
+    std::function<void(std::function<void()>)> runner =
+        [&call_count](std::function<void()> fn) {
+          ++call_count;
+          test::function::FunctionTestSchedClosure(fn);
+        };
+    FunctionLibraryRuntime::Options opts;
+    opts.runner = &runner;
+    Notification done;
+    std::vector<Tensor> out;
+    flr0_->Run(opts, handle, {x}, &out, [&done](const Status& s) {
+      TF_CHECK_OK(s);
+      done.Notify();
+    });
+    done.WaitForNotification();
+    TF_CHECK_OK(flr0_->ReleaseHandle(handle));
+    *runner_calls = call_count;
+    CHECK_EQ(out.size(), 1);
+    return out[0];
+  };
+
+  // By default, the body runs on the default executor, which schedules its
+  // kernels with the runner.
+  int runner_calls = 0;
+  test::ExpectTensorEqual<float>(run("default", &runner_calls),
+                                 test::AsTensor<float>({2, 4, 6, 8}));
+  EXPECT_GE(runner_calls, 1);
+
+  // Once opted in, the small stateless body runs on the single-threaded
+  // executor, which runs its kernels on the calling thread.
+  setenv("TF_SINGLE_THREADED_FUNCTION_MAX_NODES", "16", /*overwrite=*/1);
+  test::ExpectTensorEqual<float>(run("single_threaded", &runner_calls),
+                                 test::AsTensor<float>({2, 4, 6, 8}));
+  EXPECT_EQ(runner_calls, 0);
+
+  // Bodies with more ops than the limit keep the default executor.
+  setenv("TF_SINGLE_THREADED_FUNCTION_MAX_NODES", "1", /*overwrite=*/1);
+  test::ExpectTensorEqual<float>(run("too_large", &runner_calls),
+                                 test::AsTensor<float>({2, 4, 6, 8}));
+  EXPECT_GE(runner_calls, 1);
+  unsetenv("TF_SINGLE_THREADED_FUNCTION_MAX_NODES");
+}
+
 TEST_F(FunctionLibraryRuntimeTest, ExpandInlineFunctions) {
   Init({test::function::XTimesTwo(), test::function::XTimesFour(),
         test::function::XTimes16()});
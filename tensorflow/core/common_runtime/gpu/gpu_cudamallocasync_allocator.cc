@@ -41,6 +41,13 @@ static std::string GetCudaErrorMessage(CUresult result) {
 }
 #endif  // GOOGLE_CUDA
 
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+// The allocator and the stream of the last SetThreadStream() on this thread.
+static thread_local const GpuCudaMallocAsyncAllocator* thread_allocator =
+    nullptr;
+static thread_local CUstream thread_stream = nullptr;
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+
 std::atomic<int> GpuCudaMallocAsyncAllocator::number_instantiated_(0);
 
 GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
@@ -221,10 +228,12 @@ void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
         << " See previous errors.";
   }
   se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  const bool on_thread_stream = thread_allocator == this;
+  CUstream stream = on_thread_stream ? thread_stream : cuda_stream_;
   void* ptr = nullptr;
   if (auto result =
       cuMemAllocFromPoolAsync(reinterpret_cast<CUdeviceptr*>(&ptr),
-                              num_bytes, pool_, cuda_stream_)) {
+                              num_bytes, pool_, stream)) {
     size_t free, total;
     cuMemGetInfo(&free, &total);
     LOG(ERROR) << Name() << " cuMemAllocAsync failed to allocate " << num_bytes
@@ -282,6 +291,11 @@ void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
     return nullptr;
   }
 
+  if (on_thread_stream) {
+    mutex_lock lock(lock_);
+    stream_map_[ptr] = stream;
+  }
+
   // Update stats.
   if (stats_) {
     mutex_lock lock(lock_);
@@ -304,8 +318,18 @@ void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
 }
 void GpuCudaMallocAsyncAllocator::DeallocateRaw(void* ptr) {
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  // Frees on the stream of the allocation.
+  CUstream stream = cuda_stream_;
+  {
+    mutex_lock lock(lock_);
+    auto it = stream_map_.find(ptr);
+    if (it != stream_map_.end()) {
+      stream = it->second;
+      stream_map_.erase(it);
+    }
+  }
   if (auto result = cuMemFreeAsync(reinterpret_cast<const CUdeviceptr&>(ptr),
-                                   cuda_stream_)) {
+                                   stream)) {
     if (result == CUDA_ERROR_DEINITIALIZED) {
       // It happens with multi-GPU that TF free the GPU allocation after
       // the driver is unloaded. It is safe to ignore this error here.
@@ -336,6 +360,32 @@ void GpuCudaMallocAsyncAllocator::DeallocateRaw(void* ptr) {
 #endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 }
 
+void GpuCudaMallocAsyncAllocator::SetThreadStream(void* stream) {
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  if (stream == nullptr) {
+    thread_allocator = nullptr;
+    thread_stream = nullptr;
+  } else {
+    thread_allocator = this;
+    thread_stream = *(static_cast<CUstream*>(stream));
+  }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+bool GpuCudaMallocAsyncAllocator::IsOrderedOnStream(const void* ptr,
+                                                    void* stream) const {
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  // Only the allocations made after SetThreadStream() are known to be from
+  // this allocator.
+  mutex_lock lock(lock_);
+  auto it = stream_map_.find(ptr);
+  return it != stream_map_.end() &&
+         it->second == *(static_cast<CUstream*>(stream));
+#else   // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  return false;
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
 bool GpuCudaMallocAsyncAllocator::TracksAllocationSizes() const {
   return static_cast<bool>(stats_);
 }
@@ -90,6 +90,20 @@ class GpuCudaMallocAsyncAllocator : public Allocator {
 #endif
   }
 
+  // Makes the allocations of the calling thread ordered on `stream`, instead
+  // of the stream given to SetStream(), until it is called again with
+  // nullptr. Each allocation is freed on the stream it was allocated on, so
+  // that the memory is reused on that stream without any host
+  // synchronization, and on the other streams only once they waited on an
+  // event of that stream (the pool follows the event dependencies). A
+  // GPUDevice with several compute streams sets the stream of each kernel.
+  void SetThreadStream(void* stream);
+
+  // Returns true if `ptr` was allocated on `stream` after SetThreadStream(),
+  // in which case it is freed in the order of `stream`: a kernel on `stream`
+  // can release it without waiting for the kernel to complete.
+  bool IsOrderedOnStream(const void* ptr, void* stream) const;
+
   static int GetInstantiatedCountTestOnly() {
     return number_instantiated_;
   }
@@ -101,7 +115,8 @@ class GpuCudaMallocAsyncAllocator : public Allocator {
   // cudaMallocAsync is stream aware. But TF StreamExecutor use only 1
   // compute stream and already synchronize with the h2d, d2h and d2d
   // stream. So we do not need to ask cudaMallocAsync to add extra
-  // synchronization.
+  // synchronization. With several compute streams, the kernels allocate
+  // on their own stream (see SetThreadStream()).
   // Not owned.
   CUstream cuda_stream_;
 
@@ -124,6 +139,10 @@ class GpuCudaMallocAsyncAllocator : public Allocator {
   mutable mutex lock_;
   std::unique_ptr<AllocatorStats> stats_ TF_PT_GUARDED_BY(lock_);
   absl::flat_hash_map<const void*, size_t> size_map_ TF_GUARDED_BY(lock_);
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  // The stream of each allocation made after SetThreadStream().
+  absl::flat_hash_map<const void*, CUstream> stream_map_ TF_GUARDED_BY(lock_);
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 };
 
 }  // namespace tensorflow
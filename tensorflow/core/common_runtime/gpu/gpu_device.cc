@@ -35,6 +35,7 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
@@ -424,6 +425,11 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
 
+  if (max_streams_ > 1) {
+    stream_ordered_allocator_ =
+        dynamic_cast<GpuCudaMallocAsyncAllocator*>(gpu_allocator_);
+  }
+
   gpu_device_info_ = new GpuDeviceInfo;
   gpu_device_info_->stream = streams_[0]->compute;
   gpu_device_info_->default_context = device_contexts_[0];
@@ -532,6 +538,42 @@ string BaseGPUDevice::ComputeOpKernelDebugString(const OpKernel& op_kernel,
                          "]");
 }
 
+Status BaseGPUDevice::WaitForInputStreams(OpKernelContext* context,
+                                          se::Stream* stream, int stream_id) {
+  // If this op's device context is different from the other contexts,
+  // we must wait on the stream.
+  const bool vlog_2 = VLOG_IS_ON(2);
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    const GPUDeviceContext* idc =
+        static_cast<GPUDeviceContext*>(context->input_device_context(i));
+    if (idc == nullptr) {
+      return errors::Internal("Input device context ", i,
+                              " was not set properly.");
+    }
+    if (vlog_2) {
+      const void* base;
+      size_t len;
+      if (context->has_input(i)) {
+        if (IsRefType(context->input_dtype(i))) {
+          Tensor tensor = context->mutable_input(i, false);
+          base = DMAHelper::base(&tensor);
+          len = tensor.TotalBytes();
+        } else {
+          const Tensor& tensor = context->input(i);
+          base = DMAHelper::base(&tensor);
+          len = tensor.TotalBytes();
+        }
+        LOG(INFO) << "Input " << i << " " << base << "  " << len;
+        LOG(INFO) << "  stream[" << stream_id << "].ThenWaitFor(stream["
+                  << idc->stream_id() << "])"
+                  << ((idc->stream() == stream) ? " not needed" : "");
+      }
+    }
+    if (idc->stream() != stream) stream->ThenWaitFor(idc->stream());
+  }
+  return Status::OK();
+}
+
 void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
   // NOTE(tucker): We need to discriminate between Eigen GPU
   // operations and all others.  If an operation is Eigen
@@ -548,44 +590,14 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
   const auto stream_id = gpu_device_context->stream_id();
 
   const bool vlog_1 = VLOG_IS_ON(1);
-  const bool vlog_2 = vlog_1 && VLOG_IS_ON(2);
 
   if (vlog_1) {
     VLOG(1) << "GpuDevice::ComputeHelper "
             << ComputeOpKernelDebugString(*op_kernel, stream_id);
   }
 
-  const auto num_streams = streams_.size();
-  if (num_streams > 1) {
-    // If this op's device context is different from the other contexts,
-    // we must wait on the stream.
-    for (int i = 0; i < context->num_inputs(); ++i) {
-      const GPUDeviceContext* idc =
-          static_cast<GPUDeviceContext*>(context->input_device_context(i));
-      OP_REQUIRES(context, idc != nullptr,
-                  errors::Internal("Input device context ", i,
-                                   " was not set properly."));
-      if (vlog_2) {
-        const void* base;
-        size_t len;
-        if (context->has_input(i)) {
-          if (IsRefType(context->input_dtype(i))) {
-            Tensor tensor = context->mutable_input(i, false);
-            base = DMAHelper::base(&tensor);
-            len = tensor.TotalBytes();
-          } else {
-            const Tensor& tensor = context->input(i);
-            base = DMAHelper::base(&tensor);
-            len = tensor.TotalBytes();
-          }
-          LOG(INFO) << "Input " << i << " " << base << "  " << len;
-          LOG(INFO) << "  stream[" << stream_id << "].ThenWaitFor(stream["
-                    << idc->stream_id() << "])"
-                    << ((idc->stream() == stream) ? " not needed" : "");
-        }
-      }
-      if (idc->stream() != stream) stream->ThenWaitFor(idc->stream());
-    }
+  if (streams_.size() > 1) {
+    OP_REQUIRES_OK(context, WaitForInputStreams(context, stream, stream_id));
   }
   if (kernel_tracker_.get()) {
     context->set_record_memory_consumption(true);
@@ -594,7 +606,14 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     }
   }
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  if (stream_ordered_allocator_ != nullptr) {
+    stream_ordered_allocator_->SetThreadStream(
+        stream->implementation()->GpuStreamMemberHack());
+  }
   op_kernel->Compute(context);
+  if (stream_ordered_allocator_ != nullptr) {
+    stream_ordered_allocator_->SetThreadStream(nullptr);
+  }
   if (context->status().ok()) {
     if (sync_every_op_) {
       // Note: GPUUtil::Sync() only syncs the default stream.
@@ -635,7 +654,23 @@ void BaseGPUDevice::ConsumeListOfAccessedTensors(
     gpu_device_context = static_cast<GPUDeviceContext*>(device_context);
   }
   se::Stream* stream = gpu_device_context->stream();
-  em_->ThenDeleteTensors(stream, tensor_refs);
+  if (stream_ordered_allocator_ == nullptr) {
+    em_->ThenDeleteTensors(stream, tensor_refs);
+    return;
+  }
+  // The buffers allocated on `stream` are freed in its order, so they can be
+  // released now. The others wait for the kernel to complete.
+  void* cuda_stream = stream->implementation()->GpuStreamMemberHack();
+  TensorReferenceVector pending_refs;
+  for (const TensorReference& ref : tensor_refs) {
+    if (stream_ordered_allocator_->IsOrderedOnStream(ref.root_data(),
+                                                     cuda_stream)) {
+      ref.Unref();
+    } else {
+      pending_refs.push_back(ref);
+    }
+  }
+  if (!pending_refs.empty()) em_->ThenDeleteTensors(stream, pending_refs);
 }
 
 // Based on the semantics of Device::Sync this call should wait for
@@ -657,6 +692,10 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
           << op_kernel->type_string() << " on GPU" << tf_gpu_id_ << " stream["
           << stream_id << "]";
 
+  if (streams_.size() > 1) {
+    OP_REQUIRES_OK_ASYNC(
+        context, WaitForInputStreams(context, stream, stream_id), done);
+  }
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
   op_kernel->ComputeAsync(context, done);
 }
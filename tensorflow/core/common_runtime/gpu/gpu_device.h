@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
+class GpuCudaMallocAsyncAllocator;
 class GPUKernelTracker;
 
 class BaseGPUDevice : public LocalDevice {
@@ -126,8 +127,9 @@ class BaseGPUDevice : public LocalDevice {
   // the compute stream and are not yet known to have completed.
   int PendingKernels();
 
+  // Returns the compute stream of the first stream group, which is the only
+  // one unless GPUOptions.experimental.num_compute_streams is set.
   void* GetStream() {
-    CHECK(streams_.size() == 1);
     return streams_.front()->compute->implementation()->GpuStreamMemberHack();
   }
 
@@ -165,6 +167,9 @@ class BaseGPUDevice : public LocalDevice {
   std::unique_ptr<GPUKernelTracker> kernel_tracker_;
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
+  // The allocator of the device when it frees in stream order and the device
+  // has several compute streams. Not owned.
+  GpuCudaMallocAsyncAllocator* stream_ordered_allocator_ = nullptr;
 
   // Initialize scractch buffers used by Eigen.
   Status InitScratchBuffers();
@@ -172,6 +177,11 @@ class BaseGPUDevice : public LocalDevice {
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
+  // Makes `stream` wait for the streams of the inputs of `context` that were
+  // computed on another stream. Only needed with several compute streams.
+  Status WaitForInputStreams(OpKernelContext* context, se::Stream* stream,
+                             int stream_id);
+
   string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                     const int& stream_id);
 
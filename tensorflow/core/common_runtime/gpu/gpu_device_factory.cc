@@ -26,6 +26,23 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// Returns GPUOptions.experimental.num_compute_streams, with 0 meaning 1.
+int32 NumComputeStreams(const SessionOptions& options) {
+  int32 num_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+  if (num_streams == 0) num_streams = 1;
+  if (num_streams < 1) {
+    LOG(ERROR) << "Illegal GPUOptions.experimental.num_compute_streams="
+               << num_streams << " set to 1 instead.";
+    num_streams = 1;
+  }
+  return num_streams;
+}
+
+}  // namespace
+
 class GPUDevice : public BaseGPUDevice {
  public:
   GPUDevice(const SessionOptions& options, const string& name,
@@ -34,7 +51,8 @@ class GPUDevice : public BaseGPUDevice {
             Allocator* gpu_allocator, Allocator* cpu_allocator)
       : BaseGPUDevice(options, name, memory_limit, locality, tf_gpu_id,
                       physical_device_desc, gpu_allocator, cpu_allocator,
-                      false /* sync every op */, 1 /* max_streams */) {
+                      false /* sync every op */,
+                      NumComputeStreams(options) /* max_streams */) {
     if (options.config.has_gpu_options()) {
       force_gpu_compatible_ =
           options.config.gpu_options().force_gpu_compatible();
@@ -21,6 +21,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -147,6 +151,34 @@ TEST_F(GPUDeviceTest, CudaMallocAsync) {
   EXPECT_EQ(status.code(), error::OK);
 }
 
+TEST_F(GPUDeviceTest, CudaMallocAsyncThreadStream) {
+  SessionOptions opts = MakeSessionOptions("0", 0, 1, {},
+                                           /*use_cuda_malloc_async=*/true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  auto* allocator = dynamic_cast<GpuCudaMallocAsyncAllocator*>(
+      devices[0]->GetAllocator(AllocatorAttributes()));
+  ASSERT_NE(allocator, nullptr);
+  auto* device_context = static_cast<GPUDeviceContext*>(
+      devices[0]->tensorflow_gpu_device_info()->default_context);
+  void* stream =
+      device_context->stream()->implementation()->GpuStreamMemberHack();
+
+  // Only the allocations made on the thread stream are ordered on it.
+  void* default_ptr =
+      allocator->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  allocator->SetThreadStream(stream);
+  void* stream_ptr =
+      allocator->AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  allocator->SetThreadStream(nullptr);
+  EXPECT_FALSE(allocator->IsOrderedOnStream(default_ptr, stream));
+  EXPECT_TRUE(allocator->IsOrderedOnStream(stream_ptr, stream));
+  allocator->DeallocateRaw(default_ptr);
+  allocator->DeallocateRaw(stream_ptr);
+  EXPECT_FALSE(allocator->IsOrderedOnStream(stream_ptr, stream));
+}
+
 TEST_F(GPUDeviceTest, FailedToParseVisibleDeviceList) {
   SessionOptions opts = MakeSessionOptions("0,abc");
   std::vector<std::unique_ptr<Device>> devices;
@@ -376,6 +408,30 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, MultipleComputeStreams) {
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_num_compute_streams(2);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+
+  Graph graph(OpRegistry::Global());
+  Node* a;
+  Node* b;
+  TF_ASSERT_OK(NodeBuilder("a", "NoOp").Finalize(&graph, &a));
+  TF_ASSERT_OK(NodeBuilder("b", "NoOp").Finalize(&graph, &b));
+  FixupSourceAndSinkEdges(&graph);
+  DeviceContextMap context_map;
+  TF_ASSERT_OK(devices[0]->FillContextMap(&graph, &context_map));
+  ASSERT_EQ(context_map.size(), graph.num_node_ids());
+  // The two independent nodes are assigned to different streams.
+  EXPECT_NE(static_cast<GPUDeviceContext*>(context_map[a->id()])->stream(),
+            static_cast<GPUDeviceContext*>(context_map[b->id()])->stream());
+  for (DeviceContext* context : context_map) context->Unref();
+}
+
 class GPUKernelTrackerTest : public ::testing::Test {
  protected:
   void Init(const GPUKernelTracker::Params& params) {
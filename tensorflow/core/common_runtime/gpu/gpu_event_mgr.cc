@@ -97,16 +97,23 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(
+          gpu_options.experimental().event_mgr_host_callbacks()),
       accumulated_stream_(nullptr),
       accumulated_tensors_(new TensorReferenceVector),
       accumulated_tensor_bytes_(0),
       threadpool_(Env::Default(), "GPU_Event_Manager", kNumThreads) {
   gpu_event_mgr::InitThreadpoolLabels(&threadpool_);
-  StartPollingLoop();
+  if (!use_host_callbacks_) StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    // The host callbacks use the threadpool.
+    mutex_lock l(mu_);
+    while (pending_host_callbacks_ > 0) host_callbacks_done_.wait(l);
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -221,6 +228,23 @@ void EventMgr::PollLoop() {
 void EventMgr::QueueInUse(se::Stream* stream, InUse iu) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
+  if (use_host_callbacks_) {
+    ++pending_host_callbacks_;
+    stream->ThenDoHostCallback([this, iu]() {
+      // A host callback must not call into the driver, which freeing memory
+      // may do, so the record is retired on the threadpool. The function
+      // runs there directly.
+      threadpool_.Schedule([this, iu]() {
+        InUse to_free = iu;
+        to_free.func = nullptr;
+        FreeMemory({to_free});
+        if (iu.func != nullptr) iu.func();
+        mutex_lock l(mu_);
+        if (--pending_host_callbacks_ == 0) host_callbacks_done_.notify_all();
+      });
+    });
+    return;
+  }
   // Events are created on demand, and repeatedly reused.  There is no
   // limit placed here on the number of allocated Events.
   if (free_events_.empty()) {
@@ -111,6 +111,9 @@ class EventMgr {
   se::StreamExecutor* const exec_;
   const int64 deferred_bytes_threshold_;
   const int32 polling_active_delay_usecs_;
+  // If true, the InUse records are retired by host callbacks on the streams
+  // rather than by polling their events.
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ GUARDED_BY(mu_);
 
@@ -150,7 +153,8 @@ class EventMgr {
 
   // Stream-enqueue an unused Event and save with it a collection of
   // Tensors and/or a BufRec to be deleted only after the Event
-  // records.
+  // records. With use_host_callbacks_, stream-enqueue a host callback
+  // that deletes them instead.
   void QueueInUse(se::Stream* stream, InUse in_use)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -198,6 +202,11 @@ class EventMgr {
   std::deque<InUse> used_events_ GUARDED_BY(mu_);
 
   bool stop_polling_ GUARDED_BY(mu_);
+
+  // The number of host callbacks that have not run yet, and its signal for
+  // the destructor.
+  int64 pending_host_callbacks_ GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_;
   std::unique_ptr<Notification> polling_stopped_;
 
   // The main PollLoop for the event manager runs in this threadpool.
@@ -242,6 +242,31 @@ TEST(EventMgr, ManySmallTensorsSeparateCallsFlushed) {
   }
 }
 
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_host_callbacks(true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  EXPECT_EQ(0, live_tensor_bytes);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  for (int i = 0; i < 5; ++i) {
+    TensorReferenceVector v;
+    AddTensorReference(&v, 100 * 1048576);
+    em.ThenDeleteTensors(stream.get(), v);
+    Notification note;
+    em.ThenExecute(stream.get(), [&note]() { note.Notify(); });
+    note.WaitForNotification();
+    // No event is polled, the tensors are freed by the callbacks.
+    EXPECT_EQ(0, th.queue_size());
+    while (live_tensor_bytes > 0) {
+      Env::Default()->SleepForMicroseconds(100);
+    }
+  }
+}
+
 // Deleting the EventMgr when events are still pending should shut
 // down gracefully.
 TEST(EventMgr, NonEmptyShutdown) {
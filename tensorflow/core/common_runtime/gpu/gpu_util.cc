@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -23,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -36,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -111,6 +117,58 @@ void* GetBase(const Tensor* src) {
 
 void* GetBase(Tensor* dst) { return DMAHelper::base(dst); }
 
+namespace {
+
+// Copies of at least this many bytes between the GPU and pageable host memory
+// are staged through pinned host memory, so that they are asynchronous like
+// the copies of pinned tensors. The driver already buffers smaller copies.
+const int64 kMinStagedCopyBytes = 64 << 10;
+
+// Staged copies are enqueued by chunks of this size, so that copying a chunk
+// between the pageable and the pinned memory overlaps with the DMA of the
+// other chunks.
+const int64 kStagedCopyChunkBytes = 4 << 20;
+
+bool StagePageableCopies() {
+  static const bool stage = [] {
+    bool value;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_GPU_STAGE_PAGEABLE_COPIES", true, &value));
+    return value;
+  }();
+  return stage;
+}
+
+// Returns a pinned buffer of `total_bytes` to stage a copy between the GPU
+// and `host_tensor`, to be freed with `*host_allocator`. Returns nullptr if
+// the copy should be done directly, i.e. `host_tensor` is small or already
+// pinned, or the pinned memory is exhausted. The buffer comes from the pooled
+// pinned allocator of the device, so the staging buffers are reused.
+void* AllocateStagingBuffer(Device* gpu_device, const Tensor& host_tensor,
+                            int64 total_bytes, Allocator** host_allocator) {
+  if (total_bytes < kMinStagedCopyBytes || !StagePageableCopies()) {
+    return nullptr;
+  }
+  AllocatorAttributes attr;
+  attr.set_on_host(true);
+  attr.set_gpu_compatible(true);
+  Allocator* allocator = gpu_device->GetAllocator(attr);
+  TensorDescription description;
+  host_tensor.FillDescription(&description);
+  if (description.allocation_description().allocator_name() ==
+      allocator->Name()) {
+    return nullptr;
+  }
+  void* buffer = allocator->AllocateRaw(
+      Allocator::kAllocatorAlignment, total_bytes,
+      AllocationAttributes(/*no_retry_on_failure=*/true,
+                           /*allocation_will_be_logged=*/false, nullptr));
+  *host_allocator = allocator;
+  return buffer;
+}
+
+}  // namespace
+
 /*static*/
 void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
                               const DeviceContext* device_context,
@@ -281,7 +339,43 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    void* dst_ptr = GetBase(cpu_tensor);
+    char* dst_ptr = static_cast<char*>(GetBase(cpu_tensor));
+    Allocator* host_allocator = nullptr;
+    char* staging = static_cast<char*>(AllocateStagingBuffer(
+        gpu_device, *cpu_tensor, total_bytes, &host_allocator));
+    if (staging != nullptr) {
+      // Each chunk is copied out of the staging buffer once its DMA is done.
+      // The callbacks may run concurrently, so the last one to finish frees
+      // the buffer and calls `done`.
+      const int64 num_chunks =
+          (total_bytes + kStagedCopyChunkBytes - 1) / kStagedCopyChunkBytes;
+      auto pending_chunks = std::make_shared<std::atomic<int64>>(num_chunks);
+      TensorReference input_ref(*gpu_tensor);
+      for (int64 offset = 0; offset < total_bytes;
+           offset += kStagedCopyChunkBytes) {
+        const int64 bytes =
+            std::min(kStagedCopyChunkBytes, total_bytes - offset);
+        DeviceMemoryBase gpu_src_chunk(static_cast<char*>(src_ptr) + offset,
+                                       bytes);
+        send_device_to_host_stream->ThenMemcpy(staging + offset, gpu_src_chunk,
+                                               bytes);
+        dev_info->event_mgr->ThenExecute(
+            send_device_to_host_stream,
+            [send_device_to_host_stream, done, input_ref, host_allocator,
+             staging, dst_ptr, offset, bytes, pending_chunks]() {
+              if (!send_device_to_host_stream->ok()) {
+                LOG(FATAL) << "GPU->CPU Memcpy failed";
+              }
+              memcpy(dst_ptr + offset, staging + offset, bytes);
+              if (pending_chunks->fetch_sub(1) == 1) {
+                host_allocator->DeallocateRaw(staging);
+                input_ref.Unref();
+                done(Status::OK());
+              }
+            });
+      }
+      return;
+    }
     send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
   }
   // Use of the input may outlive stack scope, so keep a ref.
@@ -327,8 +421,36 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   const int64 total_bytes = cpu_tensor->TotalBytes();
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
-    void* src_ptr = GetBase(cpu_tensor);
+    const char* src_ptr = static_cast<const char*>(GetBase(cpu_tensor));
     void* dst_ptr = GetBase(gpu_tensor);
+    Allocator* host_allocator = nullptr;
+    char* staging = static_cast<char*>(AllocateStagingBuffer(
+        gpu_device, *cpu_tensor, total_bytes, &host_allocator));
+    if (staging != nullptr) {
+      // The DMA of each chunk is enqueued as soon as it is in the staging
+      // buffer, and runs while the next chunks are copied into it. The source
+      // tensor is not needed anymore once this returns.
+      for (int64 offset = 0; offset < total_bytes;
+           offset += kStagedCopyChunkBytes) {
+        const int64 bytes =
+            std::min(kStagedCopyChunkBytes, total_bytes - offset);
+        memcpy(staging + offset, src_ptr + offset, bytes);
+        DeviceMemoryBase gpu_dst_chunk(static_cast<char*>(dst_ptr) + offset,
+                                       bytes);
+        recv_host_to_device_stream->ThenMemcpy(&gpu_dst_chunk, staging + offset,
+                                               bytes);
+      }
+      dev_info->event_mgr->ThenExecute(
+          recv_host_to_device_stream,
+          [recv_host_to_device_stream, done, host_allocator, staging]() {
+            host_allocator->DeallocateRaw(staging);
+            if (!recv_host_to_device_stream->ok()) {
+              LOG(FATAL) << "CPU->GPU Memcpy failed";
+            }
+            done(Status::OK());
+          });
+      return;
+    }
     DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
     recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr, total_bytes);
   }
@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -57,6 +58,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
+#include "tensorflow/core/grappler/utils.h"
 #endif  // IS_MOBILE_PLATFORM
 
 namespace tensorflow {
@@ -268,6 +270,17 @@ Status GraphExecutionState::Extend(
     TF_RETURN_IF_ERROR(
         new_execution_state->InitBaseGraph(std::move(base_graph)));
   }
+  if (session_options_->config.graph_options()
+          .rewrite_options()
+          .incremental_optimization()) {
+    std::shared_ptr<const OptimizationSnapshot> snapshot;
+    {
+      mutex_lock l(snapshot_mu_);
+      snapshot = optimization_snapshot_;
+    }
+    mutex_lock l(new_execution_state->snapshot_mu_);
+    new_execution_state->optimization_snapshot_ = std::move(snapshot);
+  }
   *out = std::move(new_execution_state);
 
   // NOTE(mrry): Extend() is likely to be used for non-throughput-sensitive
@@ -487,6 +500,71 @@ Status GetFeedShapeAndTypeFromAttribute(const NodeDef& node,
   return Status::OK();
 }
 
+// Replaces every node named in `callable_options.constant_feed()` by a Const
+// node holding the fed value. The Const keeps the name, device and control
+// inputs of the replaced node, so the rest of the graph is unchanged.
+Status SubstituteConstantFeeds(const CallableOptions& callable_options,
+                               GraphDef* graph_def) {
+  std::unordered_set<string> feeds;
+  for (const string& feed : callable_options.feed()) {
+    feeds.insert(string(ParseTensorName(feed).first));
+  }
+  std::unordered_map<string, const TensorProto*> constants;
+  for (const auto& constant_feed : callable_options.constant_feed()) {
+    TensorId id = ParseTensorName(constant_feed.first);
+    if (id.second != 0) {
+      return errors::InvalidArgument("Unsupported constant feed: ",
+                                     constant_feed.first);
+    }
+    const string node_name = string(id.first);
+    if (feeds.count(node_name) > 0) {
+      return errors::InvalidArgument(
+          "Tensor ", constant_feed.first,
+          " is specified in both feed and constant_feed");
+    }
+    if (!constants.emplace(node_name, &constant_feed.second).second) {
+      return errors::InvalidArgument("Tensor ", constant_feed.first,
+                                     " is specified twice in constant_feed");
+    }
+  }
+
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    auto it = constants.find(node.name());
+    if (it == constants.end()) continue;
+    const TensorProto& value = *it->second;
+    DataType type;
+    if (!TryGetNodeAttr(node, "dtype", &type) &&
+        !TryGetNodeAttr(node, "T", &type)) {
+      return errors::InvalidArgument(
+          "Could not determine output type for constant feed node: ",
+          node.name(), " of type ", node.op());
+    }
+    if (type != value.dtype()) {
+      return errors::InvalidArgument(
+          "Constant feed ", node.name(), " has type ",
+          DataTypeString(value.dtype()), " but the node outputs ",
+          DataTypeString(type));
+    }
+
+    NodeDef constant;
+    constant.set_name(node.name());
+    constant.set_op("Const");
+    constant.set_device(node.device());
+    for (const string& input : node.input()) {
+      if (!input.empty() && input[0] == '^') constant.add_input(input);
+    }
+    AddNodeAttr("dtype", type, &constant);
+    AddNodeAttr("value", value, &constant);
+    node.Swap(&constant);
+    constants.erase(it);
+  }
+  if (!constants.empty()) {
+    return errors::InvalidArgument("Constant feed ", constants.begin()->first,
+                                   " was not found in the Graph");
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 Status GraphExecutionState::PruneGraph(
@@ -631,6 +709,83 @@ Status GraphExecutionState::InitBaseGraph(std::unique_ptr<Graph>&& new_graph) {
   return Status::OK();
 }
 
+#ifndef IS_MOBILE_PLATFORM
+namespace {
+
+// Builds in `incremental_item` the graph of `item` made of the optimized graph
+// of a snapshot, taken before the graph was extended, and of the nodes added
+// since then, which are returned in `new_nodes`. Returns false if the graph was
+// not extended, or if it reads from nodes of the snapshot that the
+// optimization was free to rewrite, in which case the graph must be optimized
+// from scratch.
+bool MakeIncrementalItem(const std::unordered_set<string>& snapshot_nodes,
+                         const std::unordered_set<string>& preserved_nodes,
+                         const GraphDef& optimized_graph,
+                         const grappler::GrapplerItem& item,
+                         grappler::GrapplerItem* incremental_item,
+                         std::vector<string>* new_nodes) {
+  new_nodes->clear();
+  std::unordered_set<string> required_nodes;
+  for (const NodeDef& node : item.graph.node()) {
+    if (snapshot_nodes.count(node.name()) > 0) continue;
+    new_nodes->push_back(node.name());
+    for (const string& input : node.input()) {
+      const string input_node = grappler::NodeName(input);
+      if (snapshot_nodes.count(input_node) > 0) {
+        required_nodes.insert(input_node);
+      }
+    }
+  }
+  if (new_nodes->empty()) return false;
+  for (const string& node : item.NodesToPreserve()) {
+    if (snapshot_nodes.count(node) > 0) required_nodes.insert(node);
+  }
+
+  std::unordered_set<string> optimized_nodes;
+  for (const NodeDef& node : optimized_graph.node()) {
+    optimized_nodes.insert(node.name());
+  }
+  for (const string& node : required_nodes) {
+    if (preserved_nodes.count(node) == 0 || optimized_nodes.count(node) == 0) {
+      VLOG(2) << "Can not re-optimize the graph incrementally, it depends on "
+              << "node " << node << " that the optimization could rewrite";
+      return false;
+    }
+  }
+
+  GraphDef graph = optimized_graph;
+  *graph.mutable_versions() = item.graph.versions();
+  FunctionLibraryDefinition flib(OpRegistry::Global(), graph.library());
+  for (const FunctionDef& fdef : item.graph.library().function()) {
+    if (!flib.Contains(fdef.signature().name()) &&
+        !flib.AddFunctionDef(fdef).ok()) {
+      return false;
+    }
+  }
+  for (const GradientDef& grad : item.graph.library().gradient()) {
+    if (flib.FindGradient(grad.function_name()).empty() &&
+        !flib.AddGradientDef(grad).ok()) {
+      return false;
+    }
+  }
+  *graph.mutable_library() = flib.ToProto();
+  for (const NodeDef& node : item.graph.node()) {
+    if (snapshot_nodes.count(node.name()) == 0) *graph.add_node() = node;
+  }
+
+  *incremental_item = item.WithGraph(std::move(graph));
+  // Keep preserving the nodes that later extensions of the graph might read.
+  for (const string& node : preserved_nodes) {
+    if (optimized_nodes.count(node) > 0) {
+      incremental_item->keep_ops.push_back(node);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+#endif  // IS_MOBILE_PLATFORM
+
 Status GraphExecutionState::OptimizeGraph(
     const BuildGraphOptions& options, std::unique_ptr<Graph>* optimized_graph,
     std::unique_ptr<FunctionLibraryDefinition>* optimized_flib) {
@@ -643,6 +798,8 @@ Status GraphExecutionState::OptimizeGraph(
     grappler::GrapplerItem item;
     item.id = "tf_graph";
     graph_->ToGraphDef(&item.graph);
+    TF_RETURN_IF_ERROR(
+        SubstituteConstantFeeds(options.callable_options, &item.graph));
 
     // It's ok to skip invalid device annotations in Grappler.
     for (const Device* d : device_set_->devices()) {
@@ -732,8 +889,54 @@ Status GraphExecutionState::OptimizeGraph(
     }
     grappler::VirtualCluster cluster(device_set_);
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
-        item, session_options_->config, cpu_device, &cluster, &new_graph));
+    // A graph specialized on constant feeds must neither reuse nor replace
+    // the snapshot of the graph optimized for other callables.
+    const bool incremental = session_options_->config.graph_options()
+                                 .rewrite_options()
+                                 .incremental_optimization() &&
+                             options.callable_options.constant_feed().empty();
+    std::shared_ptr<const OptimizationSnapshot> snapshot;
+    if (incremental) {
+      mutex_lock l(snapshot_mu_);
+      snapshot = optimization_snapshot_;
+    }
+    auto new_snapshot = std::make_shared<OptimizationSnapshot>();
+
+    grappler::GrapplerItem incremental_item;
+    std::vector<string> new_nodes;
+    Status incremental_status = errors::Unavailable("No snapshot");
+    if (snapshot != nullptr &&
+        MakeIncrementalItem(snapshot->nodes, snapshot->preserved_nodes,
+                            snapshot->optimized_graph, item,
+                            &incremental_item, &new_nodes)) {
+      VLOG(1) << "Re-optimizing the graph incrementally around "
+              << new_nodes.size() << " new nodes";
+      incremental_status = grappler::RunMetaOptimizerIncrementally(
+          incremental_item, new_nodes, session_options_->config, cpu_device,
+          &cluster, &new_graph);
+      if (incremental_status.ok()) {
+        new_snapshot->preserved_nodes = snapshot->preserved_nodes;
+      } else {
+        VLOG(1) << "Incremental optimization failed, optimizing the whole "
+                << "graph instead: " << incremental_status;
+      }
+    }
+    if (!incremental_status.ok()) {
+      TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+          item, session_options_->config, cpu_device, &cluster, &new_graph));
+    }
+
+    if (incremental) {
+      for (const NodeDef& node : item.graph.node()) {
+        new_snapshot->nodes.insert(node.name());
+      }
+      for (const string& node : item.NodesToPreserve()) {
+        new_snapshot->preserved_nodes.insert(node);
+      }
+      new_snapshot->optimized_graph = new_graph;
+      mutex_lock l(snapshot_mu_);
+      optimization_snapshot_ = std::move(new_snapshot);
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
@@ -797,7 +1000,23 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
     // Simply copy the original graph and the function library if we couldn't
     // optimize it.
     optimized_graph.reset(new Graph(flib_def_.get()));
-    CopyGraph(*graph_, optimized_graph.get());
+    if (options.callable_options.constant_feed().empty()) {
+      CopyGraph(*graph_, optimized_graph.get());
+    } else {
+      // The constant feeds are not fed at run time, so the graph must still
+      // be specialized on them.
+      GraphDef graph_def;
+      graph_->ToGraphDef(&graph_def);
+      TF_RETURN_IF_ERROR(
+          SubstituteConstantFeeds(options.callable_options, &graph_def));
+      GraphConstructorOptions opts;
+      opts.allow_internal_ops = true;
+      TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(opts, std::move(graph_def),
+                                                optimized_graph.get()));
+      for (Node* node : optimized_graph->nodes()) {
+        node->set_assigned_device_name(node->requested_device());
+      }
+    }
     optimized_flib.reset(new FunctionLibraryDefinition(*flib_def_));
   }
 
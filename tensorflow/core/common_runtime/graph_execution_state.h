@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/build_graph_options.h"
@@ -30,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -210,6 +213,20 @@ class GraphExecutionState {
   // The dataflow graph owned by this object.
   Graph* graph_;
 
+  // The result of the most recent Grappler optimization of the whole graph.
+  // With RewriterConfig.incremental_optimization it is handed over to the
+  // state created by `Extend()`, which then re-optimizes only the new nodes.
+  struct OptimizationSnapshot {
+    // Names of the nodes of the graph that was optimized.
+    std::unordered_set<string> nodes;
+    // Names of the nodes whose semantics the optimization preserved.
+    std::unordered_set<string> preserved_nodes;
+    GraphDef optimized_graph;
+  };
+  mutable mutex snapshot_mu_;
+  std::shared_ptr<const OptimizationSnapshot> optimization_snapshot_
+      GUARDED_BY(snapshot_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GraphExecutionState);
 };
 
@@ -0,0 +1,321 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <functional>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// Invokes `f` `n` times, with the index of the invocation and a callback, and
+// blocks until all of the callbacks have run.  Returns the first non-OK status
+// any of them was called with.
+Status WaitForCallbacks(int n,
+                        const std::function<void(int, StatusCallback)>& f) {
+  BlockingCounter pending(n);
+  mutex mu;
+  Status status;
+  for (int i = 0; i < n; ++i) {
+    f(i, [&pending, &mu, &status](const Status& s) {
+      {
+        mutex_lock l(mu);
+        status.Update(s);
+      }
+      pending.DecrementCount();
+    });
+  }
+  pending.Wait();
+  return status;
+}
+
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr), col_params_(nullptr), task_idx_(-1) {}
+
+HierarchicalRingReducer::~HierarchicalRingReducer() {
+  // `merge_op` of the leader ring aliases the one of `col_params_`, which
+  // owns it.
+  leader_params_.merge_op.release();
+}
+
+bool HierarchicalRingReducer::IsHierarchical(
+    const CollectiveParams& col_params) {
+  const std::vector<string>& task_names = col_params.instance.task_names;
+  if (task_names.empty()) return false;
+  int num_tasks = 1;
+  for (int i = 1; i < task_names.size(); ++i) {
+    if (task_names[i] != task_names[i - 1]) ++num_tasks;
+  }
+  return num_tasks > 1 && task_names.size() > num_tasks;
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE ||
+      col_params->instance.impl_details.collective_name !=
+          "HierarchicalRingReduce") {
+    return errors::Internal("HierarchicalRingReducer cannot run ",
+                            col_params->instance.impl_details.collective_name);
+  }
+  // Precondition: device_names must be sorted so that all devices in the
+  // same task are adjacent.
+  const std::vector<string>& task_names = col_params->instance.task_names;
+  for (int i = 1; i < task_names.size(); ++i) {
+    if (task_names[i] == task_names[i - 1]) continue;
+    for (int j = 0; j < i; ++j) {
+      if (task_names[j] == task_names[i]) {
+        return errors::Internal("Devices of task ", task_names[i],
+                                " are not adjacent in collective ",
+                                col_params->name);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    CollectiveContext* col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  leaders_.clear();
+  members_.clear();
+  const std::vector<string>& task_names = col_params_->instance.task_names;
+  const int default_rank = col_params_->default_rank;
+  for (int i = 0; i < task_names.size(); ++i) {
+    if (i == 0 || task_names[i] != task_names[i - 1]) {
+      leaders_.push_back(i);
+    }
+    if (task_names[i] == task_names[default_rank]) {
+      if (i != leaders_.back()) members_.push_back(i);
+      task_idx_ = leaders_.size() - 1;
+    }
+  }
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  const bool is_leader = col_params_->default_rank == leaders_[task_idx_];
+  VLOG(1) << "HierarchicalRingReducer::Run for device "
+          << col_ctx_->device_name << " default_rank "
+          << col_params_->default_rank << (is_leader ? " (leader of " : " (")
+          << members_.size() << " members)";
+  done(is_leader ? RunLeader() : RunMember());
+}
+
+Status HierarchicalRingReducer::RunLeader() {
+  TF_RETURN_IF_ERROR(MaybeAbort(CopyInputToOutput()));
+  TF_RETURN_IF_ERROR(MaybeAbort(ReduceFromMembers()));
+  TF_RETURN_IF_ERROR(MaybeAbort(RunLeaderRing()));
+  TF_RETURN_IF_ERROR(MaybeAbort(Finalize()));
+  return MaybeAbort(BroadcastToMembers());
+}
+
+Status HierarchicalRingReducer::RunMember() {
+  const int leader = leaders_[task_idx_];
+  const string& leader_device = col_params_->instance.device_names[leader];
+  const string& leader_task = col_params_->instance.task_names[leader];
+  Status s = WaitForCallbacks(1, [this, &leader_device, &leader_task](
+                                     int, StatusCallback cb) {
+    col_ctx_->col_exec->PostToPeer(
+        leader_device, leader_task, GatherBufKey(col_params_->default_rank),
+        col_ctx_->device, col_ctx_->op_ctx->input_device_context(0),
+        col_ctx_->op_ctx->input_alloc_attr(0), col_ctx_->input,
+        col_ctx_->device_locality, cb);
+  });
+  TF_RETURN_IF_ERROR(MaybeAbort(s));
+  s = WaitForCallbacks(1, [this, leader, &leader_device, &leader_task](
+                              int, StatusCallback cb) {
+    col_ctx_->col_exec->RecvFromPeer(
+        leader_device, leader_task, col_params_->task.is_local[leader],
+        BroadcastBufKey(col_params_->default_rank), col_ctx_->device,
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->output,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/, cb);
+  });
+  return MaybeAbort(s);
+}
+
+Status HierarchicalRingReducer::CopyInputToOutput() {
+  if ((col_ctx_->input == col_ctx_->output) ||
+      (DMAHelper::base(col_ctx_->input) == DMAHelper::base(col_ctx_->output))) {
+    return Status::OK();
+  }
+  profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+  return WaitForCallbacks(1, [this](int, StatusCallback cb) {
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->input_device_context(0),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/, cb);
+  });
+}
+
+Status HierarchicalRingReducer::ReduceFromMembers() {
+  if (members_.empty()) return Status::OK();
+  profiler::TraceMe activity("ReduceFromMembers",
+                             profiler::TraceMeLevel::kInfo);
+  Allocator* allocator =
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+  std::vector<Tensor> inputs;
+  inputs.reserve(members_.size());
+  for (int i = 0; i < members_.size(); ++i) {
+    inputs.emplace_back(allocator, col_ctx_->output->dtype(),
+                        col_ctx_->output->shape());
+  }
+  TF_RETURN_IF_ERROR(
+      WaitForCallbacks(members_.size(), [this, &inputs](int i,
+                                                        StatusCallback cb) {
+        const int member = members_[i];
+        col_ctx_->col_exec->RecvFromPeer(
+            col_params_->instance.device_names[member],
+            col_params_->instance.task_names[member],
+            col_params_->task.is_local[member], GatherBufKey(member),
+            col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+            col_ctx_->op_ctx->output_alloc_attr(0), &inputs[i],
+            col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/, cb);
+      }));
+  for (Tensor& input : inputs) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op.get(), col_ctx_->output, &input));
+  }
+  return Status::OK();
+}
+
+Status HierarchicalRingReducer::RunLeaderRing() {
+  if (leaders_.size() < 2) return Status::OK();
+  leader_params_.name = col_params_->name;
+  leader_params_.group = col_params_->group;
+  leader_params_.group.group_size = leaders_.size();
+  leader_params_.group.num_tasks = leaders_.size();
+  leader_params_.instance.instance_key = col_params_->instance.instance_key;
+  leader_params_.instance.type = REDUCTION_COLLECTIVE;
+  leader_params_.instance.data_type = col_params_->instance.data_type;
+  leader_params_.instance.shape = col_params_->instance.shape;
+  leader_params_.instance.impl_details.collective_name = "RingReduce";
+  for (int leader : leaders_) {
+    leader_params_.instance.device_names.push_back(
+        col_params_->instance.device_names[leader]);
+    leader_params_.instance.task_names.push_back(
+        col_params_->instance.task_names[leader]);
+    leader_params_.task.is_local.push_back(col_params_->task.is_local[leader]);
+  }
+  leader_params_.default_rank = task_idx_;
+  // The merge is shared with the intra-task reduction, while final_op is
+  // applied afterwards with the size of the whole group.
+  leader_params_.merge_op.reset(col_params_->merge_op.get());
+
+  CollectiveImplementationInterface* ring_params_resolver;
+  TF_RETURN_IF_ERROR(CollectiveRegistry::LookupParamResolverInstance(
+      "RingReduce", &ring_params_resolver));
+  TF_RETURN_IF_ERROR(
+      ring_params_resolver->InitializeCollectiveParams(&leader_params_));
+
+  CollectiveImplementationInterface* ring_impl;
+  TF_RETURN_IF_ERROR(CollectiveRegistry::Lookup("RingReduce", &ring_impl));
+  std::unique_ptr<CollectiveImplementationInterface> ring(ring_impl);
+  leader_ctx_.reset(new CollectiveContext(
+      col_ctx_->col_exec, col_ctx_->dev_mgr, col_ctx_->op_ctx,
+      col_ctx_->op_params, leader_params_,
+      strings::StrCat(col_ctx_->exec_key, ":leaders"), col_ctx_->step_id,
+      col_ctx_->output, col_ctx_->output));
+  TF_RETURN_IF_ERROR(ring->InitializeCollectiveContext(leader_ctx_.get()));
+  // The ring aborts the CollectiveExecutor itself on failure.
+  Status s = WaitForCallbacks(
+      1, [&ring](int, StatusCallback cb) { ring->Run(std::move(cb)); });
+  if (!s.ok()) aborted_ = true;
+  return s;
+}
+
+Status HierarchicalRingReducer::Finalize() {
+  if (!col_params_->final_op) return Status::OK();
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      col_ctx_->output, 1,
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0))));
+  Tensor group_size = ca->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type != "CPU") {
+    Tensor host_group_size = group_size;
+    group_size = ca->Scalar(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+        AllocationAttributes());
+    TF_RETURN_IF_ERROR(WaitForCallbacks(
+        1, [this, &host_group_size, &group_size](int, StatusCallback cb) {
+          col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+              &host_group_size, col_ctx_->device, &group_size, cb);
+        }));
+  }
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op.get(), col_ctx_->output, &group_size);
+}
+
+Status HierarchicalRingReducer::BroadcastToMembers() {
+  if (members_.empty()) return Status::OK();
+  profiler::TraceMe activity("BroadcastToMembers",
+                             profiler::TraceMeLevel::kInfo);
+  return WaitForCallbacks(
+      members_.size(), [this](int i, StatusCallback cb) {
+        const int member = members_[i];
+        col_ctx_->col_exec->PostToPeer(
+            col_params_->instance.device_names[member],
+            col_params_->instance.task_names[member], BroadcastBufKey(member),
+            col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+            col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->output,
+            col_ctx_->device_locality, cb);
+      });
+}
+
+Status HierarchicalRingReducer::MaybeAbort(const Status& s) {
+  if (!s.ok() && !aborted_) {
+    LOG(ERROR) << "Aborting HierarchicalRingReduce with " << s;
+    aborted_ = true;
+    col_ctx_->col_exec->StartAbort(s);
+  }
+  return s;
+}
+
+string HierarchicalRingReducer::GatherBufKey(int rank) const {
+  return strings::StrCat(col_ctx_->exec_key, ":gather:", rank);
+}
+
+string HierarchicalRingReducer::BroadcastBufKey(int rank) const {
+  return strings::StrCat(col_ctx_->exec_key, ":bcast:", rank);
+}
+
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+class Device;
+
+// Topology-aware implementation of collective all-reduce for groups that span
+// several tasks, each contributing one or more devices.
+//
+// The first device of each task acts as the leader of that task.  Every other
+// device sends its input to its leader, which merges them in.  The leaders
+// then run a RingReducer among themselves, so that only one tensor per task
+// crosses the network in each step of the ring, and finally send the result
+// back to the other devices of their task.  Compared to a flat ring over all
+// devices this keeps the number of inter-task transfers independent of the
+// number of devices per task, so a single slow link between two hosts no
+// longer gates every chunk of the reduction.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override;
+
+  // Returns true if the group of `col_params`, whose device and task names
+  // have already been resolved, spans several tasks and at least one of them
+  // contributes more than one device.  Otherwise a flat ring is just as good.
+  static bool IsHierarchical(const CollectiveParams& col_params);
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  Status InitializeCollectiveContext(CollectiveContext* col_ctx) override;
+
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Begins execution of the hierarchical reduction.  Blocks until it
+  // completes, hence must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Steps taken by the leader of a task.
+  Status RunLeader();
+  // Steps taken by every other device of a task.
+  Status RunMember();
+
+  Status CopyInputToOutput();
+  // Receives the inputs of the other devices of this task and merges them
+  // into the output.
+  Status ReduceFromMembers();
+  // Runs a RingReducer among the task leaders, in place on the output.
+  Status RunLeaderRing();
+  // Applies final_op to the output, if any.
+  Status Finalize();
+  // Sends the output to the other devices of this task.
+  Status BroadcastToMembers();
+
+  // Invokes StartAbort on the CollectiveExecutor the first time it is called
+  // with a non-OK status, then returns `s`.
+  Status MaybeAbort(const Status& s);
+
+  string GatherBufKey(int rank) const;
+  string BroadcastBufKey(int rank) const;
+
+  CollectiveContext* col_ctx_;          // Not owned
+  const CollectiveParams* col_params_;  // Not owned
+  // Index in device_names of the leader of each task, in task order.
+  std::vector<int> leaders_;
+  // Position of this device's task in `leaders_`.
+  int task_idx_;
+  // Index in device_names of the non-leader devices of this task.
+  std::vector<int> members_;
+
+  // Parameters and context of the ring among the task leaders.
+  CollectiveParams leader_params_;
+  std::unique_ptr<CollectiveContext> leader_ctx_;
+
+  bool aborted_ = false;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
@@ -0,0 +1,351 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/unbounded_work_queue.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+static int64 kStepId = 123;
+
+// Wraps CollectiveRemoteAccessLocal with the ability to return an
+// error status to the N'th action.
+class FailTestRMA : public CollectiveRemoteAccessLocal {
+ public:
+  FailTestRMA(const DeviceMgr* dev_mgr, DeviceResolverInterface* dev_resolver,
+              std::shared_ptr<UnboundedWorkQueue> work_queue, int64 step_id,
+              int fail_after)
+      : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, work_queue, step_id),
+        fail_after_(fail_after) {}
+
+  bool MaybeFail(const StatusCallback& done) {
+    bool fail_now = false;
+    {
+      mutex_lock l(mu_);
+      if (fail_after_ > 0) {
+        fail_now = (--fail_after_ == 0);
+      }
+    }
+    if (fail_now) {
+      done(errors::Internal("Deliberate failure"));
+      return true;
+    }
+    return false;
+  }
+
+  void RecvFromPeer(const string& peer_device, const string& peer_task,
+                    bool peer_is_local, const string& key, Device* to_device,
+                    DeviceContext* to_device_ctx,
+                    const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+                    const DeviceLocality& client_locality,
+                    int dev_to_dev_stream_index,
+                    const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::RecvFromPeer(
+        peer_device, peer_task, peer_is_local, key, to_device, to_device_ctx,
+        to_alloc_attr, to_tensor, client_locality, dev_to_dev_stream_index,
+        done);
+  }
+
+  void PostToPeer(const string& peer_device, const string& peer_task,
+                  const string& key, Device* from_device,
+                  DeviceContext* from_device_ctx,
+                  const AllocatorAttributes& from_alloc_attr,
+                  const Tensor* from_tensor,
+                  const DeviceLocality& client_locality,
+                  const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::PostToPeer(
+        peer_device, peer_task, key, from_device, from_device_ctx,
+        from_alloc_attr, from_tensor, client_locality, done);
+  }
+
+  mutex mu_;
+  int fail_after_ GUARDED_BY(mu_);
+};
+
+std::unique_ptr<OpKernel> GetKernel(const NodeDef& node, DeviceBase* device) {
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node,
+      TF_GRAPH_DEF_VERSION, &status);
+  if (!status.ok()) {
+    LOG(FATAL) << status;
+  }
+  return k;
+}
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder(strings::StrCat(op, "_node"), op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  return GetKernel(node_def, device);
+}
+
+CollectiveParams SetUpCollectiveParams(
+    const std::vector<int>& num_devs_per_task) {
+  CollectiveParams cp;
+  cp.instance.type = REDUCTION_COLLECTIVE;
+  for (int ti = 0; ti < num_devs_per_task.size(); ++ti) {
+    string task_name = strings::StrCat("/job:worker/replica:0/task:", ti);
+    for (int di = 0; di < num_devs_per_task[ti]; ++di) {
+      cp.instance.task_names.push_back(task_name);
+      cp.instance.device_names.push_back(
+          strings::StrCat(task_name, "/cpu:", di));
+    }
+  }
+  cp.group.group_size = cp.instance.device_names.size();
+  cp.group.num_tasks = num_devs_per_task.size();
+  return cp;
+}
+
+TEST(HierarchicalRingReducerParamsTest, IsHierarchical) {
+  EXPECT_FALSE(
+      HierarchicalRingReducer::IsHierarchical(SetUpCollectiveParams({4})));
+  EXPECT_FALSE(
+      HierarchicalRingReducer::IsHierarchical(SetUpCollectiveParams({1, 1})));
+  EXPECT_TRUE(
+      HierarchicalRingReducer::IsHierarchical(SetUpCollectiveParams({2, 2})));
+  EXPECT_TRUE(HierarchicalRingReducer::IsHierarchical(
+      SetUpCollectiveParams({1, 3, 1})));
+}
+
+TEST(HierarchicalRingReducerParamsTest, InitializeParams) {
+  CollectiveImplementationInterface* col_impl;
+  TF_ASSERT_OK(CollectiveRegistry::LookupParamResolverInstance(
+      "HierarchicalRingReduce", &col_impl));
+  CollectiveParams cp = SetUpCollectiveParams({2, 2});
+  cp.instance.impl_details.collective_name = "HierarchicalRingReduce";
+  TF_EXPECT_OK(col_impl->InitializeCollectiveParams(&cp));
+
+  // Devices of the same task must be adjacent.
+  std::swap(cp.instance.task_names[1], cp.instance.task_names[2]);
+  EXPECT_TRUE(errors::IsInternal(col_impl->InitializeCollectiveParams(&cp)));
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  ~HierarchicalRingReducerTest() override {
+    for (auto i : instances_) delete i;
+    if (col_exec_) col_exec_->Unref();
+  }
+
+  void Init(const std::vector<int>& num_devs_per_task, DataType dtype,
+            int fail_after) {
+    std::vector<std::unique_ptr<Device>> local_devices;
+    SessionOptions sess_opts;
+    sess_opts.env = Env::Default();
+    Bytes mem_limit(4 << 20);
+    DeviceLocality dev_locality;
+    col_params_ = SetUpCollectiveParams(num_devs_per_task);
+    for (const string& dev_name : col_params_.instance.device_names) {
+      local_devices.push_back(absl::make_unique<ThreadPoolDevice>(
+          sess_opts, dev_name, mem_limit, dev_locality, cpu_allocator()));
+      // Normally each device would set is_local to its own perspective but
+      // this test runs in a single process so is_local is always true.
+      col_params_.task.is_local.push_back(true);
+    }
+    dev_mgr_ = absl::make_unique<DeviceMgr>(std::move(local_devices));
+    dev_resolver_ = absl::make_unique<DeviceResolverLocal>(dev_mgr_.get());
+    work_queue_ = std::make_shared<UnboundedWorkQueue>(Env::Default(), "test");
+    rma_ = new FailTestRMA(dev_mgr_.get(), dev_resolver_.get(), work_queue_,
+                           kStepId, fail_after);
+    col_exec_ = new BaseCollectiveExecutor(&col_exec_mgr_, rma_, kStepId,
+                                           dev_mgr_.get(), &gpu_ring_order_);
+    col_params_.name = "test_collective";
+    col_params_.group.group_key = 5;
+    col_params_.group.device_type = DEVICE_CPU;
+    col_params_.instance.instance_key = 17;
+    col_params_.instance.data_type = dtype;
+    col_params_.instance.impl_details.collective_name =
+        "HierarchicalRingReduce";
+    for (int rank = 0; rank < col_params_.group.group_size; ++rank) {
+      instances_.push_back(new DeviceInstance(rank, this));
+    }
+  }
+
+  template <typename T>
+  void RunTest(DataType dtype, const std::vector<int>& num_devs_per_task,
+               int tensor_len, int fail_after) {
+    Init(num_devs_per_task, dtype, fail_after);
+    std::vector<T> expected(tensor_len, 0);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->InitTensor(
+          dtype, TensorShape({tensor_len}), [&expected, di](Tensor* t) {
+            for (size_t i = 0; i < t->NumElements(); ++i) {
+              T value = static_cast<T>(di * 10 + i);
+              t->flat<T>()(i) = value;
+              expected[i] += value;
+            }
+          });
+    }
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<T>(instances_.size());
+    }
+
+    std::atomic<int> done(0);
+    for (auto di : instances_) {
+      SchedClosure([di, &done] {
+        di->DoReduce();
+        ++done;
+      });
+    }
+    while (done < static_cast<int>(instances_.size())) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      if (fail_after > 0) {
+        EXPECT_NE(
+            instances_[di]->status_.error_message().find("Deliberate failure"),
+            string::npos)
+            << instances_[di]->status_;
+        continue;
+      }
+      TF_EXPECT_OK(instances_[di]->status_);
+      auto actual = instances_[di]->tensor_.unaligned_flat<T>();
+      for (int i = 0; i < tensor_len; ++i) {
+        EXPECT_EQ(expected[i], actual(i))
+            << "Mismatch at device " << di << " index " << i;
+      }
+    }
+  }
+
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, HierarchicalRingReducerTest* parent)
+        : parent_(parent) {
+      const string& dev_name = parent_->col_params_.instance.device_names[rank];
+      TF_CHECK_OK(parent_->dev_mgr_->LookupDevice(dev_name, &device_));
+      col_params_.name = parent_->col_params_.name;
+      col_params_.group = parent_->col_params_.group;
+      col_params_.instance = parent_->col_params_.instance;
+      col_params_.task.is_local = parent_->col_params_.task.is_local;
+      col_params_.default_rank = rank;
+    }
+
+    void InitTensor(DataType dtype, const TensorShape& shape,
+                    const std::function<void(Tensor*)>& init_f) {
+      tensor_ =
+          Tensor(device_->GetAllocator(AllocatorAttributes()), dtype, shape);
+      init_f(&tensor_);
+    }
+
+    void DoReduce() {
+      col_params_.merge_op =
+          GetBinOp("Add", col_params_.instance.data_type, device_);
+      col_params_.final_op =
+          GetBinOp("Div", col_params_.instance.data_type, device_);
+
+      // Prepare an OpKernelContext.
+      OpKernelContext::Params op_params;
+      op_params.step_id = kStepId;
+      op_params.device = device_;
+      gtl::InlinedVector<TensorValue, 4> inputs;
+      inputs.push_back(TensorValue(&tensor_));
+      op_params.inputs = &inputs;
+      gtl::InlinedVector<AllocatorAttributes, 4> input_aa(
+          {AllocatorAttributes()});
+      op_params.input_alloc_attrs = &input_aa;
+      DeviceContext* dev_ctx = new DeviceContext;
+      gtl::InlinedVector<DeviceContext*, 4> input_dc({dev_ctx});
+      op_params.input_device_contexts = &input_dc;
+      op_params.op_device_context = dev_ctx;
+      int forward_from = 0;
+      op_params.forward_from_array = &forward_from;
+      AllocatorAttributes generic_alloc_attr;
+      op_params.output_attr_array = &generic_alloc_attr;
+      // The kernel is only used to give the context a name and is never run.
+      std::unique_ptr<OpKernel> op =
+          GetBinOp("Add", col_params_.instance.data_type, device_);
+      op_params.op_kernel = op.get();
+      OpKernelContext ctx(&op_params, 1);
+
+      // Reduce in place on the input, as the reduction kernel may do.
+      string exec_key =
+          strings::StrCat(col_params_.instance.instance_key, ":0:0");
+      HierarchicalRingReducer reducer;
+      CollectiveContext col_ctx(parent_->col_exec_, parent_->dev_mgr_.get(),
+                                &ctx, &op_params, col_params_, exec_key,
+                                kStepId, &tensor_, &tensor_);
+      TF_CHECK_OK(reducer.InitializeCollectiveContext(&col_ctx));
+      reducer.Run([this](Status s) { status_ = s; });
+      dev_ctx->Unref();
+    }
+
+    HierarchicalRingReducerTest* parent_;
+    Device* device_;
+    Tensor tensor_;
+    CollectiveParams col_params_;
+    Status status_;
+  };
+
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  CollectiveExecutor* col_exec_ = nullptr;
+  CollectiveRemoteAccessLocal* rma_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  std::shared_ptr<UnboundedWorkQueue> work_queue_;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  string gpu_ring_order_;
+  CollectiveParams col_params_;
+  std::vector<DeviceInstance*> instances_;
+};
+
+TEST_F(HierarchicalRingReducerTest, TwoTasksOfFourDevices) {
+  RunTest<float>(DT_FLOAT, {4, 4}, 1001, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, UnevenTasks) {
+  RunTest<int64>(DT_INT64, {1, 3, 2}, 4095, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, FourTasksOfTwoDevices) {
+  RunTest<double>(DT_DOUBLE, {2, 2, 2, 2}, 16, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, FailDuringReduction) {
+  RunTest<float>(DT_FLOAT, {4, 4}, 1001, 1);
+}
+
+TEST_F(HierarchicalRingReducerTest, FailDuringLeaderRing) {
+  RunTest<float>(DT_FLOAT, {4, 4}, 1001, 7);
+}
+
+}  // namespace
+}  // namespace tensorflow
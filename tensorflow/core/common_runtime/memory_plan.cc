@@ -0,0 +1,192 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_plan.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+int64 AlignedBytes(int64 bytes) {
+  const int64 alignment = Allocator::kAllocatorAlignment;
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+bool LifetimesIntersect(const BufferLifetime& a, const BufferLifetime& b) {
+  return a.first <= b.last && b.first <= a.last;
+}
+
+}  // namespace
+
+MemoryPlan PackBufferLifetimes(std::vector<BufferLifetime> buffers,
+                               int num_node_ids) {
+  // Largest first, ties broken by production order, so that the result does
+  // not depend on the order of 'buffers'.
+  std::sort(buffers.begin(), buffers.end(),
+            [](const BufferLifetime& a, const BufferLifetime& b) {
+              if (a.bytes != b.bytes) return a.bytes > b.bytes;
+              if (a.first != b.first) return a.first < b.first;
+              if (a.node_id != b.node_id) return a.node_id < b.node_id;
+              return a.output < b.output;
+            });
+
+  MemoryPlan plan;
+  plan.slots.reserve(buffers.size());
+  for (int i = 0; i < buffers.size(); ++i) {
+    const BufferLifetime& buffer = buffers[i];
+    const int64 bytes = AlignedBytes(buffer.bytes);
+    // The already placed buffers that are live at the same time, by offset.
+    std::vector<const MemoryPlan::Slot*> live;
+    for (int j = 0; j < i; ++j) {
+      if (LifetimesIntersect(buffer, buffers[j])) {
+        live.push_back(&plan.slots[j]);
+      }
+    }
+    std::sort(live.begin(), live.end(),
+              [](const MemoryPlan::Slot* a, const MemoryPlan::Slot* b) {
+                return a->offset < b->offset;
+              });
+    // Take the first gap that is large enough.
+    int64 offset = 0;
+    for (const MemoryPlan::Slot* other : live) {
+      if (other->offset - offset >= bytes) break;
+      offset = std::max(offset, other->offset + AlignedBytes(other->bytes));
+    }
+    plan.slots.push_back({buffer.node_id, buffer.output, offset, buffer.bytes,
+                          /*conflicts=*/{}});
+    plan.total_bytes = std::max(plan.total_bytes, offset + bytes);
+  }
+
+  for (int i = 0; i < plan.slots.size(); ++i) {
+    MemoryPlan::Slot& a = plan.slots[i];
+    for (int j = i + 1; j < plan.slots.size(); ++j) {
+      MemoryPlan::Slot& b = plan.slots[j];
+      if (a.offset < b.offset + b.bytes && b.offset < a.offset + a.bytes) {
+        a.conflicts.push_back(j);
+        b.conflicts.push_back(i);
+      }
+    }
+  }
+
+  plan.node_output_base.assign(num_node_ids, -1);
+  for (const BufferLifetime& buffer : buffers) {
+    DCHECK_LT(buffer.node_id, num_node_ids);
+    if (plan.node_output_base[buffer.node_id] < 0) {
+      plan.node_output_base[buffer.node_id] = plan.output_slots.size();
+      plan.output_slots.resize(plan.output_slots.size() + buffer.num_outputs,
+                               -1);
+    }
+  }
+  for (int i = 0; i < plan.slots.size(); ++i) {
+    const MemoryPlan::Slot& slot = plan.slots[i];
+    plan.output_slots[plan.node_output_base[slot.node_id] + slot.output] = i;
+  }
+  return plan;
+}
+
+// Hands out one slot of the arena, falling back to the underlying allocator
+// when the slot cannot be used.
+class MemoryPlanArena::SlotAllocator : public Allocator {
+ public:
+  SlotAllocator(MemoryPlanArena* arena, int slot)
+      : arena_(arena), slot_(slot) {}
+
+  string Name() override { return "memory_plan"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    const MemoryPlan::Slot& slot = arena_->plan_->slots[slot_];
+    arena_->Ref();
+    if (alignment <= kAllocatorAlignment && num_bytes <= slot.bytes &&
+        arena_->Claim(slot_)) {
+      arena_->num_planned_allocations_.fetch_add(1,
+                                                  std::memory_order_relaxed);
+      return arena_->base_ + slot.offset;
+    }
+    void* ptr = arena_->allocator_->AllocateRaw(alignment, num_bytes);
+    if (ptr == nullptr) arena_->Unref();
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    if (ptr == arena_->base_ + arena_->plan_->slots[slot_].offset) {
+      arena_->Unclaim(slot_);
+    } else {
+      arena_->allocator_->DeallocateRaw(ptr);
+    }
+    arena_->Unref();
+  }
+
+ private:
+  MemoryPlanArena* const arena_;
+  const int slot_;
+};
+
+MemoryPlanArena::MemoryPlanArena(std::shared_ptr<const MemoryPlan> plan,
+                                 Allocator* allocator)
+    : plan_(std::move(plan)), allocator_(allocator) {
+  if (plan_->total_bytes == 0) return;
+  AllocationAttributes attr;
+  attr.no_retry_on_failure = true;
+  base_ = static_cast<char*>(allocator_->AllocateRaw(
+      Allocator::kAllocatorAlignment, plan_->total_bytes, attr));
+  if (base_ == nullptr) {
+    VLOG(1) << "MemoryPlanArena could not reserve " << plan_->total_bytes
+            << " bytes from " << allocator_->Name();
+    return;
+  }
+  slot_allocators_.reserve(plan_->slots.size());
+  for (int i = 0; i < plan_->slots.size(); ++i) {
+    slot_allocators_.emplace_back(new SlotAllocator(this, i));
+  }
+  output_allocators_.resize(plan_->output_slots.size(), nullptr);
+  for (int i = 0; i < plan_->output_slots.size(); ++i) {
+    if (plan_->output_slots[i] >= 0) {
+      output_allocators_[i] = slot_allocators_[plan_->output_slots[i]].get();
+    }
+  }
+  in_use_.resize(plan_->slots.size(), false);
+}
+
+MemoryPlanArena::~MemoryPlanArena() {
+  if (base_ != nullptr) allocator_->DeallocateRaw(base_);
+}
+
+void MemoryPlanArena::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+bool MemoryPlanArena::Claim(int slot) {
+  mutex_lock l(mu_);
+  if (in_use_[slot]) return false;
+  for (int other : plan_->slots[slot].conflicts) {
+    if (in_use_[other]) return false;
+  }
+  in_use_[slot] = true;
+  return true;
+}
+
+void MemoryPlanArena::Unclaim(int slot) {
+  mutex_lock l(mu_);
+  DCHECK(in_use_[slot]);
+  in_use_[slot] = false;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,141 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLAN_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The lifetime of one statically-shaped node output, in terms of positions
+// in a topological order of the graph: the output is produced at 'first'
+// and last read at 'last'.
+struct BufferLifetime {
+  int node_id;
+  int output;
+  // Number of outputs of the node.
+  int num_outputs;
+  int64 bytes;
+  int first;
+  int last;
+};
+
+// A static assignment of node outputs to offsets in a single buffer, such
+// that outputs whose lifetimes overlap never share memory.
+struct MemoryPlan {
+  struct Slot {
+    int node_id;
+    int output;
+    int64 offset;
+    int64 bytes;
+    // Slots whose memory overlaps this one.
+    std::vector<int> conflicts;
+  };
+
+  std::vector<Slot> slots;
+  int64 total_bytes = 0;
+
+  // Indexed by node id: the position in 'output_slots' of the first output
+  // of the node, or -1 if no output of the node is planned.
+  std::vector<int> node_output_base;
+  // For every output of every planned node, the index of its slot in
+  // 'slots', or -1.
+  std::vector<int> output_slots;
+};
+
+// Packs 'buffers' into a buffer greedily, largest first, placing each at the
+// lowest offset that does not overlap a buffer with an intersecting lifetime
+// (the strategy of TFLite's ArenaPlanner). Offsets are aligned to
+// Allocator::kAllocatorAlignment. 'num_node_ids' bounds the node ids.
+MemoryPlan PackBufferLifetimes(std::vector<BufferLifetime> buffers,
+                               int num_node_ids);
+
+// The memory of one step of an executor that was given a MemoryPlan.
+//
+// Every planned output gets its own Allocator, which returns the output's
+// slot in one block that is reserved when the step starts. At runtime a slot
+// is only handed out if none of the slots that share its memory is still in
+// use (for example because a kernel forwarded or retained the tensor past
+// the lifetime computed by the planner); otherwise, and for requests larger
+// than the slot, the allocation is passed through to the underlying
+// allocator.
+//
+// The arena deletes itself once Release() has been called and every tensor
+// allocated from it has been deallocated.
+class MemoryPlanArena {
+ public:
+  // 'allocator' must outlive the arena.
+  MemoryPlanArena(std::shared_ptr<const MemoryPlan> plan, Allocator* allocator);
+
+  // Returns the allocators for the outputs of node 'node_id', indexed by
+  // output, with nullptr entries for outputs that are not planned; or
+  // nullptr if the node has no planned output.
+  Allocator* const* OutputAllocators(int node_id) const {
+    if (base_ == nullptr || node_id >= plan_->node_output_base.size()) {
+      return nullptr;
+    }
+    const int base = plan_->node_output_base[node_id];
+    return base < 0 ? nullptr : &output_allocators_[base];
+  }
+
+  // Returns the number of allocations that were served from a slot.
+  int64 NumPlannedAllocations() const {
+    return num_planned_allocations_.load(std::memory_order_relaxed);
+  }
+
+  // Drops the creator's reference.
+  void Release() { Unref(); }
+
+ private:
+  class SlotAllocator;
+
+  ~MemoryPlanArena();
+
+  void Ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
+  void Unref();
+
+  // Marks 'slot' as in use, unless it or a slot sharing its memory already
+  // is. Returns true on success.
+  bool Claim(int slot);
+  void Unclaim(int slot);
+
+  const std::shared_ptr<const MemoryPlan> plan_;
+  Allocator* const allocator_;
+  char* base_ = nullptr;
+  std::vector<std::unique_ptr<SlotAllocator>> slot_allocators_;
+  std::vector<Allocator*> output_allocators_;
+
+  mutex mu_;
+  std::vector<bool> in_use_ GUARDED_BY(mu_);
+
+  std::atomic<int64> num_planned_allocations_{0};
+  // One for the creator plus one per live allocation.
+  std::atomic<int64> refs_{1};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryPlanArena);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLAN_H_
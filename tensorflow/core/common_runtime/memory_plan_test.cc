@@ -0,0 +1,106 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_plan.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+const MemoryPlan::Slot& SlotFor(const MemoryPlan& plan, int node_id,
+                                int output) {
+  const int base = plan.node_output_base[node_id];
+  CHECK_GE(base, 0);
+  const int slot = plan.output_slots[base + output];
+  CHECK_GE(slot, 0);
+  return plan.slots[slot];
+}
+
+TEST(MemoryPlanTest, DisjointLifetimesShareMemory) {
+  // A chain a -> b -> c: a and c are never live at the same time.
+  std::vector<BufferLifetime> buffers = {
+      {/*node_id=*/2, /*output=*/0, /*num_outputs=*/1, 1000, 0, 1},
+      {/*node_id=*/3, /*output=*/0, /*num_outputs=*/1, 1000, 1, 2},
+      {/*node_id=*/4, /*output=*/0, /*num_outputs=*/1, 1000, 2, 3},
+  };
+  MemoryPlan plan = PackBufferLifetimes(buffers, 5);
+  ASSERT_EQ(3, plan.slots.size());
+  EXPECT_EQ(2 * 1024, plan.total_bytes);
+  EXPECT_EQ(SlotFor(plan, 2, 0).offset, SlotFor(plan, 4, 0).offset);
+  EXPECT_NE(SlotFor(plan, 2, 0).offset, SlotFor(plan, 3, 0).offset);
+  EXPECT_EQ(1, SlotFor(plan, 2, 0).conflicts.size());
+  EXPECT_EQ(-1, plan.node_output_base[0]);
+}
+
+TEST(MemoryPlanTest, FillsGaps) {
+  // A large long-lived buffer, then two small ones that fit below it.
+  std::vector<BufferLifetime> buffers = {
+      {2, 0, 2, 4096, 0, 0},  {2, 1, 2, 1024, 0, 3},
+      {3, 0, 1, 2048, 1, 3},  {4, 0, 1, 2048, 2, 3},
+  };
+  MemoryPlan plan = PackBufferLifetimes(buffers, 5);
+  EXPECT_EQ(0, SlotFor(plan, 2, 0).offset);
+  EXPECT_EQ(5 * 1024, plan.total_bytes);
+  for (const auto& a : plan.slots) {
+    for (const auto& b : plan.slots) {
+      if (&a == &b) continue;
+      const bool overlap =
+          a.offset < b.offset + b.bytes && b.offset < a.offset + a.bytes;
+      EXPECT_EQ(overlap, std::find(a.conflicts.begin(), a.conflicts.end(),
+                                   &b - &plan.slots[0]) != a.conflicts.end());
+    }
+  }
+}
+
+TEST(MemoryPlanArenaTest, FallsBackWhenSlotIsBusy) {
+  std::vector<BufferLifetime> buffers = {
+      {2, 0, 1, 256, 0, 1},
+      {3, 0, 1, 256, 2, 3},
+  };
+  auto plan = std::make_shared<MemoryPlan>(PackBufferLifetimes(buffers, 4));
+  ASSERT_EQ(256, plan->total_bytes);
+  MemoryPlanArena* arena = new MemoryPlanArena(plan, cpu_allocator());
+  Allocator* a = arena->OutputAllocators(2)[0];
+  Allocator* b = arena->OutputAllocators(3)[0];
+  EXPECT_EQ(nullptr, arena->OutputAllocators(1));
+
+  Tensor ta(a, DT_FLOAT, TensorShape({64}));
+  // 'ta' outlives its planned lifetime, so 'tb' cannot use the shared
+  // memory.
+  Tensor tb(b, DT_FLOAT, TensorShape({64}));
+  EXPECT_NE(ta.tensor_data().data(), tb.tensor_data().data());
+  EXPECT_EQ(1, arena->NumPlannedAllocations());
+
+  // Once 'ta' is gone, the slot can be used.
+  const void* shared = ta.tensor_data().data();
+  ta = Tensor();
+  Tensor tb2(b, DT_FLOAT, TensorShape({64}));
+  EXPECT_EQ(shared, tb2.tensor_data().data());
+  // Requests larger than planned are not served from the slot.
+  Tensor too_big(a, DT_FLOAT, TensorShape({128}));
+  EXPECT_NE(shared, too_big.tensor_data().data());
+  EXPECT_EQ(2, arena->NumPlannedAllocations());
+
+  // The tensors keep the arena alive.
+  arena->Release();
+  tb2.flat<float>().setZero();
+}
+
+}  // namespace
+}  // namespace tensorflow
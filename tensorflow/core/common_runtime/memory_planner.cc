@@ -0,0 +1,116 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns the number of bytes of a tensor with properties 'props', or -1 if
+// it is not known statically.
+int64 StaticBytes(const OpInfo::TensorProperties& props) {
+  if (!DataTypeCanUseMemcpy(props.dtype()) || IsRefType(props.dtype())) {
+    return -1;
+  }
+  const TensorShapeProto& shape = props.shape();
+  if (shape.unknown_rank()) return -1;
+  int64 num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return -1;
+    num_elements *= dim.size();
+  }
+  return num_elements * DataTypeSize(props.dtype());
+}
+
+bool ProducesPlannableOutputs(const Node* n) {
+  return n->IsOp() && !n->IsConstant() && !n->IsVariable() && !n->IsArg() &&
+         !n->IsRecv() && !n->IsIdentity();
+}
+
+// Extends '*last' to the position of the last reader of output 'output' of
+// 'n', looking through Identity nodes. Returns false if the output escapes
+// the step.
+bool LastUse(const Node* n, int output, const std::vector<int>& position,
+             int* last) {
+  for (const Edge* e : n->out_edges()) {
+    if (e->IsControlEdge() || e->src_output() != output) continue;
+    const Node* dst = e->dst();
+    if (dst->IsSend() || dst->IsRetval()) return false;
+    *last = std::max(*last, position[dst->id()]);
+    if (dst->IsIdentity() && !LastUse(dst, 0, position, last)) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+Status PlanGraphMemory(const Graph& graph, MemoryPlan* plan) {
+  *plan = MemoryPlan();
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsControlFlow()) {
+      VLOG(1) << "Not planning memory for a graph with control flow";
+      return Status::OK();
+    }
+  }
+
+  grappler::GrapplerItem item;
+  graph.ToGraphDef(&item.graph);
+  grappler::GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  std::vector<int> position(graph.num_node_ids(), -1);
+  for (int i = 0; i < order.size(); ++i) {
+    position[order[i]->id()] = i;
+  }
+
+  std::vector<BufferLifetime> buffers;
+  for (const Node* n : order) {
+    if (!ProducesPlannableOutputs(n) ||
+        !properties.HasOutputProperties(n->name())) {
+      continue;
+    }
+    const auto& outputs = properties.GetOutputProperties(n->name());
+    if (outputs.size() != n->num_outputs()) continue;
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      if (IsRefType(n->output_type(i))) continue;
+      const int64 bytes = StaticBytes(outputs[i]);
+      if (bytes <= 0) continue;
+      int last = position[n->id()];
+      if (!LastUse(n, i, position, &last)) continue;
+      buffers.push_back(
+          {n->id(), i, n->num_outputs(), bytes, position[n->id()], last});
+    }
+  }
+  *plan = PackBufferLifetimes(std::move(buffers), graph.num_node_ids());
+  VLOG(1) << "Planned " << plan->slots.size() << " outputs into "
+          << plan->total_bytes << " bytes";
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,41 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+
+#include "tensorflow/core/common_runtime/memory_plan.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Computes a MemoryPlan for the node outputs of the partition 'graph' whose
+// shapes are fully known statically, as inferred by grappler's
+// GraphProperties. Lifetimes are measured in a reverse post order of the
+// graph; an output is live until its last consumer, following chains of
+// Identity nodes that forward it.
+//
+// Outputs of constants, variables, _Arg and _Recv nodes, reference and
+// non-memcpy-able outputs, and outputs that reach a _Send or _Retval node
+// are not planned. Graphs with control flow get an empty plan.
+//
+// 'graph' must not be modified afterwards, since the plan refers to its node
+// ids.
+Status PlanGraphMemory(const Graph& graph, MemoryPlan* plan);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
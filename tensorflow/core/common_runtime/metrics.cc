@@ -48,6 +48,14 @@ auto* graph_run_output_tensor_bytes = monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 14 (256G)
     {monitoring::Buckets::Exponential(1, 4, 14)});
 
+auto* sampled_op_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/sampled_op_time_usecs",
+     "The execution time of the ops in the steps sampled every "
+     "TF_OP_TIME_SAMPLING_PERIOD steps, in microseconds.",
+     "op"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
 auto* tf_data_autotune_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/autotune", "tf.data autotuning", "name");
 
@@ -121,6 +129,10 @@ void UpdateGraphExecTime(const uint64 running_time_usecs) {
   }
 }
 
+void RecordSampledOpTime(const string& op, const uint64 op_time_usecs) {
+  sampled_op_time_usecs->GetCell(op)->Add(op_time_usecs);
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     build_graph_calls->GetCell()->IncrementBy(1);
@@ -49,6 +49,11 @@ void RecordGraphOutputTensors(const size_t size);
 
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 
+// Records the execution time of an op in a sampled step.
+//
+// The `op` argument is the type of the op (e.g. "MatMul").
+void RecordSampledOpTime(const string& op, const uint64 op_time_usecs);
+
 // Updates the metrics stored about time spent building graphs.
 //
 // By "GraphBuild", we refer to building a client graph, which is a sub-graph of
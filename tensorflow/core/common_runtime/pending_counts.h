@@ -16,6 +16,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <atomic>
+
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/logging.h"
@@ -226,6 +228,20 @@ class PendingCounts {
     }
   }
 
+  // As adjust_for_activation, but safe to call concurrently with other
+  // calls to adjust_for_activation_atomic on the same PendingCounts object.
+  // It must not race with any of the non-atomic mutators above.
+  void adjust_for_activation_atomic(Handle h, bool increment_dead,
+                                    int* pending_result, int* dead_result) {
+    if (h.is_large_) {
+      adjust_for_activation_shared_atomic(LargeAtomic(h), increment_dead,
+                                          pending_result, dead_result);
+    } else {
+      adjust_for_activation_shared_atomic(PackedAtomic(h), increment_dead,
+                                          pending_result, dead_result);
+    }
+  }
+
   class Handle {
    public:
     Handle() : byte_offset_(0), is_large_(0) {}
@@ -251,6 +267,31 @@ class PendingCounts {
     *pending_result = c->pending;
   }
 
+  template <typename T>
+  inline void adjust_for_activation_shared_atomic(std::atomic<T>* c,
+                                                  bool increment_dead,
+                                                  int* pending_result,
+                                                  int* dead_result) {
+    T old_val = c->load(std::memory_order_relaxed);
+    while (true) {
+      T new_val = old_val;
+      DCHECK_GE(new_val.pending, 1);
+      if (increment_dead && PENDING_NOTREADY == NodeStateForStruct(&new_val)) {
+        new_val.dead_count++;
+      }
+      new_val.pending -= 1;
+      // Release the writes of this input and acquire those of the other
+      // inputs, so that whoever sees the count drop to zero sees all inputs.
+      if (c->compare_exchange_weak(old_val, new_val,
+                                   std::memory_order_acq_rel,
+                                   std::memory_order_relaxed)) {
+        *dead_result = new_val.dead_count;
+        *pending_result = new_val.pending;
+        return;
+      }
+    }
+  }
+
   // We keep track of the pending count and dead input count for each
   // graph node.  The representation used here is designed to be cache
   // efficient for graphs with large numbers of nodes, where most
@@ -299,6 +340,19 @@ class PendingCounts {
     return reinterpret_cast<PackedCounts*>(bytes_ + h.byte_offset_);
   }
 
+  // The counts are updated in place, so an atomic view of each struct must
+  // have the same representation as the struct itself.
+  static_assert(sizeof(std::atomic<PackedCounts>) == sizeof(PackedCounts),
+                "std::atomic<PackedCounts> must not add any state");
+  static_assert(sizeof(std::atomic<LargeCounts>) == sizeof(LargeCounts),
+                "std::atomic<LargeCounts> must not add any state");
+  inline std::atomic<LargeCounts>* LargeAtomic(Handle h) {
+    return reinterpret_cast<std::atomic<LargeCounts>*>(Large(h));
+  }
+  inline std::atomic<PackedCounts>* PackedAtomic(Handle h) {
+    return reinterpret_cast<std::atomic<PackedCounts>*>(Packed(h));
+  }
+
   const int num_bytes_;  // Just for bounds checking in debug mode
   char* bytes_;          // Array of num_bytes_ bytes
 
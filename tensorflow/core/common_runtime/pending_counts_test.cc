@@ -13,10 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -166,4 +169,48 @@ TEST(PendingCounts, AdjustForActivation) {
   }
 }
 
+TEST(PendingCounts, AdjustForActivationAtomic) {
+  PendingCounts::Layout layout;
+  PendingCounts::Handle handles[2];
+  // Test for both packed and large.
+  const int kInitialCounts[2] = {6, 16};
+  handles[0] = layout.CreateHandle(kInitialCounts[0], kInitialCounts[0]);
+  handles[1] = layout.CreateHandle(kInitialCounts[1], kInitialCounts[1]);
+  PendingCounts c(layout);
+  for (int id = 0; id < 2; id++) {
+    c.set_initial_count(handles[id], kInitialCounts[id]);
+  }
+
+  // Every other activation is dead. Exactly one activation per handle must
+  // observe a zero pending count, together with the final dead count.
+  std::atomic<int> num_ready[2];
+  std::atomic<int> final_dead[2];
+  for (int id = 0; id < 2; id++) {
+    num_ready[id] = 0;
+    final_dead[id] = -1;
+  }
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 4);
+    for (int id = 0; id < 2; id++) {
+      for (int i = 0; i < kInitialCounts[id]; ++i) {
+        pool.Schedule([&c, &handles, &num_ready, &final_dead, id, i]() {
+          int pending, dead;
+          c.adjust_for_activation_atomic(handles[id], i % 2 == 0, &pending,
+                                         &dead);
+          if (pending == 0) {
+            ++num_ready[id];
+            final_dead[id] = dead;
+          }
+        });
+      }
+    }
+  }
+  for (int id = 0; id < 2; id++) {
+    EXPECT_EQ(num_ready[id], 1);
+    EXPECT_EQ(final_dead[id], kInitialCounts[id] / 2);
+    EXPECT_EQ(c.pending(handles[id]), 0);
+    EXPECT_EQ(c.dead_count(handles[id]), kInitialCounts[id] / 2);
+  }
+}
+
 }  // namespace tensorflow
@@ -799,6 +799,21 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
             << component_handle;
     VLOG(2) << DebugString(shard);
     comp_data->handle_ = component_handle;
+    comp_data->flr_ = GetFLR(target);
+  }
+
+  if (data->glue_.size() == 1) {
+    ComponentFunctionData* comp_data = &data->glue_.begin()->second;
+    const auto is_identity = [](const std::vector<int>& indices, int size) {
+      if (indices.size() != size) return false;
+      for (int i = 0; i < size; ++i) {
+        if (indices[i] != i) return false;
+      }
+      return true;
+    };
+    comp_data->is_whole_function_ =
+        is_identity(comp_data->arg_indices_, arg_nodes.size()) &&
+        is_identity(comp_data->ret_indices_, data->num_outputs_);
   }
 
   *handle = AddMultiDeviceHandle(std::move(data), function_key);
@@ -889,27 +904,55 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
     return;
   }
 
+  FunctionLibraryRuntime::Options opts_copy = opts;
+  const ComponentFunctionData& first_comp_data = data->glue_.begin()->second;
+  if (first_comp_data.is_whole_function_ && first_comp_data.flr_ != nullptr) {
+    // The function runs on a single local device: its component function
+    // takes the arguments and produces the return values directly.
+    FunctionLibraryRuntime* flr = first_comp_data.flr_;
+    opts_copy.args_alloc_attrs = first_comp_data.arg_alloc_attrs_;
+    opts_copy.rets_alloc_attrs = first_comp_data.ret_alloc_attrs_;
+    opts_copy.remote_execution = false;
+    thread::ThreadPool* pool = flr->device()->tensorflow_device_thread_pool();
+    opts_copy.runner = (pool == nullptr) ? opts_copy.runner : flr->runner();
+    VLOG(1) << "Running single component function with handle "
+            << first_comp_data.handle_;
+    flr->Run(opts_copy, first_comp_data.handle_, args, rets,
+             [data, done = std::move(done)](const Status& status) {
+               if (!status.ok()) {
+                 VLOG(2) << "Component function execution failed: " << status;
+                 done(Status(
+                     status.code(),
+                     strings::StrCat(
+                         errors::FormatFunctionForError(data->function_name_),
+                         " ", status.error_message())));
+                 return;
+               }
+               done(status);
+             });
+    return;
+  }
+
   auto* refcounted_done = new ReffedStatusCallback(std::move(done));
   for (int i = 0; i < data->glue_.size(); ++i) {
     refcounted_done->Ref();
   }
 
-  FunctionLibraryRuntime::Options opts_copy = opts;
+  rets->resize(data->num_outputs_);
   for (const auto& pair : data->glue_) {
     const string& target = pair.first;
-    const ComponentFunctionData& comp_data = pair.second;
-    FunctionLibraryRuntime::Handle handle = pair.second.handle_;
+    const ComponentFunctionData* comp_data = &pair.second;
+    FunctionLibraryRuntime::Handle handle = comp_data->handle_;
 
-    opts_copy.args_alloc_attrs = comp_data.arg_alloc_attrs_;
-    opts_copy.rets_alloc_attrs = comp_data.ret_alloc_attrs_;
+    opts_copy.args_alloc_attrs = comp_data->arg_alloc_attrs_;
+    opts_copy.rets_alloc_attrs = comp_data->ret_alloc_attrs_;
     opts_copy.remote_execution = false;
 
     std::vector<Tensor> comp_args =
-        GetArgsForIndices(comp_data.arg_indices_, args);
+        GetArgsForIndices(comp_data->arg_indices_, args);
     std::vector<Tensor>* comp_rets = new std::vector<Tensor>;
-    rets->resize(data->num_outputs_);
 
-    FunctionLibraryRuntime* flr = GetFLR(target);
+    FunctionLibraryRuntime* flr = comp_data->flr_;
     if (flr != nullptr) {
       // When target device has private thread pool, use the target device
       // runner
@@ -932,7 +975,7 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
                        Status(status.code(), function_and_msg));
                  } else {
                    for (int i = 0; i < comp_rets->size(); ++i) {
-                     (*rets)[comp_data.ret_indices_[i]] = (*comp_rets)[i];
+                     (*rets)[comp_data->ret_indices_[i]] = (*comp_rets)[i];
                    }
                  }
                  delete comp_rets;
@@ -953,7 +996,7 @@ void ProcessFunctionLibraryRuntime::RunMultiDevice(
               refcounted_done->UpdateStatus(status);
             } else {
               for (int i = 0; i < comp_rets->size(); ++i) {
-                (*rets)[comp_data.ret_indices_[i]] = (*comp_rets)[i];
+                (*rets)[comp_data->ret_indices_[i]] = (*comp_rets)[i];
               }
             }
             delete comp_rets;
@@ -187,6 +187,13 @@ class ProcessFunctionLibraryRuntime {
     // ret_alloc_attrs_[i] are the allocator attributes of the i-th return value
     // of the component function.
     std::vector<AllocatorAttributes> ret_alloc_attrs_;
+    // The runtime of the device of the component function, or nullptr if the
+    // device is remote. Resolved once, since it is needed at every run.
+    FunctionLibraryRuntime* flr_ = nullptr;
+    // True if the arguments and return values of the component function are
+    // all the arguments and return values of the multi-device function, in
+    // the same order.
+    bool is_whole_function_ = false;
   };
 
   // Data structure holding information for a single instantiated multi-device
@@ -681,6 +681,19 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_FlipBoth) {
       this, MakeOptions("CPU:0", {"GPU:0", "CPU:0"}, {"GPU:0", "CPU:0"}));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_SingleDevice) {
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::Options opts;
+  opts.rendezvous = rendezvous_;
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  for (int i = 0; i < 2; ++i) {
+    Tensor y;
+    TF_CHECK_OK(Run("XTimesTwo", opts, {{"T", DT_FLOAT}},
+                    MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"}), {x}, {&y}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  }
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_EmptyBodySwap) {
   if (gpu_device_ == nullptr) {
     GTEST_SKIP() << "No GPUs available";
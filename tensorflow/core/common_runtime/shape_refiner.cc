@@ -159,6 +159,31 @@ Status InferShapesForFunctionSubNode(const Node* node, ShapeRefiner* refiner,
 Status ShapeRefiner::InferShapesForFunction(
     const FunctionDef* function_def, AttrSlice attributes,
     bool keep_nested_shapes, ExtendedInferenceContext* outer_context) {
+  InferenceContext* c = outer_context->get_context();
+  string shapes_key;
+  if (!keep_nested_shapes) {
+    shapes_key = FunctionShapesKey(function_def, attributes, c);
+    auto cached = function_output_shapes_.find(shapes_key);
+    if (cached != function_output_shapes_.end()) {
+      for (int i = 0; i < cached->second.size(); ++i) {
+        const FunctionOutputShapes& output = cached->second[i];
+        ShapeHandle handle;
+        TF_RETURN_IF_ERROR(c->MakeShapeFromShapeProto(output.shape, &handle));
+        c->set_output(i, handle);
+        if (output.has_handle_data) {
+          std::vector<ShapeAndType> shapes_and_types;
+          for (const auto& shape_and_type : output.handle_shapes_and_types) {
+            TF_RETURN_IF_ERROR(
+                c->MakeShapeFromShapeProto(shape_and_type.first, &handle));
+            shapes_and_types.emplace_back(handle, shape_and_type.second);
+          }
+          c->set_output_handle_shapes_and_types(i, shapes_and_types);
+        }
+      }
+      return Status::OK();
+    }
+  }
+
   const Graph* graph;
   auto it = functions_.find(function_def);
   if (it != functions_.end()) {
@@ -232,9 +257,50 @@ Status ShapeRefiner::InferShapesForFunction(
     }
   }
 
+  if (!keep_nested_shapes && inference_status.ok()) {
+    std::vector<FunctionOutputShapes> outputs(c->num_outputs());
+    for (int i = 0; i < c->num_outputs(); ++i) {
+      c->ShapeHandleToProto(c->output(i), &outputs[i].shape);
+      const std::vector<ShapeAndType>* shapes_and_types =
+          c->output_handle_shapes_and_types(i);
+      if (shapes_and_types != nullptr) {
+        outputs[i].has_handle_data = true;
+        for (const ShapeAndType& shape_and_type : *shapes_and_types) {
+          TensorShapeProto proto;
+          c->ShapeHandleToProto(shape_and_type.shape, &proto);
+          outputs[i].handle_shapes_and_types.emplace_back(
+              std::move(proto), shape_and_type.dtype);
+        }
+      }
+    }
+    function_output_shapes_[shapes_key] = std::move(outputs);
+  }
+
   return inference_status;
 }
 
+string ShapeRefiner::FunctionShapesKey(const FunctionDef* function_def,
+                                       AttrSlice attributes,
+                                       InferenceContext* context) {
+  // The FunctionDef is owned by the function library, which outlives the
+  // refiner.
+  string key = strings::StrCat(reinterpret_cast<uintptr_t>(function_def), ":",
+                               Canonicalize(function_def->signature().name(),
+                                            attributes));
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    strings::StrAppend(&key, ";", context->DebugString(context->input(i)));
+    const std::vector<ShapeAndType>* shapes_and_types =
+        context->input_handle_shapes_and_types(i);
+    if (shapes_and_types != nullptr) {
+      for (const ShapeAndType& shape_and_type : *shapes_and_types) {
+        strings::StrAppend(&key, ",", DataTypeString(shape_and_type.dtype),
+                           context->DebugString(shape_and_type.shape));
+      }
+    }
+  }
+  return key;
+}
+
 Status ShapeRefiner::AddNode(const Node* node) {
   // For each 'input' of this node, fetch the corresponding shape
   // from 'input's InferenceContext, and store into a vector
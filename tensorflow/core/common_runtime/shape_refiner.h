@@ -215,6 +215,12 @@ class ShapeRefiner {
                                 AttrSlice attributes, bool keep_nested_shapes,
                                 ExtendedInferenceContext* outer_context);
 
+  // Returns the key of the function_output_shapes_ entry for a call of
+  // 'function_def' with 'attributes' and the input shapes of 'outer_context'.
+  static string FunctionShapesKey(const FunctionDef* function_def,
+                                  AttrSlice attributes,
+                                  shape_inference::InferenceContext* context);
+
   // Attempts to evaluate the 'dst_idx'-th input to 'node'. If the input edge
   // value can be evaluated, 'evaluated' is set to true and the value returned
   // in 'result'. Otherwise 'evaluated' is set to false.
@@ -298,6 +304,19 @@ class ShapeRefiner {
   std::unordered_map<const FunctionDef*, std::unique_ptr<const Graph>>
       functions_;
 
+  // The inferred shapes of an output of a function call.
+  struct FunctionOutputShapes {
+    TensorShapeProto shape;
+    bool has_handle_data = false;
+    std::vector<std::pair<TensorShapeProto, DataType>> handle_shapes_and_types;
+  };
+  // Caches the output shapes of the function calls inferred without keeping
+  // the nested inferences, keyed by FunctionShapesKey(). The calls of a
+  // function with the same input shapes reuse them instead of running the
+  // inference on the function body again.
+  std::unordered_map<string, std::vector<FunctionOutputShapes>>
+      function_output_shapes_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ShapeRefiner);
 };
 
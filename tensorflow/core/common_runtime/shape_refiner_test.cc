@@ -1434,6 +1434,35 @@ TEST_F(ShapeRefinerTest, SimpleFunctionShapeInference_WithNesting) {
                               true /* keep_nested_inferences */);
 }
 
+TEST_F(ShapeRefinerTest, RepeatedFunctionCallShapeInference) {
+  FunctionDefLibrary f_lib_proto;
+  *(f_lib_proto.add_function()) = test::function::XTimesTwo();
+  FunctionLibraryDefinition f_lib(OpRegistry::Global(), f_lib_proto);
+
+  Scope root = Scope::NewRootScope();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto x = ops::Const(root, {{1.0f, 2.0f}});
+  auto y = ops::Const(root, {{1.0f}, {2.0f}, {3.0f}});
+  auto x2 = test::function::Call(&root, "x2", "XTimesTwo", {x});
+  auto x2_again = test::function::Call(&root, "x2_again", "XTimesTwo", {x});
+  auto y2 = test::function::Call(&root, "y2", "XTimesTwo", {y});
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, &f_lib);
+  m.set_function_library_for_shape_inference(&f_lib);
+
+  TF_ASSERT_OK(m.AddNode(x.node()));
+  TF_ASSERT_OK(m.AddNode(y.node()));
+  TF_ASSERT_OK(m.AddNode(x2.node()));
+  TF_ASSERT_OK(m.AddNode(x2_again.node()));
+  TF_ASSERT_OK(m.AddNode(y2.node()));
+
+  // The second call with the same input shapes reuses the inferred shapes,
+  // and a call with other input shapes doesn't.
+  EXPECT_SHAPE("[1,2]", m, x2, 0);
+  EXPECT_SHAPE("[1,2]", m, x2_again, 0);
+  EXPECT_SHAPE("[3,1]", m, y2, 0);
+}
+
 TEST_F(ShapeRefinerTest, FunctionShapeInferenceFallback) {
   // Test that function inference falls back to returning unknown shapes,
   // if the function lookup fails.
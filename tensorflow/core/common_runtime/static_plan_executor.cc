@@ -0,0 +1,412 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_plan_executor.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/tensor_slice_reader_cache.h"
+
+namespace tensorflow {
+namespace {
+
+typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
+typedef gtl::InlinedVector<DeviceContext*, 4> DeviceContextVec;
+typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
+
+class StaticPlanExecutorImpl : public Executor {
+ public:
+  StaticPlanExecutorImpl(const LocalExecutorParams& params,
+                         std::unique_ptr<const Graph> graph)
+      : params_(params), graph_(std::move(graph)) {}
+
+  ~StaticPlanExecutorImpl() override {
+    for (const KernelState& kernel_state : kernels_) {
+      params_.delete_kernel(kernel_state.kernel);
+    }
+  }
+
+  Status Initialize();
+
+  void RunAsync(const Args& args, DoneCallback done) override {
+    // The plan runs on a single thread, so hand the whole step to the runner
+    // once. This keeps RunAsync() non-blocking, which matters when several
+    // executors of one step communicate through the rendezvous.
+    if (args.runner == nullptr) {
+      done(RunPlanAndAbortOnError(args));
+      return;
+    }
+    args.runner([this, args, done]() { done(RunPlanAndAbortOnError(args)); });
+  }
+
+ private:
+  // One entry of the plan.
+  struct KernelState {
+    OpKernel* kernel = nullptr;
+    const Node* node = nullptr;
+
+    // The inputs of this kernel are input_slots[input_start, input_start +
+    // num_inputs) in the per-step input array.
+    int input_start = 0;
+    int num_inputs = 0;
+    int num_outputs = 0;
+
+    // output_locations[i] lists the input slots fed by the i-th output.
+    std::vector<gtl::InlinedVector<int, 2>> output_locations;
+
+    // Whether the i-th input is of reference type.
+    gtl::InlinedVector<bool, 4> input_is_ref;
+
+    // Passed to OpKernelContext::Params::output_attr_array.
+    AllocatorAttributeVec output_alloc_attrs;
+  };
+
+  // A value flowing along an edge: either a tensor or a reference to a
+  // tensor guarded by a mutex.
+  struct Entry {
+    Tensor val;
+    Tensor* ref = nullptr;
+    mutex* ref_mu = nullptr;
+    bool has_value = false;
+
+    void Clear() {
+      val = Tensor();
+      ref = nullptr;
+      ref_mu = nullptr;
+      has_value = false;
+    }
+  };
+
+  Status RunPlan(const Args& args) const;
+
+  // Runs the plan and, if it fails, aborts the rendezvous and the rest of
+  // the step as the default executor does, so that executors on the other
+  // side of a Send/Recv do not wait forever.
+  Status RunPlanAndAbortOnError(const Args& args) const {
+    Status s = RunPlan(args);
+    if (!s.ok()) {
+      VLOG(1) << "[" << params_.device->name()
+              << "] Static plan executor aborting: " << s;
+      if (args.rendezvous) args.rendezvous->StartAbort(s);
+      if (args.collective_executor) args.collective_executor->StartAbort(s);
+      if (args.cancellation_manager) args.cancellation_manager->StartCancel();
+    }
+    return s;
+  }
+
+  const LocalExecutorParams params_;
+  // Owned. The plan refers to its nodes.
+  const std::unique_ptr<const Graph> graph_;
+
+  // The kernels of the graph, in topological order.
+  std::vector<KernelState> kernels_;
+
+  // Total number of inputs over all kernels, i.e. the size of the per-step
+  // input array.
+  int total_num_inputs_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticPlanExecutorImpl);
+};
+
+Status StaticPlanExecutorImpl::Initialize() {
+  const Graph& graph = *graph_;
+  if (params_.device->device_type() != DEVICE_CPU) {
+    return errors::Unimplemented(
+        "The static plan executor only supports CPU devices, but the graph is "
+        "placed on ",
+        params_.device->name());
+  }
+
+  std::vector<Node*> ordered_nodes;
+  ordered_nodes.reserve(graph.num_nodes());
+  GetReversePostOrder(graph, &ordered_nodes);
+
+  // Maps node ids to their position in kernels_.
+  std::vector<int> node_to_kernel(graph.num_node_ids(), -1);
+  kernels_.reserve(ordered_nodes.size());
+  for (const Node* n : ordered_nodes) {
+    if (n->IsSource() || n->IsSink()) continue;
+    if (IsControlFlow(n)) {
+      return errors::Unimplemented(
+          "The static plan executor does not support control flow, but the "
+          "graph contains ",
+          FormatNodeForError(*n));
+    }
+
+    KernelState kernel_state;
+    kernel_state.node = n;
+    kernel_state.input_start = total_num_inputs_;
+    kernel_state.num_inputs = n->num_inputs();
+    kernel_state.num_outputs = n->num_outputs();
+    kernel_state.output_locations.resize(n->num_outputs());
+    kernel_state.output_alloc_attrs.resize(n->num_outputs());
+    for (int i = 0; i < n->num_inputs(); ++i) {
+      kernel_state.input_is_ref.push_back(IsRefType(n->input_type(i)));
+    }
+    TF_RETURN_IF_ERROR(params_.create_kernel(n->def(), &kernel_state.kernel));
+
+    node_to_kernel[n->id()] = kernels_.size();
+    total_num_inputs_ += n->num_inputs();
+    kernels_.push_back(std::move(kernel_state));
+  }
+
+  for (KernelState& kernel_state : kernels_) {
+    for (const Edge* e : kernel_state.node->out_edges()) {
+      if (e->IsControlEdge() || e->dst()->IsSink()) continue;
+      const int dst_kernel = node_to_kernel[e->dst()->id()];
+      DCHECK_GE(dst_kernel, 0);
+      kernel_state.output_locations[e->src_output()].push_back(
+          kernels_[dst_kernel].input_start + e->dst_input());
+    }
+  }
+
+  return Status::OK();
+}
+
+Status StaticPlanExecutorImpl::RunPlan(const Args& args) const {
+  // The input slots for every kernel. Slots are filled by their producer and
+  // cleared as soon as their consumer has run.
+  std::unique_ptr<Entry[]> inputs(new Entry[total_num_inputs_]);
+
+  Device* device = params_.device;
+  std::unique_ptr<Device> user_device;
+  if (args.user_intra_op_threadpool != nullptr) {
+    user_device = RenamedDevice::NewRenamedDevice(
+        device->name(), device, false, false, args.user_intra_op_threadpool);
+  }
+  checkpoint::TensorSliceReaderCacheWrapper slice_reader_cache;
+  Executor::Args::Runner runner = args.runner;
+
+  TensorValueVec node_inputs;
+  DeviceContextVec input_device_contexts;
+  AllocatorAttributeVec input_alloc_attrs;
+
+  OpKernelContext::Params params;
+  params.step_id = args.step_id;
+  params.device = user_device ? user_device.get() : device;
+  params.rendezvous = args.rendezvous;
+  params.create_rendezvous = &params_.rendezvous_factory;
+  params.collective_executor = args.collective_executor;
+  params.session_state = args.session_state;
+  params.session_handle = args.session_handle;
+  params.session_metadata = params_.session_metadata;
+  params.tensor_store = args.tensor_store;
+  params.cancellation_manager = args.cancellation_manager;
+  params.call_frame = args.call_frame;
+  params.function_library = params_.function_library;
+  params.resource_manager = device->resource_manager();
+  params.step_container = args.step_container;
+  params.step_arena = args.step_container != nullptr
+                          ? args.step_container->step_arena()
+                          : nullptr;
+  params.slice_reader_cache = &slice_reader_cache;
+  params.inputs = &node_inputs;
+  params.input_device_contexts = &input_device_contexts;
+  params.input_alloc_attrs = &input_alloc_attrs;
+  params.runner = &runner;
+  params.stats_collector = args.stats_collector;
+
+  for (const KernelState& kernel_state : kernels_) {
+    if (args.cancellation_manager != nullptr &&
+        args.cancellation_manager->IsCancelled()) {
+      return errors::Cancelled("Step was cancelled before running ",
+                               FormatNodeForError(*kernel_state.node));
+    }
+
+    // Gather the inputs of this kernel.
+    const int num_inputs = kernel_state.num_inputs;
+    Entry* first_input = inputs.get() + kernel_state.input_start;
+    node_inputs.clear();
+    node_inputs.resize(num_inputs);
+    input_device_contexts.clear();
+    input_device_contexts.resize(num_inputs, nullptr);
+    input_alloc_attrs.clear();
+    input_alloc_attrs.resize(num_inputs);
+    for (int i = 0; i < num_inputs; ++i) {
+      Entry* entry = first_input + i;
+      if (!entry->has_value) {
+        return errors::Internal("Missing input ", i, " of ",
+                                FormatNodeForError(*kernel_state.node));
+      }
+      if (kernel_state.input_is_ref[i]) {
+        if (entry->ref == nullptr) {
+          return errors::InvalidArgument(
+              i, "-th input expects a ref type: ",
+              FormatNodeForError(*kernel_state.node));
+        }
+        node_inputs[i] = TensorValue(entry->ref_mu, entry->ref);
+      } else {
+        if (entry->ref != nullptr) {
+          // Dereference the tensor under the lock.
+          tf_shared_lock l(*entry->ref_mu);
+          entry->val = *entry->ref;
+          entry->ref = nullptr;
+          entry->ref_mu = nullptr;
+        }
+        node_inputs[i].tensor = &entry->val;
+      }
+    }
+
+    NodeExecStatsInterface* stats = nullptr;
+    if (args.stats_collector != nullptr) {
+      stats = args.stats_collector->CreateNodeExecStats(kernel_state.node);
+    }
+    params.track_allocations = stats ? stats->TrackAllocations() : false;
+    params.op_kernel = kernel_state.kernel;
+    params.output_attr_array = kernel_state.output_alloc_attrs.data();
+    OpKernelContext ctx(&params, kernel_state.num_outputs);
+
+    if (stats) {
+      stats->RecordExecutorStarted();
+      stats->RecordComputeStarted();
+    }
+    AsyncOpKernel* async = kernel_state.kernel->AsAsync();
+    if (async != nullptr) {
+      Notification n;
+      device->ComputeAsync(async, &ctx, [&n]() { n.Notify(); });
+      n.WaitForNotification();
+    } else {
+      device->Compute(kernel_state.kernel, &ctx);
+    }
+    if (stats) {
+      stats->RecordComputeEnded();
+      stats->SetMemory(&ctx);
+    }
+
+    // The inputs are no longer needed; release them so that their buffers
+    // can be reused by later kernels.
+    for (int i = 0; i < num_inputs; ++i) {
+      (first_input + i)->Clear();
+    }
+
+    Status s = ctx.status();
+    if (!s.ok()) {
+      if (stats) {
+        stats->RecordExecutorEnded();
+        stats->Done(device->name());
+      }
+      return AttachDef(s, kernel_state.kernel->def());
+    }
+
+    // Move the outputs into the input slots of their consumers.
+    for (int i = 0; i < kernel_state.num_outputs; ++i) {
+      const TensorValue val = ctx.release_output(i);
+      const auto& locations = kernel_state.output_locations[i];
+      if (val.tensor == nullptr) {
+        if (!locations.empty() && !IsRecv(kernel_state.node)) {
+          s.Update(errors::Internal("Missing ", i, "-th output from ",
+                                    FormatNodeForError(*kernel_state.node)));
+        }
+        continue;
+      }
+      const DataType dtype = val.dtype_safe();
+      if (dtype != kernel_state.node->output_type(i)) {
+        s.Update(errors::Internal(
+            "Output ", i, " of type ", DataTypeString(dtype),
+            " does not match declared output type ",
+            DataTypeString(kernel_state.node->output_type(i)), " for node ",
+            FormatNodeForError(*kernel_state.node)));
+        if (!val.is_ref()) delete val.tensor;
+        continue;
+      }
+      if (stats && val.tensor->IsInitialized()) {
+        stats->SetOutput(i, val.tensor);
+      }
+      if (val.is_ref()) {
+        for (int location : locations) {
+          Entry* entry = inputs.get() + location;
+          entry->ref = val.tensor;
+          entry->ref_mu = val.mutex_if_ref;
+          entry->has_value = true;
+        }
+      } else {
+        const int num_locations = locations.size();
+        for (int j = 0; j < num_locations; ++j) {
+          Entry* entry = inputs.get() + locations[j];
+          if (j + 1 < num_locations) {
+            entry->val = *val.tensor;
+          } else {
+            // Move into the last consumer, so that it holds the only
+            // reference to the buffer if no other consumer needs it and may
+            // forward it to an output.
+            entry->val = std::move(*val.tensor);
+          }
+          entry->has_value = true;
+        }
+        delete val.tensor;
+      }
+    }
+    if (stats) {
+      stats->RecordExecutorEnded();
+      stats->Done(device->name());
+    }
+    TF_RETURN_IF_ERROR(s);
+  }
+
+  if (args.sync_on_finish) {
+    return device->Sync();
+  }
+  return Status::OK();
+}
+
+class StaticPlanExecutorRegistrar {
+ public:
+  StaticPlanExecutorRegistrar() {
+    ExecutorFactory::Register("STATIC_PLAN", new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params,
+                       std::unique_ptr<const Graph> graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(
+          NewStaticPlanExecutor(params, std::move(graph), &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static StaticPlanExecutorRegistrar registrar;
+
+}  // namespace
+
+Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                             std::unique_ptr<const Graph> graph,
+                             Executor** executor) {
+  std::unique_ptr<StaticPlanExecutorImpl> impl(
+      new StaticPlanExecutorImpl(params, std::move(graph)));
+  TF_RETURN_IF_ERROR(impl->Initialize());
+  *executor = impl.release();
+  return Status::OK();
+}
+
+}  // namespace tensorflow
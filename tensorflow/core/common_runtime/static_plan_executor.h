@@ -0,0 +1,51 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
+
+#include "tensorflow/core/common_runtime/executor.h"
+
+namespace tensorflow {
+
+// Creates an Executor that computes the given "graph" by replaying a plan
+// that is computed once, when the executor is created.
+//
+// The plan is a topological order of the kernels in "graph", together with
+// the input slot that each output edge feeds. Running a step walks the plan
+// on a single thread, moving each output into the input slots of its
+// consumers. No pending counts, frames, or ready queues are maintained, so
+// the per-node cost is much lower than that of the default executor, at the
+// cost of running independent nodes one after another.
+//
+// Only graphs that satisfy the following are supported; NewStaticPlanExecutor
+// returns an error otherwise:
+//   * the graph is placed on a CPU device;
+//   * the graph has no control flow (Switch, Merge, Enter, Exit or
+//     NextIteration nodes).
+//
+// Asynchronous kernels are supported, but the executor blocks until each
+// one completes before moving on to the next node.
+//
+// The executor is registered under the type "STATIC_PLAN", so a
+// DirectSession uses it when
+// ConfigProto.experimental.executor_type == "STATIC_PLAN".
+::tensorflow::Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                                           std::unique_ptr<const Graph> graph,
+                                           Executor** executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
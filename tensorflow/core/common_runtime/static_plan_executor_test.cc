@@ -0,0 +1,200 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_plan_executor.h"
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+#define ALICE "/job:j/replica:0/task:0/cpu:0"
+#define BOB "/job:j/replica:0/task:0/device:CPU:0"
+
+class StaticPlanExecutorTest : public ::testing::Test {
+ protected:
+  StaticPlanExecutorTest()
+      : device_(DeviceFactory::NewDevice("CPU", {},
+                                         "/job:localhost/replica:0/task:0")) {
+    SessionOptions options;
+    thread_pool_ = ComputePool(options);
+  }
+
+  ~StaticPlanExecutorTest() override {
+    // There should always be exactly one Ref left on the Rendezvous
+    // when the test completes.
+    if (rendez_ != nullptr) CHECK(rendez_->Unref());
+  }
+
+  // Resets exec_ with a new executor for 'graph'.
+  Status Create(std::unique_ptr<const Graph> graph) {
+    const int version = graph->versions().producer();
+    LocalExecutorParams params;
+    params.device = device_.get();
+    params.create_kernel = [this, version](const NodeDef& ndef,
+                                           OpKernel** kernel) {
+      return CreateNonCachedKernel(device_.get(), nullptr, ndef, version,
+                                   kernel);
+    };
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+    if (rendez_ == nullptr) rendez_ = NewLocalRendezvous();
+    exec_.reset();
+    return NewExecutor("STATIC_PLAN", params, std::move(graph), &exec_);
+  }
+
+  Status Run() {
+    Executor::Args args;
+    args.rendezvous = rendez_;
+    args.runner = [this](std::function<void()> fn) {
+      thread_pool_->Schedule(fn);
+    };
+    return exec_->Run(args);
+  }
+
+  Rendezvous::ParsedKey Key(const string& sender, const string& receiver,
+                            const string& name) {
+    Rendezvous::ParsedKey result;
+    TF_CHECK_OK(Rendezvous::ParseKey(
+        Rendezvous::CreateKey(sender, 1, receiver, name, FrameAndIter(0, 0)),
+        &result));
+    return result;
+  }
+
+  void Feed(const string& name, float val) {
+    Tensor t(DT_FLOAT, TensorShape({}));
+    t.scalar<float>()() = val;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(ALICE, BOB, name), Rendezvous::Args(), t, false));
+  }
+
+  float Fetch(const string& name) {
+    Tensor out;
+    bool is_dead = false;
+    TF_CHECK_OK(rendez_->Recv(Key(BOB, ALICE, name), Rendezvous::Args(), &out,
+                              &is_dead));
+    CHECK(!is_dead);
+    return out.scalar<float>()();
+  }
+
+  thread::ThreadPool* thread_pool_ = nullptr;
+  std::unique_ptr<Device> device_;
+  std::unique_ptr<Executor> exec_;
+  Rendezvous* rendez_ = nullptr;
+};
+
+TEST_F(StaticPlanExecutorTest, SimpleAdd) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, BOB);
+  auto tmp = test::graph::Add(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  TF_ASSERT_OK(Create(std::move(g)));
+  Feed("a", 1.0);
+  Feed("b", 2.0);
+  TF_ASSERT_OK(Run());
+  EXPECT_EQ(3.0, Fetch("c"));
+}
+
+TEST_F(StaticPlanExecutorTest, FanOutAndRepeatedRuns) {
+  // v0 <- a
+  // v(i) = v(i-1) + v(i-1)
+  // Every output feeds two input slots of the same consumer, so each step
+  // exercises both the copy and the move path.
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  for (int i = 1; i <= 10; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+  TF_ASSERT_OK(Create(std::move(g)));
+  for (int step = 1; step <= 3; ++step) {
+    Feed("a", step);
+    TF_ASSERT_OK(Run());
+    EXPECT_EQ(1024.0 * step, Fetch("b"));
+  }
+}
+
+TEST_F(StaticPlanExecutorTest, ReferenceInputs) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  Tensor one(DT_FLOAT, TensorShape({}));
+  one.scalar<float>()() = 1.0;
+  auto c = test::graph::Constant(g.get(), one);
+  auto var = test::graph::Var(g.get(), DT_FLOAT, TensorShape({}));
+  auto assign = test::graph::Assign(g.get(), var, c);
+  auto add = test::graph::Add(g.get(), assign, c);
+  test::graph::Send(g.get(), add, "out", BOB, 1, ALICE);
+  TF_ASSERT_OK(Create(std::move(g)));
+  TF_ASSERT_OK(Run());
+  EXPECT_EQ(2.0, Fetch("out"));
+}
+
+TEST_F(StaticPlanExecutorTest, KernelErrorIsReported) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  // The Recv expects a float, but an int is sent.
+  test::graph::Send(g.get(), in0, "b", BOB, 1, ALICE);
+  TF_ASSERT_OK(Create(std::move(g)));
+  Tensor t(DT_INT32, TensorShape({}));
+  t.scalar<int32>()() = 1;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, BOB, "a"), Rendezvous::Args(), t, false));
+  EXPECT_TRUE(errors::IsInternal(Run()));
+}
+
+TEST_F(StaticPlanExecutorTest, RejectsControlFlow) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  Tensor pred(DT_BOOL, TensorShape({}));
+  pred.scalar<bool>()() = true;
+  auto in1 = test::graph::Constant(g.get(), pred);
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Status s = Create(std::move(g));
+  EXPECT_TRUE(errors::IsUnimplemented(s)) << s;
+}
+
+static void BM_StaticPlanExecutor(int iters, int depth) {
+  testing::StopTiming();
+  // A chain of 'depth' cheap ops, where per-node overhead dominates.
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor one(DT_FLOAT, TensorShape({}));
+  one.scalar<float>()() = 1.0;
+  Node* v = test::graph::Constant(g, one);
+  for (int i = 0; i < depth; ++i) {
+    v = test::graph::Identity(g, v);
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * depth);
+  testing::StartTiming();
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, "STATIC_PLAN")
+      .Run(iters);
+}
+BENCHMARK(BM_StaticPlanExecutor)->Arg(16)->Arg(1024);
+
+}  // namespace
+}  // namespace tensorflow
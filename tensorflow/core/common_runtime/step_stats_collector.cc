@@ -138,6 +138,10 @@ void NodeExecStatsWrapper::SetScheduled(int64 nanos) {
   stats_->set_scheduled_nanos(nanos);
 }
 
+void NodeExecStatsWrapper::SetRanInline(bool ran_inline) {
+  stats_->set_ran_inline(ran_inline);
+}
+
 void NodeExecStatsWrapper::SetMemory(OpKernelContext* ctx) {
   for (const auto& allocator_pair : ctx->ConsumeWrappedAllocators()) {
     AddAllocation(allocator_pair.first, allocator_pair.second);
@@ -88,6 +88,10 @@ class NodeExecStatsInterface {
   // Records the absolute time in nanoseconds at which this node became
   // runnable (i.e. was scheduled for execution).
   virtual void SetScheduled(int64 nanos) = 0;
+
+  // Records whether the executor ran this node inline on the thread that
+  // made it runnable, rather than dispatching it to another thread.
+  virtual void SetRanInline(bool ran_inline) = 0;
 };
 
 // Wraps NodeExecStats and adds allocation to it.
@@ -114,6 +118,7 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
   void SetOutput(int slot, const Tensor* tensor) override;
   void SetReferencedTensors(const TensorReferenceVector& tensors) override;
   void SetScheduled(int64 nanos) override;
+  void SetRanInline(bool ran_inline) override;
 
  private:
   friend class StepStatsCollector;
@@ -0,0 +1,114 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A bounded double-ended queue that is owned by one worker and can be
+// stolen from by others.
+//
+// The owner pushes and pops at the back, so the most recently produced
+// item (typically a successor of the node that was just run) is executed
+// next on the same thread while its inputs are still in cache. Thieves take
+// from the front, which holds the oldest and usually largest pieces of work.
+//
+// Storage is a ring buffer that grows on demand up to `capacity`, so an
+// idle queue costs no memory beyond the object itself. All operations take
+// the queue's own mutex; since every worker has its own queue, that mutex is
+// only contended when another worker is stealing.
+template <typename T>
+class WorkStealingQueue {
+ public:
+  explicit WorkStealingQueue(size_t capacity) : capacity_(capacity) {
+    DCHECK_GT(capacity, 0);
+  }
+
+  // Pushes `item` onto the back of the queue. Returns false, leaving the
+  // queue unchanged, if the queue already holds `capacity` items.
+  bool PushBack(const T& item) {
+    mutex_lock l(mu_);
+    if (size_ == capacity_) return false;
+    if (size_ == buffer_.size()) Grow();
+    buffer_[(head_ + size_) % buffer_.size()] = item;
+    ++size_;
+    return true;
+  }
+
+  // Removes the most recently pushed item and stores it in `*item`. Returns
+  // false if the queue is empty. Intended for use by the owning worker.
+  bool PopBack(T* item) {
+    mutex_lock l(mu_);
+    if (size_ == 0) return false;
+    --size_;
+    *item = buffer_[(head_ + size_) % buffer_.size()];
+    return true;
+  }
+
+  // Removes the oldest item and stores it in `*item`. Returns false if the
+  // queue is empty. Intended for use by workers stealing from this queue.
+  bool PopFront(T* item) {
+    mutex_lock l(mu_);
+    if (size_ == 0) return false;
+    *item = buffer_[head_];
+    head_ = (head_ + 1) % buffer_.size();
+    --size_;
+    return true;
+  }
+
+  size_t Size() const {
+    mutex_lock l(mu_);
+    return size_;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  // Doubles the ring buffer (bounded by capacity_), unrolling the live
+  // entries so that they start at index 0.
+  void Grow() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    size_t new_size = buffer_.empty() ? 8 : 2 * buffer_.size();
+    if (new_size > capacity_) new_size = capacity_;
+    std::vector<T> new_buffer(new_size);
+    for (size_t i = 0; i < size_; ++i) {
+      new_buffer[i] = buffer_[(head_ + i) % buffer_.size()];
+    }
+    buffer_.swap(new_buffer);
+    head_ = 0;
+  }
+
+  const size_t capacity_;
+  mutable mutex mu_;
+  std::vector<T> buffer_ GUARDED_BY(mu_);
+  size_t head_ GUARDED_BY(mu_) = 0;
+  size_t size_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingQueue);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
@@ -0,0 +1,113 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingQueueTest, OwnerIsLifoThiefIsFifo) {
+  WorkStealingQueue<int> q(16);
+  EXPECT_TRUE(q.Empty());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(q.PushBack(i));
+  }
+  EXPECT_EQ(4, q.Size());
+  int v = -1;
+  EXPECT_TRUE(q.PopBack(&v));
+  EXPECT_EQ(3, v);
+  EXPECT_TRUE(q.PopFront(&v));
+  EXPECT_EQ(0, v);
+  EXPECT_TRUE(q.PopFront(&v));
+  EXPECT_EQ(1, v);
+  EXPECT_TRUE(q.PopBack(&v));
+  EXPECT_EQ(2, v);
+  EXPECT_FALSE(q.PopBack(&v));
+  EXPECT_FALSE(q.PopFront(&v));
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(WorkStealingQueueTest, Bounded) {
+  WorkStealingQueue<int> q(3);
+  EXPECT_TRUE(q.PushBack(1));
+  EXPECT_TRUE(q.PushBack(2));
+  EXPECT_TRUE(q.PushBack(3));
+  EXPECT_FALSE(q.PushBack(4));
+  EXPECT_EQ(3, q.Size());
+  int v = -1;
+  EXPECT_TRUE(q.PopFront(&v));
+  EXPECT_EQ(1, v);
+  EXPECT_TRUE(q.PushBack(4));
+  EXPECT_FALSE(q.PushBack(5));
+}
+
+TEST(WorkStealingQueueTest, GrowsAcrossWrapAround) {
+  WorkStealingQueue<int> q(100);
+  int v = -1;
+  // Move the head away from index 0 before the buffer has to grow, so that
+  // growing has to unroll a wrapped ring.
+  for (int i = 0; i < 6; ++i) EXPECT_TRUE(q.PushBack(i));
+  for (int i = 0; i < 5; ++i) EXPECT_TRUE(q.PopFront(&v));
+  for (int i = 6; i < 40; ++i) EXPECT_TRUE(q.PushBack(i));
+  for (int i = 5; i < 40; ++i) {
+    EXPECT_TRUE(q.PopFront(&v));
+    EXPECT_EQ(i, v);
+  }
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(WorkStealingQueueTest, ConcurrentOwnerAndThieves) {
+  const int kItems = 10000;
+  const int kThieves = 4;
+  WorkStealingQueue<int> q(kItems);
+  std::atomic<int64> sum(0);
+  std::atomic<int> taken(0);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kThieves + 1);
+    pool.Schedule([&q, &sum, &taken]() {
+      for (int i = 1; i <= kItems; ++i) {
+        ASSERT_TRUE(q.PushBack(i));
+        int v;
+        if (i % 3 == 0 && q.PopBack(&v)) {
+          sum += v;
+          ++taken;
+        }
+      }
+    });
+    for (int t = 0; t < kThieves; ++t) {
+      pool.Schedule([&q, &sum, &taken]() {
+        while (taken.load() < kItems) {
+          int v;
+          if (q.PopFront(&v)) {
+            sum += v;
+            ++taken;
+          }
+        }
+      });
+    }
+  }
+  EXPECT_EQ(kItems, taken.load());
+  EXPECT_EQ(static_cast<int64>(kItems) * (kItems + 1) / 2, sum.load());
+}
+
+}  // namespace
+}  // namespace tensorflow
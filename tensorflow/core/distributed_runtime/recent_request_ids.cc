@@ -15,17 +15,31 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/recent_request_ids.h"
 
+#include <algorithm>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 
-RecentRequestIds::RecentRequestIds(int num_tracked_request_ids)
-    : circular_buffer_(num_tracked_request_ids) {
-  set_.reserve(num_tracked_request_ids);
+RecentRequestIds::RecentRequestIds(int num_tracked_request_ids,
+                                   int num_shards) {
+  num_shards = std::max(1, std::min(num_shards, num_tracked_request_ids));
+  // Round up, so that at least num_tracked_request_ids are tracked overall.
+  const int shard_size =
+      (num_tracked_request_ids + num_shards - 1) / num_shards;
+  shards_.reserve(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    auto shard = absl::make_unique<Shard>();
+    mutex_lock l(shard->mu);
+    shard->circular_buffer.resize(shard_size);
+    shard->set.reserve(shard_size);
+    shards_.push_back(std::move(shard));
+  }
 }
 
 bool RecentRequestIds::Insert(int64 request_id) {
@@ -34,22 +48,28 @@ bool RecentRequestIds::Insert(int64 request_id) {
     return true;
   }
 
-  mutex_lock l(mu_);
-  const bool inserted = set_.insert(request_id).second;
+  Shard& shard =
+      shards_.size() == 1
+          ? *shards_[0]
+          : *shards_[Hash64(reinterpret_cast<const char*>(&request_id),
+                            sizeof(request_id)) %
+                     shards_.size()];
+  mutex_lock l(shard.mu);
+  const bool inserted = shard.set.insert(request_id).second;
   if (!inserted) {
     // Note: RecentRequestIds is not strict LRU because we don't update
-    // request_id's age in the circular_buffer_ if it's tracked again. Strict
+    // request_id's age in the circular_buffer if it's tracked again. Strict
     // LRU is not useful here because returning this error will close the
     // current Session.
     return false;
   }
 
-  // Remove the oldest request_id from the set_. circular_buffer_ is
+  // Remove the oldest request_id from the set. circular_buffer is
   // zero-initialized, and zero is never tracked, so it's safe to do this even
   // when the buffer is not yet full.
-  set_.erase(circular_buffer_[next_index_]);
-  circular_buffer_[next_index_] = request_id;
-  next_index_ = (next_index_ + 1) % circular_buffer_.size();
+  shard.set.erase(shard.circular_buffer[shard.next_index]);
+  shard.circular_buffer[shard.next_index] = request_id;
+  shard.next_index = (shard.next_index + 1) % shard.circular_buffer.size();
   return true;
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECENT_REQUEST_IDS_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECENT_REQUEST_IDS_H_
 
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -45,13 +46,19 @@ namespace tensorflow {
 // buffer tracks the oldest request_id. When the buffer is full, the new
 // request_id replaces the oldest request_id in the circular buffer, and the
 // oldest request_id is removed from the set.
+//
+// To reduce lock contention, the request_ids can be split by hash into
+// num_shards shards that each track num_tracked_request_ids / num_shards of
+// them under their own lock. The oldest request_id of the shard is then evicted
+// rather than the oldest one overall, which makes no difference for request_ids
+// from GetUniqueRequestId(), as they are spread evenly over the shards.
 class RecentRequestIds {
  public:
   // num_tracked_request_ids should be much larger than the number of RPCs that
   // can be received in a small time window. For example, we observed a peak RPC
   // rate of ~700 RecvTensor RPC/s when training inception v3 on TPUs, so we
   // currently set num_tracked_request_ids to 100,000 for RecvTensor.
-  RecentRequestIds(int num_tracked_request_ids);
+  explicit RecentRequestIds(int num_tracked_request_ids, int num_shards = 1);
 
   // Returns OK iff request_id has not been seen in the last
   // num_tracked_request_ids insertions. For backwards compatibility, this
@@ -65,15 +72,19 @@ class RecentRequestIds {
                      const RequestWrapper* wrapper);
 
  private:
+  struct Shard {
+    mutex mu;
+    // next_index indexes into circular_buffer, and points to the next storage
+    // space to use. When the buffer is full, next_index points at the oldest
+    // request_id.
+    int next_index GUARDED_BY(mu) = 0;
+    std::vector<int64> circular_buffer GUARDED_BY(mu);
+    std::unordered_set<int64> set GUARDED_BY(mu);
+  };
+
   bool Insert(int64 request_id);
 
-  mutex mu_;
-  // next_index_ indexes into circular_buffer_, and points to the next storage
-  // space to use. When the buffer is full, next_index_ points at the oldest
-  // request_id.
-  int next_index_ GUARDED_BY(mu_) = 0;
-  std::vector<int64> circular_buffer_ GUARDED_BY(mu_);
-  std::unordered_set<int64> set_ GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Shard>> shards_;
 };
 
 // Implementation details
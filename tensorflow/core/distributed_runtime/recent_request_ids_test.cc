@@ -95,6 +95,27 @@ TEST(RecentRequestIds, Ordered3) { TestOrdered(3); }
 TEST(RecentRequestIds, Ordered4) { TestOrdered(4); }
 TEST(RecentRequestIds, Ordered5) { TestOrdered(5); }
 
+TEST(RecentRequestIds, Sharded) {
+  RecentRequestIds recent_request_ids(1000, /*num_shards=*/8);
+  std::vector<int64> request_ids;
+  for (int i = 0; i < 100; ++i) {
+    request_ids.push_back(GetUniqueRequestId());
+    TF_EXPECT_OK(TrackUnique(request_ids.back(), &recent_request_ids));
+  }
+  for (int64 request_id : request_ids) {
+    EXPECT_FALSE(TrackUnique(request_id, &recent_request_ids).ok());
+  }
+}
+
+TEST(RecentRequestIds, MoreShardsThanRequestIds) {
+  // Falls back to a single shard, which evicts the oldest request_id.
+  RecentRequestIds recent_request_ids(1, /*num_shards=*/8);
+  TF_EXPECT_OK(TrackUnique(1, &recent_request_ids));
+  EXPECT_FALSE(TrackUnique(1, &recent_request_ids).ok());
+  TF_EXPECT_OK(TrackUnique(2, &recent_request_ids));
+  TF_EXPECT_OK(TrackUnique(1, &recent_request_ids));
+}
+
 void BM_TrackUnique(int iters) {
   RecentRequestIds recent_request_ids(100000);
   RecvTensorRequest request;
@@ -106,4 +127,15 @@ void BM_TrackUnique(int iters) {
 
 BENCHMARK(BM_TrackUnique);
 
+void BM_TrackUniqueSharded(int iters) {
+  RecentRequestIds recent_request_ids(100000, /*num_shards=*/32);
+  RecvTensorRequest request;
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(recent_request_ids.TrackUnique(
+        GetUniqueRequestId(), "BM_TrackUniqueSharded", request));
+  }
+}
+
+BENCHMARK(BM_TrackUniqueSharded);
+
 }  // namespace tensorflow
@@ -22,9 +22,13 @@ limitations under the License.
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/async_stream.h"
 #include "grpcpp/support/async_unary_call.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_call_metrics.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 
 namespace tensorflow {
 
@@ -107,6 +111,10 @@ class UntypedCall : public core::RefCounted {
   // the `grpc::ServerContext` associated with the request.
   virtual void RequestCancelled(Service* service, bool ok) = 0;
 
+  // This method will be called when the response has been sent, or failed
+  // to be sent if `ok` is false.
+  virtual void ResponseSent(bool ok) {}
+
   // Associates a tag in a `::grpc::CompletionQueue` with a callback
   // for an incoming RPC.  An active Tag owns a reference on the corresponding
   // Call object.
@@ -126,7 +134,7 @@ class UntypedCall : public core::RefCounted {
           call_->RequestReceived(service, ok);
           break;
         case kResponseSent:
-          // No special handling needed apart from the Unref below.
+          call_->ResponseSent(ok);
           break;
         case kCancelled:
           call_->RequestCancelled(service, ok);
@@ -141,6 +149,14 @@ class UntypedCall : public core::RefCounted {
   };
 };
 
+// Returns the serialized size of a request or response message.
+inline size_t GrpcMessageBytes(const protobuf::Message& message) {
+  return message.ByteSizeLong();
+}
+inline size_t GrpcMessageBytes(const ::grpc::ByteBuffer& buffer) {
+  return buffer.Length();
+}
+
 // Represents a pending call with known request and response message
 // types, and a known request-handling method.
 template <class Service, class GrpcService, class RequestMessage,
@@ -167,17 +183,51 @@ class Call : public UntypedCall<Service> {
 
   void RequestReceived(Service* service, bool ok) override {
     if (ok) {
+      if (metrics_ != nullptr) {
+        received_micros_ = Env::Default()->NowMicros();
+        handler_start_micros_ = received_micros_;
+        metrics_->request_bytes->Add(GrpcMessageBytes(request));
+      }
       this->Ref();
       (service->*handle_request_function_)(this);
     }
   }
 
+  // Records that the handler of this call starts running now.  Handlers that
+  // defer their work, e.g. to a thread pool, call this once the work starts
+  // so that the wait is reported as queueing time; otherwise the handler is
+  // assumed to have started when the request was received.
+  void RecordHandlerStarted() {
+    if (metrics_ != nullptr) {
+      handler_start_micros_ = Env::Default()->NowMicros();
+    }
+  }
+
   void SendResponse(::grpc::Status status) {
+    if (metrics_ != nullptr) {
+      send_response_micros_ = Env::Default()->NowMicros();
+      metrics_->queue_time_usecs->Add(handler_start_micros_ -
+                                      received_micros_);
+      metrics_->handler_time_usecs->Add(send_response_micros_ -
+                                        handler_start_micros_);
+      response_ok_ = status.ok();
+    }
     this->Ref();  // Ref for grpc; released in Tag callback.
     responder_.Finish(response, status, &response_sent_tag_);
     this->Unref();
   }
 
+  void ResponseSent(bool ok) override {
+    if (metrics_ != nullptr && ok) {
+      metrics_->response_time_usecs->Add(Env::Default()->NowMicros() -
+                                         send_response_micros_);
+      // No response message is sent with an error status.
+      if (response_ok_) {
+        metrics_->response_bytes->Add(GrpcMessageBytes(response));
+      }
+    }
+  }
+
   void RequestCancelled(Service* service, bool ok) override {
     if (ctx_.IsCancelled()) {
       mutex_lock l(mu_);
@@ -204,14 +254,16 @@ class Call : public UntypedCall<Service> {
   // completion queue, using the given `enqueue_function`.
   //
   // The request will be handled with the given
-  // `handle_request_function`.
+  // `handle_request_function`, and recorded in `metrics` if it is not null.
   static void EnqueueRequest(GrpcService* grpc_service,
                              ::grpc::ServerCompletionQueue* cq,
                              EnqueueFunction enqueue_function,
                              HandleRequestFunction handle_request_function,
-                             bool supports_cancel) {
+                             bool supports_cancel,
+                             GrpcCallMetrics* metrics = nullptr) {
     auto call = new Call<Service, GrpcService, RequestMessage, ResponseMessage>(
         handle_request_function);
+    call->metrics_ = metrics;
     if (supports_cancel) {
       call->RegisterCancellationHandler();
     }
@@ -226,13 +278,14 @@ class Call : public UntypedCall<Service> {
   // completion queue, using the given `method_id`.
   //
   // The request will be handled with the given
-  // `handle_request_function`.
+  // `handle_request_function`, and recorded in `metrics` if it is not null.
   static void EnqueueRequestForMethod(
       GrpcService* grpc_service, ::grpc::ServerCompletionQueue* cq,
       int method_id, HandleRequestFunction handle_request_function,
-      bool supports_cancel) {
+      bool supports_cancel, GrpcCallMetrics* metrics = nullptr) {
     auto call = new Call<Service, GrpcService, RequestMessage, ResponseMessage>(
         handle_request_function);
+    call->metrics_ = metrics;
     if (supports_cancel) {
       call->RegisterCancellationHandler();
     }
@@ -271,6 +324,14 @@ class Call : public UntypedCall<Service> {
   Tag response_sent_tag_{this, Tag::kResponseSent};
   Tag cancelled_tag_{this, Tag::kCancelled};
 
+  // Timestamps of the phases of this call, only set when `metrics_` is not
+  // null. Each phase happens-after the previous one, so no lock is needed.
+  GrpcCallMetrics* metrics_ = nullptr;  // Not owned.
+  uint64 received_micros_ = 0;
+  uint64 handler_start_micros_ = 0;
+  uint64 send_response_micros_ = 0;
+  bool response_ok_ = false;
+
   mutex mu_;
   std::function<void()> cancel_callback_ GUARDED_BY(mu_);
 };
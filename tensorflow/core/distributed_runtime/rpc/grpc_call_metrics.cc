@@ -0,0 +1,79 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_call_metrics.h"
+
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+auto* grpc_server_queue_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc/server/queue_time_usecs",
+     "The time gRPC requests waited for their handler to start in "
+     "microseconds.",
+     "method"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* grpc_server_handler_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc/server/handler_time_usecs",
+     "The time spent handling gRPC requests in microseconds.", "method"},
+    // Power of 2 with bucket count 30 (> 17 minutes)
+    {monitoring::Buckets::Exponential(1, 2, 30)});
+
+auto* grpc_server_response_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc/server/response_time_usecs",
+     "The time spent sending gRPC responses in microseconds.", "method"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* grpc_server_request_bytes = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc/server/request_bytes",
+     "The serialized size of gRPC requests in bytes.", "method"},
+    // Power of 4 with bucket count 18 (64G)
+    {monitoring::Buckets::Exponential(1, 4, 18)});
+
+auto* grpc_server_response_bytes = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc/server/response_bytes",
+     "The serialized size of gRPC responses in bytes.", "method"},
+    // Power of 4 with bucket count 18 (64G)
+    {monitoring::Buckets::Exponential(1, 4, 18)});
+
+}  // namespace
+
+GrpcCallMetrics* GrpcCallMetrics::Get(const string& method) {
+  static mutex* mu = new mutex;
+  static auto* metrics =
+      new std::unordered_map<string, std::unique_ptr<GrpcCallMetrics>>;
+  mutex_lock l(*mu);
+  std::unique_ptr<GrpcCallMetrics>& entry = (*metrics)[method];
+  if (entry == nullptr) {
+    entry.reset(new GrpcCallMetrics);
+    entry->queue_time_usecs = grpc_server_queue_time_usecs->GetCell(method);
+    entry->handler_time_usecs =
+        grpc_server_handler_time_usecs->GetCell(method);
+    entry->response_time_usecs =
+        grpc_server_response_time_usecs->GetCell(method);
+    entry->request_bytes = grpc_server_request_bytes->GetCell(method);
+    entry->response_bytes = grpc_server_response_bytes->GetCell(method);
+  }
+  return entry.get();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_METRICS_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_METRICS_H_
+
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Histograms recorded for every server-side call of one gRPC method, labeled
+// with the full method name (e.g. "/tensorflow.WorkerService/RunGraph").
+//
+// The cells are looked up once per method, so recording a call only costs a
+// few histogram updates and is always enabled.
+struct GrpcCallMetrics {
+  // Time from the request being taken off the completion queue to its
+  // handler starting, e.g. after waiting for a thread of the compute pool.
+  monitoring::SamplerCell* queue_time_usecs;
+  // Time from the handler starting to the response being handed to gRPC.
+  monitoring::SamplerCell* handler_time_usecs;
+  // Time from the response being handed to gRPC to gRPC reporting that it
+  // has been sent, i.e. waiting for the network and the client.
+  monitoring::SamplerCell* response_time_usecs;
+  // Serialized sizes of the request and of successful responses.
+  monitoring::SamplerCell* request_bytes;
+  monitoring::SamplerCell* response_bytes;
+
+  // Returns the metrics of `method`, which live for the rest of the process.
+  static GrpcCallMetrics* Get(const string& method);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_METRICS_H_
@@ -0,0 +1,51 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_call_metrics.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(GrpcCallMetricsTest, SameMethodSharesMetrics) {
+  GrpcCallMetrics* run_graph =
+      GrpcCallMetrics::Get("/tensorflow.WorkerService/RunGraph");
+  GrpcCallMetrics* recv_tensor =
+      GrpcCallMetrics::Get("/tensorflow.WorkerService/RecvTensor");
+  EXPECT_EQ(run_graph,
+            GrpcCallMetrics::Get("/tensorflow.WorkerService/RunGraph"));
+  EXPECT_NE(run_graph, recv_tensor);
+  EXPECT_NE(run_graph->handler_time_usecs, recv_tensor->handler_time_usecs);
+}
+
+TEST(GrpcCallMetricsTest, RecordsPerMethod) {
+  GrpcCallMetrics* put = GrpcCallMetrics::Get("/test.Service/Put");
+  GrpcCallMetrics* get = GrpcCallMetrics::Get("/test.Service/Get");
+  put->queue_time_usecs->Add(10);
+  put->handler_time_usecs->Add(100);
+  put->response_bytes->Add(1024);
+  put->response_bytes->Add(2048);
+
+  EXPECT_EQ(put->queue_time_usecs->value().num(), 1);
+  EXPECT_EQ(put->handler_time_usecs->value().sum(), 100);
+  EXPECT_EQ(put->response_bytes->value().num(), 2);
+  EXPECT_EQ(put->response_bytes->value().sum(), 3072);
+  EXPECT_EQ(put->request_bytes->value().num(), 0);
+  EXPECT_EQ(get->response_bytes->value().num(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,163 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_chunked_tensor_cache.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+void GrpcChunkedTensorCache::Insert(int64 request_id, int64 step_id,
+                                    const Tensor& tensor, int64 chunk_bytes,
+                                    bool ready) {
+  DCHECK_GT(chunk_bytes, 0);
+  const int64 num_chunks = NumChunks(tensor.TotalBytes(), chunk_bytes);
+  VLOG(1) << "GrpcChunkedTensorCache Insert " << request_id << ": "
+          << tensor.TotalBytes() << " bytes in " << num_chunks << " chunks";
+  mutex_lock l(mu_);
+  Entry& entry = entries_[request_id];
+  entry.step_id = step_id;
+  entry.tensor = tensor;
+  entry.chunk_bytes = chunk_bytes;
+  entry.chunk_ready.assign(num_chunks, ready);
+  entry.chunk_status.assign(num_chunks, Status::OK());
+  entry.chunk_sent.assign(num_chunks, false);
+  entry.num_chunks_sent = 0;
+  entry.waiters.clear();
+  entry.waiters.resize(num_chunks);
+}
+
+void GrpcChunkedTensorCache::MarkChunkReady(int64 request_id,
+                                            int64 chunk_index,
+                                            const Status& status) {
+  std::vector<ChunkCallback> waiters;
+  Tensor tensor;
+  int64 chunk_bytes;
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(request_id);
+    if (it == entries_.end()) {
+      // The step has been cleaned up while the chunk was being produced.
+      return;
+    }
+    Entry& entry = it->second;
+    DCHECK_GE(chunk_index, 0);
+    DCHECK_LT(chunk_index, static_cast<int64>(entry.chunk_ready.size()));
+    entry.chunk_ready[chunk_index] = true;
+    entry.chunk_status[chunk_index] = status;
+    waiters.swap(entry.waiters[chunk_index]);
+    tensor = entry.tensor;
+    chunk_bytes = entry.chunk_bytes;
+    if (!waiters.empty()) {
+      MarkChunkSent(it, chunk_index);
+    }
+  }
+  for (const auto& cb : waiters) {
+    FinishChunk(tensor, chunk_bytes, chunk_index, status, cb);
+  }
+}
+
+void GrpcChunkedTensorCache::GetChunk(int64 request_id, int64 offset,
+                                      const ChunkCallback& cb) {
+  Tensor tensor;
+  int64 chunk_bytes = 0;
+  int64 chunk_index = 0;
+  Status status;
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(request_id);
+    if (it == entries_.end()) {
+      status = errors::NotFound(
+          "No tensor is being sent in chunks for request ", request_id);
+    } else {
+      Entry& entry = it->second;
+      const int64 total_bytes = entry.tensor.TotalBytes();
+      if (offset < 0 || offset >= total_bytes ||
+          offset % entry.chunk_bytes != 0) {
+        status = errors::InvalidArgument(
+            "Invalid chunk offset ", offset, " for a tensor of ", total_bytes,
+            " bytes sent in chunks of ", entry.chunk_bytes, " bytes");
+      } else {
+        chunk_index = offset / entry.chunk_bytes;
+        if (!entry.chunk_ready[chunk_index]) {
+          entry.waiters[chunk_index].push_back(cb);
+          return;
+        }
+        tensor = entry.tensor;
+        chunk_bytes = entry.chunk_bytes;
+        status = entry.chunk_status[chunk_index];
+        MarkChunkSent(it, chunk_index);
+      }
+    }
+  }
+  FinishChunk(tensor, chunk_bytes, chunk_index, status, cb);
+}
+
+void GrpcChunkedTensorCache::CleanEntriesForStep(int64 step_id) {
+  std::vector<ChunkCallback> waiters;
+  {
+    mutex_lock l(mu_);
+    for (auto it = entries_.begin(), last = entries_.end(); it != last;) {
+      if (it->second.step_id == step_id) {
+        VLOG(1) << "Erase stale GrpcChunkedTensorCache entry " << it->first;
+        for (auto& chunk_waiters : it->second.waiters) {
+          for (auto& cb : chunk_waiters) {
+            waiters.push_back(std::move(cb));
+          }
+        }
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  for (const auto& cb : waiters) {
+    cb(Tensor(), 0, 0,
+       errors::Aborted("Step ", step_id,
+                       " was cleaned up while a tensor was being sent"));
+  }
+}
+
+void GrpcChunkedTensorCache::FinishChunk(const Tensor& tensor,
+                                         int64 chunk_bytes, int64 chunk_index,
+                                         const Status& status,
+                                         const ChunkCallback& cb) {
+  if (!status.ok()) {
+    cb(Tensor(), 0, 0, status);
+    return;
+  }
+  const int64 offset = chunk_index * chunk_bytes;
+  const int64 total_bytes = tensor.TotalBytes();
+  cb(tensor, offset, std::min(chunk_bytes, total_bytes - offset),
+     Status::OK());
+}
+
+void GrpcChunkedTensorCache::MarkChunkSent(
+    gtl::FlatMap<int64, Entry>::iterator it, int64 chunk_index) {
+  Entry& entry = it->second;
+  if (!entry.chunk_sent[chunk_index]) {
+    entry.chunk_sent[chunk_index] = true;
+    ++entry.num_chunks_sent;
+  }
+  if (entry.num_chunks_sent == static_cast<int64>(entry.chunk_sent.size())) {
+    VLOG(1) << "All chunks of request " << it->first << " have been sent";
+    entries_.erase(it);
+  }
+}
+
+}  // namespace tensorflow
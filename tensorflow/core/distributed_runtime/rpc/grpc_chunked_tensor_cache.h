@@ -0,0 +1,101 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CHUNKED_TENSOR_CACHE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CHUNKED_TENSOR_CACHE_H_
+
+#include <functional>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/platform/mutex.h"
+
+// Sender-side state of the tensors that are sent in chunks by RecvTensor.
+//
+// When the receiver of a large tensor allows it, the sender replies to the
+// RecvTensor request with only the tensor's metadata, and keeps the tensor in
+// this cache until the receiver has fetched every chunk of it with separate
+// chunk requests. The chunks of a tensor that is still being copied off its
+// device become available one at a time, so that sending the first chunks
+// overlaps with copying the rest.
+namespace tensorflow {
+
+class GrpcChunkedTensorCache {
+ public:
+  // Invoked with the cached tensor and the byte range of the requested chunk
+  // in its backing store, or with a non-OK status.
+  using ChunkCallback = std::function<void(
+      const Tensor& tensor, int64 offset, int64 num_bytes, const Status& s)>;
+
+  // Returns the number of chunks of `chunk_bytes` bytes that `num_bytes`
+  // bytes are split into.
+  static int64 NumChunks(int64 num_bytes, int64 chunk_bytes) {
+    return (num_bytes + chunk_bytes - 1) / chunk_bytes;
+  }
+
+  // Adds `tensor` to the cache under `request_id`. If `ready` is false, the
+  // contents of `tensor` are still being produced, and each chunk only becomes
+  // available once MarkChunkReady() is called for it.
+  void Insert(int64 request_id, int64 step_id, const Tensor& tensor,
+              int64 chunk_bytes, bool ready);
+
+  // Marks the chunk with index `chunk_index` of the tensor cached under
+  // `request_id` as available, or failed if `status` is not OK.
+  void MarkChunkReady(int64 request_id, int64 chunk_index,
+                      const Status& status);
+
+  // Invokes `cb` with the chunk of the tensor cached under `request_id` that
+  // starts at byte `offset`, as soon as that chunk is available. The entry is
+  // removed once each of its chunks has been handed out.
+  void GetChunk(int64 request_id, int64 offset, const ChunkCallback& cb);
+
+  // Removes the entries with the given step_id, failing any pending requests
+  // for their chunks.
+  void CleanEntriesForStep(int64 step_id);
+
+ private:
+  struct Entry {
+    int64 step_id = -1;
+    Tensor tensor;
+    int64 chunk_bytes = 0;
+    // The status of each chunk is only meaningful once it is ready.
+    std::vector<bool> chunk_ready;
+    std::vector<Status> chunk_status;
+    std::vector<bool> chunk_sent;
+    int64 num_chunks_sent = 0;
+    // Requests for chunks that are not ready yet, by chunk index.
+    std::vector<std::vector<ChunkCallback>> waiters;
+  };
+
+  // Invokes `cb` for chunk `chunk_index` of `tensor`. Must be called without
+  // holding `mu_`.
+  static void FinishChunk(const Tensor& tensor, int64 chunk_bytes,
+                          int64 chunk_index, const Status& status,
+                          const ChunkCallback& cb);
+
+  // Records that chunk `chunk_index` of the entry at `it` has been handed out,
+  // and erases the entry if this was the last one.
+  void MarkChunkSent(gtl::FlatMap<int64, Entry>::iterator it,
+                     int64 chunk_index) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutex mu_;
+  gtl::FlatMap<int64, Entry> entries_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CHUNKED_TENSOR_CACHE_H_
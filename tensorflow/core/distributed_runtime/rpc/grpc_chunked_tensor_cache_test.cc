@@ -0,0 +1,148 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_chunked_tensor_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+struct Chunk {
+  int64 offset = -1;
+  int64 num_bytes = -1;
+  Status status;
+  bool done = false;
+};
+
+GrpcChunkedTensorCache::ChunkCallback RecordChunk(Chunk* chunk) {
+  return [chunk](const Tensor& tensor, int64 offset, int64 num_bytes,
+                 const Status& s) {
+    chunk->offset = offset;
+    chunk->num_bytes = num_bytes;
+    chunk->status = s;
+    chunk->done = true;
+  };
+}
+
+TEST(GrpcChunkedTensorCacheTest, NumChunks) {
+  EXPECT_EQ(GrpcChunkedTensorCache::NumChunks(8, 4), 2);
+  EXPECT_EQ(GrpcChunkedTensorCache::NumChunks(9, 4), 3);
+  EXPECT_EQ(GrpcChunkedTensorCache::NumChunks(3, 4), 1);
+}
+
+TEST(GrpcChunkedTensorCacheTest, ReadyTensor) {
+  GrpcChunkedTensorCache cache;
+  // 5 floats, i.e. 20 bytes in chunks of 8, 8 and 4 bytes.
+  Tensor t = test::AsTensor<float>({1, 2, 3, 4, 5});
+  cache.Insert(/*request_id=*/1, /*step_id=*/7, t, /*chunk_bytes=*/8,
+               /*ready=*/true);
+
+  Chunk last;
+  cache.GetChunk(1, 16, RecordChunk(&last));
+  ASSERT_TRUE(last.done);
+  TF_EXPECT_OK(last.status);
+  EXPECT_EQ(last.offset, 16);
+  EXPECT_EQ(last.num_bytes, 4);
+
+  Chunk first;
+  cache.GetChunk(1, 0, [&first, &t](const Tensor& tensor, int64 offset,
+                                    int64 num_bytes, const Status& s) {
+    EXPECT_EQ(tensor.tensor_data().data(), t.tensor_data().data());
+    RecordChunk(&first)(tensor, offset, num_bytes, s);
+  });
+  ASSERT_TRUE(first.done);
+  TF_EXPECT_OK(first.status);
+  EXPECT_EQ(first.offset, 0);
+  EXPECT_EQ(first.num_bytes, 8);
+
+  Chunk invalid;
+  cache.GetChunk(1, 4, RecordChunk(&invalid));
+  EXPECT_TRUE(errors::IsInvalidArgument(invalid.status)) << invalid.status;
+
+  // A retried chunk is served again until the last chunk has been sent.
+  Chunk retried;
+  cache.GetChunk(1, 0, RecordChunk(&retried));
+  TF_EXPECT_OK(retried.status);
+
+  Chunk middle;
+  cache.GetChunk(1, 8, RecordChunk(&middle));
+  TF_EXPECT_OK(middle.status);
+  EXPECT_EQ(middle.num_bytes, 8);
+
+  Chunk after_last;
+  cache.GetChunk(1, 0, RecordChunk(&after_last));
+  EXPECT_TRUE(errors::IsNotFound(after_last.status)) << after_last.status;
+}
+
+TEST(GrpcChunkedTensorCacheTest, ChunksBecomeReadyOneAtATime) {
+  GrpcChunkedTensorCache cache;
+  Tensor t = test::AsTensor<int32>({1, 2, 3, 4});
+  cache.Insert(/*request_id=*/1, /*step_id=*/7, t, /*chunk_bytes=*/8,
+               /*ready=*/false);
+
+  Chunk second;
+  cache.GetChunk(1, 8, RecordChunk(&second));
+  EXPECT_FALSE(second.done);
+  cache.MarkChunkReady(1, 0, Status::OK());
+  EXPECT_FALSE(second.done);
+  cache.MarkChunkReady(1, 1, Status::OK());
+  ASSERT_TRUE(second.done);
+  TF_EXPECT_OK(second.status);
+  EXPECT_EQ(second.offset, 8);
+
+  Chunk first;
+  cache.GetChunk(1, 0, RecordChunk(&first));
+  ASSERT_TRUE(first.done);
+  TF_EXPECT_OK(first.status);
+}
+
+TEST(GrpcChunkedTensorCacheTest, FailedChunk) {
+  GrpcChunkedTensorCache cache;
+  Tensor t = test::AsTensor<int32>({1, 2, 3, 4});
+  cache.Insert(/*request_id=*/1, /*step_id=*/7, t, /*chunk_bytes=*/8,
+               /*ready=*/false);
+  Chunk first;
+  cache.GetChunk(1, 0, RecordChunk(&first));
+  cache.MarkChunkReady(1, 0, errors::Internal("Copy failed"));
+  ASSERT_TRUE(first.done);
+  EXPECT_TRUE(errors::IsInternal(first.status)) << first.status;
+}
+
+TEST(GrpcChunkedTensorCacheTest, CleanEntriesForStep) {
+  GrpcChunkedTensorCache cache;
+  Tensor t = test::AsTensor<int32>({1, 2, 3, 4});
+  cache.Insert(/*request_id=*/1, /*step_id=*/7, t, /*chunk_bytes=*/8,
+               /*ready=*/false);
+  cache.Insert(/*request_id=*/2, /*step_id=*/8, t, /*chunk_bytes=*/8,
+               /*ready=*/true);
+  Chunk pending;
+  cache.GetChunk(1, 0, RecordChunk(&pending));
+  cache.CleanEntriesForStep(7);
+  ASSERT_TRUE(pending.done);
+  EXPECT_TRUE(errors::IsAborted(pending.status)) << pending.status;
+  // Copies that finish after the step was cleaned up are ignored.
+  cache.MarkChunkReady(1, 1, Status::OK());
+
+  Chunk other_step;
+  cache.GetChunk(2, 0, RecordChunk(&other_step));
+  TF_EXPECT_OK(other_step.status);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/master.h"
 #include "tensorflow/core/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_call.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_call_metrics.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_master_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/platform/logging.h"
@@ -90,6 +91,8 @@ class GrpcMasterService : public AsyncServiceInterface {
 // to keep accepting new requests.
 #define ENQUEUE_REQUEST(method, supports_cancel)                              \
   do {                                                                        \
+    static GrpcCallMetrics* const call_metrics =                              \
+        GrpcCallMetrics::Get("/tensorflow.MasterService/" #method);           \
     mutex_lock l(mu_);                                                        \
     if (!is_shutdown_) {                                                      \
       Call<GrpcMasterService, grpc::MasterService::AsyncService,              \
@@ -97,7 +100,7 @@ class GrpcMasterService : public AsyncServiceInterface {
           EnqueueRequest(&master_service_, cq_.get(),                         \
                          &grpc::MasterService::AsyncService::Request##method, \
                          &GrpcMasterService::method##Handler,                 \
-                         (supports_cancel));                                  \
+                         (supports_cancel), call_metrics);                    \
     }                                                                         \
   } while (0)
 
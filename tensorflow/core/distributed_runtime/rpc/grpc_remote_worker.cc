@@ -20,9 +20,12 @@ limitations under the License.
 #include "grpcpp/generic/generic_stub.h"
 #include "grpcpp/grpcpp.h"
 
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
@@ -36,11 +39,37 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 const int kMaxWorkerRpcRetries = 10;
 
+// The maximum number of chunk requests that a chunked RecvTensor keeps in
+// flight.
+const int kMaxRecvTensorChunksInFlight = 8;
+
+namespace {
+
+// Returns the chunk size in bytes that RecvTensor requests offer to the
+// sender, or 0 if tensors are always received in a single response. Set with
+// the TF_GRPC_RECV_TENSOR_CHUNK_BYTES environment variable.
+int64 RecvTensorMaxChunkBytes() {
+  static const int64 max_chunk_bytes = []() {
+    int64 value;
+    Status s =
+        ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_CHUNK_BYTES", 0, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      value = 0;
+    }
+    return value;
+  }();
+  return max_chunk_bytes;
+}
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
@@ -67,6 +96,7 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        batchrecvtensor_(Method(GrpcWorkerMethod::kBatchRecvTensor)),
         logger_(logger) {}
 
   ~GrpcRemoteWorker() override {}
@@ -250,9 +280,79 @@ class GrpcRemoteWorker : public WorkerInterface {
       done(s);
     };
 
+    if (response->on_host()) {
+      // The contents of a tensor in host memory may be sent compressed, or,
+      // if it is large, in chunks. Either way they are decoded straight into
+      // the tensor that the first response allocates.
+      RecvTensorRequest on_host_request = *request;
+      on_host_request.set_accept_compressed_content(true);
+      on_host_request.set_max_chunk_bytes(RecvTensorMaxChunkBytes());
+      auto on_host_callback = [this, request, response,
+                               callback](const Status& s) {
+        const auto& transport_options =
+            response->metadata().transport_options();
+        RecvTensorChunkInfo chunk_info;
+        CompressedTensorContent compressed;
+        if (s.ok() && transport_options.Is<RecvTensorChunkInfo>() &&
+            transport_options.UnpackTo(&chunk_info)) {
+          RecvTensorChunksAsync(*request, chunk_info.chunk_bytes(),
+                                const_cast<Tensor*>(&response->tensor()),
+                                callback);
+        } else if (s.ok() &&
+                   transport_options.Is<CompressedTensorContent>()) {
+          Status decode_status =
+              transport_options.UnpackTo(&compressed)
+                  ? grpc::DecodeCompressedTensorContent(
+                        compressed, const_cast<Tensor*>(&response->tensor()))
+                  : errors::DataLoss("Failed to parse CompressedTensorContent");
+          callback(decode_status);
+        } else {
+          callback(s);
+        }
+      };
+      IssueRequest(&on_host_request, response, recvtensor_,
+                   std::move(on_host_callback), call_opts);
+      return;
+    }
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void BatchRecvTensorAsync(CallOptions* call_opts,
+                            const BatchRecvTensorRequest* request,
+                            std::vector<TensorResponse*> responses,
+                            StatusCallback done) override {
+    VLOG(1) << "BatchRecvTensorAsync with " << request->requests_size()
+            << " requests";
+    // The tensors are parsed by the protobuf library and then copied into
+    // place, which is cheaper than an RPC each for the small tensors that
+    // are batched.
+    BatchRecvTensorResponse* batch_response = new BatchRecvTensorResponse;
+    auto callback = [this, request, responses, batch_response,
+                     done](const Status& s) {
+      Status status = s;
+      if (status.ok() &&
+          batch_response->responses_size() != request->requests_size()) {
+        status = errors::Internal(
+            "BatchRecvTensor returned ", batch_response->responses_size(),
+            " responses to ", request->requests_size(), " requests");
+      }
+      for (int i = 0; status.ok() && i < request->requests_size(); ++i) {
+        const bool require_ack =
+            batch_response->responses(i).require_ack();
+        status = responses[i]->InitFrom(batch_response->mutable_responses(i));
+        if (require_ack) {
+          IssueMarkRecvFinishedRequest(request->requests(i).request_id());
+        }
+      }
+      delete batch_response;
+      // Note done() can delete this worker object, so we need to call done()
+      // last.
+      done(status);
+    };
+    IssueRequest(request, batch_response, batchrecvtensor_,
+                 std::move(callback), call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -283,6 +383,103 @@ class GrpcRemoteWorker : public WorkerInterface {
                                  callback_threadpool_, max_retries);
   }
 
+  void IssueRequest(const protobuf::Message* request, GrpcRawBuffer* response,
+                    const ::grpc::string& method, StatusCallback done,
+                    CallOptions* call_opts = nullptr,
+                    int max_retries = kMaxWorkerRpcRetries) {
+    new RPCState<GrpcRawBuffer>(&stub_, cq_, method, *request, response,
+                                std::move(done), call_opts,
+                                callback_threadpool_, max_retries);
+  }
+
+  // The state of the chunk requests that fetch the contents of a tensor that
+  // the sender announced in response to a RecvTensor request.
+  struct RecvTensorChunksState {
+    int64 step_id;
+    string rendezvous_key;
+    int64 chunked_request_id;
+    char* data;  // Not owned.
+    int64 total_bytes;
+    int64 chunk_bytes;
+    StatusCallback done;
+
+    mutex mu;
+    int64 next_offset GUARDED_BY(mu) = 0;
+    int num_outstanding GUARDED_BY(mu) = 0;
+    Status status GUARDED_BY(mu);
+  };
+
+  // Fetches the contents of `*tensor`, the tensor announced in response to
+  // `request`, in chunks of `chunk_bytes` bytes, and then invokes `done`.
+  // Chunk requests are idempotent and therefore retried freely, but they
+  // cannot be cancelled.
+  void RecvTensorChunksAsync(const RecvTensorRequest& request,
+                             int64 chunk_bytes, Tensor* tensor,
+                             StatusCallback done) {
+    if (chunk_bytes <= 0 || !DMAHelper::CanUseDMA(tensor)) {
+      done(errors::Internal("Invalid chunked response to RecvTensor for ",
+                            request.rendezvous_key()));
+      return;
+    }
+    auto state = std::make_shared<RecvTensorChunksState>();
+    state->step_id = request.step_id();
+    state->rendezvous_key = request.rendezvous_key();
+    state->chunked_request_id = request.request_id();
+    state->data = static_cast<char*>(DMAHelper::base(tensor));
+    state->total_bytes = tensor->TotalBytes();
+    state->chunk_bytes = chunk_bytes;
+    state->done = std::move(done);
+    IssueRecvTensorChunkRequests(state);
+  }
+
+  // Issues chunk requests until `kMaxRecvTensorChunksInFlight` are
+  // outstanding or every chunk has been requested.
+  void IssueRecvTensorChunkRequests(
+      const std::shared_ptr<RecvTensorChunksState>& state) {
+    while (true) {
+      int64 offset;
+      {
+        mutex_lock l(state->mu);
+        if (!state->status.ok() || state->next_offset >= state->total_bytes ||
+            state->num_outstanding >= kMaxRecvTensorChunksInFlight) {
+          return;
+        }
+        offset = state->next_offset;
+        state->next_offset += state->chunk_bytes;
+        ++state->num_outstanding;
+      }
+      RecvTensorRequest request;
+      request.set_step_id(state->step_id);
+      request.set_rendezvous_key(state->rendezvous_key);
+      request.set_request_id(GetUniqueRequestId());
+      request.set_chunked_request_id(state->chunked_request_id);
+      request.set_chunk_offset(offset);
+      GrpcRawBuffer* buffer = new GrpcRawBuffer;
+      buffer->data = state->data + offset;
+      buffer->size = std::min(state->chunk_bytes, state->total_bytes - offset);
+      IssueRequest(&request, buffer, recvtensor_,
+                   [this, state, buffer](const Status& s) {
+                     delete buffer;
+                     bool finished;
+                     Status status;
+                     {
+                       mutex_lock l(state->mu);
+                       state->status.Update(s);
+                       --state->num_outstanding;
+                       status = state->status;
+                       finished = state->num_outstanding == 0 &&
+                                  (!status.ok() ||
+                                   state->next_offset >= state->total_bytes);
+                     }
+                     if (finished) {
+                       state->done(status);
+                     } else {
+                       IssueRecvTensorChunkRequests(state);
+                     }
+                   });
+    }
+  }
+
   void IssueMarkRecvFinishedRequest(int64 request_id) {
     VLOG(2) << "Send MarkRecvFinishedRequest for request " << request_id;
     MarkRecvFinishedRequest request;
@@ -317,6 +514,7 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string batchrecvtensor_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -23,9 +23,11 @@ bool GrpcResponseCache::QueueRequest(int64 request_id, int64 step_id,
                                      const FinishResponseCB& cb) {
   VLOG(1) << "GrpcResponseCache Lookup " << request_id;
 
-  mu_.lock();
+  Shard& shard = GetShard(request_id);
+  shard.mu.lock();
 
-  ResponseCacheEntry& entry = response_cache_[request_id];
+  ResponseCacheEntry& entry = shard.response_cache[request_id];
+  shard.size.store(shard.response_cache.size(), std::memory_order_release);
 
   if (entry.state == ResponseCacheEntry::State::FINISHED) {
     VLOG(1) << "Reuse cached response for " << request_id;
@@ -34,7 +36,7 @@ bool GrpcResponseCache::QueueRequest(int64 request_id, int64 step_id,
     // expensive.
     auto entry_copy = entry;
 
-    mu_.unlock();
+    shard.mu.unlock();
     entry_copy.FinishResponse(cb);
     return true;
   }
@@ -44,14 +46,14 @@ bool GrpcResponseCache::QueueRequest(int64 request_id, int64 step_id,
   if (entry.state == ResponseCacheEntry::State::ACTIVE) {
     VLOG(1) << "Found active request for " << request_id
             << ".  Adding entry to response queue.";
-    mu_.unlock();
+    shard.mu.unlock();
     return true;
   } else {
     VLOG(2) << "No cache entry for " << request_id
             << ", running user computation.";
     entry.step_id = step_id;
     entry.state = ResponseCacheEntry::State::ACTIVE;
-    mu_.unlock();
+    shard.mu.unlock();
     return false;
   }
 }
@@ -62,10 +64,11 @@ void GrpcResponseCache::OnRequestFinished(int64 request_id,
   absl::optional<ResponseCacheEntry> entry_copy;
 
   {
-    mutex_lock m(mu_);
+    Shard& shard = GetShard(request_id);
+    mutex_lock m(shard.mu);
 
-    auto it = response_cache_.find(request_id);
-    if (it == response_cache_.end()) {
+    auto it = shard.response_cache.find(request_id);
+    if (it == shard.response_cache.end()) {
       LOG(ERROR) << "Unexpected missing response cache entry for request "
                  << request_id;
       return;
@@ -94,21 +97,29 @@ void GrpcResponseCache::OnRequestFinished(int64 request_id,
 }
 
 void GrpcResponseCache::EraseRequestId(int64 request_id) {
-  mutex_lock m(mu_);
-  response_cache_.erase(request_id);
+  Shard& shard = GetShard(request_id);
+  if (shard.size.load(std::memory_order_acquire) == 0) return;
+  mutex_lock m(shard.mu);
+  shard.response_cache.erase(request_id);
+  shard.size.store(shard.response_cache.size(), std::memory_order_release);
 }
 
 void GrpcResponseCache::CleanEntriesForStep(int64 step_id) {
-  mutex_lock m(mu_);
-  // Remove all cache entries whose step id is the given step_id
-  for (auto it = response_cache_.begin(), last = response_cache_.end();
-       it != last;) {
-    if (it->second.step_id == step_id) {
-      VLOG(1) << "Erase stale GrpcResponseCache entry " << it->first;
-      it = response_cache_.erase(it);
-    } else {
-      ++it;
+  for (Shard& shard : shards_) {
+    if (shard.size.load(std::memory_order_acquire) == 0) continue;
+    mutex_lock m(shard.mu);
+    // Remove all cache entries whose step id is the given step_id
+    for (auto it = shard.response_cache.begin(),
+              last = shard.response_cache.end();
+         it != last;) {
+      if (it->second.step_id == step_id) {
+        VLOG(1) << "Erase stale GrpcResponseCache entry " << it->first;
+        it = shard.response_cache.erase(it);
+      } else {
+        ++it;
+      }
     }
+    shard.size.store(shard.response_cache.size(), std::memory_order_release);
   }
 }
 
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_RESPONSE_CACHE_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_RESPONSE_CACHE_H_
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/mutex.h"
 
 // gRPC response caching.  Most WorkerService methods cannot be retried directly
@@ -84,10 +86,27 @@ class GrpcResponseCache {
     std::vector<FinishResponseCB> callbacks;
   };
 
-  mutex mu_;
-  // response_cache_ is expected to be small, as entries are cleared immediately
-  // on ack from the receiver.
-  gtl::FlatMap<int64, ResponseCacheEntry> response_cache_ GUARDED_BY(mu_);
+  // The entries are split by request_id into shards with separate locks, so
+  // that concurrent RPCs rarely contend.
+  static constexpr int kNumShards = 16;
+
+  struct Shard {
+    mutex mu;
+    // response_cache is expected to be small, as entries are cleared
+    // immediately on ack from the receiver.
+    gtl::FlatMap<int64, ResponseCacheEntry> response_cache GUARDED_BY(mu);
+    // The size of response_cache, which lets lookups of missing entries skip
+    // shards that are empty without taking the lock.
+    std::atomic<int64> size{0};
+  };
+
+  Shard& GetShard(int64 request_id) {
+    return shards_[Hash64(reinterpret_cast<const char*>(&request_id),
+                          sizeof(request_id)) %
+                   kNumShards];
+  }
+
+  Shard shards_[kNumShards];
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+struct Response {
+  Tensor tensor;
+  Status status;
+  int num_calls = 0;
+};
+
+GrpcResponseCache::FinishResponseCB RecordResponse(Response* response) {
+  return [response](const Tensor& tensor, bool is_dead, const Status& s) {
+    response->tensor = tensor;
+    response->status = s;
+    ++response->num_calls;
+  };
+}
+
+TEST(GrpcResponseCacheTest, RetriedRequests) {
+  GrpcResponseCache cache;
+  Response first, active_retry, finished_retry;
+  EXPECT_FALSE(cache.QueueRequest(/*request_id=*/1, /*step_id=*/7,
+                                  RecordResponse(&first)));
+  EXPECT_TRUE(cache.QueueRequest(1, 7, RecordResponse(&active_retry)));
+  EXPECT_EQ(first.num_calls, 0);
+
+  Tensor t = test::AsTensor<int32>({1, 2, 3});
+  cache.OnRequestFinished(1, t, /*is_dead=*/false, Status::OK());
+  EXPECT_EQ(first.num_calls, 1);
+  EXPECT_EQ(active_retry.num_calls, 1);
+  test::ExpectTensorEqual<int32>(first.tensor, t);
+
+  EXPECT_TRUE(cache.QueueRequest(1, 7, RecordResponse(&finished_retry)));
+  EXPECT_EQ(finished_retry.num_calls, 1);
+  TF_EXPECT_OK(finished_retry.status);
+  test::ExpectTensorEqual<int32>(finished_retry.tensor, t);
+}
+
+TEST(GrpcResponseCacheTest, EraseRequestId) {
+  GrpcResponseCache cache;
+  Response response;
+  // Erasing missing entries, including from empty shards, is a no-op.
+  cache.EraseRequestId(1);
+  EXPECT_FALSE(cache.QueueRequest(1, 7, RecordResponse(&response)));
+  cache.OnRequestFinished(1, Tensor(), false, Status::OK());
+  cache.EraseRequestId(2);
+  EXPECT_TRUE(cache.QueueRequest(1, 7, RecordResponse(&response)));
+  cache.EraseRequestId(1);
+  EXPECT_FALSE(cache.QueueRequest(1, 7, RecordResponse(&response)));
+}
+
+TEST(GrpcResponseCacheTest, CleanEntriesForStep) {
+  GrpcResponseCache cache;
+  Response response;
+  // Enough requests to populate every shard.
+  for (int64 request_id = 1; request_id <= 100; ++request_id) {
+    EXPECT_FALSE(cache.QueueRequest(request_id, /*step_id=*/request_id % 2,
+                                    RecordResponse(&response)));
+  }
+  cache.CleanEntriesForStep(0);
+  for (int64 request_id = 1; request_id <= 100; ++request_id) {
+    // Only the entries of step 1 remain, and are still active.
+    EXPECT_EQ(cache.QueueRequest(request_id, request_id % 2,
+                                 RecordResponse(&response)),
+              request_id % 2 == 1)
+        << request_id;
+  }
+  EXPECT_EQ(response.num_calls, 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,9 +21,13 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 // (Omitted internal-only flag)
@@ -40,6 +44,35 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
   result->Swap(&tmp);
 }
 
+namespace {
+
+// Returns the size of the encoding of the DT_STRING tensor "val" by
+// port::EncodeStringList: the varint32 lengths of the strings, followed by
+// their contents.
+size_t EncodedStringListSize(const Tensor& val) {
+  const auto strings = val.flat<tstring>();
+  size_t size = 0;
+  for (int64 i = 0; i < strings.size(); ++i) {
+    size += core::VarintLength(strings(i).size()) + strings(i).size();
+  }
+  return size;
+}
+
+// Writes the encoding of the DT_STRING tensor "val" by port::EncodeStringList
+// to "dst", which must hold EncodedStringListSize(val) bytes.
+void WriteStringList(const Tensor& val, char* dst) {
+  const auto strings = val.flat<tstring>();
+  for (int64 i = 0; i < strings.size(); ++i) {
+    dst = core::EncodeVarint32(dst, strings(i).size());
+  }
+  for (int64 i = 0; i < strings.size(); ++i) {
+    memcpy(dst, strings(i).data(), strings(i).size());
+    dst += strings(i).size();
+  }
+}
+
+}  // namespace
+
 // We generate a RecvTensorResponse protocol buffer encoding into "*result",
 // but where possible, we share the underlying Tensor buffer for "val", to
 // avoid an extra copy.
@@ -144,7 +177,7 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
   response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
-  if (!DataTypeCanUseMemcpy(val.dtype())) {
+  if (!DataTypeCanUseMemcpy(val.dtype()) && val.dtype() != DT_STRING) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
     // go directly from val -> ByteBuffer, with some effort.
@@ -159,11 +192,16 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
     io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
     EncodeSkeleton(val, &e_skeleton);
 
-    StringPiece tdata = val.tensor_data();
+    // String tensors are encoded as by Tensor::AsProtoTensorContent, but
+    // directly into the ByteBuffer.
+    const bool is_string = (val.dtype() == DT_STRING);
+    StringPiece tdata = is_string ? StringPiece() : val.tensor_data();
+    const size_t content_bytes =
+        is_string ? EncodedStringListSize(val) : tdata.size();
     uint32 overall_tensor_proto_bytesize =
         (e_skeleton.size() +
          VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
-                               tdata.size()));
+                               content_bytes));
     string header;  // All of RecvTensorResponse except the tensor() field
     response.AppendToString(&header);
 
@@ -181,11 +219,12 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
     // backing store alive as needed.
     //
     // We enable this behavior if the tensor is large.
-    bool share_tensor_slice_memory = (tdata.size() > kLargeTensorBytes);
+    bool share_tensor_slice_memory =
+        (!is_string && tdata.size() > kLargeTensorBytes);
 
     // (Omitted internal-only conditional)
 
-    size_t encoder_size = expected_size - tdata.size();
+    size_t encoder_size = expected_size - content_bytes;
 
     // Encode all but the actual "tdata", but including the tag and
     // varlength header for the "tdata"
@@ -201,7 +240,7 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
     e.WriteRawBytes(StringPiece(e_skeleton.data(), e_skeleton.size()));
     // (D1) & (D2)
     e.WriteVarlengthBeginning(TensorProto::kTensorContentFieldNumber,
-                              tdata.size());
+                              content_bytes);
 
     // All but the tensor backing store are serialized now
 
@@ -210,10 +249,15 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
     int num_slices = 0;
     {
       size_t slice_len =
-          e.size() + (share_tensor_slice_memory ? 0 : tdata.size());
+          e.size() + (share_tensor_slice_memory ? 0 : content_bytes);
       slices[0] = ::grpc::Slice(slice_len);
       memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
-      if (!share_tensor_slice_memory) {
+      if (is_string) {
+        // (E)
+        char* dst =
+            reinterpret_cast<char*>(const_cast<uint8_t*>(slices[0].begin()));
+        WriteStringList(val, dst + e.size());
+      } else if (!share_tensor_slice_memory) {
         // (E)
         memcpy(const_cast<uint8_t*>(slices[0].begin()) + e.size(), tdata.data(),
                tdata.size());
@@ -243,5 +287,117 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+void EncodeTensorChunkToByteBuffer(const Tensor& val, int64 offset,
+                                   int64 num_bytes,
+                                   ::grpc::ByteBuffer* result) {
+  const int kLargeChunkBytes = 1024;
+  StringPiece tdata = val.tensor_data();
+  DCHECK_GE(offset, 0);
+  DCHECK_LE(offset + num_bytes, tdata.size());
+  const char* begin = tdata.data() + offset;
+  ::grpc::Slice slice;
+  if (num_bytes > kLargeChunkBytes) {
+    // Share the backing store, as in EncodeTensorToByteBuffer.
+    const TensorBuffer* buf = DMAHelper::buffer(&val);
+    buf->Ref();
+    slice = ::grpc::Slice(
+        const_cast<void*>(static_cast<const void*>(begin)), num_bytes,
+        [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+        const_cast<TensorBuffer*>(buf));
+  } else {
+    slice = ::grpc::Slice(begin, num_bytes);
+  }
+  ::grpc::ByteBuffer tmp(&slice, 1);
+  result->Swap(&tmp);
+}
+
+void EncodeBatchRecvTensorResponseToByteBuffer(
+    std::vector<::grpc::ByteBuffer>* responses, ::grpc::ByteBuffer* result) {
+  // Each element of BatchRecvTensorResponse.responses is encoded as its tag
+  // and length, followed by the encoded RecvTensorResponse.
+  static const int kHeaderMax = 1 + core::kMaxVarint32Bytes;
+  std::vector<::grpc::Slice> slices;
+  std::vector<::grpc::Slice> response_slices;
+  for (::grpc::ByteBuffer& response : *responses) {
+    char header[kHeaderMax];
+    io::ProtoEncodeHelper e(header, kHeaderMax);
+    e.WriteVarlengthBeginning(BatchRecvTensorResponse::kResponsesFieldNumber,
+                              response.Length());
+    slices.emplace_back(e.data(), e.size());
+    response_slices.clear();
+    if (response.Length() > 0) {
+      (void)response.Dump(&response_slices);
+    }
+    for (::grpc::Slice& slice : response_slices) {
+      slices.push_back(std::move(slice));
+    }
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
+namespace {
+const char kSnappyAlgorithm[] = "snappy";
+}  // namespace
+
+bool IsSupportedTensorCompressionAlgorithm(const string& algorithm) {
+  return algorithm == kSnappyAlgorithm;
+}
+
+bool EncodeCompressedTensorToByteBuffer(const Tensor& val, bool require_ack,
+                                        const string& algorithm,
+                                        ::grpc::ByteBuffer* result) {
+  if (!IsSupportedTensorCompressionAlgorithm(algorithm)) {
+    return false;
+  }
+  DCHECK(DataTypeCanUseMemcpy(val.dtype()));
+  StringPiece tdata = val.tensor_data();
+  CompressedTensorContent compressed;
+  compressed.set_algorithm(algorithm);
+  // Snappy_Compress() fails if the binary was built without snappy.
+  if (!port::Snappy_Compress(tdata.data(), tdata.size(),
+                             compressed.mutable_content()) ||
+      compressed.content().size() >= tdata.size()) {
+    return false;
+  }
+
+  RecvTensorResponse response;
+  response.set_require_ack(require_ack);
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  TensorProto* proto = response.mutable_tensor();
+  proto->set_dtype(val.dtype());
+  val.shape().AsProto(proto->mutable_tensor_shape());
+  response.mutable_transport_options()->PackFrom(compressed);
+  EncodeRecvTensorResponseToByteBuffer(response, result);
+  return true;
+}
+
+Status DecodeCompressedTensorContent(const CompressedTensorContent& compressed,
+                                     Tensor* tensor) {
+  if (compressed.algorithm() != kSnappyAlgorithm) {
+    return errors::Unimplemented("Unsupported tensor compression algorithm: ",
+                                 compressed.algorithm());
+  }
+  if (!DataTypeCanUseMemcpy(tensor->dtype())) {
+    return errors::Internal("Compressed contents received for a tensor of ",
+                            DataTypeString(tensor->dtype()));
+  }
+  const string& content = compressed.content();
+  size_t uncompressed_bytes = 0;
+  if (!port::Snappy_GetUncompressedLength(content.data(), content.size(),
+                                          &uncompressed_bytes) ||
+      uncompressed_bytes != tensor->TotalBytes()) {
+    return errors::DataLoss("Compressed tensor contents hold ",
+                            uncompressed_bytes, " bytes, expected ",
+                            tensor->TotalBytes());
+  }
+  if (uncompressed_bytes > 0 &&
+      !port::Snappy_Uncompress(content.data(), content.size(),
+                               static_cast<char*>(DMAHelper::base(tensor)))) {
+    return errors::DataLoss("Failed to decompress tensor contents");
+  }
+  return Status::OK();
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
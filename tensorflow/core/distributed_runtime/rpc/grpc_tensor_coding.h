@@ -16,9 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <vector>
+
 #include "grpcpp/impl/codegen/byte_buffer.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
+class CompressedTensorContent;
 class Tensor;
 class RecvTensorResponse;
 
@@ -49,6 +54,45 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// Encode "num_bytes" bytes of the contents of "val", starting at byte
+// "offset", into a byte buffer as raw bytes. This is the response to a
+// RecvTensor chunk request (see RecvTensorRequest.chunked_request_id).
+//
+// Discards original contents of *result.
+void EncodeTensorChunkToByteBuffer(const Tensor& val, int64 offset,
+                                   int64 num_bytes,
+                                   ::grpc::ByteBuffer* result);
+
+// Concatenate "responses", each of which holds an encoded RecvTensorResponse,
+// into a byte buffer in a format that is parseable as a
+// BatchRecvTensorResponse protocol buffer holding them in the same order.
+// The slices of "responses" are shared rather than copied.
+//
+// Discards original contents of *result.
+void EncodeBatchRecvTensorResponseToByteBuffer(
+    std::vector<::grpc::ByteBuffer>* responses, ::grpc::ByteBuffer* result);
+
+// Encode a Tensor into a byte buffer in a format that is parseable as a
+// RecvTensorResponse protocol buffer holding the dtype and shape of "val",
+// and its contents compressed with "algorithm" in a CompressedTensorContent
+// in transport_options. "val" must have a dtype that can be memcpy-ed.
+//
+// Returns false, leaving *result unchanged, if "algorithm" is not supported
+// or compression does not make the contents smaller, in which case "val"
+// should be sent uncompressed.
+bool EncodeCompressedTensorToByteBuffer(const Tensor& val, bool require_ack,
+                                        const string& algorithm,
+                                        ::grpc::ByteBuffer* result);
+
+// Returns true if "algorithm" can be passed to
+// EncodeCompressedTensorToByteBuffer.
+bool IsSupportedTensorCompressionAlgorithm(const string& algorithm);
+
+// Decompress "compressed" into the contents of "*tensor", which must already
+// have the dtype and shape of the compressed tensor.
+Status DecodeCompressedTensorContent(const CompressedTensorContent& compressed,
+                                     Tensor* tensor);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -19,13 +19,27 @@ limitations under the License.
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 
+static string ByteBufferToString(const ::grpc::ByteBuffer& buf) {
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  return tmp;
+}
+
 class GrpcTensorCodingTest : public ::testing::Test {
  public:
   void Validate(const Tensor& t, bool is_dead) {
@@ -33,16 +47,8 @@ class GrpcTensorCodingTest : public ::testing::Test {
     ::grpc::ByteBuffer buf;
     grpc::EncodeTensorToByteBuffer(is_dead, t, false, &buf);
 
-    // Make a string
-    std::vector<::grpc::Slice> slices;
-    (void)buf.Dump(&slices);
-    string tmp;
-    for (const auto& s : slices) {
-      tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
-    }
-
     RecvTensorResponse response;
-    EXPECT_TRUE(response.ParseFromString(tmp));
+    EXPECT_TRUE(response.ParseFromString(ByteBufferToString(buf)));
     EXPECT_EQ(response.is_dead(), is_dead);
 
     Tensor result_tensor;
@@ -100,4 +106,73 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, BatchRecvTensorResponse) {
+  // Large enough for the encoding to share the tensor buffer.
+  Tensor large(DT_FLOAT, TensorShape({1000}));
+  test::FillIota<float>(&large, 0.0f);
+  std::vector<Tensor> tensors = {test::AsTensor<int32>({1, 2, 3}), large,
+                                 Tensor(DT_INT64, TensorShape({0}))};
+  std::vector<::grpc::ByteBuffer> responses(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    grpc::EncodeTensorToByteBuffer(/*is_dead=*/i == 2, tensors[i],
+                                   /*require_ack=*/false, &responses[i]);
+  }
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeBatchRecvTensorResponseToByteBuffer(&responses, &buf);
+
+  BatchRecvTensorResponse batch;
+  ASSERT_TRUE(batch.ParseFromString(ByteBufferToString(buf)));
+  ASSERT_EQ(batch.responses_size(), tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    EXPECT_EQ(batch.responses(i).is_dead(), i == 2);
+    Tensor result;
+    ASSERT_TRUE(result.FromProto(batch.responses(i).tensor()));
+    EXPECT_EQ(tensors[i].DebugString(), result.DebugString());
+  }
+
+  std::vector<::grpc::ByteBuffer> no_responses;
+  grpc::EncodeBatchRecvTensorResponseToByteBuffer(&no_responses, &buf);
+  EXPECT_EQ(buf.Length(), 0);
+}
+
+TEST_F(GrpcTensorCodingTest, CompressedTensor) {
+  string probe;
+  if (!port::Snappy_Compress("", 0, &probe)) {
+    LOG(INFO) << "Skipping test: snappy is not available";
+    return;
+  }
+  Tensor t(DT_INT64, TensorShape({2, 500}));
+  test::FillFn<int64>(&t, [](int i) { return i / 100; });
+  ::grpc::ByteBuffer buf;
+  ASSERT_TRUE(grpc::EncodeCompressedTensorToByteBuffer(
+      t, /*require_ack=*/true, "snappy", &buf));
+
+  RecvTensorResponse response;
+  ASSERT_TRUE(response.ParseFromString(ByteBufferToString(buf)));
+  EXPECT_TRUE(response.require_ack());
+  EXPECT_TRUE(response.tensor().tensor_content().empty());
+  CompressedTensorContent compressed;
+  ASSERT_TRUE(response.transport_options().UnpackTo(&compressed));
+  EXPECT_EQ(compressed.algorithm(), "snappy");
+  EXPECT_LT(compressed.content().size(), t.TotalBytes());
+
+  Tensor result(response.tensor().dtype(),
+                TensorShape(response.tensor().tensor_shape()));
+  TF_ASSERT_OK(grpc::DecodeCompressedTensorContent(compressed, &result));
+  test::ExpectTensorEqual<int64>(t, result);
+
+  Tensor wrong_shape(DT_INT64, TensorShape({3}));
+  EXPECT_TRUE(errors::IsDataLoss(
+      grpc::DecodeCompressedTensorContent(compressed, &wrong_shape)));
+}
+
+TEST_F(GrpcTensorCodingTest, IncompressibleTensor) {
+  Tensor t = test::AsTensor<int32>({1, 2});
+  ::grpc::ByteBuffer buf;
+  EXPECT_FALSE(grpc::EncodeCompressedTensorToByteBuffer(
+      t, /*require_ack=*/false, "snappy", &buf));
+  EXPECT_FALSE(
+      grpc::EncodeCompressedTensorToByteBuffer(t, false, "zstd", &buf));
+}
+
 }  // namespace tensorflow
@@ -114,4 +114,22 @@ bool GrpcMaybeParseProto(grpc::ByteBuffer* src, string* dst) {
   return true;
 }
 
+// GrpcMaybeParseProto into a GrpcRawBuffer copies bytes straight into the
+// destination, e.g. a range of a tensor's backing store.
+bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, GrpcRawBuffer* dst) {
+  if (src->Length() != dst->size) {
+    return false;
+  }
+  std::vector<::grpc::Slice> slices;
+  if (!src->Dump(&slices).ok()) {
+    return false;
+  }
+  char* pos = dst->data;
+  for (const ::grpc::Slice& s : slices) {
+    memcpy(pos, s.begin(), s.size());
+    pos += s.size();
+  }
+  return true;
+}
+
 }  // namespace tensorflow
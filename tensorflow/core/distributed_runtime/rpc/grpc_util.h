@@ -131,6 +131,16 @@ bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, TensorResponse* dst);
 // Copy grpc buffer src to string *dst.
 bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, string* dst);
 
+// A preallocated destination for the raw bytes of an RPC response.
+struct GrpcRawBuffer {
+  char* data = nullptr;
+  size_t size = 0;
+};
+
+// Copy grpc buffer src to *dst. Fails unless src holds exactly dst->size
+// bytes.
+bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, GrpcRawBuffer* dst);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_UTIL_H_
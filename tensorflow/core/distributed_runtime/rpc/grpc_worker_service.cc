@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_map>
@@ -35,6 +36,8 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_call.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_call_metrics.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_chunked_tensor_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
@@ -53,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -71,17 +75,20 @@ namespace {
 // The implementation of the request handler for each RPC method
 // must ensure that it calls ENQUEUE_REQUEST() for that RPC method,
 // to keep accepting new requests.
-#define ENQUEUE_REQUEST(method, supports_cancel)                             \
-  do {                                                                       \
-    mutex_lock l(shutdown_mu_);                                              \
-    if (!is_shutdown_) {                                                     \
-      Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,       \
-           method##Request, method##Response>::                              \
-          EnqueueRequestForMethod(                                           \
-              worker_service_, cq_.get(),                                    \
-              static_cast<int>(GrpcWorkerMethod::k##method),                 \
-              &GrpcWorkerServiceThread::method##Handler, (supports_cancel)); \
-    }                                                                        \
+#define ENQUEUE_REQUEST(method, supports_cancel)                            \
+  do {                                                                      \
+    static GrpcCallMetrics* const call_metrics = GrpcCallMetrics::Get(      \
+        GrpcWorkerMethodName(GrpcWorkerMethod::k##method));                 \
+    mutex_lock l(shutdown_mu_);                                             \
+    if (!is_shutdown_) {                                                    \
+      Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,      \
+           method##Request, method##Response>::                             \
+          EnqueueRequestForMethod(                                          \
+              worker_service_, cq_.get(),                                   \
+              static_cast<int>(GrpcWorkerMethod::k##method),                \
+              &GrpcWorkerServiceThread::method##Handler, (supports_cancel), \
+              call_metrics);                                                \
+    }                                                                       \
   } while (0)
 
 #define SETUP_FOR_REQUEST(method, default_depth, supports_cancel)              \
@@ -157,6 +164,13 @@ class GrpcWorkerServiceThread {
          ++i) {
       EnqueueRecvTensorRequestRaw();
     }
+    for (int i = 0;
+         i < gtl::FindWithDefault(
+                 queue_depth_,
+                 static_cast<int>(GrpcWorkerMethod::kBatchRecvTensor), 100);
+         ++i) {
+      EnqueueBatchRecvTensorRequestRaw();
+    }
 
     void* tag;
     bool ok;
@@ -174,6 +188,14 @@ class GrpcWorkerServiceThread {
     worker_->env()->compute_pool->Schedule(std::move(f));
   }
 
+  // Start tracing a call for the step `step_id`. Step IDs are assigned by the
+  // master, so the traces of one step can be matched up across workers.
+  static profiler::TraceMe* TraceRpc(StringPiece name, int64 step_id) {
+    return new profiler::TraceMe(
+        [&] { return strings::StrCat(name, ":", step_id); },
+        profiler::TraceMeLevel::kInfo);
+  }
+
   // The following section contains one request handler method per
   // RPC. The `FooHandler` method is called (indirectly) by
   // `HandleRPCsLoop()` when the next Foo RPC is received. Each
@@ -192,6 +214,7 @@ class GrpcWorkerServiceThread {
 #define HANDLE_CALL(method, may_block_on_compute_pool)                        \
   void method##Handler(WorkerCall<method##Request, method##Response>* call) { \
     auto closure = [this, call]() {                                           \
+      call->RecordHandlerStarted();                                           \
       Status s = worker_->method(&call->request, &call->response);            \
       if (!s.ok()) {                                                          \
         VLOG(1) << "Bad response from " << #method << ": " << s;              \
@@ -221,6 +244,7 @@ class GrpcWorkerServiceThread {
   void GetStepSequenceHandler(
       WorkerCall<GetStepSequenceRequest, GetStepSequenceResponse>* call) {
     Schedule([this, call]() {
+      call->RecordHandlerStarted();
       worker_->GetStepSequenceAsync(
           &call->request, &call->response, [call](const Status& s) {
             VLOG(1) << "Bad response from GetStepSequence:" << s;
@@ -240,6 +264,8 @@ class GrpcWorkerServiceThread {
 
   void RunGraphHandler(WorkerCall<RunGraphRequest, RunGraphResponse>* call) {
     Schedule([this, call]() {
+      call->RecordHandlerStarted();
+      auto* trace = TraceRpc("RunGraph/Server", call->request.step_id());
       CallOptions* call_opts = new CallOptions;
       ProtoRunGraphRequest* wrapped_request =
           new ProtoRunGraphRequest(&call->request);
@@ -248,7 +274,7 @@ class GrpcWorkerServiceThread {
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->RunGraphAsync(call_opts, wrapped_request, wrapped_response,
                              [call, call_opts, wrapped_request,
-                              wrapped_response](const Status& s) {
+                              wrapped_response, trace](const Status& s) {
                                VLOG(1) << "RunGraph::Done";
                                if (!s.ok()) {
                                  VLOG(1) << "Bad response from RunGraph:" << s;
@@ -257,6 +283,7 @@ class GrpcWorkerServiceThread {
                                delete call_opts;
                                delete wrapped_request;
                                delete wrapped_response;
+                               delete trace;
                                call->SendResponse(ToGrpcStatus(s));
                              });
     });
@@ -266,14 +293,17 @@ class GrpcWorkerServiceThread {
   void RecvTensorHandlerRaw(
       WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
     Schedule([this, call]() {
+      call->RecordHandlerStarted();
+      auto* trace = TraceRpc("RecvTensor/Server", call->request.step_id());
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
 
       worker_->GrpcRecvTensorAsync(
           call_opts, &call->request, &call->response,
-          [call, call_opts](const Status& s) {
+          [call, call_opts, trace](const Status& s) {
             call->ClearCancelCallback();
             delete call_opts;
+            delete trace;
             if (!s.ok()) {
               VLOG(1) << "Bad response from RecvTensor:" << s;
             }
@@ -283,14 +313,38 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void BatchRecvTensorHandlerRaw(
+      WorkerCall<BatchRecvTensorRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      call->RecordHandlerStarted();
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+
+      worker_->GrpcBatchRecvTensorAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(1) << "Bad response from BatchRecvTensor:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    EnqueueBatchRecvTensorRequestRaw();
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
+      call->RecordHandlerStarted();
+      auto* trace = TraceRpc("RecvBuf/Server", call->request.step_id());
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->RecvBufAsync(call_opts, &call->request, &call->response,
-                            [call, call_opts](const Status& s) {
+                            [call, call_opts, trace](const Status& s) {
                               call->ClearCancelCallback();
                               delete call_opts;
+                              delete trace;
                               if (!s.ok()) {
                                 VLOG(1) << "Bad response from RecvBuf:" << s;
                               }
@@ -303,6 +357,7 @@ class GrpcWorkerServiceThread {
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
+      call->RecordHandlerStarted();
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->CompleteGroupAsync(
@@ -322,6 +377,7 @@ class GrpcWorkerServiceThread {
   void CompleteInstanceHandler(
       WorkerCall<CompleteInstanceRequest, CompleteInstanceResponse>* call) {
     Schedule([this, call]() {
+      call->RecordHandlerStarted();
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->CompleteInstanceAsync(
@@ -340,6 +396,8 @@ class GrpcWorkerServiceThread {
 #undef ENQUEUE_REQUEST
 
   void EnqueueRecvTensorRequestRaw() {
+    static GrpcCallMetrics* const call_metrics = GrpcCallMetrics::Get(
+        GrpcWorkerMethodName(GrpcWorkerMethod::kRecvTensor));
     mutex_lock l(shutdown_mu_);
     if (!is_shutdown_) {
       Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
@@ -348,7 +406,22 @@ class GrpcWorkerServiceThread {
               worker_service_, cq_.get(),
               static_cast<int>(GrpcWorkerMethod::kRecvTensor),
               &GrpcWorkerServiceThread::RecvTensorHandlerRaw,
-              true /* supports cancel*/);
+              true /* supports cancel*/, call_metrics);
+    }
+  }
+
+  void EnqueueBatchRecvTensorRequestRaw() {
+    static GrpcCallMetrics* const call_metrics = GrpcCallMetrics::Get(
+        GrpcWorkerMethodName(GrpcWorkerMethod::kBatchRecvTensor));
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
+           BatchRecvTensorRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              worker_service_, cq_.get(),
+              static_cast<int>(GrpcWorkerMethod::kBatchRecvTensor),
+              &GrpcWorkerServiceThread::BatchRecvTensorHandlerRaw,
+              true /* supports cancel*/, call_metrics);
     }
   }
 
@@ -423,10 +496,36 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
       recv_buf_max_chunk_(
           config.experimental().recv_buf_max_chunk() > 0
               ? config.experimental().recv_buf_max_chunk()
-              : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)) {
+              : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)),
+      tensor_compression_algorithm_(
+          config.rpc_options().tensor_compression_algorithm()),
+      tensor_compression_min_bytes_(
+          config.rpc_options().tensor_compression_min_bytes()) {
   if (config.rpc_options().cache_rpc_response()) {
     EnableResponseCache();
   }
+  if (!tensor_compression_algorithm_.empty() &&
+      !grpc::IsSupportedTensorCompressionAlgorithm(
+          tensor_compression_algorithm_)) {
+    LOG(ERROR) << "Unsupported tensor_compression_algorithm \""
+               << tensor_compression_algorithm_
+               << "\"; tensors will be sent uncompressed.";
+    tensor_compression_algorithm_.clear();
+  }
+  for (int dtype : config.rpc_options().tensor_compression_dtypes()) {
+    tensor_compression_dtypes_.push_back(static_cast<DataType>(dtype));
+  }
+}
+
+bool GrpcWorker::ShouldCompressTensor(const Tensor& val) const {
+  return !tensor_compression_algorithm_.empty() &&
+         DataTypeCanUseMemcpy(val.dtype()) &&
+         static_cast<int64>(val.TotalBytes()) >=
+             std::max<int64>(tensor_compression_min_bytes_, 1) &&
+         (tensor_compression_dtypes_.empty() ||
+          std::find(tensor_compression_dtypes_.begin(),
+                    tensor_compression_dtypes_.end(),
+                    val.dtype()) != tensor_compression_dtypes_.end());
 }
 
 void GrpcWorker::EnableResponseCache() {
@@ -442,16 +541,27 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                      ::grpc::ByteBuffer* response,
                                      StatusCallback done) {
   VLOG(1) << "GrpcRecvTensorAsync req: " << request->DebugString();
+  if (request->chunked_request_id() != 0) {
+    GrpcRecvTensorChunkAsync(request, response, std::move(done));
+    return;
+  }
   const int64 request_id = request->request_id();
   const int64 step_id = request->step_id();
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  const bool accept_compressed = request->accept_compressed_content();
+  auto do_response = [this, response, done, cache_enabled, accept_compressed](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      if (!(accept_compressed && !is_dead && ShouldCompressTensor(tensor) &&
+            grpc::EncodeCompressedTensorToByteBuffer(
+                tensor, cache_enabled, tensor_compression_algorithm_,
+                response))) {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -510,11 +620,20 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       [step_id]() { LOG(WARNING) << "RecvTensor cancelled for " << step_id; });
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
-          const Status& status, const Rendezvous::Args& send_args,
-          const Rendezvous::Args& recv_args, const Tensor& val,
-          const bool is_dead) {
+      [this, opts, rendezvous_done, src_dev, request, response, done,
+       cache_enabled](const Status& status, const Rendezvous::Args& send_args,
+                      const Rendezvous::Args& recv_args, const Tensor& val,
+                      const bool is_dead) {
         opts->ClearCancelCallback();
+        // The response cache holds on to whole responses, so it is not
+        // combined with chunking.
+        if (status.ok() && !is_dead && !cache_enabled &&
+            request->max_chunk_bytes() > 0 && request->request_id() != 0 &&
+            DataTypeCanUseMemcpy(val.dtype()) &&
+            static_cast<int64>(val.TotalBytes()) > request->max_chunk_bytes()) {
+          SendTensorInChunks(request, src_dev, send_args, val, response, done);
+          return;
+        }
         if (status.ok()) {
           // DMA can only be used for Tensors that do not fall into
           // the following three odd edge cases: 1) a zero-size
@@ -555,6 +674,143 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::GrpcBatchRecvTensorAsync(
+    CallOptions* opts, const BatchRecvTensorRequest* request,
+    ::grpc::ByteBuffer* response, StatusCallback done) {
+  const int num_requests = request->requests_size();
+  VLOG(1) << "GrpcBatchRecvTensorAsync with " << num_requests << " requests";
+  if (num_requests == 0) {
+    response->Clear();
+    done(Status::OK());
+    return;
+  }
+  for (const RecvTensorRequest& r : request->requests()) {
+    if (r.chunked_request_id() != 0 || r.max_chunk_bytes() != 0 ||
+        r.accept_compressed_content()) {
+      done(errors::InvalidArgument(
+          "A batched RecvTensor request can not receive its tensor in chunks "
+          "or compressed: ",
+          r.rendezvous_key()));
+      return;
+    }
+  }
+  struct State {
+    mutex mu;
+    int pending GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+    std::vector<::grpc::ByteBuffer> responses;
+    // Each request sets and clears its own cancel callback.
+    std::unique_ptr<CallOptions[]> call_opts;
+  };
+  State* state = new State;
+  state->pending = num_requests;
+  state->responses.resize(num_requests);
+  state->call_opts.reset(new CallOptions[num_requests]);
+  opts->SetCancelCallback([state, num_requests]() {
+    for (int i = 0; i < num_requests; ++i) {
+      state->call_opts[i].StartCancel();
+    }
+  });
+  for (int i = 0; i < num_requests; ++i) {
+    GrpcRecvTensorAsync(
+        &state->call_opts[i], &request->requests(i), &state->responses[i],
+        [opts, state, response, done](const Status& s) {
+          Status status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(s);
+            if (--state->pending > 0) return;
+            status = state->status;
+          }
+          opts->ClearCancelCallback();
+          if (status.ok()) {
+            grpc::EncodeBatchRecvTensorResponseToByteBuffer(&state->responses,
+                                                            response);
+          }
+          delete state;
+          done(status);
+        });
+  }
+}
+
+void GrpcWorker::SendTensorInChunks(const RecvTensorRequest* request,
+                                    Device* src_dev,
+                                    const Rendezvous::Args& send_args,
+                                    const Tensor& val,
+                                    ::grpc::ByteBuffer* response,
+                                    StatusCallback done) {
+  const int64 request_id = request->request_id();
+  const int64 chunk_bytes = request->max_chunk_bytes();
+  if (src_dev->tensorflow_gpu_device_info() &&
+      !send_args.alloc_attrs.on_host()) {
+    DeviceContext* send_dev_context = send_args.device_context;
+    CHECK(send_dev_context)
+        << "send dev name: " << src_dev->name()
+        << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
+    AllocatorAttributes alloc_attrs;
+    alloc_attrs.set_gpu_compatible(true);
+    alloc_attrs.set_on_host(true);
+    Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+    Tensor copy(alloc, val.dtype(), val.shape());
+    chunked_tensors_.Insert(request_id, request->step_id(), copy, chunk_bytes,
+                            /*ready=*/false);
+    // Copy the chunks in order, so that the first ones can be sent while the
+    // rest are still being copied.
+    const int64 total_bytes = val.TotalBytes();
+    const TensorShape flat_shape({total_bytes});
+    Tensor flat_val;
+    Tensor flat_copy;
+    TF_CHECK_OK(flat_val.BitcastFrom(val, DT_UINT8, flat_shape));
+    TF_CHECK_OK(flat_copy.BitcastFrom(copy, DT_UINT8, flat_shape));
+    const int64 num_chunks =
+        GrpcChunkedTensorCache::NumChunks(total_bytes, chunk_bytes);
+    for (int64 i = 0; i < num_chunks; ++i) {
+      const int64 begin = i * chunk_bytes;
+      const int64 end = std::min(begin + chunk_bytes, total_bytes);
+      Tensor* src_chunk = new Tensor(flat_val.Slice(begin, end));
+      Tensor* dst_chunk = new Tensor(flat_copy.Slice(begin, end));
+      send_dev_context->CopyDeviceTensorToCPU(
+          src_chunk, request->rendezvous_key(), src_dev, dst_chunk,
+          [this, request_id, i, src_chunk, dst_chunk](const Status& s) {
+            chunked_tensors_.MarkChunkReady(request_id, i, s);
+            delete src_chunk;
+            delete dst_chunk;
+          });
+    }
+  } else {
+    chunked_tensors_.Insert(request_id, request->step_id(), val, chunk_bytes,
+                            /*ready=*/true);
+  }
+
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(Env::Default()->NowMicros());
+  TensorProto* tensor_proto = proto.mutable_tensor();
+  tensor_proto->set_dtype(val.dtype());
+  val.shape().AsProto(tensor_proto->mutable_tensor_shape());
+  RecvTensorChunkInfo chunk_info;
+  chunk_info.set_chunk_bytes(chunk_bytes);
+  proto.mutable_transport_options()->PackFrom(chunk_info);
+  grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+  done(Status::OK());
+}
+
+void GrpcWorker::GrpcRecvTensorChunkAsync(const RecvTensorRequest* request,
+                                          ::grpc::ByteBuffer* response,
+                                          StatusCallback done) {
+  // Chunk requests only read the state set up by the request that announced
+  // the tensor, so they can be retried and are not checked for uniqueness.
+  chunked_tensors_.GetChunk(
+      request->chunked_request_id(), request->chunk_offset(),
+      [response, done](const Tensor& tensor, int64 offset, int64 num_bytes,
+                       const Status& s) {
+        if (s.ok()) {
+          grpc::EncodeTensorChunkToByteBuffer(tensor, offset, num_bytes,
+                                              response);
+        }
+        done(s);
+      });
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -731,6 +987,8 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  // Likewise for tensors whose chunks were not all fetched.
+  chunked_tensors_.CleanEntriesForStep(request->step_id());
   Worker::CleanupGraphAsync(request, response, done);
 }
 
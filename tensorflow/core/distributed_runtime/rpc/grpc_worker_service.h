@@ -19,9 +19,12 @@ limitations under the License.
 #include <memory>
 #include <unordered_map>
 #include "grpcpp/server_builder.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_chunked_tensor_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace grpc {
@@ -32,6 +35,7 @@ namespace tensorflow {
 
 class AsyncServiceInterface;
 class ConfigProto;
+class Device;
 struct WorkerEnv;
 struct WorkerSession;
 class GrpcResponseCache;
@@ -46,6 +50,13 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Handles each of `request->requests()` as GrpcRecvTensorAsync does, and
+  // replies with all of their responses once the last one is ready.
+  void GrpcBatchRecvTensorAsync(CallOptions* opts,
+                                const BatchRecvTensorRequest* request,
+                                ::grpc::ByteBuffer* response,
+                                StatusCallback done);
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -63,8 +74,31 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64 request_id);
 
  private:
+  // Replies to `request` with the metadata of `val` and keeps `val` in
+  // `chunked_tensors_`, so that the receiver can fetch its contents in chunks
+  // with GrpcRecvTensorChunkAsync. A tensor on a GPU is copied to the host one
+  // chunk at a time, and each chunk can be sent as soon as it is copied.
+  void SendTensorInChunks(const RecvTensorRequest* request, Device* src_dev,
+                          const Rendezvous::Args& send_args, const Tensor& val,
+                          ::grpc::ByteBuffer* response, StatusCallback done);
+
+  // Replies to a chunk request with the raw bytes of the chunk.
+  void GrpcRecvTensorChunkAsync(const RecvTensorRequest* request,
+                                ::grpc::ByteBuffer* response,
+                                StatusCallback done);
+
+  // Returns true if the contents of `val` should be compressed with
+  // `tensor_compression_algorithm_` when it is sent to a receiver that accepts
+  // compressed contents.
+  bool ShouldCompressTensor(const Tensor& val) const;
+
   std::unique_ptr<GrpcResponseCache> response_cache_;
+  GrpcChunkedTensorCache chunked_tensors_;
   const int32 recv_buf_max_chunk_;
+  // From RPCOptions. Compression is disabled if the algorithm is empty.
+  string tensor_compression_algorithm_;
+  const int64 tensor_compression_min_bytes_;
+  DataTypeVector tensor_compression_dtypes_;
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
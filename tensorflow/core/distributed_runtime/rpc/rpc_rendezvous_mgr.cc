@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -32,11 +34,46 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// If positive, receives from the same worker that are issued within this many
+// microseconds of each other are sent as one BatchRecvTensor RPC.
+int64 RecvTensorBatchWindowMicros() {
+  static int64 window_micros = [] {
+    int64 value;
+    Status s = ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS", 0,
+                                   &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      value = 0;
+    }
+    return value;
+  }();
+  return window_micros;
+}
+
+// The largest number of receives that are sent in one batch. A batch is sent
+// as soon as it is full, without waiting for the end of the window.
+int64 RecvTensorMaxBatchSize() {
+  static int64 max_batch_size = [] {
+    int64 value;
+    Status s =
+        ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_MAX_BATCH_SIZE", 64, &value);
+    if (!s.ok() || value < 1) {
+      LOG(ERROR) << "Invalid TF_RPC_RECV_TENSOR_MAX_BATCH_SIZE: " << s;
+      value = 64;
+    }
+    return value;
+  }();
+  return max_batch_size;
+}
+
+class RpcRecvTensorCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
@@ -50,6 +87,31 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Sends the RecvTensor RPC of `call`.
+  void StartCall(RpcRecvTensorCall* call);
+
+  // Completes `call` with its status, and releases it.
+  void FinishCall(RpcRecvTensorCall* call);
+
+  // Adds `call` to the pending batch of its source worker, which is sent once
+  // it is full or the batch window has passed.
+  void AddToBatch(RpcRecvTensorCall* call);
+
+  // Sends the pending batch of receives from `src_worker`, if any.
+  void FlushBatch(const string& src_worker);
+
+  // Sends `calls`, which all receive from the same worker, as one
+  // BatchRecvTensor RPC, falling back to one RPC per call if that fails with
+  // Unimplemented.
+  void StartBatch(std::vector<RpcRecvTensorCall*> calls);
+
+  mutex batch_mu_;
+  // Receives that wait to be sent, by source worker.
+  std::unordered_map<string, std::vector<RpcRecvTensorCall*>> pending_batches_
+      GUARDED_BY(batch_mu_);
+  // The source workers that do not support BatchRecvTensor.
+  std::unordered_set<string> batching_unsupported_ GUARDED_BY(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -133,6 +195,22 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
  private:
   friend class RpcRemoteRendezvous;
 
+  // Prepares this call to be received as part of a batch, whose RPC is
+  // cancelled through `batch_opts` if this call is aborted.
+  void StartBatched(CallOptions* batch_opts) {
+    resp_.InitAlloc(dst_device_, alloc_attrs_);
+    opts_.SetCancelCallback([batch_opts]() { batch_opts->StartCancel(); });
+  }
+
+  // Records the outcome of a batch that this call was part of.
+  void FinishBatched(const Status& s) {
+    opts_.ClearCancelCallback();
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+  }
+
   // Start the main RecvTensor call, checking for an async abort.
   void StartRTCall(std::function<void()> recv_done) {
     resp_.InitAlloc(dst_device_, alloc_attrs_);
@@ -270,22 +348,132 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call]() {
-    // Removes "call" from active_. Prevent StartAbort().
-    DeregisterCall(call);
-    // If StartAbort was called prior to DeregisterCall, then the
-    // current status should be bad.
-    Status s = call->status();
-    // NOTE: `*session()` can potentially be deleted before we return from
-    // `call->done()(...)`, so we must release the worker before calling the
-    // callback.
-    call->ReleaseWorker(session()->worker_cache.get());
-    call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
-    get_call_freelist()->Release(call);
-    Unref();
-  });
+  if (RecvTensorBatchWindowMicros() > 0) {
+    AddToBatch(call);
+  } else {
+    StartCall(call);
+  }
 }
 
+void RpcRemoteRendezvous::StartCall(RpcRecvTensorCall* call) {
+  call->Start([this, call]() { FinishCall(call); });
+}
+
+void RpcRemoteRendezvous::FinishCall(RpcRecvTensorCall* call) {
+  // Removes "call" from active_. Prevent StartAbort().
+  DeregisterCall(call);
+  // If StartAbort was called prior to DeregisterCall, then the
+  // current status should be bad.
+  Status s = call->status();
+  // NOTE: `*session()` can potentially be deleted before we return from
+  // `call->done()(...)`, so we must release the worker before calling the
+  // callback.
+  call->ReleaseWorker(session()->worker_cache.get());
+  call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
+  get_call_freelist()->Release(call);
+  Unref();
+}
+
+void RpcRemoteRendezvous::AddToBatch(RpcRecvTensorCall* call) {
+  const string& src_worker = call->src_worker_;
+  std::vector<RpcRecvTensorCall*> full_batch;
+  bool schedule_flush = false;
+  {
+    mutex_lock l(batch_mu_);
+    if (batching_unsupported_.count(src_worker) == 0) {
+      std::vector<RpcRecvTensorCall*>& batch = pending_batches_[src_worker];
+      batch.push_back(call);
+      if (static_cast<int64>(batch.size()) >= RecvTensorMaxBatchSize()) {
+        full_batch.swap(batch);
+        pending_batches_.erase(src_worker);
+      } else {
+        schedule_flush = batch.size() == 1;
+      }
+      call = nullptr;
+    }
+  }
+  if (call != nullptr) {
+    StartCall(call);
+  } else if (!full_batch.empty()) {
+    StartBatch(std::move(full_batch));
+  } else if (schedule_flush) {
+    Ref();
+    env_->env->SchedClosureAfter(RecvTensorBatchWindowMicros(),
+                                 [this, src_worker]() {
+                                   FlushBatch(src_worker);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker) {
+  std::vector<RpcRecvTensorCall*> calls;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    if (it == pending_batches_.end()) return;
+    calls.swap(it->second);
+    pending_batches_.erase(it);
+  }
+  StartBatch(std::move(calls));
+}
+
+// The state of a BatchRecvTensor RPC.
+struct RpcRecvTensorBatch {
+  std::vector<RpcRecvTensorCall*> calls;
+  CallOptions opts;
+  BatchRecvTensorRequest req;
+};
+
+void RpcRemoteRendezvous::StartBatch(std::vector<RpcRecvTensorCall*> calls) {
+  RpcRecvTensorBatch* batch = new RpcRecvTensorBatch;
+  std::vector<TensorResponse*> responses;
+  for (RpcRecvTensorCall* call : calls) {
+    call->StartBatched(&batch->opts);
+    // A call that was aborted while it waited is not sent.
+    if (!call->status().ok()) {
+      call->FinishBatched(Status::OK());
+      FinishCall(call);
+      continue;
+    }
+    batch->calls.push_back(call);
+    *batch->req.add_requests() = call->req_;
+    responses.push_back(&call->resp_);
+  }
+  if (batch->calls.size() <= 1) {
+    for (RpcRecvTensorCall* call : batch->calls) {
+      call->FinishBatched(Status::OK());
+      StartCall(call);
+    }
+    delete batch;
+    return;
+  }
+  VLOG(2) << "Receiving " << batch->calls.size() << " tensors from "
+          << batch->calls[0]->src_worker_ << " in one batch";
+  batch->calls[0]->wi_->BatchRecvTensorAsync(
+      &batch->opts, &batch->req, std::move(responses),
+      [this, batch](const Status& s) {
+        if (errors::IsUnimplemented(s)) {
+          const string& src_worker = batch->calls[0]->src_worker_;
+          VLOG(1) << src_worker << " does not support BatchRecvTensor: " << s;
+          {
+            mutex_lock l(batch_mu_);
+            batching_unsupported_.insert(src_worker);
+          }
+          for (RpcRecvTensorCall* call : batch->calls) {
+            call->FinishBatched(Status::OK());
+            call->resp_.ClearTensor();
+            StartCall(call);
+          }
+        } else {
+          for (RpcRecvTensorCall* call : batch->calls) {
+            call->FinishBatched(s);
+            FinishCall(call);
+          }
+        }
+        delete batch;
+      });
+}
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
 
+#include <unordered_set>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -45,6 +46,37 @@ SessionMgr::SessionMgr(
           nullptr)),
       worker_cache_factory_(std::move(worker_cache_factory)) {}
 
+namespace {
+
+// Returns the names of the tasks of `old_cluster` that are missing from
+// `new_cluster` or have a different address in it.
+std::unordered_set<string> ChangedTargets(const ClusterDef& old_cluster,
+                                          const ClusterDef& new_cluster) {
+  std::unordered_set<string> changed_targets;
+  for (const auto& old_job : old_cluster.job()) {
+    const JobDef* new_job = nullptr;
+    for (const auto& job : new_cluster.job()) {
+      if (job.name() == old_job.name()) {
+        new_job = &job;
+        break;
+      }
+    }
+    for (const auto& task : old_job.tasks()) {
+      if (new_job != nullptr) {
+        auto it = new_job->tasks().find(task.first);
+        if (it != new_job->tasks().end() && it->second == task.second) {
+          continue;
+        }
+      }
+      changed_targets.insert(strings::StrCat("/job:", old_job.name(),
+                                             "/replica:0/task:", task.first));
+    }
+  }
+  return changed_targets;
+}
+
+}  // namespace
+
 /* static */
 string SessionMgr::WorkerNameFromServerDef(const ServerDef& server_def) {
   return strings::StrCat("/job:", server_def.job_name(),
@@ -135,6 +167,50 @@ Status SessionMgr::CreateSession(
   }
 
   sessions_.insert(std::make_pair(session, std::move(worker_session)));
+  if (!server_def.cluster().job().empty()) {
+    cluster_defs_[session] = server_def.cluster();
+  }
+  return Status::OK();
+}
+
+Status SessionMgr::UpdateSession(const string& session,
+                                 const ServerDef& server_def) {
+  mutex_lock l(mu_);
+  if (session.empty()) {
+    return errors::InvalidArgument("Session must be non-empty.");
+  }
+  auto it = sessions_.find(session);
+  if (it == sessions_.end()) {
+    return errors::InvalidArgument("Cannot update session ", session,
+                                   " because it does not exist.");
+  }
+  auto cluster_it = cluster_defs_.find(session);
+  if (cluster_it == cluster_defs_.end() ||
+      server_def.cluster().job().empty()) {
+    return errors::InvalidArgument(
+        "Session ", session,
+        " can only be updated with a ClusterSpec if it was created with one.");
+  }
+  const std::shared_ptr<WorkerSession>& worker_session = it->second;
+  const string worker_name = WorkerNameFromServerDef(server_def);
+  if (worker_name != worker_session->worker_name) {
+    return errors::InvalidArgument("Cannot update session ", session,
+                                   " of worker ", worker_session->worker_name,
+                                   " into a session of worker ", worker_name);
+  }
+
+  WorkerCacheInterface* worker_cache = nullptr;
+  TF_RETURN_IF_ERROR(worker_cache_factory_(server_def, &worker_cache));
+  if (worker_cache != nullptr && default_worker_cache_ != nullptr) {
+    worker_cache->SetLogging(this->is_logging_active_);
+  }
+  const std::unordered_set<string> changed_targets =
+      ChangedTargets(cluster_it->second, server_def.cluster());
+  VLOG(1) << "Updating the ClusterSpec of session " << session << ", "
+          << changed_targets.size() << " tasks were removed or moved";
+  worker_session->UpdateWorkerCache(
+      std::unique_ptr<WorkerCacheInterface>(worker_cache), changed_targets);
+  cluster_it->second = server_def.cluster();
   return Status::OK();
 }
 
@@ -144,6 +220,7 @@ Status SessionMgr::DeleteSession(const string& session) {
   if (it != sessions_.end()) {
     sessions_.erase(it);
   }
+  cluster_defs_.erase(session);
   return Status::OK();
 }
 
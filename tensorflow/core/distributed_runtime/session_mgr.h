@@ -53,6 +53,15 @@ class SessionMgr {
       const protobuf::RepeatedPtrField<DeviceAttributes>& device_attributes,
       bool isolate_session_state);
 
+  // Updates the ClusterSpec of an existing session that was created with one,
+  // without tearing down the session: the graphs registered with it stay
+  // registered, and the channels to the tasks whose address did not change
+  // are reused.  Only the partitions that involve tasks that were removed
+  // or moved need to be registered again.  `server_def` must name the same
+  // task as the one the session was created with.  The remote devices of
+  // the session, if any, are left unchanged.
+  Status UpdateSession(const string& session, const ServerDef& server_def);
+
   // Locates the worker session for a given session handle
   Status WorkerSessionForSession(const string& session_handle,
                                  std::shared_ptr<WorkerSession>* out_session);
@@ -98,6 +107,8 @@ class SessionMgr {
   mutex mu_;
   // A map from session identifier to internal session structure.
   std::map<string, std::shared_ptr<WorkerSession>> sessions_ GUARDED_BY(mu_);
+  // The ClusterSpec of the sessions that were created with one.
+  std::map<string, ClusterDef> cluster_defs_ GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -54,9 +55,24 @@ class SessionMgrTest : public ::testing::Test {
 
   std::unique_ptr<DeviceMgr> device_mgr_;
   WorkerEnv env_;
+  // The workers of the caches created by factory_.
+  std::vector<std::unique_ptr<TestWorkerInterface>> workers_;
   SessionMgr::WorkerCacheFactory factory_ =
-      [](const ServerDef& server_def, WorkerCacheInterface** worker_cache) {
-        *worker_cache = nullptr;  // Set to null to make debugging easier.
+      [this](const ServerDef& server_def, WorkerCacheInterface** worker_cache) {
+        if (server_def.cluster().job().empty()) {
+          *worker_cache = nullptr;  // Set to null to make debugging easier.
+          return Status::OK();
+        }
+        TestWorkerCache* cache = new TestWorkerCache;
+        for (const auto& job : server_def.cluster().job()) {
+          for (const auto& task : job.tasks()) {
+            workers_.emplace_back(new TestWorkerInterface);
+            cache->AddWorker(strings::StrCat("/job:", job.name(),
+                                             "/replica:0/task:", task.first),
+                             workers_.back().get());
+          }
+        }
+        *worker_cache = cache;
         return Status::OK();
       };
   SessionMgr mgr_;
@@ -152,6 +168,81 @@ TEST_F(SessionMgrTest, CreateSessionIsolateSessionState) {
   EXPECT_NE(devices_3[0]->resource_manager(), devices_4[0]->resource_manager());
 }
 
+TEST_F(SessionMgrTest, UpdateSession) {
+  ServerDef server_def;
+  server_def.set_job_name("worker");
+  server_def.set_task_index(0);
+  auto job = server_def.mutable_cluster()->add_job();
+  job->set_name("worker");
+  job->mutable_tasks()->insert({0, "localhost:3333"});
+  job->mutable_tasks()->insert({1, "localhost:3334"});
+  job->mutable_tasks()->insert({2, "localhost:3335"});
+
+  string session_handle = "test_session_handle";
+  TF_EXPECT_OK(mgr_.CreateSession(session_handle, server_def, true));
+  std::shared_ptr<WorkerSession> session;
+  TF_EXPECT_OK(mgr_.WorkerSessionForSession(session_handle, &session));
+  WorkerInterface* worker_1 =
+      session->worker_cache->GetOrCreateWorker("/job:worker/replica:0/task:1");
+  WorkerInterface* worker_2 =
+      session->worker_cache->GetOrCreateWorker("/job:worker/replica:0/task:2");
+  ASSERT_NE(nullptr, worker_1);
+  ASSERT_NE(nullptr, worker_2);
+  GraphMgr* graph_mgr = session->graph_mgr.get();
+
+  // Task 1 is unchanged, task 2 moves and task 3 joins.
+  (*job->mutable_tasks())[2] = "otherhost:3335";
+  job->mutable_tasks()->insert({3, "localhost:3336"});
+  TF_EXPECT_OK(mgr_.UpdateSession(session_handle, server_def));
+
+  std::shared_ptr<WorkerSession> updated_session;
+  TF_EXPECT_OK(mgr_.WorkerSessionForSession(session_handle, &updated_session));
+  EXPECT_EQ(session, updated_session);
+  EXPECT_EQ(graph_mgr, updated_session->graph_mgr.get());
+  EXPECT_EQ(worker_1, session->worker_cache->GetOrCreateWorker(
+                          "/job:worker/replica:0/task:1"));
+  WorkerInterface* new_worker_2 =
+      session->worker_cache->GetOrCreateWorker("/job:worker/replica:0/task:2");
+  EXPECT_NE(nullptr, new_worker_2);
+  EXPECT_NE(worker_2, new_worker_2);
+  EXPECT_NE(nullptr, session->worker_cache->GetOrCreateWorker(
+                         "/job:worker/replica:0/task:3"));
+  std::vector<string> workers;
+  session->worker_cache->ListWorkers(&workers);
+  EXPECT_EQ(4, workers.size());
+
+  TF_EXPECT_OK(mgr_.DeleteSession(session_handle));
+}
+
+TEST_F(SessionMgrTest, UpdateSessionErrors) {
+  ServerDef server_def;
+  server_def.set_job_name("worker");
+  server_def.set_task_index(0);
+  auto job = server_def.mutable_cluster()->add_job();
+  job->set_name("worker");
+  job->mutable_tasks()->insert({0, "localhost:3333"});
+
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(mgr_.UpdateSession("unknown", server_def)));
+
+  TF_EXPECT_OK(mgr_.CreateSession("handle", server_def, true));
+  ServerDef other_task = server_def;
+  other_task.set_task_index(1);
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(mgr_.UpdateSession("handle", other_task)));
+  ServerDef no_cluster = server_def;
+  no_cluster.clear_cluster();
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(mgr_.UpdateSession("handle", no_cluster)));
+  TF_EXPECT_OK(mgr_.DeleteSession("handle"));
+
+  // A session created without a ClusterSpec cannot be updated with one.
+  TF_EXPECT_OK(mgr_.CreateSession("handle", no_cluster, true));
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(mgr_.UpdateSession("handle", server_def)));
+  TF_EXPECT_OK(mgr_.DeleteSession("handle"));
+}
+
 TEST_F(SessionMgrTest, LegacySession) {
   string session_handle = "";
   std::shared_ptr<WorkerSession> session;
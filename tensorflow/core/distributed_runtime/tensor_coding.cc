@@ -142,6 +142,28 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
   return input->DecrementRecursionDepthAndPopLimit(p.first);
 }
 
+// Reads the "n" strings encoded by port::EncodeStringList in the next
+// "num_bytes" bytes of "input" directly into "strings", without copying the
+// encoded list first as TensorProto::tensor_content.
+bool ReadStringList(protobuf::io::CodedInputStream* input, int num_bytes,
+                    int64 n, tstring* strings) {
+  const int start = input->CurrentPosition();
+  int64 total_size = 0;
+  for (int64 i = 0; i < n; ++i) {
+    uint32 size;
+    if (!input->ReadVarint32(&size)) return false;
+    total_size += size;
+    // Check the sizes before allocating the strings.
+    if (total_size > num_bytes) return false;
+    strings[i].resize(size);
+  }
+  for (int64 i = 0; i < n; ++i) {
+    if (strings[i].empty()) continue;
+    if (!input->ReadRaw(&strings[i][0], strings[i].size())) return false;
+  }
+  return input->CurrentPosition() - start == num_bytes;
+}
+
 }  // namespace
 
 bool TensorResponse::ParseTensorSubmessage(
@@ -167,7 +189,10 @@ bool TensorResponse::ParseTensorSubmessage(
         if ((wt != WIRETYPE_VARINT) || !input->ReadVarint32(&v)) return false;
         if (seen_tensor_content) return false;
         tensor_meta->set_dtype(static_cast<DataType>(static_cast<int>(v)));
-        if (!DataTypeCanUseMemcpy(tensor_meta->dtype())) return false;
+        if (!DataTypeCanUseMemcpy(tensor_meta->dtype()) &&
+            tensor_meta->dtype() != DT_STRING) {
+          return false;
+        }
         break;
       }
       case TensorProto::kTensorShapeFieldNumber: {
@@ -197,6 +222,15 @@ bool TensorResponse::ParseTensorSubmessage(
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
         Tensor t(allocator_, tensor_meta->dtype(), shape);
+        if (tensor_meta->dtype() == DT_STRING) {
+          auto strings = t.flat<tstring>();
+          if (!ReadStringList(input, num_bytes, strings.size(),
+                              strings.data())) {
+            return false;
+          }
+          tensor_ = std::move(t);
+          break;
+        }
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
         // TODO(jeff,sanjay): Figure out a way to avoid this copy if
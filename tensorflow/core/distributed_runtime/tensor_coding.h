@@ -91,6 +91,10 @@ class TensorResponse {
   // Return pointer to the device hosting the tensor.
   DeviceBase* device() const { return device_; }
 
+  // Return true if the tensor is allocated in host memory, in which case
+  // ParseFrom() decodes its contents directly into the allocation.
+  bool on_host() const { return on_host_; }
+
  private:
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
@@ -156,6 +156,29 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, StringTensorWithEmptyStrings) {
+  Tensor a(DT_STRING, TensorShape({4}));
+  test::FillValues<string>(&a, {"", "abc", "", string(1000, 'x')});
+  Validate(a, false, true);
+}
+
+TEST_F(TensorResponseTest, CorruptStringTensor) {
+  Tensor src(DT_STRING, TensorShape({2}));
+  test::FillValues<string>(&src, {"abc", "def"});
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  // The first length covers more than the encoded strings.
+  (*proto.mutable_tensor()->mutable_tensor_content())[0] = 100;
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  StringSource source(&encoded, 1024);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  EXPECT_FALSE(response.ParseFrom(&source).ok());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -191,6 +214,28 @@ static void BM_TensorResponse(int iters, int arg) {
 }
 BENCHMARK(BM_TensorResponse)->Arg(0)->Arg(1000)->Arg(100000);
 
+static void BM_StringTensorResponse(int iters, int arg) {
+  testing::StopTiming();
+  Tensor src(DT_STRING, TensorShape({arg}));
+  auto strings = src.flat<tstring>();
+  for (int i = 0; i < arg; i++) {
+    strings(i) = strings::StrCat("This is string ", i);
+  }
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  DummyDevice cpu_device(Env::Default());
+  testing::StartTiming();
+  while (--iters > 0) {
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    StringSource source(&encoded, -1);
+    TF_CHECK_OK(response.ParseFrom(&source));
+  }
+}
+BENCHMARK(BM_StringTensorResponse)->Arg(1000)->Arg(100000);
+
 static void BM_TensorViaTensorProto(int iters, int arg) {
   testing::StopTiming();
   string encoded = MakeFloatTensorTestCase(arg);
@@ -28,7 +28,8 @@ limitations under the License.
 
 namespace tensorflow {
 
-Worker::Worker(WorkerEnv* env) : env_(env), recent_request_ids_(100000) {
+Worker::Worker(WorkerEnv* env)
+    : env_(env), recent_request_ids_(100000, /*num_shards=*/32) {
   // Enable log history collection in StatusGroup so that recent warning and
   // error log messages will be attached to the root error status to be
   // forwarded to the master.
@@ -25,26 +25,50 @@ auto* worker_session_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/core/worker_session_created",
                                     "True if a worker session was created.");
 
+}  // namespace
+
 // A private cache that wraps worker_cache and allows reuse of
 // WorkerInterface objects.
 class WorkerFreeListCache : public WorkerCacheInterface {
  public:
-  explicit WorkerFreeListCache(std::unique_ptr<WorkerCacheInterface> w)
-      : wrapped_(std::move(w)) {}
+  explicit WorkerFreeListCache(std::unique_ptr<WorkerCacheInterface> w) {
+    caches_.push_back(std::move(w));
+  }
 
   ~WorkerFreeListCache() final {
     for (auto& p : workers_) {
-      wrapped_->ReleaseWorker(p.first, p.second.worker);
+      p.second.owner->ReleaseWorker(p.first, p.second.worker);
+    }
+    for (auto& p : retired_workers_) {
+      p.second.owner->ReleaseWorker(p.first, p.second.worker);
+    }
+  }
+
+  // Makes `w` the cache from which new WorkerInterface objects are obtained.
+  // The cached objects for targets in `changed_targets` are no longer handed
+  // out but, as they may still be in use, are only released with this cache,
+  // as are the previous wrapped caches they depend on.
+  void Update(std::unique_ptr<WorkerCacheInterface> w,
+              const std::unordered_set<string>& changed_targets) {
+    mutex_lock l(mu_);
+    for (auto it = workers_.begin(); it != workers_.end();) {
+      if (changed_targets.count(it->first) > 0) {
+        retired_workers_.emplace_back(it->first, it->second);
+        it = workers_.erase(it);
+      } else {
+        ++it;
+      }
     }
+    caches_.push_back(std::move(w));
   }
 
   void ListWorkers(std::vector<string>* workers) const override {
-    wrapped_->ListWorkers(workers);
+    wrapped()->ListWorkers(workers);
   }
 
   void ListWorkersInJob(const string& job_name,
                         std::vector<string>* workers) const override {
-    wrapped_->ListWorkersInJob(job_name, workers);
+    wrapped()->ListWorkersInJob(job_name, workers);
   }
 
   WorkerInterface* GetOrCreateWorker(const string& target) override {
@@ -54,7 +78,8 @@ class WorkerFreeListCache : public WorkerCacheInterface {
       return p->second.worker;
     }
     WorkerState state;
-    state.worker = wrapped_->GetOrCreateWorker(target);
+    state.owner = caches_.back().get();
+    state.worker = state.owner->GetOrCreateWorker(target);
     if (state.worker != nullptr) {
       workers_.insert(std::make_pair(target, state));
     }
@@ -63,7 +88,7 @@ class WorkerFreeListCache : public WorkerCacheInterface {
 
   Status GetEagerClientCache(
       std::unique_ptr<eager::EagerClientCache>* eager_client_cache) override {
-    return wrapped_->GetEagerClientCache(eager_client_cache);
+    return wrapped()->GetEagerClientCache(eager_client_cache);
   }
 
   void ReleaseWorker(const string& target, WorkerInterface* worker) override {
@@ -72,38 +97,47 @@ class WorkerFreeListCache : public WorkerCacheInterface {
 
   bool GetDeviceLocalityNonBlocking(const string& device,
                                     DeviceLocality* locality) override {
-    return wrapped_->GetDeviceLocalityNonBlocking(device, locality);
+    return wrapped()->GetDeviceLocalityNonBlocking(device, locality);
   }
 
   void GetDeviceLocalityAsync(const string& device, DeviceLocality* locality,
                               StatusCallback done) override {
-    wrapped_->GetDeviceLocalityAsync(device, locality, done);
+    wrapped()->GetDeviceLocalityAsync(device, locality, done);
   }
 
-  void SetLogging(bool active) override { wrapped_->SetLogging(active); }
+  void SetLogging(bool active) override { wrapped()->SetLogging(active); }
 
-  void ClearLogs() override { wrapped_->ClearLogs(); }
+  void ClearLogs() override { wrapped()->ClearLogs(); }
 
   bool RetrieveLogs(int64 step_id, StepStats* ss) override {
-    return wrapped_->RetrieveLogs(step_id, ss);
+    return wrapped()->RetrieveLogs(step_id, ss);
   }
 
  private:
-  std::unique_ptr<WorkerCacheInterface> wrapped_;
+  // Returns the most recent wrapped cache.  The previous ones are never
+  // deleted before *this, so the returned pointer stays valid.
+  WorkerCacheInterface* wrapped() const {
+    mutex_lock l(mu_);
+    return caches_.back().get();
+  }
 
   // Information kept per created WorkerInterface.
   struct WorkerState {
     WorkerInterface* worker;
+    // The wrapped cache that created `worker`.
+    WorkerCacheInterface* owner;
     // TODO(jeff,sanjay): Add reference count if we support eviction.
   };
 
   // TODO(jeff,sanjay): Eviction when the map becomes too big.
-  mutex mu_;
+  mutable mutex mu_;
+  // Every cache wrapped so far, the current one last.
+  std::vector<std::unique_ptr<WorkerCacheInterface>> caches_ GUARDED_BY(mu_);
   std::unordered_map<string, WorkerState> workers_ GUARDED_BY(mu_);
+  std::vector<std::pair<string, WorkerState>> retired_workers_
+      GUARDED_BY(mu_);
 };
 
-}  // namespace
-
 WorkerSession::WorkerSession(const string& session_name,
                              const string& worker_name,
                              std::unique_ptr<WorkerCacheInterface> worker_cache,
@@ -120,6 +154,7 @@ WorkerSession::WorkerSession(const string& session_name,
       device_mgr_(std::move(device_mgr)),
       borrowed_device_mgr_(nullptr),
       remote_device_mgr_(std::move(remote_device_mgr)) {
+  free_list_cache_ = static_cast<WorkerFreeListCache*>(worker_cache.get());
   // Starts exporting metrics through a platform-specific monitoring API (if
   // provided). For builds using "tensorflow/core/platform/default", this is
   // currently a no-op.
@@ -153,6 +188,7 @@ WorkerSession::WorkerSession(const string& session_name,
       device_mgr_(nullptr),
       borrowed_device_mgr_(borrowed_device_mgr),
       remote_device_mgr_(std::move(remote_device_mgr)) {
+  free_list_cache_ = static_cast<WorkerFreeListCache*>(worker_cache.get());
   // Starts exporting metrics through a platform-specific monitoring API (if
   // provided). For builds using "tensorflow/core/platform/default", this is
   // currently a no-op.
@@ -160,6 +196,12 @@ WorkerSession::WorkerSession(const string& session_name,
   monitoring::StartExporter();
 }
 
+void WorkerSession::UpdateWorkerCache(
+    std::unique_ptr<WorkerCacheInterface> new_worker_cache,
+    const std::unordered_set<string>& changed_targets) {
+  free_list_cache_->Update(std::move(new_worker_cache), changed_targets);
+}
+
 WorkerSession::~WorkerSession() {
   if (graph_mgr) {
     Status s = graph_mgr->DeregisterAll();
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_SESSION_H_
 
 #include <string>
+#include <unordered_set>
 
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/distributed_runtime/cluster_function_library_runtime.h"
@@ -28,6 +29,7 @@ namespace tensorflow {
 class ClusterFunctionLibraryRuntime;
 class GraphMgr;
 class WorkerCacheInterface;
+class WorkerFreeListCache;
 
 // WorkerSession encapsulates all of the state relating to a given session.
 struct WorkerSession {
@@ -71,6 +73,14 @@ struct WorkerSession {
       DeviceMgr* borrowed_device_mgr, std::unique_ptr<GraphMgr> graph_mgr,
       std::unique_ptr<DeviceMgr> remote_device_mgr);
 
+  // Makes `new_worker_cache`, e.g. built for an updated ClusterSpec, the
+  // object from which new WorkerInterface instances are obtained.  The
+  // instances already obtained for targets that are not in `changed_targets`
+  // keep being handed out, so their channels are reused.  The graphs
+  // registered with graph_mgr are not affected.
+  void UpdateWorkerCache(std::unique_ptr<WorkerCacheInterface> new_worker_cache,
+                         const std::unordered_set<string>& changed_targets);
+
   ~WorkerSession();
 
  private:
@@ -83,6 +93,7 @@ struct WorkerSession {
   const std::unique_ptr<DeviceMgr> device_mgr_;
   DeviceMgr* const borrowed_device_mgr_;  // Not owned.
   const std::unique_ptr<DeviceMgr> remote_device_mgr_;
+  WorkerFreeListCache* free_list_cache_;  // Owned by worker_cache.
 };
 
 }  // namespace tensorflow
@@ -82,13 +82,20 @@ struct AllocatorStats {
   // if such a limit is known.
   absl::optional<int64> bytes_reservable_limit;
 
+  // Stats for allocators that keep freed memory in per-thread caches. Bytes
+  // held by such caches are included in bytes_in_use.
+  int64 bytes_in_thread_caches;  // Number of bytes held by thread caches.
+  int64 num_thread_cache_hits;   // Allocations served by a thread cache.
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
         peak_bytes_in_use(0),
         largest_alloc_size(0),
         bytes_reserved(0),
-        peak_bytes_reserved(0) {}
+        peak_bytes_reserved(0),
+        bytes_in_thread_caches(0),
+        num_thread_cache_hits(0) {}
 
   string DebugString() const;
 };
@@ -15,36 +15,26 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bfloat16.h"
 
+#include <cstring>
+
 namespace tensorflow {
 
+// Both conversions work on the 32-bit patterns of the floats rather than on
+// their 16-bit halves, so they don't depend on the byte order and the
+// compiler vectorizes them.
 void FloatToBFloat16(const float* src, bfloat16* dst, int64 size) {
-  const uint16_t* p = reinterpret_cast<const uint16_t*>(src);
-  uint16_t* q = reinterpret_cast<uint16_t*>(dst);
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-  for (; size != 0; p += 2, q++, size--) {
-    *q = p[0];
-  }
-#else
-  for (; size != 0; p += 2, q++, size--) {
-    *q = p[1];
+  for (int64 i = 0; i < size; ++i) {
+    uint32_t bits;
+    std::memcpy(&bits, src + i, sizeof(bits));
+    dst[i].value = static_cast<uint16_t>(bits >> 16);
   }
-#endif
 }
 
 void BFloat16ToFloat(const bfloat16* src, float* dst, int64 size) {
-  const uint16_t* p = reinterpret_cast<const uint16_t*>(src);
-  uint16_t* q = reinterpret_cast<uint16_t*>(dst);
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-  for (; size != 0; p++, q += 2, size--) {
-    q[0] = *p;
-    q[1] = 0;
-  }
-#else
-  for (; size != 0; p++, q += 2, size--) {
-    q[0] = 0;
-    q[1] = *p;
+  for (int64 i = 0; i < size; ++i) {
+    const uint32_t bits = static_cast<uint32_t>(src[i].value) << 16;
+    std::memcpy(dst + i, &bits, sizeof(bits));
   }
-#endif
 }
 
 }  // end namespace tensorflow
@@ -393,10 +393,17 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
                                     bool* end_of_sequence) {
   profiler::TraceMe activity([&] { return BuildTraceMeName(); },
                              profiler::TraceMeLevel::kInfo);
+  const bool record_get_next = collect_resource_usage(ctx);
+  const int64 start_nanos = record_get_next ? Env::Default()->NowNanos() : 0;
   RecordStart(ctx, /*stop_output=*/true);
   Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
   if (s.ok() && !*end_of_sequence) RecordElement(ctx);
   RecordStop(ctx, /*start_output=*/true);
+  if (record_get_next) {
+    const int64 bytes =
+        s.ok() && !*end_of_sequence ? GetAllocatedBytes(*out_tensors) : 0;
+    node_->record_get_next(bytes, Env::Default()->NowNanos() - start_nanos);
+  }
   if (TF_PREDICT_FALSE(errors::IsOutOfRange(s))) {
     s = errors::Internal("Iterator \"", params_.prefix,
                          "\" returned `OutOfRange`. This indicates an "
@@ -545,6 +545,10 @@ class IteratorBase {
     return RestoreInternal(ctx, reader);
   }
 
+  // Returns the performance model of the input pipeline rooted in this
+  // iterator, or nullptr if the iterator does not maintain one.
+  virtual std::shared_ptr<model::Model> model() const { return nullptr; }
+
  protected:
   // Returns a node that models this iterator.
   virtual std::shared_ptr<model::Node> CreateNode(
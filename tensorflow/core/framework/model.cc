@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <deque>
 #include <memory>
 
 #include "absl/time/clock.h"
@@ -711,6 +712,35 @@ void Model::AddProcessingTime(const string& name, int64 delta) {
   }
 }
 
+std::vector<NodeStats> Model::CollectStats() {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  std::vector<NodeStats> stats;
+  if (!output) return stats;
+  std::deque<std::shared_ptr<Node>> queue = {output};
+  while (!queue.empty()) {
+    std::shared_ptr<Node> node = queue.front();
+    queue.pop_front();
+    NodeStats node_stats;
+    node_stats.name = node->long_name();
+    if (node->output()) node_stats.output = node->output()->long_name();
+    node_stats.num_elements = node->num_elements();
+    node_stats.bytes_produced = node->bytes_produced();
+    node_stats.processing_time = node->processing_time();
+    node_stats.get_next_time = node->get_next_time();
+    node_stats.buffered_elements = node->buffered_elements();
+    node_stats.buffered_bytes = node->buffered_bytes();
+    stats.push_back(std::move(node_stats));
+    for (auto& input : node->inputs()) {
+      queue.push_back(input);
+    }
+  }
+  return stats;
+}
+
 void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
                      int64 ram_budget) {
   switch (algorithm) {
@@ -857,7 +887,9 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget) {
             std::max(max_abs_derivative, std::abs(gradient[pair.first]));
       }
     }
+    std::map<string, double> previous_values;
     for (auto& pair : parameters) {
+      previous_values[pair.first] = pair.second->value;
       new_value = pair.second->value -
                   kDescentStep * gradient[pair.first] / max_abs_derivative;
       // Projection on a feasible interval.
@@ -869,11 +901,33 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget) {
         pair.second->value = new_value;
       }
     }
+    // A step that would let the buffers grow past the memory budget is undone,
+    // so that the resulting parameters never exceed the budget.
+    if (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+      VLOG(2) << "Reverting the last optimization step because it would "
+                 "exceed the memory budget of "
+              << ram_budget << " bytes.";
+      for (auto& pair : parameters) {
+        pair.second->value = previous_values[pair.first];
+      }
+      break;
+    }
     output_time = new_output_time;
   }
-  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+  std::map<string, double> unrounded_values;
   for (auto& pair : parameters) {
+    unrounded_values[pair.first] = pair.second->value;
     pair.second->value = std::round(pair.second->value);
+  }
+  // Rounding up can exceed the memory budget, in which case the values are
+  // rounded down instead.
+  if (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+    for (auto& pair : parameters) {
+      pair.second->value = std::floor(unrounded_values[pair.first]);
+    }
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size();
+  for (auto& pair : parameters) {
     auto& parameter = pair.second;
     VLOG(2) << "Setting tunable parameter " << pair.first << " to "
             << parameter->value;
@@ -917,11 +971,19 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget) {
     }
     double best_delta = -1.0L;
     Parameter* best_parameter = nullptr;
+    bool reached_ram_budget = false;
     for (auto& pair : parameters) {
       if (pair.second->value == pair.second->max) {
         continue;
       }
       pair.second->value++;
+      // Increments that would let the buffers grow past the memory budget are
+      // not considered.
+      if (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+        reached_ram_budget = true;
+        pair.second->value--;
+        continue;
+      }
       double new_output_time = OutputTime(snapshot, /*gradient=*/nullptr);
       double delta = output_time - new_output_time;
       if (delta > best_delta &&
@@ -931,6 +993,12 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget) {
       }
       pair.second->value--;
     }
+    if (!best_parameter && reached_ram_budget) {
+      VLOG(2) << "Every remaining increment of a tunable parameter would "
+                 "exceed the memory budget of "
+              << ram_budget << " bytes.";
+      break;
+    }
     if (!best_parameter) {
       VLOG(2) << "Failed to find a tunable parameter that would decrease the "
                  "output time. This means that the autotuning optimization got "
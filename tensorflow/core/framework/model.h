@@ -158,6 +158,19 @@ class Node {
     return buffered_elements_;
   }
 
+  // Returns the number of bytes of the elements produced by the node.
+  int64 bytes_produced() const LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return bytes_produced_;
+  }
+
+  // Returns the aggregate time spent in calls to the node's `GetNext()`,
+  // including the time spent waiting for its inputs.
+  int64 get_next_time() const LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return get_next_time_;
+  }
+
   // Indicates whether the node has tunable parameters.
   bool has_tunable_parameters() const LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
@@ -211,6 +224,14 @@ class Node {
     num_elements_++;
   }
 
+  // Records that a call to the node's `GetNext()` took `time_nanos` and
+  // produced `bytes` bytes.
+  void record_get_next(int64 bytes, int64 time_nanos) LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    bytes_produced_ += bytes;
+    get_next_time_ += time_nanos;
+  }
+
   // Records that a node thread has started executing.
   void record_start(int64 time_nanos) LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
@@ -270,6 +291,8 @@ class Node {
     strings::StrAppend(&result, "  buffered_bytes=", buffered_bytes_, "\n");
     strings::StrAppend(&result, "  processing_time=", processing_time_, "\n");
     strings::StrAppend(&result, "  num_elements=", num_elements_, "\n");
+    strings::StrAppend(&result, "  bytes_produced=", bytes_produced_, "\n");
+    strings::StrAppend(&result, "  get_next_time=", get_next_time_, "\n");
     string inputs;
     for (auto& input : inputs_) {
       strings::StrAppend(&inputs, input->long_name(), ",");
@@ -499,6 +522,8 @@ class Node {
   int64 buffered_elements_ GUARDED_BY(mu_) = 0;
   int64 processing_time_ GUARDED_BY(mu_) = 0;
   int64 num_elements_ GUARDED_BY(mu_) = 0;
+  int64 bytes_produced_ GUARDED_BY(mu_) = 0;
+  int64 get_next_time_ GUARDED_BY(mu_) = 0;
   std::map<std::thread::id, int64> work_start_ GUARDED_BY(mu_);
   std::map<string, std::shared_ptr<Parameter>> parameters_ GUARDED_BY(mu_);
 
@@ -516,6 +541,24 @@ class Node {
   Node* const output_;
 };
 
+// A point-in-time copy of the counters of a `Node`. Times are in nanoseconds
+// and, like the byte counts, accumulate over the lifetime of the node.
+struct NodeStats {
+  // The unique name of the node, e.g. "ParallelMap(id:3)".
+  string name;
+  // The unique name of the node's output, or empty for the root of the model.
+  string output;
+  int64 num_elements = 0;
+  int64 bytes_produced = 0;
+  // Time spent in the node itself, excluding the time spent in its inputs.
+  int64 processing_time = 0;
+  // Time spent in calls to the node's `GetNext()`, including the time spent
+  // waiting for its inputs or, for asynchronous nodes, for its buffer.
+  int64 get_next_time = 0;
+  int64 buffered_elements = 0;
+  int64 buffered_bytes = 0;
+};
+
 // InterleaveMany is used to model datasets whose inputs are used to create
 // datasets whose elements are then interleaved.
 std::shared_ptr<Node> MakeInterleaveManyNode(Node::Args args);
@@ -577,6 +620,15 @@ class Model {
   // Indicates whether to collect resource usage.
   bool collect_resource_usage() const { return collect_resource_usage_; }
 
+  // Starts collecting resource usage even if the model has no tunable
+  // parameters, e.g. because a user asked for the statistics of the model.
+  void EnableResourceUsageCollection() { collect_resource_usage_ = true; }
+
+  // Returns the statistics of all nodes, with outputs preceding their inputs.
+  // Time and byte counts only cover the period during which resource usage was
+  // collected.
+  std::vector<NodeStats> CollectStats() LOCKS_EXCLUDED(mu_);
+
   // Adds a node with the given name and given output.
   std::shared_ptr<Node> AddNode(Node::Factory factory, const string& name,
                                 const string& output_name) LOCKS_EXCLUDED(mu_);
@@ -585,6 +637,10 @@ class Model {
   void AddProcessingTime(const string& name, int64 delta) LOCKS_EXCLUDED(mu_);
 
   // Uses the given algorithm to perform the autotuning optimization.
+  //
+  // `ram_budget` is the number of bytes that the buffers of the model's nodes
+  // may use in addition to what they already buffer. The optimization never
+  // picks parameters whose worst-case buffer size would exceed it.
   void Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget)
       LOCKS_EXCLUDED(mu_);
 
@@ -624,7 +680,9 @@ class Model {
   // parameter whose increase in parallelism decreases the output time the most.
   // This process is repeated until all parameters reach their maximum values or
   // the projected output time is less than or equal to the processing time
-  // needed to produce an element divided by CPU budget.
+  // needed to produce an element divided by CPU budget. Increments that would
+  // exceed the memory budget are skipped, and the process stops once no
+  // remaining increment fits in the budget.
   void OptimizeHillClimb(int64 cpu_budget, int64 ram_budget);
 
   // This optimization algorithm starts by setting all tunable parallelism
@@ -633,7 +691,8 @@ class Model {
   // projecting resulting values on the feasible intervals. Improvement step is
   // repeated until either the output time improvement is smaller than threshold
   // value or the output time is less than the processing time needed to produce
-  // an element divided by CPU budget.
+  // an element divided by CPU budget. A step that would exceed the memory
+  // budget is undone and ends the process.
   void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget);
 
   // Collects the output time and if `gradient` is not `nullptr`, the output
@@ -727,6 +727,82 @@ TEST(UnknownGradientTest, Model) {
               (new_output_time - output_time) / kParameterStep,
               kComparisonPrecision);
 }
+
+class OptimizeRamBudgetTest
+    : public ::testing::TestWithParam<AutotuneAlgorithm> {};
+
+TEST_P(OptimizeRamBudgetTest, Model) {
+  const AutotuneAlgorithm algorithm = GetParam();
+  std::shared_ptr<SharedState> parallelism = std::make_shared<SharedState>(
+      kAutotune, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  Model model(/*remove_node_hook=*/[](std::shared_ptr<Node>) {});
+  std::shared_ptr<Node> async_known_ratio = model.AddNode(
+      [parallelism](Node::Args args) {
+        return MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {MakeParameter(kParallelism, parallelism, /*min=*/1, /*max=*/16)});
+      },
+      "async_known_ratio", /*output_name=*/"");
+  std::shared_ptr<Node> source = model.AddNode(
+      [](Node::Args args) { return MakeSourceNode(std::move(args)); },
+      "source", "async_known_ratio");
+  source->add_processing_time(10000);
+  source->record_element();
+  async_known_ratio->add_processing_time(100000);
+  async_known_ratio->record_element();
+  // A single buffered element of 100 bytes, so every unit of parallelism
+  // accounts for 100 bytes of the worst-case buffer size.
+  async_known_ratio->record_buffer_event(100, 1);
+
+  // Without a memory limit, the expensive node would be given the maximum
+  // parallelism. The 100 bytes that are already buffered are excluded from
+  // the 250 byte budget, so at most 3 units of parallelism fit.
+  model.Optimize(algorithm, /*cpu_budget=*/64, /*ram_budget=*/250);
+  EXPECT_GE(parallelism->value, 1);
+  EXPECT_LE(parallelism->value, 3);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Test, OptimizeRamBudgetTest,
+    ::testing::Values(AutotuneAlgorithm::HILL_CLIMB,
+                      AutotuneAlgorithm::GRADIENT_DESCENT));
+
+TEST(CollectStatsTest, Model) {
+  Model model(/*remove_node_hook=*/[](std::shared_ptr<Node>) {});
+  EXPECT_TRUE(model.CollectStats().empty());
+  std::shared_ptr<Node> known_ratio = model.AddNode(
+      [](Node::Args args) {
+        return MakeKnownRatioNode(std::move(args), /*ratio=*/1);
+      },
+      "known_ratio", /*output_name=*/"");
+  std::shared_ptr<Node> source = model.AddNode(
+      [](Node::Args args) { return MakeSourceNode(std::move(args)); },
+      "source", "known_ratio");
+  known_ratio->add_processing_time(100);
+  known_ratio->record_element();
+  known_ratio->record_get_next(/*bytes=*/8, /*time_nanos=*/300);
+  source->add_processing_time(200);
+  source->record_element();
+  source->record_element();
+  source->record_get_next(/*bytes=*/16, /*time_nanos=*/200);
+
+  std::vector<NodeStats> stats = model.CollectStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].name, known_ratio->long_name());
+  EXPECT_EQ(stats[0].output, "");
+  EXPECT_EQ(stats[0].num_elements, 1);
+  EXPECT_EQ(stats[0].bytes_produced, 8);
+  EXPECT_EQ(stats[0].processing_time, 100);
+  EXPECT_EQ(stats[0].get_next_time, 300);
+  EXPECT_EQ(stats[1].name, source->long_name());
+  EXPECT_EQ(stats[1].output, known_ratio->long_name());
+  EXPECT_EQ(stats[1].num_elements, 2);
+  EXPECT_EQ(stats[1].bytes_produced, 16);
+  EXPECT_EQ(stats[1].processing_time, 200);
+  EXPECT_EQ(stats[1].get_next_time, 200);
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
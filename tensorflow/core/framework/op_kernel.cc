@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>  // NOLINT
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_def_util.h"
+#include "tensorflow/core/framework/step_arena_allocator.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -711,7 +713,13 @@ Status OpKernelContext::allocate_output(StringPiece name,
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+  return allocate_tensor_from(get_allocator(attr), type, shape, out_tensor,
+                              allocation_attr);
+}
+
+Status OpKernelContext::allocate_tensor_from(
+    Allocator* a, DataType type, const TensorShape& shape, Tensor* out_tensor,
+    const AllocationAttributes& allocation_attr) {
   Tensor new_tensor(a, type, shape,
                     AllocationAttributes(allocation_attr.no_retry_on_failure,
                                          /* allocation_will_be_logged= */ true,
@@ -766,8 +774,29 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
           " more than once.  Try turning off the ScopedAllocator optimizer.");
     }
   }
+  const Tensor* output_buffer = params_->output_buffers != nullptr
+                                   ? params_->output_buffers[index]
+                                   : nullptr;
+  if (output_buffer != nullptr && output_buffer->dtype() == type &&
+      output_buffer->shape() == shape && attr.value == 0 &&
+      attr.scope_id <= 0) {
+    outputs_[index] = TensorValue(new Tensor(*output_buffer));
+    *output = outputs_[index].tensor;
+    return Status::OK();
+  }
   auto output_tensor = MakeUnique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Allocator* planned_allocator =
+      params_->planned_output_allocators != nullptr
+          ? params_->planned_output_allocators[index]
+          : nullptr;
+  Status s;
+  if (planned_allocator != nullptr && attr.value == 0 && attr.scope_id <= 0 &&
+      !track_allocations()) {
+    s = allocate_tensor_from(planned_allocator, type, shape,
+                             output_tensor.get(), AllocationAttributes());
+  } else {
+    s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  }
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -795,6 +824,24 @@ Status OpKernelContext::allocate_temp(
             << ".  Switch to allocate_output to avoid performance penalty.";
     allocator_attr.scope_id = -1;
   }
+  StepArenaAllocator* arena = params_->step_arena;
+  if (arena != nullptr && !params_->log_memory &&
+      allocation_attr.freed_by_func == nullptr &&
+      get_allocator(allocator_attr) == arena->underlying_allocator()) {
+    // The temporary is freed with the rest of the step's arena. This path is
+    // not taken when allocations are tracked, since get_allocator() then
+    // returns a TrackingAllocator wrapper.
+    Tensor new_tensor(arena, type, shape);
+    if (new_tensor.IsInitialized()) {
+      record_tensor_reference(new_tensor);
+      *out_temp = std::move(new_tensor);
+      if (record_memory_consumption_) {
+        mutex_lock l(stats_mu_);
+        temp_memory_allocated_ += out_temp->TotalBytes();
+      }
+      return Status::OK();
+    }
+  }
   Status s =
       allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
@@ -1066,12 +1113,25 @@ struct KernelRegistration {
   std::unique_ptr<kernel_factory::OpKernelFactory> factory;
 };
 
+// A registration made by a static initializer, not yet added to the map.
+struct PendingKernelRegistration {
+  std::unique_ptr<const KernelDef> def;
+  string kernel_class_name;
+  std::unique_ptr<kernel_factory::OpKernelFactory> factory;
+};
+
 // This maps from 'op_type' + DeviceType to the set of KernelDefs and
 // factory functions for instantiating the OpKernel that matches the
 // KernelDef.
+//
+// Registrations are only queued in `pending` at static initialization time,
+// and are keyed and copied into `registry` on the first lookup, so that
+// binaries linking many kernels do not pay for building the map at startup.
 struct KernelRegistry {
   mutex mu;
   std::unordered_multimap<string, KernelRegistration> registry GUARDED_BY(mu);
+  std::vector<PendingKernelRegistration> pending GUARDED_BY(mu);
+  std::atomic<bool> has_pending{false};
 };
 
 #if defined(_WIN32)
@@ -1169,30 +1229,48 @@ void* GlobalKernelRegistry() {
   return global_kernel_registry;
 }
 
-static KernelRegistry* GlobalKernelRegistryTyped() {
-#ifdef AUTOLOAD_DYNAMIC_KERNELS
-  LoadDynamicKernels();
-#endif  // AUTOLOAD_DYNAMIC_KERNELS
-  return reinterpret_cast<KernelRegistry*>(GlobalKernelRegistry());
-}
-
 static string Key(StringPiece op_type, const DeviceType& device_type,
                   StringPiece label) {
   return strings::StrCat(op_type, ":", DeviceTypeString(device_type), ":",
                          label);
 }
 
+// Moves the registrations queued by OpKernelRegistrar into the map.
+static void FlushPendingKernelRegistrations(KernelRegistry* registry) {
+  if (!registry->has_pending.load(std::memory_order_acquire)) return;
+  mutex_lock l(registry->mu);
+  registry->registry.reserve(registry->registry.size() +
+                             registry->pending.size());
+  for (PendingKernelRegistration& p : registry->pending) {
+    const KernelDef& kernel_def = *p.def;
+    registry->registry.emplace(
+        Key(kernel_def.op(), DeviceType(kernel_def.device_type()),
+            kernel_def.label()),
+        KernelRegistration(kernel_def, p.kernel_class_name,
+                           std::move(p.factory)));
+  }
+  registry->pending.clear();
+  registry->pending.shrink_to_fit();
+  registry->has_pending.store(false, std::memory_order_release);
+}
+
+static KernelRegistry* GlobalKernelRegistryTyped() {
+#ifdef AUTOLOAD_DYNAMIC_KERNELS
+  LoadDynamicKernels();
+#endif  // AUTOLOAD_DYNAMIC_KERNELS
+  auto* registry = reinterpret_cast<KernelRegistry*>(GlobalKernelRegistry());
+  FlushPendingKernelRegistrations(registry);
+  return registry;
+}
+
 namespace kernel_factory {
 
 void OpKernelRegistrar::InitInternal(const KernelDef* kernel_def,
                                      StringPiece kernel_class_name,
                                      std::unique_ptr<OpKernelFactory> factory) {
+  std::unique_ptr<const KernelDef> owned_kernel_def(kernel_def);
   // See comments in register_kernel::Name in header for info on _no_register.
   if (kernel_def->op() != "_no_register") {
-    const string key =
-        Key(kernel_def->op(), DeviceType(kernel_def->device_type()),
-            kernel_def->label());
-
     // To avoid calling LoadDynamicKernels DO NOT CALL GlobalKernelRegistryTyped
     // here.
     // InitInternal gets called by static initializers, so it ends up executing
@@ -1202,12 +1280,14 @@ void OpKernelRegistrar::InitInternal(const KernelDef* kernel_def,
     // registration mechanism, we have this workaround here.
     auto global_registry =
         reinterpret_cast<KernelRegistry*>(GlobalKernelRegistry());
+    // The registration is keyed and added to the map on the first lookup,
+    // see FlushPendingKernelRegistrations.
     mutex_lock l(global_registry->mu);
-    global_registry->registry.emplace(
-        key,
-        KernelRegistration(*kernel_def, kernel_class_name, std::move(factory)));
+    global_registry->pending.push_back(
+        {std::move(owned_kernel_def), string(kernel_class_name),
+         std::move(factory)});
+    global_registry->has_pending.store(true, std::memory_order_release);
   }
-  delete kernel_def;
 }
 
 OpKernel* OpKernelRegistrar::PtrOpKernelFactory::Create(
@@ -76,6 +76,7 @@ class OpKernelContext;       // declared below,
 class OpRegistryInterface;
 class ResourceMgr;
 class ScopedStepContainer;
+class StepArenaAllocator;
 class CollectiveExecutor;
 class StepStatsCollectorInterface;
 
@@ -670,6 +671,10 @@ class OpKernelContext {
     // stored in this container..
     ScopedStepContainer* step_container = nullptr;
 
+    // If not null, allocate_temp() serves requests that would go to the
+    // arena's underlying allocator from this per-step arena instead.
+    StepArenaAllocator* step_arena = nullptr;
+
     // Mechanism used by this op kernel invocation to communicate with
     // computations running on other devices.
     Rendezvous* rendezvous = nullptr;
@@ -727,6 +732,19 @@ class OpKernelContext {
     // Values in [0,...) represent reservations for the indexed output.
     const int* forward_from_array = nullptr;
 
+    // Array indexed by output number for this node. If an entry is not
+    // null, allocate_output() allocates that output from it rather than from
+    // the device, unless the output has non-default allocator attributes.
+    // Used by executors that plan the memory of statically-shaped outputs.
+    Allocator* const* planned_output_allocators = nullptr;
+
+    // Array indexed by output number for this node. If an entry is not null,
+    // allocate_output() returns a tensor that shares the entry's buffer when
+    // the requested type and shape match it and the output has default
+    // allocator attributes. Used to write outputs directly into caller-owned
+    // memory.
+    const Tensor* const* output_buffers = nullptr;
+
     // For tracking actively running deferred ops.
     std::function<void()> inc_num_deferred_ops_function = []() {};
     std::function<void()> dec_num_deferred_ops_function = []() {};
@@ -1311,6 +1329,12 @@ class OpKernelContext {
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
 
+  // Like allocate_tensor(), but allocates from 'a' instead of the allocator
+  // selected by the attributes.
+  Status allocate_tensor_from(Allocator* a, DataType type,
+                              const TensorShape& shape, Tensor* out_tensor,
+                              const AllocationAttributes& allocation_attr);
+
   // Initialize the allocated_scope_ids_ set the first time this method is
   // called.
   void maybe_initialize_scope_id_set();
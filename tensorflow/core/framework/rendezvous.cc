@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <utility>
@@ -155,15 +156,15 @@ class LocalRendezvousImpl : public Rendezvous {
     uint64 key_hash = KeyHash(key.FullKey());
     VLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
 
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = GetShard(key_hash);
+    shard->mu.lock();
+    if (aborted_.load(std::memory_order_acquire)) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
-      return s;
+      shard->mu.unlock();
+      return status();
     }
 
-    ItemQueue* queue = &table_[key_hash];
+    ItemQueue* queue = &shard->table[key_hash];
     if (queue->empty() || queue->front()->IsSendValue()) {
       // There is no waiter for this message. Append the message
       // into the queue. The waiter will pick it up when arrives.
@@ -177,7 +178,7 @@ class LocalRendezvousImpl : public Rendezvous {
         item->send_args.device_context->Ref();
       }
       queue->push_back(item);
-      mu_.unlock();
+      shard->mu.unlock();
       return Status::OK();
     }
 
@@ -188,11 +189,11 @@ class LocalRendezvousImpl : public Rendezvous {
     // Delete the queue when the last element has been consumed.
     if (queue->size() == 1) {
       VLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-      table_.erase(key_hash);
+      shard->table.erase(key_hash);
     } else {
       queue->pop_front();
     }
-    mu_.unlock();
+    shard->mu.unlock();
 
     // Notify the waiter by invoking its done closure, outside the
     // lock.
@@ -207,16 +208,16 @@ class LocalRendezvousImpl : public Rendezvous {
     uint64 key_hash = KeyHash(key.FullKey());
     VLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = GetShard(key_hash);
+    shard->mu.lock();
+    if (aborted_.load(std::memory_order_acquire)) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
-      done(s, Args(), recv_args, Tensor(), false);
+      shard->mu.unlock();
+      done(status(), Args(), recv_args, Tensor(), false);
       return;
     }
 
-    ItemQueue* queue = &table_[key_hash];
+    ItemQueue* queue = &shard->table[key_hash];
     if (queue->empty() || !queue->front()->IsSendValue()) {
       // There is no message to pick up.
       // Only recv-related fields need to be filled.
@@ -225,18 +226,18 @@ class LocalRendezvousImpl : public Rendezvous {
       bool already_cancelled = false;
       if (cm != nullptr) {
         token = cm->get_cancellation_token();
-        already_cancelled = !cm->RegisterCallback(token, [this, token,
+        already_cancelled = !cm->RegisterCallback(token, [shard, token,
                                                           key_hash] {
           Item* item = nullptr;
           {
-            mutex_lock l(mu_);
-            ItemQueue* queue = &table_[key_hash];
+            mutex_lock l(shard->mu);
+            ItemQueue* queue = &shard->table[key_hash];
             if (!queue->empty() && !queue->front()->IsSendValue()) {
               for (auto it = queue->begin(); it != queue->end(); it++) {
                 if ((*it)->cancellation_token == token) {
                   item = *it;
                   if (queue->size() == 1) {
-                    table_.erase(key_hash);
+                    shard->table.erase(key_hash);
                   } else {
                     queue->erase(it);
                   }
@@ -255,7 +256,7 @@ class LocalRendezvousImpl : public Rendezvous {
         });
       }
       if (already_cancelled) {
-        mu_.unlock();
+        shard->mu.unlock();
         done(StatusGroup::MakeDerived(
                  errors::Cancelled("RecvAsync is cancelled.")),
              Args(), recv_args, Tensor(), /*is_dead=*/false);
@@ -288,7 +289,7 @@ class LocalRendezvousImpl : public Rendezvous {
         item->recv_args.device_context->Ref();
       }
       queue->push_back(item);
-      mu_.unlock();
+      shard->mu.unlock();
       return;
     }
 
@@ -300,11 +301,11 @@ class LocalRendezvousImpl : public Rendezvous {
     // Delete the queue when the last element has been consumed.
     if (queue->size() == 1) {
       VLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-      table_.erase(key_hash);
+      shard->table.erase(key_hash);
     } else {
       queue->pop_front();
     }
-    mu_.unlock();
+    shard->mu.unlock();
 
     // Invokes the done() by invoking its done closure, outside scope
     // of the table lock.
@@ -315,18 +316,26 @@ class LocalRendezvousImpl : public Rendezvous {
 
   void StartAbort(const Status& status) override {
     CHECK(!status.ok());
-    Table table;
     {
-      mutex_lock l(mu_);
+      mutex_lock l(status_mu_);
       status_.Update(status);
-      table_.swap(table);
+      aborted_.store(true, std::memory_order_release);
     }
-    for (auto& p : table) {
-      for (Item* item : p.second) {
-        if (!item->IsSendValue()) {
-          item->waiter(status, Args(), Args(), Tensor(), false);
+    // Items added to a shard before it is drained below are aborted here, and
+    // later Send and RecvAsync calls on it see `aborted_`.
+    for (Shard& shard : shards_) {
+      Table table;
+      {
+        mutex_lock l(shard.mu);
+        shard.table.swap(table);
+      }
+      for (auto& p : table) {
+        for (Item* item : p.second) {
+          if (!item->IsSendValue()) {
+            item->waiter(status, Args(), Args(), Tensor(), false);
+          }
+          delete item;
         }
-        delete item;
       }
     }
   }
@@ -369,13 +378,35 @@ class LocalRendezvousImpl : public Rendezvous {
   typedef std::deque<Item*> ItemQueue;
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ GUARDED_BY(mu_);
-  Status status_ GUARDED_BY(mu_);
+  // The table is sharded by key hash, so that the sends and receives of
+  // different keys, e.g. of the many cross-device edges of a step, rarely
+  // contend for the same lock.
+  struct Shard {
+    mutex mu;
+    Table table GUARDED_BY(mu);
+  };
+  static constexpr int kNumShards = 16;
+
+  Shard* GetShard(uint64 key_hash) { return &shards_[key_hash % kNumShards]; }
+
+  Status status() {
+    mutex_lock l(status_mu_);
+    return status_;
+  }
+
+  Shard shards_[kNumShards];
+  // Set once status_ is not OK.
+  std::atomic<bool> aborted_{false};
+  mutex status_mu_;
+  Status status_ GUARDED_BY(status_mu_);
 
   ~LocalRendezvousImpl() override {
-    if (!table_.empty()) {
+    bool empty = true;
+    for (Shard& shard : shards_) {
+      mutex_lock l(shard.mu);
+      empty = empty && shard.table.empty();
+    }
+    if (!empty) {
       StartAbort(errors::Cancelled("LocalRendezvousImpl deleted"));
     }
   }
@@ -394,6 +394,25 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
       errors::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+// Pending receives of many keys, which are spread over the shards of the
+// table, are all aborted by StartAbort().
+TEST_F(LocalRendezvousTest, AbortPendingRecvsOfManyKeys) {
+  const int N = 100;
+  int num_aborted = 0;
+  for (int i = 0; i < N; ++i) {
+    rendez_->RecvAsync(
+        MakeKey(strings::StrCat(i)), Rendezvous::Args(),
+        [&num_aborted](const Status& s, const Rendezvous::Args& send_args,
+                       const Rendezvous::Args& recv_args, const Tensor& val,
+                       const bool val_dead) {
+          if (errors::IsAborted(s)) ++num_aborted;
+        });
+  }
+  EXPECT_EQ(0, num_aborted);
+  rendez_->StartAbort(errors::Aborted(""));
+  EXPECT_EQ(N, num_aborted);
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_handle.h"
+#include "tensorflow/core/framework/step_arena_allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
@@ -104,15 +105,28 @@ class ScopedStepContainer {
         step_id_(step_id),
         cleanup_(cleanup) {}
 
-  ~ScopedStepContainer() { cleanup_(name_); }
+  ~ScopedStepContainer() {
+    cleanup_(name_);
+    if (step_arena_ != nullptr) step_arena_->Release();
+  }
 
   const string& name() const { return name_; }
   const int64 step_id() const { return step_id_; }
 
+  // Sets the arena that kernel temporaries of this step are allocated from.
+  // Takes over the creator's reference on "arena", which is released when
+  // the step container is destroyed.
+  void set_step_arena(StepArenaAllocator* arena) {
+    DCHECK(step_arena_ == nullptr);
+    step_arena_ = arena;
+  }
+  StepArenaAllocator* step_arena() const { return step_arena_; }
+
  private:
   const string name_;
   const int64 step_id_;
   const std::function<void(const string&)> cleanup_;
+  StepArenaAllocator* step_arena_ = nullptr;
 };
 
 class ResourceMgr {
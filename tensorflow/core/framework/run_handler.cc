@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/run_handler_util.h"
@@ -312,7 +313,8 @@ class RunHandlerThreadPool {
 
   // Set work queues from which the thread 'tid' can steal its work.
   // The request with start_request_idx will be attempted first. Other requests
-  // will be attempted in FIFO order based on their arrival time.
+  // will be attempted in the order of `thread_work_sources`, i.e. by priority,
+  // then deadline, then arrival time.
 
   // TODO(donglin) Change the task steal order to be round-robin such that if
   // an attempt to steal task from request i failed, then attempt to steal task
@@ -518,10 +520,24 @@ class RunHandler::Impl {
   // requested via RunHandlerPool::Get().
   uint64 start_time_us() const { return start_time_us_; }
   int64 step_id() const { return step_id_; }
+  int64 priority() const { return priority_; }
+  // Absolute deadline in microseconds since unix epoch, or the maximum uint64
+  // value if the request has no deadline.
+  uint64 deadline_us() const { return deadline_us_; }
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
-  void Reset(int64 step_id);
+  void Reset(int64 step_id,
+             const RunOptions::Experimental::RunHandlerPoolOptions& options);
+
+  // Returns true if this handler should be served before `other`.
+  bool ComesBefore(const Impl& other) const {
+    if (priority_ != other.priority_) return priority_ > other.priority_;
+    if (deadline_us_ != other.deadline_us_) {
+      return deadline_us_ < other.deadline_us_;
+    }
+    return start_time_us_ < other.start_time_us_;
+  }
 
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
 
@@ -544,6 +560,8 @@ class RunHandler::Impl {
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
   int64 step_id_;
+  int64 priority_;
+  uint64 deadline_us_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   ThreadWorkSource tws_;
 };
@@ -582,18 +600,26 @@ class RunHandlerPool::Impl {
     return run_handler_thread_pool_.get();
   }
 
-  std::unique_ptr<RunHandler> Get(int64 step_id) LOCKS_EXCLUDED(mu_) {
+  std::unique_ptr<RunHandler> Get(
+      int64 step_id,
+      const RunOptions::Experimental::RunHandlerPoolOptions& options)
+      LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
     while (free_handlers_.empty()) {
       one_handler_free_.wait(l);
     }
-    // Remove the last entry from free_handlers_ and add to the end of
+    // Remove the last entry from free_handlers_ and insert it into
     // sorted_active_handlers_.
     auto* handler_impl = free_handlers_.back();
-    handler_impl->Reset(step_id);
-    // Sortedness isn't violated if we simply add at the end of the list, since
-    // handlers are expected to be obtained in increasing order of time.
-    sorted_active_handlers_.push_back(handler_impl);
+    handler_impl->Reset(step_id, options);
+    // Handlers are obtained in increasing order of time, so without
+    // priorities or deadlines this always inserts at the end of the list.
+    auto pos = std::upper_bound(
+        sorted_active_handlers_.begin(), sorted_active_handlers_.end(),
+        handler_impl, [](const RunHandler::Impl* a, const RunHandler::Impl* b) {
+          return a->ComesBefore(*b);
+        });
+    sorted_active_handlers_.insert(pos, handler_impl);
     DCHECK_LE(sorted_active_handlers_.size(), max_handlers_);
     free_handlers_.pop_back();
 
@@ -643,8 +669,8 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by RunHandler::Impl::ComesBefore, i.e. by decreasing
+  // priority, then increasing deadline, then increasing start time.
   std::vector<RunHandler::Impl*> sorted_active_handlers_ GUARDED_BY(mu_);
   std::vector<RunHandler::Impl*> free_handlers_ GUARDED_BY(mu_);
   std::vector<std::unique_ptr<RunHandler::Impl>> handlers_ GUARDED_BY(mu_);
@@ -668,12 +694,21 @@ void RunHandlerPool::Impl::RecomputePoolStatsLocked() {
     thread_work_sources[i]->SetRank(i);
   }
 
+  // Threads only start from requests of the highest active priority, so lower
+  // priority requests are served only by threads that find no work there.
+  int num_top_priority_requests = 1;
+  while (num_top_priority_requests < num_active_requests &&
+         sorted_active_handlers_[num_top_priority_requests]->priority() ==
+             sorted_active_handlers_[0]->priority()) {
+    ++num_top_priority_requests;
+  }
+
   int num_threads = run_handler_thread_pool()->NumThreads();
   int num_blocking_threads = run_handler_thread_pool()->NumBlockingThreads();
   int num_non_blocking_threads = num_threads - num_blocking_threads;
 
   std::vector<int> request_idx_list = ChooseRequestsWithExponentialDistribution(
-      num_active_requests, num_blocking_threads);
+      num_top_priority_requests, num_blocking_threads);
   for (int i = 0; i < num_blocking_threads; ++i) {
     VLOG(2) << "Set work for tid=" << i
             << " with start_request_idx=" << request_idx_list[i];
@@ -682,7 +717,7 @@ void RunHandlerPool::Impl::RecomputePoolStatsLocked() {
   }
 
   request_idx_list = ChooseRequestsWithExponentialDistribution(
-      num_active_requests, num_non_blocking_threads);
+      num_top_priority_requests, num_non_blocking_threads);
   for (int i = 0; i < num_non_blocking_threads; ++i) {
     VLOG(2) << "Set work for tid=" << (i + num_blocking_threads)
             << " with start_request_idx=" << request_idx_list[i];
@@ -731,7 +766,7 @@ void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl) {
   thread_pool_interface_.reset(new ThreadPoolInterfaceWrapper(this));
-  Reset(0);
+  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions());
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -746,9 +781,15 @@ void RunHandler::Impl::ScheduleIntraOpClosure(std::function<void()> fn) {
                                                         std::move(fn));
 }
 
-void RunHandler::Impl::Reset(int64 step_id) {
+void RunHandler::Impl::Reset(
+    int64 step_id,
+    const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
+  priority_ = options.priority();
+  deadline_us_ = options.deadline_in_ms() > 0
+                     ? start_time_us_ + options.deadline_in_ms() * 1000
+                     : std::numeric_limits<uint64>::max();
   tws_.SetTracemeId(step_id);
 }
 
@@ -762,7 +803,14 @@ RunHandlerPool::RunHandlerPool(int num_inter_op_threads,
 RunHandlerPool::~RunHandlerPool() {}
 
 std::unique_ptr<RunHandler> RunHandlerPool::Get(int64 step_id) {
-  return impl_->Get(step_id);
+  return impl_->Get(step_id,
+                    RunOptions::Experimental::RunHandlerPoolOptions());
+}
+
+std::unique_ptr<RunHandler> RunHandlerPool::Get(
+    int64 step_id,
+    const RunOptions::Experimental::RunHandlerPoolOptions& options) {
+  return impl_->Get(step_id, options);
 }
 
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
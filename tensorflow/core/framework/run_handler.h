@@ -64,6 +64,13 @@ class RunHandlerPool {
   // Will block unless there is an inactive handler.
   std::unique_ptr<RunHandler> Get(int64 step_id = 0);
 
+  // As above, but the handler is scheduled according to `options`: handlers
+  // with a higher priority are served first, and handlers of equal priority
+  // are served earliest deadline first, then in order of the Get() calls.
+  std::unique_ptr<RunHandler> Get(
+      int64 step_id,
+      const RunOptions::Experimental::RunHandlerPoolOptions& options);
+
  private:
   class Impl;
   friend class RunHandler;
@@ -74,7 +81,7 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (the priority and deadline given to Get(), then the time of the Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
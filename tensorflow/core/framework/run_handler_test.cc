@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/synchronization/barrier.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -72,5 +73,64 @@ TEST(RunHandlerUtilTest, TestBasicScheduling) {
   counter.Wait();
 }
 
+// Occupies the only inter-op thread of a pool with a closure of `blocker`,
+// schedules one closure on each of `handlers` in turn and returns the order
+// in which the closures ran, as indices into `handlers`.
+std::vector<int> RunOrder(RunHandler* blocker,
+                          const std::vector<RunHandler*>& handlers) {
+  Notification blocker_started;
+  Notification release_blocker;
+  BlockingCounter done(handlers.size());
+  mutex mu;
+  std::vector<int> order;
+  blocker->ScheduleInterOpClosure([&]() {
+    blocker_started.Notify();
+    release_blocker.WaitForNotification();
+  });
+  blocker_started.WaitForNotification();
+  for (int i = 0; i < handlers.size(); ++i) {
+    handlers[i]->ScheduleInterOpClosure([&, i]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(i);
+      }
+      done.DecrementCount();
+    });
+  }
+  release_blocker.Notify();
+  done.Wait();
+  return order;
+}
+
+TEST(RunHandlerUtilTest, TestPriorityScheduling) {
+  RunHandlerPool pool(1);
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(2);
+  auto blocker = pool.Get(0, options);
+  options.set_priority(0);
+  auto batch = pool.Get(1, options);
+  options.set_priority(1);
+  auto latency = pool.Get(2, options);
+  // The latency handler is served first even though it was obtained last.
+  EXPECT_EQ(std::vector<int>({1, 0}),
+            RunOrder(blocker.get(), {batch.get(), latency.get()}));
+}
+
+TEST(RunHandlerUtilTest, TestDeadlineScheduling) {
+  RunHandlerPool pool(1);
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(1);
+  auto blocker = pool.Get(0, options);
+  options.set_priority(0);
+  auto no_deadline = pool.Get(1, options);
+  options.set_deadline_in_ms(3600 * 1000);
+  auto late = pool.Get(2, options);
+  options.set_deadline_in_ms(10);
+  auto early = pool.Get(3, options);
+  EXPECT_EQ(std::vector<int>({2, 1, 0}),
+            RunOrder(blocker.get(),
+                     {no_deadline.get(), late.get(), early.get()}));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/step_arena_allocator.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+StepArenaAllocator::StepArenaAllocator(Allocator* allocator,
+                                       size_t reserve_bytes)
+    : allocator_(allocator) {
+  if (reserve_bytes > 0) {
+    AllocationAttributes attr;
+    attr.no_retry_on_failure = true;
+    base_ = static_cast<char*>(
+        allocator_->AllocateRaw(kAllocatorAlignment, reserve_bytes, attr));
+    if (base_ != nullptr) {
+      capacity_ = reserve_bytes;
+    } else {
+      VLOG(1) << "StepArenaAllocator could not reserve " << reserve_bytes
+              << " bytes from " << allocator_->Name();
+    }
+  }
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  if (base_ != nullptr) {
+    allocator_->DeallocateRaw(base_);
+  }
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  // Every allocation starts at a multiple of kAllocatorAlignment from base_,
+  // which the underlying allocator aligns at least that much.
+  const size_t rounded_bytes =
+      (num_bytes + kAllocatorAlignment - 1) & ~(kAllocatorAlignment - 1);
+  bytes_requested_.fetch_add(rounded_bytes, std::memory_order_relaxed);
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  if (base_ != nullptr && alignment <= kAllocatorAlignment) {
+    size_t offset = offset_.load(std::memory_order_relaxed);
+    while (offset + rounded_bytes <= capacity_) {
+      if (offset_.compare_exchange_weak(offset, offset + rounded_bytes,
+                                        std::memory_order_relaxed)) {
+        num_arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+        return base_ + offset;
+      }
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr == nullptr) Unref();
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (!InArena(ptr)) {
+    allocator_->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+void StepArenaAllocator::Release() { Unref(); }
+
+void StepArenaAllocator::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+}  // namespace tensorflow
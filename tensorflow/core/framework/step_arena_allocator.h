@@ -0,0 +1,96 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_FRAMEWORK_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// StepArenaAllocator hands out the temporaries of one step by bumping a
+// pointer through a single block that it reserves from an underlying
+// allocator when the step starts. DeallocateRaw does not reuse memory; the
+// block is returned to the underlying allocator all at once, after the step
+// has ended and the last tensor allocated from it has been freed.
+//
+// Requests that do not fit in the remaining space of the block are passed
+// through to the underlying allocator. BytesRequested() reports the total
+// number of bytes the step asked for, so that the owner can reserve that
+// much for the next step and serve all of it from the block.
+//
+// Like TrackingAllocator, the arena deletes itself: the creator owns one
+// reference, which is dropped by Release(), and every live allocation holds
+// another.
+class StepArenaAllocator : public Allocator {
+ public:
+  // Reserves 'reserve_bytes' (which may be 0) from 'allocator', which must
+  // outlive the arena.
+  StepArenaAllocator(Allocator* allocator, size_t reserve_bytes);
+
+  string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Returns the allocator that the arena was reserved from.
+  Allocator* underlying_allocator() const { return allocator_; }
+
+  // Returns the total number of bytes requested so far, each request rounded
+  // up to kAllocatorAlignment, including requests that overflowed the block.
+  size_t BytesRequested() const {
+    return bytes_requested_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the number of requests served from the reserved block.
+  int64 NumArenaAllocations() const {
+    return num_arena_allocations_.load(std::memory_order_relaxed);
+  }
+
+  // Drops the creator's reference. The arena must not be used for new
+  // allocations afterwards. It is deleted once all outstanding allocations
+  // have been deallocated.
+  void Release();
+
+ private:
+  ~StepArenaAllocator() override;
+
+  // Drops one reference, deleting the arena when it was the last one.
+  void Unref();
+
+  bool InArena(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    return p >= base_ && p < base_ + capacity_;
+  }
+
+  Allocator* const allocator_;
+  char* base_ = nullptr;
+  size_t capacity_ = 0;
+  // Offset of the first free byte in the block.
+  std::atomic<size_t> offset_{0};
+  std::atomic<size_t> bytes_requested_{0};
+  std::atomic<int64> num_arena_allocations_{0};
+  // One for the creator plus one per live allocation.
+  std::atomic<int64> refs_{1};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_STEP_ARENA_ALLOCATOR_H_
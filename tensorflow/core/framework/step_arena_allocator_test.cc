@@ -0,0 +1,133 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/step_arena_allocator.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the allocations that reach the underlying allocator.
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    mutex_lock l(mu_);
+    ++num_allocs_;
+    void* p = cpu_allocator()->AllocateRaw(alignment, num_bytes);
+    live_[p] = num_bytes;
+    return p;
+  }
+  void DeallocateRaw(void* ptr) override {
+    mutex_lock l(mu_);
+    CHECK_EQ(1, live_.erase(ptr));
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int num_allocs() {
+    mutex_lock l(mu_);
+    return num_allocs_;
+  }
+  int num_live() {
+    mutex_lock l(mu_);
+    return live_.size();
+  }
+
+ private:
+  mutex mu_;
+  int num_allocs_ GUARDED_BY(mu_) = 0;
+  std::unordered_map<void*, size_t> live_ GUARDED_BY(mu_);
+};
+
+TEST(StepArenaAllocatorTest, ServesFromReservedBlock) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, 4096);
+  EXPECT_EQ(1, base.num_allocs());
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(0,
+              reinterpret_cast<uintptr_t>(p) % Allocator::kAllocatorAlignment);
+    ptrs.push_back(p);
+  }
+  EXPECT_EQ(1, base.num_allocs());
+  EXPECT_EQ(8, arena->NumArenaAllocations());
+  EXPECT_EQ(8 * 128, arena->BytesRequested());
+  for (void* p : ptrs) arena->DeallocateRaw(p);
+  // The block is only returned once the step has ended.
+  EXPECT_EQ(1, base.num_live());
+  arena->Release();
+  EXPECT_EQ(0, base.num_live());
+}
+
+TEST(StepArenaAllocatorTest, OverflowGoesToUnderlyingAllocator) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, 256);
+  void* a = arena->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  void* b = arena->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  EXPECT_EQ(2, base.num_allocs());
+  EXPECT_EQ(1, arena->NumArenaAllocations());
+  EXPECT_EQ(512, arena->BytesRequested());
+  arena->DeallocateRaw(b);
+  EXPECT_EQ(1, base.num_live());
+  arena->DeallocateRaw(a);
+  arena->Release();
+  EXPECT_EQ(0, base.num_live());
+
+  // A step reserving what the previous one requested needs a single call.
+  arena = new StepArenaAllocator(&base, 512);
+  a = arena->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  b = arena->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  EXPECT_EQ(3, base.num_allocs());
+  arena->DeallocateRaw(a);
+  arena->DeallocateRaw(b);
+  arena->Release();
+  EXPECT_EQ(0, base.num_live());
+}
+
+TEST(StepArenaAllocatorTest, TensorsOutliveStep) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, 1024);
+  Tensor t(arena, DT_FLOAT, TensorShape({4}));
+  t.flat<float>().setConstant(1.0f);
+  arena->Release();
+  // The block is kept alive by 't'.
+  EXPECT_EQ(1, base.num_live());
+  EXPECT_EQ(1.0f, t.flat<float>()(3));
+  t = Tensor();
+  EXPECT_EQ(0, base.num_live());
+}
+
+TEST(StepArenaAllocatorTest, NoReservation) {
+  CountingAllocator base;
+  StepArenaAllocator* arena = new StepArenaAllocator(&base, 0);
+  EXPECT_EQ(0, base.num_allocs());
+  void* p = arena->AllocateRaw(Allocator::kAllocatorAlignment, 10);
+  EXPECT_EQ(1, base.num_allocs());
+  EXPECT_EQ(64, arena->BytesRequested());
+  arena->Release();
+  EXPECT_EQ(1, base.num_live());
+  arena->DeallocateRaw(p);
+  EXPECT_EQ(0, base.num_live());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -48,6 +48,9 @@ class TensorReference {
     if (buf_) buf_->FillAllocationDescription(description);
   }
 
+  // Returns the start of the root buffer, as returned by its allocator.
+  const void* root_data() const { return buf_ ? buf_->data() : nullptr; }
+
   // Convenience function for de-duplicating tensor references.
   bool SharesBufferWith(const TensorReference& t) const {
     return buf_ == t.buf_;
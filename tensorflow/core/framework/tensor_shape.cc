@@ -311,7 +311,7 @@ void TensorShapeRep::SlowCopyFrom(const TensorShapeRep& b) {
       *(as64()->dims_) = *(b.as64()->dims_);
     } else {
       set_tag(REP_OUT_OF_LINE);
-      as64()->dims_ = new gtl::InlinedVector<int64, 4>(*(b.as64()->dims_));
+      as64()->dims_ = new gtl::InlinedVector<int64, 6>(*(b.as64()->dims_));
     }
   }
 }
@@ -458,7 +458,7 @@ void TensorShapeBase<Shape>::UnsafeAddDim(int64 size, int64 new_num_elements) {
     } else {
       set_tag(REP_OUT_OF_LINE);
       as64()->dims_ =
-          new gtl::InlinedVector<int64, 4>(vals.begin(), vals.end());
+          new gtl::InlinedVector<int64, 6>(vals.begin(), vals.end());
     }
   }
   set_ndims_byte(nd + 1);
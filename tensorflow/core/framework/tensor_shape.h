@@ -88,7 +88,8 @@ class TensorShapeRep {
   // Rep16: Supports up to 6 dimensions where each dimension is < 2^16 - 1
   // Rep32: Supports up to 3 dimensions where each dimension is < 2^32 - 1
   // Rep64: Supports arbitrary dimensionality, 64-bit dimensions using
-  //        an out of line vector.
+  //        an out of line vector, which keeps up to 6 dimensions (e.g. the 5-D
+  //        shapes of volumetric convolutions) in a single allocation.
   // For PartialTensorShape, a dimension of static_cast<uint??>(-1) is unknown.
   // This value is not allowed in TensorShape either for format compatibility.
   struct Rep16 {
@@ -98,7 +99,7 @@ class TensorShapeRep {
     uint32 dims_[3];
   };
   struct Rep64 {
-    gtl::InlinedVector<int64, 4>* dims_;
+    gtl::InlinedVector<int64, 6>* dims_;
   };
 
   // We use the max value of uint16 or uint32 to represent unknown shapes, so
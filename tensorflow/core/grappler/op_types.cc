@@ -95,6 +95,10 @@ bool IsAssert(const NodeDef& node) { return node.op() == "Assert"; }
 
 bool IsAtan2(const NodeDef& node) { return node.op() == "Atan2"; }
 
+bool IsBatchMatMul(const NodeDef& node) {
+  return node.op() == "BatchMatMul" || node.op() == "BatchMatMulV2";
+}
+
 bool IsBetainc(const NodeDef& node) { return node.op() == "Betainc"; }
 
 bool IsBiasAdd(const NodeDef& node) {
@@ -275,6 +279,10 @@ bool IsFusedBatchNormGrad(const NodeDef& node) {
          op == "FusedBatchNormGradV3";
 }
 
+bool IsGather(const NodeDef& node) {
+  return node.op() == "Gather" || node.op() == "GatherV2";
+}
+
 bool IsGreater(const NodeDef& node) { return node.op() == "Greater"; }
 
 bool IsGreaterEqual(const NodeDef& node) { return node.op() == "GreaterEqual"; }
@@ -454,6 +462,18 @@ bool IsRelu6Grad(const NodeDef& node) { return node.op() == "Relu6Grad"; }
 
 bool IsReshape(const NodeDef& node) { return (node.op() == "Reshape"); }
 
+bool IsResourceApplyAdam(const NodeDef& node) {
+  return node.op() == "ResourceApplyAdam";
+}
+
+bool IsResourceApplyMomentum(const NodeDef& node) {
+  return node.op() == "ResourceApplyMomentum";
+}
+
+bool IsResourceGather(const NodeDef& node) {
+  return node.op() == "ResourceGather";
+}
+
 bool IsRestore(const NodeDef& node) {
   return (node.op() == "Restore" || node.op() == "RestoreV2" ||
           node.op() == "RestoreSlice");
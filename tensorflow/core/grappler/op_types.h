@@ -41,6 +41,7 @@ bool IsAssert(const NodeDef& node);
 bool IsAssign(const NodeDef& node);
 bool IsAtan2(const NodeDef& node);
 bool IsAvgPoolGrad(const NodeDef& node);
+bool IsBatchMatMul(const NodeDef& node);
 bool IsBetainc(const NodeDef& node);
 bool IsBiasAdd(const NodeDef& node);
 bool IsBiasAddV2(const NodeDef& node);
@@ -83,6 +84,7 @@ bool IsFloorMod(const NodeDef& node);
 bool IsFusedBatchNorm(const NodeDef& node);
 bool IsFusedBatchNormEx(const NodeDef& node);
 bool IsFusedBatchNormGrad(const NodeDef& node);
+bool IsGather(const NodeDef& node);
 bool IsGreater(const NodeDef& node);
 bool IsGreaterEqual(const NodeDef& node);
 bool IsHistogramSummary(const NodeDef& node);
@@ -147,6 +149,9 @@ bool IsRelu6(const NodeDef& node);
 bool IsRelu6Grad(const NodeDef& node);
 bool IsReluGrad(const NodeDef& node);
 bool IsReshape(const NodeDef& node);
+bool IsResourceApplyAdam(const NodeDef& node);
+bool IsResourceApplyMomentum(const NodeDef& node);
+bool IsResourceGather(const NodeDef& node);
 bool IsRestore(const NodeDef& node);
 bool IsRetval(const NodeDef& node);
 bool IsReverse(const NodeDef& node);
@@ -48,6 +48,7 @@ const std::pair<int, int> kMinGPUArch = {7, 0};
 
 const char kSuffix[] = "AutoMixedPrecision";
 const char kCastToFp16[] = "CastToFp16";
+const char kCastToBf16[] = "CastToBf16";
 const char kCastToFp32[] = "CastToFp32";
 
 // Instances of this class represent unique type attribute identifiers within a
@@ -836,9 +837,13 @@ DataTypeSet AllowedDataTypes(const OpDef& op_def, const TypeAttrId& t_attr_id) {
   return AllowedDataTypes(*attr_def);
 }
 
+// Builds a Cast between DT_FLOAT and `f16_type`, which is DT_HALF or
+// DT_BFLOAT16.
 NodeDef BuildCastNode(const MutableGraphView::OutputPort& src, bool to_fp16,
-                      const string& device) {
-  const char* cast_string = to_fp16 ? kCastToFp16 : kCastToFp32;
+                      DataType f16_type, const string& device) {
+  const char* cast_string = !to_fp16                 ? kCastToFp32
+                            : f16_type == DT_BFLOAT16 ? kCastToBf16
+                                                      : kCastToFp16;
   string name = strings::StrCat(src.node->name(), "-", src.port_id, "-",
                                 cast_string, "-", kSuffix);
   NodeDef node;
@@ -846,8 +851,8 @@ NodeDef BuildCastNode(const MutableGraphView::OutputPort& src, bool to_fp16,
   node.set_op("Cast");
   node.set_device(device);
   node.add_input(strings::StrCat(src.node->name(), ":", src.port_id));
-  (*node.mutable_attr())["SrcT"].set_type(to_fp16 ? DT_FLOAT : DT_HALF);
-  (*node.mutable_attr())["DstT"].set_type(to_fp16 ? DT_HALF : DT_FLOAT);
+  (*node.mutable_attr())["SrcT"].set_type(to_fp16 ? DT_FLOAT : f16_type);
+  (*node.mutable_attr())["DstT"].set_type(to_fp16 ? f16_type : DT_FLOAT);
   (*node.mutable_attr())["Truncate"].set_b(false);
   return node;
 }
@@ -937,8 +942,12 @@ class AutoMixedPrecisionImpl {
  public:
   AutoMixedPrecisionImpl(Cluster* cluster,
                          const std::unordered_set<string>& nodes_to_preserve,
-                         GraphDef* graph, string id)
-      : virtual_placer_(cluster->GetDevices()),
+                         GraphDef* graph, string id,
+                         AutoMixedPrecisionMode mode)
+      : mode_(mode),
+        target_dtype_(mode == AutoMixedPrecisionMode::CPU ? DT_BFLOAT16
+                                                          : DT_HALF),
+        virtual_placer_(cluster->GetDevices()),
         nodes_to_preserve_(nodes_to_preserve),
         graph_(graph),
         function_library_(OpRegistry::Global(), graph->library()),
@@ -959,7 +968,7 @@ class AutoMixedPrecisionImpl {
   Status PrintDebugLogs(bool preop, size_t timestamp);
   void LogSkippedNode(const NodeDef& node) const;
   bool MustPreserve(const NodeDef& node) const;
-  bool IsOnGPU(const NodeDef& node) const;
+  bool IsOnDevice(const NodeDef& node, const string& device_type) const;
   bool IsScopeDisabled(const NodeDef& node) const;
   bool IsOnSuitableGPUArch(const NodeDef& node) const;
   bool ShouldProcess(const NodeDef& node) const;
@@ -997,6 +1006,10 @@ class AutoMixedPrecisionImpl {
                                     int* num_nodes_changed,
                                     int* num_nonvar_casts_to_fp16);
 
+  AutoMixedPrecisionMode mode_;
+  // The type that white nodes are converted to, DT_HALF on GPU and
+  // DT_BFLOAT16 on CPU.
+  DataType target_dtype_;
   VirtualPlacer virtual_placer_;
   std::unordered_set<string> nodes_to_preserve_;
   GraphDef* graph_;
@@ -1022,7 +1035,7 @@ bool AutoMixedPrecisionImpl::NodeHasFP16KernelForTypeAttr(
     string device_name = virtual_placer_.get_canonical_device_name(node);
     node_copy.set_device(device_name);
   }
-  if (!SetDataType(&node_copy, taid, DataType::DT_HALF)) {
+  if (!SetDataType(&node_copy, taid, target_dtype_)) {
     return false;
   }
   return IsKernelRegisteredForNode(node_copy).ok();
@@ -1082,8 +1095,7 @@ Status AutoMixedPrecisionImpl::PrintDebugLogs(bool preop, size_t timestamp) {
                          strings::StrCat("paintbuckets", suffix, ".txt"));
     f.open(fname.c_str(), std::fstream::out);
     f << "WhiteList:\n";
-    for (auto x : AutoMixedPrecisionLists::WhiteList(cuda_version_,
-                                                     cudnn_version_)) {
+    for (auto x : fp16_whitelist_) {
       f << x << "\n";
     }
     f << "\nBlackList:\n";
@@ -1109,14 +1121,17 @@ void AutoMixedPrecisionImpl::LogSkippedNode(const NodeDef& node) const {
           << " because it "
           << (MustPreserve(node)
                   ? "must be preserved"
-                  : "is not on the GPU, or the GPU arch is not suitable");
+                  : mode_ == AutoMixedPrecisionMode::CPU
+                        ? "is not on the CPU"
+                        : "is not on the GPU, or the GPU arch is not suitable");
 }
 
 bool AutoMixedPrecisionImpl::MustPreserve(const NodeDef& node) const {
   return nodes_to_preserve_.count(node.name());
 }
 
-bool AutoMixedPrecisionImpl::IsOnGPU(const NodeDef& node) const {
+bool AutoMixedPrecisionImpl::IsOnDevice(const NodeDef& node,
+                                        const string& device_type) const {
   string device_name;
   if (node.device().empty()) {
     device_name = virtual_placer_.get_canonical_device_name(node);
@@ -1127,7 +1142,7 @@ bool AutoMixedPrecisionImpl::IsOnGPU(const NodeDef& node) const {
   string not_used;
   if (DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
       absl::StrContains(absl::AsciiStrToLower(device),
-                        absl::AsciiStrToLower(DEVICE_GPU))) {
+                        absl::AsciiStrToLower(device_type))) {
     return true;
   }
   return false;
@@ -1207,7 +1222,7 @@ bool AutoMixedPrecisionImpl::SupportsFloat16(
       OpRegistry::Global()->LookUpOpDef(node_type.node->op(), &op_def);
   if (!status.ok()) return false;
   return AllowedDataTypes(*op_def, node_type.type_attr)
-             .Contains(DataType::DT_HALF) &&
+             .Contains(target_dtype_) &&
          NodeHasFP16KernelForTypeAttr(*node_type.node, node_type.type_attr);
 }
 
@@ -1256,8 +1271,10 @@ Status AutoMixedPrecisionImpl::Optimize() {
   optimization_level = absl::AsciiStrToUpper(optimization_level);
   force_all_fp16_ = optimization_level == "UNSAFE_FORCE_ALL";
 
-  fp16_whitelist_ = AutoMixedPrecisionLists::WhiteList(cuda_version_,
-                                                       cudnn_version_);
+  fp16_whitelist_ = mode_ == AutoMixedPrecisionMode::CPU
+                        ? AutoMixedPrecisionLists::CpuWhiteList()
+                        : AutoMixedPrecisionLists::WhiteList(cuda_version_,
+                                                             cudnn_version_);
   fp16_blacklist_ = AutoMixedPrecisionLists::BlackList();
   fp16_graylist_ = AutoMixedPrecisionLists::GrayList();
   fp16_clearlist_ = AutoMixedPrecisionLists::ClearList();
@@ -1269,8 +1286,12 @@ Status AutoMixedPrecisionImpl::Optimize() {
 
   VLOG(2) << "Identifying nodes that should be processed";
   for (const NodeDef& node : graph_->node()) {
-    if (!MustPreserve(node) && IsOnGPU(node) && !IsScopeDisabled(node) &&
-        (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node))) {
+    const bool on_suitable_device =
+        mode_ == AutoMixedPrecisionMode::CPU
+            ? IsOnDevice(node, DEVICE_CPU)
+            : IsOnDevice(node, DEVICE_GPU) &&
+                  (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node));
+    if (!MustPreserve(node) && on_suitable_device && !IsScopeDisabled(node)) {
       should_process_nodes_.insert(&node);
     } else {
       LogSkippedNode(node);
@@ -1876,8 +1897,8 @@ void AutoMixedPrecisionImpl::MakeCastsWhiteIfAllOutputsWhite(
   }
 }
 
-// Changes all white-painted type attributes to DT_HALF, and inserts Cast nodes
-// at node outputs for all edges that connect white-painted <->
+// Changes all white-painted type attributes to target_dtype_, and inserts Cast
+// nodes at node outputs for all edges that connect white-painted <->
 // non-white-painted type attributes.
 Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
     const absl::flat_hash_set<int>& white_set, int* num_nodes_changed,
@@ -1898,8 +1919,9 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
       bool src_is_white = white_set.count(node_type_idx);
       if (src_is_white) {
         VLOG(1) << "Changing type " << type_attr.DebugString() << " of "
-                << node->op() << " node " << node->name() << " to DT_HALF";
-        if (!SetDataType(node, type_attr, DT_HALF)) {
+                << node->op() << " node " << node->name() << " to "
+                << DataTypeString(target_dtype_);
+        if (!SetDataType(node, type_attr, target_dtype_)) {
           return errors::Internal("Failed to set type attribute");
         }
         ++*num_nodes_changed;
@@ -1926,11 +1948,13 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
             if (!added_cast_node) {
               bool to_fp16 = dst_is_white;
               VLOG(1) << "Inserting cast to "
-                      << (to_fp16 ? "DT_HALF" : "DT_FLOAT") << " at "
+                      << DataTypeString(to_fp16 ? target_dtype_ : DT_FLOAT)
+                      << " at "
                       << src.node->op() << " " << src.node->name() << ":"
                       << src.port_id;
               added_cast_node = graph_view_.AddNode(
-                  BuildCastNode(src, to_fp16, src.node->device()));
+                  BuildCastNode(src, to_fp16, target_dtype_,
+                                src.node->device()));
               if (to_fp16 && !IsConstant(*node) && !IsVariable(*node) &&
                   !NodeImplicitlyReadsNonResourceVariable(*node)) {
                 ++*num_nonvar_casts_to_fp16;
@@ -1971,18 +1995,21 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
   // Start by copying input graph to output.
   *output = item.graph;
 
-  int num_gpus = ShouldIgnorePerformance() ? GetNumGPUs(*cluster)
-                                           : GetNumGPUs(*cluster, kMinGPUArch);
-  if (num_gpus < 1) {
-    // AutoMixedPrecision is currently only tuned for GPU.
-    LOG(WARNING) << "No (suitable) GPUs detected, skipping " << name()
-                 << " graph optimizer";
-    return Status::OK();
+  if (mode_ == AutoMixedPrecisionMode::CUDA) {
+    int num_gpus = ShouldIgnorePerformance()
+                       ? GetNumGPUs(*cluster)
+                       : GetNumGPUs(*cluster, kMinGPUArch);
+    if (num_gpus < 1) {
+      // The CUDA mode is only tuned for GPUs with Tensor Cores.
+      LOG(WARNING) << "No (suitable) GPUs detected, skipping " << name()
+                   << " graph optimizer";
+      return Status::OK();
+    }
   }
 
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
-                                   item.id);
+                                   item.id, mode_);
   if (item.id == "tf_graph") {
     LOG(INFO) << "Running " << name() << " graph optimizer";
   } else {
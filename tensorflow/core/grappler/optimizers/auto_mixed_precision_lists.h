@@ -99,6 +99,27 @@ class AutoMixedPrecisionLists {
     return list;
   }
 
+  // Returns the set of ops that are always converted to bfloat16 on CPU. CPUs
+  // have no faster bfloat16 arithmetic, so these are the ops whose operands
+  // dominate the memory traffic. The gray, black and clear lists are the same
+  // as for fp16.
+  static gtl::FlatSet<string> CpuWhiteList() {
+    string to_add, to_remove;
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_WHITELIST_ADD", "", &to_add));
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_WHITELIST_REMOVE", "",
+        &to_remove));
+
+    auto list = gtl::FlatSet<string>{
+        "BatchMatMul",
+        "BatchMatMulV2",
+        "MatMul",
+    };
+    UpdateList(&list, to_add, to_remove);
+    return list;
+  }
+
   // Returns the set of ops that are considered numerically-safe (for execution
   // in fp16), but which may be made unsafe by an upstream blacklist op.
   static gtl::FlatSet<string> GrayList() {
@@ -61,6 +61,24 @@ NodeDef* AutoParallel::AddNodeDiv(const string& name, const string& input_a,
   return node;
 }
 
+NodeDef* AutoParallel::AddNodeGradientSum(const string& name,
+                                          const string& gradient) {
+  NodeDef* node = graph_.add_node();
+  node->set_name(strings::StrCat(kAutoParallelPrefix, "-Sum-", name));
+  node->set_op("AddN");
+  // The inputs are replaced with the gradients of every replica in
+  // AddSharedNodes().
+  node->add_input(gradient);
+  AttrValue attr_n;
+  attr_n.set_i(num_replicas_);
+  node->mutable_attr()->insert({"N", attr_n});
+  AttrValue attr_type;
+  attr_type.set_type(DT_FLOAT);
+  node->mutable_attr()->insert({"T", attr_type});
+  gradient_sums_[node->name()] = gradient;
+  return node;
+}
+
 NodeDef* AutoParallel::AddNodeControl(const string& name,
                                       const std::set<string>& deps,
                                       GraphDef* graph) {
@@ -137,10 +155,15 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
     auto apply_gradients_op = all_nodes_[apply_gradient_node_name]->op();
     auto apply_gradients_node = all_nodes_[apply_gradient_node_name];
 
-    auto div_node = AddNodeDiv(
-        apply_gradient_node_name,
-        apply_gradients_node->input(gradient_pos[apply_gradients_op]),
-        div_const_node->name());
+    string gradient =
+        apply_gradients_node->input(gradient_pos[apply_gradients_op]);
+    if (pipeline_) {
+      auto sum_node = AddNodeGradientSum(apply_gradient_node_name, gradient);
+      all_nodes_.insert(std::make_pair(sum_node->name(), sum_node));
+      gradient = sum_node->name();
+    }
+    auto div_node = AddNodeDiv(apply_gradient_node_name, gradient,
+                               div_const_node->name());
     all_nodes_.insert(std::make_pair(div_node->name(), div_node));
     *apply_gradients_node->mutable_input(gradient_pos[apply_gradients_op]) =
         div_node->name();
@@ -174,6 +197,19 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
     dont_replicate_nodes.insert(NodeName(init));
   }
 
+  // In a pipeline, the averaged gradients are applied once.
+  if (pipeline_) {
+    dont_replicate_nodes.insert(div_const_node->name());
+    for (const auto& apply_gradient_node_name : apply_gradients_nodes_) {
+      dont_replicate_nodes.insert(apply_gradient_node_name);
+      dont_replicate_nodes.insert(strings::StrCat(
+          kAutoParallelPrefix, "-Div-", apply_gradient_node_name));
+    }
+    for (const auto& sum : gradient_sums_) {
+      dont_replicate_nodes.insert(sum.first);
+    }
+  }
+
   // Don't replicate all input nodes, except the dequeue node.
   for (const auto& input_node : input_nodes) {
     if (input_node->name() != dequeue_node->name()) {
@@ -206,6 +242,15 @@ void AutoParallel::AddSharedNodes(GraphDef* graph) {
   for (const auto& node : shared_nodes_) {
     auto new_node = graph->add_node();
     *new_node = *all_nodes_[node];
+    auto sum = gradient_sums_.find(node);
+    if (sum != gradient_sums_.end()) {
+      new_node->clear_input();
+      for (int i = 0; i < num_replicas_; i++) {
+        new_node->add_input(AddPrefixToNodeName(
+            sum->second, strings::StrCat(kAutoParallelPrefix, "-Replica-", i)));
+      }
+      continue;
+    }
     for (int i = 0; i < new_node->input_size(); i++) {
       if (NotSharedNode(NodeName(new_node->input(i)))) {
         string new_name = AddPrefixToNodeName(new_node->input(i), prefix);
@@ -222,7 +267,7 @@ void AutoParallel::AddOneReplica(GraphDef* graph, int number) {
     *new_node = *all_nodes_[node];
     if (NotSharedNode(new_node->name())) {
       new_node->set_name(AddPrefixToNodeName(new_node->name(), prefix));
-      if (num_gpus_ > 0) {
+      if (num_gpus_ > 0 && !pipeline_) {
         new_node->set_device(strings::StrCat("/gpu:", number % num_gpus_));
       }
       for (int i = 0; i < new_node->input_size(); i++) {
@@ -241,19 +286,26 @@ void AutoParallel::BuildGraph(GraphDef* graph) {
     AddOneReplica(graph, i);
   }
   std::set<string> fetches;
+  std::vector<string> replicated_fetches;
   for (size_t i = 0; i < item_->fetch.size(); i++) {
+    // The fetches that are not replicated, e.g. the gradient applications of
+    // a pipeline, are already in the graph.
+    if (!NotSharedNode(NodeName(item_->fetch[i]))) continue;
+    replicated_fetches.push_back(item_->fetch[i]);
     for (int j = 0; j < num_replicas_; j++) {
       string prefix = strings::StrCat(kAutoParallelPrefix, "-Replica-", j);
       string fetch = AddPrefixToNodeName(item_->fetch[i], prefix);
       fetches.insert(fetch);
     }
   }
-  string name_control =
-      strings::StrCat(kAutoParallelPrefix, "-Control-", "Fetch");
-  auto control = AddNodeControl(name_control, fetches, graph);
+  if (!replicated_fetches.empty()) {
+    string name_control =
+        strings::StrCat(kAutoParallelPrefix, "-Control-", "Fetch");
+    auto control = AddNodeControl(name_control, fetches, graph);
 
-  for (const auto& fetch : item_->fetch) {
-    AddNodeControl(fetch, {control->name()}, graph);
+    for (const auto& fetch : replicated_fetches) {
+      AddNodeControl(fetch, {control->name()}, graph);
+    }
   }
   *graph->mutable_library() = item_->graph.library();
   *graph->mutable_versions() = item_->graph.versions();
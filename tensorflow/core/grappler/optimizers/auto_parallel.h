@@ -24,9 +24,17 @@ namespace tensorflow {
 namespace grappler {
 
 // Automatically parallelize a graph by splitting in the batch dimension.
+//
+// By default, the replicas are placed on different GPUs and each applies its
+// own gradients (data parallelism). With `pipeline`, the replicas are the
+// micro-batches of a pipeline instead: they keep the device placement of the
+// graph, so that when a model is split across devices, its stages run
+// different micro-batches concurrently, and the gradients of all the
+// micro-batches are averaged before being applied once.
 class AutoParallel : public GraphOptimizer {
  public:
-  AutoParallel(int num_replicas) : num_replicas_(num_replicas) {
+  AutoParallel(int num_replicas, bool pipeline = false)
+      : num_replicas_(num_replicas), pipeline_(pipeline) {
     CHECK(num_replicas_ >= 2);
   }
   ~AutoParallel() override {}
@@ -47,13 +55,18 @@ class AutoParallel : public GraphOptimizer {
   std::set<string> apply_gradients_nodes_;
   std::set<string> replica_nodes_;
   std::set<string> shared_nodes_;
+  // In a pipeline, maps the nodes that sum the gradients of the replicas to
+  // the gradient they sum.
+  std::map<string, string> gradient_sums_;
   const GrapplerItem* item_;
   int num_replicas_;
+  bool pipeline_;
   int num_gpus_;
   Status Initialize(const GrapplerItem& item);
   NodeDef* AddNodeDivConst();
   NodeDef* AddNodeDiv(const string& name, const string& input_a,
                       const string& input_b);
+  NodeDef* AddNodeGradientSum(const string& name, const string& gradient);
   NodeDef* AddNodeControl(const string& name, const std::set<string>& deps,
                           GraphDef* graph);
   bool NotSharedNode(const string& name);
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -150,6 +151,70 @@ TEST_F(AutoParallelTest, SimpleParallelNoDequeue) {
   TF_EXPECT_OK(status);
 }
 
+TEST_F(AutoParallelTest, Pipeline) {
+  tensorflow::Scope s = tensorflow::Scope::DisabledShapeInferenceScope();
+  Output constant_a = ops::Const(s.WithOpName("constant_a"), 1.0f, {1});
+  Output constant_b = ops::Const(s.WithOpName("constant_b"), 1, {1});
+  Output var = ops::Variable(s.WithOpName("var"), {1}, DT_FLOAT);
+  Output assign = ops::Assign(s.WithOpName("assign"), {var}, {constant_a});
+  Output fifo_queue = ops::FIFOQueue(s.WithOpName("fifo_queue"), {DT_FLOAT});
+  auto dequeue = ops::QueueDequeueMany(s.WithOpName("dequeue"), {fifo_queue},
+                                       {constant_b}, {DT_FLOAT});
+  // Two stages of the model, on different devices.
+  Output stage0 = ops::AddN(s.WithOpName("stage0").WithDevice("/gpu:0"),
+                            {constant_a, dequeue[0]});
+  Output stage1 = ops::AddN(s.WithOpName("stage1").WithDevice("/gpu:1"),
+                            {constant_a, stage0});
+  Output learning_rate = ops::Const(s.WithOpName("learning_rate"), 0.01f, {1});
+  Output apply_gradient = ops::ApplyGradientDescent(
+      s.WithOpName("apply_gradient"), {var}, {learning_rate}, {stage1});
+
+  GrapplerItem item;
+  item.init_ops.push_back("assign");
+  item.fetch.push_back("apply_gradient");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoParallel parallel(2, /*pipeline=*/true);
+  GraphDef output;
+  TF_EXPECT_OK(parallel.Optimize(nullptr, item, &output));
+
+  std::map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_TRUE(nodes.emplace(node.name(), &node).second) << node.name();
+  }
+
+  // Each micro-batch keeps the placement of the stages.
+  for (int i = 0; i < 2; ++i) {
+    const string prefix = strings::StrCat("AutoParallel-Replica-", i, "/");
+    ASSERT_EQ(1, nodes.count(prefix + "dequeue"));
+    ASSERT_EQ(1, nodes.count(prefix + "stage0"));
+    ASSERT_EQ(1, nodes.count(prefix + "stage1"));
+    EXPECT_EQ("/gpu:0", nodes[prefix + "stage0"]->device());
+    EXPECT_EQ("/gpu:1", nodes[prefix + "stage1"]->device());
+    EXPECT_EQ(prefix + "stage0", nodes[prefix + "stage1"]->input(1));
+    EXPECT_EQ(0, nodes.count(prefix + "apply_gradient"));
+  }
+
+  // The gradients of the micro-batches are averaged and applied once.
+  ASSERT_EQ(1, nodes.count("AutoParallel-Sum-apply_gradient"));
+  const NodeDef* sum = nodes["AutoParallel-Sum-apply_gradient"];
+  EXPECT_EQ("AddN", sum->op());
+  ASSERT_EQ(2, sum->input_size());
+  EXPECT_EQ("AutoParallel-Replica-0/stage1", sum->input(0));
+  EXPECT_EQ("AutoParallel-Replica-1/stage1", sum->input(1));
+
+  ASSERT_EQ(1, nodes.count("AutoParallel-Div-apply_gradient"));
+  const NodeDef* div = nodes["AutoParallel-Div-apply_gradient"];
+  EXPECT_EQ("AutoParallel-Sum-apply_gradient", div->input(0));
+  EXPECT_EQ("AutoParallel-Div-Const", div->input(1));
+
+  ASSERT_EQ(1, nodes.count("apply_gradient"));
+  const NodeDef* apply = nodes["apply_gradient"];
+  EXPECT_EQ("ApplyGradientDescent", apply->op());
+  EXPECT_EQ("var", apply->input(0));
+  EXPECT_EQ("AutoParallel-Div-apply_gradient", apply->input(2));
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/critical_path_priority.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/static_schedule.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status CriticalPathPriority::Optimize(Cluster* cluster,
+                                      const GrapplerItem& item,
+                                      GraphDef* optimized_graph) {
+  if (cluster == nullptr) {
+    return errors::Aborted("CriticalPathPriority requires a cluster.");
+  }
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> completion_times;
+  TF_RETURN_IF_ERROR(
+      EstimateEarliestExecutionTimes(item, cluster, &completion_times));
+  Costs::NanoSeconds step_time(0);
+  for (const auto& it : completion_times) {
+    step_time = std::max(step_time, it.second);
+  }
+
+  // All the nodes without fanouts only have to complete by the end of the
+  // step, so the required time of a node is the end of the step minus the
+  // longest chain of work that follows it.
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> end_of_step;
+  for (const NodeDef& node : item.graph.node()) end_of_step[&node] = step_time;
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> required_times;
+  TF_RETURN_IF_ERROR(
+      EstimateRequiredTimes(item, cluster, end_of_step, &required_times));
+
+  *optimized_graph = item.graph;
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    // Nodes that the schedule never reached (e.g. in loops) keep the lowest
+    // priority.
+    int64 priority = 0;
+    auto it = required_times.find(&item.graph.node(i));
+    if (it != required_times.end() && it->second <= step_time) {
+      priority = (step_time - it->second).count();
+    }
+    SetAttrValue(priority, &(*optimized_graph->mutable_node(i)
+                                  ->mutable_attr())[kCriticalPathPriorityAttr]);
+  }
+  return Status::OK();
+}
+
+void CriticalPathPriority::Feedback(Cluster* /*cluster*/,
+                                    const GrapplerItem& /*item*/,
+                                    const GraphDef& /*optimized_graph*/,
+                                    double /*result*/) {
+  // Nothing to do for CriticalPathPriority.
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(CriticalPathPriority, "critical_path_priority");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,62 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_PRIORITY_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_PRIORITY_H_
+
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Node attribute that holds the critical-path priority of a node. The
+// executor runs the ready nodes with the highest priority first.
+constexpr char kCriticalPathPriorityAttr[] = "_critical_path_priority";
+
+// CriticalPathPriority annotates every node with the estimated length, in
+// nanoseconds, of the longest chain of work that can only start once the node
+// completes, using the static schedule of EstimateEarliestExecutionTimes and
+// EstimateRequiredTimes. Nodes on the critical path of the step get the
+// highest priorities, e.g. the sends and gradient reductions of the early
+// layers in a training step, whose consumers are still far from the end of
+// the step.
+//
+// The optimizer is not enabled by default. It must be registered through
+// RewriterConfig.custom_optimizers, and needs a cluster to estimate costs.
+class CriticalPathPriority : public CustomGraphOptimizer {
+ public:
+  CriticalPathPriority() {}
+  ~CriticalPathPriority() override {}
+
+  string name() const override { return "critical_path_priority"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return Status::OK();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CRITICAL_PATH_PRIORITY_H_
@@ -0,0 +1,85 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/critical_path_priority.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class CriticalPathPriorityTest : public ::testing::Test {
+ public:
+  std::unique_ptr<VirtualCluster> CreateVirtualCluster() const {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cpu_device.set_frequency(1000);
+    cpu_device.set_num_cores(4);
+    cpu_device.set_bandwidth(32);
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+    return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+  }
+};
+
+TEST_F(CriticalPathPriorityTest, PrioritizeLongestChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {100, 100});
+  Output long_1 = ops::Square(s.WithOpName("long_1"), a);
+  Output long_2 = ops::Square(s.WithOpName("long_2"), long_1);
+  Output long_3 = ops::Square(s.WithOpName("long_3"), long_2);
+  Output short_1 = ops::Square(s.WithOpName("short_1"), a);
+
+  GrapplerItem item;
+  item.fetch = {"long_3", "short_1"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  CriticalPathPriority optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  std::unordered_map<string, int64> priorities;
+  for (const NodeDef& node : output.node()) {
+    ASSERT_EQ(1, node.attr().count(kCriticalPathPriorityAttr));
+    priorities[node.name()] = node.attr().at(kCriticalPathPriorityAttr).i();
+  }
+  EXPECT_GT(priorities["a"], priorities["long_1"]);
+  EXPECT_GT(priorities["long_1"], priorities["long_2"]);
+  EXPECT_GT(priorities["long_2"], priorities["long_3"]);
+  EXPECT_EQ(0, priorities["long_3"]);
+  EXPECT_EQ(0, priorities["short_1"]);
+}
+
+TEST_F(CriticalPathPriorityTest, RequiresCluster) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {10});
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  CriticalPathPriority optimizer;
+  GraphDef output;
+  EXPECT_TRUE(errors::IsAborted(optimizer.Optimize(nullptr, item, &output)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
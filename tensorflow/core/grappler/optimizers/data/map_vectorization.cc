@@ -121,15 +121,25 @@ FunctionDef* AddVectorizedFunction(const NodeDef& map_node,
   DCHECK_EQ(map_defun_node.op(), "MapDefun");
 
   FunctionDef* result;
+  vectorization_utils::VectorizationReport report;
   Status s = vectorization_utils::VectorizeMapDefun(
-      *vectorized_func, map_defun_node, library, &result);
+      *vectorized_func, map_defun_node, library, &result, &report);
 
   if (!s.ok()) {
     LOG(WARNING) << "VectorizeMapDefun failed. The function will only be "
                     "naively vectorized with MapDefun. Reason: "
-                 << s;
+                 << s << ". Coverage: " << report.DebugString();
     return vectorized_func;
   }
+  if (!report.fully_vectorized()) {
+    LOG(WARNING) << "The map function " << orig_func.signature().name()
+                 << " could only be partially vectorized; the remaining ops "
+                    "run once per element. Coverage: "
+                 << report.DebugString();
+  } else {
+    VLOG(1) << "Fully vectorized the map function "
+            << orig_func.signature().name() << ": " << report.DebugString();
+  }
   return result;
 }
 
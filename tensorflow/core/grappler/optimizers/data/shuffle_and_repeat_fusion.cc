@@ -93,6 +93,12 @@ Status ShuffleAndRepeatFusion::OptimizeAndCollectStats(
       continue;
     }
 
+    // The fused kernel does not support a byte budget for its buffer.
+    if (HasNodeAttr(shuffle_node, "buffer_size_bytes") &&
+        shuffle_node.attr().at("buffer_size_bytes").i() > 0) {
+      continue;
+    }
+
     NodeDef* shuffle_and_repeat_node =
         graph.AddNode(make_shuffle_and_repeat_node(shuffle_node, repeat_node));
     TF_RETURN_IF_ERROR(graph.UpdateFanouts(repeat_node.name(),
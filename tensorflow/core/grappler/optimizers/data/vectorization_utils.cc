@@ -143,6 +143,9 @@ class Vectorization {
   Status Vectorize(const FunctionDef& outer_scope,
                    const NodeDef& map_defun_node, FunctionDef** result);
 
+  // Fills `report` with the per-op coverage of the last call to `Vectorize`.
+  void FillReport(VectorizationReport* report) const;
+
  private:
   // Converts FunctionDefs to Graphs and adds mappings from
   // arg nodes and unstacked nodes to the corresponding nodes in outer_scope_.
@@ -210,6 +213,9 @@ class Vectorization {
   // Unconvertible ret nodes
   std::set<Node*> unconvertible_;
 
+  // First error encountered while converting an op, keyed by op type.
+  std::map<string, string> conversion_errors_;
+
   FunctionDefLibrary* lib_;  // Not owned
   FunctionLibraryDefinition lib_def_;
   // Note that FunctionBody has a pointer to a Graph object that corresponds
@@ -337,6 +343,42 @@ Status Vectorization::Vectorize(const FunctionDef& outer_scope,
   return GetResult(result);
 }
 
+void Vectorization::FillReport(VectorizationReport* report) const {
+  if (map_defun_fn_ == nullptr) return;
+  // The nodes that still run per element are those that the remaining
+  // MapDefun outputs depend on. Converted nodes that they depend on also
+  // still run per element.
+  std::set<const Node*> unvectorized;
+  std::vector<const Node*> stack(map_defun_fn_->ret_nodes.begin(),
+                                 map_defun_fn_->ret_nodes.end());
+  while (!stack.empty()) {
+    const Node* node = stack.back();
+    stack.pop_back();
+    for (const Edge* edge : node->in_edges()) {
+      if (unvectorized.insert(edge->src()).second) {
+        stack.push_back(edge->src());
+      }
+    }
+  }
+  std::set<const Node*> converted;
+  for (const auto& pair : conversion_map_) {
+    converted.insert(pair.first.first);
+  }
+  for (const Node* node : map_defun_fn_->graph->op_nodes()) {
+    if (node->IsArg() || node->IsRetval()) continue;
+    if (unvectorized.count(node)) {
+      ++report->unvectorized_ops[node->type_string()];
+    } else if (converted.count(node)) {
+      ++report->vectorized_ops[node->type_string()];
+    }
+  }
+  for (const auto& pair : conversion_errors_) {
+    if (report->unvectorized_ops.count(pair.first)) {
+      report->errors.insert(pair);
+    }
+  }
+}
+
 void Vectorization::VectorizeHelper() {
   while (true) {
     int output_position = graph_utils::GetFirstElementIndexWithPredicate(
@@ -354,6 +396,11 @@ void Vectorization::VectorizeHelper() {
       VLOG(2) << "Could not convert the output at node: "
               << output_node->DebugString() << "\nError: " << s;
       unconvertible_.insert(output_node);
+      const Edge* in_edge = nullptr;
+      if (output_node->input_edge(0, &in_edge).ok()) {
+        conversion_errors_.emplace(in_edge->src()->type_string(),
+                                   s.error_message());
+      }
     }
   }
 
@@ -633,6 +680,31 @@ Status Vectorization::GetResult(FunctionDef** vectorized_function) {
 
 }  // namespace
 
+string VectorizationReport::DebugString() const {
+  int num_vectorized = 0;
+  for (const auto& pair : vectorized_ops) {
+    num_vectorized += pair.second;
+  }
+  int num_unvectorized = 0;
+  std::vector<string> unvectorized;
+  for (const auto& pair : unvectorized_ops) {
+    num_unvectorized += pair.second;
+    string entry = strings::StrCat(pair.first, " x", pair.second);
+    if (auto* error = gtl::FindOrNull(errors, pair.first)) {
+      strings::StrAppend(&entry, " (", *error, ")");
+    }
+    unvectorized.push_back(std::move(entry));
+  }
+  string result = strings::StrCat(num_vectorized, " of ",
+                                  num_vectorized + num_unvectorized,
+                                  " ops vectorized");
+  if (!unvectorized.empty()) {
+    strings::StrAppend(&result, "; not vectorized: ",
+                       absl::StrJoin(unvectorized, ", "));
+  }
+  return result;
+}
+
 Status VectorizeMapDefun(const FunctionDef& outer_scope,
                          const NodeDef& map_defun_node, FunctionDefLibrary* lib,
                          FunctionDef** result) {
@@ -640,6 +712,16 @@ Status VectorizeMapDefun(const FunctionDef& outer_scope,
   return Vectorization(lib).Vectorize(outer_scope, map_defun_node, result);
 }
 
+Status VectorizeMapDefun(const FunctionDef& outer_scope,
+                         const NodeDef& map_defun_node, FunctionDefLibrary* lib,
+                         FunctionDef** result, VectorizationReport* report) {
+  *result = nullptr;
+  Vectorization vectorization(lib);
+  Status s = vectorization.Vectorize(outer_scope, map_defun_node, result);
+  vectorization.FillReport(report);
+  return s;
+}
+
 }  // namespace vectorization_utils
 }  // namespace grappler
 }  // namespace tensorflow
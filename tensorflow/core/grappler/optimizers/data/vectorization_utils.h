@@ -16,14 +16,39 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_UTILS_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_UTILS_H_
 
+#include <map>
+
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 namespace grappler {
 namespace vectorization_utils {
 
+// Describes which ops of a MapDefun function were vectorized, keyed by op
+// type.
+struct VectorizationReport {
+  // Number of nodes of each op type that were lifted out of the MapDefun
+  // function and now run once per batch.
+  std::map<string, int> vectorized_ops;
+
+  // Number of nodes of each op type that remain in the MapDefun function and
+  // still run once per element.
+  std::map<string, int> unvectorized_ops;
+
+  // For op types that failed to convert, the first conversion error.
+  std::map<string, string> errors;
+
+  bool fully_vectorized() const { return unvectorized_ops.empty(); }
+
+  // Returns a one-line summary of the report, e.g.
+  //   "2 of 3 ops vectorized; not vectorized: MatMul x1 (No vectorizer
+  //   registered for op: MatMul)".
+  string DebugString() const;
+};
+
 // Given a MapDefun node (`map_defun_node`) in a FunctionDef (`outer_scope`)
 // that maps a function in lib across some input vector elements,
 // `VectorizeMapDefun` attempts to create a vectorized version of `outer_scope`
@@ -90,6 +115,13 @@ Status VectorizeMapDefun(const FunctionDef& outer_scope,
                          const NodeDef& map_defun_node, FunctionDefLibrary* lib,
                          FunctionDef** result);
 
+// As above, and additionally fills `report` with the per-op coverage of the
+// vectorization. `report` is filled even if an error is returned, as long as
+// the MapDefun function could be converted to a graph.
+Status VectorizeMapDefun(const FunctionDef& outer_scope,
+                         const NodeDef& map_defun_node, FunctionDefLibrary* lib,
+                         FunctionDef** result, VectorizationReport* report);
+
 }  // namespace vectorization_utils
 }  // namespace grappler
 }  // namespace tensorflow
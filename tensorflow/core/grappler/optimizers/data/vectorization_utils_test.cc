@@ -264,6 +264,39 @@ TEST(VectorizeMapDefunTest, VectorizeWithUnvectorizableOp) {
       lib_def.Find(map_defun_node.attr().at("f").func().name());
   EXPECT_EQ(map_defun_fn->signature().output_arg_size(), 1);
 }
+
+TEST(VectorizeMapDefunTest, ReportsCoverageOfUnvectorizableOp) {
+  FunctionDef inner = FunctionDefHelper::Create(
+      /*function_name=*/"inner_function",
+      /*in_def=*/{"arg0: int32", "arg1: int32"},
+      /*out_def=*/{"ret0: int32", "ret1: int32"},
+      /*attr_def=*/{},
+      /*node_def=*/
+      {{{"MatMul"}, "MatMul", {"arg0", "arg0"}, {{"T", DT_INT32}}},
+       Cast("Cast", {"arg1"}, DT_INT32, DT_INT32)},  //
+      /*ret_def=*/{{"ret0", "MatMul:product:0"}, {"ret1", "Cast:y:0"}});
+
+  FunctionDef outer;
+  TF_ASSERT_OK(WrapFunctionWithMapDefun(inner, &outer));
+  FunctionDefLibrary lib;
+  *lib.add_function() = outer;
+  *lib.add_function() = inner;
+  FunctionDef* vectorized;
+  VectorizationReport report;
+  TF_ASSERT_OK(VectorizeMapDefun(outer, outer.node_def(0), &lib, &vectorized,
+                                 &report));
+
+  EXPECT_FALSE(report.fully_vectorized());
+  EXPECT_EQ(report.vectorized_ops, (std::map<string, int>{{"Cast", 1}}));
+  EXPECT_EQ(report.unvectorized_ops, (std::map<string, int>{{"MatMul", 1}}));
+  ASSERT_EQ(report.errors.count("MatMul"), 1);
+  EXPECT_EQ(report.errors.at("MatMul"),
+            "No vectorizer registered for op: MatMul");
+  EXPECT_EQ(report.DebugString(),
+            "1 of 2 ops vectorized; not vectorized: MatMul x1 (No vectorizer "
+            "registered for op: MatMul)");
+}
+
 // Before:
 //
 //                 +------+
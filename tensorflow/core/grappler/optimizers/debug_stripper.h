@@ -32,6 +32,9 @@ class DebugStripper : public GraphOptimizer {
 
   bool UsesFunctionLibrary() const override { return false; }
 
+  // Stripping a node only rewires its direct consumers.
+  int Locality() const override { return 1; }
+
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* output) override;
 
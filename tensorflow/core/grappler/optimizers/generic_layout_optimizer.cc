@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/path.h" 
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/port.h"
 
 
 namespace tensorflow {
@@ -41,6 +43,7 @@ namespace {
 
 constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
+constexpr char kCPU[] = "CPU";
 constexpr float kVoltaGPURatioThreshold = 0.5;
 constexpr float kConvGPUFP16Threshold = 0.5;
 
@@ -125,6 +128,89 @@ inline absl::optional<std::pair<string, string>> GetSrcAndDstDataFormats(
   return std::make_pair(src_format, dst_format);
 }
 
+// Returns the indices of the layout sensitive nodes that use the source data
+// format.
+std::vector<int> GetSrcFormatLayoutSensitiveNodes(
+    const TransposeContext& context) {
+  std::vector<int> nodes;
+  for (int i = 0; i < context.num_nodes; ++i) {
+    const auto* node_view = context.graph_view->GetNode(i);
+    if (!IsLayoutSensitiveOp(*node_view->node())) continue;
+    const auto* data_format = node_view->GetAttr("data_format");
+    if (data_format != nullptr && data_format->s() == context.src_format) {
+      nodes.push_back(i);
+    }
+  }
+  return nodes;
+}
+
+// MKL-DNN kernels compute in blocked layouts (e.g. nChw16c), and reorder
+// every NHWC input and output of a layout sensitive op into and out of them,
+// while the MKL layout pass keeps NCHW tensors in the blocked layout across
+// chains of MKL ops. Converting an op to NCHW saves its two reorders, which
+// cost about as much as a Transpose of the same tensors, so the conversion
+// pays off if the Transposes it adds at the ends of the converted chains cost
+// less according to the OpLevelCostEstimator.
+bool IsCpuConversionProfitable(const TransposeContext& context,
+                               const Cluster& cluster,
+                               const std::vector<int>& converted_candidates) {
+  DeviceProperties device;
+  for (const auto& it : cluster.GetDevices()) {
+    if (it.second.type() == kCPU) {
+      device = it.second;
+      break;
+    }
+  }
+  if (device.type() != kCPU) return false;
+
+  OpLevelCostEstimator estimator;
+  auto transpose_time = [&estimator,
+                         &device](const OpInfo::TensorProperties& tensor) {
+    OpContext op_context;
+    op_context.op_info.set_op("Transpose");
+    *op_context.op_info.mutable_device() = device;
+    *op_context.op_info.add_inputs() = tensor;
+    *op_context.op_info.add_outputs() = tensor;
+    return estimator.PredictCosts(op_context).execution_time.count();
+  };
+
+  int64 saved_time = 0;
+  for (int i : converted_candidates) {
+    const auto* node_view = context.graph_view->GetNode(i);
+    const auto* data_format = node_view->GetAttr("data_format");
+    if (data_format == nullptr || data_format->s() != context.dst_format) {
+      continue;
+    }
+    const string& name = node_view->GetName();
+    const auto& inputs = context.graph_properties->GetInputProperties(name);
+    const auto& outputs = context.graph_properties->GetOutputProperties(name);
+    if (!inputs.empty()) saved_time += transpose_time(inputs[0]);
+    if (!outputs.empty()) saved_time += transpose_time(outputs[0]);
+  }
+
+  int64 added_time = 0;
+  const int num_nodes = context.graph_view->NumNodes();
+  for (int i = context.num_nodes; i < num_nodes; ++i) {
+    const auto* node_view = context.graph_view->GetNode(i);
+    if (!IsTranspose(*node_view->node())) continue;
+    const auto* dtype = node_view->GetAttr("T");
+    const auto* shapes = node_view->GetAttr(kAttrOutputShape);
+    if (dtype == nullptr || shapes == nullptr ||
+        shapes->list().shape_size() != 1) {
+      return false;
+    }
+    OpInfo::TensorProperties tensor;
+    tensor.set_dtype(dtype->type());
+    *tensor.mutable_shape() = shapes->list().shape(0);
+    added_time += transpose_time(tensor);
+  }
+
+  VLOG(1) << "Converting to " << context.dst_format << " on CPU saves "
+          << saved_time << " ns of reorders for " << added_time
+          << " ns of transposes.";
+  return added_time < saved_time;
+}
+
 Status ExpandLayoutSensitiveOp(TransposeContext* context,
                                TransposerFactory* transposer_factory) {
   const int num_nodes = context->num_nodes;
@@ -437,10 +523,12 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   }
   const auto num_gpus_and_num_volta = GetNumGPUs(*cluster);
   const int num_gpus = num_gpus_and_num_volta.first;
-  if (num_gpus < 1) {
+  // Without GPUs, convolutions are only converted for the MKL-DNN kernels.
+  const bool optimize_for_cpu = num_gpus < 1 && IsMklEnabled();
+  if (num_gpus < 1 && !optimize_for_cpu) {
     return errors::Aborted(
         "No GPUs found: GenericLayoutOptimizer is currently only tuned for "
-        "GPU.");
+        "GPU and for CPU with MKL.");
   }
 
   const bool is_aggressive = opt_level_ == RewriterConfig::AGGRESSIVE;
@@ -449,16 +537,27 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   TF_RETURN_IF_ERROR(
       TransposeContext::InitializeTransposeContext(item, cluster, &context));
 
-  const auto src_dst_formats =
-      GetSrcAndDstDataFormats(context, num_gpus, num_gpus_and_num_volta.second,
-                              force_);
+  absl::optional<std::pair<string, string>> src_dst_formats;
+  if (optimize_for_cpu) {
+    if (NumConvOnDeviceWithDataTypeOverThreshold(context, kCPU, DT_FLOAT,
+                                                 force_)
+            .has_value()) {
+      src_dst_formats = std::make_pair(string(kNHWC), string(kNCHW));
+    }
+  } else {
+    src_dst_formats = GetSrcAndDstDataFormats(
+        context, num_gpus, num_gpus_and_num_volta.second, force_);
+  }
   if (!src_dst_formats.has_value()) {
     return errors::Aborted(
         "No Conv ops found: GenericLayoutOptimizer is skipped.");
   }
-  context.AssignDeviceAndDataFormats(kGPU, src_dst_formats->first,
+  context.AssignDeviceAndDataFormats(optimize_for_cpu ? kCPU : kGPU,
+                                     src_dst_formats->first,
                                      src_dst_formats->second);
 
+  const std::vector<int> src_format_nodes =
+      GetSrcFormatLayoutSensitiveNodes(context);
   TransposerFactory transposer_factory;
   TF_RETURN_IF_ERROR(ExpandLayoutSensitiveOp(&context, &transposer_factory));
   if (context.graph.node_size() > context.num_nodes || is_aggressive) {
@@ -470,6 +569,11 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
     TF_RETURN_IF_ERROR(
         context.graph_view->SortTopologically(/*ignore_cycles=*/false, {}));
   }
+  if (optimize_for_cpu &&
+      !IsCpuConversionProfitable(context, *cluster, src_format_nodes)) {
+    return errors::Aborted(
+        "Converting the CPU convolutions to NCHW is not profitable.");
+  }
   TF_RETURN_IF_ERROR(EraseOutputShapeAttrs(&context));
 	TF_RETURN_IF_ERROR(PrintDebugLogs("layout_optimized",
                                     context.graph_view->graph()));
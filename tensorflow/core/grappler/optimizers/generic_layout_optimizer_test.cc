@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/port.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -594,6 +595,65 @@ TEST_F(GenericLayoutOptimizerTest, CancelTransposeAroundPad) {
   test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(GenericLayoutOptimizerTest, CPUOnlyCluster) {
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  cpu_device.set_bandwidth(32);
+  VirtualCluster cpu_cluster({{"/CPU:0", cpu_device}});
+  TF_ASSERT_OK(cpu_cluster.Provision());
+
+  // A chain of layout sensitive ops is worth converting, a single one is not.
+  Scope chain_scope = Scope::NewRootScope();
+  auto conv = SimpleConv2D(&chain_scope, 8, 2, "SAME", "/CPU:0");
+  auto bias = ops::Const(chain_scope.WithOpName("Bias"), {1.0f, 2.0f}, {2});
+  auto bias_add = ops::BiasAdd(
+      chain_scope.WithOpName("BiasAdd").WithDevice("/CPU:0"), conv, bias);
+  auto relu =
+      ops::Relu(chain_scope.WithOpName("Relu").WithDevice("/CPU:0"), bias_add);
+  auto max_pool =
+      ops::MaxPool(chain_scope.WithOpName("MaxPool").WithDevice("/CPU:0"),
+                   relu, {1, 2, 2, 1}, {1, 2, 2, 1}, "VALID");
+  auto chain_output = Identity(chain_scope.WithOpName("Output"), max_pool);
+  GrapplerItem chain_item;
+  TF_ASSERT_OK(chain_scope.ToGraphDef(&chain_item.graph));
+
+  Scope single_scope = Scope::NewRootScope();
+  auto single_conv = SimpleConv2D(&single_scope, 8, 2, "SAME", "/CPU:0");
+  auto single_output =
+      Identity(single_scope.WithOpName("Output"), single_conv);
+  GrapplerItem single_item;
+  TF_ASSERT_OK(single_scope.ToGraphDef(&single_item.graph));
+
+  GenericLayoutOptimizer optimizer;
+  GraphDef output;
+  if (!IsMklEnabled()) {
+    EXPECT_TRUE(errors::IsAborted(
+        optimizer.Optimize(&cpu_cluster, chain_item, &output)));
+    return;
+  }
+
+  TF_ASSERT_OK(optimizer.Optimize(&cpu_cluster, chain_item, &output));
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  for (const char* name : {"Conv2D", "BiasAdd", "MaxPool"}) {
+    auto* node = graph_view.GetNode(name);
+    ASSERT_NE(node, nullptr);
+    VerifyDataFormatAttributeMatch(node, "NCHW");
+  }
+  // The only transposes are at the ends of the chain.
+  int num_transposes = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Transpose") ++num_transposes;
+  }
+  EXPECT_EQ(num_transposes, 2);
+
+  EXPECT_TRUE(errors::IsAborted(
+      optimizer.Optimize(&cpu_cluster, single_item, &output)));
+}
+
 // TODO(yanzha): Add more complex Graph for test.
 
 }  // namespace grappler
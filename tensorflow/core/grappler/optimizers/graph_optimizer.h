@@ -43,6 +43,13 @@ class GraphOptimizer {
   // that do not instantiate functions should return true.
   virtual bool UsesFunctionLibrary() const = 0;
 
+  // Returns the number of edges around a node that the optimizer looks at to
+  // rewrite it, or a negative value if the optimizer needs to see the whole
+  // graph. Optimizers with a non-negative locality can be run incrementally,
+  // only on the neighborhood of the nodes that changed since the graph was
+  // last optimized (see MetaOptimizer::OptimizeIncrementally).
+  virtual int Locality() const { return -1; }
+
   // Routine called to allow an algorithm to propose a rewritten graph
   // for the graph, feeds and fetches in "item" to run more efficiently
   // on "cluster". If the returned status is Status::OK() then
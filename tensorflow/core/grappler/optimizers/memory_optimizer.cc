@@ -792,8 +792,54 @@ Status BuildSwapPair(NodeDef* node, int input_to_swap,
   return Status::OK();
 }
 
+// Inserts a Cast to bfloat16 before the swap out node of `swap_pair` and a
+// Cast back to float after its swap in node, which halves the amount of data
+// moved between the device and the host at the cost of precision. The first
+// Cast still needs its input, and the consumer of the swapped tensor must be
+// connected to the second one. Only float tensors are supported.
+Status BuildSwapCastPair(const std::pair<NodeDef*, NodeDef*>& swap_pair,
+                         GraphDef* graph,
+                         std::pair<NodeDef*, NodeDef*>* cast_pair) {
+  NodeDef* swap_out_node = swap_pair.first;
+  NodeDef* swap_in_node = swap_pair.second;
+  if (swap_out_node->attr().at("T").type() != DT_FLOAT) {
+    return errors::InvalidArgument("Can't swap ", swap_out_node->name(),
+                                   " as bfloat16 since it is not a float");
+  }
+
+  NodeDef* cast_out_node = graph->add_node();
+  cast_out_node->set_name(
+      strings::StrCat(swap_out_node->name(), "_to_bfloat16"));
+  cast_out_node->set_op("Cast");
+  (*cast_out_node->mutable_attr())["SrcT"].set_type(DT_FLOAT);
+  (*cast_out_node->mutable_attr())["DstT"].set_type(DT_BFLOAT16);
+  (*cast_out_node->mutable_attr())["Truncate"].set_b(false);
+  *swap_out_node->add_input() = cast_out_node->name();
+
+  NodeDef* cast_in_node = graph->add_node();
+  cast_in_node->set_name(
+      strings::StrCat(swap_in_node->name(), "_from_bfloat16"));
+  cast_in_node->set_op("Cast");
+  (*cast_in_node->mutable_attr())["SrcT"].set_type(DT_BFLOAT16);
+  (*cast_in_node->mutable_attr())["DstT"].set_type(DT_FLOAT);
+  (*cast_in_node->mutable_attr())["Truncate"].set_b(false);
+  *cast_in_node->add_input() = swap_in_node->name();
+
+  for (NodeDef* cast_node : {cast_out_node, cast_in_node}) {
+    cast_node->set_device(swap_out_node->device());
+    (*cast_node->mutable_attr())["_class"] = swap_out_node->attr().at("_class");
+  }
+  (*swap_out_node->mutable_attr())["T"].set_type(DT_BFLOAT16);
+  (*swap_in_node->mutable_attr())["T"].set_type(DT_BFLOAT16);
+  *cast_pair = std::make_pair(cast_out_node, cast_in_node);
+
+  return Status::OK();
+}
+
 struct SwapInfo {
   std::vector<int> inputs_to_swap;
+  // Whether float inputs are swapped as bfloat16.
+  bool swap_as_bfloat16 = false;
   Costs::NanoSeconds time_to_swap = 0;
 };
 
@@ -963,6 +1009,44 @@ static bool IsSwappable(MutableGraphView::InputPort input) {
   return !IsRefType(dtype);
 }
 
+// Start and completion times of an op in a simulated run of the graph.
+struct OpTimes {
+  Costs::NanoSeconds start;
+  Costs::NanoSeconds completion;
+};
+
+// Simulates a run of the graph of `item` on the devices of `cluster` with the
+// analytical cost model, and records the times of each op in `op_times`.
+static bool EstimateOpTimes(Cluster* cluster, const GrapplerItem& item,
+                            std::unordered_map<string, OpTimes>* op_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      OpTimes times;
+      times.start = Costs::NanoSeconds(1) +
+                    Costs::MicroSeconds(node_stats.all_start_micros() +
+                                        node_stats.op_start_rel_micros());
+      times.completion = Costs::NanoSeconds(1) +
+                         Costs::MicroSeconds(node_stats.all_start_micros() +
+                                             node_stats.op_end_rel_micros());
+      op_times->emplace(node_stats.node_name(), times);
+    }
+  }
+  return true;
+}
+
 struct MemInfo {
   MutableGraphView::OutputPort port;
   int64 memory_used;
@@ -1002,30 +1086,9 @@ static bool IdentifySwappingCandidates(
     }
     int64 required_savings = mem_usage.used_memory - prop.memory_size();
 
-    std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    std::unordered_map<string, OpTimes> op_times;
+    if (!EstimateOpTimes(cluster, *item, &op_times)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1066,12 +1129,12 @@ static bool IdentifySwappingCandidates(
       bool valid = true;
       for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
         // Get execution time.
-        auto it = op_completion_times.find(input.node->name());
-        if (it == op_completion_times.end()) {
+        auto it = op_times.find(input.node->name());
+        if (it == op_times.end()) {
           valid = false;
           break;
         }
-        if (it->second <= peak_time) {
+        if (it->second.completion <= peak_time) {
           continue;
         }
 
@@ -1092,7 +1155,7 @@ static bool IdentifySwappingCandidates(
 
         // Set earliest use time that's after peak.
         mem_info.uses_left.emplace_back(input);
-        earliest_use = std::min(earliest_use, it->second);
+        earliest_use = std::min(earliest_use, it->second.completion);
       }
       if (valid && !mem_info.uses_left.empty()) {
         // Compute the fitness: we need the tensor to be generated way away of
@@ -1137,15 +1200,236 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
+// A tensor live at the memory peak which can be evicted until its next use,
+// either by recomputing it or by swapping it to host memory.
+struct EvictionCandidate {
+  MutableGraphView::OutputPort port;
+  int64 memory_used;
+  std::vector<MutableGraphView::InputPort> uses_left;
+  bool recompute;
+  // Estimated time the eviction adds to the step.
+  Costs::NanoSeconds cost;
+  double score;
+
+  bool operator<(const EvictionCandidate& other) const {
+    return score > other.score;
+  }
+};
+
+// Uses the analytical cost model and the static memory estimate to decide, for
+// every large tensor live at the memory peak of a GPU, whether to recompute it
+// (when recomputing is cheaper than the transfers that a swap could not hide),
+// to swap it to host memory, or to leave it alone. Tensors are evicted in
+// order of memory saved per unit of cost until the peak fits in the device
+// memory, or in `memory_budget_bytes` if it is set and smaller.
+//
+// Recomputations are applied to the graph right away, and the inputs to swap
+// are added to `nodes_to_swap`. Returns true if the graph was changed.
+static bool RecomputeOrIdentifySwappingCandidates(
+    Cluster* cluster, int64 memory_budget_bytes, GrapplerItem* item,
+    std::unordered_set<string>* skip_list,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+  // RecomputeSubgraph needs a topological numbering. Sorting moves the nodes,
+  // so it has to happen before collecting any NodeDef pointers.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return false;
+  }
+  GraphMemory memory(*item);
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster->GetDevices();
+  Status s = memory.InferStatically(devices);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  const std::unordered_set<string> cheap_to_recompute_ops =
+      GetCheapToRecomputeOps();
+  std::unordered_map<string, OpTimes> op_times;
+  bool simulated = false;
+  std::vector<EvictionCandidate> evictions;
+
+  MutableGraphView graph(&item->graph);
+  for (const auto& device : devices) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU" || prop.memory_size() <= 0) {
+      continue;
+    }
+    int64 budget = prop.memory_size();
+    if (memory_budget_bytes > 0) {
+      budget = std::min(budget, memory_budget_bytes);
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+    int64 required_savings = mem_usage.used_memory - budget;
+
+    if (!simulated) {
+      if (!EstimateOpTimes(cluster, *item, &op_times)) {
+        return false;
+      }
+      simulated = true;
+    }
+
+    Costs::Duration peak_time = -1;
+    std::unordered_set<string> live_at_peak;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      live_at_peak.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    std::vector<EvictionCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024 ||
+          skip_list->count(live_tensor.node) > 0) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) {
+        continue;
+      }
+      EvictionCandidate candidate;
+      candidate.port = port;
+      candidate.memory_used = live_tensor.memory_used;
+      Costs::NanoSeconds earliest_use(Costs::NanoSeconds::infinity());
+      bool valid = true;
+      bool swappable = IsSwappable(graph, port);
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_times.find(input.node->name());
+        if (it == op_times.end() ||
+            skip_list->count(input.node->name()) > 0 ||
+            skip_list->count(
+                strings::StrCat(input.node->name(), ":", input.port_id)) > 0) {
+          valid = false;
+          break;
+        }
+        if (it->second.completion <= peak_time) {
+          continue;
+        }
+        swappable &= IsSwappable(input);
+        candidate.uses_left.push_back(input);
+        earliest_use = std::min(earliest_use, it->second.start);
+      }
+      if (!valid || candidate.uses_left.empty()) {
+        continue;
+      }
+
+      // A swap out and back in must fit between the allocation of the tensor
+      // and its next use to be free, otherwise the rest delays the step.
+      // Let's assume we're going to swap over PCIe running at 16 GBps.
+      const int64 transfer_time = 2 * live_tensor.memory_used / 16;
+      const int64 idle_time =
+          (earliest_use - live_tensor.allocation_time).count();
+      const Costs::NanoSeconds swap_cost(
+          std::max<int64>(0, transfer_time - idle_time));
+
+      // Only recompute nodes whose inputs are live at the peak anyway, so that
+      // keeping them until the recomputation doesn't raise the peak.
+      const NodeDef& producer = *port.node;
+      bool recomputable =
+          port.port_id == 0 && feeds.count(producer.name()) == 0 &&
+          (cheap_to_recompute_ops.count(producer.op()) > 0 ||
+           producer.attr().count(kRecomputeHint) > 0) &&
+          op_times.count(producer.name()) > 0;
+      for (const string& input : producer.input()) {
+        if (!recomputable || IsControlInput(input)) {
+          continue;
+        }
+        int input_port;
+        const string input_node = ParseNodeName(input, &input_port);
+        recomputable &= live_at_peak.count(strings::StrCat(
+                            input_node, ":", input_port)) > 0;
+      }
+      Costs::NanoSeconds recompute_cost(Costs::NanoSeconds::infinity());
+      if (recomputable) {
+        const OpTimes& times = op_times[producer.name()];
+        recompute_cost = times.completion - times.start;
+      }
+
+      if (recomputable && (!swappable || recompute_cost <= swap_cost)) {
+        candidate.recompute = true;
+        candidate.cost = recompute_cost;
+      } else if (swappable) {
+        candidate.recompute = false;
+        candidate.cost = swap_cost;
+      } else {
+        continue;
+      }
+      // Note that we must perform the arithmetic inexactly as "double", since
+      // the values do not fit into any integral type.
+      candidate.score = static_cast<double>(candidate.memory_used) /
+                        (1.0 + candidate.cost.count());
+      candidates.push_back(candidate);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    for (const EvictionCandidate& candidate : candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      evictions.push_back(candidate);
+      required_savings -= candidate.memory_used;
+    }
+  }
+
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  NodeMap node_map(&item->graph);
+  for (int node_number = 0; node_number < item->graph.node_size();
+       ++node_number) {
+    topological_numbering[item->graph.mutable_node(node_number)] =
+        item->graph.node_size() - node_number - 1;
+  }
+  bool updated_graph = false;
+  for (const EvictionCandidate& eviction : evictions) {
+    if (eviction.recompute) {
+      VLOG(1) << "Will recompute " << eviction.port.node->name() << " of size "
+              << eviction.memory_used << " at an estimated cost of "
+              << eviction.cost.count() << "ns";
+      std::unordered_set<NodeDef*> target_nodes;
+      for (const MutableGraphView::InputPort& use : eviction.uses_left) {
+        target_nodes.insert(use.node);
+      }
+      RecomputeSubgraph({eviction.port.node}, target_nodes, node_map,
+                        topological_numbering, &item->graph);
+      // The copy reads the same inputs, don't recompute it again.
+      skip_list->insert(eviction.port.node->name());
+      updated_graph = true;
+    } else {
+      for (const MutableGraphView::InputPort& use : eviction.uses_left) {
+        VLOG(1) << "Will swap fanout " << use.node->name() << ":"
+                << use.port_id << " of tensor " << eviction.port.node->name()
+                << ":" << eviction.port.port_id << " of size "
+                << eviction.memory_used << " at an estimated cost of "
+                << eviction.cost.count() << "ns";
+        (*nodes_to_swap)[use.node].inputs_to_swap.push_back(use.port_id);
+      }
+    }
+  }
+  return updated_graph;
+}
+
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, GrapplerItem* item,
-                  std::unordered_set<string>* skip_list) {
+                  int64 memory_budget_bytes, Cluster* cluster,
+                  GrapplerItem* item, std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
+  bool recomputed = false;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
     IdentifySwappingCandidates(cluster, item, skip_list, &nodes_to_swap);
+  } else if (optimization_level == RewriterConfig::COST_MODEL_HEURISTICS) {
+    recomputed = RecomputeOrIdentifySwappingCandidates(
+        cluster, memory_budget_bytes, item, skip_list, &nodes_to_swap);
   }
   // Look for manual annotatations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1160,11 +1444,17 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
         int64 input_id = val.i();
         swap_info.inputs_to_swap.push_back(input_id);
       }
+      // Swapping as bfloat16 loses precision, so it is only done for the
+      // nodes whose inputs are known to tolerate it.
+      auto it = node.attr().find("_swap_to_host_as_bfloat16");
+      if (it != node.attr().end()) {
+        swap_info.swap_as_bfloat16 = it->second.b();
+      }
     }
   }
   if (nodes_to_swap.empty()) {
     // Nothing to do.
-    return false;
+    return recomputed;
   }
 
   // Estimate the size of the data to swap for each node.
@@ -1174,7 +1464,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                             /*aggressive_shape_inference=*/false,
                             /*include_tensor_values=*/false)
            .ok()) {
-    return false;
+    return recomputed;
   }
   for (auto& swap : nodes_to_swap) {
     const NodeDef* node = swap.first;
@@ -1184,7 +1474,11 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
     int64 bytes_to_swap = 0;
     for (int64 input_id : swap_info.inputs_to_swap) {
       const OpInfo::TensorProperties& t = props[input_id];
-      bytes_to_swap += CalculateTensorSize(t);
+      int64 tensor_size = CalculateTensorSize(t);
+      if (swap_info.swap_as_bfloat16 && t.dtype() == DT_FLOAT) {
+        tensor_size /= 2;
+      }
+      bytes_to_swap += tensor_size;
     }
     // Let's assume we're going to swap over PCIe running at 16 GBps.
     swap_info.time_to_swap = bytes_to_swap / 16;
@@ -1192,7 +1486,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
 
   std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
   if (!EstimateEarliestExecutionTimes(*item, cluster, &execution_times).ok()) {
-    return false;
+    return recomputed;
   }
 
   std::unordered_map<string, const NodeDef*> name_map;
@@ -1245,8 +1539,18 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                .ok()) {
         continue;
       }
-      *swap_nodes.first->add_input() = node->input(input_id);
-      *node->mutable_input(input_id) = swap_nodes.second->name();
+      NodeDef* first_node = swap_nodes.first;
+      NodeDef* last_node = swap_nodes.second;
+      std::pair<NodeDef*, NodeDef*> cast_nodes;
+      if (swap_info.swap_as_bfloat16 &&
+          BuildSwapCastPair(swap_nodes, &item->graph, &cast_nodes).ok()) {
+        first_node = cast_nodes.first;
+        last_node = cast_nodes.second;
+        skip_list->insert(cast_nodes.first->name());
+        skip_list->insert(cast_nodes.second->name());
+      }
+      *first_node->add_input() = node->input(input_id);
+      *node->mutable_input(input_id) = last_node->name();
 
       // Add the control dependencies needed to delay the execution of the swap.
       out_trigger->add_input(strings::StrCat("^", swap_nodes.first->name()));
@@ -1257,7 +1561,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       skip_list->insert(swap_nodes.second->name());
     }
   }
-  return updated_graph;
+  return updated_graph || recomputed;
 }
 
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
@@ -1411,10 +1715,12 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ == RewriterConfig::COST_MODEL_HEURISTICS) &&
           cluster != nullptr) {
-        updated_graph |= SwappingPass(optimization_level_, cluster,
-                                      &optimized_item, &skip_list);
+        updated_graph |=
+            SwappingPass(optimization_level_, memory_budget_bytes_, cluster,
+                         &optimized_item, &skip_list);
       }
     }
   }
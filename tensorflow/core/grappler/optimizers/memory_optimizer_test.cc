@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/device_properties.pb.h"
 
@@ -294,6 +295,63 @@ TEST_F(MemoryOptimizerTest, SimpleSwapping) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, SwappingAsBfloat16) {
+  // Build a simple graph with an op that's marked for swapping as bfloat16.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  Output a =
+      ops::Variable(s.WithOpName("a").WithDevice("/gpu:0"), {10, 10}, DT_FLOAT);
+  Output b = ops::AddN(s.WithOpName("b").WithDevice("/gpu:0"), {a});
+  Output c = ops::AddN(s.WithOpName("c").WithDevice("/gpu:0"), {b});
+  Output d = ops::AddN(s.WithOpName("d").WithDevice("/gpu:0"), {c});
+  Output e = ops::AddN(s.WithOpName("e").WithDevice("/gpu:0"), {b, d});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e"};
+
+  EXPECT_EQ(NodeName(e.name()), item.graph.node(4).name());
+  NodeDef* e_node = item.graph.mutable_node(4);
+  (*e_node->mutable_attr())["_swap_to_host"].mutable_list()->add_i(0);
+  (*e_node->mutable_attr())["_swap_to_host_as_bfloat16"].set_b(true);
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::MANUAL);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : output.node()) {
+    nodes[node.name()] = &node;
+  }
+  ASSERT_EQ(9, nodes.size());
+
+  const NodeDef* cast_out = nodes["swap_out_e_0_to_bfloat16"];
+  ASSERT_NE(nullptr, cast_out);
+  EXPECT_EQ("Cast", cast_out->op());
+  EXPECT_EQ(DT_BFLOAT16, cast_out->attr().at("DstT").type());
+  EXPECT_EQ(NodeName(b.name()), cast_out->input(0));
+
+  const NodeDef* swap_out = nodes["swap_out_e_0"];
+  ASSERT_NE(nullptr, swap_out);
+  EXPECT_EQ(DT_BFLOAT16, swap_out->attr().at("T").type());
+  EXPECT_EQ(cast_out->name(), swap_out->input(0));
+
+  const NodeDef* swap_in = nodes["swap_in_e_0"];
+  ASSERT_NE(nullptr, swap_in);
+  EXPECT_EQ(DT_BFLOAT16, swap_in->attr().at("T").type());
+  EXPECT_EQ(swap_out->name(), swap_in->input(0));
+
+  const NodeDef* cast_in = nodes["swap_in_e_0_from_bfloat16"];
+  ASSERT_NE(nullptr, cast_in);
+  EXPECT_EQ(DT_FLOAT, cast_in->attr().at("DstT").type());
+  EXPECT_EQ(swap_in->name(), cast_in->input(0));
+
+  EXPECT_EQ(cast_in->name(), nodes["e"]->input(0));
+  EXPECT_EQ("^swap_out_e_0", nodes["c"]->input(1));
+}
+
 TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
@@ -346,6 +404,91 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+// Builds the graph of SwappingHeuristics, where e reads b, c and d long after
+// they are produced.
+GrapplerItem BuildEvictionGraph() {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Identity(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), v);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), a);
+  Output d = ops::Identity(s.WithOpName("d").WithDevice("/gpu:0"), b);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output e =
+      ops::Concat(s.WithOpName("e").WithDevice("/gpu:0"), {a, b, c, d}, axis);
+  Output f = ops::Square(s.WithOpName("f").WithDevice("/gpu:0"), a);
+  Output g = ops::Sqrt(s.WithOpName("g").WithDevice("/gpu:0"), b);
+  Output h = ops::Exp(s.WithOpName("h").WithDevice("/gpu:0"), c);
+  Output i = ops::Log(s.WithOpName("i").WithDevice("/gpu:0"), d);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e", "f", "g", "h", "i"};
+  item.init_ops = {init.name()};
+  return item;
+}
+
+// Returns the number of inputs of e which are swapped in or recomputed.
+int NumEvictedInputsOfE(const GraphDef& graph) {
+  int num_evicted = 0;
+  for (const auto& node : graph.node()) {
+    if (node.name() != "e") continue;
+    for (const string& input : node.input()) {
+      if (str_util::StartsWith(input, "swap_in_") ||
+          str_util::StartsWith(input, "Recomputed/")) {
+        ++num_evicted;
+      }
+    }
+  }
+  return num_evicted;
+}
+
+TEST_F(MemoryOptimizerTest, CostModelHeuristics) {
+  GrapplerItem item = BuildEvictionGraph();
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::COST_MODEL_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  EXPECT_GT(NumEvictedInputsOfE(output), 0);
+
+#if GOOGLE_CUDA
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+#endif
+}
+
+TEST_F(MemoryOptimizerTest, CostModelHeuristicsMemoryBudget) {
+  GrapplerItem item = BuildEvictionGraph();
+  // Enough memory for the whole graph.
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  DeviceProperties gpu_device =
+      cluster->GetDevices().at("/job:localhost/replica:0/task:0/gpu:0");
+  gpu_device.set_memory_size(1024 * 1024 * 1024);
+  std::unordered_map<string, DeviceProperties> devices = cluster->GetDevices();
+  devices["/job:localhost/replica:0/task:0/gpu:0"] = gpu_device;
+  VirtualCluster large_cluster(devices);
+
+  MemoryOptimizer no_budget(RewriterConfig::COST_MODEL_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(no_budget.Optimize(&large_cluster, item, &output));
+  EXPECT_EQ(NumEvictedInputsOfE(output), 0);
+
+  // The budget is enforced even though the device memory is large enough.
+  MemoryOptimizer with_budget(RewriterConfig::COST_MODEL_HEURISTICS,
+                              "gradients/", 1024 * 1024);
+  TF_EXPECT_OK(with_budget.Optimize(&large_cluster, item, &output));
+  EXPECT_GT(NumEvictedInputsOfE(output), 0);
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
+#include <algorithm>
+#include <map>
+
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -44,11 +47,19 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/canonicalizer.h"
 #include "tensorflow/core/grappler/utils/colocation.h"
 #include "tensorflow/core/grappler/utils/functions.h"
+#include "tensorflow/core/grappler/utils/graph_region.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
@@ -61,6 +72,7 @@ namespace {
 
 constexpr int kDefaultNumberOfIterations = 2;
 constexpr int kDefaultMinGraphNodes = 4;
+constexpr int kDefaultMaxFunctionOptimizationThreads = 8;
 
 int64 NumEdges(const GraphDef& graph) {
   int64 num_edges = 0;
@@ -83,10 +95,21 @@ int NumIterations(const RewriterConfig& cfg) {
              : cfg.meta_optimizer_iterations();
 }
 
+int NumFunctionOptimizationThreads(const RewriterConfig& cfg) {
+  if (cfg.function_optimization_threads() > 0) {
+    return cfg.function_optimization_threads();
+  }
+  // Every thread holds a copy of the function it optimizes and of the part of
+  // the library reachable from it, so we do not use all cores of big hosts.
+  return std::min(port::NumSchedulableCPUs(),
+                  kDefaultMaxFunctionOptimizationThreads);
+}
+
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
-         name == "loop_optimizer" || name == "auto_mixed_precision";
+         name == "loop_optimizer" || name == "auto_mixed_precision" ||
+         name == "auto_mixed_precision_cpu";
 }
 
 // Creates a function library stub from a real function library: copy only
@@ -175,6 +198,37 @@ bool MemoryOptimizerEnabled(
   return mem_opt_type != RewriterConfig::NO_MEM_OPT;
 }
 
+// Appends the deterministic serialization of `proto` to the cache key.
+void AppendToCacheKey(const protobuf::MessageLite& proto, string* key) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  strings::StrAppend(key, serialized.size(), ":", serialized);
+}
+
+void AppendToCacheKey(std::vector<string> names, string* key) {
+  std::sort(names.begin(), names.end());
+  strings::StrAppend(key, names.size(), ":", absl::StrJoin(names, ","), "\n");
+}
+
+// Writes `graph` to `path` in a temporary file first, so that concurrent
+// readers never see a partial cache entry.
+Status WriteCacheEntry(const string& path, const GraphDef& graph) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(string(io::Dirname(path))));
+  string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a unique file name for ", path);
+  }
+  Status s = WriteBinaryProto(env, tmp_path, graph);
+  if (s.ok()) {
+    s = env->RenameFile(tmp_path, path);
+  }
+  if (!s.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+  return s;
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, VALUE) \
@@ -189,10 +243,13 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("remap", new Remapper(cfg_.remapping(), xla_on_));
   MK_OPT("layout", new GenericLayoutOptimizer());
   MK_OPT("auto_mixed_precision",
-         new AutoMixedPrecision(cfg_.auto_mixed_precision()));
+         new AutoMixedPrecision(AutoMixedPrecisionMode::CUDA));
+  MK_OPT("auto_mixed_precision_cpu",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
   MK_OPT("memory", new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("arithmetic", new ArithmeticOptimizer(cfg_.arithmetic_optimization()));
-  MK_OPT("autoparallel", new AutoParallel(cfg_.auto_parallel().num_replicas()));
+  MK_OPT("autoparallel", new AutoParallel(cfg_.auto_parallel().num_replicas(),
+                                          cfg_.auto_parallel().pipeline()));
   MK_OPT("loop", new LoopOptimizer(cfg_.loop_optimization(), cpu_device_));
   MK_OPT("dependency", new DependencyOptimizer(cfg_.dependency_optimization()));
   MK_OPT("debug_stripper", new DebugStripper());
@@ -263,7 +320,11 @@ Status MetaOptimizer::InitializeOptimizers(
   }
   if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())) {
     optimizers->push_back(
-        MakeUnique<AutoMixedPrecision>(cfg_.auto_mixed_precision()));
+        MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::CUDA));
+  }
+  if (cfg_.auto_mixed_precision_cpu() == RewriterConfig::ON) {
+    optimizers->push_back(
+        MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
   }
   if (cfg_.layout_optimizer() != RewriterConfig::OFF) {
     optimizers->push_back(MakeUnique<GenericLayoutOptimizer>());
@@ -272,16 +333,19 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
+          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization(), "gradients/",
+                                      cfg_.memory_optimizer_budget_bytes()));
     } else {
       optimizers->push_back(MakeUnique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_budget_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable()) {
     optimizers->push_back(
-        MakeUnique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
+        MakeUnique<AutoParallel>(cfg_.auto_parallel().num_replicas(),
+                                 cfg_.auto_parallel().pipeline()));
   }
   if (cfg_.scoped_allocator_optimization()) {
     optimizers->push_back(MakeUnique<ScopedAllocatorOptimizer>(
@@ -508,7 +572,10 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, const GrapplerItem& item,
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -587,10 +654,162 @@ Status MetaOptimizer::RunOptimizer(
   return Status::OK();
 }
 
+string MetaOptimizer::CachePath(Cluster* cluster,
+                                const GrapplerItem& item) const {
+  const string& cache_dir = cfg_.meta_optimizer_cache_dir();
+  if (cache_dir.empty()) return "";
+
+  // The key covers everything the optimized graph depends on, including the
+  // TensorFlow version that produced it.
+  string key = strings::StrCat(TF_VERSION_STRING, "/", tf_git_version(), "\n");
+  ConfigProto config = config_proto_;
+  RewriterConfig* rewrite_options =
+      config.mutable_graph_options()->mutable_rewrite_options();
+  rewrite_options->clear_meta_optimizer_cache_dir();
+  // The optimized graph does not depend on the number of threads.
+  rewrite_options->clear_function_optimization_threads();
+  AppendToCacheKey(config, &key);
+  AppendToCacheKey(item.graph, &key);
+  for (const auto& feed : item.feed) {
+    TensorProto tensor;
+    feed.second.AsProtoTensorContent(&tensor);
+    strings::StrAppend(&key, feed.first, "\n");
+    AppendToCacheKey(tensor, &key);
+  }
+  AppendToCacheKey(item.fetch, &key);
+  AppendToCacheKey(item.init_ops, &key);
+  AppendToCacheKey(item.keep_ops, &key);
+  strings::StrAppend(&key, item.save_op, "\n", item.restore_op, "\n",
+                     item.save_restore_loc_tensor, "\n");
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    AppendToCacheKey(queue_runner, &key);
+  }
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  strings::StrAppend(&key, options.allow_non_differentiable_rewrites,
+                     options.allow_pruning_stateful_and_dataset_ops,
+                     options.optimize_function_library,
+                     options.is_eager_mode, "\n");
+  AppendToCacheKey(std::vector<string>(item.devices().begin(),
+                                       item.devices().end()),
+                   &key);
+  if (cluster != nullptr) {
+    std::map<string, DeviceProperties> devices(cluster->GetDevices().begin(),
+                                               cluster->GetDevices().end());
+    for (const auto& device : devices) {
+      strings::StrAppend(&key, device.first, "\n");
+      AppendToCacheKey(device.second, &key);
+    }
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return io::JoinPath(
+      cache_dir, strings::StrCat(
+                     "meta_optimizer_",
+                     strings::Hex(fingerprint.high64, strings::kZeroPad16),
+                     strings::Hex(fingerprint.low64, strings::kZeroPad16),
+                     ".pb"));
+}
+
 Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
+  const string cache_path = CachePath(cluster, item);
+  if (!cache_path.empty()) {
+    const Status s = ReadBinaryProto(Env::Default(), cache_path,
+                                     optimized_graph);
+    if (s.ok()) {
+      VLOG(1) << "Loaded optimized graph for grappler item " << item.id
+              << " from " << cache_path;
+      mutex_lock lock(optimization_results_mu_);
+      optimization_results_.clear();
+      return Status::OK();
+    }
+    if (!errors::IsNotFound(s)) {
+      LOG(WARNING) << "Ignoring meta-optimizer cache entry " << cache_path
+                   << ": " << s;
+    }
+  }
+
+  TF_RETURN_IF_ERROR(OptimizeGraphAndFunctions(cluster, item,
+                                               optimized_graph));
+
+  if (!cache_path.empty()) {
+    const Status s = WriteCacheEntry(cache_path, *optimized_graph);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to write meta-optimizer cache entry "
+                   << cache_path << ": " << s;
+    }
+  }
+  return Status::OK();
+}
+
+Status MetaOptimizer::OptimizeIncrementally(
+    Cluster* cluster, const GrapplerItem& item,
+    const std::vector<string>& changed_nodes, GraphDef* optimized_graph) {
+  std::vector<std::unique_ptr<GraphOptimizer>> optimizers;
+  if (cfg_.optimizers().empty()) {
+    TF_RETURN_IF_ERROR(InitializeOptimizers(&optimizers));
+  } else {
+    TF_RETURN_IF_ERROR(InitializeOptimizersByName(&optimizers));
+  }
+
+  // Optimizers that need to see the whole graph are skipped, and the region
+  // must be large enough for every other optimizer.
+  int radius = -1;
+  std::vector<GraphOptimizer*> local_optimizers;
+  for (const auto& optimizer : optimizers) {
+    if (optimizer->Locality() < 0) continue;
+    radius = std::max(radius, optimizer->Locality());
+    local_optimizers.push_back(optimizer.get());
+  }
+  if (local_optimizers.empty() || changed_nodes.empty()) {
+    VLOG(3) << "Skipping incremental optimization, nothing to do";
+    *optimized_graph = item.graph;
+    return Status::OK();
+  }
+
+  GraphRegion region;
+  TF_RETURN_IF_ERROR(ExtractGraphRegion(item, changed_nodes, radius, &region));
+  VLOG(1) << "Optimize GrapplerItem incrementally: item.id=" << item.id
+          << " num_optimizers=" << local_optimizers.size()
+          << ", num nodes = " << item.graph.node_size()
+          << ", num region nodes = " << region.nodes.size();
+
+  GrapplerItem optimized_item = region.item;
+  GraphDef optimized_region;
+  optimized_region.Swap(&optimized_item.graph);
+  GraphOptimizationResult optimization_result(
+      strings::StrCat(item.id, "_incremental"));
+  for (int iteration = 0; iteration < NumIterations(cfg_); ++iteration) {
+    for (GraphOptimizer* optimizer : local_optimizers) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (iteration > 0 && IsRunOnceOptimizer(optimizer->name())) continue;
+      TF_RETURN_IF_ERROR(RunOptimizer(optimizer, cluster, &optimized_item,
+                                      &optimized_region,
+                                      &optimization_result));
+    }
+  }
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
+
+  *optimized_graph = item.graph;
+  TF_RETURN_IF_ERROR(
+      SpliceGraphRegion(region, optimized_region, optimized_graph));
+  TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
+  ReassignColocation(optimized_graph);
+  return Status::OK();
+}
+
+Status MetaOptimizer::OptimizeGraphAndFunctions(Cluster* cluster,
+                                                const GrapplerItem& item,
+                                                GraphDef* optimized_graph) {
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock lock(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -670,6 +889,87 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     find_xla_compiled_functions(function.node_def());
   }
 
+  const bool is_tpu_graph = IsTPUGraphDef(*optimized_graph);
+
+  // Optimizes the body of `func` into `optimized_func_graph`. It only reads
+  // `flib`, so it can run concurrently for different functions.
+  const auto optimize_function =
+      [&](const FunctionDef& func, GrapplerFunctionItem* func_item,
+          GraphDef* optimized_func_graph) -> Status {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(
+        func, flib, trimmed_item.graph.versions().producer(), func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // TODO(b/129545186): Shape inference in GraphProperties doesn't work well
+    // with _Arg nodes. Replace them with Placeholders with unknown shape.
+    absl::flat_hash_set<absl::string_view> input_nodes;
+    for (auto& input_arg : func_item->inputs()) {
+      input_nodes.insert(input_arg.node_name);
+    }
+    for (NodeDef& func_node : *func_item->graph.mutable_node()) {
+      if (input_nodes.contains(func_node.name())) {
+        func_node.set_op("Placeholder");
+        auto& attrs = *func_node.mutable_attr();
+        attrs["dtype"] = attrs["T"];
+        attrs.erase("index");
+        attrs.erase("T");
+        TensorShapeProto unknown_shape;
+        unknown_shape.set_unknown_rank(true);
+        *(attrs["shape"].mutable_shape()) = unknown_shape;
+      }
+    }
+
+    // Optimize function body graph.
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only execption is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      FunctionDefLibrary func_item_function_library;
+      func_item_function_library.Swap(func_item->graph.mutable_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, *func_item,
+                                              optimized_func_graph);
+    }
+    return OptimizeGraph(cluster, *func_item, optimized_func_graph);
+  };
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   bool optimize_function_library =
@@ -678,10 +978,13 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    // Functions of the library do not depend on each other until we merge
+    // the optimized bodies and specializations back into `flib`, so we
+    // collect all functions to optimize in this pass, optimize them in
+    // parallel, and then update the library in the library order. This keeps
+    // the result independent of the number of threads.
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -698,87 +1001,48 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if (IsParametrized(func)) continue;
 
       VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
+              << funcs.size() << " of "
               << optimized_graph->library().function_size() << "]";
 
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(
-          func, flib, trimmed_item.graph.versions().producer(), &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
-      }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // TODO(b/129545186): Shape inference in GraphProperties doesn't work well
-      // with _Arg nodes. Replace them with Placeholders with unknown shape.
-      absl::flat_hash_set<absl::string_view> input_nodes;
-      for (auto& input_arg : func_item.inputs()) {
-        input_nodes.insert(input_arg.node_name);
+    const int num_funcs = funcs.size();
+    std::vector<GrapplerFunctionItem> func_items(num_funcs);
+    std::vector<GraphDef> optimized_func_graphs(num_funcs);
+    std::vector<Status> statuses(num_funcs);
+
+    const int num_threads =
+        std::min(num_funcs, NumFunctionOptimizationThreads(cfg_));
+    if (num_threads > 1) {
+      VLOG(2) << "Optimize " << num_funcs << " functions on " << num_threads
+              << " threads";
+      thread::ThreadPool pool(Env::Default(), "grappler_function_optimizer",
+                              num_threads);
+      for (int i = 0; i < num_funcs; ++i) {
+        pool.Schedule([&, i]() {
+          statuses[i] = optimize_function(*funcs[i], &func_items[i],
+                                          &optimized_func_graphs[i]);
+        });
       }
-      for (NodeDef& func_node : *func_item.graph.mutable_node()) {
-        if (input_nodes.contains(func_node.name())) {
-          func_node.set_op("Placeholder");
-          auto& attrs = *func_node.mutable_attr();
-          attrs["dtype"] = attrs["T"];
-          attrs.erase("index");
-          attrs.erase("T");
-          TensorShapeProto unknown_shape;
-          unknown_shape.set_unknown_rank(true);
-          *(attrs["shape"].mutable_shape()) = unknown_shape;
-        }
+      // The destructor of the pool waits for all scheduled closures.
+    } else {
+      for (int i = 0; i < num_funcs; ++i) {
+        statuses[i] = optimize_function(*funcs[i], &func_items[i],
+                                        &optimized_func_graphs[i]);
+        if (!statuses[i].ok()) break;
       }
+    }
 
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (IsTPUGraphDef(*optimized_graph)) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only execption is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        FunctionDefLibrary func_item_function_library;
-        func_item_function_library.Swap(func_item.graph.mutable_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        TF_RETURN_IF_ERROR(
-            OptimizeGraph(cluster, func_item, &optimized_func_graph));
-      }
+    for (int i = 0; i < num_funcs; ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+      const string& func_name = funcs[i]->signature().name();
+      GrapplerFunctionItem& func_item = func_items[i];
+      GraphDef& optimized_func_graph = optimized_func_graphs[i];
 
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
@@ -817,6 +1081,7 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 }
 
 void MetaOptimizer::PrintResult() {
+  mutex_lock lock(optimization_results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     LOG(INFO) << "Optimization results for grappler item: " << graph_result.id;
     for (const OptimizerResult& result : graph_result.results) {
@@ -850,6 +1115,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
+         rewrite_cfg.auto_mixed_precision_cpu() == RewriterConfig::ON ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
@@ -863,6 +1129,18 @@ Status RunMetaOptimizer(const GrapplerItem& item, const ConfigProto& cfg,
   return optimizer.Optimize(cluster, item, optimized_graph);
 }
 
+Status RunMetaOptimizerIncrementally(const GrapplerItem& item,
+                                     const std::vector<string>& changed_nodes,
+                                     const ConfigProto& cfg,
+                                     DeviceBase* cpu_device, Cluster* cluster,
+                                     GraphDef* optimized_graph) {
+  MetaOptimizer optimizer(cpu_device, cfg);
+  optimizer.set_deadline_usec(
+      DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
+  return optimizer.OptimizeIncrementally(cluster, item, changed_nodes,
+                                         optimized_graph);
+}
+
 Status OptimizeGraph(
     std::vector<string> ret_node_names, std::vector<string> keep_node_names,
     FunctionLibraryDefinition* flib, const DeviceSet& device_set,
@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -44,6 +46,14 @@ class MetaOptimizer : public GraphOptimizer {
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
 
+  // Re-optimizes `item`, whose graph is assumed to be optimized already except
+  // for the `changed_nodes` (e.g. the nodes added to it since then). Only the
+  // optimizers with a non-negative Locality() run, on the region of the graph
+  // within reach of the changed nodes. The function library is not optimized.
+  Status OptimizeIncrementally(Cluster* cluster, const GrapplerItem& item,
+                               const std::vector<string>& changed_nodes,
+                               GraphDef* optimized_graph);
+
   void PrintResult();
 
   void Feedback(Cluster* cluster, const GrapplerItem& item,
@@ -78,6 +88,15 @@ class MetaOptimizer : public GraphOptimizer {
   Status OptimizeGraph(Cluster* cluster, const GrapplerItem& item,
                        GraphDef* optimized_graph);
 
+  // Optimizes the main graph of `item` and the functions reachable from it.
+  Status OptimizeGraphAndFunctions(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* optimized_graph);
+
+  // Returns the path of the file in meta_optimizer_cache_dir that caches the
+  // result of optimizing `item` for `cluster`, or an empty string if caching
+  // is disabled.
+  string CachePath(Cluster* cluster, const GrapplerItem& item) const;
+
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
   RewriterConfig& cfg_;
@@ -99,7 +118,11 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  // Functions of the library are optimized in parallel, and each of them
+  // records its GraphOptimizationResult.
+  mutex optimization_results_mu_;
+  std::vector<GraphOptimizationResult> optimization_results_
+      GUARDED_BY(optimization_results_mu_);
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
@@ -114,6 +137,14 @@ Status RunMetaOptimizer(const GrapplerItem& item, const ConfigProto& cfg,
                         DeviceBase* cpu_device, Cluster* cluster,
                         GraphDef* optimized_graph);
 
+// Run the meta optimizer incrementally, only on the region of the graph around
+// `changed_nodes` (see MetaOptimizer::OptimizeIncrementally).
+Status RunMetaOptimizerIncrementally(const GrapplerItem& item,
+                                     const std::vector<string>& changed_nodes,
+                                     const ConfigProto& cfg,
+                                     DeviceBase* cpu_device, Cluster* cluster,
+                                     GraphDef* optimized_graph);
+
 // Wrapper around RunMetaOptimizer convenient for optimizing
 // function graphs.
 //
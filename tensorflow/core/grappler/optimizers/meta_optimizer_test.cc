@@ -29,6 +29,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -113,6 +116,8 @@ class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override {
     *optimized_graph = item.graph;
+    // Functions of the library are optimized in parallel.
+    mutex_lock lock(mu_);
     if (optimization_options_) {
       optimization_options_->insert({item.id, item.optimization_options()});
     }
@@ -123,10 +128,12 @@ class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
                 const GraphDef& optimized_graph, double result) override {}
 
  private:
+  static mutex mu_;
   static gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
       optimization_options_;
 };
 
+mutex GrapplerItemPropertiesAccumulator::mu_(LINKER_INITIALIZED);
 gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
     GrapplerItemPropertiesAccumulator::optimization_options_;
 
@@ -708,6 +715,76 @@ class SleepingOptimizer : public CustomGraphOptimizer {
 
 REGISTER_GRAPH_OPTIMIZER(SleepingOptimizer);
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  using test::function::NDef;
+
+  // Define function library of independent functions, each computing the
+  // same product twice:
+  //
+  //   MyFunc_i(x, y) = (x * y, x * y)
+  constexpr int kNumFunctions = 16;
+  std::vector<FunctionDef> function_library;
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+      NDef("b", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  GrapplerItem item;
+  item.id = "tf_graph";
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string func_name = absl::StrCat("MyFunc_", i);
+    FunctionDef func = FunctionDefHelper::Create(
+        func_name, {"x:float", "y:float"}, {"z0:float", "z1:float"}, {},
+        {{{"mul0"}, "Mul", {"x", "y"}, {{"T", DT_FLOAT}}},
+         {{"mul1"}, "Mul", {"x", "y"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z0", "mul0:z:0"}, {"z1", "mul1:z:0"}});
+    function_library.push_back(func);
+
+    const string call = absl::StrCat("call_", i);
+    const string out = absl::StrCat("out_", i);
+    nodes.push_back(NDef(call, func_name, {"a", "b"}, {}, kDevice));
+    nodes.push_back(
+        NDef(out, "Identity", {call + ":1"}, {{"T", DT_FLOAT}}, kDevice));
+    item.fetch.push_back(out);
+  }
+  item.graph = test::function::GDef(nodes, function_library);
+
+  // Optimizes the item with the arithmetic optimizer on `num_threads`.
+  const auto optimize = [&item](int num_threads) -> GraphDef {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.add_optimizers("arithmetic");
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_function_optimization_threads(num_threads);
+
+    GraphDef output;
+    TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                     .Optimize(nullptr, item, &output));
+    return output;
+  };
+
+  const GraphDef sequential = optimize(1);
+  const GraphDef parallel = optimize(4);
+
+  // Every function body was optimized ...
+  ASSERT_EQ(sequential.library().function_size(), kNumFunctions);
+  for (const FunctionDef& func : sequential.library().function()) {
+    int num_muls = 0;
+    for (const NodeDef& node : func.node_def()) {
+      if (node.op() == "Mul") ++num_muls;
+    }
+    EXPECT_EQ(num_muls, 1) << func.signature().name();
+  }
+
+  // ... and the result does not depend on the number of threads.
+  CompareGraphs(sequential, parallel);
+  ASSERT_EQ(parallel.library().function_size(), kNumFunctions);
+  for (int i = 0; i < kNumFunctions; ++i) {
+    CompareFunctions(sequential.library().function(i),
+                     parallel.library().function(i));
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizerTimesOut) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
   GrapplerItem item;
@@ -1009,6 +1086,102 @@ TEST_F(MetaOptimizerTest, CompressConstants) {
   }
 }
 
+TEST_F(MetaOptimizerTest, OptimizeIncrementally) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output old_check = ops::CheckNumerics(s.WithOpName("old_check"), x, "");
+  Output square_1 = ops::Square(s.WithOpName("square_1"), old_check);
+  Output square_2 = ops::Square(s.WithOpName("square_2"), square_1);
+  Output square_3 = ops::Square(s.WithOpName("square_3"), square_2);
+  Output new_check =
+      ops::CheckNumerics(s.WithOpName("new_check"), square_3, "");
+  Output y = ops::Square(s.WithOpName("y"), new_check);
+
+  GrapplerItem item;
+  item.fetch = {"y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("debug_stripper");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  // The debug stripper only needs to see the direct consumers of a node, so
+  // the nodes far away from the changed node are left as they are.
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.OptimizeIncrementally(nullptr, item, {"new_check"},
+                                               &output));
+
+  ASSERT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "old_check") {
+      EXPECT_EQ("CheckNumerics", node.op());
+    } else if (node.name() == "new_check") {
+      EXPECT_EQ("Identity", node.op());
+      EXPECT_EQ("square_3", node.input(0));
+    } else if (node.name() == "y") {
+      EXPECT_EQ("new_check", node.input(0));
+    }
+    EXPECT_FALSE(absl::StartsWith(node.name(), "GraphRegion/"));
+  }
+
+  Tensor x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4}));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x_t}});
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(MetaOptimizerTest, CachesOptimizedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache");
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_cache_dir(cache_dir);
+
+  // The first optimization is stored in the cache directory.
+  TestOptimizer::SetOptimized(false);
+  GraphDef first_output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &first_output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  std::vector<string> entries;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &entries));
+  EXPECT_EQ(entries.size(), 1);
+
+  // An identical item is served from the cache without running optimizers.
+  TestOptimizer::SetOptimized(false);
+  GraphDef second_output;
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &second_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(first_output, second_output);
+
+  // Different fetches or a different config are cache misses.
+  item.fetch.push_back(item.graph.node(0).name());
+  TestOptimizer::SetOptimized(false);
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &second_output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  rewriter_config.set_min_graph_nodes(-2);
+  TestOptimizer::SetOptimized(false);
+  TF_EXPECT_OK(MetaOptimizer(nullptr, config_proto)
+                   .Optimize(nullptr, item, &second_output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &entries));
+  EXPECT_EQ(entries.size(), 3);
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
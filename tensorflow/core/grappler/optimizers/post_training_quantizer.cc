@@ -0,0 +1,610 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/post_training_quantizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kPrefix[] = "PostTrainingQuantizer";
+
+string CanonicalTensorName(const string& tensor_name) {
+  const TensorId id = ParseTensorName(tensor_name);
+  if (id.index() == 0) return string(id.node());
+  return strings::StrCat(id.node(), ":", id.index());
+}
+
+// Makes the range valid for the quantized kernels, the same way QuantizeV2
+// does: the range must contain zero and can not be empty.
+void NudgeRange(float* min, float* max) {
+  *min = std::min(0.0f, *min);
+  const float epsilon =
+      std::max(1.0f, std::max(std::fabs(*min), std::fabs(*max))) / 100.0f;
+  *max = std::max(0.0f, std::max(*max, *min + epsilon));
+}
+
+// Same as FloatToQuantized<quint8> in kernels/quantization_utils.h, which
+// is the mapping that the MIN_FIRST mode of QuantizeV2 and Dequantize uses.
+uint8 FloatToQuint8(float value, float min, float max) {
+  const double range = (max - min) * (256.0 / 255.0);
+  const double range_scale = 256.0 / range;
+  const int64 quantized =
+      std::round(value * range_scale) - std::round(min * range_scale);
+  return static_cast<uint8>(
+      std::min<int64>(255, std::max<int64>(0, quantized)));
+}
+
+void QuantizeTensor(const Tensor& value, Tensor* quantized, float* min,
+                    float* max) {
+  const auto values = value.flat<float>();
+  *min = 0.0f;
+  *max = 0.0f;
+  for (int64 i = 0; i < values.size(); ++i) {
+    *min = std::min(*min, values(i));
+    *max = std::max(*max, values(i));
+  }
+  NudgeRange(min, max);
+  *quantized = Tensor(DT_QUINT8, value.shape());
+  auto quantized_values = quantized->flat<quint8>();
+  for (int64 i = 0; i < values.size(); ++i) {
+    quantized_values(i) = FloatToQuint8(values(i), *min, *max);
+  }
+}
+
+bool IsOnCpu(const NodeDef& node) {
+  if (node.device().empty()) return true;
+  DeviceNameUtils::ParsedName parsed_name;
+  return DeviceNameUtils::ParseFullName(node.device(), &parsed_name) &&
+         (!parsed_name.has_type || parsed_name.type == DEVICE_CPU);
+}
+
+bool HasFloatType(const NodeDef& node) {
+  auto it = node.attr().find("T");
+  return it != node.attr().end() && it->second.type() == DT_FLOAT;
+}
+
+bool HasNhwcFormat(const NodeDef& node) {
+  auto it = node.attr().find("data_format");
+  return it == node.attr().end() || it->second.s() == "NHWC";
+}
+
+// Returns true if the Conv2D attributes are supported by the CPU kernel of
+// QuantizedConv2D.
+bool IsSupportedConv2D(const NodeDef& node) {
+  if (!HasNhwcFormat(node)) return false;
+  if (node.attr().at("padding").s() == "EXPLICIT") return false;
+  const auto& strides = node.attr().at("strides").list().i();
+  if (strides.size() != 4 || strides[0] != 1 || strides[3] != 1 ||
+      strides[1] != strides[2]) {
+    return false;
+  }
+  auto it = node.attr().find("dilations");
+  if (it != node.attr().end()) {
+    for (int64 dilation : it->second.list().i()) {
+      if (dilation != 1) return false;
+    }
+  }
+  return true;
+}
+
+// Reads the float value of the constant `node` into `value`.
+bool GetFloatConstant(const NodeDef& node, Tensor* value) {
+  if (!IsConstant(node) || node.attr().at("dtype").type() != DT_FLOAT) {
+    return false;
+  }
+  return value->FromProto(node.attr().at("value").tensor());
+}
+
+// A float MatMul or Conv2D with the BiasAdd and activation that follow it,
+// rewritten into a single chain of quantized nodes. The chain reads and
+// produces 8 bit tensors, and `tail` is the node whose result it produces.
+struct QuantizedChain {
+  const NodeDef* anchor = nullptr;
+  const NodeDef* bias_add = nullptr;
+  const NodeDef* activation = nullptr;
+  const NodeDef* tail = nullptr;
+  Tensor weights;
+  Tensor bias;
+  float input_min, input_max;
+  float anchor_min, anchor_max;
+  float output_min, output_max;
+};
+
+class Quantizer {
+ public:
+  Quantizer(const GrapplerItem& item, const CalibrationRanges& ranges)
+      : item_(item),
+        ranges_(ranges),
+        nodes_to_preserve_(item.NodesToPreserve()) {}
+
+  Status Optimize(GraphDef* optimized_graph);
+
+ private:
+  struct Fanout {
+    int data = 0;
+    int control = 0;
+    // The only data consumer, if there is exactly one.
+    const NodeDef* consumer = nullptr;
+  };
+
+  // Returns the node that `node` can be fused with, i.e. the only consumer of
+  // its result if the node itself can be removed.
+  const NodeDef* FusibleConsumer(const NodeDef& node) const;
+  bool LookupRange(const string& tensor_name, float* min, float* max) const;
+  bool MatchChain(const NodeDef& anchor, QuantizedChain* chain) const;
+
+  // Returns true if the result of the chain is only read by other chains, so
+  // that it never has to be dequantized.
+  bool OnlyFeedsChains(const QuantizedChain& chain) const;
+
+  NodeDef* AddNode(const string& name, const string& op,
+                   const QuantizedChain& chain,
+                   const std::vector<string>& inputs);
+  string AddFloatConstant(const string& name, const QuantizedChain& chain,
+                          float value);
+  string AddQuantizedConstant(const string& name, const QuantizedChain& chain,
+                              const Tensor& value, string* min, string* max);
+  // Adds the quantized nodes of `chain`, and returns the name of its final
+  // Requantize node.
+  string AddChain(const QuantizedChain& chain);
+
+  const GrapplerItem& item_;
+  const CalibrationRanges& ranges_;
+  const std::unordered_set<string> nodes_to_preserve_;
+  std::unordered_map<string, const NodeDef*> nodes_;
+  std::unordered_map<string, Fanout> fanouts_;
+  // Chains keyed by the name of their tail node.
+  std::unordered_map<string, QuantizedChain> chains_;
+  // Names of the QuantizeV2 nodes, keyed by the float tensor they quantize.
+  std::unordered_map<string, string> quantized_inputs_;
+  GraphDef* graph_ = nullptr;
+};
+
+const NodeDef* Quantizer::FusibleConsumer(const NodeDef& node) const {
+  if (nodes_to_preserve_.count(node.name()) > 0) return nullptr;
+  auto it = fanouts_.find(node.name());
+  if (it == fanouts_.end() || it->second.data != 1 ||
+      it->second.control != 0) {
+    return nullptr;
+  }
+  const NodeDef* consumer = it->second.consumer;
+  if (consumer->input_size() == 0 || consumer->input(0) != node.name() ||
+      consumer->device() != node.device()) {
+    return nullptr;
+  }
+  return consumer;
+}
+
+bool Quantizer::LookupRange(const string& tensor_name, float* min,
+                            float* max) const {
+  if (!ranges_.Lookup(tensor_name, min, max)) return false;
+  NudgeRange(min, max);
+  return true;
+}
+
+bool Quantizer::MatchChain(const NodeDef& anchor,
+                           QuantizedChain* chain) const {
+  if (!IsOnCpu(anchor) || !HasFloatType(anchor)) return false;
+  if (IsConv2D(anchor)) {
+    if (!IsSupportedConv2D(anchor)) return false;
+  } else if (!IsMatMul(anchor)) {
+    return false;
+  }
+  if (anchor.input_size() < 2 || IsControlInput(anchor.input(0)) ||
+      IsControlInput(anchor.input(1))) {
+    return false;
+  }
+  const TensorId weights_id = ParseTensorName(anchor.input(1));
+  auto weights = nodes_.find(string(weights_id.node()));
+  if (weights_id.index() != 0 || weights == nodes_.end() ||
+      !GetFloatConstant(*weights->second, &chain->weights)) {
+    return false;
+  }
+  if (!LookupRange(anchor.input(0), &chain->input_min, &chain->input_max)) {
+    return false;
+  }
+
+  chain->anchor = &anchor;
+  chain->bias_add = nullptr;
+  chain->activation = nullptr;
+  chain->tail = nullptr;
+  const bool has_anchor_range =
+      LookupRange(anchor.name(), &chain->anchor_min, &chain->anchor_max);
+  if (has_anchor_range) {
+    chain->tail = &anchor;
+    chain->output_min = chain->anchor_min;
+    chain->output_max = chain->anchor_max;
+  }
+
+  // The bias is added to the requantized result of the anchor, so it needs
+  // the range of the anchor too.
+  const NodeDef* node = FusibleConsumer(anchor);
+  if (has_anchor_range && node != nullptr && IsBiasAdd(*node) &&
+      HasFloatType(*node) && HasNhwcFormat(*node) &&
+      !IsControlInput(node->input(1)) &&
+      ParseTensorName(node->input(1)).index() == 0) {
+    auto bias = nodes_.find(NodeName(node->input(1)));
+    if (bias != nodes_.end() && GetFloatConstant(*bias->second, &chain->bias) &&
+        chain->bias.dims() == 1) {
+      chain->bias_add = node;
+      node = FusibleConsumer(*node);
+    } else {
+      node = nullptr;
+    }
+  }
+  if (node != nullptr && (IsRelu(*node) || IsRelu6(*node)) &&
+      HasFloatType(*node)) {
+    chain->activation = node;
+  }
+
+  // The chain ends at its last node with a known range.
+  for (const NodeDef* tail : {chain->activation, chain->bias_add}) {
+    if (tail != nullptr &&
+        LookupRange(tail->name(), &chain->output_min, &chain->output_max)) {
+      chain->tail = tail;
+      break;
+    }
+  }
+  if (chain->tail == nullptr) return false;
+  if (chain->tail == chain->bias_add) {
+    chain->activation = nullptr;
+  } else if (chain->tail == chain->anchor) {
+    chain->bias_add = nullptr;
+    chain->activation = nullptr;
+  }
+  return true;
+}
+
+bool Quantizer::OnlyFeedsChains(const QuantizedChain& chain) const {
+  const string& name = chain.tail->name();
+  if (nodes_to_preserve_.count(name) > 0) return false;
+  auto it = fanouts_.find(name);
+  if (it == fanouts_.end() || it->second.control > 0) return false;
+  int chain_inputs = 0;
+  for (const auto& consumer : chains_) {
+    if (CanonicalTensorName(consumer.second.anchor->input(0)) == name) {
+      ++chain_inputs;
+    }
+  }
+  return chain_inputs == it->second.data;
+}
+
+NodeDef* Quantizer::AddNode(const string& name, const string& op,
+                            const QuantizedChain& chain,
+                            const std::vector<string>& inputs) {
+  NodeDef* node = graph_->add_node();
+  node->set_name(
+      strings::StrCat(kPrefix, "/", chain.anchor->name(), "/", name));
+  node->set_op(op);
+  node->set_device(chain.anchor->device());
+  for (const string& input : inputs) node->add_input(input);
+  return node;
+}
+
+string Quantizer::AddFloatConstant(const string& name,
+                                   const QuantizedChain& chain, float value) {
+  NodeDef* node = AddNode(name, "Const", chain, {});
+  SetAttrValue(DT_FLOAT, &(*node->mutable_attr())["dtype"]);
+  Tensor(value).AsProtoTensorContent(
+      (*node->mutable_attr())["value"].mutable_tensor());
+  return node->name();
+}
+
+string Quantizer::AddQuantizedConstant(const string& name,
+                                       const QuantizedChain& chain,
+                                       const Tensor& value, string* min,
+                                       string* max) {
+  Tensor quantized;
+  float min_value, max_value;
+  QuantizeTensor(value, &quantized, &min_value, &max_value);
+  NodeDef* node = AddNode(name, "Const", chain, {});
+  SetAttrValue(DT_QUINT8, &(*node->mutable_attr())["dtype"]);
+  quantized.AsProtoTensorContent(
+      (*node->mutable_attr())["value"].mutable_tensor());
+  *min = AddFloatConstant(strings::StrCat(name, "_min"), chain, min_value);
+  *max = AddFloatConstant(strings::StrCat(name, "_max"), chain, max_value);
+  return node->name();
+}
+
+string Quantizer::AddChain(const QuantizedChain& chain) {
+  const NodeDef& anchor = *chain.anchor;
+
+  // Read the input in the 8 bit domain when it is produced by another chain.
+  string input, input_min, input_max;
+  auto producer = chains_.find(CanonicalTensorName(anchor.input(0)));
+  if (producer != chains_.end()) {
+    input = strings::StrCat(kPrefix, "/", producer->second.anchor->name(),
+                            "/requantize");
+  } else {
+    const string tensor = CanonicalTensorName(anchor.input(0));
+    auto it = quantized_inputs_.find(tensor);
+    if (it == quantized_inputs_.end()) {
+      const string min = AddFloatConstant("input_min", chain, chain.input_min);
+      const string max = AddFloatConstant("input_max", chain, chain.input_max);
+      NodeDef* quantize = AddNode("quantize_input", "QuantizeV2", chain,
+                                  {anchor.input(0), min, max});
+      SetAttrValue(DT_QUINT8, &(*quantize->mutable_attr())["T"]);
+      SetAttrValue("MIN_FIRST", &(*quantize->mutable_attr())["mode"]);
+      it = quantized_inputs_.emplace(tensor, quantize->name()).first;
+    }
+    input = it->second;
+  }
+  input_min = strings::StrCat(input, ":1");
+  input_max = strings::StrCat(input, ":2");
+
+  string weights_min, weights_max;
+  const string weights = AddQuantizedConstant("weights", chain, chain.weights,
+                                              &weights_min, &weights_max);
+  NodeDef* quantized;
+  if (IsConv2D(anchor)) {
+    quantized = AddNode("conv", "QuantizedConv2D", chain,
+                        {input, weights, input_min, input_max, weights_min,
+                         weights_max});
+    SetAttrValue(DT_QUINT8, &(*quantized->mutable_attr())["Tinput"]);
+    SetAttrValue(DT_QUINT8, &(*quantized->mutable_attr())["Tfilter"]);
+    SetAttrValue(DT_QINT32, &(*quantized->mutable_attr())["out_type"]);
+    for (const char* attr : {"strides", "padding", "dilations"}) {
+      auto it = anchor.attr().find(attr);
+      if (it != anchor.attr().end()) {
+        (*quantized->mutable_attr())[attr] = it->second;
+      }
+    }
+  } else {
+    quantized = AddNode("matmul", "QuantizedMatMul", chain,
+                        {input, weights, input_min, input_max, weights_min,
+                         weights_max});
+    SetAttrValue(DT_QUINT8, &(*quantized->mutable_attr())["T1"]);
+    SetAttrValue(DT_QUINT8, &(*quantized->mutable_attr())["T2"]);
+    SetAttrValue(DT_QINT32, &(*quantized->mutable_attr())["Toutput"]);
+    for (const char* attr : {"transpose_a", "transpose_b"}) {
+      auto it = anchor.attr().find(attr);
+      if (it != anchor.attr().end()) {
+        (*quantized->mutable_attr())[attr] = it->second;
+      }
+    }
+  }
+  // The control dependencies of all the fused nodes must be preserved.
+  for (const NodeDef* node : {chain.anchor, chain.bias_add, chain.activation}) {
+    if (node == nullptr) continue;
+    for (const string& input : node->input()) {
+      if (IsControlInput(input)) quantized->add_input(input);
+    }
+  }
+  string result = quantized->name();
+
+  auto add_requantize = [this, &chain](const string& name,
+                                       const string& input, float min,
+                                       float max) -> string {
+    NodeDef* requantize = AddNode(
+        name, "Requantize", chain,
+        {input, strings::StrCat(input, ":1"), strings::StrCat(input, ":2"),
+         AddFloatConstant(strings::StrCat(name, "_min"), chain, min),
+         AddFloatConstant(strings::StrCat(name, "_max"), chain, max)});
+    SetAttrValue(DT_QINT32, &(*requantize->mutable_attr())["Tinput"]);
+    SetAttrValue(DT_QUINT8, &(*requantize->mutable_attr())["out_type"]);
+    return requantize->name();
+  };
+
+  if (chain.bias_add != nullptr) {
+    const string requantized = add_requantize(
+        "requantize_accumulator", result, chain.anchor_min, chain.anchor_max);
+    string bias_min, bias_max;
+    const string bias =
+        AddQuantizedConstant("bias", chain, chain.bias, &bias_min, &bias_max);
+    NodeDef* bias_add = AddNode(
+        "bias_add", "QuantizedBiasAdd", chain,
+        {requantized, bias, strings::StrCat(requantized, ":1"),
+         strings::StrCat(requantized, ":2"), bias_min, bias_max});
+    SetAttrValue(DT_QUINT8, &(*bias_add->mutable_attr())["T1"]);
+    SetAttrValue(DT_QUINT8, &(*bias_add->mutable_attr())["T2"]);
+    SetAttrValue(DT_QINT32, &(*bias_add->mutable_attr())["out_type"]);
+    result = bias_add->name();
+  }
+
+  if (chain.activation != nullptr) {
+    NodeDef* activation = AddNode(
+        "activation", IsRelu(*chain.activation) ? "QuantizedRelu"
+                                                : "QuantizedRelu6",
+        chain,
+        {result, strings::StrCat(result, ":1"), strings::StrCat(result, ":2")});
+    SetAttrValue(DT_QINT32, &(*activation->mutable_attr())["Tinput"]);
+    SetAttrValue(DT_QINT32, &(*activation->mutable_attr())["out_type"]);
+    result = activation->name();
+  }
+
+  return add_requantize("requantize", result, chain.output_min,
+                        chain.output_max);
+}
+
+Status Quantizer::Optimize(GraphDef* optimized_graph) {
+  const GraphDef& graph = item_.graph;
+  for (const NodeDef& node : graph.node()) {
+    if (absl::StartsWith(node.name(), kPrefix)) {
+      return errors::Aborted("The graph is already quantized.");
+    }
+    nodes_[node.name()] = &node;
+  }
+  for (const NodeDef& node : graph.node()) {
+    for (const string& input : node.input()) {
+      Fanout& fanout = fanouts_[NodeName(input)];
+      if (IsControlInput(input)) {
+        ++fanout.control;
+      } else {
+        fanout.consumer = ++fanout.data == 1 ? &node : nullptr;
+      }
+    }
+  }
+
+  std::unordered_set<string> fused_nodes;
+  for (const NodeDef& node : graph.node()) {
+    QuantizedChain chain;
+    if (!MatchChain(node, &chain)) continue;
+    for (const NodeDef* fused :
+         {chain.anchor, chain.bias_add, chain.activation}) {
+      if (fused != nullptr) fused_nodes.insert(fused->name());
+    }
+    chains_.emplace(chain.tail->name(), chain);
+  }
+  if (chains_.empty()) return errors::Aborted("Nothing to do.");
+
+  // The weights and biases are replaced by their quantized copies.
+  for (const auto& it : chains_) {
+    const QuantizedChain& chain = it.second;
+    for (const NodeDef* node : {chain.anchor, chain.bias_add}) {
+      if (node == nullptr) continue;
+      const string constant = NodeName(node->input(1));
+      if (nodes_to_preserve_.count(constant) == 0 &&
+          nodes_.at(constant)->input_size() == 0 &&
+          fanouts_[constant].data == 1 && fanouts_[constant].control == 0) {
+        fused_nodes.insert(constant);
+      }
+    }
+  }
+
+  graph_ = optimized_graph;
+  *graph_->mutable_versions() = graph.versions();
+  *graph_->mutable_library() = graph.library();
+  for (const NodeDef& node : graph.node()) {
+    if (fused_nodes.count(node.name()) == 0) *graph_->add_node() = node;
+  }
+
+  // Only the chains whose result is read by float nodes are dequantized, in
+  // place of their tail node.
+  for (const auto& it : chains_) {
+    const QuantizedChain& chain = it.second;
+    const string requantize = AddChain(chain);
+    if (OnlyFeedsChains(chain)) continue;
+    NodeDef* dequantize = graph_->add_node();
+    dequantize->set_name(chain.tail->name());
+    dequantize->set_op("Dequantize");
+    dequantize->set_device(chain.tail->device());
+    dequantize->add_input(requantize);
+    dequantize->add_input(strings::StrCat(requantize, ":1"));
+    dequantize->add_input(strings::StrCat(requantize, ":2"));
+    SetAttrValue(DT_QUINT8, &(*dequantize->mutable_attr())["T"]);
+    SetAttrValue("MIN_FIRST", &(*dequantize->mutable_attr())["mode"]);
+  }
+
+  VLOG(1) << "Quantized " << chains_.size() << " MatMul and Conv2D nodes.";
+  return Status::OK();
+}
+
+}  // namespace
+
+void CalibrationRanges::Record(const string& tensor_name,
+                               const Tensor& value) {
+  const auto values = value.flat<float>();
+  if (values.size() == 0) return;
+  auto it = ranges_.emplace(CanonicalTensorName(tensor_name),
+                            std::make_pair(values(0), values(0)))
+                .first;
+  for (int64 i = 0; i < values.size(); ++i) {
+    it->second.first = std::min(it->second.first, values(i));
+    it->second.second = std::max(it->second.second, values(i));
+  }
+}
+
+bool CalibrationRanges::Lookup(const string& tensor_name, float* min,
+                               float* max) const {
+  auto it = ranges_.find(CanonicalTensorName(tensor_name));
+  if (it == ranges_.end()) return false;
+  *min = it->second.first;
+  *max = it->second.second;
+  return true;
+}
+
+string CalibrationRanges::ToString() const {
+  string serialized;
+  for (const auto& it : ranges_) {
+    strings::StrAppend(&serialized, it.first, " ", it.second.first, " ",
+                       it.second.second, "\n");
+  }
+  return serialized;
+}
+
+Status CalibrationRanges::FromString(const string& serialized) {
+  for (const string& line :
+       str_util::Split(serialized, '\n', str_util::SkipEmpty())) {
+    const std::vector<string> fields =
+        str_util::Split(line, ' ', str_util::SkipEmpty());
+    float min, max;
+    if (fields.size() != 3 || !strings::safe_strtof(fields[1], &min) ||
+        !strings::safe_strtof(fields[2], &max) || min > max) {
+      return errors::InvalidArgument("Invalid calibration range: ", line);
+    }
+    auto& range = ranges_[CanonicalTensorName(fields[0])];
+    range.first = min;
+    range.second = max;
+  }
+  return Status::OK();
+}
+
+Status PostTrainingQuantizer::Init(
+    const tensorflow::RewriterConfig_CustomGraphOptimizer* config) {
+  if (!config) return Status::OK();
+  const auto& parameters = config->parameter_map();
+  auto it = parameters.find("calibration");
+  if (it != parameters.end()) {
+    string serialized;
+    TF_RETURN_IF_ERROR(
+        ReadFileToString(Env::Default(), it->second.s(), &serialized));
+    TF_RETURN_IF_ERROR(ranges_.FromString(serialized));
+  }
+  return Status::OK();
+}
+
+Status PostTrainingQuantizer::Optimize(Cluster* /*cluster*/,
+                                       const GrapplerItem& item,
+                                       GraphDef* optimized_graph) {
+  if (ranges_.empty()) return errors::Aborted("Nothing to do.");
+  optimized_graph->Clear();
+  Quantizer quantizer(item, ranges_);
+  return quantizer.Optimize(optimized_graph);
+}
+
+void PostTrainingQuantizer::Feedback(Cluster* /*cluster*/,
+                                     const GrapplerItem& /*item*/,
+                                     const GraphDef& /*optimized_graph*/,
+                                     double /*result*/) {
+  // Nothing to do for PostTrainingQuantizer.
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(PostTrainingQuantizer, "post_training_quantizer");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
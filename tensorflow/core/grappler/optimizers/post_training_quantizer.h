@@ -0,0 +1,92 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_POST_TRAINING_QUANTIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_POST_TRAINING_QUANTIZER_H_
+
+#include <map>
+#include <utility>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Value ranges of float tensors, as observed while running a graph on a
+// representative calibration data set.
+class CalibrationRanges {
+ public:
+  // Widens the range of `tensor_name` (e.g. "node" or "node:1") to include
+  // all the values of `value`, which must be a float tensor.
+  void Record(const string& tensor_name, const Tensor& value);
+
+  // Looks up the range of `tensor_name`. Returns false if it was never
+  // recorded.
+  bool Lookup(const string& tensor_name, float* min, float* max) const;
+
+  bool empty() const { return ranges_.empty(); }
+
+  // Serializes the ranges as one "<tensor_name> <min> <max>" line per tensor.
+  string ToString() const;
+  // Adds the ranges serialized by ToString().
+  Status FromString(const string& serialized);
+
+ private:
+  // Keyed by the canonical tensor name, i.e. with no ":0" suffix.
+  std::map<string, std::pair<float, float>> ranges_;
+};
+
+// PostTrainingQuantizer rewrites float MatMul and Conv2D nodes with constant
+// weights that run on CPU, together with the BiasAdd and Relu/Relu6 nodes
+// that directly follow them, into the 8 bit QuantizedMatMul and
+// QuantizedConv2D kernels followed by QuantizedBiasAdd, QuantizedRelu and a
+// Requantize back to 8 bits. The weights and biases are quantized offline,
+// and the activation ranges come from calibration, so no range has to be
+// computed at runtime. Quantized nodes that feed each other stay in the 8 bit
+// domain: activations are only quantized and dequantized where the graph
+// crosses between float nodes and rewritten ones.
+//
+// The optimizer is not enabled by default. It must be registered through
+// RewriterConfig.custom_optimizers with a `calibration` parameter that names a
+// file written by CalibrationRanges::ToString().
+class PostTrainingQuantizer : public CustomGraphOptimizer {
+ public:
+  PostTrainingQuantizer() {}
+  explicit PostTrainingQuantizer(CalibrationRanges ranges)
+      : ranges_(std::move(ranges)) {}
+  ~PostTrainingQuantizer() override {}
+
+  string name() const override { return "post_training_quantizer"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override;
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+
+ private:
+  CalibrationRanges ranges_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_POST_TRAINING_QUANTIZER_H_
@@ -0,0 +1,202 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/post_training_quantizer.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class PostTrainingQuantizerTest : public GrapplerTest {
+ protected:
+  // Runs the graph of `item` on random values of `input_shape` fed to `x`,
+  // and records the ranges of `tensors`.
+  CalibrationRanges Calibrate(const GrapplerItem& item,
+                              const TensorShape& input_shape,
+                              const std::vector<string>& tensors) {
+    CalibrationRanges ranges;
+    for (int i = 0; i < 8; ++i) {
+      Tensor x_t = GenerateRandomTensor<DT_FLOAT>(input_shape);
+      auto values = EvaluateNodes(item.graph, tensors, {{"x", x_t}});
+      for (int j = 0; j < tensors.size(); ++j) {
+        ranges.Record(tensors[j], values[j]);
+      }
+    }
+    return ranges;
+  }
+
+  // Checks that `optimized` computes roughly the same fetches as `item`.
+  void ExpectSameResults(const GrapplerItem& item, const GraphDef& optimized,
+                         const TensorShape& input_shape) {
+    Tensor x_t = GenerateRandomTensor<DT_FLOAT>(input_shape);
+    auto expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+    auto actual = EvaluateNodes(optimized, item.fetch, {{"x", x_t}});
+    ASSERT_EQ(expected.size(), actual.size());
+    for (int i = 0; i < expected.size(); ++i) {
+      float max_abs = 0.0f;
+      for (int64 j = 0; j < expected[i].NumElements(); ++j) {
+        max_abs = std::max(max_abs, std::abs(expected[i].flat<float>()(j)));
+      }
+      test::ExpectTensorNear<float>(expected[i], actual[i], 0.05 * max_abs);
+    }
+  }
+};
+
+const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) return &node;
+  }
+  return nullptr;
+}
+
+int CountOps(const GraphDef& graph, const string& op) {
+  int count = 0;
+  for (const NodeDef& node : graph.node()) {
+    if (node.op() == op) ++count;
+  }
+  return count;
+}
+
+TEST_F(PostTrainingQuantizerTest, CalibrationRanges) {
+  CalibrationRanges ranges;
+  EXPECT_TRUE(ranges.empty());
+  ranges.Record("a", test::AsTensor<float>({1.0f, -2.0f, 0.5f}));
+  ranges.Record("a:0", test::AsTensor<float>({3.0f}));
+  ranges.Record("b:1", test::AsTensor<float>({0.25f, 0.75f}));
+
+  CalibrationRanges parsed;
+  TF_ASSERT_OK(parsed.FromString(ranges.ToString()));
+  float min, max;
+  ASSERT_TRUE(parsed.Lookup("a", &min, &max));
+  EXPECT_EQ(-2.0f, min);
+  EXPECT_EQ(3.0f, max);
+  ASSERT_TRUE(parsed.Lookup("b:1", &min, &max));
+  EXPECT_EQ(0.25f, min);
+  EXPECT_EQ(0.75f, max);
+  EXPECT_FALSE(parsed.Lookup("b", &min, &max));
+
+  EXPECT_TRUE(errors::IsInvalidArgument(parsed.FromString("c 1.0\n")));
+  EXPECT_TRUE(errors::IsInvalidArgument(parsed.FromString("c 2.0 1.0\n")));
+}
+
+TEST_F(PostTrainingQuantizerTest, NothingToDoWithoutCalibration) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 4}));
+  Output w = ops::Const(s.WithOpName("w"), 1.0f, {4, 3});
+  Output y = ops::MatMul(s.WithOpName("y"), x, w);
+
+  GrapplerItem item;
+  item.fetch = {"y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  PostTrainingQuantizer optimizer;
+  TF_EXPECT_OK(optimizer.Init());
+  GraphDef output;
+  EXPECT_TRUE(errors::IsAborted(optimizer.Optimize(nullptr, item, &output)));
+}
+
+TEST_F(PostTrainingQuantizerTest, QuantizeMatMulChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 4}));
+  Output w1 = ops::Const(s.WithOpName("w1"),
+                         GenerateRandomTensor<DT_FLOAT>(TensorShape({4, 3})));
+  Output b1 = ops::Const(s.WithOpName("b1"), {0.5f, -0.25f, 0.0f}, {3});
+  Output w2 = ops::Const(s.WithOpName("w2"),
+                         GenerateRandomTensor<DT_FLOAT>(TensorShape({3, 2})));
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w1);
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, b1);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+  Output y = ops::MatMul(s.WithOpName("y"), relu, w2);
+
+  GrapplerItem item;
+  item.fetch = {"y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  const TensorShape input_shape({2, 4});
+  PostTrainingQuantizer optimizer(Calibrate(
+      item, input_shape, {"x", "matmul", "bias_add", "relu", "y"}));
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The result of relu stays quantized, so only x is quantized and only y
+  // is dequantized.
+  EXPECT_EQ(1, CountOps(output, "QuantizeV2"));
+  EXPECT_EQ(2, CountOps(output, "QuantizedMatMul"));
+  EXPECT_EQ(1, CountOps(output, "QuantizedBiasAdd"));
+  EXPECT_EQ(1, CountOps(output, "QuantizedRelu"));
+  EXPECT_EQ(1, CountOps(output, "Dequantize"));
+  EXPECT_EQ(0, CountOps(output, "MatMul"));
+  EXPECT_EQ(nullptr, FindNode(output, "relu"));
+  EXPECT_EQ(nullptr, FindNode(output, "w1"));
+
+  const NodeDef* y_node = FindNode(output, "y");
+  ASSERT_NE(nullptr, y_node);
+  EXPECT_EQ("Dequantize", y_node->op());
+  EXPECT_EQ("PostTrainingQuantizer/y/requantize", y_node->input(0));
+  const NodeDef* y_matmul = FindNode(output, "PostTrainingQuantizer/y/matmul");
+  ASSERT_NE(nullptr, y_matmul);
+  EXPECT_EQ("PostTrainingQuantizer/matmul/requantize", y_matmul->input(0));
+
+  ExpectSameResults(item, output, input_shape);
+}
+
+TEST_F(PostTrainingQuantizerTest, DequantizeForFloatConsumers) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 6, 6, 2}));
+  Output filter =
+      ops::Const(s.WithOpName("filter"),
+                 GenerateRandomTensor<DT_FLOAT>(TensorShape({3, 3, 2, 4})));
+  Output conv =
+      ops::Conv2D(s.WithOpName("conv"), x, filter, {1, 1, 1, 1}, "SAME");
+  Output relu = ops::Relu(s.WithOpName("relu"), conv);
+  Output y = ops::Square(s.WithOpName("y"), relu);
+
+  GrapplerItem item;
+  item.fetch = {"y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  // Without the range of conv, the chain ends at relu.
+  const TensorShape input_shape({1, 6, 6, 2});
+  PostTrainingQuantizer optimizer(
+      Calibrate(item, input_shape, {"x", "relu"}));
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(1, CountOps(output, "QuantizedConv2D"));
+  EXPECT_EQ(0, CountOps(output, "Conv2D"));
+  EXPECT_EQ(nullptr, FindNode(output, "conv"));
+  const NodeDef* relu_node = FindNode(output, "relu");
+  ASSERT_NE(nullptr, relu_node);
+  EXPECT_EQ("Dequantize", relu_node->op());
+  const NodeDef* y_node = FindNode(output, "y");
+  ASSERT_NE(nullptr, y_node);
+  EXPECT_EQ("Square", y_node->op());
+
+  ExpectSameResults(item, output, input_shape);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
@@ -58,12 +61,23 @@ namespace {
 constexpr char kFusedConv2D[] = "_FusedConv2D";
 constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
+constexpr char kFusedLayerNorm[] = "_FusedLayerNorm";
+constexpr char kFusedScaledDotProductAttention[] =
+    "_FusedScaledDotProductAttention";
+constexpr char kFusedEmbeddingSparseLookup[] = "_FusedEmbeddingSparseLookup";
+constexpr char kFusedResourceEmbeddingSparseLookup[] =
+    "_FusedResourceEmbeddingSparseLookup";
+constexpr char kResourceMultiApplyAdam[] = "_ResourceMultiApplyAdam";
+constexpr char kResourceMultiApplyMomentum[] = "_ResourceMultiApplyMomentum";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
 
 constexpr int kMissingIndex = -1;
 
+// Maximum number of variables updated by one _ResourceMultiApply{...} node.
+constexpr int kMaxMultiApplyVariables = 64;
+
 struct RemapperContext {
   explicit RemapperContext(GrapplerItem* item, Status* status, bool xla_on)
       : nodes_to_preserve(item->NodesToPreserve()),
@@ -198,6 +212,59 @@ struct ContractionWithBiasAndAddActivation {
 };
 #endif  // INTEL_MKL
 
+// Layer normalization over the innermost dimension, in the form produced by
+// `nn.moments` + `nn.batch_normalization` (e.g. Keras LayerNormalization):
+//   mean     = Mean(x, axis=-1, keep_dims=true)
+//   variance = Mean(SquaredDifference(x, StopGradient(mean)), axis=-1, ...)
+//   inv      = Mul(Rsqrt(AddV2(variance, epsilon)), scale)
+//   y        = AddV2(Mul(x, inv), Sub(offset, Mul(mean, inv)))
+struct LayerNorm {
+  LayerNorm() = default;
+
+  int add = kMissingIndex;  // root of the pattern
+  int x_mul = kMissingIndex;
+  int offset_sub = kMissingIndex;
+  int mean_mul = kMissingIndex;
+  int scale_mul = kMissingIndex;
+  int rsqrt = kMissingIndex;
+  int variance_add = kMissingIndex;
+  int variance_mean = kMissingIndex;
+  int squared_difference = kMissingIndex;
+  int stop_gradient = kMissingIndex;  // optional
+  int mean = kMissingIndex;
+  // Ports of `x` in x_mul and of `scale` in scale_mul.
+  int x_port = 0;
+  int scale_port = 0;
+  float epsilon = 0.0f;
+};
+
+// Scaled dot-product attention:
+//   BatchMatMul(Softmax(Mul(BatchMatMul(q, k, adj_y=true), scale)), v)
+// where the scaling is optional and can also be a division by a constant.
+struct ScaledDotProductAttention {
+  ScaledDotProductAttention() = default;
+
+  int query_key_matmul = kMissingIndex;
+  int scaling = kMissingIndex;  // optional
+  int softmax = kMissingIndex;
+  int output_matmul = kMissingIndex;  // root of the pattern
+  float scale = 1.0f;
+};
+
+// Embedding lookup with a combiner, as in `embedding_lookup_sparse`:
+//   SparseSegment{Sum,Mean,SqrtN}(Identity(Gather(params, ids)), indices,
+//                                 segment_ids)
+// where the Identity is optional, and the gather is a Gather, a GatherV2
+// along axis 0 or a ResourceGather.
+struct EmbeddingSparseLookup {
+  EmbeddingSparseLookup() = default;
+
+  int segment_reduction = kMissingIndex;  // root of the pattern
+  int identity = kMissingIndex;           // optional
+  int gather = kMissingIndex;
+  string combiner;
+};
+
 bool IsInPreserveSet(const RemapperContext& ctx, const NodeDef* node) {
   return ctx.nodes_to_preserve.count(node->name()) > 0;
 }
@@ -842,6 +909,419 @@ bool FindFusedBatchNormEx(const RemapperContext& ctx, int node_index,
   return false;
 }
 
+// Returns true if the regular input `port` of the node is a constant with a
+// single float element, and stores its value in `value`.
+bool GetScalarConstInput(const RemapperContext& ctx, const NodeDef& node,
+                         int port, float* value) {
+  const auto& props = ctx.graph_properties.GetInputProperties(node.name());
+  if (static_cast<int>(props.size()) <= port || !props[port].has_value())
+    return false;
+  Tensor tensor;
+  if (!tensor.FromProto(props[port].value())) return false;
+  if (tensor.dtype() != DT_FLOAT || tensor.NumElements() != 1) return false;
+  *value = tensor.flat<float>()(0);
+  return true;
+}
+
+// Returns true if `mean` reduces its input of rank `rank` over the innermost
+// dimension only, and keeps the reduced dimension.
+bool IsInnermostDimMean(const RemapperContext& ctx, const NodeDef& mean,
+                        int rank) {
+  bool keep_dims = false;
+  if (!TryGetNodeAttr(mean, "keep_dims", &keep_dims) || !keep_dims)
+    return false;
+
+  const auto& props = ctx.graph_properties.GetInputProperties(mean.name());
+  if (props.size() != 2 || !props[1].has_value()) return false;
+  Tensor axes;
+  if (!axes.FromProto(props[1].value()) || axes.NumElements() != 1)
+    return false;
+
+  int64 axis;
+  if (axes.dtype() == DT_INT32) {
+    axis = axes.flat<int32>()(0);
+  } else if (axes.dtype() == DT_INT64) {
+    axis = axes.flat<int64>()(0);
+  } else {
+    return false;
+  }
+  return axis == -1 || axis == rank - 1;
+}
+
+// Returns true if every regular fanout of the pattern nodes, except for the
+// root, is itself one of the pattern nodes, so that the whole pattern can be
+// replaced with a single fused node.
+bool IsSelfContainedPattern(const RemapperContext& ctx,
+                            const std::vector<int>& nodes, int root) {
+  const absl::flat_hash_set<int> pattern(nodes.begin(), nodes.end());
+  for (int node_index : nodes) {
+    if (node_index == root) continue;
+    const auto* node_view = ctx.graph_view.GetNode(node_index);
+    if (HasControlFaninOrFanout(*node_view) ||
+        IsInPreserveSet(ctx, node_view->node()))
+      return false;
+    for (const auto& fanouts : node_view->GetRegularFanouts()) {
+      for (const auto& fanout : fanouts) {
+        if (!pattern.contains(fanout.node_index())) return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool FindLayerNorm(const RemapperContext& ctx, int node_index,
+                   LayerNorm* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  // TODO(lyandy): Forward controls for patterns with control dependencies.
+  if (!IsAdd(*node_def) || HasControlFaninOrFanout(*node_view)) return false;
+  if (!HasDataType(node_def, DT_FLOAT) || !NodeIsOnCpu(node_def)) return false;
+  // XLA does not know about _FusedLayerNorm, and fuses this pattern itself.
+  if (ctx.xla_on_) return false;
+  if (node_view->NumRegularFanins() != 2) return false;
+
+  // Returns the regular fanin of `view` at `port` if it is a binary op.
+  const auto binary_fanin =
+      [](const utils::MutableNodeView& view,
+         int port) -> const utils::MutableNodeView* {
+    if (view.NumRegularFanins() <= port) return nullptr;
+    const auto* fanin = view.GetRegularFanin(port).node_view();
+    return fanin->NumRegularFanins() == 2 ? fanin : nullptr;
+  };
+
+  LayerNorm pattern;
+  pattern.add = node_index;
+
+  // y = Mul(x, inv) + Sub(offset, Mul(mean, inv)), with Add in any order.
+  const utils::MutableNodeView* x_mul = nullptr;
+  const utils::MutableNodeView* offset_sub = nullptr;
+  for (int port = 0; port < 2; ++port) {
+    const auto* lhs = binary_fanin(*node_view, port);
+    const auto* rhs = binary_fanin(*node_view, 1 - port);
+    if (lhs && rhs && IsMul(*lhs->node()) && IsSub(*rhs->node())) {
+      x_mul = lhs;
+      offset_sub = rhs;
+    }
+  }
+  if (x_mul == nullptr) return false;
+  pattern.x_mul = x_mul->node_index();
+  pattern.offset_sub = offset_sub->node_index();
+
+  const auto* mean_mul = binary_fanin(*offset_sub, 1);
+  if (mean_mul == nullptr || !IsMul(*mean_mul->node())) return false;
+  pattern.mean_mul = mean_mul->node_index();
+
+  // inv = Mul(Rsqrt(...), scale) must be shared by both Mul nodes.
+  const utils::MutableNodeView* scale_mul = nullptr;
+  const utils::MutableNodeView* mean = nullptr;
+  for (int port = 0; port < 2; ++port) {
+    const auto* inv = binary_fanin(*mean_mul, port);
+    const auto* other = mean_mul->GetRegularFanin(1 - port).node_view();
+    if (inv && IsMul(*inv->node()) && IsMean(*other->node())) {
+      scale_mul = inv;
+      mean = other;
+    }
+  }
+  if (scale_mul == nullptr) return false;
+  pattern.scale_mul = scale_mul->node_index();
+  pattern.mean = mean->node_index();
+
+  bool found_x = false;
+  for (int port = 0; port < 2; ++port) {
+    if (x_mul->GetRegularFanin(1 - port).node_index() == pattern.scale_mul) {
+      pattern.x_port = port;
+      found_x = true;
+    }
+  }
+  if (!found_x) return false;
+  const auto& x = x_mul->GetRegularFanin(pattern.x_port);
+
+  // Returns true if the fanin is the same tensor as `x`.
+  const auto is_x = [&x](const utils::MutableFanoutView& fanin) -> bool {
+    return fanin.node_index() == x.node_index() && fanin.index() == x.index();
+  };
+
+  // mean = Mean(x).
+  if (mean->NumRegularFanins() != 2 || !is_x(mean->GetRegularFanin(0)))
+    return false;
+
+  // inv = Mul(Rsqrt(variance + epsilon), scale).
+  const utils::MutableNodeView* rsqrt = nullptr;
+  for (int port = 0; port < 2; ++port) {
+    const auto* fanin = scale_mul->GetRegularFanin(port).node_view();
+    if (IsRsqrt(*fanin->node())) {
+      rsqrt = fanin;
+      pattern.scale_port = 1 - port;
+    }
+  }
+  if (rsqrt == nullptr) return false;
+  pattern.rsqrt = rsqrt->node_index();
+
+  const auto* variance_add = binary_fanin(*rsqrt, 0);
+  if (variance_add == nullptr || !IsAdd(*variance_add->node())) return false;
+  pattern.variance_add = variance_add->node_index();
+
+  const utils::MutableNodeView* variance_mean = nullptr;
+  for (int port = 0; port < 2; ++port) {
+    const auto* fanin = variance_add->GetRegularFanin(port).node_view();
+    if (IsMean(*fanin->node()) &&
+        GetScalarConstInput(ctx, *variance_add->node(), 1 - port,
+                            &pattern.epsilon)) {
+      variance_mean = fanin;
+    }
+  }
+  if (variance_mean == nullptr) return false;
+  pattern.variance_mean = variance_mean->node_index();
+
+  // variance = Mean(SquaredDifference(x, StopGradient(mean))).
+  const auto* squared_difference = binary_fanin(*variance_mean, 0);
+  if (squared_difference == nullptr ||
+      !IsSquaredDifference(*squared_difference->node()))
+    return false;
+  pattern.squared_difference = squared_difference->node_index();
+
+  bool found_mean = false;
+  for (int port = 0; port < 2; ++port) {
+    if (!is_x(squared_difference->GetRegularFanin(port))) continue;
+    const auto& fanin = squared_difference->GetRegularFanin(1 - port);
+    const auto* fanin_view = fanin.node_view();
+    if (fanin.node_index() == pattern.mean) {
+      found_mean = true;
+    } else if (IsStopGradient(*fanin_view->node()) &&
+               fanin_view->NumRegularFanins() == 1 &&
+               fanin_view->GetRegularFanin(0).node_index() == pattern.mean) {
+      pattern.stop_gradient = fanin.node_index();
+      found_mean = true;
+    }
+  }
+  if (!found_mean) return false;
+
+  // Both reductions must be over the innermost dimension of `x`, and `scale`
+  // and `offset` must be vectors of the size of that dimension.
+  const auto& mean_props =
+      ctx.graph_properties.GetInputProperties(mean->node()->name());
+  if (mean_props.empty()) return false;
+  const TensorShapeProto& x_shape = mean_props[0].shape();
+  const int rank = Rank(x_shape);
+  if (rank < 1) return false;
+  if (!IsInnermostDimMean(ctx, *mean->node(), rank) ||
+      !IsInnermostDimMean(ctx, *variance_mean->node(), rank))
+    return false;
+
+  TensorShapeProto depth_shape;
+  *depth_shape.add_dim() = x_shape.dim(rank - 1);
+  const auto& scale_props =
+      ctx.graph_properties.GetInputProperties(scale_mul->node()->name());
+  const auto& offset_props =
+      ctx.graph_properties.GetInputProperties(offset_sub->node()->name());
+  if (scale_props.size() != 2 || offset_props.size() != 2 ||
+      !ShapesSymbolicallyEqual(scale_props[pattern.scale_port].shape(),
+                               depth_shape) ||
+      !ShapesSymbolicallyEqual(offset_props[0].shape(), depth_shape))
+    return false;
+
+  std::vector<int> nodes = {pattern.add,
+                            pattern.x_mul,
+                            pattern.offset_sub,
+                            pattern.mean_mul,
+                            pattern.scale_mul,
+                            pattern.rsqrt,
+                            pattern.variance_add,
+                            pattern.variance_mean,
+                            pattern.squared_difference,
+                            pattern.mean};
+  if (pattern.stop_gradient != kMissingIndex)
+    nodes.push_back(pattern.stop_gradient);
+  if (!IsSelfContainedPattern(ctx, nodes, node_index)) return false;
+
+  // We successfully found a layer normalization pattern.
+  *matched = pattern;
+
+  return true;
+}
+
+bool FindScaledDotProductAttention(const RemapperContext& ctx, int node_index,
+                                   ScaledDotProductAttention* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  // TODO(lyandy): Forward controls for patterns with control dependencies.
+  if (!IsBatchMatMul(*node_def) || HasControlFaninOrFanout(*node_view))
+    return false;
+  if (!HasDataType(node_def, DT_FLOAT) || !NodeIsOnCpu(node_def)) return false;
+  // XLA does not know about _FusedScaledDotProductAttention.
+  if (ctx.xla_on_) return false;
+  if (node_view->NumRegularFanins() != 2) return false;
+
+  // Returns true if the BatchMatMul node has the given adjoint attributes.
+  const auto has_adjoints = [](const NodeDef& matmul, bool adj_x,
+                               bool adj_y) -> bool {
+    bool node_adj_x = false;
+    bool node_adj_y = false;
+    return TryGetNodeAttr(matmul, "adj_x", &node_adj_x) &&
+           TryGetNodeAttr(matmul, "adj_y", &node_adj_y) &&
+           node_adj_x == adj_x && node_adj_y == adj_y;
+  };
+  if (!has_adjoints(*node_def, false, false)) return false;
+
+  ScaledDotProductAttention pattern;
+  pattern.output_matmul = node_index;
+
+  const auto* softmax = node_view->GetRegularFanin(0).node_view();
+  if (!IsSoftmax(*softmax->node()) || softmax->NumRegularFanins() != 1)
+    return false;
+  pattern.softmax = softmax->node_index();
+
+  // Scores might be scaled by a constant before the Softmax.
+  const auto* scores = softmax->GetRegularFanin(0).node_view();
+  const auto* scores_def = scores->node();
+  if ((IsMul(*scores_def) || IsRealDiv(*scores_def)) &&
+      scores->NumRegularFanins() == 2) {
+    pattern.scaling = scores->node_index();
+    const utils::MutableNodeView* scaled = nullptr;
+    float constant;
+    for (int port = 0; port < 2; ++port) {
+      // Only the divisor of a RealDiv can be the constant.
+      if (IsRealDiv(*scores_def) && port == 0) continue;
+      if (GetScalarConstInput(ctx, *scores_def, port, &constant)) {
+        scaled = scores->GetRegularFanin(1 - port).node_view();
+      }
+    }
+    if (scaled == nullptr) return false;
+    if (IsRealDiv(*scores_def)) {
+      if (constant == 0.0f) return false;
+      pattern.scale = 1.0f / constant;
+    } else {
+      pattern.scale = constant;
+    }
+    scores = scaled;
+    scores_def = scores->node();
+  }
+
+  if (!IsBatchMatMul(*scores_def) || scores->NumRegularFanins() != 2 ||
+      !has_adjoints(*scores_def, false, true))
+    return false;
+  pattern.query_key_matmul = scores->node_index();
+
+  // The fused kernel does not broadcast batch dimensions, so query, key and
+  // value must all have the same ones.
+  const auto& scores_props =
+      ctx.graph_properties.GetInputProperties(scores_def->name());
+  const auto& output_props =
+      ctx.graph_properties.GetInputProperties(node_def->name());
+  if (scores_props.size() != 2 || output_props.size() != 2) return false;
+  const TensorShapeProto* shapes[] = {&scores_props[0].shape(),
+                                      &scores_props[1].shape(),
+                                      &output_props[1].shape()};
+  const int rank = Rank(*shapes[0]);
+  if (rank < 2) return false;
+  TensorShapeProto batch_dims[3];
+  for (int i = 0; i < 3; ++i) {
+    if (Rank(*shapes[i]) != rank) return false;
+    for (int d = 0; d < rank - 2; ++d) {
+      *batch_dims[i].add_dim() = shapes[i]->dim(d);
+    }
+  }
+  if (!ShapesSymbolicallyEqual(batch_dims[0], batch_dims[1]) ||
+      !ShapesSymbolicallyEqual(batch_dims[0], batch_dims[2]))
+    return false;
+
+  std::vector<int> nodes = {pattern.output_matmul, pattern.softmax,
+                            pattern.query_key_matmul};
+  if (pattern.scaling != kMissingIndex) nodes.push_back(pattern.scaling);
+  if (!IsSelfContainedPattern(ctx, nodes, node_index)) return false;
+
+  // We successfully found a scaled dot-product attention pattern.
+  *matched = pattern;
+
+  return true;
+}
+
+// Returns the combiner of a SparseSegment{Sum,Mean,SqrtN} node, or an empty
+// string for any other node.
+string GetSparseSegmentCombiner(const NodeDef& node) {
+  if (node.op() == "SparseSegmentSum") return "sum";
+  if (node.op() == "SparseSegmentMean") return "mean";
+  if (node.op() == "SparseSegmentSqrtN") return "sqrtn";
+  return "";
+}
+
+bool FindEmbeddingSparseLookup(const RemapperContext& ctx, int node_index,
+                               EmbeddingSparseLookup* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  // TODO(lyandy): Forward controls for patterns with control dependencies.
+  if (HasControlFaninOrFanout(*node_view)) return false;
+  const string combiner = GetSparseSegmentCombiner(*node_def);
+  if (combiner.empty() || node_view->NumRegularFanins() != 3) return false;
+  if (!HasDataType(node_def, DT_FLOAT) || !NodeIsOnCpu(node_def)) return false;
+  // XLA does not know about _Fused{Resource}EmbeddingSparseLookup.
+  if (ctx.xla_on_) return false;
+
+  EmbeddingSparseLookup pattern;
+  pattern.segment_reduction = node_index;
+  pattern.combiner = combiner;
+
+  const auto* gather = node_view->GetRegularFanin(0).node_view();
+  if (IsIdentity(*gather->node()) && gather->NumRegularFanins() == 1) {
+    pattern.identity = gather->node_index();
+    gather = gather->GetRegularFanin(0).node_view();
+  }
+  const auto* gather_def = gather->node();
+  if (!NodeIsOnCpu(gather_def)) return false;
+
+  // Only gathers of whole rows of float params can be fused.
+  int batch_dims = 0;
+  if (IsGather(*gather_def)) {
+    if (!HasDataType(gather_def, DT_FLOAT, "Tparams")) return false;
+    if (gather_def->op() == "GatherV2") {
+      if (gather->NumRegularFanins() != 3) return false;
+      if (TryGetNodeAttr(*gather_def, "batch_dims", &batch_dims) &&
+          batch_dims != 0)
+        return false;
+      const auto& props =
+          ctx.graph_properties.GetInputProperties(gather_def->name());
+      if (props.size() != 3 || !props[2].has_value()) return false;
+      Tensor axis;
+      if (!axis.FromProto(props[2].value()) || axis.NumElements() != 1)
+        return false;
+      if (axis.dtype() == DT_INT32) {
+        if (axis.flat<int32>()(0) != 0) return false;
+      } else if (axis.dtype() == DT_INT64) {
+        if (axis.flat<int64>()(0) != 0) return false;
+      } else {
+        return false;
+      }
+    } else if (gather->NumRegularFanins() != 2) {
+      return false;
+    }
+  } else if (IsResourceGather(*gather_def)) {
+    if (!HasDataType(gather_def, DT_FLOAT, "dtype")) return false;
+    if (TryGetNodeAttr(*gather_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0)
+      return false;
+    if (gather->NumRegularFanins() != 2) return false;
+  } else {
+    return false;
+  }
+  pattern.gather = gather->node_index();
+
+  // The fused kernels take the ids as a vector, like the output of the
+  // Unique op in `embedding_lookup_sparse`.
+  const auto& gather_props =
+      ctx.graph_properties.GetInputProperties(gather_def->name());
+  if (gather_props.size() < 2 || Rank(gather_props[1].shape()) != 1)
+    return false;
+
+  std::vector<int> nodes = {pattern.segment_reduction, pattern.gather};
+  if (pattern.identity != kMissingIndex) nodes.push_back(pattern.identity);
+  if (!IsSelfContainedPattern(ctx, nodes, node_index)) return false;
+
+  // We successfully found an embedding lookup pattern.
+  *matched = pattern;
+
+  return true;
+}
+
 void CopyConv2DAttributes(const NodeDef& conv2d, NodeDef* fused_conv2d) {
   DCHECK(IsConv2D(conv2d)) << "Input node must be a Conv2D";
 
@@ -1267,6 +1747,308 @@ Status AddFusedBatchNormExNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddFusedLayerNormNode(RemapperContext* ctx, const LayerNorm& matched,
+                             std::vector<bool>* invalidated_nodes,
+                             std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& add = graph->node(matched.add);
+  const NodeDef& x_mul = graph->node(matched.x_mul);
+  const NodeDef& scale_mul = graph->node(matched.scale_mul);
+  const NodeDef& offset_sub = graph->node(matched.offset_sub);
+  VLOG(2) << "Fuse layer normalization: output=" << add.name()
+          << " x=" << x_mul.input(matched.x_port)
+          << " scale=" << scale_mul.input(matched.scale_port)
+          << " offset=" << offset_sub.input(0)
+          << " epsilon=" << matched.epsilon;
+
+  NodeDef fused_op;
+  fused_op.set_name(add.name());
+  fused_op.set_op(kFusedLayerNorm);
+  fused_op.set_device(add.device());
+  fused_op.add_input(x_mul.input(matched.x_port));          // 0: x
+  fused_op.add_input(scale_mul.input(matched.scale_port));  // 1: scale
+  fused_op.add_input(offset_sub.input(0));                  // 2: offset
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)["T"] = add.attr().at("T");
+  SetAttrValue(matched.epsilon, &(*attrs)["epsilon"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.add] = true;
+  for (int node : {matched.x_mul, matched.offset_sub, matched.mean_mul,
+                   matched.scale_mul, matched.rsqrt, matched.variance_add,
+                   matched.variance_mean, matched.squared_difference,
+                   matched.stop_gradient, matched.mean}) {
+    if (node != kMissingIndex) (*nodes_to_delete)[node] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddFusedScaledDotProductAttentionNode(
+    RemapperContext* ctx, const ScaledDotProductAttention& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output_matmul = graph->node(matched.output_matmul);
+  const NodeDef& query_key_matmul = graph->node(matched.query_key_matmul);
+  VLOG(2) << "Fuse scaled dot-product attention: output="
+          << output_matmul.name() << " query=" << query_key_matmul.input(0)
+          << " key=" << query_key_matmul.input(1)
+          << " value=" << output_matmul.input(1) << " scale=" << matched.scale;
+
+  NodeDef fused_op;
+  fused_op.set_name(output_matmul.name());
+  fused_op.set_op(kFusedScaledDotProductAttention);
+  fused_op.set_device(output_matmul.device());
+  fused_op.add_input(query_key_matmul.input(0));  // 0: query
+  fused_op.add_input(query_key_matmul.input(1));  // 1: key
+  fused_op.add_input(output_matmul.input(1));     // 2: value
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)["T"] = output_matmul.attr().at("T");
+  SetAttrValue(matched.scale, &(*attrs)["scale"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output_matmul] = true;
+  (*nodes_to_delete)[matched.softmax] = true;
+  (*nodes_to_delete)[matched.query_key_matmul] = true;
+  if (matched.scaling != kMissingIndex) {
+    (*nodes_to_delete)[matched.scaling] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddFusedEmbeddingSparseLookupNode(
+    RemapperContext* ctx, const EmbeddingSparseLookup& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& segment_reduction = graph->node(matched.segment_reduction);
+  const NodeDef& gather = graph->node(matched.gather);
+  VLOG(2) << "Fuse embedding lookup: output=" << segment_reduction.name()
+          << " params=" << gather.input(0) << " ids=" << gather.input(1)
+          << " combiner=" << matched.combiner;
+
+  const bool is_resource = IsResourceGather(gather);
+  NodeDef fused_op;
+  fused_op.set_name(segment_reduction.name());
+  fused_op.set_op(is_resource ? kFusedResourceEmbeddingSparseLookup
+                              : kFusedEmbeddingSparseLookup);
+  fused_op.set_device(segment_reduction.device());
+  fused_op.add_input(gather.input(0));             // 0: params or resource
+  fused_op.add_input(gather.input(1));             // 1: ids
+  fused_op.add_input(segment_reduction.input(1));  // 2: indices
+  fused_op.add_input(segment_reduction.input(2));  // 3: segment_ids
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)[is_resource ? "dtype" : "T"] = segment_reduction.attr().at("T");
+  (*attrs)["Tids"] = gather.attr().at("Tindices");
+  if (HasNodeAttr(segment_reduction, "Tidx")) {
+    (*attrs)["Tidx"] = segment_reduction.attr().at("Tidx");
+  } else {
+    SetAttrValue(DT_INT32, &(*attrs)["Tidx"]);
+  }
+  SetAttrValue(matched.combiner, &(*attrs)["combiner"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.segment_reduction] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+  if (matched.identity != kMissingIndex) {
+    (*nodes_to_delete)[matched.identity] = true;
+  }
+
+  return Status::OK();
+}
+
+// Returns the key of the group of ResourceApply{Adam,Momentum} nodes that can
+// be merged with `node_view` into a _ResourceMultiApply{Adam,Momentum} node, or
+// an empty string if it can't be merged. The nodes of a group have the same
+// op, device, attributes and hyperparameter inputs.
+string MultiApplyGroupKey(const RemapperContext& ctx,
+                          const utils::MutableNodeView& node_view) {
+  const NodeDef* node_def = node_view.node();
+  const bool is_adam = IsResourceApplyAdam(*node_def);
+  if (!is_adam && !IsResourceApplyMomentum(*node_def)) return "";
+  // XLA does not know about the _ResourceMultiApply{...} ops.
+  if (ctx.xla_on_ || !NodeIsOnGpu(node_def)) return "";
+  if (ctx.nodes_to_preserve.count(node_def->name()) > 0) return "";
+  if (!HasDataType(node_def, DT_HALF) && !HasDataType(node_def, DT_FLOAT) &&
+      !HasDataType(node_def, DT_DOUBLE)) {
+    return "";
+  }
+  const int num_inputs = is_adam ? 10 : 5;
+  if (node_view.NumRegularFanins() != num_inputs) return "";
+
+  bool use_locking = false;
+  bool use_nesterov = false;
+  TryGetNodeAttr(*node_def, "use_locking", &use_locking);
+  TryGetNodeAttr(*node_def, "use_nesterov", &use_nesterov);
+  string key = absl::StrCat(node_def->op(), "|", node_def->device(), "|",
+                            node_def->attr().at("T").type(), "|", use_locking,
+                            "|", use_nesterov);
+  const std::vector<int> hyperparameters =
+      is_adam ? std::vector<int>{3, 4, 5, 6, 7, 8} : std::vector<int>{2, 4};
+  for (int i : hyperparameters) {
+    absl::StrAppend(&key, "|", node_def->input(i));
+  }
+  return key;
+}
+
+// Returns true if a node of `group` depends on another node of the group, in
+// which case they can't be merged.
+bool HasDependencyInGroup(const RemapperContext& ctx,
+                          const std::vector<int>& group) {
+  const int num_nodes = ctx.graph_view.NumNodes();
+  std::vector<bool> in_group(num_nodes);
+  for (int i : group) in_group[i] = true;
+
+  std::vector<bool> visited(num_nodes);
+  std::vector<int> queue;
+  const auto visit_fanouts = [&](int node_index) {
+    const auto* node_view = ctx.graph_view.GetNode(node_index);
+    for (const auto& port_fanouts : node_view->GetRegularFanouts()) {
+      for (const auto& fanout : port_fanouts) {
+        if (!visited[fanout.node_index()]) {
+          visited[fanout.node_index()] = true;
+          queue.push_back(fanout.node_index());
+        }
+      }
+    }
+    for (const auto& fanout : node_view->GetControlledFanouts()) {
+      if (!visited[fanout.node_index()]) {
+        visited[fanout.node_index()] = true;
+        queue.push_back(fanout.node_index());
+      }
+    }
+  };
+  for (int i : group) visit_fanouts(i);
+  while (!queue.empty()) {
+    const int node_index = queue.back();
+    queue.pop_back();
+    if (in_group[node_index]) return true;
+    visit_fanouts(node_index);
+  }
+  return false;
+}
+
+// Merges the ResourceApply{Adam,Momentum} nodes placed on the same GPU with
+// the same hyperparameters into _ResourceMultiApply{Adam,Momentum} nodes,
+// which update up to kMaxMultiApplyVariables variables in a single kernel
+// launch. The control dependencies on the merged nodes are moved to the new
+// node.
+Status AddMultiApplyNodes(RemapperContext* ctx) {
+  std::vector<std::vector<int>> groups;
+  absl::flat_hash_map<string, int> group_indices;
+  for (int i = 0; i < ctx->graph_view.NumNodes(); ++i) {
+    const string key = MultiApplyGroupKey(*ctx, *ctx->graph_view.GetNode(i));
+    if (key.empty()) continue;
+    auto inserted = group_indices.emplace(key, groups.size());
+    if (inserted.second) groups.emplace_back();
+    groups[inserted.first->second].push_back(i);
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  for (const std::vector<int>& group : groups) {
+    if (group.size() < 2 || HasDependencyInGroup(*ctx, group)) continue;
+
+    for (size_t begin = 0; begin < group.size();
+         begin += kMaxMultiApplyVariables) {
+      const size_t end =
+          std::min(group.size(), begin + kMaxMultiApplyVariables);
+      if (end - begin < 2) continue;
+
+      const NodeDef* first = ctx->graph_view.GetNode(group[begin])->node();
+      const bool is_adam = IsResourceApplyAdam(*first);
+      const int num_variable_inputs = is_adam ? 3 : 2;
+      const int num_vars = end - begin;
+      VLOG(2) << "Merge " << num_vars << " " << first->op()
+              << " nodes: first=" << first->name();
+
+      NodeDef multi_apply;
+      multi_apply.set_name(AddPrefixToNodeName(first->name(), "MultiApply"));
+      multi_apply.set_op(is_adam ? kResourceMultiApplyAdam
+                                 : kResourceMultiApplyMomentum);
+      multi_apply.set_device(first->device());
+      // Variables and their slots, one list per input.
+      for (int input = 0; input < num_variable_inputs; ++input) {
+        for (size_t i = begin; i < end; ++i) {
+          multi_apply.add_input(
+              ctx->graph_view.GetNode(group[i])->node()->input(input));
+        }
+      }
+      const auto add_gradients = [&](int grad_input) {
+        for (size_t i = begin; i < end; ++i) {
+          multi_apply.add_input(
+              ctx->graph_view.GetNode(group[i])->node()->input(grad_input));
+        }
+      };
+      if (is_adam) {
+        // beta1_power, beta2_power, lr, beta1, beta2, epsilon, grad.
+        for (int input = 3; input < 9; ++input) {
+          multi_apply.add_input(first->input(input));
+        }
+        add_gradients(9);
+      } else {
+        // lr, grad, momentum.
+        multi_apply.add_input(first->input(2));
+        add_gradients(3);
+        multi_apply.add_input(first->input(4));
+      }
+      absl::flat_hash_set<string> control_inputs;
+      for (size_t i = begin; i < end; ++i) {
+        for (const auto& fanin :
+             ctx->graph_view.GetNode(group[i])->GetControllingFanins()) {
+          const string& fanin_name = fanin.node_view()->GetName();
+          if (control_inputs.insert(fanin_name).second) {
+            multi_apply.add_input(AsControlDependency(fanin_name));
+          }
+        }
+      }
+
+      auto* attrs = multi_apply.mutable_attr();
+      SetAttrValue(num_vars, &(*attrs)["N"]);
+      (*attrs)["T"] = first->attr().at("T");
+      if (HasNodeAttr(*first, "use_locking")) {
+        (*attrs)["use_locking"] = first->attr().at("use_locking");
+      }
+      if (HasNodeAttr(*first, "use_nesterov")) {
+        (*attrs)["use_nesterov"] = first->attr().at("use_nesterov");
+      }
+
+      const string multi_apply_name = multi_apply.name();
+      Status status;
+      mutation->AddNode(std::move(multi_apply), &status);
+      TF_RETURN_IF_ERROR(status);
+
+      for (size_t i = begin; i < end; ++i) {
+        auto* node_view = ctx->graph_view.GetNode(group[i]);
+        for (const auto& fanout : node_view->GetControlledFanouts()) {
+          mutation->RemoveControllingFanin(fanout.node_view(),
+                                           node_view->GetName());
+          mutation->AddControllingFanin(fanout.node_view(), multi_apply_name);
+        }
+        mutation->RemoveNode(node_view);
+      }
+    }
+  }
+  return mutation->Apply();
+}
+
 Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
   const GraphDef* graph = ctx->graph_view.graph();
   const NodeDef& fused_node = graph->node(matched.fused_batch_norm);
@@ -1466,6 +2248,8 @@ Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
 // shapes:
 //   (1) Splitting FusedBatchNorm into primitives.
 //   (2) Fusing side input and/or activation into FusedBatchNorm.
+//   (3) Fusing layer normalization and attention subgraphs.
+//   (4) Fusing embedding lookups with their combiner.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -1511,7 +2295,36 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
-  return is_batch_norm_candidate() || is_batch_norm_fusion_candidate();
+  // Candidate for a layer normalization fusion.
+  const auto is_layer_norm_candidate = [&]() -> bool {
+    if (!IsAdd(*node_def) || node_view->NumRegularFanins() != 2) return false;
+    if (GetDataTypeFromAttr(*node_def, "T") != DT_FLOAT) return false;
+    return IsSub(*node_view->GetRegularFanin(0).node_view()->node()) ||
+           IsSub(*node_view->GetRegularFanin(1).node_view()->node());
+  };
+
+  // Candidate for a scaled dot-product attention fusion.
+  const auto is_attention_candidate = [&]() -> bool {
+    if (!IsBatchMatMul(*node_def) || node_view->NumRegularFanins() < 1)
+      return false;
+    return IsSoftmax(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
+  // Candidate for an embedding lookup fusion.
+  const auto is_embedding_lookup_candidate = [&]() -> bool {
+    if (GetSparseSegmentCombiner(*node_def).empty() ||
+        node_view->NumRegularFanins() < 1)
+      return false;
+    const auto* data = node_view->GetRegularFanin(0).node_view();
+    if (IsIdentity(*data->node()) && data->NumRegularFanins() == 1) {
+      data = data->GetRegularFanin(0).node_view();
+    }
+    return IsGather(*data->node()) || IsResourceGather(*data->node());
+  };
+
+  return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
+         is_layer_norm_candidate() || is_attention_candidate() ||
+         is_embedding_lookup_candidate();
 }
 
 }  // namespace
@@ -1649,6 +2462,36 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap Mean+SquaredDifference+Rsqrt+... layer normalization into the
+    // _FusedLayerNorm.
+    LayerNorm layer_norm;
+    if (allow_non_differentiable_rewrites &&
+        FindLayerNorm(ctx, i, &layer_norm)) {
+      TF_RETURN_IF_ERROR(AddFusedLayerNormNode(
+          &ctx, layer_norm, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap BatchMatMul+Softmax+BatchMatMul into the
+    // _FusedScaledDotProductAttention.
+    ScaledDotProductAttention attention;
+    if (allow_non_differentiable_rewrites &&
+        FindScaledDotProductAttention(ctx, i, &attention)) {
+      TF_RETURN_IF_ERROR(AddFusedScaledDotProductAttentionNode(
+          &ctx, attention, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap {Resource}Gather+SparseSegment{Sum,Mean,SqrtN} into the
+    // _Fused{Resource}EmbeddingSparseLookup.
+    EmbeddingSparseLookup embedding_lookup;
+    if (allow_non_differentiable_rewrites &&
+        FindEmbeddingSparseLookup(ctx, i, &embedding_lookup)) {
+      TF_RETURN_IF_ERROR(AddFusedEmbeddingSparseLookupNode(
+          &ctx, embedding_lookup, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -1667,6 +2510,9 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
   TF_RETURN_IF_ERROR(mutation->Apply());
 
+  // Merge the per-variable optimizer updates on GPU.
+  TF_RETURN_IF_ERROR(AddMultiApplyNodes(&ctx));
+
   *optimized_graph = mutable_item.graph;
 
   return Status::OK();
@@ -38,6 +38,10 @@ class Remapper : public GraphOptimizer {
 
   bool UsesFunctionLibrary() const override { return false; }
 
+  // The deepest fused pattern, layer normalization, spans up to nine edges
+  // from its root, and the fanouts of its intermediate nodes are checked too.
+  int Locality() const override { return 10; }
+
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
 
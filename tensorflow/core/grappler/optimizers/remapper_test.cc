@@ -853,5 +853,279 @@ TEST_F(RemapperTest, FuseConv2DWithSqueezeAndBias) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(RemapperTest, FuseLayerNorm) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({4, 16}));
+  auto scale = Placeholder(s.WithOpName("scale"), DT_FLOAT,
+                           ops::Placeholder::Shape({16}));
+  auto offset = Placeholder(s.WithOpName("offset"), DT_FLOAT,
+                            ops::Placeholder::Shape({16}));
+
+  // This is the graph built by nn.moments + nn.batch_normalization.
+  auto axes = ops::Const(s.WithOpName("axes"), {-1}, {1});
+  auto keep_dims = ops::Mean::KeepDims(true);
+  auto mean = ops::Mean(s.WithOpName("mean"), x, axes, keep_dims);
+  auto stop_gradient = ops::StopGradient(s.WithOpName("stop_gradient"), mean);
+  auto squared_difference = ops::SquaredDifference(
+      s.WithOpName("squared_difference"), x, stop_gradient);
+  auto variance =
+      ops::Mean(s.WithOpName("variance"), squared_difference, axes, keep_dims);
+  auto epsilon = ops::Const(s.WithOpName("epsilon"), 0.001f);
+  auto variance_add =
+      ops::AddV2(s.WithOpName("variance_add"), variance, epsilon);
+  auto rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), variance_add);
+  auto inv = ops::Mul(s.WithOpName("inv"), rsqrt, scale);
+  auto x_mul = ops::Mul(s.WithOpName("x_mul"), x, inv);
+  auto mean_mul = ops::Mul(s.WithOpName("mean_mul"), mean, inv);
+  auto offset_sub = ops::Sub(s.WithOpName("offset_sub"), offset, mean_mul);
+  auto layer_norm = ops::AddV2(s.WithOpName("layer_norm"), x_mul, offset_sub);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), layer_norm);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({4, 16});
+  auto scale_t = GenerateRandomTensor<DT_FLOAT>({16});
+  auto offset_t = GenerateRandomTensor<DT_FLOAT>({16});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"scale", scale_t}, {"offset", offset_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "layer_norm") {
+      EXPECT_EQ(node.op(), "_FusedLayerNorm");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "scale");
+      EXPECT_EQ(node.input(2), "offset");
+      EXPECT_FLOAT_EQ(node.attr().at("epsilon").f(), 0.001f);
+      found++;
+    }
+    EXPECT_NE(node.op(), "Rsqrt");
+    EXPECT_NE(node.op(), "SquaredDifference");
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseScaledDotProductAttention) {
+  using ::tensorflow::ops::Placeholder;
+
+  for (const bool broadcast_key : {false, true}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    const int key_batch = broadcast_key ? 1 : 2;
+    auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 8, 16}));
+    auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                           ops::Placeholder::Shape({key_batch, 12, 16}));
+    auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 12, 4}));
+
+    auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                     ops::BatchMatMulV2::AdjY(true));
+    auto divisor = ops::Const(s.WithOpName("divisor"), 4.0f);
+    auto scaled = ops::RealDiv(s.WithOpName("scaled"), scores, divisor);
+    auto probs = ops::Softmax(s.WithOpName("probs"), scaled);
+    auto attention =
+        ops::BatchMatMulV2(s.WithOpName("attention"), probs, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    auto query_t = GenerateRandomTensor<DT_FLOAT>({2, 8, 16});
+    auto key_t = GenerateRandomTensor<DT_FLOAT>({key_batch, 12, 16});
+    auto value_t = GenerateRandomTensor<DT_FLOAT>({2, 12, 4});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", query_t}, {"key", key_t}, {"value", value_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.name() != "attention") continue;
+      // The fused kernel does not broadcast batch dimensions.
+      if (broadcast_key) {
+        EXPECT_EQ(node.op(), "BatchMatMulV2");
+      } else {
+        EXPECT_EQ(node.op(), "_FusedScaledDotProductAttention");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "query");
+        EXPECT_EQ(node.input(1), "key");
+        EXPECT_EQ(node.input(2), "value");
+        EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.25f);
+      }
+      found++;
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+}
+
+TEST_F(RemapperTest, FuseEmbeddingSparseLookup) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto params = Placeholder(s.WithOpName("params"), DT_FLOAT,
+                            ops::Placeholder::Shape({10, 8}));
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT64,
+                         ops::Placeholder::Shape({4}));
+  auto indices = Placeholder(s.WithOpName("indices"), DT_INT32,
+                             ops::Placeholder::Shape({6}));
+  auto segment_ids = Placeholder(s.WithOpName("segment_ids"), DT_INT32,
+                                 ops::Placeholder::Shape({6}));
+
+  auto axis = ops::Const(s.WithOpName("axis"), 0);
+  auto gather = ops::GatherV2(s.WithOpName("gather"), params, ids, axis);
+  auto embeddings = ops::Identity(s.WithOpName("embeddings"), gather);
+  auto combined = ops::SparseSegmentMean(s.WithOpName("combined"), embeddings,
+                                         indices, segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), combined);
+
+  auto params_t = GenerateRandomTensor<DT_FLOAT>({10, 8});
+  Tensor ids_t = test::AsTensor<int64>({7, 2, 9, 0});
+  Tensor indices_t = test::AsTensor<int32>({0, 1, 1, 3, 2, 0});
+  Tensor segment_ids_t = test::AsTensor<int32>({0, 0, 1, 1, 1, 3});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"params", params_t},
+               {"ids", ids_t},
+               {"indices", indices_t},
+               {"segment_ids", segment_ids_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    EXPECT_NE(node.name(), "embeddings");
+    if (node.name() == "combined") {
+      EXPECT_EQ(node.op(), "_FusedEmbeddingSparseLookup");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "params");
+      EXPECT_EQ(node.input(1), "ids");
+      EXPECT_EQ(node.input(2), "indices");
+      EXPECT_EQ(node.input(3), "segment_ids");
+      EXPECT_EQ(node.attr().at("combiner").s(), "mean");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseResourceApplyMomentum) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto lr = Placeholder(s.WithOpName("lr"), DT_FLOAT);
+  auto other_lr = Placeholder(s.WithOpName("other_lr"), DT_FLOAT);
+  auto momentum = Placeholder(s.WithOpName("momentum"), DT_FLOAT);
+
+  std::vector<Operation> applies;
+  for (int i = 0; i < 3; ++i) {
+    const string suffix = "_" + std::to_string(i);
+    auto var = Placeholder(s.WithOpName("var" + suffix), DT_RESOURCE);
+    auto accum = Placeholder(s.WithOpName("accum" + suffix), DT_RESOURCE);
+    auto grad = Placeholder(s.WithOpName("grad" + suffix), DT_FLOAT);
+    // The last variable has a different learning rate, and is not merged.
+    applies.push_back(ops::ResourceApplyMomentum(
+        s.WithOpName("apply" + suffix), var, accum, i < 2 ? lr : other_lr,
+        grad, momentum));
+  }
+  auto train = ops::NoOp(s.WithOpName("train").WithControlDependencies(
+      {applies[0], applies[1], applies[2]}));
+
+  GrapplerItem item;
+  item.fetch = {"train"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on GPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "apply_0");
+    EXPECT_NE(node.name(), "apply_1");
+    if (node.name() == "MultiApply/apply_0") {
+      EXPECT_EQ(node.op(), "_ResourceMultiApplyMomentum");
+      EXPECT_EQ(node.attr().at("N").i(), 2);
+      ASSERT_EQ(node.input_size(), 8);
+      EXPECT_EQ(node.input(0), "var_0");
+      EXPECT_EQ(node.input(1), "var_1");
+      EXPECT_EQ(node.input(2), "accum_0");
+      EXPECT_EQ(node.input(3), "accum_1");
+      EXPECT_EQ(node.input(4), "lr");
+      EXPECT_EQ(node.input(5), "grad_0");
+      EXPECT_EQ(node.input(6), "grad_1");
+      EXPECT_EQ(node.input(7), "momentum");
+      found++;
+    }
+    if (node.name() == "apply_2") {
+      EXPECT_EQ(node.op(), "ResourceApplyMomentum");
+      found++;
+    }
+    if (node.name() == "train") {
+      EXPECT_THAT(node.input(), ::testing::UnorderedElementsAre(
+                                    "^apply_2", "^MultiApply/apply_0"));
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 3);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -280,6 +280,44 @@ Status GetInputs(ScopedAllocatorOptimizer* sa_opti, int64 invocation_count,
   return Status::OK();
 }
 
+// Build the ScopedAllocator node that will be assigned to allocate
+// the output tensors described by `inputs`.
+Status ConstructScopedAllocatorNode(
+    GraphDef* graph, NodeMap* node_map, const string& device_name,
+    DataType dtype, int sa_id, const string& sa_name,
+    const std::vector<TensorShape>& input_shapes,
+    const std::vector<InputDesc>& inputs, const TensorShape& sa_shape) {
+  VLOG(2) << "ConstructScopedAllocatorNode " << sa_name;
+  NodeDefBuilder sa_builder(sa_name, "_ScopedAllocator");
+  sa_builder.Device(device_name);
+  sa_builder.Attr("sa_name", sa_name);
+  sa_builder.Attr("T", dtype);
+  sa_builder.Attr("id", sa_id);
+  sa_builder.Attr("shapes", input_shapes);
+  sa_builder.Attr("shape", sa_shape);
+  sa_builder.Attr("expected_call_count", static_cast<int64>(inputs.size()));
+  NodeDef* sa_node = graph->add_node();
+  LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
+  node_map->AddNode(sa_name, sa_node);
+
+  // Add control edges from the ScopedAllocatorOp to all of the
+  // input nodes and mark them for allocation from backing tensor.
+  for (int i = 0; i < inputs.size(); ++i) {
+    auto& nd = inputs[i];
+    VLOG(2) << "To input " << i << ": " << nd.from_node_def->name()
+            << " add control input "
+            << "^" << sa_name;
+    nd.from_node_def->add_input(strings::StrCat("^", sa_name));
+    // This attribute says: allocate output_slot from
+    // ScopedAllocator instance sa_id + 1 + i.
+    ScopedAllocatorOptimizer::ExtendNodeAttr(kScopedAllocatorAttrName,
+                                             {nd.output_slot, sa_id + 1 + i},
+                                             nd.from_node_def);
+    node_map->AddOutput(sa_name, nd.from_node_def->name());
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 void ScopedAllocatorOptimizer::ExtendNodeAttr(StringPiece name,
@@ -401,45 +439,6 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     return Status::OK();
   }
 
-  // Build the ScopedAllocator node that will be assigned to allocate
-  // the output tensors of the input node set.
-  Status ConstructScopedAllocatorNode(
-      ScopedAllocatorOptimizer* sa_opti, GraphDef* graph, NodeMap* node_map,
-      const std::vector<NodeDef*>& ops, const string& device_name,
-      DataType dtype, int sa_id, const string& sa_name,
-      const std::vector<TensorShape>& input_shapes,
-      const std::vector<InputDesc>& inputs, const TensorShape& sa_shape) {
-    VLOG(2) << "ConstructScopedAllocatorNode " << sa_name;
-    NodeDefBuilder sa_builder(sa_name, "_ScopedAllocator");
-    sa_builder.Device(device_name);
-    sa_builder.Attr("sa_name", sa_name);
-    sa_builder.Attr("T", dtype);
-    sa_builder.Attr("id", sa_id);
-    sa_builder.Attr("shapes", input_shapes);
-    sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64>(ops.size()));
-    NodeDef* sa_node = graph->add_node();
-    LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
-    node_map->AddNode(sa_name, sa_node);
-
-    // Add control edges from the ScopedAllocatorOp to all of the
-    // input nodes and mark them for allocation from backing tensor.
-    for (int i = 0; i < inputs.size(); ++i) {
-      auto& nd = inputs[i];
-      VLOG(2) << "To input " << i << ": " << nd.from_node_def->name()
-              << " add control input "
-              << "^" << sa_name;
-      nd.from_node_def->add_input(strings::StrCat("^", sa_name));
-      // This attribute says: allocate output_slot from
-      // ScopedAllocator instance sa_id + 1 + i.
-      ScopedAllocatorOptimizer::ExtendNodeAttr(kScopedAllocatorAttrName,
-                                               {nd.output_slot, sa_id + 1 + i},
-                                               nd.from_node_def);
-      node_map->AddOutput(sa_name, nd.from_node_def->name());
-    }
-    return Status::OK();
-  }
-
   Status BuildSAConcatNode(GraphDef* graph, NodeMap* node_map,
                            const std::vector<NodeDef*>& ops,
                            const std::set<string>& op_instance_names,
@@ -692,8 +691,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     string sa_name =
         strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
     TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
-        sa_opti, graph, node_map, ops, device_name, dtype, sa_id, sa_name,
-        input_shapes, inputs, sa_shape));
+        graph, node_map, device_name, dtype, sa_id, sa_name, input_shapes,
+        inputs, sa_shape));
 
     // TODO(tucker): Maybe add control edges to delay execution of the
     // ScopedAllocatorOp until just before first use in order to
@@ -745,12 +744,243 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Rewrites a ConcatV2 or ParallelConcat whose inputs follow one another in
+// its output, i.e. one that concatenates along the outermost dimension of
+// size greater than 1.  The producers of its inputs allocate them from a
+// single ScopedAllocator, and the concat reads that ScopedAllocator's backing
+// tensor through a ScopedAllocatorConcat instead of copying its inputs:
+/*
+     x0  x1 ... xn                  ScopedAllocator
+      \   |    /                   /   |    |    \
+       ConcatV2          =>      x0   x1 ... xn   |
+          |                        \   |    |    /
+         ...                     ScopedAllocatorConcat
+                                          |
+                                 ConcatV2 (as Identity)
+                                          |
+                                         ...
+*/
+// The concat node is kept as an Identity so that its consumers and fetches
+// are unaffected.  Fields of a ScopedAllocator are aligned to
+// Allocator::kAllocatorAlignment, so the size in bytes of each input but the
+// last must be a multiple of it, or the backing tensor would have gaps.
+class ConcatRewriter : public ScopedAllocatorOptimizer::Rewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool RewritesSingleNodes() const override { return true; }
+
+  // Many concats cannot be rewritten, so this only returns non-OK if the
+  // graph cannot be rewritten consistently, and otherwise leaves those alone.
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64 invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& nodes, bool* applied) override {
+    CHECK_EQ(1, nodes.size());
+    NodeDef* concat = nodes[0];
+    VLOG(1) << "ConcatRewriter::Rewrite " << op_name << " " << concat->name();
+    NodeMap* node_map = sa_opti->node_map();
+
+    DataType dtype;
+    TensorShape output_shape;
+    std::vector<TensorShape> input_shapes;
+    std::vector<InputDesc> inputs;
+    Status s = AnalyzeConcat(sa_opti, concat, &dtype, &output_shape,
+                             &input_shapes, &inputs);
+    if (!s.ok()) {
+      VLOG(1) << "Not rewriting " << concat->name() << ": " << s;
+      return Status::OK();
+    }
+
+    const int num_inputs = inputs.size();
+    const int sa_id = sa_opti->NewScopedAllocatorId(num_inputs);
+    const string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+        graph, node_map, concat->device(), dtype, sa_id, sa_name, input_shapes,
+        inputs, TensorShape({output_shape.num_elements()})));
+
+    const string sac_name = strings::StrCat("scoped_allocator_concat_", sa_id,
+                                            "_", invocation_count);
+    NodeDefBuilder sac_builder(sac_name, "_ScopedAllocatorConcat");
+    sac_builder.Device(concat->device());
+    sac_builder.Attr("sa_name", sa_name);
+    sac_builder.Attr("id", sa_id);
+    sac_builder.Attr("T", dtype);
+    sac_builder.Attr("shape", output_shape);
+    sac_builder.Attr("reshape", true);
+    sac_builder.Attr("N", num_inputs);
+    sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+    std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+    for (const InputDesc& nd : inputs) {
+      sac_inputs.emplace_back(nd.from_node_def->name(), nd.output_slot, dtype);
+    }
+    sac_builder.Input(sac_inputs);
+    NodeDef* sac_node = graph->add_node();
+    LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(sac_node));
+    node_map->AddNode(sac_name, sac_node);
+    node_map->AddOutput(sa_name, sac_name);
+    for (const InputDesc& nd : inputs) {
+      node_map->AddOutput(nd.from_node_def->name(), sac_name);
+    }
+
+    // Move the control inputs of the concat to the ScopedAllocatorConcat and
+    // turn the concat into an Identity of the latter.
+    for (const string& input : concat->input()) {
+      const string input_node = NodeName(input);
+      node_map->RemoveOutput(input_node, concat->name());
+      if (IsControlInput(input)) {
+        sac_node->add_input(input);
+        node_map->AddOutput(input_node, sac_name);
+      }
+    }
+    concat->clear_input();
+    concat->add_input(sac_name);
+    node_map->AddOutput(sac_name, concat->name());
+    concat->set_op("Identity");
+    for (const char* attr_name : {"N", "Tidx", "shape"}) {
+      concat->mutable_attr()->erase(attr_name);
+    }
+
+    *applied = true;
+    return Status::OK();
+  }
+
+ private:
+  // Checks whether `concat` can be rewritten and gathers its type, its
+  // output shape, and the shapes and producers of its inputs.
+  Status AnalyzeConcat(ScopedAllocatorOptimizer* sa_opti, NodeDef* concat,
+                       DataType* dtype, TensorShape* output_shape,
+                       std::vector<TensorShape>* input_shapes,
+                       std::vector<InputDesc>* inputs) {
+    CHECK(graph_properties_);
+    NodeMap* node_map = sa_opti->node_map();
+    AttrSlice attrs(*concat);
+    int num_inputs;
+    TF_RETURN_IF_ERROR(GetNodeAttr(attrs, "N", &num_inputs));
+    TF_RETURN_IF_ERROR(GetNodeAttr(attrs, "T", dtype));
+    // int32 tensors of non-CPU devices usually live in host memory, which the
+    // device's ScopedAllocator cannot back.
+    if (!DataTypeCanUseMemcpy(*dtype) || *dtype == DT_INT32 ||
+        Allocator::kAllocatorAlignment % DataTypeSize(*dtype) != 0) {
+      return errors::Unimplemented("Unsupported type ",
+                                   DataTypeString(*dtype));
+    }
+    if (num_inputs < 2 || concat->input_size() < num_inputs) {
+      return errors::Unimplemented("Expected at least 2 inputs");
+    }
+
+    int64 axis = 0;
+    if (concat->op() == "ConcatV2") {
+      if (concat->input_size() <= num_inputs) {
+        return errors::Internal("Missing axis input");
+      }
+      const NodeDef* axis_node = node_map->GetNode(concat->input(num_inputs));
+      Tensor axis_tensor;
+      if (axis_node == nullptr || !IsConstant(*axis_node) ||
+          !GetNodeAttr(*axis_node, "value", &axis_tensor).ok() ||
+          axis_tensor.NumElements() != 1) {
+        return errors::Unimplemented("Axis is not a constant scalar");
+      }
+      axis = axis_tensor.dtype() == DT_INT32 ? axis_tensor.flat<int32>()(0)
+                                             : axis_tensor.flat<int64>()(0);
+    }
+
+    if (!graph_properties_->HasOutputProperties(concat->name()) ||
+        !graph_properties_->HasInputProperties(concat->name())) {
+      return errors::Unimplemented("Shapes are not known");
+    }
+    const std::vector<OpInfo::TensorProperties>& output_props =
+        graph_properties_->GetOutputProperties(concat->name());
+    if (output_props.size() != 1 ||
+        !TensorShape::IsValid(output_props[0].shape())) {
+      return errors::Unimplemented("Output shape is not known");
+    }
+    *output_shape = TensorShape(output_props[0].shape());
+    if (axis < 0) axis += output_shape->dims();
+    if (axis < 0 || axis >= output_shape->dims()) {
+      return errors::InvalidArgument("Invalid axis ", axis);
+    }
+    for (int d = 0; d < axis; ++d) {
+      if (output_shape->dim_size(d) != 1) {
+        return errors::Unimplemented(
+            "Inputs are not contiguous in the output of shape ",
+            output_shape->DebugString());
+      }
+    }
+
+    const std::vector<OpInfo::TensorProperties>& input_props =
+        graph_properties_->GetInputProperties(concat->name());
+    if (input_props.size() < num_inputs) {
+      return errors::Unimplemented("Input shapes are not known");
+    }
+    int64 num_elements = 0;
+    for (int i = 0; i < num_inputs; ++i) {
+      if (input_props[i].dtype() != *dtype ||
+          !TensorShape::IsValid(input_props[i].shape())) {
+        return errors::Unimplemented("Shape of input ", i, " is not known");
+      }
+      TensorShape shape(input_props[i].shape());
+      const int64 num_bytes = shape.num_elements() * DataTypeSize(*dtype);
+      if (num_bytes == 0 ||
+          (i < num_inputs - 1 &&
+           num_bytes % Allocator::kAllocatorAlignment != 0)) {
+        return errors::Unimplemented("Input ", i, " of ", num_bytes,
+                                     " bytes would not be contiguous with the "
+                                     "next one");
+      }
+      num_elements += shape.num_elements();
+      input_shapes->push_back(shape);
+    }
+    if (num_elements != output_shape->num_elements()) {
+      return errors::Internal("Inconsistent input and output shapes");
+    }
+
+    std::set<string> seen_inputs;
+    for (int i = 0; i < num_inputs; ++i) {
+      const string& input_name = concat->input(i);
+      int output_slot = 0;
+      const string producer_name = ParseNodeName(input_name, &output_slot);
+      NodeDef* producer = node_map->GetNode(producer_name);
+      if (producer == nullptr) {
+        return errors::Internal("Did not find node ", input_name);
+      }
+      // An output can only be allocated from one ScopedAllocator field.
+      if (!seen_inputs.insert(strings::StrCat(producer_name, ":", output_slot))
+               .second ||
+          sa_opti->repeated_outputs().contains(input_name)) {
+        return errors::Unimplemented("Input ", input_name, " is repeated");
+      }
+      // The ScopedAllocator is outside of any frame, so it must not control
+      // an Exit.
+      if (IsExit(*producer) || producer->device() != concat->device()) {
+        return errors::Unimplemented("Cannot allocate input ", input_name);
+      }
+      std::vector<int32> scope_ids;
+      if (GetNodeAttr(AttrSlice(*producer), kScopedAllocatorAttrName,
+                      &scope_ids)
+              .ok()) {
+        for (int j = 0; j + 1 < scope_ids.size(); j += 2) {
+          if (scope_ids[j] == output_slot) {
+            return errors::Unimplemented("Input ", input_name,
+                                         " is already assigned to scope_id ",
+                                         scope_ids[j + 1]);
+          }
+        }
+      }
+      inputs->emplace_back(producer, output_slot, concat);
+    }
+    return Status::OK();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level), max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -760,7 +990,11 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      if (op_name == "ConcatV2" || op_name == "ParallelConcat") {
+        rewriters_[op_name] = concat_rewriter;
+      } else {
+        rewriters_[op_name] = r;
+      }
     }
   }
 }
@@ -951,6 +1185,7 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
     for (auto& dt : occ) {
       VLOG(2) << "Processing device " << dt.first;
       const DevOpOccurrences& dev_occ = dt.second;
+      std::vector<const DevOpOccurrences::value_type*> single_node_occ;
       for (auto& it : dev_occ) {
         string op_name = it.first;
         VLOG(1) << "Processing " << op_name << " set size " << it.second.size();
@@ -961,6 +1196,12 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (rewriter->RewritesSingleNodes()) {
+          // These are rewritten after the groups of parallel ops on this
+          // device, which thereby keep precedence on the outputs they share.
+          single_node_occ.push_back(&it);
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -974,7 +1215,8 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // Nodes with a common depth and root path are now grouped
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
-        status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
+        status = ApplyToAll(root.get(), [this, rewriter, graph,
+                                         &graph_properties, &frame_view,
                                          &op_name, invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
@@ -983,13 +1225,19 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
             for (auto& lg : loop_groups) {
               if (lg.size() > 1) {
-                bool applied = false;
                 Status s = OrderNodeSet(&lg);
                 TF_RETURN_IF_ERROR(s);
-                VLOG(1) << "Applying Rewriter for " << op_name;
-                s = rewriter->Rewrite(this, invocation_count, graph, op_name,
-                                      lg, &applied);
-                LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                std::vector<std::vector<NodeDef*>> buckets;
+                BucketNodeSet(graph_properties, lg, &buckets);
+                for (const auto& bucket : buckets) {
+                  if (bucket.size() < 2) continue;
+                  bool applied = false;
+                  VLOG(1) << "Applying Rewriter for " << op_name << " to "
+                          << bucket.size() << " nodes";
+                  s = rewriter->Rewrite(this, invocation_count, graph,
+                                        op_name, bucket, &applied);
+                  LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                }
               }
             }
           }
@@ -999,6 +1247,21 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           break;
         }
       }
+      for (const DevOpOccurrences::value_type* it : single_node_occ) {
+        if (!status.ok()) break;
+        const string& op_name = it->first;
+        Rewriter* rewriter = GetRewriter(op_name);
+        for (NodeDef* node : it->second) {
+          // The ScopedAllocator is created outside of any frame.
+          if (frame_view.IsInFrame(*node)) continue;
+          bool applied = false;
+          VLOG(1) << "Applying Rewriter for " << op_name << " to "
+                  << node->name();
+          status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                     {node}, &applied);
+          if (!status.ok()) break;
+        }
+      }
       if (!status.ok()) {
         break;
       }
@@ -1058,6 +1321,48 @@ Status ScopedAllocatorOptimizer::OrderNodeSet(
   return Status::OK();
 }
 
+void ScopedAllocatorOptimizer::BucketNodeSet(
+    const GraphProperties& graph_properties,
+    const std::vector<NodeDef*>& nodes,
+    std::vector<std::vector<NodeDef*>>* buckets) const {
+  buckets->clear();
+  std::vector<int64> node_bytes;
+  if (max_bucket_bytes_ > 0) {
+    for (const NodeDef* n : nodes) {
+      if (!graph_properties.HasOutputProperties(n->name())) break;
+      const std::vector<OpInfo::TensorProperties>& prop_list =
+          graph_properties.GetOutputProperties(n->name());
+      if (prop_list.size() != 1 ||
+          !TensorShape::IsValid(prop_list[0].shape())) {
+        break;
+      }
+      node_bytes.push_back(TensorShape(prop_list[0].shape()).num_elements() *
+                           DataTypeSize(prop_list[0].dtype()));
+    }
+  }
+  if (node_bytes.size() != nodes.size()) {
+    // Leave it to the Rewriter to report nodes with unknown shapes.
+    buckets->push_back(nodes);
+    return;
+  }
+  int64 bucket_bytes = 0;
+  for (int i = nodes.size() - 1; i >= 0; --i) {
+    if (buckets->empty() ||
+        (bucket_bytes > 0 &&
+         bucket_bytes + node_bytes[i] > max_bucket_bytes_)) {
+      buckets->emplace_back();
+      bucket_bytes = 0;
+    }
+    buckets->back().push_back(nodes[i]);
+    bucket_bytes += node_bytes[i];
+  }
+  for (auto& bucket : *buckets) {
+    std::reverse(bucket.begin(), bucket.end());
+  }
+  VLOG(1) << "Split " << nodes.size() << " nodes into " << buckets->size()
+          << " buckets of at most " << max_bucket_bytes_ << " bytes";
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
 
@@ -34,7 +34,12 @@ class NodeMap;
 class ScopedAllocatorOptimizer;
 
 // An Optimizer that introduces ScopedAllocators in order to reduce data
-// movement and consolidate some kinds of Ops.
+// movement and consolidate some kinds of Ops.  Groups of parallel Ops are
+// merged into a single Op reading all of their inputs from one backing
+// tensor.  ConcatV2 and ParallelConcat Ops, when enabled with
+// ScopedAllocatorOptions.enable_op, instead have their inputs allocated from
+// one backing tensor that they output without copying, where the layout
+// allows it.
 class ScopedAllocatorOptimizer : public GraphOptimizer {
  public:
   ScopedAllocatorOptimizer(RewriterConfig::Toggle opt_level,
@@ -96,6 +101,10 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // If true, `Rewrite` is called with each node of its op on its own,
+    // rather than with groups of logically parallel nodes.
+    virtual bool RewritesSingleNodes() const { return false; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
@@ -110,7 +119,16 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
 
   Status OrderNodeSet(std::vector<NodeDef*>* nodes) const;
 
+  // Splits the ordered `nodes` into buckets of at most `max_bucket_bytes_`
+  // bytes of output each, starting from the last node.  The nodes of each
+  // bucket keep their relative order.  Returns a single bucket if bucketing
+  // is disabled or the size of some node is not known.
+  void BucketNodeSet(const GraphProperties& graph_properties,
+                     const std::vector<NodeDef*>& nodes,
+                     std::vector<std::vector<NodeDef*>>* buckets) const;
+
   RewriterConfig::Toggle opt_level_;
+  int64 max_bucket_bytes_;
   std::unordered_set<string> nodes_to_preserve_;
   OpNameSet op_name_set_;
   absl::flat_hash_map<string, Rewriter*> rewriters_;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 
+#include <set>
 #include <unordered_set>
 
 #include "tensorflow/cc/ops/standard_ops.h"
@@ -153,6 +154,46 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(root_scope.ToGraphDef(graph_def));
   }
 
+  // Constructs a graph with four parallel Abs ops, a1 to a4, each reading a
+  // different Add op s1 to s4.
+  void BuildFourAbsGraph(GraphDef* graph_def) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    Output a =
+        ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+    Output b =
+        ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+    for (int i = 1; i <= 4; ++i) {
+      Output sum = ops::Add(s.WithOpName(strings::StrCat("s", i)), a, b);
+      Output abs = ops::Abs(s.WithOpName(strings::StrCat("a", i)), sum);
+      ops::Reshape(s.WithOpName(strings::StrCat("r", i)), abs, {1, 4});
+    }
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
+  // Constructs a graph with a ConcatV2 op "concat" of the outputs of two Add
+  // ops s1 and s2 of shape [2, 8], along `axis`, read by Reshape op r.
+  void BuildConcatGraph(GraphDef* graph_def, int axis) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    std::vector<float> a_values(16), b_values(16);
+    for (int i = 0; i < 16; ++i) {
+      a_values[i] = i;
+      b_values[i] = 100 * i;
+    }
+    Output a = ops::Const(s.WithOpName("a"),
+                          test::AsTensor<float>(a_values, {2, 8}));
+    Output b = ops::Const(s.WithOpName("b"),
+                          test::AsTensor<float>(b_values, {2, 8}));
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Add(s.WithOpName("s2"), b, b);
+    Output concat = ops::Concat(s.WithOpName("concat"), {s1, s2}, axis);
+    ops::Reshape(s.WithOpName("r"), concat, {-1});
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -169,7 +210,8 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
   // returns the outputs specifed by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const string& enable_op = "Abs") {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -183,7 +225,7 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    rwcfg->mutable_scoped_allocator_opts()->add_enable_op(enable_op);
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -324,6 +366,124 @@ TEST_F(ScopedAllocatorOptimizerTest, ForwardInputToOutput) {
   ValidateValues(outputs, /*expected=*/{{2, 2, 3, 3}, {4, 4, 3, 2}});
 }
 
+// Runs after the tests above that depend on the optimizer's invocation count.
+TEST_F(ScopedAllocatorOptimizerTest, BucketedRewrite) {
+  // Tests that a group of Abs ops is split into buckets of bounded size, each
+  // of which is rewritten separately, starting from the last op.
+  GrapplerItem item;
+  BuildFourAbsGraph(&item.graph);
+  SetShapes(&item.graph);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  // Each Abs outputs 4 floats, so that a bucket fits two of them.
+  opts.set_max_bucket_bytes(2 * 4 * sizeof(float));
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  std::set<std::set<string>> concat_inputs;
+  for (const NodeDef& nd : optimized_graph.node()) {
+    if (nd.op() != "_ScopedAllocatorConcat") continue;
+    std::set<string> inputs;
+    for (const string& input : nd.input()) {
+      const NodeDef* input_node = node_map.GetNode(input);
+      ASSERT_TRUE(input_node);
+      if (input_node->op() == "Add") inputs.insert(input_node->name());
+    }
+    concat_inputs.insert(inputs);
+  }
+  std::set<std::set<string>> expected = {{"s1", "s2"}, {"s3", "s4"}};
+  EXPECT_EQ(expected, concat_inputs);
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, BucketLargerThanLimit) {
+  // Tests that ops larger than the bucket limit are left alone.
+  GrapplerItem item;
+  BuildFourAbsGraph(&item.graph);
+  SetShapes(&item.graph);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  opts.set_max_bucket_bytes(1);
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+  for (const NodeDef& nd : optimized_graph.node()) {
+    EXPECT_NE("_ScopedAllocatorConcat", nd.op());
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewrite) {
+  // Tests that the inputs of a concat along its first dimension are allocated
+  // from a ScopedAllocator whose backing tensor replaces the concat output.
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*axis=*/0);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  const NodeDef* concat = node_map.GetNode("concat");
+  ASSERT_TRUE(concat);
+  EXPECT_EQ("Identity", concat->op());
+  ASSERT_EQ(1, concat->input_size());
+  const NodeDef* sac = node_map.GetNode(concat->input(0));
+  ASSERT_TRUE(sac);
+  EXPECT_EQ("_ScopedAllocatorConcat", sac->op());
+  ASSERT_EQ(3, sac->input_size());
+  const NodeDef* sa = node_map.GetNode(sac->input(0));
+  ASSERT_TRUE(sa);
+  EXPECT_EQ("_ScopedAllocator", sa->op());
+  EXPECT_EQ("s1", sac->input(1));
+  EXPECT_EQ("s2", sac->input(2));
+  for (const string& name : {"s1", "s2"}) {
+    const NodeDef* producer = node_map.GetNode(name);
+    ASSERT_TRUE(producer);
+    EXPECT_TRUE(HasNodeAttr(*producer, "_scoped_allocator"));
+    EXPECT_EQ(strings::StrCat("^", sa->name()),
+              producer->input(producer->input_size() - 1));
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*axis=*/0);
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"r:0", "concat:0"}, &outputs,
+               /*enable_op=*/"ConcatV2");
+  std::vector<float> expected;
+  for (int i = 0; i < 16; ++i) expected.push_back(101 * i);
+  for (int i = 0; i < 16; ++i) expected.push_back(200 * i);
+  ValidateValues(outputs, /*expected=*/{expected, expected});
+  EXPECT_EQ(TensorShape({4, 8}), outputs[1].shape());
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatAlongInnerDimension) {
+  // Tests that a concat whose inputs are interleaved in its output is left
+  // alone.
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*axis=*/1);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+  for (const NodeDef& nd : optimized_graph.node()) {
+    EXPECT_NE("_ScopedAllocatorConcat", nd.op());
+    if (nd.name() == "concat") EXPECT_EQ("ConcatV2", nd.op());
+  }
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -0,0 +1,526 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/shape_specializer.h"
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kPrefix[] = "ShapeSpecializer";
+
+bool IsFullyDefined(const TensorShapeProto& shape) {
+  return PartialTensorShape(shape).IsFullyDefined();
+}
+
+string ShapesKey(const std::vector<TensorShapeProto>& shapes) {
+  std::vector<string> keys;
+  keys.reserve(shapes.size());
+  for (const TensorShapeProto& shape : shapes) {
+    keys.push_back(PartialTensorShape(shape).DebugString());
+  }
+  return absl::StrJoin(keys, ";");
+}
+
+// Returns the name of the graph input fed through the runtime node
+// `node_name`, or an empty string if it is not a feed node. Feeds are
+// replaced by `_arg_<input>_<port>_<index>` nodes when they are passed in the
+// call frame, and by `_recv_<input>_<port>` nodes otherwise (see
+// graph/subgraph.cc).
+string FedInputName(absl::string_view node_name) {
+  if (absl::ConsumePrefix(&node_name, "_arg_")) {
+    const size_t pos = node_name.rfind('_');
+    if (pos == absl::string_view::npos) return "";
+    node_name = node_name.substr(0, pos);
+  } else if (!absl::ConsumePrefix(&node_name, "_recv_")) {
+    return "";
+  }
+  if (!absl::ConsumeSuffix(&node_name, "_0")) return "";
+  return string(node_name);
+}
+
+string OutputTensorName(const string& node, int index) {
+  return index == 0 ? node : strings::StrCat(node, ":", index);
+}
+
+NodeDef* AddNode(const string& name, const string& op, const string& device,
+                 const std::vector<string>& inputs, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  node->set_device(device);
+  for (const string& input : inputs) node->add_input(input);
+  return node;
+}
+
+NodeDef* AddInt32Const(const string& name, const string& device,
+                       const std::vector<int32>& values, bool scalar,
+                       GraphDef* graph) {
+  NodeDef* node = AddNode(name, "Const", device, {}, graph);
+  Tensor value(DT_INT32, scalar ? TensorShape({})
+                                : TensorShape({static_cast<int64>(
+                                      values.size())}));
+  for (int i = 0; i < values.size(); ++i) value.flat<int32>()(i) = values[i];
+  (*node->mutable_attr())["dtype"].set_type(DT_INT32);
+  value.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+// Adds the nodes that check at runtime whether `input` has the static shape
+// `shape`, and returns the name of their boolean scalar result.
+string AddShapeCheck(const NodeDef& input, const TensorShapeProto& shape,
+                     const string& prefix, GraphDef* graph) {
+  const string scope = strings::StrCat(prefix, "/", input.name());
+  const string& device = input.device();
+  const DataType dtype = input.attr().at("dtype").type();
+
+  std::vector<int32> dims;
+  for (const auto& dim : shape.dim()) dims.push_back(dim.size());
+
+  NodeDef* rank = AddNode(strings::StrCat(scope, "/rank"), "Rank", device,
+                          {input.name()}, graph);
+  SetAttrValue(dtype, &(*rank->mutable_attr())["T"]);
+  NodeDef* expected_rank =
+      AddInt32Const(strings::StrCat(scope, "/expected_rank"), device,
+                    {static_cast<int32>(dims.size())}, true, graph);
+  NodeDef* rank_equal = AddNode(strings::StrCat(scope, "/rank_equal"), "Equal",
+                                device, {rank->name(), expected_rank->name()},
+                                graph);
+  SetAttrValue(DT_INT32, &(*rank_equal->mutable_attr())["T"]);
+
+  // With incompatible_shape_error=false, comparing shapes of different ranks
+  // yields a scalar false. The result is flattened so that it can always be
+  // reduced along axis 0; the rank check above rejects the ranks that
+  // happened to broadcast.
+  NodeDef* input_shape = AddNode(strings::StrCat(scope, "/shape"), "Shape",
+                                 device, {input.name()}, graph);
+  SetAttrValue(dtype, &(*input_shape->mutable_attr())["T"]);
+  SetAttrValue(DT_INT32, &(*input_shape->mutable_attr())["out_type"]);
+  NodeDef* expected_shape = AddInt32Const(
+      strings::StrCat(scope, "/expected_shape"), device, dims, false, graph);
+  NodeDef* shape_equal = AddNode(strings::StrCat(scope, "/shape_equal"),
+                                 "Equal", device,
+                                 {input_shape->name(), expected_shape->name()},
+                                 graph);
+  SetAttrValue(DT_INT32, &(*shape_equal->mutable_attr())["T"]);
+  SetAttrValue(false,
+               &(*shape_equal->mutable_attr())["incompatible_shape_error"]);
+  NodeDef* flat_shape = AddInt32Const(strings::StrCat(scope, "/flat_shape"),
+                                      device, {-1}, false, graph);
+  NodeDef* flat_equal = AddNode(strings::StrCat(scope, "/flat_equal"),
+                                "Reshape", device,
+                                {shape_equal->name(), flat_shape->name()},
+                                graph);
+  SetAttrValue(DT_BOOL, &(*flat_equal->mutable_attr())["T"]);
+  SetAttrValue(DT_INT32, &(*flat_equal->mutable_attr())["Tshape"]);
+  NodeDef* axis = AddInt32Const(strings::StrCat(scope, "/axis"), device, {0},
+                                true, graph);
+  NodeDef* all_equal =
+      AddNode(strings::StrCat(scope, "/all_equal"), "All", device,
+              {flat_equal->name(), axis->name()}, graph);
+  SetAttrValue(false, &(*all_equal->mutable_attr())["keep_dims"]);
+  SetAttrValue(DT_INT32, &(*all_equal->mutable_attr())["Tidx"]);
+
+  NodeDef* check =
+      AddNode(strings::StrCat(scope, "/has_shape"), "LogicalAnd", device,
+              {rank_equal->name(), all_equal->name()}, graph);
+  return check->name();
+}
+
+// Rewires the inputs of `node` that read a specialized graph input to the
+// tensors in `switched_inputs`, and the inputs that read a renamed node to its
+// new name in `renamed_nodes`.
+void RewireInputs(const std::unordered_map<string, string>& switched_inputs,
+                  const std::unordered_map<string, string>& renamed_nodes,
+                  NodeDef* node) {
+  for (string& input : *node->mutable_input()) {
+    const TensorId id = ParseTensorName(input);
+    const string name(id.node());
+    const int index = id.index();
+
+    auto it = switched_inputs.find(name);
+    if (it != switched_inputs.end()) {
+      input = index < 0 ? AsControlDependency(NodeName(it->second))
+                        : it->second;
+      continue;
+    }
+    it = renamed_nodes.find(name);
+    if (it != renamed_nodes.end()) {
+      input = index < 0 ? AsControlDependency(it->second)
+                        : OutputTensorName(it->second, index);
+    }
+  }
+}
+
+}  // namespace
+
+ShapeProfile::ShapeProfile(std::vector<string> inputs)
+    : inputs_(std::move(inputs)) {}
+
+void ShapeProfile::AddStep(std::vector<TensorShapeProto> shapes) {
+  DCHECK_EQ(shapes.size(), inputs_.size());
+  Entry& entry = entries_[ShapesKey(shapes)];
+  if (entry.count == 0) {
+    entry.shapes = std::move(shapes);
+    entry.first_step = num_steps_;
+  }
+  ++entry.count;
+  ++num_steps_;
+}
+
+bool ShapeProfile::AddStepStats(const StepStats& step_stats) {
+  std::unordered_map<string, int> positions;
+  for (int i = 0; i < inputs_.size(); ++i) positions[inputs_[i]] = i;
+
+  std::vector<TensorShapeProto> shapes(inputs_.size());
+  for (TensorShapeProto& shape : shapes) shape.set_unknown_rank(true);
+
+  bool found = false;
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      auto it = positions.find(node_stats.node_name());
+      if (it == positions.end()) {
+        it = positions.find(FedInputName(node_stats.node_name()));
+      }
+      if (it == positions.end()) continue;
+      for (const NodeOutput& output : node_stats.output()) {
+        if (output.slot() != 0) continue;
+        shapes[it->second] = output.tensor_description().shape();
+        found = true;
+      }
+    }
+  }
+  if (!found) return false;
+
+  AddStep(std::move(shapes));
+  return true;
+}
+
+std::vector<std::vector<TensorShapeProto>> ShapeProfile::CommonShapes(
+    int max_shapes, float min_fraction) const {
+  std::vector<const Entry*> common;
+  for (const auto& it : entries_) {
+    const Entry& entry = it.second;
+    if (entry.count < min_fraction * num_steps_) continue;
+    if (std::none_of(entry.shapes.begin(), entry.shapes.end(),
+                     IsFullyDefined)) {
+      continue;
+    }
+    common.push_back(&entry);
+  }
+  std::sort(common.begin(), common.end(),
+            [](const Entry* a, const Entry* b) {
+              if (a->count != b->count) return a->count > b->count;
+              return a->first_step < b->first_step;
+            });
+
+  std::vector<std::vector<TensorShapeProto>> shapes;
+  for (const Entry* entry : common) {
+    if (shapes.size() >= max_shapes) break;
+    shapes.push_back(entry->shapes);
+  }
+  return shapes;
+}
+
+Status ShapeSpecializer::Init(
+    const tensorflow::RewriterConfig_CustomGraphOptimizer* config) {
+  if (!config) return Status::OK();
+  const auto& parameters = config->parameter_map();
+
+  auto it = parameters.find("max_branches");
+  if (it != parameters.end()) max_branches_ = it->second.i();
+  if (max_branches_ < 1) {
+    return errors::InvalidArgument("max_branches should be >= 1, currently ",
+                                   max_branches_);
+  }
+
+  it = parameters.find("min_fraction");
+  if (it != parameters.end()) min_fraction_ = it->second.f();
+  if (min_fraction_ < 0 || min_fraction_ > 1) {
+    return errors::InvalidArgument(
+        "min_fraction should be in [0, 1], currently ", min_fraction_);
+  }
+
+  it = parameters.find("run_metadata");
+  if (it != parameters.end()) {
+    std::vector<string> files;
+    if (it->second.value_case() == AttrValue::kList) {
+      files.assign(it->second.list().s().begin(), it->second.list().s().end());
+    } else {
+      files.push_back(it->second.s());
+    }
+    for (const string& file : files) {
+      RunMetadata run_metadata;
+      TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), file, &run_metadata));
+      step_stats_.push_back(run_metadata.step_stats());
+    }
+  }
+
+  return Status::OK();
+}
+
+Status ShapeSpecializer::Optimize(Cluster* /*cluster*/,
+                                  const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  if (step_stats_.empty()) return errors::Aborted("Nothing to do.");
+  for (const NodeDef& node : item.graph.node()) {
+    if (absl::StartsWith(node.name(), kPrefix)) {
+      return errors::Aborted("The graph is already specialized.");
+    }
+  }
+
+  *optimized_graph = item.graph;
+  NodeMap node_map(optimized_graph);
+
+  // Inputs whose shape is not statically known.
+  std::vector<const NodeDef*> inputs;
+  std::vector<string> input_names;
+  for (const NodeDef& node : optimized_graph->node()) {
+    if (!IsPlaceholder(node) || node_map.GetOutputs(node.name()).empty()) {
+      continue;
+    }
+    PartialTensorShape shape;
+    if (GetNodeAttr(node, "shape", &shape).ok() && shape.IsFullyDefined()) {
+      continue;
+    }
+    inputs.push_back(&node);
+    input_names.push_back(node.name());
+  }
+  if (inputs.empty()) return errors::Aborted("Nothing to do.");
+
+  ShapeProfile profile(input_names);
+  for (const StepStats& step_stats : step_stats_) {
+    profile.AddStepStats(step_stats);
+  }
+
+  // Drop the shapes that contradict the declared input shapes.
+  std::vector<std::vector<TensorShapeProto>> common_shapes;
+  for (auto& shapes : profile.CommonShapes(max_branches_, min_fraction_)) {
+    bool compatible = true;
+    for (int i = 0; i < inputs.size(); ++i) {
+      PartialTensorShape declared;
+      if (IsFullyDefined(shapes[i]) &&
+          GetNodeAttr(*inputs[i], "shape", &declared).ok() &&
+          !declared.IsCompatibleWith(PartialTensorShape(shapes[i]))) {
+        compatible = false;
+      }
+    }
+    if (compatible) common_shapes.push_back(std::move(shapes));
+  }
+  if (common_shapes.empty()) return errors::Aborted("Nothing to do.");
+
+  // Nodes that (transitively) depend on the inputs, and thus get a copy in
+  // every branch.
+  std::unordered_set<string> input_set(input_names.begin(), input_names.end());
+  std::unordered_set<string> fanout;
+  std::deque<string> queue(input_names.begin(), input_names.end());
+  while (!queue.empty()) {
+    const string name = queue.front();
+    queue.pop_front();
+    for (const NodeDef* output : node_map.GetOutputs(name)) {
+      if (input_set.count(output->name()) == 0 &&
+          fanout.insert(output->name()).second) {
+        queue.push_back(output->name());
+      }
+    }
+  }
+
+  std::unordered_set<string> fetch_nodes;
+  for (const string& fetch : item.fetch) fetch_nodes.insert(NodeName(fetch));
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  std::vector<NodeDef*> fanout_nodes;
+  std::unordered_map<string, DataTypeVector> fetch_types;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (fanout.count(node.name()) == 0) continue;
+    // Duplicating stateful ops would change the semantics of the graph, and
+    // existing control flow frames can not be nested in the branches.
+    const OpDef* op_def = nullptr;
+    if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+        IsStateful(node) || IsControlFlow(node)) {
+      return errors::Aborted("Can not specialize the graph: ", node.name(),
+                             " (", node.op(), ") can not be duplicated.");
+    }
+    if (fetch_nodes.count(node.name()) > 0) {
+      DataTypeVector types;
+      TF_RETURN_IF_ERROR(OutputTypesForNode(node, *op_def, &types));
+      if (types.empty()) {
+        return errors::Aborted("Can not specialize the graph: fetch node ",
+                               node.name(), " has no outputs.");
+      }
+      fetch_types[node.name()] = types;
+    } else if (nodes_to_preserve.count(node.name()) > 0) {
+      return errors::Aborted("Can not specialize the graph: ", node.name(),
+                             " must be preserved.");
+    }
+    fanout_nodes.push_back(&node);
+  }
+  if (fetch_types.empty()) return errors::Aborted("Nothing to do.");
+
+  // Dispatch: branch k is taken if its shape check passes and the checks of
+  // all the previous branches failed. Every input goes through a chain of
+  // Switch nodes whose false outputs feed the original (generic) graph.
+  const int num_branches = common_shapes.size();
+  std::vector<std::unordered_map<string, string>> switched_inputs(
+      num_branches + 1);
+  std::vector<string> predicates(num_branches);
+  for (int k = 0; k < num_branches; ++k) {
+    const string prefix = strings::StrCat(kPrefix, "/dispatch/branch_", k);
+    for (int i = 0; i < inputs.size(); ++i) {
+      if (!IsFullyDefined(common_shapes[k][i])) continue;
+      const string check = AddShapeCheck(*inputs[i], common_shapes[k][i],
+                                         prefix, optimized_graph);
+      if (predicates[k].empty()) {
+        predicates[k] = check;
+      } else {
+        predicates[k] =
+            AddNode(strings::StrCat(prefix, "/and_", i), "LogicalAnd",
+                    inputs[i]->device(), {predicates[k], check},
+                    optimized_graph)
+                ->name();
+      }
+    }
+  }
+  for (int i = 0; i < inputs.size(); ++i) {
+    const NodeDef& input = *inputs[i];
+    const DataType dtype = input.attr().at("dtype").type();
+    string remaining = input.name();
+    for (int k = 0; k < num_branches; ++k) {
+      const string scope = strings::StrCat(kPrefix, "/dispatch/branch_", k,
+                                           "/", input.name());
+      NodeDef* switch_node =
+          AddNode(strings::StrCat(scope, "/switch"), "Switch", input.device(),
+                  {remaining, predicates[k]}, optimized_graph);
+      SetAttrValue(dtype, &(*switch_node->mutable_attr())["T"]);
+      remaining = switch_node->name();
+
+      string taken = strings::StrCat(switch_node->name(), ":1");
+      const TensorShapeProto& shape = common_shapes[k][i];
+      if (IsFullyDefined(shape)) {
+        // Makes the static shape of the input visible to shape inference.
+        std::vector<int32> dims;
+        for (const auto& dim : shape.dim()) dims.push_back(dim.size());
+        NodeDef* static_shape =
+            AddInt32Const(strings::StrCat(scope, "/static_shape"),
+                          input.device(), dims, false, optimized_graph);
+        NodeDef* reshape = AddNode(scope, "Reshape", input.device(),
+                                   {taken, static_shape->name()},
+                                   optimized_graph);
+        SetAttrValue(dtype, &(*reshape->mutable_attr())["T"]);
+        SetAttrValue(DT_INT32, &(*reshape->mutable_attr())["Tshape"]);
+        taken = reshape->name();
+      }
+      switched_inputs[k][input.name()] = taken;
+    }
+    switched_inputs[num_branches][input.name()] = remaining;
+  }
+
+  // Specialized branches.
+  for (int k = 0; k < num_branches; ++k) {
+    std::unordered_map<string, string> renamed_nodes;
+    for (const NodeDef* node : fanout_nodes) {
+      renamed_nodes[node->name()] =
+          strings::StrCat(kPrefix, "/branch_", k, "/", node->name());
+    }
+    for (const NodeDef* node : fanout_nodes) {
+      NodeDef* copy = optimized_graph->add_node();
+      *copy = *node;
+      copy->set_name(renamed_nodes[node->name()]);
+      RewireInputs(switched_inputs[k], renamed_nodes, copy);
+    }
+  }
+
+  // The generic branch reuses the original nodes. Only the fetch nodes are
+  // renamed, so that their names can be taken by the merged results.
+  std::unordered_map<string, string> generic_names;
+  for (const auto& it : fetch_types) {
+    generic_names[it.first] = strings::StrCat(kPrefix, "/generic/", it.first);
+  }
+  std::vector<NodeDef> fetch_defs;
+  for (NodeDef* node : fanout_nodes) {
+    if (fetch_types.count(node->name()) > 0) fetch_defs.push_back(*node);
+    RewireInputs(switched_inputs[num_branches], generic_names, node);
+    if (generic_names.count(node->name()) > 0) {
+      node->set_name(generic_names[node->name()]);
+    }
+  }
+
+  // Every output of a fetch node is merged from all the branches.
+  for (const NodeDef& fetch : fetch_defs) {
+    const DataTypeVector& types = fetch_types[fetch.name()];
+    std::vector<string> merged;
+    for (int i = 0; i < types.size(); ++i) {
+      NodeDef* merge = AddNode(
+          strings::StrCat(kPrefix, "/merge/", fetch.name(), "/output_", i),
+          "Merge", fetch.device(), {}, optimized_graph);
+      for (int k = 0; k < num_branches; ++k) {
+        merge->add_input(OutputTensorName(
+            strings::StrCat(kPrefix, "/branch_", k, "/", fetch.name()), i));
+      }
+      merge->add_input(OutputTensorName(generic_names[fetch.name()], i));
+      SetAttrValue(types[i], &(*merge->mutable_attr())["T"]);
+      SetAttrValue(num_branches + 1, &(*merge->mutable_attr())["N"]);
+      merged.push_back(merge->name());
+    }
+
+    NodeDef* output =
+        AddNode(fetch.name(), types.size() == 1 ? "Identity" : "IdentityN",
+                fetch.device(), merged, optimized_graph);
+    if (types.size() == 1) {
+      SetAttrValue(types[0], &(*output->mutable_attr())["T"]);
+    } else {
+      SetAttrValue(types, &(*output->mutable_attr())["T"]);
+    }
+  }
+
+  VLOG(1) << "Specialized " << fanout_nodes.size() << " nodes for "
+          << num_branches << " input shape combinations.";
+  return Status::OK();
+}
+
+void ShapeSpecializer::Feedback(Cluster* /*cluster*/,
+                                const GrapplerItem& /*item*/,
+                                const GraphDef& /*optimized_graph*/,
+                                double /*result*/) {
+  // Nothing to do for ShapeSpecializer.
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ShapeSpecializer, "shape_specializer");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,115 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SHAPE_SPECIALIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SHAPE_SPECIALIZER_H_
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Shapes of a fixed set of graph inputs as they were observed at runtime,
+// aggregated over a number of steps.
+class ShapeProfile {
+ public:
+  explicit ShapeProfile(std::vector<string> inputs);
+
+  const std::vector<string>& inputs() const { return inputs_; }
+
+  // Number of steps recorded so far.
+  int64 num_steps() const { return num_steps_; }
+
+  // Records the shapes of all the inputs in one step. Inputs that were not
+  // observed in the step must have an unknown rank.
+  void AddStep(std::vector<TensorShapeProto> shapes);
+
+  // Records the input shapes found in the StepStats of one step, matching
+  // both the input nodes themselves and the `_Arg` and `_Recv` nodes that
+  // replace fed inputs at runtime. Returns false if none of the inputs were
+  // found, in which case the step is ignored.
+  bool AddStepStats(const StepStats& step_stats);
+
+  // Returns up to `max_shapes` distinct input shape combinations that were
+  // observed in at least `min_fraction` of the steps, most frequent first.
+  // The shapes of the inputs that were not observed have an unknown rank.
+  std::vector<std::vector<TensorShapeProto>> CommonShapes(
+      int max_shapes, float min_fraction) const;
+
+ private:
+  struct Entry {
+    std::vector<TensorShapeProto> shapes;
+    int64 count = 0;
+    int64 first_step = 0;
+  };
+
+  std::vector<string> inputs_;
+  int64 num_steps_ = 0;
+  // Keyed by a string representation of the shapes.
+  std::map<string, Entry> entries_;
+};
+
+// ShapeSpecializer duplicates the part of the graph that depends on inputs
+// of a partially known shape once for every input shape combination that is
+// common in an observed shape profile. In each copy the inputs are reshaped
+// to the static shape of the combination, so that other optimizers (constant
+// folding, layout optimizer, remapper) can treat all the shapes of the copy
+// as known. A cheap check of the runtime input shapes selects the copy that
+// runs; inputs of any other shape run the original graph.
+//
+// The optimizer is not enabled by default. It must be registered through
+// RewriterConfig.custom_optimizers with a `run_metadata` parameter that lists
+// files with the serialized RunMetadata of steps run with FULL_TRACE.
+class ShapeSpecializer : public CustomGraphOptimizer {
+ public:
+  ShapeSpecializer() {}
+  ShapeSpecializer(std::vector<StepStats> step_stats, int max_branches,
+                   float min_fraction)
+      : step_stats_(std::move(step_stats)),
+        max_branches_(max_branches),
+        min_fraction_(min_fraction) {}
+  ~ShapeSpecializer() override {}
+
+  string name() const override { return "shape_specializer"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override;
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+
+ private:
+  std::vector<StepStats> step_stats_;
+  // Maximum number of specialized copies of the graph.
+  int max_branches_ = 4;
+  // Minimum fraction of the profiled steps that must have run with a shape
+  // combination for it to get a specialized copy.
+  float min_fraction_ = 0.1;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SHAPE_SPECIALIZER_H_
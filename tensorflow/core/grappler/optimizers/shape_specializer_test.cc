@@ -0,0 +1,184 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/shape_specializer.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ShapeSpecializerTest : public GrapplerTest {};
+
+TensorShapeProto MakeShape(const std::vector<int64>& dims) {
+  TensorShapeProto shape;
+  for (int64 dim : dims) shape.add_dim()->set_size(dim);
+  return shape;
+}
+
+// Returns the StepStats of a step that fed `node_name` with `dims`.
+StepStats MakeStepStats(const string& node_name,
+                        const std::vector<int64>& dims) {
+  StepStats step_stats;
+  NodeExecStats* node_stats = step_stats.add_dev_stats()->add_node_stats();
+  node_stats->set_node_name(node_name);
+  NodeOutput* output = node_stats->add_output();
+  output->set_slot(0);
+  *output->mutable_tensor_description()->mutable_shape() = MakeShape(dims);
+  return step_stats;
+}
+
+TEST_F(ShapeSpecializerTest, CommonShapes) {
+  ShapeProfile profile({"x"});
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(profile.AddStepStats(MakeStepStats("_arg_x_0_0", {2, 4})));
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(profile.AddStepStats(MakeStepStats("_recv_x_0", {8, 4})));
+  }
+  EXPECT_TRUE(profile.AddStepStats(MakeStepStats("x", {3, 4})));
+  EXPECT_FALSE(profile.AddStepStats(MakeStepStats("_arg_y_0_0", {3, 4})));
+  EXPECT_EQ(8, profile.num_steps());
+
+  auto shapes = profile.CommonShapes(4, 0.2);
+  ASSERT_EQ(2, shapes.size());
+  EXPECT_EQ("[8,4]", PartialTensorShape(shapes[0][0]).DebugString());
+  EXPECT_EQ("[2,4]", PartialTensorShape(shapes[1][0]).DebugString());
+
+  shapes = profile.CommonShapes(1, 0.0);
+  ASSERT_EQ(1, shapes.size());
+  EXPECT_EQ("[8,4]", PartialTensorShape(shapes[0][0]).DebugString());
+
+  EXPECT_EQ(3, profile.CommonShapes(4, 0.0).size());
+}
+
+TEST_F(ShapeSpecializerTest, NothingToDoWithoutProfile) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 4}));
+  Output y = ops::Square(s.WithOpName("y"), x);
+
+  GrapplerItem item;
+  item.fetch = {"y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ShapeSpecializer optimizer;
+  TF_EXPECT_OK(optimizer.Init());
+  GraphDef output;
+  EXPECT_TRUE(errors::IsAborted(optimizer.Optimize(nullptr, item, &output)));
+}
+
+TEST_F(ShapeSpecializerTest, SpecializeCommonShapes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 4}));
+  Output sum = ops::Sum(s.WithOpName("sum"), x, {1});
+  Output two = ops::Const(s.WithOpName("two"), 2.0f, {});
+  Output y = ops::Mul(s.WithOpName("y"), sum, two);
+
+  GrapplerItem item;
+  item.fetch = {"y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  std::vector<StepStats> step_stats;
+  for (int i = 0; i < 3; ++i) {
+    step_stats.push_back(MakeStepStats("_arg_x_0_0", {8, 4}));
+  }
+  step_stats.push_back(MakeStepStats("_arg_x_0_0", {1, 4}));
+  step_stats.push_back(MakeStepStats("_arg_x_0_0", {5, 4}));
+
+  ShapeSpecializer optimizer(step_stats, /*max_branches=*/4,
+                             /*min_fraction=*/0.3);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Only [8, 4] is common enough to get a specialized branch.
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "ShapeSpecializer/branch_0/sum") {
+      ++found;
+      EXPECT_EQ("Sum", node.op());
+      EXPECT_EQ("ShapeSpecializer/dispatch/branch_0/x", node.input(0));
+    } else if (node.name() == "ShapeSpecializer/dispatch/branch_0/x") {
+      ++found;
+      EXPECT_EQ("Reshape", node.op());
+      EXPECT_EQ("ShapeSpecializer/dispatch/branch_0/x/switch:1",
+                node.input(0));
+    } else if (node.name() == "sum") {
+      ++found;
+      EXPECT_EQ("ShapeSpecializer/dispatch/branch_0/x/switch",
+                node.input(0));
+    } else if (node.name() == "ShapeSpecializer/merge/y/output_0") {
+      ++found;
+      EXPECT_EQ("Merge", node.op());
+      ASSERT_EQ(2, node.input_size());
+      EXPECT_EQ("ShapeSpecializer/branch_0/y", node.input(0));
+      EXPECT_EQ("ShapeSpecializer/generic/y", node.input(1));
+    } else if (node.name() == "y") {
+      ++found;
+      EXPECT_EQ("Identity", node.op());
+      EXPECT_EQ("ShapeSpecializer/merge/y/output_0", node.input(0));
+    }
+    EXPECT_NE("ShapeSpecializer/branch_1/sum", node.name());
+  }
+  EXPECT_EQ(5, found);
+
+  // The shapes of the specialized branch are statically known.
+  GrapplerItem optimized_item = item.WithGraph(std::move(output));
+  GraphProperties properties(optimized_item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+  const auto& props =
+      properties.GetOutputProperties("ShapeSpecializer/branch_0/sum");
+  ASSERT_EQ(1, props.size());
+  EXPECT_EQ("[8]", PartialTensorShape(props[0].shape()).DebugString());
+
+  // Both the specialized and the generic branch compute the original result.
+  for (int64 batch_size : {8, 3}) {
+    Tensor x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({batch_size, 4}));
+    auto expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+    auto actual =
+        EvaluateNodes(optimized_item.graph, item.fetch, {{"x", x_t}});
+    ASSERT_EQ(1, expected.size());
+    ASSERT_EQ(1, actual.size());
+    test::ExpectTensorNear<float>(expected[0], actual[0], 1e-6);
+  }
+}
+
+TEST_F(ShapeSpecializerTest, DoNotSpecializeStatefulOps) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_INT32,
+                              ops::Placeholder::Shape({-1}));
+  Output y = ops::RandomUniform(s.WithOpName("y"), x, DT_FLOAT);
+
+  GrapplerItem item;
+  item.fetch = {"y"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ShapeSpecializer optimizer({MakeStepStats("_arg_x_0_0", {2})},
+                             /*max_branches=*/4, /*min_fraction=*/0.1);
+  GraphDef output;
+  EXPECT_TRUE(errors::IsAborted(optimizer.Optimize(nullptr, item, &output)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
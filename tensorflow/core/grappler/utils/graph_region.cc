@@ -0,0 +1,284 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/utils/graph_region.h"
+
+#include <deque>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kProxyPrefix[] = "GraphRegion/input/";
+
+// Returns a canonical representation of the tensor or control dependency
+// read by the input `id`.
+string CanonicalInputName(const TensorId& id) {
+  if (id.index() < 0) return AsControlDependency(string(id.node()));
+  if (id.index() == 0) return string(id.node());
+  return strings::StrCat(id.node(), ":", id.index());
+}
+
+}  // namespace
+
+Status ExtractGraphRegion(const GrapplerItem& item,
+                          const std::vector<string>& seeds, int radius,
+                          GraphRegion* region) {
+  const GraphDef& graph = item.graph;
+  std::unordered_map<string, int> node_index;
+  for (int i = 0; i < graph.node_size(); ++i) {
+    node_index[graph.node(i).name()] = i;
+  }
+
+  // Edges are followed in both directions.
+  std::vector<std::vector<int>> neighbors(graph.node_size());
+  for (int i = 0; i < graph.node_size(); ++i) {
+    for (const string& input : graph.node(i).input()) {
+      auto it = node_index.find(NodeName(input));
+      if (it == node_index.end()) {
+        return errors::InvalidArgument("Node ", graph.node(i).name(),
+                                       " has an unknown input ", input);
+      }
+      neighbors[i].push_back(it->second);
+      neighbors[it->second].push_back(i);
+    }
+  }
+
+  std::vector<int> distance(graph.node_size(), -1);
+  std::deque<int> queue;
+  for (const string& seed : seeds) {
+    auto it = node_index.find(seed);
+    if (it == node_index.end()) {
+      return errors::InvalidArgument("Unknown region seed node ", seed);
+    }
+    if (distance[it->second] < 0) {
+      distance[it->second] = 0;
+      queue.push_back(it->second);
+    }
+  }
+  while (!queue.empty()) {
+    const int i = queue.front();
+    queue.pop_front();
+    if (distance[i] >= radius) continue;
+    for (int neighbor : neighbors[i]) {
+      if (distance[neighbor] < 0) {
+        distance[neighbor] = distance[i] + 1;
+        queue.push_back(neighbor);
+      }
+    }
+  }
+
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(graph));
+  // Proxy nodes would hide the control flow dependencies and the frames of
+  // the region nodes from the optimizers.
+  auto check_node = [&frame_view](const NodeDef& node) -> Status {
+    if (IsControlFlow(node) || frame_view.IsInFrame(node)) {
+      return errors::FailedPrecondition(
+          "Can not extract a graph region that contains or reads from the "
+          "control flow node ",
+          node.name());
+    }
+    return Status::OK();
+  };
+
+  region->nodes.clear();
+  region->context_nodes.clear();
+  region->proxies.clear();
+  for (int i = 0; i < graph.node_size(); ++i) {
+    if (distance[i] < 0) continue;
+    TF_RETURN_IF_ERROR(check_node(graph.node(i)));
+    region->nodes.insert(graph.node(i).name());
+  }
+
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             graph.library());
+  GraphDef region_graph;
+  *region_graph.mutable_versions() = graph.versions();
+  *region_graph.mutable_library() = graph.library();
+
+  std::unordered_map<string, string> input_proxies;
+  std::vector<int> context_nodes;
+  for (int i = 0; i < graph.node_size(); ++i) {
+    if (distance[i] < 0) continue;
+    NodeDef* node = region_graph.add_node();
+    *node = graph.node(i);
+    for (string& input : *node->mutable_input()) {
+      const TensorId id = ParseTensorName(input);
+      const string source_name(id.node());
+      const int index = id.index();
+      if (region->nodes.count(source_name) > 0) continue;
+
+      const int source_index = node_index[source_name];
+      const NodeDef& source = graph.node(source_index);
+      TF_RETURN_IF_ERROR(check_node(source));
+      if (source.input_size() == 0) {
+        if (region->context_nodes.insert(source_name).second) {
+          context_nodes.push_back(source_index);
+        }
+        continue;
+      }
+
+      const string canonical_input = CanonicalInputName(id);
+      auto it = input_proxies.find(canonical_input);
+      if (it == input_proxies.end()) {
+        const string proxy_name = strings::StrCat(
+            kProxyPrefix, source_name,
+            index < 0 ? "/control" : strings::StrCat("/output_", index));
+        if (node_index.count(proxy_name) > 0) {
+          return errors::AlreadyExists("Graph already has a node named ",
+                                       proxy_name);
+        }
+        NodeDef* proxy = region_graph.add_node();
+        proxy->set_name(proxy_name);
+        proxy->set_device(source.device());
+        if (index < 0) {
+          proxy->set_op("NoOp");
+        } else {
+          const OpDef* op_def = nullptr;
+          TF_RETURN_IF_ERROR(
+              function_library.LookUpOpDef(source.op(), &op_def));
+          DataTypeVector output_types;
+          TF_RETURN_IF_ERROR(
+              OutputTypesForNode(source, *op_def, &output_types));
+          if (index >= output_types.size()) {
+            return errors::InvalidArgument("Node ", node->name(),
+                                           " reads from a missing output ",
+                                           input);
+          }
+          proxy->set_op("Placeholder");
+          SetAttrValue(output_types[index], &(*proxy->mutable_attr())["dtype"]);
+          SetAttrValue(PartialTensorShape(),
+                       &(*proxy->mutable_attr())["shape"]);
+        }
+        it = input_proxies.emplace(canonical_input, proxy_name).first;
+        region->proxies[proxy_name] = canonical_input;
+      }
+      input = index < 0 ? AsControlDependency(it->second) : it->second;
+    }
+  }
+  for (int i : context_nodes) *region_graph.add_node() = graph.node(i);
+
+  // The region nodes that the rest of the graph reads from must be fetched.
+  std::unordered_set<string> fetch_nodes;
+  for (int i = 0; i < graph.node_size(); ++i) {
+    if (distance[i] >= 0) continue;
+    for (const string& input : graph.node(i).input()) {
+      const string name = NodeName(input);
+      if (region->nodes.count(name) > 0) fetch_nodes.insert(name);
+    }
+  }
+
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  region->item = item.WithGraph(std::move(region_graph));
+  GrapplerItem& region_item = region->item;
+  region_item.fetch.clear();
+  region_item.feed.clear();
+  region_item.init_ops.clear();
+  region_item.keep_ops.clear();
+  region_item.save_op.clear();
+  region_item.restore_op.clear();
+  region_item.save_restore_loc_tensor.clear();
+  region_item.queue_runners.clear();
+
+  for (const string& fetch : item.fetch) {
+    if (region->nodes.count(NodeName(fetch)) > 0) {
+      region_item.fetch.push_back(fetch);
+      fetch_nodes.erase(NodeName(fetch));
+    }
+  }
+  for (const auto& feed : item.feed) {
+    if (region->nodes.count(NodeName(feed.first)) > 0) {
+      region_item.feed.push_back(feed);
+    }
+  }
+  for (int i = 0; i < graph.node_size(); ++i) {
+    if (distance[i] < 0) continue;
+    const string& name = graph.node(i).name();
+    if (fetch_nodes.count(name) > 0) {
+      region_item.fetch.push_back(name);
+    } else if (nodes_to_preserve.count(name) > 0) {
+      region_item.keep_ops.push_back(name);
+    }
+  }
+  for (int i : context_nodes) {
+    region_item.keep_ops.push_back(graph.node(i).name());
+  }
+
+  return Status::OK();
+}
+
+Status SpliceGraphRegion(const GraphRegion& region,
+                         const GraphDef& optimized_region, GraphDef* graph) {
+  GraphDef spliced;
+  *spliced.mutable_versions() = graph->versions();
+  *spliced.mutable_library() = optimized_region.library();
+
+  std::unordered_set<string> node_names;
+  for (const NodeDef& node : graph->node()) {
+    if (region.nodes.count(node.name()) > 0) continue;
+    node_names.insert(node.name());
+    *spliced.add_node() = node;
+  }
+
+  for (const NodeDef& node : optimized_region.node()) {
+    if (region.proxies.count(node.name()) > 0 ||
+        region.context_nodes.count(node.name()) > 0) {
+      continue;
+    }
+    if (!node_names.insert(node.name()).second) {
+      return errors::AlreadyExists("Node ", node.name(),
+                                   " of the optimized region already exists "
+                                   "in the graph");
+    }
+    NodeDef* spliced_node = spliced.add_node();
+    *spliced_node = node;
+    for (string& input : *spliced_node->mutable_input()) {
+      const TensorId id = ParseTensorName(input);
+      auto it = region.proxies.find(string(id.node()));
+      if (it == region.proxies.end()) continue;
+      input = id.index() < 0 ? AsControlDependency(NodeName(it->second))
+                             : it->second;
+    }
+  }
+
+  for (const NodeDef& node : spliced.node()) {
+    for (const string& input : node.input()) {
+      if (node_names.count(NodeName(input)) == 0) {
+        return errors::FailedPrecondition(
+            "Node ", node.name(), " reads from ", input,
+            ", which is not defined by the optimized region");
+      }
+    }
+  }
+
+  graph->Swap(&spliced);
+  return Status::OK();
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
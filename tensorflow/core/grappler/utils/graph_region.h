@@ -0,0 +1,73 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_UTILS_GRAPH_REGION_H_
+#define TENSORFLOW_CORE_GRAPPLER_UTILS_GRAPH_REGION_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A region of the graph of a GrapplerItem, extracted as a standalone
+// GrapplerItem so that it can be optimized on its own, and then spliced back
+// into the graph.
+//
+// The tensors that flow into the region from the rest of the graph are fed by
+// proxy nodes: a Placeholder per tensor and a NoOp per control dependency.
+// Source nodes with no inputs at all (e.g. constants) are copied verbatim
+// instead, so that optimizers can still look at their values. The region
+// nodes that are read by the rest of the graph are fetched, and all the
+// region nodes that the original item preserves are kept, so optimizing the
+// region preserves the semantics of the whole graph.
+struct GraphRegion {
+  // The region as a standalone item.
+  GrapplerItem item;
+  // Names of the nodes of the original graph that are part of the region.
+  std::unordered_set<string> nodes;
+  // Names of the source nodes that were copied into the region item as
+  // read-only context.
+  std::unordered_set<string> context_nodes;
+  // Maps the proxy node names to the tensor (or control dependency) of the
+  // original graph that they stand for.
+  std::unordered_map<string, string> proxies;
+};
+
+// Extracts the region of `item.graph` made of the `seeds` nodes and of all
+// the nodes within `radius` edges from them, following edges in both
+// directions. Returns an error if the region can not be represented as a
+// standalone graph, e.g. because it contains control flow whose frames would
+// be cut.
+Status ExtractGraphRegion(const GrapplerItem& item,
+                          const std::vector<string>& seeds, int radius,
+                          GraphRegion* region);
+
+// Replaces the region nodes in `graph`, which must be the graph the region
+// was extracted from, with the nodes of `optimized_region`, and rewires them
+// to read from the rest of the graph instead of the proxy nodes. The function
+// library of `graph` is replaced with the one of `optimized_region`.
+Status SpliceGraphRegion(const GraphRegion& region,
+                         const GraphDef& optimized_region, GraphDef* graph);
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_UTILS_GRAPH_REGION_H_
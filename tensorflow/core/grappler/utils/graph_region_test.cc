@@ -0,0 +1,149 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/utils/graph_region.h"
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using ::tensorflow::test::function::NDef;
+
+// a -> b -> c -> d -> e <- k
+GrapplerItem MakeChain() {
+  GrapplerItem item;
+  item.graph = ::tensorflow::test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("b", "Square", {"a"}, {{"T", DT_FLOAT}}),
+       NDef("c", "Square", {"b"}, {{"T", DT_FLOAT}}),
+       NDef("d", "Square", {"c", "^b"}, {{"T", DT_FLOAT}}),
+       NDef("k", "Const", {}, {{"dtype", DT_FLOAT}, {"value", 2.0f}}),
+       NDef("e", "Mul", {"d", "k"}, {{"T", DT_FLOAT}})},
+      /*funcs=*/{});
+  item.fetch = {"e"};
+  return item;
+}
+
+const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) return &node;
+  }
+  return nullptr;
+}
+
+TEST(GraphRegionTest, ExtractRegion) {
+  GrapplerItem item = MakeChain();
+  GraphRegion region;
+  TF_ASSERT_OK(ExtractGraphRegion(item, {"d", "e"}, 0, &region));
+
+  EXPECT_EQ(std::unordered_set<string>({"d", "e"}), region.nodes);
+  EXPECT_EQ(std::unordered_set<string>({"k"}), region.context_nodes);
+  EXPECT_EQ(std::vector<string>({"e"}), region.item.fetch);
+  EXPECT_EQ(std::vector<string>({"k"}), region.item.keep_ops);
+
+  // d reads from c and b, which are outside of the region.
+  const NodeDef* d = FindNode(region.item.graph, "d");
+  ASSERT_NE(nullptr, d);
+  EXPECT_EQ("GraphRegion/input/c/output_0", d->input(0));
+  EXPECT_EQ("^GraphRegion/input/b/control", d->input(1));
+
+  const NodeDef* proxy =
+      FindNode(region.item.graph, "GraphRegion/input/c/output_0");
+  ASSERT_NE(nullptr, proxy);
+  EXPECT_EQ("Placeholder", proxy->op());
+  EXPECT_EQ(DT_FLOAT, proxy->attr().at("dtype").type());
+  proxy = FindNode(region.item.graph, "GraphRegion/input/b/control");
+  ASSERT_NE(nullptr, proxy);
+  EXPECT_EQ("NoOp", proxy->op());
+
+  EXPECT_EQ("c", region.proxies.at("GraphRegion/input/c/output_0"));
+  EXPECT_EQ("^b", region.proxies.at("GraphRegion/input/b/control"));
+  EXPECT_NE(nullptr, FindNode(region.item.graph, "k"));
+  EXPECT_EQ(nullptr, FindNode(region.item.graph, "c"));
+
+  // The rest of the graph reads from c, so it is fetched from the region.
+  TF_ASSERT_OK(ExtractGraphRegion(item, {"c"}, 0, &region));
+  EXPECT_EQ(std::vector<string>({"c"}), region.item.fetch);
+}
+
+TEST(GraphRegionTest, SpliceRegion) {
+  GrapplerItem item = MakeChain();
+  GraphRegion region;
+  TF_ASSERT_OK(ExtractGraphRegion(item, {"e"}, 1, &region));
+  EXPECT_EQ(std::unordered_set<string>({"d", "e", "k"}), region.nodes);
+
+  // Pretend that an optimizer fused d into e.
+  GraphDef optimized_region = region.item.graph;
+  GraphDef fused;
+  for (const NodeDef& node : optimized_region.node()) {
+    if (node.name() == "d") continue;
+    NodeDef* new_node = fused.add_node();
+    *new_node = node;
+    if (node.name() == "e") {
+      new_node->set_op("SquareMul");
+      new_node->set_input(0, "GraphRegion/input/c/output_0");
+      new_node->add_input("^GraphRegion/input/b/control");
+    }
+  }
+
+  GraphDef graph = item.graph;
+  TF_ASSERT_OK(SpliceGraphRegion(region, fused, &graph));
+  EXPECT_EQ(5, graph.node_size());
+  EXPECT_EQ(nullptr, FindNode(graph, "d"));
+  const NodeDef* e = FindNode(graph, "e");
+  ASSERT_NE(nullptr, e);
+  EXPECT_EQ("SquareMul", e->op());
+  ASSERT_EQ(3, e->input_size());
+  EXPECT_EQ("c", e->input(0));
+  EXPECT_EQ("k", e->input(1));
+  EXPECT_EQ("^b", e->input(2));
+}
+
+TEST(GraphRegionTest, SpliceRejectsNameCollisions) {
+  GrapplerItem item = MakeChain();
+  GraphRegion region;
+  TF_ASSERT_OK(ExtractGraphRegion(item, {"e"}, 1, &region));
+
+  GraphDef optimized_region = region.item.graph;
+  *optimized_region.add_node() = NDef("a", "NoOp", {}, {});
+
+  GraphDef graph = item.graph;
+  EXPECT_TRUE(errors::IsAlreadyExists(
+      SpliceGraphRegion(region, optimized_region, &graph)));
+}
+
+TEST(GraphRegionTest, RejectControlFlow) {
+  GrapplerItem item;
+  item.graph = ::tensorflow::test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("p", "Placeholder", {}, {{"dtype", DT_BOOL}}),
+       NDef("switch", "Switch", {"x", "p"}, {{"T", DT_FLOAT}}),
+       NDef("y", "Square", {"switch:1"}, {{"T", DT_FLOAT}})},
+      /*funcs=*/{});
+
+  GraphRegion region;
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      ExtractGraphRegion(item, {"y"}, 0, &region)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
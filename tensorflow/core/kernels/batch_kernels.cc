@@ -20,15 +20,19 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/concat_lib.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -38,6 +42,17 @@ typedef Eigen::GpuDevice GPUDevice;
 typedef Eigen::SyclDevice SYCLDevice;
 #endif  // TENSORFLOW_USE_SYCL
 
+namespace {
+
+auto* batch_padding_fraction = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/batching/padding_fraction",
+     "The fraction of the rows of the batches that are padding added to reach "
+     "an allowed batch size."},
+    {monitoring::Buckets::Explicit(
+        {0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9})});
+
+}  // namespace
+
 // Concatenates 'inputs' into a single tensor along the zeroth dimension.
 // Requires that all elements of 'inputs' have element type T. Writes to the
 // op's output at position 'output_index', using 'context' for the allocation to
@@ -208,27 +223,79 @@ Status Split(OpKernelContext* context, const Tensor& input,
   return SplitCPU<T>(context, input, sizes, outputs);
 }
 
+// Calls Concat<T>() for the element type of 'inputs'.
+Status ConcatTensors(OpKernelContext* context,
+                     const gtl::ArraySlice<Tensor>& inputs, Tensor* output) {
+  const DataType type = inputs[0].dtype();
+  switch (type) {
+#define CASE(type)                   \
+  case DataTypeToEnum<type>::value:  \
+    return Concat<type>(context, inputs, output);
+    TF_CALL_ALL_TYPES(CASE);
+#undef CASE
+    default:
+      return errors::InvalidArgument("Unsupported data type: ", type);
+  }
+}
+
+// Calls Split<T>() for the element type of 'input'. Where the splits are
+// aligned, they share the buffer of 'input'.
+Status SplitTensor(OpKernelContext* context, const Tensor& input,
+                   const gtl::ArraySlice<int64>& sizes,
+                   std::vector<Tensor>* outputs) {
+  const DataType type = input.dtype();
+  switch (type) {
+#define CASE(type)                  \
+  case DataTypeToEnum<type>::value: \
+    return Split<type>(context, input, sizes, outputs);
+    TF_CALL_ALL_TYPES(CASE);
+#undef CASE
+    default:
+      return errors::InvalidArgument("Unsupported data type: ", type);
+  }
+}
+
 // A class encapsulating the state and logic for batching tensors.
 class BatchResource : public ResourceBase {
  public:
+  // If 'device_name' is set and TF_BATCH_FUNCTION_DEVICE_IN_FLIGHT_BATCHES is
+  // positive, the batches of the function 'fhandle' are processed by the
+  // scheduler shared by all the resources of the device (see
+  // GetDeviceBatcher()) rather than by 'num_batch_threads' threads of their
+  // own.
   static Status Create(int32 num_batch_threads, int32 max_batch_size,
                        int32 batch_timeout_micros, int32 max_enqueued_batches,
                        const std::vector<int32>& allowed_batch_sizes,
                        FunctionLibraryRuntime::Handle fhandle,
+                       const string& device_name,
                        std::unique_ptr<BatchResource>* resource) {
     std::unique_ptr<BatchResource> new_resource(new BatchResource);
 
-    Batcher::Options batcher_options;
-    batcher_options.num_batch_threads = num_batch_threads;
-    TF_RETURN_IF_ERROR(
-        Batcher::Create(batcher_options, &new_resource->batcher_));
-
     new_resource->batcher_queue_options_.max_batch_size = max_batch_size;
     new_resource->batcher_queue_options_.max_enqueued_batches =
         max_enqueued_batches;
     new_resource->batcher_queue_options_.batch_timeout_micros =
         batch_timeout_micros;
 
+    int64 device_in_flight_batches = 0;
+    if (fhandle != kInvalidHandle && !device_name.empty()) {
+      TF_RETURN_IF_ERROR(
+          ReadInt64FromEnvVar("TF_BATCH_FUNCTION_DEVICE_IN_FLIGHT_BATCHES", 0,
+                              &device_in_flight_batches));
+    }
+    if (device_in_flight_batches > 0) {
+      TF_RETURN_IF_ERROR(GetDeviceBatcher(device_name,
+                                          device_in_flight_batches,
+                                          &new_resource->device_batcher_));
+      new_resource->device_batcher_queue_options_ =
+          GetDeviceBatcherQueueOptions(new_resource->batcher_queue_options_);
+    } else {
+      Batcher::Options batcher_options;
+      batcher_options.num_batch_threads = num_batch_threads;
+      TF_RETURN_IF_ERROR(
+          Batcher::Create(batcher_options, &new_resource->batcher_));
+    }
+
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
 
     new_resource->fhandle_ = fhandle;
@@ -275,15 +342,39 @@ class BatchResource : public ResourceBase {
     batch_components->done_callback = std::move(done_callback);
 
     BatcherQueue* batcher_queue;
-    TF_RETURN_IF_ERROR(
-        LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+    TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
+        batcher_queue_name, InnerShapesKey(*batch_components),
+        &batcher_queue));
+    if (fhandle_ != kInvalidHandle &&
+        static_cast<int64>(batch_components->size()) >
+            batcher_queue_options_.max_batch_size) {
+      return ScheduleSplitTasks(std::move(batch_components), batcher_queue);
+    }
     return batcher_queue->Schedule(&batch_components);
   }
 
  private:
   BatchResource() = default;
 
-  // One input to be batched. Corresponds to one invocation of the batch op.
+  // The state shared by the tasks split off an input larger than the maximum
+  // batch size. Once they all ran, their outputs are concatenated into the
+  // outputs of the batch op invocation.
+  struct SplitInputState {
+    OpKernelContext* context;
+    AsyncOpKernel::DoneCallback done_callback;
+    // The outputs of each task, indexed by BatchTask::split_index. Each task
+    // only writes its own entry, before it is done.
+    std::vector<std::vector<Tensor>> outputs;
+
+    mutex mu;
+    // The first error of the tasks.
+    Status status GUARDED_BY(mu);
+    int num_pending_tasks GUARDED_BY(mu);
+  };
+
+  // One input to be batched. Corresponds to one invocation of the batch op, or
+  // to a part of the input of an invocation whose input is larger than the
+  // maximum batch size.
   struct BatchTask : public serving::BatchTask {
     // A unique ID to identify this invocation of Batch.
     int64 guid;
@@ -295,13 +386,58 @@ class BatchResource : public ResourceBase {
     OpKernelContext* context;
     AsyncOpKernel::DoneCallback done_callback;
 
+    // Set if this task is a part of a larger input, see SplitInputState.
+    std::shared_ptr<SplitInputState> split_state;
+    int split_index = 0;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
   };
 
   using Batcher = serving::SharedBatchScheduler<BatchTask>;
+  using DeviceBatcher = serving::AdaptiveSharedBatchScheduler<BatchTask>;
   using BatcherQueue = serving::BatchScheduler<BatchTask>;
   using Batch = serving::Batch<BatchTask>;
 
+  // Returns the scheduler of the batches of the resources of 'device_name',
+  // processing at most 'in_flight_batches' of them at once. It interleaves the
+  // batches of all the models placed on the device by age, so that a model
+  // doesn't block the others by launching batches independently of them. The
+  // scheduler lives as long as resources use it.
+  static Status GetDeviceBatcher(const string& device_name,
+                                 int64 in_flight_batches,
+                                 std::shared_ptr<DeviceBatcher>* batcher) {
+    static mutex* mu = new mutex;
+    static auto* batchers =
+        new std::map<string, std::weak_ptr<DeviceBatcher>>;
+    mutex_lock l(*mu);
+    std::weak_ptr<DeviceBatcher>& entry = (*batchers)[device_name];
+    *batcher = entry.lock();
+    if (*batcher != nullptr) return Status::OK();
+
+    DeviceBatcher::Options options;
+    options.thread_pool_name = "device_batch_threads";
+    options.num_batch_threads = in_flight_batches;
+    options.initial_in_flight_batches_limit = in_flight_batches;
+    options.min_in_flight_batches_limit = in_flight_batches;
+    TF_RETURN_IF_ERROR(DeviceBatcher::Create(options, batcher));
+    entry = *batcher;
+    return Status::OK();
+  }
+
+  // Returns the options of the queues of a resource on the device scheduler,
+  // given those it would use on a scheduler of its own. Every option is
+  // carried over, since the rest of the resource, e.g. the splitting of
+  // inputs larger than the maximum batch size, relies on
+  // 'batcher_queue_options_' whichever scheduler is used.
+  static DeviceBatcher::QueueOptions GetDeviceBatcherQueueOptions(
+      const Batcher::QueueOptions& options) {
+    DeviceBatcher::QueueOptions device_options;
+    device_options.max_batch_size = options.max_batch_size;
+    device_options.max_enqueued_batches = options.max_enqueued_batches;
+    device_options.batch_timeout_micros = options.batch_timeout_micros;
+    return device_options;
+  }
+
   // Validates that it's legal to combine the tasks in 'batch' into a batch.
   // Assumes the batch is non-empty.
   static Status ValidateBatch(const Batch& batch) {
@@ -342,6 +478,10 @@ class BatchResource : public ResourceBase {
 
     const int padded_batch_size = RoundToLowestAllowedBatchSize(batch.size());
     const int padding_amount = padded_batch_size - batch.size();
+    if (padded_batch_size > 0) {
+      batch_padding_fraction->GetCell()->Add(
+          static_cast<double>(padding_amount) / padded_batch_size);
+    }
 
     // All tasks should have the same number of input edges.
     const int num_inputs = batch.task(0).inputs.size();
@@ -389,28 +529,22 @@ class BatchResource : public ResourceBase {
         }
       }
 
-      const DataType type = to_concatenate[0].dtype();
-      Status concat_status;
-      Tensor concatenated_tensor;
-      switch (type) {
-#define CASE(type)                                                   \
-  case DataTypeToEnum<type>::value:                                  \
-    concat_status =                                                  \
-        Concat<type>(context, to_concatenate, &concatenated_tensor); \
-    break;
-        TF_CALL_ALL_TYPES(CASE);
-#undef CASE
-        default:
-          concat_status =
-              errors::InvalidArgument("Unsupported data type: ", type);
-          break;
+      // A single task without padding is passed as is.
+      if (to_concatenate.size() == 1) {
+        concatenated_tensors->push_back(to_concatenate[0]);
+        continue;
       }
-      TF_RETURN_IF_ERROR(concat_status);
+      Tensor concatenated_tensor;
+      TF_RETURN_IF_ERROR(
+          ConcatTensors(context, to_concatenate, &concatenated_tensor));
       concatenated_tensors->push_back(concatenated_tensor);
     }
     return Status::OK();
   }
 
+  // Sets the outputs of the tasks of 'batch' to their rows of
+  // 'combined_outputs'. The aligned rows share the buffers of
+  // 'combined_outputs' rather than being copied.
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
                             Batch* batch) const {
     DCHECK_GE(batch->num_tasks(), 1);
@@ -452,8 +586,9 @@ class BatchResource : public ResourceBase {
       }
 
       std::vector<Tensor> split_tensor;
-      const Status split_status = tensor::Split(
-          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+      const Status split_status =
+          SplitTensor(batch->task(0).context, output_tensor,
+                      task_sizes_plus_optional_padding, &split_tensor);
       DCHECK(split_status.ok()) << split_status.ToString();
       if (!split_status.ok()) {
         return errors::Internal("Tensor split operation failed: ",
@@ -469,7 +604,11 @@ class BatchResource : public ResourceBase {
 
       for (int j = 0; j < batch->num_tasks(); ++j) {
         BatchTask& task = *(batch->mutable_task(j));
-        task.context->set_output(i, split_tensor.at(j));
+        if (task.split_state != nullptr) {
+          task.split_state->outputs[task.split_index][i] = split_tensor.at(j);
+        } else {
+          task.context->set_output(i, split_tensor.at(j));
+        }
       }  // (Ignore a possible final split_tensors entry containing the
          // padding.)
     }
@@ -477,6 +616,89 @@ class BatchResource : public ResourceBase {
     return Status::OK();
   }
 
+  // Splits 'task', whose input is larger than the maximum batch size, into
+  // tasks of at most the maximum batch size, and schedules them on 'queue'.
+  // The batch op invocation is done when they all are.
+  Status ScheduleSplitTasks(std::unique_ptr<BatchTask> task,
+                            BatcherQueue* queue) {
+    const int64 max_batch_size = batcher_queue_options_.max_batch_size;
+    std::vector<int64> split_sizes;
+    for (int64 remaining = task->size(); remaining > 0;
+         remaining -= max_batch_size) {
+      split_sizes.push_back(std::min(remaining, max_batch_size));
+    }
+    std::vector<std::vector<Tensor>> split_inputs(split_sizes.size());
+    for (const Tensor& input : task->inputs) {
+      std::vector<Tensor> splits;
+      TF_RETURN_IF_ERROR(
+          SplitTensor(task->context, input, split_sizes, &splits));
+      for (int i = 0; i < splits.size(); ++i) {
+        split_inputs[i].push_back(std::move(splits[i]));
+      }
+    }
+
+    auto state = std::make_shared<SplitInputState>();
+    state->context = task->context;
+    state->done_callback = std::move(task->done_callback);
+    state->outputs.assign(
+        split_sizes.size(),
+        std::vector<Tensor>(task->context->num_outputs()));
+    state->num_pending_tasks = split_sizes.size();
+
+    for (int i = 0; i < split_sizes.size(); ++i) {
+      std::unique_ptr<BatchTask> split_task(new BatchTask);
+      split_task->guid = task->guid;
+      split_task->propagated_context = task->propagated_context;
+      split_task->inputs = std::move(split_inputs[i]);
+      split_task->captured_inputs = task->captured_inputs;
+      split_task->context = task->context;
+      split_task->done_callback = [state]() { FinishSplitTask(state.get()); };
+      split_task->split_state = state;
+      split_task->split_index = i;
+      const Status status = queue->Schedule(&split_task);
+      if (!status.ok()) {
+        // The remaining tasks are never scheduled; fail them here.
+        mutex_lock l(state->mu);
+        state->status.Update(status);
+        state->num_pending_tasks -= split_sizes.size() - i - 1;
+        if (split_task != nullptr) {
+          // Not taken by the queue.
+          --state->num_pending_tasks;
+        }
+        if (state->num_pending_tasks > 0) return Status::OK();
+        // The op invocation is finished by the caller with 'status'.
+        state->done_callback = nullptr;
+        return status;
+      }
+    }
+    return Status::OK();
+  }
+
+  // Called when a task split off a larger input is done. Once they all are,
+  // concatenates their outputs into the outputs of the batch op invocation.
+  static void FinishSplitTask(SplitInputState* state) {
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      if (--state->num_pending_tasks > 0) return;
+      status = state->status;
+    }
+    if (state->done_callback == nullptr) return;
+    OpKernelContext* context = state->context;
+    for (int i = 0; status.ok() && i < context->num_outputs(); ++i) {
+      std::vector<Tensor> to_concatenate;
+      to_concatenate.reserve(state->outputs.size());
+      for (const std::vector<Tensor>& outputs : state->outputs) {
+        to_concatenate.push_back(outputs[i]);
+      }
+      Tensor output;
+      status = ConcatTensors(context, to_concatenate, &output);
+      if (status.ok()) context->set_output(i, output);
+    }
+    context->SetStatus(status);
+    state->done_callback();
+  }
+
   void ProcessFuncBatch(std::unique_ptr<Batch> batch) const {
     if (batch->empty()) {
       return;
@@ -500,8 +722,14 @@ class BatchResource : public ResourceBase {
         return;
       }
       for (int i = 0; i < batch->num_tasks(); ++i) {
-        batch->mutable_task(i)->context->SetStatus(status);
-        batch->mutable_task(i)->done_callback();
+        BatchTask* task = batch->mutable_task(i);
+        if (task->split_state != nullptr) {
+          mutex_lock l(task->split_state->mu);
+          task->split_state->status.Update(status);
+        } else {
+          task->context->SetStatus(status);
+        }
+        task->done_callback();
       }
       cleanup_done = true;
     };
@@ -659,13 +887,39 @@ class BatchResource : public ResourceBase {
     return Status::OK();
   }
 
-  // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
-  // creates it.
+  // Returns the shapes of the inputs of 'task' without their 0th dimension.
+  // Only the tasks with the same inner shapes can be concatenated in a batch.
+  static string InnerShapesKey(const BatchTask& task) {
+    std::vector<string> shapes;
+    shapes.reserve(task.inputs.size());
+    for (const Tensor& input : task.inputs) {
+      TensorShape inner_shape = input.shape();
+      inner_shape.RemoveDim(0);
+      shapes.push_back(inner_shape.DebugString());
+    }
+    return str_util::Join(shapes, ",");
+  }
+
+  // Looks up the batcher queue for 'queue_name' and the tasks with inner
+  // shapes 'inner_shapes_key'. If it didn't previously exist, creates it.
+  //
+  // The tasks of a queue are batched separately for each inner shape, e.g.
+  // for each sequence length of padded requests, since only the tasks with
+  // the same inner shapes can be concatenated. Beyond kMaxInnerShapesPerQueue
+  // inner shapes, the tasks of the other shapes share a single queue.
   Status LookupOrCreateBatcherQueue(const string& queue_name,
+                                    const string& inner_shapes_key,
                                     BatcherQueue** queue) {
+    static constexpr int kMaxInnerShapesPerQueue = 64;
     mutex_lock l(batcher_queues_mu_);
 
-    auto it = batcher_queues_.find(queue_name);
+    string key = strings::StrCat(queue_name, "/", inner_shapes_key);
+    auto it = batcher_queues_.find(key);
+    if (it == batcher_queues_.end() &&
+        num_inner_shapes_[queue_name] >= kMaxInnerShapesPerQueue) {
+      key = queue_name;
+      it = batcher_queues_.find(key);
+    }
     if (it != batcher_queues_.end()) {
       *queue = it->second.get();
       return Status::OK();
@@ -679,23 +933,35 @@ class BatchResource : public ResourceBase {
         ProcessFuncBatch(std::move(batch));
       }
     };
-    TF_RETURN_IF_ERROR(batcher_->AddQueue(batcher_queue_options_,
-                                          process_batch_callback, &new_queue));
+    if (device_batcher_ != nullptr) {
+      TF_RETURN_IF_ERROR(device_batcher_->AddQueue(
+          device_batcher_queue_options_, process_batch_callback, &new_queue));
+    } else {
+      TF_RETURN_IF_ERROR(batcher_->AddQueue(
+          batcher_queue_options_, process_batch_callback, &new_queue));
+    }
     *queue = new_queue.get();
-    batcher_queues_[queue_name] = std::move(new_queue);
+    batcher_queues_[key] = std::move(new_queue);
+    if (key != queue_name) ++num_inner_shapes_[queue_name];
     return Status::OK();
   }
 
   // A batch scheduler, and options for creating queues.
   std::shared_ptr<Batcher> batcher_;
   Batcher::QueueOptions batcher_queue_options_;
+  // If set, the scheduler shared with the other resources of the device, used
+  // instead of 'batcher_'.
+  std::shared_ptr<DeviceBatcher> device_batcher_;
+  DeviceBatcher::QueueOptions device_batcher_queue_options_;
 
-  // A collection of batcher queues, keyed on queue name.
+  // A collection of batcher queues, keyed on queue name and inner shapes.
   // TODO(olston): Garbage-collect unused queues (perhaps simply remove empty
   // ones (with a time delay?); it's okay if they get recreated later).
   mutable mutex batcher_queues_mu_;
   std::map<string, std::unique_ptr<BatcherQueue>> batcher_queues_
       GUARDED_BY(batcher_queues_mu_);
+  // The number of inner shapes with their own queue, keyed on queue name.
+  std::map<string, int> num_inner_shapes_ GUARDED_BY(batcher_queues_mu_);
 
   std::vector<int32> allowed_batch_sizes_;
   FunctionLibraryRuntime::Handle fhandle_;
@@ -733,12 +999,13 @@ class BatchFunctionKernel : public AsyncOpKernel {
 
   void ComputeAsync(OpKernelContext* c, DoneCallback done) final {
     BatchResource* br;
-    std::function<Status(BatchResource**)> creator = [this](BatchResource** r) {
+    std::function<Status(BatchResource**)> creator = [this,
+                                                      c](BatchResource** r) {
       std::unique_ptr<BatchResource> new_resource;
-      TF_RETURN_IF_ERROR(
-          BatchResource::Create(num_batch_threads_, max_batch_size_,
-                                batch_timeout_micros_, max_enqueued_batches_,
-                                allowed_batch_sizes_, fhandle_, &new_resource));
+      TF_RETURN_IF_ERROR(BatchResource::Create(
+          num_batch_threads_, max_batch_size_, batch_timeout_micros_,
+          max_enqueued_batches_, allowed_batch_sizes_, fhandle_,
+          c->device()->name(), &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -818,7 +1085,7 @@ class BatchKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle,
-          &new_resource));
+          /*device_name=*/"", &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/bfloat16_conversion.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -248,6 +249,28 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
   }
 };
 
+// There is no bfloat16 contraction kernel, so bfloat16 batch matmuls are
+// computed in float like MatMul does, with the conversions sharded.
+template <>
+struct LaunchBatchMatMul<CPUDevice, bfloat16> {
+  static void Launch(OpKernelContext* context, const Tensor& in_x,
+                     const Tensor& in_y, bool adj_x, bool adj_y,
+                     const MatMulBCast& bcast, Tensor* out) {
+    Tensor in_x_float, in_y_float, out_float;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_FLOAT, in_x.shape(), &in_x_float));
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_FLOAT, in_y.shape(), &in_y_float));
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_FLOAT, out->shape(), &out_float));
+    ParallelBFloat16ToFloat(context, in_x, &in_x_float);
+    ParallelBFloat16ToFloat(context, in_y, &in_y_float);
+    LaunchBatchMatMul<CPUDevice, float>::Launch(
+        context, in_x_float, in_y_float, adj_x, adj_y, bcast, &out_float);
+    ParallelFloatToBFloat16(context, out_float, out);
+  }
+};
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 namespace {
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_ADAPTIVE_SHARED_BATCH_SCHEDULER_H_
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <random>
@@ -112,6 +113,16 @@ class AdaptiveSharedBatchScheduler
     // numbers will give less noisy latency measurements, but will be less
     // responsive to changes in workload.
     int64 batches_to_average_over = 1000;
+    // Target for the 99th percentile of the batch latency, from the creation of
+    // a batch to the end of its processing.  When positive, the maximum size
+    // and the timeout of the batches of every queue are scaled by
+    // batch_size_scale_, adjusted along with in_flight_batches_limit_: it
+    // decreases while the 99th percentile is above the target, and increases
+    // back toward 1 (i.e. the QueueOptions values) while it is well below, so
+    // that batches are as large as the target allows.  Zero disables it.
+    int64 latency_target_micros = 0;
+    // Lower bound for batch_size_scale_.
+    double min_batch_size_scale = 0.0625;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -143,6 +154,8 @@ class AdaptiveSharedBatchScheduler
     return in_flight_batches_limit_;
   }
 
+  double batch_size_scale() const { return batch_size_scale_.load(); }
+
  private:
   // access to AddBatch, RemoveQueue, GetEnv.
   friend class internal::ASBSQueue<TaskType>;
@@ -153,6 +166,10 @@ class AdaptiveSharedBatchScheduler
   void CallbackWrapper(const internal::ASBSBatch<TaskType>* batch,
                        BatchProcessor callback, bool is_express);
 
+  // Adjusts batch_size_scale_ to the 99th percentile of
+  // batch_latencies_micros_.
+  void AdjustBatchSizeScale() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Schedules batch if in_flight_batches_limit_ is not met.
   void MaybeScheduleNextBatch() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -219,6 +236,19 @@ class AdaptiveSharedBatchScheduler
   // Current adjustment size (as a fraction of in_flight_batches_limit_).
   double step_size_multiplier_ GUARDED_BY(mu_) = kMaxStepSizeMultiplier;
 
+  // Fields controlling the dynamic adjustment of batch_size_scale_.
+  // Latencies of the batches counted by batch_count_, if
+  // options_.latency_target_micros is set.
+  std::vector<int64> batch_latencies_micros_ GUARDED_BY(mu_);
+  // Factor applied to the maximum batch size and timeout of the queues. Read
+  // by the queues without holding mu_.
+  std::atomic<double> batch_size_scale_{1.0};
+  // The scale increases when the latency is below this fraction of the target.
+  constexpr static double kBatchSizeScaleIncreaseThreshold = 0.8;
+  // Additive increase and multiplicative decrease of batch_size_scale_.
+  constexpr static double kBatchSizeScaleIncrease = 0.0625;  // 1/16
+  constexpr static double kBatchSizeScaleDecrease = 0.75;
+
   TF_DISALLOW_COPY_AND_ASSIGN(AdaptiveSharedBatchScheduler);
 };
 
@@ -250,6 +280,10 @@ class ASBSQueue : public BatchScheduler<TaskType> {
   // Number of size 1 tasks which could currently be scheduled without failing.
   size_t SchedulingCapacity() const override;
 
+  // Maximum size of the batches, scaled by the scheduler's batch_size_scale().
+  // A larger task still forms a batch on its own.
+  int64 ScaledMaxBatchSize() const;
+
   // Notifies queue that a batch is about to be scheduled; the queue should not
   // place any more tasks in this batch.
   void ReleaseBatch(const ASBSBatch<TaskType>* batch);
@@ -301,6 +335,16 @@ constexpr double AdaptiveSharedBatchScheduler<TaskType>::kMaxStepSizeMultiplier;
 template <typename TaskType>
 constexpr double AdaptiveSharedBatchScheduler<TaskType>::kMinStepSizeMultiplier;
 
+template <typename TaskType>
+constexpr double
+    AdaptiveSharedBatchScheduler<TaskType>::kBatchSizeScaleIncreaseThreshold;
+
+template <typename TaskType>
+constexpr double AdaptiveSharedBatchScheduler<TaskType>::kBatchSizeScaleIncrease;
+
+template <typename TaskType>
+constexpr double AdaptiveSharedBatchScheduler<TaskType>::kBatchSizeScaleDecrease;
+
 template <typename TaskType>
 Status AdaptiveSharedBatchScheduler<TaskType>::Create(
     const Options& options,
@@ -344,6 +388,16 @@ Status AdaptiveSharedBatchScheduler<TaskType>::Create(
         "greater than or equal to 1; was ",
         options.batches_to_average_over);
   }
+  if (options.latency_target_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_target_micros can't be negative; was ",
+        options.latency_target_micros);
+  }
+  if (options.min_batch_size_scale <= 0 || options.min_batch_size_scale > 1) {
+    return errors::InvalidArgument(
+        "min_batch_size_scale must be in (0, 1]; was ",
+        options.min_batch_size_scale);
+  }
   scheduler->reset(new AdaptiveSharedBatchScheduler<TaskType>(options));
   return Status::OK();
 }
@@ -479,6 +533,9 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
   in_flight_batches_--;
   batch_count_++;
   batch_latency_sum_ += end_time - start_time;
+  if (options_.latency_target_micros > 0) {
+    batch_latencies_micros_.push_back(end_time - start_time);
+  }
   // Occasionally adjust in_flight_batches_limit_ to minimize average latency.
   // Although the optimal value may depend on the workload, the latency should
   // be a simple convex function of in_flight_batches_limit_, allowing us to
@@ -514,10 +571,32 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
     last_latency_decreased_ = current_latency_decreased;
     batch_count_ = 0;
     batch_latency_sum_ = 0;
+    if (options_.latency_target_micros > 0) AdjustBatchSizeScale();
   }
   MaybeScheduleNextBatch();
 }
 
+template <typename TaskType>
+void AdaptiveSharedBatchScheduler<TaskType>::AdjustBatchSizeScale() {
+  if (batch_latencies_micros_.empty()) return;
+  // Larger batches increase both the throughput and the latency, so the scale
+  // is decreased quickly when the target is missed, and increased slowly.
+  auto p99 = batch_latencies_micros_.begin() +
+             (batch_latencies_micros_.size() - 1) * 99 / 100;
+  std::nth_element(batch_latencies_micros_.begin(), p99,
+                   batch_latencies_micros_.end());
+  double scale = batch_size_scale_.load();
+  if (*p99 > options_.latency_target_micros) {
+    scale = std::max(scale * kBatchSizeScaleDecrease,
+                     options_.min_batch_size_scale);
+  } else if (*p99 <
+             options_.latency_target_micros * kBatchSizeScaleIncreaseThreshold) {
+    scale = std::min(scale + kBatchSizeScaleIncrease, 1.0);
+  }
+  batch_size_scale_.store(scale);
+  batch_latencies_micros_.clear();
+}
+
 // ---------------- ASBSQueue ----------------
 
 namespace internal {
@@ -557,7 +636,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
     mutex_lock l(mu_);
     // Current batch is full, create another if allowed.
     if (current_batch_ &&
-        current_batch_->size() + size > options_.max_batch_size) {
+        current_batch_->size() + size > ScaledMaxBatchSize()) {
       if (num_enqueued_batches_ >= options_.max_enqueued_batches) {
         return errors::Unavailable("The batch scheduling queue is full");
       }
@@ -567,9 +646,10 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
     }
     if (!current_batch_) {
       num_enqueued_batches_++;
-      current_batch_ = new_batch =
-          new ASBSBatch<TaskType>(this, scheduler_->GetEnv()->NowMicros(),
-                                  options_.batch_timeout_micros);
+      current_batch_ = new_batch = new ASBSBatch<TaskType>(
+          this, scheduler_->GetEnv()->NowMicros(),
+          static_cast<int64>(options_.batch_timeout_micros *
+                             scheduler_->batch_size_scale()));
     }
     current_batch_->AddTask(std::move(*task));
     num_enqueued_tasks_++;
@@ -597,6 +677,13 @@ size_t ASBSQueue<TaskType>::NumEnqueuedTasks() const {
   return num_enqueued_tasks_;
 }
 
+template <typename TaskType>
+int64 ASBSQueue<TaskType>::ScaledMaxBatchSize() const {
+  return std::max<int64>(
+      1, static_cast<int64>(options_.max_batch_size *
+                            scheduler_->batch_size_scale()));
+}
+
 template <typename TaskType>
 size_t ASBSQueue<TaskType>::SchedulingCapacity() const {
   mutex_lock l(mu_);
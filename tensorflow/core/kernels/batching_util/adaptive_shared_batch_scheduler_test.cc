@@ -92,6 +92,12 @@ TEST(AdaptiveSharedBatchSchedulerTest, BadOptions) {
   options.min_in_flight_batches_limit = 2;
   options.num_batch_threads = 3;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.latency_target_micros = -1;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.min_batch_size_scale = 0;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
 }
 
 TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimit) {
@@ -192,6 +198,50 @@ TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimitTuning) {
   stop_teardown.Notify();
 }
 
+TEST(AdaptiveSharedBatchSchedulerTest, BatchSizeScaleTuning) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+    options.env = &env;
+    options.initial_in_flight_batches_limit = 2;
+    options.batches_to_average_over = 1;
+    options.latency_target_micros = 100;
+    auto queue_callback = [&env](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      switch (batch->size()) {
+        case 1:
+          env.AdvanceByMicroseconds(1000);
+          break;
+        case 2:
+          env.AdvanceByMicroseconds(10);
+          break;
+      }
+    };
+    std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue({}, queue_callback, &queue));
+
+    EXPECT_EQ(scheduler->batch_size_scale(), 1.0);
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    while (scheduler->batch_size_scale() == 1.0) {
+    }
+    // Latency above the target -> multiplicative decrease.
+    EXPECT_EQ(scheduler->batch_size_scale(), 0.75);
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    while (scheduler->batch_size_scale() == 0.75) {
+    }
+    // Latency well below the target -> additive increase.
+    EXPECT_EQ(scheduler->batch_size_scale(), 0.8125);
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST(AdaptiveSharedBatchSchedulerTest, FullBatchSchedulingBoostMicros) {
   test_util::FakeClockEnv env(Env::Default());
   Notification start_teardown, stop_teardown;
@@ -0,0 +1,56 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BFLOAT16_CONVERSION_H_
+#define TENSORFLOW_CORE_KERNELS_BFLOAT16_CONVERSION_H_
+
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Conversions between bfloat16 and float tensors, sharded over the intra-op
+// thread pool of `ctx`. Kernels without a native bfloat16 implementation use
+// them to compute in float, where the serial conversions would otherwise
+// dominate for large tensors.
+inline void ParallelBFloat16ToFloat(OpKernelContext* ctx, const Tensor& src,
+                                    Tensor* dst) {
+  const bfloat16* src_data = src.flat<bfloat16>().data();
+  float* dst_data = dst->flat<float>().data();
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        src.NumElements(), /*cost_per_unit=*/1,
+        [src_data, dst_data](int64 begin, int64 end) {
+          BFloat16ToFloat(src_data + begin, dst_data + begin, end - begin);
+        });
+}
+
+inline void ParallelFloatToBFloat16(OpKernelContext* ctx, const Tensor& src,
+                                    Tensor* dst) {
+  const float* src_data = src.flat<float>().data();
+  bfloat16* dst_data = dst->flat<bfloat16>().data();
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        src.NumElements(), /*cost_per_unit=*/1,
+        [src_data, dst_data](int64 begin, int64 end) {
+          FloatToBFloat16(src_data + begin, dst_data + begin, end - begin);
+        });
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BFLOAT16_CONVERSION_H_
@@ -13,11 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -128,81 +131,108 @@ class BoostedTreesCalculateBestGainsPerFeatureOp : public OpKernel {
                    context->output_list("right_node_contribs_list",
                                         &output_right_node_contribs_list));
 
-    // Use identity later to convert float to Eigen::Matrix type for input to
-    // CalculateWeightsAndGains. This op only supports single dimension logits.
-    Eigen::MatrixXf identity;
-    identity.setIdentity(1, 1);
-    // Get the best split info per node for each feature.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
+    // Best split info of every node for one feature.
+    struct FeatureSplits {
+      std::vector<int32> node_ids;
+      std::vector<float> gains;
+      std::vector<int32> thresholds;
+      std::vector<float> left_node_contribs;
+      std::vector<float> right_node_contribs;
+    };
+    std::vector<FeatureSplits> feature_splits(num_features_);
+
+    // Get the best split info per node for each feature. Features are
+    // independent, so they are processed in parallel.
+    auto do_features = [&](const int64 begin, const int64 end) {
+      // Use identity later to convert float to Eigen::Matrix type for input to
+      // CalculateWeightsAndGains. This op only supports single dimension
+      // logits.
+      Eigen::MatrixXf identity;
+      identity.setIdentity(1, 1);
       std::vector<float> cum_grad;
       std::vector<float> cum_hess;
       cum_grad.reserve(num_buckets);
       cum_hess.reserve(num_buckets);
-
-      std::vector<int32> output_node_ids;
-      std::vector<float> output_gains;
-      std::vector<int32> output_thresholds;
-      std::vector<float> output_left_node_contribs;
-      std::vector<float> output_right_node_contribs;
-      for (int node_id = node_id_first; node_id < node_id_last; ++node_id) {
-        // Calculate gains.
-        cum_grad.clear();
-        cum_hess.clear();
-        float total_grad = 0.0;
-        float total_hess = 0.0;
-        for (int bucket = 0; bucket < num_buckets; ++bucket) {
-          // TODO(nponomareva): Consider multi-dimensional gradients/hessians.
-          total_grad += stats_summary[feature_idx](node_id, bucket, 0);
-          total_hess += stats_summary[feature_idx](node_id, bucket, 1);
-          cum_grad.push_back(total_grad);
-          cum_hess.push_back(total_hess);
-        }
-        // Check if node has enough of average hessian.
-        if (total_hess < min_node_weight) {
-          // Do not split the node because not enough avg hessian.
-          continue;
-        }
-        float best_gain = std::numeric_limits<float>::lowest();
-        float best_bucket = 0;
-        float best_contrib_for_left = 0.0;
-        float best_contrib_for_right = 0.0;
-        // Parent gain.
-        float parent_gain;
-        Eigen::VectorXf unused(1);
-        CalculateWeightsAndGains(total_grad * identity, total_hess * identity,
-                                 l1, l2, &unused, &parent_gain);
-
-        for (int bucket = 0; bucket < num_buckets; ++bucket) {
-          const float cum_grad_bucket = cum_grad[bucket];
-          const float cum_hess_bucket = cum_hess[bucket];
-          // Left child.
-          Eigen::VectorXf contrib_for_left(1);
-          float gain_for_left;
-          CalculateWeightsAndGains(cum_grad_bucket * identity,
-                                   cum_hess_bucket * identity, l1, l2,
-                                   &contrib_for_left, &gain_for_left);
-          // Right child.
-          // use contrib_for_right.
-          Eigen::VectorXf contrib_for_right(1);
-          float gain_for_right;
-          CalculateWeightsAndGains((total_grad - cum_grad_bucket) * identity,
-                                   (total_hess - cum_hess_bucket) * identity,
-                                   l1, l2, &contrib_for_right, &gain_for_right);
-
-          if (GainIsLarger(gain_for_left + gain_for_right, best_gain)) {
-            best_gain = gain_for_left + gain_for_right;
-            best_bucket = bucket;
-            best_contrib_for_left = contrib_for_left[0];
-            best_contrib_for_right = contrib_for_right[0];
+      for (int64 feature_idx = begin; feature_idx < end; ++feature_idx) {
+        FeatureSplits* splits = &feature_splits[feature_idx];
+        for (int node_id = node_id_first; node_id < node_id_last; ++node_id) {
+          // Calculate gains.
+          cum_grad.clear();
+          cum_hess.clear();
+          float total_grad = 0.0;
+          float total_hess = 0.0;
+          for (int bucket = 0; bucket < num_buckets; ++bucket) {
+            // TODO(nponomareva): Consider multi-dimensional gradients/hessians.
+            total_grad += stats_summary[feature_idx](node_id, bucket, 0);
+            total_hess += stats_summary[feature_idx](node_id, bucket, 1);
+            cum_grad.push_back(total_grad);
+            cum_hess.push_back(total_hess);
           }
-        }  // for bucket
-        output_node_ids.push_back(node_id);
-        // Remove the parent gain for the parent node.
-        output_gains.push_back(best_gain - parent_gain);
-        output_thresholds.push_back(best_bucket);
-        output_left_node_contribs.push_back(best_contrib_for_left);
-        output_right_node_contribs.push_back(best_contrib_for_right);
-      }  // for node_id
+          // Check if node has enough of average hessian.
+          if (total_hess < min_node_weight) {
+            // Do not split the node because not enough avg hessian.
+            continue;
+          }
+          float best_gain = std::numeric_limits<float>::lowest();
+          float best_bucket = 0;
+          float best_contrib_for_left = 0.0;
+          float best_contrib_for_right = 0.0;
+          // Parent gain.
+          float parent_gain;
+          Eigen::VectorXf unused(1);
+          CalculateWeightsAndGains(total_grad * identity, total_hess * identity,
+                                   l1, l2, &unused, &parent_gain);
+
+          for (int bucket = 0; bucket < num_buckets; ++bucket) {
+            const float cum_grad_bucket = cum_grad[bucket];
+            const float cum_hess_bucket = cum_hess[bucket];
+            // Left child.
+            Eigen::VectorXf contrib_for_left(1);
+            float gain_for_left;
+            CalculateWeightsAndGains(cum_grad_bucket * identity,
+                                     cum_hess_bucket * identity, l1, l2,
+                                     &contrib_for_left, &gain_for_left);
+            // Right child.
+            // use contrib_for_right.
+            Eigen::VectorXf contrib_for_right(1);
+            float gain_for_right;
+            CalculateWeightsAndGains((total_grad - cum_grad_bucket) * identity,
+                                     (total_hess - cum_hess_bucket) * identity,
+                                     l1, l2, &contrib_for_right,
+                                     &gain_for_right);
+
+            if (GainIsLarger(gain_for_left + gain_for_right, best_gain)) {
+              best_gain = gain_for_left + gain_for_right;
+              best_bucket = bucket;
+              best_contrib_for_left = contrib_for_left[0];
+              best_contrib_for_right = contrib_for_right[0];
+            }
+          }  // for bucket
+          splits->node_ids.push_back(node_id);
+          // Remove the parent gain for the parent node.
+          splits->gains.push_back(best_gain - parent_gain);
+          splits->thresholds.push_back(best_bucket);
+          splits->left_node_contribs.push_back(best_contrib_for_left);
+          splits->right_node_contribs.push_back(best_contrib_for_right);
+        }  // for node_id
+      }    // for f
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64 kCostPerUnit =
+        100 * std::max(node_id_last - node_id_first, 1) * (num_buckets + 1);
+    Shard(worker_threads.num_threads, worker_threads.workers, num_features_,
+          kCostPerUnit, do_features);
+
+    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
+      const FeatureSplits& splits = feature_splits[feature_idx];
+      const std::vector<int32>& output_node_ids = splits.node_ids;
+      const std::vector<float>& output_gains = splits.gains;
+      const std::vector<int32>& output_thresholds = splits.thresholds;
+      const std::vector<float>& output_left_node_contribs =
+          splits.left_node_contribs;
+      const std::vector<float>& output_right_node_contribs =
+          splits.right_node_contribs;
       const int num_nodes = output_node_ids.size();
       // output_node_ids
       Tensor* output_node_ids_t;
@@ -1020,38 +1050,71 @@ class BoostedTreesMakeStatsSummaryOp : public OpKernel {
     // Infer batch size.
     const int64 batch_size = node_ids_t->dim_size(0);
 
-    // Allocate temporary stats tensor (Rank 4).
+    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
+      const int64 feature_size =
+          bucketized_features_list[feature_idx].NumElements();
+      OP_REQUIRES(
+          context, feature_size == node_ids.size(),
+          errors::InvalidArgument("feature ", feature_idx,
+                                  " should have same size as node_ids, got ",
+                                  feature_size, " and ", node_ids.size()));
+    }
+
+    // Features are accumulated independently of each other. When there are
+    // fewer features than threads, the examples are also split into blocks so
+    // that small feature counts still use the whole pool; every (feature,
+    // block) pair accumulates into its own partial histogram, and the blocks
+    // are summed afterwards.
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    constexpr int64 kMinExamplesPerBlock = 4096;
+    const int64 num_blocks = std::max<int64>(
+        1, std::min<int64>(
+               worker_threads.num_threads / std::max(num_features_, 1),
+               batch_size / kMinExamplesPerBlock));
+
+    // Allocate temporary stats tensor (Rank 5, the leading dim is the block).
     Tensor temp_stats_double_t;
     OP_REQUIRES_OK(context, context->allocate_temp(
                                 DT_DOUBLE,
-                                {num_features_, max_splits_, num_buckets_, 2},
+                                {num_blocks, num_features_, max_splits_,
+                                 num_buckets_, 2},
                                 &temp_stats_double_t));
-    auto temp_stats_double = temp_stats_double_t.tensor<double, 4>();
+    auto temp_stats_double = temp_stats_double_t.tensor<double, 5>();
     temp_stats_double.setZero();
 
     // Partition by node, and then bucketize.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
-      const auto& features = bucketized_features_list[feature_idx].vec<int32>();
-      OP_REQUIRES(
-          context, features.size() == node_ids.size(),
-          errors::InvalidArgument("feature ", feature_idx,
-                                  " should have same size as node_ids, got ",
-                                  features.size(), " and ", node_ids.size()));
-      for (int i = 0; i < batch_size; ++i) {
-        const int32 node = node_ids(i);
-        const int32 bucket = features(i);
-        temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
-        temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+    auto do_accumulate = [&](const int64 begin, const int64 end) {
+      for (int64 unit = begin; unit < end; ++unit) {
+        const int feature_idx = unit / num_blocks;
+        const int64 block = unit % num_blocks;
+        const int64 first = block * batch_size / num_blocks;
+        const int64 last = (block + 1) * batch_size / num_blocks;
+        const auto features =
+            bucketized_features_list[feature_idx].vec<int32>();
+        for (int64 i = first; i < last; ++i) {
+          const int32 node = node_ids(i);
+          const int32 bucket = features(i);
+          temp_stats_double(block, feature_idx, node, bucket, 0) +=
+              gradients(i, 0);
+          temp_stats_double(block, feature_idx, node, bucket, 1) +=
+              hessians(i, 0);
+        }
       }
-    }
+    };
+    const int64 kCostPerUnit = 20 * (batch_size / num_blocks + 1);
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_features_ * num_blocks, kCostPerUnit, do_accumulate);
 
-    // Copy temp tensor over to output tensor.
+    // Sum the blocks into the output tensor.
     Tensor* output_stats_summary_t = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(
-                                "stats_summary", temp_stats_double_t.shape(),
+                                "stats_summary",
+                                {num_features_, max_splits_, num_buckets_, 2},
                                 &output_stats_summary_t));
+    const Eigen::array<int, 1> block_dim = {0};
     output_stats_summary_t->tensor<float, 4>() =
-        temp_stats_double.template cast<float>();
+        temp_stats_double.sum(block_dim).template cast<float>();
   }
 
  private:
@@ -423,6 +423,82 @@ struct BinaryFunctor<CPUDevice, Functor, 2, false> {
   }
 #endif
 
+  // Rows shorter than this are left to the Eigen broadcast expressions, since
+  // the per-row loop below wouldn't vectorize well.
+  static constexpr int kMinRowSizeForRowLoop = 32;
+
+  // Computes out[i, :] = func(matrix[i, :], vec) for each row i, or
+  // func(vec, matrix[i, :]) if 'vec_is_left', with one contiguous vectorized
+  // expression per row rather than a 2-D broadcast expression. This is the
+  // [N, C] op [C] pattern of bias additions and scalings.
+  template <bool vec_is_left>
+  void RowVectorBCast(
+      const CPUDevice& dev,
+      typename TTypes<typename Functor::out_type, NDIMS>::Tensor out,
+      const typename Functor::in_type* matrix,
+      const typename Functor::in_type* vec) {
+    typedef typename Functor::out_type Tout;
+    typedef typename Functor::in_type Tin;
+    typedef typename Functor::func Binary;
+    const int64 rows = out.dimension(0);
+    const int64 cols = out.dimension(1);
+    auto work = [&out, matrix, vec, cols](int64 start, int64 limit) {
+      typename TTypes<Tin>::UnalignedConstFlat vec_flat(vec, cols);
+      for (int64 i = start; i < limit; ++i) {
+        typename TTypes<Tout>::UnalignedFlat out_row(out.data() + i * cols,
+                                                     cols);
+        typename TTypes<Tin>::UnalignedConstFlat row(matrix + i * cols, cols);
+        if (vec_is_left) {
+          out_row = vec_flat.binaryExpr(row, Binary());
+        } else {
+          out_row = row.binaryExpr(vec_flat, Binary());
+        }
+      }
+    };
+    const Eigen::TensorOpCost cost(
+        2 * sizeof(Tin) * cols, sizeof(Tout) * cols,
+        cols * Eigen::internal::functor_traits<Binary>::Cost);
+    dev.parallelFor(rows, cost, work);
+  }
+
+  // Computes out[i, :] = func(matrix[i, :], col[i]) for each row i, or
+  // func(col[i], matrix[i, :]) if 'col_is_left', like RowVectorBCast(). This is
+  // the [N, C] op [N, 1] pattern of per-row scalings.
+  template <bool col_is_left>
+  void ColumnVectorBCast(
+      const CPUDevice& dev,
+      typename TTypes<typename Functor::out_type, NDIMS>::Tensor out,
+      const typename Functor::in_type* matrix,
+      const typename Functor::in_type* col) {
+    typedef typename Functor::out_type Tout;
+    typedef typename Functor::in_type Tin;
+    typedef typename Functor::func Binary;
+    typedef typename Eigen::internal::scalar_left<
+        Tout, Tin, Binary, /*is_scalar_in_host_memory=*/true>
+        Left;
+    typedef typename Eigen::internal::scalar_right<
+        Tout, Tin, Binary, /*is_scalar_in_host_memory=*/true>
+        Right;
+    const int64 rows = out.dimension(0);
+    const int64 cols = out.dimension(1);
+    auto work = [&out, matrix, col, cols](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        typename TTypes<Tout>::UnalignedFlat out_row(out.data() + i * cols,
+                                                     cols);
+        typename TTypes<Tin>::UnalignedConstFlat row(matrix + i * cols, cols);
+        if (col_is_left) {
+          out_row = row.unaryExpr(Left(col + i));
+        } else {
+          out_row = row.unaryExpr(Right(col + i));
+        }
+      }
+    };
+    const Eigen::TensorOpCost cost(
+        sizeof(Tin) * (cols + 1), sizeof(Tout) * cols,
+        cols * Eigen::internal::functor_traits<Binary>::Cost);
+    dev.parallelFor(rows, cost, work);
+  }
+
   void BCast(const CPUDevice& dev,
              typename TTypes<typename Functor::out_type, NDIMS>::Tensor out,
              typename TTypes<typename Functor::in_type, NDIMS>::ConstTensor in0,
@@ -466,24 +542,44 @@ struct BinaryFunctor<CPUDevice, Functor, 2, false> {
         return;
       }
       if (a == 1) {
+        if (b >= kMinRowSizeForRowLoop) {
+          RowVectorBCast</*vec_is_left=*/true>(dev, out, in1.data(),
+                                               in0.data());
+          return;
+        }
         auto lhs = in0.reshape(OneByM(b)).broadcast(NByOne(c));
         auto rhs = in1;
         Assign(dev, out, lhs.binaryExpr(rhs, func));
         return;
       }
       if (b == 1) {
+        if (d >= kMinRowSizeForRowLoop) {
+          ColumnVectorBCast</*col_is_left=*/true>(dev, out, in1.data(),
+                                                  in0.data());
+          return;
+        }
         auto lhs = in0.reshape(NByOne(a)).broadcast(OneByM(d));
         auto rhs = in1;
         Assign(dev, out, lhs.binaryExpr(rhs, func));
         return;
       }
       if (c == 1) {
+        if (d >= kMinRowSizeForRowLoop) {
+          RowVectorBCast</*vec_is_left=*/false>(dev, out, in0.data(),
+                                                in1.data());
+          return;
+        }
         auto lhs = in0;
         auto rhs = in1.reshape(OneByM(d)).broadcast(NByOne(a));
         Assign(dev, out, lhs.binaryExpr(rhs, func));
         return;
       }
       if (d == 1) {
+        if (b >= kMinRowSizeForRowLoop) {
+          ColumnVectorBCast</*col_is_left=*/false>(dev, out, in0.data(),
+                                                   in1.data());
+          return;
+        }
         auto lhs = in0;
         auto rhs = in1.reshape(NByOne(c)).broadcast(OneByM(b));
         Assign(dev, out, lhs.binaryExpr(rhs, func));
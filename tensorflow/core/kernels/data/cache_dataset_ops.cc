@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
+#include "tensorflow/core/kernels/data/checkpoint_element_store.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -52,6 +53,7 @@ constexpr char kCacheClaimed[] = "cache_claimed";
 constexpr char kCacheSize[] = "cache_size";
 constexpr char kCache[] = "cache";
 constexpr char kSizeSuffix[] = ".size";
+constexpr char kPathSuffix[] = ".path";
 constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
@@ -745,8 +747,27 @@ class CacheDatasetOp::MemoryDataset : public DatasetBase {
         size_t cache_size = cache_->size();
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kCacheSize), cache_size));
+        // If a checkpoint element store is configured, the cached elements
+        // are written to it and only their paths go into the checkpoint.
+        // Cached elements never change, so each is written at most once.
+        CheckpointElementStore* store = CheckpointElementStore::Default();
+        if (store != nullptr) {
+          for (size_t i = element_paths_.size(); i < cache_size; ++i) {
+            std::vector<Tensor> element;
+            TF_RETURN_IF_ERROR(cache_->Lookup(i, &element));
+            element_paths_.emplace_back();
+            TF_RETURN_IF_ERROR(store->Write(element, &element_paths_.back()));
+          }
+        }
         for (size_t i = 0; i < cache_size; i++) {
-          auto& element = cache_->at(i);
+          if (store != nullptr) {
+            TF_RETURN_IF_ERROR(writer->WriteScalar(
+                full_name(strings::StrCat(kCache, "[", i, "]", kPathSuffix)),
+                element_paths_[i]));
+            continue;
+          }
+          std::vector<Tensor> element;
+          TF_RETURN_IF_ERROR(cache_->Lookup(i, &element));
           TF_RETURN_IF_ERROR(writer->WriteScalar(
               full_name(strings::StrCat(kCache, "[", i, "]", kSizeSuffix)),
               element.size()));
@@ -769,6 +790,7 @@ class CacheDatasetOp::MemoryDataset : public DatasetBase {
       mutex_lock l(mu_);
       iterator_.reset();
       cache_->Reset();
+      element_paths_.clear();
       {
         int64 temp;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kMode), &temp));
@@ -784,6 +806,17 @@ class CacheDatasetOp::MemoryDataset : public DatasetBase {
         }
         for (size_t i = 0; i < cache_size; ++i) {
           std::vector<Tensor> element;
+          const string path_key =
+              full_name(strings::StrCat(kCache, "[", i, "]", kPathSuffix));
+          if (reader->Contains(path_key)) {
+            tstring path;
+            TF_RETURN_IF_ERROR(reader->ReadScalar(path_key, &path));
+            element_paths_.emplace_back(path);
+            TF_RETURN_IF_ERROR(
+                CheckpointElementStore::Read(element_paths_.back(), &element));
+            TF_RETURN_IF_ERROR(cache_->emplace_back(std::move(element)));
+            continue;
+          }
           size_t element_size;
           {
             int64 temp;
@@ -799,10 +832,10 @@ class CacheDatasetOp::MemoryDataset : public DatasetBase {
                 full_name(strings::StrCat(kCache, "[", i, "][", j, "]")),
                 &element.back()));
           }
-          cache_->emplace_back(std::move(element));
+          TF_RETURN_IF_ERROR(cache_->emplace_back(std::move(element)));
         }
         if (reader->Contains(full_name(kCacheCompleted))) {
-          cache_->Complete();
+          TF_RETURN_IF_ERROR(cache_->Complete());
         }
       }
       InitializeIterator();
@@ -843,11 +876,12 @@ class CacheDatasetOp::MemoryDataset : public DatasetBase {
         TF_RETURN_IF_ERROR(
             input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
         if (*end_of_sequence) {
-          cache_->Complete();
-          return Status::OK();
+          return cache_->Complete();
+        }
+        TF_RETURN_IF_ERROR(cache_->emplace_back(*out_tensors));
+        if (cache_->num_in_memory() == cache_->size()) {
+          RecordBufferEnqueue(ctx, *out_tensors);
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        cache_->emplace_back(*out_tensors);
         return Status::OK();
       }
 
@@ -887,9 +921,9 @@ class CacheDatasetOp::MemoryDataset : public DatasetBase {
         // dataset but performance modeling uses the iterator abstraction and
         // thus we record the memory allocated for the cache here. The caveat
         // is that this is incorrect if there are concurrent instances of this
-        // iterator.
+        // iterator. Elements that have been spilled to disk are not counted.
         tf_shared_lock l(mu_);
-        for (size_t i = 0; i < cache_->size(); ++i) {
+        for (size_t i = 0; i < cache_->num_in_memory(); ++i) {
           RecordBufferEnqueue(ctx, cache_->at(i));
         }
         return Status::OK();
@@ -900,7 +934,8 @@ class CacheDatasetOp::MemoryDataset : public DatasetBase {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
-          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
+          std::vector<Tensor> cache_tensors;
+          TF_RETURN_IF_ERROR(cache_->Lookup(index_, &cache_tensors));
           out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
                               cache_tensors.end());
           index_++;
@@ -963,6 +998,8 @@ class CacheDatasetOp::MemoryDataset : public DatasetBase {
     enum Mode { read, write };
     Mode mode_ GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> iterator_ GUARDED_BY(mu_);
+    // Paths of the first cached elements in the checkpoint element store.
+    std::vector<string> element_paths_ GUARDED_BY(mu_);
   };  // MemoryIterator
 
   const DatasetBase* const input_;
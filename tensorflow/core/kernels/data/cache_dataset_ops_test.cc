@@ -11,7 +11,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/path.h"
 
 namespace tensorflow {
 namespace data {
@@ -524,6 +526,39 @@ INSTANTIATE_TEST_SUITE_P(
     ::testing::ValuesIn(std::vector<TestCase>({TestCase1(), TestCase2(),
                                                TestCase3(), TestCase4()})));
 
+TEST(MemoryCacheTest, SpillsToDiskOverBudget) {
+  const string spill_dir = io::JoinPath(testing::TmpDir(), "memory_cache");
+  // Each element is a single int64 scalar, so three of them fit in memory.
+  MemoryCache cache(/*memory_budget_bytes=*/24, spill_dir);
+  for (int64 i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(cache.emplace_back({test::AsScalar<int64>(i)}));
+  }
+  EXPECT_EQ(cache.size(), 5);
+  EXPECT_EQ(cache.num_in_memory(), 3);
+
+  std::vector<Tensor> element;
+  TF_EXPECT_OK(cache.Lookup(2, &element));
+  EXPECT_TRUE(errors::IsFailedPrecondition(cache.Lookup(3, &element)));
+
+  TF_ASSERT_OK(cache.Complete());
+  for (int64 i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(cache.Lookup(i, &element));
+    ASSERT_EQ(element.size(), 1);
+    test::ExpectTensorEqual<int64>(element[0], test::AsScalar<int64>(i));
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(cache.Lookup(5, &element)));
+
+  std::vector<string> spill_files;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      io::JoinPath(spill_dir, "*"), &spill_files));
+  EXPECT_FALSE(spill_files.empty());
+  cache.Reset();
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      io::JoinPath(spill_dir, "*"), &spill_files));
+  EXPECT_TRUE(spill_files.empty());
+  EXPECT_EQ(cache.size(), 0);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -18,23 +18,77 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
 namespace {
 
 const char kMemoryCache[] = "MemoryCache";
+const char kMemoryBudgetEnvVar[] = "TF_DATA_MEMORY_CACHE_BUDGET_BYTES";
+const char kSpillDirEnvVar[] = "TF_DATA_MEMORY_CACHE_SPILL_DIR";
+const char kSpillFilePrefix[] = "tf_data_memory_cache_";
+// Bundle keys must be added in increasing order, so the indices are padded to
+// the width of the largest `size_t`.
+const char kSpillKeyFormat[] = "%020zu_%020zu";
+
+int64 MemoryBudgetFromEnv() {
+  int64 budget;
+  Status s = ReadInt64FromEnvVar(kMemoryBudgetEnvVar, 0, &budget);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << kMemoryBudgetEnvVar << ": " << s;
+    return 0;
+  }
+  return budget;
+}
+
+string SpillDirFromEnv() {
+  string dir;
+  Status s = ReadStringFromEnvVar(kSpillDirEnvVar, "", &dir);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << kSpillDirEnvVar << ": " << s;
+    return "";
+  }
+  return dir;
+}
+
+string SpillKey(size_t index, size_t tensor_index) {
+  return strings::Printf(kSpillKeyFormat, index, tensor_index);
+}
 
 }  // namespace
 
+MemoryCache::MemoryCache()
+    : MemoryCache(MemoryBudgetFromEnv(), SpillDirFromEnv()) {}
+
+MemoryCache::MemoryCache(int64 memory_budget_bytes, string spill_dir)
+    : memory_budget_bytes_(memory_budget_bytes),
+      spill_dir_(std::move(spill_dir)) {}
+
+MemoryCache::~MemoryCache() {
+  mutex_lock l(mu_);
+  DeleteSpillFilesLocked();
+}
+
 string MemoryCache::DebugString() const { return kMemoryCache; }
 
-void MemoryCache::Complete() {
+Status MemoryCache::Complete() {
   mutex_lock l(mu_);
+  if (spill_writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(spill_writer_->Finish());
+    spill_writer_.reset();
+    spill_reader_ =
+        absl::make_unique<BundleReader>(Env::Default(), spill_prefix_);
+    TF_RETURN_IF_ERROR(spill_reader_->status());
+  }
   completed_ = true;
+  return Status::OK();
 }
 
 bool MemoryCache::IsClaimed() {
@@ -61,6 +115,8 @@ void MemoryCache::Reset() {
   claimed_ = false;
   completed_ = false;
   cache_.clear();
+  bytes_in_memory_ = 0;
+  DeleteSpillFilesLocked();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64 index) {
@@ -69,16 +125,123 @@ const std::vector<Tensor>& MemoryCache::at(int64 index) {
   return cache_[index];
 }
 
-void MemoryCache::emplace_back(std::vector<Tensor> element) {
+Status MemoryCache::Lookup(int64 index, std::vector<Tensor>* element) {
+  {
+    tf_shared_lock l(mu_);
+    if (index < cache_.size()) {
+      *element = cache_[index];
+      return Status::OK();
+    }
+  }
+  // `BundleReader` is not thread-safe, so reads from disk are serialized.
   mutex_lock l(mu_);
-  cache_.emplace_back(std::move(element));
+  const size_t spill_index = index - cache_.size();
+  if (spill_index >= num_spilled_) {
+    return errors::OutOfRange("Index ", index,
+                              " is out of range for a cache of size ",
+                              cache_.size() + num_spilled_, ".");
+  }
+  if (spill_reader_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Element ", index,
+        " of the memory cache has been spilled to disk and cannot be read "
+        "before the cache is completed.");
+  }
+  element->clear();
+  element->reserve(spilled_element_size_);
+  for (size_t i = 0; i < spilled_element_size_; ++i) {
+    element->emplace_back();
+    TF_RETURN_IF_ERROR(
+        spill_reader_->Lookup(SpillKey(spill_index, i), &element->back()));
+  }
+  return Status::OK();
+}
+
+Status MemoryCache::emplace_back(std::vector<Tensor> element) {
+  mutex_lock l(mu_);
+  int64 element_bytes = 0;
+  for (const Tensor& t : element) {
+    element_bytes += t.TotalBytes();
+  }
+  // Once spilling has started, all further elements go to disk so that the
+  // in-memory elements remain a prefix of the cache.
+  if (num_spilled_ == 0 && (memory_budget_bytes_ <= 0 ||
+                            bytes_in_memory_ + element_bytes <=
+                                memory_budget_bytes_)) {
+    bytes_in_memory_ += element_bytes;
+    cache_.emplace_back(std::move(element));
+    return Status::OK();
+  }
+  if (num_spilled_ == 0) {
+    TF_RETURN_IF_ERROR(StartSpillLocked());
+    spilled_element_size_ = element.size();
+  }
+  if (element.size() != spilled_element_size_) {
+    return errors::Internal("Expected an element of ", spilled_element_size_,
+                            " tensors, got: ", element.size());
+  }
+  for (size_t i = 0; i < element.size(); ++i) {
+    TF_RETURN_IF_ERROR(
+        spill_writer_->Add(SpillKey(num_spilled_, i), element[i]));
+  }
+  ++num_spilled_;
+  return Status::OK();
 }
 
 size_t MemoryCache::size() {
+  tf_shared_lock l(mu_);
+  return cache_.size() + num_spilled_;
+}
+
+size_t MemoryCache::num_in_memory() {
   tf_shared_lock l(mu_);
   return cache_.size();
 }
 
+Status MemoryCache::StartSpillLocked() {
+  Env* env = Env::Default();
+  if (spill_dir_.empty()) {
+    if (!env->LocalTempFilename(&spill_prefix_)) {
+      return errors::Internal(
+          "Failed to create a temporary file name for the memory cache.");
+    }
+  } else {
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(spill_dir_));
+    spill_prefix_ = io::JoinPath(
+        spill_dir_, strings::StrCat(kSpillFilePrefix, random::New64()));
+  }
+  LOG(INFO) << "The memory cache exceeded its budget of "
+            << memory_budget_bytes_ << " bytes; spilling further elements to "
+            << spill_prefix_;
+  spill_writer_ = absl::make_unique<BundleWriter>(env, spill_prefix_);
+  return spill_writer_->status();
+}
+
+void MemoryCache::DeleteSpillFilesLocked() {
+  spill_writer_.reset();
+  spill_reader_.reset();
+  num_spilled_ = 0;
+  spilled_element_size_ = 0;
+  if (spill_prefix_.empty()) {
+    return;
+  }
+  Env* env = Env::Default();
+  std::vector<string> spill_files;
+  Status s = env->GetMatchingPaths(strings::StrCat(spill_prefix_, "*"),
+                                   &spill_files);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to get matching files on " << spill_prefix_
+                 << "* : " << s.ToString();
+  }
+  for (const string& path : spill_files) {
+    s = env->DeleteFile(path);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete " << path << " : " << s.ToString();
+    }
+  }
+  spill_prefix_.clear();
+}
+
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
     OpKernelConstruction* ctx)
     : AnonymousResourceOp<MemoryCache>(ctx) {}
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace data {
@@ -27,14 +28,25 @@ namespace data {
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// Elements are kept in memory until their total size would exceed the memory
+// budget. From then on, elements are spilled to a tensor bundle on local
+// disk, in the same format that the file-backed cache uses, and are read back
+// from it once the cache is completed. A budget of 0 means unlimited. By
+// default, the budget is read from the TF_DATA_MEMORY_CACHE_BUDGET_BYTES
+// environment variable and the spill file is created in the directory named
+// by TF_DATA_MEMORY_CACHE_SPILL_DIR, or in the local temporary directory if
+// that is not set.
 class MemoryCache : public ResourceBase {
  public:
-  MemoryCache() = default;
+  MemoryCache();
+  MemoryCache(int64 memory_budget_bytes, string spill_dir);
+  ~MemoryCache() override;
 
   string DebugString() const override;
 
-  // Marks the cache as completed.
-  void Complete();
+  // Marks the cache as completed, flushing any spilled elements to disk.
+  Status Complete();
 
   // Returns whether the cache is claimed.
   bool IsClaimed();
@@ -45,25 +57,51 @@ class MemoryCache : public ResourceBase {
   // Attempts to claim the cache, returning whether the cache was claimed.
   bool MaybeClaim();
 
-  // Resets the cache.
+  // Resets the cache, deleting any spilled elements.
   void Reset();
 
-  // Returns the element at the given index.
+  // Returns the in-memory element at the given index, which must be less
+  // than `num_in_memory()`.
   const std::vector<Tensor>& at(int64 index);
 
-  // Adds the element to the cache.
-  void emplace_back(std::vector<Tensor> element);
+  // Stores the element at the given index in `element`, reading it from disk
+  // if it has been spilled. Spilled elements can only be read once the cache
+  // is completed.
+  Status Lookup(int64 index, std::vector<Tensor>* element);
+
+  // Adds the element to the cache, spilling it to disk if it does not fit in
+  // the memory budget.
+  Status emplace_back(std::vector<Tensor> element);
 
   // Returns the size of the cache.
   size_t size();
 
+  // Returns the number of elements held in memory. These are always the first
+  // `num_in_memory()` elements of the cache.
+  size_t num_in_memory();
+
  private:
+  Status StartSpillLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void DeleteSpillFilesLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 memory_budget_bytes_;
+  const string spill_dir_;
+
   mutex mu_;
   // Determines whether a writer has claimed the cache.
   bool claimed_ GUARDED_BY(mu_) = false;
   // Determines whether all elements of the dataset have been cached.
   bool completed_ GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ GUARDED_BY(mu_);
+  int64 bytes_in_memory_ GUARDED_BY(mu_) = 0;
+
+  // State of the spill file. `spill_writer_` is set while elements are being
+  // spilled and `spill_reader_` once the cache is completed.
+  string spill_prefix_ GUARDED_BY(mu_);
+  std::unique_ptr<BundleWriter> spill_writer_ GUARDED_BY(mu_);
+  std::unique_ptr<BundleReader> spill_reader_ GUARDED_BY(mu_);
+  size_t num_spilled_ GUARDED_BY(mu_) = 0;
+  size_t spilled_element_size_ GUARDED_BY(mu_) = 0;
 };
 
 // Creates an instance of cache resource and transfers ownership to the caller.
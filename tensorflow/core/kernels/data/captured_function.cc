@@ -92,6 +92,8 @@ class SimpleStepStatsCollector : public StepStatsCollectorInterface {
 
     void SetScheduled(int64 nanos) override {}
 
+    void SetRanInline(bool ran_inline) override {}
+
    private:
     int64 start_time_ns_ = 0;
     int64 end_time_ns_ = 0;
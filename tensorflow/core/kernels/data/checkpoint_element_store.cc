@@ -0,0 +1,122 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/checkpoint_element_store.h"
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+const char kElementDirEnvVar[] = "TF_DATA_CHECKPOINT_ELEMENT_DIR";
+const char kElementTypeName[] = "tf_data_checkpoint_element";
+const char kElementFileSuffix[] = ".element";
+const char kTempFileSuffix[] = ".tmp";
+
+}  // namespace
+
+CheckpointElementStore::CheckpointElementStore(string dir)
+    : dir_(std::move(dir)) {}
+
+/* static */
+CheckpointElementStore* CheckpointElementStore::Default() {
+  static CheckpointElementStore* store = []() -> CheckpointElementStore* {
+    string dir;
+    Status s = ReadStringFromEnvVar(kElementDirEnvVar, "", &dir);
+    if (!s.ok()) {
+      LOG(WARNING) << "Ignoring " << kElementDirEnvVar << ": " << s;
+      return nullptr;
+    }
+    if (dir.empty()) {
+      return nullptr;
+    }
+    return new CheckpointElementStore(std::move(dir));
+  }();
+  return store;
+}
+
+Status CheckpointElementStore::Write(const std::vector<Tensor>& element,
+                                     string* path) {
+  VariantTensorDataProto proto;
+  proto.set_type_name(kElementTypeName);
+  for (const Tensor& t : element) {
+    t.AsProtoTensorContent(proto.add_tensors());
+  }
+  string data;
+  if (!SerializeToStringDeterministic(proto, &data)) {
+    return errors::Internal("Failed to serialize a dataset element of ",
+                            element.size(), " tensors.");
+  }
+  const Fprint128 fingerprint = Fingerprint128(data);
+  *path = io::JoinPath(
+      dir_, strings::Printf(
+                "%016llx%016llx%s",
+                static_cast<unsigned long long>(fingerprint.high64),
+                static_cast<unsigned long long>(fingerprint.low64),
+                kElementFileSuffix));
+  {
+    tf_shared_lock l(mu_);
+    if (written_.count(*path) > 0) {
+      return Status::OK();
+    }
+  }
+  Env* env = Env::Default();
+  // Elements written by an earlier process are reused as well. Files only
+  // appear under their final name once completely written, so an existing
+  // file always holds the element.
+  if (!env->FileExists(*path).ok()) {
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir_));
+    const string temp_path =
+        strings::StrCat(*path, kTempFileSuffix, random::New64());
+    TF_RETURN_IF_ERROR(WriteStringToFile(env, temp_path, data));
+    TF_RETURN_IF_ERROR(env->RenameFile(temp_path, *path));
+  }
+  mutex_lock l(mu_);
+  written_.insert(*path);
+  return Status::OK();
+}
+
+/* static */
+Status CheckpointElementStore::Read(const string& path,
+                                    std::vector<Tensor>* element) {
+  string data;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), path, &data));
+  VariantTensorDataProto proto;
+  if (!proto.ParseFromString(data) || proto.type_name() != kElementTypeName) {
+    return errors::DataLoss("Failed to parse the dataset element in ", path);
+  }
+  element->clear();
+  element->reserve(proto.tensors_size());
+  for (const TensorProto& tensor_proto : proto.tensors()) {
+    element->emplace_back();
+    if (!element->back().FromProto(tensor_proto)) {
+      return errors::DataLoss("Failed to parse a tensor of the element in ",
+                              path);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
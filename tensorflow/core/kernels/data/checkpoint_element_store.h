@@ -0,0 +1,67 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_CHECKPOINT_ELEMENT_STORE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_CHECKPOINT_ELEMENT_STORE_H_
+
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Stores dataset elements buffered by iterators, such as the contents of a
+// shuffle buffer or an in-memory cache, outside of the iterator checkpoint.
+//
+// Each element is written to its own file in the store directory, named by a
+// fingerprint of its contents, and an element that is already in the store is
+// not written again. Iterators record only the paths of their buffered
+// elements in the checkpoint, so a checkpoint of a large buffer that changes
+// little between saves only writes the elements added since the last save.
+//
+// Files are never deleted by the store, because older checkpoints may still
+// refer to them; the lifetime of the directory is up to the user.
+class CheckpointElementStore {
+ public:
+  explicit CheckpointElementStore(string dir);
+
+  // Returns the process-wide store in the directory named by the
+  // TF_DATA_CHECKPOINT_ELEMENT_DIR environment variable, or nullptr if that
+  // is not set, in which case elements should be written to the checkpoint.
+  static CheckpointElementStore* Default();
+
+  // Writes `element` to the store unless it is already there, and stores the
+  // path of its file in `path`.
+  Status Write(const std::vector<Tensor>& element, string* path);
+
+  // Reads the element written to `path` by `Write()`.
+  static Status Read(const string& path, std::vector<Tensor>* element);
+
+ private:
+  const string dir_;
+
+  mutex mu_;
+  // Paths known to hold a completely written element.
+  std::unordered_set<string> written_ GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_CHECKPOINT_ELEMENT_STORE_H_
@@ -0,0 +1,81 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/checkpoint_element_store.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> MakeElement(int64 value) {
+  return {test::AsScalar<int64>(value),
+          test::AsTensor<tstring>({"a", "b"}, {2})};
+}
+
+TEST(CheckpointElementStoreTest, WriteAndRead) {
+  const string dir = io::JoinPath(testing::TmpDir(), "write_and_read");
+  CheckpointElementStore store(dir);
+  const std::vector<Tensor> element = MakeElement(42);
+  string path;
+  TF_ASSERT_OK(store.Write(element, &path));
+  EXPECT_TRUE(absl::StartsWith(path, dir));
+
+  std::vector<Tensor> restored;
+  TF_ASSERT_OK(CheckpointElementStore::Read(path, &restored));
+  ASSERT_EQ(restored.size(), element.size());
+  test::ExpectTensorEqual<int64>(restored[0], element[0]);
+  test::ExpectTensorEqual<tstring>(restored[1], element[1]);
+}
+
+TEST(CheckpointElementStoreTest, ElementsAreWrittenOnce) {
+  const string dir = io::JoinPath(testing::TmpDir(), "written_once");
+  CheckpointElementStore store(dir);
+  string path;
+  TF_ASSERT_OK(store.Write(MakeElement(1), &path));
+  string same_path;
+  TF_ASSERT_OK(store.Write(MakeElement(1), &same_path));
+  EXPECT_EQ(path, same_path);
+  string other_path;
+  TF_ASSERT_OK(store.Write(MakeElement(2), &other_path));
+  EXPECT_NE(path, other_path);
+
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_EQ(children.size(), 2);
+
+  // A new store reuses the elements written by an earlier one.
+  CheckpointElementStore new_store(dir);
+  TF_ASSERT_OK(new_store.Write(MakeElement(2), &same_path));
+  EXPECT_EQ(other_path, same_path);
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_EQ(children.size(), 2);
+}
+
+TEST(CheckpointElementStoreTest, ReadMissingElement) {
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsNotFound(CheckpointElementStore::Read(
+      io::JoinPath(testing::TmpDir(), "missing.element"), &element)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
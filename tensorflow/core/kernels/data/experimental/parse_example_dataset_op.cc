@@ -142,6 +142,10 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
          it++) {
       it->second = i++;
     }
+    // The feature names are fixed for the lifetime of the dataset, so the
+    // index is built once rather than for every batch of examples.
+    OP_REQUIRES_OK(ctx, example::FastParseExampleConfigIndex::Create(
+                            config, &config.index));
 
     *output =
         new Dataset(ctx, input, dense_defaults, sparse_keys_, dense_keys_,
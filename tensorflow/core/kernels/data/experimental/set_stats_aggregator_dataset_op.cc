@@ -185,6 +185,13 @@ class SetStatsAggregatorDatasetOp : public UnaryDatasetOpKernel {
         return input_impl_->GetNext(&iter_ctx, out_tensors, end_of_sequence);
       }
 
+      // This dataset is applied after the autotuning model, so it forwards
+      // the model of its input.
+      std::shared_ptr<model::Model> model() const override {
+        tf_shared_lock l(mu_);
+        return input_impl_ ? input_impl_->model() : nullptr;
+      }
+
      protected:
       std::shared_ptr<model::Node> CreateNode(
           IteratorContext* ctx, model::Node::Args args) const override {
@@ -204,7 +211,7 @@ class SetStatsAggregatorDatasetOp : public UnaryDatasetOpKernel {
       }
 
      private:
-      mutex mu_;
+      mutable mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
     };
 
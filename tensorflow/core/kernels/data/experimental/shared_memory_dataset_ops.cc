@@ -0,0 +1,274 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Runs a dataset to completion and writes its elements to a shared memory
+// ring buffer. This is the producer side of `SharedMemoryDataset`, and is
+// intended to run in a separate worker process, typically on a dataset that
+// was deserialized with `DatasetFromGraph`.
+class DatasetToSharedMemoryOp : public AsyncOpKernel {
+ public:
+  explicit DatasetToSharedMemoryOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        background_worker_(ctx->env(), "tf_data_to_shared_memory") {}
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    // The call to `iterator->GetNext()` may block and depend on an inter-op
+    // thread pool thread, so we issue the call using a background thread.
+    background_worker_.Schedule(std::bind(
+        [this, ctx](std::function<void()>& done) {
+          tstring name;
+          OP_REQUIRES_OK_ASYNC(
+              ctx, ParseScalarArgument<tstring>(ctx, "buffer_name", &name),
+              done);
+          int64 num_slots;
+          OP_REQUIRES_OK_ASYNC(
+              ctx, ParseScalarArgument<int64>(ctx, "num_slots", &num_slots),
+              done);
+          int64 slot_size;
+          OP_REQUIRES_OK_ASYNC(
+              ctx, ParseScalarArgument<int64>(ctx, "slot_size", &slot_size),
+              done);
+
+          DatasetBase* dataset;
+          OP_REQUIRES_OK_ASYNC(
+              ctx, GetDatasetFromVariantTensor(ctx->input(0), &dataset), done);
+          for (DataType dt : dataset->output_dtypes()) {
+            OP_REQUIRES_ASYNC(
+                ctx, DataTypeCanUseMemcpy(dt),
+                errors::InvalidArgument(
+                    "DatasetToSharedMemory does not support components of "
+                    "type ",
+                    DataTypeString(dt), "."),
+                done);
+          }
+
+          std::unique_ptr<SharedMemoryRingBuffer> buffer;
+          OP_REQUIRES_OK_ASYNC(ctx,
+                               SharedMemoryRingBuffer::Create(
+                                   name, num_slots, slot_size, &buffer),
+                               done);
+
+          IteratorContext::Params params(ctx);
+          FunctionHandleCache function_handle_cache(params.flr);
+          params.function_handle_cache = &function_handle_cache;
+          ResourceMgr resource_mgr;
+          params.resource_mgr = &resource_mgr;
+          CancellationManager cancellation_manager;
+          params.cancellation_manager = &cancellation_manager;
+          std::function<void()> deregister_fn;
+          OP_REQUIRES_OK_ASYNC(ctx,
+                               ConnectCancellationManagers(
+                                   ctx->cancellation_manager(),
+                                   params.cancellation_manager, &deregister_fn),
+                               done);
+          auto cleanup = gtl::MakeCleanup(std::move(deregister_fn));
+
+          IteratorContext iter_ctx(std::move(params));
+          std::unique_ptr<IteratorBase> iterator;
+          Status s = dataset->MakeIterator(
+              &iter_ctx, "DatasetToSharedMemoryOpIterator", &iterator);
+          std::vector<Tensor> components;
+          bool end_of_sequence = false;
+          while (s.ok()) {
+            components.clear();
+            s = iterator->GetNext(&iter_ctx, &components, &end_of_sequence);
+            if (!s.ok() || end_of_sequence) break;
+            // Writing blocks while the consumer holds all slots, so it is
+            // cancelled along with the op.
+            s = buffer->Write(components, iter_ctx.cancellation_manager());
+          }
+          // The consumer observes the same status as this op, so that errors
+          // in the worker surface in the process that reads the elements.
+          buffer->Close(s);
+          // Destroy the iterator before calling the callback to avoid
+          // destruction races.
+          iterator.reset();
+          OP_REQUIRES_OK_ASYNC(ctx, s, done);
+          done();
+        },
+        std::move(done)));
+  }
+
+ private:
+  BackgroundWorker background_worker_;
+};
+
+// Reads the elements that a `DatasetToSharedMemory` op writes to the shared
+// memory buffer `buffer_name`, possibly from another process. The tensors of
+// each element point directly into shared memory.
+class SharedMemoryDatasetOp : public DatasetOpKernel {
+ public:
+  explicit SharedMemoryDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    tstring name;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<tstring>(ctx, "buffer_name", &name));
+    *output = new Dataset(ctx, name, output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const string& name,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          name_(name),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(
+          Iterator::Params{this, strings::StrCat(prefix, "::SharedMemory")});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "SharedMemoryDatasetOp::Dataset";
+    }
+
+    Status CheckExternalState() const override {
+      return errors::FailedPrecondition(
+          DebugString(), " depends on the shared memory buffer ", name_, ".");
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* name = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(name_, &name));
+      TF_RETURN_IF_ERROR(b->AddDataset(this, {name}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        // Waiting for the producer holds `mu_`, since elements must be read in
+        // order, but is cancelled along with the iterator so that a producer
+        // that never shows up or stalls cannot block it forever.
+        mutex_lock l(mu_);
+        if (end_of_sequence_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        if (buffer_ == nullptr) {
+          TF_RETURN_IF_ERROR(SharedMemoryRingBuffer::Open(
+              dataset()->name_, ctx->cancellation_manager(), &buffer_));
+          // Remove the name right away so that the segment is freed as soon
+          // as both processes are done with it, even if one of them crashes.
+          TF_RETURN_IF_ERROR(buffer_->Unlink());
+        }
+        TF_RETURN_IF_ERROR(buffer_->Read(ctx->cancellation_manager(),
+                                         out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          end_of_sequence_ = true;
+          return Status::OK();
+        }
+        if (out_tensors->size() != dataset()->output_types_.size()) {
+          return errors::InvalidArgument(
+              "Expected elements with ", dataset()->output_types_.size(),
+              " components from the shared memory buffer ", dataset()->name_,
+              ", but got ", out_tensors->size(), ".");
+        }
+        for (size_t i = 0; i < out_tensors->size(); ++i) {
+          if ((*out_tensors)[i].dtype() != dataset()->output_types_[i]) {
+            return errors::InvalidArgument(
+                "Expected component ", i, " of type ",
+                DataTypeString(dataset()->output_types_[i]),
+                " from the shared memory buffer ", dataset()->name_,
+                ", but got ", DataTypeString((*out_tensors)[i].dtype()), ".");
+          }
+        }
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return errors::Unimplemented(
+            "Checkpointing is currently not supported for "
+            "SharedMemoryDataset.");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(
+            "Checkpointing is currently not supported for "
+            "SharedMemoryDataset.");
+      }
+
+     private:
+      mutex mu_;
+      std::unique_ptr<SharedMemoryRingBuffer> buffer_ GUARDED_BY(mu_);
+      bool end_of_sequence_ GUARDED_BY(mu_) = false;
+    };
+
+    const string name_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DatasetToSharedMemory").Device(DEVICE_CPU),
+                        DatasetToSharedMemoryOp);
+REGISTER_KERNEL_BUILDER(Name("SharedMemoryDataset").Device(DEVICE_CPU),
+                        SharedMemoryDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
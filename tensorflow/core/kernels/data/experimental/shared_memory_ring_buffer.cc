@@ -0,0 +1,508 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(PLATFORM_WINDOWS)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr uint64 kMagic = 0x62726d6873646674;  // "tfdshmrb"
+constexpr uint32 kVersion = 1;
+constexpr size_t kAlignment = 64;
+constexpr size_t kMaxErrorMessageSize = 1024;
+
+// Slot states.
+constexpr uint32 kFree = 0;
+constexpr uint32 kFull = 1;
+
+// Producer states.
+constexpr uint32 kOpen = 0;
+constexpr uint32 kClosed = 1;
+
+size_t RoundUp(size_t value) {
+  return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+string SegmentName(const string& name) {
+  return strings::StrCat("/tf_data_", name);
+}
+
+// Waits for a state change of the other side. The first few attempts only
+// yield, so that a consumer that keeps up with its producer (or vice versa)
+// does not pay for a sleep. Fails with Cancelled once `cancellation_manager`
+// (if any) is cancelled.
+Status Backoff(const string& name, CancellationManager* cancellation_manager,
+               int* attempt) {
+  if (cancellation_manager != nullptr &&
+      cancellation_manager->IsCancelled()) {
+    return errors::Cancelled("Waiting for the shared memory buffer ", name,
+                             " was cancelled.");
+  }
+  constexpr int kMaxSpins = 16;
+  constexpr int64 kMaxSleepMicros = 1000;
+  if (*attempt < kMaxSpins) {
+    std::this_thread::yield();
+  } else {
+    Env::Default()->SleepForMicroseconds(
+        std::min(kMaxSleepMicros, int64{1} << std::min(*attempt - kMaxSpins,
+                                                       10)));
+  }
+  ++*attempt;
+  return Status::OK();
+}
+
+}  // namespace
+
+struct SharedMemoryRingBuffer::Header {
+  // Written last by the producer, once the rest of the header is initialized.
+  std::atomic<uint64> magic;
+  uint32 version;
+  uint32 num_slots;
+  uint64 slot_size;
+  // Offsets of the slot control entries and of the slot data from the start
+  // of the segment.
+  uint64 control_offset;
+  uint64 control_stride;
+  uint64 data_offset;
+  std::atomic<uint32> producer_state;
+  std::atomic<uint64> num_written;
+  int32 error_code;
+  char error_message[kMaxErrorMessageSize];
+};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "The shared memory ring buffer requires lock-free atomics, "
+              "which are address-free and can be shared across processes.");
+
+// A mapping of the shared memory segment. Each `Tensor` handed out by the
+// consumer indirectly holds a reference, so that the mapping outlives them.
+class SharedMemoryRingBuffer::Region : public core::RefCounted {
+ public:
+  Region(void* base, size_t size) : base_(base), size_(size) {}
+
+  ~Region() override {
+#if !defined(PLATFORM_WINDOWS)
+    if (munmap(base_, size_) != 0) {
+      LOG(WARNING) << "Failed to unmap shared memory: " << strerror(errno);
+    }
+#endif  // !defined(PLATFORM_WINDOWS)
+  }
+
+  char* base() const { return static_cast<char*>(base_); }
+
+ private:
+  void* const base_;
+  const size_t size_;
+};
+
+// Hands a slot back to the producer once the last tensor that points into it
+// is destroyed.
+class SharedMemoryRingBuffer::SlotLease : public core::RefCounted {
+ public:
+  SlotLease(Region* region, SlotControl* control)
+      : region_(region), control_(control) {
+    region_->Ref();
+  }
+
+  ~SlotLease() override {
+    control_->state.store(kFree, std::memory_order_release);
+    region_->Unref();
+  }
+
+ private:
+  Region* const region_;
+  SlotControl* const control_;
+};
+
+// A tensor buffer that points into a slot without owning the memory.
+class SharedMemoryRingBuffer::SlotBuffer : public TensorBuffer {
+ public:
+  SlotBuffer(SlotLease* lease, void* data, size_t size)
+      : TensorBuffer(data), lease_(lease), size_(size) {
+    lease_->Ref();
+  }
+
+  ~SlotBuffer() override { lease_->Unref(); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocated_bytes(size_);
+    proto->set_allocator_name("shared_memory");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  SlotLease* const lease_;
+  const size_t size_;
+};
+
+/* static */ constexpr int SharedMemoryRingBuffer::kMaxTensorsPerElement;
+/* static */ constexpr int SharedMemoryRingBuffer::kMaxRank;
+
+#if defined(PLATFORM_WINDOWS)
+
+Status SharedMemoryRingBuffer::Create(
+    const string& name, int64 num_slots, int64 slot_size,
+    std::unique_ptr<SharedMemoryRingBuffer>* result) {
+  return errors::Unimplemented(
+      "Shared memory ring buffers are not supported on Windows.");
+}
+
+Status SharedMemoryRingBuffer::Open(
+    const string& name, CancellationManager* cancellation_manager,
+    std::unique_ptr<SharedMemoryRingBuffer>* result) {
+  return errors::Unimplemented(
+      "Shared memory ring buffers are not supported on Windows.");
+}
+
+Status SharedMemoryRingBuffer::Unlink() {
+  return errors::Unimplemented(
+      "Shared memory ring buffers are not supported on Windows.");
+}
+
+#else
+
+Status SharedMemoryRingBuffer::Create(
+    const string& name, int64 num_slots, int64 slot_size,
+    std::unique_ptr<SharedMemoryRingBuffer>* result) {
+  if (name.empty() || name.find('/') != string::npos) {
+    return errors::InvalidArgument(
+        "The name of a shared memory buffer must be non-empty and must not "
+        "contain '/', but got: ",
+        name);
+  }
+  if (num_slots <= 0 || slot_size <= 0) {
+    return errors::InvalidArgument(
+        "The number of slots and the slot size must be positive, but got ",
+        num_slots, " and ", slot_size, ".");
+  }
+  const uint64 control_offset = RoundUp(sizeof(Header));
+  const uint64 control_stride = RoundUp(sizeof(SlotControl));
+  const uint64 data_offset = control_offset + num_slots * control_stride;
+  const uint64 aligned_slot_size = RoundUp(slot_size);
+  const uint64 size = data_offset + num_slots * aligned_slot_size;
+
+  const string segment_name = SegmentName(name);
+  int fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    if (errno == EEXIST) {
+      return errors::AlreadyExists("The shared memory buffer ", name,
+                                   " already exists.");
+    }
+    return errors::Internal("Failed to create shared memory buffer ", name,
+                            ": ", strerror(errno));
+  }
+  if (ftruncate(fd, size) != 0) {
+    Status s = errors::ResourceExhausted("Failed to allocate ", size,
+                                         " bytes of shared memory for ", name,
+                                         ": ", strerror(errno));
+    close(fd);
+    shm_unlink(segment_name.c_str());
+    return s;
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(segment_name.c_str());
+    return errors::Internal("Failed to map shared memory buffer ", name, ": ",
+                            strerror(errno));
+  }
+
+  // `ftruncate` zero-fills the segment, so all slots start out free.
+  Header* header = static_cast<Header*>(base);
+  header->version = kVersion;
+  header->num_slots = num_slots;
+  header->slot_size = aligned_slot_size;
+  header->control_offset = control_offset;
+  header->control_stride = control_stride;
+  header->data_offset = data_offset;
+  header->producer_state.store(kOpen, std::memory_order_relaxed);
+  header->num_written.store(0, std::memory_order_relaxed);
+  header->magic.store(kMagic, std::memory_order_release);
+
+  result->reset(new SharedMemoryRingBuffer(name, new Region(base, size),
+                                           /*is_producer=*/true));
+  return Status::OK();
+}
+
+Status SharedMemoryRingBuffer::Open(
+    const string& name, CancellationManager* cancellation_manager,
+    std::unique_ptr<SharedMemoryRingBuffer>* result) {
+  const string segment_name = SegmentName(name);
+  int attempt = 0;
+  while (true) {
+    int fd = shm_open(segment_name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      if (errno != ENOENT) {
+        return errors::Internal("Failed to open shared memory buffer ", name,
+                                ": ", strerror(errno));
+      }
+      TF_RETURN_IF_ERROR(Backoff(name, cancellation_manager, &attempt));
+      continue;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      Status s = errors::Internal("Failed to stat shared memory buffer ", name,
+                                  ": ", strerror(errno));
+      close(fd);
+      return s;
+    }
+    if (st.st_size < static_cast<off_t>(sizeof(Header))) {
+      // The producer has not sized the segment yet.
+      close(fd);
+      TF_RETURN_IF_ERROR(Backoff(name, cancellation_manager, &attempt));
+      continue;
+    }
+    void* base =
+        mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+      return errors::Internal("Failed to map shared memory buffer ", name,
+                              ": ", strerror(errno));
+    }
+    Region* region = new Region(base, st.st_size);
+    Header* header = static_cast<Header*>(base);
+    while (header->magic.load(std::memory_order_acquire) != kMagic) {
+      Status s = Backoff(name, cancellation_manager, &attempt);
+      if (!s.ok()) {
+        region->Unref();
+        return s;
+      }
+    }
+    if (header->version != kVersion) {
+      region->Unref();
+      return errors::FailedPrecondition(
+          "The shared memory buffer ", name, " has version ", header->version,
+          ", but version ", kVersion, " is expected.");
+    }
+    result->reset(
+        new SharedMemoryRingBuffer(name, region, /*is_producer=*/false));
+    return Status::OK();
+  }
+}
+
+Status SharedMemoryRingBuffer::Unlink() {
+  if (shm_unlink(SegmentName(name_).c_str()) != 0 && errno != ENOENT) {
+    return errors::Internal("Failed to unlink shared memory buffer ", name_,
+                            ": ", strerror(errno));
+  }
+  return Status::OK();
+}
+
+#endif  // defined(PLATFORM_WINDOWS)
+
+SharedMemoryRingBuffer::SharedMemoryRingBuffer(string name, Region* region,
+                                               bool is_producer)
+    : name_(std::move(name)),
+      region_(region),
+      header_(reinterpret_cast<Header*>(region->base())),
+      is_producer_(is_producer) {}
+
+SharedMemoryRingBuffer::~SharedMemoryRingBuffer() {
+  if (is_producer_ && header_->producer_state.load(
+                          std::memory_order_relaxed) == kOpen) {
+    Close(errors::Aborted("The producer of the shared memory buffer ", name_,
+                          " was destroyed before the end of the sequence."));
+  }
+  region_->Unref();
+}
+
+SharedMemoryRingBuffer::SlotControl* SharedMemoryRingBuffer::slot_control(
+    uint64 index) const {
+  return reinterpret_cast<SlotControl*>(
+      region_->base() + header_->control_offset +
+      (index % header_->num_slots) * header_->control_stride);
+}
+
+char* SharedMemoryRingBuffer::slot_data(uint64 index) const {
+  return region_->base() + header_->data_offset +
+         (index % header_->num_slots) * header_->slot_size;
+}
+
+Status SharedMemoryRingBuffer::Write(
+    const std::vector<Tensor>& element,
+    CancellationManager* cancellation_manager) {
+  DCHECK(is_producer_);
+  if (element.size() > kMaxTensorsPerElement) {
+    return errors::InvalidArgument(
+        "Elements written to a shared memory buffer can have at most ",
+        kMaxTensorsPerElement, " components, but got ", element.size(), ".");
+  }
+  uint64 total_bytes = 0;
+  for (const Tensor& t : element) {
+    if (!DataTypeCanUseMemcpy(t.dtype())) {
+      return errors::InvalidArgument(
+          "Tensors of type ", DataTypeString(t.dtype()),
+          " cannot be written to a shared memory buffer.");
+    }
+    if (t.dims() > kMaxRank) {
+      return errors::InvalidArgument(
+          "Tensors written to a shared memory buffer can have rank at most ",
+          kMaxRank, ", but got ", t.shape().DebugString(), ".");
+    }
+    total_bytes += RoundUp(t.TotalBytes());
+  }
+  if (total_bytes > header_->slot_size) {
+    return errors::InvalidArgument(
+        "An element of ", total_bytes,
+        " bytes does not fit in a shared memory buffer slot of ",
+        header_->slot_size, " bytes.");
+  }
+
+  SlotControl* control = slot_control(next_index_);
+  int attempt = 0;
+  while (control->state.load(std::memory_order_acquire) != kFree) {
+    TF_RETURN_IF_ERROR(Backoff(name_, cancellation_manager, &attempt));
+  }
+  char* data = slot_data(next_index_);
+  uint64 offset = 0;
+  control->num_tensors = element.size();
+  for (size_t i = 0; i < element.size(); ++i) {
+    const Tensor& t = element[i];
+    auto& metadata = control->tensors[i];
+    metadata.dtype = t.dtype();
+    metadata.rank = t.dims();
+    for (int d = 0; d < t.dims(); ++d) {
+      metadata.dims[d] = t.dim_size(d);
+    }
+    metadata.offset = offset;
+    metadata.num_bytes = t.TotalBytes();
+    if (metadata.num_bytes > 0) {
+      std::memcpy(data + offset, t.tensor_data().data(), metadata.num_bytes);
+    }
+    offset += RoundUp(metadata.num_bytes);
+  }
+  control->state.store(kFull, std::memory_order_release);
+  header_->num_written.fetch_add(1, std::memory_order_release);
+  ++next_index_;
+  return Status::OK();
+}
+
+void SharedMemoryRingBuffer::Close(const Status& status) {
+  DCHECK(is_producer_);
+  header_->error_code = status.code();
+  if (!status.ok()) {
+    strncpy(header_->error_message, status.error_message().c_str(),
+            kMaxErrorMessageSize - 1);
+    header_->error_message[kMaxErrorMessageSize - 1] = '\0';
+  }
+  header_->producer_state.store(kClosed, std::memory_order_release);
+}
+
+Status SharedMemoryRingBuffer::Read(CancellationManager* cancellation_manager,
+                                    std::vector<Tensor>* element,
+                                    bool* end_of_sequence) {
+  DCHECK(!is_producer_);
+  SlotControl* control = slot_control(next_index_);
+  int attempt = 0;
+  while (control->state.load(std::memory_order_acquire) != kFull) {
+    if (header_->producer_state.load(std::memory_order_acquire) == kClosed &&
+        header_->num_written.load(std::memory_order_acquire) == next_index_) {
+      if (header_->error_code != error::OK) {
+        return Status(static_cast<error::Code>(header_->error_code),
+                      header_->error_message);
+      }
+      *end_of_sequence = true;
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(Backoff(name_, cancellation_manager, &attempt));
+  }
+  // The metadata lives in memory that the other process can write to, so it
+  // is copied before it is validated, and never trusted afterwards.
+  const uint32 num_tensors = control->num_tensors;
+  if (num_tensors > kMaxTensorsPerElement) {
+    return errors::DataLoss("Slot ", next_index_ % header_->num_slots,
+                            " of the shared memory buffer ", name_, " holds ",
+                            num_tensors, " tensors, but at most ",
+                            kMaxTensorsPerElement, " are supported.");
+  }
+  const uint64 slot_size = header_->slot_size;
+  std::vector<SlotControl::TensorMetadata> metadata(
+      control->tensors, control->tensors + num_tensors);
+  std::vector<TensorShape> shapes(num_tensors);
+  for (uint32 i = 0; i < num_tensors; ++i) {
+    const auto& m = metadata[i];
+    const DataType dtype = static_cast<DataType>(m.dtype);
+    if (!DataType_IsValid(m.dtype) || !DataTypeCanUseMemcpy(dtype)) {
+      return errors::DataLoss("Tensor ", i, " in the shared memory buffer ",
+                              name_, " has invalid dtype ", m.dtype, ".");
+    }
+    if (m.rank < 0 || m.rank > kMaxRank) {
+      return errors::DataLoss("Tensor ", i, " in the shared memory buffer ",
+                              name_, " has invalid rank ", m.rank, ".");
+    }
+    Status s = TensorShapeUtils::MakeShape(m.dims, m.rank, &shapes[i]);
+    if (!s.ok()) {
+      return errors::DataLoss("Tensor ", i, " in the shared memory buffer ",
+                              name_, " has an invalid shape: ",
+                              s.error_message());
+    }
+    const uint64 expected_bytes =
+        shapes[i].num_elements() * DataTypeSize(dtype);
+    if (m.num_bytes != expected_bytes || m.offset > slot_size ||
+        m.num_bytes > slot_size - m.offset) {
+      return errors::DataLoss(
+          "Tensor ", i, " in the shared memory buffer ", name_, " of shape ",
+          shapes[i].DebugString(), " has ", m.num_bytes, " bytes at offset ",
+          m.offset, ", which does not fit in a slot of ", slot_size,
+          " bytes.");
+    }
+  }
+  // The lease is released once the last tensor that refers to it, and the
+  // local reference below, are gone.
+  SlotLease* lease = new SlotLease(region_, control);
+  char* data = slot_data(next_index_);
+  element->clear();
+  element->reserve(num_tensors);
+  for (uint32 i = 0; i < num_tensors; ++i) {
+    SlotBuffer* buffer =
+        new SlotBuffer(lease, data + metadata[i].offset, metadata[i].num_bytes);
+    element->emplace_back(static_cast<DataType>(metadata[i].dtype), shapes[i],
+                          buffer);
+    buffer->Unref();
+  }
+  lease->Unref();
+  ++next_index_;
+  *end_of_sequence = false;
+  return Status::OK();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A single-producer, single-consumer queue of dataset elements that lives in a
+// named POSIX shared memory segment, so that the producer and the consumer can
+// run in different processes on the same host.
+//
+// The segment consists of a small control region and `num_slots` data slots of
+// `slot_size` bytes each. The producer copies the tensors of an element into
+// the next free slot and publishes the element's dtypes, shapes and offsets in
+// the control region. The consumer builds `Tensor`s that point directly into
+// the slot, without copying, and the slot is handed back to the producer once
+// the last of those tensors is destroyed.
+//
+// Only tensors whose dtype can be copied with memcpy (i.e. not string, variant
+// or resource tensors) can be transferred.
+//
+// The calls that wait for the other side take an optional
+// `cancellation_manager`, and fail with Cancelled once it is cancelled, since
+// the other process may never show up or make progress.
+class SharedMemoryRingBuffer {
+ public:
+  // Maximum number of tensors in an element.
+  static constexpr int kMaxTensorsPerElement = 64;
+  // Maximum rank of a tensor in an element.
+  static constexpr int kMaxRank = 8;
+
+  // Creates the shared memory segment `name` for writing. Fails with
+  // AlreadyExists if a segment with that name exists.
+  static Status Create(const string& name, int64 num_slots, int64 slot_size,
+                       std::unique_ptr<SharedMemoryRingBuffer>* result);
+
+  // Opens the shared memory segment `name` for reading, waiting for the
+  // producer to create it.
+  static Status Open(const string& name,
+                     CancellationManager* cancellation_manager,
+                     std::unique_ptr<SharedMemoryRingBuffer>* result);
+
+  ~SharedMemoryRingBuffer();
+
+  // Copies `element` into the next slot, blocking while the consumer still
+  // holds it. Must only be called by the producer.
+  Status Write(const std::vector<Tensor>& element,
+               CancellationManager* cancellation_manager);
+
+  // Marks the end of the sequence. If `status` is not OK, the consumer fails
+  // with it instead of reaching the end of the sequence. Must only be called by
+  // the producer.
+  void Close(const Status& status);
+
+  // Stores the next element in `element`, blocking until the producer has
+  // written it, or sets `end_of_sequence` once the producer has closed the
+  // buffer and all elements have been read. Fails with DataLoss if the slot
+  // metadata written by the producer is malformed. Must only be called by the
+  // consumer.
+  Status Read(CancellationManager* cancellation_manager,
+              std::vector<Tensor>* element, bool* end_of_sequence);
+
+  // Removes the name of the segment, so that it is freed once both sides have
+  // unmapped it.
+  Status Unlink();
+
+ private:
+  class Region;
+  class SlotBuffer;
+  class SlotLease;
+  struct Header;
+
+  // The control entry of a slot, which describes the element in it.
+  struct SlotControl {
+    struct TensorMetadata {
+      int32 dtype;
+      int32 rank;
+      int64 dims[kMaxRank];
+      uint64 offset;
+      uint64 num_bytes;
+    };
+
+    std::atomic<uint32> state;
+    uint32 num_tensors;
+    TensorMetadata tensors[kMaxTensorsPerElement];
+  };
+
+  friend class SharedMemoryRingBufferTestPeer;
+
+  SharedMemoryRingBuffer(string name, Region* region, bool is_producer);
+
+  SlotControl* slot_control(uint64 index) const;
+  char* slot_data(uint64 index) const;
+
+  const string name_;
+  Region* const region_;  // Owns a reference.
+  Header* const header_;
+  const bool is_producer_;
+  uint64 next_index_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryRingBuffer);
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
@@ -0,0 +1,221 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Gives tests access to the slot metadata, to emulate a faulty producer.
+class SharedMemoryRingBufferTestPeer {
+ public:
+  static uint32* num_tensors(SharedMemoryRingBuffer* buffer, uint64 index) {
+    return &buffer->slot_control(index)->num_tensors;
+  }
+  static int32* rank(SharedMemoryRingBuffer* buffer, uint64 index, int i) {
+    return &buffer->slot_control(index)->tensors[i].rank;
+  }
+  static uint64* offset(SharedMemoryRingBuffer* buffer, uint64 index, int i) {
+    return &buffer->slot_control(index)->tensors[i].offset;
+  }
+};
+
+namespace {
+
+string UniqueName() {
+  return strings::StrCat("shared_memory_ring_buffer_test_", random::New64());
+}
+
+class SharedMemoryRingBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    name_ = UniqueName();
+    TF_ASSERT_OK(SharedMemoryRingBuffer::Create(name_, /*num_slots=*/2,
+                                                /*slot_size=*/1024,
+                                                &producer_));
+    TF_ASSERT_OK(SharedMemoryRingBuffer::Open(
+        name_, /*cancellation_manager=*/nullptr, &consumer_));
+    TF_ASSERT_OK(consumer_->Unlink());
+  }
+
+  string name_;
+  std::unique_ptr<SharedMemoryRingBuffer> producer_;
+  std::unique_ptr<SharedMemoryRingBuffer> consumer_;
+};
+
+TEST_F(SharedMemoryRingBufferTest, WriteAndRead) {
+  constexpr int kNumElements = 10;
+  std::unique_ptr<Thread> writer(Env::Default()->StartThread(
+      {}, "writer", [this]() {
+        for (int64 i = 0; i < kNumElements; ++i) {
+          TF_ASSERT_OK(producer_->Write(
+              {test::AsScalar<int64>(i),
+               test::AsTensor<float>({1.0f * i, 2.0f * i}, {2})},
+              /*cancellation_manager=*/nullptr));
+        }
+        producer_->Close(Status::OK());
+      }));
+  for (int64 i = 0; i < kNumElements; ++i) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = true;
+    TF_ASSERT_OK(consumer_->Read(nullptr, &element, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    ASSERT_EQ(element.size(), 2);
+    test::ExpectTensorEqual<int64>(element[0], test::AsScalar<int64>(i));
+    test::ExpectTensorEqual<float>(
+        element[1], test::AsTensor<float>({1.0f * i, 2.0f * i}, {2}));
+  }
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(consumer_->Read(nullptr, &element, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+}
+
+TEST_F(SharedMemoryRingBufferTest, SlotIsHeldUntilTensorsAreReleased) {
+  // Fill both slots.
+  TF_ASSERT_OK(producer_->Write({test::AsScalar<int64>(0)}, nullptr));
+  TF_ASSERT_OK(producer_->Write({test::AsScalar<int64>(1)}, nullptr));
+  std::vector<Tensor> element;
+  bool end_of_sequence;
+  TF_ASSERT_OK(consumer_->Read(nullptr, &element, &end_of_sequence));
+  Tensor first = element[0];
+  element.clear();
+
+  Notification written;
+  std::unique_ptr<Thread> writer(Env::Default()->StartThread(
+      {}, "writer", [this, &written]() {
+        TF_ASSERT_OK(producer_->Write({test::AsScalar<int64>(2)}, nullptr));
+        written.Notify();
+      }));
+  // The third element reuses the first slot, which `first` still points to.
+  EXPECT_FALSE(WaitForNotificationWithTimeout(&written, 100 * 1000));
+  test::ExpectTensorEqual<int64>(first, test::AsScalar<int64>(0));
+  first = Tensor();
+  written.WaitForNotification();
+}
+
+TEST_F(SharedMemoryRingBufferTest, ProducerErrorIsPropagated) {
+  TF_ASSERT_OK(producer_->Write({test::AsScalar<int64>(0)}, nullptr));
+  producer_->Close(errors::InvalidArgument("Something went wrong."));
+  std::vector<Tensor> element;
+  bool end_of_sequence;
+  TF_ASSERT_OK(consumer_->Read(nullptr, &element, &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  Status s = consumer_->Read(nullptr, &element, &end_of_sequence);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_EQ(s.error_message(), "Something went wrong.");
+}
+
+TEST_F(SharedMemoryRingBufferTest, DestroyingProducerAborts) {
+  producer_.reset();
+  std::vector<Tensor> element;
+  bool end_of_sequence;
+  EXPECT_TRUE(
+      errors::IsAborted(consumer_->Read(nullptr, &element, &end_of_sequence)));
+}
+
+TEST_F(SharedMemoryRingBufferTest, RejectsUnsupportedElements) {
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      producer_->Write({test::AsScalar<tstring>("string")}, nullptr)));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      producer_->Write({test::AsTensor<int64>(std::vector<int64>(1024))},
+                       nullptr)));
+}
+
+TEST_F(SharedMemoryRingBufferTest, ReadIsCancelled) {
+  CancellationManager cancellation_manager;
+  std::unique_ptr<Thread> canceller(
+      Env::Default()->StartThread({}, "canceller", [&cancellation_manager]() {
+        Env::Default()->SleepForMicroseconds(10 * 1000);
+        cancellation_manager.StartCancel();
+      }));
+  // Nothing is ever written, so only the cancellation ends the read.
+  std::vector<Tensor> element;
+  bool end_of_sequence;
+  Status s = consumer_->Read(&cancellation_manager, &element, &end_of_sequence);
+  EXPECT_TRUE(errors::IsCancelled(s)) << s;
+}
+
+TEST_F(SharedMemoryRingBufferTest, WriteIsCancelled) {
+  // Fill both slots, which the consumer never releases.
+  TF_ASSERT_OK(producer_->Write({test::AsScalar<int64>(0)}, nullptr));
+  TF_ASSERT_OK(producer_->Write({test::AsScalar<int64>(1)}, nullptr));
+  CancellationManager cancellation_manager;
+  cancellation_manager.StartCancel();
+  Status s =
+      producer_->Write({test::AsScalar<int64>(2)}, &cancellation_manager);
+  EXPECT_TRUE(errors::IsCancelled(s)) << s;
+}
+
+TEST_F(SharedMemoryRingBufferTest, RejectsMalformedSlots) {
+  std::vector<Tensor> element;
+  bool end_of_sequence;
+
+  TF_ASSERT_OK(producer_->Write({test::AsScalar<int64>(0)}, nullptr));
+  *SharedMemoryRingBufferTestPeer::num_tensors(producer_.get(), 0) =
+      SharedMemoryRingBuffer::kMaxTensorsPerElement + 1;
+  Status s = consumer_->Read(nullptr, &element, &end_of_sequence);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+  *SharedMemoryRingBufferTestPeer::num_tensors(producer_.get(), 0) = 1;
+
+  *SharedMemoryRingBufferTestPeer::rank(producer_.get(), 0, 0) =
+      SharedMemoryRingBuffer::kMaxRank + 1;
+  s = consumer_->Read(nullptr, &element, &end_of_sequence);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+  *SharedMemoryRingBufferTestPeer::rank(producer_.get(), 0, 0) = 0;
+
+  *SharedMemoryRingBufferTestPeer::offset(producer_.get(), 0, 0) = 1024;
+  s = consumer_->Read(nullptr, &element, &end_of_sequence);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+  *SharedMemoryRingBufferTestPeer::offset(producer_.get(), 0, 0) = 0;
+
+  // Once the metadata is valid again, the element can be read.
+  TF_ASSERT_OK(consumer_->Read(nullptr, &element, &end_of_sequence));
+  ASSERT_EQ(element.size(), 1);
+  test::ExpectTensorEqual<int64>(element[0], test::AsScalar<int64>(0));
+}
+
+TEST(SharedMemoryRingBufferOpenTest, OpenIsCancelled) {
+  CancellationManager cancellation_manager;
+  cancellation_manager.StartCancel();
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  Status s = SharedMemoryRingBuffer::Open(UniqueName(), &cancellation_manager,
+                                          &consumer);
+  EXPECT_TRUE(errors::IsCancelled(s)) << s;
+}
+
+TEST(SharedMemoryRingBufferCreateTest, AlreadyExists) {
+  const string name = UniqueName();
+  std::unique_ptr<SharedMemoryRingBuffer> first;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(name, /*num_slots=*/1,
+                                              /*slot_size=*/64, &first));
+  std::unique_ptr<SharedMemoryRingBuffer> second;
+  EXPECT_TRUE(errors::IsAlreadyExists(SharedMemoryRingBuffer::Create(
+      name, /*num_slots=*/1, /*slot_size=*/64, &second)));
+  TF_ASSERT_OK(first->Unlink());
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -55,11 +55,56 @@ const int64 kDefaultShardSizeBytes = 10LL * 1024 * 1024 * 1024;
 
 const size_t kHeaderSize = sizeof(uint64);
 
+// Uncompressed size after which a snapshot file starts a new chunk.
+const int64 kChunkSizeBytes = 64LL * 1024 * 1024;
+
 constexpr char kSnapshotFilename[] = "snapshot.metadata";
+constexpr char kSnapshotFileSuffix[] = ".snapshot";
+constexpr char kIndexFileSuffix[] = ".index";
 constexpr char kSnapshotReaderWorkerPool[] = "snapshot_reader_worker_pool";
 constexpr char kSnapshotWriterWorkerPool[] = "snapshot_writer_worker_pool";
 constexpr char kSeparator[] = "::";
 constexpr char kBookkeeping[] = "Bookkeeping";
+constexpr char kState[] = "state";
+
+// Forwards writes to another file and counts the bytes written, so that the
+// offsets of chunks are known even if the file does not support Tell().
+class ByteCountingFile : public WritableFile {
+ public:
+  explicit ByteCountingFile(WritableFile* file) : file_(file) {}
+
+  Status Append(StringPiece data) override {
+    TF_RETURN_IF_ERROR(file_->Append(data));
+    bytes_written_ += data.size();
+    return Status::OK();
+  }
+
+#if defined(PLATFORM_GOOGLE)
+  Status Append(const absl::Cord& cord) override {
+    TF_RETURN_IF_ERROR(file_->Append(cord));
+    bytes_written_ += cord.size();
+    return Status::OK();
+  }
+#endif  // PLATFORM_GOOGLE
+
+  // The owner of the underlying file is responsible for closing it.
+  Status Close() override { return Status::OK(); }
+  Status Flush() override { return file_->Flush(); }
+  Status Name(StringPiece* result) const override {
+    return file_->Name(result);
+  }
+  Status Sync() override { return file_->Sync(); }
+  Status Tell(int64* position) override {
+    *position = bytes_written_;
+    return Status::OK();
+  }
+
+  int64 bytes_written() const { return bytes_written_; }
+
+ private:
+  WritableFile* const file_;  // Not owned.
+  int64 bytes_written_ = 0;
+};
 
 class SnapshotWriter {
  public:
@@ -69,71 +114,127 @@ class SnapshotWriter {
 
   explicit SnapshotWriter(WritableFile* dest, const string& compression_type =
                                                   io::compression::kNone)
-      : dest_(dest), compression_type_(compression_type) {
-    if (compression_type == io::compression::kGzip) {
+      : file_(dest), dest_(&file_), compression_type_(compression_type) {
 #if defined(IS_SLIM_BUILD)
+    if (compression_type == io::compression::kGzip) {
       LOG(ERROR) << "Compression is unsupported on mobile platforms. Turning "
                  << "off compression.";
-#else   // IS_SLIM_BUILD
-      io::ZlibCompressionOptions zlib_options;
-      zlib_options = io::ZlibCompressionOptions::GZIP();
-
-      io::ZlibOutputBuffer* zlib_output_buffer = new io::ZlibOutputBuffer(
-          dest, zlib_options.input_buffer_size, zlib_options.output_buffer_size,
-          zlib_options);
-      TF_CHECK_OK(zlib_output_buffer->Init());
-      dest_ = zlib_output_buffer;
-      dest_is_owned_ = true;
-#endif  // IS_SLIM_BUILD
     }
+#endif  // IS_SLIM_BUILD
   }
 
   Status WriteRecord(const StringPiece& data) {
     profiler::TraceMe activity(
         absl::StrCat(kClassName, kSeparator, kWriteStringPiece),
         profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(MaybeStartChunk());
     char header[kHeaderSize];
     core::EncodeFixed64(header, data.size());
     TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
-    return dest_->Append(data);
+    TF_RETURN_IF_ERROR(dest_->Append(data));
+    return RecordWritten(data.size());
   }
 
 #if defined(PLATFORM_GOOGLE)
   Status WriteRecord(const absl::Cord& data) {
     profiler::TraceMe activity(absl::StrCat(kClassName, kSeparator, kWriteCord),
                                profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(MaybeStartChunk());
     char header[kHeaderSize];
     core::EncodeFixed64(header, data.size());
 
     TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
 
-    return dest_->Append(data);
+    TF_RETURN_IF_ERROR(dest_->Append(data));
+    return RecordWritten(data.size());
   }
 #endif  // PLATFORM_GOOGLE
 
+  // Finishes the last chunk. Does not close the file passed to the
+  // constructor.
   Status Close() {
-    if (dest_is_owned_) {
-      Status s = dest_->Close();
-      delete dest_;
-      dest_ = nullptr;
-      return s;
+    if (closed_) {
+      return Status::OK();
     }
-    return Status::OK();
+    closed_ = true;
+    return FinishChunk();
   }
 
+  // Returns the chunks written so far. Complete after `Close()`.
+  const experimental::SnapshotFileIndex& index() const { return index_; }
+
   ~SnapshotWriter() {
-    if (dest_ != nullptr) {
-      Status s = Close();
-      if (!s.ok()) {
-        LOG(ERROR) << "Could not finish writing file: " << s;
-      }
+    Status s = Close();
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not finish writing file: " << s;
     }
   }
 
  private:
-  WritableFile* dest_;
-  bool dest_is_owned_ = false;
+  // Starts a new chunk before the first record of the chunk is written, so
+  // that no empty chunks are written.
+  Status MaybeStartChunk() {
+    if (in_chunk_) {
+      return Status::OK();
+    }
+    in_chunk_ = true;
+    chunk_offset_ = file_.bytes_written();
+#if !defined(IS_SLIM_BUILD)
+    if (compression_type_ == io::compression::kGzip) {
+      // Each chunk is a separate gzip member, so that it can be decompressed
+      // without decompressing the chunks before it.
+      io::ZlibCompressionOptions zlib_options =
+          io::ZlibCompressionOptions::GZIP();
+      auto zlib_output_buffer = absl::make_unique<io::ZlibOutputBuffer>(
+          &file_, zlib_options.input_buffer_size,
+          zlib_options.output_buffer_size, zlib_options);
+      TF_RETURN_IF_ERROR(zlib_output_buffer->Init());
+      zlib_output_buffer_ = std::move(zlib_output_buffer);
+      dest_ = zlib_output_buffer_.get();
+    }
+#endif  // IS_SLIM_BUILD
+    return Status::OK();
+  }
+
+  Status RecordWritten(size_t record_size) {
+    ++chunk_num_elements_;
+    chunk_bytes_ += kHeaderSize + record_size;
+    if (chunk_bytes_ >= kChunkSizeBytes) {
+      return FinishChunk();
+    }
+    return Status::OK();
+  }
+
+  Status FinishChunk() {
+    if (!in_chunk_) {
+      return Status::OK();
+    }
+    in_chunk_ = false;
+    if (zlib_output_buffer_ != nullptr) {
+      dest_ = &file_;
+      Status s = zlib_output_buffer_->Close();
+      zlib_output_buffer_.reset();
+      TF_RETURN_IF_ERROR(s);
+    }
+    experimental::SnapshotFileIndex::Chunk* chunk = index_.add_chunks();
+    chunk->set_offset(chunk_offset_);
+    chunk->set_num_elements(chunk_num_elements_);
+    chunk_num_elements_ = 0;
+    chunk_bytes_ = 0;
+    return Status::OK();
+  }
+
+  ByteCountingFile file_;
+  std::unique_ptr<WritableFile> zlib_output_buffer_;
+  WritableFile* dest_;  // Either `file_` or `zlib_output_buffer_`.
   const string compression_type_;
+
+  experimental::SnapshotFileIndex index_;
+  bool in_chunk_ = false;
+  bool closed_ = false;
+  int64 chunk_offset_ = 0;
+  int64 chunk_num_elements_ = 0;
+  int64 chunk_bytes_ = 0;
 };
 
 class SnapshotReader {
@@ -142,11 +243,16 @@ class SnapshotReader {
   static constexpr const char* const kReadString = "ReadString";
   static constexpr const char* const kReadCord = "ReadCord";
 
+  // Reads the records of `file` starting at `offset`, which must be the start
+  // of a chunk.
   explicit SnapshotReader(
       RandomAccessFile* file,
-      const string& compression_type = io::compression::kNone)
-      : input_stream_(new io::RandomAccessInputStream(file)),
-        compression_type_(compression_type) {
+      const string& compression_type = io::compression::kNone,
+      int64 offset = 0)
+      : compression_type_(compression_type) {
+    auto input_stream = absl::make_unique<io::RandomAccessInputStream>(file);
+    TF_CHECK_OK(input_stream->Seek(offset));
+    input_stream_ = std::move(input_stream);
     if (compression_type_ == io::compression::kGzip) {
 #if defined(IS_SLIM_BUILD)
       LOG(ERROR) << "Compression is unsupported on mobile platforms. Turning "
@@ -191,6 +297,14 @@ class SnapshotReader {
   }
 #endif
 
+  // Skips the next record without reading its contents where possible.
+  Status SkipRecord() {
+    string header;
+    TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(kHeaderSize, &header));
+    uint64 length = core::DecodeFixed64(header.data());
+    return input_stream_->SkipNBytes(length);
+  }
+
  private:
   std::unique_ptr<io::InputStreamInterface> input_stream_;
   const string compression_type_;
@@ -232,6 +346,38 @@ Status ReadMetadataFile(const string& hash_dir,
   return Status::OK();
 }
 
+Status WriteIndexFile(const string& data_filename,
+                      const experimental::SnapshotFileIndex& index) {
+  string index_filename = absl::StrCat(data_filename, kIndexFileSuffix);
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(index_filename, &file));
+
+  auto writer = absl::make_unique<SnapshotWriter>(file.get());
+  TF_RETURN_IF_ERROR(writer->WriteRecord(index.SerializeAsString()));
+  TF_RETURN_IF_ERROR(writer->Close());
+  return file->Close();
+}
+
+// Returns NotFound if the data file has no index, e.g. because it was written
+// before indices were introduced.
+Status ReadIndexFile(const string& data_filename,
+                     experimental::SnapshotFileIndex* index) {
+  string index_filename = absl::StrCat(data_filename, kIndexFileSuffix);
+  TF_RETURN_IF_ERROR(Env::Default()->FileExists(index_filename));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(
+      Env::Default()->NewRandomAccessFile(index_filename, &file));
+
+  string record_bytes;
+  auto reader = absl::make_unique<SnapshotReader>(file.get());
+  TF_RETURN_IF_ERROR(reader->ReadRecord(&record_bytes));
+  if (!index->ParseFromString(record_bytes)) {
+    return errors::DataLoss("Could not parse snapshot index ", index_filename);
+  }
+  return Status::OK();
+}
+
 SnapshotMode DetermineOpState(
     const Status& file_status,
     const experimental::SnapshotMetadataRecord& metadata,
@@ -514,20 +660,46 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
      protected:
       Status SaveInternal(IteratorStateWriter* writer) override {
-        // TODO(frankchn): Make save iterators work
+        mutex_lock l(mu_);
+        // TODO(frankchn): Make save iterators work for writers.
+        if (iterator_ != nullptr && state_ == READER) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kState),
+                                                 static_cast<int64>(state_)));
+          TF_RETURN_IF_ERROR(SaveInput(writer, iterator_));
+        }
         return Status::OK();
       }
 
       Status RestoreInternal(IteratorContext* ctx,
                              IteratorStateReader* reader) override {
-        // TODO(frankchn): Make iterator restores work
-        return Status::OK();
+        mutex_lock l(mu_);
+        // TODO(frankchn): Make iterator restores work for writers.
+        if (!reader->Contains(full_name(kState))) {
+          return Status::OK();
+        }
+        experimental::SnapshotMetadataRecord metadata;
+        TF_RETURN_IF_ERROR(ReadMetadataFile(hash_dir_, &metadata));
+        if (!metadata.finalized()) {
+          return errors::FailedPrecondition(
+              "The checkpoint was taken while reading the snapshot in ",
+              hash_dir_, ", which is no longer finalized.");
+        }
+        state_ = READER;
+        iterator_ = absl::make_unique<SnapshotReaderIterator>(
+            SnapshotReaderIterator::Params{
+                dataset(), strings::StrCat(prefix(), "ReaderImpl")},
+            hash_dir_, metadata);
+        TF_RETURN_IF_ERROR(iterator_->Initialize(ctx));
+        return RestoreInput(ctx, reader, iterator_);
       }
 
      private:
       class SnapshotReaderIterator : public DatasetIterator<Dataset> {
        public:
         static constexpr const char* const kParse = "Parse";
+        static constexpr const char* const kRunId = "run_id";
+        static constexpr const char* const kNumTasks = "num_tasks";
+        static constexpr const char* const kNumConsumed = "num_consumed";
 
         explicit SnapshotReaderIterator(
             const Params& params, const string& hash_dir,
@@ -551,14 +723,33 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
                                                dataset()->num_reader_threads_);
           run_id_ = metadata_.run_id();
           run_dir_ = absl::StrCat(hash_dir_, "/", run_id_);
-          // Get all the files in the run_dir.
+          // Get all the data files in the run_dir.
+          std::vector<string> filenames;
           TF_RETURN_IF_ERROR(ctx->env()->GetMatchingPaths(
-              absl::StrCat(run_dir_, "/*"), &filenames_));
-          if (filenames_.empty()) {
+              absl::StrCat(run_dir_, "/*", kSnapshotFileSuffix), &filenames));
+          if (filenames.empty()) {
             return errors::InvalidArgument("Could not find any files in dir: ",
                                            run_dir_);
           }
-          std::sort(filenames_.begin(), filenames_.end());
+          std::sort(filenames.begin(), filenames.end());
+          // Split the files into chunks, so that the work is spread evenly
+          // across the reader threads and a restored iterator can resume in
+          // the middle of a file. Files without an index are read as a whole.
+          for (const string& filename : filenames) {
+            const string path =
+                absl::StrCat(dataset()->reader_path_prefix_, filename);
+            experimental::SnapshotFileIndex index;
+            Status s = ReadIndexFile(path, &index);
+            if (errors::IsNotFound(s)) {
+              tasks_.push_back({path, /*offset=*/0, /*num_elements=*/-1});
+              continue;
+            }
+            TF_RETURN_IF_ERROR(s);
+            for (const auto& chunk : index.chunks()) {
+              tasks_.push_back({path, chunk.offset(), chunk.num_elements()});
+            }
+          }
+          num_consumed_.assign(tasks_.size(), 0);
           return Status::OK();
         }
 
@@ -570,7 +761,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           if (!background_threads_started_) {
             for (int i = 0; i < dataset()->num_reader_threads_; ++i) {
               ++num_active_threads_;
-              thread_pool_->Schedule([this]() { ReadingFilesLoop(); });
+              thread_pool_->Schedule([this]() { ReadingTasksLoop(); });
             }
             background_threads_started_ = true;
           }
@@ -591,6 +782,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
             if (s.ok()) {
               *end_of_sequence = false;
               *out_tensors = std::move(buffer_.front().value);
+              ++num_consumed_[buffer_.front().task_index];
 
               {
                 profiler::TraceMe activity(
@@ -626,15 +818,83 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           return errors::Internal("Unreachable point in SnapshotReader");
         }
 
+       protected:
+        // The state consists of the number of elements returned from each
+        // chunk. Elements that were read but not returned yet are read again
+        // after restoring.
+        Status SaveInternal(IteratorStateWriter* writer) override {
+          mutex_lock l(mu_);
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kRunId), run_id_));
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(kNumTasks), static_cast<int64>(tasks_.size())));
+          for (size_t i = 0; i < tasks_.size(); ++i) {
+            if (num_consumed_[i] > 0) {
+              TF_RETURN_IF_ERROR(writer->WriteScalar(
+                  full_name(strings::StrCat(kNumConsumed, "_", i)),
+                  num_consumed_[i]));
+            }
+          }
+          return Status::OK();
+        }
+
+        Status RestoreInternal(IteratorContext* ctx,
+                               IteratorStateReader* reader) override {
+          mutex_lock l(mu_);
+          if (background_threads_started_) {
+            return errors::FailedPrecondition(
+                "Cannot restore a snapshot reader that has started reading.");
+          }
+          string run_id;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRunId), &run_id));
+          int64 num_tasks;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name(kNumTasks), &num_tasks));
+          if (run_id != run_id_ ||
+              num_tasks != static_cast<int64>(tasks_.size())) {
+            return errors::FailedPrecondition(
+                "The checkpoint was taken while reading snapshot run ", run_id,
+                " with ", num_tasks, " chunks, but the current snapshot run ",
+                "is ", run_id_, " with ", tasks_.size(), " chunks.");
+          }
+          for (size_t i = 0; i < tasks_.size(); ++i) {
+            const string key = full_name(strings::StrCat(kNumConsumed, "_", i));
+            num_consumed_[i] = 0;
+            if (reader->Contains(key)) {
+              TF_RETURN_IF_ERROR(reader->ReadScalar(key, &num_consumed_[i]));
+            }
+          }
+          return Status::OK();
+        }
+
        private:
-        // Reads one file end to end.
-        Status ReadFile(const string& filename) {
+        // A part of a data file to read: either a chunk listed in the file's
+        // index, or the whole file if it has no index.
+        struct ReadTask {
+          string filename;
+          int64 offset;
+          int64 num_elements;  // -1 to read until the end of the file.
+        };
+
+        // Reads the elements of `tasks_[task_index]`, skipping the first
+        // `num_to_skip` elements.
+        Status ProcessTask(size_t task_index, int64 num_to_skip) {
+          const ReadTask& task = tasks_[task_index];
           std::unique_ptr<RandomAccessFile> file;
-          TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename, &file));
-          std::unique_ptr<SnapshotReader> reader(
-              new SnapshotReader(file.get(), dataset()->compression_));
+          TF_RETURN_IF_ERROR(
+              Env::Default()->NewRandomAccessFile(task.filename, &file));
+          std::unique_ptr<SnapshotReader> reader(new SnapshotReader(
+              file.get(), dataset()->compression_, task.offset));
+          for (int64 i = 0; i < num_to_skip; ++i) {
+            Status s = reader->SkipRecord();
+            if (errors::IsOutOfRange(s)) {
+              return errors::DataLoss("Snapshot file ", task.filename,
+                                      " has fewer elements than expected.");
+            }
+            TF_RETURN_IF_ERROR(s);
+          }
 
-          while (true) {
+          int64 num_read = num_to_skip;
+          while (task.num_elements < 0 || num_read < task.num_elements) {
             // Wait for a slot in the buffer.
             {
               mutex_lock l(mu_);
@@ -646,7 +906,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
               if (cancelled_) {
                 return errors::Cancelled(
                     "SnapshotDatasetOp::Dataset::SnapshotReaderIterator::"
-                    "ReadFile");
+                    "ProcessTask");
               }
             }
 #if !defined(PLATFORM_GOOGLE)
@@ -677,11 +937,16 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
               BufferElement elem;
               std::swap(elem.value, out_tensors);
               elem.status = Status::OK();
+              elem.task_index = task_index;
+              ++num_read;
               mutex_lock l(mu_);
               buffer_.push_back(std::move(elem));
               cond_var_.notify_all();
-            } else if (errors::IsOutOfRange(s)) {
+            } else if (errors::IsOutOfRange(s) && task.num_elements < 0) {
               return Status::OK();
+            } else if (errors::IsOutOfRange(s)) {
+              return errors::DataLoss("Snapshot file ", task.filename,
+                                      " has fewer elements than expected.");
             } else {
               return s;
             }
@@ -689,36 +954,40 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           return Status::OK();
         }
 
-        // Pulls one file off the filenames_ list and reads it through. When
-        // all files are read, terminates.
-        void ReadingFilesLoop() {
+        // Pulls one task off the tasks_ list and reads it through. When all
+        // tasks are read, terminates.
+        void ReadingTasksLoop() {
           auto cleanup = gtl::MakeCleanup([this]() {
             mutex_lock l(mu_);
             --num_active_threads_;
             cond_var_.notify_all();
           });
           while (true) {
-            string filename = "";
+            size_t task_index;
+            int64 num_to_skip;
             {
               mutex_lock l(mu_);
-              if (next_file_index_ >= filenames_.size()) {
+              if (next_task_index_ >= tasks_.size()) {
                 return;
               }
-              filename = absl::StrCat(dataset()->reader_path_prefix_,
-                                      filenames_[next_file_index_]);
-              VLOG(2) << "Starting to read: " << filename;
-              next_file_index_++;
+              task_index = next_task_index_++;
+              num_to_skip = num_consumed_[task_index];
+              VLOG(2) << "Starting to read: " << tasks_[task_index].filename
+                      << " at offset " << tasks_[task_index].offset;
+            }
+            Status s = Status::OK();
+            if (num_to_skip != tasks_[task_index].num_elements) {
+              s = ProcessTask(task_index, num_to_skip);
             }
-            Status s = ReadFile(filename);
-            // If we get to the end of the file, it's a clean termination and
-            // we are at the end of the file. If all files have been processed,
-            // then we insert an end_of_sequence marker in the buffer and
-            // terminate the loop.
+            // If we get to the end of the task, it's a clean termination. If
+            // all tasks have been processed, then we insert an
+            // end_of_sequence marker in the buffer and terminate the loop.
             if (s.ok()) {
-              VLOG(2) << "Finished reading: " << filename;
+              VLOG(2) << "Finished reading: " << tasks_[task_index].filename
+                      << " at offset " << tasks_[task_index].offset;
               mutex_lock l(mu_);
-              num_files_done_++;
-              if (num_files_done_ >= filenames_.size()) {
+              num_tasks_done_++;
+              if (num_tasks_done_ >= tasks_.size()) {
                 background_threads_finished_ = true;
                 cond_var_.notify_all();
                 return;
@@ -738,6 +1007,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         struct BufferElement {
           Status status;
           std::vector<Tensor> value;
+          size_t task_index = 0;
         };
 
         mutex mu_;
@@ -747,13 +1017,15 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         const experimental::SnapshotMetadataRecord metadata_;
         string run_id_ GUARDED_BY(mu_);
         string run_dir_ GUARDED_BY(mu_);
-        std::vector<string> filenames_;
+        std::vector<ReadTask> tasks_;
+        // Number of elements of each task returned by GetNext.
+        std::vector<int64> num_consumed_ GUARDED_BY(mu_);
 
         uint64 elements_produced_ GUARDED_BY(mu_) = 0;
         int64 time_spent_micros_ GUARDED_BY(mu_) = 0;
         double kbytes_read_ GUARDED_BY(mu_) = 0;
-        size_t next_file_index_ GUARDED_BY(mu_) = 0;
-        int64 num_files_done_ GUARDED_BY(mu_) = 0;
+        size_t next_task_index_ GUARDED_BY(mu_) = 0;
+        size_t num_tasks_done_ GUARDED_BY(mu_) = 0;
 
         std::unique_ptr<thread::ThreadPool> thread_pool_;
         int64 num_active_threads_ GUARDED_BY(mu_) = 0;
@@ -877,7 +1149,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           mutex_lock l(mu_);
           string snapshot_data_filename = absl::StrCat(
               run_dir_, "/", strings::Printf("%08llu", next_file_index_),
-              ".snapshot");
+              kSnapshotFileSuffix);
           next_file_index_++;
           return snapshot_data_filename;
         }
@@ -978,6 +1250,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
               // If we exceed the shard size, we get a new file and reset.
               TF_RETURN_IF_ERROR((*writer)->Close());
               TF_RETURN_IF_ERROR((*file)->Close());
+              TF_RETURN_IF_ERROR(
+                  WriteIndexFile(*snapshot_data_filename, (*writer)->index()));
               *snapshot_data_filename = GetSnapshotFilename();
               TF_RETURN_IF_ERROR(Env::Default()->NewAppendableFile(
                   *snapshot_data_filename, file));
@@ -998,6 +1272,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           if (*end_of_processing) {
             TF_RETURN_IF_ERROR((*writer)->Close());
             TF_RETURN_IF_ERROR((*file)->Close());
+            TF_RETURN_IF_ERROR(
+                WriteIndexFile(*snapshot_data_filename, (*writer)->index()));
             mutex_lock l(mu_);
             if (!written_final_metadata_file_) {
               experimental::SnapshotMetadataRecord metadata;
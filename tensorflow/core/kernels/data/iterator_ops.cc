@@ -106,6 +106,39 @@ Status IteratorResource::Save(SerializationContext* ctx,
       "saving it.");
 }
 
+Status IteratorResource::GetStats(experimental::IteratorStats* stats) {
+  std::shared_ptr<State> captured_state;
+  {
+    tf_shared_lock l(mu_);
+    captured_state = iterator_state_;
+  }
+  if (!captured_state->iterator) {
+    return errors::FailedPrecondition(
+        "GetStats() failed because the iterator has not been initialized. "
+        "Ensure that you have run the initializer operation for this iterator "
+        "before getting its statistics.");
+  }
+  stats->Clear();
+  std::shared_ptr<model::Model> model = captured_state->iterator->model();
+  if (!model) {
+    // Autotuning is disabled, so there are no statistics to report.
+    return Status::OK();
+  }
+  model->EnableResourceUsageCollection();
+  for (const model::NodeStats& node_stats : model->CollectStats()) {
+    experimental::IteratorNodeStats* node = stats->add_nodes();
+    node->set_name(node_stats.name);
+    node->set_output(node_stats.output);
+    node->set_num_elements(node_stats.num_elements);
+    node->set_bytes_produced(node_stats.bytes_produced);
+    node->set_processing_time_nanos(node_stats.processing_time);
+    node->set_get_next_time_nanos(node_stats.get_next_time);
+    node->set_buffered_elements(node_stats.buffered_elements);
+    node->set_buffered_bytes(node_stats.buffered_bytes);
+  }
+  return Status::OK();
+}
+
 Status IteratorResource::Restore(OpKernelContext* ctx,
                                  IteratorStateReader* reader) {
   std::shared_ptr<State> captured_state;
@@ -1083,6 +1116,23 @@ class SerializeIteratorOp : public OpKernel {
   }
 };
 
+class IteratorGetStatsOp : public OpKernel {
+ public:
+  explicit IteratorGetStatsOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    IteratorResource* iterator_resource;
+    OP_REQUIRES_OK(
+        ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &iterator_resource));
+    core::ScopedUnref unref_iterator(iterator_resource);
+    experimental::IteratorStats stats;
+    OP_REQUIRES_OK(ctx, iterator_resource->GetStats(&stats));
+    Tensor* stats_t;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &stats_t));
+    stats_t->scalar<tstring>()() = stats.SerializeAsString();
+  }
+};
+
 class DeserializeIteratorOp : public OpKernel {
  public:
   explicit DeserializeIteratorOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
@@ -1172,6 +1222,8 @@ REGISTER_KERNEL_BUILDER(Name("IteratorFromStringHandleV2")
                             .HostMemory("string_handle")
                             .Priority(1),
                         IteratorFromStringHandleOp);
+REGISTER_KERNEL_BUILDER(Name("IteratorGetStats").Device(DEVICE_CPU),
+                        IteratorGetStatsOp);
 REGISTER_KERNEL_BUILDER(Name("SerializeIterator").Device(DEVICE_CPU),
                         SerializeIteratorOp);
 REGISTER_KERNEL_BUILDER(Name("DeserializeIterator").Device(DEVICE_CPU),
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/unbounded_thread_pool.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/protobuf/data/experimental/iterator_stats.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -52,6 +53,10 @@ class IteratorResource : public ResourceBase {
 
   Status Restore(OpKernelContext* ctx, IteratorStateReader* reader);
 
+  // Returns the statistics of the performance model of the iterator. Enables
+  // resource usage collection in the model if it was not enabled yet.
+  Status GetStats(experimental::IteratorStats* stats);
+
   Status SetIteratorFromDataset(OpKernelContext* ctx, DatasetBase* dataset);
 
   string DebugString() const override { return "Iterator resource"; }
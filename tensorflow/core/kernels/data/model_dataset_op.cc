@@ -50,7 +50,13 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES(ctx, cpu_budget_ > 0,
                 errors::InvalidArgument("CPU budget must be positive but is ",
                                         cpu_budget_, "."));
-    ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("ram_budget", &ram_budget_));
+    if (ram_budget_ == 0) {
+      ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    }
+    OP_REQUIRES(ctx, ram_budget_ > 0,
+                errors::InvalidArgument("RAM budget must be positive but is ",
+                                        ram_budget_, "."));
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -144,6 +150,8 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
                                     out_tensors, end_of_sequence);
       }
 
+      std::shared_ptr<model::Model> model() const override { return model_; }
+
      protected:
       std::shared_ptr<model::Node> CreateNode(
           IteratorContext* ctx, model::Node::Args args) const override {
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_interleave_dataset_op.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -62,6 +63,8 @@ namespace data {
 /* static */ constexpr const char* const
     ParallelInterleaveDatasetOp::kOutputShapes;
 /* static */ constexpr const char* const ParallelInterleaveDatasetOp::kSloppy;
+/* static */ constexpr const char* const
+    ParallelInterleaveDatasetOp::kMaxOutOfOrder;
 
 constexpr char kDataParallelInterleaveWorkerPool[] =
     "data_parallel_interleave_worker_pool";
@@ -71,6 +74,7 @@ constexpr char kCycleIndex[] = "cycle_index";
 constexpr char kEndOfInput[] = "end_of_input";
 constexpr char kElementIdCounter[] = "element_id_counter";
 constexpr char kNumOpen[] = "num_open";
+constexpr char kNumOutOfOrder[] = "num_out_of_order";
 constexpr char kCurrentElements[] = "current_elements";
 constexpr char kCurrentElementsSize[] = "current_elements.size";
 constexpr char kFutureElements[] = "future_elements";
@@ -98,6 +102,11 @@ constexpr double kPrefetchFactor = 2.0L;
 // is to achieve efficient CPU utilization when some of the threads perform I/O.
 constexpr double kCPUFactor = 2.0L;
 
+// `kMaxBufferedBlocks * block_length` is the largest number of results that a
+// current cycle element may buffer when the parallelism is autotuned. See
+// `MaybeDeepenBuffers()`.
+constexpr int64 kMaxBufferedBlocks = 4;
+
 // The motivation for creating an alternative implementation of parallel
 // interleave is to decouple the degree of parallelism from the cycle length.
 // This makes it possible to change the degree of parallelism (e.g. through
@@ -112,7 +121,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
           std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
           int64 block_length, int64 num_parallel_calls, bool sloppy,
-          const DataTypeVector& output_types,
+          int64 max_out_of_order, const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
@@ -121,6 +130,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         block_length_(block_length),
         num_parallel_calls_(num_parallel_calls),
         sloppy_(sloppy),
+        max_out_of_order_(max_out_of_order),
         output_types_(output_types),
         output_shapes_(output_shapes) {
     input_->Ref();
@@ -181,6 +191,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
     AttrValue sloppy_attr;
     b->BuildAttrValue(sloppy_, &sloppy_attr);
+    AttrValue max_out_of_order_attr;
+    b->BuildAttrValue(max_out_of_order_, &max_out_of_order_attr);
 
     TF_RETURN_IF_ERROR(b->AddDataset(this,
                                      {{0, input_node},
@@ -190,7 +202,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                                      {{1, other_arguments}},
                                      {{kFunc, f},
                                       {kTarguments, other_arguments_types_attr},
-                                      {kSloppy, sloppy_attr}},
+                                      {kSloppy, sloppy_attr},
+                                      {kMaxOutOfOrder, max_out_of_order_attr}},
                                      output));
     return Status::OK();
   }
@@ -307,6 +320,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kElementIdCounter),
                                              element_id_counter_));
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNumOpen), num_open_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNumOutOfOrder), num_out_of_order_));
       TF_RETURN_IF_ERROR(WriteCurrentElements(writer));
       TF_RETURN_IF_ERROR(WriteFutureElements(writer));
       return Status::OK();
@@ -324,6 +339,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                                             &element_id_counter_));
       if (reader->Contains(full_name(kEndOfInput))) end_of_input_ = true;
       TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumOpen), &num_open_));
+      if (reader->Contains(full_name(kNumOutOfOrder))) {
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumOutOfOrder),
+                                              &num_out_of_order_));
+      }
       TF_RETURN_IF_ERROR(ReadCurrentElements(ctx, reader));
       TF_RETURN_IF_ERROR(ReadFutureElements(ctx, reader));
       return Status::OK();
@@ -378,7 +397,20 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     bool Consume(std::shared_ptr<Result>* result)
         EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       if (!sloppy_) {
-        return ConsumeHelper(result);
+        if (ConsumeHelper(result)) {
+          num_out_of_order_ = 0;
+          return true;
+        }
+        // The cycle element whose turn it is has no result ready. Up to
+        // `max_out_of_order` results may be taken from the other cycle
+        // elements in the meantime; its position in the cycle is kept.
+        if (num_out_of_order_ < dataset()->max_out_of_order_ &&
+            ConsumeOutOfOrder(result)) {
+          ++num_out_of_order_;
+          return true;
+        }
+        MaybeDeepenBuffers();
+        return false;
       }
       // If we are allowed to be sloppy (i.e. return results out of order),
       // try to find an element in the cycle that has a result available.
@@ -391,6 +423,58 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       return false;
     }
 
+    // Consumes a ready result of a cycle element other than the one at
+    // `cycle_index_` without changing the position in the cycle. Returns
+    // whether a result was found.
+    bool ConsumeOutOfOrder(std::shared_ptr<Result>* result)
+        EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      for (int i = 1; i < dataset()->cycle_length_; ++i) {
+        const int64 idx = (cycle_index_ + i) % dataset()->cycle_length_;
+        std::shared_ptr<Element> element = current_elements_[idx];
+        if (!element) {
+          continue;
+        }
+        mutex_lock l(element->mu);
+        if (!element->results.empty() && element->results.front()->is_ready) {
+          std::swap(*result, element->results.front());
+          element->results.pop_front();
+          cond_var_->notify_all();
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Called when the consumer has to wait for the cycle element at
+    // `cycle_index_`. If the parallelism is autotuned and another cycle
+    // element sits idle with a full buffer, the slow element is holding up
+    // the output while threads have nothing to do, so the cycle elements are
+    // allowed to buffer further ahead of it (up to `kMaxBufferedBlocks`
+    // blocks). Whatever they buffer in the meantime is returned without
+    // waiting once the slow element catches up.
+    void MaybeDeepenBuffers() EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      if (dataset()->num_parallel_calls_ != model::kAutotune ||
+          buffered_blocks_ >= kMaxBufferedBlocks) {
+        return;
+      }
+      const int64 buffer_size = dataset()->block_length_ * buffered_blocks_;
+      for (int i = 1; i < dataset()->cycle_length_; ++i) {
+        const int64 idx = (cycle_index_ + i) % dataset()->cycle_length_;
+        std::shared_ptr<Element> element = current_elements_[idx];
+        if (!element || element->in_use || !element->iterator) {
+          continue;
+        }
+        mutex_lock l(element->mu);
+        if (static_cast<int64>(element->results.size()) >= buffer_size) {
+          buffered_blocks_ = std::min(2 * buffered_blocks_, kMaxBufferedBlocks);
+          VLOG(2) << "Buffering up to " << buffered_blocks_
+                  << " blocks per cycle element";
+          cond_var_->notify_all();
+          return;
+        }
+      }
+    }
+
     bool ConsumeHelper(std::shared_ptr<Result>* result)
         EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       while (true) {
@@ -452,7 +536,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       auto busy = [this]() EXCLUSIVE_LOCKS_REQUIRED(*mu_) -> bool {
         const bool has_more_elements =
             !future_elements_.empty() || !end_of_input_;
-        const int block_length = dataset()->block_length_;
+        const int64 buffer_size = dataset()->block_length_ * buffered_blocks_;
         bool all_elements_busy = true;
         for (auto& element : current_elements_) {
           if (!element) {
@@ -463,7 +547,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           } else {
             mutex_lock l(element->mu);
             if (!element->in_use && element->iterator &&
-                element->results.size() < block_length) {
+                element->results.size() < buffer_size) {
               all_elements_busy = false;
               break;
             }
@@ -507,10 +591,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           }
           std::shared_ptr<Element> element = current_elements_[idx];
           if (!element->in_use && element->iterator) {
+            // Fetch at most one block per call so that a thread is not tied
+            // to one element while others need results.
             int64 num_results;
             {
               mutex_lock l(element->mu);
-              num_results = dataset()->block_length_ - element->results.size();
+              num_results = std::min<int64>(
+                  dataset()->block_length_,
+                  dataset()->block_length_ * buffered_blocks_ -
+                      element->results.size());
             }
             if (num_results > 0) {
               current_num_calls_++;
@@ -931,6 +1020,14 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Identifies the number of open iterators.
     int64 num_open_ GUARDED_BY(*mu_) = 0;
 
+    // Identifies the number of results consumed out of order since the last
+    // result consumed in order.
+    int64 num_out_of_order_ GUARDED_BY(*mu_) = 0;
+
+    // Identifies the number of blocks of results that each current cycle
+    // element may buffer.
+    int64 buffered_blocks_ GUARDED_BY(*mu_) = 1;
+
     // Identifies the number of outstanding calls for CurrentElementsManager.
     int64 current_num_calls_ GUARDED_BY(*mu_) = 0;
     // Identifies the number of outstanding calls for FutureElementsManager.
@@ -953,6 +1050,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64 num_parallel_calls_;
   const int op_version_ = 2;
   const bool sloppy_;
+  const int64 max_out_of_order_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
 };
@@ -967,6 +1065,9 @@ ParallelInterleaveDatasetOp::ParallelInterleaveDatasetOp(
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kSloppy, &sloppy_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kMaxOutOfOrder, &max_out_of_order_));
+  OP_REQUIRES(ctx, max_out_of_order_ >= 0,
+              errors::InvalidArgument("`max_out_of_order` must be >= 0"));
 }
 
 void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -1007,7 +1108,7 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
 
   *output = new Dataset(ctx, input, std::move(captured_func), cycle_length,
                         block_length, num_parallel_calls, sloppy_,
-                        output_types_, output_shapes_);
+                        max_out_of_order_, output_types_, output_shapes_);
 }
 
 namespace {
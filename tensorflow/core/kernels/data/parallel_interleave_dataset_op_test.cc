@@ -11,6 +11,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_interleave_dataset_op.h"
 
+#include <algorithm>
+#include <set>
+#include <utility>
+
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 
 namespace tensorflow {
@@ -39,7 +43,7 @@ class ParallelInterleaveDatasetOpTest : public DatasetOpsTestBase {
       const FunctionDefHelper::AttrValueWrapper &func,
       const DataTypeVector &output_types,
       const std::vector<PartialTensorShape> &output_shapes, bool sloppy,
-      std::unique_ptr<OpKernel> *op_kernel) {
+      int64 max_out_of_order, std::unique_ptr<OpKernel> *op_kernel) {
     name_utils::OpNameParams params;
     params.op_version = kOpVersion;
     NodeDef node_def = test::function::NDef(
@@ -53,7 +57,8 @@ class ParallelInterleaveDatasetOpTest : public DatasetOpsTestBase {
          {ParallelInterleaveDatasetOp::kTarguments, {}},
          {ParallelInterleaveDatasetOp::kOutputTypes, output_types},
          {ParallelInterleaveDatasetOp::kOutputShapes, output_shapes},
-         {ParallelInterleaveDatasetOp::kSloppy, sloppy}});
+         {ParallelInterleaveDatasetOp::kSloppy, sloppy},
+         {ParallelInterleaveDatasetOp::kMaxOutOfOrder, max_out_of_order}});
     TF_RETURN_IF_ERROR(CreateOpKernel(node_def, op_kernel));
     return Status::OK();
   }
@@ -82,6 +87,7 @@ struct TestCase {
   std::vector<PartialTensorShape> expected_output_shapes;
   int64 expected_cardinality;
   std::vector<int> breakpoints;
+  int64 max_out_of_order = 0;
 };
 
 template <typename T>
@@ -447,6 +453,94 @@ TestCase InvalidNumParallelCallsTestCase() {
       /*breakpoints*/ {}};
 }
 
+// test case 14: cycle_length = 3, block_length = 1, num_parallel_calls = 2,
+// sloppy = false, max_out_of_order = 2
+TestCase BoundedOutOfOrderTestCase() {
+  return {
+      /*input_tensors*/
+      {CreateTensor<int64>(TensorShape{3, 3, 1}, {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+      /*func*/
+      MakeTensorSliceDatasetFunc(
+          DataTypeVector({DT_INT64}),
+          std::vector<PartialTensorShape>({PartialTensorShape({1})})),
+      /*func_lib*/ {test::function::MakeTensorSliceDataset()},
+      /*cycle_length*/
+      CreateTensor<int64>(TensorShape({}), {3}),
+      /*block_length*/
+      CreateTensor<int64>(TensorShape({}), {1}),
+      /*num_parallel_calls*/
+      CreateTensor<int64>(TensorShape({}), {2}),
+      /*sloppy*/ false,
+      /*expected_outputs*/
+      ConvertToTensorVec<int64>({0, 3, 6, 1, 4, 7, 2, 5, 8}),
+      /*expected_output_dtypes*/ {DT_INT64},
+      /*expected_output_shapes*/ {PartialTensorShape({1})},
+      /*expected_cardinality*/ tensorflow::data::kUnknownCardinality,
+      /*breakpoints*/ {0, 4, 11},
+      /*max_out_of_order*/ 2};
+}
+
+// Checks that the `outputs` of a deterministic interleave over the rows of
+// `input` deviate from the deterministic order only as much as
+// `max_out_of_order` allows: each cycle element produces its results in
+// order, and at most `max_out_of_order` results are taken from the other
+// cycle elements while the one whose turn it is has no result ready.
+// Assumes that block_length is 1 and that all the rows fit in the cycle, so
+// cycle element i produces the values of row i.
+Status ExpectBoundedOutOfOrder(const std::vector<Tensor> &outputs,
+                               const Tensor &input, int64 max_out_of_order) {
+  const int64 num_rows = input.dim_size(0);
+  const int64 row_size = input.NumElements() / num_rows;
+  const auto values = input.flat<int64>();
+  // The position of the next result of each cycle element.
+  std::vector<int64> next(num_rows, 0);
+  // The possible (cycle index, number of results taken out of order) states
+  // of the iterator. The iterator only moves past an exhausted cycle element
+  // once it learns it is exhausted, so there may be several.
+  std::set<std::pair<int64, int64>> states = {{0, 0}};
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const int64 value = outputs[i].flat<int64>()(0);
+    int64 element = 0;
+    while (element < num_rows &&
+           (next[element] == row_size ||
+            values(element * row_size + next[element]) != value)) {
+      ++element;
+    }
+    if (element == num_rows) {
+      return errors::Internal("Output ", i, " (", value,
+                              ") is not the next result of a cycle element.");
+    }
+
+    std::vector<std::pair<int64, int64>> closure(states.begin(), states.end());
+    for (size_t j = 0; j < closure.size(); ++j) {
+      const int64 cycle_index = closure[j].first;
+      if (next[cycle_index] == row_size) {
+        const std::pair<int64, int64> advanced = {
+            (cycle_index + 1) % num_rows, closure[j].second};
+        if (std::find(closure.begin(), closure.end(), advanced) ==
+            closure.end()) {
+          closure.push_back(advanced);
+        }
+      }
+    }
+    states.clear();
+    for (const auto &state : closure) {
+      if (state.first == element) {
+        states.insert({(element + 1) % num_rows, 0});
+      } else if (state.second < max_out_of_order) {
+        states.insert({state.first, state.second + 1});
+      }
+    }
+    if (states.empty()) {
+      return errors::Internal("Output ", i, " (", value,
+                              ") is more than ", max_out_of_order,
+                              " results out of order.");
+    }
+    ++next[element];
+  }
+  return Status::OK();
+}
+
 class ParameterizedParallelInterleaveDatasetOpTest
     : public ParallelInterleaveDatasetOpTest,
       public ::testing::WithParamInterface<TestCase> {};
@@ -461,7 +555,7 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, GetNext) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -499,7 +593,13 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, GetNext) {
   }
 
   TF_EXPECT_OK(ExpectEqual(out_tensors, test_case.expected_outputs,
-                           /*compare_order*/ !test_case.sloppy));
+                           /*compare_order*/ !test_case.sloppy &&
+                               test_case.max_out_of_order == 0));
+  if (!test_case.sloppy && test_case.max_out_of_order > 0) {
+    TF_EXPECT_OK(ExpectBoundedOutOfOrder(out_tensors,
+                                         test_case.input_tensors[0],
+                                         test_case.max_out_of_order));
+  }
 }
 
 TEST_F(ParallelInterleaveDatasetOpTest, InvalidArguments) {
@@ -515,7 +615,7 @@ TEST_F(ParallelInterleaveDatasetOpTest, InvalidArguments) {
     TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
         test_case.func, test_case.expected_output_dtypes,
         test_case.expected_output_shapes, test_case.sloppy,
-        &parallel_interleave_dataset_kernel));
+        test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
     Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
     std::vector<Tensor> inputs_for_tensor_slice_dataset =
@@ -551,7 +651,7 @@ TEST_F(ParallelInterleaveDatasetOpTest, DatasetNodeName) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -586,7 +686,7 @@ TEST_F(ParallelInterleaveDatasetOpTest, DatasetTypeString) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -625,7 +725,7 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, DatasetOutputDtypes) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -661,7 +761,7 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, DatasetOutputShapes) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -698,7 +798,7 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, Cardinality) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -734,7 +834,7 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, IteratorOutputDtypes) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -777,7 +877,7 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, IteratorOutputShapes) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -820,7 +920,7 @@ TEST_F(ParallelInterleaveDatasetOpTest, IteratorOutputPrefix) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -865,7 +965,7 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, Roundtrip) {
   TF_ASSERT_OK(CreateParallelInterleaveDatasetKernel(
       test_case.func, test_case.expected_output_dtypes,
       test_case.expected_output_shapes, test_case.sloppy,
-      &parallel_interleave_dataset_kernel));
+      test_case.max_out_of_order, &parallel_interleave_dataset_kernel));
 
   Tensor tensor_slice_dataset_tensor(DT_VARIANT, TensorShape({}));
   std::vector<Tensor> inputs_for_tensor_slice_dataset = test_case.input_tensors;
@@ -920,7 +1020,13 @@ TEST_P(ParameterizedParallelInterleaveDatasetOpTest, Roundtrip) {
   }
 
   TF_EXPECT_OK(ExpectEqual(out_tensors, test_case.expected_outputs,
-                           /*compare_order*/ !test_case.sloppy));
+                           /*compare_order*/ !test_case.sloppy &&
+                               test_case.max_out_of_order == 0));
+  if (!test_case.sloppy && test_case.max_out_of_order > 0) {
+    TF_EXPECT_OK(ExpectBoundedOutOfOrder(out_tensors,
+                                         test_case.input_tensors[0],
+                                         test_case.max_out_of_order));
+  }
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -928,7 +1034,8 @@ INSTANTIATE_TEST_SUITE_P(
     ParameterizedParallelInterleaveDatasetOpTest,
     ::testing::ValuesIn(std::vector<TestCase>(
         {TestCase1(), TestCase2(), TestCase3(), TestCase4(), TestCase5(),
-         TestCase6(), TestCase7(), TestCase8(), TestCase9(), TestCase10()})));
+         TestCase6(), TestCase7(), TestCase8(), TestCase9(), TestCase10(),
+         BoundedOutOfOrderTestCase()})));
 
 }  // namespace
 }  // namespace data
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/checkpoint_element_store.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -36,6 +37,7 @@ namespace data {
 
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kInputDataset;
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kBufferSize;
+/* static */ constexpr const char* const ShuffleDatasetOpBase::kBufferSizeBytes;
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kSeed;
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kSeed2;
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kOutputTypes;
@@ -61,6 +63,7 @@ constexpr char kSlicesStart[] = "slices_start";
 constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kBuffer[] = "buffer";
 constexpr char kSize[] = "size";
+constexpr char kPath[] = "path";
 constexpr char kRandomSeedGenerator[] = "RandomSeedGenerator";
 constexpr char kTFData[] = "tf_data";
 constexpr char kDSNumRandomSamples[] = "ds_num_random_samples";
@@ -75,10 +78,11 @@ ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
 class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
  public:
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                     int64 buffer_size, int64 count)
+                     int64 buffer_size, int64 buffer_size_bytes, int64 count)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
+        buffer_size_bytes_(buffer_size_bytes),
         count_(count) {
     input_->Ref();
   }
@@ -123,6 +127,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           generator_(&parent_generator_) {
       buffer_ = absl::make_unique<std::vector<Tensor>[]>(
           params.dataset->buffer_size_);
+      buffer_paths_ = absl::make_unique<string[]>(params.dataset->buffer_size_);
       slices_.push_back(absl::make_unique<Slice>(0, 0));
     }
 
@@ -138,7 +143,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
             ctx, this->prefix(), &input_impl_));
       }
-      while (input_impl_ && num_elements_ < this->dataset()->buffer_size_) {
+      while (input_impl_ && num_elements_ < this->dataset()->buffer_size_ &&
+             !BufferBytesExhausted()) {
         if (ctx->env()->NowMicros() >
             ((num_log_entries + 1) * kLogIntervalMicros) + start_micros) {
           num_log_entries++;
@@ -175,8 +181,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
                     << this->dataset()->buffer_size_;
           }
           this->RecordBufferEnqueue(ctx, input_element);
-          buffer_[slices_.back()->end % this->dataset()->buffer_size_] =
-              std::move(input_element);
+          num_bytes_ += GetAllocatedBytes(input_element);
+          const int64 index =
+              slices_.back()->end % this->dataset()->buffer_size_;
+          buffer_[index] = std::move(input_element);
+          buffer_paths_[index].clear();
           num_elements_++;
           slices_.back()->end++;
         } else {
@@ -211,9 +220,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             (slices_.front()->start + offset) % this->dataset()->buffer_size_;
         *out_tensors = std::move(buffer_[index]);
         this->RecordBufferDequeue(ctx, *out_tensors);
-        std::swap(
-            buffer_[index],
-            buffer_[slices_.front()->start % this->dataset()->buffer_size_]);
+        num_bytes_ -= GetAllocatedBytes(*out_tensors);
+        const int64 start_index =
+            slices_.front()->start % this->dataset()->buffer_size_;
+        std::swap(buffer_[index], buffer_[start_index]);
+        std::swap(buffer_paths_[index], buffer_paths_[start_index]);
         slices_.front()->start++;
         num_elements_--;
       } else {
@@ -255,7 +266,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(this->SaveInput(writer, input_impl_));
       }
 
-      // Save the epoch counter, buffer, and buffer slices.
+      // Save the epoch counter, buffer, and buffer slices. If a checkpoint
+      // element store is configured, the buffered elements are written to it
+      // and only their paths go into the checkpoint.
+      CheckpointElementStore* store = CheckpointElementStore::Default();
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kEpoch), epoch_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kNumElements), num_elements_));
@@ -271,6 +285,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             slices_[i]->end));
         for (size_t j = slices_[i]->start; j < slices_[i]->end; ++j) {
           size_t index = j % this->dataset()->buffer_size_;
+          if (store != nullptr) {
+            if (buffer_paths_[index].empty()) {
+              TF_RETURN_IF_ERROR(
+                  store->Write(buffer_[index], &buffer_paths_[index]));
+            }
+            TF_RETURN_IF_ERROR(writer->WriteScalar(
+                this->full_name(
+                    absl::StrJoin(std::make_tuple(kBuffer, index, kPath), "_")),
+                buffer_paths_[index]));
+            continue;
+          }
           TF_RETURN_IF_ERROR(writer->WriteScalar(
               this->full_name(
                   absl::StrJoin(std::make_tuple(kBuffer, index, kSize), "_")),
@@ -319,6 +344,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       }
       buffer_ = absl::make_unique<std::vector<Tensor>[]>(
           this->dataset()->buffer_size_);
+      buffer_paths_ =
+          absl::make_unique<string[]>(this->dataset()->buffer_size_);
+      num_bytes_ = 0;
       for (size_t i = 0; i < slices_size; ++i) {
         int64 start;
         TF_RETURN_IF_ERROR(
@@ -332,6 +360,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         slices_.push_back(absl::make_unique<Slice>(start, end));
         for (size_t j = start; j < end; ++j) {
           size_t index = j % this->dataset()->buffer_size_;
+          const string path_key = this->full_name(
+              absl::StrJoin(std::make_tuple(kBuffer, index, kPath), "_"));
+          if (reader->Contains(path_key)) {
+            tstring path;
+            TF_RETURN_IF_ERROR(reader->ReadScalar(path_key, &path));
+            buffer_paths_[index] = string(path);
+            TF_RETURN_IF_ERROR(CheckpointElementStore::Read(
+                buffer_paths_[index], &buffer_[index]));
+            num_bytes_ += GetAllocatedBytes(buffer_[index]);
+            continue;
+          }
           int64 list_size;
           TF_RETURN_IF_ERROR(reader->ReadScalar(
               this->full_name(
@@ -344,6 +383,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
                     absl::StrJoin(std::make_tuple(kBuffer, index, k), "_")),
                 &buffer_[index][k]));
           }
+          num_bytes_ += GetAllocatedBytes(buffer_[index]);
         }
       }
 
@@ -374,10 +414,22 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return out;
     }
 
+    // Returns true if the elements in `buffer_` use up the byte budget of the
+    // dataset, in which case no more elements should be added to it.
+    bool BufferBytesExhausted() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return this->dataset()->buffer_size_bytes_ > 0 &&
+             num_bytes_ >= this->dataset()->buffer_size_bytes_;
+    }
+
     std::unique_ptr<std::vector<Tensor>[]> buffer_ GUARDED_BY(mu_);
+    // Paths of the elements in `buffer_` in the checkpoint element store, or
+    // empty if an element has not been written to it yet.
+    std::unique_ptr<string[]> buffer_paths_ GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
     int64 epoch_ GUARDED_BY(mu_);
     int64 num_elements_ GUARDED_BY(mu_);
+    // Total allocated bytes of the elements in `buffer_`.
+    int64 num_bytes_ GUARDED_BY(mu_) = 0;
     std::deque<std::unique_ptr<Slice>> slices_ GUARDED_BY(mu_);
     random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
     random::SingleSampleAdapter<random::PhiloxRandom> generator_
@@ -385,8 +437,23 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     int64 num_random_samples_ GUARDED_BY(mu_) = 0;
   };
 
+  // Appends the `buffer_size_bytes` attr to `attrs` if a byte budget is set,
+  // so that graphs without one remain readable by older binaries.
+  void AddBufferSizeBytesAttr(
+      DatasetGraphDefBuilder* b,
+      std::vector<std::pair<StringPiece, AttrValue>>* attrs) const {
+    if (buffer_size_bytes_ > 0) {
+      AttrValue buffer_size_bytes;
+      b->BuildAttrValue(buffer_size_bytes_, &buffer_size_bytes);
+      attrs->emplace_back(kBufferSizeBytes, buffer_size_bytes);
+    }
+  }
+
   const DatasetBase* const input_;
   const int64 buffer_size_;
+  // If positive, the shuffle buffer stops filling up once its elements use
+  // this many bytes, even if it holds fewer than `buffer_size_` elements.
+  const int64 buffer_size_bytes_;
   const int64 count_;
 };
 
@@ -395,8 +462,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 class ShuffleDatasetOp::ReshufflingDataset : public ShuffleDatasetBase {
  public:
   ReshufflingDataset(OpKernelContext* ctx, const DatasetBase* input,
-                     int64 buffer_size, int64 seed, int64 seed2, int64 count)
-      : ShuffleDatasetBase(ctx, input, buffer_size, count),
+                     int64 buffer_size, int64 buffer_size_bytes, int64 seed,
+                     int64 seed2, int64 count)
+      : ShuffleDatasetBase(ctx, input, buffer_size, buffer_size_bytes, count),
         seed_(seed),
         seed2_(seed2) {}
 
@@ -508,10 +576,12 @@ class ShuffleDatasetOp::ReshufflingDataset : public ShuffleDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
     TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
     b->BuildAttrValue(true, &reshuffle_each_iteration);
+    std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddBufferSizeBytesAttr(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this, {input_graph_node, buffer_size, seed, seed2},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
+        attrs,                                               // Attrs
         output));
     return Status::OK();
   }
@@ -526,10 +596,10 @@ class ShuffleDatasetOp::ReshufflingDataset : public ShuffleDatasetBase {
 class ShuffleDatasetOp::ReshufflingDatasetV2 : public ShuffleDatasetBase {
  public:
   ReshufflingDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
-                       int64 buffer_size, int64 count,
+                       int64 buffer_size, int64 buffer_size_bytes, int64 count,
                        const Tensor& resource_handle,
                        RandomSeedGenerator* seed_generator)
-      : ShuffleDatasetBase(ctx, input, buffer_size, count),
+      : ShuffleDatasetBase(ctx, input, buffer_size, buffer_size_bytes, count),
         resource_handle_(resource_handle),
         seed_generator_(seed_generator) {}
 
@@ -613,10 +683,12 @@ class ShuffleDatasetOp::ReshufflingDatasetV2 : public ShuffleDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size_node));
     Node* resource_handle_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+    std::vector<std::pair<StringPiece, AttrValue>> attrs;
+    AddBufferSizeBytesAttr(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
         {input_graph_node, buffer_size_node, resource_handle_node},  // Inputs
-        {},                                                          // Attrs
+        attrs,                                                       // Attrs
         output));
     return Status::OK();
   }
@@ -631,8 +703,9 @@ class ShuffleDatasetOp::ReshufflingDatasetV2 : public ShuffleDatasetBase {
 class ShuffleDatasetOp::FixedSeedDataset : public ShuffleDatasetBase {
  public:
   FixedSeedDataset(OpKernelContext* ctx, const DatasetBase* input,
-                   int64 buffer_size, int64 seed, int64 seed2, int64 count)
-      : ShuffleDatasetBase(ctx, input, buffer_size, count),
+                   int64 buffer_size, int64 buffer_size_bytes, int64 seed,
+                   int64 seed2, int64 count)
+      : ShuffleDatasetBase(ctx, input, buffer_size, buffer_size_bytes, count),
         seed_(seed),
         seed2_(seed2) {}
 
@@ -666,10 +739,12 @@ class ShuffleDatasetOp::FixedSeedDataset : public ShuffleDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
     TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
     b->BuildAttrValue(false, &reshuffle_each_iteration);
+    std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+        std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)};
+    AddBufferSizeBytesAttr(b, &attrs);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this, {input_graph_node, buffer_size, seed, seed2},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
+        attrs,                                               // Attrs
         output));
     return Status::OK();
   }
@@ -686,6 +761,12 @@ ShuffleDatasetOp::ShuffleDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
   }
+  if (ctx->HasAttr(kBufferSizeBytes)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kBufferSizeBytes, &buffer_size_bytes_));
+    OP_REQUIRES(ctx, buffer_size_bytes_ >= 0,
+                errors::InvalidArgument("buffer_size_bytes must be greater "
+                                        "than or equal to zero."));
+  }
 }
 
 void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -704,8 +785,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
         ctx, LookupResource(ctx, HandleFromInput(ctx, 2), &seed_generator));
     // Transferring ownership of seed generator reference onto
     // `ReshufflingDatasetV2`.
-    *output = new ReshufflingDatasetV2(ctx, input, buffer_size, count,
-                                       ctx->input(2), seed_generator);
+    *output =
+        new ReshufflingDatasetV2(ctx, input, buffer_size, buffer_size_bytes_,
+                                 count, ctx->input(2), seed_generator);
     return;
   }
 
@@ -723,10 +805,11 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   }
 
   if (reshuffle_each_iteration_) {
-    *output =
-        new ReshufflingDataset(ctx, input, buffer_size, seed, seed2, count);
+    *output = new ReshufflingDataset(ctx, input, buffer_size,
+                                     buffer_size_bytes_, seed, seed2, count);
   } else {
-    *output = new FixedSeedDataset(ctx, input, buffer_size, seed, seed2, count);
+    *output = new FixedSeedDataset(ctx, input, buffer_size, buffer_size_bytes_,
+                                   seed, seed2, count);
   }
 }
 
@@ -734,7 +817,8 @@ class ShuffleAndRepeatDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
           int64 seed, int64 seed2, int64 count)
-      : ShuffleDatasetBase(ctx, input, buffer_size, count),
+      : ShuffleDatasetBase(ctx, input, buffer_size, /*buffer_size_bytes=*/0,
+                           count),
         seed_(seed),
         seed2_(seed2) {}
 
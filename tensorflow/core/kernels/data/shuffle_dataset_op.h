@@ -24,6 +24,7 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
  public:
   static constexpr const char* const kInputDataset = "input_dataset";
   static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kBufferSizeBytes = "buffer_size_bytes";
   static constexpr const char* const kSeed = "seed";
   static constexpr const char* const kSeed2 = "seed2";
   static constexpr const char* const kOutputTypes = "output_types";
@@ -53,6 +54,7 @@ class ShuffleDatasetOp : public ShuffleDatasetOpBase {
   class FixedSeedDataset;
   int op_version_;
   bool reshuffle_each_iteration_;
+  int64 buffer_size_bytes_ = 0;
 };
 
 class ShuffleAndRepeatDatasetOp : public ShuffleDatasetOpBase {
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -38,6 +39,22 @@ namespace data {
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
+// Number of reads of `buffer_size` bytes to keep in flight for each file.
+constexpr char kReadaheadBuffersEnvVar[] = "TF_DATA_TFRECORD_READAHEAD_BUFFERS";
+
+namespace {
+
+int64 ReadaheadBuffersFromEnv() {
+  int64 num_buffers;
+  Status s = ReadInt64FromEnvVar(kReadaheadBuffersEnvVar, 0, &num_buffers);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << kReadaheadBuffersEnvVar << ": " << s;
+    return 0;
+  }
+  return num_buffers;
+}
+
+}  // namespace
 
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
@@ -50,6 +67,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
             compression_type)) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
+      options_.readahead_num_buffers = ReadaheadBuffersFromEnv();
     }
   }
 
@@ -0,0 +1,267 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/crop_resize_bilinear_core.h"
+#include "tensorflow/core/kernels/image_resizer_state.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the largest DCT scaling denominator libjpeg supports (1, 2, 4 or 8)
+// for which the decoded crop window is still at least `out_height` x
+// `out_width`.
+int ChooseScaleDenom(int crop_height, int crop_width, int out_height,
+                     int out_width) {
+  int ratio = 8;
+  while (ratio > 1 &&
+         (crop_height / ratio < out_height || crop_width / ratio < out_width)) {
+    ratio /= 2;
+  }
+  return ratio;
+}
+
+// Size of the image that libjpeg decodes with the given scaling denominator.
+int ScaledSize(int size, int ratio) { return (size + ratio - 1) / ratio; }
+
+}  // namespace
+
+// Decodes a batch of JPEG images, crops each of them and resizes them to a
+// common size, writing into one batched float output. Each image is decoded
+// with libjpeg's DCT-domain downscaling at the smallest resolution that is
+// still no smaller than the target, which skips most of the IDCT and color
+// conversion work for large images, and the images are decoded in parallel.
+class DecodeAndResizeJpegBatchOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegBatchOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("half_pixel_centers",
+                                             &half_pixel_centers_));
+
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    // The TensorFlow-chosen default for jpeg decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method = JDCT_IFAST;
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents.shape().DebugString()));
+    const int64 batch_size = contents.dim_size(0);
+
+    const Tensor& crop_windows = context->input(1);
+    OP_REQUIRES(context,
+                crop_windows.dims() == 2 &&
+                    crop_windows.dim_size(0) == batch_size &&
+                    crop_windows.dim_size(1) == 4,
+                errors::InvalidArgument(
+                    "crop_windows must have shape [", batch_size,
+                    ", 4], got ", crop_windows.shape().DebugString()));
+
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument("size must be 1-D with 2 elements, "
+                                        "got shape ",
+                                        size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        out_height, ", ", out_width, "]"));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({batch_size, out_height, out_width,
+                                       channels_}),
+                       &output));
+    if (batch_size == 0) return;
+
+    const auto contents_vec = contents.vec<tstring>();
+    const auto crop_windows_mat = crop_windows.matrix<int32>();
+    auto output_data = output->tensor<float, 4>();
+    const int64 out_image_size =
+        static_cast<int64>(out_height) * out_width * channels_;
+
+    std::vector<Status> statuses(batch_size);
+    auto decode_images = [&](const int64 begin, const int64 end) {
+      for (int64 b = begin; b < end; ++b) {
+        statuses[b] = DecodeAndResize(
+            contents_vec(b), crop_windows_mat(b, 0), crop_windows_mat(b, 1),
+            crop_windows_mat(b, 2), crop_windows_mat(b, 3), out_height,
+            out_width, output_data.data() + b * out_image_size);
+      }
+    };
+    // Decoding dominates and is far more expensive than the output size
+    // suggests, so give every image its own shard where threads allow.
+    const int64 kCostPerImage = 1000 * (out_image_size + 1000);
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          kCostPerImage, decode_images);
+
+    for (int64 b = 0; b < batch_size; ++b) {
+      OP_REQUIRES_OK(context, statuses[b]);
+    }
+  }
+
+ private:
+  // Decodes the JPEG `input` cropped to the window [crop_y, crop_x,
+  // crop_height, crop_width] and writes it resized to `out_height` x
+  // `out_width` into `output`. An empty window selects the whole image.
+  Status DecodeAndResize(StringPiece input, int crop_y, int crop_x,
+                         int crop_height, int crop_width, int out_height,
+                         int out_width, float* output) const {
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                     input.size());
+    }
+    int image_height = 0;
+    int image_width = 0;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &image_width,
+                            &image_height, nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data, size ", input.size());
+    }
+    if (crop_height == 0 || crop_width == 0) {
+      crop_y = 0;
+      crop_x = 0;
+      crop_height = image_height;
+      crop_width = image_width;
+    }
+    if (crop_y < 0 || crop_x < 0 || crop_height < 0 || crop_width < 0 ||
+        crop_height > image_height - crop_y ||
+        crop_width > image_width - crop_x) {
+      return errors::InvalidArgument(
+          "Invalid crop window [", crop_y, ", ", crop_x, ", ", crop_height,
+          ", ", crop_width, "] for image of size ", image_height, "x",
+          image_width);
+    }
+
+    // The crop window is expressed in the coordinates of the scaled image, so
+    // it is widened to the enclosing whole scaled pixels.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio =
+        ChooseScaleDenom(crop_height, crop_width, out_height, out_width);
+    const int scaled_height = ScaledSize(image_height, flags.ratio);
+    const int scaled_width = ScaledSize(image_width, flags.ratio);
+    flags.crop_y = crop_y / flags.ratio;
+    flags.crop_x = crop_x / flags.ratio;
+    flags.crop_height =
+        std::min(ScaledSize(crop_y + crop_height, flags.ratio),
+                 scaled_height) -
+        flags.crop_y;
+    flags.crop_width =
+        std::min(ScaledSize(crop_x + crop_width, flags.ratio), scaled_width) -
+        flags.crop_x;
+    flags.crop = flags.crop_height != scaled_height ||
+                 flags.crop_width != scaled_width;
+
+    std::unique_ptr<uint8[]> decoded;
+    int in_height = 0;
+    int in_width = 0;
+    const uint8* image = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int width, int height, int channels) -> uint8* {
+          in_height = height;
+          in_width = width;
+          decoded.reset(
+              new uint8[static_cast<int64>(height) * width * channels]);
+          return decoded.get();
+        });
+    if (image == nullptr) {
+      return errors::InvalidArgument("Invalid JPEG data or crop window, size ",
+                                     input.size());
+    }
+
+    if (in_height == out_height && in_width == out_width) {
+      std::copy_n(image, static_cast<int64>(in_height) * in_width * channels_,
+                  output);
+      return Status::OK();
+    }
+
+    std::vector<CachedInterpolation> ys(out_height + 1);
+    std::vector<CachedInterpolation> xs(out_width + 1);
+    const float height_scale = CalculateResizeScale(
+        in_height, out_height, false /* align_corners */);
+    const float width_scale =
+        CalculateResizeScale(in_width, out_width, false /* align_corners */);
+    if (half_pixel_centers_) {
+      compute_interpolation_weights(HalfPixelScaler(), out_height, in_height,
+                                    height_scale, ys.data());
+      compute_interpolation_weights(HalfPixelScaler(), out_width, in_width,
+                                    width_scale, xs.data());
+    } else {
+      compute_interpolation_weights(LegacyScaler(), out_height, in_height,
+                                    height_scale, ys.data());
+      compute_interpolation_weights(LegacyScaler(), out_width, in_width,
+                                    width_scale, xs.data());
+    }
+    // Scale x interpolation weights to avoid a multiplication during iteration.
+    for (auto& x : xs) {
+      x.lower *= channels_;
+      x.upper *= channels_;
+    }
+    crop_resize_single_image_common(
+        image, in_height, in_width, out_height, out_width, channels_, 0,
+        out_width - 1, xs.data(), 0, out_height - 1, ys.data(), 0.0f, false,
+        false, output);
+    return Status::OK();
+  }
+
+  int channels_;
+  bool half_pixel_centers_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndResizeJpegBatch").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegBatchOp);
+
+}  // namespace tensorflow
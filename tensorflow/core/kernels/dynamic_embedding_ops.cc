@@ -0,0 +1,283 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/dynamic_embedding_variable.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+class DynamicEmbeddingVariableOp : public OpKernel {
+ public:
+  explicit DynamicEmbeddingVariableOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("container", &container_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+    if (shared_name_.empty()) {
+      shared_name_ = name();
+    }
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("embedding_dim", &options_.embedding_dim));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_slots", &options_.num_slots));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("initial_stddev", &options_.initial_stddev));
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr("slot_initial_value", &options_.slot_initial_value));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("min_frequency", &options_.min_frequency));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_shards", &options_.num_shards));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("seed", &options_.seed));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const ResourceHandle handle = MakeResourceHandle<DynamicEmbeddingVariable>(
+        ctx, container_, shared_name_);
+    core::RefCountPtr<DynamicEmbeddingVariable> variable;
+    OP_REQUIRES_OK(ctx, LookupOrCreateResource<DynamicEmbeddingVariable>(
+                            ctx, handle, &variable,
+                            [this](DynamicEmbeddingVariable** ret) {
+                              *ret = new DynamicEmbeddingVariable(options_);
+                              return Status::OK();
+                            }));
+    const DynamicEmbeddingOptions& options = variable->options();
+    OP_REQUIRES(ctx,
+                options.embedding_dim == options_.embedding_dim &&
+                    options.num_slots == options_.num_slots,
+                errors::InvalidArgument(
+                    "DynamicEmbeddingVariable ", shared_name_,
+                    " already exists with embedding_dim ",
+                    options.embedding_dim, " and num_slots ",
+                    options.num_slots));
+
+    AllocatorAttributes attr;
+    attr.set_on_host(true);
+    Tensor* handle_t;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &handle_t,
+                                             attr));
+    handle_t->scalar<ResourceHandle>()() = handle;
+  }
+
+ private:
+  string container_;
+  string shared_name_;
+  DynamicEmbeddingOptions options_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingVariable").Device(DEVICE_CPU),
+                        DynamicEmbeddingVariableOp);
+
+class DynamicEmbeddingLookupOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<DynamicEmbeddingVariable> variable;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &variable));
+    const Tensor& ids = ctx->input(1);
+    const Tensor& step = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(step.shape()),
+                errors::InvalidArgument("step must be a scalar: ",
+                                        step.shape().DebugString()));
+
+    TensorShape output_shape = ids.shape();
+    output_shape.AddDim(variable->options().embedding_dim);
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output));
+    OP_REQUIRES_OK(ctx, variable->Lookup(ids.flat<int64>().data(),
+                                         ids.NumElements(),
+                                         step.scalar<int64>()(),
+                                         output->flat<float>().data()));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingLookup").Device(DEVICE_CPU),
+                        DynamicEmbeddingLookupOp);
+
+namespace {
+
+// Validates the inputs of the sparse apply ops: the scalar learning rate,
+// the vector of indices and the gradients of shape [N, embedding_dim].
+Status ValidateSparseApplyInputs(const DynamicEmbeddingVariable& variable,
+                                 const Tensor& lr, const Tensor& grad,
+                                 const Tensor& indices) {
+  if (!TensorShapeUtils::IsScalar(lr.shape())) {
+    return errors::InvalidArgument("lr is not a scalar: ",
+                                   lr.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(indices.shape())) {
+    return errors::InvalidArgument("indices must be one-dimensional: ",
+                                   indices.shape().DebugString());
+  }
+  if (grad.shape() != TensorShape({indices.dim_size(0),
+                                   variable.options().embedding_dim})) {
+    return errors::InvalidArgument(
+        "grad must be of shape [", indices.dim_size(0), ", ",
+        variable.options().embedding_dim, "]: ", grad.shape().DebugString());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+class DynamicEmbeddingSparseApplyGradientDescentOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<DynamicEmbeddingVariable> variable;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &variable));
+    const Tensor& alpha = ctx->input(1);
+    const Tensor& grad = ctx->input(2);
+    const Tensor& indices = ctx->input(3);
+    OP_REQUIRES_OK(
+        ctx, ValidateSparseApplyInputs(*variable, alpha, grad, indices));
+    variable->ApplyGradientDescent(indices.vec<int64>().data(),
+                                   indices.NumElements(),
+                                   alpha.scalar<float>()(),
+                                   grad.flat<float>().data());
+  }
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("DynamicEmbeddingSparseApplyGradientDescent").Device(DEVICE_CPU),
+    DynamicEmbeddingSparseApplyGradientDescentOp);
+
+class DynamicEmbeddingSparseApplyAdagradOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<DynamicEmbeddingVariable> variable;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &variable));
+    const Tensor& lr = ctx->input(1);
+    const Tensor& grad = ctx->input(2);
+    const Tensor& indices = ctx->input(3);
+    OP_REQUIRES_OK(ctx,
+                   ValidateSparseApplyInputs(*variable, lr, grad, indices));
+    OP_REQUIRES_OK(ctx, variable->ApplyAdagrad(indices.vec<int64>().data(),
+                                               indices.NumElements(),
+                                               lr.scalar<float>()(),
+                                               grad.flat<float>().data()));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("DynamicEmbeddingSparseApplyAdagrad").Device(DEVICE_CPU),
+    DynamicEmbeddingSparseApplyAdagradOp);
+
+class DynamicEmbeddingEvictOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<DynamicEmbeddingVariable> variable;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &variable));
+    for (int i = 1; i < 4; ++i) {
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(ctx->input(i).shape()),
+                  errors::InvalidArgument(
+                      "Input ", i, " must be a scalar: ",
+                      ctx->input(i).shape().DebugString()));
+    }
+    Tensor* num_evicted;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(0, TensorShape({}), &num_evicted));
+    num_evicted->scalar<int64>()() =
+        variable->Evict(ctx->input(1).scalar<int64>()(),
+                        ctx->input(2).scalar<int64>()(),
+                        ctx->input(3).scalar<int64>()());
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingEvict").Device(DEVICE_CPU),
+                        DynamicEmbeddingEvictOp);
+
+namespace {
+
+// Checks that the prefix and tensor name inputs of the save and restore ops
+// are scalars.
+Status ValidateCheckpointInputs(const Tensor& prefix,
+                                const Tensor& tensor_name) {
+  if (!TensorShapeUtils::IsScalar(prefix.shape())) {
+    return errors::InvalidArgument("prefix must be a scalar: ",
+                                   prefix.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsScalar(tensor_name.shape())) {
+    return errors::InvalidArgument("tensor_name must be a scalar: ",
+                                   tensor_name.shape().DebugString());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+class DynamicEmbeddingSaveOp : public OpKernel {
+ public:
+  explicit DynamicEmbeddingSaveOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("only_dirty", &only_dirty_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<DynamicEmbeddingVariable> variable;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &variable));
+    const Tensor& prefix = ctx->input(1);
+    const Tensor& tensor_name = ctx->input(2);
+    OP_REQUIRES_OK(ctx, ValidateCheckpointInputs(prefix, tensor_name));
+
+    BundleWriter writer(ctx->env(), prefix.scalar<tstring>()());
+    OP_REQUIRES_OK(ctx, writer.status());
+    OP_REQUIRES_OK(ctx, variable->Save(tensor_name.scalar<tstring>()(),
+                                       only_dirty_, &writer));
+    OP_REQUIRES_OK(ctx, writer.Finish());
+  }
+
+ private:
+  bool only_dirty_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingSave").Device(DEVICE_CPU),
+                        DynamicEmbeddingSaveOp);
+
+class DynamicEmbeddingRestoreOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<DynamicEmbeddingVariable> variable;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &variable));
+    const Tensor& prefix = ctx->input(1);
+    const Tensor& tensor_name = ctx->input(2);
+    OP_REQUIRES_OK(ctx, ValidateCheckpointInputs(prefix, tensor_name));
+
+    BundleReader reader(ctx->env(), prefix.scalar<tstring>()());
+    OP_REQUIRES_OK(ctx, reader.status());
+    OP_REQUIRES_OK(ctx,
+                   variable->Restore(tensor_name.scalar<tstring>()(), &reader));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingRestore").Device(DEVICE_CPU),
+                        DynamicEmbeddingRestoreOp);
+
+}  // namespace tensorflow
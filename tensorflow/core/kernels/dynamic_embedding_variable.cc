@@ -0,0 +1,413 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/dynamic_embedding_variable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Raises `last_step` to `step`, so that concurrent lookups at different steps
+// keep the latest one.
+void UpdateLastStep(int64 step, std::atomic<int64>* last_step) {
+  int64 current = last_step->load(std::memory_order_relaxed);
+  while (current < step && !last_step->compare_exchange_weak(
+                               current, step, std::memory_order_relaxed)) {
+  }
+}
+
+string TensorKey(StringPiece tensor_name, StringPiece suffix) {
+  return strings::StrCat(tensor_name, "-", suffix);
+}
+
+}  // namespace
+
+constexpr int64 DynamicEmbeddingVariable::kRowsPerChunk;
+constexpr int64 DynamicEmbeddingVariable::kMaxChunks;
+
+DynamicEmbeddingVariable::Chunk::Chunk(int64 row_width)
+    : values(new float[kRowsPerChunk * row_width]),
+      frequency(new std::atomic<int64>[kRowsPerChunk]),
+      last_step(new std::atomic<int64>[kRowsPerChunk]),
+      dirty(new std::atomic<bool>[kRowsPerChunk]) {}
+
+DynamicEmbeddingVariable::DynamicEmbeddingVariable(
+    const DynamicEmbeddingOptions& options)
+    : options_(options),
+      row_width_(options.embedding_dim * (1 + options.num_slots)),
+      rows_(options.num_shards),
+      chunks_(kMaxChunks),
+      generator_(options.seed == 0 ? random::New64() : options.seed,
+                 random::New64()) {}
+
+string DynamicEmbeddingVariable::DebugString() const {
+  return strings::StrCat("DynamicEmbeddingVariable(embedding_dim=",
+                         options_.embedding_dim, ", size=", size(), ")");
+}
+
+int64 DynamicEmbeddingVariable::MemoryUsed() const {
+  const int64 chunk_bytes =
+      kRowsPerChunk * (row_width_ * sizeof(float) + 2 * sizeof(int64) + 1);
+  mutex_lock l(create_mu_);
+  const int64 num_chunks =
+      (num_allocated_rows_ + kRowsPerChunk - 1) / kRowsPerChunk;
+  return sizeof(DynamicEmbeddingVariable) + rows_.MemoryUsed() +
+         num_chunks * chunk_bytes +
+         candidates_.size() * 2 * sizeof(int64) +
+         free_rows_.size() * sizeof(int64);
+}
+
+int64 DynamicEmbeddingVariable::size() const { return rows_.size(); }
+
+int64 DynamicEmbeddingVariable::AllocateRow() {
+  int64 row;
+  if (!free_rows_.empty()) {
+    row = free_rows_.back();
+    free_rows_.pop_back();
+  } else {
+    if (num_allocated_rows_ == kRowsPerChunk * kMaxChunks) {
+      return -1;
+    }
+    row = num_allocated_rows_++;
+    if (chunks_[row / kRowsPerChunk] == nullptr) {
+      chunks_[row / kRowsPerChunk].reset(new Chunk(row_width_));
+    }
+  }
+  float* values = RowValues(row);
+  const int64 dim = options_.embedding_dim;
+  for (int64 d = 0; d < dim; d += 4) {
+    const auto samples = normal_(&generator_);
+    for (int64 j = 0; j < 4 && d + j < dim; ++j) {
+      values[d + j] = samples[j] * options_.initial_stddev;
+    }
+  }
+  std::fill(values + dim, values + row_width_, options_.slot_initial_value);
+  RowFrequency(row).store(0, std::memory_order_relaxed);
+  RowLastStep(row).store(0, std::memory_order_relaxed);
+  RowDirty(row).store(true, std::memory_order_relaxed);
+  return row;
+}
+
+void DynamicEmbeddingVariable::FreeRow(int64 row) { free_rows_.push_back(row); }
+
+Status DynamicEmbeddingVariable::Lookup(const int64* ids, int64 n, int64 step,
+                                        float* values) {
+  tf_shared_lock l(mu_);
+  std::vector<int64> rows(n);
+  rows_.Find(ids, n, -1, rows.data());
+
+  std::vector<int64> missing;
+  for (int64 i = 0; i < n; ++i) {
+    if (rows[i] < 0) {
+      missing.push_back(i);
+    }
+  }
+  if (!missing.empty()) {
+    mutex_lock create_lock(create_mu_);
+    std::vector<int64> missing_ids(missing.size());
+    std::vector<int64> missing_rows(missing.size());
+    for (size_t j = 0; j < missing.size(); ++j) {
+      missing_ids[j] = ids[missing[j]];
+    }
+    // Another lookup may have created some of the rows since.
+    rows_.Find(missing_ids.data(), missing_ids.size(), -1,
+               missing_rows.data());
+    std::unordered_map<int64, int64> created;
+    std::vector<int64> created_ids;
+    std::vector<int64> created_rows;
+    for (size_t j = 0; j < missing.size(); ++j) {
+      if (missing_rows[j] >= 0) {
+        rows[missing[j]] = missing_rows[j];
+        continue;
+      }
+      const int64 id = missing_ids[j];
+      auto it = created.find(id);
+      if (it != created.end()) {
+        rows[missing[j]] = it->second;
+        continue;
+      }
+      const int64 count = ++candidates_[id];
+      if (count < options_.min_frequency) {
+        continue;
+      }
+      const int64 row = AllocateRow();
+      if (row < 0) {
+        rows_.Insert(created_ids.data(), created_rows.data(),
+                     created_ids.size());
+        return errors::ResourceExhausted(
+            "DynamicEmbeddingVariable is full with ",
+            kRowsPerChunk * kMaxChunks, " rows");
+      }
+      candidates_.erase(id);
+      // The lookup itself is counted below.
+      RowFrequency(row).store(count - 1, std::memory_order_relaxed);
+      created.emplace(id, row);
+      created_ids.push_back(id);
+      created_rows.push_back(row);
+      rows[missing[j]] = row;
+    }
+    rows_.Insert(created_ids.data(), created_rows.data(), created_ids.size());
+  }
+
+  const int64 dim = options_.embedding_dim;
+  for (int64 i = 0; i < n; ++i) {
+    float* out = values + i * dim;
+    if (rows[i] < 0) {
+      std::fill(out, out + dim, 0.0f);
+      continue;
+    }
+    RowFrequency(rows[i]).fetch_add(1, std::memory_order_relaxed);
+    UpdateLastStep(step, &RowLastStep(rows[i]));
+    std::memcpy(out, RowValues(rows[i]), dim * sizeof(float));
+  }
+  return Status::OK();
+}
+
+void DynamicEmbeddingVariable::ApplyGradientDescent(const int64* ids, int64 n,
+                                                    float lr,
+                                                    const float* grad) {
+  tf_shared_lock l(mu_);
+  std::vector<int64> rows(n);
+  rows_.Find(ids, n, -1, rows.data());
+  const int64 dim = options_.embedding_dim;
+  for (int64 i = 0; i < n; ++i) {
+    if (rows[i] < 0) {
+      continue;
+    }
+    float* var = RowValues(rows[i]);
+    const float* g = grad + i * dim;
+    for (int64 d = 0; d < dim; ++d) {
+      var[d] -= lr * g[d];
+    }
+    RowDirty(rows[i]).store(true, std::memory_order_relaxed);
+  }
+}
+
+Status DynamicEmbeddingVariable::ApplyAdagrad(const int64* ids, int64 n,
+                                              float lr, const float* grad) {
+  if (options_.num_slots < 1) {
+    return errors::FailedPrecondition(
+        "Adagrad needs a DynamicEmbeddingVariable with num_slots >= 1");
+  }
+  tf_shared_lock l(mu_);
+  std::vector<int64> rows(n);
+  rows_.Find(ids, n, -1, rows.data());
+  const int64 dim = options_.embedding_dim;
+  for (int64 i = 0; i < n; ++i) {
+    if (rows[i] < 0) {
+      continue;
+    }
+    float* var = RowValues(rows[i]);
+    float* accum = var + dim;
+    const float* g = grad + i * dim;
+    for (int64 d = 0; d < dim; ++d) {
+      accum[d] += g[d] * g[d];
+      var[d] -= lr * g[d] / std::sqrt(accum[d]);
+    }
+    RowDirty(rows[i]).store(true, std::memory_order_relaxed);
+  }
+  return Status::OK();
+}
+
+int64 DynamicEmbeddingVariable::Evict(int64 step, int64 ttl_steps,
+                                      int64 max_rows) {
+  mutex_lock l(mu_);
+  mutex_lock create_lock(create_mu_);
+  candidates_.clear();
+
+  std::vector<int64> ids;
+  std::vector<int64> rows;
+  rows_.Export(&ids, &rows);
+  std::vector<int64> kept(ids.size());
+  for (size_t i = 0; i < kept.size(); ++i) {
+    kept[i] = i;
+  }
+  std::vector<int64> evicted;
+  if (ttl_steps > 0) {
+    auto stale = std::partition(kept.begin(), kept.end(), [&](int64 i) {
+      return RowLastStep(rows[i]).load(std::memory_order_relaxed) >=
+             step - ttl_steps;
+    });
+    evicted.assign(stale, kept.end());
+    kept.erase(stale, kept.end());
+  }
+  if (max_rows > 0 && kept.size() > static_cast<size_t>(max_rows)) {
+    // Moves the max_rows most frequent rows to the front.
+    std::nth_element(kept.begin(), kept.begin() + max_rows, kept.end(),
+                     [&](int64 a, int64 b) {
+                       return RowFrequency(rows[a]).load(
+                                  std::memory_order_relaxed) >
+                              RowFrequency(rows[b]).load(
+                                  std::memory_order_relaxed);
+                     });
+    evicted.insert(evicted.end(), kept.begin() + max_rows, kept.end());
+  }
+
+  std::vector<int64> evicted_ids(evicted.size());
+  for (size_t j = 0; j < evicted.size(); ++j) {
+    evicted_ids[j] = ids[evicted[j]];
+    FreeRow(rows[evicted[j]]);
+  }
+  rows_.Erase(evicted_ids.data(), evicted_ids.size());
+  evicted_ids_.insert(evicted_ids_.end(), evicted_ids.begin(),
+                      evicted_ids.end());
+  return evicted.size();
+}
+
+Status DynamicEmbeddingVariable::Save(StringPiece tensor_name, bool only_dirty,
+                                      BundleWriter* writer) {
+  mutex_lock l(mu_);
+  std::vector<int64> ids;
+  std::vector<int64> rows;
+  rows_.Export(&ids, &rows);
+  std::vector<int64> saved;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (!only_dirty || RowDirty(rows[i]).load(std::memory_order_relaxed)) {
+      saved.push_back(i);
+    }
+  }
+
+  const int64 num_saved = saved.size();
+  Tensor ids_t(DT_INT64, TensorShape({num_saved}));
+  Tensor values_t(DT_FLOAT, TensorShape({num_saved, row_width_}));
+  Tensor frequencies_t(DT_INT64, TensorShape({num_saved}));
+  Tensor steps_t(DT_INT64, TensorShape({num_saved}));
+  auto ids_flat = ids_t.vec<int64>();
+  auto values_matrix = values_t.matrix<float>();
+  auto frequencies_flat = frequencies_t.vec<int64>();
+  auto steps_flat = steps_t.vec<int64>();
+  for (int64 j = 0; j < num_saved; ++j) {
+    const int64 row = rows[saved[j]];
+    ids_flat(j) = ids[saved[j]];
+    std::memcpy(&values_matrix(j, 0), RowValues(row),
+                row_width_ * sizeof(float));
+    frequencies_flat(j) = RowFrequency(row).load(std::memory_order_relaxed);
+    steps_flat(j) = RowLastStep(row).load(std::memory_order_relaxed);
+  }
+  const int64 num_evicted = only_dirty ? evicted_ids_.size() : 0;
+  Tensor evicted_t(DT_INT64, TensorShape({num_evicted}));
+  std::copy_n(evicted_ids_.begin(), num_evicted,
+              evicted_t.vec<int64>().data());
+  Tensor incremental_t(DT_BOOL, TensorShape({}));
+  incremental_t.scalar<bool>()() = only_dirty;
+
+  TF_RETURN_IF_ERROR(writer->Add(TensorKey(tensor_name, "evicted"),
+                                 evicted_t));
+  TF_RETURN_IF_ERROR(writer->Add(TensorKey(tensor_name, "frequencies"),
+                                 frequencies_t));
+  TF_RETURN_IF_ERROR(writer->Add(TensorKey(tensor_name, "ids"), ids_t));
+  TF_RETURN_IF_ERROR(writer->Add(TensorKey(tensor_name, "incremental"),
+                                 incremental_t));
+  TF_RETURN_IF_ERROR(writer->Add(TensorKey(tensor_name, "steps"), steps_t));
+  TF_RETURN_IF_ERROR(writer->Add(TensorKey(tensor_name, "values"), values_t));
+
+  for (int64 j = 0; j < num_saved; ++j) {
+    RowDirty(rows[saved[j]]).store(false, std::memory_order_relaxed);
+  }
+  evicted_ids_.clear();
+  return Status::OK();
+}
+
+Status DynamicEmbeddingVariable::Restore(StringPiece tensor_name,
+                                         BundleReader* reader) {
+  Tensor ids_t, values_t, frequencies_t, steps_t, evicted_t, incremental_t;
+  TF_RETURN_IF_ERROR(reader->Lookup(TensorKey(tensor_name, "ids"), &ids_t));
+  TF_RETURN_IF_ERROR(
+      reader->Lookup(TensorKey(tensor_name, "values"), &values_t));
+  TF_RETURN_IF_ERROR(
+      reader->Lookup(TensorKey(tensor_name, "frequencies"), &frequencies_t));
+  TF_RETURN_IF_ERROR(reader->Lookup(TensorKey(tensor_name, "steps"), &steps_t));
+  TF_RETURN_IF_ERROR(
+      reader->Lookup(TensorKey(tensor_name, "evicted"), &evicted_t));
+  TF_RETURN_IF_ERROR(
+      reader->Lookup(TensorKey(tensor_name, "incremental"), &incremental_t));
+  const int64 num_rows = ids_t.NumElements();
+  if (ids_t.dtype() != DT_INT64 || ids_t.dims() != 1 ||
+      values_t.dtype() != DT_FLOAT ||
+      values_t.shape() != TensorShape({num_rows, row_width_}) ||
+      frequencies_t.dtype() != DT_INT64 ||
+      frequencies_t.NumElements() != num_rows ||
+      steps_t.dtype() != DT_INT64 || steps_t.NumElements() != num_rows ||
+      evicted_t.dtype() != DT_INT64 || incremental_t.dtype() != DT_BOOL ||
+      incremental_t.NumElements() != 1) {
+    return errors::InvalidArgument(
+        "Checkpoint of ", tensor_name,
+        " does not hold a DynamicEmbeddingVariable of row width ", row_width_,
+        ": ids ", ids_t.shape().DebugString(), ", values ",
+        values_t.shape().DebugString());
+  }
+
+  mutex_lock l(mu_);
+  mutex_lock create_lock(create_mu_);
+  candidates_.clear();
+  if (!incremental_t.scalar<bool>()()) {
+    rows_.Assign(nullptr, nullptr, 0);
+    num_allocated_rows_ = 0;
+    free_rows_.clear();
+  } else {
+    const auto evicted = evicted_t.flat<int64>();
+    std::vector<int64> evicted_rows(evicted.size());
+    rows_.Find(evicted.data(), evicted.size(), -1, evicted_rows.data());
+    for (int64 row : evicted_rows) {
+      if (row >= 0) {
+        FreeRow(row);
+      }
+    }
+    rows_.Erase(evicted.data(), evicted.size());
+  }
+  evicted_ids_.clear();
+
+  const auto ids = ids_t.vec<int64>();
+  const auto values = values_t.matrix<float>();
+  const auto frequencies = frequencies_t.vec<int64>();
+  const auto steps = steps_t.vec<int64>();
+  // The ids of a checkpoint are unique, so they can be looked up at once.
+  std::vector<int64> rows(num_rows);
+  rows_.Find(ids.data(), num_rows, -1, rows.data());
+  std::vector<int64> created_ids;
+  std::vector<int64> created_rows;
+  for (int64 i = 0; i < num_rows; ++i) {
+    if (rows[i] < 0) {
+      rows[i] = AllocateRow();
+      if (rows[i] < 0) {
+        rows_.Insert(created_ids.data(), created_rows.data(),
+                     created_ids.size());
+        return errors::ResourceExhausted(
+            "DynamicEmbeddingVariable is full with ",
+            kRowsPerChunk * kMaxChunks, " rows");
+      }
+      created_ids.push_back(ids(i));
+      created_rows.push_back(rows[i]);
+    }
+    std::memcpy(RowValues(rows[i]), &values(i, 0),
+                row_width_ * sizeof(float));
+    RowFrequency(rows[i]).store(frequencies(i), std::memory_order_relaxed);
+    RowLastStep(rows[i]).store(steps(i), std::memory_order_relaxed);
+    RowDirty(rows[i]).store(false, std::memory_order_relaxed);
+  }
+  rows_.Insert(created_ids.data(), created_rows.data(), created_ids.size());
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,164 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DYNAMIC_EMBEDDING_VARIABLE_H_
+#define TENSORFLOW_CORE_KERNELS_DYNAMIC_EMBEDDING_VARIABLE_H_
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/kernels/striped_flat_hash_map.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+struct DynamicEmbeddingOptions {
+  int64 embedding_dim = 1;
+  // Number of optimizer slots stored next to each embedding, e.g. 1 for the
+  // Adagrad accumulator. Each slot has embedding_dim values.
+  int num_slots = 0;
+  // Embeddings are initialized from N(0, initial_stddev^2), and slots to
+  // slot_initial_value.
+  float initial_stddev = 0.01f;
+  float slot_initial_value = 0.1f;
+  // An id gets a row on its min_frequency-th lookup. Before that, its
+  // embedding is zero and its gradients are dropped.
+  int64 min_frequency = 1;
+  int num_shards = 16;
+  int64 seed = 0;
+};
+
+// An embedding table keyed by int64 id, whose rows are created on the first
+// lookups of an id and can be evicted when they become stale or rare. Unlike
+// a dense variable, the ids need not be hashed into a fixed range, and only
+// the ids seen often enough take memory.
+//
+// Lookups and optimizer updates of different rows run concurrently; like the
+// non-locking training ops, concurrent updates of the same row may race.
+// Eviction, saving and restoring lock the whole table.
+class DynamicEmbeddingVariable : public ResourceBase {
+ public:
+  explicit DynamicEmbeddingVariable(const DynamicEmbeddingOptions& options);
+
+  string DebugString() const override;
+  int64 MemoryUsed() const override;
+
+  const DynamicEmbeddingOptions& options() const { return options_; }
+
+  // The number of ids with a row.
+  int64 size() const;
+
+  // Writes the embeddings of the `n` ids to `values`, of shape
+  // [n, embedding_dim]. Each lookup counts towards the frequency of its id,
+  // creates the row of the ids reaching min_frequency, and marks the row as
+  // accessed at `step`.
+  Status Lookup(const int64* ids, int64 n, int64 step, float* values);
+
+  // Fused sparse optimizer updates of the rows of `ids`, with `grad` of
+  // shape [n, embedding_dim]. Ids without a row are skipped. Repeated ids
+  // are applied in order, as in the SparseApply* ops.
+  void ApplyGradientDescent(const int64* ids, int64 n, float lr,
+                            const float* grad);
+  // Uses slot 0 as the accumulator.
+  Status ApplyAdagrad(const int64* ids, int64 n, float lr, const float* grad);
+
+  // Evicts the rows not accessed since `step - ttl_steps`, if ttl_steps > 0,
+  // then the least frequently used rows until at most `max_rows` are left,
+  // if max_rows > 0. The frequencies counted for ids without a row are
+  // dropped too, so that they are bounded by the eviction interval. Returns
+  // the number of evicted rows.
+  int64 Evict(int64 step, int64 ttl_steps, int64 max_rows);
+
+  // Adds the table to `writer` as the tensors <tensor_name>-ids, -values,
+  // -frequencies, -steps, -evicted and -incremental. If `only_dirty`, only
+  // the rows created or updated since the last save are written, along with
+  // the ids evicted since then.
+  Status Save(StringPiece tensor_name, bool only_dirty, BundleWriter* writer);
+
+  // Restores a table saved by Save(). A full checkpoint replaces the table;
+  // an incremental one is applied on top of it, so a full checkpoint and the
+  // following incremental ones must be restored in order.
+  Status Restore(StringPiece tensor_name, BundleReader* reader);
+
+ private:
+  static constexpr int64 kRowsPerChunk = 4096;
+  static constexpr int64 kMaxChunks = 16384;
+
+  // Rows are allocated in chunks that never move, so a row can be read
+  // while other rows are created.
+  struct Chunk {
+    explicit Chunk(int64 row_width);
+
+    std::unique_ptr<float[]> values;
+    std::unique_ptr<std::atomic<int64>[]> frequency;
+    std::unique_ptr<std::atomic<int64>[]> last_step;
+    std::unique_ptr<std::atomic<bool>[]> dirty;
+  };
+
+  float* RowValues(int64 row) const {
+    return chunks_[row / kRowsPerChunk]->values.get() +
+           (row % kRowsPerChunk) * row_width_;
+  }
+  std::atomic<int64>& RowFrequency(int64 row) const {
+    return chunks_[row / kRowsPerChunk]->frequency[row % kRowsPerChunk];
+  }
+  std::atomic<int64>& RowLastStep(int64 row) const {
+    return chunks_[row / kRowsPerChunk]->last_step[row % kRowsPerChunk];
+  }
+  std::atomic<bool>& RowDirty(int64 row) const {
+    return chunks_[row / kRowsPerChunk]->dirty[row % kRowsPerChunk];
+  }
+
+  // Returns a free row with initialized values, or -1 if the table is full.
+  int64 AllocateRow() EXCLUSIVE_LOCKS_REQUIRED(create_mu_);
+  void FreeRow(int64 row) EXCLUSIVE_LOCKS_REQUIRED(create_mu_);
+
+  const DynamicEmbeddingOptions options_;
+  // embedding_dim * (1 + num_slots).
+  const int64 row_width_;
+
+  // Shared by lookups and updates, exclusive for whole table operations.
+  mutable mutex mu_;
+  // Serializes the creation of rows.
+  mutable mutex create_mu_;
+
+  // Maps each id with a row to its row.
+  lookup::StripedFlatHashMap<int64, int64> rows_;
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  int64 num_allocated_rows_ GUARDED_BY(create_mu_) = 0;
+  std::vector<int64> free_rows_ GUARDED_BY(create_mu_);
+  // Lookup counts of the ids without a row.
+  std::unordered_map<int64, int64> candidates_ GUARDED_BY(create_mu_);
+  random::PhiloxRandom generator_ GUARDED_BY(create_mu_);
+  random::NormalDistribution<random::PhiloxRandom, float> normal_
+      GUARDED_BY(create_mu_);
+  // The ids evicted since the last save.
+  std::vector<int64> evicted_ids_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DynamicEmbeddingVariable);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DYNAMIC_EMBEDDING_VARIABLE_H_
@@ -0,0 +1,198 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/dynamic_embedding_variable.h"
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+DynamicEmbeddingOptions Options(int64 embedding_dim) {
+  DynamicEmbeddingOptions options;
+  options.embedding_dim = embedding_dim;
+  options.num_shards = 4;
+  options.seed = 7;
+  return options;
+}
+
+string Prefix(StringPiece name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(DynamicEmbeddingVariableTest, CreatesRowsOnLookup) {
+  core::RefCountPtr<DynamicEmbeddingVariable> variable(
+      new DynamicEmbeddingVariable(Options(3)));
+  const std::vector<int64> ids = {5, 1LL << 40, 5};
+  std::vector<float> values(ids.size() * 3);
+  TF_ASSERT_OK(variable->Lookup(ids.data(), ids.size(), 1, values.data()));
+  EXPECT_EQ(variable->size(), 2);
+  // The embeddings are random, and a repeated id gets the same one.
+  EXPECT_NE(values[0], 0.0f);
+  for (int d = 0; d < 3; ++d) {
+    EXPECT_EQ(values[d], values[6 + d]);
+  }
+
+  std::vector<float> again(ids.size() * 3);
+  TF_ASSERT_OK(variable->Lookup(ids.data(), ids.size(), 2, again.data()));
+  EXPECT_EQ(values, again);
+  EXPECT_EQ(variable->size(), 2);
+}
+
+TEST(DynamicEmbeddingVariableTest, MinFrequency) {
+  DynamicEmbeddingOptions options = Options(2);
+  options.min_frequency = 3;
+  core::RefCountPtr<DynamicEmbeddingVariable> variable(
+      new DynamicEmbeddingVariable(options));
+  const int64 id = 42;
+  float values[2];
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(variable->Lookup(&id, 1, i, values));
+    EXPECT_EQ(values[0], 0.0f);
+    EXPECT_EQ(values[1], 0.0f);
+    EXPECT_EQ(variable->size(), 0);
+  }
+  // The gradients of ids without a row are dropped.
+  const float grad[2] = {1, 1};
+  variable->ApplyGradientDescent(&id, 1, 1.0f, grad);
+  TF_ASSERT_OK(variable->Lookup(&id, 1, 2, values));
+  EXPECT_NE(values[0], 0.0f);
+  EXPECT_EQ(variable->size(), 1);
+}
+
+TEST(DynamicEmbeddingVariableTest, SparseApply) {
+  DynamicEmbeddingOptions options = Options(2);
+  options.num_slots = 1;
+  options.slot_initial_value = 0.5f;
+  core::RefCountPtr<DynamicEmbeddingVariable> variable(
+      new DynamicEmbeddingVariable(options));
+  const std::vector<int64> ids = {1, 2};
+  std::vector<float> before(4);
+  TF_ASSERT_OK(variable->Lookup(ids.data(), ids.size(), 0, before.data()));
+
+  const std::vector<int64> indices = {2, 1, 2, 3};
+  const std::vector<float> grad = {1, 2, 3, 4, 5, 6, 7, 8};
+  variable->ApplyGradientDescent(indices.data(), indices.size(), 0.5f,
+                                 grad.data());
+  std::vector<float> after(4);
+  TF_ASSERT_OK(variable->Lookup(ids.data(), ids.size(), 0, after.data()));
+  EXPECT_FLOAT_EQ(after[0], before[0] - 0.5f * 3);
+  EXPECT_FLOAT_EQ(after[1], before[1] - 0.5f * 4);
+  // The repeated id gets both updates.
+  EXPECT_FLOAT_EQ(after[2], before[2] - 0.5f * (1 + 5));
+  EXPECT_FLOAT_EQ(after[3], before[3] - 0.5f * (2 + 6));
+
+  const int64 id = 1;
+  const float adagrad_grad[2] = {1, 2};
+  TF_ASSERT_OK(variable->ApplyAdagrad(&id, 1, 0.1f, adagrad_grad));
+  float updated[2];
+  TF_ASSERT_OK(variable->Lookup(&id, 1, 0, updated));
+  EXPECT_FLOAT_EQ(updated[0], after[0] - 0.1f * 1 / std::sqrt(0.5f + 1));
+  EXPECT_FLOAT_EQ(updated[1], after[1] - 0.1f * 2 / std::sqrt(0.5f + 4));
+
+  core::RefCountPtr<DynamicEmbeddingVariable> no_slots(
+      new DynamicEmbeddingVariable(Options(2)));
+  EXPECT_FALSE(no_slots->ApplyAdagrad(&id, 1, 0.1f, adagrad_grad).ok());
+}
+
+TEST(DynamicEmbeddingVariableTest, Evict) {
+  core::RefCountPtr<DynamicEmbeddingVariable> variable(
+      new DynamicEmbeddingVariable(Options(1)));
+  float values[4];
+  // Id 1 is looked up at step 1 only, ids 2 to 4 at step 10, and id 4 most.
+  const std::vector<int64> old_ids = {1};
+  const std::vector<int64> new_ids = {2, 3, 4, 4};
+  TF_ASSERT_OK(variable->Lookup(old_ids.data(), old_ids.size(), 1, values));
+  TF_ASSERT_OK(variable->Lookup(new_ids.data(), new_ids.size(), 10, values));
+  EXPECT_EQ(variable->size(), 4);
+
+  EXPECT_EQ(variable->Evict(10, 5, 0), 1);
+  EXPECT_EQ(variable->size(), 3);
+  EXPECT_EQ(variable->Evict(10, 0, 1), 2);
+  EXPECT_EQ(variable->size(), 1);
+
+  // Id 4 kept its embedding, and the others get new rows.
+  const std::vector<int64> all_ids = {1, 2, 3, 4};
+  TF_ASSERT_OK(variable->Lookup(all_ids.data(), all_ids.size(), 11, values));
+  EXPECT_EQ(variable->size(), 4);
+}
+
+TEST(DynamicEmbeddingVariableTest, SaveAndRestore) {
+  DynamicEmbeddingOptions options = Options(2);
+  options.num_slots = 1;
+  core::RefCountPtr<DynamicEmbeddingVariable> variable(
+      new DynamicEmbeddingVariable(options));
+  const std::vector<int64> ids = {1, 2, 3};
+  std::vector<float> values(6);
+  TF_ASSERT_OK(variable->Lookup(ids.data(), ids.size(), 1, values.data()));
+  {
+    BundleWriter writer(Env::Default(), Prefix("full"));
+    TF_ASSERT_OK(variable->Save("table", false, &writer));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  // Updates id 2, evicts id 3 and creates id 4.
+  const int64 id = 2;
+  const float grad[2] = {1, 1};
+  variable->ApplyGradientDescent(&id, 1, 1.0f, grad);
+  const std::vector<int64> new_ids = {1, 2, 4};
+  TF_ASSERT_OK(
+      variable->Lookup(new_ids.data(), new_ids.size(), 5, values.data()));
+  EXPECT_EQ(variable->Evict(5, 2, 0), 1);
+  {
+    BundleWriter writer(Env::Default(), Prefix("incremental"));
+    TF_ASSERT_OK(variable->Save("table", true, &writer));
+    TF_ASSERT_OK(writer.Finish());
+    BundleReader reader(Env::Default(), Prefix("incremental"));
+    TF_ASSERT_OK(reader.status());
+    Tensor saved_ids;
+    TF_ASSERT_OK(reader.Lookup("table-ids", &saved_ids));
+    // Id 1 was not updated since the full save.
+    EXPECT_EQ(saved_ids.NumElements(), 2);
+  }
+
+  core::RefCountPtr<DynamicEmbeddingVariable> restored(
+      new DynamicEmbeddingVariable(options));
+  const int64 stale_id = 100;
+  float stale[2];
+  TF_ASSERT_OK(restored->Lookup(&stale_id, 1, 0, stale));
+  for (const char* name : {"full", "incremental"}) {
+    BundleReader reader(Env::Default(), Prefix(name));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(restored->Restore("table", &reader));
+  }
+  EXPECT_EQ(restored->size(), 3);
+  std::vector<float> expected(6), actual(6);
+  TF_ASSERT_OK(
+      variable->Lookup(new_ids.data(), new_ids.size(), 6, expected.data()));
+  TF_ASSERT_OK(
+      restored->Lookup(new_ids.data(), new_ids.size(), 6, actual.data()));
+  EXPECT_EQ(expected, actual);
+  EXPECT_EQ(restored->size(), 3);
+
+  core::RefCountPtr<DynamicEmbeddingVariable> mismatched(
+      new DynamicEmbeddingVariable(Options(3)));
+  BundleReader reader(Env::Default(), Prefix("full"));
+  EXPECT_FALSE(mismatched->Restore("table", &reader).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 #include "tensorflow/core/util/example_proto_helper.h"
@@ -131,6 +132,22 @@ class ParseExampleOp : public OpKernel {
     for (int d = 0; d < attrs_.num_sparse; ++d) {
       config.sparse.push_back({sparse_keys_t[d], attrs_.sparse_types[d]});
     }
+    OP_REQUIRES_OK(ctx, GetConfigIndex(config, &config.index));
+
+    // Parse the dense features directly into GPU-compatible memory if any of
+    // them is copied to a GPU, so that the copy needs no staging buffer.
+    int dense_start, dense_stop;
+    OP_REQUIRES_OK(ctx,
+                   ctx->op_kernel().OutputRange("dense_values", &dense_start,
+                                                &dense_stop));
+    AllocatorAttributes dense_attr;
+    for (int i = dense_start; i < dense_stop; ++i) {
+      if (ctx->output_alloc_attr(i).gpu_compatible()) {
+        dense_attr.set_gpu_compatible(true);
+        break;
+      }
+    }
+    config.dense_allocator = ctx->get_allocator(dense_attr);
 
     auto serialized_t = serialized->flat<string>();
     auto names_t = names->flat<string>();
@@ -163,6 +180,30 @@ class ParseExampleOp : public OpKernel {
 
  protected:
   ParseExampleAttrs attrs_;
+
+ private:
+  // The keys are inputs rather than attrs, but are almost always constants, so
+  // the index built for the previous call can usually be reused.
+  Status GetConfigIndex(
+      const example::FastParseExampleConfig& config,
+      std::shared_ptr<const example::FastParseExampleConfigIndex>* index) {
+    {
+      mutex_lock l(mu_);
+      if (config_index_ != nullptr && config_index_->Matches(config)) {
+        *index = config_index_;
+        return Status::OK();
+      }
+    }
+    TF_RETURN_IF_ERROR(
+        example::FastParseExampleConfigIndex::Create(config, index));
+    mutex_lock l(mu_);
+    config_index_ = *index;
+    return Status::OK();
+  }
+
+  mutex mu_;
+  std::shared_ptr<const example::FastParseExampleConfigIndex> config_index_
+      GUARDED_BY(mu_);
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParseExample").Device(DEVICE_CPU),
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <iterator>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -47,8 +48,61 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
   }
 }
 
+bool FIFOQueue::TryEnqueueWithoutBlocking(
+    const std::vector<std::vector<PersistentTensor>>& elements,
+    OpKernelContext* ctx) {
+  if (ctx->cancellation_manager()->IsCancelled()) return false;
+  mutex_lock l(mu_);
+  if (closed_ || !enqueue_attempts_.empty() || !dequeue_attempts_.empty() ||
+      queues_[0].size() + elements[0].size() >
+          static_cast<size_t>(capacity_)) {
+    return false;
+  }
+  for (int i = 0; i < num_components(); ++i) {
+    queues_[i].insert(queues_[i].end(), elements[i].begin(),
+                      elements[i].end());
+  }
+  return true;
+}
+
+bool FIFOQueue::TryDequeueWithoutBlocking(
+    int64 num_elements, OpKernelContext* ctx,
+    std::vector<std::vector<PersistentTensor>>* elements) {
+  if (ctx->cancellation_manager()->IsCancelled()) return false;
+  bool has_enqueue_attempts;
+  {
+    mutex_lock l(mu_);
+    if (!dequeue_attempts_.empty() ||
+        queues_[0].size() < static_cast<size_t>(num_elements)) {
+      return false;
+    }
+    elements->resize(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      auto end = queues_[i].begin() + num_elements;
+      (*elements)[i].assign(std::make_move_iterator(queues_[i].begin()),
+                            std::make_move_iterator(end));
+      queues_[i].erase(queues_[i].begin(), end);
+    }
+    has_enqueue_attempts = !enqueue_attempts_.empty();
+  }
+  // Blocked enqueues may fit in the space that was freed.
+  if (has_enqueue_attempts) FlushUnlocked();
+  return true;
+}
+
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  {
+    std::vector<std::vector<PersistentTensor>> elements(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      elements[i].emplace_back(tuple[i]);
+    }
+    if (TryEnqueueWithoutBlocking(elements, ctx)) {
+      callback();
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -107,6 +161,28 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  if (batch_size <= capacity_) {
+    // Split the batch outside of mu_, then enqueue all of its elements at
+    // once if they fit.
+    std::vector<std::vector<PersistentTensor>> elements(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      elements[i].resize(batch_size);
+      for (int64 index = 0; index < batch_size; ++index) {
+        Status s = GetElementComponentFromBatch(tuple, index, i, ctx,
+                                                &elements[i][index]);
+        if (!s.ok()) {
+          ctx->SetStatus(s);
+          callback();
+          return;
+        }
+      }
+    }
+    if (TryEnqueueWithoutBlocking(elements, ctx)) {
+      callback();
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -153,6 +229,19 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  {
+    std::vector<std::vector<PersistentTensor>> elements;
+    if (TryDequeueWithoutBlocking(1, ctx, &elements)) {
+      Tuple tuple;
+      tuple.reserve(num_components());
+      for (int i = 0; i < num_components(); ++i) {
+        tuple.push_back(*elements[i][0].AccessTensor(ctx));
+      }
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -244,6 +333,32 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
     return;
   }
 
+  {
+    // Take all the elements at once, and assemble the batch outside of mu_.
+    std::vector<std::vector<PersistentTensor>> elements;
+    if (TryDequeueWithoutBlocking(num_elements, ctx, &elements)) {
+      Tuple tuple;
+      tuple.reserve(num_components());
+      for (int i = 0; i < num_components(); ++i) {
+        Tensor batch;
+        Status s = ctx->allocate_temp(component_dtypes_[i],
+                                      ManyOutShape(i, num_elements), &batch);
+        for (int64 index = 0; s.ok() && index < num_elements; ++index) {
+          s = batch_util::CopyElementToSlice(
+              *elements[i][index].AccessTensor(ctx), &batch, index);
+        }
+        if (!s.ok()) {
+          ctx->SetStatus(s);
+          callback(Tuple());
+          return;
+        }
+        tuple.emplace_back(batch);
+      }
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -66,6 +66,19 @@ class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
                                              OpKernelContext* ctx,
                                              PersistentTensor* out_element);
 
+  // Fast paths for the operations that can complete immediately, which hold
+  // mu_ only while moving elements and bypass the attempt queues and the
+  // cancellation manager. They only apply when no attempt is pending, so
+  // that elements and waiters are still served in FIFO order, and return
+  // false without side effects otherwise. `elements` holds the components of
+  // each enqueued element, component-major.
+  bool TryEnqueueWithoutBlocking(
+      const std::vector<std::vector<PersistentTensor>>& elements,
+      OpKernelContext* ctx);
+  bool TryDequeueWithoutBlocking(
+      int64 num_elements, OpKernelContext* ctx,
+      std::vector<std::vector<PersistentTensor>>* elements);
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(FIFOQueue);
 };
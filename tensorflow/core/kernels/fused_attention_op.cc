@@ -0,0 +1,189 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Scaled dot-product attention: softmax(query * key^T * scale) * value, as it
+// is produced by the Grappler remapper from the BatchMatMul + Softmax +
+// BatchMatMul subgraph (see grappler/optimizers/remapper.cc).
+//
+// The work is split into blocks of query rows of every batch element. Each
+// block computes its [kBlockRows, Lk] slice of attention scores in a scratch
+// buffer, normalizes it and immediately multiplies it with the value matrix,
+// so the full [..., Lq, Lk] score tensor is never written to memory.
+template <typename T>
+class FusedScaledDotProductAttentionOp : public OpKernel {
+ public:
+  explicit FusedScaledDotProductAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    float scale;
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale));
+    scale_ = T(scale);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+
+    const int rank = query.dims();
+    OP_REQUIRES(context, rank >= 2,
+                errors::InvalidArgument("query must have rank >= 2: ",
+                                        query.shape().DebugString()));
+    OP_REQUIRES(context, key.dims() == rank && value.dims() == rank,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank: ",
+                    query.shape().DebugString(), " vs. ",
+                    key.shape().DebugString(), " vs. ",
+                    value.shape().DebugString()));
+
+    TensorShape output_shape;
+    int64 batch_size = 1;
+    for (int i = 0; i < rank - 2; ++i) {
+      const int64 dim = query.dim_size(i);
+      OP_REQUIRES(context, key.dim_size(i) == dim && value.dim_size(i) == dim,
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions: ",
+                      query.shape().DebugString(), " vs. ",
+                      key.shape().DebugString(), " vs. ",
+                      value.shape().DebugString()));
+      output_shape.AddDim(dim);
+      batch_size *= dim;
+    }
+
+    const int64 query_size = query.dim_size(rank - 2);
+    const int64 depth = query.dim_size(rank - 1);
+    const int64 key_size = key.dim_size(rank - 2);
+    const int64 value_depth = value.dim_size(rank - 1);
+    OP_REQUIRES(context, key.dim_size(rank - 1) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same inner dimension: ",
+                    query.shape().DebugString(), " vs. ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(rank - 2) == key_size,
+                errors::InvalidArgument(
+                    "key and value must have the same number of rows: ",
+                    key.shape().DebugString(), " vs. ",
+                    value.shape().DebugString()));
+    output_shape.AddDim(query_size);
+    output_shape.AddDim(value_depth);
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    if (key_size == 0) {
+      // Softmax over an empty row is empty, and so is its product with value.
+      output->flat<T>().setZero();
+      return;
+    }
+
+    auto query_t = query.shaped<T, 3>({batch_size, query_size, depth});
+    auto key_t = key.shaped<T, 3>({batch_size, key_size, depth});
+    auto value_t = value.shaped<T, 3>({batch_size, key_size, value_depth});
+    auto output_t =
+        output->shaped<T, 3>({batch_size, query_size, value_depth});
+
+    const int64 num_blocks = (query_size + kBlockRows - 1) / kBlockRows;
+    const T scale = scale_;
+
+    auto compute_blocks = [&](int64 start, int64 limit) {
+      Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> query_key_dims;
+      query_key_dims[0] = Eigen::IndexPair<Eigen::DenseIndex>(1, 1);
+      Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> scores_value_dims;
+      scores_value_dims[0] = Eigen::IndexPair<Eigen::DenseIndex>(1, 0);
+
+      Eigen::Tensor<T, 2, Eigen::RowMajor> scores;
+      for (int64 i = start; i < limit; ++i) {
+        const int64 b = i / num_blocks;
+        const int64 row = (i % num_blocks) * kBlockRows;
+        const int64 rows = std::min(kBlockRows, query_size - row);
+
+        typename TTypes<T>::UnalignedConstMatrix query_block(
+            query_t.data() + (b * query_size + row) * depth, rows, depth);
+        typename TTypes<T>::UnalignedConstMatrix key_block(
+            key_t.data() + b * key_size * depth, key_size, depth);
+        typename TTypes<T>::UnalignedConstMatrix value_block(
+            value_t.data() + b * key_size * value_depth, key_size,
+            value_depth);
+        typename TTypes<T>::UnalignedMatrix output_block(
+            output_t.data() + (b * query_size + row) * value_depth, rows,
+            value_depth);
+
+        scores = query_block.contract(key_block, query_key_dims) * scale;
+
+        // Numerically stable softmax over every row of the scores.
+        for (int64 r = 0; r < rows; ++r) {
+          T* scores_row = scores.data() + r * key_size;
+          const T max_score = *std::max_element(scores_row,
+                                                scores_row + key_size);
+          T sum = T(0);
+          for (int64 c = 0; c < key_size; ++c) {
+            scores_row[c] = std::exp(scores_row[c] - max_score);
+            sum += scores_row[c];
+          }
+          const T inv_sum = T(1) / sum;
+          for (int64 c = 0; c < key_size; ++c) {
+            scores_row[c] *= inv_sum;
+          }
+        }
+
+        output_block = scores.contract(value_block, scores_value_dims);
+      }
+    };
+
+    const int64 cost_per_block =
+        kBlockRows * key_size * (2 * depth + 2 * value_depth + 10);
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch_size * num_blocks, cost_per_block, compute_blocks);
+  }
+
+ private:
+  // Number of query rows processed together in one block.
+  static constexpr int64 kBlockRows = 64;
+
+  T scale_;
+};
+
+template <typename T>
+constexpr int64 FusedScaledDotProductAttentionOp<T>::kBlockRows;
+
+#define REGISTER_CPU(T)                                          \
+  REGISTER_KERNEL_BUILDER(Name("_FusedScaledDotProductAttention") \
+                              .Device(DEVICE_CPU)                 \
+                              .TypeConstraint<T>("T"),            \
+                          FusedScaledDotProductAttentionOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
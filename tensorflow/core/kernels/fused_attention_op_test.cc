@@ -0,0 +1,119 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedScaledDotProductAttentionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(float scale) {
+    TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedScaledDotProductAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("scale", scale)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Computes softmax(query * key^T * scale) * value with plain loops.
+  static Tensor ReferenceAttention(const Tensor& query, const Tensor& key,
+                                   const Tensor& value, float scale) {
+    const int64 batch = query.dim_size(0);
+    const int64 query_size = query.dim_size(1);
+    const int64 depth = query.dim_size(2);
+    const int64 key_size = key.dim_size(1);
+    const int64 value_depth = value.dim_size(2);
+    auto q = query.tensor<float, 3>();
+    auto k = key.tensor<float, 3>();
+    auto v = value.tensor<float, 3>();
+
+    Tensor output(DT_FLOAT, TensorShape({batch, query_size, value_depth}));
+    auto o = output.tensor<float, 3>();
+    std::vector<float> weights(key_size);
+    for (int64 b = 0; b < batch; ++b) {
+      for (int64 i = 0; i < query_size; ++i) {
+        float sum = 0;
+        for (int64 j = 0; j < key_size; ++j) {
+          float score = 0;
+          for (int64 d = 0; d < depth; ++d) score += q(b, i, d) * k(b, j, d);
+          weights[j] = std::exp(score * scale);
+          sum += weights[j];
+        }
+        for (int64 d = 0; d < value_depth; ++d) {
+          float out = 0;
+          for (int64 j = 0; j < key_size; ++j) {
+            out += weights[j] / sum * v(b, j, d);
+          }
+          o(b, i, d) = out;
+        }
+      }
+    }
+    return output;
+  }
+
+  void RunAndCompare(int64 batch, int64 query_size, int64 key_size,
+                     int64 depth, int64 value_depth, float scale) {
+    MakeOp(scale);
+    Tensor query(DT_FLOAT, TensorShape({batch, query_size, depth}));
+    Tensor key(DT_FLOAT, TensorShape({batch, key_size, depth}));
+    Tensor value(DT_FLOAT, TensorShape({batch, key_size, value_depth}));
+    query.flat<float>().setRandom();
+    key.flat<float>().setRandom();
+    value.flat<float>().setRandom();
+
+    AddInputFromArray<float>(query.shape(), query.flat<float>());
+    AddInputFromArray<float>(key.shape(), key.flat<float>());
+    AddInputFromArray<float>(value.shape(), value.flat<float>());
+    TF_ASSERT_OK(RunOpKernel());
+
+    test::ExpectTensorNear<float>(ReferenceAttention(query, key, value, scale),
+                                  *GetOutput(0), 1e-5);
+  }
+};
+
+TEST_F(FusedScaledDotProductAttentionOpTest, Small) {
+  RunAndCompare(/*batch=*/2, /*query_size=*/3, /*key_size=*/4, /*depth=*/8,
+                /*value_depth=*/5, /*scale=*/0.35);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, SeveralQueryBlocks) {
+  RunAndCompare(/*batch=*/3, /*query_size=*/150, /*key_size=*/33,
+                /*depth=*/16, /*value_depth=*/7, /*scale=*/0.25);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, MismatchedBatchDimensions) {
+  MakeOp(1.0);
+  AddInputFromArray<float>(TensorShape({2, 1, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({1, 1, 2}), {1, 2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
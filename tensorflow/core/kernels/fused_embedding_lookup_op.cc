@@ -0,0 +1,240 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+enum class Combiner { kSum, kMean, kSqrtN };
+
+Status GetCombiner(OpKernelConstruction* context, Combiner* combiner) {
+  string combiner_name;
+  TF_RETURN_IF_ERROR(context->GetAttr("combiner", &combiner_name));
+  if (combiner_name == "sum") {
+    *combiner = Combiner::kSum;
+  } else if (combiner_name == "mean") {
+    *combiner = Combiner::kMean;
+  } else if (combiner_name == "sqrtn") {
+    *combiner = Combiner::kSqrtN;
+  } else {
+    return errors::InvalidArgument("Unsupported combiner: ", combiner_name);
+  }
+  return Status::OK();
+}
+
+// Computes SparseSegment<Combiner>(Gather(params, ids), indices, segment_ids)
+// into `context` output 0. Each segment is accumulated in its output row
+// straight from the rows of `params`, so the [nnz, ...] gathered tensor is
+// never materialized. Segments are sharded over the intra-op thread pool.
+template <typename T, typename Tids, typename Tidx>
+void ComputeEmbeddingSparseLookup(OpKernelContext* context, Combiner combiner,
+                                  const Tensor& params, const Tensor& ids,
+                                  const Tensor& indices,
+                                  const Tensor& segment_ids) {
+  OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+              errors::InvalidArgument("params must be at least 1 dimensional"));
+  OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+              errors::InvalidArgument("ids should be a vector: ",
+                                      ids.shape().DebugString()));
+  OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+              errors::InvalidArgument("indices should be a vector: ",
+                                      indices.shape().DebugString()));
+  OP_REQUIRES(context, TensorShapeUtils::IsVector(segment_ids.shape()),
+              errors::InvalidArgument("segment_ids should be a vector: ",
+                                      segment_ids.shape().DebugString()));
+  const int64 num_indices = indices.NumElements();
+  OP_REQUIRES(context, num_indices == segment_ids.NumElements(),
+              errors::InvalidArgument(
+                  "segment_ids and indices should have same size."));
+
+  const auto ids_vec = ids.vec<Tids>();
+  const auto indices_vec = indices.vec<Tidx>();
+  const auto segment_vec = segment_ids.vec<int32>();
+  const int64 num_ids = ids.NumElements();
+  const int64 num_rows = params.dim_size(0);
+
+  // Checks the inputs, and finds where each segment starts. Segments without
+  // any index are empty and left at zero.
+  std::vector<int64> segment_starts;
+  int32 previous_segment = 0;
+  for (int64 i = 0; i < num_indices; ++i) {
+    const int32 segment = segment_vec(i);
+    OP_REQUIRES(context, segment >= previous_segment,
+                errors::InvalidArgument("segment ids must be >= 0 and ",
+                                        "increasing, got ", segment, " after ",
+                                        previous_segment));
+    while (static_cast<int64>(segment_starts.size()) <= segment) {
+      segment_starts.push_back(i);
+    }
+    previous_segment = segment;
+    const Tidx index = indices_vec(i);
+    OP_REQUIRES(context, index >= 0 && index < num_ids,
+                errors::InvalidArgument("indices[", i, "] = ", index,
+                                        " is not in [0, ", num_ids, ")"));
+    const Tids id = ids_vec(index);
+    OP_REQUIRES(context, id >= 0 && id < num_rows,
+                errors::InvalidArgument("ids[", index, "] = ", id,
+                                        " is not in [0, ", num_rows, ")"));
+  }
+  const int64 num_segments = segment_starts.size();
+  segment_starts.push_back(num_indices);
+
+  TensorShape output_shape = params.shape();
+  output_shape.set_dim(0, num_segments);
+  Tensor* output = nullptr;
+  OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+  if (output->NumElements() == 0) return;
+
+  const int64 row_size = output->NumElements() / num_segments;
+  const T* params_data = params.flat<T>().data();
+  T* output_data = output->flat<T>().data();
+
+  using ConstRow = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+  using Row = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+  auto params_row = [&](int64 i) {
+    return params_data + ids_vec(indices_vec(i)) * row_size;
+  };
+  auto reduce_segments = [&](int64 begin, int64 end) {
+    for (int64 s = begin; s < end; ++s) {
+      Row out(output_data + s * row_size, row_size);
+      out.setZero();
+      const int64 start = segment_starts[s];
+      const int64 limit = segment_starts[s + 1];
+      for (int64 i = start; i < limit; ++i) {
+        if (i + 1 < limit) {
+          port::prefetch<port::PREFETCH_HINT_T0>(params_row(i + 1));
+        }
+        out += ConstRow(params_row(i), row_size);
+      }
+      const int64 count = limit - start;
+      if (count > 1 && combiner == Combiner::kMean) {
+        out /= static_cast<T>(count);
+      } else if (count > 1 && combiner == Combiner::kSqrtN) {
+        out /= static_cast<T>(std::sqrt(static_cast<double>(count)));
+      }
+    }
+  };
+
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  const int64 cost_per_segment =
+      (num_indices / num_segments + 1) * row_size * sizeof(T);
+  Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+        cost_per_segment, reduce_segments);
+}
+
+}  // namespace
+
+// Gather + SparseSegment{Sum,Mean,SqrtN}, as it is produced by the Grappler
+// remapper from the `embedding_lookup_sparse` subgraph (see
+// grappler/optimizers/remapper.cc).
+template <typename T, typename Tids, typename Tidx>
+class FusedEmbeddingSparseLookupOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingSparseLookupOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    ComputeEmbeddingSparseLookup<T, Tids, Tidx>(
+        context, combiner_, context->input(0), context->input(1),
+        context->input(2), context->input(3));
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+// Same as FusedEmbeddingSparseLookupOp, with the rows read from a resource
+// variable like ResourceGather does.
+template <typename T, typename Tids, typename Tidx>
+class FusedResourceEmbeddingSparseLookupOp : public OpKernel {
+ public:
+  explicit FusedResourceEmbeddingSparseLookupOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<Var> v;
+    OP_REQUIRES_OK(context,
+                   LookupResource(context, HandleFromInput(context, 0), &v));
+    OP_REQUIRES_OK(context,
+                   EnsureSparseVariableAccess<CPUDevice, T>(context, v.get()));
+    // As in ResourceGather, the lock is held for the whole lookup so that
+    // concurrent writes don't copy the variable buffer.
+    tf_shared_lock ml(*v->mu());
+    const Tensor& params = *v->tensor();
+    OP_REQUIRES(context, params.dtype() == DataTypeToEnum<T>::v(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(DataTypeToEnum<T>::v()), " got ",
+                    DataTypeString(params.dtype())));
+    ComputeEmbeddingSparseLookup<T, Tids, Tidx>(
+        context, combiner_, params, context->input(1), context->input(2),
+        context->input(3));
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+#define REGISTER_CPU(T, Tids, Tidx)                           \
+  REGISTER_KERNEL_BUILDER(Name("_FusedEmbeddingSparseLookup") \
+                              .Device(DEVICE_CPU)             \
+                              .TypeConstraint<T>("T")         \
+                              .TypeConstraint<Tids>("Tids")   \
+                              .TypeConstraint<Tidx>("Tidx"),  \
+                          FusedEmbeddingSparseLookupOp<T, Tids, Tidx>); \
+  REGISTER_KERNEL_BUILDER(                                    \
+      Name("_FusedResourceEmbeddingSparseLookup")             \
+          .Device(DEVICE_CPU)                                 \
+          .HostMemory("resource")                             \
+          .TypeConstraint<T>("dtype")                         \
+          .TypeConstraint<Tids>("Tids")                       \
+          .TypeConstraint<Tidx>("Tidx"),                      \
+      FusedResourceEmbeddingSparseLookupOp<T, Tids, Tidx>);
+
+#define REGISTER_CPU_ALL_INDICES(T) \
+  REGISTER_CPU(T, int32, int32);    \
+  REGISTER_CPU(T, int32, int64);    \
+  REGISTER_CPU(T, int64, int32);    \
+  REGISTER_CPU(T, int64, int64);
+
+TF_CALL_float(REGISTER_CPU_ALL_INDICES);
+#undef REGISTER_CPU_ALL_INDICES
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,99 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedEmbeddingSparseLookupOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& combiner) {
+    TF_ASSERT_OK(
+        NodeDefBuilder("embedding_lookup", "_FusedEmbeddingSparseLookup")
+            .Input(FakeInput(DT_FLOAT))
+            .Input(FakeInput(DT_INT64))
+            .Input(FakeInput(DT_INT32))
+            .Input(FakeInput(DT_INT32))
+            .Attr("combiner", combiner)
+            .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Segment 0 combines rows 3 and 0, segment 1 is empty, and segment 2
+  // combines row 2 twice.
+  void AddInputs() {
+    AddInputFromArray<float>(TensorShape({4, 2}), {1, 2, 3, 4, 5, 6, 7, 8});
+    AddInputFromArray<int64>(TensorShape({4}), {3, 0, 2, 1});
+    AddInputFromArray<int32>(TensorShape({4}), {0, 1, 2, 2});
+    AddInputFromArray<int32>(TensorShape({4}), {0, 0, 2, 2});
+  }
+
+  void ExpectOutput(const std::vector<float>& values) {
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+    test::FillValues<float>(&expected, values);
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+  }
+};
+
+TEST_F(FusedEmbeddingSparseLookupOpTest, Sum) {
+  MakeOp("sum");
+  AddInputs();
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectOutput({8, 10, 0, 0, 10, 12});
+}
+
+TEST_F(FusedEmbeddingSparseLookupOpTest, Mean) {
+  MakeOp("mean");
+  AddInputs();
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectOutput({4, 5, 0, 0, 5, 6});
+}
+
+TEST_F(FusedEmbeddingSparseLookupOpTest, SqrtN) {
+  MakeOp("sqrtn");
+  AddInputs();
+  TF_ASSERT_OK(RunOpKernel());
+  ExpectOutput({5.656854, 7.071068, 0, 0, 7.071068, 8.485281});
+}
+
+TEST_F(FusedEmbeddingSparseLookupOpTest, InvalidId) {
+  MakeOp("sum");
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<int64>(TensorShape({2}), {0, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedEmbeddingSparseLookupOpTest, UnsortedSegments) {
+  MakeOp("sum");
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<int64>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,126 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Layer normalization over the innermost dimension, as it is produced by the
+// Grappler remapper from the `nn.moments` + `nn.batch_normalization` subgraph
+// (see grappler/optimizers/remapper.cc).
+template <typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    float epsilon;
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon));
+    epsilon_ = T(epsilon);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x_input = context->input(0);
+    const Tensor& scale_input = context->input(1);
+    const Tensor& offset_input = context->input(2);
+
+    OP_REQUIRES(context, x_input.dims() >= 1,
+                errors::InvalidArgument("x must have at least 1 dimension: ",
+                                        x_input.shape().DebugString()));
+    const int64 depth = x_input.dim_size(x_input.dims() - 1);
+    OP_REQUIRES(context,
+                scale_input.dims() == 1 && scale_input.dim_size(0) == depth,
+                errors::InvalidArgument("scale must be a vector of size ",
+                                        depth, ": ",
+                                        scale_input.shape().DebugString()));
+    OP_REQUIRES(context,
+                offset_input.dims() == 1 && offset_input.dim_size(0) == depth,
+                errors::InvalidArgument("offset must be a vector of size ",
+                                        depth, ": ",
+                                        offset_input.shape().DebugString()));
+
+    Tensor* y_output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x_input.shape(), &y_output));
+    if (x_input.NumElements() == 0) return;
+
+    const int64 rest_size = x_input.NumElements() / depth;
+
+    typename TTypes<T>::ConstMatrix x = x_input.flat_inner_dims<T>();
+    typename TTypes<T>::ConstVec scale = scale_input.vec<T>();
+    typename TTypes<T>::ConstVec offset = offset_input.vec<T>();
+    typename TTypes<T>::Matrix y = y_output->flat_inner_dims<T>();
+
+    const CPUDevice& d = context->eigen_device<CPUDevice>();
+
+#if !defined(EIGEN_HAS_INDEX_LIST)
+    Eigen::DSizes<Eigen::Index, 2> rest_by_one(rest_size, 1);
+    Eigen::DSizes<Eigen::Index, 2> one_by_depth(1, depth);
+    Eigen::array<int, 1> reduce_dims({1});
+    Eigen::array<Eigen::Index, 2> bcast_depth({1, depth});
+    Eigen::array<Eigen::Index, 2> bcast_rest({rest_size, 1});
+#else
+    Eigen::IndexList<Eigen::Index, Eigen::type2index<1>> rest_by_one;
+    rest_by_one.set(0, rest_size);
+    Eigen::IndexList<Eigen::type2index<1>, Eigen::Index> one_by_depth;
+    one_by_depth.set(1, depth);
+    Eigen::IndexList<Eigen::type2index<1>> reduce_dims;
+    Eigen::IndexList<Eigen::type2index<1>, Eigen::Index> bcast_depth;
+    bcast_depth.set(1, depth);
+    Eigen::IndexList<Eigen::Index, Eigen::type2index<1>> bcast_rest;
+    bcast_rest.set(0, rest_size);
+#endif
+
+    // Two passes over `x`: one for the per-row statistics, and one that
+    // produces the normalized output, instead of the half dozen broadcasted
+    // elementwise ops of the unfused subgraph.
+    Eigen::Tensor<T, 1, Eigen::RowMajor> mean(rest_size);
+    Eigen::Tensor<T, 1, Eigen::RowMajor> inv_stddev(rest_size);
+    mean.device(d) = x.mean(reduce_dims);
+
+    auto x_centered =
+        x - mean.reshape(rest_by_one).broadcast(bcast_depth);
+    inv_stddev.device(d) =
+        (x_centered.square().mean(reduce_dims) + epsilon_).rsqrt();
+
+    y.device(d) =
+        x_centered * inv_stddev.reshape(rest_by_one).broadcast(bcast_depth) *
+            scale.reshape(one_by_depth).broadcast(bcast_rest) +
+        offset.reshape(one_by_depth).broadcast(bcast_rest);
+  }
+
+ private:
+  T epsilon_;
+};
+
+#define REGISTER_CPU(T)                                                   \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedLayerNormOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,522 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Runs a fixed suite of hot CPU kernels and reports, for each of them, the
+// measured time, the allocations done by the kernel, and the efficiency
+// relative to the roofline predicted by the grappler OpLevelCostEstimator.
+//
+// The results are written as a BenchmarkEntries proto in JSON format, with
+// one entry per case. The entry names and metric names are stable, so the
+// output of a previous run can be passed as --baseline to fail on kernel
+// regressions, e.g. when upgrading Eigen or MKL:
+//
+//   kernel_efficiency_benchmark --output=/tmp/new.json \
+//       --baseline=/tmp/old.json --max_time_regression=0.1
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tracking_allocator.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/human_readable_json.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/core/util/test_log.pb.h"
+
+namespace tensorflow {
+namespace {
+
+// Names of the metrics of each BenchmarkEntry.
+constexpr char kTimePerIterMetric[] = "time_per_iter_us";
+constexpr char kAllocationsMetric[] = "allocations_per_iter";
+constexpr char kAllocatedBytesMetric[] = "allocated_bytes_per_iter";
+constexpr char kPredictedFlopsMetric[] = "predicted_flops";
+constexpr char kPredictedBytesMetric[] = "predicted_bytes";
+constexpr char kGflopsMetric[] = "achieved_gflops_per_sec";
+constexpr char kGbytesMetric[] = "achieved_gbytes_per_sec";
+constexpr char kRooflineEfficiencyMetric[] = "roofline_efficiency";
+
+struct BenchmarkCase {
+  string name;
+  NodeDef node_def;
+  std::vector<Tensor> inputs;
+};
+
+Tensor RandomTensor(DataType dtype, const TensorShape& shape,
+                    random::SimplePhilox* rnd) {
+  Tensor tensor(dtype, shape);
+  if (dtype == DT_FLOAT) {
+    auto flat = tensor.flat<float>();
+    for (int64 i = 0; i < flat.size(); ++i) flat(i) = rnd->RandFloat() - 0.5f;
+  } else {
+    CHECK_EQ(dtype, DT_INT32);
+    tensor.flat<int32>().setZero();
+  }
+  return tensor;
+}
+
+// Returns int32 indices in [0, limit), sorted if `sorted` is true.
+Tensor RandomIndices(int64 size, int32 limit, bool sorted,
+                     random::SimplePhilox* rnd) {
+  Tensor tensor(DT_INT32, TensorShape({size}));
+  auto flat = tensor.flat<int32>();
+  for (int64 i = 0; i < size; ++i) flat(i) = rnd->Uniform(limit);
+  if (sorted) std::sort(flat.data(), flat.data() + size);
+  return tensor;
+}
+
+Tensor Int32Vector(const std::vector<int32>& values) {
+  Tensor tensor(DT_INT32, TensorShape({static_cast<int64>(values.size())}));
+  std::copy(values.begin(), values.end(), tensor.flat<int32>().data());
+  return tensor;
+}
+
+Tensor Int32Scalar(int32 value) {
+  Tensor tensor(DT_INT32, TensorShape({}));
+  tensor.scalar<int32>()() = value;
+  return tensor;
+}
+
+BenchmarkCase MakeCase(const string& name, NodeDefBuilder* builder,
+                       std::vector<Tensor> inputs) {
+  BenchmarkCase benchmark_case;
+  benchmark_case.name = name;
+  TF_CHECK_OK(builder->Finalize(&benchmark_case.node_def));
+  benchmark_case.inputs = std::move(inputs);
+  return benchmark_case;
+}
+
+std::vector<BenchmarkCase> MakeBenchmarkCases() {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<BenchmarkCase> cases;
+
+  auto add_matmul = [&](int m, int k, int n) {
+    NodeDefBuilder builder("matmul", "MatMul");
+    builder.Input(FakeInput(DT_FLOAT)).Input(FakeInput(DT_FLOAT));
+    cases.push_back(MakeCase(
+        strings::StrCat("MatMul/", m, "x", k, "x", n), &builder,
+        {RandomTensor(DT_FLOAT, TensorShape({m, k}), &rnd),
+         RandomTensor(DT_FLOAT, TensorShape({k, n}), &rnd)}));
+  };
+  add_matmul(1024, 1024, 1024);
+  add_matmul(128, 4096, 1024);
+  add_matmul(8, 1024, 4096);
+
+  auto add_conv2d = [&](int batch, int size, int in_depth, int filter,
+                        int out_depth, int stride) {
+    NodeDefBuilder builder("conv2d", "Conv2D");
+    builder.Input(FakeInput(DT_FLOAT))
+        .Input(FakeInput(DT_FLOAT))
+        .Attr("strides", {1, stride, stride, 1})
+        .Attr("padding", "SAME");
+    cases.push_back(MakeCase(
+        strings::StrCat("Conv2D/", batch, "x", size, "x", size, "x", in_depth,
+                        "/", filter, "x", filter, "x", out_depth, "/s",
+                        stride),
+        &builder,
+        {RandomTensor(DT_FLOAT, TensorShape({batch, size, size, in_depth}),
+                      &rnd),
+         RandomTensor(DT_FLOAT,
+                      TensorShape({filter, filter, in_depth, out_depth}),
+                      &rnd)}));
+  };
+  add_conv2d(32, 56, 64, 3, 64, 1);
+  add_conv2d(32, 28, 256, 1, 128, 1);
+  add_conv2d(8, 224, 3, 7, 64, 2);
+
+  auto add_gather = [&](int rows, int cols, int num_indices) {
+    NodeDefBuilder builder("gather", "GatherV2");
+    builder.Input(FakeInput(DT_FLOAT))
+        .Input(FakeInput(DT_INT32))
+        .Input(FakeInput(DT_INT32));
+    cases.push_back(MakeCase(
+        strings::StrCat("GatherV2/", rows, "x", cols, "/", num_indices),
+        &builder,
+        {RandomTensor(DT_FLOAT, TensorShape({rows, cols}), &rnd),
+         RandomIndices(num_indices, rows, /*sorted=*/false, &rnd),
+         Int32Scalar(0)}));
+  };
+  add_gather(100000, 64, 16384);
+  add_gather(1000, 1024, 4096);
+
+  auto add_segment = [&](const string& op, int rows, int cols,
+                         int num_segments) {
+    const bool sorted = op == "SegmentSum";
+    NodeDefBuilder builder("segment", op);
+    builder.Input(FakeInput(DT_FLOAT)).Input(FakeInput(DT_INT32));
+    std::vector<Tensor> inputs = {
+        RandomTensor(DT_FLOAT, TensorShape({rows, cols}), &rnd),
+        RandomIndices(rows, num_segments, sorted, &rnd)};
+    if (!sorted) {
+      builder.Input(FakeInput(DT_INT32));
+      inputs.push_back(Int32Scalar(num_segments));
+    }
+    cases.push_back(MakeCase(
+        strings::StrCat(op, "/", rows, "x", cols, "/", num_segments), &builder,
+        std::move(inputs)));
+  };
+  add_segment("SegmentSum", 65536, 64, 1024);
+  add_segment("UnsortedSegmentSum", 65536, 64, 1024);
+
+  auto add_cwise = [&](const string& op, const TensorShape& x_shape,
+                       const TensorShape& y_shape) {
+    NodeDefBuilder builder("cwise", op);
+    builder.Input(FakeInput(DT_FLOAT));
+    std::vector<Tensor> inputs = {RandomTensor(DT_FLOAT, x_shape, &rnd)};
+    string name = strings::StrCat(op, "/", x_shape.DebugString());
+    if (y_shape.dims() > 0) {
+      builder.Input(FakeInput(DT_FLOAT));
+      inputs.push_back(RandomTensor(DT_FLOAT, y_shape, &rnd));
+      strings::StrAppend(&name, "/", y_shape.DebugString());
+    }
+    cases.push_back(MakeCase(name, &builder, std::move(inputs)));
+  };
+  add_cwise("Add", TensorShape({1 << 22}), TensorShape({1 << 22}));
+  add_cwise("Mul", TensorShape({4096, 1024}), TensorShape({1024}));
+  add_cwise("Add", TensorShape({32, 56, 56, 64}), TensorShape({64}));
+  add_cwise("Relu", TensorShape({1 << 22}), TensorShape({}));
+  add_cwise("Tanh", TensorShape({1 << 22}), TensorShape({}));
+
+  auto add_transpose = [&](const TensorShape& shape,
+                           const std::vector<int32>& perm) {
+    NodeDefBuilder builder("transpose", "Transpose");
+    builder.Input(FakeInput(DT_FLOAT)).Input(FakeInput(DT_INT32));
+    cases.push_back(MakeCase(
+        strings::StrCat("Transpose/", shape.DebugString(), "/",
+                        absl::StrJoin(perm, ",")),
+        &builder, {RandomTensor(DT_FLOAT, shape, &rnd), Int32Vector(perm)}));
+  };
+  add_transpose(TensorShape({2048, 2048}), {1, 0});
+  add_transpose(TensorShape({32, 56, 56, 64}), {0, 3, 1, 2});
+  add_transpose(TensorShape({32, 64, 56, 56}), {0, 2, 3, 1});
+
+  return cases;
+}
+
+// Allocations done by one run of a kernel, through its tracking allocators.
+struct AllocationStats {
+  int64 count = 0;
+  int64 bytes = 0;
+};
+
+// Runs the kernel of a BenchmarkCase directly, without an executor, so that
+// the measured time only includes OpKernel::Compute.
+class KernelRunner {
+ public:
+  KernelRunner(Device* device, const BenchmarkCase& benchmark_case)
+      : device_(device), benchmark_case_(benchmark_case) {
+    for (const Tensor& input : benchmark_case_.inputs) {
+      inputs_.push_back({nullptr, const_cast<Tensor*>(&input)});
+    }
+  }
+
+  Status Init() {
+    Status status;
+    kernel_ = CreateOpKernel(DEVICE_CPU, device_,
+                             device_->GetAllocator(AllocatorAttributes()),
+                             benchmark_case_.node_def, TF_GRAPH_DEF_VERSION,
+                             &status);
+    return status;
+  }
+
+  // Runs the kernel once. If `allocations` is not null, the allocations of
+  // the kernel are tracked and returned in it. If `outputs` is not null, the
+  // outputs are returned in it.
+  Status Run(AllocationStats* allocations, std::vector<Tensor>* outputs) {
+    OpKernelContext::Params params;
+    params.device = device_;
+    params.frame_iter = FrameAndIter(0, 0);
+    params.inputs = &inputs_;
+    params.op_kernel = kernel_.get();
+    params.track_allocations = allocations != nullptr;
+    params.runner = &runner_;
+    OpKernelContext context(&params);
+    device_->Compute(kernel_.get(), &context);
+    if (allocations != nullptr) {
+      for (const auto& wrapped : context.ConsumeWrappedAllocators()) {
+        for (const AllocRecord& record :
+             wrapped.second->GetRecordsAndUnRef()) {
+          if (record.alloc_bytes > 0) {
+            ++allocations->count;
+            allocations->bytes += record.alloc_bytes;
+          }
+        }
+      }
+    }
+    TF_RETURN_IF_ERROR(context.status());
+    if (outputs != nullptr) {
+      for (int i = 0; i < context.num_outputs(); ++i) {
+        outputs->push_back(*context.mutable_output(i));
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  Device* const device_;
+  const BenchmarkCase& benchmark_case_;
+  std::unique_ptr<OpKernel> kernel_;
+  gtl::InlinedVector<TensorValue, 4> inputs_;
+  std::function<void(std::function<void()>)> runner_ =
+      [](std::function<void()> fn) { fn(); };
+};
+
+void AddTensorProperties(const Tensor& tensor,
+                         OpInfo::TensorProperties* properties) {
+  properties->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(properties->mutable_shape());
+}
+
+// Returns the costs predicted by the OpLevelCostEstimator for `benchmark_case`
+// on `device`, given the outputs of a run of the kernel.
+grappler::Costs PredictCosts(const grappler::OpLevelCostEstimator& estimator,
+                             const DeviceProperties& device,
+                             const BenchmarkCase& benchmark_case,
+                             const std::vector<Tensor>& outputs) {
+  grappler::OpContext op_context;
+  op_context.name = benchmark_case.node_def.name();
+  op_context.device_name = "/device:CPU:0";
+  OpInfo* op_info = &op_context.op_info;
+  op_info->set_op(benchmark_case.node_def.op());
+  *op_info->mutable_attr() = benchmark_case.node_def.attr();
+  *op_info->mutable_device() = device;
+  for (const Tensor& input : benchmark_case.inputs) {
+    OpInfo::TensorProperties* properties = op_info->add_inputs();
+    AddTensorProperties(input, properties);
+    if (input.dtype() == DT_INT32 && input.NumElements() <= 8) {
+      input.AsProtoTensorContent(properties->mutable_value());
+    }
+  }
+  for (const Tensor& output : outputs) {
+    AddTensorProperties(output, op_info->add_outputs());
+  }
+  return estimator.PredictCosts(op_context);
+}
+
+void AddMetric(const string& name, double value, BenchmarkEntry* entry) {
+  MetricEntry* metric = entry->add_metrics();
+  metric->set_name(name);
+  metric->set_value(value);
+}
+
+Status RunBenchmarkCase(Device* device, const DeviceProperties& properties,
+                        const grappler::OpLevelCostEstimator& estimator,
+                        const BenchmarkCase& benchmark_case, double min_time,
+                        int64 min_iters, BenchmarkEntry* entry) {
+  KernelRunner runner(device, benchmark_case);
+  TF_RETURN_IF_ERROR(runner.Init());
+
+  // The first run is a warmup run, which also tracks the allocations and
+  // returns the output shapes. The tracking allocators are not used for the
+  // timed runs, since they add a lock per allocation.
+  AllocationStats allocations;
+  std::vector<Tensor> outputs;
+  TF_RETURN_IF_ERROR(runner.Run(&allocations, &outputs));
+
+  Env* env = Env::Default();
+  int64 iters = 0;
+  const uint64 start_micros = env->NowMicros();
+  uint64 elapsed_micros = 0;
+  while (iters < min_iters || elapsed_micros < min_time * 1e6) {
+    TF_RETURN_IF_ERROR(runner.Run(nullptr, nullptr));
+    ++iters;
+    elapsed_micros = env->NowMicros() - start_micros;
+  }
+  const double time_per_iter_us = static_cast<double>(elapsed_micros) / iters;
+
+  // The predicted compute and memory times are converted back to operations
+  // and bytes with the peak rates the estimator assumed for the device, so
+  // the roofline is the larger of the two times at peak rates.
+  const grappler::Costs costs =
+      PredictCosts(estimator, properties, benchmark_case, outputs);
+  const grappler::DeviceInfo device_info = estimator.GetDeviceInfo(properties);
+  const double compute_ns = costs.compute_time.count();
+  const double memory_ns = costs.memory_time.count();
+  const double predicted_flops = compute_ns * device_info.gigaops;
+  const double predicted_bytes = memory_ns * device_info.gb_per_sec;
+  const double roofline_us = std::max(compute_ns, memory_ns) / 1e3;
+
+  entry->set_name(benchmark_case.name);
+  entry->set_iters(iters);
+  entry->set_wall_time(elapsed_micros / 1e6);
+  AddMetric(kTimePerIterMetric, time_per_iter_us, entry);
+  AddMetric(kAllocationsMetric, allocations.count, entry);
+  AddMetric(kAllocatedBytesMetric, allocations.bytes, entry);
+  AddMetric(kPredictedFlopsMetric, predicted_flops, entry);
+  AddMetric(kPredictedBytesMetric, predicted_bytes, entry);
+  AddMetric(kGflopsMetric, predicted_flops / (time_per_iter_us * 1e3), entry);
+  AddMetric(kGbytesMetric, predicted_bytes / (time_per_iter_us * 1e3), entry);
+  AddMetric(kRooflineEfficiencyMetric, roofline_us / time_per_iter_us, entry);
+  (*entry->mutable_extras())["op"].set_string_value(
+      benchmark_case.node_def.op());
+  (*entry->mutable_extras())["cost_estimate_inaccurate"].set_double_value(
+      costs.inaccurate ? 1 : 0);
+  return Status::OK();
+}
+
+double GetMetric(const BenchmarkEntry& entry, const string& name) {
+  for (const MetricEntry& metric : entry.metrics()) {
+    if (metric.name() == name) return metric.value();
+  }
+  return -1;
+}
+
+// Compares `results` with `baseline`, and returns an error listing the cases
+// whose time per iteration grew by more than `max_time_regression`, or which
+// do more allocations. Cases missing from either side are ignored.
+Status CheckRegressions(const BenchmarkEntries& baseline,
+                        const BenchmarkEntries& results,
+                        double max_time_regression) {
+  std::unordered_map<string, const BenchmarkEntry*> baseline_entries;
+  for (const BenchmarkEntry& entry : baseline.entry()) {
+    baseline_entries[entry.name()] = &entry;
+  }
+  std::vector<string> regressions;
+  for (const BenchmarkEntry& entry : results.entry()) {
+    auto it = baseline_entries.find(entry.name());
+    if (it == baseline_entries.end()) continue;
+    const double old_time = GetMetric(*it->second, kTimePerIterMetric);
+    const double new_time = GetMetric(entry, kTimePerIterMetric);
+    if (old_time > 0 && new_time > old_time * (1 + max_time_regression)) {
+      regressions.push_back(strings::StrCat(entry.name(), ": ",
+                                            kTimePerIterMetric, " ", old_time,
+                                            " -> ", new_time));
+    }
+    const double old_allocations = GetMetric(*it->second, kAllocationsMetric);
+    const double new_allocations = GetMetric(entry, kAllocationsMetric);
+    if (old_allocations >= 0 && new_allocations > old_allocations) {
+      regressions.push_back(strings::StrCat(entry.name(), ": ",
+                                            kAllocationsMetric, " ",
+                                            old_allocations, " -> ",
+                                            new_allocations));
+    }
+  }
+  if (!regressions.empty()) {
+    return errors::FailedPrecondition("Kernel regressions:\n",
+                                      absl::StrJoin(regressions, "\n"));
+  }
+  return Status::OK();
+}
+
+int Main(int argc, char** argv) {
+  string output;
+  string baseline;
+  string filter;
+  float min_time = 1.0;
+  int64 min_iters = 10;
+  float max_time_regression = 0.1;
+  std::vector<Flag> flag_list = {
+      Flag("output", &output,
+           "file to write the results to as JSON, or empty for stdout"),
+      Flag("baseline", &baseline,
+           "JSON results of a previous run; the run fails if a case is "
+           "slower than the baseline by more than --max_time_regression, or "
+           "does more allocations"),
+      Flag("filter", &filter,
+           "only runs the cases whose name contains this string"),
+      Flag("min_time", &min_time, "minimum number of seconds to run a case"),
+      Flag("min_iters", &min_iters, "minimum number of iterations of a case"),
+      Flag("max_time_regression", &max_time_regression,
+           "allowed relative increase of the time per iteration"),
+  };
+  const string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  port::InitMain(argv[0], &argc, &argv);
+  if (!parse_result || argc > 1) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  std::unique_ptr<Device> device =
+      DeviceFactory::NewDevice("CPU", SessionOptions(),
+                               "/job:localhost/replica:0/task:0");
+  CHECK(device) << "Could not create CPU device";
+  const DeviceProperties properties = grappler::GetLocalCPUInfo();
+  grappler::OpLevelCostEstimator estimator;
+
+  BenchmarkEntries results;
+  for (const BenchmarkCase& benchmark_case : MakeBenchmarkCases()) {
+    if (!filter.empty() && benchmark_case.name.find(filter) == string::npos) {
+      continue;
+    }
+    BenchmarkEntry* entry = results.add_entry();
+    const Status status =
+        RunBenchmarkCase(device.get(), properties, estimator, benchmark_case,
+                         min_time, min_iters, entry);
+    if (!status.ok()) {
+      LOG(ERROR) << benchmark_case.name << " failed: " << status;
+      return 1;
+    }
+    LOG(INFO) << benchmark_case.name << ": "
+              << GetMetric(*entry, kTimePerIterMetric) << " us, "
+              << GetMetric(*entry, kRooflineEfficiencyMetric)
+              << " of roofline";
+  }
+
+  string json;
+  TF_CHECK_OK(ProtoToHumanReadableJson(results, &json,
+                                       /*ignore_accuracy_loss=*/true));
+  if (output.empty()) {
+    std::cout << json << std::endl;
+  } else {
+    TF_CHECK_OK(WriteStringToFile(Env::Default(), output, json));
+  }
+
+  if (!baseline.empty()) {
+    string baseline_json;
+    TF_CHECK_OK(ReadFileToString(Env::Default(), baseline, &baseline_json));
+    BenchmarkEntries baseline_results;
+    TF_CHECK_OK(HumanReadableJsonToProto(baseline_json, &baseline_results));
+    const Status status =
+        CheckRegressions(baseline_results, results, max_time_regression);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+int main(int argc, char** argv) { return tensorflow::Main(argc, argv); }
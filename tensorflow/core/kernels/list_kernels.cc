@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/concat_lib.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/batch_util.h"
 #include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
@@ -227,6 +228,67 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32 input_index,
   return Status::OK();
 }
 
+bool ElementsAreStorageSlices(const TensorList& tensor_list) {
+  const Tensor& storage = tensor_list.storage();
+  const std::vector<Tensor>& tensors = tensor_list.tensors();
+  if (!storage.IsInitialized() || tensors.empty() ||
+      storage.dim_size(0) != static_cast<int64>(tensors.size())) {
+    return false;
+  }
+  const size_t slice_bytes = storage.TotalBytes() / tensors.size();
+  const char* base = storage.tensor_data().data();
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const Tensor& t = tensors[i];
+    if (t.dtype() != storage.dtype() || t.TotalBytes() != slice_bytes ||
+        t.tensor_data().data() != base + i * slice_bytes) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies `value` into slice `index` of the storage of `list`, allocating the
+// storage on first use, and makes that slice element `index` of the list.
+// Sets `*written` to false and leaves `list` unchanged if the element cannot
+// be stored in place.
+static Status SetItemInStorage(OpKernelContext* c, int32 index,
+                               const Tensor& value, TensorList* list,
+                               bool* written) {
+  *written = false;
+  TensorShape element_shape;
+  if (!DataTypeCanUseMemcpy(value.dtype()) ||
+      !list->element_shape.AsTensorShape(&element_shape) ||
+      value.shape() != element_shape) {
+    return Status::OK();
+  }
+  // Elements must be aligned slices of the storage for kernels to read them.
+  const int64 element_bytes =
+      element_shape.num_elements() * DataTypeSize(value.dtype());
+  if (element_bytes == 0 || element_bytes % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return Status::OK();
+  }
+  Tensor& storage = list->storage();
+  if (!storage.IsInitialized()) {
+    if (list->storage_dropped()) return Status::OK();
+    const int64 num_elements = list->tensors().size();
+    if (num_elements < 2) return Status::OK();
+    TensorShape storage_shape = element_shape;
+    storage_shape.InsertDim(0, num_elements);
+    TF_RETURN_IF_ERROR(
+        c->allocate_temp(value.dtype(), storage_shape, &storage));
+    list->storage_written().assign(num_elements, false);
+  }
+  if (storage.dtype() != value.dtype() || index >= storage.dim_size(0) ||
+      list->storage_written()[index]) {
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(value, &storage, index));
+  list->storage_written()[index] = true;
+  list->tensors()[index] = storage.SubSlice(index);
+  *written = true;
+  return Status::OK();
+}
+
 class EmptyTensorList : public OpKernel {
  public:
   explicit EmptyTensorList(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -312,6 +374,7 @@ class TensorListPushBack : public OpKernel {
 
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
+    output_list->DropStorage();
     output_list->tensors().push_back(input);
   }
 
@@ -456,6 +519,7 @@ class TensorListResize : public OpKernel {
       TensorList* out = maybe_result->scalar<Variant>()().get<TensorList>();
       if (out->RefCountIsOne()) {
         // We are able to forward the input.
+        out->DropStorage();
         out->tensors().resize(size, Tensor(DT_INVALID));
         c->set_output(0, *maybe_result);
         return;
@@ -500,7 +564,8 @@ REGISTER_KERNEL_BUILDER(
 
 class TensorListSetItem : public OpKernel {
  public:
-  explicit TensorListSetItem(OpKernelConstruction* c) : OpKernel(c) {
+  explicit TensorListSetItem(OpKernelConstruction* c)
+      : OpKernel(c), set_item_in_storage_(c->device_type() == DEVICE_CPU) {
     OP_REQUIRES_OK(c, c->GetAttr("element_dtype", &element_dtype_));
   }
 
@@ -526,11 +591,25 @@ class TensorListSetItem : public OpKernel {
                     " list shape: ", l->element_shape.DebugString()));
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
+    // Only a forwarded list, which is not aliased by any other list, may write
+    // to its storage, so that the storage is allocated once per list rather
+    // than once per copy.
+    if (set_item_in_storage_ && output_list == l) {
+      bool written;
+      OP_REQUIRES_OK(
+          c, SetItemInStorage(c, index, value, output_list, &written));
+      if (written) return;
+    }
+    // The element is no longer a slice of the storage, e.g. because it is
+    // overwritten, so the storage can't be the stacked list any more.
+    output_list->DropStorage();
     output_list->tensors()[index] = value;
   }
 
  private:
   DataType element_dtype_;
+  // Whether elements are copied into contiguous storage for TensorListStack.
+  const bool set_item_in_storage_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TensorListSetItem").Device(DEVICE_CPU),
@@ -635,6 +714,7 @@ class TensorListConcatLists : public OpKernel {
                       l_b->element_shape.DebugString()));
       if (ok_to_alias) {
         TensorList* out = output_t(i).get<TensorList>();
+        out->DropStorage();
         std::copy(l_b->tensors().begin(), l_b->tensors().end(),
                   std::back_inserter(out->tensors()));
       } else {
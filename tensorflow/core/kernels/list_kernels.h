@@ -143,6 +143,29 @@ class TensorList {
   std::vector<Tensor>& tensors() { return tensors_->values_; }
   const std::vector<Tensor>& tensors() const { return tensors_->values_; }
 
+  // Contiguous storage for the elements of the list, as a tensor of shape
+  // [n] + element_shape, or an uninitialized tensor. Element i may be the i-th
+  // slice of the storage, in which case TensorListStack returns the storage
+  // instead of copying the elements into a new tensor.
+  //
+  // Tensors alias the slices of the storage, so each slice is written at most
+  // once, as recorded by `storage_written()`, and only by the list that
+  // allocated the storage: Copy() does not share it.
+  Tensor& storage() { return tensors_->storage_; }
+  const Tensor& storage() const { return tensors_->storage_; }
+  std::vector<bool>& storage_written() { return tensors_->storage_written_; }
+
+  // Releases the storage once the elements may stop being its slices, e.g.
+  // when an element is replaced or the list is resized, so that its buffer is
+  // freed as soon as no element refers to it. The list does not allocate
+  // storage again afterwards.
+  void DropStorage() {
+    tensors_->storage_ = Tensor();
+    tensors_->storage_written_.clear();
+    tensors_->storage_dropped_ = true;
+  }
+  bool storage_dropped() const { return tensors_->storage_dropped_; }
+
   // Get a new TensorList containing a copy of the underlying tensor container.
   TensorList Copy() const {
     TensorList out;
@@ -151,6 +174,10 @@ class TensorList {
     out.max_num_elements = max_num_elements;
     // This performs a copy of the std::vector.
     out.tensors_->values_ = tensors_->values_;
+    // The elements may be slices of the storage of this list, so the copy
+    // never allocates storage of its own.
+    out.tensors_->storage_dropped_ =
+        tensors_->storage_.IsInitialized() || tensors_->storage_dropped_;
     return out;
   }
 
@@ -162,6 +189,9 @@ class TensorList {
   class Tensors : public core::RefCounted {
    public:
     std::vector<Tensor> values_;
+    Tensor storage_;
+    std::vector<bool> storage_written_;
+    bool storage_dropped_ = false;
   };
   Tensors* tensors_;
 };
@@ -185,6 +215,10 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32 input_index,
                                    const TensorList& input_list,
                                    TensorList** output_list);
 
+// Returns true if every element of `tensor_list` is the corresponding slice of
+// its storage, so that the storage is the stacked list.
+bool ElementsAreStorageSlices(const TensorList& tensor_list);
+
 template <typename Device, typename T>
 class TensorListStack : public OpKernel {
  public:
@@ -243,6 +277,11 @@ class TensorListStack : public OpKernel {
                     partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
+    if (ElementsAreStorageSlices(*tensor_list) &&
+        tensor_list->storage().shape() == output_shape) {
+      c->set_output(0, tensor_list->storage());
+      return;
+    }
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
@@ -397,6 +436,7 @@ class TensorListPopBack : public OpKernel {
 
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
+    output_list->DropStorage();
     output_list->tensors().pop_back();
   }
 
@@ -803,6 +843,20 @@ class TensorListFromTensor : public OpKernel {
                     " from a tensor with shape ", output_shape.DebugString()));
     output_list.element_shape = element_shape;
     output_list.tensors().reserve(t.shape().dim_size(0));
+    // Make the elements slices of the input when they are aligned, so that
+    // neither this kernel nor TensorListStack copies them.
+    const int64 element_bytes =
+        output_shape.num_elements() * DataTypeSize(t.dtype());
+    if (DataTypeCanUseMemcpy(t.dtype()) && t.IsAligned() &&
+        element_bytes > 0 && element_bytes % EIGEN_MAX_ALIGN_BYTES == 0) {
+      output_list.storage() = t;
+      output_list.storage_written().assign(t.shape().dim_size(0), true);
+      for (int i = 0; i < t.shape().dim_size(0); ++i) {
+        output_list.tensors().push_back(t.SubSlice(i));
+      }
+      output_tensor->scalar<Variant>()() = std::move(output_list);
+      return;
+    }
     for (int i = 0; i < t.shape().dim_size(0); ++i) {
       Tensor tmp = t.Slice(i, i + 1);
       TensorShape tmp_shape = tmp.shape();
@@ -880,6 +934,7 @@ class TensorListScatterIntoExistingList : public OpKernel {
     // Resize the list if needed to accommodate all indices.
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
+    output_list->DropStorage();
     const auto indices_vec = indices.vec<int32>();
     int32 max_index =
         (indices.NumElements() == 0)
@@ -1124,6 +1179,7 @@ class TensorListPushBackBatch : public OpKernel {
       }
       TensorList* output = result_t(b).get<TensorList>();
       DCHECK(output != nullptr);
+      output->DropStorage();
       Tensor* frame;
       PersistentTensor tmp;
       OP_REQUIRES_OK(c, c->allocate_persistent(
@@ -0,0 +1,241 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/list_kernels.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Elements of 16 floats are 64 bytes, so they are aligned slices of the
+// storage.
+constexpr int kElementSize = 16;
+
+// Returns a [num_elements, kElementSize] tensor whose row i is filled with
+// `first + i`.
+Tensor MakeRows(int num_elements, float first) {
+  Tensor t(DT_FLOAT, TensorShape({num_elements, kElementSize}));
+  for (int i = 0; i < num_elements; ++i) {
+    for (int j = 0; j < kElementSize; ++j) {
+      t.matrix<float>()(i, j) = first + i;
+    }
+  }
+  return t;
+}
+
+Tensor MakeElement(float value) {
+  Tensor t(DT_FLOAT, TensorShape({kElementSize}));
+  test::FillFn<float>(&t, [value](int) { return value; });
+  return t;
+}
+
+const TensorList& GetList(const Tensor& t) {
+  return *t.scalar<Variant>()().get<TensorList>();
+}
+
+class TensorListKernelsTest : public OpsTestBase {
+ protected:
+  // Returns a list handle of `num_elements` unset elements, like
+  // TensorListReserve.
+  Tensor MakeReservedList(int num_elements) {
+    TensorList list;
+    list.element_dtype = DT_FLOAT;
+    list.element_shape = PartialTensorShape({kElementSize});
+    list.tensors().resize(num_elements, Tensor(DT_INVALID));
+    Tensor t(DT_VARIANT, TensorShape({}));
+    t.scalar<Variant>()() = std::move(list);
+    return t;
+  }
+
+  // Runs the kernel built into node_def() on `inputs`, which must outlive the
+  // next call.
+  Status Run(const std::vector<Tensor*>& inputs) {
+    TF_RETURN_IF_ERROR(InitOp());
+    inputs_.clear();
+    for (Tensor* input : inputs) {
+      inputs_.push_back(TensorValue(input));
+    }
+    return RunOpKernel();
+  }
+
+  // Runs TensorListSetItem on `*list` and replaces it with the output. The
+  // list is updated in place unless another tensor shares its buffer.
+  Status SetItem(Tensor* list, int32 index, const Tensor& item) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("set_item", "TensorListSetItem")
+                           .Input(FakeInput(DT_VARIANT))
+                           .Input(FakeInput(DT_INT32))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Attr("element_dtype", DT_FLOAT)
+                           .Finalize(node_def()));
+    Tensor index_tensor = test::AsScalar<int32>(index);
+    Tensor item_tensor = item;
+    TF_RETURN_IF_ERROR(Run({list, &index_tensor, &item_tensor}));
+    *list = *GetOutput(0);
+    return Status::OK();
+  }
+
+  Status Resize(Tensor* list, int32 size) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("resize", "TensorListResize")
+                           .Input(FakeInput(DT_VARIANT))
+                           .Input(FakeInput(DT_INT32))
+                           .Finalize(node_def()));
+    Tensor size_tensor = test::AsScalar<int32>(size);
+    TF_RETURN_IF_ERROR(Run({list, &size_tensor}));
+    *list = *GetOutput(0);
+    return Status::OK();
+  }
+
+  Status FromTensor(const Tensor& tensor, Tensor* list) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("from_tensor", "TensorListFromTensor")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_INT32))
+                           .Attr("element_dtype", DT_FLOAT)
+                           .Attr("shape_type", DT_INT32)
+                           .Finalize(node_def()));
+    Tensor tensor_copy = tensor;
+    Tensor element_shape = test::AsTensor<int32>({kElementSize});
+    TF_RETURN_IF_ERROR(Run({&tensor_copy, &element_shape}));
+    *list = *GetOutput(0);
+    return Status::OK();
+  }
+
+  Status Stack(Tensor* list, Tensor* output) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("stack", "TensorListStack")
+                           .Input(FakeInput(DT_VARIANT))
+                           .Input(FakeInput(DT_INT32))
+                           .Attr("element_dtype", DT_FLOAT)
+                           .Finalize(node_def()));
+    Tensor element_shape = test::AsTensor<int32>({kElementSize});
+    TF_RETURN_IF_ERROR(Run({list, &element_shape}));
+    *output = *GetOutput(0);
+    return Status::OK();
+  }
+};
+
+TEST_F(TensorListKernelsTest, SetItemWritesToStorage) {
+  Tensor list = MakeReservedList(3);
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(SetItem(&list, i, MakeElement(i)));
+  }
+  EXPECT_TRUE(ElementsAreStorageSlices(GetList(list)));
+
+  Tensor stacked;
+  TF_ASSERT_OK(Stack(&list, &stacked));
+  EXPECT_TRUE(stacked.SharesBufferWith(GetList(list).storage()));
+  test::ExpectTensorEqual<float>(stacked, MakeRows(3, 0));
+}
+
+TEST_F(TensorListKernelsTest, SetItemOverwriteAfterStack) {
+  Tensor list = MakeReservedList(3);
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(SetItem(&list, i, MakeElement(i)));
+  }
+  Tensor stacked;
+  TF_ASSERT_OK(Stack(&list, &stacked));
+
+  // The stacked tensor aliases the storage, so the new value must not be
+  // written to it, and the storage no longer backs the list.
+  TF_ASSERT_OK(SetItem(&list, 1, MakeElement(7)));
+  test::ExpectTensorEqual<float>(stacked, MakeRows(3, 0));
+  EXPECT_FALSE(GetList(list).storage().IsInitialized());
+  EXPECT_TRUE(GetList(list).storage_dropped());
+
+  Tensor restacked;
+  TF_ASSERT_OK(Stack(&list, &restacked));
+  EXPECT_FALSE(restacked.SharesBufferWith(stacked));
+  Tensor expected = MakeRows(3, 0);
+  for (int j = 0; j < kElementSize; ++j) {
+    expected.matrix<float>()(1, j) = 7;
+  }
+  test::ExpectTensorEqual<float>(restacked, expected);
+}
+
+TEST_F(TensorListKernelsTest, ResizeDropsStorage) {
+  Tensor list = MakeReservedList(3);
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(SetItem(&list, i, MakeElement(i)));
+  }
+  TF_ASSERT_OK(Resize(&list, 2));
+  EXPECT_FALSE(GetList(list).storage().IsInitialized());
+  EXPECT_TRUE(GetList(list).storage_dropped());
+
+  Tensor stacked;
+  TF_ASSERT_OK(Stack(&list, &stacked));
+  test::ExpectTensorEqual<float>(stacked, MakeRows(2, 0));
+
+  // Growing the list again does not allocate new storage.
+  TF_ASSERT_OK(Resize(&list, 3));
+  TF_ASSERT_OK(SetItem(&list, 2, MakeElement(2)));
+  EXPECT_FALSE(GetList(list).storage().IsInitialized());
+  TF_ASSERT_OK(Stack(&list, &stacked));
+  test::ExpectTensorEqual<float>(stacked, MakeRows(3, 0));
+}
+
+TEST_F(TensorListKernelsTest, SetItemCopiesSharedList) {
+  Tensor list = MakeReservedList(2);
+  TF_ASSERT_OK(SetItem(&list, 0, MakeElement(0)));
+  TF_ASSERT_OK(SetItem(&list, 1, MakeElement(1)));
+
+  // `shared` keeps the list from being forwarded, so SetItem updates a copy.
+  Tensor shared = list;
+  TF_ASSERT_OK(SetItem(&list, 0, MakeElement(5)));
+  EXPECT_FALSE(list.SharesBufferWith(shared));
+
+  // The original list is unchanged and still backed by its storage.
+  EXPECT_TRUE(ElementsAreStorageSlices(GetList(shared)));
+  Tensor stacked;
+  TF_ASSERT_OK(Stack(&shared, &stacked));
+  test::ExpectTensorEqual<float>(stacked, MakeRows(2, 0));
+
+  // The copy never writes to the storage it shares elements with.
+  EXPECT_FALSE(GetList(list).storage().IsInitialized());
+  EXPECT_TRUE(GetList(list).storage_dropped());
+  TF_ASSERT_OK(SetItem(&list, 1, MakeElement(6)));
+  EXPECT_FALSE(GetList(list).storage().IsInitialized());
+  Tensor copy_stacked;
+  TF_ASSERT_OK(Stack(&list, &copy_stacked));
+  test::ExpectTensorEqual<float>(copy_stacked, MakeRows(2, 5));
+  test::ExpectTensorEqual<float>(stacked, MakeRows(2, 0));
+}
+
+TEST_F(TensorListKernelsTest, FromTensorThenStackAliasesInput) {
+  Tensor input = MakeRows(4, 0);
+  Tensor list;
+  TF_ASSERT_OK(FromTensor(input, &list));
+  EXPECT_TRUE(GetList(list).storage().SharesBufferWith(input));
+  EXPECT_TRUE(ElementsAreStorageSlices(GetList(list)));
+
+  Tensor stacked;
+  TF_ASSERT_OK(Stack(&list, &stacked));
+  EXPECT_TRUE(stacked.SharesBufferWith(input));
+  test::ExpectTensorEqual<float>(stacked, input);
+
+  // Overwriting an element of the list leaves the input alone.
+  TF_ASSERT_OK(SetItem(&list, 0, MakeElement(9)));
+  test::ExpectTensorEqual<float>(input, MakeRows(4, 0));
+  EXPECT_FALSE(GetList(list).storage().IsInitialized());
+}
+
+}  // namespace
+}  // namespace tensorflow
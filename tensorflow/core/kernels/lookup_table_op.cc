@@ -16,14 +16,18 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/striped_flat_hash_map.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 
@@ -776,6 +780,93 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 deleted_key_hash_;
 };
 
+// Lookup table from integer keys to scalar values, for large id maps that
+// are read and updated by many concurrent steps. The entries are split over
+// `num_shards` open addressing tables, each with its own reader-writer lock,
+// so lookups of a batch of keys only contend with writers of the same shards
+// rather than with every other table access. See StripedFlatHashMap.
+template <class K, class V>
+class MutableFlatHashTable final : public LookupInterface {
+ public:
+  MutableFlatHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    int64 num_shards;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "num_shards", &num_shards));
+    OP_REQUIRES(
+        ctx, num_shards > 0,
+        errors::InvalidArgument("num_shards must be positive, got: ",
+                                num_shards));
+    table_.reset(new StripedFlatHashMap<K, V>(
+        static_cast<int>(std::min<int64>(num_shards, 1 << 16))));
+  }
+
+  size_t size() const override { return table_->size(); }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat<V>();
+    table_->Find(key_values.data(), key_values.size(),
+                 default_value.flat<V>()(0), value_values.data());
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    table_->Insert(key_values.data(), values.flat<V>().data(),
+                   key_values.size());
+    return Status::OK();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+    table_->Erase(key_values.data(), key_values.size());
+    return Status::OK();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    table_->Assign(key_values.data(), values.flat<V>().data(),
+                   key_values.size());
+    return Status::OK();
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    std::vector<K> exported_keys;
+    std::vector<V> exported_values;
+    table_->Export(&exported_keys, &exported_values);
+    const int64 size = exported_keys.size();
+
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+    std::copy(exported_keys.begin(), exported_keys.end(),
+              keys->flat<K>().data());
+    std::copy(exported_values.begin(), exported_values.end(),
+              values->flat<V>().data());
+    return Status::OK();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+  int64 MemoryUsed() const override {
+    return sizeof(MutableFlatHashTable) + table_->MemoryUsed();
+  }
+
+ private:
+  std::unique_ptr<StripedFlatHashMap<K, V>> table_;
+};
+
 }  // namespace lookup
 
 // Table lookup op. Perform the lookup operation on the given table.
@@ -1098,4 +1189,25 @@ REGISTER_KERNEL(tstring, int64);
 
 #undef REGISTER_KERNEL
 
+// Register the MutableFlatHashTable op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                           \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("MutableFlatHashTable")                                        \
+          .Device(DEVICE_CPU)                                             \
+          .TypeConstraint<key_dtype>("key_dtype")                         \
+          .TypeConstraint<value_dtype>("value_dtype"),                    \
+      LookupTableOp<lookup::MutableFlatHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int32, int64);
+REGISTER_KERNEL(int64, double);
+REGISTER_KERNEL(int64, float);
+REGISTER_KERNEL(int64, int32);
+REGISTER_KERNEL(int64, int64);
+
+#undef REGISTER_KERNEL
+
 }  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/bfloat16_conversion.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #if GOOGLE_CUDA
@@ -504,17 +505,14 @@ class MatMulOp : public OpKernel {
       OP_REQUIRES_OK(ctx,
                      ctx->allocate_temp(DT_FLOAT, out->shape(), &out_float));
 
-      // TODO: Avoid extra copy to make bfloat16 matmul efficient on CPU.
-      BFloat16ToFloat(a.flat<bfloat16>().data(), a_float.flat<float>().data(),
-                      a.NumElements());
-      BFloat16ToFloat(b.flat<bfloat16>().data(), b_float.flat<float>().data(),
-                      b.NumElements());
-
+      // There is no bfloat16 GEMM, so this computes in float. The conversions
+      // are sharded, or they would dominate for large matrices.
+      ParallelBFloat16ToFloat(ctx, a, &a_float);
+      ParallelBFloat16ToFloat(ctx, b, &b_float);
       LaunchMatMul<Device, float, USE_CUBLAS>::launch(
           ctx, a_float, b_float, dim_pair, &algorithms_, use_autotune_,
           &out_float);
-      FloatToBFloat16(out_float.flat<float>().data(),
-                      out->flat<bfloat16>().data(), out->NumElements());
+      ParallelFloatToBFloat16(ctx, out_float, out);
     } else {
       LaunchMatMul<Device, T, USE_CUBLAS>::launch(
           ctx, a, b, dim_pair, &algorithms_, use_autotune_, out);
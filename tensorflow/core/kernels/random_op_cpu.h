@@ -21,6 +21,7 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -73,6 +74,85 @@ struct FillPhiloxRandom {
   }
 };
 
+// Converts the Philox samples to the outputs of a distribution that takes
+// one sample per output, for many groups at once rather than one group per
+// call to the distribution. The conversions are the same as the ones of the
+// distribution, so the outputs are too. Only the distributions with a
+// specialization are converted this way.
+template <class Distribution>
+struct BatchedSampleConverter {
+  static const bool kEnabled = false;
+};
+
+template <typename T>
+struct BatchedUniformSampleConverter {
+  static const bool kEnabled = true;
+  static void Convert(const uint32* samples, int64 size, T* data);
+};
+
+template <>
+inline void BatchedUniformSampleConverter<float>::Convert(
+    const uint32* samples, int64 size, float* data) {
+  for (int64 i = 0; i < size; ++i) {
+    data[i] = random::Uint32ToFloat(samples[i]);
+  }
+}
+
+template <>
+inline void BatchedUniformSampleConverter<Eigen::half>::Convert(
+    const uint32* samples, int64 size, Eigen::half* data) {
+  for (int64 i = 0; i < size; ++i) {
+    data[i] = random::Uint16ToHalf(samples[i]);
+  }
+}
+
+template <>
+inline void BatchedUniformSampleConverter<bfloat16>::Convert(
+    const uint32* samples, int64 size, bfloat16* data) {
+  for (int64 i = 0; i < size; ++i) {
+    data[i] = random::Uint16ToGfloat16(samples[i]);
+  }
+}
+
+template <>
+struct BatchedSampleConverter<random::UniformDistribution<PhiloxRandom, float>>
+    : BatchedUniformSampleConverter<float> {};
+template <>
+struct BatchedSampleConverter<
+    random::UniformDistribution<PhiloxRandom, Eigen::half>>
+    : BatchedUniformSampleConverter<Eigen::half> {};
+template <>
+struct BatchedSampleConverter<
+    random::UniformDistribution<PhiloxRandom, bfloat16>>
+    : BatchedUniformSampleConverter<bfloat16> {};
+
+template <typename T>
+struct BatchedNormalSampleConverter {
+  static const bool kEnabled = true;
+  // The Box-Muller transform makes the outputs by pairs, so an odd `size`
+  // computes one more output than it writes.
+  static void Convert(const uint32* samples, int64 size, T* data) {
+    for (int64 i = 0; i < size; i += 2) {
+      float f[2];
+      random::BoxMullerFloat(samples[i], samples[i + 1], &f[0], &f[1]);
+      data[i] = T(f[0]);
+      if (i + 1 < size) data[i + 1] = T(f[1]);
+    }
+  }
+};
+
+template <>
+struct BatchedSampleConverter<random::NormalDistribution<PhiloxRandom, float>>
+    : BatchedNormalSampleConverter<float> {};
+template <>
+struct BatchedSampleConverter<
+    random::NormalDistribution<PhiloxRandom, Eigen::half>>
+    : BatchedNormalSampleConverter<Eigen::half> {};
+template <>
+struct BatchedSampleConverter<
+    random::NormalDistribution<PhiloxRandom, bfloat16>>
+    : BatchedNormalSampleConverter<bfloat16> {};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -82,11 +162,43 @@ struct FillPhiloxRandomTask;
 template <class Distribution>
 struct FillPhiloxRandomTask<Distribution, false> {
   typedef typename Distribution::ResultElementType T;
+  typedef BatchedSampleConverter<Distribution> Converter;
+
   static void Run(random::PhiloxRandom gen, T* data, int64 size,
                   int64 start_group, int64 limit_group, Distribution dist) {
+    gen.Skip(start_group);
+    Run(gen, data, size, start_group, limit_group, dist,
+        std::integral_constant<bool, Converter::kEnabled>());
+  }
+
+  // Generates the samples of PhiloxRandom::kBatchSize groups at once with
+  // PhiloxRandom::GenerateBatch, and converts them together. The samples
+  // generated past `limit_group` are dropped.
+  static void Run(random::PhiloxRandom gen, T* data, int64 size,
+                  int64 start_group, int64 limit_group, Distribution dist,
+                  std::true_type batched) {
+    static_assert(Distribution::kResultElementCount ==
+                      PhiloxRandom::kResultElementCount,
+                  "The batched distributions take one sample per output");
+    const int kGroupSize = Distribution::kResultElementCount;
+    const int64 limit = std::min(limit_group * kGroupSize, size);
+    uint32 samples[PhiloxRandom::kBatchSize * kGroupSize];
+    for (int64 offset = start_group * kGroupSize; offset < limit;
+         offset += PhiloxRandom::kBatchSize * kGroupSize) {
+      gen.GenerateBatch(samples);
+      Converter::Convert(
+          samples,
+          std::min<int64>(PhiloxRandom::kBatchSize * kGroupSize,
+                          limit - offset),
+          data + offset);
+    }
+  }
+
+  static void Run(random::PhiloxRandom gen, T* data, int64 size,
+                  int64 start_group, int64 limit_group, Distribution dist,
+                  std::false_type batched) {
     const int kGroupSize = Distribution::kResultElementCount;
 
-    gen.Skip(start_group);
     int64 offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
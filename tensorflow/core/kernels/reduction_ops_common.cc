@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/reduction_ops_common.h"
 
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -152,4 +153,18 @@ Status ReductionHelper::Simplify(const Tensor& data, const Tensor& axis,
   return Status::OK();
 }
 
+namespace functor {
+
+bool RequireDeterministicReductions() {
+  static bool require_determinism = [] {
+    bool deterministic_ops = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_DETERMINISTIC_OPS",
+                                   /*default_val=*/false, &deterministic_ops));
+    return deterministic_ops;
+  }();
+  return require_determinism;
+}
+
+}  // namespace functor
+
 }  // namespace tensorflow
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -266,9 +267,90 @@ struct ReduceFunctorBase {
   }
 };
 
+// Returns true if the CPU reductions to a scalar below must not depend on the
+// number of threads, which is requested by setting the TF_DETERMINISTIC_OPS
+// environment variable.
+bool RequireDeterministicReductions();
+
+// Sums `size` elements of `data` in blocks of a fixed size, which are summed
+// in parallel and then combined pairwise.  Unlike Eigen, which splits full
+// reductions into one block per thread, the order of the additions only
+// depends on `size`.
+template <typename T>
+T DeterministicSum(OpKernelContext* ctx, const T* data, int64 size) {
+  const int64 block_size = 4096;
+  const int64 num_blocks = (size + block_size - 1) / block_size;
+  if (num_blocks == 0) return T(0);
+  std::vector<T> sums(num_blocks);
+  auto sum_blocks = [data, size, block_size, &sums](int64 begin, int64 end) {
+    for (int64 b = begin; b < end; ++b) {
+      const int64 offset = b * block_size;
+      sums[b] = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(
+                    data + offset, std::min(block_size, size - offset))
+                    .sum();
+    }
+  };
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+        block_size, sum_blocks);
+  for (int64 stride = 1; stride < num_blocks; stride *= 2) {
+    for (int64 b = 0; b + stride < num_blocks; b += 2 * stride) {
+      sums[b] += sums[b + stride];
+    }
+  }
+  return sums[0];
+}
+
+// Reduces `in` to the scalar `*out` with DeterministicSum, if Reducer is
+// supported.  Returns false otherwise.
+template <typename Reducer>
+struct DeterministicScalarReduce {
+  template <typename IN_T>
+  static bool Run(OpKernelContext* ctx, IN_T in,
+                  typename IN_T::Scalar* out) {
+    return false;
+  }
+};
+
+#define DETERMINISTIC_SCALAR_REDUCE(T)                                    \
+  template <>                                                             \
+  struct DeterministicScalarReduce<Eigen::internal::SumReducer<T>> {      \
+    template <typename IN_T>                                              \
+    static bool Run(OpKernelContext* ctx, IN_T in, T* out) {              \
+      *out = DeterministicSum<T>(ctx, in.data(), in.size());              \
+      return true;                                                        \
+    }                                                                     \
+  };                                                                      \
+  template <>                                                             \
+  struct DeterministicScalarReduce<MeanReducer<T>> {                      \
+    template <typename IN_T>                                              \
+    static bool Run(OpKernelContext* ctx, IN_T in, T* out) {              \
+      *out = DeterministicSum<T>(ctx, in.data(), in.size()) /             \
+             static_cast<T>(in.size());                                   \
+      return true;                                                        \
+    }                                                                     \
+  };
+// Integer sums are associative, so they are deterministic anyway.
+DETERMINISTIC_SCALAR_REDUCE(float)
+DETERMINISTIC_SCALAR_REDUCE(double)
+#undef DETERMINISTIC_SCALAR_REDUCE
+
 template <typename Reducer>
 struct ReduceFunctor<CPUDevice, Reducer>
-    : ReduceFunctorBase<CPUDevice, Reducer> {};
+    : ReduceFunctorBase<CPUDevice, Reducer> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static void Reduce(OpKernelContext* ctx, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes,
+                     const Reducer& reducer) {
+    if (OUT_T::NumDimensions == 0 && IN_T::NumDimensions == 1 &&
+        RequireDeterministicReductions() &&
+        DeterministicScalarReduce<Reducer>::Run(ctx, in, out.data())) {
+      return;
+    }
+    ReduceFunctorBase<CPUDevice, Reducer>::Reduce(ctx, out, in, reduction_axes,
+                                                  reducer);
+  }
+};
 #if TENSORFLOW_USE_SYCL
 template <typename Reducer>
 struct ReduceFunctor<SYCLDevice, Reducer>
@@ -13,14 +13,90 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class DeterministicReductionTest : public OpsTestBase {
+ protected:
+  DeterministicReductionTest() {
+    // Read once by the first reduction, and no other test in this file runs
+    // one.
+    setenv("TF_DETERMINISTIC_OPS", "1", /*overwrite=*/1);
+  }
+
+  void SetUp() override {
+    default_worker_threads_ = *device_->tensorflow_cpu_worker_threads();
+  }
+
+  // Reduces all the elements of the vector `data` with `op` on an intra-op
+  // thread pool of `num_threads` threads.
+  Tensor ReduceToScalar(const string& op, const Tensor& data,
+                        int num_threads) {
+    thread::ThreadPool pool(Env::Default(), "deterministic_reduction",
+                            num_threads);
+    DeviceBase::CpuWorkerThreads worker_threads;
+    worker_threads.num_threads = num_threads;
+    worker_threads.workers = &pool;
+    device_->set_tensorflow_cpu_worker_threads(&worker_threads);
+
+    TF_CHECK_OK(NodeDefBuilder("reduce", op)
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_INT32))
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    Tensor input = data;
+    Tensor axes = test::AsTensor<int32>({0});
+    inputs_.clear();
+    inputs_.push_back(TensorValue(&input));
+    inputs_.push_back(TensorValue(&axes));
+    TF_CHECK_OK(RunOpKernel());
+    Tensor result = *GetOutput(0);
+    // Restores the default worker threads before `pool` is destroyed.
+    device_->set_tensorflow_cpu_worker_threads(&default_worker_threads_);
+    return result;
+  }
+
+ private:
+  DeviceBase::CpuWorkerThreads default_worker_threads_;
+};
+
+TEST_F(DeterministicReductionTest, SumAndMeanIndependentOfThreadCount) {
+  // Not a multiple of the block size of DeterministicSum, and with values of
+  // very different magnitudes, so that the result depends on the order of
+  // the additions.
+  Tensor data(DT_FLOAT, TensorShape({(1 << 20) + 123}));
+  data.flat<float>().setRandom();
+  for (int64 i = 0; i < data.NumElements(); i += 97) {
+    data.flat<float>()(i) *= 1e6f;
+  }
+
+  for (const string op : {"Sum", "Mean"}) {
+    const Tensor expected = ReduceToScalar(op, data, /*num_threads=*/1);
+    for (int num_threads : {2, 3, 8}) {
+      SCOPED_TRACE(strings::StrCat(op, " with ", num_threads, " threads"));
+      const Tensor actual = ReduceToScalar(op, data, num_threads);
+      // Bitwise equality, not within a tolerance.
+      EXPECT_EQ(memcmp(expected.tensor_data().data(),
+                       actual.tensor_data().data(), sizeof(float)),
+                0)
+          << expected.scalar<float>()() << " vs " << actual.scalar<float>()();
+    }
+  }
+}
+
 // Creates a Graph which "reduce"s a 3D float tensor of "num" elements
 // into a scalar.
 template <typename T>
@@ -21,8 +21,30 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
+namespace {
+
+// Rough cost of matching one string. RE2 objects are thread safe, so the
+// strings are matched on the intra-op threads.
+constexpr int64 kRegexMatchCostPerUnit = 2000;
+
+void FullMatchStrings(OpKernelContext* ctx, const RE2& match,
+                      const Tensor& input_tensor, Tensor* output_tensor) {
+  const auto& input_flat = input_tensor.flat<tstring>();
+  auto output_flat = output_tensor->flat<bool>();
+  auto full_match = [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      output_flat(i) = RE2::FullMatch(input_flat(i), match);
+    }
+  };
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        input_flat.size(), kRegexMatchCostPerUnit, full_match);
+}
+
+}  // namespace
 
 class RegexFullMatchOp : public OpKernel {
  public:
@@ -31,7 +53,6 @@ class RegexFullMatchOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
-    const auto& input_flat = input_tensor->flat<tstring>();
 
     const Tensor* pattern_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("pattern", &pattern_tensor));
@@ -47,10 +68,7 @@ class RegexFullMatchOp : public OpKernel {
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), match);
-    }
+    FullMatchStrings(ctx, match, *input_tensor, output_tensor);
   }
 };
 
@@ -71,15 +89,11 @@ class StaticRegexFullMatchOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
-    const auto& input_flat = input_tensor->flat<tstring>();
 
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *re_);
-    }
+    FullMatchStrings(ctx, *re_, *input_tensor, output_tensor);
   }
 
  private:
@@ -21,10 +21,14 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
 
+// Rough cost of rewriting one string.
+constexpr int64 kRegexReplaceCostPerUnit = 2000;
+
 // Execute the specified regex using the given context.
 // Context requirements:
 //  - "input" string Tensor at input_index=0
@@ -47,13 +51,20 @@ Status InternalCompute(const RE2& match, const string& rewrite,
     output_tensor->flat<tstring>() = input_tensor->flat<tstring>();
   }
   auto output_flat = output_tensor->flat<tstring>();
-  for (size_t i = 0; i < output_flat.size(); ++i) {
-    if (replace_global) {
-      RE2::GlobalReplace(&output_flat(i), match, rewrite);
-    } else {
-      RE2::Replace(&output_flat(i), match, rewrite);
+  // RE2 objects are thread safe, so the strings are rewritten in place on
+  // the intra-op threads.
+  auto replace = [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      if (replace_global) {
+        RE2::GlobalReplace(&output_flat(i), match, rewrite);
+      } else {
+        RE2::Replace(&output_flat(i), match, rewrite);
+      }
     }
-  }
+  };
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        output_flat.size(), kRegexReplaceCostPerUnit, replace);
   return Status::OK();
 }
 }  // namespace
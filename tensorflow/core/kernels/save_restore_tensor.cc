@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -244,6 +245,10 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64 kLargeShapeThreshold = 16 << 20;  // 16M
 
+// The smaller tensors are restored in groups of contiguous keys of at least
+// this many bytes.
+const int64 kMinRestoreGroupBytes = 64 << 20;  // 64MB
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -281,7 +286,12 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && read_only) {
+      // Lookup the full tensor, aliasing the checkpoint if possible.
+      Tensor restored;
+      TF_RETURN_IF_ERROR(reader->LookupReadOnly(tensor_name, &restored));
+      context->set_output(idx, restored);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -316,16 +326,42 @@ struct RestoreOp {
   string tensor_name;
   string shape_and_slice;
   string reader_prefix;
+  bool read_only;
 
   ::tensorflow::Status status;
 };
 
+// Reads the compression of the checkpoint tensors from
+// TF_CHECKPOINT_COMPRESSION ("NONE" by default, or "SNAPPY").  The compressed
+// checkpoints can't be read by older binaries.
+Status GetCheckpointCompression(BundleEntryProto::Compression* compression) {
+  string name;
+  TF_RETURN_IF_ERROR(
+      ReadStringFromEnvVar("TF_CHECKPOINT_COMPRESSION", "NONE", &name));
+  if (!BundleEntryProto::Compression_Parse(str_util::Uppercase(name),
+                                           compression)) {
+    return errors::InvalidArgument(
+        "Invalid TF_CHECKPOINT_COMPRESSION: ", name,
+        ", expected NONE or SNAPPY");
+  }
+  return Status::OK();
+}
+
+// Runs the restore operations "ops" in order, using a new BundleReader.
+void RunRestoreGroup(const string& reader_prefix,
+                     const std::vector<RestoreOp*>& ops) {
+  BundleReader reader(Env::Default(), reader_prefix);
+  for (RestoreOp* op : ops) {
+    op->status = reader.status().ok() ? op->run(&reader) : reader.status();
+  }
+}
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes) {
+                        gtl::ArraySlice<DataType> dtypes, bool read_only) {
   const string& prefix_string = prefix.scalar<tstring>()();
 
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
@@ -346,12 +382,15 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   TF_RETURN_IF_ERROR(default_reader.status());
 
   std::vector<string> mismatched_errors;
+  std::vector<int64> tensor_bytes(tensor_names_flat.size());
   for (const size_t i : sorted_name_idx) {
     TensorShape restored_full_shape;
     DataType original_dtype;
     const string& tensor_name = tensor_names_flat(i);
     TF_RETURN_IF_ERROR(default_reader.LookupDtypeAndShape(
         tensor_name, &original_dtype, &restored_full_shape));
+    tensor_bytes[i] =
+        DataTypeSize(original_dtype) * restored_full_shape.num_elements();
     if (dtypes[i] != original_dtype) {
       string error_msg = strings::StrCat(
           "tensor_name = ", tensor_name, "; expected dtype ",
@@ -368,8 +407,8 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
-    auto op =
-        new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
+    auto op = new RestoreOp{context, i, tensor_name, shape_and_slice,
+                            prefix_string, read_only};
     if (op->should_run_in_pool(&default_reader)) {
       pool_restore_ops.emplace_back(op);
     } else {
@@ -377,20 +416,39 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     }
   }
 
+  // Splits the small tensors into groups of contiguous keys, so that the reads
+  // of each group stay sequential while the groups are read concurrently.
+  std::vector<std::vector<RestoreOp*>> direct_groups(1);
+  int64 group_bytes = 0;
+  for (auto& op : direct_restore_ops) {
+    if (group_bytes >= kMinRestoreGroupBytes) {
+      direct_groups.emplace_back();
+      group_bytes = 0;
+    }
+    direct_groups.back().push_back(op.get());
+    group_bytes += tensor_bytes[op->idx];
+  }
+
   {
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
+    if (!pool_restore_ops.empty() || direct_groups.size() > 1) {
       reader_pool.reset(
           new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
       for (auto& op : pool_restore_ops) {
         reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
       }
+      for (size_t g = 1; g < direct_groups.size(); ++g) {
+        const std::vector<RestoreOp*>& group = direct_groups[g];
+        reader_pool->Schedule([&prefix_string, &group]() {
+          RunRestoreGroup(prefix_string, group);
+        });
+      }
     }
 
-    // Read small tensors from the op thread
-    for (auto& op : direct_restore_ops) {
+    // Read the first group of small tensors from the op thread
+    for (RestoreOp* op : direct_groups[0]) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
     }
   }
@@ -399,6 +457,11 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto& op : pool_restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
+  for (size_t g = 1; g < direct_groups.size(); ++g) {
+    for (RestoreOp* op : direct_groups[g]) {
+      TF_RETURN_IF_ERROR(op->status);
+    }
+  }
 
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
@@ -413,4 +476,79 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   return Status::OK();
 }
 
+Status SaveTensorsV2(const string& prefix, const Tensor& tensor_names,
+                     const Tensor& shape_and_slices,
+                     gtl::ArraySlice<Tensor> tensors) {
+  const auto& tensor_names_flat = tensor_names.flat<tstring>();
+  const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
+
+  BundleWriter::Options options;
+  TF_RETURN_IF_ERROR(GetCheckpointCompression(&options.compression));
+  BundleWriter writer(Env::Default(), prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const string& tensor_name = tensor_names_flat(i);
+    const Tensor& tensor = tensors[i];
+
+    if (!shape_and_slices_flat(i).empty()) {
+      const string& shape_spec = shape_and_slices_flat(i);
+      TensorShape shape;
+      TensorSlice slice(tensor.dims());
+      TensorShape slice_shape;
+
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(tensor.shape())) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice specification does not match the shape "
+            "of the tensor to  save: ",
+            shape_spec, ", tensor: ", tensor.shape().DebugString());
+      }
+
+      TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
+    }
+  }
+  return writer.Finish();
+}
+
+AsyncSaver::AsyncSaver()
+    : thread_(new thread::ThreadPool(Env::Default(), "async_saver", 1)) {}
+
+AsyncSaver::~AsyncSaver() {
+  // Joins the thread after the pending saves.
+  thread_.reset();
+}
+
+void AsyncSaver::Schedule(std::function<Status()> save) {
+  {
+    mutex_lock l(mu_);
+    ++num_pending_;
+  }
+  thread_->Schedule([this, save]() {
+    Status s = save();
+    if (!s.ok()) {
+      LOG(WARNING) << "Asynchronous checkpoint save failed: " << s;
+    }
+    mutex_lock l(mu_);
+    status_.Update(s);
+    if (--num_pending_ == 0) {
+      cv_.notify_all();
+    }
+  });
+}
+
+Status AsyncSaver::Wait() {
+  mutex_lock l(mu_);
+  while (num_pending_ > 0) {
+    cv_.wait(l);
+  }
+  Status s = status_;
+  status_ = Status::OK();
+  return s;
+}
+
 }  // namespace tensorflow
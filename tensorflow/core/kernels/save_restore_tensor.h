@@ -16,6 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 #define TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
 
+#include <functional>
+#include <memory>
+
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_writer.h"
 
@@ -63,10 +69,50 @@ void RestoreTensor(OpKernelContext* context,
 //   * "prefix" has 1 element, DT_STRING.
 //   * "tensor_names" and "shape_and_slices" shaped {N}, both DT_STRING.
 //   * "dtypes" has N elements, the datatypes of the to-restore tensors.
+//
+// If "read_only" is true, the full tensors are outputs aliasing the
+// memory-mapped checkpoint when possible (see BundleReader::LookupReadOnly()).
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes);
+                        gtl::ArraySlice<DataType> dtypes,
+                        bool read_only = false);
+
+// Writes "tensors" to the V2 checkpoint at "prefix", as named by
+// "tensor_names" and sliced by "shape_and_slices".
+// REQUIRES:
+//   * "tensor_names" and "shape_and_slices" shaped {N}, both DT_STRING.
+//   * "tensors" has N elements.
+Status SaveTensorsV2(const string& prefix, const Tensor& tensor_names,
+                     const Tensor& shape_and_slices,
+                     gtl::ArraySlice<Tensor> tensors);
+
+// Writes the checkpoints of the AsyncSaveV2 op on a background thread, one at
+// a time in the order they are scheduled.  AsyncSaverWait reports their
+// completion.
+class AsyncSaver : public ResourceBase {
+ public:
+  AsyncSaver();
+  // Waits for the scheduled saves to finish.
+  ~AsyncSaver() override;
+
+  // Runs "save" on the background thread.
+  void Schedule(std::function<Status()> save);
+
+  // Waits for the scheduled saves to finish, and returns the first error of
+  // the saves that finished since the last call.
+  Status Wait();
+
+  string DebugString() const override { return "AsyncSaver"; }
+
+ private:
+  mutex mu_;
+  condition_variable cv_;
+  int64 num_pending_ GUARDED_BY(mu_) = 0;
+  Status status_ GUARDED_BY(mu_);
+  // Runs the saves.
+  std::unique_ptr<thread::ThreadPool> thread_;
+};
 
 }  // namespace tensorflow
 
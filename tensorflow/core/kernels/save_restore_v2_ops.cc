@@ -20,7 +20,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
@@ -37,11 +39,13 @@ namespace tensorflow {
 
 namespace {
 
-// Shared validations of the inputs to the SaveV2 and RestoreV2 ops.
+// Shared validations of the inputs to the SaveV2, AsyncSaveV2 and RestoreV2
+// ops.  "num_fixed_inputs" counts the inputs before the saved tensors.
 void ValidateInputs(bool is_save_op, OpKernelContext* context,
                     const Tensor& prefix, const Tensor& tensor_names,
-                    const Tensor& shape_and_slices) {
-  const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
+                    const Tensor& shape_and_slices,
+                    int num_fixed_inputs = 3) {
+  const int kFixedInputs = num_fixed_inputs;
   const int num_tensors = static_cast<int>(tensor_names.NumElements());
   OP_REQUIRES(
       context, prefix.NumElements() == 1,
@@ -69,7 +73,7 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
       context, shape_and_slices.NumElements() == num_tensors,
       errors::InvalidArgument("Expected ", num_tensors,
                               " elements in shapes_and_slices, but got ",
-                              context->input(2).NumElements()));
+                              shape_and_slices.NumElements()));
   if (is_save_op) {
     OP_REQUIRES(context, context->num_inputs() == num_tensors + kFixedInputs,
                 errors::InvalidArgument(
@@ -102,49 +106,95 @@ class SaveV2 : public OpKernel {
 
     const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
     const int num_tensors = static_cast<int>(tensor_names.NumElements());
-    const string& prefix_string = prefix.scalar<tstring>()();
-    const auto& tensor_names_flat = tensor_names.flat<tstring>();
-    const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
+    std::vector<Tensor> tensors;
+    tensors.reserve(num_tensors);
+    for (int i = 0; i < num_tensors; ++i) {
+      tensors.push_back(context->input(i + kFixedInputs));
+    }
+    OP_REQUIRES_OK(context,
+                   SaveTensorsV2(prefix.scalar<tstring>()(), tensor_names,
+                                 shape_and_slices, tensors));
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+REGISTER_KERNEL_BUILDER(Name("AsyncSaver").Device(DEVICE_CPU),
+                        ResourceHandleOp<AsyncSaver>);
+
+// Same as SaveV2, with the checkpoint written in the background by an
+// AsyncSaver.  The op returns once the save is scheduled, holding the tensors
+// to save: resource variables updated in the meantime copy their buffer
+// instead of overwriting it, so the checkpoint is a consistent snapshot.
+class AsyncSaveV2 : public OpKernel {
+ public:
+  explicit AsyncSaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("copy_tensors", &copy_tensors_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<AsyncSaver> saver;
+    OP_REQUIRES_OK(context, LookupOrCreateResource<AsyncSaver>(
+                                context, HandleFromInput(context, 0), &saver,
+                                [](AsyncSaver** ret) {
+                                  *ret = new AsyncSaver;
+                                  return Status::OK();
+                                }));
+    const Tensor& prefix = context->input(1);
+    const Tensor& tensor_names = context->input(2);
+    const Tensor& shape_and_slices = context->input(3);
+    const int kFixedInputs = 4;  // Saver, prefix, names, shape_and_slices.
+    ValidateInputs(true /* is save op */, context, prefix, tensor_names,
+                   shape_and_slices, kFixedInputs);
+    if (!context->status().ok()) return;
 
+    const int num_tensors = static_cast<int>(tensor_names.NumElements());
+    std::vector<Tensor> tensors;
+    tensors.reserve(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
+      // Values of reference variables are updated in place.
+      tensors.push_back(copy_tensors_ ? tensor::DeepCopy(tensor) : tensor);
     }
-    OP_REQUIRES_OK(context, writer.Finish());
+    const string prefix_string = prefix.scalar<tstring>()();
+    saver->Schedule([prefix_string, tensor_names, shape_and_slices, tensors]() {
+      return SaveTensorsV2(prefix_string, tensor_names, shape_and_slices,
+                           tensors);
+    });
   }
+
+ private:
+  bool copy_tensors_;
 };
-REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
+REGISTER_KERNEL_BUILDER(Name("AsyncSaveV2").Device(DEVICE_CPU), AsyncSaveV2);
+
+// Waits for the saves scheduled on an AsyncSaver to finish.
+class AsyncSaverWait : public OpKernel {
+ public:
+  explicit AsyncSaverWait(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<AsyncSaver> saver;
+    OP_REQUIRES_OK(context, LookupOrCreateResource<AsyncSaver>(
+                                context, HandleFromInput(context, 0), &saver,
+                                [](AsyncSaver** ret) {
+                                  *ret = new AsyncSaver;
+                                  return Status::OK();
+                                }));
+    OP_REQUIRES_OK(context, saver->Wait());
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("AsyncSaverWait").Device(DEVICE_CPU),
+                        AsyncSaverWait);
 
 // Restores a list of named tensors from a tensor bundle (V2 checkpoint format).
 class RestoreV2 : public OpKernel {
  public:
   explicit RestoreV2(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("dtypes", &dtypes_));
+    // Set by LoadSavedModel for models that are only used for inference.
+    if (!context->GetAttr("_read_only_memmap", &read_only_).ok()) {
+      read_only_ = false;
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -182,13 +232,16 @@ class RestoreV2 : public OpKernel {
       return;
     }
     // If found, invokes the V2 reader.
-    OP_REQUIRES_OK(context, RestoreTensorsV2(context, prefix, tensor_names,
-                                             shape_and_slices, dtypes_));
+    OP_REQUIRES_OK(context,
+                   RestoreTensorsV2(context, prefix, tensor_names,
+                                    shape_and_slices, dtypes_, read_only_));
   }
 
  private:
   // Expected dtypes of the to-restore tensors.
   std::vector<DataType> dtypes_;
+  // Whether the tensors are restored as read-only aliases of the checkpoint.
+  bool read_only_;
 };
 REGISTER_KERNEL_BUILDER(Name("RestoreV2").Device(DEVICE_CPU), RestoreV2);
 
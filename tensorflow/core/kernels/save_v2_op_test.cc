@@ -23,7 +23,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
@@ -339,5 +341,59 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class AsyncSaveV2OpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "AsyncSaveV2")
+                     .Input(FakeInput(DT_RESOURCE))  // saver
+                     .Input(FakeInput())             // prefix
+                     .Input(FakeInput())             // tensor_names
+                     .Input(FakeInput())             // shape_and_slices
+                     .Input(FakeInput({DT_FLOAT}))   // tensors
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(AsyncSaveV2OpTest, Simple) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+  MakeOp();
+  AsyncSaver* saver = new AsyncSaver;
+  AddResourceInput("", "saver", saver);
+  AddInputFromArray<tstring>(TensorShape({}), {prefix});
+  AddInputFromArray<tstring>(TensorShape({1}), {"tensor_float"});
+  AddInputFromArray<tstring>(TensorShape({1}), {""});
+  AddInput<float>(TensorShape({2, 4}),
+                  [](int x) -> float { return static_cast<float>(x) / 10; });
+  TF_ASSERT_OK(RunOpKernel());
+  TF_ASSERT_OK(saver->Wait());
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_float", &val));
+  EXPECT_EQ(DT_FLOAT, val.dtype());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(static_cast<float>(i) / 10, val.flat<float>()(i));
+  }
+}
+
+TEST_F(AsyncSaveV2OpTest, Error) {
+  // The checkpoint directory can't be created under a file.
+  const string file = io::JoinPath(testing::TmpDir(), "async_not_a_dir");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file, "foo"));
+  MakeOp();
+  AsyncSaver* saver = new AsyncSaver;
+  AddResourceInput("", "saver", saver);
+  AddInputFromArray<tstring>(TensorShape({}), {io::JoinPath(file, "ckpt")});
+  AddInputFromArray<tstring>(TensorShape({1}), {"tensor_float"});
+  AddInputFromArray<tstring>(TensorShape({1}), {""});
+  AddInput<float>(TensorShape({2}), [](int x) -> float { return x; });
+  // The op succeeds, and the error is reported by the wait.
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_FALSE(saver->Wait().ok());
+  TF_EXPECT_OK(saver->Wait());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -22,7 +22,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
@@ -39,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -123,86 +126,103 @@ class SegmentReductionOp : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
+    // Finds where each segment starts, and checks that the segment ids are
+    // sorted. The checked ids are kept, so that they are not read again from
+    // the input.
+    std::vector<Index> segment_starts;
+    std::vector<Index> segment_indices;
+    Index current_index = internal::SubtleMustCopy(segment_vec(0));
+    OP_REQUIRES(
+        context, FastBoundsCheck(current_index, output_rows),
+        errors::InvalidArgument(
+            "Segment id ", current_index, " out of range [0, ", output_rows,
+            "), possibly because 'segment_ids' input is not sorted."));
+    segment_starts.push_back(0);
+    segment_indices.push_back(current_index);
+    for (Index end = 1; end < num_indices; ++end) {
+      const Index next_index = internal::SubtleMustCopy(segment_vec(end));
+      if (current_index == next_index) continue;
+      // We have a new segment here.  Verify that the segment ids are growing.
+      OP_REQUIRES(context, current_index < next_index,
+                  errors::InvalidArgument("segment ids are not increasing"));
+      OP_REQUIRES(
+          context, FastBoundsCheck(next_index, output_rows),
+          errors::InvalidArgument(
+              "Segment id ", next_index, " out of range [0, ", output_rows,
+              "), possibly because 'segment_ids' input is not sorted."));
+      segment_starts.push_back(end);
+      segment_indices.push_back(next_index);
+      current_index = next_index;
+    }
+    const int64 num_segments = segment_starts.size();
+    segment_starts.push_back(num_indices);
+
 #if !defined(EIGEN_HAS_INDEX_LIST)
     Eigen::DSizes<Eigen::DenseIndex, 1> dims_to_reduce;
     dims_to_reduce[0] = 0;
 #else
     Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
 #endif
-    Index start = 0, end = 1;
-
-    Index uninitialized_index = 0;  // Index from which the output is not set.
-    Index out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    // TODO(agarwal): if this loop becomes a bottleneck, consider sharding it
-    // across threads.
     Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
-    while (end <= num_indices) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      Index next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
+    typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
+                             Eigen::Unaligned>
+        OutT;
+
+    // Each shard reduces a range of segments, and sets the gap before each
+    // of its segments to the default value, so every output row is written
+    // by exactly one shard. We don't use out_slice.device(...) within a
+    // segment because these pieces of work are likely to be very small and
+    // the context switching overhead dwarfs any benefit we get from using
+    // another thread to do this work.
+    auto reduce_segments = [&](int64 begin_segment, int64 end_segment) {
+      for (int64 k = begin_segment; k < end_segment; ++k) {
+        const Index start = segment_starts[k];
+        const Index end = segment_starts[k + 1];
+        const Index out_index = segment_indices[k];
+        // Index from which the output is not set.
+        const Index uninitialized_index =
+            k == 0 ? 0 : segment_indices[k - 1] + 1;
+
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        if (out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(T(default_value));
         }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
-
-      // Process segment [start, end)
-      const T* in_slice_ptr = &input_flat(start, 0);
-      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                               Eigen::Unaligned>
-          OutT;
 
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(T(default_value));
+        // Process segment [start, end)
+        const T* in_slice_ptr = &input_flat(start, 0);
+        T* out_slice_ptr = &output_flat(out_index, 0);
+        OutT out_slice(out_slice_ptr, out_slice_shape);
+        if (start == end - 1) {
+          typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
+                                   Eigen::Unaligned>
+              InT;
+          InT in_slice(in_slice_ptr, out_slice_shape);
+          out_slice = in_slice;
+        } else {
+          Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
+                                                             num_col);
+          typedef Eigen::TensorMap<
+              Eigen::Tensor<const T, 2, Eigen::RowMajor>, Eigen::Unaligned>
+              InT;
+          InT in_slice(in_slice_ptr, in_slice_shape);
+
+          out_slice = in_slice.reduce(dims_to_reduce, Reducer());
+        }
       }
+    };
 
-      T* out_slice_ptr = &output_flat(out_index, 0);
-      OutT out_slice(out_slice_ptr, out_slice_shape);
-      // We don't use out_slice.device(context->eigen_device<Device>)
-      // because these pieces of work are likely to be very small and
-      // the context switching overhead dwarfs any benefit we get from
-      // using another thread to do this work.
-      if (start == end - 1) {
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
-                                 Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, out_slice_shape);
-        out_slice = in_slice;
-      } else {
-        Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
-                                                           num_col);
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
-                                 Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, in_slice_shape);
-
-        out_slice = in_slice.reduce(dims_to_reduce, Reducer());
-      }
-      if (end >= num_indices) break;
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-    }
+    // Shard() runs everything inline when the input is small.
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_segment =
+        (num_indices / num_segments + 1) * num_col * sizeof(T);
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, reduce_segments);
   }
 };
 
@@ -385,13 +405,43 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
                   typename TTypes<Index>::ConstFlat segment_ids,
                   typename TTypes<T, 2>::ConstTensor data,
                   typename TTypes<T, 2>::Tensor output) {
-    output.setConstant(InitialValueF()());
-    if (data.size() == 0) {
-      return;
-    }
     const int64 N = segment_ids.dimension(0);
     const int64 num_segments = output.dimension(0);
-    ReductionF reduction;
+    const int64 num_col = output.dimension(1);
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    if (data.size() < kMinParallelSize || num_col < kMinParallelColumns ||
+        num_segments < 2 || worker_threads->num_threads < 2) {
+      output.setConstant(InitialValueF()());
+      if (data.size() == 0) {
+        return;
+      }
+      ReductionF reduction;
+      for (int64 i = 0; i < N; ++i) {
+        Index j = internal::SubtleMustCopy(segment_ids(i));
+        if (j < 0) {
+          continue;
+        }
+        OP_REQUIRES(ctx, FastBoundsCheck(j, num_segments),
+                    errors::InvalidArgument(
+                        "segment_ids", SliceDebugString(segment_ids_shape, i),
+                        " = ", j, " is out of range [0, ", num_segments, ")"));
+        reduction(data.template chip<0>(i), output.template chip<0>(j));
+      }
+      return;
+    }
+
+    // The output rows are split in contiguous ranges of segments, one per
+    // shard, balanced by their number of input rows. Each shard scans all
+    // the segment ids, and reduces the rows of its own segments in input
+    // order, so the result is the same as with the serial loop above.
+    //
+    // The number of input rows per segment is counted in kBucketsPerShard
+    // buckets per shard, which also checks the segment ids.
+    const int64 num_shards =
+        std::min<int64>(worker_threads->num_threads, num_segments);
+    const int64 num_buckets =
+        std::min<int64>(num_segments, num_shards * kBucketsPerShard);
+    std::vector<int64> bucket_rows(num_buckets + 1, 0);
     for (int64 i = 0; i < N; ++i) {
       Index j = internal::SubtleMustCopy(segment_ids(i));
       if (j < 0) {
@@ -401,9 +451,49 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
                   errors::InvalidArgument(
                       "segment_ids", SliceDebugString(segment_ids_shape, i),
                       " = ", j, " is out of range [0, ", num_segments, ")"));
-      reduction(data.template chip<0>(i), output.template chip<0>(j));
+      ++bucket_rows[j * num_buckets / num_segments];
     }
+    // shard_segments[s] is the first segment of shard s.
+    std::vector<int64> shard_segments(num_shards + 1, num_segments);
+    shard_segments[0] = 0;
+    int64 rows = 0;
+    for (int64 b = 0, s = 1; b < num_buckets && s < num_shards; ++b) {
+      rows += bucket_rows[b];
+      if (rows * num_shards >= s * N) {
+        // The first segment of bucket b + 1.
+        shard_segments[s++] =
+            ((b + 1) * num_segments + num_buckets - 1) / num_buckets;
+      }
+    }
+
+    auto reduce_shards = [&](int64 begin, int64 end) {
+      ReductionF reduction;
+      for (int64 s = begin; s < end; ++s) {
+        const int64 first_segment = shard_segments[s];
+        const int64 last_segment = shard_segments[s + 1];
+        if (first_segment == last_segment) continue;
+        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                         Eigen::Unaligned>(&output(first_segment, 0),
+                                           last_segment - first_segment,
+                                           num_col)
+            .setConstant(InitialValueF()());
+        for (int64 i = 0; i < N; ++i) {
+          const int64 j = internal::SubtleMustCopy(segment_ids(i));
+          if (j < first_segment || j >= last_segment) continue;
+          reduction(data.template chip<0>(i), output.template chip<0>(j));
+        }
+      }
+    };
+    Shard(num_shards, worker_threads->workers, num_shards,
+          std::numeric_limits<int32>::max(), reduce_shards);
   }
+
+ private:
+  // Smaller inputs are reduced by the serial loop. As each shard scans all
+  // the segment ids, narrow rows are not worth sharding either.
+  static constexpr int64 kMinParallelSize = 64 * 1024;
+  static constexpr int64 kMinParallelColumns = 16;
+  static constexpr int64 kBucketsPerShard = 64;
 };
 
 template <typename T>
@@ -112,6 +112,7 @@ BM_Reduce_Arg(16, 8, 2);
 BM_Reduce_Arg(64, 32, 2);
 BM_Reduce_Arg(4096, 32, 2);
 BM_Reduce_Arg(4096, 128, 2);
+BM_Reduce_Arg(65536, 128, 8);
 
 static void SparseSegmentMeanGradHelper(int iters, float uniqueness, int size) {
   testing::StopTiming();
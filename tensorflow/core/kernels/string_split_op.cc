@@ -16,6 +16,7 @@ limitations under the License.
 // See docs in ../ops/string_ops.cc.
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -157,6 +159,66 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   return result;
 }
 
+// Rough cost of splitting one string.
+constexpr int64 kSplitCostPerUnit = 500;
+
+// Splits each string of `input_vec` with `split`, and writes the tokens as the
+// SparseTensor outputs of the StringSplit ops. The strings are split, and the
+// tokens copied to the output, on the intra-op threads.
+template <typename SplitFn>
+void SplitStrings(OpKernelContext* ctx,
+                  typename TTypes<tstring>::ConstVec input_vec,
+                  const SplitFn& split) {
+  const int64 batch_size = input_vec.dimension(0);
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+
+  // The tokens of each string, which are valid as long as the input is.
+  std::vector<std::vector<StringPiece>> tokens(batch_size);
+  Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+        kSplitCostPerUnit, [&](int64 begin, int64 end) {
+          for (int64 i = begin; i < end; ++i) {
+            tokens[i] = split(input_vec(i));
+          }
+        });
+
+  // offsets[i] is the index of the first output token of string i.
+  std::vector<int64> offsets(batch_size + 1, 0);
+  int64 max_num_entries = 0;
+  for (int64 i = 0; i < batch_size; ++i) {
+    const int64 n_entries = tokens[i].size();
+    offsets[i + 1] = offsets[i] + n_entries;
+    max_num_entries = std::max(max_num_entries, n_entries);
+  }
+  const int64 output_size = offsets[batch_size];
+
+  Tensor* sp_indices_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
+                                           &sp_indices_t));
+  Tensor* sp_tokens_t;
+  OP_REQUIRES_OK(
+      ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
+  Tensor* sp_shape_t;
+  OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
+
+  auto sp_indices = sp_indices_t->matrix<int64>();
+  auto sp_tokens = sp_tokens_t->vec<tstring>();
+  auto sp_shape = sp_shape_t->vec<int64>();
+  sp_shape(0) = batch_size;
+  sp_shape(1) = max_num_entries;
+  Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+        kSplitCostPerUnit, [&](int64 begin, int64 end) {
+          for (int64 i = begin; i < end; ++i) {
+            int64 c = offsets[i];
+            for (size_t j = 0; j < tokens[i].size(); ++j) {
+              sp_indices(c, 0) = i;
+              sp_indices(c, 1) = j;
+              sp_tokens(c).assign(tokens[i][j].data(), tokens[i][j].size());
+              ++c;
+            }
+          }
+        });
+}
+
 }  // namespace
 
 class StringSplitOp : public OpKernel {
@@ -179,7 +241,6 @@ class StringSplitOp : public OpKernel {
                                         input_tensor->shape().DebugString()));
 
     const auto input_vec = input_tensor->vec<tstring>();
-    const int64 batch_size = input_vec.dimension(0);
 
     const Tensor* delimiter_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("delimiter", &delimiter_tensor));
@@ -190,48 +251,14 @@ class StringSplitOp : public OpKernel {
     const auto delimiter_vec = delimiter_tensor->flat<tstring>();
     const tstring& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64 output_size = 0;
-    int64 max_num_entries = 0;
-    std::vector<int64> num_indices(batch_size);
-    for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts =
-          skip_empty_ ? Split(input_vec(i), delimiter, str_util::SkipEmpty())
-                      : Split(input_vec(i), delimiter, str_util::AllowEmpty());
-      int64 n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), std::make_move_iterator(parts.begin()),
-                    std::make_move_iterator(parts.end()));
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
+    if (skip_empty_) {
+      SplitStrings(ctx, input_vec, [&delimiter](const tstring& str) {
+        return Split(str, delimiter, str_util::SkipEmpty());
+      });
+    } else {
+      SplitStrings(ctx, input_vec, [&delimiter](const tstring& str) {
+        return Split(str, delimiter, str_util::AllowEmpty());
+      });
     }
   }
 
@@ -254,7 +281,6 @@ class StringSplitV2Op : public OpKernel {
                                         input_tensor->shape().DebugString()));
 
     const auto input_vec = input_tensor->vec<tstring>();
-    const int64 batch_size = input_vec.dimension(0);
 
     const Tensor* sep_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("sep", &sep_tensor));
@@ -263,46 +289,10 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
-
-    int64 output_size = 0;
-    int64 max_num_entries = 0;
-    std::vector<int64> num_indices(batch_size);
-    for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64 n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
-    }
-
-    Tensor* sp_indices_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
-                                             &sp_indices_t));
-    Tensor* sp_tokens_t;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_output(1, TensorShape({output_size}), &sp_tokens_t));
-    Tensor* sp_shape_t;
-    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
-
-    auto sp_indices = sp_indices_t->matrix<int64>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
-    auto sp_shape = sp_shape_t->vec<int64>();
-    sp_shape(0) = batch_size;
-    sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    const int maxsplit = maxsplit_;
+    SplitStrings(ctx, input_vec, [sep, maxsplit](const tstring& str) {
+      return SplitV2(str, sep, maxsplit);
+    });
   }
 
  private:
@@ -0,0 +1,484 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_STRIPED_FLAT_HASH_MAP_H_
+#define TENSORFLOW_CORE_KERNELS_STRIPED_FLAT_HASH_MAP_H_
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace flat_hash_internal {
+
+// Each slot of a FlatHashTable has a control byte, which is kEmpty, kDeleted,
+// or the low 7 bits of the hash of its key when the slot is full.
+constexpr int8 kEmpty = -128;
+constexpr int8 kDeleted = -2;
+
+// The slots are probed in groups whose control bytes are compared at once.
+constexpr int kGroupWidth = 16;
+
+// Scrambles all the bits of an integer key, as the control bytes and the
+// probe sequence use different bits of the hash.
+inline uint64 HashIntegerKey(uint64 x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+inline int CountTrailingZeros(uint32 mask) {
+#if defined(__GNUC__)
+  return __builtin_ctz(mask);
+#else
+  int n = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// The control bytes of a group of kGroupWidth slots. Each Match*() method
+// returns a bit mask of the matching slots of the group.
+class CtrlGroup {
+ public:
+  explicit CtrlGroup(const int8* ctrl) {
+#ifdef __SSE2__
+    ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+    memcpy(ctrl_, ctrl, kGroupWidth);
+#endif
+  }
+
+  // The full slots whose control byte is `h2`.
+  uint32 Match(int8 h2) const {
+#ifdef __SSE2__
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_));
+#else
+    uint32 mask = 0;
+    for (int i = 0; i < kGroupWidth; ++i) {
+      mask |= static_cast<uint32>(ctrl_[i] == h2) << i;
+    }
+    return mask;
+#endif
+  }
+
+  uint32 MatchEmpty() const { return Match(kEmpty); }
+
+  // Both kEmpty and kDeleted have their sign bit set, unlike full slots.
+  uint32 MatchEmptyOrDeleted() const {
+#ifdef __SSE2__
+    return _mm_movemask_epi8(ctrl_);
+#else
+    uint32 mask = 0;
+    for (int i = 0; i < kGroupWidth; ++i) {
+      mask |= static_cast<uint32>(ctrl_[i] < 0) << i;
+    }
+    return mask;
+#endif
+  }
+
+ private:
+#ifdef __SSE2__
+  __m128i ctrl_;
+#else
+  int8 ctrl_[kGroupWidth];
+#endif
+};
+
+// An open addressing hash table in the style of Swiss tables: the slots are
+// split into groups of kGroupWidth, and a lookup compares the 7-bit hash tag
+// of the key to the control bytes of a whole group at once, so that only the
+// keys of matching slots are read. Groups are probed quadratically. The
+// table is not thread safe, and hashes are computed by the caller.
+template <class K, class V>
+class FlatHashTable {
+ public:
+  FlatHashTable() { Reset(kGroupWidth); }
+
+  int64 size() const { return size_; }
+
+  // Returns the value of `key`, or nullptr if it isn't in the table.
+  const V* Find(K key, uint64 hash) const {
+    const int64 slot = FindSlot(key, hash);
+    return slot < 0 ? nullptr : &values_[slot];
+  }
+
+  // Inserts `key` or updates its value.
+  void InsertOrAssign(K key, V value, uint64 hash) {
+    const int64 slot = FindSlot(key, hash);
+    if (slot >= 0) {
+      values_[slot] = std::move(value);
+      return;
+    }
+    // Tombstones take up slots as well, so they count towards the load.
+    if ((size_ + deleted_ + 1) * 8 > capacity_ * 7) {
+      // Only grow if the table is mostly full of live entries, otherwise
+      // rehashing to the same size is enough to drop the tombstones.
+      Rehash((size_ + 1) * 16 > capacity_ * 7 ? capacity_ * 2 : capacity_);
+    }
+    InsertNew(key, std::move(value), hash);
+  }
+
+  // Removes `key`, and returns whether it was in the table.
+  bool Erase(K key, uint64 hash) {
+    const int64 slot = FindSlot(key, hash);
+    if (slot < 0) {
+      return false;
+    }
+    ctrl_[slot] = kDeleted;
+    --size_;
+    ++deleted_;
+    return true;
+  }
+
+  void Clear() { Reset(kGroupWidth); }
+
+  // Calls `fn(key, value)` for each entry.
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    for (int64 i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0) {
+        fn(keys_[i], values_[i]);
+      }
+    }
+  }
+
+  // Prefetches the first group probed for `hash`.
+  void Prefetch(uint64 hash) const {
+    const int64 group = GroupIndex(hash);
+    port::prefetch<port::PREFETCH_HINT_T0>(&ctrl_[group * kGroupWidth]);
+    port::prefetch<port::PREFETCH_HINT_T0>(&keys_[group * kGroupWidth]);
+  }
+
+  int64 MemoryUsed() const {
+    return sizeof(FlatHashTable) +
+           capacity_ * (sizeof(int8) + sizeof(K) + sizeof(V));
+  }
+
+ private:
+  static int8 H2(uint64 hash) { return static_cast<int8>(hash & 0x7f); }
+
+  int64 GroupIndex(uint64 hash) const {
+    return static_cast<int64>(hash >> 7) & (num_groups_ - 1);
+  }
+
+  // Returns the slot of `key`, or -1 if it isn't in the table. As the number
+  // of groups is a power of 2, the triangular probe sequence visits all of
+  // them, and the load factor ensures there is an empty slot to stop at.
+  int64 FindSlot(K key, uint64 hash) const {
+    const int8 h2 = H2(hash);
+    int64 group = GroupIndex(hash);
+    for (int64 step = 1;; ++step) {
+      const CtrlGroup ctrl(&ctrl_[group * kGroupWidth]);
+      for (uint32 match = ctrl.Match(h2); match != 0; match &= match - 1) {
+        const int64 slot = group * kGroupWidth + CountTrailingZeros(match);
+        if (keys_[slot] == key) {
+          return slot;
+        }
+      }
+      if (ctrl.MatchEmpty() != 0) {
+        return -1;
+      }
+      group = (group + step) & (num_groups_ - 1);
+    }
+  }
+
+  // Inserts a key that isn't in the table, without checking the load.
+  void InsertNew(K key, V value, uint64 hash) {
+    int64 group = GroupIndex(hash);
+    for (int64 step = 1;; ++step) {
+      const uint32 free =
+          CtrlGroup(&ctrl_[group * kGroupWidth]).MatchEmptyOrDeleted();
+      if (free != 0) {
+        const int64 slot = group * kGroupWidth + CountTrailingZeros(free);
+        if (ctrl_[slot] == kDeleted) {
+          --deleted_;
+        }
+        ctrl_[slot] = H2(hash);
+        keys_[slot] = key;
+        values_[slot] = std::move(value);
+        ++size_;
+        return;
+      }
+      group = (group + step) & (num_groups_ - 1);
+    }
+  }
+
+  void Reset(int64 capacity) {
+    DCHECK_EQ(capacity % kGroupWidth, 0);
+    capacity_ = capacity;
+    num_groups_ = capacity / kGroupWidth;
+    ctrl_.assign(capacity, kEmpty);
+    keys_.assign(capacity, K());
+    values_.assign(capacity, V());
+    size_ = 0;
+    deleted_ = 0;
+  }
+
+  void Rehash(int64 new_capacity) {
+    std::vector<int8> old_ctrl = std::move(ctrl_);
+    std::vector<K> old_keys = std::move(keys_);
+    std::vector<V> old_values = std::move(values_);
+    Reset(new_capacity);
+    for (size_t i = 0; i < old_ctrl.size(); ++i) {
+      if (old_ctrl[i] >= 0) {
+        InsertNew(old_keys[i], std::move(old_values[i]),
+                  HashIntegerKey(static_cast<uint64>(old_keys[i])));
+      }
+    }
+  }
+
+  std::vector<int8> ctrl_;
+  std::vector<K> keys_;
+  std::vector<V> values_;
+  int64 capacity_;
+  int64 num_groups_;
+  int64 size_;
+  int64 deleted_;
+};
+
+}  // namespace flat_hash_internal
+
+// A thread-safe hash map from integer keys, made of independent
+// FlatHashTables, or shards, each with its own reader-writer lock. A key
+// always goes to the same shard, so concurrent lookups only contend on the
+// shards they share, and only with writers.
+//
+// All operations work on batches of keys. A batch is first grouped by shard,
+// so that each shard is locked once per batch, and the first group probed
+// for the next keys is prefetched while the current key is looked up.
+template <class K, class V>
+class StripedFlatHashMap {
+ public:
+  static_assert(std::is_integral<K>::value, "Keys must be integers");
+
+  // `num_shards` is rounded up to a power of 2, and at most 65536.
+  explicit StripedFlatHashMap(int num_shards) {
+    int rounded = 1;
+    while (rounded < num_shards && rounded < (1 << 16)) {
+      rounded *= 2;
+    }
+    shard_mask_ = rounded - 1;
+    shards_.reserve(rounded);
+    for (int i = 0; i < rounded; ++i) {
+      shards_.emplace_back(new Shard);
+    }
+  }
+
+  int num_shards() const { return shards_.size(); }
+
+  int64 size() const {
+    int64 size = 0;
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      size += shard->table.size();
+    }
+    return size;
+  }
+
+  // Sets values[i] to the value of keys[i], or to `default_value`.
+  void Find(const K* keys, int64 n, const V& default_value, V* values) const {
+    const Batch batch = GroupByShard(keys, n);
+    for (int s = 0; s < num_shards(); ++s) {
+      if (batch.shard_start[s] == batch.shard_start[s + 1]) {
+        continue;
+      }
+      const Shard& shard = *shards_[s];
+      tf_shared_lock l(shard.mu);
+      ForEachInShard(batch, s, shard.table, [&](int64 i) {
+        const V* value = shard.table.Find(batch.keys[i], batch.hashes[i]);
+        values[batch.index[i]] = value ? *value : default_value;
+      });
+    }
+  }
+
+  // Inserts or updates the given keys. If a key is repeated, its last value
+  // wins.
+  void Insert(const K* keys, const V* values, int64 n) {
+    const Batch batch = GroupByShard(keys, n);
+    for (int s = 0; s < num_shards(); ++s) {
+      if (batch.shard_start[s] == batch.shard_start[s + 1]) {
+        continue;
+      }
+      Shard& shard = *shards_[s];
+      mutex_lock l(shard.mu);
+      InsertInShard(batch, s, values, &shard.table);
+    }
+  }
+
+  void Erase(const K* keys, int64 n) {
+    const Batch batch = GroupByShard(keys, n);
+    for (int s = 0; s < num_shards(); ++s) {
+      if (batch.shard_start[s] == batch.shard_start[s + 1]) {
+        continue;
+      }
+      Shard& shard = *shards_[s];
+      mutex_lock l(shard.mu);
+      ForEachInShard(batch, s, shard.table, [&](int64 i) {
+        shard.table.Erase(batch.keys[i], batch.hashes[i]);
+      });
+    }
+  }
+
+  // Replaces the contents of the map with the given entries. The whole
+  // map is locked, so readers see either the old or the new contents.
+  void Assign(const K* keys, const V* values, int64 n)
+      NO_THREAD_SAFETY_ANALYSIS {
+    const Batch batch = GroupByShard(keys, n);
+    std::vector<mutex_lock> locks;
+    locks.reserve(num_shards());
+    for (int s = 0; s < num_shards(); ++s) {
+      locks.emplace_back(shards_[s]->mu);
+    }
+    for (int s = 0; s < num_shards(); ++s) {
+      shards_[s]->table.Clear();
+      InsertInShard(batch, s, values, &shards_[s]->table);
+    }
+  }
+
+  // Appends all the entries to `keys` and `values`. The whole map is locked
+  // for reading, so the entries are a consistent snapshot.
+  void Export(std::vector<K>* keys, std::vector<V>* values) const
+      NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<tf_shared_lock> locks;
+    locks.reserve(num_shards());
+    int64 size = 0;
+    for (int s = 0; s < num_shards(); ++s) {
+      locks.emplace_back(shards_[s]->mu);
+      size += shards_[s]->table.size();
+    }
+    keys->reserve(keys->size() + size);
+    values->reserve(values->size() + size);
+    for (int s = 0; s < num_shards(); ++s) {
+      shards_[s]->table.ForEach([&](const K& key, const V& value) {
+        keys->push_back(key);
+        values->push_back(value);
+      });
+    }
+  }
+
+  int64 MemoryUsed() const {
+    int64 memory = sizeof(StripedFlatHashMap);
+    for (const auto& shard : shards_) {
+      tf_shared_lock l(shard->mu);
+      memory += sizeof(Shard) + shard->table.MemoryUsed();
+    }
+    return memory;
+  }
+
+ private:
+  // How many keys ahead of the current one to prefetch.
+  static constexpr int64 kPrefetchDistance = 8;
+
+  using Table = flat_hash_internal::FlatHashTable<K, V>;
+
+  struct Shard {
+    mutable mutex mu;
+    Table table GUARDED_BY(mu);
+  };
+
+  // A batch of keys sorted by shard: the keys of shard s are
+  // [shard_start[s], shard_start[s + 1]), and keys[i] is keys[index[i]] of
+  // the caller. The keys are copied once, so that they can't change under
+  // the lookup if the caller's buffer is concurrently updated.
+  struct Batch {
+    std::vector<K> keys;
+    std::vector<uint64> hashes;
+    std::vector<int64> index;
+    std::vector<int64> shard_start;
+  };
+
+  Batch GroupByShard(const K* keys, int64 n) const {
+    std::vector<K> key_copies(n);
+    std::vector<uint64> hashes(n);
+    std::vector<int> shard(n);
+    Batch batch;
+    batch.shard_start.assign(num_shards() + 1, 0);
+    for (int64 i = 0; i < n; ++i) {
+      key_copies[i] = *static_cast<const volatile K*>(keys + i);
+      hashes[i] = flat_hash_internal::HashIntegerKey(
+          static_cast<uint64>(key_copies[i]));
+      // FlatHashTable uses the low bits of the hash, the shard the high ones.
+      shard[i] = static_cast<int>(hashes[i] >> 48) & shard_mask_;
+      ++batch.shard_start[shard[i] + 1];
+    }
+    for (int s = 0; s < num_shards(); ++s) {
+      batch.shard_start[s + 1] += batch.shard_start[s];
+    }
+    batch.keys.resize(n);
+    batch.hashes.resize(n);
+    batch.index.resize(n);
+    std::vector<int64> next(batch.shard_start.begin(),
+                            batch.shard_start.end() - 1);
+    for (int64 i = 0; i < n; ++i) {
+      const int64 pos = next[shard[i]]++;
+      batch.hashes[pos] = hashes[i];
+      batch.keys[pos] = key_copies[i];
+      batch.index[pos] = i;
+    }
+    return batch;
+  }
+
+  // Calls `fn(i)` for each key i of shard `s` of the batch, in order.
+  template <typename Fn>
+  static void ForEachInShard(const Batch& batch, int s, const Table& table,
+                             Fn fn) {
+    const int64 end = batch.shard_start[s + 1];
+    for (int64 i = batch.shard_start[s]; i < end; ++i) {
+      if (i + kPrefetchDistance < end) {
+        table.Prefetch(batch.hashes[i + kPrefetchDistance]);
+      }
+      fn(i);
+    }
+  }
+
+  static void InsertInShard(const Batch& batch, int s, const V* values,
+                            Table* table) {
+    ForEachInShard(batch, s, *table, [&](int64 i) {
+      table->InsertOrAssign(batch.keys[i], values[batch.index[i]],
+                            batch.hashes[i]);
+    });
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  int shard_mask_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StripedFlatHashMap);
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_STRIPED_FLAT_HASH_MAP_H_
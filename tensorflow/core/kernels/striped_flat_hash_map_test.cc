@@ -0,0 +1,147 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/striped_flat_hash_map.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+TEST(StripedFlatHashMapTest, RoundsUpNumShards) {
+  EXPECT_EQ((StripedFlatHashMap<int64, int64>(1).num_shards()), 1);
+  EXPECT_EQ((StripedFlatHashMap<int64, int64>(5).num_shards()), 8);
+  EXPECT_EQ((StripedFlatHashMap<int64, int64>(16).num_shards()), 16);
+}
+
+TEST(StripedFlatHashMapTest, InsertFindErase) {
+  StripedFlatHashMap<int64, float> map(4);
+  const std::vector<int64> keys = {3, -7, 1000000007, 0, 3};
+  const std::vector<float> values = {1, 2, 3, 4, 5};
+  map.Insert(keys.data(), values.data(), keys.size());
+  // The last value of the repeated key wins.
+  EXPECT_EQ(map.size(), 4);
+
+  const std::vector<int64> queries = {0, 3, 42, -7, 1000000007};
+  std::vector<float> found(queries.size());
+  map.Find(queries.data(), queries.size(), -1.0f, found.data());
+  EXPECT_EQ(found, std::vector<float>({4, 5, -1, 2, 3}));
+
+  const std::vector<int64> erased = {3, 42};
+  map.Erase(erased.data(), erased.size());
+  EXPECT_EQ(map.size(), 3);
+  map.Find(queries.data(), queries.size(), -1.0f, found.data());
+  EXPECT_EQ(found, std::vector<float>({4, -1, -1, 2, 3}));
+}
+
+TEST(StripedFlatHashMapTest, MatchesUnorderedMap) {
+  // Enough operations to grow the tables several times, and to rehash them
+  // to drop tombstones.
+  StripedFlatHashMap<int32, int64> map(8);
+  std::unordered_map<int32, int64> expected;
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int round = 0; round < 200; ++round) {
+    std::vector<int32> keys(64);
+    std::vector<int64> values(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = rnd.Uniform(5000);
+      values[i] = rnd.Rand64();
+    }
+    if (round % 3 == 2) {
+      map.Erase(keys.data(), keys.size());
+      for (int32 key : keys) {
+        expected.erase(key);
+      }
+    } else {
+      map.Insert(keys.data(), values.data(), keys.size());
+      for (size_t i = 0; i < keys.size(); ++i) {
+        expected[keys[i]] = values[i];
+      }
+    }
+    ASSERT_EQ(map.size(), expected.size());
+  }
+
+  std::vector<int32> queries(5000);
+  for (size_t i = 0; i < queries.size(); ++i) {
+    queries[i] = i;
+  }
+  std::vector<int64> found(queries.size());
+  map.Find(queries.data(), queries.size(), -1, found.data());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    auto it = expected.find(queries[i]);
+    EXPECT_EQ(found[i], it == expected.end() ? -1 : it->second) << i;
+  }
+}
+
+TEST(StripedFlatHashMapTest, AssignAndExport) {
+  StripedFlatHashMap<int64, int64> map(4);
+  const std::vector<int64> old_keys = {1, 2, 3};
+  map.Insert(old_keys.data(), old_keys.data(), old_keys.size());
+
+  const std::vector<int64> keys = {10, 20, 30, 40};
+  const std::vector<int64> values = {1, 2, 3, 4};
+  map.Assign(keys.data(), values.data(), keys.size());
+  EXPECT_EQ(map.size(), 4);
+
+  std::vector<int64> exported_keys, exported_values;
+  map.Export(&exported_keys, &exported_values);
+  ASSERT_EQ(exported_keys.size(), 4);
+  ASSERT_EQ(exported_values.size(), 4);
+  for (size_t i = 0; i < exported_keys.size(); ++i) {
+    EXPECT_EQ(exported_values[i], exported_keys[i] / 10);
+  }
+  std::sort(exported_keys.begin(), exported_keys.end());
+  EXPECT_EQ(exported_keys, keys);
+}
+
+TEST(StripedFlatHashMapTest, ConcurrentFindAndInsert) {
+  StripedFlatHashMap<int64, int64> map(16);
+  constexpr int kNumThreads = 8;
+  constexpr int kKeysPerThread = 2000;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&map, t]() {
+        std::vector<int64> keys(kKeysPerThread);
+        for (int i = 0; i < kKeysPerThread; ++i) {
+          keys[i] = t * kKeysPerThread + i;
+        }
+        std::vector<int64> found(kKeysPerThread);
+        for (int i = 0; i < kKeysPerThread; i += 100) {
+          map.Insert(keys.data() + i, keys.data() + i, 100);
+          // Keys are only ever mapped to themselves.
+          map.Find(keys.data(), kKeysPerThread, -1, found.data());
+          for (int j = 0; j < kKeysPerThread; ++j) {
+            CHECK(found[j] == -1 || found[j] == keys[j]);
+          }
+        }
+      });
+    }
+  }
+  EXPECT_EQ(map.size(), kNumThreads * kKeysPerThread);
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
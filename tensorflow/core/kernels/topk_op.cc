@@ -97,6 +97,64 @@ class TopK : public OpKernel {
   bool sorted_;
 };
 
+namespace {
+
+// Rows with fewer rows than threads are selected in parallel over shards of
+// at least this many columns.
+constexpr int64 kMinColsPerShard = 64 * 1024;
+// When the selection of a shard is full, its columns are compared to the
+// current k-th value in blocks of this size, a loop which the compiler
+// vectorizes, and blocks without a larger value are skipped.
+constexpr int64 kThresholdBlockSize = 16;
+
+// Returns the indices of the (at most) k largest values of `input_data` in
+// columns [begin, end), in no particular order. As in the TopN selection of
+// whole rows, equal values go to the smaller index.
+template <typename T>
+std::vector<int32> SelectTopKInRange(const T* input_data, int k, int64 begin,
+                                     int64 end) {
+  const auto stable_comp = [input_data](const int32 a, const int32 b) {
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  };
+  gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+  filter.reserve(end - begin);
+  int64 c = begin;
+  for (; c < end && filter.size() < static_cast<size_t>(k); ++c) {
+    filter.push(c);
+  }
+  if (c == end) {
+    return std::vector<int32>(filter.unsorted_begin(), filter.unsorted_end());
+  }
+  // Any later column whose value is not larger than the k-th value would
+  // lose to it, as it has a larger index.
+  T threshold = input_data[filter.peek_bottom()];
+  while (c < end) {
+    const int64 block_end = std::min(end, c + kThresholdBlockSize);
+    bool has_candidate = false;
+    for (int64 j = c; j < block_end; ++j) {
+      // NaNs are not skipped, like in the TopN selection.
+      has_candidate |= !(input_data[j] <= threshold);
+    }
+    if (has_candidate) {
+      for (int64 j = c; j < block_end; ++j) {
+        if (input_data[j] <= threshold) continue;
+        filter.push(j);
+        threshold = input_data[filter.peek_bottom()];
+      }
+    }
+    c = block_end;
+  }
+  return std::vector<int32>(filter.unsorted_begin(), filter.unsorted_end());
+}
+
+}  // namespace
+
 namespace functor {
 
 template <typename T>
@@ -136,6 +194,64 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // With too few rows to keep the threads busy, each row is split in
+    // shards of columns. The top k of each shard are selected in parallel,
+    // and then the top k of their union.
+    const int64 num_col_shards = std::min<int64>(
+        worker_threads.num_threads, num_cols / kMinColsPerShard);
+    if (num_rows < worker_threads.num_threads && num_col_shards > 1 &&
+        k < num_cols / num_col_shards) {
+      const int64 shard_size =
+          (num_cols + num_col_shards - 1) / num_col_shards;
+      std::vector<std::vector<int32>> shard_top_k(num_col_shards);
+      for (int64 b = 0; b < num_rows; ++b) {
+        const T* input_data = &input(b, 0);
+        Shard(worker_threads.num_threads, worker_threads.workers,
+              num_col_shards, shard_size * 10, [&](int64 begin, int64 end) {
+                for (int64 s = begin; s < end; ++s) {
+                  shard_top_k[s] = SelectTopKInRange(
+                      input_data, k, s * shard_size,
+                      std::min(num_cols, (s + 1) * shard_size));
+                }
+              });
+
+        const auto stable_comp = [input_data](const int32 a, const int32 b) {
+          if (input_data[b] < input_data[a]) {
+            return true;
+          } else if (input_data[b] > input_data[a]) {
+            return false;
+          } else {
+            return a < b;
+          }
+        };
+        gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+        filter.reserve(num_col_shards * k);
+        for (const auto& candidates : shard_top_k) {
+          for (const int32 c : candidates) {
+            filter.push(c);
+          }
+        }
+        int32 i = 0;
+        if (sorted) {
+          std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
+          for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
+               ++top_k_it, ++i) {
+            indices(b, i) = *top_k_it;
+          }
+        } else {
+          for (auto top_k_it = filter.unsorted_begin();
+               top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
+            indices(b, i) = *top_k_it;
+          }
+        }
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const int32 loc) { return input(b, loc); });
+      }
+      return Status::OK();
+    }
+
     auto SortIndices = [&](int64 start_batch, int64 limit_batch) {
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -221,7 +337,6 @@ struct TopKFunctor<CPUDevice, T> {
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
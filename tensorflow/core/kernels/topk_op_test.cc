@@ -0,0 +1,134 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Rows of at least this many columns per thread are split in column shards.
+constexpr int kShardSize = 64 * 1024;
+constexpr int kNumThreads = 4;
+constexpr int kNumCols = kNumThreads * kShardSize;
+
+class TopKOpTest : public OpsTestBase {
+ protected:
+  TopKOpTest()
+      : thread_pool_(new thread::ThreadPool(Env::Default(), "topk_op_test",
+                                            kNumThreads)) {
+    // Uses a fixed number of threads, whatever the parallelism of the
+    // machine, so that single rows are selected over column shards.
+    worker_threads_.num_threads = kNumThreads;
+    worker_threads_.workers = thread_pool_.get();
+    device_->set_tensorflow_cpu_worker_threads(&worker_threads_);
+  }
+
+  void MakeOp(bool sorted) {
+    TF_ASSERT_OK(NodeDefBuilder("top_k", "TopKV2")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("sorted", sorted)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Runs TopKV2 on a single row and checks its outputs against a stable
+  // sort of the row, in which equal values go to the smaller index.
+  void ExpectTopK(const std::vector<float>& row, int k) {
+    MakeOp(/*sorted=*/true);
+    inputs_.clear();
+    AddInputFromArray<float>(TensorShape({1, static_cast<int64>(row.size())}),
+                             row);
+    AddInputFromArray<int32>(TensorShape({}), {k});
+    TF_ASSERT_OK(RunOpKernel());
+
+    std::vector<int32> order(row.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&row](int32 a, int32 b) { return row[a] > row[b]; });
+    order.resize(k);
+    std::vector<float> expected_values(k);
+    std::transform(order.begin(), order.end(), expected_values.begin(),
+                   [&row](int32 c) { return row[c]; });
+    test::ExpectTensorEqual<float>(
+        *GetOutput(0), test::AsTensor<float>(expected_values, {1, k}));
+    test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                   test::AsTensor<int32>(order, {1, k}));
+  }
+
+ private:
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+  DeviceBase::CpuWorkerThreads worker_threads_;
+};
+
+TEST_F(TopKOpTest, ShardedRowWithTiesAcrossShards) {
+  std::vector<float> row(kNumCols, 0);
+  // Equal values on both sides of the shard boundaries, more of them than k,
+  // so the selection must keep the smaller indices of the tie.
+  row[kShardSize - 1] = 10;
+  row[kShardSize] = 10;
+  row[2 * kShardSize - 1] = 10;
+  row[2 * kShardSize] = 10;
+  row[3 * kShardSize] = 10;
+  ExpectTopK(row, 3);
+  // The zeros after the tie come from the start of the first shard.
+  ExpectTopK(row, 7);
+}
+
+TEST_F(TopKOpTest, ShardedRowWithManyTies) {
+  std::vector<float> row(kNumCols);
+  for (int c = 0; c < kNumCols; ++c) {
+    row[c] = (static_cast<int64>(c) * 7919) % 1000;
+  }
+  ExpectTopK(row, 100);
+}
+
+TEST_F(TopKOpTest, ShardedRowUnsorted) {
+  std::vector<float> row(kNumCols, 0);
+  for (int c = 0; c < kNumCols; c += kShardSize / 2) {
+    row[c] = 1;
+  }
+  MakeOp(/*sorted=*/false);
+  AddInputFromArray<float>(TensorShape({1, kNumCols}), row);
+  AddInputFromArray<int32>(TensorShape({}), {4});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Only the order of the outputs is unspecified.
+  const auto indices = GetOutput(1)->flat<int32>();
+  std::vector<int32> sorted_indices(indices.data(),
+                                    indices.data() + indices.size());
+  std::sort(sorted_indices.begin(), sorted_indices.end());
+  EXPECT_EQ(sorted_indices,
+            std::vector<int32>({0, kShardSize / 2, kShardSize,
+                                3 * kShardSize / 2}));
+  test::ExpectTensorEqual<float>(*GetOutput(0),
+                                 test::AsTensor<float>({1, 1, 1, 1}, {1, 4}));
+}
+
+}  // namespace
+}  // namespace tensorflow
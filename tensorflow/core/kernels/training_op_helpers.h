@@ -193,11 +193,17 @@ void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
 
 // This is for use with ResourceVariables to ensure *tensor has a
 // reference count of 1 before you update it.
-// REQUIRES: If you pass in variable->tensor(), *variable->mu() must be held.
+//
+// In copy-on-read mode no tensor outside of the kernels holding the
+// variable's mutex aliases the buffer, so it is updated in place: copying it
+// would only duplicate the whole variable (e.g. a large embedding table) on
+// every dense update.
+// REQUIRES: If you pass in variable->tensor(), *variable->mu() must be held
+// exclusively.
 template <typename Device, typename T>
 Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor,
                                bool copy_on_read_mode) {
-  if (copy_on_read_mode || !tensor->RefCountIsOne()) {
+  if (!copy_on_read_mode && !tensor->RefCountIsOne()) {
     // Tensor's buffer is in use by some read, so we need to copy before
     // updating.
     PersistentTensor unused;
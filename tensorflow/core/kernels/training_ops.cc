@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
 
 #include <algorithm>
+#include <numeric>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -623,6 +625,21 @@ struct ApplyMomentum<CPUDevice, T> {
   }
 };
 
+template <typename T>
+struct MultiApplyMomentum<CPUDevice, T> {
+  void operator()(const CPUDevice& d,
+                  const std::vector<typename TTypes<T>::Flat>& var,
+                  const std::vector<typename TTypes<T>::Flat>& accum,
+                  typename TTypes<T>::ConstScalar lr,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grad,
+                  typename TTypes<T>::ConstScalar momentum, bool use_nesterov) {
+    for (size_t i = 0; i < var.size(); ++i) {
+      ApplyMomentum<CPUDevice, T>()(d, var[i], accum[i], lr, grad[i], momentum,
+                                    use_nesterov);
+    }
+  }
+};
+
 template <typename T>
 struct ApplyKerasMomentum<CPUDevice, T> {
   void operator()(const CPUDevice& d, typename TTypes<T>::Flat var,
@@ -731,6 +748,28 @@ struct ApplyAdamSYCL {
 template <typename T>
 struct ApplyAdam<CPUDevice, T> : ApplyAdamNonCuda<CPUDevice, T> {};
 
+template <typename T>
+struct MultiApplyAdam<CPUDevice, T> {
+  void operator()(const CPUDevice& d,
+                  const std::vector<typename TTypes<T>::Flat>& var,
+                  const std::vector<typename TTypes<T>::Flat>& m,
+                  const std::vector<typename TTypes<T>::Flat>& v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grad,
+                  bool use_nesterov) {
+    for (size_t i = 0; i < var.size(); ++i) {
+      ApplyAdam<CPUDevice, T>()(d, var[i], m[i], v[i], beta1_power,
+                                beta2_power, lr, beta1, beta2, epsilon,
+                                grad[i], use_nesterov);
+    }
+  }
+};
+
 template <typename T>
 struct ApplyAdamWithAmsgrad<CPUDevice, T> {
   void operator()(const CPUDevice& d, typename TTypes<T>::Flat var,
@@ -3034,6 +3073,115 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+template <typename Device, typename T>
+class MultiApplyMomentumOp : public OpKernel {
+ public:
+  explicit MultiApplyMomentumOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const bool sparse = false;
+    std::vector<int> var_inputs(2 * num_vars_);
+    std::iota(var_inputs.begin(), var_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, sparse, var_inputs);
+
+    const Tensor& lr = ctx->input(2 * num_vars_);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    const Tensor& momentum = ctx->input(3 * num_vars_ + 1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(momentum.shape()),
+                errors::InvalidArgument("momentum is not a scalar: ",
+                                        momentum.shape().DebugString()));
+
+    std::vector<Tensor> tensors(2 * num_vars_);
+    for (int i = 0; i < 2 * num_vars_; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
+                              ctx, i, use_exclusive_lock_, sparse,
+                              &tensors[i]));
+      OP_REQUIRES(ctx, tensors[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+    }
+
+    std::vector<typename TTypes<T>::Flat> var;
+    std::vector<typename TTypes<T>::Flat> accum;
+    std::vector<typename TTypes<T>::ConstFlat> grad;
+    for (int i = 0; i < num_vars_; ++i) {
+      const Tensor& var_i = tensors[i];
+      const Tensor& accum_i = tensors[num_vars_ + i];
+      const Tensor& grad_i = ctx->input(2 * num_vars_ + 1 + i);
+      OP_REQUIRES(
+          ctx, var_i.shape().IsSameSize(accum_i.shape()),
+          errors::InvalidArgument("var and accum do not have the same shape",
+                                  var_i.shape().DebugString(), " ",
+                                  accum_i.shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var_i.shape().IsSameSize(grad_i.shape()),
+          errors::InvalidArgument("var and grad do not have the same shape",
+                                  var_i.shape().DebugString(), " ",
+                                  grad_i.shape().DebugString()));
+      var.push_back(tensors[i].flat<T>());
+      accum.push_back(tensors[num_vars_ + i].flat<T>());
+      grad.push_back(grad_i.flat<T>());
+    }
+
+    const Device& device = ctx->template eigen_device<Device>();
+    functor::MultiApplyMomentum<Device, T>()(device, var, accum,
+                                             lr.scalar<T>(), grad,
+                                             momentum.scalar<T>(),
+                                             use_nesterov_);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                                    \
+  REGISTER_KERNEL_BUILDER(Name("_ResourceMultiApplyMomentum")     \
+                              .Device(DEVICE_##D)                 \
+                              .HostMemory("var")                  \
+                              .HostMemory("accum")                \
+                              .TypeConstraint<T>("T"),            \
+                          MultiApplyMomentumOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                 \
+  template <>                                                               \
+  void MultiApplyMomentum<GPUDevice, T>::operator()(                        \
+      const GPUDevice& d, const std::vector<typename TTypes<T>::Flat>& var, \
+      const std::vector<typename TTypes<T>::Flat>& accum,                   \
+      typename TTypes<T>::ConstScalar lr,                                   \
+      const std::vector<typename TTypes<T>::ConstFlat>& grad,               \
+      typename TTypes<T>::ConstScalar momentum, bool use_nesterov);         \
+  extern template struct MultiApplyMomentum<GPUDevice, T>;
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 // Note, this op works on cpu only.
 template <typename T, typename Tindex>
 class SparseApplyMomentumOp : public OpKernel {
@@ -3630,6 +3778,134 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+template <typename Device, typename T>
+class MultiApplyAdamOp : public OpKernel {
+ public:
+  explicit MultiApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const bool sparse = false;
+    std::vector<int> var_inputs(3 * num_vars_);
+    std::iota(var_inputs.begin(), var_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, sparse, var_inputs);
+
+    static constexpr const char* kScalarNames[] = {
+        "beta1_power", "beta2_power", "lr", "beta1", "beta2", "epsilon"};
+    for (int i = 0; i < 6; ++i) {
+      const Tensor& scalar = ctx->input(3 * num_vars_ + i);
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(scalar.shape()),
+                  errors::InvalidArgument(kScalarNames[i], " is not a scalar: ",
+                                          scalar.shape().DebugString()));
+    }
+
+    std::vector<Tensor> tensors(3 * num_vars_);
+    for (int i = 0; i < 3 * num_vars_; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
+                              ctx, i, use_exclusive_lock_, sparse,
+                              &tensors[i]));
+      OP_REQUIRES(ctx, tensors[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+    }
+
+    std::vector<typename TTypes<T>::Flat> var;
+    std::vector<typename TTypes<T>::Flat> m;
+    std::vector<typename TTypes<T>::Flat> v;
+    std::vector<typename TTypes<T>::ConstFlat> grad;
+    for (int i = 0; i < num_vars_; ++i) {
+      const Tensor& var_i = tensors[i];
+      const Tensor& m_i = tensors[num_vars_ + i];
+      const Tensor& v_i = tensors[2 * num_vars_ + i];
+      const Tensor& grad_i = ctx->input(3 * num_vars_ + 6 + i);
+      OP_REQUIRES(
+          ctx, var_i.shape().IsSameSize(m_i.shape()),
+          errors::InvalidArgument("var and m do not have the same shape",
+                                  var_i.shape().DebugString(), " ",
+                                  m_i.shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var_i.shape().IsSameSize(v_i.shape()),
+          errors::InvalidArgument("var and v do not have the same shape",
+                                  var_i.shape().DebugString(), " ",
+                                  v_i.shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var_i.shape().IsSameSize(grad_i.shape()),
+          errors::InvalidArgument("var and grad do not have the same shape",
+                                  var_i.shape().DebugString(), " ",
+                                  grad_i.shape().DebugString()));
+      var.push_back(tensors[i].flat<T>());
+      m.push_back(tensors[num_vars_ + i].flat<T>());
+      v.push_back(tensors[2 * num_vars_ + i].flat<T>());
+      grad.push_back(grad_i.flat<T>());
+    }
+
+    const int scalars = 3 * num_vars_;
+    const Device& device = ctx->template eigen_device<Device>();
+    functor::MultiApplyAdam<Device, T>()(
+        device, var, m, v, ctx->input(scalars).scalar<T>(),
+        ctx->input(scalars + 1).scalar<T>(),
+        ctx->input(scalars + 2).scalar<T>(),
+        ctx->input(scalars + 3).scalar<T>(),
+        ctx->input(scalars + 4).scalar<T>(),
+        ctx->input(scalars + 5).scalar<T>(), grad, use_nesterov_);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                               \
+  REGISTER_KERNEL_BUILDER(Name("_ResourceMultiApplyAdam")    \
+                              .Device(DEVICE_##D)            \
+                              .HostMemory("var")             \
+                              .HostMemory("m")               \
+                              .HostMemory("v")               \
+                              .TypeConstraint<T>("T"),       \
+                          MultiApplyAdamOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                  \
+  template <>                                                                \
+  void MultiApplyAdam<GPUDevice, T>::operator()(                             \
+      const GPUDevice& d, const std::vector<typename TTypes<T>::Flat>& var,  \
+      const std::vector<typename TTypes<T>::Flat>& m,                        \
+      const std::vector<typename TTypes<T>::Flat>& v,                        \
+      typename TTypes<T>::ConstScalar beta1_power,                           \
+      typename TTypes<T>::ConstScalar beta2_power,                           \
+      typename TTypes<T>::ConstScalar lr,                                    \
+      typename TTypes<T>::ConstScalar beta1,                                 \
+      typename TTypes<T>::ConstScalar beta2,                                 \
+      typename TTypes<T>::ConstScalar epsilon,                               \
+      const std::vector<typename TTypes<T>::ConstFlat>& grad,                \
+      bool use_nesterov);                                                    \
+  extern template struct MultiApplyAdam<GPUDevice, T>;
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
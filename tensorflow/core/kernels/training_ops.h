@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TRAINING_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OPS_H_
 
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -174,6 +176,19 @@ struct ApplyMomentum {
                   typename TTypes<T>::ConstScalar momentum, bool use_nesterov);
 };
 
+// Same as ApplyMomentum, for several variables updated with the same
+// hyperparameters. The GPU specialization updates all of them in one kernel
+// launch.
+template <typename Device, typename T>
+struct MultiApplyMomentum {
+  void operator()(const Device& d,
+                  const std::vector<typename TTypes<T>::Flat>& var,
+                  const std::vector<typename TTypes<T>::Flat>& accum,
+                  typename TTypes<T>::ConstScalar lr,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grad,
+                  typename TTypes<T>::ConstScalar momentum, bool use_nesterov);
+};
+
 template <typename Device, typename T>
 struct ApplyKerasMomentum {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
@@ -196,6 +211,25 @@ struct ApplyAdam {
                   typename TTypes<T>::ConstFlat grad, bool use_nesterov);
 };
 
+// Same as ApplyAdam, for several variables updated with the same
+// hyperparameters. The GPU specialization updates all of them in one kernel
+// launch.
+template <typename Device, typename T>
+struct MultiApplyAdam {
+  void operator()(const Device& d,
+                  const std::vector<typename TTypes<T>::Flat>& var,
+                  const std::vector<typename TTypes<T>::Flat>& m,
+                  const std::vector<typename TTypes<T>::Flat>& v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grad,
+                  bool use_nesterov);
+};
+
 template <typename Device, typename T>
 struct ApplyAdamWithAmsgrad {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
@@ -17,6 +17,9 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <array>
+#include <vector>
+
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/training_ops.h"
 #include "tensorflow/core/util/gpu_kernel_helper.h"
@@ -519,6 +522,200 @@ struct ApplyAdam<GPUDevice, T> {
   }
 };
 
+// The multi-tensor kernels below update many variables in one launch. Each
+// block updates a chunk of kMultiTensorChunkSize elements of one variable, and
+// the pointers to the variables as well as the block to chunk mapping are
+// passed by value in the kernel arguments, which are limited to 4KB. When a
+// launch runs out of variable or block slots, the remaining variables go to
+// the next launch.
+constexpr int kMultiTensorMaxTensors = 24;
+constexpr int kMultiTensorMaxBlocks = 320;
+constexpr int64 kMultiTensorChunkSize = 65536;
+constexpr int kMultiTensorThreadsPerBlock = 512;
+
+template <typename T, int kNumLists>
+struct MultiTensorArgs {
+  T* ptrs[kNumLists][kMultiTensorMaxTensors];
+  int64 sizes[kMultiTensorMaxTensors];
+  uint8 block_to_tensor[kMultiTensorMaxBlocks];
+  int32 block_to_chunk[kMultiTensorMaxBlocks];
+};
+
+// Calls `launch(args, num_blocks)` as many times as needed to cover the
+// elements of all the `tensors`, where tensors[i] holds the pointers to the
+// kNumLists tensors of the i-th variable, which have sizes[i] elements each.
+template <typename T, int kNumLists, typename LaunchFn>
+Status MultiTensorApply(const std::vector<std::array<T*, kNumLists>>& tensors,
+                        const std::vector<int64>& sizes, LaunchFn launch) {
+  MultiTensorArgs<T, kNumLists> args;
+  int num_tensors = 0;
+  int num_blocks = 0;
+  for (size_t t = 0; t < tensors.size(); ++t) {
+    if (sizes[t] == 0) continue;
+    for (int l = 0; l < kNumLists; ++l) {
+      args.ptrs[l][num_tensors] = tensors[t][l];
+    }
+    args.sizes[num_tensors] = sizes[t];
+    ++num_tensors;
+    const int64 num_chunks =
+        (sizes[t] + kMultiTensorChunkSize - 1) / kMultiTensorChunkSize;
+    for (int64 c = 0; c < num_chunks; ++c) {
+      args.block_to_tensor[num_blocks] = num_tensors - 1;
+      args.block_to_chunk[num_blocks] = c;
+      ++num_blocks;
+      const bool last_chunk = c == num_chunks - 1;
+      if (num_blocks < kMultiTensorMaxBlocks &&
+          !(last_chunk && num_tensors == kMultiTensorMaxTensors)) {
+        continue;
+      }
+      TF_RETURN_IF_ERROR(launch(args, num_blocks));
+      num_blocks = 0;
+      if (last_chunk) {
+        num_tensors = 0;
+      } else {
+        // The rest of the current tensor goes to the next launch.
+        for (int l = 0; l < kNumLists; ++l) {
+          args.ptrs[l][0] = args.ptrs[l][num_tensors - 1];
+        }
+        args.sizes[0] = args.sizes[num_tensors - 1];
+        num_tensors = 1;
+      }
+    }
+  }
+  if (num_blocks > 0) {
+    TF_RETURN_IF_ERROR(launch(args, num_blocks));
+  }
+  return Status::OK();
+}
+
+// Half precision updates are computed in float.
+template <typename T>
+struct MultiApplyComputeType {
+  using type = T;
+};
+template <>
+struct MultiApplyComputeType<Eigen::half> {
+  using type = float;
+};
+
+// args.ptrs holds var, m, v and grad.
+template <typename T>
+__global__ __launch_bounds__(kMultiTensorThreadsPerBlock) void
+MultiApplyAdamKernel(MultiTensorArgs<T, 4> args, const T* beta1_power,
+                     const T* beta2_power, const T* lr, const T* beta1,
+                     const T* beta2, const T* epsilon, bool use_nesterov) {
+  using U = typename MultiApplyComputeType<T>::type;
+  const int tensor = args.block_to_tensor[blockIdx.x];
+  const int64 begin = args.block_to_chunk[blockIdx.x] * kMultiTensorChunkSize;
+  const int64 end = min(begin + kMultiTensorChunkSize, args.sizes[tensor]);
+  T* var = args.ptrs[0][tensor];
+  T* m = args.ptrs[1][tensor];
+  T* v = args.ptrs[2][tensor];
+  const T* grad = args.ptrs[3][tensor];
+
+  const U beta1_t = static_cast<U>(*beta1);
+  const U beta2_t = static_cast<U>(*beta2);
+  const U epsilon_t = static_cast<U>(*epsilon);
+  const U alpha = static_cast<U>(*lr) *
+                  sqrt(U(1) - static_cast<U>(*beta2_power)) /
+                  (U(1) - static_cast<U>(*beta1_power));
+  for (int64 i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    const U grad_i = static_cast<U>(grad[i]);
+    U m_i = static_cast<U>(m[i]);
+    U v_i = static_cast<U>(v[i]);
+    m_i += (U(1) - beta1_t) * (grad_i - m_i);
+    v_i += (U(1) - beta2_t) * (grad_i * grad_i - v_i);
+    const U update = use_nesterov ? m_i * beta1_t + (U(1) - beta1_t) * grad_i
+                                  : m_i;
+    var[i] = static_cast<T>(static_cast<U>(var[i]) -
+                            alpha * update / (epsilon_t + sqrt(v_i)));
+    m[i] = static_cast<T>(m_i);
+    v[i] = static_cast<T>(v_i);
+  }
+}
+
+template <typename T>
+struct MultiApplyAdam<GPUDevice, T> {
+  void operator()(const GPUDevice& d,
+                  const std::vector<typename TTypes<T>::Flat>& var,
+                  const std::vector<typename TTypes<T>::Flat>& m,
+                  const std::vector<typename TTypes<T>::Flat>& v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grad,
+                  bool use_nesterov) {
+    std::vector<std::array<T*, 4>> tensors;
+    std::vector<int64> sizes;
+    for (size_t i = 0; i < var.size(); ++i) {
+      tensors.push_back({var[i].data(), m[i].data(), v[i].data(),
+                         const_cast<T*>(grad[i].data())});
+      sizes.push_back(var[i].size());
+    }
+    TF_CHECK_OK(MultiTensorApply<T, 4>(
+        tensors, sizes, [&](const MultiTensorArgs<T, 4>& args, int blocks) {
+          return GpuLaunchKernel(MultiApplyAdamKernel<T>, blocks,
+                                 kMultiTensorThreadsPerBlock, 0, d.stream(),
+                                 args, beta1_power.data(), beta2_power.data(),
+                                 lr.data(), beta1.data(), beta2.data(),
+                                 epsilon.data(), use_nesterov);
+        }));
+  }
+};
+
+// args.ptrs holds var, accum and grad.
+template <typename T>
+__global__ __launch_bounds__(kMultiTensorThreadsPerBlock) void
+MultiApplyMomentumKernel(MultiTensorArgs<T, 3> args, const T* lr,
+                         const T* momentum, bool use_nesterov) {
+  using U = typename MultiApplyComputeType<T>::type;
+  const int tensor = args.block_to_tensor[blockIdx.x];
+  const int64 begin = args.block_to_chunk[blockIdx.x] * kMultiTensorChunkSize;
+  const int64 end = min(begin + kMultiTensorChunkSize, args.sizes[tensor]);
+  T* var = args.ptrs[0][tensor];
+  T* accum = args.ptrs[1][tensor];
+  const T* grad = args.ptrs[2][tensor];
+
+  const U lr_t = static_cast<U>(*lr);
+  const U momentum_t = static_cast<U>(*momentum);
+  for (int64 i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    const U grad_i = static_cast<U>(grad[i]);
+    const U accum_i = static_cast<U>(accum[i]) * momentum_t + grad_i;
+    const U update = use_nesterov ? grad_i * lr_t + accum_i * momentum_t * lr_t
+                                  : accum_i * lr_t;
+    var[i] = static_cast<T>(static_cast<U>(var[i]) - update);
+    accum[i] = static_cast<T>(accum_i);
+  }
+}
+
+template <typename T>
+struct MultiApplyMomentum<GPUDevice, T> {
+  void operator()(const GPUDevice& d,
+                  const std::vector<typename TTypes<T>::Flat>& var,
+                  const std::vector<typename TTypes<T>::Flat>& accum,
+                  typename TTypes<T>::ConstScalar lr,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grad,
+                  typename TTypes<T>::ConstScalar momentum, bool use_nesterov) {
+    std::vector<std::array<T*, 3>> tensors;
+    std::vector<int64> sizes;
+    for (size_t i = 0; i < var.size(); ++i) {
+      tensors.push_back(
+          {var[i].data(), accum[i].data(), const_cast<T*>(grad[i].data())});
+      sizes.push_back(var[i].size());
+    }
+    TF_CHECK_OK(MultiTensorApply<T, 3>(
+        tensors, sizes, [&](const MultiTensorArgs<T, 3>& args, int blocks) {
+          return GpuLaunchKernel(MultiApplyMomentumKernel<T>, blocks,
+                                 kMultiTensorThreadsPerBlock, 0, d.stream(),
+                                 args, lr.data(), momentum.data(),
+                                 use_nesterov);
+        }));
+  }
+};
+
 template <typename T>
 struct ApplyAdamWithAmsgrad<GPUDevice, T> {
   void operator()(const GPUDevice& d, typename TTypes<T>::Flat var,
@@ -763,6 +960,14 @@ template struct functor::ApplyAdam<GPUDevice, Eigen::half>;
 template struct functor::ApplyAdam<GPUDevice, float>;
 template struct functor::ApplyAdam<GPUDevice, double>;
 
+template struct functor::MultiApplyAdam<GPUDevice, Eigen::half>;
+template struct functor::MultiApplyAdam<GPUDevice, float>;
+template struct functor::MultiApplyAdam<GPUDevice, double>;
+
+template struct functor::MultiApplyMomentum<GPUDevice, Eigen::half>;
+template struct functor::MultiApplyMomentum<GPUDevice, float>;
+template struct functor::MultiApplyMomentum<GPUDevice, double>;
+
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, Eigen::half>;
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, float>;
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, double>;
@@ -15,7 +15,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -65,12 +67,141 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Tiles of kTransposeTileSize x kTransposeTileSize elements are transposed
+// at once, so that both the reads and the writes of a tile use whole cache
+// lines.
+constexpr int64 kTransposeTileSize = 16;
+
+// Transposes the rows x cols matrix at `in` into `out`. The full tiles have
+// constant bounds, so the compiler unrolls and vectorizes them.
+template <typename T>
+void TransposeTile(const T* in, int64 in_stride, T* out, int64 out_stride,
+                   int64 rows, int64 cols) {
+  if (rows == kTransposeTileSize && cols == kTransposeTileSize) {
+    for (int64 c = 0; c < kTransposeTileSize; ++c) {
+      for (int64 r = 0; r < kTransposeTileSize; ++r) {
+        out[c * out_stride + r] = in[r * in_stride + c];
+      }
+    }
+    return;
+  }
+  for (int64 c = 0; c < cols; ++c) {
+    for (int64 r = 0; r < rows; ++r) {
+      out[c * out_stride + r] = in[r * in_stride + c];
+    }
+  }
+}
+
+// Transposes by tiles when the innermost dimension moves, which is the case
+// of the NHWC <-> NCHW layout conversions. The singleton dimensions are
+// dropped and the dimensions that stay adjacent are merged first, so that any
+// such permutation is a batch of 2-D transposes, of the input dimension that
+// becomes innermost by the innermost input dimension. The batch and the tile
+// rows are sharded over the device threads.
+//
+// Returns false, without writing `out`, if the innermost dimension does not
+// move or the matrices are narrower than a tile; the Eigen shuffle is the
+// better choice for those.
+template <typename T>
+bool TransposeTiled(const CPUDevice& device, const Tensor& in,
+                    const gtl::ArraySlice<int32> perm, Tensor* out) {
+  TensorShape squeezed_shape;
+  internal::TransposePermsVec squeezed_dim(in.dims(), -1);
+  for (int i = 0; i < in.dims(); ++i) {
+    if (in.dim_size(i) != 1) {
+      squeezed_dim[i] = squeezed_shape.dims();
+      squeezed_shape.AddDim(in.dim_size(i));
+    }
+  }
+  if (squeezed_shape.dims() < 2) return false;
+  internal::TransposePermsVec squeezed_perm;
+  for (int32 d : perm) {
+    if (squeezed_dim[d] >= 0) squeezed_perm.push_back(squeezed_dim[d]);
+  }
+  internal::TransposePermsVec new_perm;
+  internal::TransposeDimsVec dims;
+  internal::ReduceTransposeDimensions(squeezed_shape, squeezed_perm, &new_perm,
+                                      &dims);
+  const int ndims = dims.size();
+  if (ndims < 2 || new_perm[ndims - 1] == ndims - 1) return false;
+
+  // The innermost output dimension is input dimension `row_dim`, and the
+  // innermost input dimension is output dimension `col_out_dim`.
+  const int row_dim = new_perm[ndims - 1];
+  int col_out_dim = 0;
+  while (new_perm[col_out_dim] != ndims - 1) ++col_out_dim;
+  const int64 rows = dims[row_dim];
+  const int64 cols = dims[ndims - 1];
+  if (rows < kTransposeTileSize || cols < kTransposeTileSize) return false;
+
+  internal::TransposeDimsVec in_strides(ndims), out_dims(ndims),
+      out_strides(ndims);
+  in_strides[ndims - 1] = 1;
+  for (int i = ndims - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * dims[i + 1];
+  }
+  for (int i = 0; i < ndims; ++i) out_dims[i] = dims[new_perm[i]];
+  out_strides[ndims - 1] = 1;
+  for (int i = ndims - 2; i >= 0; --i) {
+    out_strides[i] = out_strides[i + 1] * out_dims[i + 1];
+  }
+  const int64 in_row_stride = in_strides[row_dim];
+  const int64 out_row_stride = out_strides[col_out_dim];
+  // The output dimensions other than the two tiled ones form the batch.
+  internal::TransposePermsVec batch_dims;
+  int64 batch_size = 1;
+  for (int i = 0; i < ndims - 1; ++i) {
+    if (i != col_out_dim) {
+      batch_dims.push_back(i);
+      batch_size *= out_dims[i];
+    }
+  }
+
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+  const int64 row_tiles = (rows + kTransposeTileSize - 1) / kTransposeTileSize;
+  // Each unit of work is one row of tiles of one matrix of the batch.
+  auto transpose_fn = [&](int64 begin, int64 end) {
+    for (int64 unit = begin; unit < end; ++unit) {
+      int64 batch_index = unit / row_tiles;
+      const int64 row = (unit % row_tiles) * kTransposeTileSize;
+      int64 in_offset = 0;
+      int64 out_offset = 0;
+      for (int k = static_cast<int>(batch_dims.size()) - 1; k >= 0; --k) {
+        const int i = batch_dims[k];
+        const int64 index = batch_index % out_dims[i];
+        batch_index /= out_dims[i];
+        in_offset += index * in_strides[new_perm[i]];
+        out_offset += index * out_strides[i];
+      }
+      const int64 tile_rows = std::min(kTransposeTileSize, rows - row);
+      for (int64 col = 0; col < cols; col += kTransposeTileSize) {
+        TransposeTile(p + in_offset + row * in_row_stride + col,
+                      in_row_stride,
+                      q + out_offset + col * out_row_stride + row,
+                      out_row_stride, tile_rows,
+                      std::min(kTransposeTileSize, cols - col));
+      }
+    }
+  };
+  const int64 elements_per_unit = kTransposeTileSize * cols;
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/elements_per_unit * sizeof(T),
+                           /*bytes_stored=*/elements_per_unit * sizeof(T),
+                           /*compute_cycles=*/elements_per_unit);
+  device.parallelFor(batch_size * row_tiles, cost, std::move(transpose_fn));
+  return true;
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (!conjugate && !std::is_same<T, tstring>::value &&
+        TransposeTiled<T>(d, in, perm, out)) {
+      return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
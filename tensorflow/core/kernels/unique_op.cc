@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,11 +28,234 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// Vectors of integers with at least this many elements are deduplicated in
+// parallel.
+constexpr int64 kParallelUniqueMinSize = 128 * 1024;
+// The elements are split by hash in partitions of about this size, so that
+// the hash table of each partition stays in the L2 cache.
+constexpr int64 kUniquePartitionSize = 32 * 1024;
+constexpr int kMaxUniquePartitionBits = 12;
+
+// Scrambles all the bits of an integer key: the high bits select the
+// partition and the low bits the slot in its table.
+inline uint64 HashUniqueKey(uint64 x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+// Computes the outputs of Unique over the vector `input`, and the counts
+// output of UniqueWithCounts if `with_counts`, on the intra-op threads:
+//
+// 1. Each block of the input counts its elements per hash partition, and
+//    the elements are scattered by partition, keeping their input order.
+// 2. Each partition is deduplicated with an open addressing table, which
+//    finds the first occurrence of each element and counts them.
+// 3. A prefix sum over the first occurrences gives the position of each
+//    unique element in the output, so that, as in the serial version, the
+//    output is in order of first occurrence.
+template <typename T, typename TIndex>
+void ParallelUnique(OpKernelContext* context, const Tensor& input,
+                    typename TTypes<TIndex>::Vec idx_vec, bool with_counts) {
+  auto Tin = input.flat<T>();
+  const int64 N = Tin.size();
+  const auto* worker_threads =
+      context->device()->tensorflow_cpu_worker_threads();
+  auto parallel_for = [worker_threads](
+                          int64 total, int64 cost_per_unit,
+                          const std::function<void(int64, int64)>& work) {
+    Shard(worker_threads->num_threads, worker_threads->workers, total,
+          cost_per_unit, work);
+  };
+
+  int partition_bits = 0;
+  while (partition_bits < kMaxUniquePartitionBits &&
+         ((int64{1} << partition_bits) < worker_threads->num_threads ||
+          (N >> partition_bits) > kUniquePartitionSize)) {
+    ++partition_bits;
+  }
+  const int64 num_partitions = int64{1} << partition_bits;
+  auto partition_of = [partition_bits](T key) -> int64 {
+    if (partition_bits == 0) return 0;
+    return HashUniqueKey(static_cast<uint64>(key)) >> (64 - partition_bits);
+  };
+  const int64 num_blocks = worker_threads->num_threads;
+  const int64 block_size = (N + num_blocks - 1) / num_blocks;
+  const int64 block_cost = block_size * 10;
+
+  // rank[i] is -1, or 0 if i is the first occurrence of its element, until
+  // it is replaced by the position of the element in the output.
+  std::unique_ptr<int32[]> rank(new int32[N]);
+  std::vector<int64> offsets(num_blocks * num_partitions, 0);
+  parallel_for(num_blocks, block_cost, [&](int64 begin, int64 end) {
+    for (int64 b = begin; b < end; ++b) {
+      int64* counts = &offsets[b * num_partitions];
+      for (int64 i = b * block_size; i < std::min(N, (b + 1) * block_size);
+           ++i) {
+        ++counts[partition_of(Tin(i))];
+        rank[i] = -1;
+      }
+    }
+  });
+  std::vector<int64> partition_starts(num_partitions + 1);
+  int64 offset = 0;
+  for (int64 p = 0; p < num_partitions; ++p) {
+    partition_starts[p] = offset;
+    for (int64 b = 0; b < num_blocks; ++b) {
+      const int64 count = offsets[b * num_partitions + p];
+      offsets[b * num_partitions + p] = offset;
+      offset += count;
+    }
+  }
+  partition_starts[num_partitions] = N;
+
+  std::unique_ptr<T[]> keys(new T[N]);
+  std::unique_ptr<int32[]> positions(new int32[N]);
+  parallel_for(num_blocks, block_cost, [&](int64 begin, int64 end) {
+    for (int64 b = begin; b < end; ++b) {
+      int64* block_offsets = &offsets[b * num_partitions];
+      for (int64 i = b * block_size; i < std::min(N, (b + 1) * block_size);
+           ++i) {
+        const int64 j = block_offsets[partition_of(Tin(i))]++;
+        keys[j] = Tin(i);
+        positions[j] = static_cast<int32>(i);
+      }
+    }
+  });
+
+  // The first occurrence and the count of each unique element of each
+  // partition. idx_vec(i) temporarily holds the first occurrence of Tin(i).
+  std::vector<std::vector<int32>> first_positions(num_partitions);
+  std::vector<std::vector<int32>> unique_counts(num_partitions);
+  parallel_for(
+      num_partitions, N / num_partitions * 50, [&](int64 begin, int64 end) {
+        std::vector<T> slot_keys;
+        std::vector<int32> slot_ids;
+        for (int64 p = begin; p < end; ++p) {
+          const int64 start = partition_starts[p];
+          const int64 limit = partition_starts[p + 1];
+          int64 capacity = 16;
+          while (capacity < 2 * (limit - start)) capacity *= 2;
+          const uint64 mask = capacity - 1;
+          slot_keys.resize(capacity);
+          slot_ids.assign(capacity, -1);
+          std::vector<int32>& firsts = first_positions[p];
+          std::vector<int32>& counts = unique_counts[p];
+          for (int64 j = start; j < limit; ++j) {
+            const T key = keys[j];
+            const int32 pos = positions[j];
+            uint64 slot = HashUniqueKey(static_cast<uint64>(key)) & mask;
+            while (slot_ids[slot] >= 0 && slot_keys[slot] != key) {
+              slot = (slot + 1) & mask;
+            }
+            int32 id = slot_ids[slot];
+            if (id < 0) {
+              id = static_cast<int32>(firsts.size());
+              slot_ids[slot] = id;
+              slot_keys[slot] = key;
+              firsts.push_back(pos);
+              if (with_counts) counts.push_back(0);
+              rank[pos] = 0;
+            }
+            idx_vec(pos) = firsts[id];
+            if (with_counts) ++counts[id];
+          }
+        }
+      });
+
+  std::vector<int64> block_starts(num_blocks + 1, 0);
+  parallel_for(num_blocks, block_cost, [&](int64 begin, int64 end) {
+    for (int64 b = begin; b < end; ++b) {
+      int64 count = 0;
+      for (int64 i = b * block_size; i < std::min(N, (b + 1) * block_size);
+           ++i) {
+        count += rank[i] >= 0;
+      }
+      block_starts[b + 1] = count;
+    }
+  });
+  for (int64 b = 0; b < num_blocks; ++b) {
+    block_starts[b + 1] += block_starts[b];
+  }
+  const int64 uniq_size = block_starts[num_blocks];
+
+  Tensor* output = nullptr;
+  OP_REQUIRES_OK(context, context->allocate_output(
+                              0, TensorShape({uniq_size}), &output));
+  auto Tout = output->flat<T>();
+  parallel_for(num_blocks, block_cost, [&](int64 begin, int64 end) {
+    for (int64 b = begin; b < end; ++b) {
+      int32 next = static_cast<int32>(block_starts[b]);
+      for (int64 i = b * block_size; i < std::min(N, (b + 1) * block_size);
+           ++i) {
+        if (rank[i] >= 0) {
+          rank[i] = next;
+          Tout(next) = Tin(i);
+          ++next;
+        }
+      }
+    }
+  });
+  parallel_for(N, 5, [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      idx_vec(i) = rank[idx_vec(i)];
+    }
+  });
+
+  if (with_counts) {
+    Tensor* count_output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                2, TensorShape({uniq_size}), &count_output));
+    auto count_output_vec = count_output->template vec<TIndex>();
+    parallel_for(num_partitions, N / num_partitions,
+                 [&](int64 begin, int64 end) {
+                   for (int64 p = begin; p < end; ++p) {
+                     const std::vector<int32>& firsts = first_positions[p];
+                     for (size_t k = 0; k < firsts.size(); ++k) {
+                       count_output_vec(rank[firsts[k]]) =
+                           unique_counts[p][k];
+                     }
+                   }
+                 });
+  }
+}
+
+// Runs ParallelUnique() and returns true if the input is a large enough
+// vector of integers, and there is more than one intra-op thread.
+template <typename T, typename TIndex>
+typename std::enable_if<
+    std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type
+MaybeParallelUnique(OpKernelContext* context, const Tensor& input,
+                    typename TTypes<TIndex>::Vec idx_vec, bool with_counts) {
+  if (input.dims() != 1 || input.NumElements() < kParallelUniqueMinSize ||
+      context->device()->tensorflow_cpu_worker_threads()->num_threads < 2) {
+    return false;
+  }
+  ParallelUnique<T, TIndex>(context, input, idx_vec, with_counts);
+  return true;
+}
+
+template <typename T, typename TIndex>
+typename std::enable_if<
+    !std::is_integral<T>::value || std::is_same<T, bool>::value, bool>::type
+MaybeParallelUnique(OpKernelContext* context, const Tensor& input,
+                    typename TTypes<TIndex>::Vec idx_vec, bool with_counts) {
+  return false;
+}
+
+}  // namespace
+
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
@@ -98,6 +325,11 @@ class UniqueOp : public OpKernel {
                                 1, TensorShape({new_sizes[1]}), &idx));
     auto idx_vec = idx->template vec<TIndex>();
 
+    if (MaybeParallelUnique<T, TIndex>(context, input, idx_vec,
+                                       num_outputs() > 2)) {
+      return;
+    }
+
     int64 uniq_size;
     if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
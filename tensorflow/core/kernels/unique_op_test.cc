@@ -15,11 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
@@ -35,6 +40,63 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& op, DataType type) {
+    TF_ASSERT_OK(NodeDefBuilder("unique", op)
+                     .Input(FakeInput(type))
+                     .Attr("out_idx", DT_INT32)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(UniqueOpTest, SmallVector) {
+  MakeOp("UniqueWithCounts", DT_INT64);
+  AddInputFromArray<int64>(TensorShape({7}), {4, 2, 4, -1, 2, 4, 7});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64>(*GetOutput(0),
+                                 test::AsTensor<int64>({4, 2, -1, 7}));
+  test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                 test::AsTensor<int32>({0, 1, 0, 2, 1, 0, 3}));
+  test::ExpectTensorEqual<int32>(*GetOutput(2),
+                                 test::AsTensor<int32>({3, 2, 1, 1}));
+}
+
+// Large enough to be deduplicated on the intra-op threads. The output must
+// still be in order of first occurrence.
+TEST_F(UniqueOpTest, LargeVector) {
+  MakeOp("UniqueWithCounts", DT_INT64);
+  const int n = 1 << 20;
+  std::vector<int64> values(n);
+  for (int i = 0; i < n; ++i) {
+    values[i] = (static_cast<int64>(std::rand()) % 50000) * (1LL << 20) - i % 3;
+  }
+  AddInputFromArray<int64>(TensorShape({n}), values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::unordered_map<int64, int32> ids;
+  std::vector<int64> expected_values;
+  std::vector<int32> expected_idx(n);
+  std::vector<int32> expected_counts;
+  for (int i = 0; i < n; ++i) {
+    auto it = ids.insert({values[i], static_cast<int32>(ids.size())});
+    if (it.second) {
+      expected_values.push_back(values[i]);
+      expected_counts.push_back(0);
+    }
+    expected_idx[i] = it.first->second;
+    ++expected_counts[it.first->second];
+  }
+  const int64 num_unique = expected_values.size();
+  test::ExpectTensorEqual<int64>(
+      *GetOutput(0), test::AsTensor<int64>(expected_values, {num_unique}));
+  test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                 test::AsTensor<int32>(expected_idx, {n}));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(2), test::AsTensor<int32>(expected_counts, {num_unique}));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
@@ -81,6 +143,37 @@ static void BM_Unique_INT32(int iters, int dim, int max_int) {
   test::Benchmark("cpu", g).Run(iters);
 }
 
+TensorProto GetRandomInt64TensorProto(int dim, int64 max_int) {
+  TensorProto tensor_proto;
+  tensor_proto.set_dtype(DT_INT64);
+  tensor_proto.mutable_tensor_shape()->add_dim()->set_size(dim);
+  tensor_proto.mutable_tensor_shape()->set_unknown_rank(false);
+  for (int i = 0; i < dim; ++i) {
+    const int64 int_val = static_cast<int64>(std::rand()) % max_int;
+    tensor_proto.add_int64_val(int_val);
+  }
+  return tensor_proto;
+}
+
+static void BM_Unique_INT64(int iters, int dim, int max_int) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT64, TensorShape({dim}));
+  CHECK(input.FromProto(GetRandomInt64TensorProto(dim, max_int)));
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UniqueWithCounts")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+
+  testing::BytesProcessed(static_cast<int64>(iters) * dim * sizeof(int64));
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
 static void BM_Unique_INT32_Repeat(int iters, int dim, int max_int) {
   testing::StopTiming();
   Graph* g = new Graph(OpRegistry::Global());
@@ -180,6 +273,12 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+BENCHMARK(BM_Unique_INT64)
+    ->ArgPair(64 * 1024, 1024 * 1024)
+    ->ArgPair(1024 * 1024, 1024 * 1024)
+    ->ArgPair(10 * 1024 * 1024, 1024 * 1024)
+    ->ArgPair(10 * 1024 * 1024, 64 * 1024 * 1024);
+
 BENCHMARK(BM_Unique_STRING)
     ->Arg(32)
     ->Arg(256)
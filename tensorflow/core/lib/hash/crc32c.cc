@@ -263,6 +263,61 @@ uint32 Extend(uint32 crc, const char *buf, size_t size) {
   return l ^ 0xffffffffu;
 }
 
+// Multiplies the 32x32 GF(2) matrix "mat" by the vector "vec".
+static uint32 Gf2MatrixTimes(const uint32 *mat, uint32 vec) {
+  uint32 sum = 0;
+  while (vec) {
+    if (vec & 1) {
+      sum ^= *mat;
+    }
+    vec >>= 1;
+    mat++;
+  }
+  return sum;
+}
+
+static void Gf2MatrixSquare(uint32 *square, const uint32 *mat) {
+  for (int n = 0; n < 32; n++) {
+    square[n] = Gf2MatrixTimes(mat, mat[n]);
+  }
+}
+
+uint32 Combine(uint32 crc_a, uint32 crc_b, size_t len_b) {
+  if (len_b == 0) {
+    return crc_a;
+  }
+  // Appending len_b zero bytes to A is a linear operator on crc_a, computed
+  // by repeated squaring of the operator for one zero bit (as in zlib's
+  // crc32_combine).
+  uint32 even[32];  // Operator for 2^(2k) zero bits.
+  uint32 odd[32];   // Operator for 2^(2k+1) zero bits.
+  odd[0] = 0x82f63b78u;  // The reflected crc32c polynomial.
+  uint32 row = 1;
+  for (int n = 1; n < 32; n++) {
+    odd[n] = row;
+    row <<= 1;
+  }
+  Gf2MatrixSquare(even, odd);  // 2 zero bits.
+  Gf2MatrixSquare(odd, even);  // 4 zero bits.
+  do {
+    // The first squaring gives the operator for one zero byte.
+    Gf2MatrixSquare(even, odd);
+    if (len_b & 1) {
+      crc_a = Gf2MatrixTimes(even, crc_a);
+    }
+    len_b >>= 1;
+    if (len_b == 0) {
+      break;
+    }
+    Gf2MatrixSquare(odd, even);
+    if (len_b & 1) {
+      crc_a = Gf2MatrixTimes(odd, crc_a);
+    }
+    len_b >>= 1;
+  } while (len_b != 0);
+  return crc_a ^ crc_b;
+}
+
 #if defined(PLATFORM_GOOGLE)
 uint32 Extend(uint32 crc, const absl::Cord &cord) {
   absl::CordReader reader(cord);
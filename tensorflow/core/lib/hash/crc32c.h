@@ -35,6 +35,11 @@ extern uint32 Extend(uint32 init_crc, const char* data, size_t n);
 // Return the crc32c of data[0,n-1]
 inline uint32 Value(const char* data, size_t n) { return Extend(0, data, n); }
 
+// Return the crc32c of concat(A, B), where crc_a is the crc32c of A and crc_b
+// is the crc32c of B, of length len_b.  Combine() lets the checksum of a
+// buffer be computed in parallel over its chunks.
+extern uint32 Combine(uint32 crc_a, uint32 crc_b, size_t len_b);
+
 #if defined(PLATFORM_GOOGLE)
 extern uint32 Extend(uint32 init_crc, const absl::Cord& cord);
 inline uint32 Value(const absl::Cord& cord) { return Extend(0, cord); }
@@ -62,6 +62,24 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, Combine) {
+  ASSERT_EQ(Value("hello world", 11),
+            Combine(Value("hello ", 6), Value("world", 5), 5));
+  ASSERT_EQ(Value("foo", 3), Combine(Value("foo", 3), Value("", 0), 0));
+  ASSERT_EQ(Value("foo", 3), Combine(Value("", 0), Value("foo", 3), 3));
+
+  std::string input(100000, 'x');
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = static_cast<char>(i * 7);
+  }
+  for (size_t split : {1, 3, 4096, 50001, 99999}) {
+    ASSERT_EQ(Value(input.data(), input.size()),
+              Combine(Value(input.data(), split),
+                      Value(input.data() + split, input.size() - split),
+                      input.size() - split));
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 
+#include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 
 namespace tensorflow {
@@ -100,6 +101,21 @@ Status BufferedInputStream::ReadNBytes(int64 bytes_to_read, string* result) {
   while (result->size() < static_cast<size_t>(bytes_to_read)) {
     // Check whether the buffer is fully read or not.
     if (pos_ == limit_) {
+      const int64 bytes_remaining = bytes_to_read - result->size();
+      if (static_cast<size_t>(bytes_remaining) >= size_) {
+        // Reads of at least a full buffer bypass the buffer, so that large
+        // records are copied from the file straight into `result`.
+        const size_t offset = result->size();
+        gtl::STLStringResizeUninitialized(result, bytes_to_read);
+        int64 bytes_read = 0;
+        s = input_stream_->ReadNBytesInto(bytes_remaining, &(*result)[offset],
+                                          &bytes_read);
+        result->resize(offset + bytes_read);
+        if (!s.ok()) {
+          file_status_ = s;
+        }
+        break;
+      }
       s = FillBuffer();
       // If we didn't read any bytes, we're at the end of the file; break out.
       if (limit_ == 0) {
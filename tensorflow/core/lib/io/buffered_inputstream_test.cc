@@ -190,6 +190,34 @@ TEST(BufferedInputStream, ReadNBytes) {
   }
 }
 
+TEST(BufferedInputStream, ReadNBytesLargerThanBuffer) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/buffer_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  std::unique_ptr<RandomAccessInputStream> input_stream(
+      new RandomAccessInputStream(file.get()));
+  string read;
+  BufferedInputStream in(input_stream.get(), 4);
+  TF_ASSERT_OK(in.ReadNBytes(1, &read));
+  EXPECT_EQ(read, "0");
+  // The first three bytes come from the buffer, the rest bypasses it.
+  TF_ASSERT_OK(in.ReadNBytes(8, &read));
+  EXPECT_EQ(read, "12345678");
+  EXPECT_EQ(9, in.Tell());
+  TF_ASSERT_OK(in.ReadNBytes(1, &read));
+  EXPECT_EQ(read, "9");
+  EXPECT_EQ(10, in.Tell());
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+  EXPECT_EQ(read, "0123456789");
+  EXPECT_EQ(10, in.Tell());
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+  EXPECT_EQ(read, "");
+}
+
 TEST(BufferedInputStream, SkipNBytes) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/buffered_inputstream_test";
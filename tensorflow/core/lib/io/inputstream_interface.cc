@@ -24,6 +24,15 @@ namespace io {
 // 8MB at a time.
 static constexpr int64 kMaxSkipSize = 8 * 1024 * 1024;
 
+Status InputStreamInterface::ReadNBytesInto(int64 bytes_to_read, char* dest,
+                                            int64* bytes_read) {
+  string data;
+  Status s = ReadNBytes(bytes_to_read, &data);
+  memcpy(dest, data.data(), data.size());
+  *bytes_read = data.size();
+  return s;
+}
+
 Status InputStreamInterface::SkipNBytes(int64 bytes_to_skip) {
   if (bytes_to_skip < 0) {
     return errors::InvalidArgument("Can't skip a negative number of bytes");
@@ -47,6 +47,15 @@ class InputStreamInterface {
   }
 #endif
 
+  // Reads the next bytes_to_read from the file into `dest`, which must have
+  // room for them, and sets `*bytes_read` to the number of bytes read. Streams
+  // that can read directly into caller-owned memory override this to avoid a
+  // copy. Typical return codes:
+  //  * OK - in case of success.
+  //  * OUT_OF_RANGE - not enough bytes remaining before end of file.
+  virtual Status ReadNBytesInto(int64 bytes_to_read, char* dest,
+                                int64* bytes_read);
+
   // Skips bytes_to_skip before next ReadNBytes. bytes_to_skip should be >= 0.
   // Typical return codes:
   //  * OK - in case of success.
@@ -49,6 +49,23 @@ Status RandomAccessInputStream::ReadNBytes(int64 bytes_to_read,
   return s;
 }
 
+Status RandomAccessInputStream::ReadNBytesInto(int64 bytes_to_read, char* dest,
+                                               int64* bytes_read) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  StringPiece data;
+  Status s = file_->Read(pos_, bytes_to_read, &data, dest);
+  if (data.data() != dest) {
+    memmove(dest, data.data(), data.size());
+  }
+  *bytes_read = data.size();
+  if (s.ok() || errors::IsOutOfRange(s)) {
+    pos_ += data.size();
+  }
+  return s;
+}
+
 #if defined(PLATFORM_GOOGLE)
 Status RandomAccessInputStream::ReadNBytes(int64 bytes_to_read,
                                            absl::Cord* result) {
@@ -39,6 +39,9 @@ class RandomAccessInputStream : public InputStreamInterface {
   Status ReadNBytes(int64 bytes_to_read, absl::Cord* result) override;
 #endif
 
+  Status ReadNBytesInto(int64 bytes_to_read, char* dest,
+                        int64* bytes_read) override;
+
   Status SkipNBytes(int64 bytes_to_skip) override;
 
   int64 Tell() const override;
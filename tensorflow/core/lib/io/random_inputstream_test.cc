@@ -52,6 +52,24 @@ TEST(RandomInputStream, ReadNBytes) {
   EXPECT_EQ(10, in.Tell());
 }
 
+TEST(RandomInputStream, ReadNBytesInto) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/random_inputbuffer_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+  char buffer[20];
+  int64 bytes_read;
+  RandomAccessInputStream in(file.get());
+  TF_ASSERT_OK(in.ReadNBytesInto(3, buffer, &bytes_read));
+  EXPECT_EQ(StringPiece(buffer, bytes_read), "012");
+  EXPECT_EQ(3, in.Tell());
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytesInto(20, buffer, &bytes_read)));
+  EXPECT_EQ(StringPiece(buffer, bytes_read), "3456789");
+  EXPECT_EQ(10, in.Tell());
+}
+
 TEST(RandomInputStream, SkipNBytes) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/random_inputbuffer_test";
@@ -0,0 +1,169 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+// A single read of up to `buffer_size_` bytes. `data` and `status` are written
+// by the thread that performs the read, and may only be accessed by the
+// stream once `done` is set.
+struct ReadaheadInputStream::Chunk {
+  explicit Chunk(int64 offset) : offset(offset) {}
+
+  const int64 offset;
+  string data;
+  Status status;
+  bool done = false;  // Guarded by the stream's `mu_`.
+};
+
+ReadaheadInputStream::ReadaheadInputStream(RandomAccessFile* file,
+                                           int64 buffer_size, int num_buffers,
+                                           thread::ThreadPool* thread_pool)
+    : file_(file),
+      buffer_size_(buffer_size),
+      num_buffers_(num_buffers),
+      thread_pool_(thread_pool) {
+  DCHECK_GT(buffer_size_, 0);
+  DCHECK_GT(num_buffers_, 0);
+}
+
+ReadaheadInputStream::~ReadaheadInputStream() { Clear(); }
+
+void ReadaheadInputStream::IssueReads() {
+  while (!reached_eof_ && chunks_.size() < static_cast<size_t>(num_buffers_)) {
+    auto chunk = std::make_shared<Chunk>(next_read_offset_);
+    next_read_offset_ += buffer_size_;
+    chunks_.push_back(chunk);
+    {
+      mutex_lock l(mu_);
+      ++num_outstanding_;
+    }
+    thread_pool_->Schedule([this, chunk]() {
+      StringPiece result;
+      chunk->data.resize(buffer_size_);
+      Status s =
+          file_->Read(chunk->offset, buffer_size_, &result, &chunk->data[0]);
+      if (result.data() != chunk->data.data()) {
+        // Some filesystems return a pointer to their own memory.
+        chunk->data.assign(result.data(), result.size());
+      } else {
+        chunk->data.resize(result.size());
+      }
+      mutex_lock l(mu_);
+      chunk->status = s;
+      chunk->done = true;
+      --num_outstanding_;
+      cond_var_.notify_all();
+    });
+  }
+}
+
+bool ReadaheadInputStream::WaitForFrontChunk() {
+  while (status_.ok()) {
+    IssueReads();
+    if (chunks_.empty()) {
+      status_ = errors::OutOfRange("reached end of file");
+      break;
+    }
+    const Chunk& front = *chunks_.front();
+    {
+      mutex_lock l(mu_);
+      while (!front.done) {
+        cond_var_.wait(l);
+      }
+    }
+    if (front_pos_ < front.data.size()) {
+      return true;
+    }
+    if (!front.status.ok()) {
+      // A read only returns fewer bytes than requested at the end of the file
+      // or on error, so nothing after it is useful.
+      status_ = front.status;
+      Clear();
+      reached_eof_ = true;
+      break;
+    }
+    chunks_.pop_front();
+    front_pos_ = 0;
+  }
+  return false;
+}
+
+Status ReadaheadInputStream::ReadNBytes(int64 bytes_to_read, string* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    if (!WaitForFrontChunk()) {
+      return status_;
+    }
+    const string& data = chunks_.front()->data;
+    const size_t bytes_to_copy = std::min<size_t>(
+        data.size() - front_pos_, bytes_to_read - result->size());
+    result->append(data, front_pos_, bytes_to_copy);
+    front_pos_ += bytes_to_copy;
+    pos_ += bytes_to_copy;
+  }
+  return Status::OK();
+}
+
+Status ReadaheadInputStream::SkipNBytes(int64 bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  while (bytes_to_skip > 0) {
+    if (!WaitForFrontChunk()) {
+      return status_;
+    }
+    const size_t bytes_to_advance = std::min<size_t>(
+        chunks_.front()->data.size() - front_pos_, bytes_to_skip);
+    front_pos_ += bytes_to_advance;
+    pos_ += bytes_to_advance;
+    bytes_to_skip -= bytes_to_advance;
+  }
+  return Status::OK();
+}
+
+Status ReadaheadInputStream::Reset() {
+  Clear();
+  pos_ = 0;
+  next_read_offset_ = 0;
+  front_pos_ = 0;
+  reached_eof_ = false;
+  status_ = Status::OK();
+  return Status::OK();
+}
+
+void ReadaheadInputStream::Clear() {
+  {
+    mutex_lock l(mu_);
+    while (num_outstanding_ > 0) {
+      cond_var_.wait(l);
+    }
+  }
+  chunks_.clear();
+  front_pos_ = 0;
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace io {
+
+// Reads a RandomAccessFile sequentially, keeping up to `num_buffers` reads of
+// `buffer_size` bytes each in flight on `thread_pool`. This hides the latency
+// of individual reads on filesystems where a single synchronous reader cannot
+// saturate the available bandwidth (e.g. NVMe or network filesystems).
+//
+// Reads must be sequential: Reset() is the only way to move backwards. A given
+// instance is NOT safe for concurrent use by multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file` or `thread_pool`, both of which must
+  // outlive *this. `file` must be safe for concurrent reads, as required by
+  // the RandomAccessFile interface.
+  ReadaheadInputStream(RandomAccessFile* file, int64 buffer_size,
+                       int num_buffers, thread::ThreadPool* thread_pool);
+
+  // Waits for the outstanding reads to finish.
+  ~ReadaheadInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  Status SkipNBytes(int64 bytes_to_skip) override;
+
+  int64 Tell() const override { return pos_; }
+
+  Status Reset() override;
+
+ private:
+  struct Chunk;
+
+  // Issues reads until `num_buffers_` are in flight or the end of the file
+  // has been requested.
+  void IssueReads();
+
+  // Blocks until the front chunk has been read, issuing more reads as needed.
+  // Returns false if no more data is available, in which case `status_` holds
+  // the reason.
+  bool WaitForFrontChunk();
+
+  // Drops all chunks, waiting for those that are still being read.
+  void Clear();
+
+  RandomAccessFile* const file_;  // Not owned.
+  const int64 buffer_size_;
+  const int num_buffers_;
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+
+  std::deque<std::shared_ptr<Chunk>> chunks_;
+  int64 pos_ = 0;               // Offset of the next byte to return.
+  int64 next_read_offset_ = 0;  // Offset of the next chunk to read.
+  size_t front_pos_ = 0;        // Bytes of the front chunk already returned.
+  bool reached_eof_ = false;    // Whether the last chunk has been read.
+  Status status_;               // Sticky error, or OutOfRange at the end.
+
+  mutex mu_;
+  condition_variable cond_var_;
+  int num_outstanding_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadaheadInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_READAHEAD_INPUTSTREAM_H_
@@ -0,0 +1,124 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+static std::vector<int> BufferSizes() { return {1, 2, 3, 4, 7, 10, 65536}; }
+
+static std::vector<int> NumBuffers() { return {1, 2, 4}; }
+
+class ReadaheadInputStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Env* env = Env::Default();
+    string fname = testing::TmpDir() + "/readahead_inputstream_test";
+    TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_));
+  }
+
+  thread::ThreadPool thread_pool_{Env::Default(), "test", 4};
+  std::unique_ptr<RandomAccessFile> file_;
+};
+
+TEST_F(ReadaheadInputStreamTest, ReadNBytes) {
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadaheadInputStream in(file_.get(), buf_size, num_buffers,
+                              &thread_pool_);
+      string read;
+      TF_ASSERT_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "012");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(5, &read));
+      EXPECT_EQ(read, "34567");
+      EXPECT_EQ(8, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+      EXPECT_EQ(read, "89");
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+      EXPECT_EQ(read, "");
+      EXPECT_EQ(10, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(0, &read));
+      EXPECT_EQ(read, "");
+    }
+  }
+}
+
+TEST_F(ReadaheadInputStreamTest, SkipNBytes) {
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadaheadInputStream in(file_.get(), buf_size, num_buffers,
+                              &thread_pool_);
+      string read;
+      TF_ASSERT_OK(in.SkipNBytes(3));
+      EXPECT_EQ(3, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(4, &read));
+      EXPECT_EQ(read, "3456");
+      EXPECT_EQ(7, in.Tell());
+      TF_ASSERT_OK(in.SkipNBytes(0));
+      EXPECT_EQ(7, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(2, &read));
+      EXPECT_EQ(read, "78");
+      EXPECT_EQ(9, in.Tell());
+      EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(20)));
+      EXPECT_EQ(10, in.Tell());
+      EXPECT_TRUE(errors::IsInvalidArgument(in.SkipNBytes(-1)));
+    }
+  }
+}
+
+TEST_F(ReadaheadInputStreamTest, Reset) {
+  for (auto buf_size : BufferSizes()) {
+    for (auto num_buffers : NumBuffers()) {
+      ReadaheadInputStream in(file_.get(), buf_size, num_buffers,
+                              &thread_pool_);
+      string read;
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+      EXPECT_EQ(read, "0123456789");
+      TF_ASSERT_OK(in.Reset());
+      EXPECT_EQ(0, in.Tell());
+      TF_ASSERT_OK(in.ReadNBytes(4, &read));
+      EXPECT_EQ(read, "0123");
+      TF_ASSERT_OK(in.Reset());
+      TF_ASSERT_OK(in.ReadNBytes(10, &read));
+      EXPECT_EQ(read, "0123456789");
+    }
+  }
+}
+
+TEST_F(ReadaheadInputStreamTest, DestroyWhileReadsAreInFlight) {
+  for (auto buf_size : BufferSizes()) {
+    ReadaheadInputStream in(file_.get(), buf_size, /*num_buffers=*/4,
+                            &thread_pool_);
+    string read;
+    TF_ASSERT_OK(in.ReadNBytes(1, &read));
+    EXPECT_EQ(read, "0");
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
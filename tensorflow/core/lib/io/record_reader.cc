@@ -17,12 +17,17 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -54,12 +59,30 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
   return options;
 }
 
+namespace {
+
+// Returns the thread pool that performs the reads of all readers that use
+// readahead. The reads block on I/O rather than use the CPU, so the pool is
+// sized for the number of reads in flight rather than the number of cores.
+thread::ThreadPool* ReadaheadThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "record_reader_readahead",
+      std::max(64, port::NumSchedulableCPUs()));
+  return thread_pool;
+}
+
+}  // namespace
+
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.buffer_size > 0 && options.readahead_num_buffers > 0) {
+    input_stream_.reset(new ReadaheadInputStream(
+        file, options.buffer_size, options.readahead_num_buffers,
+        ReadaheadThreadPool()));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -161,10 +184,50 @@ Status RecordReader::GetMetadata(Metadata* md) {
   return Status::OK();
 }
 
-Status RecordReader::ReadRecord(uint64* offset, string* record) {
-  // Position the input stream.
+#if defined(PLATFORM_GOOGLE)
+Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
+                                     absl::Cord* result) {
+  if (!cord_reads_supported_) {
+    string data;
+    TF_RETURN_IF_ERROR(ReadChecksummed(offset, n, &data));
+    *result = absl::Cord(data);
+    return Status::OK();
+  }
+  if (n >= SIZE_MAX - sizeof(uint32)) {
+    return errors::DataLoss("record size too large");
+  }
+
+  const size_t expected = n + sizeof(uint32);
+  result->Clear();
+  Status s = input_stream_->ReadNBytes(expected, result);
+  if (errors::IsUnimplemented(s)) {
+    // The buffered and compressed input streams only read into strings.
+    cord_reads_supported_ = false;
+    return ReadChecksummed(offset, n, result);
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  if (result->size() != expected) {
+    if (result->empty()) {
+      return errors::OutOfRange("eof");
+    } else {
+      return errors::DataLoss("truncated record at ", offset);
+    }
+  }
+
+  const string masked_crc_bytes(result->Subcord(n, sizeof(uint32)));
+  const uint32 masked_crc = core::DecodeFixed32(masked_crc_bytes.data());
+  result->RemoveSuffix(sizeof(uint32));
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(*result)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  return Status::OK();
+}
+#endif
+
+Status RecordReader::PositionInputStream(uint64 offset) {
   int64 curr_pos = input_stream_->Tell();
-  int64 desired_pos = static_cast<int64>(*offset);
+  int64 desired_pos = static_cast<int64>(offset);
   if (curr_pos > desired_pos || curr_pos < 0 /* EOF */ ||
       (curr_pos == desired_pos && last_read_failed_)) {
     last_read_failed_ = false;
@@ -174,6 +237,11 @@ Status RecordReader::ReadRecord(uint64* offset, string* record) {
     TF_RETURN_IF_ERROR(input_stream_->SkipNBytes(desired_pos - curr_pos));
   }
   DCHECK_EQ(desired_pos, input_stream_->Tell());
+  return Status::OK();
+}
+
+Status RecordReader::ReadRecord(uint64* offset, string* record) {
+  TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
   // Read header data.
   Status s = ReadChecksummed(*offset, sizeof(uint64), record);
@@ -198,6 +266,35 @@ Status RecordReader::ReadRecord(uint64* offset, string* record) {
   return Status::OK();
 }
 
+#if defined(PLATFORM_GOOGLE)
+Status RecordReader::ReadRecord(uint64* offset, absl::Cord* record) {
+  TF_RETURN_IF_ERROR(PositionInputStream(*offset));
+
+  // Read header data. The header is small, so it is read into a string.
+  string header;
+  Status s = ReadChecksummed(*offset, sizeof(uint64), &header);
+  if (!s.ok()) {
+    last_read_failed_ = true;
+    return s;
+  }
+  const uint64 length = core::DecodeFixed64(header.data());
+
+  // Read data
+  s = ReadChecksummed(*offset + kHeaderSize, length, record);
+  if (!s.ok()) {
+    last_read_failed_ = true;
+    if (errors::IsOutOfRange(s)) {
+      s = errors::DataLoss("truncated record at ", *offset);
+    }
+    return s;
+  }
+
+  *offset += kHeaderSize + length + kFooterSize;
+  DCHECK_EQ(*offset, input_stream_->Tell());
+  return Status::OK();
+}
+#endif
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
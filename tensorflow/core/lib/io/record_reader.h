@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
+#include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -42,6 +43,13 @@ class RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // If both readahead_num_buffers and buffer_size are non-zero, up to
+  // readahead_num_buffers reads of buffer_size bytes each are kept in flight
+  // on a shared thread pool, so that the records of a single file can be read
+  // at the full bandwidth of high-latency filesystems. The same restrictions
+  // as for buffer_size apply.
+  int64 readahead_num_buffers = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -91,6 +99,14 @@ class RecordReader {
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(uint64* offset, string* record);
 
+#if defined(PLATFORM_GOOGLE)
+  // Same as above, with the record data referencing the buffers returned by
+  // RandomAccessFile::Read(uint64, size_t, absl::Cord*) rather than copied,
+  // when the file supports it and the reader has no buffering or compression.
+  // Otherwise the data is copied once into the Cord.
+  Status ReadRecord(uint64* offset, absl::Cord* record);
+#endif
+
   // Return the metadata of the Record file.
   //
   // The current implementation scans the file to completion,
@@ -104,10 +120,20 @@ class RecordReader {
 
  private:
   Status ReadChecksummed(uint64 offset, size_t n, string* result);
+#if defined(PLATFORM_GOOGLE)
+  Status ReadChecksummed(uint64 offset, size_t n, absl::Cord* result);
+#endif
+
+  // Moves the input stream to `offset`.
+  Status PositionInputStream(uint64 offset);
 
   RecordReaderOptions options_;
   std::unique_ptr<InputStreamInterface> input_stream_;
   bool last_read_failed_;
+#if defined(PLATFORM_GOOGLE)
+  // Whether the input stream implements ReadNBytes(int64, absl::Cord*).
+  bool cord_reads_supported_ = true;
+#endif
 
   std::unique_ptr<Metadata> cached_metadata_;
 
@@ -133,6 +159,12 @@ class SequentialRecordReader {
     return underlying_.ReadRecord(&offset_, record);
   }
 
+#if defined(PLATFORM_GOOGLE)
+  Status ReadRecord(absl::Cord* record) {
+    return underlying_.ReadRecord(&offset_, record);
+  }
+#endif
+
   // Returns the current offset in the file.
   uint64 TellOffset() { return offset_; }
 
@@ -160,6 +160,23 @@ class RecordioTest : public ::testing::Test {
     }
   }
 
+#if defined(PLATFORM_GOOGLE)
+  string ReadCord() {
+    if (!reading_) {
+      reading_ = true;
+    }
+    absl::Cord record;
+    Status s = reader_->ReadRecord(&readpos_, &record);
+    if (s.ok()) {
+      return string(record);
+    } else if (errors::IsOutOfRange(s)) {
+      return "EOF";
+    } else {
+      return s.ToString();
+    }
+  }
+#endif
+
   void IncrementByte(int offset, int delta) { contents_[offset] += delta; }
 
   void SetByte(int offset, char new_byte) { contents_[offset] = new_byte; }
@@ -217,6 +234,23 @@ TEST_F(RecordioTest, ReadWriteCords) {
   ASSERT_EQ("EOF", Read());
   ASSERT_EQ("EOF", Read());  // Make sure reads at eof work
 }
+
+TEST_F(RecordioTest, ReadCords) {
+  Write("foo");
+  Write("");
+  Write(BigString("x", 10000));
+  ASSERT_EQ("foo", ReadCord());
+  ASSERT_EQ("", ReadCord());
+  ASSERT_EQ(BigString("x", 10000), ReadCord());
+  ASSERT_EQ("EOF", ReadCord());
+  ASSERT_EQ("EOF", ReadCord());  // Make sure reads at eof work
+}
+
+TEST_F(RecordioTest, ReadCordsCorruptedData) {
+  Write("foo");
+  IncrementByte(RecordReader::kHeaderSize + 1, 1);
+  ASSERT_TRUE(absl::StrContains(ReadCord(), "corrupted record"));
+}
 #endif
 
 TEST_F(RecordioTest, ManyRecords) {
@@ -190,6 +190,50 @@ class PhiloxRandom {
     return counter;
   }
 
+  // The number of calls to operator() that GenerateBatch() replaces.
+  static const int kBatchSize = 64;
+
+  // Writes the results of the next kBatchSize calls to operator() to
+  // `output[0, 4 * kBatchSize)`. The rounds are computed for all the counters
+  // together, so that the compiler vectorizes them across the counters. CPU
+  // only.
+  void GenerateBatch(uint32* output) {
+    uint32 counter0[kBatchSize];
+    uint32 counter1[kBatchSize];
+    uint32 counter2[kBatchSize];
+    uint32 counter3[kBatchSize];
+    for (int i = 0; i < kBatchSize; ++i) {
+      counter0[i] = counter_[0];
+      counter1[i] = counter_[1];
+      counter2[i] = counter_[2];
+      counter3[i] = counter_[3];
+      SkipOne();
+    }
+    Key key = key_;
+    for (int round = 0; round < 10; ++round) {
+      // Same as ComputeSingleRound().
+      for (int i = 0; i < kBatchSize; ++i) {
+        uint32 lo0;
+        uint32 hi0;
+        MultiplyHighLow(kPhiloxM4x32A, counter0[i], &lo0, &hi0);
+        uint32 lo1;
+        uint32 hi1;
+        MultiplyHighLow(kPhiloxM4x32B, counter2[i], &lo1, &hi1);
+        counter0[i] = hi1 ^ counter1[i] ^ key[0];
+        counter1[i] = lo1;
+        counter2[i] = hi0 ^ counter3[i] ^ key[1];
+        counter3[i] = lo0;
+      }
+      RaiseKey(&key);
+    }
+    for (int i = 0; i < kBatchSize; ++i) {
+      output[4 * i] = counter0[i];
+      output[4 * i + 1] = counter1[i];
+      output[4 * i + 2] = counter2[i];
+      output[4 * i + 3] = counter3[i];
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static const uint32 kPhiloxW32A = 0x9E3779B9;
@@ -68,6 +68,24 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that GenerateBatch gives the same samples as the same
+// number of calls to operator(), across a carry of the counter.
+TEST(PhiloxRandomTest, GenerateBatchMatchTest) {
+  PhiloxRandom gen(GetTestSeed());
+  gen.Skip(0xffffffffULL - 10);
+  PhiloxRandom batch_gen = gen;
+
+  std::vector<uint32> batch(2 * 4 * PhiloxRandom::kBatchSize);
+  batch_gen.GenerateBatch(&batch[0]);
+  batch_gen.GenerateBatch(&batch[4 * PhiloxRandom::kBatchSize]);
+  for (int i = 0; i < 2 * PhiloxRandom::kBatchSize; ++i) {
+    const PhiloxRandom::ResultType sample = gen();
+    for (int j = 0; j < 4; ++j) {
+      ASSERT_EQ(batch[4 * i + j], sample[j]);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
@@ -130,6 +130,9 @@ ncclDataType_t ToNcclType(DataType t) {
   }
 }
 
+// Maximum number of collectives launched in one NCCL group by a stream.
+constexpr size_t kMaxGroupedLaunches = 64;
+
 void StringToNcclUniqueId(const string& str_id, ncclUniqueId* nccl_id) {
   if (str_id.size() == NCCL_UNIQUE_ID_BYTES) {
     memcpy(nccl_id->internal, str_id.data(), NCCL_UNIQUE_ID_BYTES);
@@ -644,12 +647,11 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
   se::Stream* comm_stream = nccl_stream->stream.get();
 #endif
   ScopedActivateExecutorContext scoped_context(nccl_stream->executor);
-  const cudaStream_t* cu_stream = reinterpret_cast<const cudaStream_t*>(
-      comm_stream->implementation()->GpuStreamMemberHack());
 
   while (true) {
-    // Find collective to run.
-    std::pair<Collective*, int> next_launch;
+    // Find the collectives to run. Collectives that became ready while the
+    // previous ones were being launched are launched together.
+    std::vector<std::pair<Collective*, int>> launches;
     {
       VLOG(3) << "Locking mutex nccl_stream " << nccl_stream;
       mutex_lock l(nccl_stream->mu);
@@ -660,107 +662,142 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
         }
         nccl_stream->cv.wait(l);
       }
-      next_launch = nccl_stream->pending_launches_.back();
-      nccl_stream->pending_launches_.pop_back();
-    }
-
-    // Launch the nccl kernel.
-    Collective* collective = next_launch.first;
-    ncclDataType_t data_type = ToNcclType(collective->data_type);
-    int p_idx = next_launch.second;
-    Participant* p = collective->participants[p_idx].get();
-    auto nccl_comm = collective->communicator->members[p_idx].nccl_comm;
-    ncclResult_t nccl_result = ncclSuccess;
-    switch (collective->type) {
-      case kAllReduce: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
-
-        VLOG(2) << "call NcclAllReduce collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " sendbuff " << sendbuff << " recvbuff " << recvbuff
-                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        nccl_result = ncclAllReduce(sendbuff, recvbuff, p->input->NumElements(),
-                                    data_type, collective->reduction_op,
-                                    nccl_comm, *cu_stream);
-        break;
+      while (!nccl_stream->pending_launches_.empty() &&
+             launches.size() < kMaxGroupedLaunches) {
+        launches.push_back(nccl_stream->pending_launches_.back());
+        nccl_stream->pending_launches_.pop_back();
       }
-      case kBroadcast: {
-        const void* sendbuff = nullptr;
-        void* recvbuff = nullptr;
-        int num_elements = -1;
-        if (p->input) {
-          sendbuff = p->input->tensor_data().data();
-          num_elements = p->input->NumElements();
-        }
-        if (p->output) {
-          recvbuff = const_cast<char*>(p->output->tensor_data().data());
-          num_elements = p->output->NumElements();
-        } else {
-          // Operate in-place if no output (for the src node).
-          recvbuff = const_cast<void*>(sendbuff);
-        }
-        if (num_elements < 0) {
-          p->done_callback(errors::Internal(
-              "Both input and output are null in ncclBroadcast"));
-          collective->Unref();
-          continue;
+    }
+
+#if NCCL_MAJOR >= 2
+    // Grouping the launches lets NCCL enqueue them together instead of paying
+    // the launch overhead of each collective. The order of the collectives on
+    // each communicator is unchanged, which is all NCCL requires of the ranks.
+    const bool grouped = launches.size() > 1;
+    if (grouped) {
+      ncclGroupStart();
+    }
+#endif
+    std::vector<Status> statuses;
+    statuses.reserve(launches.size());
+    for (const auto& launch : launches) {
+      statuses.push_back(
+          LaunchKernel(launch.first, launch.second, comm_stream));
+    }
+#if NCCL_MAJOR >= 2
+    if (grouped) {
+      const ncclResult_t group_result = ncclGroupEnd();
+      if (group_result != ncclSuccess) {
+        for (Status& status : statuses) {
+          status.Update(errors::Unknown("Error invoking NCCL: ",
+                                        ncclGetErrorString(group_result)));
         }
-        VLOG(2) << "call NcclBroadcast collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " sendbuff " << sendbuff << " recvbuff " << recvbuff
-                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        nccl_result =
-            ncclBroadcast(sendbuff, recvbuff, num_elements, data_type,
-                          collective->root_rank, nccl_comm, *cu_stream);
-        break;
-      }
-      case kReduce: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff =
-            p->output ? const_cast<char*>(p->output->tensor_data().data())
-                      : nullptr;
-        nccl_result = ncclReduce(sendbuff, recvbuff, p->input->NumElements(),
-                                 data_type, collective->reduction_op,
-                                 collective->root_rank, nccl_comm, *cu_stream);
-        break;
       }
-      case kAllGather: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+    }
+#endif
 
-        VLOG(2) << "call NcclAllGather collective_key "
+    for (size_t i = 0; i < launches.size(); ++i) {
+      Collective* collective = launches[i].first;
+      const int p_idx = launches[i].second;
+      // Run the done_callback when the nccl kernel finishes running.
+      auto done_callback = [collective, p_idx, status = statuses[i]]() {
+        VLOG(2) << "done Nccl kernel collective_key "
                 << collective->collective_key << " participant " << p_idx
-                << " sendbuff " << sendbuff << " sendcount "
-                << p->input->NumElements() << " recvbuff " << recvbuff
-                << " recvcount " << p->output->NumElements() << " nccl_comm "
-                << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        nccl_result = ncclAllGather(sendbuff, recvbuff, p->input->NumElements(),
-                                    data_type, nccl_comm, *cu_stream);
-        break;
-      }
+                << " status " << status;
+        // If the launch failed, other members of the collective that did
+        // launch their kernels are hanging.
+        collective->participants[p_idx]->done_callback(status);
+        collective->Unref();
+      };
+      collective->participants[p_idx]->event_mgr->ThenExecute(comm_stream,
+                                                               done_callback);
     }
+  }
+}
 
-    // Run the done_callback when the nccl kernel finishes running.
-    auto done_callback = [collective, p_idx, nccl_result]() {
-      VLOG(2) << "done Nccl kernel collective_key "
+Status NcclManager::LaunchKernel(Collective* collective, int p_idx,
+                                 se::Stream* comm_stream) {
+  const cudaStream_t cu_stream = *reinterpret_cast<const cudaStream_t*>(
+      comm_stream->implementation()->GpuStreamMemberHack());
+  ncclDataType_t data_type = ToNcclType(collective->data_type);
+  Participant* p = collective->participants[p_idx].get();
+  auto nccl_comm = collective->communicator->members[p_idx].nccl_comm;
+  ncclResult_t nccl_result = ncclSuccess;
+  switch (collective->type) {
+    case kAllReduce: {
+      const void* sendbuff = p->input->tensor_data().data();
+      void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+
+      VLOG(2) << "call NcclAllReduce collective_key "
               << collective->collective_key << " participant " << p_idx
-              << " ncclResult " << nccl_result;
-      if (nccl_result == ncclSuccess) {
-        collective->participants[p_idx]->done_callback(Status::OK());
+              << " sendbuff " << sendbuff << " recvbuff " << recvbuff
+              << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
+              << " cuda_stream " << cu_stream;
+      nccl_result = ncclAllReduce(sendbuff, recvbuff, p->input->NumElements(),
+                                  data_type, collective->reduction_op,
+                                  nccl_comm, cu_stream);
+      break;
+    }
+    case kBroadcast: {
+      const void* sendbuff = nullptr;
+      void* recvbuff = nullptr;
+      int num_elements = -1;
+      if (p->input) {
+        sendbuff = p->input->tensor_data().data();
+        num_elements = p->input->NumElements();
+      }
+      if (p->output) {
+        recvbuff = const_cast<char*>(p->output->tensor_data().data());
+        num_elements = p->output->NumElements();
       } else {
-        // Propagate the error, but note that if other members of the collective
-        // did launch their kernels, then they are hanging.
-        collective->participants[p_idx]->done_callback(errors::Unknown(
-            "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
+        // Operate in-place if no output (for the src node).
+        recvbuff = const_cast<void*>(sendbuff);
+      }
+      if (num_elements < 0) {
+        return errors::Internal(
+            "Both input and output are null in ncclBroadcast");
       }
-      collective->Unref();
-    };
-    p->event_mgr->ThenExecute(comm_stream, done_callback);
+      VLOG(2) << "call NcclBroadcast collective_key "
+              << collective->collective_key << " participant " << p_idx
+              << " sendbuff " << sendbuff << " recvbuff " << recvbuff
+              << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
+              << " cuda_stream " << cu_stream;
+      nccl_result =
+          ncclBroadcast(sendbuff, recvbuff, num_elements, data_type,
+                        collective->root_rank, nccl_comm, cu_stream);
+      break;
+    }
+    case kReduce: {
+      const void* sendbuff = p->input->tensor_data().data();
+      void* recvbuff =
+          p->output ? const_cast<char*>(p->output->tensor_data().data())
+                    : nullptr;
+      nccl_result = ncclReduce(sendbuff, recvbuff, p->input->NumElements(),
+                               data_type, collective->reduction_op,
+                               collective->root_rank, nccl_comm, cu_stream);
+      break;
+    }
+    case kAllGather: {
+      const void* sendbuff = p->input->tensor_data().data();
+      void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+
+      VLOG(2) << "call NcclAllGather collective_key "
+              << collective->collective_key << " participant " << p_idx
+              << " sendbuff " << sendbuff << " sendcount "
+              << p->input->NumElements() << " recvbuff " << recvbuff
+              << " recvcount " << p->output->NumElements() << " nccl_comm "
+              << nccl_comm << " comm_stream " << comm_stream
+              << " cuda_stream " << cu_stream;
+      nccl_result = ncclAllGather(sendbuff, recvbuff, p->input->NumElements(),
+                                  data_type, nccl_comm, cu_stream);
+      break;
+    }
   }
+  if (nccl_result != ncclSuccess) {
+    return errors::Unknown("Error invoking NCCL: ",
+                           ncclGetErrorString(nccl_result));
+  }
+  return Status::OK();
 }
 
 }  // namespace tensorflow
@@ -243,6 +243,10 @@ class NcclManager {
   // Run <collective>.  This calls takes ownership of <collective>.
   void RunCollective(Collective* collective);
   void LoopKernelLaunches(NcclStream* stream);
+  // Enqueues the nccl kernel of participant <p_idx> of <collective> on
+  // <comm_stream>.
+  static Status LaunchKernel(Collective* collective, int p_idx,
+                             se::Stream* comm_stream);
 
   mutex mu_;
 
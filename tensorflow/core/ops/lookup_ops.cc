@@ -439,6 +439,20 @@ REGISTER_OP("MutableDenseHashTableV2")
       return MutableHashTableShape(c, /*key=*/c->input(0), /*value=*/value_s);
     });
 
+REGISTER_OP("MutableFlatHashTable")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: {int32, int64}")
+    .Attr("value_dtype: {int32, int64, float, double}")
+    .Attr("num_shards: int = 16")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      return MutableHashTableShape(c, /*key=*/c->Scalar(),
+                                   /*value=*/c->Scalar());
+    });
+
 REGISTER_OP("InitializeTable")
     .Input("table_handle: Ref(string)")
     .Input("keys: Tkey")
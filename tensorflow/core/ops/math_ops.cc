@@ -1367,6 +1367,75 @@ REGISTER_OP("SparseSegmentSqrtNGrad")
     .Attr("Tidx: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradShapeFn);
 
+namespace {
+
+// The output of the fused embedding lookups is [?] + params.shape[1:].
+Status FusedEmbeddingSparseLookupShape(InferenceContext* c,
+                                       ShapeHandle params) {
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(params, 1, &params));
+  ShapeHandle unused;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+  ShapeHandle indices;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices));
+  ShapeHandle segment_ids;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids));
+  TF_RETURN_IF_ERROR(c->Merge(indices, segment_ids, &unused));
+
+  ShapeHandle row_shape;
+  TF_RETURN_IF_ERROR(c->Subshape(params, 1, &row_shape));
+  ShapeHandle out;
+  TF_RETURN_IF_ERROR(c->Concatenate(
+      c->Vector(InferenceContext::kUnknownDim), row_shape, &out));
+  c->set_output(0, out);
+  return Status::OK();
+}
+
+}  // namespace
+
+// Computes SparseSegment{Sum,Mean,SqrtN}(Gather(params, ids), indices,
+// segment_ids) without materializing the gathered rows.
+REGISTER_OP("_FusedEmbeddingSparseLookup")
+    .Input("params: T")
+    .Input("ids: Tids")
+    .Input("indices: Tidx")
+    .Input("segment_ids: int32")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("Tids: {int32, int64}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'}")
+    .SetShapeFn([](InferenceContext* c) {
+      return FusedEmbeddingSparseLookupShape(c, c->input(0));
+    })
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
+// Same as _FusedEmbeddingSparseLookup, with the params read from a resource
+// variable as in ResourceGather.
+REGISTER_OP("_FusedResourceEmbeddingSparseLookup")
+    .Input("resource: resource")
+    .Input("ids: Tids")
+    .Input("indices: Tidx")
+    .Input("segment_ids: int32")
+    .Output("output: dtype")
+    .Attr("dtype: {float}")
+    .Attr("Tids: {int32, int64}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'}")
+    .SetShapeFn([](InferenceContext* c) {
+      auto* handle_data = c->input_handle_shapes_and_types(0);
+      ShapeHandle params = handle_data != nullptr && handle_data->size() == 1
+                               ? (*handle_data)[0].shape
+                               : c->UnknownShape();
+      return FusedEmbeddingSparseLookupShape(c, params);
+    })
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
@@ -416,4 +416,104 @@ REGISTER_OP("ConsumeMutexLock")
     .SetIsStateful()
     .SetShapeFn([](InferenceContext* c) { return Status::OK(); });
 
+REGISTER_OP("DynamicEmbeddingVariable")
+    .Output("resource: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("embedding_dim: int >= 1")
+    .Attr("num_slots: int >= 0 = 0")
+    .Attr("initial_stddev: float = 0.01")
+    .Attr("slot_initial_value: float = 0.1")
+    .Attr("min_frequency: int >= 1 = 1")
+    .Attr("num_shards: int >= 1 = 16")
+    .Attr("seed: int = 0")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("DynamicEmbeddingLookup")
+    .Input("resource: resource")
+    .Input("ids: int64")
+    .Input("step: int64")
+    .Output("embeddings: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          c->input(1), c->Vector(InferenceContext::kUnknownDim), &out));
+      c->set_output(0, out);
+      return Status::OK();
+    });
+
+namespace {
+
+Status DynamicEmbeddingSparseApplyShape(InferenceContext* c) {
+  ShapeHandle unused;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));  // lr
+  ShapeHandle grad;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 2, &grad));
+  ShapeHandle indices;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &indices));
+  shape_inference::DimensionHandle unused_dim;
+  TF_RETURN_IF_ERROR(
+      c->Merge(c->Dim(grad, 0), c->Dim(indices, 0), &unused_dim));
+  return Status::OK();
+}
+
+}  // namespace
+
+REGISTER_OP("DynamicEmbeddingSparseApplyGradientDescent")
+    .Input("resource: resource")
+    .Input("alpha: float")
+    .Input("grad: float")
+    .Input("indices: int64")
+    .SetShapeFn(DynamicEmbeddingSparseApplyShape);
+
+REGISTER_OP("DynamicEmbeddingSparseApplyAdagrad")
+    .Input("resource: resource")
+    .Input("lr: float")
+    .Input("grad: float")
+    .Input("indices: int64")
+    .SetShapeFn(DynamicEmbeddingSparseApplyShape);
+
+REGISTER_OP("DynamicEmbeddingEvict")
+    .Input("resource: resource")
+    .Input("step: int64")
+    .Input("ttl_steps: int64")
+    .Input("max_rows: int64")
+    .Output("num_evicted: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      for (int i = 1; i < 4; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      c->set_output(0, c->Scalar());
+      return Status::OK();
+    });
+
+REGISTER_OP("DynamicEmbeddingSave")
+    .Input("resource: resource")
+    .Input("prefix: string")
+    .Input("tensor_name: string")
+    .Attr("only_dirty: bool = false")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      return Status::OK();
+    });
+
+REGISTER_OP("DynamicEmbeddingRestore")
+    .Input("resource: resource")
+    .Input("prefix: string")
+    .Input("tensor_name: string")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      return Status::OK();
+    });
+
 }  // namespace tensorflow
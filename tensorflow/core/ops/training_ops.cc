@@ -785,6 +785,41 @@ REGISTER_OP("ResourceSparseApplyKerasMomentum")
       return ApplyMomentumShapeFn(c, true /* sparse */);
     });
 
+// Shape function of _ResourceMultiApplyMomentum. The i-th variable, its
+// accumulator and its gradient must have the same shape.
+static Status MultiApplyMomentumShapeFn(InferenceContext* c) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape(c, i);                            // var
+    TF_RETURN_IF_ERROR(c->Merge(s, ShapeOrHandleShape(c, n + i), &s));  // accum
+    TF_RETURN_IF_ERROR(
+        c->Merge(s, ShapeOrHandleShape(c, 2 * n + 1 + i), &s));  // grad
+  }
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2 * n), 0, &unused));      // lr
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(3 * n + 1), 0, &unused));  // momentum
+  return Status::OK();
+}
+
+// Same as ResourceApplyMomentum, applied to N variables with the same
+// hyperparameters. The GPU kernel updates all of them in a single launch.
+REGISTER_OP("_ResourceMultiApplyMomentum")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Input("momentum: T")
+    .Attr("N: int >= 1")
+    .Attr("T: {half, float, double}")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(MultiApplyMomentumShapeFn)
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 static Status ApplyAdamShapeFn(InferenceContext* c, bool sparse) {
   ShapeHandle unused;
   ShapeHandle s = ShapeOrHandleShape(c, 0);                       // var
@@ -841,6 +876,49 @@ REGISTER_OP("ResourceApplyAdam")
       return ApplyAdamShapeFn(c, false /* sparse */);
     });
 
+// Shape function of _ResourceMultiApplyAdam. The i-th variable, its m and v
+// slots and its gradient must have the same shape.
+static Status MultiApplyAdamShapeFn(InferenceContext* c) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape(c, i);                            // var
+    TF_RETURN_IF_ERROR(c->Merge(s, ShapeOrHandleShape(c, n + i), &s));  // m
+    TF_RETURN_IF_ERROR(
+        c->Merge(s, ShapeOrHandleShape(c, 2 * n + i), &s));  // v
+    TF_RETURN_IF_ERROR(
+        c->Merge(s, ShapeOrHandleShape(c, 3 * n + 6 + i), &s));  // grad
+  }
+  for (int i = 3 * n; i < 3 * n + 6; ++i) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+  }
+  return Status::OK();
+}
+
+// Same as ResourceApplyAdam, applied to N variables with the same
+// hyperparameters. The GPU kernel updates all of them in a single launch.
+REGISTER_OP("_ResourceMultiApplyAdam")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {half, float, double}")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(MultiApplyAdamShapeFn)
+    .Doc(R"doc(
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 static Status ApplyAdamWithAmsgradShapeFn(InferenceContext* c, bool sparse) {
   ShapeHandle unused;
   ShapeHandle s = ShapeOrHandleShape(c, 0);                       // var
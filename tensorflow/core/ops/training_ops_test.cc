@@ -13,8 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -289,6 +291,37 @@ TEST(TrainingOpsTest, ApplyAdam_ShapeFn) {
   INFER_ERROR(err, op, "?;?;?;?;?;?;?;?;[?];?");
 }
 
+TEST(TrainingOpsTest, ResourceMultiApplyAdam_ShapeFn) {
+  ShapeInferenceTestOp op("_ResourceMultiApplyAdam");
+  const int n = 2;
+  std::vector<NodeDefBuilder::NodeOut> vars(n, {"a", 0, DT_RESOURCE});
+  std::vector<NodeDefBuilder::NodeOut> grads(n, {"a", 0, DT_FLOAT});
+  TF_ASSERT_OK(NodeDefBuilder("test", "_ResourceMultiApplyAdam")
+                   .Input(vars)
+                   .Input(vars)
+                   .Input(vars)
+                   .Input("a", 0, DT_FLOAT)
+                   .Input("a", 0, DT_FLOAT)
+                   .Input("a", 0, DT_FLOAT)
+                   .Input("a", 0, DT_FLOAT)
+                   .Input("a", 0, DT_FLOAT)
+                   .Input("a", 0, DT_FLOAT)
+                   .Input(grads)
+                   .Attr("N", n)
+                   .Finalize(&op.node_def));
+
+  // The i-th var, m, v and grad must have the same shape.
+  INFER_OK(op, "[1];[2];[1];[2];[1];[2];[];[];[];[];[];[];[1];[2]", "");
+  INFER_ERROR("Dimension 0 in both shapes must be equal, but are 1 and 2", op,
+              "[1];[1];[2];[1];[1];[1];[];[];[];[];[];[];[1];[1]");
+  INFER_ERROR("Dimension 0 in both shapes must be equal, but are 2 and 1", op,
+              "[1];[2];[1];[2];[1];[2];[];[];[];[];[];[];[1];[1]");
+
+  // beta1_power, beta2_power, lr, beta1, beta2, and epsilon must be scalars.
+  INFER_ERROR("Shape must be rank 0 but is rank 1", op,
+              "?;?;?;?;?;?;?;?;[?];?;?;?;?;?");
+}
+
 TEST(TrainingOpsTest, ApplyRMSProp_ShapeFn) {
   ShapeInferenceTestOp op("ApplyRMSProp");
 
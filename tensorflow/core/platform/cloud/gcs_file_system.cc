@@ -27,6 +27,7 @@ limitations under the License.
 #endif
 #include "absl/base/macros.h"
 #include "include/json/json.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
@@ -61,6 +62,9 @@ constexpr char kStorageHost[] = "storage.googleapis.com";
 constexpr char kBucketMetadataLocationKey[] = "location";
 constexpr size_t kReadAppendableFileBufferSize = 1024 * 1024;  // In bytes.
 constexpr int kGetChildrenDefaultPageSize = 1000;
+// The maximum number of concurrent range requests issued by
+// GcsRandomAccessFile::ReadV.
+constexpr int kMaxParallelRangeReads = 16;
 // The HTTP response code "308 Resume Incomplete".
 constexpr uint64 HTTP_CODE_RESUME_INCOMPLETE = 308;
 // The environment variable that overrides the size of the readahead buffer.
@@ -304,6 +308,30 @@ class GcsRandomAccessFile : public RandomAccessFile {
     return read_fn_(filename_, offset, n, result, scratch);
   }
 
+  /// Issues the range requests concurrently, since each of them mostly waits
+  /// for the round trip to GCS. Thread safe.
+  Status ReadV(std::vector<FileReadRange>* ranges) const override {
+    const int num_workers =
+        std::min<int>(ranges->size(), kMaxParallelRangeReads);
+    if (num_workers <= 1) return RandomAccessFile::ReadV(ranges);
+    BlockingCounter counter(num_workers);
+    for (int worker = 0; worker < num_workers; ++worker) {
+      Env::Default()->SchedClosure([this, ranges, worker, num_workers,
+                                    &counter]() {
+        for (size_t i = worker; i < ranges->size(); i += num_workers) {
+          FileReadRange& range = (*ranges)[i];
+          range.status =
+              Read(range.offset, range.n, &range.result, range.scratch);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    Status status;
+    for (const FileReadRange& range : *ranges) status.Update(range.status);
+    return status;
+  }
+
  private:
   /// The filename of this file.
   const string filename_;
@@ -510,6 +538,14 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    const uint64 composite_upload_threshold =
+        filesystem_->composite_upload_threshold();
+    if (composite_upload_threshold > 0 &&
+        file_size >= composite_upload_threshold) {
+      return CompositeUpload(file_size);
+    }
     string session_uri;
     TF_RETURN_IF_ERROR(CreateNewUploadSession(&session_uri));
     uint64 already_uploaded = 0;
@@ -679,6 +715,113 @@ class GcsWritableFile : public WritableFile {
     return Status::OK();
   }
 
+  /// \brief Uploads the file as temporary component objects in parallel, and
+  /// composes them into the object.
+  ///
+  /// Each component is a simple upload of a range of the memory-mapped
+  /// temporary file. The components are deleted whether or not the upload
+  /// succeeded.
+  Status CompositeUpload(uint64 file_size) {
+    std::unique_ptr<ReadOnlyMemoryRegion> content;
+    TF_RETURN_IF_ERROR(Env::Default()->NewReadOnlyMemoryRegionFromFile(
+        tmp_content_filename_, &content));
+    if (content->length() != file_size) {
+      return errors::Internal("The internal temporary file has ",
+                              content->length(), " bytes instead of ",
+                              file_size);
+    }
+    const char* data = static_cast<const char*>(content->data());
+    const uint64 max_components = filesystem_->composite_upload_components();
+    const uint64 component_size =
+        (file_size + max_components - 1) / max_components;
+    const int num_components =
+        (file_size + component_size - 1) / component_size;
+
+    // The component names only depend on the object, so that the components
+    // of failed uploads are overwritten by the next attempts.
+    std::vector<string> components(num_components);
+    std::vector<Status> statuses(num_components);
+    BlockingCounter counter(num_components);
+    for (int i = 0; i < num_components; ++i) {
+      components[i] = strings::StrCat(object_, "_tmp_component_", i);
+      const uint64 begin = i * component_size;
+      const size_t size = std::min(component_size, file_size - begin);
+      Env::Default()->SchedClosure([this, i, data, begin, size, &components,
+                                    &statuses, &counter]() {
+        statuses[i] = RetryingUtils::CallWithRetries(
+            [this, i, data, begin, size, &components]() {
+              return UploadComponent(components[i], data + begin, size);
+            },
+            retry_config_);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    Status status;
+    for (const Status& component_status : statuses) {
+      status.Update(component_status);
+    }
+    if (status.ok()) {
+      status = RetryingUtils::CallWithRetries(
+          [this, &components]() { return ComposeComponents(components); },
+          retry_config_);
+    }
+    for (const string& component : components) {
+      const Status delete_status = filesystem_->DeleteFile(
+          strings::StrCat("gs://", bucket_, "/", component));
+      if (!delete_status.ok()) {
+        LOG(WARNING) << "Failed to delete the temporary component "
+                     << component << " of " << GetGcsPath() << ": "
+                     << delete_status;
+      }
+    }
+    if (status.ok()) {
+      // Erase the file from the file cache on every successful write.
+      file_cache_erase_();
+    }
+    return status;
+  }
+
+  /// Uploads `data[0..size-1]` to the temporary object `component`.
+  Status UploadComponent(const string& component, const char* data,
+                         size_t size) {
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket_,
+                                    "/o?uploadType=media&name=",
+                                    request->EscapeString(component)));
+    request->SetPostFromBuffer(data, size);
+    request->SetTimeouts(timeouts_->connect, timeouts_->idle, timeouts_->write);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading ",
+                                    component, " for ", GetGcsPath());
+    return Status::OK();
+  }
+
+  /// Composes the temporary objects `components` into the object.
+  Status ComposeComponents(const std::vector<string>& components) {
+    Json::Value body;
+    Json::Value& source_objects = body["sourceObjects"];
+    for (const string& component : components) {
+      Json::Value source_object;
+      source_object["name"] = component;
+      source_objects.append(source_object);
+    }
+    const string body_string = Json::FastWriter().write(body);
+
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                    request->EscapeString(object_),
+                                    "/compose"));
+    request->AddHeader("Content-Type", "application/json");
+    request->SetPostFromBuffer(body_string.data(), body_string.size());
+    request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                         timeouts_->metadata);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when composing ",
+                                    GetGcsPath());
+    return Status::OK();
+  }
+
   string GetGcsPath() const {
     return strings::StrCat("gs://", bucket_, "/", object_);
   }
@@ -877,6 +1020,15 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
 
   GetEnvVar(kAllowedBucketLocations, SplitByCommaToLowercaseSet,
             &allowed_locations_);
+
+  uint64 composite_upload_threshold_mb = 0;
+  int32 composite_upload_components = kDefaultCompositeUploadComponents;
+  GetEnvVar(kCompositeUploadThreshold, strings::safe_strtou64,
+            &composite_upload_threshold_mb);
+  GetEnvVar(kCompositeUploadComponents, strings::safe_strto32,
+            &composite_upload_components);
+  SetCompositeUploadConfig(composite_upload_threshold_mb * 1024 * 1024,
+                           composite_upload_components);
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -977,16 +1129,35 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
   }
 }
 
+void GcsFileSystem::SetCompositeUploadConfig(uint64 threshold_bytes,
+                                             int num_components) {
+  composite_upload_threshold_ = threshold_bytes;
+  composite_upload_components_ =
+      std::min(std::max(num_components, 1), kMaxCompositeUploadComponents);
+  VLOG(1) << "GCS composite upload threshold = " << threshold_bytes << " ; "
+          << "components = " << composite_upload_components_;
+}
+
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
+  uint64 value;
+  size_t num_shards = kDefaultCacheNumShards;
+  if (GetEnvVar(kCacheNumShards, strings::safe_strtou64, &value)) {
+    num_shards = value;
+  }
+  size_t prefetch_blocks = kDefaultCachePrefetchBlocks;
+  if (GetEnvVar(kCachePrefetchBlocks, strings::safe_strtou64, &value)) {
+    prefetch_blocks = value;
+  }
   std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
       block_size, max_bytes, max_staleness,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), num_shards, prefetch_blocks));
   return file_block_cache;
 }
 
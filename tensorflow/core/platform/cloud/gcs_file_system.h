@@ -50,6 +50,27 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the number of shards of the LRU cache of
+// blocks read from GCS, to reduce lock contention between reader threads.
+// Each shard holds an equal part of the max size.
+constexpr char kCacheNumShards[] = "GCS_READ_CACHE_NUM_SHARDS";
+constexpr size_t kDefaultCacheNumShards = 1;
+// The environment variable that sets the number of blocks fetched ahead of
+// sequential reads of a file. 0 (the default) disables the prefetching.
+constexpr char kCachePrefetchBlocks[] = "GCS_READ_CACHE_PREFETCH_BLOCKS";
+constexpr size_t kDefaultCachePrefetchBlocks = 0;
+// The environment variable that sets the size from which written files are
+// uploaded as several components in parallel, and composed into the object.
+// Specified in MB. 0 (the default) disables the composite uploads.
+constexpr char kCompositeUploadThreshold[] =
+    "GCS_COMPOSITE_UPLOAD_THRESHOLD_MB";
+constexpr uint64 kDefaultCompositeUploadThreshold = 0;
+// The environment variable that sets the number of components of composite
+// uploads. GCS composes at most 32 components at once.
+constexpr char kCompositeUploadComponents[] =
+    "GCS_COMPOSITE_UPLOAD_COMPONENTS";
+constexpr int kDefaultCompositeUploadComponents = 8;
+constexpr int kMaxCompositeUploadComponents = 32;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -201,6 +222,13 @@ class GcsFileSystem : public FileSystem {
     return matching_paths_cache_->max_entries();
   }
 
+  uint64 composite_upload_threshold() const {
+    return composite_upload_threshold_;
+  }
+  int composite_upload_components() const {
+    return composite_upload_components_;
+  }
+
   /// Structure containing the information for timeouts related to accessing the
   /// GCS APIs.
   ///
@@ -253,6 +281,13 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Configures the composite uploads of the files written from now on.
+  ///
+  /// Files of at least `threshold_bytes` are uploaded as `num_components`
+  /// temporary objects in parallel, which are then composed into the object.
+  /// A `threshold_bytes` of 0 disables the composite uploads.
+  void SetCompositeUploadConfig(uint64 threshold_bytes, int num_components);
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -368,6 +403,11 @@ class GcsFileSystem : public FileSystem {
   // Additional header material to be transmitted with all GCS requests
   std::unique_ptr<std::pair<const string, const string>> additional_header_;
 
+  /// The size from which files are uploaded as composite objects, if positive.
+  uint64 composite_upload_threshold_ = kDefaultCompositeUploadThreshold;
+  /// The number of components of the composite uploads.
+  int composite_upload_components_ = kDefaultCompositeUploadComponents;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GcsFileSystem);
 };
 
@@ -17,10 +17,17 @@ limitations under the License.
 #include <cstring>
 #include <memory>
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
+RamFileBlockCache::Shard* RamFileBlockCache::GetShard(
+    const string& filename) const {
+  if (shards_.size() == 1) return shards_[0].get();
+  return shards_[Hash64(filename) % shards_.size()].get();
+}
+
 bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
   mutex_lock l(block->mu);
   if (block->state != FetchState::FINISHED) {
@@ -31,49 +38,49 @@ bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
 }
 
 std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
-    const Key& key) {
-  mutex_lock lock(mu_);
-  auto entry = block_map_.find(key);
-  if (entry != block_map_.end()) {
+    Shard* shard, const Key& key) {
+  mutex_lock lock(shard->mu);
+  auto entry = shard->block_map.find(key);
+  if (entry != shard->block_map.end()) {
     if (BlockNotStale(entry->second)) {
       return entry->second;
     } else {
       // Remove the stale block and continue.
-      RemoveFile_Locked(key.first);
+      RemoveFile_Locked(shard, key.first);
     }
   }
 
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
-  lru_list_.push_front(key);
-  lra_list_.push_front(key);
-  new_entry->lru_iterator = lru_list_.begin();
-  new_entry->lra_iterator = lra_list_.begin();
+  shard->lru_list.push_front(key);
+  shard->lra_list.push_front(key);
+  new_entry->lru_iterator = shard->lru_list.begin();
+  new_entry->lra_iterator = shard->lra_list.begin();
   new_entry->timestamp = env_->NowSeconds();
-  block_map_.emplace(std::make_pair(key, new_entry));
+  shard->block_map.emplace(std::make_pair(key, new_entry));
   return new_entry;
 }
 
 // Remove blocks from the cache until we do not exceed our maximum size.
-void RamFileBlockCache::Trim() {
-  while (!lru_list_.empty() && cache_size_ > max_bytes_) {
-    RemoveBlock(block_map_.find(lru_list_.back()));
+void RamFileBlockCache::Trim(Shard* shard) {
+  while (!shard->lru_list.empty() && shard->cache_size > shard_max_bytes_) {
+    RemoveBlock(shard, shard->block_map.find(shard->lru_list.back()));
   }
 }
 
 /// Move the block to the front of the LRU list if it isn't already there.
-Status RamFileBlockCache::UpdateLRU(const Key& key,
+Status RamFileBlockCache::UpdateLRU(Shard* shard, const Key& key,
                                     const std::shared_ptr<Block>& block) {
-  mutex_lock lock(mu_);
+  mutex_lock lock(shard->mu);
   if (block->timestamp == 0) {
     // The block was evicted from another thread. Allow it to remain evicted.
     return Status::OK();
   }
-  if (block->lru_iterator != lru_list_.begin()) {
-    lru_list_.erase(block->lru_iterator);
-    lru_list_.push_front(key);
-    block->lru_iterator = lru_list_.begin();
+  if (block->lru_iterator != shard->lru_list.begin()) {
+    shard->lru_list.erase(block->lru_iterator);
+    shard->lru_list.push_front(key);
+    block->lru_iterator = shard->lru_list.begin();
   }
 
   // Check for inconsistent state. If there is a block later in the same file
@@ -82,35 +89,35 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
   // incomplete reads may still go undetected.
   if (block->data.size() < block_size_) {
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
-    auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
+    auto fcmp = shard->block_map.upper_bound(fmax);
+    if (fcmp != shard->block_map.begin() && key < (--fcmp)->first) {
       return errors::Internal("Block cache contents are inconsistent.");
     }
   }
 
-  Trim();
+  Trim(shard);
 
   return Status::OK();
 }
 
-Status RamFileBlockCache::MaybeFetch(const Key& key,
+Status RamFileBlockCache::MaybeFetch(Shard* shard, const Key& key,
                                      const std::shared_ptr<Block>& block) {
   bool downloaded_block = false;
   auto reconcile_state =
-      gtl::MakeCleanup([this, &downloaded_block, &key, &block] {
-        // Perform this action in a cleanup callback to avoid locking mu_ after
-        // locking block->mu.
+      gtl::MakeCleanup([this, shard, &downloaded_block, &key, &block] {
+        // Perform this action in a cleanup callback to avoid locking the
+        // shard's mu after locking block->mu.
         if (downloaded_block) {
-          mutex_lock l(mu_);
+          mutex_lock l(shard->mu);
           // Do not update state if the block is already to be evicted.
           if (block->timestamp != 0) {
             // Use capacity() instead of size() to account for all  memory
             // used by the cache.
-            cache_size_ += block->data.capacity();
+            shard->cache_size += block->data.capacity();
             // Put to beginning of LRA list.
-            lra_list_.erase(block->lra_iterator);
-            lra_list_.push_front(key);
-            block->lra_iterator = lra_list_.begin();
+            shard->lra_list.erase(block->lra_iterator);
+            shard->lra_list.push_front(key);
+            block->lra_iterator = shard->lra_list.begin();
             block->timestamp = env_->NowSeconds();
           }
         }
@@ -165,11 +172,12 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (n == 0) {
     return Status::OK();
   }
-  if (!IsCacheEnabled() || (n > max_bytes_)) {
+  if (!IsCacheEnabled() || (n > shard_max_bytes_)) {
     // The cache is effectively disabled, so we pass the read through to the
     // fetcher without breaking it up into blocks.
     return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
   }
+  Shard* shard = GetShard(filename);
   // Calculate the block-aligned start and end of the read.
   size_t start = block_size_ * (offset / block_size_);
   size_t finish = block_size_ * ((offset + n) / block_size_);
@@ -182,10 +190,10 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     Key key = std::make_pair(filename, pos);
     // Look up the block, fetching and inserting it if necessary, and update the
     // LRU iterator for the key and block.
-    std::shared_ptr<Block> block = Lookup(key);
+    std::shared_ptr<Block> block = Lookup(shard, key);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
-    TF_RETURN_IF_ERROR(MaybeFetch(key, block));
-    TF_RETURN_IF_ERROR(UpdateLRU(key, block));
+    TF_RETURN_IF_ERROR(MaybeFetch(shard, key, block));
+    TF_RETURN_IF_ERROR(UpdateLRU(shard, key, block));
     // Copy the relevant portion of the block into the result buffer.
     const auto& data = block->data;
     if (offset >= pos + data.size()) {
@@ -214,83 +222,161 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
     if (data.size() < block_size_) {
       // The block was a partial block and thus signals EOF at its upper bound.
-      break;
+      *bytes_transferred = total_bytes_transferred;
+      return Status::OK();
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  // Only after full blocks, since the blocks after a partial block are past
+  // the end of the file.
+  if (prefetch_pool_) {
+    MaybePrefetch(shard, filename, offset, n);
+  }
   return Status::OK();
 }
 
+void RamFileBlockCache::MaybePrefetch(Shard* shard, const string& filename,
+                                      size_t offset, size_t n) {
+  // The block-aligned end of the read.
+  const size_t read_end = block_size_ * ((offset + n - 1) / block_size_ + 1);
+  size_t begin;
+  size_t end;
+  {
+    mutex_lock lock(shard->mu);
+    ReadPattern& pattern = shard->read_patterns[filename];
+    if (offset == pattern.next_offset) {
+      ++pattern.sequential_reads;
+    } else {
+      pattern.sequential_reads = 0;
+      pattern.prefetch_limit = 0;
+    }
+    pattern.next_offset = offset + n;
+    if (pattern.sequential_reads < kMinSequentialReads) return;
+    begin = std::max(read_end, pattern.prefetch_limit);
+    end = read_end + prefetch_blocks_ * block_size_;
+    if (begin >= end) return;
+    pattern.prefetch_limit = end;
+  }
+  prefetch_pool_->Schedule(
+      [this, filename, begin, end]() { Prefetch(filename, begin, end); });
+}
+
+void RamFileBlockCache::Prefetch(const string& filename, size_t begin,
+                                 size_t end) {
+  // A block is only fetched once the previous one turned out to be full: the
+  // blocks after a partial block are past the end of the file, and fetching
+  // them would make the cache look inconsistent. The block before `begin` was
+  // read, or is being prefetched, unless it was already evicted.
+  Shard* shard = GetShard(filename);
+  const Key first_key = std::make_pair(filename, begin - block_size_);
+  std::shared_ptr<Block> previous;
+  {
+    mutex_lock lock(shard->mu);
+    auto entry = shard->block_map.find(first_key);
+    if (entry == shard->block_map.end()) return;
+    previous = entry->second;
+  }
+  if (!MaybeFetch(shard, first_key, previous).ok()) return;
+  for (size_t pos = begin; pos < end; pos += block_size_) {
+    if (previous->data.size() < block_size_ ||
+        stop_prefetching_.HasBeenNotified()) {
+      return;
+    }
+    Key key = std::make_pair(filename, pos);
+    previous = Lookup(shard, key);
+    Status status = MaybeFetch(shard, key, previous);
+    if (status.ok()) status = UpdateLRU(shard, key, previous);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to prefetch " << filename << "@" << pos << ": "
+              << status;
+      return;
+    }
+  }
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64 file_signature) {
-  mutex_lock lock(mu_);
-  auto it = file_signature_map_.find(filename);
-  if (it != file_signature_map_.end()) {
+  Shard* shard = GetShard(filename);
+  mutex_lock lock(shard->mu);
+  auto it = shard->file_signature_map.find(filename);
+  if (it != shard->file_signature_map.end()) {
     if (it->second == file_signature) {
       return true;
     }
     // Remove the file from cache if the signatures don't match.
-    RemoveFile_Locked(filename);
+    RemoveFile_Locked(shard, filename);
     it->second = file_signature;
     return false;
   }
-  file_signature_map_[filename] = file_signature;
+  shard->file_signature_map[filename] = file_signature;
   return true;
 }
 
 size_t RamFileBlockCache::CacheSize() const {
-  mutex_lock lock(mu_);
-  return cache_size_;
+  size_t cache_size = 0;
+  for (const auto& shard : shards_) {
+    mutex_lock lock(shard->mu);
+    cache_size += shard->cache_size;
+  }
+  return cache_size;
 }
 
 void RamFileBlockCache::Prune() {
   while (!WaitForNotificationWithTimeout(&stop_pruning_thread_, 1000000)) {
-    mutex_lock lock(mu_);
-    uint64 now = env_->NowSeconds();
-    while (!lra_list_.empty()) {
-      auto it = block_map_.find(lra_list_.back());
-      if (now - it->second->timestamp <= max_staleness_) {
-        // The oldest block is not yet expired. Come back later.
-        break;
+    for (const auto& shard : shards_) {
+      mutex_lock lock(shard->mu);
+      uint64 now = env_->NowSeconds();
+      while (!shard->lra_list.empty()) {
+        auto it = shard->block_map.find(shard->lra_list.back());
+        if (now - it->second->timestamp <= max_staleness_) {
+          // The oldest block is not yet expired. Come back later.
+          break;
+        }
+        // We need to make a copy of the filename here, since it could
+        // otherwise be used within RemoveFile_Locked after `it` is deleted.
+        RemoveFile_Locked(shard.get(), std::string(it->first.first));
       }
-      // We need to make a copy of the filename here, since it could otherwise
-      // be used within RemoveFile_Locked after `it` is deleted.
-      RemoveFile_Locked(std::string(it->first.first));
     }
   }
 }
 
 void RamFileBlockCache::Flush() {
-  mutex_lock lock(mu_);
-  block_map_.clear();
-  lru_list_.clear();
-  lra_list_.clear();
-  cache_size_ = 0;
+  for (const auto& shard : shards_) {
+    mutex_lock lock(shard->mu);
+    shard->block_map.clear();
+    shard->lru_list.clear();
+    shard->lra_list.clear();
+    shard->cache_size = 0;
+    shard->read_patterns.clear();
+  }
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
-  mutex_lock lock(mu_);
-  RemoveFile_Locked(filename);
+  Shard* shard = GetShard(filename);
+  mutex_lock lock(shard->mu);
+  RemoveFile_Locked(shard, filename);
 }
 
-void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+void RamFileBlockCache::RemoveFile_Locked(Shard* shard,
+                                          const string& filename) {
   Key begin = std::make_pair(filename, 0);
-  auto it = block_map_.lower_bound(begin);
-  while (it != block_map_.end() && it->first.first == filename) {
+  auto it = shard->block_map.lower_bound(begin);
+  while (it != shard->block_map.end() && it->first.first == filename) {
     auto next = std::next(it);
-    RemoveBlock(it);
+    RemoveBlock(shard, it);
     it = next;
   }
+  shard->read_patterns.erase(filename);
 }
 
-void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
+void RamFileBlockCache::RemoveBlock(Shard* shard, BlockMap::iterator entry) {
   // This signals that the block is removed, and should not be inadvertently
   // reinserted into the cache in UpdateLRU.
   entry->second->timestamp = 0;
-  lru_list_.erase(entry->second->lru_iterator);
-  lra_list_.erase(entry->second->lra_iterator);
-  cache_size_ -= entry->second->data.capacity();
-  block_map_.erase(entry);
+  shard->lru_list.erase(entry->second->lru_iterator);
+  shard->lra_list.erase(entry->second->lra_iterator);
+  shard->cache_size -= entry->second->data.capacity();
+  shard->block_map.erase(entry);
 }
 
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -37,6 +39,16 @@ namespace tensorflow {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// The files are spread over `num_shards` shards by the hash of their name.
+/// Each shard has its own lock and LRU list, and holds up to
+/// `max_bytes / num_shards` bytes, so that concurrent reads of different files
+/// rarely contend.
+///
+/// When `prefetch_blocks` is positive, the blocks following sequential reads of
+/// a file are fetched ahead of time: once a file was read sequentially
+/// `kMinSequentialReads` times in a row, the cache keeps the `prefetch_blocks`
+/// blocks after the last read being fetched in the background.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -49,13 +61,28 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// The number of sequential reads of a file after which its next blocks are
+  /// prefetched.
+  static constexpr int kMinSequentialReads = 2;
+
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t num_shards = 1, size_t prefetch_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        shard_max_bytes_(max_bytes / std::max<size_t>(num_shards, 1)),
+        prefetch_blocks_(prefetch_blocks) {
+    shards_.resize(std::max<size_t>(num_shards, 1));
+    for (auto& shard : shards_) {
+      shard.reset(new Shard);
+    }
+    if (IsCacheEnabled() && prefetch_blocks_ > 0) {
+      prefetch_pool_.reset(new thread::ThreadPool(env_, "TF_prefetch_FBC",
+                                                  kNumPrefetchThreads));
+    }
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
@@ -65,6 +92,11 @@ class RamFileBlockCache : public FileBlockCache {
   }
 
   ~RamFileBlockCache() override {
+    if (prefetch_pool_) {
+      stop_prefetching_.Notify();
+      // Waits for the running prefetches, and drops the scheduled ones.
+      prefetch_pool_.reset();
+    }
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -95,14 +127,13 @@ class RamFileBlockCache : public FileBlockCache {
   // exist before. If the signature changes, update the existing signature with
   // the new one and remove the file from cache.
   bool ValidateAndUpdateFileSignature(const string& filename,
-                                      int64 file_signature) override
-      LOCKS_EXCLUDED(mu_);
+                                      int64 file_signature) override;
 
   /// Remove all cached blocks for `filename`.
-  void RemoveFile(const string& filename) override LOCKS_EXCLUDED(mu_);
+  void RemoveFile(const string& filename) override;
 
   /// Remove all cached data.
-  void Flush() override LOCKS_EXCLUDED(mu_);
+  void Flush() override;
 
   /// Accessors for cache parameters.
   size_t block_size() const override { return block_size_; }
@@ -110,7 +141,7 @@ class RamFileBlockCache : public FileBlockCache {
   uint64 max_staleness() const override { return max_staleness_; }
 
   /// The current size (in bytes) of the cache.
-  size_t CacheSize() const override LOCKS_EXCLUDED(mu_);
+  size_t CacheSize() const override;
 
   // Returns true if the cache is enabled. If false, the BlockFetcher callback
   // is always executed during Read.
@@ -130,6 +161,13 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of bytes in the LRU cache of each shard.
+  const size_t shard_max_bytes_;
+  /// The number of blocks to prefetch after sequential reads.
+  const size_t prefetch_blocks_;
+
+  /// The number of threads fetching blocks ahead of sequential reads.
+  static constexpr int kNumPrefetchThreads = 8;
 
   /// \brief The key type for the file block cache.
   ///
@@ -158,13 +196,13 @@ class RamFileBlockCache : public FileBlockCache {
   ///
   /// Thread safety:
   /// The iterator and timestamp fields should only be accessed while holding
-  /// the block-cache-wide mu_ instance variable. The state variable should only
-  /// be accessed while holding the Block's mu lock. The data vector should only
+  /// the mu of the shard of the block. The state variable should only be
+  /// accessed while holding the Block's mu lock. The data vector should only
   /// be accessed after state == FINISHED, and it should never be modified.
   ///
-  /// In order to prevent deadlocks, never grab the block-cache-wide mu_ lock
-  /// AFTER grabbing any block's mu lock. It is safe to grab mu without locking
-  /// mu_.
+  /// In order to prevent deadlocks, never grab a shard's mu lock AFTER grabbing
+  /// any block's mu lock. It is safe to grab a block's mu without locking the
+  /// shard's mu.
   struct Block {
     /// The block data.
     std::vector<char> data;
@@ -187,31 +225,88 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// \brief The recent reads of a file, to detect sequential reads.
+  struct ReadPattern {
+    /// The offset right after the last read.
+    size_t next_offset = 0;
+    /// The number of reads in a row that started at `next_offset`.
+    int sequential_reads = 0;
+    /// The end of the blocks already scheduled for prefetching.
+    size_t prefetch_limit = 0;
+  };
+
+  /// \brief The cached blocks of the files whose name hashes to one shard.
+  struct Shard {
+    /// Guards access to the block map, LRU list, and cached byte count.
+    mutex mu;
+
+    /// The block map (map from Key to Block).
+    BlockMap block_map GUARDED_BY(mu);
+
+    /// The LRU list of block keys. The front of the list identifies the most
+    /// recently accessed block.
+    std::list<Key> lru_list GUARDED_BY(mu);
+
+    /// The LRA (least recently added) list of block keys. The front of the
+    /// list identifies the most recently added block.
+    ///
+    /// Note: blocks are added to lra_list only after they have successfully
+    /// been fetched from the underlying block store.
+    std::list<Key> lra_list GUARDED_BY(mu);
+
+    /// The combined number of bytes in all of the cached blocks.
+    size_t cache_size GUARDED_BY(mu) = 0;
+
+    // A filename->file_signature map.
+    std::map<string, int64> file_signature_map GUARDED_BY(mu);
+
+    // A filename->read pattern map, for the prefetching.
+    std::map<string, ReadPattern> read_patterns GUARDED_BY(mu);
+  };
+
+  /// Returns the shard of `filename`.
+  Shard* GetShard(const string& filename) const;
+
   /// Prune the cache by removing files with expired blocks.
-  void Prune() LOCKS_EXCLUDED(mu_);
+  void Prune();
 
-  bool BlockNotStale(const std::shared_ptr<Block>& block)
-      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool BlockNotStale(const std::shared_ptr<Block>& block);
 
   /// Look up a Key in the block cache.
-  std::shared_ptr<Block> Lookup(const Key& key) LOCKS_EXCLUDED(mu_);
+  std::shared_ptr<Block> Lookup(Shard* shard, const Key& key)
+      LOCKS_EXCLUDED(shard->mu);
 
-  Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
-      LOCKS_EXCLUDED(mu_);
+  Status MaybeFetch(Shard* shard, const Key& key,
+                    const std::shared_ptr<Block>& block)
+      LOCKS_EXCLUDED(shard->mu);
 
   /// Trim the block cache to make room for another entry.
-  void Trim() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Trim(Shard* shard) EXCLUSIVE_LOCKS_REQUIRED(shard->mu);
 
   /// Update the LRU iterator for the block at `key`.
-  Status UpdateLRU(const Key& key, const std::shared_ptr<Block>& block)
-      LOCKS_EXCLUDED(mu_);
+  Status UpdateLRU(Shard* shard, const Key& key,
+                   const std::shared_ptr<Block>& block)
+      LOCKS_EXCLUDED(shard->mu);
+
+  /// Records a read of `filename`, and schedules the prefetch of the blocks
+  /// after it if the file is read sequentially.
+  void MaybePrefetch(Shard* shard, const string& filename, size_t offset,
+                     size_t n) LOCKS_EXCLUDED(shard->mu);
+
+  /// Fetches the blocks of `filename` in [begin, end), until a partial block.
+  void Prefetch(const string& filename, size_t begin, size_t end);
 
-  /// Remove all blocks of a file, with mu_ already held.
-  void RemoveFile_Locked(const string& filename) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  /// Remove all blocks of a file, with the shard's mu already held.
+  void RemoveFile_Locked(Shard* shard, const string& filename)
+      EXCLUSIVE_LOCKS_REQUIRED(shard->mu);
 
   /// Remove the block `entry` from the block map and LRU list, and update the
   /// cache size accordingly.
-  void RemoveBlock(BlockMap::iterator entry) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void RemoveBlock(Shard* shard, BlockMap::iterator entry)
+      EXCLUSIVE_LOCKS_REQUIRED(shard->mu);
+
+  /// The shards of the cache. Never resized after construction.
+  std::vector<std::unique_ptr<Shard>> shards_;
 
   /// The cache pruning thread that removes files with expired blocks.
   std::unique_ptr<Thread> pruning_thread_;
@@ -219,28 +314,11 @@ class RamFileBlockCache : public FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
-  /// Guards access to the block map, LRU list, and cached byte count.
-  mutable mutex mu_;
-
-  /// The block map (map from Key to Block).
-  BlockMap block_map_ GUARDED_BY(mu_);
-
-  /// The LRU list of block keys. The front of the list identifies the most
-  /// recently accessed block.
-  std::list<Key> lru_list_ GUARDED_BY(mu_);
-
-  /// The LRA (least recently added) list of block keys. The front of the list
-  /// identifies the most recently added block.
-  ///
-  /// Note: blocks are added to lra_list_ only after they have successfully been
-  /// fetched from the underlying block store.
-  std::list<Key> lra_list_ GUARDED_BY(mu_);
-
-  /// The combined number of bytes in all of the cached blocks.
-  size_t cache_size_ GUARDED_BY(mu_) = 0;
+  /// The threads fetching blocks ahead of sequential reads, if any.
+  std::unique_ptr<thread::ThreadPool> prefetch_pool_;
 
-  // A filename->file_signature map.
-  std::map<string, int64> file_signature_map_ GUARDED_BY(mu_);
+  /// Notification for skipping the scheduled prefetches.
+  Notification stop_prefetching_;
 };
 
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 #include <cstring>
+#include <map>
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/cloud/now_seconds_env.h"
@@ -545,6 +546,77 @@ TEST(RamFileBlockCacheTest, CoalesceConcurrentReads) {
   EXPECT_EQ(1, num_requests);
 }
 
+TEST(RamFileBlockCacheTest, Shards) {
+  const size_t block_size = 16;
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 4 * 6 * block_size, 0, fetcher,
+                          Env::Default(), /*num_shards=*/4);
+  std::vector<char> out;
+  const std::vector<string> filenames = {"a", "b", "c", "d", "e", "f"};
+  for (const string& filename : filenames) {
+    TF_EXPECT_OK(ReadCache(&cache, filename, 0, block_size, &out));
+  }
+  EXPECT_EQ(filenames.size(), calls);
+  EXPECT_EQ(filenames.size() * block_size, cache.CacheSize());
+  // Each shard can hold a block of every file, so all of the reads are cached.
+  for (const string& filename : filenames) {
+    TF_EXPECT_OK(ReadCache(&cache, filename, 0, block_size, &out));
+  }
+  EXPECT_EQ(filenames.size(), calls);
+  cache.RemoveFile("a");
+  EXPECT_EQ((filenames.size() - 1) * block_size, cache.CacheSize());
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+  EXPECT_EQ(filenames.size() + 1, calls);
+  cache.Flush();
+  EXPECT_EQ(0, cache.CacheSize());
+}
+
+TEST(RamFileBlockCacheTest, PrefetchSequentialReads) {
+  // A file of 3.5 blocks.
+  const size_t block_size = 16;
+  const size_t file_size = 3 * block_size + block_size / 2;
+  mutex mu;
+  std::map<size_t, int> calls;
+  Notification last_block_fetched;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      calls[offset]++;
+    }
+    *bytes_transferred = offset < file_size ? std::min(n, file_size - offset)
+                                            : 0;
+    memset(buffer, 'x', *bytes_transferred);
+    if (offset == 3 * block_size) last_block_fetched.Notify();
+    return Status::OK();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                            Env::Default(), /*num_shards=*/1,
+                            /*prefetch_blocks=*/4);
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+    // The second sequential read prefetches the rest of the file.
+    EXPECT_TRUE(WaitForNotificationWithTimeout(&last_block_fetched,
+                                               10 * 1000 * 1000));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 2 * block_size, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 3 * block_size, block_size, &out));
+    EXPECT_EQ(block_size / 2, out.size());
+  }
+  // Every block was fetched once, and nothing past the end of the file.
+  std::map<size_t, int> expected = {
+      {0, 1}, {block_size, 1}, {2 * block_size, 1}, {3 * block_size, 1}};
+  EXPECT_EQ(expected, calls);
+}
+
 TEST(RamFileBlockCacheTest, Flush) {
   int calls = 0;
   auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
@@ -51,6 +51,22 @@ void FileSystem::FlushCaches() {}
 
 RandomAccessFile::~RandomAccessFile() {}
 
+Status RandomAccessFile::ReadV(std::vector<FileReadRange>* ranges) const {
+  Status status;
+  for (FileReadRange& range : *ranges) {
+    range.status = Read(range.offset, range.n, &range.result, range.scratch);
+    status.Update(range.status);
+  }
+  return status;
+}
+
+void RandomAccessFile::ReadVAsync(
+    std::vector<FileReadRange>* ranges,
+    std::function<void(const Status&)> done) const {
+  Env::Default()->SchedClosure(
+      [this, ranges, done]() { done(ReadV(ranges)); });
+}
+
 WritableFile::~WritableFile() {}
 
 FileSystemRegistry::~FileSystemRegistry() {}
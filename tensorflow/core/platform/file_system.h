@@ -229,6 +229,19 @@ class FileSystem {
   virtual ~FileSystem();
 };
 
+/// \brief One of the ranges read by `RandomAccessFile::ReadV`.
+///
+/// `scratch[0..n-1]` must be live while the read is in flight and while
+/// `result` is used.
+struct FileReadRange {
+  uint64 offset = 0;
+  size_t n = 0;
+  char* scratch = nullptr;
+  /// Set by the read, like the `result` and status of `Read`.
+  StringPiece result;
+  Status status;
+};
+
 /// A file abstraction for randomly reading the contents of a file.
 class RandomAccessFile {
  public:
@@ -261,6 +274,24 @@ class RandomAccessFile {
   virtual Status Read(uint64 offset, size_t n, StringPiece* result,
                       char* scratch) const = 0;
 
+  /// \brief Reads each of `ranges`, as `Read` would.
+  ///
+  /// Sets the `result` and `status` of every range, and returns the first
+  /// non-OK status of the ranges, in order. The default reads the ranges one
+  /// after the other; file systems with high latency per request override it
+  /// to issue them concurrently.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual Status ReadV(std::vector<FileReadRange>* ranges) const;
+
+  /// \brief Asynchronous version of `ReadV`.
+  ///
+  /// Calls `done` with the status `ReadV` would return, possibly from another
+  /// thread. `ranges` and their scratch buffers must be live until then. The
+  /// default runs `ReadV` with `Env::Default()->SchedClosure`.
+  virtual void ReadVAsync(std::vector<FileReadRange>* ranges,
+                          std::function<void(const Status&)> done) const;
+
   // TODO(ebrevdo): Remove this ifdef when absl is updated.
 #if defined(PLATFORM_GOOGLE)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
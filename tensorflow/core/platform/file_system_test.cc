@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <sys/stat.h>
 
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -293,4 +294,70 @@ TEST(TestFileSystemTest, RootDirectory) {
   EXPECT_EQ("./test", results[0]);
 }
 
+// A file with the contents of a string.
+class StringRandomAccessFile : public RandomAccessFile {
+ public:
+  explicit StringRandomAccessFile(const string& contents)
+      : contents_(contents) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    if (offset > contents_.size()) {
+      *result = StringPiece();
+      return errors::OutOfRange("Read past the end of the file");
+    }
+    *result = StringPiece(contents_).substr(offset, n);
+    if (result->size() < n) {
+      return errors::OutOfRange("Read fewer bytes than requested");
+    }
+    return Status::OK();
+  }
+
+ private:
+  const string contents_;
+};
+
+TEST(RandomAccessFileTest, ReadV) {
+  StringRandomAccessFile file("0123456789");
+  char scratch[12];
+  std::vector<FileReadRange> ranges(3);
+  ranges[0].offset = 6;
+  ranges[0].n = 3;
+  ranges[0].scratch = scratch;
+  ranges[1].offset = 0;
+  ranges[1].n = 2;
+  ranges[1].scratch = scratch + 3;
+  ranges[2].offset = 8;
+  ranges[2].n = 4;
+  ranges[2].scratch = scratch + 5;
+  EXPECT_EQ(error::OUT_OF_RANGE, file.ReadV(&ranges).code());
+  TF_EXPECT_OK(ranges[0].status);
+  EXPECT_EQ("678", ranges[0].result);
+  TF_EXPECT_OK(ranges[1].status);
+  EXPECT_EQ("01", ranges[1].result);
+  EXPECT_EQ(error::OUT_OF_RANGE, ranges[2].status.code());
+  EXPECT_EQ("89", ranges[2].result);
+
+  ranges.pop_back();
+  TF_EXPECT_OK(file.ReadV(&ranges));
+}
+
+TEST(RandomAccessFileTest, ReadVAsync) {
+  StringRandomAccessFile file("0123456789");
+  char scratch[4];
+  std::vector<FileReadRange> ranges(1);
+  ranges[0].offset = 3;
+  ranges[0].n = 4;
+  ranges[0].scratch = scratch;
+  Notification done;
+  Status status = errors::Unknown("Not called");
+  file.ReadVAsync(&ranges, [&status, &done](const Status& s) {
+    status = s;
+    done.Notify();
+  });
+  done.WaitForNotification();
+  TF_EXPECT_OK(status);
+  EXPECT_EQ("3456", ranges[0].result);
+}
+
 }  // namespace tensorflow
@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/platform/s3/s3_file_system.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/s3/aws_crypto.h"
@@ -36,6 +39,7 @@ limitations under the License.
 #include <aws/s3/model/ListObjectsRequest.h>
 #include <aws/s3/model/PutObjectRequest.h>
 
+#include <algorithm>
 #include <cstdlib>
 
 namespace tensorflow {
@@ -44,6 +48,12 @@ namespace {
 static const char* kS3FileSystemAllocationTag = "S3FileSystemAllocation";
 static const size_t kS3ReadAppendableFileBufferSize = 1024 * 1024;
 static const int kS3GetChildrenMaxKeys = 100;
+// Reads of at least two chunks are split into ranged GetObject requests of
+// this size, which are sent concurrently.
+static const size_t kS3MultiPartDownloadChunkSize = 16 * 1024 * 1024;
+static const int kS3MaxParallelDownloads = 16;
+static const int kS3DefaultMaxConnections = 64;
+static const size_t kS3DefaultBlockSizeMb = 16;
 
 Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
   static mutex cfg_lock(LINKER_INITIALIZED);
@@ -123,6 +133,17 @@ Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
         cfg.requestTimeoutMs = timeout;
       }
     }
+    // The client, and its connection pool, is shared by all the files. The
+    // concurrent ranged reads need more connections than the SDK default.
+    cfg.maxConnections = kS3DefaultMaxConnections;
+    const char* max_connections = getenv("S3_MAX_CONNECTIONS");
+    if (max_connections) {
+      int32 connections;
+
+      if (strings::safe_strto32(max_connections, &connections)) {
+        cfg.maxConnections = connections;
+      }
+    }
 
     init = true;
   }
@@ -166,9 +187,8 @@ Status ParseS3Path(const string& fname, bool empty_object_ok, string* bucket,
 
 class S3RandomAccessFile : public RandomAccessFile {
  public:
-  S3RandomAccessFile(const string& bucket, const string& object,
-                     std::shared_ptr<Aws::S3::S3Client> s3_client)
-      : bucket_(bucket), object_(object), s3_client_(s3_client) {}
+  S3RandomAccessFile(const string& filename, FileBlockCache* file_block_cache)
+      : filename_(filename), file_block_cache_(file_block_cache) {}
 
   Status Name(StringPiece* result) const override {
     return errors::Unimplemented("S3RandomAccessFile does not support Name()");
@@ -176,39 +196,31 @@ class S3RandomAccessFile : public RandomAccessFile {
 
   Status Read(uint64 offset, size_t n, StringPiece* result,
               char* scratch) const override {
-    Aws::S3::Model::GetObjectRequest getObjectRequest;
-    getObjectRequest.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
-    string bytes = strings::StrCat("bytes=", offset, "-", offset + n - 1);
-    getObjectRequest.SetRange(bytes.c_str());
-    getObjectRequest.SetResponseStreamFactory([]() {
-      return Aws::New<Aws::StringStream>(kS3FileSystemAllocationTag);
-    });
-    auto getObjectOutcome = this->s3_client_->GetObject(getObjectRequest);
-    if (!getObjectOutcome.IsSuccess()) {
-      n = 0;
-      *result = StringPiece(scratch, n);
+    size_t bytes_transferred = 0;
+    Status status = file_block_cache_->Read(filename_, offset, n, scratch,
+                                            &bytes_transferred);
+    *result = StringPiece(scratch, bytes_transferred);
+    TF_RETURN_IF_ERROR(status);
+    if (bytes_transferred < n) {
       return Status(error::OUT_OF_RANGE, "Read less bytes than requested");
     }
-    n = getObjectOutcome.GetResult().GetContentLength();
-    getObjectOutcome.GetResult().GetBody().read(scratch, n);
-
-    *result = StringPiece(scratch, n);
     return Status::OK();
   }
 
  private:
-  string bucket_;
-  string object_;
-  std::shared_ptr<Aws::S3::S3Client> s3_client_;
+  string filename_;
+  FileBlockCache* file_block_cache_;  // Not owned.
 };
 
 class S3WritableFile : public WritableFile {
  public:
   S3WritableFile(const string& bucket, const string& object,
-                 std::shared_ptr<Aws::S3::S3Client> s3_client)
+                 std::shared_ptr<Aws::S3::S3Client> s3_client,
+                 std::function<void()> file_cache_erase)
       : bucket_(bucket),
         object_(object),
         s3_client_(s3_client),
+        file_cache_erase_(std::move(file_cache_erase)),
         sync_needed_(true),
         outfile_(Aws::MakeShared<Aws::Utils::TempFile>(
             kS3FileSystemAllocationTag, "/tmp/s3_filesystem_XXXXXX",
@@ -264,6 +276,7 @@ class S3WritableFile : public WritableFile {
       return errors::Unknown(putObjectOutcome.GetError().GetExceptionName(),
                              ": ", putObjectOutcome.GetError().GetMessage());
     }
+    file_cache_erase_();
     return Status::OK();
   }
 
@@ -271,6 +284,7 @@ class S3WritableFile : public WritableFile {
   string bucket_;
   string object_;
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
+  std::function<void()> file_cache_erase_;
   bool sync_needed_;
   std::shared_ptr<Aws::Utils::TempFile> outfile_;
 };
@@ -287,10 +301,113 @@ class S3ReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
   uint64 length_;
 };
 
+// Reads the value of the environment variable `name` as a uint64, or returns
+// `default_value`.
+uint64 GetEnvUint64(const char* name, uint64 default_value) {
+  const char* value = getenv(name);
+  uint64 result;
+  if (value && strings::safe_strtou64(value, &result)) {
+    return result;
+  }
+  return default_value;
+}
+
+// Reads up to `n` bytes of the object from `offset` into `buffer` with a
+// single ranged GetObject, and stores the number of bytes read in
+// `bytes_transferred`. Fewer than `n` bytes are read at the end of the object,
+// and none if the object doesn't exist.
+Status GetObjectRange(Aws::S3::S3Client* s3_client, const string& bucket,
+                      const string& object, uint64 offset, size_t n,
+                      char* buffer, size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return Status::OK();
+  }
+  Aws::S3::Model::GetObjectRequest getObjectRequest;
+  getObjectRequest.WithBucket(bucket.c_str()).WithKey(object.c_str());
+  string bytes = strings::StrCat("bytes=", offset, "-", offset + n - 1);
+  getObjectRequest.SetRange(bytes.c_str());
+  getObjectRequest.SetResponseStreamFactory([]() {
+    return Aws::New<Aws::StringStream>(kS3FileSystemAllocationTag);
+  });
+  auto getObjectOutcome = s3_client->GetObject(getObjectRequest);
+  if (!getObjectOutcome.IsSuccess()) {
+    const auto response_code = getObjectOutcome.GetError().GetResponseCode();
+    if (response_code ==
+            Aws::Http::HttpResponseCode::REQUESTED_RANGE_NOT_SATISFIABLE ||
+        response_code == Aws::Http::HttpResponseCode::NOT_FOUND) {
+      return Status::OK();
+    }
+    return errors::Unknown(getObjectOutcome.GetError().GetExceptionName(),
+                           ": ", getObjectOutcome.GetError().GetMessage());
+  }
+  *bytes_transferred = std::min<size_t>(
+      n, getObjectOutcome.GetResult().GetContentLength());
+  getObjectOutcome.GetResult().GetBody().read(buffer, *bytes_transferred);
+  return Status::OK();
+}
+
+// Same as GetObjectRange(), with large reads split into chunks that are read
+// with concurrent ranged GetObject requests.
+Status ParallelGetObjectRange(Aws::S3::S3Client* s3_client,
+                              const string& bucket, const string& object,
+                              uint64 offset, size_t n, char* buffer,
+                              size_t* bytes_transferred) {
+  if (n < 2 * kS3MultiPartDownloadChunkSize) {
+    return GetObjectRange(s3_client, bucket, object, offset, n, buffer,
+                          bytes_transferred);
+  }
+  const int num_chunks =
+      (n + kS3MultiPartDownloadChunkSize - 1) / kS3MultiPartDownloadChunkSize;
+  auto chunk_size = [n](int i) {
+    return std::min(kS3MultiPartDownloadChunkSize,
+                    n - i * kS3MultiPartDownloadChunkSize);
+  };
+  std::vector<Status> statuses(num_chunks);
+  std::vector<size_t> chunk_bytes(num_chunks);
+  const int num_workers = std::min(num_chunks, kS3MaxParallelDownloads);
+  BlockingCounter counter(num_workers);
+  for (int worker = 0; worker < num_workers; ++worker) {
+    Env::Default()->SchedClosure([&, worker]() {
+      for (int i = worker; i < num_chunks; i += num_workers) {
+        const size_t begin = i * kS3MultiPartDownloadChunkSize;
+        statuses[i] =
+            GetObjectRange(s3_client, bucket, object, offset + begin,
+                           chunk_size(i), buffer + begin, &chunk_bytes[i]);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  // The bytes read are contiguous up to the first short chunk, which holds
+  // the end of the object.
+  *bytes_transferred = 0;
+  for (int i = 0; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    *bytes_transferred += chunk_bytes[i];
+    if (chunk_bytes[i] < chunk_size(i)) break;
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 S3FileSystem::S3FileSystem()
-    : s3_client_(nullptr, ShutdownClient), client_lock_() {}
+    : s3_client_(nullptr, ShutdownClient), client_lock_() {
+  const uint64 block_size =
+      GetEnvUint64("S3_READ_CACHE_BLOCK_SIZE_MB", kS3DefaultBlockSizeMb) *
+      1024 * 1024;
+  const uint64 max_bytes =
+      GetEnvUint64("S3_READ_CACHE_MAX_SIZE_MB", 0) * 1024 * 1024;
+  const uint64 max_staleness = GetEnvUint64("S3_READ_CACHE_MAX_STALENESS", 0);
+  file_block_cache_.reset(new RamFileBlockCache(
+      block_size, max_bytes, max_staleness,
+      [this](const string& filename, size_t offset, size_t n, char* buffer,
+             size_t* bytes_transferred) {
+        return LoadBufferFromS3(filename, offset, n, buffer,
+                                bytes_transferred);
+      }));
+}
 
 S3FileSystem::~S3FileSystem() {}
 
@@ -328,15 +445,26 @@ Status S3FileSystem::NewRandomAccessFile(
     const string& fname, std::unique_ptr<RandomAccessFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3RandomAccessFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3RandomAccessFile(fname, file_block_cache_.get()));
   return Status::OK();
 }
 
+Status S3FileSystem::LoadBufferFromS3(const string& fname, size_t offset,
+                                      size_t n, char* buffer,
+                                      size_t* bytes_transferred) {
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  return ParallelGetObjectRange(this->GetS3Client().get(), bucket, object,
+                                offset, n, buffer, bytes_transferred);
+}
+
 Status S3FileSystem::NewWritableFile(const string& fname,
                                      std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3WritableFile(
+      bucket, object, this->GetS3Client(),
+      [this, fname]() { file_block_cache_->RemoveFile(fname); }));
   return Status::OK();
 }
 
@@ -351,7 +479,9 @@ Status S3FileSystem::NewAppendableFile(const string& fname,
 
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3WritableFile(
+      bucket, object, this->GetS3Client(),
+      [this, fname]() { file_block_cache_->RemoveFile(fname); }));
 
   while (true) {
     status = reader->Read(offset, kS3ReadAppendableFileBufferSize, &read_chunk,
@@ -515,6 +645,7 @@ Status S3FileSystem::DeleteFile(const string& fname) {
     return errors::Unknown(deleteObjectOutcome.GetError().GetExceptionName(),
                            ": ", deleteObjectOutcome.GetError().GetMessage());
   }
+  file_block_cache_->RemoveFile(fname);
   return Status::OK();
 }
 
@@ -644,6 +775,10 @@ Status S3FileSystem::RenameFile(const string& src, const string& target) {
             deleteObjectOutcome.GetError().GetExceptionName(), ": ",
             deleteObjectOutcome.GetError().GetMessage());
       }
+      file_block_cache_->RemoveFile(
+          strings::StrCat("s3://", src_bucket, "/", src_key.c_str()));
+      file_block_cache_->RemoveFile(
+          strings::StrCat("s3://", target_bucket, "/", target_key.c_str()));
     }
     listObjectsRequest.SetMarker(listObjectsResult.GetNextMarker());
   } while (listObjectsResult.GetIsTruncated());
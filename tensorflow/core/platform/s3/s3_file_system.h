@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CONTRIB_S3_S3_FILE_SYSTEM_H_
 
 #include <aws/s3/S3Client.h>
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 
@@ -75,9 +76,20 @@ class S3FileSystem : public FileSystem {
   // for a bucket.
   std::shared_ptr<Aws::S3::S3Client> GetS3Client();
 
+  // Reads up to `n` bytes of `fname` from `offset`, with concurrent ranged
+  // GetObject requests for large reads. This is the fetcher of the block
+  // cache.
+  Status LoadBufferFromS3(const string& fname, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred);
+
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
   // Lock held when checking for s3_client_ initialization.
   mutex client_lock_;
+
+  // The block cache of the reads, shared by all the files. It is sized with
+  // `S3_READ_CACHE_BLOCK_SIZE_MB` and `S3_READ_CACHE_MAX_SIZE_MB` (0, the
+  // default, passes the reads through), and `S3_READ_CACHE_MAX_STALENESS`.
+  std::unique_ptr<FileBlockCache> file_block_cache_;
 };
 
 }  // namespace tensorflow
@@ -91,6 +91,31 @@ TEST_F(S3FileSystemTest, NewRandomAccessFile) {
   EXPECT_EQ(content.substr(2, 4), result);
 }
 
+TEST_F(S3FileSystemTest, NewRandomAccessFile_MultiPartRead) {
+  const string fname = TmpDir("MultiPartRead");
+  // Read with three concurrent ranged requests, the last one partial.
+  string content(40 * 1024 * 1024, 'a');
+  for (size_t i = 0; i < content.size(); i += 4096) {
+    content[i] = 'a' + (i / 4096) % 26;
+  }
+  TF_ASSERT_OK(WriteString(fname, content));
+
+  string got;
+  TF_EXPECT_OK(ReadAll(fname, &got));
+  EXPECT_EQ(content, got);
+
+  // Reading past the end of the file returns the available bytes.
+  std::unique_ptr<RandomAccessFile> reader;
+  TF_ASSERT_OK(s3fs.NewRandomAccessFile(fname, &reader));
+  got.resize(content.size());
+  StringPiece result;
+  EXPECT_EQ(error::OUT_OF_RANGE,
+            reader->Read(8 * 1024 * 1024, content.size(), &result,
+                         gtl::string_as_array(&got))
+                .code());
+  EXPECT_EQ(content.substr(8 * 1024 * 1024), result);
+}
+
 TEST_F(S3FileSystemTest, NewWritableFile) {
   std::unique_ptr<WritableFile> writer;
   const string fname = TmpDir("WritableFile");
@@ -80,6 +80,14 @@ Status HostTracer::Stop() {
   }
   events_ = TraceMeRecorder::Stop();
   recording_ = false;
+  uint64 dropped_events = 0;
+  for (const auto& thread : events_) {
+    dropped_events += thread.dropped_events;
+  }
+  if (dropped_events > 0) {
+    LOG(WARNING) << "TraceMeRecorder dropped " << dropped_events
+                 << " events because the per-thread buffers were full.";
+  }
   return Status::OK();
 }
 
@@ -0,0 +1,145 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/internal/gpu/gpu_kernel_sampler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/annotation.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/internal/gpu/cupti_wrapper.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+auto* gpu_kernel_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/profiler/gpu/kernel_time_usecs",
+     "The time of the GPU kernels sampled by the GPU kernel sampler in "
+     "microseconds.",
+     "op"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+}  // namespace
+
+// Adds the kernel activity events to gpu_kernel_time_usecs.
+class GpuKernelSampler::Collector : public CuptiTraceCollector {
+ public:
+  Collector() : CuptiTraceCollector(Options()) {}
+
+  void AddEvent(CuptiTracerEvent&& event) override {
+    if (event.type != CuptiTracerEventType::Kernel ||
+        event.source != CuptiTracerEventSource::Activity ||
+        event.end_time_ns < event.start_time_ns) {
+      return;
+    }
+    // Kernels launched outside of any op are labeled by their name.
+    const absl::string_view op =
+        event.annotation.empty() ? event.name : event.annotation;
+    gpu_kernel_time_usecs->GetCell(string(op))
+        ->Add((event.end_time_ns - event.start_time_ns) / 1000.0);
+  }
+
+  void OnEventsDropped(const string& reason, uint32 num_events) override {
+    VLOG(1) << "GPU kernel sampler dropped " << num_events
+            << " events: " << reason;
+  }
+
+  void Flush() override {}
+
+ private:
+  static CuptiTracerCollectorOptions Options() {
+    CuptiTracerCollectorOptions options;
+    // The callback API is only used to map the kernels to their op.
+    options.max_callback_api_events = 0;
+    return options;
+  }
+};
+
+GpuKernelSampler::GpuKernelSampler(const GpuKernelSamplerOptions& options)
+    : options_(options),
+      cupti_interface_(absl::make_unique<CuptiWrapper>()),
+      collector_(absl::make_unique<Collector>()) {
+  thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "gpu_kernel_sampler", [this]() { Run(); }));
+}
+
+GpuKernelSampler::~GpuKernelSampler() {
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+    cv_.notify_all();
+  }
+  // Joins the thread.
+  thread_.reset();
+}
+
+void GpuKernelSampler::Run() {
+  const auto idle_time = std::chrono::milliseconds(
+      std::max<int64>(0, options_.period_ms - options_.duration_ms));
+  mutex_lock l(mu_);
+  while (true) {
+    cv_.wait_for(l, idle_time);
+    if (stopping_) return;
+    CuptiTracer* tracer = CuptiTracer::GetCuptiTracerSingleton();
+    if (!tracer->IsAvailable()) {
+      VLOG(1) << "CUPTI is in use, skipping a GPU kernel sampling window";
+      continue;
+    }
+    CuptiTracerOptions tracer_options;
+    tracer_options.required_callback_api_events = false;
+    tracer_options.cbids_selected = {CUPTI_DRIVER_TRACE_CBID_cuLaunchKernel};
+    tracer_options.activities_selected = {
+        CUPTI_ACTIVITY_KIND_CONCURRENT_KERNEL};
+    // The annotations name the op of the kernels. They may already be enabled
+    // by a profiler session.
+    const bool annotations_enabled = tracing::ScopedAnnotation::IsEnabled();
+    if (!annotations_enabled) tracing::ScopedAnnotation::Enable(true);
+    tracer->Enable(tracer_options, cupti_interface_.get(), collector_.get());
+    cv_.wait_for(l, std::chrono::milliseconds(options_.duration_ms));
+    tracer->Disable();
+    if (!annotations_enabled) tracing::ScopedAnnotation::Enable(false);
+  }
+}
+
+/* static */ void GpuKernelSampler::MaybeStartFromEnvironment() {
+  GpuKernelSamplerOptions options;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_GPU_KERNEL_SAMPLING_PERIOD_MS", 0,
+                                  &options.period_ms));
+  if (options.period_ms <= 0) return;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_GPU_KERNEL_SAMPLING_DURATION_MS",
+                                  options.duration_ms, &options.duration_ms));
+  LOG(INFO) << "Sampling GPU kernels for " << options.duration_ms
+            << "ms every " << options.period_ms << "ms";
+  static GpuKernelSampler* sampler = new GpuKernelSampler(options);
+  (void)sampler;
+}
+
+namespace {
+
+auto start_gpu_kernel_sampler = [] {
+  GpuKernelSampler::MaybeStartFromEnvironment();
+  return 0;
+}();
+
+}  // namespace
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_GPU_GPU_KERNEL_SAMPLER_H_
+#define TENSORFLOW_CORE_PROFILER_INTERNAL_GPU_GPU_KERNEL_SAMPLER_H_
+
+#include <memory>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/gpu/cupti_interface.h"
+#include "tensorflow/core/profiler/internal/gpu/cupti_tracer.h"
+
+namespace tensorflow {
+namespace profiler {
+
+struct GpuKernelSamplerOptions {
+  // Time between the starts of two sampling windows.
+  int64 period_ms = 60 * 1000;
+  // Duration of a sampling window.
+  int64 duration_ms = 1000;
+};
+
+// Keeps lightweight GPU profiling on in production. During a sampling window
+// of `duration_ms` every `period_ms`, the kernels are recorded with the CUPTI
+// activity API, and their times are added to the histograms of the
+// /tensorflow/core/profiler/gpu/kernel_time_usecs metric, labeled by the
+// TensorFlow op that launched them.
+//
+// Only the kernel launch callback is enabled, to map the kernels to their op,
+// and it does not create any event. Outside of the windows, CUPTI is
+// disabled. A window is skipped if another profiler session uses CUPTI.
+class GpuKernelSampler {
+ public:
+  explicit GpuKernelSampler(const GpuKernelSamplerOptions& options);
+  // Waits for the current window to finish.
+  ~GpuKernelSampler();
+
+  // Starts a sampler if TF_GPU_KERNEL_SAMPLING_PERIOD_MS is set to a positive
+  // number of milliseconds. TF_GPU_KERNEL_SAMPLING_DURATION_MS sets the
+  // duration of the windows. The sampler lives until the process exits.
+  static void MaybeStartFromEnvironment();
+
+ private:
+  class Collector;
+
+  // Runs the sampling windows until the sampler is destroyed.
+  void Run();
+
+  const GpuKernelSamplerOptions options_;
+  std::unique_ptr<CuptiInterface> cupti_interface_;
+  std::unique_ptr<Collector> collector_;
+  mutex mu_;
+  condition_variable cv_;
+  bool stopping_ GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuKernelSampler);
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_INTERNAL_GPU_GPU_KERNEL_SAMPLER_H_
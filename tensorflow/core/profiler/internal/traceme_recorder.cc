@@ -23,6 +23,9 @@ namespace profiler {
 
 std::atomic<int> TraceMeRecorder::trace_level_ =
     ATOMIC_VAR_INIT(TraceMeRecorder::kTracingDisabled);
+std::atomic<size_t> TraceMeRecorder::max_events_per_thread_ =
+    ATOMIC_VAR_INIT(TraceMeRecorder::kDefaultMaxEventsPerThread);
+constexpr size_t TraceMeRecorder::kDefaultMaxEventsPerThread;
 
 // Implementation of TraceMeRecorder::trace_level_ must be lock-free for faster
 // execution of the TraceMe() public API. This can be commented (if compilation
@@ -43,7 +46,12 @@ namespace {
 //
 // Push writes at end_, and then advances it, allocating a block if needed.
 // PopAll takes ownership of events in the range [start_, end_).
-// The end_ pointer is atomic so Push and PopAll can be concurrent.
+// The start_ and end_ pointers are atomic so Push and PopAll can be concurrent.
+//
+// The queue holds at most `max_events` events: Push drops the event and
+// increments a counter instead of growing the queue further. The blocks are
+// freed as soon as they are popped, so a consumer that pops regularly keeps
+// the memory of a long trace bounded.
 //
 // Push and PopAll are lock free and each might be called from at most one
 // thread. Push is only called by the owner thread. PopAll is called by the
@@ -60,7 +68,7 @@ class EventQueue {
       : start_block_(new Block{/*start=*/0, /*next=*/nullptr}),
         start_(start_block_->start),
         end_block_(start_block_),
-        end_(start_) {}
+        end_(start_block_->start) {}
 
   // REQUIRES: PopAll() was called since the last Push().
   // Memory should be deallocated and trace events destroyed on destruction.
@@ -72,9 +80,15 @@ class EventQueue {
     delete end_block_;
   }
 
-  // Add a new event to the back of the queue. Fast and lock-free.
-  void Push(TraceMeRecorder::Event&& event) {
+  // Add a new event to the back of the queue, or drops it if the queue holds
+  // `max_events` events. Fast and wait-free.
+  void Push(TraceMeRecorder::Event&& event, size_t max_events) {
     size_t end = end_.load(std::memory_order_relaxed);
+    if (ABSL_PREDICT_FALSE(end - start_.load(std::memory_order_acquire) >=
+                           max_events)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
     new (&end_block_->events[end++ - end_block_->start].event)
         TraceMeRecorder::Event(std::move(event));
     if (ABSL_PREDICT_FALSE(end - end_block_->start == Block::kNumSlots)) {
@@ -92,17 +106,23 @@ class EventQueue {
     // Read index before contents.
     size_t end = end_.load(std::memory_order_acquire);
     std::vector<TraceMeRecorder::Event> result;
-    result.reserve(end - start_);
-    while (start_ != end) {
+    result.reserve(end - start_.load(std::memory_order_relaxed));
+    while (start_.load(std::memory_order_relaxed) != end) {
       result.emplace_back(Pop());
     }
     return result;
   }
 
+  // Returns the number of events dropped since the previous call.
+  uint64 TakeDropped() {
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
  private:
   // Returns true if the queue is empty at the time of invocation.
   bool Empty() const {
-    return (start_ == end_.load(std::memory_order_acquire));
+    return (start_.load(std::memory_order_relaxed) ==
+            end_.load(std::memory_order_acquire));
   }
 
   // Remove one event off the front of the queue and return it.
@@ -110,17 +130,20 @@ class EventQueue {
   TraceMeRecorder::Event Pop() {
     DCHECK(!Empty());
     // Move the next event into the output.
-    auto& event = start_block_->events[start_++ - start_block_->start].event;
+    size_t start = start_.load(std::memory_order_relaxed);
+    auto& event = start_block_->events[start++ - start_block_->start].event;
     TraceMeRecorder::Event out = std::move(event);
     event.~Event();  // Events must be individually destroyed.
     // If we reach the end of a block, we own it and should delete it.
     // The next block is present: end always points to something.
-    if (ABSL_PREDICT_FALSE(start_ - start_block_->start == Block::kNumSlots)) {
+    if (ABSL_PREDICT_FALSE(start - start_block_->start == Block::kNumSlots)) {
       auto* next_block = start_block_->next;
       delete start_block_;
       start_block_ = next_block;
-      DCHECK_EQ(start_, start_block_->start);
+      DCHECK_EQ(start, start_block_->start);
     }
+    // Release the slot to the producer after the event is moved out.
+    start_.store(start, std::memory_order_release);
     return out;
   }
 
@@ -146,10 +169,12 @@ class EventQueue {
 
   // Head of list for reading. Only accessed by consumer thread.
   Block* start_block_;
-  size_t start_;
+  std::atomic<size_t> start_;  // Atomic: also read by producer thread.
   // Tail of list for writing. Accessed by producer thread.
   Block* end_block_;
   std::atomic<size_t> end_;  // Atomic: also read by consumer thread.
+  // Number of events dropped by Push since the last TakeDropped.
+  std::atomic<uint64> dropped_{0};
 };
 
 }  // namespace
@@ -171,11 +196,17 @@ class TraceMeRecorder::ThreadLocalRecorder {
   ~ThreadLocalRecorder() { TraceMeRecorder::Get()->UnregisterThread(Clear()); }
 
   // Record is only called from the owner thread.
-  void Record(TraceMeRecorder::Event&& event) { queue_.Push(std::move(event)); }
+  void Record(TraceMeRecorder::Event&& event) {
+    queue_.Push(std::move(event),
+                max_events_per_thread_.load(std::memory_order_relaxed));
+  }
 
-  // Clear is called from the control thread when tracing starts/stops, or from
-  // the owner thread when it shuts down (see destructor).
-  TraceMeRecorder::ThreadEvents Clear() { return {info_, queue_.PopAll()}; }
+  // Clear is called from the control thread when tracing starts/stops or its
+  // events are consumed, or from the owner thread when it shuts down (see
+  // destructor).
+  TraceMeRecorder::ThreadEvents Clear() {
+    return {info_, queue_.PopAll(), queue_.TakeDropped()};
+  }
 
  private:
   TraceMeRecorder::ThreadInfo info_;
@@ -212,9 +243,14 @@ TraceMeRecorder::Events TraceMeRecorder::Clear() {
   return result;
 }
 
-bool TraceMeRecorder::StartRecording(int level) {
+bool TraceMeRecorder::StartRecording(int level, size_t max_events_per_thread) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
+  if (trace_level_.load(std::memory_order_acquire) != kTracingDisabled) {
+    return false;
+  }
+  max_events_per_thread_.store(max_events_per_thread,
+                               std::memory_order_relaxed);
   // Change trace_level_ while holding mutex_.
   int expected = kTracingDisabled;
   bool started = trace_level_.compare_exchange_strong(
@@ -242,5 +278,14 @@ TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   return events;
 }
 
+TraceMeRecorder::Events TraceMeRecorder::ConsumeRecording() {
+  TraceMeRecorder::Events events;
+  mutex_lock lock(mutex_);
+  if (trace_level_.load(std::memory_order_acquire) != kTracingDisabled) {
+    events = Clear();
+  }
+  return events;
+}
+
 }  // namespace profiler
 }  // namespace tensorflow
@@ -56,18 +56,34 @@ class TraceMeRecorder {
   struct ThreadEvents {
     ThreadInfo thread;
     std::vector<Event> events;
+    // The number of events of the thread dropped because its buffer was full.
+    uint64 dropped_events = 0;
   };
   using Events = std::vector<ThreadEvents>;
 
+  // The default maximum number of events buffered per thread, about 56 MiB.
+  static constexpr size_t kDefaultMaxEventsPerThread = 1 << 20;
+
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
   // Level must be >= 0. If level is 0, no traces will be recorded.
-  static bool Start(int level) { return Get()->StartRecording(level); }
+  // At most `max_events_per_thread` events are buffered per thread, further
+  // events are dropped and counted in ThreadEvents::dropped_events.
+  static bool Start(int level,
+                    size_t max_events_per_thread = kDefaultMaxEventsPerThread) {
+    return Get()->StartRecording(level, max_events_per_thread);
+  }
 
   // Stops recording and returns events recorded since Start().
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // Returns the events recorded since Start() or the previous Consume(),
+  // without stopping the recording. Long traces can be drained periodically
+  // so that the per-thread buffers do not fill up. Returns no events if the
+  // recorder is not started.
+  static Events Consume() { return Get()->ConsumeRecording(); }
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
     return ABSL_PREDICT_FALSE(trace_level_.load(std::memory_order_acquire) >=
@@ -95,8 +111,9 @@ class TraceMeRecorder {
   void RegisterThread(int32 tid, ThreadLocalRecorder* thread);
   void UnregisterThread(ThreadEvents&& events);
 
-  bool StartRecording(int level);
+  bool StartRecording(int level, size_t max_events_per_thread);
   Events StopRecording();
+  Events ConsumeRecording();
 
   // Gathers events from all active threads, and clears their buffers.
   Events Clear() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -106,6 +123,9 @@ class TraceMeRecorder {
   // Modified by TraceMeRecorder singleton when tracing starts/stops.
   static std::atomic<int> trace_level_;
 
+  // Maximum number of events buffered per thread. Set when tracing starts.
+  static std::atomic<size_t> max_events_per_thread_;
+
   mutex mutex_;
   // Map of the static container instances (thread_local storage) for each
   // thread. While active, a ThreadLocalRecorder stores trace events.
@@ -46,6 +46,46 @@ TEST(RecorderTest, SingleThreaded) {
               ::testing::ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, DropsEventsWhenFull) {
+  uint64 start_time = Env::Default()->NowNanos();
+  uint64 end_time = start_time + kNanosInSec;
+
+  TraceMeRecorder::Start(/*level=*/1, /*max_events_per_thread=*/2);
+  TraceMeRecorder::Record({1, "kept1", start_time, end_time});
+  TraceMeRecorder::Record({2, "kept2", start_time, end_time});
+  TraceMeRecorder::Record({3, "dropped", start_time, end_time});
+  auto results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events,
+              ::testing::ElementsAre(Named("kept1"), Named("kept2")));
+  EXPECT_EQ(results[0].dropped_events, 1);
+}
+
+TEST(RecorderTest, ConsumeWhileRecording) {
+  uint64 start_time = Env::Default()->NowNanos();
+  uint64 end_time = start_time + kNanosInSec;
+
+  TraceMeRecorder::Start(/*level=*/1, /*max_events_per_thread=*/2);
+  TraceMeRecorder::Record({1, "first1", start_time, end_time});
+  TraceMeRecorder::Record({2, "first2", start_time, end_time});
+  auto first = TraceMeRecorder::Consume();
+  EXPECT_TRUE(TraceMeRecorder::Active());
+  // The consumed events free up the buffer.
+  TraceMeRecorder::Record({3, "second1", start_time, end_time});
+  TraceMeRecorder::Record({4, "second2", start_time, end_time});
+  auto second = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(first.size(), 1);
+  EXPECT_THAT(first[0].events,
+              ::testing::ElementsAre(Named("first1"), Named("first2")));
+  ASSERT_EQ(second.size(), 1);
+  EXPECT_THAT(second[0].events,
+              ::testing::ElementsAre(Named("second1"), Named("second2")));
+  EXPECT_EQ(second[0].dropped_events, 0);
+  EXPECT_TRUE(TraceMeRecorder::Consume().empty());
+}
+
 void SpinNanos(int nanos) {
   uint64 deadline = Env::Default()->NowNanos() + nanos;
   while (Env::Default()->NowNanos() < deadline) {
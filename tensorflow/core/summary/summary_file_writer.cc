@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
 
@@ -34,7 +35,9 @@ class SummaryFileWriter : public SummaryWriterInterface {
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
-        env_(env) {}
+        env_(env),
+        flush_requested_(false),
+        shutdown_(false) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
     const Status is_dir = env_->IsDirectory(logdir);
@@ -44,26 +47,41 @@ class SummaryFileWriter : public SummaryWriterInterface {
       }
       TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
     }
-    mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(filename_suffix),
-        "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
+    {
+      mutex_lock wl(writer_mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(filename_suffix),
+          "Could not initialize events writer.");
+    }
     is_initialized_ = true;
+    writer_thread_.reset(env_->StartThread(ThreadOptions(),
+                                           "summary_file_writer",
+                                           [this]() { WriterLoop(); }));
     return Status::OK();
   }
 
+  // Writes all the events enqueued so far, on the calling thread, and returns
+  // the first error from the writer thread since the last call, if any.
   Status Flush() override {
-    mutex_lock ml(mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    const Status s = WriteQueuedEvents();
+    mutex_lock ml(mu_);
+    Status status = TakeWriterStatus();
+    status.Update(s);
+    return status;
   }
 
   ~SummaryFileWriter() override {
+    {
+      mutex_lock ml(mu_);
+      shutdown_ = true;
+      cond_.notify_all();
+    }
+    writer_thread_.reset();
     (void)Flush();  // Ignore errors.
   }
 
@@ -138,14 +156,21 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return WriteEvent(std::move(e));
   }
 
+  // Enqueues `event` for the writer thread, which writes the queue once it
+  // holds more than max_queue events, and at least every flush_millis
+  // milliseconds. Blocks while a full queue is waiting for the writer thread,
+  // so that memory stays bounded when the file system is slow.
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    while (queue_.size() > max_queue_ && !shutdown_) {
+      cond_.wait(ml);
+    }
     queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+    if (queue_.size() > max_queue_) {
+      flush_requested_ = true;
+      cond_.notify_all();
     }
-    return Status::OK();
+    return TakeWriterStatus();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -155,28 +180,75 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Writes and flushes the events in the queue. Holding writer_mu_ while the
+  // queue is taken keeps the events of concurrent calls in order.
+  Status WriteQueuedEvents() LOCKS_EXCLUDED(writer_mu_, mu_) {
+    mutex_lock wl(writer_mu_);
+    std::vector<std::unique_ptr<Event>> events;
+    {
+      mutex_lock ml(mu_);
+      events.swap(queue_);
+      flush_requested_ = false;
+      // Wakes up the callers of WriteEvent blocked on a full queue.
+      cond_.notify_all();
+    }
+    if (events.empty()) {
+      return Status::OK();
+    }
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
+  void WriterLoop() {
+    while (true) {
+      {
+        mutex_lock ml(mu_);
+        if (!flush_requested_ && !shutdown_) {
+          if (flush_millis_ > 0) {
+            WaitForMilliseconds(&ml, &cond_, flush_millis_);
+          } else {
+            cond_.wait(ml);
+          }
+        }
+        // The destructor writes the remaining events.
+        if (shutdown_) return;
+      }
+      const Status s = WriteQueuedEvents();
+      if (!s.ok()) {
+        mutex_lock ml(mu_);
+        writer_status_.Update(s);
+      }
+    }
+  }
+
+  Status TakeWriterStatus() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status s = writer_status_;
+    writer_status_ = Status::OK();
+    return s;
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
   Env* env_;
+  mutex writer_mu_ ACQUIRED_BEFORE(mu_);
+  // A pointer to allow deferred construction.
+  std::unique_ptr<EventsWriter> events_writer_ GUARDED_BY(writer_mu_);
   mutex mu_;
+  condition_variable cond_;
   std::vector<std::unique_ptr<Event>> queue_ GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ GUARDED_BY(mu_);
+  bool flush_requested_ GUARDED_BY(mu_);
+  bool shutdown_ GUARDED_BY(mu_);
+  // The first error of the writer thread not yet returned to a caller.
+  Status writer_status_ GUARDED_BY(mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       GUARDED_BY(mu_);
+  // Writes the queue in the background.
+  std::unique_ptr<Thread> writer_thread_;
 };
 
 }  // namespace
@@ -231,5 +231,41 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+TEST_F(SummaryFileWriterTest, WritesInBackground) {
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(100, 1, testing::TmpDir(),
+                                      "background_test", &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  std::unique_ptr<Event> e{new Event};
+  e->set_step(7);
+  TF_CHECK_OK(writer->WriteEvent(std::move(e)));
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  string filename;
+  for (const string& f : files) {
+    if (absl::StrContains(f, "background_test")) {
+      filename = io::JoinPath(testing::TmpDir(), f);
+    }
+  }
+  ASSERT_FALSE(filename.empty());
+
+  // Without any call to Flush(), the event is written within flush_millis.
+  Event event;
+  for (int attempt = 0; attempt < 1000 && event.step() != 7; ++attempt) {
+    env_.SleepForMicroseconds(10 * 1000);
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env_.NewRandomAccessFile(filename, &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    string record;
+    uint64 offset = 0;
+    if (reader.ReadRecord(&offset, &record).ok() &&
+        reader.ReadRecord(&offset, &record).ok()) {
+      event.ParseFromString(record);
+    }
+  }
+  EXPECT_EQ(event.step(), 7);
+}
+
 }  // namespace
 }  // namespace tensorflow
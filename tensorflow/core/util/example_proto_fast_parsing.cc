@@ -335,8 +335,17 @@ bool ParseFeatureMapEntry(protobuf::io::CodedInputStream* stream,
   return true;
 }
 
+struct KeepAllFeatures {
+  bool operator()(StringPiece feature_name) const { return true; }
+};
+
+// Only features whose name satisfies `keep` are added to `example`, so that
+// callers do not have to iterate over features they do not need. The values
+// of the other features are skipped without being parsed.
+template <typename FeatureFilter>
 bool ParseFeatures(protobuf::io::CodedInputStream* stream,
-                   parsed::Example* example) {
+                   const FeatureFilter& keep, parsed::Example* example,
+                   size_t* num_features) {
   DCHECK(stream != nullptr);
   DCHECK(example != nullptr);
   uint32 length;
@@ -346,14 +355,19 @@ bool ParseFeatures(protobuf::io::CodedInputStream* stream,
     parsed::FeatureMapEntry feature_map_entry;
     if (!stream->ExpectTag(kDelimitedTag(1))) return false;
     if (!ParseFeatureMapEntry(stream, &feature_map_entry)) return false;
-    example->push_back(std::move(feature_map_entry));
+    ++*num_features;
+    if (keep(feature_map_entry.first)) {
+      example->push_back(std::move(feature_map_entry));
+    }
   }
   stream->PopLimit(limit);
   return true;
 }
 
+template <typename FeatureFilter>
 bool ParseExample(protobuf::io::CodedInputStream* stream,
-                  parsed::Example* example) {
+                  const FeatureFilter& keep, parsed::Example* example,
+                  size_t* num_features) {
   DCHECK(stream != nullptr);
   DCHECK(example != nullptr);
   // Loop over the input stream which may contain multiple serialized Example
@@ -363,18 +377,28 @@ bool ParseExample(protobuf::io::CodedInputStream* stream,
     if (!stream->ExpectTag(kDelimitedTag(1))) {
       if (!SkipExtraneousTag(stream)) return false;
     } else {
-      if (!ParseFeatures(stream, example)) return false;
+      if (!ParseFeatures(stream, keep, example, num_features)) return false;
     }
   }
   return true;
 }
 
-bool ParseExample(StringPiece serialized, parsed::Example* example) {
+// Sets `*num_features` to the number of features in `serialized`, including
+// those that were filtered out.
+template <typename FeatureFilter>
+bool ParseExample(StringPiece serialized, const FeatureFilter& keep,
+                  parsed::Example* example, size_t* num_features) {
   DCHECK(example != nullptr);
   protobuf::io::CodedInputStream stream(
       reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
   EnableAliasing(&stream);
-  return ParseExample(&stream, example);
+  *num_features = 0;
+  return ParseExample(&stream, keep, example, num_features);
+}
+
+bool ParseExample(StringPiece serialized, parsed::Example* example) {
+  size_t num_features;
+  return ParseExample(serialized, KeepAllFeatures(), example, &num_features);
 }
 
 }  // namespace
@@ -482,6 +506,100 @@ struct SeededHasher {
   uint64 seed{0xDECAFCAFFE};
 };
 
+}  // namespace
+
+struct FastParseExampleConfigIndex::Impl {
+  explicit Impl(size_t config_size) : config_index(config_size) {}
+
+  // Looks up the sub-config for `feature_name`.
+  bool Find(StringPiece feature_name,
+            std::pair<size_t, Type>* d_and_type) const {
+    // Most of the features of wide examples are not requested, and comparing
+    // the length of their names is cheaper than hashing them.
+    if ((name_length_mask & (uint64{1} << (feature_name.size() % 64))) == 0) {
+      return false;
+    }
+    if (!config_index.Find(hasher(feature_name), d_and_type)) return false;
+    // Testing for PresizedCuckooMap collision.
+    const string& config_feature_name = d_and_type->second == Type::Dense
+                                            ? dense_names[d_and_type->first]
+                                            : sparse_names[d_and_type->first];
+    return feature_name == config_feature_name;
+  }
+
+  bool operator()(StringPiece feature_name) const {
+    std::pair<size_t, Type> unused;
+    return Find(feature_name, &unused);
+  }
+
+  SeededHasher hasher;
+  PresizedCuckooMap<std::pair<size_t, Type>> config_index;
+  std::vector<string> dense_names;
+  std::vector<string> sparse_names;
+  // Bit `n % 64` is set if a requested feature name has length `n`.
+  uint64 name_length_mask = 0;
+};
+
+FastParseExampleConfigIndex::FastParseExampleConfigIndex(
+    std::unique_ptr<Impl> impl)
+    : impl_(std::move(impl)) {}
+
+FastParseExampleConfigIndex::~FastParseExampleConfigIndex() {}
+
+/* static */ Status FastParseExampleConfigIndex::Create(
+    const Config& config,
+    std::shared_ptr<const FastParseExampleConfigIndex>* index) {
+  const size_t config_size = config.dense.size() + config.sparse.size();
+  auto impl = absl::make_unique<Impl>(config_size);
+  for (const auto& c : config.dense) {
+    impl->dense_names.push_back(c.feature_name);
+    impl->name_length_mask |= uint64{1} << (c.feature_name.size() % 64);
+  }
+  for (const auto& c : config.sparse) {
+    impl->sparse_names.push_back(c.feature_name);
+    impl->name_length_mask |= uint64{1} << (c.feature_name.size() % 64);
+  }
+  bool ok = true;
+  for (size_t i = 0; i < 1000; ++i) {
+    for (size_t d = 0; d < config.dense.size(); ++d) {
+      ok &= impl->config_index.InsertUnique(
+          impl->hasher(config.dense[d].feature_name), {d, Type::Dense});
+    }
+    for (size_t d = 0; d < config.sparse.size(); ++d) {
+      ok &= impl->config_index.InsertUnique(
+          impl->hasher(config.sparse[d].feature_name), {d, Type::Sparse});
+    }
+    if (ok) break;
+    LOG(WARNING) << "Collision found. This should happen only if you have "
+                    "around 2^32 entries in your config.";
+    impl->hasher.seed++;
+    impl->config_index.Clear(config_size);
+    ok = true;
+  }
+  if (!ok) {
+    return errors::Internal(
+        "Could not avoid collision. This should not happen.");
+  }
+  index->reset(new FastParseExampleConfigIndex(std::move(impl)));
+  return Status::OK();
+}
+
+bool FastParseExampleConfigIndex::Matches(const Config& config) const {
+  if (config.dense.size() != impl_->dense_names.size() ||
+      config.sparse.size() != impl_->sparse_names.size()) {
+    return false;
+  }
+  for (size_t d = 0; d < config.dense.size(); ++d) {
+    if (config.dense[d].feature_name != impl_->dense_names[d]) return false;
+  }
+  for (size_t d = 0; d < config.sparse.size(); ++d) {
+    if (config.sparse[d].feature_name != impl_->sparse_names[d]) return false;
+  }
+  return true;
+}
+
+namespace {
+
 template <typename T>
 class LimitedArraySlice {
  public:
@@ -544,15 +662,18 @@ void LogSparseFeatureDataLoss(StringPiece feature_name) {
 Status FastParseSerializedExample(
     const string& serialized_example, const string& example_name,
     const size_t example_index, const Config& config,
-    const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
-    SeededHasher hasher, std::vector<Tensor>* output_dense,
+    const FastParseExampleConfigIndex::Impl& config_index,
+    std::vector<Tensor>* output_dense,
     std::vector<SparseBuffer>* output_varlen_dense,
     std::vector<SparseBuffer>* output_sparse,
     PerExampleFeatureStats* output_stats) {
   DCHECK(output_dense != nullptr);
   DCHECK(output_sparse != nullptr);
+  // Only the requested features are kept.
   parsed::Example parsed_example;
-  if (!ParseExample(serialized_example, &parsed_example)) {
+  size_t num_features;
+  if (!ParseExample(serialized_example, config_index, &parsed_example,
+                    &num_features)) {
     return errors::InvalidArgument("Could not parse example input, value: '",
                                    serialized_example, "'");
   }
@@ -566,7 +687,7 @@ Status FastParseSerializedExample(
     // TODO(b/111553342): This may over-count the number of features if there
     // are duplicate keys in the feature map. Consider deduplicating the keys
     // before computing the count.
-    output_stats->features_count = parsed_example_size;
+    output_stats->features_count = num_features;
   }
 
   for (size_t i = 0; i < parsed_example_size; ++i) {
@@ -579,21 +700,11 @@ Status FastParseSerializedExample(
     parsed::Feature& feature = name_and_feature.second;
 
     std::pair<size_t, Type> d_and_type;
-    uint64 h = hasher(feature_name);
-    if (!config_index.Find(h, &d_and_type)) continue;
+    if (!config_index.Find(feature_name, &d_and_type)) continue;
 
     size_t d = d_and_type.first;
     bool is_dense = d_and_type.second == Type::Dense;
 
-    {
-      // Testing for PresizedCuckooMap collision.
-      // TODO(lew): Use dense_hash_map and avoid this and hasher creation.
-      const string& config_feature_name = is_dense
-                                              ? config.dense[d].feature_name
-                                              : config.sparse[d].feature_name;
-      if (feature_name != config_feature_name) continue;
-    }
-
     auto example_error = [&](StringPiece suffix) {
       return errors::InvalidArgument("Name: ", example_name,
                                      ", Key: ", feature_name,
@@ -1018,31 +1129,15 @@ Status FastParseExample(const Config& config,
     result->feature_stats.resize(serialized.size());
   }
 
-  size_t config_size = config.dense.size() + config.sparse.size();
-  SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-    ok = true;
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
+  std::shared_ptr<const FastParseExampleConfigIndex> index = config.index;
+  if (index == nullptr || !index->Matches(config)) {
+    TF_RETURN_IF_ERROR(FastParseExampleConfigIndex::Create(config, &index));
   }
+  const FastParseExampleConfigIndex::Impl& config_index = index->impl();
+
+  Allocator* dense_allocator = config.dense_allocator != nullptr
+                                   ? config.dense_allocator
+                                   : cpu_allocator();
 
   // Allocate dense output for fixed length dense values
   // (variable-length dense and sparse have to be buffered).
@@ -1054,7 +1149,8 @@ Status FastParseExample(const Config& config,
     for (const int64 dim : config.dense[d].shape.dim_sizes()) {
       out_shape.AddDim(dim);
     }
-    fixed_dense_values[d] = Tensor(config.dense[d].dtype, out_shape);
+    fixed_dense_values[d] =
+        Tensor(dense_allocator, config.dense[d].dtype, out_shape);
   }
 
   // This parameter affects performance in a big and data-dependent way.
@@ -1111,7 +1207,7 @@ Status FastParseExample(const Config& config,
       status_of_minibatch[minibatch] = FastParseSerializedExample(
           serialized[e],
           (!example_names.empty() ? example_names[e] : "<unknown>"), e, config,
-          config_index, hasher, &fixed_dense_values,
+          config_index, &fixed_dense_values,
           &varlen_dense_buffers[minibatch], &sparse_buffers[minibatch], stats);
       if (!status_of_minibatch[minibatch].ok()) break;
     }
@@ -1232,7 +1328,7 @@ Status FastParseExample(const Config& config,
     for (int i = 1; i < config.dense[d].shape.dims(); ++i) {
       values_shape.AddDim(config.dense[d].shape.dim_size(i));
     }
-    Tensor values(config.dense[d].dtype, values_shape);
+    Tensor values(dense_allocator, config.dense[d].dtype, values_shape);
     result->dense_values[d] = values;
     const size_t num_elements = values.NumElements();
 
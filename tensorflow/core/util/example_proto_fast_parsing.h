@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 #define TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,6 +35,8 @@ limitations under the License.
 namespace tensorflow {
 namespace example {
 
+class FastParseExampleConfigIndex;
+
 // FastParseExampleConfig defines how to parse features in Example.
 // Each sub-config is responsible for one feature identified with feautre_name.
 // FastParseExampleConfig can't have two sub-configs with the same feature_name.
@@ -63,6 +66,48 @@ struct FastParseExampleConfig {
   // If `true`, `Result::feature_stats` will contain one
   // `PerExampleFeatureStats` for each serialized example in the input.
   bool collect_feature_stats = false;
+
+  // Optional index of the feature names above. If it is not set, or was built
+  // for different feature names, `FastParseExample()` builds one per call.
+  std::shared_ptr<const FastParseExampleConfigIndex> index;
+
+  // Optional allocator for the batched dense outputs of `FastParseExample()`,
+  // which are parsed directly into the tensors it allocates. Callers whose
+  // outputs are copied to a GPU can pass a host allocator for page-locked
+  // memory, so that the copy can be done asynchronously without staging. If
+  // it is not set, `cpu_allocator()` is used.
+  Allocator* dense_allocator = nullptr;
+};
+
+// Maps the feature names of a `FastParseExampleConfig` to its dense and sparse
+// sub-configs, using a hash function that is collision-free on those names.
+// While parsing, features that the config does not request are skipped
+// without being parsed, usually without even hashing their name.
+//
+// Building the index takes time linear in the size of the config, so callers
+// that parse many batches with the same feature names (e.g. kernels) should
+// build it once and store it in `FastParseExampleConfig::index`.
+class FastParseExampleConfigIndex {
+ public:
+  static Status Create(
+      const FastParseExampleConfig& config,
+      std::shared_ptr<const FastParseExampleConfigIndex>* index);
+
+  ~FastParseExampleConfigIndex();
+
+  // Returns true if `config` has the same dense and sparse feature names, in
+  // the same order, as the config that the index was built for.
+  bool Matches(const FastParseExampleConfig& config) const;
+
+  struct Impl;
+  const Impl& impl() const { return *impl_; }
+
+ private:
+  explicit FastParseExampleConfigIndex(std::unique_ptr<Impl> impl);
+
+  std::unique_ptr<Impl> impl_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FastParseExampleConfigIndex);
 };
 
 // Statistics about the features in each example passed to
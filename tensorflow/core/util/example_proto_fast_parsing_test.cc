@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -321,6 +323,92 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+TEST(FastParse, ConfigIndex) {
+  std::vector<tstring> serialized = {ExampleWithSomeFeatures()};
+
+  FastParseExampleConfig config;
+  AddDenseFeature("float_list", DT_FLOAT, {2}, false, 2, &config);
+  AddSparseFeature("int64_list", DT_INT64, &config);
+  // Not present in the example, but has the same length as "bytes_list".
+  AddSparseFeature("bytes_lisp", DT_STRING, &config);
+  config.collect_feature_stats = true;
+
+  std::shared_ptr<const FastParseExampleConfigIndex> index;
+  TF_ASSERT_OK(FastParseExampleConfigIndex::Create(config, &index));
+  EXPECT_TRUE(index->Matches(config));
+
+  FastParseExampleConfig other_config;
+  AddDenseFeature("float_list", DT_FLOAT, {2}, false, 2, &other_config);
+  AddSparseFeature("bytes_list", DT_STRING, &other_config);
+  AddSparseFeature("int64_list", DT_INT64, &other_config);
+  EXPECT_FALSE(index->Matches(other_config));
+
+  // An index that does not match the config must not be used.
+  other_config.index = index;
+  Result other_result;
+  TF_ASSERT_OK(
+      FastParseExample(other_config, serialized, {}, nullptr, &other_result));
+  EXPECT_EQ(2, other_result.sparse_values[0].NumElements());
+
+  Result expected;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &expected));
+  config.index = index;
+  for (int i = 0; i < 2; ++i) {
+    Result result;
+    TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+    test::ExpectTensorEqual<float>(expected.dense_values[0],
+                                   result.dense_values[0]);
+    test::ExpectTensorEqual<int64>(expected.sparse_values[0],
+                                   result.sparse_values[0]);
+    EXPECT_EQ(3, result.sparse_values[0].NumElements());
+    EXPECT_EQ(0, result.sparse_values[1].NumElements());
+    // Features that were not requested still count towards the stats.
+    EXPECT_EQ(7, result.feature_stats[0].features_count);
+  }
+}
+
+// Forwards to `cpu_allocator()` and counts the allocations made through it.
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int num_allocations() const { return num_allocations_; }
+
+ private:
+  int num_allocations_ = 0;
+};
+
+TEST(FastParse, DenseAllocator) {
+  std::vector<tstring> serialized(3, ExampleWithSomeFeatures());
+
+  FastParseExampleConfig config;
+  AddDenseFeature("float_list", DT_FLOAT, {2}, false, 2, &config);
+  AddDenseFeature("int64_list", DT_INT64, {-1}, true, 1, &config);
+  AddSparseFeature("bytes_list", DT_STRING, &config);
+
+  Result expected;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &expected));
+
+  CountingAllocator allocator;
+  config.dense_allocator = &allocator;
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  // Only the two dense outputs are allocated with the dense allocator.
+  EXPECT_EQ(2, allocator.num_allocations());
+  test::ExpectTensorEqual<float>(expected.dense_values[0],
+                                 result.dense_values[0]);
+  test::ExpectTensorEqual<int64>(expected.dense_values[1],
+                                 result.dense_values[1]);
+  test::ExpectTensorEqual<tstring>(expected.sparse_values[0],
+                                   result.sparse_values[0]);
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
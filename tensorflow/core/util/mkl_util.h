@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_MKL_UTIL_H_
 #ifdef INTEL_MKL
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
@@ -32,6 +33,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -1800,6 +1803,74 @@ class MklPrimitive {
 
 const mkldnn::memory::dims NONE_DIMS = {};
 
+//
+// Process-wide accounting of the thread-local LRU caches below. Cached
+// primitives hold the buffers of their last execution and cannot run on two
+// threads at once, so every thread keeps its own cache, but all the caches
+// share a bound on their total number of entries, set by the
+// TF_MKL_PRIMITIVE_CACHE_CAPACITY environment variable (unbounded by
+// default), and export their hits, misses, evictions and size as metrics.
+//
+class LRUCacheStats {
+ public:
+  static void RecordHit() {
+    static monitoring::CounterCell* cell = Lookups()->GetCell("hit");
+    cell->IncrementBy(1);
+  }
+
+  static void RecordMiss() {
+    static monitoring::CounterCell* cell = Lookups()->GetCell("miss");
+    cell->IncrementBy(1);
+  }
+
+  static void RecordInsertion() { UpdateEntries(1); }
+
+  static void RecordRemoval(bool is_eviction) {
+    if (is_eviction) {
+      static monitoring::CounterCell* cell = Lookups()->GetCell("eviction");
+      cell->IncrementBy(1);
+    }
+    UpdateEntries(-1);
+  }
+
+  static void RecordRemovals(int64 count) { UpdateEntries(-count); }
+
+  // Returns true if the caches of all threads hold as many entries as the
+  // process-wide capacity allows.
+  static bool AtProcessCapacity() {
+    static const int64 capacity = [] {
+      int64 capacity;
+      TF_CHECK_OK(ReadInt64FromEnvVar("TF_MKL_PRIMITIVE_CACHE_CAPACITY", -1,
+                                      &capacity));
+      return capacity;
+    }();
+    return capacity >= 0 && Entries()->load() >= capacity;
+  }
+
+ private:
+  static monitoring::Counter<1>* Lookups() {
+    static auto* counter = monitoring::Counter<1>::New(
+        "/tensorflow/core/mkl_primitive_cache_events",
+        "The number of hits, misses and evictions of the MKL primitive "
+        "caches.",
+        "event");
+    return counter;
+  }
+
+  static std::atomic<int64>* Entries() {
+    static std::atomic<int64> entries(0);
+    return &entries;
+  }
+
+  static void UpdateEntries(int64 delta) {
+    static auto* gauge = monitoring::Gauge<int64, 0>::New(
+        "/tensorflow/core/mkl_primitive_cache_entries",
+        "The number of primitives in the MKL primitive caches of all "
+        "threads.");
+    gauge->GetCell()->Set(Entries()->fetch_add(delta) + delta);
+  }
+};
+
 //
 // LRUCache is a class which implements LRU (Least Recently Used) cache.
 // The implementation is similar to that of
@@ -1813,7 +1884,8 @@ const mkldnn::memory::dims NONE_DIMS = {};
 // at the head of LRU list.
 //
 // This class is used to maintain an upper bound on the total number of
-// cached items. When the cache reaches its capacity, the LRU item will
+// cached items. When the cache reaches its capacity, or the caches of all
+// threads reach the process-wide capacity of LRUCacheStats, the LRU item will
 // be removed and replaced by a new one from SetOp call.
 //
 template <typename T>
@@ -1824,11 +1896,15 @@ class LRUCache {
     Clear();
   }
 
+  ~LRUCache() { Clear(); }
+
   T* GetOp(const string& key) {
     auto it = cache_.find(key);
     if (it == cache_.end()) {
+      LRUCacheStats::RecordMiss();
       return nullptr;
     }
+    LRUCacheStats::RecordHit();
 
     // Move to the front of LRU list as the most recently accessed.
     lru_list_.erase(it->second.lru_iterator);
@@ -1838,7 +1914,14 @@ class LRUCache {
   }
 
   void SetOp(const string& key, T* op) {
-    if (lru_list_.size() >= capacity_) {
+    // Replace the entry of an existing key, rather than deleting the new op
+    // that the caller is about to use.
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      Remove(it, /*is_eviction=*/false);
+    }
+    while (!lru_list_.empty() && (lru_list_.size() >= capacity_ ||
+                                  LRUCacheStats::AtProcessCapacity())) {
       Delete();
     }
 
@@ -1846,12 +1929,14 @@ class LRUCache {
     lru_list_.push_front(key);
     Entry entry(op, lru_list_.begin());
     cache_.emplace(std::make_pair(key, std::move(entry)));
+    LRUCacheStats::RecordInsertion();
   }
 
   void Clear() {
     if (lru_list_.empty()) return;
 
     // Clean up the cache
+    LRUCacheStats::RecordRemovals(lru_list_.size());
     cache_.clear();
     lru_list_.clear();
   }
@@ -1887,12 +1972,17 @@ class LRUCache {
   // is the tail of lru_list_. Update cache_ correspondingly.
   bool Delete() {
     if (lru_list_.empty()) return false;
-    string key = lru_list_.back();
-    lru_list_.pop_back();
-    cache_.erase(key);
+    Remove(cache_.find(lru_list_.back()), /*is_eviction=*/true);
     return true;
   }
 
+  void Remove(typename std::unordered_map<string, Entry>::iterator it,
+              bool is_eviction) {
+    lru_list_.erase(it->second.lru_iterator);
+    cache_.erase(it);
+    LRUCacheStats::RecordRemoval(is_eviction);
+  }
+
   // Cache capacity
   size_t capacity_;
 
@@ -116,6 +116,21 @@ TEST(MklUtilTest, LRUCacheTest) {
   }
 }
 
+TEST(MklUtilTest, LRUCacheSetExistingKey) {
+  LRUCache<int> lru_cache(2);
+  lru_cache.SetOp("a", new int(1));
+  lru_cache.SetOp("b", new int(2));
+
+  // Setting an existing key replaces its object and makes it the most
+  // recently accessed one.
+  lru_cache.SetOp("a", new int(3));
+  EXPECT_EQ(*lru_cache.GetOp("a"), 3);
+  lru_cache.SetOp("c", new int(4));
+  EXPECT_EQ(nullptr, lru_cache.GetOp("b"));
+  EXPECT_EQ(*lru_cache.GetOp("a"), 3);
+  EXPECT_EQ(*lru_cache.GetOp("c"), 4);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
@@ -20,7 +20,9 @@ limitations under the License.
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb_text.h"
@@ -33,8 +35,10 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
@@ -42,6 +46,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
 #include "tensorflow/core/util/tensor_slice_util.h"
@@ -51,11 +57,18 @@ namespace tensorflow {
 // Versioning of the tensor bundle format.
 const int kTensorBundleMinProducer = 0;
 const int kTensorBundleMinConsumer = 0;
-const int kTensorBundleVersion = 1;
+const int kTensorBundleVersion = 2;
+
+// Minimum consumer version of the bundles written with compression.
+static const int kTensorBundleMinCompressedConsumer = 2;
 
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
 
+// Entries larger than this are read in chunks of this size, which are read and
+// checksummed concurrently.
+static const int64 kParallelReadChunkSize = 16 << 20;
+
 // Key to the special BundleHeaderProto entry.  Do not change this, as clients
 // can make the assumption that the header is always the first entry in the
 // bundle.
@@ -63,6 +76,112 @@ const char* const kHeaderEntryKey = "";
 
 namespace {
 
+// Returns the thread pool reading the chunks of large entries, or nullptr if
+// the reads are serial.  The number of threads is set by
+// TF_BUNDLE_READER_NUM_THREADS (8 by default, 0 or 1 disables the pool).
+thread::ThreadPool* ParallelReadPool() {
+  static thread::ThreadPool* pool = []() -> thread::ThreadPool* {
+    int64 num_threads;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar("TF_BUNDLE_READER_NUM_THREADS", 8, &num_threads));
+    if (num_threads <= 1) return nullptr;
+    return new thread::ThreadPool(Env::Default(), "bundle_reader",
+                                  num_threads);
+  }();
+  return pool;
+}
+
+// Reads file[offset, offset+size) into "buffer", and stores its crc32c into
+// "crc32c_value".
+Status ReadAndChecksum(RandomAccessFile* file, uint64 offset, size_t size,
+                       char* buffer, uint32* crc32c_value) {
+  StringPiece sp;
+  TF_RETURN_IF_ERROR(file->Read(offset, size, &sp, buffer));
+  if (sp.data() != buffer) {
+    memmove(buffer, sp.data(), size);
+  }
+  *crc32c_value = crc32c::Value(buffer, size);
+  return Status::OK();
+}
+
+// Same as ReadAndChecksum(), with large reads split into chunks that are read
+// and checksummed concurrently on ParallelReadPool().  RandomAccessFile reads
+// are thread-safe, and many in flight hide the latency of network filesystems.
+// Without the pool, the chunks are read with RandomAccessFile::ReadV(), which
+// network filesystems still issue concurrently.
+Status ParallelReadAndChecksum(RandomAccessFile* file, uint64 offset,
+                               size_t size, char* buffer,
+                               uint32* crc32c_value) {
+  if (size <= 2 * kParallelReadChunkSize) {
+    return ReadAndChecksum(file, offset, size, buffer, crc32c_value);
+  }
+  const int64 num_chunks =
+      (size + kParallelReadChunkSize - 1) / kParallelReadChunkSize;
+  auto chunk_size = [size](int64 i) {
+    return std::min<size_t>(kParallelReadChunkSize,
+                            size - i * kParallelReadChunkSize);
+  };
+  thread::ThreadPool* pool = ParallelReadPool();
+  if (pool == nullptr) {
+    std::vector<FileReadRange> ranges(num_chunks);
+    for (int64 i = 0; i < num_chunks; ++i) {
+      const size_t begin = i * kParallelReadChunkSize;
+      ranges[i].offset = offset + begin;
+      ranges[i].n = chunk_size(i);
+      ranges[i].scratch = buffer + begin;
+    }
+    TF_RETURN_IF_ERROR(file->ReadV(&ranges));
+    for (const FileReadRange& range : ranges) {
+      if (range.result.data() != range.scratch) {
+        memmove(range.scratch, range.result.data(), range.n);
+      }
+    }
+    *crc32c_value = crc32c::Value(buffer, size);
+    return Status::OK();
+  }
+  std::vector<Status> statuses(num_chunks);
+  std::vector<uint32> crcs(num_chunks);
+  BlockingCounter counter(num_chunks);
+  for (int64 i = 0; i < num_chunks; ++i) {
+    pool->Schedule([&, i]() {
+      const size_t begin = i * kParallelReadChunkSize;
+      statuses[i] = ReadAndChecksum(file, offset + begin, chunk_size(i),
+                                    buffer + begin, &crcs[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  *crc32c_value = 0;
+  for (int64 i = 0; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    *crc32c_value = crc32c::Combine(*crc32c_value, crcs[i], chunk_size(i));
+  }
+  return Status::OK();
+}
+
+// A read-only tensor buffer in a memory-mapped data file.  It doesn't own its
+// memory, so that its tensors are never forwarded or updated in place.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const void* data, size_t size)
+      : TensorBuffer(const_cast<void*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("BundleReader");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -232,6 +351,113 @@ Status WriteTensor(const Tensor& val, FileOutputBuffer* out,
   return out->Append(StringPiece(buf, *bytes_written));
 }
 
+// Compresses "input" into "output".  Returns false if the compression isn't
+// available on this platform.
+bool CompressChunk(BundleEntryProto::Compression compression,
+                   const char* input, size_t length, string* output) {
+  switch (compression) {
+    case BundleEntryProto::SNAPPY:
+      return port::Snappy_Compress(input, length, output);
+    default:
+      return false;
+  }
+}
+
+// Uncompresses "input" into the "expected_length" bytes of "output".
+Status UncompressChunk(BundleEntryProto::Compression compression,
+                       const char* input, size_t length,
+                       size_t expected_length, char* output) {
+  switch (compression) {
+    case BundleEntryProto::SNAPPY: {
+      size_t uncompressed_length;
+      if (!port::Snappy_GetUncompressedLength(input, length,
+                                              &uncompressed_length) ||
+          uncompressed_length != expected_length ||
+          !port::Snappy_Uncompress(input, length, output)) {
+        return errors::DataLoss(
+            "Unable to uncompress a snappy chunk of a bundle entry");
+      }
+      return Status::OK();
+    }
+    default:
+      return errors::Unimplemented("Unsupported bundle entry compression ",
+                                   compression);
+  }
+}
+
+// Same as WriteTensor(), with the data bytes compressed in chunks of
+// "chunk_size" bytes, and the chunk fields of "entry" filled.  Stores the
+// checksum of the uncompressed bytes into "crc32c".
+//
+// Sets "compressed" to false and writes nothing if the compression is not
+// available or the first chunk doesn't shrink by at least 1/8, in which case
+// the caller writes the tensor uncompressed.
+// REQUIRES: DataTypeCanUseMemcpy(val.dtype())
+Status WriteCompressedTensor(const Tensor& val,
+                             BundleEntryProto::Compression compression,
+                             int64 chunk_size, FileOutputBuffer* out,
+                             BundleEntryProto* entry, size_t* bytes_written,
+                             uint32* crc32c, bool* compressed) {
+  *compressed = false;
+  *bytes_written = 0;
+  const size_t dtype_size = DataTypeSize(val.dtype());
+  const size_t total_bytes = val.TotalBytes();
+  if (dtype_size == 0 || total_bytes == 0) return Status::OK();
+  // Keeps the chunks aligned on the elements.
+  chunk_size = std::max<int64>(chunk_size, 1);
+  chunk_size = (chunk_size + dtype_size - 1) / dtype_size * dtype_size;
+
+  const char* buf = GetBackingBuffer(val);
+  string chunk;
+  for (size_t begin = 0; begin < total_bytes; begin += chunk_size) {
+    const size_t length = std::min<size_t>(chunk_size, total_bytes - begin);
+    if (!CompressChunk(compression, buf + begin, length, &chunk)) {
+      if (begin == 0) return Status::OK();
+      return errors::Internal("Failed to compress a chunk of ", length,
+                              " bytes");
+    }
+    if (begin == 0 && chunk.size() > length - length / 8) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(out->Append(chunk));
+    *bytes_written += chunk.size();
+    entry->add_chunk_offsets(*bytes_written);
+    entry->add_chunk_crc32c(
+        crc32c::Mask(crc32c::Value(chunk.data(), chunk.size())));
+  }
+  entry->set_compression(compression);
+  entry->set_chunk_size(chunk_size);
+  *crc32c = crc32c::Value(buf, total_bytes);
+  *compressed = true;
+  VLOG(1) << "Appended " << *bytes_written << " compressed bytes for "
+          << total_bytes << " tensor bytes";
+  return Status::OK();
+}
+
+// Checks the chunk fields of the compressed "entry" of tensor "key".
+Status ValidateCompressedEntry(StringPiece key,
+                               const BundleEntryProto& entry) {
+  const int64 total_bytes = DataTypeSize(entry.dtype()) *
+                            TensorShape(entry.shape()).num_elements();
+  const int64 num_chunks = entry.chunk_offsets_size();
+  if (!DataTypeCanUseMemcpy(entry.dtype()) || entry.chunk_size() <= 0 ||
+      entry.chunk_crc32c_size() != num_chunks ||
+      num_chunks != (total_bytes + entry.chunk_size() - 1) /
+                        entry.chunk_size() ||
+      (num_chunks > 0 && entry.chunk_offsets(num_chunks - 1) != entry.size())) {
+    return errors::DataLoss("Invalid compressed bundle entry: key ", key);
+  }
+  int64 previous_offset = 0;
+  for (const int64 offset : entry.chunk_offsets()) {
+    if (offset <= previous_offset) {
+      return errors::DataLoss("Invalid compressed bundle entry: key ", key,
+                              "; chunk offsets are not increasing");
+    }
+    previous_offset = offset;
+  }
+  return Status::OK();
+}
+
 // Serializes string tensor "val".  "bytes_written" is treated in the same
 // fashion as WriteTensor().
 //
@@ -446,8 +672,17 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   } else if (val.dtype() == DT_VARIANT) {
     status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
   } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
+    bool compressed = false;
+    if (options_.compression != BundleEntryProto::NONE &&
+        DataTypeCanUseMemcpy(val.dtype())) {
+      status_ = WriteCompressedTensor(
+          val, options_.compression, options_.compression_chunk_size,
+          out_.get(), entry, &data_bytes_written, &crc32c, &compressed);
+    }
+    if (status_.ok() && !compressed) {
+      status_ = WriteTensor(val, out_.get(), &data_bytes_written);
+      crc32c = out_->crc32c();
+    }
   }
 
   if (status_.ok()) {
@@ -531,7 +766,9 @@ Status BundleWriter::Finish() {
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
-    version->set_min_consumer(kTensorBundleMinConsumer);
+    version->set_min_consumer(options_.compression == BundleEntryProto::NONE
+                                  ? kTensorBundleMinConsumer
+                                  : kTensorBundleMinCompressedConsumer);
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -812,8 +1049,10 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     ret = new Tensor(entry.dtype(), stored_shape);
   }
 
-  // Validates the "size" field.
-  if (entry.dtype() != DT_STRING && entry.dtype() != DT_VARIANT) {
+  // Validates the "size" field.  The size of compressed entries is validated
+  // with their chunks by ReadCompressedChunks().
+  if (entry.compression() == BundleEntryProto::NONE &&
+      entry.dtype() != DT_STRING && entry.dtype() != DT_VARIANT) {
     if (entry.size() != ret->TotalBytes()) {
       return errors::DataLoss("Invalid size in bundle entry: key ", key(),
                               "; stored size ", entry.size(),
@@ -834,38 +1073,34 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
-
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
 
-  if (DataTypeCanUseMemcpy(entry.dtype())) {
+  if (entry.compression() != BundleEntryProto::NONE) {
+    char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
+    TF_RETURN_IF_ERROR(ReadCompressedChunks(
+        entry, 0, entry.chunk_offsets_size(), backing_buffer));
+    actual_crc32c = crc32c::Value(backing_buffer, ret->TotalBytes());
+    if (need_to_swap_bytes_) {
+      TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
+    }
+  } else if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
+    // Note that we compute the checksum *before* byte-swapping. The checksum
+    // should be on the bytes in the order they appear in the file.
     if (entry.size() > kBufferSize) {
-      StringPiece sp;
-      TF_RETURN_IF_ERROR(buffered_file->file()->Read(
-          entry.offset(), entry.size(), &sp, backing_buffer));
-      if (sp.data() != backing_buffer) {
-        memmove(backing_buffer, sp.data(), entry.size());
-      }
+      // Reads straight into the tensor, bypassing the input buffer.
+      TF_RETURN_IF_ERROR(ParallelReadAndChecksum(
+          buffered_file->file(), entry.offset(), entry.size(), backing_buffer,
+          &actual_crc32c));
     } else {
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
                                                    &unused_bytes_read));
+      actual_crc32c = crc32c::Value(backing_buffer, entry.size());
     }
-    // Note that we compute the checksum *before* byte-swapping. The checksum
-    // should be on the bytes in the order they appear in the file.
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
     if (need_to_swap_bytes_) {
       TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
     }
@@ -900,6 +1135,137 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return Status::OK();
 }
 
+Status BundleReader::GetDataFile(int32 shard_id,
+                                 io::InputBuffer** buffered_file) {
+  // Open the data file if it has not been opened.
+  io::InputBuffer*& data_file = data_[shard_id];
+  if (data_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_file = new io::InputBuffer(file.release(), kBufferSize);
+  }
+  *buffered_file = data_file;
+  return Status::OK();
+}
+
+Status BundleReader::ReadCompressedChunks(const BundleEntryProto& entry,
+                                          int64 begin_chunk, int64 end_chunk,
+                                          char* output) {
+  TF_RETURN_IF_ERROR(ValidateCompressedEntry(key(), entry));
+  DCHECK_LE(0, begin_chunk);
+  DCHECK_LE(begin_chunk, end_chunk);
+  DCHECK_LE(end_chunk, entry.chunk_offsets_size());
+  if (begin_chunk == end_chunk) return Status::OK();
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+
+  auto chunk_begin = [&entry](int64 i) -> int64 {
+    return i == 0 ? 0 : entry.chunk_offsets(i - 1);
+  };
+  const int64 read_begin = chunk_begin(begin_chunk);
+  const int64 read_size = entry.chunk_offsets(end_chunk - 1) - read_begin;
+  std::unique_ptr<char[]> compressed(new char[read_size]);
+  // The chunks are validated one by one, the checksum of the whole range is
+  // not needed.
+  uint32 unused_crc32c;
+  TF_RETURN_IF_ERROR(ParallelReadAndChecksum(
+      buffered_file->file(), entry.offset() + read_begin, read_size,
+      compressed.get(), &unused_crc32c));
+
+  const int64 total_bytes = DataTypeSize(entry.dtype()) *
+                            TensorShape(entry.shape()).num_elements();
+  auto uncompress = [&](int64 i) -> Status {
+    const char* data = compressed.get() + chunk_begin(i) - read_begin;
+    const size_t length = entry.chunk_offsets(i) - chunk_begin(i);
+    const uint32 actual_crc32c = crc32c::Value(data, length);
+    if (crc32c::Unmask(entry.chunk_crc32c(i)) != actual_crc32c) {
+      return errors::DataLoss(
+          "Checksum does not match for chunk ", i, ": stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.chunk_crc32c(i))),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+    }
+    const int64 begin = i * entry.chunk_size();
+    return UncompressChunk(
+        entry.compression(), data, length,
+        std::min<int64>(entry.chunk_size(), total_bytes - begin),
+        output + begin - begin_chunk * entry.chunk_size());
+  };
+
+  thread::ThreadPool* pool = ParallelReadPool();
+  if (pool == nullptr || end_chunk - begin_chunk == 1) {
+    for (int64 i = begin_chunk; i < end_chunk; ++i) {
+      TF_RETURN_IF_ERROR(uncompress(i));
+    }
+    return Status::OK();
+  }
+  std::vector<Status> statuses(end_chunk - begin_chunk);
+  BlockingCounter counter(end_chunk - begin_chunk);
+  for (int64 i = begin_chunk; i < end_chunk; ++i) {
+    pool->Schedule([&, i]() {
+      statuses[i - begin_chunk] = uncompress(i);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
+Status BundleReader::ReadCompressedSliceRows(
+    const TensorShape& full_shape, const BundleEntryProto& stored_slice_entry,
+    const TensorSlice& stored_slice, const TensorSlice& slice_spec,
+    TensorSlice* read_slice, Tensor* read_tensor) {
+  const TensorShape stored_slice_shape(stored_slice_entry.shape());
+  *read_slice = stored_slice;
+  TensorSlice intersection(full_shape.dims());
+  stored_slice.Intersect(slice_spec, &intersection);
+  auto begin_row = [](const TensorSlice& slice) -> int64 {
+    return slice.IsFullAt(0) ? 0 : slice.start(0);
+  };
+  const int64 first_row = begin_row(intersection) - begin_row(stored_slice);
+  const int64 num_rows = intersection.IsFullAt(0)
+                             ? full_shape.dim_size(0)
+                             : intersection.length(0);
+  const int64 stored_rows = stored_slice_shape.dim_size(0);
+  if (num_rows <= 0 || num_rows >= stored_rows) {
+    // Reads the whole stored slice, validating its checksum.
+    *read_tensor = Tensor(stored_slice_entry.dtype(), stored_slice_shape);
+    return GetValue(stored_slice_entry, read_tensor);
+  }
+
+  TensorShape read_shape = stored_slice_shape;
+  read_shape.set_dim(0, num_rows);
+  *read_tensor = Tensor(stored_slice_entry.dtype(), read_shape);
+  const int64 row_bytes = read_tensor->TotalBytes() / num_rows;
+  const int64 chunk_size = stored_slice_entry.chunk_size();
+  if (chunk_size <= 0) {
+    return errors::DataLoss("Invalid compressed bundle entry: key ", key());
+  }
+  const int64 begin_byte = first_row * row_bytes;
+  const int64 end_byte = begin_byte + num_rows * row_bytes;
+  const int64 begin_chunk = begin_byte / chunk_size;
+  const int64 end_chunk = (end_byte + chunk_size - 1) / chunk_size;
+  const int64 total_bytes = stored_rows * row_bytes;
+  std::unique_ptr<char[]> chunks(new char[std::min(
+      end_chunk * chunk_size - begin_chunk * chunk_size,
+      total_bytes - begin_chunk * chunk_size)]);
+  TF_RETURN_IF_ERROR(ReadCompressedChunks(stored_slice_entry, begin_chunk,
+                                          end_chunk, chunks.get()));
+  memcpy(const_cast<char*>(read_tensor->tensor_data().data()),
+         chunks.get() + begin_byte - begin_chunk * chunk_size,
+         read_tensor->TotalBytes());
+  if (need_to_swap_bytes_) {
+    TF_RETURN_IF_ERROR(ByteSwapTensor(read_tensor));
+  }
+  read_slice->set_start(0, begin_row(stored_slice) + first_row);
+  read_slice->set_length(0, num_rows);
+  return Status::OK();
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -914,6 +1280,65 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupReadOnly(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      entry.compression() != BundleEntryProto::NONE || need_to_swap_bytes_) {
+    *val = Tensor(entry.dtype(), shape);
+    return Lookup(key, val);
+  }
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &region);
+    if (!s.ok()) {
+      VLOG(1) << "Can't memory-map the data file " << entry.shard_id()
+              << " of " << prefix_ << ", reading it instead: " << s;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) {
+    *val = Tensor(entry.dtype(), shape);
+    return GetValue(entry, val);
+  }
+
+  const size_t expected_size =
+      DataTypeSize(entry.dtype()) * shape.num_elements();
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::OutOfRange("Bundle entry ", key,
+                              " is past the end of its data file");
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    // Tensors must be aligned, see BundleWriter::Options::data_alignment.
+    *val = Tensor(entry.dtype(), shape);
+    return GetValue(entry, val);
+  }
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  MappedTensorBuffer* buf =
+      new MappedTensorBuffer(region, data, entry.size());
+  *val = Tensor(entry.dtype(), shape, buf);
+  buf->Unref();
+  return Status::OK();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1030,8 +1455,19 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
       return status_;
     }
 
-    Tensor stored_slice_tensor(stored_slice_entry.dtype(), stored_slice_shape);
-    status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
+    // Only the rows of compressed slices intersecting "slice_spec" are read.
+    TensorSlice read_slice = stored_slice;
+    Tensor stored_slice_tensor;
+    if (stored_slice_entry.compression() != BundleEntryProto::NONE &&
+        stored_slice_shape.dims() > 0) {
+      status_ = ReadCompressedSliceRows(full_shape, stored_slice_entry,
+                                        stored_slice, slice_spec, &read_slice,
+                                        &stored_slice_tensor);
+    } else {
+      stored_slice_tensor =
+          Tensor(stored_slice_entry.dtype(), stored_slice_shape);
+      status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
+    }
     if (!status_.ok()) return status_;
 
     // Copies the intersection over.
@@ -1040,7 +1476,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 #define HANDLE_COPY(T)                                                 \
   case DataTypeToEnum<T>::value:                                       \
     CHECK(CopyDataFromTensorSliceToTensorSlice(                        \
-        full_shape, stored_slice, slice_spec,                          \
+        full_shape, read_slice, slice_spec,                            \
         stored_slice_tensor.flat<T>().data(), val->flat<T>().data())); \
     break;
 
@@ -64,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -91,6 +92,8 @@ class FileOutputBuffer;
 // History:
 // 0. Any tensor bundles produced before this field was added.
 // 1. Added this field (2016-09-14).
+// 2. Added the compressed entries, see BundleEntryProto.compression.  Only the
+//    bundles written with compression require this version.
 extern const int kTensorBundleMinProducer;
 extern const int kTensorBundleMinConsumer;
 extern const int kTensorBundleVersion;
@@ -112,6 +115,15 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Compression of the tensors with a fixed-size dtype.  A tensor is stored
+    // uncompressed if its first chunk doesn't shrink by at least 1/8.  The
+    // bundles written with compression can't be read by binaries older than
+    // version 2 of the format.
+    BundleEntryProto::Compression compression{BundleEntryProto::NONE};
+    // Number of uncompressed bytes per compressed chunk, which is the
+    // granularity of the slice reads.  Rounded up to a multiple of the dtype
+    // size.
+    int64 compression_chunk_size{256 << 10};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -218,6 +230,17 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Same as Lookup(), except that "*val" is replaced by a read-only alias of
+  // the memory-mapped data file when possible, instead of a copy of its
+  // contents.  The alias never owns its memory, so resource variables
+  // holding it copy it before any update.  Falls back to Lookup() into a new
+  // tensor for partitioned, string, variant, byte-swapped and misaligned
+  // tensors, and for files that can't be memory-mapped.
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupReadOnly(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -239,6 +262,7 @@ class BundleReader {
   // Looks up a specific slice of a partitioned tensor.
   // It is only required that the stored slices cover the requested slice,
   // namely "slice_spec" is a subset of the union of the stored slices.
+  // Only the chunks covering "slice_spec" are read from compressed entries.
   // REQUIRES: status().ok()
   Status LookupSlice(StringPiece full_tensor_key, const TensorSlice& slice_spec,
                      Tensor* val) TF_MUST_USE_RESULT;
@@ -274,6 +298,28 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Reads and decompresses the chunks [begin_chunk, end_chunk) of the
+  // compressed entry "entry" into "output", which must hold their
+  // uncompressed bytes.  Validates the checksums of the chunks.
+  Status ReadCompressedChunks(const BundleEntryProto& entry, int64 begin_chunk,
+                              int64 end_chunk,
+                              char* output) TF_MUST_USE_RESULT;
+
+  // Reads the rows of the compressed "stored_slice" intersecting "slice_spec"
+  // into "read_tensor", and sets "read_slice" to the slice they hold.  Only
+  // the chunks covering these rows are read.
+  Status ReadCompressedSliceRows(const TensorShape& full_shape,
+                                 const BundleEntryProto& stored_slice_entry,
+                                 const TensorSlice& stored_slice,
+                                 const TensorSlice& slice_spec,
+                                 TensorSlice* read_slice,
+                                 Tensor* read_tensor) TF_MUST_USE_RESULT;
+
+  // Returns the InputBuffer reading the data file "shard_id", opening it if
+  // needed.
+  Status GetDataFile(int32 shard_id,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -291,6 +337,10 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // The memory-mapped data files used by LookupReadOnly(), shared with the
+  // tensors aliasing them.  Null for the files that can't be mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -25,10 +25,12 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -973,6 +975,78 @@ TEST(TensorBundleTest, Checksum) {
   }
 }
 
+TEST(TensorBundleTest, LargeTensor) {
+  // Larger than two read chunks, so that it is read in parallel.
+  Tensor expected(DT_FLOAT, TensorShape({10 << 20}));
+  auto expected_flat = expected.flat<float>();
+  for (int64 i = 0; i < expected.NumElements(); ++i) {
+    expected_flat(i) = static_cast<float>(i % 1000);
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("large"));
+    TF_EXPECT_OK(writer.Add("foo", expected));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("large"));
+    TF_ASSERT_OK(reader.status());
+    Tensor val(DT_FLOAT, expected.shape());
+    TF_ASSERT_OK(reader.Lookup("foo", &val));
+    test::ExpectTensorEqual<float>(expected, val);
+  }
+
+  // Corrupts a byte of the last chunk.
+  const string datafile = DataFilename(Prefix("large"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), datafile, &data));
+  data[data.size() - 3] = ~data[data.size() - 3];
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), datafile, data));
+  BundleReader reader(Env::Default(), Prefix("large"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val(DT_FLOAT, expected.shape());
+  Status status = reader.Lookup("foo", &val);
+  EXPECT_TRUE(errors::IsDataLoss(status));
+  EXPECT_TRUE(absl::StrContains(status.ToString(), "Checksum does not match"));
+}
+
+TEST(TensorBundleTest, LookupReadOnly) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("read_only"), opts);
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1.f)));
+    TF_EXPECT_OK(writer.Add("strings", test::AsTensor<tstring>({"a", "b"})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("read_only"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.LookupReadOnly("foo", &val));
+  test::ExpectTensorEqual<float>(Constant_2x3<float>(1.f), val);
+  // Both lookups alias the same mapping of the data file.
+  Tensor other;
+  TF_ASSERT_OK(reader.LookupReadOnly("foo", &other));
+  EXPECT_EQ(val.tensor_data().data(), other.tensor_data().data());
+
+  TF_ASSERT_OK(reader.LookupReadOnly("strings", &val));
+  test::ExpectTensorEqual<tstring>(test::AsTensor<tstring>({"a", "b"}), val);
+}
+
+TEST(TensorBundleTest, LookupReadOnlyMisaligned) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("read_only_misaligned"));
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<int8>(1)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2.f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("read_only_misaligned"));
+  TF_ASSERT_OK(reader.status());
+  // "b" starts at offset 6 of the data file, so it is read instead.
+  Tensor val;
+  TF_ASSERT_OK(reader.LookupReadOnly("b", &val));
+  test::ExpectTensorEqual<float>(Constant_2x3<float>(2.f), val);
+}
+
 TEST(TensorBundleTest, TruncatedTensorContents) {
   Env* env = Env::Default();
   BundleWriter writer(env, Prefix("end"));
@@ -993,6 +1067,94 @@ TEST(TensorBundleTest, TruncatedTensorContents) {
   EXPECT_TRUE(errors::IsOutOfRange(reader.Lookup("key", &val)));
 }
 
+TEST(TensorBundleTest, Compression) {
+  string unused;
+  if (!port::Snappy_Compress("", 0, &unused)) {
+    LOG(INFO) << "Snappy is not available, skipping the test";
+    return;
+  }
+  const TensorShape kShape({1000, 16});
+  Tensor noise(DT_INT32, kShape);
+  test::FillFn<int32>(&noise, [](int offset) -> int32 {
+    return Hash32(reinterpret_cast<const char*>(&offset), sizeof(offset), 0);
+  });
+  {
+    BundleWriter::Options opts;
+    opts.compression = BundleEntryProto::SNAPPY;
+    opts.compression_chunk_size = 4096;
+    BundleWriter writer(Env::Default(), Prefix("compressed"), opts);
+    TF_EXPECT_OK(writer.Add("zeros", Constant<float>(0.f, kShape)));
+    TF_EXPECT_OK(writer.Add("noise", noise));
+    TF_EXPECT_OK(writer.Add("strings", test::AsTensor<tstring>({"a", "b"})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("compressed"));
+  TF_ASSERT_OK(reader.status());
+  BundleHeaderProto header;
+  reader.Seek(kHeaderEntryKey);
+  ASSERT_TRUE(ParseProtoUnlimited(&header, reader.value().data(),
+                                  reader.value().size()));
+  EXPECT_EQ(2, header.version().min_consumer());
+
+  // The zeros are compressed in 16 chunks, the noise is not compressed.
+  BundleEntryProto entry;
+  reader.Seek("zeros");
+  ASSERT_TRUE(ParseProtoUnlimited(&entry, reader.value().data(),
+                                  reader.value().size()));
+  EXPECT_EQ(BundleEntryProto::SNAPPY, entry.compression());
+  EXPECT_EQ(16, entry.chunk_offsets_size());
+  EXPECT_LT(entry.size(), kShape.num_elements() * sizeof(float) / 8);
+  reader.Seek("noise");
+  ASSERT_TRUE(ParseProtoUnlimited(&entry, reader.value().data(),
+                                  reader.value().size()));
+  EXPECT_EQ(BundleEntryProto::NONE, entry.compression());
+
+  Expect<float>(&reader, "zeros", Constant<float>(0.f, kShape));
+  Expect<int32>(&reader, "noise", noise);
+  Expect<tstring>(&reader, "strings", test::AsTensor<tstring>({"a", "b"}));
+  Tensor val;
+  TF_ASSERT_OK(reader.LookupReadOnly("zeros", &val));
+  test::ExpectTensorEqual<float>(Constant<float>(0.f, kShape), val);
+}
+
+TEST(TensorBundleTest, CompressedSlices) {
+  const TensorShape kFullShape({1000, 4});
+  auto rows = [](int64 begin, int64 num_rows) {
+    Tensor t(DT_FLOAT, TensorShape({num_rows, 4}));
+    test::FillFn<float>(&t, [begin](int offset) -> float {
+      return begin + offset / 4;
+    });
+    return t;
+  };
+  {
+    BundleWriter::Options opts;
+    opts.compression = BundleEntryProto::SNAPPY;
+    opts.compression_chunk_size = 1000;
+    BundleWriter writer(Env::Default(), Prefix("compressed_slices"), opts);
+    TF_ASSERT_OK(writer.AddSlice("foo", kFullShape,
+                                 TensorSlice::ParseOrDie("0,500:-"),
+                                 rows(0, 500)));
+    TF_ASSERT_OK(writer.AddSlice("foo", kFullShape,
+                                 TensorSlice::ParseOrDie("500,500:-"),
+                                 rows(500, 500)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("compressed_slices"));
+  TF_ASSERT_OK(reader.status());
+  // Cuts both slices, and the chunks.
+  Tensor val(DT_FLOAT, TensorShape({401, 2}));
+  TF_ASSERT_OK(
+      reader.LookupSlice("foo", TensorSlice::ParseOrDie("299,401:1,2"), &val));
+  Tensor expected(DT_FLOAT, TensorShape({401, 2}));
+  test::FillFn<float>(&expected,
+                      [](int offset) -> float { return 299 + offset / 2; });
+  test::ExpectTensorEqual<float>(expected, val);
+
+  val = Tensor(DT_FLOAT, kFullShape);
+  TF_ASSERT_OK(reader.Lookup("foo", &val));
+  test::ExpectTensorEqual<float>(rows(0, 1000), val);
+}
+
 TEST(TensorBundleTest, HeaderEntry) {
   {
     BundleWriter writer(Env::Default(), Prefix("b"));
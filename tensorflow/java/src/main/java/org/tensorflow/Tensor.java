@@ -266,6 +266,45 @@ public final class Tensor<T> implements AutoCloseable {
     return t;
   }
 
+  /**
+   * Create a Tensor of any non-string type that wraps the data of a direct buffer.
+   *
+   * <p>Unlike {@link #create(Class, long[], ByteBuffer)}, the data is not copied into the tensor
+   * (unless its memory is not aligned as TensorFlow requires): the tensor reads the bytes remaining
+   * in {@code data}, starting from its current position, which must be encoded in native byte
+   * order. The position of {@code data} is not changed. The tensor holds a reference to {@code
+   * data} until its memory is released, so these bytes must not be modified until the tensor is
+   * closed and the computations that use it are completed.
+   *
+   * @param <T> the tensor element type
+   * @param type the tensor element type, represented as a class object.
+   * @param shape the tensor shape.
+   * @param data a direct buffer containing the tensor data.
+   * @throws IllegalArgumentException If {@code data} is not a direct buffer, if the tensor datatype
+   *     is {@link String}, or if the shape is not compatible with the buffer
+   */
+  public static <T> Tensor<T> wrap(Class<T> type, long[] shape, ByteBuffer data) {
+    DataType dtype = DataType.fromClass(type);
+    if (!data.isDirect()) {
+      throw new IllegalArgumentException("cannot wrap a ByteBuffer that is not direct");
+    }
+    int elemBytes = elemByteSize(dtype);
+    int nflattened = numElements(shape);
+    if (data.remaining() != nflattened * elemBytes) {
+      throw new IllegalArgumentException(
+          String.format(
+              "ByteBuffer with %d bytes is not compatible with a %s Tensor with shape %s",
+              data.remaining(), dtype.toString(), Arrays.toString(shape)));
+    }
+    Tensor<T> t = new Tensor<T>(dtype);
+    t.shapeCopy = Arrays.copyOf(shape, shape.length);
+    long nativeHandle =
+        allocateForDirectBuffer(
+            t.dtype.c(), t.shapeCopy, data, data.position(), data.remaining());
+    t.nativeRef = new NativeReference(nativeHandle);
+    return t;
+  }
+
   /**
    * Returns this Tensor object with the type {@code Tensor<U>}. This method is useful when given a
    * value of type {@code Tensor<?>}.
@@ -524,6 +563,16 @@ public final class Tensor<T> implements AutoCloseable {
     dst.put(src);
   }
 
+  /**
+   * Returns a read-only view of the tensor data, in native byte order for primitive types.
+   *
+   * <p>Unlike {@link #writeTo(ByteBuffer)}, the data is not copied: the returned direct buffer
+   * reads the memory of the tensor, so it must not be used after the tensor is closed.
+   */
+  public ByteBuffer asReadOnlyBuffer() {
+    return buffer().asReadOnlyBuffer().order(ByteOrder.nativeOrder());
+  }
+
   /** Returns a string describing the type and shape of the Tensor. */
   @Override
   public String toString() {
@@ -810,6 +859,9 @@ public final class Tensor<T> implements AutoCloseable {
 
   private static native long allocateNonScalarBytes(long[] shape, Object[] value);
 
+  private static native long allocateForDirectBuffer(
+      int dtype, long[] shape, ByteBuffer data, int offset, long byteSize);
+
   private static native void delete(long handle);
 
   private static native ByteBuffer buffer(long handle);
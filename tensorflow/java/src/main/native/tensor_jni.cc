@@ -473,6 +473,80 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateNonScalarBytes(
   return ret;
 }
 
+namespace {
+// The Java reference to a direct buffer whose memory backs a TF_Tensor.
+struct DirectBufferReference {
+  JavaVM* vm;
+  jobject buffer;  // A global reference.
+};
+
+// Deallocator of the TF_Tensors created by allocateForDirectBuffer, which
+// releases the buffer. It may be called from a thread that TensorFlow created
+// once the tensor is not used anymore, which then needs to be attached to the
+// JVM.
+void releaseDirectBuffer(void* data, size_t len, void* arg) {
+  DirectBufferReference* ref = static_cast<DirectBufferReference*>(arg);
+  JNIEnv* env = nullptr;
+  bool attached = false;
+  if (ref->vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) ==
+      JNI_EDETACHED) {
+    if (ref->vm->AttachCurrentThread(reinterpret_cast<void**>(&env),
+                                     nullptr) != JNI_OK) {
+      // The reference cannot be released without a JNIEnv, leak it.
+      delete ref;
+      return;
+    }
+    attached = true;
+  }
+  env->DeleteGlobalRef(ref->buffer);
+  if (attached) ref->vm->DetachCurrentThread();
+  delete ref;
+}
+}  // namespace
+
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateForDirectBuffer(
+    JNIEnv* env, jclass clazz, jint dtype, jlongArray shape, jobject buffer,
+    jint offset, jlong sizeInBytes) {
+  char* address = static_cast<char*>(env->GetDirectBufferAddress(buffer));
+  if (address == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "the buffer is not a direct buffer");
+    return 0;
+  }
+  DirectBufferReference* ref = new DirectBufferReference;
+  if (env->GetJavaVM(&ref->vm) != JNI_OK) {
+    delete ref;
+    throwException(env, kIllegalStateException,
+                   "unable to get the Java VM of the buffer");
+    return 0;
+  }
+  ref->buffer = env->NewGlobalRef(buffer);
+
+  const int num_dims = static_cast<int>(env->GetArrayLength(shape));
+  std::unique_ptr<int64_t[]> dims(new int64_t[num_dims]);
+  if (num_dims > 0) {
+    jlong* jdims = env->GetLongArrayElements(shape, nullptr);
+    for (int i = 0; i < num_dims; ++i) {
+      dims[i] = static_cast<int64_t>(jdims[i]);
+    }
+    env->ReleaseLongArrayElements(shape, jdims, JNI_ABORT);
+  }
+  // The tensor reads the memory of the buffer without copying it (unless it
+  // is not aligned as TensorFlow requires), and holds the reference to the
+  // buffer until it is deallocated. On failure, the deallocator has already
+  // been called.
+  TF_Tensor* t = TF_NewTensor(static_cast<TF_DataType>(dtype), dims.get(),
+                              num_dims, address + offset,
+                              static_cast<size_t>(sizeInBytes),
+                              releaseDirectBuffer, ref);
+  if (t == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "the buffer is not compatible with the Tensor");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(t);
+}
+
 JNIEXPORT void JNICALL Java_org_tensorflow_Tensor_delete(JNIEnv* env,
                                                          jclass clazz,
                                                          jlong handle) {
@@ -47,6 +47,14 @@ Java_org_tensorflow_Tensor_allocateScalarBytes(JNIEnv *, jclass, jbyteArray);
 JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateNonScalarBytes(
     JNIEnv *, jclass, jlongArray, jobjectArray);
 
+/*
+ * Class:     org_tensorflow_Tensor
+ * Method:    allocateForDirectBuffer
+ * Signature: (I[JLjava/nio/ByteBuffer;IJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateForDirectBuffer(
+    JNIEnv *, jclass, jint, jlongArray, jobject, jint, jlong);
+
 /*
  * Class:     org_tensorflow_Tensor
  * Method:    delete
@@ -164,6 +164,48 @@ public class TensorTest {
     }
   }
 
+  @Test
+  public void wrapDirectBuffer() {
+    float[] floats = {1f, 2f, 3f, 4f};
+    ByteBuffer buf = ByteBuffer.allocateDirect(4 * floats.length).order(ByteOrder.nativeOrder());
+    buf.asFloatBuffer().put(floats);
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {2, 2}, buf)) {
+      assertEquals(DataType.FLOAT, t.dataType());
+      assertArrayEquals(new long[] {2, 2}, t.shape());
+      float[][] actual = new float[2][2];
+      t.copyTo(actual);
+      assertArrayEquals(new float[] {1f, 2f}, actual[0], EPSILON_F);
+      assertArrayEquals(new float[] {3f, 4f}, actual[1], EPSILON_F);
+    }
+    assertEquals(0, buf.position());
+
+    // validate the buffer checks
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {5}, buf)) {
+      fail("should have failed on incompatible buffer");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {4}, ByteBuffer.allocate(16))) {
+      fail("should have failed on a buffer that is not direct");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+  }
+
+  @Test
+  public void asReadOnlyBuffer() {
+    long[] longs = {1L, 2L, 3L};
+    try (Tensor<Long> t = Tensor.create(longs, Long.class)) {
+      ByteBuffer buf = t.asReadOnlyBuffer();
+      assertTrue(buf.isReadOnly());
+      assertTrue(buf.isDirect());
+      assertEquals(t.numBytes(), buf.remaining());
+      long[] actual = new long[longs.length];
+      buf.asLongBuffer().get(actual);
+      assertArrayEquals(longs, actual);
+    }
+  }
+
   @Test
   public void writeTo() {
     int[] ints = {1, 2, 3};
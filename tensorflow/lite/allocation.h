@@ -59,7 +59,12 @@ class Allocation {
 
 class MMAPAllocation : public Allocation {
  public:
-  MMAPAllocation(const char* filename, ErrorReporter* error_reporter);
+  // Maps `filename` read-only. If `lazy_loading` is true, the kernel is asked
+  // not to read ahead of the pages that are accessed, so that each part of the
+  // file, such as the weights of an op, is only read from disk once it is
+  // used, instead of being faulted in along with its neighbours.
+  MMAPAllocation(const char* filename, ErrorReporter* error_reporter,
+                 bool lazy_loading = false);
   virtual ~MMAPAllocation();
   const void* base() const override;
   size_t bytes() const override;
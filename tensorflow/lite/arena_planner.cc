@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/arena_planner.h"
 #include <utility>
+#include <vector>
 
 namespace tflite {
 
@@ -29,14 +30,16 @@ struct AllocationInfo {
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_inputs, bool preserve_intermediates,
-                           int tensor_alignment)
+                           int tensor_alignment,
+                           std::vector<int32_t> offline_offsets)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment),
       persistent_arena_(kDefaultArenaAlignment),
       preserve_inputs_(preserve_inputs),
       preserve_intermediates_(preserve_intermediates),
-      tensor_alignment_(tensor_alignment) {}
+      tensor_alignment_(tensor_alignment),
+      offline_offsets_(std::move(offline_offsets)) {}
 
 ArenaPlanner::~ArenaPlanner() {}
 
@@ -64,8 +67,9 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   TF_LITE_ENSURE_STATUS(ResetAllocations());
   // The alloc_queue_ is specific to the graph topology, and will be
-  // completely reconstructed from graph data here.
+  // completely reconstructed from graph data here. So are the cached plans.
   alloc_queue_.clear();
+  cached_plans_.clear();
 
   // Keeps track of references to each tensor.
   std::vector<int> refcounts(graph_info_->num_tensors(), 0);
@@ -152,9 +156,19 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       TF_LITE_ENSURE_STATUS(allocate(0, tensor_index));
     }
   }
+  // Tensors released by nodes that may run concurrently with the current one
+  // are only deallocated after the last of these nodes.
+  std::vector<int> pending_deallocations;
+  size_t concurrent_nodes_end = 0;
   // Go through the graph in execution order.
   for (size_t i = 0; i < graph_info_->num_nodes(); ++i) {
     const TfLiteNode& node = graph_info_->node(i);
+    if (i >= concurrent_nodes_end) {
+      concurrent_nodes_end = graph_info_->concurrent_nodes_end(i);
+      TF_LITE_ENSURE(context_, concurrent_nodes_end > i &&
+                                   concurrent_nodes_end <=
+                                       graph_info_->num_nodes());
+    }
 
     // First queue output tensors for allocation.
     TfLiteIntArray* node_outputs = node.outputs;
@@ -172,11 +186,17 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
         if (tensor_index != kOptionalTensor) {
           refcounts[tensor_index]--;
           if (refcounts[tensor_index] == 0) {
-            TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+            pending_deallocations.push_back(tensor_index);
           }
         }
       }
     }
+    if (i + 1 == concurrent_nodes_end) {
+      for (int tensor_index : pending_deallocations) {
+        TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+      }
+      pending_deallocations.clear();
+    }
   }
 
   // Note that graph outputs will never be scheduled for deallocation. We
@@ -190,7 +210,18 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   TF_LITE_ENSURE(context_, graph_info_->num_tensors() >= allocs_.size());
   allocs_.resize(graph_info_->num_tensors());
 
-  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  // Only the plans made for the whole graph at once are cached, as the
+  // allocations made stepwise depend on the order of the steps.
+  if (first_node == 0 &&
+      last_node + 1 >= static_cast<int>(graph_info_->num_nodes())) {
+    std::vector<size_t> key = GetPlanKey();
+    if (!RestoreCachedPlan(key)) {
+      TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+      CachePlan(std::move(key));
+    }
+  } else {
+    TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  }
   TF_LITE_ENSURE_STATUS(Commit());
 
   for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
@@ -204,6 +235,43 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+std::vector<size_t> ArenaPlanner::GetPlanKey() {
+  std::vector<size_t> key;
+  key.reserve(2 * graph_info_->num_tensors() + graph_info_->num_nodes());
+  for (size_t i = 0; i < graph_info_->num_tensors(); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    key.push_back(tensor.allocation_type);
+    key.push_back(tensor.bytes);
+  }
+  for (size_t i = 0; i < graph_info_->num_nodes(); ++i) {
+    const TfLiteIntArray* temporaries = graph_info_->node(i).temporaries;
+    key.push_back(temporaries->size);
+    key.insert(key.end(), temporaries->data,
+               temporaries->data + temporaries->size);
+  }
+  return key;
+}
+
+bool ArenaPlanner::RestoreCachedPlan(const std::vector<size_t>& key) {
+  for (auto it = cached_plans_.begin(); it != cached_plans_.end(); ++it) {
+    if (it->key != key) continue;
+    allocs_ = it->allocs;
+    arena_.RestoreState(it->arena_state);
+    persistent_arena_.RestoreState(it->persistent_arena_state);
+    cached_plans_.splice(cached_plans_.begin(), cached_plans_, it);
+    return true;
+  }
+  return false;
+}
+
+void ArenaPlanner::CachePlan(std::vector<size_t> key) {
+  cached_plans_.push_front({std::move(key), allocs_, arena_.SaveState(),
+                            persistent_arena_.SaveState()});
+  if (cached_plans_.size() > static_cast<size_t>(kMaxCachedArenaPlans)) {
+    cached_plans_.pop_back();
+  }
+}
+
 TfLiteStatus ArenaPlanner::Commit() {
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
@@ -212,6 +280,11 @@ TfLiteStatus ArenaPlanner::Commit() {
 
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   int active_node = first_node;
+  // The temporaries of the nodes in [concurrent_nodes_begin, active_node) are
+  // allocated, and released once the nodes that may run concurrently with
+  // them are done.
+  int concurrent_nodes_begin = first_node;
+  int concurrent_nodes_end = first_node;
   // When dynamic tensors are present this method is called multiple times.
   // The items in the alloc_queue_ referring to nodes before first_node were
   // processed previously and should be skipped. Entries after last_node are
@@ -222,9 +295,14 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     if (alloc_info.node == active_node) {
       // This is the first allocation/deallocation for a given node.  It is
       // time to deallocate the previous temporaries and allocate new ones.
-      if (active_node != first_node) {
-        TF_LITE_ENSURE_STATUS(
-            CalculateDeallocationOfInternalTensors(active_node - 1));
+      if (active_node >= concurrent_nodes_end) {
+        TF_LITE_ENSURE_STATUS(CalculateDeallocationOfInternalTensors(
+            concurrent_nodes_begin, active_node));
+        concurrent_nodes_begin = active_node;
+        concurrent_nodes_end =
+            active_node < static_cast<int>(graph_info_->num_nodes())
+                ? graph_info_->concurrent_nodes_end(active_node)
+                : active_node + 1;
       }
       TF_LITE_ENSURE_STATUS(CalculateAllocationOfInternalTensors(active_node));
       ++active_node;
@@ -237,14 +315,10 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
-  // For the case if the graph is empty the node index can be negative since we
-  // substract from the active node, so the node_index can be zero for those
-  // cases
-  if (active_node > 0) {
-    // Don't forget to deallocate temporaries of last node.
-    TF_LITE_ENSURE_STATUS(
-        CalculateDeallocationOfInternalTensors(active_node - 1));
-  }
+  // Don't forget to deallocate temporaries of the last nodes. If the graph is
+  // empty, this range is empty too.
+  TF_LITE_ENSURE_STATUS(CalculateDeallocationOfInternalTensors(
+      concurrent_nodes_begin, active_node));
 
   return kTfLiteOk;
 }
@@ -269,6 +343,12 @@ TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
 TfLiteStatus ArenaPlanner::CalculateTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
+    if (tensor_index < static_cast<int>(offline_offsets_.size()) &&
+        offline_offsets_[tensor_index] >= 0 &&
+        arena_.TryAllocateAt(tensor_alignment_, offline_offsets_[tensor_index],
+                             tensor.bytes, &allocs_[tensor_index])) {
+      return kTfLiteOk;
+    }
     TF_LITE_ENSURE_STATUS(arena_.Allocate(
         context_, tensor_alignment_, tensor.bytes, &allocs_[tensor_index]));
   }
@@ -301,8 +381,11 @@ TfLiteStatus ArenaPlanner::CalculateAllocationOfInternalTensors(
 }
 
 TfLiteStatus ArenaPlanner::CalculateDeallocationOfInternalTensors(
-    int node_index) {
-  if (node_index < static_cast<int>(graph_info_->num_nodes())) {
+    int first_node, int end_node) {
+  for (int node_index = first_node;
+       node_index < end_node &&
+       node_index < static_cast<int>(graph_info_->num_nodes());
+       ++node_index) {
     const TfLiteNode& node = graph_info_->node(static_cast<size_t>(node_index));
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int i = 0; i < node_temporaries->size; ++i) {
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_ARENA_PLANNER_H_
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
+#include <list>
 #include <memory>
 #include <vector>
 
@@ -28,6 +29,8 @@ namespace tflite {
 // Memory allocation tuning
 constexpr const int kDefaultArenaAlignment = 64;
 constexpr const int kDefaultTensorAlignment = 64;
+// Number of allocation plans kept by ArenaPlanner for reuse.
+constexpr const int kMaxCachedArenaPlans = 8;
 
 struct AllocationInfo;
 
@@ -40,6 +43,20 @@ struct AllocationInfo;
 // share some of the buffer if a tensor B is to be allocated after another
 // tensor A has been deallocated.
 //
+// Tensors used by nodes that may run concurrently (see
+// GraphInfo::concurrent_nodes_end) never share memory: tensors and temporaries
+// released by one of these nodes are only reused after all of them are done.
+//
+// An offline plan may give the offset of some kTfLiteArenaRw tensors in the
+// arena. Each of these tensors is placed at its planned offset unless the
+// bytes there are still in use, e.g. because tensor sizes changed since the
+// plan was made, in which case it is planned like any other tensor.
+//
+// The plans made for the whole graph are cached, keyed by the size of every
+// tensor. Switching back and forth between a few input shapes, e.g. batch
+// sizes, then reuses the plan of each shape instead of making it again. Up to
+// kMaxCachedArenaPlans plans are kept, dropping the least recently used ones.
+//
 // If dynamic tensors are used the planning steps can be repeated during model
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
@@ -54,10 +71,12 @@ class ArenaPlanner : public MemoryPlanner {
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. If 'preserve_inputs' is true the inputs to the
   // graph will not share memory with any other tensor, effectively preserving
-  // them until the end of inference.
+  // them until the end of inference. 'offline_offsets' holds the planned
+  // offset of each tensor, or -1 for the tensors that have none.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_inputs, bool preserve_intermediates,
-               int tensor_alignment = kDefaultTensorAlignment);
+               int tensor_alignment = kDefaultTensorAlignment,
+               std::vector<int32_t> offline_offsets = {});
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -92,9 +111,22 @@ class ArenaPlanner : public MemoryPlanner {
   // 'node_index'.
   TfLiteStatus CalculateAllocationOfInternalTensors(int node_index);
 
-  // Register a deallocation for all internal (temporary) tensors of
-  // 'node_index'.
-  TfLiteStatus CalculateDeallocationOfInternalTensors(int node_index);
+  // Register a deallocation for all internal (temporary) tensors of the nodes
+  // in [first_node, end_node).
+  TfLiteStatus CalculateDeallocationOfInternalTensors(int first_node,
+                                                      int end_node);
+
+  // Returns what the allocations of the whole graph depend on besides its
+  // topology: the allocation type and size of every tensor, along with the
+  // temporaries of every node.
+  std::vector<size_t> GetPlanKey();
+
+  // Restores the allocations cached for 'key', if any, and marks them as the
+  // most recently used.
+  bool RestoreCachedPlan(const std::vector<size_t>& key);
+
+  // Caches the current allocations under 'key'.
+  void CachePlan(std::vector<size_t> key);
 
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
@@ -125,6 +157,18 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // Arena offsets planned ahead of time, indexed by tensor.
+  std::vector<int32_t> offline_offsets_;
+
+  // Allocations made for the whole graph, most recently used first.
+  struct CachedPlan {
+    std::vector<size_t> key;
+    std::vector<ArenaAlloc> allocs;
+    SimpleMemoryArena::State arena_state;
+    SimpleMemoryArena::State persistent_arena_state;
+  };
+  std::list<CachedPlan> cached_plans_;
 };
 
 }  // namespace tflite
@@ -104,16 +104,25 @@ class TestGraph {
   const std::vector<int>& outputs() { return outputs_; }
   const std::vector<int>& variables() { return variables_; }
 
+  const std::vector<size_t>& concurrent_nodes_end() {
+    return concurrent_nodes_end_;
+  }
+
   void SetVariables(const std::vector<int>& variables) {
     variables_ = variables;
   }
 
+  void SetConcurrentNodesEnd(const std::vector<size_t>& concurrent_nodes_end) {
+    concurrent_nodes_end_ = concurrent_nodes_end;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
     std::swap(inputs_, other->inputs_);
     std::swap(outputs_, other->outputs_);
     std::swap(variables_, other->variables_);
+    std::swap(concurrent_nodes_end_, other->concurrent_nodes_end_);
   }
 
  private:
@@ -122,6 +131,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<size_t> concurrent_nodes_end_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -143,6 +153,12 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  size_t concurrent_nodes_end(size_t index) const override {
+    if (graph_->concurrent_nodes_end().empty()) {
+      return index + 1;
+    }
+    return graph_->concurrent_nodes_end()[index];
+  }
 
  private:
   TestGraph* graph_;
@@ -162,12 +178,14 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_inputs = false) {
+  void SetGraph(TestGraph* graph, bool preserve_inputs = false,
+                std::vector<int32_t> offline_offsets = {}) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_inputs, /*preserve intermediates*/ false, kTensorAlignment));
+        preserve_inputs, /*preserve intermediates*/ false, kTensorAlignment,
+        std::move(offline_offsets)));
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -272,6 +290,47 @@ TEST_F(ArenaPlannerTest, SimpleGraph) {
   EXPECT_EQ(GetOffset(3), 0);
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithOfflinePlan) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph, /*preserve_inputs=*/false,
+           /*offline_offsets=*/{100, 0, 8, 0, 20, 40});
+  Execute(0, 10);
+
+  // Alloc(+) and dealloc(-) order: +0 +1 +2 -1 +4 +5 -2 -0 +3 -4 -5
+  EXPECT_EQ(GetOffset(0), 100);
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), 8);
+  EXPECT_EQ(GetOffset(4), 20);
+  EXPECT_EQ(GetOffset(5), 40);
+  EXPECT_EQ(GetOffset(3), 0);
+}
+
+TEST_F(ArenaPlannerTest, OfflinePlanFallsBackOnOverlap) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  // #2 would overlap #1, which is still in use when #2 is allocated.
+  SetGraph(&graph, /*preserve_inputs=*/false,
+           /*offline_offsets=*/{0, 4, 8, -1, -1, -1});
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), 4);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
@@ -317,6 +376,52 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithTemporary) {
   EXPECT_EQ(GetOffset(3), 0);
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithConcurrentNodes) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},     // First op
+                      {{1}, {2}, {}},     // Second op
+                      {{0}, {3}, {}},     // Third op, concurrent with second
+                      {{2, 3}, {4}, {}},  // Fourth op
+                  },
+                  {4});
+  // Tensor 3 would fit where tensor 1 was.
+  (*graph.tensors())[3].bytes = (*graph.tensors())[1].bytes;
+  graph.SetConcurrentNodesEnd({1, 3, 3, 4});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Alloc(+) and dealloc(-) order: +0 +1 +2 +3 -1 -0 +4 -2 -3
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(3));
+}
+
+TEST_F(ArenaPlannerTest, ConcurrentNodesWithTemporaries) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {2}},  // First op, with temporary
+                      {{0}, {3}, {4}},  // Second op, with temporary
+                  },
+                  {1, 3});
+  // Tensor 4 would fit where tensor 2 was.
+  (*graph.tensors())[4].bytes = (*graph.tensors())[2].bytes;
+  graph.SetConcurrentNodesEnd({2, 2});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Alloc(+) and dealloc(-) order: +2 +0 +1 +4 +3 -0 -2 -4
+  EXPECT_EQ(GetOffset(2), 0);
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithOptionals) {
   TestGraph graph({0, -1, 1},
                   {
@@ -363,6 +468,37 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithLargeTensor) {
   EXPECT_EQ(GetOffset(3), 0);
 }
 
+TEST_F(ArenaPlannerTest, ReusesCachedPlanAfterResize) {
+  TestGraph graph({0, -1, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},   // First op
+                      {{2, 0}, {4}, {5}},  // Second op, with temporary
+                      {{4, -1}, {3}, {}}   // Third op, with optional
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+  std::vector<int64_t> offsets;
+  for (int i = 0; i < 6; ++i) offsets.push_back(GetOffset(i));
+
+  // Growing #1 moves the tensors after it.
+  (*graph.tensors())[1].bytes = 40;
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(5), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+
+  // Going back to the original size, whose plan is cached, places the tensors
+  // where they were.
+  (*graph.tensors())[1].bytes = 6;
+  CHECK(planner_->ResetAllocations() == kTfLiteOk);
+  Execute(0, 10);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithPersistentTensor) {
   TestGraph graph({0, -1, 1},
                   {
@@ -0,0 +1,81 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/async_invoker.h"
+
+#include <utility>
+
+namespace tflite {
+
+AsyncInvoker::AsyncInvoker(Interpreter* interpreter)
+    : interpreter_(interpreter), thread_([this] { Run(); }) {}
+
+AsyncInvoker::~AsyncInvoker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_ = true;
+  }
+  cond_.notify_all();
+  thread_.join();
+}
+
+TfLiteStatus AsyncInvoker::Invoke(DoneCallback on_done) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (busy_) {
+      return kTfLiteError;
+    }
+    busy_ = true;
+    on_done_ = std::move(on_done);
+  }
+  cond_.notify_all();
+  return kTfLiteOk;
+}
+
+TfLiteStatus AsyncInvoker::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this] { return !busy_; });
+  const TfLiteStatus status = status_;
+  status_ = kTfLiteOk;
+  return status;
+}
+
+bool AsyncInvoker::IsBusy() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return busy_;
+}
+
+void AsyncInvoker::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    // An invocation in flight completes before the thread exits.
+    cond_.wait(lock, [this] { return busy_ || exit_; });
+    if (!busy_) {
+      return;
+    }
+    DoneCallback on_done = std::move(on_done_);
+    on_done_ = nullptr;
+    lock.unlock();
+    const TfLiteStatus status = interpreter_->Invoke();
+    if (on_done) {
+      on_done(status);
+    }
+    lock.lock();
+    status_ = status;
+    busy_ = false;
+    cond_.notify_all();
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,89 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_ASYNC_INVOKER_H_
+#define TENSORFLOW_LITE_ASYNC_INVOKER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+
+/// Invokes an interpreter on a dedicated thread, so that the caller can go on
+/// with other work, e.g. pre-processing the next frame or post-processing the
+/// previous one, while the interpreter and its delegates run.
+///
+/// At most one invocation is in flight at a time. While it is, the caller must
+/// not touch the interpreter, nor the data of its input and output tensors.
+/// To overlap the processing of consecutive frames, bind a second set of
+/// buffers to the inputs and outputs with
+/// Interpreter::SetCustomAllocationForTensor() after each Wait(), and fill or
+/// read the buffers of the other set meanwhile.
+///
+/// Example:
+///
+/// tflite::AsyncInvoker invoker(interpreter.get());
+/// invoker.Invoke([](TfLiteStatus status) { /* frame N is done */ });
+/// PreProcess(next_input_buffer);  // Runs while frame N is invoked.
+/// if (invoker.Wait() != kTfLiteOk) { ... }
+class AsyncInvoker {
+ public:
+  using DoneCallback = std::function<void(TfLiteStatus)>;
+
+  /// `interpreter` must outlive the invoker.
+  explicit AsyncInvoker(Interpreter* interpreter);
+  /// Waits for the invocation in flight, if any.
+  ~AsyncInvoker();
+
+  AsyncInvoker(const AsyncInvoker&) = delete;
+  AsyncInvoker& operator=(const AsyncInvoker&) = delete;
+
+  /// Starts invoking the interpreter and returns without waiting for it to
+  /// complete. `on_done`, if set, is called on the invoker's thread with the
+  /// status of Interpreter::Invoke() once it returns, before Wait() does; it
+  /// must not call Invoke() or Wait() itself. Returns kTfLiteError if an
+  /// invocation is already in flight.
+  TfLiteStatus Invoke(DoneCallback on_done = nullptr);
+
+  /// Blocks until the invocation in flight completes and returns its status.
+  /// Returns kTfLiteOk right away if nothing was invoked since the last Wait().
+  TfLiteStatus Wait();
+
+  /// Returns whether an invocation is in flight.
+  bool IsBusy();
+
+ private:
+  // The body of the invoker's thread.
+  void Run();
+
+  Interpreter* const interpreter_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  // Guarded by mutex_.
+  bool busy_ = false;
+  bool exit_ = false;
+  TfLiteStatus status_ = kTfLiteOk;
+  DoneCallback on_done_;
+  // Declared last, so that it starts once the fields above are initialized.
+  std::thread thread_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_ASYNC_INVOKER_H_
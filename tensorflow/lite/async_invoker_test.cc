@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/async_invoker.h"
+
+#include <memory>
+#include <mutex>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+// Builds an interpreter of a model computing x = a + b + c and y = d + b + c.
+std::unique_ptr<Interpreter> BuildMultiAddInterpreter(
+    std::unique_ptr<FlatBufferModel>* model) {
+  *model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  if (!*model) return nullptr;
+  ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  if (InterpreterBuilder(**model, resolver)(&interpreter) != kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    return nullptr;
+  }
+  return interpreter;
+}
+
+void FillInputs(Interpreter* interpreter, float value) {
+  for (int input = 0; input < 4; ++input) {
+    TfLiteTensor* tensor = interpreter->input_tensor(input);
+    for (int j = 0; j < tensor->bytes / sizeof(float); ++j) {
+      tensor->data.f[j] = value;
+    }
+  }
+}
+
+TEST(AsyncInvokerTest, InvokesAndCallsBack) {
+  std::unique_ptr<FlatBufferModel> model;
+  auto interpreter = BuildMultiAddInterpreter(&model);
+  ASSERT_NE(interpreter, nullptr);
+  AsyncInvoker invoker(interpreter.get());
+
+  for (int i = 0; i < 3; ++i) {
+    FillInputs(interpreter.get(), i);
+    TfLiteStatus callback_status = kTfLiteError;
+    float callback_output = -1.f;
+    ASSERT_EQ(invoker.Invoke([&](TfLiteStatus status) {
+                callback_status = status;
+                callback_output = interpreter->typed_output_tensor<float>(0)[0];
+              }),
+              kTfLiteOk);
+    EXPECT_EQ(invoker.Wait(), kTfLiteOk);
+    EXPECT_FALSE(invoker.IsBusy());
+    // The callback runs before Wait() returns.
+    EXPECT_EQ(callback_status, kTfLiteOk);
+    EXPECT_EQ(callback_output, 3 * i);
+    EXPECT_EQ(interpreter->typed_output_tensor<float>(1)[0], 3 * i);
+  }
+}
+
+TEST(AsyncInvokerTest, RejectsOverlappingInvocations) {
+  std::unique_ptr<FlatBufferModel> model;
+  auto interpreter = BuildMultiAddInterpreter(&model);
+  ASSERT_NE(interpreter, nullptr);
+  AsyncInvoker invoker(interpreter.get());
+  FillInputs(interpreter.get(), 1.f);
+
+  // Hold the invocation in its callback until the second one was attempted.
+  std::mutex mutex;
+  std::unique_lock<std::mutex> hold(mutex);
+  ASSERT_EQ(invoker.Invoke([&mutex](TfLiteStatus) {
+              std::lock_guard<std::mutex> lock(mutex);
+            }),
+            kTfLiteOk);
+  EXPECT_TRUE(invoker.IsBusy());
+  EXPECT_EQ(invoker.Invoke(), kTfLiteError);
+  hold.unlock();
+  EXPECT_EQ(invoker.Wait(), kTfLiteOk);
+  EXPECT_EQ(interpreter->typed_output_tensor<float>(0)[0], 3.f);
+}
+
+TEST(AsyncInvokerTest, WaitWithoutInvokeReturnsRightAway) {
+  std::unique_ptr<FlatBufferModel> model;
+  auto interpreter = BuildMultiAddInterpreter(&model);
+  ASSERT_NE(interpreter, nullptr);
+  AsyncInvoker invoker(interpreter.get());
+  EXPECT_FALSE(invoker.IsBusy());
+  EXPECT_EQ(invoker.Wait(), kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
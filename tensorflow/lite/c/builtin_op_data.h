@@ -126,6 +126,8 @@ typedef struct {
 typedef enum {
   kTfLiteFullyConnectedWeightsFormatDefault = 0,
   kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8 = 1,
+  kTfLiteFullyConnectedWeightsFormatSparse1x4 = 2,
+  kTfLiteFullyConnectedWeightsFormatPackedInt4 = 3,
 } TfLiteFullyConnectedWeightsFormat;
 
 typedef struct {
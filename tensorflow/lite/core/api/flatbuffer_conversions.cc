@@ -328,6 +328,14 @@ TfLiteStatus ParseOpData(const Operator* op, BuiltinOperator op_type,
             params->weights_format =
                 kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8;
             break;
+          case FullyConnectedOptionsWeightsFormat_SPARSE1x4:
+            params->weights_format =
+                kTfLiteFullyConnectedWeightsFormatSparse1x4;
+            break;
+          case FullyConnectedOptionsWeightsFormat_PACKED_INT4:
+            params->weights_format =
+                kTfLiteFullyConnectedWeightsFormatPackedInt4;
+            break;
           default:
             error_reporter->Report("Unhandled fully-connected weights format.");
             return kTfLiteError;
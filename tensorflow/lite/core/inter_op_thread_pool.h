@@ -0,0 +1,69 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tflite {
+
+// A minimal thread pool that runs the nodes of a subgraph that don't depend on
+// each other concurrently. The thread calling ParallelFor takes part in the
+// work, so a pool of `num_threads` threads starts `num_threads - 1` workers.
+class InterOpThreadPool {
+ public:
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  // Calls `fn(task, thread)` for every `task` in [0, num_tasks) and returns
+  // once all the calls are done. `thread` is 0 for the calling thread and in
+  // [1, num_threads()) for the workers, and no two concurrent calls share
+  // one. Must not be called concurrently.
+  void ParallelFor(int num_tasks, const std::function<void(int, int)>& fn);
+
+  int num_threads() const { return workers_.size() + 1; }
+
+ private:
+  void WorkerLoop(int thread);
+  void RunTasks(int thread);
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  // Signaled when a new ParallelFor starts or the pool shuts down.
+  std::condition_variable work_available_;
+  // Signaled when the last worker is done with the current ParallelFor.
+  std::condition_variable work_done_;
+  // Incremented by every ParallelFor.
+  int generation_ = 0;
+  int busy_workers_ = 0;
+  bool shutting_down_ = false;
+
+  const std::function<void(int, int)>* fn_ = nullptr;
+  int num_tasks_ = 0;
+  std::atomic<int> next_task_{0};
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
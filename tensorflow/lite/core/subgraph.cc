@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <numeric>
 
 #include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/builtin_ops.h"
@@ -88,6 +90,30 @@ bool HasDynamicTensor(const TfLiteContext& context,
   return HasDynamicTensorImpl(context, TfLiteIntArrayView{int_array});
 }
 
+// Returns true if `node` must not run concurrently with any other node.
+bool MustRunAlone(const TfLiteContext& context, const TfLiteNode& node,
+                  const TfLiteRegistration& registration) {
+  switch (registration.builtin_code) {
+    // Custom ops may not be thread-safe, and control flow ops invoke other
+    // subgraphs, which only run one at a time.
+    case kTfLiteBuiltinCall:
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinWhile:
+      return true;
+    default:
+      break;
+  }
+  // Variable tensors are updated in place, so their users must run in order.
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (tensor_index != kOptionalTensor &&
+        context.tensors[tensor_index].is_variable) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // Gets the legacy TfLiteQuantizationParams from the current TfLiteQuantization.
 TfLiteQuantizationParams GetLegacyQuantization(
     const TfLiteQuantization& quantization) {
@@ -186,6 +212,12 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  size_t concurrent_nodes_end(size_t index) const override {
+    if (subgraph_->concurrent_nodes_end_.empty()) {
+      return index + 1;
+    }
+    return subgraph_->concurrent_nodes_end_[index];
+  }
 
  public:
   Subgraph* subgraph_;
@@ -409,7 +441,16 @@ TfLiteExternalContext* Subgraph::GetExternalContext(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     struct TfLiteContext* context, TfLiteExternalContextType type) {
-  return static_cast<Subgraph*>(context->impl_)->GetExternalContext(type);
+  auto* subgraph = static_cast<Subgraph*>(context->impl_);
+  if (type == kTfLiteCpuBackendContext && context != &subgraph->context_) {
+    // Nodes run by inter-op worker threads get their own CPU backend context.
+    for (int i = 0; i < subgraph->inter_op_contexts_.size(); ++i) {
+      if (context == &subgraph->inter_op_contexts_[i]) {
+        return subgraph->inter_op_cpu_backend_contexts_[i].get();
+      }
+    }
+  }
+  return subgraph->GetExternalContext(type);
 }
 
 void Subgraph::SetExternalContext(TfLiteExternalContextType type,
@@ -468,6 +509,67 @@ TfLiteStatus Subgraph::SetVariables(std::vector<int> variables) {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::SetOfflineMemoryPlan(std::vector<int32_t> offsets) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError("SetOfflineMemoryPlan is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_EQ(&context_, offsets.size(), tensors_.size());
+  offline_memory_plan_ = std::move(offsets);
+  // Plan the memory again.
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetCustomAllocationForTensor(
+    int tensor_index, const TfLiteCustomAllocation& allocation) {
+  TF_LITE_ENSURE(&context_,
+                 tensor_index < context_.tensors_size && tensor_index >= 0);
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  if (std::find(inputs_.begin(), inputs_.end(), tensor_index) ==
+          inputs_.end() &&
+      std::find(outputs_.begin(), outputs_.end(), tensor_index) ==
+          outputs_.end()) {
+    ReportError("Tensor %d is neither an input nor an output.", tensor_index);
+    return kTfLiteError;
+  }
+  if (tensor.allocation_type != kTfLiteArenaRw &&
+      tensor.allocation_type != kTfLiteCustom) {
+    ReportError("Tensor %d isn't arena allocated, so it can't be bound.",
+                tensor_index);
+    return kTfLiteError;
+  }
+  if (allocation.data == nullptr ||
+      reinterpret_cast<uintptr_t>(allocation.data) % kDefaultTensorAlignment !=
+          0) {
+    ReportError("The buffer of tensor %d must be aligned to %d bytes.",
+                tensor_index, kDefaultTensorAlignment);
+    return kTfLiteError;
+  }
+  // The size of outputs may not be known before AllocateTensors(), in which
+  // case it's checked when they are resized.
+  if (allocation.bytes < tensor.bytes) {
+    ReportError("Tensor %d needs %zu bytes, but its buffer has %zu.",
+                tensor_index, tensor.bytes, allocation.bytes);
+    return kTfLiteError;
+  }
+
+  if (tensor.allocation_type == kTfLiteArenaRw) {
+    // Moving the tensor out of the arena changes the arena layout.
+    if (state_ == kStateInvokableAndImmutable) {
+      ReportError(
+          "SetCustomAllocationForTensor is disallowed when graph is immutable.");
+      return kTfLiteError;
+    }
+    tensor.allocation_type = kTfLiteCustom;
+    state_ = kStateUninvokable;
+  }
+  custom_allocations_[tensor_index] = allocation;
+  tensor.data.raw = static_cast<char*>(allocation.data);
+  return kTfLiteOk;
+}
+
 void Subgraph::SetCancellationFunction(void* data,
                                        bool (*check_cancelled_func)(void*)) {
   cancellation_data_ = data;
@@ -573,6 +675,7 @@ TfLiteStatus Subgraph::AllocateTensors() {
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
   state_ = kStateInvokable;
+  invoked_since_allocation_ = false;
 
   // Reset the variable tensors to zero after (re)allocating the tensors.
   // Developers shouldn't rely on the side effect of this function to reset
@@ -767,9 +870,11 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
 
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   if (!memory_planner_) {
+    TF_LITE_ENSURE_STATUS(PlanConcurrentNodes());
     memory_planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
-        /*preserve_inputs=*/true, /*preserve_intermediates*/ false));
+        /*preserve_inputs=*/true, /*preserve_intermediates*/ false,
+        kDefaultTensorAlignment, offline_memory_plan_));
     memory_planner_->PlanAllocations();
   }
 
@@ -810,6 +915,13 @@ TfLiteStatus Subgraph::Invoke() {
     applied_nnapi_delegate_ = true;
   }
 
+  if (invoked_since_allocation_ && !has_dynamic_tensors_ &&
+      profiler_ == nullptr &&
+      concurrent_nodes_end_.size() == execution_plan_.size() &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    return InvokeConcurrently();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -900,9 +1012,147 @@ TfLiteStatus Subgraph::Invoke() {
     }
   }
 
+  invoked_since_allocation_ = true;
   return status;
 }
 
+TfLiteStatus Subgraph::InvokeConcurrently() {
+  EnsureTensorsVectorCapacity();
+  for (int i = 0; i < inter_op_contexts_.size(); ++i) {
+    inter_op_contexts_[i] = context_;
+    inter_op_cpu_backend_contexts_[i]->Refresh(&inter_op_contexts_[i]);
+  }
+
+  const int plan_size = execution_plan_.size();
+  std::vector<TfLiteStatus> statuses;
+  for (int begin = 0; begin < plan_size;) {
+    const int end = concurrent_nodes_end_[begin];
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+
+    statuses.assign(end - begin, kTfLiteOk);
+    inter_op_thread_pool_->ParallelFor(end - begin, [&](int task, int thread) {
+      TfLiteContext* context =
+          thread == 0 ? &context_ : &inter_op_contexts_[thread - 1];
+      auto& node_and_registration =
+          nodes_and_registration_[execution_plan_[begin + task]];
+      const TfLiteRegistration& registration = node_and_registration.second;
+      statuses[task] =
+          registration.invoke == nullptr
+              ? kTfLiteError
+              : registration.invoke(context, &node_and_registration.first);
+    });
+    for (int task = 0; task < end - begin; ++task) {
+      if (statuses[task] == kTfLiteError) {
+        const int node_index = execution_plan_[begin + task];
+        return ReportOpError(&context_,
+                             nodes_and_registration_[node_index].first,
+                             nodes_and_registration_[node_index].second,
+                             node_index, "failed to invoke");
+      }
+    }
+    begin = end;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetNumInterOpThreads(int num_threads) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError("SetNumInterOpThreads is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE(&context_, num_threads >= 1);
+  if (num_threads == inter_op_num_threads_) {
+    return kTfLiteOk;
+  }
+  inter_op_num_threads_ = num_threads;
+  inter_op_thread_pool_.reset(
+      num_threads > 1 ? new InterOpThreadPool(num_threads) : nullptr);
+  inter_op_contexts_.resize(num_threads - 1);
+  inter_op_cpu_backend_contexts_.clear();
+  for (int i = 1; i < num_threads; ++i) {
+    inter_op_cpu_backend_contexts_.emplace_back(new ExternalCpuBackendContext);
+  }
+  // Plan the execution order and the memory again.
+  memory_planner_.reset();
+  concurrent_nodes_end_.clear();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::PlanConcurrentNodes() {
+  concurrent_nodes_end_.clear();
+  if (inter_op_num_threads_ <= 1) {
+    return kTfLiteOk;
+  }
+
+  // Each node is assigned to the earliest stage after the nodes producing its
+  // inputs and the last node that must run alone. The nodes of a stage don't
+  // depend on each other and can run concurrently.
+  const int plan_size = execution_plan_.size();
+  std::vector<int> tensor_stage(tensors_.size(), -1);
+  std::vector<int> node_stage(plan_size);
+  int num_stages = 0;
+  int first_free_stage = 0;
+  for (int i = 0; i < plan_size; ++i) {
+    const auto& node_and_registration =
+        nodes_and_registration_[execution_plan_[i]];
+    const TfLiteNode& node = node_and_registration.first;
+    if (node.delegate != nullptr) {
+      // Delegate kernels share the state of their delegate.
+      return kTfLiteOk;
+    }
+    int stage = first_free_stage;
+    if (MustRunAlone(context_, node, node_and_registration.second)) {
+      stage = num_stages;
+      first_free_stage = stage + 1;
+    } else {
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index != kOptionalTensor) {
+          stage = std::max(stage, tensor_stage[tensor_index] + 1);
+        }
+      }
+    }
+    node_stage[i] = stage;
+    num_stages = std::max(num_stages, stage + 1);
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      tensor_stage[tensor_index] = stage;
+    }
+  }
+  if (num_stages == plan_size) {
+    return kTfLiteOk;
+  }
+
+  // Ordering the nodes by stage keeps the execution plan a valid topological
+  // sort.
+  std::vector<int> order(plan_size);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&node_stage](int a, int b) {
+    return node_stage[a] < node_stage[b];
+  });
+  std::vector<int> new_plan(plan_size);
+  for (int i = 0; i < plan_size; ++i) {
+    new_plan[i] = execution_plan_[order[i]];
+  }
+  execution_plan_ = std::move(new_plan);
+
+  concurrent_nodes_end_.resize(plan_size);
+  for (int begin = 0; begin < plan_size;) {
+    int end = begin + 1;
+    while (end < plan_size &&
+           node_stage[order[end]] == node_stage[order[begin]]) {
+      ++end;
+    }
+    std::fill(concurrent_nodes_end_.begin() + begin,
+              concurrent_nodes_end_.begin() + end, end);
+    begin = end;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1007,6 +1257,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadOnly(
   }
 
   TfLiteTensor& tensor = context_.tensors[tensor_index];
+  custom_allocations_.erase(tensor_index);
   if (type == tensor.type &&
       EqualArrayAndTfLiteIntArray(tensor.dims, rank, dims)) {
     // Fast path which does not invalidate the invokable property.
@@ -1070,6 +1321,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadWrite(
   }
 
   TfLiteTensor& tensor = context_.tensors[tensor_index];
+  custom_allocations_.erase(tensor_index);
   TfLiteTensorReset(type, name, ConvertArrayToTfLiteIntArray(rank, dims),
                     GetLegacyQuantization(quantization),
                     /*buffer=*/nullptr, required_bytes, allocation_type,
@@ -1094,7 +1346,8 @@ TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
   // Note that in theory we could resize kTfLiteArenaRwPersistent tensors too.
   if (tensor->allocation_type == kTfLiteArenaRw ||
       tensor->allocation_type == kTfLiteDynamic ||
-      tensor->allocation_type == kTfLiteArenaRwPersistent) {
+      tensor->allocation_type == kTfLiteArenaRwPersistent ||
+      tensor->allocation_type == kTfLiteCustom) {
     tensor_resized_since_op_invoke_ |=
         TfLiteIntArrayEqual(tensor->dims, new_size) == 0;
     if (tensor->type != kTfLiteString) {
@@ -1106,6 +1359,17 @@ TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
         return kTfLiteError;
       }
 
+      if (tensor->allocation_type == kTfLiteCustom) {
+        const int tensor_index = tensor - context_.tensors;
+        const size_t available = custom_allocations_[tensor_index].bytes;
+        if (bytesRequired > available) {
+          TfLiteIntArrayFree(new_size);
+          ReportError("Tensor %d needs %zu bytes, but its buffer has %zu.",
+                      tensor_index, bytesRequired, available);
+          return kTfLiteError;
+        }
+      }
+
       // Realloc space for kTfLiteDynamic tensors.
       TfLiteTensorRealloc(bytesRequired, tensor);
       tensor->bytes = bytesRequired;
@@ -1113,7 +1377,8 @@ TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
     if (tensor->dims) TfLiteIntArrayFree(tensor->dims);
     tensor->dims = new_size;
 
-    if (tensor->allocation_type != kTfLiteDynamic) {
+    if (tensor->allocation_type != kTfLiteDynamic &&
+        tensor->allocation_type != kTfLiteCustom) {
       tensor->data.raw = nullptr;
     }
   } else {
@@ -1211,6 +1476,7 @@ TfLiteStatus Subgraph::RedoAllDelegates() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    TF_LITE_ENSURE_OK(&context_, PlanConcurrentNodes());
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
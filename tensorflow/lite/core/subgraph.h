@@ -17,13 +17,16 @@ limitations under the License.
 
 #include <cstdlib>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #include "tensorflow/lite/experimental/resource_variable/resource_variable.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
 
@@ -35,6 +38,7 @@ class NNAPIDelegate;
 class Subgraph {
  public:
   friend class Interpreter;
+  friend class InterpreterInfo;
 
   Subgraph(ErrorReporter* error_reporter,
            TfLiteExternalContext** external_contexts,
@@ -63,6 +67,25 @@ class Subgraph {
   // interpreter.
   TfLiteStatus SetVariables(std::vector<int> variables);
 
+  // Provide the offset in the arena planned ahead of time for each tensor, or
+  // -1 for the tensors to plan at runtime (see ArenaPlanner). Typically set
+  // by the InterpreterBuilder from the model metadata.
+  TfLiteStatus SetOfflineMemoryPlan(std::vector<int32_t> offsets);
+
+  // Backs the input or output tensor `tensor_index` with `allocation`, a
+  // buffer owned by the caller, instead of the arena, so that the caller
+  // doesn't need to copy data in or out. The data must be aligned to
+  // kDefaultTensorAlignment and remain valid until the tensor is bound to
+  // another buffer or the subgraph is destroyed.
+  //
+  // The binding survives Invoke() and AllocateTensors(). The first binding of
+  // a tensor takes effect on the next AllocateTensors(), which drops the
+  // tensor from the arena, while binding it again only swaps the buffer.
+  // Resizing the tensor beyond `allocation.bytes` fails.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetCustomAllocationForTensor(
+      int tensor_index, const TfLiteCustomAllocation& allocation);
+
   // Ensure the internal node storage memory allocates at least `count`
   // spots for node. NOTE, this doesn't actually add operators. This is an
   // efficiency optimization that is subject to change.
@@ -250,6 +273,20 @@ class Subgraph {
   // WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  // Runs nodes of the execution plan that don't depend on each other on up to
+  // `num_threads` threads, which is 1 (sequential execution) by default.
+  // Takes effect on the next call to AllocateTensors(), which reorders the
+  // execution plan so that nodes that can run concurrently are adjacent and
+  // keeps their tensors from sharing memory.
+  //
+  // Nodes run one at a time if the subgraph has dynamic tensors, delegates or
+  // a profiler, and custom, control flow and stateful nodes always run alone.
+  // The first Invoke() after AllocateTensors() is sequential too, so that
+  // kernels can lazily initialize state they share. Each thread gets its own
+  // CPU backend context, with up to `recommended_num_threads` threads.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
   // Ensure the data in `tensor.data` is readable. In case delegate is used,
   // it might require to copy the data from delegate buffer to raw memory.
   // WARNING: This is an experimental API and subject to change.
@@ -339,6 +376,15 @@ class Subgraph {
   // to wait until Invoke() to resolve the sizes of dynamic tensors.
   TfLiteStatus PrepareOpsAndTensors();
 
+  // Reorders the execution plan so that nodes that can run concurrently are
+  // adjacent, and fills `concurrent_nodes_end_`. Does nothing unless more than
+  // one inter-op thread is requested.
+  TfLiteStatus PlanConcurrentNodes();
+
+  // Runs the execution plan with nodes that don't depend on each other running
+  // concurrently. All ops must have been prepared.
+  TfLiteStatus InvokeConcurrently();
+
   // Call OpPrepare() for all ops starting at 'first_node'. Stop when a
   // dynamic tensors is found or all ops have been prepared. Fill
   // 'last_node_prepared' with the id of the op containing dynamic tensors, or
@@ -605,6 +651,32 @@ class Subgraph {
   // Whether the subgraph is currently in use (e.g. running the `Invoke`
   // or `AllocateTensors` functions).
   bool is_subgraph_in_use_ = false;
+
+  // The maximum number of nodes that run concurrently.
+  int inter_op_num_threads_ = 1;
+
+  // Runs concurrent nodes if `inter_op_num_threads_` > 1.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
+  // For each execution plan index, one past the last index of the nodes that
+  // may run concurrently with it. Empty if nodes run one at a time.
+  std::vector<int> concurrent_nodes_end_;
+
+  // Copies of `context_` passed to the nodes run by the inter-op worker
+  // threads, so that each worker uses its own CPU backend context.
+  std::vector<TfLiteContext> inter_op_contexts_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      inter_op_cpu_backend_contexts_;
+
+  // Whether Invoke() ran sequentially since the tensors were last allocated.
+  bool invoked_since_allocation_ = false;
+
+  // Arena offsets planned ahead of time, indexed by tensor. Empty if there is
+  // no such plan.
+  std::vector<int32_t> offline_memory_plan_;
+
+  // Buffers owned by the caller backing kTfLiteCustom tensors, by tensor.
+  std::map<int, TfLiteCustomAllocation> custom_allocations_;
 };
 
 }  // namespace tflite
@@ -66,9 +66,8 @@ class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
   explicit TfLiteTensorBuffer(const TfLiteTensor* tensor)
       : BaseTfLiteTensorBuffer(tensorflow::cpu_allocator()->AllocateRaw(
             EIGEN_MAX_ALIGN_BYTES, tensor->bytes)) {
-    // TODO(ahentz): if we can guarantee that TF Lite allocated tensors with
-    // the same alignment as TensorFlow (EIGEN_MAX_ALIGN_BYTES), then we can
-    // potentially eliminate the copy below.
+    // Data aligned to EIGEN_MAX_ALIGN_BYTES can avoid this copy, see
+    // AliasingTfLiteTensorBuffer.
     len_ = tensor->bytes;
 
     LogAllocation();
@@ -89,6 +88,28 @@ class TfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
   size_t len_;
 };
 
+// A tensor buffer for the same data types as above, pointing to the data of
+// the TfLiteTensor rather than to a copy of it. TF Lite keeps owning the data.
+class AliasingTfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
+ public:
+  explicit AliasingTfLiteTensorBuffer(const TfLiteTensor* tensor)
+      : BaseTfLiteTensorBuffer(tensor->data.raw), len_(tensor->bytes) {}
+
+  size_t size() const override { return len_; }
+
+ private:
+  size_t len_;
+};
+
+// Returns true if TensorFlow can use the TfLiteTensor's data as is: strings
+// have different formats, and TensorFlow's kernels expect their data to be
+// aligned to EIGEN_MAX_ALIGN_BYTES.
+bool CanAliasTfLiteTensor(const TfLiteTensor* tensor) {
+  return tensor->type != kTfLiteString && tensor->data.raw != nullptr &&
+         reinterpret_cast<uintptr_t>(tensor->data.raw) % EIGEN_MAX_ALIGN_BYTES ==
+             0;
+}
+
 // A string buffer. TFLITE string tensor format is different than
 // TF's so we need perform the conversion here.
 class StringTfLiteTensorBuffer : public BaseTfLiteTensorBuffer {
@@ -150,7 +171,12 @@ tensorflow::Tensor BufferMap::GetTensor(int tensor_index) const {
   return id_to_tensor_.at(tensor_index);
 }
 
-void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor) {
+bool BufferMap::IsTfLiteAlias(int tensor_index) const {
+  return HasTensor(tensor_index) && tflite_aliases_.count(tensor_index) > 0;
+}
+
+void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor,
+                              bool alias_data) {
   tensorflow::TensorShape shape;
   int num_dims = tensor->dims->size;
   for (int i = 0; i < num_dims; ++i) {
@@ -160,8 +186,11 @@ void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor) {
   // for it. This is not always the best approach. For example, this might
   // be a reallocation after resizing tensors. In that case it would be
   // preferable to somehow reuse the buffer.
+  const bool is_alias = alias_data && CanAliasTfLiteTensor(tensor);
   BaseTfLiteTensorBuffer* buf;
-  if (tensor->type == kTfLiteString) {
+  if (is_alias) {
+    buf = new AliasingTfLiteTensorBuffer(tensor);
+  } else if (tensor->type == kTfLiteString) {
     buf = new StringTfLiteTensorBuffer(tensor);
   } else {
     buf = new TfLiteTensorBuffer(tensor);
@@ -172,11 +201,17 @@ void BufferMap::SetFromTfLite(int tensor_index, const TfLiteTensor* tensor) {
 
   id_to_tensor_[tensor_index] = std::move(t);
   owned_by_tf_.erase(tensor_index);
+  if (is_alias) {
+    tflite_aliases_.insert(tensor_index);
+  } else {
+    tflite_aliases_.erase(tensor_index);
+  }
 }
 
 void BufferMap::SetFromTensorFlow(int tensor_index, tensorflow::Tensor tensor) {
   id_to_tensor_[tensor_index] = std::move(tensor);
   owned_by_tf_.insert(tensor_index);
+  tflite_aliases_.erase(tensor_index);
 }
 
 }  // namespace flex
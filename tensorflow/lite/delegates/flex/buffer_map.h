@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_DELEGATES_FLEX_BUFFER_MAP_H_
 
 #include <map>
+#include <set>
 
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -53,8 +54,17 @@ class BufferMap {
   void SetFromTensorFlow(int tensor_index, tensorflow::Tensor tensor);
 
   // Same as above but creates a new tensorflow::Tensor with a copy of the
-  // given TfLiteTensor's data.
-  void SetFromTfLite(int tensor_index, const TfLiteTensor* tensor);
+  // given TfLiteTensor's data. If 'alias_data' is true, the new
+  // tensorflow::Tensor points to the TfLiteTensor's data instead, whenever
+  // its type and alignment allow it. The data must then stay valid for as
+  // long as the tensorflow::Tensor, or any tensor sharing its buffer, is used.
+  void SetFromTfLite(int tensor_index, const TfLiteTensor* tensor,
+                     bool alias_data = false);
+
+  // Returns true if the tensorflow::Tensor associated with the given
+  // 'tensor_index' points to the data of a TfLiteTensor rather than to a copy
+  // of it.
+  bool IsTfLiteAlias(int tensor_index) const;
 
  private:
   // Mapping from TL Lite tensor ID to TensorFlow's Tensor. All tensors that
@@ -68,6 +78,8 @@ class BufferMap {
   // TensorFlow. This set keeps track of all input or output tensors that have
   // been populated by tensorflow.
   std::set<int> owned_by_tf_;
+  // The tensors added by SetFromTfLite() without copying their data.
+  std::set<int> tflite_aliases_;
 };
 
 }  // namespace flex
@@ -224,6 +224,61 @@ TEST(BufferMapTest, TensorFlowOverwritesTfLite) {
               ElementsAre(0, 0, 0, 0.123f, 0, 0));
 }
 
+TEST(BufferMapTest, SetFromTfLiteAliasingData) {
+  alignas(EIGEN_MAX_ALIGN_BYTES) float data[] = {0, 0, 0, 0.123f, 0, 0, 0};
+  TfLiteTensor t;
+  memset(&t, 0, sizeof(TfLiteTensor));
+  t.allocation_type = kTfLiteArenaRw;
+  t.type = kTfLiteFloat32;
+  t.dims = ConvertVectorToTfLiteIntArray({1, 2, 1, 3});
+  t.data.f = data;
+  t.bytes = 6 * sizeof(float);
+
+  BufferMap buffer_map;
+  buffer_map.SetFromTfLite(0, &t, /*alias_data=*/true);
+  EXPECT_TRUE(buffer_map.IsTfLiteAlias(0));
+  EXPECT_FALSE(buffer_map.IsTensorFlowTensor(0));
+  data[0] = 1;
+  EXPECT_THAT(GetTensorData<float>(buffer_map.GetTensor(0)),
+              ElementsAre(1, 0, 0, 0.123f, 0, 0));
+
+  // Misaligned data is copied.
+  t.data.f = data + 1;
+  buffer_map.SetFromTfLite(0, &t, /*alias_data=*/true);
+  EXPECT_FALSE(buffer_map.IsTfLiteAlias(0));
+  data[1] = 2;
+  EXPECT_THAT(GetTensorData<float>(buffer_map.GetTensor(0)),
+              ElementsAre(0, 0, 0.123f, 0, 0, 0));
+
+  // So is data that isn't explicitly allowed to be aliased.
+  t.data.f = data;
+  buffer_map.SetFromTfLite(0, &t);
+  EXPECT_FALSE(buffer_map.IsTfLiteAlias(0));
+
+  TfLiteIntArrayFree(t.dims);
+}
+
+TEST(BufferMapTest, TensorFlowOverwritesTfLiteAlias) {
+  alignas(EIGEN_MAX_ALIGN_BYTES) float data[] = {0, 0, 0, 0.123f, 0, 0};
+  TfLiteTensor t1;
+  memset(&t1, 0, sizeof(TfLiteTensor));
+  t1.allocation_type = kTfLiteArenaRw;
+  t1.type = kTfLiteFloat32;
+  t1.dims = ConvertVectorToTfLiteIntArray({1, 2, 1, 3});
+  t1.data.f = data;
+  t1.bytes = sizeof(data);
+  tensorflow::Tensor t2 = MakeTensor<int>({1, 2, 4}, {0, 0, 0, 3, 0, 0, 1, 2});
+
+  BufferMap buffer_map;
+  buffer_map.SetFromTfLite(0, &t1, /*alias_data=*/true);
+  buffer_map.SetFromTensorFlow(0, t2);
+
+  EXPECT_FALSE(buffer_map.IsTfLiteAlias(0));
+  EXPECT_TRUE(buffer_map.IsTensorFlowTensor(0));
+
+  TfLiteIntArrayFree(t1.dims);
+}
+
 }  // namespace
 }  // namespace flex
 }  // namespace tflite
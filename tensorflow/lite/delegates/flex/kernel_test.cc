@@ -136,6 +136,26 @@ TEST_F(KernelTest, FullGraph) {
   ASSERT_THAT(GetValues(8), ElementsAre(24.0f, 32.0f, 48.0f));
 }
 
+TEST_F(KernelTest, ForwardedInput) {
+  // Identity forwards its input, whose data TF Lite owns.
+  AddTensors(2, {0}, {1}, kTfLiteFloat32, {3});
+  AddTfOp(testing::kIdentity, {0}, {1});
+
+  ConfigureDelegate([](TfLiteContext* context, TfLiteDelegate* delegate) {
+    return GenericPrepare(context, delegate, {0});
+  });
+
+  SetShape(0, {2, 2, 1});
+  SetValues(0, {1.1f, 2.2f, 3.3f, 4.4f});
+  ASSERT_TRUE(Invoke());
+  ASSERT_THAT(GetShape(1), ElementsAre(2, 2, 1));
+  ASSERT_THAT(GetValues(1), ElementsAre(1.1f, 2.2f, 3.3f, 4.4f));
+
+  SetValues(0, {5.5f, 6.6f, 7.7f, 8.8f});
+  ASSERT_TRUE(Invoke());
+  ASSERT_THAT(GetValues(1), ElementsAre(5.5f, 6.6f, 7.7f, 8.8f));
+}
+
 TEST_F(KernelTest, BadTensorFlowOp) {
   AddTensors(2, {0}, {1}, kTfLiteFloat32, {3});
   AddTfOp(testing::kNonExistent, {0}, {1});
@@ -16,7 +16,13 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/cl/gpu_api_delegate.h"
 
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
@@ -28,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/common/model_transformer.h"
 #include "tensorflow/lite/delegates/gpu/common/status.h"
 #include "tensorflow/lite/delegates/gpu/common/transformations/general_transformations.h"
+#include <farmhash.h>
 
 namespace tflite {
 namespace gpu {
@@ -70,6 +77,86 @@ DataLayout ToDataLayoutFromTFL(TfLiteGpuDataLayout data_layout) {
   }
 }
 
+// Returns a fingerprint of the nodes replaced by the delegate, the tensors they
+// use, the values of their constant tensors and the compile options. It only
+// picks the cache file: the programs in it are looked up by a fingerprint of
+// their source, so a collision can't make the delegate run the wrong kernels.
+uint64_t GetModelFingerprint(TfLiteContext* context,
+                             const TfLiteDelegateParams* delegate_params,
+                             const TfLiteGpuCompileOptions_New& options) {
+  std::vector<uint64_t> description = {
+      static_cast<uint64_t>(options.precision_loss_allowed),
+      static_cast<uint64_t>(options.inference_priority)};
+  auto add_tensor = [&](int tensor_index) {
+    description.push_back(tensor_index);
+    if (tensor_index < 0) {
+      return;
+    }
+    const TfLiteTensor& tensor = context->tensors[tensor_index];
+    description.push_back(tensor.type);
+    if (tensor.dims) {
+      description.insert(description.end(), tensor.dims->data,
+                         tensor.dims->data + tensor.dims->size);
+    }
+    if (tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw_const) {
+      description.push_back(
+          ::util::Fingerprint64(tensor.data.raw_const, tensor.bytes));
+    }
+  };
+  const TfLiteIntArray* nodes = delegate_params->nodes_to_replace;
+  for (int i = 0; i < nodes->size; ++i) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    if (context->GetNodeAndRegistration(context, nodes->data[i], &node,
+                                        &registration) != kTfLiteOk) {
+      continue;
+    }
+    description.push_back(registration->builtin_code);
+    description.push_back(registration->version);
+    if (registration->custom_name) {
+      description.push_back(::util::Fingerprint64(
+          registration->custom_name, strlen(registration->custom_name)));
+    }
+    for (int j = 0; j < node->inputs->size; ++j) {
+      add_tensor(node->inputs->data[j]);
+    }
+    for (int j = 0; j < node->outputs->size; ++j) {
+      add_tensor(node->outputs->data[j]);
+    }
+  }
+  return ::util::Fingerprint64(
+      reinterpret_cast<const char*>(description.data()),
+      description.size() * sizeof(description[0]));
+}
+
+bool ReadCacheFile(const std::string& path, std::vector<uint8_t>* data) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  data->resize(file.tellg());
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(data->data()), data->size());
+  return file.good();
+}
+
+// Writes to a temporary file first, so that a crash or a concurrent run never
+// leaves a truncated cache behind.
+bool WriteCacheFile(const std::string& path, const std::vector<uint8_t>& data) {
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file.good()) {
+      return false;
+    }
+  }
+  return std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
 class Delegate {
  public:
   explicit Delegate(const TfLiteGpuDelegateOptions_New* options) {
@@ -84,6 +171,7 @@ class Delegate {
       options_.egl_context = eglGetCurrentContext();
       options_.serialized_binary_cache_data = nullptr;
       options_.serialized_binary_cache_size = 0;
+      options_.serialization_dir = nullptr;
     }
   }
 
@@ -107,6 +195,21 @@ class Delegate {
     env_options.serialized_binary_cache = {
         options_.serialized_binary_cache_data,
         options_.serialized_binary_cache_size};
+    std::string cache_path;
+    std::vector<uint8_t> file_cache;
+    if (!options_.serialized_binary_cache_data &&
+        options_.serialization_dir) {
+      cache_path = absl::StrCat(
+          options_.serialization_dir, "/gpu_cl_",
+          absl::Hex(GetModelFingerprint(context, delegate_params,
+                                        options_.compile_options),
+                    absl::kZeroPad16),
+          ".jetbin");
+      // A missing or unreadable file only means compiling from scratch.
+      if (ReadCacheFile(cache_path, &file_cache)) {
+        env_options.serialized_binary_cache = file_cache;
+      }
+    }
     InferenceEnvironmentProperties properties;
     Status status =
         NewInferenceEnvironment(env_options, &environment_, &properties);
@@ -157,7 +260,20 @@ class Delegate {
                                                   GetObjectDef(tensor_index)));
     }
 
-    return builder->Build(&runner_);
+    RETURN_IF_ERROR(builder->Build(&runner_));
+
+    // Rewrite the cache file when this run compiled or tuned anything, e.g.
+    // on the first run or after a driver update.
+    if (!cache_path.empty()) {
+      std::vector<uint8_t> cache = environment_->GetSerializedBinaryCache();
+      if (!cache.empty() && cache != file_cache &&
+          !WriteCacheFile(cache_path, cache)) {
+        context->ReportError(context,
+                             "TfLiteGpuDelegate: failed to write cache to %s",
+                             cache_path.c_str());
+      }
+    }
+    return OkStatus();
   }
 
   Status SetInputsAndOutputs(TfLiteContext* context) {
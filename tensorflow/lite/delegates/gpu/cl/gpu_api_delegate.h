@@ -72,6 +72,16 @@ struct TFL_CAPI_EXPORT TfLiteGpuDelegateOptions_New {
   // incompatible when GPU driver is updated.
   const uint8_t* serialized_binary_cache_data;
   size_t serialized_binary_cache_size;
+
+  // [Optional]
+  // Directory in which the delegate keeps compiled OpenCL programs and tuned
+  // work group sizes across runs, so that only the first run pays for
+  // compiling and tuning. Each model and set of compile options gets its own
+  // file there, named after a fingerprint of the delegated graph, its weights
+  // and the options. A file built for another device or GPU driver is
+  // discarded and rewritten. Ignored when serialized_binary_cache_data is set.
+  // The directory must exist and be writable by the application.
+  const char* serialization_dir;
 };
 
 // Creates a new delegate instance that need to be destroyed with
@@ -81,7 +91,8 @@ struct TFL_CAPI_EXPORT TfLiteGpuDelegateOptions_New {
 //   .precision_loss_allowed = false,
 // }
 // .egl_display = eglGetCurrentDisplay(),
-// .egl_context = eglGetCurrentContext();
+// .egl_context = eglGetCurrentContext(),
+// .serialization_dir = nullptr;
 TFL_CAPI_EXPORT TfLiteDelegate* TfLiteGpuDelegateCreate_New(
     const TfLiteGpuDelegateOptions_New* options);
 
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/common/transformations/add_bias.h"
 #include "tensorflow/lite/delegates/gpu/common/transformations/merge_padding_with.h"
 #include "tensorflow/lite/delegates/gpu/common/types.h"
+#include <farmhash.h>
 
 namespace tflite {
 namespace gpu {
@@ -151,6 +152,7 @@ Status InferenceContext::InitFromGraph(const CreateInferenceInfo& create_info,
   TuningParameters tuning_parameters;
   tuning_parameters.queue = env->profiling_queue();
   tuning_parameters.info = env->device().GetInfoPtr();
+  tuning_parameters.cache = env->program_cache();
   if (create_info.hints.Check(ModelHints::kFastTuning)) {
     tuning_parameters.tuning_type = TuningType::FAST;
   }
@@ -347,8 +349,13 @@ Status InferenceContext::Compile(const CreationContext& creation_context) {
 }
 
 Status InferenceContext::Tune(const TuningParameters& tuning_parameters) {
-  for (auto& node : nodes_) {
-    RETURN_IF_ERROR(node.operations[0]->Tune(tuning_parameters));
+  TuningParameters node_tuning_parameters = tuning_parameters;
+  for (int i = 0; i < nodes_.size(); ++i) {
+    // Nodes come in the same order for the same graph, so their index and
+    // name tell their kernels apart in the tuning cache.
+    node_tuning_parameters.cache_key = tuning_parameters.cache_key + i +
+                                       ::util::Fingerprint64(nodes_[i].name);
+    RETURN_IF_ERROR(nodes_[i].operations[0]->Tune(node_tuning_parameters));
   }
   return OkStatus();
 }
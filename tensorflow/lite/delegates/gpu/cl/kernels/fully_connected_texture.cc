@@ -34,6 +34,7 @@ namespace {
 std::string GetFullyConnectedKernelCode(
     const TensorDescriptor& src_descriptor,
     const TensorDescriptor& dst_descriptor, CalculationsPrecision precision,
+    bool int8_weights,
     const std::vector<ElementwiseOperation*>& linked_operations,
     const int3& work_group_size) {
   TensorCodeGenerator src_tensor("src_data", "src_size", src_descriptor);
@@ -53,7 +54,12 @@ std::string GetFullyConnectedKernelCode(
 
   c += "__kernel void main_function(\n";
   c += src_tensor.GetDeclaration(AccessType::READ) + ",\n";
-  c += "    __read_only image2d_t filters,\n";
+  if (int8_weights) {
+    c += "    __global const char4* filters,\n";
+    c += "    __read_only image2d_t scales,\n";
+  } else {
+    c += "    __read_only image2d_t filters,\n";
+  }
   c += "    __read_only image2d_t biases";
   c += GetArgsDeclaration(linked_operations);
   c += dst_tensor.GetDeclaration(AccessType::WRITE) + ",\n";
@@ -67,10 +73,26 @@ std::string GetFullyConnectedKernelCode(
   c += "  uint c = tid.y;\n";       // vector coord for every thread
   c += "  uint c2 = tid.y * 2;\n";  // it should be * 4, so as we have FLT4
   // but we keep half8 in float4 so, we have * 2 y_coord for texture
+  if (int8_weights) {
+    // The threads past the last destination slice read the weights of the
+    // last one, so that they stay in bounds.
+    c += "  int f_gid = min(gid, dst_size.w - 1);\n";
+  }
   c += "  for (int i = 0; i < src_depth_x4; ++i, c += 4, c2 += 8) {\n";
   c += "    FLT4 v = " +
        src_tensor.Read3D("0", "0", "c", TextureAddressMode::DONT_CARE) + ";\n";
-  if (precision != CalculationsPrecision::F32) {
+  if (int8_weights) {
+    c += "   __global const char4* f = filters + (c * dst_size.w + f_gid) * "
+         "4;\n";
+    c += "   FLT4 m0 = TO_FLT4(convert_float4(f[0]));\n";
+    c += "   FLT4 m1 = TO_FLT4(convert_float4(f[1]));\n";
+    c += "   FLT4 m2 = TO_FLT4(convert_float4(f[2]));\n";
+    c += "   FLT4 m3 = TO_FLT4(convert_float4(f[3]));\n";
+    c += "   s.x += (v.x * m0.s0 + v.y * m0.s1 + v.z * m0.s2 + v.w * m0.s3);\n";
+    c += "   s.y += (v.x * m1.s0 + v.y * m1.s1 + v.z * m1.s2 + v.w * m1.s3);\n";
+    c += "   s.z += (v.x * m2.s0 + v.y * m2.s1 + v.z * m2.s2 + v.w * m2.s3);\n";
+    c += "   s.w += (v.x * m3.s0 + v.y * m3.s1 + v.z * m3.s2 + v.w * m3.s3);\n";
+  } else if (precision != CalculationsPrecision::F32) {
     c += "   half8 m0 = as_half8(read_imagef(filters, smp_none, (int2)(gid, "
          "c2+0)));\n";
     c += "   half8 m1 = as_half8(read_imagef(filters, smp_none, (int2)(gid, "
@@ -102,6 +124,11 @@ std::string GetFullyConnectedKernelCode(
   c += "    s += temp[tid.x][1];\n";
   c += "    s += temp[tid.x][2];\n";
   c += "    s += temp[tid.x][3];\n";
+  if (int8_weights) {
+    // The weights of each destination channel are scaled once, on the sum.
+    c += "    s *= TO_ACCUM_TYPE(READ_IMAGE(scales, smp_none, (int2)(gid, "
+         "0)));\n";
+  }
   c += "    FLT4 r0 = TO_FLT4(s) + READ_IMAGE(biases, smp_none, (int2)(gid, "
        "0));\n";
   c += "  " + dst_tensor.GetAddress("dst_adr", "0", "0", "gid") + "\n";
@@ -120,6 +147,9 @@ FullyConnectedTexture::FullyConnectedTexture(const OperationDef& definition)
 FullyConnectedTexture::FullyConnectedTexture(FullyConnectedTexture&& kernel)
     : GPUOperation(std::move(kernel)),
       weights_(std::move(kernel.weights_)),
+      int8_weights_(kernel.int8_weights_),
+      weights_int8_(std::move(kernel.weights_int8_)),
+      scales_(std::move(kernel.scales_)),
       biases_(std::move(kernel.biases_)),
       kernel_(std::move(kernel.kernel_)),
       work_group_size_(kernel.work_group_size_) {}
@@ -129,6 +159,9 @@ FullyConnectedTexture& FullyConnectedTexture::operator=(
   if (this != &kernel) {
     weights_ = std::move(kernel.weights_), biases_ = std::move(kernel.biases_),
     kernel_ = std::move(kernel.kernel_);
+    std::swap(int8_weights_, kernel.int8_weights_);
+    weights_int8_ = std::move(kernel.weights_int8_);
+    scales_ = std::move(kernel.scales_);
     std::swap(work_group_size_, kernel.work_group_size_);
     GPUOperation::operator=(std::move(kernel));
   }
@@ -144,7 +177,8 @@ Status FullyConnectedTexture::Compile(const CreationContext& creation_context) {
     wg_width /= 2;
     const auto code = GetFullyConnectedKernelCode(
         definition_.src_tensors[0], definition_.dst_tensors[0],
-        definition_.precision, linked_operations_, work_group_size_);
+        definition_.precision, int8_weights_, linked_operations_,
+        work_group_size_);
     RETURN_IF_ERROR(creation_context.cache->GetOrCreateCLKernel(
         code, "main_function", *creation_context.context,
         *creation_context.device, &kernel_));
@@ -157,7 +191,12 @@ Status FullyConnectedTexture::AddToQueue(CLCommandQueue* queue) {
   const int src_depth_x4 = IntegralDivideRoundUp(src_[0]->Depth(), 4);
   kernel_.ResetBindingCounter();
   RETURN_IF_ERROR(kernel_.SetMemoryAuto(src_[0]->GetMemoryPtr()));
-  RETURN_IF_ERROR(kernel_.SetMemoryAuto(weights_.GetMemoryPtr()));
+  if (int8_weights_) {
+    RETURN_IF_ERROR(kernel_.SetMemoryAuto(weights_int8_.GetMemoryPtr()));
+    RETURN_IF_ERROR(kernel_.SetMemoryAuto(scales_.GetMemoryPtr()));
+  } else {
+    RETURN_IF_ERROR(kernel_.SetMemoryAuto(weights_.GetMemoryPtr()));
+  }
   RETURN_IF_ERROR(kernel_.SetMemoryAuto(biases_.GetMemoryPtr()));
   RETURN_IF_ERROR(BindArgs(&kernel_, linked_operations_));
   RETURN_IF_ERROR(kernel_.SetMemoryAuto(dst_[0]->GetMemoryPtr()));
@@ -61,6 +61,39 @@ TEST_F(OpenCLOperationTest, FullyConnectedTexture) {
   }
 }
 
+// The weights are int8 values times a scale per output channel, so they are
+// stored as int8.
+TEST_F(OpenCLOperationTest, FullyConnectedTextureInt8Weights) {
+  TensorFloat32 src_tensor;
+  src_tensor.shape = BHWC(1, 1, 1, 4);
+  src_tensor.data = {0.0f, 1.0f, 2.0f, 3.0f};
+
+  FullyConnectedAttributes attr;
+  attr.weights.shape = OHWI(2, 1, 1, 4);
+  // {127, -64, 3, 0} * 0.5 and {1, 2, -127, 10} * 0.25.
+  attr.weights.data = {63.5f, -32.0f, 1.5f, 0.0f, 0.25f, 0.5f, -31.75f, 2.5f};
+  attr.bias.shape = Linear(2);
+  attr.bias.data = {0.5f, -0.5f};
+
+  for (auto storage : env_.GetSupportedStorages()) {
+    for (auto precision : env_.GetSupportedPrecisions()) {
+      const float eps = precision == CalculationsPrecision::F32 ? 1e-6f : 1e-3f;
+      OperationDef op_def;
+      op_def.precision = precision;
+      auto data_type = DeduceDataTypeFromPrecision(precision);
+      op_def.src_tensors.push_back({data_type, storage});
+      op_def.dst_tensors.push_back({data_type, storage});
+      TensorFloat32 dst_tensor;
+      FullyConnectedTexture operation;
+      ASSERT_OK(CreateFullyConnectedTexture(creation_context_, op_def, attr,
+                                            &operation));
+      ASSERT_OK(ExecuteGPUOperation(src_tensor, creation_context_, &operation,
+                                    BHWC(1, 1, 1, 2), &dst_tensor));
+      EXPECT_THAT(dst_tensor.data, Pointwise(FloatNear(eps), {-28.5f, -56.0f}));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace cl
 }  // namespace gpu
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_device.h"
+#include "tensorflow/lite/delegates/gpu/cl/program_cache.h"
 
 namespace tflite {
 namespace gpu {
@@ -29,6 +30,12 @@ struct TuningParameters {
   ProfilingCommandQueue* queue;
   const DeviceInfo* info;
   TuningType tuning_type = TuningType::EXHAUSTIVE;
+  // [Optional] When set, work group sizes are looked up in and added to the
+  // cache, under keys derived from `cache_key` and the grid, instead of being
+  // measured on every run. `cache_key` must tell apart the kernels tuned with
+  // the same cache.
+  ProgramCache* cache = nullptr;
+  uint64_t cache_key = 0;
 };
 
 }  // namespace cl
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/delegates/gpu/common/util.h"
+#include <farmhash.h>
 
 namespace tflite {
 namespace gpu {
@@ -218,6 +219,41 @@ void AddCornerCases(const int3& grid, int max_work_group_total_size,
   }
 }
 
+// Picks the fastest of `work_groups` by running the kernel with each of them,
+// unless the tuning cache already holds a pick for this launch.
+Status GetBestWorkGroupFromCandidates(const TuningParameters& params,
+                                      const CLKernel& kernel, const int3& grid,
+                                      const std::vector<int3>& work_groups,
+                                      int3* best_work_group) {
+  uint64_t key = 0;
+  if (params.cache) {
+    const int64_t launch[] = {static_cast<int64_t>(params.cache_key),
+                              grid.x,
+                              grid.y,
+                              grid.z,
+                              kernel.GetMaxWorkGroupSize()};
+    key = ::util::Fingerprint64(reinterpret_cast<const char*>(launch),
+                                sizeof(launch));
+    int3 cached;
+    // A stale entry, e.g. from a colliding key, is never used unless it is one
+    // of the sizes valid for this launch.
+    if (params.cache->FindWorkGroupSize(key, &cached) &&
+        std::find(work_groups.begin(), work_groups.end(), cached) !=
+            work_groups.end()) {
+      *best_work_group = cached;
+      return OkStatus();
+    }
+  }
+  int best_work_group_index;
+  RETURN_IF_ERROR(params.queue->GetBestWorkGroupIndex(
+      kernel, *params.info, grid, work_groups, &best_work_group_index));
+  *best_work_group = work_groups[best_work_group_index];
+  if (params.cache) {
+    params.cache->AddWorkGroupSize(key, *best_work_group);
+  }
+  return OkStatus();
+}
+
 Status GetBestWorkGroupAlignedToGrid(const TuningParameters& params,
                                      const CLKernel& kernel, const int3& grid,
                                      int3* best_work_group) {
@@ -225,17 +261,14 @@ Status GetBestWorkGroupAlignedToGrid(const TuningParameters& params,
   std::vector<int3> work_groups = GenerateWorkGroupSizes(
       grid, /*min_work_group_total_size = */ 32, kernel.GetMaxWorkGroupSize(),
       params.info->max_work_group_sizes, alignment, alignment, alignment);
-  int best_work_group_index;
   // If the grid parameter too small, method below cannot generate workgroups.
   if (work_groups.empty()) {
     AddCornerCases(grid, kernel.GetMaxWorkGroupSize(),
                    params.info->max_work_group_sizes, alignment, alignment,
                    alignment, &work_groups);
   }
-  RETURN_IF_ERROR(params.queue->GetBestWorkGroupIndex(
-      kernel, *params.info, grid, work_groups, &best_work_group_index));
-  *best_work_group = work_groups[best_work_group_index];
-  return OkStatus();
+  return GetBestWorkGroupFromCandidates(params, kernel, grid, work_groups,
+                                        best_work_group);
 }
 
 int GetPenalty(int grid_size, int group_size) {
@@ -357,11 +390,8 @@ Status GetBestWorkGroupXY128(const TuningParameters& params,
                              int3* best_work_group) {
   std::vector<int3> work_groups = GenerateWorkGroupSizesXY128(
       grid, kernel.GetMaxWorkGroupSize(), z_alignment);
-  int best_work_group_index;
-  RETURN_IF_ERROR(params.queue->GetBestWorkGroupIndex(
-      kernel, *params.info, grid, work_groups, &best_work_group_index));
-  *best_work_group = work_groups[best_work_group_index];
-  return OkStatus();
+  return GetBestWorkGroupFromCandidates(params, kernel, grid, work_groups,
+                                        best_work_group);
 }
 
 Status GetBestWorkGroupXY128Linear(const TuningParameters& params,
@@ -370,11 +400,8 @@ Status GetBestWorkGroupXY128Linear(const TuningParameters& params,
                                    int3* best_work_group) {
   std::vector<int3> work_groups = GenerateWorkGroupSizesXY128Linear(
       grid, kernel.GetMaxWorkGroupSize(), z_alignment);
-  int best_work_group_index;
-  RETURN_IF_ERROR(params.queue->GetBestWorkGroupIndex(
-      kernel, *params.info, grid, work_groups, &best_work_group_index));
-  *best_work_group = work_groups[best_work_group_index];
-  return OkStatus();
+  return GetBestWorkGroupFromCandidates(params, kernel, grid, work_groups,
+                                        best_work_group);
 }
 
 bool XY128RequiresMoreWorkGroupsThenXY128Linear(int width, int height) {
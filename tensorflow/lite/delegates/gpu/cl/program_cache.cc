@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/delegates/gpu/cl/program_cache.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 
@@ -44,14 +45,27 @@ ProgramCache::ProgramDescriptor::ProgramDescriptor(const std::string& code_text,
 ProgramCache::ProgramDescriptor::ProgramDescriptor(uint64_t fingerprints)
     : fingerprint(fingerprints), use_fingerprint(true) {}
 
+namespace {
+
+// Programs and work group sizes are only valid on the device and driver they
+// were built and tuned with.
+std::string GetDeviceDescription(const CLDevice& device) {
+  return GetDeviceInfo<std::string>(device.id(), CL_DEVICE_NAME) + " " +
+         GetDeviceInfo<std::string>(device.id(), CL_DRIVER_VERSION);
+}
+
+}  // namespace
+
 ProgramCache::ProgramCache(ProgramCache&& program_cache)
     : use_fingerprints_(program_cache.use_fingerprints_),
-      programs_(std::move(program_cache.programs_)) {}
+      programs_(std::move(program_cache.programs_)),
+      work_group_sizes_(std::move(program_cache.work_group_sizes_)) {}
 
 ProgramCache& ProgramCache::operator=(ProgramCache&& program_cache) {
   if (this != &program_cache) {
     use_fingerprints_ = program_cache.use_fingerprints_;
     programs_ = std::move(program_cache.programs_);
+    work_group_sizes_ = std::move(program_cache.work_group_sizes_);
   }
   return *this;
 }
@@ -100,6 +114,13 @@ Status ProgramCache::AddSerializedCache(
     return InvalidArgumentError(
         "OpenCL driver changed, cache invalid, should be regenerated");
   }
+  // Caches serialized before the device was recorded only check the platform.
+  if (model->device() &&
+      GetDeviceDescription(device) !=
+          std::string(model->device()->c_str(), model->device()->size())) {
+    return InvalidArgumentError(
+        "OpenCL device changed, cache invalid, should be regenerated");
+  }
 
   use_fingerprints_ = true;
 
@@ -116,27 +137,58 @@ Status ProgramCache::AddSerializedCache(
       programs_.insert(std::make_pair(std::move(desc), std::move(program)));
     }
   }
+  if (model->work_group_sizes()) {
+    for (auto work_group_size : *model->work_group_sizes()) {
+      work_group_sizes_.insert(std::make_pair(
+          work_group_size->key(),
+          int3(work_group_size->x(), work_group_size->y(),
+               work_group_size->z())));
+    }
+  }
   return OkStatus();
 }
 
 Status ProgramCache::GetSerializedCache(
     const CLDevice& device, std::vector<uint8_t>* serialized_cache) const {
   ::flatbuffers::FlatBufferBuilder builder;
-  std::vector<flatbuffers::Offset<data::Program>> serialized_programs;
+  // Programs are serialized in order of fingerprint, so that the same cache
+  // always serializes to the same bytes.
+  std::vector<const std::pair<const ProgramDescriptor, CLProgram>*>
+      sorted_programs;
   for (auto& program : programs_) {
+    sorted_programs.push_back(&program);
+  }
+  std::sort(sorted_programs.begin(), sorted_programs.end(),
+            [](const std::pair<const ProgramDescriptor, CLProgram>* a,
+               const std::pair<const ProgramDescriptor, CLProgram>* b) {
+              return a->first.fingerprint < b->first.fingerprint;
+            });
+  std::vector<flatbuffers::Offset<data::Program>> serialized_programs;
+  for (auto program : sorted_programs) {
     std::vector<uint8_t> binary;
-    RETURN_IF_ERROR(program.second.GetBinary(&binary));
+    RETURN_IF_ERROR(program->second.GetBinary(&binary));
     auto binary_offset = builder.CreateVector(binary);
     data::ProgramBuilder program_builder(builder);
-    program_builder.add_fingerprint(program.first.fingerprint);
+    program_builder.add_fingerprint(program->first.fingerprint);
     program_builder.add_binary(binary_offset);
     serialized_programs.push_back(program_builder.Finish());
   }
+  std::vector<flatbuffers::Offset<data::WorkGroupSize>>
+      serialized_work_group_sizes;
+  for (auto& work_group_size : work_group_sizes_) {
+    serialized_work_group_sizes.push_back(data::CreateWorkGroupSize(
+        builder, work_group_size.first, work_group_size.second.x,
+        work_group_size.second.y, work_group_size.second.z));
+  }
   auto driver_version = builder.CreateString(device.GetPlatformVersion());
+  auto device_s = builder.CreateString(GetDeviceDescription(device));
   auto programs_s = builder.CreateVector(serialized_programs);
+  auto work_group_sizes_s = builder.CreateVector(serialized_work_group_sizes);
   data::CompiledCacheBuilder cache_builder(builder);
   cache_builder.add_driver_version(driver_version);
   cache_builder.add_programs(programs_s);
+  cache_builder.add_device(device_s);
+  cache_builder.add_work_group_sizes(work_group_sizes_s);
   data::FinishCompiledCacheBuffer(builder, cache_builder.Finish());
   size_t next_element = serialized_cache->size();
   serialized_cache->resize(serialized_cache->size() + builder.GetSize());
@@ -145,6 +197,21 @@ Status ProgramCache::GetSerializedCache(
   return OkStatus();
 }
 
+bool ProgramCache::FindWorkGroupSize(uint64_t key,
+                                     int3* work_group_size) const {
+  auto it = work_group_sizes_.find(key);
+  if (it == work_group_sizes_.end()) {
+    return false;
+  }
+  *work_group_size = it->second;
+  return true;
+}
+
+void ProgramCache::AddWorkGroupSize(uint64_t key,
+                                    const int3& work_group_size) {
+  work_group_sizes_[key] = work_group_size;
+}
+
 }  // namespace cl
 }  // namespace gpu
 }  // namespace tflite
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_DELEGATES_GPU_CL_PROGRAM_CACHE_H_
 
 #include <cstdint>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/cl/cl_kernel.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_program.h"
 #include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/types.h"
 
 namespace tflite {
 namespace gpu {
@@ -56,6 +58,12 @@ class ProgramCache {
   Status GetSerializedCache(const CLDevice& device,
                             std::vector<uint8_t>* serialized_cache) const;
 
+  // Work group sizes picked by tuning, keyed by a fingerprint of the kernel
+  // launch they were tuned for. They are serialized along with the programs,
+  // so that a deserialized cache also skips tuning.
+  bool FindWorkGroupSize(uint64_t key, int3* work_group_size) const;
+  void AddWorkGroupSize(uint64_t key, const int3& work_group_size);
+
  private:
   struct ProgramDescriptor {
     ProgramDescriptor() = default;
@@ -95,6 +103,7 @@ class ProgramCache {
   std::unordered_map<ProgramDescriptor, CLProgram, ProgramDescriptorHasher,
                      ProgramDescriptorEqual>
       programs_;
+  std::map<uint64_t, int3> work_group_sizes_;
 };
 
 }  // namespace cl
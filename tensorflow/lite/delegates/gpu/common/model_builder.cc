@@ -90,6 +90,51 @@ void ConvertFloat16ToFloat32(size_t num_elements, const uint16_t* src,
   }
 }
 
+// Dequantizes an int8 tensor, which has a scale and zero point for the whole
+// tensor or for each index of its quantized dimension.
+Status DequantizeInt8(const TfLiteTensor& tensor, float* dst) {
+  const int8_t* src = tensor.data.int8;
+  const int num_elements = NumElements(&tensor);
+  const auto* params =
+      tensor.quantization.type == kTfLiteAffineQuantization
+          ? static_cast<const TfLiteAffineQuantization*>(
+                tensor.quantization.params)
+          : nullptr;
+  if (params == nullptr || params->scale == nullptr ||
+      params->scale->size == 1) {
+    const float scale =
+        params == nullptr || params->scale == nullptr
+            ? tensor.params.scale
+            : params->scale->data[0];
+    const int32_t zero_point =
+        params == nullptr || params->zero_point == nullptr
+            ? tensor.params.zero_point
+            : params->zero_point->data[0];
+    for (int i = 0; i < num_elements; ++i) {
+      dst[i] = (src[i] - zero_point) * scale;
+    }
+    return OkStatus();
+  }
+  const int axis = params->quantized_dimension;
+  if (axis < 0 || axis >= tensor.dims->size ||
+      tensor.dims->data[axis] != params->scale->size ||
+      params->zero_point == nullptr ||
+      params->zero_point->size != params->scale->size) {
+    return InvalidArgumentError("Invalid quantization of an int8 tensor");
+  }
+  int inner_size = 1;
+  for (int i = axis + 1; i < tensor.dims->size; ++i) {
+    inner_size *= tensor.dims->data[i];
+  }
+  const int num_channels = params->scale->size;
+  for (int i = 0; i < num_elements; ++i) {
+    const int channel = (i / inner_size) % num_channels;
+    dst[i] = (src[i] - params->zero_point->data[channel]) *
+             params->scale->data[channel];
+  }
+  return OkStatus();
+}
+
 template <>
 Status CreateVectorCopyData<float>(const TfLiteTensor& tensor,
                                    float* tensor_data) {
@@ -103,6 +148,10 @@ Status CreateVectorCopyData<float>(const TfLiteTensor& tensor,
           reinterpret_cast<uint16_t const*>(tensor.data.raw_const),
           tensor_data);
       break;
+    case kTfLiteInt8:
+      // Constant weights quantized to int8, e.g. by post-training
+      // quantization.
+      return DequantizeInt8(tensor, tensor_data);
     default:
       return InvalidArgumentError("Unsupported data type for float32 tensor");
   }
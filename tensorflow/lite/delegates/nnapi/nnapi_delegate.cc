@@ -3279,7 +3279,8 @@ using ::tflite::delegate::nnapi::NNAPIDelegateKernel;
 StatefulNnApiDelegate::StatefulNnApiDelegate(Options options)
     : TfLiteDelegate(TfLiteDelegateCreate()),
       delegate_data_(
-          Data{.execution_preference = options.execution_preference}) {
+          Data{.execution_preference = options.execution_preference,
+               .has_partition_plan = options.partition_plan != nullptr}) {
   if (options.accelerator_name) {
     delegate_data_.accelerator_name = options.accelerator_name;
   }
@@ -3289,6 +3290,9 @@ StatefulNnApiDelegate::StatefulNnApiDelegate(Options options)
   if (options.model_token) {
     delegate_data_.model_token = options.model_token;
   }
+  if (options.partition_plan) {
+    delegate_data_.partition_plan = *options.partition_plan;
+  }
   TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                        "Created TensorFlow Lite delegate for NNAPI.");
   Prepare = DoPrepare;
@@ -3315,6 +3319,9 @@ const StatefulNnApiDelegate::Options StatefulNnApiDelegate::GetOptions(
   options.model_token = delegate_data->model_token.empty()
                             ? nullptr
                             : delegate_data->model_token.c_str();
+  options.partition_plan = delegate_data->has_partition_plan
+                               ? &delegate_data->partition_plan
+                               : nullptr;
   return options;
 }
 
@@ -3421,9 +3428,32 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
   TfLiteIntArray* plan;
   TF_LITE_ENSURE_STATUS(context->GetExecutionPlan(context, &plan));
 
+  // Nodes that the partition plan keeps on the CPU. The plan refers to node
+  // indices of the original graph, so it is only applied to a graph of the
+  // same size.
+  std::vector<bool> cpu_nodes;
+  auto delegate_data = reinterpret_cast<Data*>(delegate->data_);
+  if (delegate_data->has_partition_plan) {
+    const NnApiPartitionPlan& partition_plan = delegate_data->partition_plan;
+    if (partition_plan.num_nodes == plan->size) {
+      cpu_nodes.resize(plan->size, false);
+      for (int node_index : partition_plan.cpu_nodes) {
+        cpu_nodes[node_index] = true;
+      }
+    } else {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                      "Ignoring NNAPI partition plan made for %d nodes in a "
+                      "graph of %d nodes.",
+                      partition_plan.num_nodes, plan->size);
+    }
+  }
+
   int android_sdk_version = NnApiImplementation()->android_sdk_version;
   // Check for every node if it is supported
   for (int node_index : TfLiteIntArrayView(plan)) {
+    if (!cpu_nodes.empty() && cpu_nodes[node_index]) {
+      continue;
+    }
     TfLiteNode* node;
     TfLiteRegistration* registration;
     TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/delegates/nnapi/nnapi_partition_plan.h"
 
 typedef struct ANeuralNetworksMemory ANeuralNetworksMemory;
 
@@ -63,6 +64,12 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // NOTE: when using compilation caching, it is not recommended to use the
     // same delegate instance for multiple models.
     const char* model_token = nullptr;
+
+    // Partition plan, typically produced by the benchmark tool's calibration
+    // mode, listing supported nodes that should nevertheless run on the CPU.
+    // Default to nullptr, which delegates every supported node. The plan is
+    // copied when the delegate is created.
+    const NnApiPartitionPlan* partition_plan = nullptr;
   };
 
   // Uses default options.
@@ -124,6 +131,10 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     std::string cache_dir;
     // The unique token string for NNAPI model.
     std::string model_token;
+    // Whether 'partition_plan' was provided.
+    bool has_partition_plan;
+    // Nodes to keep on the CPU.
+    NnApiPartitionPlan partition_plan;
     // Tensor to ANeuralNetworksMemory mapping.
     std::vector<MemoryRegistration> tensor_memory_map;
   };
@@ -0,0 +1,74 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/nnapi/nnapi_partition_plan.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+namespace tflite {
+namespace {
+
+// The plan is stored as
+//   num_nodes <N>
+//   cpu_nodes <count> <index>...
+constexpr char kNumNodesKey[] = "num_nodes";
+constexpr char kCpuNodesKey[] = "cpu_nodes";
+
+}  // namespace
+
+bool ReadNnApiPartitionPlan(const std::string& path, NnApiPartitionPlan* plan) {
+  std::ifstream file(path);
+  if (!file) return false;
+
+  std::string key;
+  int num_nodes = 0;
+  if (!(file >> key >> num_nodes) || key != kNumNodesKey || num_nodes < 0) {
+    return false;
+  }
+  int num_cpu_nodes = 0;
+  if (!(file >> key >> num_cpu_nodes) || key != kCpuNodesKey ||
+      num_cpu_nodes < 0 || num_cpu_nodes > num_nodes) {
+    return false;
+  }
+  std::vector<int> cpu_nodes(num_cpu_nodes);
+  for (int& node_index : cpu_nodes) {
+    if (!(file >> node_index) || node_index < 0 || node_index >= num_nodes) {
+      return false;
+    }
+  }
+  std::sort(cpu_nodes.begin(), cpu_nodes.end());
+  cpu_nodes.erase(std::unique(cpu_nodes.begin(), cpu_nodes.end()),
+                  cpu_nodes.end());
+
+  plan->num_nodes = num_nodes;
+  plan->cpu_nodes = std::move(cpu_nodes);
+  return true;
+}
+
+bool WriteNnApiPartitionPlan(const NnApiPartitionPlan& plan,
+                             const std::string& path) {
+  std::ofstream file(path);
+  if (!file) return false;
+  file << kNumNodesKey << " " << plan.num_nodes << "\n";
+  file << kCpuNodesKey << " " << plan.cpu_nodes.size();
+  for (int node_index : plan.cpu_nodes) {
+    file << " " << node_index;
+  }
+  file << "\n";
+  return static_cast<bool>(file);
+}
+
+}  // namespace tflite
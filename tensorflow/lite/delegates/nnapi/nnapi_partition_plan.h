@@ -0,0 +1,45 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_NNAPI_NNAPI_PARTITION_PLAN_H_
+#define TENSORFLOW_LITE_DELEGATES_NNAPI_NNAPI_PARTITION_PLAN_H_
+
+#include <string>
+#include <vector>
+
+namespace tflite {
+
+// Lists the nodes of a model that the NNAPI delegate should leave to the CPU
+// even though NNAPI supports them, typically because the partitions they
+// belong to were measured to run faster on the CPU on the target device.
+struct NnApiPartitionPlan {
+  // The number of nodes of the model the plan was made for. A plan is ignored
+  // when applied to a graph with a different number of nodes.
+  int num_nodes = 0;
+  // Indices of the nodes to keep on the CPU, in increasing order.
+  std::vector<int> cpu_nodes;
+};
+
+// Reads a plan written by WriteNnApiPartitionPlan() from 'path'. Returns false
+// if the file cannot be read or is malformed.
+bool ReadNnApiPartitionPlan(const std::string& path, NnApiPartitionPlan* plan);
+
+// Writes 'plan' to 'path' in a small text format. Returns false if the file
+// cannot be written.
+bool WriteNnApiPartitionPlan(const NnApiPartitionPlan& plan,
+                             const std::string& path);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_NNAPI_NNAPI_PARTITION_PLAN_H_
@@ -0,0 +1,90 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/nnapi/nnapi_partition_plan.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+std::string TempPath(const std::string& name) {
+  const char* dir = std::getenv("TEST_TMPDIR");
+  return std::string(dir ? dir : "/tmp") + "/" + name;
+}
+
+TEST(NnApiPartitionPlanTest, RoundTrip) {
+  const std::string path = TempPath("nnapi_partition_plan_round_trip");
+  NnApiPartitionPlan plan;
+  plan.num_nodes = 10;
+  plan.cpu_nodes = {2, 3, 7};
+  ASSERT_TRUE(WriteNnApiPartitionPlan(plan, path));
+
+  NnApiPartitionPlan read_plan;
+  ASSERT_TRUE(ReadNnApiPartitionPlan(path, &read_plan));
+  EXPECT_EQ(read_plan.num_nodes, 10);
+  EXPECT_THAT(read_plan.cpu_nodes, ElementsAre(2, 3, 7));
+}
+
+TEST(NnApiPartitionPlanTest, EmptyPlan) {
+  const std::string path = TempPath("nnapi_partition_plan_empty");
+  NnApiPartitionPlan plan;
+  plan.num_nodes = 4;
+  ASSERT_TRUE(WriteNnApiPartitionPlan(plan, path));
+
+  NnApiPartitionPlan read_plan;
+  ASSERT_TRUE(ReadNnApiPartitionPlan(path, &read_plan));
+  EXPECT_EQ(read_plan.num_nodes, 4);
+  EXPECT_THAT(read_plan.cpu_nodes, IsEmpty());
+}
+
+TEST(NnApiPartitionPlanTest, SortsAndDeduplicatesNodes) {
+  const std::string path = TempPath("nnapi_partition_plan_unsorted");
+  std::ofstream(path) << "num_nodes 6\ncpu_nodes 4 5 1 5 0\n";
+
+  NnApiPartitionPlan plan;
+  ASSERT_TRUE(ReadNnApiPartitionPlan(path, &plan));
+  EXPECT_THAT(plan.cpu_nodes, ElementsAre(0, 1, 5));
+}
+
+TEST(NnApiPartitionPlanTest, RejectsMalformedPlans) {
+  NnApiPartitionPlan plan;
+  EXPECT_FALSE(ReadNnApiPartitionPlan(TempPath("does_not_exist"), &plan));
+
+  const std::string path = TempPath("nnapi_partition_plan_malformed");
+  std::ofstream(path) << "num_nodes 3\ncpu_nodes 1 3\n";
+  EXPECT_FALSE(ReadNnApiPartitionPlan(path, &plan));
+
+  std::ofstream(path) << "nodes 3\ncpu_nodes 0\n";
+  EXPECT_FALSE(ReadNnApiPartitionPlan(path, &plan));
+
+  std::ofstream(path) << "num_nodes 3\ncpu_nodes 2 1\n";
+  EXPECT_FALSE(ReadNnApiPartitionPlan(path, &plan));
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
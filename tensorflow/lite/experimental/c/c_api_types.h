@@ -44,11 +44,12 @@ typedef enum { kTfLiteOk = 0, kTfLiteError = 1 } TfLiteStatus;
 // need. Access to the external contexts is controled by one of the
 // corresponding support files.
 typedef enum {
-  kTfLiteEigenContext = 0,       // include eigen_support.h to use.
-  kTfLiteGemmLowpContext = 1,    // include gemm_support.h to use.
-  kTfLiteEdgeTpuContext = 2,     // Placeholder for Edge TPU support.
-  kTfLiteCpuBackendContext = 3,  // include cpu_backend_support.h to use.
-  kTfLiteMaxExternalContexts = 4
+  kTfLiteEigenContext = 0,          // include eigen_support.h to use.
+  kTfLiteGemmLowpContext = 1,       // include gemm_support.h to use.
+  kTfLiteEdgeTpuContext = 2,        // Placeholder for Edge TPU support.
+  kTfLiteCpuBackendContext = 3,     // include cpu_backend_support.h to use.
+  kTfLiteSharedWeightsContext = 4,  // include shared_weights_cache.h to use.
+  kTfLiteMaxExternalContexts = 5
 } TfLiteExternalContextType;
 
 // Forward declare so dependent structs and methods can reference these types
@@ -280,14 +281,25 @@ typedef union {
 // Memory allocation strategies. kTfLiteMmapRo is for read-only memory-mapped
 // data (or data externally allocated). kTfLiteArenaRw is arena allocated
 // data. kTfLiteDynamic is for tensors that are allocated during evaluation.
+// kTfLiteCustom is for input and output tensors bound to a buffer owned by
+// the caller, see TfLiteCustomAllocation.
 typedef enum {
   kTfLiteMemNone = 0,
   kTfLiteMmapRo,
   kTfLiteArenaRw,
   kTfLiteArenaRwPersistent,
   kTfLiteDynamic,
+  kTfLiteCustom,
 } TfLiteAllocationType;
 
+// A buffer owned by the caller that backs a kTfLiteCustom tensor in place of
+// the arena. `data` must be aligned to 64 bytes and hold at least the
+// `bytes` of the tensor.
+typedef struct {
+  void* data;
+  size_t bytes;
+} TfLiteCustomAllocation;
+
 // The delegates should use zero or positive integers to represent handles.
 // -1 is reserved from unallocated status.
 typedef int TfLiteBufferHandle;
@@ -0,0 +1,180 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/micro/greedy_memory_planner.h"
+
+namespace tflite {
+
+constexpr int GreedyMemoryPlanner::kOnlinePlannedBuffer;
+
+GreedyMemoryPlanner::GreedyMemoryPlanner(uint8_t* scratch_buffer,
+                                         int scratch_buffer_size)
+    : max_buffer_count_(scratch_buffer_size / GetScratchBytesPerBuffer()),
+      buffer_count_(0),
+      need_to_calculate_offsets_(true),
+      first_entry_index_(-1),
+      next_free_entry_(0) {
+  uint8_t* next_free = scratch_buffer;
+  requirements_ = reinterpret_cast<BufferRequirements*>(next_free);
+  next_free += sizeof(BufferRequirements) * max_buffer_count_;
+  buffer_order_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  buffer_offsets_ = reinterpret_cast<int*>(next_free);
+  next_free += sizeof(int) * max_buffer_count_;
+  buffers_sorted_by_offset_ = reinterpret_cast<ListEntry*>(next_free);
+}
+
+int GreedyMemoryPlanner::GetScratchBytesPerBuffer() {
+  return sizeof(BufferRequirements) + sizeof(int) * 2 + sizeof(ListEntry);
+}
+
+TfLiteStatus GreedyMemoryPlanner::AddBuffer(ErrorReporter* error_reporter,
+                                            int size, int first_time_used,
+                                            int last_time_used,
+                                            int offline_offset) {
+  if (buffer_count_ >= max_buffer_count_) {
+    error_reporter->Report("Too many buffers to plan (max is %d)",
+                           max_buffer_count_);
+    return kTfLiteError;
+  }
+  if (size < 0 || first_time_used > last_time_used ||
+      (offline_offset < 0 && offline_offset != kOnlinePlannedBuffer)) {
+    error_reporter->Report("Invalid buffer of size %d used from %d to %d",
+                           size, first_time_used, last_time_used);
+    return kTfLiteError;
+  }
+  BufferRequirements* current = &requirements_[buffer_count_];
+  current->size = size;
+  current->first_time_used = first_time_used;
+  current->last_time_used = last_time_used;
+  current->offline_offset = offline_offset;
+  ++buffer_count_;
+  need_to_calculate_offsets_ = true;
+  return kTfLiteOk;
+}
+
+bool GreedyMemoryPlanner::DoBuffersOverlapInTime(int a, int b) const {
+  const BufferRequirements& first = requirements_[a];
+  const BufferRequirements& second = requirements_[b];
+  return first.first_time_used <= second.last_time_used &&
+         second.first_time_used <= first.last_time_used;
+}
+
+int GreedyMemoryPlanner::FindOffsetForBuffer(int requirements_index) const {
+  const int size = requirements_[requirements_index].size;
+  int candidate_offset = 0;
+  for (int entry_index = first_entry_index_; entry_index != -1;
+       entry_index = buffers_sorted_by_offset_[entry_index].next_entry_index) {
+    const ListEntry& entry = buffers_sorted_by_offset_[entry_index];
+    if (!DoBuffersOverlapInTime(requirements_index,
+                                entry.requirements_index)) {
+      continue;
+    }
+    // The entries are sorted by offset, so if the buffer fits before this
+    // one, it doesn't overlap any of the following ones either.
+    if (entry.offset >= candidate_offset + size) {
+      break;
+    }
+    const int entry_end =
+        entry.offset + requirements_[entry.requirements_index].size;
+    if (entry_end > candidate_offset) {
+      candidate_offset = entry_end;
+    }
+  }
+  return candidate_offset;
+}
+
+void GreedyMemoryPlanner::InsertInList(int requirements_index, int offset) {
+  const int new_entry_index = next_free_entry_++;
+  ListEntry* new_entry = &buffers_sorted_by_offset_[new_entry_index];
+  new_entry->offset = offset;
+  new_entry->requirements_index = requirements_index;
+  int* link = &first_entry_index_;
+  while (*link != -1 && buffers_sorted_by_offset_[*link].offset <= offset) {
+    link = &buffers_sorted_by_offset_[*link].next_entry_index;
+  }
+  new_entry->next_entry_index = *link;
+  *link = new_entry_index;
+}
+
+void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
+  if (!need_to_calculate_offsets_) {
+    return;
+  }
+  need_to_calculate_offsets_ = false;
+
+  // Buffers with an offline offset go first, then the others from the largest
+  // to the smallest: placing large buffers first leaves fewer gaps that are
+  // too small to be used. This is an insertion sort, which is stable and fine
+  // for the few hundred buffers of a typical model.
+  for (int i = 0; i < buffer_count_; ++i) {
+    const BufferRequirements& current = requirements_[i];
+    const bool current_is_offline =
+        current.offline_offset != kOnlinePlannedBuffer;
+    int j = i;
+    for (; j > 0; --j) {
+      const BufferRequirements& previous = requirements_[buffer_order_[j - 1]];
+      const bool previous_is_offline =
+          previous.offline_offset != kOnlinePlannedBuffer;
+      const bool goes_first =
+          (current_is_offline && !previous_is_offline) ||
+          (!current_is_offline && !previous_is_offline &&
+           current.size > previous.size);
+      if (!goes_first) {
+        break;
+      }
+      buffer_order_[j] = buffer_order_[j - 1];
+    }
+    buffer_order_[j] = i;
+  }
+
+  first_entry_index_ = -1;
+  next_free_entry_ = 0;
+  for (int i = 0; i < buffer_count_; ++i) {
+    const int buffer_index = buffer_order_[i];
+    const BufferRequirements& current = requirements_[buffer_index];
+    const int offset = current.offline_offset != kOnlinePlannedBuffer
+                           ? current.offline_offset
+                           : FindOffsetForBuffer(buffer_index);
+    buffer_offsets_[buffer_index] = offset;
+    InsertInList(buffer_index, offset);
+  }
+}
+
+int GreedyMemoryPlanner::GetMaximumMemorySize() {
+  CalculateOffsetsIfNeeded();
+  int max_size = 0;
+  for (int i = 0; i < buffer_count_; ++i) {
+    const int end = buffer_offsets_[i] + requirements_[i].size;
+    if (end > max_size) {
+      max_size = end;
+    }
+  }
+  return max_size;
+}
+
+TfLiteStatus GreedyMemoryPlanner::GetOffsetForBuffer(
+    ErrorReporter* error_reporter, int buffer_index, int* offset) {
+  if (buffer_index < 0 || buffer_index >= buffer_count_) {
+    error_reporter->Report("Buffer index %d is outside range 0 to %d",
+                           buffer_index, buffer_count_);
+    return kTfLiteError;
+  }
+  CalculateOffsetsIfNeeded();
+  *offset = buffer_offsets_[buffer_index];
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,123 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_MICRO_GREEDY_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_MICRO_GREEDY_MEMORY_PLANNER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+
+namespace tflite {
+
+// Plans where buffers go in a memory arena, given when each of them is first
+// and last used, so that buffers that are never live at the same time share
+// memory. This is the same approach as ArenaPlanner's, but fit for
+// microcontrollers: it doesn't allocate from the heap, keeping all of its
+// bookkeeping in a caller-provided scratch buffer, and doesn't use the STL.
+//
+// Buffers are placed from the largest to the smallest, each at the lowest
+// offset where it doesn't overlap any already placed buffer that is live at
+// the same time. Buffers may also be given a fixed offset, e.g. from a plan
+// computed offline, in which case they are placed first and the others are
+// placed around them.
+//
+// Typical usage:
+//
+//   GreedyMemoryPlanner planner(scratch, scratch_size);
+//   for each buffer:
+//     planner.AddBuffer(error_reporter, size, first_time_used, last_time_used);
+//   int arena_size = planner.GetMaximumMemorySize();
+//   for each buffer i:
+//     planner.GetOffsetForBuffer(error_reporter, i, &offset);
+class GreedyMemoryPlanner {
+ public:
+  // Special offset of AddBuffer, for buffers to be placed by the planner.
+  static constexpr int kOnlinePlannedBuffer = -1;
+
+  // `scratch_buffer` holds the planner's bookkeeping and must outlive it.
+  // Each buffer takes up GetScratchBytesPerBuffer() bytes of it.
+  GreedyMemoryPlanner(uint8_t* scratch_buffer, int scratch_buffer_size);
+
+  // Returns the scratch space needed per buffer.
+  static int GetScratchBytesPerBuffer();
+
+  // Adds a buffer of `size` bytes, live from the `first_time_used` to the
+  // `last_time_used` time steps included, typically operator indices. If
+  // `offline_offset` isn't kOnlinePlannedBuffer, the buffer is placed at
+  // that offset rather than by the planner. Buffer indices are assigned in
+  // the order of the calls, starting at 0.
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used,
+                         int offline_offset = kOnlinePlannedBuffer);
+
+  // Returns the size of the arena that the planned buffers need.
+  int GetMaximumMemorySize();
+
+  // Returns the number of buffers added so far.
+  int GetBufferCount() const { return buffer_count_; }
+
+  // Returns the offset of the given buffer in the arena.
+  TfLiteStatus GetOffsetForBuffer(ErrorReporter* error_reporter,
+                                  int buffer_index, int* offset);
+
+ private:
+  struct BufferRequirements {
+    int size;
+    int first_time_used;
+    int last_time_used;
+    int offline_offset;
+  };
+
+  // A buffer that has been placed, in a list of such buffers sorted by offset.
+  struct ListEntry {
+    int offset;
+    int requirements_index;
+    int next_entry_index;
+  };
+
+  // Computes the plan, if buffers were added since it was last computed.
+  void CalculateOffsetsIfNeeded();
+
+  // Places the given buffer at `offset` in the list sorted by offset.
+  void InsertInList(int requirements_index, int offset);
+
+  // Returns whether the given buffers are live at the same time.
+  bool DoBuffersOverlapInTime(int a, int b) const;
+
+  // Returns the lowest offset where the given buffer doesn't overlap, in time
+  // and in memory, any placed buffer.
+  int FindOffsetForBuffer(int requirements_index) const;
+
+  int max_buffer_count_;
+  int buffer_count_;
+  bool need_to_calculate_offsets_;
+
+  // The arrays below are carved out of the scratch buffer.
+  BufferRequirements* requirements_;
+  // Buffer indices, sorted by placement order.
+  int* buffer_order_;
+  // The planned offset of each buffer.
+  int* buffer_offsets_;
+  // The placed buffers, as a singly linked list sorted by offset.
+  ListEntry* buffers_sorted_by_offset_;
+  int first_entry_index_;
+  int next_free_entry_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_MICRO_GREEDY_MEMORY_PLANNER_H_
@@ -0,0 +1,127 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/micro/greedy_memory_planner.h"
+
+#include "tensorflow/lite/experimental/micro/testing/micro_test.h"
+
+namespace tflite {
+namespace {
+
+constexpr int kScratchBufferSize = 1024;
+// Aligned for the planner's bookkeeping.
+alignas(4) uint8_t scratch_buffer[kScratchBufferSize];
+
+}  // namespace
+}  // namespace tflite
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestReusesMemoryOfDisjointLifetimes) {
+  tflite::GreedyMemoryPlanner planner(tflite::scratch_buffer,
+                                      tflite::kScratchBufferSize);
+  // A chain of three tensors, each one only live with its neighbors.
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 100, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 50, 1, 2));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 100, 2, 3));
+  TF_LITE_MICRO_EXPECT_EQ(3, planner.GetBufferCount());
+  TF_LITE_MICRO_EXPECT_EQ(150, planner.GetMaximumMemorySize());
+
+  int offset;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 0, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(0, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 1, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(100, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 2, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(0, offset);
+}
+
+TF_LITE_MICRO_TEST(TestFillsGaps) {
+  tflite::GreedyMemoryPlanner planner(tflite::scratch_buffer,
+                                      tflite::kScratchBufferSize);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 10, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 20, 1, 2));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 30, 0, 3));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 10, 3, 4));
+  // Buffer 3 fits where buffers 0 and 1 were.
+  TF_LITE_MICRO_EXPECT_EQ(60, planner.GetMaximumMemorySize());
+
+  int offset;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 2, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(0, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 1, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(30, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 0, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(50, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 3, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(30, offset);
+}
+
+TF_LITE_MICRO_TEST(TestOfflineOffsets) {
+  tflite::GreedyMemoryPlanner planner(tflite::scratch_buffer,
+                                      tflite::kScratchBufferSize);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 16, 0, 2, 32));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 32, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 48, 1, 2));
+  TF_LITE_MICRO_EXPECT_EQ(96, planner.GetMaximumMemorySize());
+
+  int offset;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 0, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(32, offset);
+  // The online buffers go around the offline one.
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 2, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(48, offset);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(micro_test::reporter, 1, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(0, offset);
+}
+
+TF_LITE_MICRO_TEST(TestTooManyBuffers) {
+  const int scratch_size =
+      2 * tflite::GreedyMemoryPlanner::GetScratchBytesPerBuffer();
+  tflite::GreedyMemoryPlanner planner(tflite::scratch_buffer, scratch_size);
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 10, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.AddBuffer(micro_test::reporter, 10, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError, planner.AddBuffer(micro_test::reporter, 10, 0, 1));
+
+  int offset;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteError,
+      planner.GetOffsetForBuffer(micro_test::reporter, 2, &offset));
+}
+
+TF_LITE_MICRO_TESTS_END
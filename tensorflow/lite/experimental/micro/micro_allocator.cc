@@ -15,10 +15,28 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/micro/micro_allocator.h"
 
+#include <string.h>
+
 #include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/experimental/micro/greedy_memory_planner.h"
 
 namespace tflite {
 
+namespace {
+
+// The alignment of the planned tensors, enough for any tensor type.
+constexpr int kPlannedBufferAlignment = 16;
+
+// The name of the model metadata holding an offline memory plan.
+constexpr char kOfflineMemoryAllocationMetadata[] = "OfflineMemoryAllocation";
+
+int AlignSizeUp(int size) {
+  return ((size + kPlannedBufferAlignment - 1) / kPlannedBufferAlignment) *
+         kPlannedBufferAlignment;
+}
+
+}  // namespace
+
 MicroAllocator::MicroAllocator(TfLiteContext* context, const Model* model,
                                uint8_t* tensor_arena, size_t arena_size,
                                ErrorReporter* error_reporter)
@@ -69,74 +87,200 @@ TfLiteStatus MicroAllocator::RegisterPreallocatedInput(uint8_t* buffer,
 TfLiteStatus MicroAllocator::AllocateTensors() {
   const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers =
       model_->buffers();
+  const int tensor_count = tensors_->size();
+  const int operator_count = operators_->size();
 
-  int* first_created = reinterpret_cast<int*>(tensor_allocator_.AllocateMemory(
-      sizeof(int) * tensors_->size(), sizeof(int)));
-  int* last_used = reinterpret_cast<int*>(tensor_allocator_.AllocateMemory(
-      sizeof(int) * tensors_->size(), sizeof(int)));
-  for (size_t i = 0; i < tensors_->size(); ++i) {
-    first_created[i] = -1;
-    last_used[i] = -1;
-  }
+  const int32_t* offline_offsets;
+  TF_LITE_ENSURE_STATUS(GetOfflinePlannedOffsets(&offline_offsets));
 
-  // It is necessary to specify that model inputs have been allocated to avoid
-  // re-allocating later.  Since inputs are not created by a particular node, we
-  // make up an index which does not overlap with any node.
-  const int kInputIndex = subgraph_->inputs()->size();
-  for (size_t i = 0; i < subgraph_->inputs()->size(); ++i) {
-    const int tensor_index = subgraph_->inputs()->Get(i);
-    const auto* tensor = tensors_->Get(tensor_index);
-    // Check for and skip pre-allocated inputs.
-    if (context_->tensors[tensor_index].data.raw == nullptr) {
-      const TfLiteStatus status = tensor_allocator_.AllocateTensor(
-          *tensor, 0, operators_->size(), buffers, error_reporter_,
-          &context_->tensors[tensor_index]);
-      TF_LITE_ENSURE_OK(context_, status);
+  // Fill in all the tensors but the pre-allocated inputs. Variable tensors
+  // keep their values across invocations, so they get memory of their own.
+  // Other tensors without constant data are placed by the memory planner
+  // below.
+  for (int i = 0; i < tensor_count; ++i) {
+    TfLiteTensor* tensor = &context_->tensors[i];
+    if (IsPreallocatedInput(i)) {
+      continue;
+    }
+    const auto* flatbuffer_tensor = tensors_->Get(i);
+    if (flatbuffer_tensor->is_variable()) {
+      TF_LITE_ENSURE_STATUS(tensor_allocator_.AllocateTensor(
+          *flatbuffer_tensor, 0, operator_count, buffers, error_reporter_,
+          tensor));
+    } else {
+      TF_LITE_ENSURE_STATUS(tensor_allocator_.InitializeTensor(
+          *flatbuffer_tensor, buffers, error_reporter_, tensor));
     }
-    first_created[tensor_index] = kInputIndex;
   }
 
-  for (int i = (operators_->size() - 1); i >= 0; --i) {
+  // The planned tensors go right after the allocations above, where the
+  // temporary allocations needed to plan them are made in the meantime.
+  uint8_t* planned_arena =
+      tensor_allocator_.AllocateMemory(0, kPlannedBufferAlignment);
+  int* first_used = reinterpret_cast<int*>(
+      tensor_allocator_.AllocateTempMemory(sizeof(int) * tensor_count,
+                                           sizeof(int)));
+  int* last_used = reinterpret_cast<int*>(
+      tensor_allocator_.AllocateTempMemory(sizeof(int) * tensor_count,
+                                           sizeof(int)));
+  if (planned_arena == nullptr || first_used == nullptr ||
+      last_used == nullptr) {
+    error_reporter_->Report("Arena too small to plan the tensors");
+    return kTfLiteError;
+  }
+
+  // Find the lifetime of each tensor, in operator indices. The model inputs
+  // and outputs stay live during the whole invocation, so that they can be
+  // read after it.
+  for (int i = 0; i < tensor_count; ++i) {
+    first_used[i] = -1;
+    last_used[i] = -1;
+  }
+  for (int i = 0; i < operator_count; ++i) {
     const auto* op = operators_->Get(i);
     for (size_t n = 0; n < op->inputs()->size(); ++n) {
       const int tensor_index = op->inputs()->Get(n);
-      if ((last_used[tensor_index] == -1) || (last_used[tensor_index] < i)) {
-        last_used[tensor_index] = i;
+      if (tensor_index < 0) {
+        continue;  // Optional input.
       }
+      if (first_used[tensor_index] == -1) {
+        // Read without having been written by an earlier operator.
+        first_used[tensor_index] = 0;
+      }
+      last_used[tensor_index] = i;
     }
     for (size_t n = 0; n < op->outputs()->size(); ++n) {
       const int tensor_index = op->outputs()->Get(n);
-      const int create_before = i;
-      int destroy_after = last_used[tensor_index];
-      if (destroy_after == -1) {
-        destroy_after = operators_->size();
+      if (first_used[tensor_index] == -1) {
+        first_used[tensor_index] = i;
       }
-      const auto* tensor = tensors_->Get(tensor_index);
-      if (!tensor->is_variable()) {
-        const TfLiteStatus status = tensor_allocator_.AllocateTensor(
-            *tensor, create_before, destroy_after, buffers, error_reporter_,
-            &context_->tensors[tensor_index]);
-        if (status != kTfLiteOk) {
-          return status;
-        }
-        first_created[tensor_index] = i;
+      if (last_used[tensor_index] < i) {
+        last_used[tensor_index] = i;
       }
     }
   }
+  for (size_t n = 0; n < subgraph_->inputs()->size(); ++n) {
+    const int tensor_index = subgraph_->inputs()->Get(n);
+    first_used[tensor_index] = 0;
+    last_used[tensor_index] = operator_count;
+  }
+  for (size_t n = 0; n < subgraph_->outputs()->size(); ++n) {
+    const int tensor_index = subgraph_->outputs()->Get(n);
+    first_used[tensor_index] = 0;
+    last_used[tensor_index] = operator_count;
+  }
 
-  for (size_t i = 0; i < tensors_->size(); ++i) {
-    const auto* tensor = tensors_->Get(i);
-    const bool is_read_only = (first_created[i] == -1) && (last_used[i] != -1);
-    if (tensor->is_variable() || is_read_only) {
-      const TfLiteStatus status = tensor_allocator_.AllocateTensor(
-          *tensor, 0, operators_->size(), buffers, error_reporter_,
-          &context_->tensors[i]);
-      if (status != kTfLiteOk) {
-        return status;
-      }
+  int planned_count = 0;
+  for (int i = 0; i < tensor_count; ++i) {
+    if (NeedsPlanning(i, first_used)) {
+      ++planned_count;
     }
   }
+  const int scratch_size =
+      planned_count * GreedyMemoryPlanner::GetScratchBytesPerBuffer();
+  uint8_t* scratch =
+      tensor_allocator_.AllocateTempMemory(scratch_size, sizeof(int));
+  if (scratch == nullptr) {
+    error_reporter_->Report("Arena too small to plan %d tensors",
+                            planned_count);
+    return kTfLiteError;
+  }
+  GreedyMemoryPlanner planner(scratch, scratch_size);
+  for (int i = 0; i < tensor_count; ++i) {
+    if (!NeedsPlanning(i, first_used)) {
+      continue;
+    }
+    const int size = AlignSizeUp(context_->tensors[i].bytes);
+    const int offline_offset =
+        offline_offsets ? flatbuffers::EndianScalar(offline_offsets[i])
+                        : GreedyMemoryPlanner::kOnlinePlannedBuffer;
+    TF_LITE_ENSURE_STATUS(planner.AddBuffer(error_reporter_, size,
+                                            first_used[i], last_used[i],
+                                            offline_offset));
+  }
+  const int planned_size = planner.GetMaximumMemorySize();
+  int buffer_index = 0;
+  for (int i = 0; i < tensor_count; ++i) {
+    if (!NeedsPlanning(i, first_used)) {
+      continue;
+    }
+    int offset;
+    TF_LITE_ENSURE_STATUS(
+        planner.GetOffsetForBuffer(error_reporter_, buffer_index++, &offset));
+    context_->tensors[i].data.raw =
+        reinterpret_cast<char*>(planned_arena + offset);
+  }
 
+  // Now that the planning is done, the planned tensors take the place of the
+  // temporary allocations.
+  tensor_allocator_.ResetTempAllocations();
+  if (tensor_allocator_.AllocateMemory(planned_size, 1) != planned_arena) {
+    error_reporter_->Report(
+        "Arena too small for the planned tensors, which need %d bytes",
+        planned_size);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+bool MicroAllocator::IsPreallocatedInput(int tensor_index) const {
+  for (size_t i = 0; i < subgraph_->inputs()->size(); ++i) {
+    if (subgraph_->inputs()->Get(i) == tensor_index) {
+      return context_->tensors[tensor_index].data.raw != nullptr;
+    }
+  }
+  return false;
+}
+
+bool MicroAllocator::NeedsPlanning(int tensor_index,
+                                   const int* first_used) const {
+  // Pre-allocated inputs, variable tensors and tensors with constant data
+  // already have data by now.
+  const TfLiteTensor& tensor = context_->tensors[tensor_index];
+  return first_used[tensor_index] != -1 && tensor.data.raw == nullptr;
+}
+
+TfLiteStatus MicroAllocator::GetOfflinePlannedOffsets(
+    const int32_t** offline_offsets) {
+  *offline_offsets = nullptr;
+  const auto* metadata = model_->metadata();
+  if (metadata == nullptr) {
+    return kTfLiteOk;
+  }
+  for (size_t i = 0; i < metadata->size(); ++i) {
+    const auto* entry = metadata->Get(i);
+    if (entry->name() == nullptr ||
+        strcmp(entry->name()->c_str(), kOfflineMemoryAllocationMetadata) !=
+            0) {
+      continue;
+    }
+    const auto* buffer = model_->buffers()->Get(entry->buffer());
+    const int kHeaderSize = 3;
+    if (buffer == nullptr || buffer->data() == nullptr ||
+        buffer->data()->size() < kHeaderSize * sizeof(int32_t)) {
+      error_reporter_->Report("Invalid offline memory plan");
+      return kTfLiteError;
+    }
+    // The buffer data is 16-byte aligned, see the schema.
+    const int32_t* values =
+        reinterpret_cast<const int32_t*>(buffer->data()->data());
+    const int version = flatbuffers::EndianScalar(values[0]);
+    const int subgraph_index = flatbuffers::EndianScalar(values[1]);
+    const int offset_count = flatbuffers::EndianScalar(values[2]);
+    if (version != 1 || subgraph_index != 0 ||
+        offset_count != static_cast<int>(tensors_->size()) ||
+        buffer->data()->size() !=
+            (kHeaderSize + offset_count) * sizeof(int32_t)) {
+      error_reporter_->Report(
+          "Unsupported offline memory plan: version %d, subgraph %d, %d "
+          "offsets for %d tensors",
+          version, subgraph_index, offset_count,
+          static_cast<int>(tensors_->size()));
+      return kTfLiteError;
+    }
+    *offline_offsets = values + kHeaderSize;
+    return kTfLiteOk;
+  }
   return kTfLiteOk;
 }
 
@@ -47,9 +47,29 @@ class MicroAllocator {
   // Run through the model and allocate all necessary input, output and
   // intermediate tensors except for those already provided via calls to
   // registerPreallocatedInput.
+  //
+  // Tensors whose lifetimes don't overlap share memory, as planned by
+  // GreedyMemoryPlanner. The model inputs and outputs are kept live during the
+  // whole invocation. A plan computed offline can be provided instead, in the
+  // model metadata named "OfflineMemoryAllocation": its buffer holds int32
+  // values [version (1), subgraph index (0), number of tensors, followed by
+  // an offset for each tensor of the subgraph], the offsets being relative to
+  // the start of the planned tensors and multiples of 16. Tensors with an
+  // offset of -1 are planned at runtime, around the offline-planned ones.
   TfLiteStatus AllocateTensors();
 
  private:
+  // Returns whether the tensor is a model input registered with
+  // RegisterPreallocatedInput.
+  bool IsPreallocatedInput(int tensor_index) const;
+
+  // Returns whether the tensor is to be placed by the memory planner.
+  bool NeedsPlanning(int tensor_index, const int* first_used) const;
+
+  // Returns the offline memory plan from the model metadata, if any, as an
+  // offset per tensor, or null.
+  TfLiteStatus GetOfflinePlannedOffsets(const int32_t** offline_offsets);
+
   const Model* model_;
   SimpleTensorAllocator tensor_allocator_;
   ErrorReporter* error_reporter_;
@@ -80,6 +80,33 @@ TfLiteStatus SimpleTensorAllocator::AllocateTensor(
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
     ErrorReporter* error_reporter, TfLiteTensor* result,
     uint8_t* preallocated_buffer) {
+  TF_LITE_ENSURE_STATUS(
+      InitializeTensor(flatbuffer_tensor, buffers, error_reporter, result));
+  if (result->allocation_type == kTfLiteArenaRw) {
+    if (preallocated_buffer != nullptr) {
+      result->data.raw = reinterpret_cast<char*>(preallocated_buffer);
+    } else {
+      size_t type_size;
+      TF_LITE_ENSURE_STATUS(
+          TfLiteTypeSizeOf(result->type, &type_size, error_reporter));
+      result->data.raw =
+          reinterpret_cast<char*>(AllocateMemory(result->bytes, type_size));
+    }
+    if (result->data.raw == nullptr) {
+      error_reporter->Report(
+          "Couldn't allocate memory for tensor '%s', wanted %d bytes but only "
+          "%d were available",
+          result->name, result->bytes, (data_size_max_ - data_size_));
+      return kTfLiteError;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus SimpleTensorAllocator::InitializeTensor(
+    const tflite::Tensor& flatbuffer_tensor,
+    const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
+    ErrorReporter* error_reporter, TfLiteTensor* result) {
   TF_LITE_ENSURE_STATUS(ConvertTensorType(flatbuffer_tensor.type(),
                                           &result->type, error_reporter));
   result->is_variable = flatbuffer_tensor.is_variable();
@@ -109,23 +136,6 @@ TfLiteStatus SimpleTensorAllocator::AllocateTensor(
     TF_LITE_ENSURE_STATUS(BytesRequired(flatbuffer_tensor, data_size,
                                         &result->bytes, &type_size,
                                         error_reporter));
-    if (preallocated_buffer != nullptr) {
-      result->data.raw = reinterpret_cast<char*>(preallocated_buffer);
-    } else {
-      result->data.raw =
-          reinterpret_cast<char*>(AllocateMemory(result->bytes, type_size));
-    }
-    if (result->data.raw == nullptr) {
-      const char* tensor_name = flatbuffer_tensor.name()->c_str();
-      if (tensor_name == nullptr) {
-        tensor_name = "<None>";
-      }
-      error_reporter->Report(
-          "Couldn't allocate memory for tensor '%s', wanted %d bytes but only "
-          "%d were available",
-          tensor_name, result->bytes, (data_size_max_ - data_size_));
-      return kTfLiteError;
-    }
     result->allocation_type = kTfLiteArenaRw;
   }
   result->dims = reinterpret_cast<TfLiteIntArray*>(AllocateMemory(
@@ -173,4 +183,19 @@ uint8_t* SimpleTensorAllocator::AllocateMemory(size_t size, size_t alignment) {
   return aligned_result;
 }
 
+uint8_t* SimpleTensorAllocator::AllocateTempMemory(size_t size,
+                                                   size_t alignment) {
+  uint8_t* current_data = data_ + data_size_ + temp_data_size_;
+  uint8_t* aligned_result = AlignPointerRoundUp(current_data, alignment);
+  uint8_t* next_free = aligned_result + size;
+  size_t aligned_size = (next_free - current_data);
+  if ((data_size_ + temp_data_size_ + aligned_size) > data_size_max_) {
+    return nullptr;
+  }
+  temp_data_size_ += aligned_size;
+  return aligned_result;
+}
+
+void SimpleTensorAllocator::ResetTempAllocations() { temp_data_size_ = 0; }
+
 }  // namespace tflite
@@ -22,13 +22,16 @@ limitations under the License.
 
 namespace tflite {
 
-// TODO(petewarden): This allocator never frees up or reuses  any memory, even
-// though we have enough information about lifetimes of the tensors to do so.
-// This makes it pretty wasteful, so we should use a more intelligent method.
+// Allocates memory linearly from an arena, never freeing it. Reusing the
+// memory of tensors with disjoint lifetimes is left to a planner, see
+// GreedyMemoryPlanner and MicroAllocator.
 class SimpleTensorAllocator {
  public:
   SimpleTensorAllocator(uint8_t* buffer, size_t buffer_size)
-      : data_size_(0), data_size_max_(buffer_size), data_(buffer) {}
+      : data_size_(0),
+        temp_data_size_(0),
+        data_size_max_(buffer_size),
+        data_(buffer) {}
 
   TfLiteStatus AllocateTensor(
       const tflite::Tensor& flatbuffer_tensor, int create_before,
@@ -37,12 +40,27 @@ class SimpleTensorAllocator {
       ErrorReporter* error_reporter, TfLiteTensor* result,
       uint8_t* preallocated_memory = nullptr);
 
+  // Fills in `result` like AllocateTensor, except that a tensor without
+  // constant data is left with a null data pointer, for the caller to place
+  // it, e.g. as planned by GreedyMemoryPlanner.
+  TfLiteStatus InitializeTensor(
+      const tflite::Tensor& flatbuffer_tensor,
+      const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
+      ErrorReporter* error_reporter, TfLiteTensor* result);
+
   uint8_t* AllocateMemory(size_t size, size_t alignment);
 
+  // Temporary allocations are made past the ones of AllocateMemory, and are
+  // all released at once by ResetTempAllocations. AllocateMemory must not be
+  // called while there are temporary allocations, as it would overwrite them.
+  uint8_t* AllocateTempMemory(size_t size, size_t alignment);
+  void ResetTempAllocations();
+
   int GetDataSize() const { return data_size_; }
 
  private:
   int data_size_;
+  int temp_data_size_;
   size_t data_size_max_;
   uint8_t* data_;
 };
@@ -90,7 +90,8 @@ int floor_log2_quotient(int num, int denom) {
 
 void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
                   int kernel_cols, int lhs_scalar_size, int rhs_scalar_size,
-                  int cache_friendly_traversal_threshold, BlockMap* block_map) {
+                  int cache_friendly_traversal_threshold, int min_num_blocks,
+                  BlockMap* block_map) {
   gemmlowp::ScopedProfilingLabel label("MakeBlockMap");
   RUY_DCHECK_GE(rows, kernel_rows);
   RUY_DCHECK_GE(cols, kernel_cols);
@@ -170,6 +171,15 @@ void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
   l1_size_log2 = std::min(
       l1_size_log2, 15 - depth_ceil_log2 -
                         ceil_log2(std::max(lhs_scalar_size, rhs_scalar_size)));
+  // Make the blocks smaller if needed to have at least min_num_blocks of them.
+  // The number of blocks is 2^(2 * num_blocks_base_log2 + rectangularness).
+  const int min_num_blocks_log2 = ceil_log2(std::max(min_num_blocks, 1));
+  const int min_num_blocks_base_log2 =
+      std::max(0, min_num_blocks_log2 - rows_rectangularness_log2 -
+                      cols_rectangularness_log2 + 1) /
+      2;
+  l1_size_log2 =
+      std::min(l1_size_log2, size_floor_log2 - min_num_blocks_base_log2);
   l1_size_log2 = std::max(l1_size_log2, kernel_width_log2);
   l1_size_log2 = std::min(l1_size_log2, size_floor_log2);
 
@@ -102,9 +102,17 @@ struct BlockMap {
 
 // Create a BlockMap suitable for tiling the destination matrix in a
 // matrix multiplication with the given parameters.
+//
+// The blocks are made smaller than cache-friendliness alone would call for,
+// down to the kernel block size, if that is needed to make at least
+// `min_num_blocks` of them. Threads pick the next block to work on as they
+// finish their current one, so threads running on faster cores work on
+// proportionally more blocks, as long as there are enough blocks: see
+// GetMinNumBlocks in trmul.cc, which uses this on heterogeneous cores.
 void MakeBlockMap(int rows, int cols, int depth, int kernel_rows,
                   int kernel_cols, int lhs_scalar_size, int rhs_scalar_size,
-                  int cache_friendly_traversal_threshold, BlockMap* block_map);
+                  int cache_friendly_traversal_threshold, int min_num_blocks,
+                  BlockMap* block_map);
 
 // Maps an integer index to a block position in the grid.
 void GetBlockByIndex(const BlockMap& block_map, int index,
@@ -0,0 +1,71 @@
+/* Copyright 2020 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/ruy/block_map.h"
+
+#include <gtest/gtest.h>
+
+namespace ruy {
+namespace {
+
+void MakeTestBlockMap(int size, int min_num_blocks, BlockMap* block_map) {
+  MakeBlockMap(size, size, size, 8, 8, 1, 1,
+               /*cache_friendly_traversal_threshold=*/0, min_num_blocks,
+               block_map);
+}
+
+void CheckBlocksCoverDims(const BlockMap& block_map) {
+  for (Side side : {Side::kLhs, Side::kRhs}) {
+    int expected_start = 0;
+    for (int block = 0; block < NumBlocksPerSide(side, block_map); block++) {
+      int start, end;
+      GetBlockMatrixCoords(side, block_map, block, &start, &end);
+      EXPECT_EQ(start, expected_start);
+      expected_start = end;
+    }
+    EXPECT_EQ(expected_start, block_map.dims[side]);
+  }
+}
+
+TEST(BlockMapTest, MinNumBlocks) {
+  BlockMap default_block_map;
+  MakeTestBlockMap(256, 1, &default_block_map);
+  CheckBlocksCoverDims(default_block_map);
+  const int default_num_blocks = NumBlocks(default_block_map);
+
+  for (int min_num_blocks : {default_num_blocks + 1, 3 * default_num_blocks,
+                             16 * default_num_blocks}) {
+    BlockMap block_map;
+    MakeTestBlockMap(256, min_num_blocks, &block_map);
+    CheckBlocksCoverDims(block_map);
+    EXPECT_GE(NumBlocks(block_map), min_num_blocks);
+  }
+}
+
+TEST(BlockMapTest, MinNumBlocksIsBoundedByKernelSize) {
+  BlockMap block_map;
+  MakeTestBlockMap(64, 1000, &block_map);
+  CheckBlocksCoverDims(block_map);
+  // Blocks can't get smaller than 8x8 kernel blocks.
+  EXPECT_EQ(NumBlocks(block_map), 64);
+}
+
+}  // namespace
+}  // namespace ruy
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
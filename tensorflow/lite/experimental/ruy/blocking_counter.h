@@ -20,6 +20,8 @@ limitations under the License.
 #include <condition_variable>  // NOLINT(build/c++11)
 #include <mutex>               // NOLINT(build/c++11)
 
+#include "tensorflow/lite/experimental/ruy/time.h"
+
 namespace ruy {
 
 // A BlockingCounter lets one thread to wait for N events to occur.
@@ -45,8 +47,9 @@ class BlockingCounter {
   bool DecrementCount();
 
   // Waits for the N other threads (N having been set by Reset())
-  // to hit the BlockingCounter.
-  void Wait();
+  // to hit the BlockingCounter, spin-waiting for up to `spin_duration`
+  // before waiting passively. See WaitUntil.
+  void Wait(const Duration& spin_duration);
 
  private:
   std::atomic<int> count_;
@@ -17,6 +17,9 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/ruy/check_macros.h"
 #include "tensorflow/lite/experimental/ruy/detect_dotprod.h"
+#include "tensorflow/lite/experimental/ruy/detect_x86.h"
+#include "tensorflow/lite/experimental/ruy/have_built_path_for.h"
+#include "tensorflow/lite/experimental/ruy/platform.h"
 
 namespace ruy {
 
@@ -46,6 +49,27 @@ Path Context::GetRuntimeEnabledPaths() {
       RUY_DCHECK((runtime_enabled_paths_ & Path::kNeonDotprod) == Path::kNone);
     }
   }
+#elif RUY_PLATFORM(X86_ENHANCEMENTS)
+  // Disable the paths that weren't compiled in, or that the CPU doesn't
+  // support.
+  if ((runtime_enabled_paths_ & Path::kAvx2) != Path::kNone) {
+    if (!(HaveBuiltPathForAvx2() && DetectCpuAvx2())) {
+      runtime_enabled_paths_ = runtime_enabled_paths_ ^ Path::kAvx2;
+      RUY_DCHECK((runtime_enabled_paths_ & Path::kAvx2) == Path::kNone);
+    }
+  }
+  if ((runtime_enabled_paths_ & Path::kAvx512) != Path::kNone) {
+    if (!(HaveBuiltPathForAvx512() && DetectCpuAvx512())) {
+      runtime_enabled_paths_ = runtime_enabled_paths_ ^ Path::kAvx512;
+      RUY_DCHECK((runtime_enabled_paths_ & Path::kAvx512) == Path::kNone);
+    }
+  }
+  if ((runtime_enabled_paths_ & Path::kAvxVnni) != Path::kNone) {
+    if (!(HaveBuiltPathForAvxVnni() && DetectCpuAvxVnni())) {
+      runtime_enabled_paths_ = runtime_enabled_paths_ ^ Path::kAvxVnni;
+      RUY_DCHECK((runtime_enabled_paths_ & Path::kAvxVnni) == Path::kNone);
+    }
+  }
 #endif
 
   // Sanity check. We can't possibly have disabled all paths, as some paths
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/ruy/allocator.h"
 #include "tensorflow/lite/experimental/ruy/path.h"
+#include "tensorflow/lite/experimental/ruy/prepacked_cache.h"
 #include "tensorflow/lite/experimental/ruy/thread_pool.h"
 #include "tensorflow/lite/experimental/ruy/trace.h"
 #include "tensorflow/lite/experimental/ruy/tune.h"
@@ -49,6 +50,14 @@ struct Context final {
   // TODO(benoitjacob) rename that thread_pool. Current name is gemmlowp legacy.
   ThreadPool workers_pool;
   int max_num_threads = 1;
+  // Optional relative speeds of the threads of a multi-threaded matrix
+  // multiplication: entry 0 is the main thread, entry i is the thread
+  // running task #i, i.e. the (i-1)-th thread of workers_pool, see
+  // ThreadPool::set_cpu_affinity_masks. Missing entries default to 1.
+  // When threads run on cores of different speeds, e.g. big and little cores,
+  // this lets matrix multiplications be divided into enough blocks for the
+  // faster threads to do proportionally more of the work.
+  std::vector<float> thread_relative_speeds;
   // State for each thread in the thread pool. Entry 0 is the main thread.
   std::vector<std::unique_ptr<PerThreadState>> per_thread_states;
   TracingContext tracing;
@@ -73,6 +82,13 @@ struct Context final {
     return tuning_resolver->Resolve();
   }
 
+  PrepackedCache* GetPrepackedCache() {
+    if (!prepacked_cache_) {
+      prepacked_cache_.reset(new PrepackedCache);
+    }
+    return prepacked_cache_.get();
+  }
+
   template <Path CompiledPaths>
   Path GetPathToTake() {
     last_taken_path =
@@ -89,6 +105,8 @@ struct Context final {
   // while it's already in committed state, so the main thread needs both
   // this allocator, and its per-thread allocator.
   std::unique_ptr<Allocator> main_allocator_;
+  // Packed forms of the cacheable matrices, see Matrix::cacheable.
+  std::unique_ptr<PrepackedCache> prepacked_cache_;
   Path runtime_enabled_paths_ = Path::kNone;
 };
 
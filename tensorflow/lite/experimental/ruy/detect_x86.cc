@@ -0,0 +1,121 @@
+/* Copyright 2020 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/ruy/detect_x86.h"
+
+#include <cstdint>
+
+#if RUY_PLATFORM(X86)
+#ifdef _MSC_VER
+#include <immintrin.h>  // IWYU pragma: keep
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace ruy {
+
+#if RUY_PLATFORM(X86)
+
+namespace {
+
+// Registers returned by the CPUID instruction for a given leaf and subleaf.
+struct CpuidRegisters {
+  std::uint32_t eax = 0;
+  std::uint32_t ebx = 0;
+  std::uint32_t ecx = 0;
+  std::uint32_t edx = 0;
+};
+
+CpuidRegisters Cpuid(std::uint32_t leaf, std::uint32_t subleaf) {
+  CpuidRegisters regs;
+#ifdef _MSC_VER
+  int info[4];
+  __cpuidex(info, leaf, subleaf);
+  regs.eax = info[0];
+  regs.ebx = info[1];
+  regs.ecx = info[2];
+  regs.edx = info[3];
+#else
+  __cpuid_count(leaf, subleaf, regs.eax, regs.ebx, regs.ecx, regs.edx);
+#endif
+  return regs;
+}
+
+// Returns the XCR0 register, telling which register states the OS saves on
+// context switches.
+std::uint64_t ReadXcr0() {
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  std::uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+bool IsBitSet(std::uint32_t reg, int bit) { return (reg >> bit) & 1; }
+
+// The CPU features needed by the x86 paths, detected once.
+struct X86Features {
+  bool avx2 = false;
+  bool avx512 = false;
+  bool avx_vnni = false;
+
+  X86Features() {
+    const CpuidRegisters leaf0 = Cpuid(0, 0);
+    if (leaf0.eax < 7) {
+      return;
+    }
+    const CpuidRegisters leaf1 = Cpuid(1, 0);
+    // The OS must have enabled XSAVE, for XGETBV to be available.
+    if (!IsBitSet(leaf1.ecx, 27)) {
+      return;
+    }
+    const std::uint64_t xcr0 = ReadXcr0();
+    // SSE and AVX states.
+    const bool os_saves_ymm = (xcr0 & 0x6) == 0x6;
+    // Opmask, upper halves of ZMM0-15 and ZMM16-31 states.
+    const bool os_saves_zmm = os_saves_ymm && (xcr0 & 0xe0) == 0xe0;
+
+    const CpuidRegisters leaf7 = Cpuid(7, 0);
+    const bool fma = IsBitSet(leaf1.ecx, 12);
+    avx2 = os_saves_ymm && fma && IsBitSet(leaf7.ebx, 5);
+    // AVX512F, AVX512DQ, AVX512CD, AVX512BW, AVX512VL.
+    avx512 = avx2 && os_saves_zmm && IsBitSet(leaf7.ebx, 16) &&
+             IsBitSet(leaf7.ebx, 17) && IsBitSet(leaf7.ebx, 28) &&
+             IsBitSet(leaf7.ebx, 30) && IsBitSet(leaf7.ebx, 31);
+    // AVX512_VNNI.
+    avx_vnni = avx512 && IsBitSet(leaf7.ecx, 11);
+  }
+};
+
+const X86Features& GetX86Features() {
+  static const X86Features features;
+  return features;
+}
+
+}  // namespace
+
+bool DetectCpuAvx2() { return GetX86Features().avx2; }
+
+bool DetectCpuAvx512() { return GetX86Features().avx512; }
+
+bool DetectCpuAvxVnni() { return GetX86Features().avx_vnni; }
+
+#endif  // RUY_PLATFORM(X86)
+
+}  // namespace ruy
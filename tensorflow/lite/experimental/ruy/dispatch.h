@@ -50,6 +50,7 @@ limitations under the License.
 #include "tensorflow/lite/experimental/ruy/pack.h"
 #include "tensorflow/lite/experimental/ruy/pack_common.h"
 #include "tensorflow/lite/experimental/ruy/path.h"
+#include "tensorflow/lite/experimental/ruy/prepacked_cache.h"
 #include "tensorflow/lite/experimental/ruy/side_pair.h"
 #include "tensorflow/lite/experimental/ruy/size_util.h"
 #include "tensorflow/lite/experimental/ruy/spec.h"
@@ -379,6 +380,49 @@ struct CompileTimeEnabledReferenceMul</*ReferenceMulIsEnabled=*/false> {
   }
 };
 
+// Takes the packed form of the cacheable operands from the Context's
+// PrepackedCache, packing them into it on the first use, and marks them as
+// prepacked so that TrMul doesn't pack them again.
+inline void HandlePrepackedCaching(TrMulParams* params,
+                                   const SidePair<bool>& cacheable,
+                                   Path the_path, Context* context) {
+  for (Side side : {Side::kLhs, Side::kRhs}) {
+    if (!cacheable[side]) {
+      continue;
+    }
+    const DMatrix& src = params->src[side];
+    PrepackedCacheKey key;
+    key.src_data = src.data;
+    key.side = static_cast<std::uint8_t>(side);
+    key.path = static_cast<std::uint8_t>(the_path);
+    key.src_layout = src.layout;
+    key.src_zero_point = src.zero_point;
+    key.src_type_size = src.data_type.size;
+    key.src_type_is_signed = src.data_type.is_signed;
+    key.src_type_is_floating_point = src.data_type.is_floating_point;
+
+    PrepackedCache* cache = context->GetPrepackedCache();
+    PMatrix& packed = params->packed[side];
+    const PrepackedMatrix* prepacked = cache->Find(key);
+    if (!prepacked) {
+      PrepackedMatrix* inserted =
+          cache->Insert(key, DataSize(packed), SumsSize(packed));
+      if (!inserted) {
+        // Too large for the cache: TrMul packs it as usual.
+        continue;
+      }
+      packed.data = inserted->data;
+      packed.sums = inserted->sums;
+      params->RunPack(side, context->GetMainThreadTuning(), 0,
+                      packed.layout.cols);
+      prepacked = inserted;
+    }
+    packed.data = prepacked->data;
+    packed.sums = prepacked->sums;
+    params->is_prepacked[side] = true;
+  }
+}
+
 template <Path CompiledPaths, typename LhsScalar, typename RhsScalar,
           typename DstScalar, typename Spec>
 void DispatchMul(const Matrix<LhsScalar>& lhs, const Matrix<RhsScalar>& rhs,
@@ -426,6 +470,8 @@ void DispatchMul(const Matrix<LhsScalar>& lhs, const Matrix<RhsScalar>& rhs,
   TrMulParams params;
   CreateTrMulParams<TrMulCompiledPaths>(transposed_lhs, rhs, spec, context, dst,
                                         the_path, &params);
+  HandlePrepackedCaching(&params, {lhs.cacheable, rhs.cacheable}, the_path,
+                         context);
   TrMul(&params, context);
 }
 
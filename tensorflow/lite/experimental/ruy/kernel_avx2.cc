@@ -0,0 +1,379 @@
+/* Copyright 2020 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "profiling/instrumentation.h"
+#include "tensorflow/lite/experimental/ruy/check_macros.h"
+#include "tensorflow/lite/experimental/ruy/have_built_path_for.h"
+#include "tensorflow/lite/experimental/ruy/kernel.h"
+#include "tensorflow/lite/experimental/ruy/opt_set.h"
+#include "tensorflow/lite/experimental/ruy/platform.h"
+
+#if RUY_PLATFORM(AVX2) && RUY_OPT_ENABLED(RUY_OPT_ASM)
+#include <immintrin.h>  // IWYU pragma: keep
+#endif
+
+namespace ruy {
+
+#if RUY_PLATFORM(X86)
+bool HaveBuiltPathForAvx2() {
+  return RUY_PLATFORM(AVX2) && RUY_OPT_ENABLED(RUY_OPT_ASM) &&
+         RUY_OPT_ENABLED(RUY_OPT_INTRINSICS);
+}
+#endif  // RUY_PLATFORM(X86)
+
+#if RUY_PLATFORM(AVX2) && RUY_OPT_ENABLED(RUY_OPT_ASM)
+
+namespace {
+
+// Mask selecting the first `count` 32-bit lanes, for masked loads and stores.
+inline __m256i LaneMask(int count) {
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32(count),
+                            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+// Sign-extends the low (resp. high) byte of each 16-bit lane to the whole lane.
+inline __m256i SignExtendEvenBytes(__m256i v) {
+  return _mm256_srai_epi16(_mm256_slli_epi16(v, 8), 8);
+}
+
+inline __m256i SignExtendOddBytes(__m256i v) { return _mm256_srai_epi16(v, 8); }
+
+// Arithmetic right shift of 64-bit lanes, which AVX2 lacks.
+inline __m256i ShiftRightArithmeticEpi64(__m256i v, __m256i count) {
+  const __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), v);
+  return _mm256_xor_si256(_mm256_srlv_epi64(_mm256_xor_si256(v, sign), count),
+                          sign);
+}
+
+// Applies the fixed-point multiplier `m` and the right shift `right_shift` of
+// each lane, rounding to nearest with ties upward, as the AVX-512 kernel does.
+inline __m256i MultiplyByFixedPoint(__m256i v, __m256i m,
+                                    __m256i right_shift) {
+  const __m256i low_mask = _mm256_set1_epi64x(0xffffffff);
+  const __m256i final_right_shift =
+      _mm256_add_epi32(right_shift, _mm256_set1_epi32(31));
+  const __m256i offset = _mm256_set1_epi64x(static_cast<std::int64_t>(1) << 30);
+  // _mm256_mul_epi32 multiplies the even lanes; shift the odd ones down.
+  __m256i even = _mm256_mul_epi32(v, m);
+  __m256i odd =
+      _mm256_mul_epi32(_mm256_srli_epi64(v, 32), _mm256_srli_epi64(m, 32));
+  even = _mm256_add_epi64(
+      even, _mm256_sllv_epi64(offset, _mm256_and_si256(right_shift, low_mask)));
+  odd = _mm256_add_epi64(
+      odd, _mm256_sllv_epi64(offset, _mm256_srli_epi64(right_shift, 32)));
+  even = ShiftRightArithmeticEpi64(
+      even, _mm256_and_si256(final_right_shift, low_mask));
+  odd = ShiftRightArithmeticEpi64(odd,
+                                  _mm256_srli_epi64(final_right_shift, 32));
+  return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+}
+
+// Stores the low byte (resp. low 16 bits) of the first `count` lanes of `v`.
+inline void StoreEpi32AsEpi8(__m256i v, int count, void* dst) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  //
+      0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  v = _mm256_shuffle_epi8(v, shuffle);
+  v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+  if (count == 8) {
+    _mm_storel_epi64(static_cast<__m128i*>(dst), _mm256_castsi256_si128(v));
+  } else {
+    std::int8_t buf[8];
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(buf),
+                     _mm256_castsi256_si128(v));
+    memcpy(dst, buf, count);
+  }
+}
+
+inline void StoreEpi32AsEpi16(__m256i v, int count, void* dst) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,  //
+      0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+  v = _mm256_shuffle_epi8(v, shuffle);
+  v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 4, 5, 0, 0, 0, 0));
+  if (count == 8) {
+    _mm_storeu_si128(static_cast<__m128i*>(dst), _mm256_castsi256_si128(v));
+  } else {
+    std::int16_t buf[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(buf),
+                     _mm256_castsi256_si128(v));
+    memcpy(dst, buf, count * sizeof(std::int16_t));
+  }
+}
+
+}  // namespace
+
+void Kernel8bitAvx2(const KernelParams8bit<8, 8>& params) {
+  gemmlowp::ScopedProfilingLabel label("Kernel kAvx2 8-bit");
+
+  std::int32_t dst_stride;
+  if ((params.dst_type_id == DstTypeId<std::int8_t>::kValue) ||
+      (params.dst_type_id == DstTypeId<std::uint8_t>::kValue)) {
+    dst_stride = params.dst_stride;
+  } else if (params.dst_type_id == DstTypeId<std::int16_t>::kValue) {
+    dst_stride = params.dst_stride / sizeof(std::int16_t);
+  } else if (params.dst_type_id == DstTypeId<std::int32_t>::kValue) {
+    dst_stride = params.dst_stride / sizeof(std::int32_t);
+  } else {
+    RUY_DCHECK(false);
+  }
+
+  int bias_ptr_block_increment = params.flags & RUY_ASM_FLAG_HAS_BIAS ? 8 : 0;
+
+  const std::int8_t* rhs_col_ptr = params.rhs_base_ptr;
+  void* dst_col_ptr = params.dst_base_ptr;
+  const std::int32_t* bias_col_ptr = params.bias;
+  if (params.flags & RUY_ASM_FLAG_HAS_BIAS) {
+    bias_col_ptr += params.start_row;
+  }
+
+  for (int col = params.start_col; col <= params.last_col; col += 8) {
+    const std::int8_t* lhs_col_ptr = params.lhs_base_ptr;
+    void* dst_ptr = dst_col_ptr;
+    const std::int32_t* bias_ptr = bias_col_ptr;
+
+    for (int row = params.start_row; row <= params.last_row; row += 8) {
+      const int residual_rows = std::min(params.dst_rows - row, 8);
+      const int residual_cols = std::min(params.dst_cols - col, 8);
+      const __m256i row_mask = LaneMask(residual_rows);
+
+      // Initialize with bias.
+      __m256i accum_data_v[8];
+      const __m256i initial_accum_data =
+          _mm256_maskload_epi32(bias_ptr, row_mask);
+      bias_ptr += bias_ptr_block_increment;
+      for (int j = 0; j < 8; ++j) {
+        accum_data_v[j] = initial_accum_data;
+      }
+
+      // Each 32-bit lane of the packed data holds 4 consecutive levels of
+      // depth. The even and odd bytes are sign-extended to 16 bits separately,
+      // so that _mm256_madd_epi16 sums pairs of products into 32 bits.
+      const std::int8_t* lhs_ptr = lhs_col_ptr;
+      const std::int8_t* rhs_ptr = rhs_col_ptr;
+      for (int d = 0; d < params.depth; d += 4) {
+        const __m256i lhs_data =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs_ptr));
+        const __m256i rhs_data =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs_ptr));
+        const __m256i lhs_16_bit_even = SignExtendEvenBytes(lhs_data);
+        const __m256i lhs_16_bit_odd = SignExtendOddBytes(lhs_data);
+        const __m256i rhs_16_bit_even = SignExtendEvenBytes(rhs_data);
+        const __m256i rhs_16_bit_odd = SignExtendOddBytes(rhs_data);
+
+        for (int j = 0; j < 8; ++j) {
+          const __m256i index = _mm256_set1_epi32(j);
+          const __m256i dup_rhs_element_even =
+              _mm256_permutevar8x32_epi32(rhs_16_bit_even, index);
+          const __m256i dup_rhs_element_odd =
+              _mm256_permutevar8x32_epi32(rhs_16_bit_odd, index);
+          accum_data_v[j] = _mm256_add_epi32(
+              accum_data_v[j],
+              _mm256_add_epi32(
+                  _mm256_madd_epi16(lhs_16_bit_even, dup_rhs_element_even),
+                  _mm256_madd_epi16(lhs_16_bit_odd, dup_rhs_element_odd)));
+        }
+
+        lhs_ptr += 8 * 4;
+        rhs_ptr += 8 * 4;
+      }
+
+      const std::int32_t lhs_zero_point = params.lhs_zero_point;
+      const std::int32_t rhs_zero_point = params.rhs_zero_point;
+      const std::int32_t prod_zp_depth = params.prod_zp_depth;
+      if ((params.flags & RUY_ASM_FLAG_HAS_LHS_SUMS) && rhs_zero_point) {
+        const __m256i lhs_sums_offset = _mm256_mullo_epi32(
+            _mm256_set1_epi32(rhs_zero_point),
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(&params.lhs_sums[row])));
+        for (int j = 0; j < 8; ++j) {
+          accum_data_v[j] = _mm256_sub_epi32(accum_data_v[j], lhs_sums_offset);
+        }
+      }
+      if (((params.flags & RUY_ASM_FLAG_HAS_RHS_SUMS) && lhs_zero_point) ||
+          prod_zp_depth) {
+        for (int j = 0; j < 8; ++j) {
+          std::int32_t non_lhs_sums_offset = -prod_zp_depth;
+          if (params.flags & RUY_ASM_FLAG_HAS_RHS_SUMS) {
+            non_lhs_sums_offset += lhs_zero_point * params.rhs_sums[col + j];
+          }
+          accum_data_v[j] = _mm256_sub_epi32(
+              accum_data_v[j], _mm256_set1_epi32(non_lhs_sums_offset));
+        }
+      }
+
+      if (params.dst_type_id != DstTypeId<std::int32_t>::kValue) {
+        __m256i m_vector;
+        __m256i e_vector;
+        // Does not make use of RUY_ASM_FLAG_NEEDS_LEFT_SHIFT.
+        if (params.flags & RUY_ASM_FLAG_HAS_PERCHANNEL) {
+          m_vector = _mm256_maskload_epi32(&params.multiplier_fixedpoint[row],
+                                           row_mask);
+          e_vector = _mm256_maskload_epi32(&params.multiplier_exponent[row],
+                                           row_mask);
+        } else {
+          // These arrays have size LhsCols, and are pre-filled.
+          m_vector = _mm256_loadu_si256(
+              reinterpret_cast<const __m256i*>(params.multiplier_fixedpoint));
+          e_vector = _mm256_loadu_si256(
+              reinterpret_cast<const __m256i*>(params.multiplier_exponent));
+        }
+
+        const __m256i zero_vector = _mm256_setzero_si256();
+        const __m256i left_shift = _mm256_max_epi32(e_vector, zero_vector);
+        const __m256i right_shift =
+            _mm256_max_epi32(_mm256_sub_epi32(zero_vector, e_vector),
+                             zero_vector);
+        for (int j = 0; j < 8; ++j) {
+          accum_data_v[j] = MultiplyByFixedPoint(
+              _mm256_sllv_epi32(accum_data_v[j], left_shift), m_vector,
+              right_shift);
+#if !RUY_OPT_ENABLED(RUY_OPT_NATIVE_ROUNDING)
+          RUY_DCHECK(false);
+#endif
+        }
+
+        if (params.dst_zero_point) {
+          const __m256i dst_zero_point =
+              _mm256_set1_epi32(params.dst_zero_point);
+          for (int j = 0; j < 8; ++j) {
+            accum_data_v[j] = _mm256_add_epi32(accum_data_v[j], dst_zero_point);
+          }
+        }
+        const __m256i clamp_max_v = _mm256_set1_epi32(params.clamp_max);
+        const __m256i clamp_min_v = _mm256_set1_epi32(params.clamp_min);
+        for (int j = 0; j < 8; ++j) {
+          accum_data_v[j] = _mm256_min_epi32(accum_data_v[j], clamp_max_v);
+          accum_data_v[j] = _mm256_max_epi32(accum_data_v[j], clamp_min_v);
+        }
+      }
+
+      if ((params.dst_type_id == DstTypeId<std::int8_t>::kValue) ||
+          (params.dst_type_id == DstTypeId<std::uint8_t>::kValue)) {
+        std::uint8_t* tmp_ptr = static_cast<std::uint8_t*>(dst_ptr);
+        for (int j = 0; j < residual_cols; ++j) {
+          StoreEpi32AsEpi8(accum_data_v[j], residual_rows, tmp_ptr);
+          tmp_ptr += dst_stride;
+        }
+        dst_ptr = static_cast<void*>(static_cast<std::uint8_t*>(dst_ptr) + 8);
+      } else if (params.dst_type_id == DstTypeId<std::int16_t>::kValue) {
+        std::int16_t* tmp_ptr = static_cast<std::int16_t*>(dst_ptr);
+        for (int j = 0; j < residual_cols; ++j) {
+          StoreEpi32AsEpi16(accum_data_v[j], residual_rows, tmp_ptr);
+          tmp_ptr += dst_stride;
+        }
+        dst_ptr = static_cast<void*>(static_cast<std::int16_t*>(dst_ptr) + 8);
+      } else if (params.dst_type_id == DstTypeId<std::int32_t>::kValue) {
+        std::int32_t* tmp_ptr = static_cast<std::int32_t*>(dst_ptr);
+        for (int j = 0; j < residual_cols; ++j) {
+          _mm256_maskstore_epi32(tmp_ptr, row_mask, accum_data_v[j]);
+          tmp_ptr += dst_stride;
+        }
+        dst_ptr = static_cast<void*>(static_cast<std::int32_t*>(dst_ptr) + 8);
+      } else {
+        RUY_DCHECK(false);
+      }
+
+      lhs_col_ptr += 8 * params.lhs_stride;
+    }  // End row-block loop.
+
+    dst_col_ptr = static_cast<void*>(static_cast<char*>(dst_col_ptr) +
+                                     8 * params.dst_stride);
+    rhs_col_ptr += 8 * params.rhs_stride;
+  }  // End col-block loop.
+}
+
+void KernelFloatAvx2(const KernelParamsFloat<8, 8>& params) {
+  gemmlowp::ScopedProfilingLabel label("Kernel kAvx2 float");
+
+  // As parameters are defined, we need to scale by sizeof(float).
+  const std::int64_t lhs_stride = params.lhs_stride >> 2;
+  const std::int64_t dst_stride = params.dst_stride >> 2;
+  const std::int64_t rhs_stride = params.rhs_stride >> 2;
+
+  int bias_ptr_block_increment = params.flags & RUY_ASM_FLAG_HAS_BIAS ? 1 : 0;
+  const int end_row = std::min(params.dst_rows, params.last_row + 8);
+  const int end_col = std::min(params.dst_cols, params.last_col + 8);
+
+  const float* adj_rhs_col_ptr =
+      params.rhs_base_ptr - params.start_col * rhs_stride;
+  float* adj_dst_col_ptr =
+      params.dst_base_ptr - params.start_col * dst_stride - params.start_row;
+  const float* adj_lhs_col_ptr =
+      params.lhs_base_ptr - params.start_row * lhs_stride;
+
+  const __m256 clamp_max_v = _mm256_set1_ps(params.clamp_max);
+  const __m256 clamp_min_v = _mm256_set1_ps(params.clamp_min);
+
+  for (int col = params.start_col; col < end_col; col += 8) {
+    const int residual_cols = std::min(end_col - col, 8);
+    const float* rhs_col_ptr = adj_rhs_col_ptr + col * rhs_stride;
+    float* dst_col_ptr = adj_dst_col_ptr + col * dst_stride;
+
+    for (int row = params.start_row; row < end_row; row += 8) {
+      const int residual_rows = std::min(end_row - row, 8);
+      const __m256i row_mask = LaneMask(residual_rows);
+      const float* lhs_ptr = adj_lhs_col_ptr + row * lhs_stride;
+      const float* rhs_ptr = rhs_col_ptr;
+      float* dst_ptr = dst_col_ptr + row;
+      const float* bias_ptr = params.bias + row * bias_ptr_block_increment;
+
+      // Initialize with bias.
+      const __m256 initial_accum_data = _mm256_maskload_ps(bias_ptr, row_mask);
+      __m256 accum_data_v[8];
+      for (int j = 0; j < 8; ++j) {
+        accum_data_v[j] = initial_accum_data;
+      }
+
+      for (int d = 0; d < params.depth; ++d) {
+        const __m256 lhs_data = _mm256_loadu_ps(lhs_ptr);
+        for (int j = 0; j < 8; ++j) {
+          accum_data_v[j] = _mm256_fmadd_ps(
+              lhs_data, _mm256_broadcast_ss(rhs_ptr + j), accum_data_v[j]);
+        }
+        lhs_ptr += 8;
+        rhs_ptr += 8;
+      }
+
+      for (int j = 0; j < residual_cols; ++j) {
+        __m256 accum = _mm256_min_ps(accum_data_v[j], clamp_max_v);
+        accum = _mm256_max_ps(accum, clamp_min_v);
+        if (residual_rows == 8) {
+          _mm256_storeu_ps(dst_ptr, accum);
+        } else {
+          _mm256_maskstore_ps(dst_ptr, row_mask, accum);
+        }
+        dst_ptr += dst_stride;
+      }
+    }  // End row-block loop.
+  }    // End col-block loop.
+}
+
+#elif RUY_PLATFORM(X86_ENHANCEMENTS) && RUY_OPT_ENABLED(RUY_OPT_ASM)
+
+// This translation unit was built without AVX2. HaveBuiltPathForAvx2() tells
+// Context::GetRuntimeEnabledPaths() to never select this path.
+
+void Kernel8bitAvx2(const KernelParams8bit<8, 8>&) { RUY_DCHECK(false); }
+
+void KernelFloatAvx2(const KernelParamsFloat<8, 8>&) { RUY_DCHECK(false); }
+
+#endif  //  RUY_PLATFORM(AVX2) && RUY_OPT_ENABLED(RUY_OPT_ASM)
+
+}  // namespace ruy
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "profiling/instrumentation.h"
 #include "tensorflow/lite/experimental/ruy/check_macros.h"
+#include "tensorflow/lite/experimental/ruy/have_built_path_for.h"
 #include "tensorflow/lite/experimental/ruy/kernel.h"
 #include "tensorflow/lite/experimental/ruy/opt_set.h"
 #include "tensorflow/lite/experimental/ruy/platform.h"
@@ -28,6 +29,13 @@ limitations under the License.
 
 namespace ruy {
 
+#if RUY_PLATFORM(X86)
+bool HaveBuiltPathForAvx512() {
+  return RUY_PLATFORM(AVX512) && RUY_OPT_ENABLED(RUY_OPT_ASM) &&
+         RUY_OPT_ENABLED(RUY_OPT_INTRINSICS);
+}
+#endif  // RUY_PLATFORM(X86)
+
 #if RUY_PLATFORM(AVX512) && RUY_OPT_ENABLED(RUY_OPT_ASM)
 
 inline std::int32_t mm512_get1_epi32(const __m512i v, int i) {
@@ -807,6 +815,15 @@ void KernelFloatAvx512(const KernelParamsFloat<16, 16>& params) {
   }      // Residual cols.
 }
 
+#elif RUY_PLATFORM(X86_ENHANCEMENTS) && RUY_OPT_ENABLED(RUY_OPT_ASM)
+
+// This translation unit was built without AVX-512. HaveBuiltPathForAvx512()
+// tells Context::GetRuntimeEnabledPaths() to never select this path.
+
+void Kernel8bitAvx512(const KernelParams8bit<16, 16>&) { RUY_DCHECK(false); }
+
+void KernelFloatAvx512(const KernelParamsFloat<16, 16>&) { RUY_DCHECK(false); }
+
 #endif  //  RUY_PLATFORM(AVX512) && RUY_OPT_ENABLED(RUY_OPT_ASM)
 
 }  // namespace ruy
@@ -110,6 +110,7 @@ struct Matrix final {
     data = other.data;
     layout = other.layout;
     zero_point = other.zero_point;
+    cacheable = other.cacheable;
   }
 
   // The underlying buffer wrapped by this matrix.
@@ -119,6 +120,11 @@ struct Matrix final {
   // The zero_point, i.e. which Scalar value is to be interpreted as zero.
   // When Scalar is floating-point, this must be 0.
   Scalar zero_point = 0;
+  // Whether Mul may cache the packed form of this matrix in the Context, to
+  // skip packing it in the next multiplications by the same data. Only set it
+  // on constant matrices such as the weights of a neural network layer: the
+  // data must not change as long as the Context lives.
+  bool cacheable = false;
 };
 
 inline void MakeSimpleLayout(int rows, int cols, Order order, Layout* layout) {
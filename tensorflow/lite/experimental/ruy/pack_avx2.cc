@@ -0,0 +1,210 @@
+/* Copyright 2020 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "profiling/instrumentation.h"
+#include "tensorflow/lite/experimental/ruy/check_macros.h"
+#include "tensorflow/lite/experimental/ruy/matrix.h"
+#include "tensorflow/lite/experimental/ruy/opt_set.h"
+#include "tensorflow/lite/experimental/ruy/pack.h"
+#include "tensorflow/lite/experimental/ruy/path.h"
+#include "tensorflow/lite/experimental/ruy/platform.h"
+
+#if RUY_PLATFORM(AVX2) && RUY_OPT_ENABLED(RUY_OPT_INTRINSICS)
+#include <immintrin.h>  // IWYU pragma: keep
+#endif
+
+namespace ruy {
+
+#if RUY_PLATFORM(AVX2) && RUY_OPT_ENABLED(RUY_OPT_INTRINSICS)
+
+// The first int8_t template parameter is arbitrary: this routine is common to
+// all 8-bit source matrix types.
+using PackImpl8bitAvx2 =
+    PackImpl<Path::kAvx2, FixedKernelLayout<Order::kColMajor, 4, 8>,
+             std::int8_t, std::int8_t, std::int32_t>;
+
+namespace {
+
+// Transposes the 8x8 matrix of 32-bit elements held in r[0..7], one row per
+// register.
+inline void Transpose8x8Epi32(__m256i* r) {
+  const __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+  const __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+  const __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+  const __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+  const __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+  const __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+  const __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+  const __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+  const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+  const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+  const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+  const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+  const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+  const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+  const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+  const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+  r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+  r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+  r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+  r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+  r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+  r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+  r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+  r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+// Returns the sums of the 4 signed bytes of each 32-bit lane.
+inline __m256i SumBytesPerEpi32(__m256i v) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  const __m256i even = _mm256_srai_epi16(_mm256_slli_epi16(v, 8), 8);
+  const __m256i odd = _mm256_srai_epi16(v, 8);
+  return _mm256_add_epi32(_mm256_madd_epi16(even, ones),
+                          _mm256_madd_epi16(odd, ones));
+}
+
+}  // namespace.
+
+void Pack8bitAvx2(const std::int8_t* src_ptr, std::int8_t input_xor,
+                  const std::int8_t* zerobuf, int src_stride,
+                  int remaining_src_cols, int src_rows, std::int8_t* packed_ptr,
+                  std::int32_t* sums_ptr) {
+  gemmlowp::ScopedProfilingLabel label("Pack kAvx2 8bit");
+
+  using Layout = PackImpl8bitAvx2::Layout;
+  RUY_DCHECK_EQ(Layout::kCols, 8);
+  RUY_DCHECK_EQ(Layout::kRows, 4);
+
+  // The 4 source rows making up a packed row of a column are contiguous, so
+  // packing 32 source rows of the 8 columns of a block amounts to transposing
+  // an 8x8 matrix of 32-bit elements.
+  constexpr int kNumChunkedSrcRows = 32;
+  const std::int8_t* src_ptrs[Layout::kCols];
+  std::int64_t src_incs[Layout::kCols];
+  for (int i = 0; i < Layout::kCols; ++i) {
+    // Columns past the end of the source take the zero point from zerobuf.
+    if (i < remaining_src_cols) {
+      src_ptrs[i] = src_ptr + i * src_stride;
+      src_incs[i] = kNumChunkedSrcRows;
+    } else {
+      src_ptrs[i] = zerobuf;
+      src_incs[i] = 0;
+    }
+  }
+
+  const __m256i input_xor_v = _mm256_set1_epi8(input_xor);
+  __m256i sums_v = _mm256_setzero_si256();
+  for (int k = 0; k < src_rows; k += kNumChunkedSrcRows) {
+    const int available_src_rows = src_rows - k;
+    __m256i r[Layout::kCols];
+    if (available_src_rows >= kNumChunkedSrcRows) {
+      for (int i = 0; i < Layout::kCols; ++i) {
+        r[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_ptrs[i]));
+      }
+    } else {
+      // Pad the trailing rows with the zero point, up to the next multiple of
+      // Layout::kRows that ends up in the packed matrix.
+      std::int8_t trailing_buf[kNumChunkedSrcRows];
+      for (int i = 0; i < Layout::kCols; ++i) {
+        memset(trailing_buf, zerobuf[0], kNumChunkedSrcRows);
+        memcpy(trailing_buf, src_ptrs[i], available_src_rows);
+        r[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(trailing_buf));
+      }
+    }
+    for (int i = 0; i < Layout::kCols; ++i) {
+      r[i] = _mm256_xor_si256(r[i], input_xor_v);
+      src_ptrs[i] += src_incs[i];
+    }
+    Transpose8x8Epi32(r);
+
+    const int packed_rows =
+        std::min(kNumChunkedSrcRows, (available_src_rows + 3) & ~3);
+    for (int m = 0; m < packed_rows / Layout::kRows; ++m) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(packed_ptr), r[m]);
+      sums_v = _mm256_add_epi32(sums_v, SumBytesPerEpi32(r[m]));
+      packed_ptr += Layout::kCols * Layout::kRows;
+    }
+  }
+  if (sums_ptr) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums_ptr), sums_v);
+  }
+}
+
+void PackFloatAvx2(const float* src_ptr, const float* zerobuf, int src_stride,
+                   int remaining_src_cols, int src_rows, float* packed_ptr) {
+  gemmlowp::ScopedProfilingLabel label("Pack kAvx2 float");
+
+  // Packing 8 rows of the 8 columns of a block is an 8x8 transpose.
+  constexpr int kBlockSize = 8;
+  const float* src_ptrs[kBlockSize];
+  std::int64_t src_incs[kBlockSize];
+  for (int i = 0; i < kBlockSize; ++i) {
+    if (i < remaining_src_cols) {
+      src_ptrs[i] = src_ptr + i * src_stride;
+      src_incs[i] = kBlockSize;
+    } else {
+      src_ptrs[i] = zerobuf;
+      src_incs[i] = 0;
+    }
+  }
+
+  for (int k = 0; k < src_rows; k += kBlockSize) {
+    const int available_src_rows = std::min(src_rows - k, kBlockSize);
+    __m256i r[kBlockSize];
+    if (available_src_rows == kBlockSize) {
+      for (int i = 0; i < kBlockSize; ++i) {
+        r[i] = _mm256_castps_si256(_mm256_loadu_ps(src_ptrs[i]));
+      }
+    } else {
+      float trailing_buf[kBlockSize] = {0.0f};
+      for (int i = 0; i < kBlockSize; ++i) {
+        memcpy(trailing_buf, src_ptrs[i], available_src_rows * sizeof(float));
+        r[i] = _mm256_castps_si256(_mm256_loadu_ps(trailing_buf));
+      }
+    }
+    for (int i = 0; i < kBlockSize; ++i) {
+      src_ptrs[i] += src_incs[i];
+    }
+    Transpose8x8Epi32(r);
+
+    for (int m = 0; m < available_src_rows; ++m) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(packed_ptr), r[m]);
+      packed_ptr += kBlockSize;
+    }
+  }
+}
+
+#elif RUY_PLATFORM(X86_ENHANCEMENTS) && RUY_OPT_ENABLED(RUY_OPT_ASM)
+
+// This translation unit was built without AVX2, see kernel_avx2.cc.
+
+void Pack8bitAvx2(const std::int8_t*, std::int8_t, const std::int8_t*, int, int,
+                  int, std::int8_t*, std::int32_t*) {
+  RUY_DCHECK(false);
+}
+
+void PackFloatAvx2(const float*, const float*, int, int, int, float*) {
+  RUY_DCHECK(false);
+}
+
+#endif  // RUY_PLATFORM(AVX2) && RUY_OPT_ENABLED(RUY_OPT_INTRINSICS)
+
+}  // namespace ruy
@@ -541,6 +541,19 @@ void PackFloatAvx512(const float* src_ptr, const float* zerobuf, int src_stride,
   }
 }
 
+#elif RUY_PLATFORM(X86_ENHANCEMENTS) && RUY_OPT_ENABLED(RUY_OPT_ASM)
+
+// This translation unit was built without AVX-512, see kernel_avx512.cc.
+
+void Pack8bitAvx512(const std::int8_t*, std::int8_t, const std::int8_t*, int,
+                    int, int, std::int8_t*, std::int32_t*) {
+  RUY_DCHECK(false);
+}
+
+void PackFloatAvx512(const float*, const float*, int, int, int, float*) {
+  RUY_DCHECK(false);
+}
+
 #endif  // RUY_PLATFORM(AVX512) && RUY_OPT_ENABLED(RUY_OPT_INTRINSICS)
 
 }  // namespace ruy
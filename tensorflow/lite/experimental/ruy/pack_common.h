@@ -153,9 +153,17 @@ struct PackedTypeImpl<Path::kNeonDotprod, std::uint8_t> {
 };
 #elif RUY_PLATFORM(X86)
 template <>
+struct PackedTypeImpl<Path::kAvx2, std::uint8_t> {
+  using Type = std::int8_t;
+};
+template <>
 struct PackedTypeImpl<Path::kAvx512, std::uint8_t> {
   using Type = std::int8_t;
 };
+template <>
+struct PackedTypeImpl<Path::kAvxVnni, std::uint8_t> {
+  using Type = std::int8_t;
+};
 #endif
 
 template <Path ThePath, typename Scalar>
@@ -212,7 +220,9 @@ RUY_INHERIT_PACK(Path::kStandardCpp, Path::kNeon)
 RUY_INHERIT_PACK(Path::kNeon, Path::kNeonDotprod)
 #endif
 #elif RUY_PLATFORM(X86)
-RUY_INHERIT_PACK(Path::kStandardCpp, Path::kAvx512)
+RUY_INHERIT_PACK(Path::kStandardCpp, Path::kAvx2)
+RUY_INHERIT_PACK(Path::kAvx2, Path::kAvx512)
+RUY_INHERIT_PACK(Path::kAvx512, Path::kAvxVnni)
 #endif
 
 // Main entry point for packing.
@@ -85,8 +85,13 @@ enum class Path : std::uint8_t {
 #if RUY_PLATFORM(X86)
   // x86 architectures.
   //
+  // Optimized for AVX2 and FMA.
+  kAvx2 = 0x4,
   // Optimized for AVX-512.
-  kAvx512 = 0x4,
+  kAvx512 = 0x8,
+  // Optimized for AVX-512 VNNI, for 8-bit multiplications. Float
+  // multiplications take the same code as kAvx512.
+  kAvxVnni = 0x10,
 #endif
 };
 
@@ -121,11 +126,12 @@ constexpr Path kAllPaths =
     Path::kReference | Path::kStandardCpp | Path::kNeon | Path::kNeonDotprod;
 #elif RUY_PLATFORM(NEON_32)
 constexpr Path kAllPaths = Path::kReference | Path::kStandardCpp | Path::kNeon;
-#elif RUY_PLATFORM(X86)
-// TODO(b/138433137): kAllPaths should always contain kAvx512 regardless of
-// whether AVX-512 is enabled in the translation unit #including this header.
-constexpr Path kAllPaths =
-    Path::kReference | Path::kStandardCpp | Path::kAvx512;
+#elif RUY_PLATFORM(X86_ENHANCEMENTS)
+// The x86 paths don't depend on the instruction sets enabled in the
+// translation unit #including this header: the ones that the CPU doesn't
+// support are disabled at runtime.
+constexpr Path kAllPaths = Path::kReference | Path::kStandardCpp |
+                           Path::kAvx2 | Path::kAvx512 | Path::kAvxVnni;
 #else
 constexpr Path kAllPaths = Path::kReference | Path::kStandardCpp;
 #endif
@@ -133,9 +139,9 @@ constexpr Path kAllPaths = Path::kReference | Path::kStandardCpp;
 // We don't know how to do runtime dotprod detection outside of linux for now.
 #if RUY_PLATFORM(NEON)
 constexpr Path kAllPaths = Path::kReference | Path::kStandardCpp | Path::kNeon;
-#elif RUY_PLATFORM(X86)
-constexpr Path kAllPaths =
-    Path::kReference | Path::kStandardCpp | Path::kAvx512;
+#elif RUY_PLATFORM(X86_ENHANCEMENTS)
+constexpr Path kAllPaths = Path::kReference | Path::kStandardCpp |
+                           Path::kAvx2 | Path::kAvx512 | Path::kAvxVnni;
 #else
 constexpr Path kAllPaths = Path::kReference | Path::kStandardCpp;
 #endif
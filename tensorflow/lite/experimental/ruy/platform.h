@@ -78,35 +78,42 @@ limitations under the License.
 //
 // NOTE: Consider guarding by !defined(__APPLE__) when removing Linux-only
 // restriction.
-#if defined(RUY_FORCE_ENABLE_X86_ENHANCEMENTS) || \
-    (defined(__clang__) && defined(__linux__))
-#define RUY_USE_X86_ENHANCEMENTS 1
+#if RUY_PLATFORM(X86) && (defined(RUY_FORCE_ENABLE_X86_ENHANCEMENTS) || \
+                          (defined(__clang__) && defined(__linux__)))
+#define RUY_DONOTUSEDIRECTLY_X86_ENHANCEMENTS 1
 #else
-#define RUY_USE_X86_ENHANCEMENTS 0
+#define RUY_DONOTUSEDIRECTLY_X86_ENHANCEMENTS 0
 #endif
 
-// These CPU capabilities will all be true when Skylake, etc, are enabled during
-// compilation.
-//
-// TODO(b/138433137) Select x86 enhancements at runtime rather than via compile
-// options.
-//
-#if RUY_USE_X86_ENHANCEMENTS && RUY_PLATFORM(X86) && defined(__AVX512F__) &&   \
-    defined(__AVX512DQ__) && defined(__AVX512CD__) && defined(__AVX512BW__) && \
-    defined(__AVX512VL__)
+// The x86 paths (Path::kAvx2, Path::kAvx512, Path::kAvxVnni) are declared
+// whenever RUY_PLATFORM(X86_ENHANCEMENTS) is true, and are selected at runtime
+// by Context::GetRuntimeEnabledPaths() depending on the CPU. Their code is only
+// compiled in the translation units built with the corresponding instruction
+// sets enabled, see the copts of the kernel_* and pack_* libraries in BUILD.
+// The capabilities below are those of the current translation unit, and are
+// meant for these files only.
+#if RUY_PLATFORM(X86_ENHANCEMENTS) && defined(__AVX512F__) && \
+    defined(__AVX512DQ__) && defined(__AVX512CD__) &&         \
+    defined(__AVX512BW__) && defined(__AVX512VL__)
 #define RUY_DONOTUSEDIRECTLY_AVX512 1
 #else
 #define RUY_DONOTUSEDIRECTLY_AVX512 0
 #endif
 
-#if RUY_USE_X86_ENHANCEMENTS && RUY_PLATFORM(X86) && defined(__AVX2__)
+#if RUY_PLATFORM(X86_ENHANCEMENTS) && defined(__AVX2__) && defined(__FMA__)
 #define RUY_DONOTUSEDIRECTLY_AVX2 1
 #else
 #define RUY_DONOTUSEDIRECTLY_AVX2 0
 #endif
 
+#if RUY_PLATFORM(AVX512) && defined(__AVX512VNNI__)
+#define RUY_DONOTUSEDIRECTLY_AVX_VNNI 1
+#else
+#define RUY_DONOTUSEDIRECTLY_AVX_VNNI 0
+#endif
+
 // Note does not check for LZCNT or POPCNT.
-#if RUY_USE_X86_ENHANCEMENTS && RUY_PLATFORM(X86) && defined(__SSE4_2__)
+#if RUY_PLATFORM(X86_ENHANCEMENTS) && defined(__SSE4_2__)
 #define RUY_DONOTUSEDIRECTLY_SSE4_2 1
 #else
 #define RUY_DONOTUSEDIRECTLY_SSE4_2 0
@@ -119,6 +126,4 @@ limitations under the License.
 #define RUY_DONOTUSEDIRECTLY_APPLE 0
 #endif
 
-#undef RUY_USE_X86_ENHANCEMENTS
-
 #endif  // TENSORFLOW_LITE_EXPERIMENTAL_RUY_PLATFORM_H_
@@ -0,0 +1,108 @@
+/* Copyright 2020 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/ruy/prepacked_cache.h"
+
+#include <cstdlib>
+
+#include "tensorflow/lite/experimental/ruy/allocator.h"
+#include "tensorflow/lite/experimental/ruy/check_macros.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace ruy {
+
+namespace {
+
+void* AlignedAlloc(std::size_t num_bytes) {
+  constexpr std::size_t kAlignment = detail::AlignedAllocator::kAlignment;
+#ifdef _WIN32
+  return _aligned_malloc(num_bytes, kAlignment);
+#else
+  void* ptr;
+  if (posix_memalign(&ptr, kAlignment, num_bytes)) {
+    return nullptr;
+  }
+  return ptr;
+#endif
+}
+
+void AlignedFree(void* ptr) {
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+}  // namespace
+
+PrepackedCache::~PrepackedCache() {
+  for (auto& key_and_entry : cache_) {
+    FreeEntry(&key_and_entry.second);
+  }
+}
+
+const PrepackedMatrix* PrepackedCache::Find(const PrepackedCacheKey& key) {
+  auto it = cache_.find(key);
+  if (it == cache_.end()) {
+    return nullptr;
+  }
+  it->second.last_use = ++ticks_;
+  return &it->second.matrix;
+}
+
+PrepackedMatrix* PrepackedCache::Insert(const PrepackedCacheKey& key,
+                                        std::size_t data_size,
+                                        std::size_t sums_size) {
+  RUY_DCHECK(cache_.find(key) == cache_.end());
+  const std::size_t bytes = data_size + sums_size;
+  if (bytes > max_buffers_bytes_) {
+    return nullptr;
+  }
+  EvictUntilRoomFor(bytes);
+  Entry& entry = cache_[key];
+  entry.matrix.data_size = data_size;
+  entry.matrix.sums_size = sums_size;
+  entry.matrix.data = AlignedAlloc(data_size);
+  entry.matrix.sums = AlignedAlloc(sums_size);
+  entry.last_use = ++ticks_;
+  buffers_bytes_ += bytes;
+  return &entry.matrix;
+}
+
+void PrepackedCache::EvictUntilRoomFor(std::size_t bytes) {
+  while (!cache_.empty() && buffers_bytes_ + bytes > max_buffers_bytes_) {
+    auto oldest = cache_.begin();
+    for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+      if (it->second.last_use < oldest->second.last_use) {
+        oldest = it;
+      }
+    }
+    FreeEntry(&oldest->second);
+    cache_.erase(oldest);
+  }
+}
+
+void PrepackedCache::FreeEntry(Entry* entry) {
+  buffers_bytes_ -= entry->matrix.data_size + entry->matrix.sums_size;
+  AlignedFree(entry->matrix.data);
+  AlignedFree(entry->matrix.sums);
+  entry->matrix = PrepackedMatrix();
+}
+
+}  // namespace ruy
@@ -0,0 +1,109 @@
+/* Copyright 2020 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RUY_PREPACKED_CACHE_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RUY_PREPACKED_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+
+#include "tensorflow/lite/experimental/ruy/matrix.h"
+
+namespace ruy {
+
+// Identifies the packed form of a source matrix: its data pointer, along with
+// everything else determining the result of packing it.
+struct PrepackedCacheKey {
+  const void* src_data = nullptr;
+  // Values of Side and Path.
+  std::uint8_t side = 0;
+  std::uint8_t path = 0;
+  Layout src_layout;
+  std::int32_t src_zero_point = 0;
+  std::uint8_t src_type_size = 0;
+  bool src_type_is_signed = false;
+  bool src_type_is_floating_point = false;
+
+  bool operator<(const PrepackedCacheKey& other) const {
+    return Tie() < other.Tie();
+  }
+
+ private:
+  std::tuple<const void*, std::uint8_t, std::uint8_t, std::int32_t,
+             std::int32_t, std::int32_t, Order, std::int32_t, std::uint8_t,
+             bool, bool>
+  Tie() const {
+    return std::make_tuple(src_data, side, path, src_layout.rows,
+                           src_layout.cols, src_layout.stride,
+                           src_layout.order, src_zero_point, src_type_size,
+                           src_type_is_signed, src_type_is_floating_point);
+  }
+};
+
+// A cache of packed matrices, used by Mul for the operands flagged as
+// Matrix::cacheable. This saves packing the same constant matrix, typically
+// the weights of a neural network layer, again in each multiplication.
+//
+// Entries are never invalidated: the data of a cacheable matrix must not
+// change as long as the cache lives, i.e. as long as its Context. When the
+// total size of the packed buffers exceeds the limit, the least recently used
+// entries are evicted.
+class PrepackedCache {
+ public:
+  static constexpr std::size_t kDefaultMaxBuffersBytes = 1 << 28;
+
+  explicit PrepackedCache(
+      std::size_t max_buffers_bytes = kDefaultMaxBuffersBytes)
+      : max_buffers_bytes_(max_buffers_bytes) {}
+  ~PrepackedCache();
+
+  PrepackedCache(const PrepackedCache&) = delete;
+  PrepackedCache& operator=(const PrepackedCache&) = delete;
+
+  // Returns the entry for `key` and marks it as the most recently used, or
+  // returns nullptr if there is none.
+  const PrepackedMatrix* Find(const PrepackedCacheKey& key);
+
+  // Inserts an entry for `key`, which must not be in the cache yet, with
+  // buffers of the given sizes for the caller to pack into. Returns nullptr
+  // if the buffers alone exceed the limit.
+  PrepackedMatrix* Insert(const PrepackedCacheKey& key, std::size_t data_size,
+                          std::size_t sums_size);
+
+  int NumEntries() const { return cache_.size(); }
+  std::size_t BuffersBytes() const { return buffers_bytes_; }
+
+ private:
+  struct Entry {
+    PrepackedMatrix matrix;
+    std::uint64_t last_use = 0;
+  };
+
+  // Evicts the least recently used entries until `bytes` more fit within the
+  // limit.
+  void EvictUntilRoomFor(std::size_t bytes);
+  void FreeEntry(Entry* entry);
+
+  const std::size_t max_buffers_bytes_;
+  std::size_t buffers_bytes_ = 0;
+  std::uint64_t ticks_ = 0;
+  std::map<PrepackedCacheKey, Entry> cache_;
+};
+
+}  // namespace ruy
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RUY_PREPACKED_CACHE_H_
@@ -0,0 +1,94 @@
+/* Copyright 2020 Google LLC. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/ruy/prepacked_cache.h"
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+namespace ruy {
+namespace {
+
+PrepackedCacheKey MakeKey(const void* src_data) {
+  PrepackedCacheKey key;
+  key.src_data = src_data;
+  key.src_layout.rows = 16;
+  key.src_layout.cols = 16;
+  key.src_layout.stride = 16;
+  return key;
+}
+
+TEST(PrepackedCacheTest, FindsInsertedEntries) {
+  PrepackedCache cache;
+  const int data[2] = {0};
+  EXPECT_EQ(cache.Find(MakeKey(&data[0])), nullptr);
+  PrepackedMatrix* inserted = cache.Insert(MakeKey(&data[0]), 256, 64);
+  ASSERT_NE(inserted, nullptr);
+  // If this is bogus memory, ASan will cause this test to fail.
+  memset(inserted->data, 0, inserted->data_size);
+  memset(inserted->sums, 0, inserted->sums_size);
+  EXPECT_EQ(cache.Find(MakeKey(&data[0])), inserted);
+  EXPECT_EQ(cache.Find(MakeKey(&data[1])), nullptr);
+  EXPECT_EQ(cache.NumEntries(), 1);
+  EXPECT_EQ(cache.BuffersBytes(), 320);
+}
+
+TEST(PrepackedCacheTest, TellsApartKeysOfTheSameData) {
+  PrepackedCache cache;
+  const int data = 0;
+  PrepackedCacheKey key = MakeKey(&data);
+  ASSERT_NE(cache.Insert(key, 256, 64), nullptr);
+  key.side = 1;
+  EXPECT_EQ(cache.Find(key), nullptr);
+  key = MakeKey(&data);
+  key.src_layout.order = Order::kRowMajor;
+  EXPECT_EQ(cache.Find(key), nullptr);
+  key = MakeKey(&data);
+  key.src_zero_point = 128;
+  EXPECT_EQ(cache.Find(key), nullptr);
+}
+
+TEST(PrepackedCacheTest, EvictsLeastRecentlyUsed) {
+  PrepackedCache cache(/*max_buffers_bytes=*/1000);
+  const int data[3] = {0};
+  ASSERT_NE(cache.Insert(MakeKey(&data[0]), 400, 0), nullptr);
+  ASSERT_NE(cache.Insert(MakeKey(&data[1]), 400, 0), nullptr);
+  // Using the first entry makes the second one the least recently used.
+  EXPECT_NE(cache.Find(MakeKey(&data[0])), nullptr);
+  ASSERT_NE(cache.Insert(MakeKey(&data[2]), 400, 0), nullptr);
+  EXPECT_NE(cache.Find(MakeKey(&data[0])), nullptr);
+  EXPECT_EQ(cache.Find(MakeKey(&data[1])), nullptr);
+  EXPECT_NE(cache.Find(MakeKey(&data[2])), nullptr);
+  EXPECT_EQ(cache.NumEntries(), 2);
+  EXPECT_EQ(cache.BuffersBytes(), 800);
+}
+
+TEST(PrepackedCacheTest, RejectsEntriesLargerThanTheLimit) {
+  PrepackedCache cache(/*max_buffers_bytes=*/1000);
+  const int data[2] = {0};
+  ASSERT_NE(cache.Insert(MakeKey(&data[0]), 400, 0), nullptr);
+  EXPECT_EQ(cache.Insert(MakeKey(&data[1]), 1000, 4), nullptr);
+  EXPECT_NE(cache.Find(MakeKey(&data[0])), nullptr);
+  EXPECT_EQ(cache.NumEntries(), 1);
+}
+
+}  // namespace
+}  // namespace ruy
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -24,11 +24,37 @@ limitations under the License.
 #include <mutex>               // NOLINT(build/c++11)
 #include <thread>              // NOLINT(build/c++11)
 
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 #include "tensorflow/lite/experimental/ruy/check_macros.h"
 #include "tensorflow/lite/experimental/ruy/wait.h"
 
 namespace ruy {
 
+namespace {
+
+// Restricts the calling thread to the CPUs set in `mask`, or allows it to
+// run on any CPU if `mask` is zero. Failures are ignored: affinity is only a
+// performance hint.
+void SetCurrentThreadAffinity(std::uint64_t mask) {
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!mask || (cpu < 64 && (mask & (std::uint64_t{1} << cpu)))) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+  sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#else
+  (void)mask;
+#endif
+}
+
+}  // namespace
+
 // A worker thread.
 class Thread {
  public:
@@ -39,10 +65,14 @@ class Thread {
     ExitAsSoonAsPossible  // Should exit at earliest convenience.
   };
 
-  explicit Thread(BlockingCounter* counter_to_decrement_when_ready)
+  Thread(BlockingCounter* counter_to_decrement_when_ready,
+         const std::atomic<Duration>* spin_duration)
       : task_(nullptr),
+        affinity_mask_(0),
+        applied_affinity_mask_(0),
         state_(State::Startup),
-        counter_to_decrement_when_ready_(counter_to_decrement_when_ready) {
+        counter_to_decrement_when_ready_(counter_to_decrement_when_ready),
+        spin_duration_(spin_duration) {
     thread_.reset(new std::thread(ThreadFunc, this));
   }
 
@@ -55,9 +85,11 @@ class Thread {
   // or the master thread; however, not all state transitions are legal,
   // which is guarded by assertions.
   //
-  // The Task argument is to be used only with new_state==HasWork.
-  // It specifies the Task being handed to this Thread.
-  void ChangeState(State new_state, Task* task = nullptr) {
+  // The Task and affinity_mask arguments are to be used only with
+  // new_state==HasWork. They specify the Task being handed to this Thread
+  // and the CPUs it should run on.
+  void ChangeState(State new_state, Task* task = nullptr,
+                   std::uint64_t affinity_mask = 0) {
     state_mutex_.lock();
     State old_state = state_.load(std::memory_order_relaxed);
     RUY_DCHECK(old_state != new_state);
@@ -79,7 +111,12 @@ class Thread {
     switch (new_state) {
       case State::Ready:
         if (task_) {
-          // Doing work is part of reverting to 'ready' state.
+          // Doing work is part of reverting to 'ready' state. This runs on
+          // the worker thread itself, so this is where its affinity changes.
+          if (affinity_mask_ != applied_affinity_mask_) {
+            SetCurrentThreadAffinity(affinity_mask_);
+            applied_affinity_mask_ = affinity_mask_;
+          }
           task_->Run();
           task_ = nullptr;
         }
@@ -87,6 +124,7 @@ class Thread {
       case State::HasWork:
         RUY_DCHECK(!task_);
         task_ = task;
+        affinity_mask_ = affinity_mask;
         break;
       default:
         break;
@@ -102,7 +140,9 @@ class Thread {
   static void ThreadFunc(Thread* arg) { arg->ThreadFuncImpl(); }
 
   // Called by the master thead to give this thread work to do.
-  void StartWork(Task* task) { ChangeState(State::HasWork, task); }
+  void StartWork(Task* task, std::uint64_t affinity_mask) {
+    ChangeState(State::HasWork, task, affinity_mask);
+  }
 
  private:
   // Thread entry point.
@@ -116,7 +156,8 @@ class Thread {
       const auto& condition = [this]() {
         return state_.load(std::memory_order_acquire) != State::Ready;
       };
-      WaitUntil(condition, &state_cond_, &state_mutex_);
+      WaitUntil(condition, spin_duration_->load(std::memory_order_relaxed),
+                &state_cond_, &state_mutex_);
 
       // Act on new state.
       switch (state_.load(std::memory_order_acquire)) {
@@ -138,6 +179,11 @@ class Thread {
   // The task to be worked on.
   Task* task_;
 
+  // The CPU affinity mask requested for task_, and the one last applied to
+  // this thread. See ThreadPool::set_cpu_affinity_masks.
+  std::uint64_t affinity_mask_;
+  std::uint64_t applied_affinity_mask_;
+
   // The condition variable and mutex guarding state changes.
   std::condition_variable state_cond_;
   std::mutex state_mutex_;
@@ -151,8 +197,28 @@ class Thread {
   // pointer to the master's thread BlockingCounter object, to notify the
   // master thread of when this thread switches to the 'Ready' state.
   BlockingCounter* const counter_to_decrement_when_ready_;
+
+  // The spin-waiting duration, owned by the ThreadPool.
+  const std::atomic<Duration>* const spin_duration_;
 };
 
+ThreadPool::ThreadPool() : spin_duration_(DefaultSpinDuration()) {}
+
+void ThreadPool::set_spin_milliseconds(float milliseconds) {
+  spin_duration_.store(DurationFromMilliseconds(milliseconds),
+                       std::memory_order_relaxed);
+}
+
+float ThreadPool::spin_milliseconds() const {
+  return 1000.f *
+         ToFloatSeconds(spin_duration_.load(std::memory_order_relaxed));
+}
+
+void ThreadPool::set_cpu_affinity_masks(
+    const std::vector<std::uint64_t>& masks) {
+  cpu_affinity_masks_ = masks;
+}
+
 void ThreadPool::ExecuteImpl(int task_count, int stride, Task* tasks) {
   RUY_DCHECK_GE(task_count, 1);
 
@@ -167,14 +233,20 @@ void ThreadPool::ExecuteImpl(int task_count, int stride, Task* tasks) {
   counter_to_decrement_when_ready_.Reset(task_count - 1);
   for (int i = 1; i < task_count; i++) {
     auto task_address = reinterpret_cast<std::uintptr_t>(tasks) + i * stride;
-    threads_[i - 1]->StartWork(reinterpret_cast<Task*>(task_address));
+    const std::uint64_t affinity_mask =
+        i - 1 < static_cast<int>(cpu_affinity_masks_.size())
+            ? cpu_affinity_masks_[i - 1]
+            : 0;
+    threads_[i - 1]->StartWork(reinterpret_cast<Task*>(task_address),
+                               affinity_mask);
   }
 
   // Execute task #0 immediately on the current thread.
   (tasks + 0)->Run();
 
   // Wait for the threads submitted above to finish.
-  counter_to_decrement_when_ready_.Wait();
+  counter_to_decrement_when_ready_.Wait(
+      spin_duration_.load(std::memory_order_relaxed));
 }
 
 // Ensures that the pool has at least the given count of threads.
@@ -186,9 +258,11 @@ void ThreadPool::CreateThreads(int threads_count) {
   }
   counter_to_decrement_when_ready_.Reset(threads_count - threads_.size());
   while (threads_.size() < threads_count) {
-    threads_.push_back(new Thread(&counter_to_decrement_when_ready_));
+    threads_.push_back(
+        new Thread(&counter_to_decrement_when_ready_, &spin_duration_));
   }
-  counter_to_decrement_when_ready_.Wait();
+  counter_to_decrement_when_ready_.Wait(
+      spin_duration_.load(std::memory_order_relaxed));
 }
 
 ThreadPool::~ThreadPool() {
@@ -19,9 +19,12 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_RUY_THREAD_POOL_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_RUY_THREAD_POOL_H_
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "tensorflow/lite/experimental/ruy/blocking_counter.h"
+#include "tensorflow/lite/experimental/ruy/time.h"
 
 namespace ruy {
 
@@ -53,7 +56,7 @@ class Thread;
 // implementation --- see ruy's TrMulTask.
 class ThreadPool {
  public:
-  ThreadPool() {}
+  ThreadPool();
 
   ~ThreadPool();
 
@@ -76,6 +79,30 @@ class ThreadPool {
     ExecuteImpl(task_count, sizeof(TaskType), static_cast<Task*>(tasks));
   }
 
+  // Sets how long threads spin-wait before falling back to passively waiting
+  // on a condition variable: worker threads waiting for new work, and the
+  // main thread waiting for the worker threads to finish. Spinning lets
+  // back-to-back matrix multiplications start without waiting to be scheduled
+  // again by the OS, at the cost of burning CPU cycles, and battery, between
+  // them. Zero disables spinning. The default is DefaultSpinDuration().
+  void set_spin_milliseconds(float milliseconds);
+  float spin_milliseconds() const;
+
+  // Sets the CPUs that each worker thread may run on: the i-th mask is a
+  // bitmask of the CPUs allowed for the i-th worker thread, which runs task
+  // #(i+1) of Execute. A zero or missing mask leaves a thread free to run on
+  // any CPU. For example, on a big.LITTLE SoC, this can keep the worker
+  // threads on the big cores.
+  //
+  // Masks are applied by each thread itself when it next runs a task. This is
+  // only implemented on Linux and Android and is best-effort: a mask that
+  // the OS rejects, e.g. one with only offline CPUs, is ignored. The main
+  // thread's affinity is left for the caller to manage.
+  void set_cpu_affinity_masks(const std::vector<std::uint64_t>& masks);
+  const std::vector<std::uint64_t>& cpu_affinity_masks() const {
+    return cpu_affinity_masks_;
+  }
+
  private:
   // Ensures that the pool has at least the given count of threads.
   // If any new thread has to be created, this function waits for it to
@@ -95,6 +122,13 @@ class ThreadPool {
 
   // The BlockingCounter used to wait for the threads.
   BlockingCounter counter_to_decrement_when_ready_;
+
+  // See set_spin_milliseconds. Atomic as worker threads read it while
+  // waiting for work, which may be concurrent with setting it.
+  std::atomic<Duration> spin_duration_;
+
+  // See set_cpu_affinity_masks.
+  std::vector<std::uint64_t> cpu_affinity_masks_;
 };
 
 }  // namespace ruy
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/ruy/trmul.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -252,6 +254,29 @@ int GetThreadCount(Context* context, int rows, int cols, int depth) {
   return clamp(guess, 1, context->max_num_threads);
 }
 
+// Returns the minimum number of blocks to divide the destination matrix into.
+// Threads pick blocks dynamically, so each thread does a share of the work
+// proportional to its speed as long as the slowest thread's share amounts to
+// a few blocks: otherwise, the faster threads end up idle, waiting for the
+// slowest one to finish its last block.
+int GetMinNumBlocks(const Context* context, int thread_count) {
+  const std::vector<float>& speeds = context->thread_relative_speeds;
+  if (speeds.empty() || thread_count == 1) {
+    return 1;
+  }
+  static constexpr int kMinBlocksPerSlowestThread = 2;
+  float total_speed = 0;
+  float slowest_speed = 0;
+  for (int i = 0; i < thread_count; i++) {
+    const float speed = i < static_cast<int>(speeds.size()) ? speeds[i] : 1.f;
+    RUY_DCHECK_GT(speed, 0);
+    total_speed += speed;
+    slowest_speed = i == 0 ? speed : std::min(slowest_speed, speed);
+  }
+  return static_cast<int>(
+      std::ceil(kMinBlocksPerSlowestThread * total_speed / slowest_speed));
+}
+
 LoopStructure GetLoopStructure(int thread_count, int rows, int cols, int depth,
                                int cache_friendly_traversal_threshold) {
   if (thread_count == 1 &&
@@ -320,7 +345,8 @@ void TrMul(TrMulParams* params, Context* context) {
   MakeBlockMap(packed_lhs.layout.cols, packed_rhs.layout.cols, depth,
                packed_lhs.layout.kernel.cols, packed_rhs.layout.kernel.cols,
                packed_lhs.data_type.size, packed_rhs.data_type.size,
-               params->cache_friendly_traversal_threshold, &block_map);
+               params->cache_friendly_traversal_threshold,
+               GetMinNumBlocks(context, thread_count), &block_map);
 
   // Initialize per-thread state.
   thread_count = clamp(thread_count, 1, NumBlocks(block_map));
@@ -40,17 +40,11 @@ void WaitUntil(const std::function<bool()>& condition,
   condvar->wait(lock, condition);
 }
 
-void WaitUntil(const std::function<bool()>& condition,
-               std::condition_variable* condvar, std::mutex* mutex) {
+Duration DefaultSpinDuration() {
   // This value was empirically derived with some microbenchmark, we don't have
-  // high confidence in it.
-  //
-  // TODO(b/135595069): make this value configurable at runtime.
-  // I almost wanted to file another bug to ask for experimenting in a more
-  // principled way to tune this value better, but this would have to be tuned
-  // on real end-to-end applications and we'd expect different applications to
-  // require different tunings. So the more important point is the need for
-  // this to be controllable by the application.
+  // high confidence in it. Applications can override it with
+  // ThreadPool::set_spin_milliseconds(), as different applications are
+  // expected to require different tunings.
   //
   // That this value means that we may be sleeping substantially longer
   // than a scheduler timeslice's duration is not necessarily surprising. The
@@ -62,9 +56,13 @@ void WaitUntil(const std::function<bool()>& condition,
   // application, after having finished a GEMM, we might do unrelated work for
   // a little while, then start on a new GEMM. In that case the wait interval
   // may be a little longer. There may also not be another GEMM for a long time,
-  // in which case we'll end up passively waiting below.
-  const Duration spin_duration = DurationFromMilliseconds(2);
-  WaitUntil(condition, spin_duration, condvar, mutex);
+  // in which case WaitUntil ends up waiting passively.
+  return DurationFromMilliseconds(2);
+}
+
+void WaitUntil(const std::function<bool()>& condition,
+               std::condition_variable* condvar, std::mutex* mutex) {
+  WaitUntil(condition, DefaultSpinDuration(), condvar, mutex);
 }
 
 }  // namespace ruy
@@ -64,8 +64,11 @@ void WaitUntil(const std::function<bool()>& condition,
                const Duration& spin_duration, std::condition_variable* condvar,
                std::mutex* mutex);
 
-// Convenience overload using a default `spin_duration`.
-// TODO(benoitjacob): let this be controlled from the ruy API.
+// Returns the `spin_duration` used by default, e.g. by ThreadPool unless
+// overridden by ThreadPool::set_spin_milliseconds().
+Duration DefaultSpinDuration();
+
+// Convenience overload using DefaultSpinDuration().
 void WaitUntil(const std::function<bool()>& condition,
                std::condition_variable* condvar, std::mutex* mutex);
 
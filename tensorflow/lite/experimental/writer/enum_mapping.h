@@ -92,6 +92,10 @@ FullyConnectedOptionsWeightsFormatToSchema(
       return FullyConnectedOptionsWeightsFormat_DEFAULT;
     case kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8:
       return FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8;
+    case kTfLiteFullyConnectedWeightsFormatSparse1x4:
+      return FullyConnectedOptionsWeightsFormat_SPARSE1x4;
+    case kTfLiteFullyConnectedWeightsFormatPackedInt4:
+      return FullyConnectedOptionsWeightsFormat_PACKED_INT4;
   }
 }
 
@@ -53,6 +53,11 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns one past the index of the last node that may run concurrently
+  // with node `index`. Nodes that may run concurrently have consecutive
+  // indices. By default, nodes run one at a time.
+  virtual size_t concurrent_nodes_end(size_t index) const { return index + 1; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
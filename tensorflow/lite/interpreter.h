@@ -356,6 +356,13 @@ class Interpreter {
   /// Set the number of threads available to the interpreter.
   void SetNumThreads(int num_threads);
 
+  /// Set the maximum number of independent nodes, e.g. the branches of a
+  /// multi-tower model, that run concurrently. Defaults to 1. Takes effect on
+  /// the next AllocateTensors(); see Subgraph::SetNumInterOpThreads for the
+  /// nodes that always run alone.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
   /// Allow float16 precision for FP32 calculation when possible.
   /// default: not allow.
   /// WARNING: This is an experimental API and subject to change.
@@ -413,6 +420,17 @@ class Interpreter {
                                TfLiteBufferHandle buffer_handle,
                                TfLiteDelegate* delegate);
 
+  /// Backs the input or output tensor `tensor_index` with `allocation`, a
+  /// buffer owned by the caller, e.g. a camera frame, so that data doesn't
+  /// have to be copied in or out. The data must be aligned to 64 bytes and
+  /// remain valid until the tensor is bound to another buffer or the
+  /// interpreter is destroyed. The first binding of a tensor requires
+  /// AllocateTensors() to be called again; binding it again afterwards only
+  /// swaps the buffer. See Subgraph::SetCustomAllocationForTensor.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetCustomAllocationForTensor(
+      int tensor_index, const TfLiteCustomAllocation& allocation);
+
   /// Get the delegate buffer handle, and the delegate which can process the
   /// buffer handle.
   /// WARNING: This is an experimental API and subject to change.
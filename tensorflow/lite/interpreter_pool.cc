@@ -0,0 +1,44 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+namespace tflite {
+
+std::unique_ptr<InterpreterPool> InterpreterPool::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    int num_interpreters, int num_threads) {
+  if (num_interpreters < 1) {
+    model.error_reporter()->Report(
+        "An interpreter pool needs at least one interpreter, got %d.",
+        num_interpreters);
+    return nullptr;
+  }
+  std::unique_ptr<InterpreterPool> pool(new InterpreterPool);
+  InterpreterBuilder builder(model, op_resolver);
+  for (int i = 0; i < num_interpreters; ++i) {
+    std::unique_ptr<Interpreter> interpreter;
+    if (builder(&interpreter, num_threads) != kTfLiteOk) {
+      return nullptr;
+    }
+    // The cache must be in place before the ops are prepared, which is when
+    // they decide where to keep the weights they derive.
+    interpreter->SetExternalContext(kTfLiteSharedWeightsContext,
+                                    &pool->shared_weights_);
+    pool->interpreters_.push_back(std::move(interpreter));
+  }
+  return pool;
+}
+
+}  // namespace tflite
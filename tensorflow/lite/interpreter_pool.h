@@ -0,0 +1,76 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_INTERPRETER_POOL_H_
+#define TENSORFLOW_LITE_INTERPRETER_POOL_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/op_resolver.h"
+#include "tensorflow/lite/shared_weights_cache.h"
+
+namespace tflite {
+
+/// A set of interpreters for the same model, meant to be invoked concurrently,
+/// e.g. one per serving thread. Besides the model itself, the interpreters
+/// share the weights that kernels derive from the model's read-only tensors
+/// through a SharedWeightsCache. Each interpreter still has its own tensor
+/// arenas and its own cpu backend context, so different interpreters may be
+/// invoked at the same time, but a single interpreter may not.
+///
+/// Example:
+///
+/// auto model = tflite::FlatBufferModel::BuildFromFile(filename);
+/// tflite::ops::builtin::BuiltinOpResolver resolver;
+/// auto pool = tflite::InterpreterPool::Create(*model, resolver,
+///                                             /*num_interpreters=*/16);
+/// // On serving thread i:
+/// tflite::Interpreter* interpreter = pool->interpreter(i);
+/// interpreter->AllocateTensors();
+/// ...
+class InterpreterPool {
+ public:
+  /// Builds `num_interpreters` interpreters for `model`, each using
+  /// `num_threads` threads as in InterpreterBuilder. Returns nullptr if any
+  /// of them can't be built. `model` must outlive the returned pool; the
+  /// `op_resolver` only needs to live during the call.
+  static std::unique_ptr<InterpreterPool> Create(const FlatBufferModel& model,
+                                                 const OpResolver& op_resolver,
+                                                 int num_interpreters,
+                                                 int num_threads = -1);
+
+  InterpreterPool(const InterpreterPool&) = delete;
+  InterpreterPool& operator=(const InterpreterPool&) = delete;
+
+  int size() const { return interpreters_.size(); }
+
+  /// Returns the `index`th interpreter, which remains owned by the pool.
+  Interpreter* interpreter(int index) { return interpreters_[index].get(); }
+
+  const SharedWeightsCache& shared_weights() const { return shared_weights_; }
+
+ private:
+  InterpreterPool() = default;
+
+  // Declared before the interpreters so that it outlives them.
+  SharedWeightsCache shared_weights_;
+  std::vector<std::unique_ptr<Interpreter>> interpreters_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTERPRETER_POOL_H_
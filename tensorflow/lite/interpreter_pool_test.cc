@@ -0,0 +1,115 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+TEST(SharedWeightsCacheTest, CreatesEachEntryOnce) {
+  SharedWeightsCache cache;
+  const float source[] = {1.f, 2.f};
+  int num_fills = 0;
+  auto fill = [&num_fills](void* data) {
+    ++num_fills;
+    static_cast<float*>(data)[0] = 3.f;
+  };
+
+  const void* data = cache.GetOrCreate(
+      source, SharedWeightsCache::kConvHwcnWeights, sizeof(float), fill);
+  EXPECT_EQ(static_cast<const float*>(data)[0], 3.f);
+  EXPECT_EQ(cache.GetOrCreate(source, SharedWeightsCache::kConvHwcnWeights,
+                              sizeof(float), fill),
+            data);
+  EXPECT_EQ(num_fills, 1);
+
+  // A different source gets its own entry.
+  EXPECT_NE(cache.GetOrCreate(source + 1, SharedWeightsCache::kConvHwcnWeights,
+                              sizeof(float), fill),
+            data);
+  EXPECT_EQ(num_fills, 2);
+  EXPECT_EQ(cache.size_in_bytes(), 2 * sizeof(float));
+}
+
+TEST(InterpreterPoolTest, RejectsEmptyPool) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  EXPECT_EQ(InterpreterPool::Create(*model, resolver, 0), nullptr);
+}
+
+TEST(InterpreterPoolTest, InvokesInterpretersConcurrently) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  auto pool = InterpreterPool::Create(*model, resolver, 2);
+  ASSERT_NE(pool, nullptr);
+  ASSERT_EQ(pool->size(), 2);
+  EXPECT_NE(pool->interpreter(0), pool->interpreter(1));
+
+  for (int i = 0; i < pool->size(); ++i) {
+    Interpreter* interpreter = pool->interpreter(i);
+    EXPECT_EQ(SharedWeightsCache::GetFromContext(
+                  interpreter->primary_subgraph().context()),
+              &pool->shared_weights());
+    ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+    // The arenas are not shared.
+    EXPECT_NE(interpreter->typed_output_tensor<float>(0),
+              pool->interpreter(1 - i)->typed_output_tensor<float>(0));
+  }
+
+  // The model computes x = a + b + c and y = d + b + c.
+  std::vector<std::thread> threads;
+  std::vector<TfLiteStatus> statuses(pool->size(), kTfLiteError);
+  for (int i = 0; i < pool->size(); ++i) {
+    Interpreter* interpreter = pool->interpreter(i);
+    for (int input = 0; input < 4; ++input) {
+      TfLiteTensor* tensor = interpreter->input_tensor(input);
+      for (int j = 0; j < tensor->bytes / sizeof(float); ++j) {
+        tensor->data.f[j] = i + input;
+      }
+    }
+    threads.emplace_back(
+        [interpreter, &statuses, i] { statuses[i] = interpreter->Invoke(); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < pool->size(); ++i) {
+    EXPECT_EQ(statuses[i], kTfLiteOk);
+    EXPECT_EQ(pool->interpreter(i)->typed_output_tensor<float>(0)[0],
+              3 * i + 3);
+    EXPECT_EQ(pool->interpreter(i)->typed_output_tensor<float>(1)[0],
+              3 * i + 6);
+  }
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
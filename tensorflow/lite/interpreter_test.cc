@@ -58,6 +58,7 @@ TfLiteRegistration* Register_NEG();
 }  // namespace ops
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::IsEmpty;
 
 // Make an interpreter that has no tensors and no nodes
@@ -709,6 +710,140 @@ TEST(BasicInterpreter, ThreeStepAllocate) {
   ASSERT_EQ(interpreter.tensor(4)->data.i32[0], 15);
 }
 
+TEST(BasicInterpreter, InterOpParallelism) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({4}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quantized),
+              kTfLiteOk);
+  }
+
+  TfLiteRegistration reg_add_one = {nullptr, nullptr, nullptr, nullptr};
+  reg_add_one.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    output->data.f[0] = input->data.f[0] + 1;
+    return kTfLiteOk;
+  };
+  TfLiteRegistration reg_sum = {nullptr, nullptr, nullptr, nullptr};
+  reg_sum.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* a = &context->tensors[node->inputs->data[0]];
+    const TfLiteTensor* b = &context->tensors[node->inputs->data[1]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    output->data.f[0] = a->data.f[0] + b->data.f[0];
+    return kTfLiteOk;
+  };
+
+  // Node 2 doesn't depend on nodes 0 and 1.
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({2, 3}, {4}, nullptr, 0,
+                                              nullptr, &reg_sum),
+            kTfLiteOk);
+
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // Nodes 0 and 2 run first, concurrently.
+  EXPECT_THAT(interpreter.execution_plan(), ElementsAre(0, 2, 1, 3));
+  EXPECT_NE(interpreter.tensor(1)->data.raw, interpreter.tensor(3)->data.raw);
+
+  // The first invocation is sequential, the next ones are concurrent.
+  for (int i = 0; i < 3; ++i) {
+    interpreter.typed_tensor<float>(0)[0] = i;
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    EXPECT_EQ(interpreter.typed_tensor<float>(4)[0], 2 * i + 3);
+  }
+}
+
+TEST(BasicInterpreter, CustomAllocation) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {4}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg_add_one = {nullptr, nullptr, nullptr, nullptr};
+  reg_add_one.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg_add_one.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < input->dims->data[0]; ++i) {
+      output->data.f[i] = input->data.f[i] + 1;
+    }
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr,
+                                              &reg_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  alignas(64) float input[16];
+  alignas(64) float output[4];
+  alignas(64) float other_output[4];
+  // Only aligned buffers large enough for inputs and outputs can be bound.
+  EXPECT_EQ(interpreter.SetCustomAllocationForTensor(1, {input, sizeof(input)}),
+            kTfLiteError);
+  EXPECT_EQ(interpreter.SetCustomAllocationForTensor(0, {input + 1, 12}),
+            kTfLiteError);
+  EXPECT_EQ(interpreter.SetCustomAllocationForTensor(0, {input, 8}),
+            kTfLiteError);
+
+  ASSERT_EQ(interpreter.SetCustomAllocationForTensor(0, {input, sizeof(input)}),
+            kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.SetCustomAllocationForTensor(2, {output, sizeof(output)}),
+      kTfLiteOk);
+  // The tensors must be moved out of the arena first.
+  EXPECT_EQ(interpreter.Invoke(), kTfLiteError);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.typed_input_tensor<float>(0), input);
+  EXPECT_EQ(interpreter.typed_output_tensor<float>(0), output);
+
+  for (int i = 0; i < 4; ++i) {
+    input[i] = i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_THAT(output, ElementsAre(2, 3, 4, 5));
+
+  // Swapping the buffer of a bound tensor takes effect right away.
+  ASSERT_EQ(interpreter.SetCustomAllocationForTensor(
+                2, {other_output, sizeof(other_output)}),
+            kTfLiteOk);
+  input[0] = 10;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_THAT(other_output, ElementsAre(12, 3, 4, 5));
+  EXPECT_THAT(output, ElementsAre(2, 3, 4, 5));
+
+  // The input buffer has room for 16 values, but the output one doesn't.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {16}), kTfLiteOk);
+  EXPECT_EQ(interpreter.typed_input_tensor<float>(0), input);
+  EXPECT_EQ(interpreter.AllocateTensors(), kTfLiteError);
+  EXPECT_EQ(interpreter.ResizeInputTensor(0, {32}), kTfLiteError);
+}
+
 TEST(BasicInterpreter, AllocateTwice) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
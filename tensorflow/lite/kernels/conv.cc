@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/op_macros.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/shared_weights_cache.h"
 
 namespace tflite {
 namespace ops {
@@ -91,7 +92,11 @@ struct OpData {
   int32_t input_quantized_index;
   int32_t scaling_factors_index;
   bool need_hwcn_weights;
+  // Whether the transposed weights live in the interpreter's
+  // SharedWeightsCache rather than in a temporary tensor.
+  bool use_shared_hwcn_weights;
   bool have_weights_been_transposed;
+  const float* shared_hwcn_weights = nullptr;
   bool need_im2col;
 
   bool supports_multithreaded_kernel;
@@ -126,11 +131,10 @@ void Free(TfLiteContext* context, void* buffer) {
 // Naive implementation of transpose for floats. Could be optimized to be more
 // cache friendly, but for now it's a one-time cost on first run, and we would
 // prefer to remove the need to do this at all eventually.
-void TransposeFloatTensor(TfLiteTensor* input, TfLiteTensor* output) {
-  const int rows = output->dims->data[1];
-  const int cols = output->dims->data[0];
+void TransposeFloatTensor(const TfLiteTensor* input, float* output_data) {
+  const int rows = input->dims->data[0];
+  const int cols = NumElements(input) / rows;
   const float* input_data = GetTensorData<float>(input);
-  float* output_data = GetTensorData<float>(output);
   for (int i = 0; i < rows; ++i) {
     for (int j = 0; j < cols; ++j) {
       const float in_value = input_data[i * cols + j];
@@ -166,6 +170,12 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   // we're running with that data type.
   data->need_hwcn_weights = (input->type == kTfLiteFloat32 &&
                              data->supports_multithreaded_kernel && !is_hybrid);
+  // Read-only filters are the same in every interpreter built from the same
+  // model, so they are transposed once into the shared weights cache when the
+  // interpreter has one.
+  data->use_shared_hwcn_weights =
+      data->need_hwcn_weights && filter->allocation_type == kTfLiteMmapRo &&
+      SharedWeightsCache::GetFromContext(context) != nullptr;
 
   // We don't always need to allocate im2col. It is only used in some versions
   // of the optimized Conv. This test just mimics something that happens inside
@@ -185,7 +195,7 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
     }
     ++temporaries_count;
   }
-  if (data->need_hwcn_weights) {
+  if (data->need_hwcn_weights && !data->use_shared_hwcn_weights) {
     data->hwcn_weights_index = temporaries_count;
     if (data->hwcn_weights_id == kTensorNotAllocated) {
       context->AddTensors(context, 1, &data->hwcn_weights_id);
@@ -346,7 +356,7 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     if (im2col_status != kTfLiteOk) return im2col_status;
   }
 
-  if (data->need_hwcn_weights) {
+  if (data->need_hwcn_weights && !data->use_shared_hwcn_weights) {
     node->temporaries->data[data->hwcn_weights_index] = data->hwcn_weights_id;
     TfLiteIntArray* hwcn_weights_size = TfLiteIntArrayCreate(2);
 
@@ -366,7 +376,9 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     auto hwcn_weights_status =
         context->ResizeTensor(context, hwcn_weights, hwcn_weights_size);
     if (hwcn_weights_status != kTfLiteOk) return hwcn_weights_status;
+  }
 
+  if (data->need_hwcn_weights) {
     // TODO(petewarden): If Resize() is called when the size hasn't actually
     // changed, this will do extra redundant work.
     data->have_weights_been_transposed = false;
@@ -573,7 +585,9 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
       TFLITE_DCHECK(false);
 #else
       const float* filter_data;
-      if (data->need_hwcn_weights) {
+      if (data->use_shared_hwcn_weights) {
+        filter_data = data->shared_hwcn_weights;
+      } else if (data->need_hwcn_weights) {
         filter_data = GetTensorData<float>(hwcn_weights);
       } else {
         filter_data = GetTensorData<float>(filter);
@@ -680,12 +694,22 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           ? &context->tensors[node->temporaries->data[data->im2col_index]]
           : nullptr;
   TfLiteTensor* hwcn_weights =
-      data->need_hwcn_weights
+      data->need_hwcn_weights && !data->use_shared_hwcn_weights
           ? &context->tensors[node->temporaries->data[data->hwcn_weights_index]]
           : nullptr;
 
   if (data->need_hwcn_weights && !data->have_weights_been_transposed) {
-    TransposeFloatTensor(filter, hwcn_weights);
+    if (data->use_shared_hwcn_weights) {
+      data->shared_hwcn_weights = static_cast<const float*>(
+          SharedWeightsCache::GetFromContext(context)->GetOrCreate(
+              filter->data.raw, SharedWeightsCache::kConvHwcnWeights,
+              filter->bytes, [filter](void* hwcn_weights_data) {
+                TransposeFloatTensor(filter,
+                                     static_cast<float*>(hwcn_weights_data));
+              }));
+    } else {
+      TransposeFloatTensor(filter, GetTensorData<float>(hwcn_weights));
+    }
     data->have_weights_been_transposed = true;
   }
 
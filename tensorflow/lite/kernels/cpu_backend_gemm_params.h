@@ -47,6 +47,10 @@ struct MatrixParams {
   // The zero_point, i.e. which Scalar value is to be interpreted as zero.
   // When Scalar is floating-point, this must be 0.
   Scalar zero_point = 0;
+  // Whether the matrix data, at this address, is constant for the lifetime of
+  // the CpuBackendContext, e.g. the weights of a fully-connected layer. The
+  // ruy back-end then packs it once and keeps the packed form in a cache.
+  bool cacheable = false;
 };
 
 // Enumeration of broad categories of Gemm.
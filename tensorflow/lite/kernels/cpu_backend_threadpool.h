@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_THREADPOOL_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_THREADPOOL_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
@@ -54,6 +58,56 @@ void Execute(int tasks_count, TaskType* tasks,
 
 #endif
 
+// Minimum amount of work, in number of elements processed, worth handing to
+// one more thread.
+constexpr int kMinShardCost = 1 << 16;
+
+template <typename ShardFn>
+class ShardTask : public Task {
+ public:
+  ShardTask(const ShardFn& shard_fn, int start, int end)
+      : shard_fn_(shard_fn), start_(start), end_(end) {}
+
+  void Run() override { shard_fn_(start_, end_); }
+
+ private:
+  const ShardFn& shard_fn_;
+  int start_;
+  int end_;
+};
+
+// Splits the rows [0, num_rows) of an op into contiguous shards and runs
+// `shard_fn(start, end)` on each of them, in parallel on the threads of
+// `cpu_backend_context`. `row_cost` is the rough number of elements processed
+// per row: no shard gets less than kMinShardCost of work, so small ops run
+// entirely on the calling thread.
+template <typename ShardFn>
+void ExecuteSharded(int num_rows, int row_cost,
+                    CpuBackendContext* cpu_backend_context,
+                    const ShardFn& shard_fn) {
+  const int64_t cost = static_cast<int64_t>(num_rows) * row_cost;
+  const int shard_count = static_cast<int>(
+      std::min<int64_t>({num_rows, cost / kMinShardCost,
+                         cpu_backend_context->max_num_threads()}));
+  if (shard_count <= 1) {
+    shard_fn(0, num_rows);
+    return;
+  }
+
+  std::vector<ShardTask<ShardFn>> tasks;
+  // TODO(b/131746020) don't create new heap allocations every time.
+  // At least we make it a single heap allocation by using reserve().
+  tasks.reserve(shard_count);
+  int start = 0;
+  for (int i = 0; i < shard_count; ++i) {
+    // Try to distribute the rows as evenly as possible.
+    const int end = start + (num_rows - start) / (shard_count - i);
+    tasks.emplace_back(shard_fn, start, end);
+    start = end;
+  }
+  Execute(tasks.size(), tasks.data(), cpu_backend_context);
+}
+
 }  // namespace cpu_backend_threadpool
 }  // namespace tflite
 
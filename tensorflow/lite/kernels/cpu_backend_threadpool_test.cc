@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 
+#include <algorithm>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 
@@ -87,6 +90,35 @@ TEST(CpuBackendThreadpoolTest, TenThreadsSize1234567) {
   TestGenerateArrayOfIncrementingInts(10, 1234567);
 }
 
+// Returns the number of shards the work was split into.
+int TestShardedIncrementingInts(int num_threads, int size) {
+  std::vector<int> buffer(size);
+  std::vector<int> shard_sizes(size, 0);
+
+  CpuBackendContext context;
+  context.SetMaxNumThreads(num_threads);
+  cpu_backend_threadpool::ExecuteSharded(
+      size, /*row_cost=*/1, &context, [&](int start, int end) {
+        for (int i = start; i < end; i++) {
+          buffer[i] = i;
+        }
+        shard_sizes[start] = end - start;
+      });
+
+  for (int i = 0; i < size; i++) {
+    EXPECT_EQ(buffer[i], i);
+  }
+  return size - std::count(shard_sizes.begin(), shard_sizes.end(), 0);
+}
+
+TEST(CpuBackendThreadpoolTest, ShardedSize100RunsOnOneThread) {
+  EXPECT_EQ(TestShardedIncrementingInts(4, 100), 1);
+}
+
+TEST(CpuBackendThreadpoolTest, ShardedFourThreadsSize1000000) {
+  EXPECT_EQ(TestShardedIncrementingInts(4, 1000000), 4);
+}
+
 }  // namespace
 
 }  // namespace tflite
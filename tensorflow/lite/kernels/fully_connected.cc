@@ -29,6 +29,8 @@ limitations under the License.
 #include "tensorflow/lite/kernels/activation_functor.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/packed_int4_fully_connected.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/reference/reference_ops.h"
@@ -60,6 +62,11 @@ struct OpData {
   int32_t output_activation_max;
   // The index of the temporary tensor where the quantized inputs are cached.
   int scratch_tensor_index;
+  // The data of the weights in `sparse_*_weights`, or nullptr if the weights
+  // aren't stored in block sparse form, in which case the dense kernels run.
+  const void* sparse_weights_source = nullptr;
+  optimized_ops::BlockSparseWeights1x4<float> sparse_float_weights;
+  optimized_ops::BlockSparseWeights1x4<int8_t> sparse_int8_weights;
 };
 
 constexpr int kInputTensor = 0;
@@ -68,6 +75,15 @@ constexpr int kBiasTensor = 2;
 constexpr int kOutputTensor = 0;
 constexpr int kShuffledInputWorkspaceTensor = 1;
 
+// Returns the depth of the input that the weights are multiplied with. Packed
+// int4 weights hold two values per byte along it.
+inline int GetInputDepth(const TfLiteTensor* filter,
+                         const TfLiteFullyConnectedParams* params) {
+  return params->weights_format == kTfLiteFullyConnectedWeightsFormatPackedInt4
+             ? 2 * SizeOfDimension(filter, 1)
+             : SizeOfDimension(filter, 1);
+}
+
 inline TfLiteStatus CheckTypes(TfLiteContext* context,
                                const TfLiteTensor* input,
                                const TfLiteTensor* filter,
@@ -84,6 +100,12 @@ inline TfLiteStatus CheckTypes(TfLiteContext* context,
   const bool is_optional_bias_float = !bias || (bias->type == kTfLiteFloat32);
   const bool is_optional_bias_int = !bias || (bias->type == kTfLiteInt32);
 
+  // Packed int4 weights are only supported by the hybrid kernel.
+  if (params->weights_format == kTfLiteFullyConnectedWeightsFormatPackedInt4) {
+    TF_LITE_ENSURE_EQ(context, filter->type, kTfLiteInt8);
+    TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+  }
+
   if (is_quantized) {
     if (is_shuffled) {
       TF_LITE_ENSURE_EQ(context, input->type, kTfLiteUInt8);
@@ -127,6 +149,38 @@ void Free(TfLiteContext* context, void* buffer) {
   delete reinterpret_cast<OpData*>(buffer);
 }
 
+// Stores the weights of a layer whose weights format is
+// kTfLiteFullyConnectedWeightsFormatSparse1x4 in block sparse form. The dense
+// kernels keep running if the weights aren't constant, their depth isn't a
+// multiple of 4, or the layer isn't float or int8 with a weights zero point
+// of 0. This is done on the first Eval() rather than in Prepare(), so that
+// AllocateTensors() doesn't read all the weights of a lazily loaded model.
+void PrepareSparseWeights(const TfLiteTensor* input, const TfLiteTensor* filter,
+                          OpData* data) {
+  if (filter->allocation_type != kTfLiteMmapRo ||
+      SizeOfDimension(filter, 1) % 4 != 0) {
+    data->sparse_weights_source = nullptr;
+    return;
+  }
+  if (data->sparse_weights_source == filter->data.raw) {
+    return;
+  }
+  if (input->type == kTfLiteFloat32 && filter->type == kTfLiteFloat32) {
+    optimized_ops::BuildBlockSparseWeights1x4(GetTensorShape(filter),
+                                              GetTensorData<float>(filter),
+                                              &data->sparse_float_weights);
+  } else if (input->type == kTfLiteInt8 && filter->type == kTfLiteInt8 &&
+             filter->params.zero_point == 0) {
+    optimized_ops::BuildBlockSparseWeights1x4(GetTensorShape(filter),
+                                              GetTensorData<int8_t>(filter),
+                                              &data->sparse_int8_weights);
+  } else {
+    data->sparse_weights_source = nullptr;
+    return;
+  }
+  data->sparse_weights_source = filter->data.raw;
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
       reinterpret_cast<TfLiteFullyConnectedParams*>(node->builtin_data);
@@ -136,8 +190,10 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, node->inputs->size == 2 || node->inputs->size == 3);
   // Shuffled formats need a workspace to store the shuffled input activations.
   const int expected_outputs_count =
-      params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault ? 1
-                                                                          : 2;
+      params->weights_format ==
+              kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8
+          ? 2
+          : 1;
   TF_LITE_ENSURE_EQ(context, node->outputs->size, expected_outputs_count);
 
   const TfLiteTensor* input = GetInput(context, node, kInputTensor);
@@ -160,7 +216,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   }
 
   TF_LITE_ENSURE_EQ(context, NumDimensions(filter), 2);
-  const int batch_size = input_size / filter->dims->data[1];
+  const int input_depth = GetInputDepth(filter, params);
+  const int batch_size = input_size / input_depth;
   const int num_units = filter->dims->data[0];
 
   if (bias) {
@@ -219,7 +276,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     // [batch_size, ..., n_inputs] and a filter of shape [n_inputs, n_units]
     // this Op produces an output of shape [batch_size, ..., n_units].
     TF_LITE_ENSURE_EQ(context, input->dims->data[input->dims->size - 1],
-                      SizeOfDimension(filter, 1));
+                      input_depth);
     output_size_array = TfLiteIntArrayCopy(input->dims);
     output_size_array->data[output_size_array->size - 1] = num_units;
   } else {
@@ -277,8 +334,8 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
     total_input_size *= input->dims->data[i];
   }
 
-  const int input_size = filter->dims->data[1];
-  const int batch_size = total_input_size / filter->dims->data[1];
+  const int input_size = GetInputDepth(filter, params);
+  const int batch_size = total_input_size / input_size;
   const int num_units = filter->dims->data[0];
 
   // Output = bias if bias tensor exists.
@@ -321,10 +378,18 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   }
 
   // Compute output += weight * quantized_input
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      filter_data, num_units, input_size, quant_data, scaling_factors_ptr,
-      batch_size, output->data.f,
-      /*result_stride=*/1);
+  if (params->weights_format == kTfLiteFullyConnectedWeightsFormatPackedInt4) {
+    // The weights are unpacked inside the dot products rather than expanded
+    // to a full int8 or float copy.
+    optimized_ops::PackedInt4HybridFullyConnected(
+        filter_data, num_units, input_size, quant_data, scaling_factors_ptr,
+        batch_size, output->data.f, CpuBackendContext::GetFromContext(context));
+  } else {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        filter_data, num_units, input_size, quant_data, scaling_factors_ptr,
+        batch_size, output->data.f,
+        /*result_stride=*/1);
+  }
 
   // Apply activation function to floats.
   tensor_utils::ApplyActivationToVector(output->data.f, batch_size * num_units,
@@ -346,12 +411,20 @@ void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
   op_params.output_shift = data->output_shift;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
+  op_params.lhs_cacheable = IsConstantTensor(filter);
+  op_params.rhs_cacheable = IsConstantTensor(input);
   if (kernel_type == kReference) {
     reference_integer_ops::FullyConnected(
         op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
         GetTensorShape(filter), GetTensorData<int8_t>(filter),
         GetTensorShape(bias), GetTensorData<int32_t>(bias),
         GetTensorShape(output), GetTensorData<int8_t>(output));
+  } else if (data->sparse_weights_source) {
+    optimized_ops::SparseFullyConnected1x4(
+        op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
+        data->sparse_int8_weights, GetTensorShape(bias),
+        GetTensorData<int32_t>(bias), GetTensorShape(output),
+        GetTensorData<int8_t>(output), cpu_backend_context);
   } else {
     optimized_integer_ops::FullyConnected(
         op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
@@ -387,6 +460,8 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
     op_params.output_shift = data->output_shift;
     op_params.quantized_activation_min = data->output_activation_min;
     op_params.quantized_activation_max = data->output_activation_max;
+    op_params.lhs_cacheable = IsConstantTensor(filter);
+    op_params.rhs_cacheable = IsConstantTensor(input);
     switch (output->type) {
       case kTfLiteUInt8:
         if (kernel_type == kReference) {
@@ -506,10 +581,22 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
         GetTensorShape(output), GetTensorData<float>(output));
   } else if (kernel_type == kLegacyPie) {
     return EvalPie(context, node, params, data, input, filter, bias, output);
+  } else if (data->sparse_weights_source) {
+    FullyConnectedParams op_params;
+    op_params.float_activation_min = output_activation_min;
+    op_params.float_activation_max = output_activation_max;
+    optimized_ops::SparseFullyConnected1x4(
+        op_params, GetTensorShape(input), GetTensorData<float>(input),
+        data->sparse_float_weights, GetTensorShape(bias),
+        GetTensorData<float>(bias), GetTensorShape(output),
+        GetTensorData<float>(output),
+        CpuBackendContext::GetFromContext(context));
   } else {
     FullyConnectedParams op_params;
     op_params.float_activation_min = output_activation_min;
     op_params.float_activation_max = output_activation_max;
+    op_params.lhs_cacheable = IsConstantTensor(filter);
+    op_params.rhs_cacheable = IsConstantTensor(input);
     optimized_ops::FullyConnected(
         op_params, GetTensorShape(input), GetTensorData<float>(input),
         GetTensorShape(filter), GetTensorData<float>(filter),
@@ -535,6 +622,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           : nullptr;
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
 
+  if (kernel_type == kGenericOptimized &&
+      params->weights_format == kTfLiteFullyConnectedWeightsFormatSparse1x4) {
+    PrepareSparseWeights(input, filter, data);
+  }
+
   switch (filter->type) {
     case kTfLiteFloat32:
       return EvalFloat<kernel_type>(context, node, params, data, input, filter,
@@ -548,7 +640,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                                                   input, filter, bias, output,
                                                   shuffled_input_workspace);
       } else if (params->weights_format ==
-                 kTfLiteFullyConnectedWeightsFormatDefault) {
+                     kTfLiteFullyConnectedWeightsFormatDefault ||
+                 params->weights_format ==
+                     kTfLiteFullyConnectedWeightsFormatSparse1x4) {
         return EvalQuantized<kernel_type>(context, node, params, data, input,
                                           filter, bias, output);
       } else {
@@ -557,7 +651,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         return kTfLiteError;
       }
     case kTfLiteInt8:
-      if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault) {
+      if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault ||
+          params->weights_format ==
+              kTfLiteFullyConnectedWeightsFormatSparse1x4 ||
+          params->weights_format ==
+              kTfLiteFullyConnectedWeightsFormatPackedInt4) {
         return EvalQuantized<kernel_type>(context, node, params, data, input,
                                           filter, bias, output);
       } else {
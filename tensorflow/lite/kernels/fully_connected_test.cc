@@ -166,7 +166,7 @@ class BaseFullyConnectedOpModel : public SingleOpModel {
     }
 
     output_ = AddOutput(output);
-    if (weights_format != FullyConnectedOptionsWeightsFormat_DEFAULT) {
+    if (weights_format == FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8) {
       AddOutput({TensorType_UINT8, input.shape});
     }
 
@@ -335,6 +335,101 @@ class HybridFullyConnectedOpModel : public SingleOpModel {
   int input_size_;
 };
 
+// A model with constant weights marked as 1x4 block sparse, so that the
+// optimized kernel only multiplies their non-zero blocks.
+template <typename T>
+class SparseFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseFullyConnectedOpModel(TfLiteRegistration* registration,
+                              const TensorData& input,
+                              const TensorData& weights,
+                              std::initializer_list<T> weights_data,
+                              const TensorData& output) {
+    input_ = AddInput(input);
+    weights_ = AddConstInput(weights, weights_data);
+    const int units = weights.shape[0];
+    if (input.type == TensorType_FLOAT32) {
+      bias_ = AddInput({TensorType_FLOAT32, {units}});
+    } else {
+      bias_ = AddInput({TensorType_INT32,
+                        {units},
+                        0,
+                        0,
+                        GetScale(input_) * GetScale(weights_)});
+    }
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
+                 BuiltinOptions_FullyConnectedOptions,
+                 CreateFullyConnectedOptions(
+                     builder_, ActivationFunctionType_NONE,
+                     FullyConnectedOptionsWeightsFormat_SPARSE1x4)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  int input() { return input_; }
+  int bias() { return bias_; }
+  int output() { return output_; }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+// A hybrid model whose int8 weights are packed two per byte, in the
+// PACKED_INT4 weights format.
+class PackedInt4FullyConnectedOpModel : public SingleOpModel {
+ public:
+  PackedInt4FullyConnectedOpModel(TfLiteRegistration* registration, int units,
+                                  int batches, int input_depth,
+                                  float weights_scale) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_depth}});
+    weights_ = AddInput({TensorType_INT8,
+                         {units, input_depth / 2},
+                         0,
+                         0,
+                         weights_scale,
+                         0});
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+
+    SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
+                 BuiltinOptions_FullyConnectedOptions,
+                 CreateFullyConnectedOptions(
+                     builder_, ActivationFunctionType_NONE,
+                     FullyConnectedOptionsWeightsFormat_PACKED_INT4)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  // Packs the given row-major values, each in [-7, 7].
+  void SetWeights(const std::vector<int8_t>& values) {
+    std::vector<int8_t> packed(values.size() / 2);
+    for (size_t i = 0; i < packed.size(); ++i) {
+      packed[i] = static_cast<int8_t>((values[2 * i] & 0x0f) |
+                                      (values[2 * i + 1] << 4));
+    }
+    PopulateTensor(weights_, packed);
+  }
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
+  void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_FULLY_CONNECTED_REF()},
     {"GenericOptimized", ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT()},
@@ -830,6 +925,45 @@ TEST(HybridFullyConnectedOpTest, SimpleTestQuantizedInt8) {
                                  /*max_abs_error=*/1.3f)));
 }
 
+TEST_P(FloatFullyConnectedOpTest, PackedInt4Weights) {
+  // A depth of 40 covers both the vectorized and the leftover columns.
+  const int units = 3, batches = 2, depth = 40;
+  const float weights_scale = 0.1f;
+  PackedInt4FullyConnectedOpModel m(GetRegistration(), units, batches, depth,
+                                    weights_scale);
+
+  std::vector<int8_t> weights(units * depth);
+  for (int u = 0; u < units; ++u) {
+    for (int i = 0; i < depth; ++i) {
+      weights[u * depth + i] = (i * (u + 1)) % 15 - 7;
+    }
+  }
+  std::vector<float> input(batches * depth);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = (static_cast<int>(i % 9) - 4) / 4.0f;
+  }
+  const std::vector<float> bias = {1, 2, 3};
+  m.SetWeights(weights);
+  m.SetBias(bias);
+  m.SetInput(input);
+
+  m.Invoke();
+
+  std::vector<float> expected;
+  for (int b = 0; b < batches; ++b) {
+    for (int u = 0; u < units; ++u) {
+      float acc = bias[u];
+      for (int i = 0; i < depth; ++i) {
+        acc += weights[u * depth + i] * weights_scale * input[b * depth + i];
+      }
+      expected.push_back(acc);
+    }
+  }
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(batches, units));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 expected, /*max_abs_error=*/0.15f)));
+}
+
 TEST_P(FloatFullyConnectedOpTest, SimpleTest4DInput) {
   // Note that it is not required that the first dimension be the number of
   // batches. All we care is that the input can be evenly distributed in
@@ -1029,5 +1163,52 @@ TEST_P(FloatFullyConnectedOpTest, BlackBoxTest) {
   }
 }
 
+TEST_P(FloatFullyConnectedOpTest, SparseWeights) {
+  SparseFullyConnectedOpModel<float> m(GetRegistration(),
+                                       /*input=*/{TensorType_FLOAT32, {2, 8}},
+                                       /*weights=*/{TensorType_FLOAT32, {3, 8}},
+                                       {
+                                           1, 2, 3, 4, 0, 0, 0, 0,  // u = 0
+                                           0, 0, 0, 0, 0, 0, 0, 0,  // u = 1
+                                           0, 0, 0, 0, 1, 0, -2, 1,  // u = 2
+                                       },
+                                       /*output=*/{TensorType_FLOAT32});
+  m.PopulateTensor<float>(m.bias(), {1, 2, 3});
+  m.PopulateTensor<float>(m.input(), {
+                                         1, 2, 3, 4, 5, 6, 7, 8,       // b = 0
+                                         -1, -2, -3, -4, 1, 1, 1, 1,  // b = 1
+                                     });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.ExtractVector<float>(m.output()),
+              ElementsAreArray({31, 2, 2, -29, 2, 3}));
+}
+
+TEST_P(QuantizedFullyConnectedOpTest, SparseWeightsInt8) {
+  SparseFullyConnectedOpModel<int8_t> m(
+      GetRegistration(),
+      /*input=*/{TensorType_INT8, {2, 8}, -63.5, 64},
+      /*weights=*/{TensorType_INT8, {3, 8}, 0, 0, /*scale=*/1.0},
+      {
+          1, 2, 3, 4, 0, 0, 0, 0,   // u = 0
+          0, 0, 0, 0, 0, 0, 0, 0,   // u = 1
+          0, 0, 0, 0, 1, 0, -2, 1,  // u = 2
+      },
+      /*output=*/{TensorType_INT8, {}, -127, 128});
+  m.QuantizeAndPopulate<int32_t>(m.bias(), {1, 2, 3});
+  m.QuantizeAndPopulate<int8_t>(m.input(), {
+                                               1, 2, 3, 4, 5, 6, 7, 8,  // b = 0
+                                               -1, -2, -3, -4, 1, 1, 1, 1,
+                                           });
+
+  m.Invoke();
+
+  EXPECT_THAT(Dequantize<int8_t>(m.ExtractVector<int8_t>(m.output()),
+                                 m.GetScale(m.output()),
+                                 m.GetZeroPoint(m.output())),
+              ElementsAreArray({31, 2, 2, -29, 2, 3}));
+}
+
 }  // namespace
 }  // namespace tflite
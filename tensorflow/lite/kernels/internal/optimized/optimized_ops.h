@@ -20,6 +20,7 @@ limitations under the License.
 #include <sys/types.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <limits>
@@ -223,6 +224,8 @@ inline void FullyConnected(
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
   lhs_params.cols = weights_shape.Dims(dims_count - 1);
   lhs_params.rows = FlatSizeSkipDim(weights_shape, dims_count - 1);
+  lhs_params.cacheable = params.lhs_cacheable;
+  rhs_params.cacheable = params.rhs_cacheable;
   cpu_backend_gemm::MatrixParams<float> dst_params;
   dst_params.order = cpu_backend_gemm::Order::kColMajor;
   dst_params.rows = output_shape.Dims(output_shape.DimensionsCount() - 1);
@@ -275,11 +278,13 @@ inline void FullyConnected(
   lhs_params.cols = filter_cols;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
   lhs_params.zero_point = -filter_offset;
+  lhs_params.cacheable = params.lhs_cacheable;
   cpu_backend_gemm::MatrixParams<uint8> rhs_params;
   rhs_params.rows = filter_cols;
   rhs_params.cols = batches;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.zero_point = -input_offset;
+  rhs_params.cacheable = params.rhs_cacheable;
   cpu_backend_gemm::MatrixParams<uint8> dst_params;
   dst_params.rows = filter_rows;
   dst_params.cols = batches;
@@ -332,11 +337,13 @@ inline void FullyConnected(
   lhs_params.cols = accum_depth;
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
   lhs_params.zero_point = -filter_offset;
+  lhs_params.cacheable = params.lhs_cacheable;
   cpu_backend_gemm::MatrixParams<uint8> rhs_params;
   rhs_params.rows = accum_depth;
   rhs_params.cols = batches;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.zero_point = -input_offset;
+  rhs_params.cacheable = params.rhs_cacheable;
   cpu_backend_gemm::MatrixParams<int16> dst_params;
   dst_params.rows = output_depth;
   dst_params.cols = batches;
@@ -3468,6 +3475,109 @@ inline void L2Pool(const PoolParams& params, const RuntimeShape& input_shape,
   }
 }
 
+// Runs `pool` on shards of the output rows of a float pooling op, in parallel.
+// Each shard only sees the input rows covered by the windows of its output
+// rows, with the padding adjusted accordingly.
+template <typename PoolFn>
+inline bool PoolByOutputRows(const PoolParams& params,
+                             const RuntimeShape& input_shape,
+                             const float* input_data,
+                             const RuntimeShape& output_shape,
+                             float* output_data,
+                             CpuBackendContext* cpu_backend_context,
+                             const PoolFn& pool) {
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int num_rows = batches * output_height;
+  const int row_cost =
+      output_width * depth * params.filter_height * params.filter_width;
+
+  std::atomic<bool> success(true);
+  cpu_backend_threadpool::ExecuteSharded(
+      num_rows, row_cost, cpu_backend_context, [&](int start, int end) {
+        if (start == 0 && end == num_rows) {
+          success = pool(params, input_shape, input_data, output_shape,
+                         output_data);
+          return;
+        }
+        for (int b = start / output_height; b * output_height < end; ++b) {
+          const int out_start = std::max(start - b * output_height, 0);
+          const int out_end = std::min(end - b * output_height, output_height);
+          const int in_start = std::max(
+              out_start * params.stride_height - params.padding_values.height,
+              0);
+          const int in_end =
+              std::min((out_end - 1) * params.stride_height -
+                           params.padding_values.height + params.filter_height,
+                       input_height);
+          TFLITE_DCHECK_LT(in_start, in_end);
+          PoolParams shard_params = params;
+          shard_params.padding_values.height = params.padding_values.height +
+                                               in_start -
+                                               out_start * params.stride_height;
+          if (!pool(shard_params,
+                    RuntimeShape({1, in_end - in_start, input_width, depth}),
+                    input_data + Offset(input_shape, b, in_start, 0, 0),
+                    RuntimeShape({1, out_end - out_start, output_width, depth}),
+                    output_data + Offset(output_shape, b, out_start, 0, 0))) {
+            success = false;
+          }
+        }
+      });
+  return success;
+}
+
+inline bool AveragePool(const PoolParams& params,
+                        const RuntimeShape& input_shape,
+                        const float* input_data,
+                        const RuntimeShape& output_shape, float* output_data,
+                        CpuBackendContext* cpu_backend_context) {
+  return PoolByOutputRows(
+      params, input_shape, input_data, output_shape, output_data,
+      cpu_backend_context,
+      [](const PoolParams& params, const RuntimeShape& input_shape,
+         const float* input_data, const RuntimeShape& output_shape,
+         float* output_data) {
+        return AveragePool(params, input_shape, input_data, output_shape,
+                           output_data);
+      });
+}
+
+inline void MaxPool(const PoolParams& params, const RuntimeShape& input_shape,
+                    const float* input_data, const RuntimeShape& output_shape,
+                    float* output_data,
+                    CpuBackendContext* cpu_backend_context) {
+  PoolByOutputRows(params, input_shape, input_data, output_shape, output_data,
+                   cpu_backend_context,
+                   [](const PoolParams& params, const RuntimeShape& input_shape,
+                      const float* input_data, const RuntimeShape& output_shape,
+                      float* output_data) {
+                     MaxPool(params, input_shape, input_data, output_shape,
+                             output_data);
+                     return true;
+                   });
+}
+
+inline void L2Pool(const PoolParams& params, const RuntimeShape& input_shape,
+                   const float* input_data, const RuntimeShape& output_shape,
+                   float* output_data, CpuBackendContext* cpu_backend_context) {
+  PoolByOutputRows(params, input_shape, input_data, output_shape, output_data,
+                   cpu_backend_context,
+                   [](const PoolParams& params, const RuntimeShape& input_shape,
+                      const float* input_data, const RuntimeShape& output_shape,
+                      float* output_data) {
+                     L2Pool(params, input_shape, input_data, output_shape,
+                            output_data);
+                     return true;
+                   });
+}
+
 inline void LocalResponseNormalization(
     const tflite::LocalResponseNormalizationParams& op_params,
     const RuntimeShape& input_shape, const float* input_data,
@@ -3532,6 +3642,25 @@ inline void Softmax(const SoftmaxParams& params,
   out_mat.array().rowwise() *= scale;
 }
 
+// Same as above, with the rows, i.e. all dimensions but the last one, split
+// across the threads of `cpu_backend_context`.
+inline void Softmax(const SoftmaxParams& params,
+                    const RuntimeShape& input_shape, const float* input_data,
+                    const RuntimeShape& output_shape, float* output_data,
+                    CpuBackendContext* cpu_backend_context) {
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int outer_size =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int depth =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+  cpu_backend_threadpool::ExecuteSharded(
+      outer_size, depth, cpu_backend_context, [&](int start, int end) {
+        const RuntimeShape shard_shape({end - start, depth});
+        Softmax(params, shard_shape, input_data + start * depth, shard_shape,
+                output_data + start * depth);
+      });
+}
+
 inline int32_t QuantizeSoftmaxOutput(int8_t* output_data, float prob_rescaled,
                                      int32_t zero_point) {
   const int32_t prob_rnd = static_cast<int32_t>(std::round(prob_rescaled));
@@ -4205,68 +4334,73 @@ inline void ResizeBilinearKernel2x2(int32 x0, int32 x1, int32 y0, int32 y1,
 #endif
 }
 
+// Computes the output rows upsampled from the input rows [row_start, row_end)
+// of all batches, flattened.
 inline void ResizeBilinear2x2(int32 batches, int32 input_height,
                               int32 input_width, int32 depth,
                               int32 output_height, int32 output_width,
                               const RuntimeShape& input_shape,
                               const float* input_data,
                               const RuntimeShape& output_shape,
-                              float* output_data) {
-  for (int b = 0; b < batches; b++) {
-    for (int y0 = 0, y = 0; y <= output_height - 2; y += 2, y0++) {
-      for (int x0 = 0, x = 0; x <= output_width - 2; x += 2, x0++) {
-        int32 x1 = std::min(x0 + 1, input_width - 1);
-        int32 y1 = std::min(y0 + 1, input_height - 1);
-        ResizeBilinearKernel2x2(x0, x1, y0, y1, x, y, depth, b, input_shape,
-                                input_data, output_shape, output_data);
-      }
+                              float* output_data, int row_start, int row_end) {
+  for (int row = row_start; row < row_end; ++row) {
+    const int b = row / input_height;
+    const int y0 = row % input_height;
+    const int y = 2 * y0;
+    for (int x0 = 0, x = 0; x <= output_width - 2; x += 2, x0++) {
+      int32 x1 = std::min(x0 + 1, input_width - 1);
+      int32 y1 = std::min(y0 + 1, input_height - 1);
+      ResizeBilinearKernel2x2(x0, x1, y0, y1, x, y, depth, b, input_shape,
+                              input_data, output_shape, output_data);
     }
   }
 }
 
+// Computes the output rows [row_start, row_end) of all batches, flattened.
 inline void ResizeBilinearGeneric(
     int32 batches, int32 input_height, int32 input_width, int32 depth,
     int32 output_height, int32 output_width, float height_scale,
     float width_scale, const RuntimeShape& input_shape, const float* input_data,
-    const RuntimeShape& output_shape, float* output_data) {
-  memset(output_data, 0,
-         batches * output_height * output_width * depth * sizeof(float));
-
-  int32 output_offset = 0;
-  for (int b = 0; b < batches; ++b) {
-    for (int y = 0; y < output_height; ++y) {
-      float input_y = y * height_scale;
-      int32 y0 = static_cast<int32>(std::floor(input_y));
-      int32 y1 = std::min(y0 + 1, input_height - 1);
-      for (int x = 0; x < output_width; ++x) {
-        float input_x = x * width_scale;
-        int32 x0 = static_cast<int32>(input_x);
-        int32 x1 = std::min(x0 + 1, input_width - 1);
-        float* output_ptr = &output_data[output_offset];
-
-        // Run kernel on the 4 corners of the bilinear resize algorithm.
-        int32 input_offset = Offset(input_shape, b, y0, x0, 0);
-        float scale = (1 - (input_y - y0)) * (1 - (input_x - x0));
-        const float* input_ptr = &input_data[input_offset];
-        ResizeBilinearKernel(input_ptr, depth, scale, output_ptr);
-
-        input_offset = Offset(input_shape, b, y0, x1, 0);
-        scale = (1 - (input_y - y0)) * (input_x - x0);
-        input_ptr = &input_data[input_offset];
-        ResizeBilinearKernel(input_ptr, depth, scale, output_ptr);
-
-        input_offset = Offset(input_shape, b, y1, x0, 0);
-        scale = (input_y - y0) * (1 - (input_x - x0));
-        input_ptr = &input_data[input_offset];
-        ResizeBilinearKernel(input_ptr, depth, scale, output_ptr);
-
-        input_offset = Offset(input_shape, b, y1, x1, 0);
-        scale = (input_y - y0) * (input_x - x0);
-        input_ptr = &input_data[input_offset];
-        ResizeBilinearKernel(input_ptr, depth, scale, output_ptr);
-
-        output_offset += depth;
-      }
+    const RuntimeShape& output_shape, float* output_data, int row_start,
+    int row_end) {
+  int32 output_offset = row_start * output_width * depth;
+  memset(output_data + output_offset, 0,
+         (row_end - row_start) * output_width * depth * sizeof(float));
+
+  for (int row = row_start; row < row_end; ++row) {
+    const int b = row / output_height;
+    const int y = row % output_height;
+    float input_y = y * height_scale;
+    int32 y0 = static_cast<int32>(std::floor(input_y));
+    int32 y1 = std::min(y0 + 1, input_height - 1);
+    for (int x = 0; x < output_width; ++x) {
+      float input_x = x * width_scale;
+      int32 x0 = static_cast<int32>(input_x);
+      int32 x1 = std::min(x0 + 1, input_width - 1);
+      float* output_ptr = &output_data[output_offset];
+
+      // Run kernel on the 4 corners of the bilinear resize algorithm.
+      int32 input_offset = Offset(input_shape, b, y0, x0, 0);
+      float scale = (1 - (input_y - y0)) * (1 - (input_x - x0));
+      const float* input_ptr = &input_data[input_offset];
+      ResizeBilinearKernel(input_ptr, depth, scale, output_ptr);
+
+      input_offset = Offset(input_shape, b, y0, x1, 0);
+      scale = (1 - (input_y - y0)) * (input_x - x0);
+      input_ptr = &input_data[input_offset];
+      ResizeBilinearKernel(input_ptr, depth, scale, output_ptr);
+
+      input_offset = Offset(input_shape, b, y1, x0, 0);
+      scale = (input_y - y0) * (1 - (input_x - x0));
+      input_ptr = &input_data[input_offset];
+      ResizeBilinearKernel(input_ptr, depth, scale, output_ptr);
+
+      input_offset = Offset(input_shape, b, y1, x1, 0);
+      scale = (input_y - y0) * (input_x - x0);
+      input_ptr = &input_data[input_offset];
+      ResizeBilinearKernel(input_ptr, depth, scale, output_ptr);
+
+      output_offset += depth;
     }
   }
 }
@@ -4338,7 +4472,7 @@ inline void ResizeBilinear(const tflite::ResizeBilinearParams& op_params,
       output_width == 2 * input_width) {
     ResizeBilinear2x2(batches, input_height, input_width, depth, output_height,
                       output_width, input_shape, input_data, output_shape,
-                      output_data);
+                      output_data, 0, batches * input_height);
   } else {
     float height_scale = static_cast<float>(input_height) / output_height;
     float width_scale = static_cast<float>(input_width) / output_width;
@@ -4352,7 +4486,65 @@ inline void ResizeBilinear(const tflite::ResizeBilinearParams& op_params,
     ResizeBilinearGeneric(batches, input_height, input_width, depth,
                           output_height, output_width, height_scale,
                           width_scale, input_shape, input_data, output_shape,
-                          output_data);
+                          output_data, 0, batches * output_height);
+  }
+}
+
+// Same as above, with the output rows split across the threads of
+// `cpu_backend_context`.
+inline void ResizeBilinear(const tflite::ResizeBilinearParams& op_params,
+                           const RuntimeShape& unextended_input_shape,
+                           const float* input_data,
+                           const RuntimeShape& output_size_shape,
+                           const int32* output_size_data,
+                           const RuntimeShape& unextended_output_shape,
+                           float* output_data,
+                           CpuBackendContext* cpu_backend_context) {
+  gemmlowp::ScopedProfilingLabel label("ResizeBilinear");
+  TFLITE_DCHECK_LE(unextended_input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_LE(unextended_output_shape.DimensionsCount(), 4);
+  const RuntimeShape input_shape =
+      RuntimeShape::ExtendedShape(4, unextended_input_shape);
+  const RuntimeShape output_shape =
+      RuntimeShape::ExtendedShape(4, unextended_output_shape);
+
+  int32 batches = MatchingDim(input_shape, 0, output_shape, 0);
+  int32 input_height = input_shape.Dims(1);
+  int32 input_width = input_shape.Dims(2);
+  int32 depth = MatchingDim(input_shape, 3, output_shape, 3);
+
+  TFLITE_DCHECK_EQ(output_size_shape.FlatSize(), 2);
+  int32 output_height = output_size_data[0];
+  int32 output_width = output_size_data[1];
+
+  // Specialize for 2x2 upsample, which computes two output rows per input row.
+  if (!op_params.align_corners && output_height == 2 * input_height &&
+      output_width == 2 * input_width) {
+    cpu_backend_threadpool::ExecuteSharded(
+        batches * input_height, 2 * output_width * depth, cpu_backend_context,
+        [&](int start, int end) {
+          ResizeBilinear2x2(batches, input_height, input_width, depth,
+                            output_height, output_width, input_shape,
+                            input_data, output_shape, output_data, start, end);
+        });
+  } else {
+    float height_scale = static_cast<float>(input_height) / output_height;
+    float width_scale = static_cast<float>(input_width) / output_width;
+    if (op_params.align_corners && output_height > 1) {
+      height_scale = static_cast<float>(input_height - 1) / (output_height - 1);
+    }
+    if (op_params.align_corners && output_width > 1) {
+      width_scale = static_cast<float>(input_width - 1) / (output_width - 1);
+    }
+
+    cpu_backend_threadpool::ExecuteSharded(
+        batches * output_height, 4 * output_width * depth, cpu_backend_context,
+        [&](int start, int end) {
+          ResizeBilinearGeneric(batches, input_height, input_width, depth,
+                                output_height, output_width, height_scale,
+                                width_scale, input_shape, input_data,
+                                output_shape, output_data, start, end);
+        });
   }
 }
 
@@ -0,0 +1,120 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_PACKED_INT4_FULLY_CONNECTED_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_PACKED_INT4_FULLY_CONNECTED_H_
+
+#include <algorithm>
+
+#include "profiling/instrumentation.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// Packed int4 weights hold two signed 4-bit values per byte: element 2k of a
+// row in the low nibble and element 2k + 1 in the high nibble. A row of
+// `cols` weights thus takes cols / 2 bytes, and `cols` must be even.
+
+// Returns the element held in the low nibble of `packed`, sign extended.
+inline int8 UnpackLowInt4(int8 packed) {
+  return static_cast<int8>(static_cast<uint8>(packed) << 4) >> 4;
+}
+
+// Returns the element held in the high nibble of `packed`, sign extended.
+inline int8 UnpackHighInt4(int8 packed) { return packed >> 4; }
+
+// Packs `size` values, each in [-8, 7], into size / 2 bytes.
+inline void PackInt4(const int8* values, int size, int8* packed) {
+  TFLITE_DCHECK_EQ(size % 2, 0);
+  for (int i = 0; i < size / 2; ++i) {
+    packed[i] = static_cast<int8>((values[2 * i] & 0x0f) |
+                                  (values[2 * i + 1] << 4));
+  }
+}
+
+// Returns the dot product of a row of `cols` packed int4 weights with `cols`
+// int8 values. The nibbles are unpacked in registers, so the weights are
+// never expanded in memory.
+inline int32 PackedInt4Dot(const int8* packed_row, const int8* input,
+                           int cols) {
+  int32 acc = 0;
+  int c = 0;
+#ifdef USE_NEON
+  int32x4_t acc_32x4 = vdupq_n_s32(0);
+  for (; c <= cols - 32; c += 32) {
+    const int8x16_t packed = vld1q_s8(packed_row + c / 2);
+    const int8x16_t low = vshrq_n_s8(vshlq_n_s8(packed, 4), 4);
+    const int8x16_t high = vshrq_n_s8(packed, 4);
+    // Interleaving the nibbles restores the order of the row.
+    const int8x16x2_t weights = vzipq_s8(low, high);
+    const int8x16_t input_0 = vld1q_s8(input + c);
+    const int8x16_t input_1 = vld1q_s8(input + c + 16);
+    // |w| <= 8, so two products always fit in int16.
+    int16x8_t prod = vmull_s8(vget_low_s8(weights.val[0]),
+                              vget_low_s8(input_0));
+    prod = vmlal_s8(prod, vget_high_s8(weights.val[0]), vget_high_s8(input_0));
+    acc_32x4 = vpadalq_s16(acc_32x4, prod);
+    prod = vmull_s8(vget_low_s8(weights.val[1]), vget_low_s8(input_1));
+    prod = vmlal_s8(prod, vget_high_s8(weights.val[1]), vget_high_s8(input_1));
+    acc_32x4 = vpadalq_s16(acc_32x4, prod);
+  }
+  acc = vgetq_lane_s32(acc_32x4, 0) + vgetq_lane_s32(acc_32x4, 1) +
+        vgetq_lane_s32(acc_32x4, 2) + vgetq_lane_s32(acc_32x4, 3);
+#endif
+  for (; c < cols; c += 2) {
+    const int8 packed = packed_row[c / 2];
+    acc += UnpackLowInt4(packed) * input[c] +
+           UnpackHighInt4(packed) * input[c + 1];
+  }
+  return acc;
+}
+
+// The hybrid fully-connected layer for packed int4 weights of shape
+// [rows, cols]. `quantized_input` holds `batches` rows of `cols` symmetric
+// int8 values, and `scaling_factors[b]` is the product of the input and
+// weights scales of batch b. Like
+// tensor_utils::MatrixBatchVectorMultiplyAccumulate, the results are added
+// to `output`, of shape [batches, rows]. Rows are sharded over the cpu
+// backend thread pool.
+inline void PackedInt4HybridFullyConnected(
+    const int8* packed_weights, int rows, int cols, const int8* quantized_input,
+    const float* scaling_factors, int batches, float* output,
+    CpuBackendContext* cpu_backend_context) {
+  gemmlowp::ScopedProfilingLabel label("PackedInt4HybridFullyConnected");
+  TFLITE_DCHECK_EQ(cols % 2, 0);
+  cpu_backend_threadpool::ExecuteSharded(
+      rows, cols * batches, cpu_backend_context,
+      [&](int row_start, int row_end) {
+        for (int b = 0; b < batches; ++b) {
+          const int8* input = quantized_input + b * cols;
+          float* result = output + b * rows;
+          const float scale = scaling_factors[b];
+          for (int r = row_start; r < row_end; ++r) {
+            result[r] +=
+                scale * PackedInt4Dot(packed_weights + r * (cols / 2), input,
+                                      cols);
+          }
+        }
+      });
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_PACKED_INT4_FULLY_CONNECTED_H_
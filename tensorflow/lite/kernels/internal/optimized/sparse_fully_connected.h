@@ -0,0 +1,232 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_FULLY_CONNECTED_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_FULLY_CONNECTED_H_
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "profiling/instrumentation.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// The weights of a fully-connected layer, of shape [rows, cols], split into
+// blocks of 1x4 consecutive weights along the depth and stored in compressed
+// sparse row form: the blocks of row r are [row_start[r], row_start[r + 1]),
+// the i-th one starting at column block_col[i] and holding the weights
+// values[4 * i] to values[4 * i + 3]. All-zero blocks are dropped.
+template <typename T>
+struct BlockSparseWeights1x4 {
+  int rows = 0;
+  int cols = 0;
+  std::vector<int32> row_start;
+  std::vector<int32> block_col;
+  std::vector<T> values;
+  // The sum of the weights of each row, which applies the input offset of
+  // quantized layers.
+  std::vector<int32> row_sums;
+};
+
+// Converts dense weights of shape [rows, cols] to the block sparse form. The
+// depth, `cols`, must be a multiple of 4.
+template <typename T>
+inline void BuildBlockSparseWeights1x4(const RuntimeShape& filter_shape,
+                                       const T* filter_data,
+                                       BlockSparseWeights1x4<T>* weights) {
+  const int dims_count = filter_shape.DimensionsCount();
+  weights->rows = filter_shape.Dims(dims_count - 2);
+  weights->cols = filter_shape.Dims(dims_count - 1);
+  TFLITE_DCHECK_EQ(weights->cols % 4, 0);
+  weights->row_start.assign(1, 0);
+  weights->block_col.clear();
+  weights->values.clear();
+  weights->row_sums.assign(weights->rows, 0);
+  for (int r = 0; r < weights->rows; ++r) {
+    const T* row = filter_data + r * weights->cols;
+    for (int c = 0; c < weights->cols; c += 4) {
+      if (row[c] == 0 && row[c + 1] == 0 && row[c + 2] == 0 &&
+          row[c + 3] == 0) {
+        continue;
+      }
+      weights->block_col.push_back(c);
+      for (int i = 0; i < 4; ++i) {
+        weights->values.push_back(row[c + i]);
+        weights->row_sums[r] += static_cast<int32>(row[c + i]);
+      }
+    }
+    weights->row_start.push_back(weights->block_col.size());
+  }
+}
+
+// Returns the dot product of row `r` of `weights` with `input`.
+inline float SparseDot1x4(const BlockSparseWeights1x4<float>& weights, int r,
+                          const float* input) {
+  const int32* block_col = weights.block_col.data();
+  const float* values = weights.values.data();
+  const int start = weights.row_start[r];
+  const int end = weights.row_start[r + 1];
+#ifdef USE_NEON
+  float32x4_t acc = vdupq_n_f32(0.f);
+  for (int i = start; i < end; ++i) {
+    acc = vmlaq_f32(acc, vld1q_f32(values + 4 * i),
+                    vld1q_f32(input + block_col[i]));
+  }
+  const float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+  return vget_lane_f32(vpadd_f32(sum, sum), 0);
+#else
+  float acc = 0.f;
+  for (int i = start; i < end; ++i) {
+    const float* block = values + 4 * i;
+    const float* x = input + block_col[i];
+    acc += block[0] * x[0] + block[1] * x[1] + block[2] * x[2] +
+           block[3] * x[3];
+  }
+  return acc;
+#endif
+}
+
+// Returns the dot product of row `r` of `weights` with `input`, without any
+// offset.
+inline int32 SparseDot1x4(const BlockSparseWeights1x4<int8>& weights, int r,
+                          const int8* input) {
+  const int32* block_col = weights.block_col.data();
+  const int8* values = weights.values.data();
+  const int start = weights.row_start[r];
+  const int end = weights.row_start[r + 1];
+#ifdef USE_NEON
+  int32x4_t acc = vdupq_n_s32(0);
+  for (int i = start; i < end; ++i) {
+    // Only the low 4 lanes of each vector are used.
+    int32 block, x;
+    memcpy(&block, values + 4 * i, sizeof(block));
+    memcpy(&x, input + block_col[i], sizeof(x));
+    const int16x8_t prod = vmull_s8(vreinterpret_s8_s32(vdup_n_s32(block)),
+                                    vreinterpret_s8_s32(vdup_n_s32(x)));
+    acc = vaddw_s16(acc, vget_low_s16(prod));
+  }
+  return vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) +
+         vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+#else
+  int32 acc = 0;
+  for (int i = start; i < end; ++i) {
+    const int8* block = values + 4 * i;
+    const int8* x = input + block_col[i];
+    acc += block[0] * x[0] + block[1] * x[1] + block[2] * x[2] +
+           block[3] * x[3];
+  }
+  return acc;
+#endif
+}
+
+// Returns the cost of computing one output of each batch, for sharding.
+template <typename T>
+inline int SparseRowCost1x4(const BlockSparseWeights1x4<T>& weights,
+                            int batches) {
+  const int rows = std::max(weights.rows, 1);
+  return std::max<int>(1, weights.values.size() / rows) * batches;
+}
+
+// A fully-connected layer with 1x4 block sparse weights. Only the non-zero
+// blocks are multiplied, so the cost is proportional to the number of
+// non-zero blocks rather than to the size of the weights.
+inline void SparseFullyConnected1x4(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const float* input_data, const BlockSparseWeights1x4<float>& weights,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  gemmlowp::ScopedProfilingLabel label("SparseFullyConnected1x4/float");
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = output_shape.Dims(output_dims_count - 1);
+  const int accum_depth = weights.cols;
+  TFLITE_DCHECK_EQ(output_depth, weights.rows);
+
+  cpu_backend_threadpool::ExecuteSharded(
+      output_depth, SparseRowCost1x4(weights, batches), cpu_backend_context,
+      [&](int row_start, int row_end) {
+        for (int b = 0; b < batches; ++b) {
+          const float* input = input_data + b * accum_depth;
+          float* output = output_data + b * output_depth;
+          for (int r = row_start; r < row_end; ++r) {
+            float acc = SparseDot1x4(weights, r, input);
+            if (bias_data) {
+              acc += bias_data[r];
+            }
+            output[r] = ActivationFunctionWithMinMax(
+                acc, output_activation_min, output_activation_max);
+          }
+        }
+      });
+}
+
+// The int8 flavor of SparseFullyConnected1x4. The weights must be quantized
+// with a zero point of 0, so that dropped blocks contribute nothing.
+inline void SparseFullyConnected1x4(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const int8* input_data, const BlockSparseWeights1x4<int8>& weights,
+    const RuntimeShape& bias_shape, const int32* bias_data,
+    const RuntimeShape& output_shape, int8* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  gemmlowp::ScopedProfilingLabel label("SparseFullyConnected1x4/8bit");
+  TFLITE_DCHECK_EQ(params.weights_offset, 0);
+  const int32 input_offset = params.input_offset;
+  const int32 output_offset = params.output_offset;
+  const int32 output_multiplier = params.output_multiplier;
+  const int output_shift = params.output_shift;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = output_shape.Dims(output_dims_count - 1);
+  const int accum_depth = weights.cols;
+  TFLITE_DCHECK_EQ(output_depth, weights.rows);
+
+  cpu_backend_threadpool::ExecuteSharded(
+      output_depth, SparseRowCost1x4(weights, batches), cpu_backend_context,
+      [&](int row_start, int row_end) {
+        for (int b = 0; b < batches; ++b) {
+          const int8* input = input_data + b * accum_depth;
+          int8* output = output_data + b * output_depth;
+          for (int r = row_start; r < row_end; ++r) {
+            int32 acc = SparseDot1x4(weights, r, input) +
+                        input_offset * weights.row_sums[r];
+            if (bias_data) {
+              acc += bias_data[r];
+            }
+            acc = MultiplyByQuantizedMultiplier(acc, output_multiplier,
+                                                output_shift);
+            acc += output_offset;
+            acc = std::max(acc, output_activation_min);
+            acc = std::min(acc, output_activation_max);
+            output[r] = static_cast<int8>(acc);
+          }
+        }
+      });
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_FULLY_CONNECTED_H_
@@ -0,0 +1,138 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/test_util.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace {
+
+enum class PoolType { kAverage, kMax, kL2 };
+
+// Runs the single-threaded and multi-threaded optimized float pooling
+// functions and asserts the values are the same.
+void RunOnePoolTest(PoolType pool_type, const PoolParams& params,
+                    const RuntimeShape& input_shape, const float* input_data,
+                    const RuntimeShape& output_shape) {
+  const int buffer_size = output_shape.FlatSize();
+  std::vector<float> expected_output(buffer_size);
+  std::vector<float> output(buffer_size);
+
+  CpuBackendContext cpu_backend_context;
+  cpu_backend_context.SetMaxNumThreads(4);
+  switch (pool_type) {
+    case PoolType::kAverage:
+      ASSERT_TRUE(optimized_ops::AveragePool(params, input_shape, input_data,
+                                             output_shape,
+                                             expected_output.data()));
+      ASSERT_TRUE(optimized_ops::AveragePool(params, input_shape, input_data,
+                                             output_shape, output.data(),
+                                             &cpu_backend_context));
+      break;
+    case PoolType::kMax:
+      optimized_ops::MaxPool(params, input_shape, input_data, output_shape,
+                             expected_output.data());
+      optimized_ops::MaxPool(params, input_shape, input_data, output_shape,
+                             output.data(), &cpu_backend_context);
+      break;
+    case PoolType::kL2:
+      optimized_ops::L2Pool(params, input_shape, input_data, output_shape,
+                            expected_output.data());
+      optimized_ops::L2Pool(params, input_shape, input_data, output_shape,
+                            output.data(), &cpu_backend_context);
+      break;
+  }
+
+  for (int i = 0; i < buffer_size; i++) {
+    ASSERT_NEAR(output[i], expected_output[i], 1e-5f) << "index " << i;
+  }
+}
+
+// Creates random input shape (batch, height, width, depth), computes the
+// output shape with padding "SAME" or "VALID", fills the input data and runs
+// the test function.
+void CreateDataAndRunPool(PoolType pool_type, bool padding_same) {
+  const int batch = UniformRandomInt(1, 2);
+  const int depth = UniformRandomInt(16, 64);
+  const int stride_width = UniformRandomInt(1, 3);
+  const int stride_height = UniformRandomInt(1, 3);
+  const int filter_width = UniformRandomInt(1, 5);
+  const int filter_height = UniformRandomInt(1, 5);
+  const int input_width = UniformRandomInt(20, 60) + filter_width;
+  const int input_height = UniformRandomInt(20, 60) + filter_height;
+  const int output_width =
+      padding_same ? (input_width + stride_width - 1) / stride_width
+                   : (input_width - filter_width + stride_width) / stride_width;
+  const int output_height =
+      padding_same
+          ? (input_height + stride_height - 1) / stride_height
+          : (input_height - filter_height + stride_height) / stride_height;
+
+  const RuntimeShape input_shape({batch, input_height, input_width, depth});
+  const RuntimeShape output_shape({batch, output_height, output_width, depth});
+  std::vector<float> input_data(input_shape.FlatSize());
+  FillRandom(&input_data, -1.0f, 1.0f);
+
+  PoolParams params;
+  params.stride_height = stride_height;
+  params.stride_width = stride_width;
+  params.filter_height = filter_height;
+  params.filter_width = filter_width;
+  params.float_activation_min = std::numeric_limits<float>::lowest();
+  params.float_activation_max = std::numeric_limits<float>::max();
+  auto compute_padding = [](int stride, int in_size, int filter_size,
+                            int out_size) {
+    int padding = ((out_size - 1) * stride + filter_size - in_size) / 2;
+    return padding > 0 ? padding : 0;
+  };
+  params.padding_values.width =
+      compute_padding(stride_width, input_width, filter_width, output_width);
+  params.padding_values.height = compute_padding(stride_height, input_height,
+                                                 filter_height, output_height);
+  RunOnePoolTest(pool_type, params, input_shape, input_data.data(),
+                 output_shape);
+}
+
+TEST(PoolingMultithreadTest, AveragePool) {
+  RandomEngine().seed(38291);
+  for (int i = 0; i < 20; i++) {
+    CreateDataAndRunPool(PoolType::kAverage, /*padding_same=*/true);
+    CreateDataAndRunPool(PoolType::kAverage, /*padding_same=*/false);
+  }
+}
+
+TEST(PoolingMultithreadTest, MaxPool) {
+  RandomEngine().seed(38291);
+  for (int i = 0; i < 20; i++) {
+    CreateDataAndRunPool(PoolType::kMax, /*padding_same=*/true);
+    CreateDataAndRunPool(PoolType::kMax, /*padding_same=*/false);
+  }
+}
+
+TEST(PoolingMultithreadTest, L2Pool) {
+  RandomEngine().seed(38291);
+  for (int i = 0; i < 20; i++) {
+    CreateDataAndRunPool(PoolType::kL2, /*padding_same=*/true);
+    CreateDataAndRunPool(PoolType::kL2, /*padding_same=*/false);
+  }
+}
+
+}  // namespace
+}  // namespace tflite
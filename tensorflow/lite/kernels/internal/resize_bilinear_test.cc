@@ -17,6 +17,7 @@ limitations under the License.
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/lite/kernels/internal/test_util.h"
@@ -138,5 +139,60 @@ TEST(ResizeBilinear2x2, TestResizeBilinear) {
                                  output_width, output_height, 1e-5);
   }
 }
+// Checks that splitting the rows across threads yields the same output.
+void TestOneMultithreadedResizeBilinear(int batch, int depth, int input_width,
+                                        int input_height, int output_width,
+                                        int output_height) {
+  RuntimeShape input_dims_inference({batch, input_height, input_width, depth});
+  RuntimeShape output_dims_inference(
+      {batch, output_height, output_width, depth});
+
+  std::vector<float> input_data(input_dims_inference.FlatSize(), 0);
+  std::vector<float> expected_output_data(output_dims_inference.FlatSize(), 0);
+  std::vector<float> output_data(output_dims_inference.FlatSize(), 3);
+  FillRandom(&input_data, 0.0f, 255.0f);
+
+  RuntimeShape output_size_dims({1, 1, 1, 2});
+  std::vector<int32> output_size_data = {output_height, output_width};
+
+  tflite::ResizeBilinearParams op_params;
+  op_params.align_corners = false;
+
+  CpuBackendContext cpu_backend_context;
+  cpu_backend_context.SetMaxNumThreads(4);
+  optimized_ops::ResizeBilinear(op_params, input_dims_inference,
+                                input_data.data(), output_size_dims,
+                                output_size_data.data(), output_dims_inference,
+                                expected_output_data.data());
+  optimized_ops::ResizeBilinear(
+      op_params, input_dims_inference, input_data.data(), output_size_dims,
+      output_size_data.data(), output_dims_inference, output_data.data(),
+      &cpu_backend_context);
+
+  for (size_t i = 0; i < output_data.size(); i++) {
+    ASSERT_EQ(output_data[i], expected_output_data[i]);
+  }
+}
+
+TEST(ResizeBilinear, TestMultithreadedResizeBilinear) {
+  RandomEngine().seed(38291);
+  const int kTestsToRun = 20;
+  for (int i = 0; i < kTestsToRun; i++) {
+    const int batch = UniformRandomInt(1, 2);
+    const int depth = UniformRandomInt(16, 64);
+    const int input_width = UniformRandomInt(20, 100);
+    const int input_height = UniformRandomInt(20, 100);
+    const int output_width = UniformRandomInt(50, 200);
+    const int output_height = UniformRandomInt(50, 200);
+
+    TestOneMultithreadedResizeBilinear(batch, depth, input_width,
+                                       input_height, output_width,
+                                       output_height);
+    TestOneMultithreadedResizeBilinear(batch, depth, input_width,
+                                       input_height, input_width * 2,
+                                       input_height * 2);
+  }
+}
+
 }  // namespace
 }  // namespace tflite
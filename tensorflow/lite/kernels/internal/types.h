@@ -97,6 +97,15 @@ enum class FullyConnectedWeightsFormat : uint8 {
   //   tensorflow/lite/toco/graph_transformations/ensure_uint8_weights_safe_for_fast_int8_kernels.cc
   //
   kShuffled4x16Int8,
+  // Same layout as kDefault, for weights pruned in blocks of 1x4 consecutive
+  // values along input_depth. The runtime may store the non-zero blocks
+  // separately and only multiply those, which pays off when most blocks are
+  // zero, e.g. in heavily pruned models.
+  kSparse1x4,
+  // Signed 4-bit weights, two per byte along input_depth, so the stored
+  // matrix is [output_depth, input_depth / 2] bytes. Only used by the hybrid
+  // kernel, which unpacks the nibbles inside its dot products.
+  kPackedInt4,
 };
 
 // Quantization parameters, determining the mapping of quantized values
@@ -855,6 +864,10 @@ struct FullyConnectedParams {
   float float_activation_min;
   float float_activation_max;
   FullyConnectedWeightsFormat weights_format;
+  // Whether the weights, respectively the input, are constant tensors, which
+  // lets the GEMM back-end cache their packed form.
+  bool lhs_cacheable = false;
+  bool rhs_cacheable = false;
 };
 
 struct GatherParams {
@@ -0,0 +1,478 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Per-kernel microbenchmarks.
+//
+// Runs conv, depthwise conv, fully connected and elementwise ops on a set of
+// representative shapes, for each supported type and each requested number of
+// threads, and reports the time per invocation. The results can be written as
+// JSON in the format of the Google benchmark library, so that they can be
+// compared across releases with its tools/compare.py script.
+//
+// Example:
+//   kernel_benchmark --num_threads=1,2,4 --filter=CONV_2D \
+//     --output_json=/tmp/kernels.json
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace {
+
+// A SingleOpModel whose inputs are all filled with random values before it is
+// timed. Weights are regular inputs, as in the kernel tests.
+class KernelBenchmarkModel : public SingleOpModel {
+ public:
+  // Fills every input tensor with values spread over its whole range.
+  void FillInputs(std::mt19937* random_engine) {
+    for (int index : interpreter_->inputs()) {
+      if (index == kOptionalTensor) continue;
+      TfLiteTensor* tensor = interpreter_->tensor(index);
+      const int size = NumElements(tensor);
+      switch (tensor->type) {
+        case kTfLiteFloat32:
+          Fill(std::uniform_real_distribution<float>(-1.0f, 1.0f), size,
+               tensor->data.f, random_engine);
+          break;
+        case kTfLiteInt32:
+          Fill(std::uniform_int_distribution<int32_t>(-1000, 1000), size,
+               tensor->data.i32, random_engine);
+          break;
+        case kTfLiteInt16:
+          Fill(std::uniform_int_distribution<int16_t>(-32767, 32767), size,
+               tensor->data.i16, random_engine);
+          break;
+        case kTfLiteInt8:
+          Fill(std::uniform_int_distribution<int16_t>(-127, 127), size,
+               tensor->data.int8, random_engine);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+ private:
+  template <typename Distribution, typename T>
+  static void Fill(Distribution distribution, int size, T* data,
+                   std::mt19937* random_engine) {
+    for (int i = 0; i < size; ++i) {
+      data[i] = static_cast<T>(distribution(*random_engine));
+    }
+  }
+};
+
+// The quantization ranges used for the quantized variants. int16 tensors use
+// the symmetric power-of-two range that the int16 kernels require.
+TensorData MakeTensor(TensorType type, std::vector<int> shape) {
+  switch (type) {
+    case TensorType_INT8:
+      return {type, shape, -4.0f, 4.0f};
+    case TensorType_INT16:
+      return {type, shape, -1.0f, 32767.0f / 32768.0f};
+    default:
+      return {type, shape};
+  }
+}
+
+// Returns per-channel quantized int8 weights, with the channel at
+// channel_index, or plain float weights.
+TensorData MakeWeights(TensorType type, std::vector<int> shape,
+                       int channel_index) {
+  if (type != TensorType_INT8) return {type, shape};
+  const int num_channels = shape[channel_index];
+  return {type,
+          shape,
+          /*min=*/0,
+          /*max=*/0,
+          /*scale=*/0,
+          /*zero_point=*/0,
+          /*per_channel_quantization=*/true,
+          std::vector<float>(num_channels, 1.0f / 127),
+          std::vector<int64_t>(num_channels, 0),
+          channel_index};
+}
+
+// Returns the bias matching the given input and per-channel weights.
+TensorData MakeBias(const TensorData& input, const TensorData& weights,
+                    int size) {
+  if (input.type != TensorType_INT8) return {input.type, {size}};
+  const float input_scale = (input.max - input.min) / 255;
+  std::vector<float> scales(size);
+  for (int i = 0; i < size; ++i) {
+    scales[i] = input_scale * weights.per_channel_quantization_scales[i];
+  }
+  return {TensorType_INT32,
+          {size},
+          /*min=*/0,
+          /*max=*/0,
+          /*scale=*/0,
+          /*zero_point=*/0,
+          /*per_channel_quantization=*/true,
+          scales,
+          std::vector<int64_t>(size, 0),
+          /*channel_index=*/0};
+}
+
+class ConvModel : public KernelBenchmarkModel {
+ public:
+  ConvModel(TensorType type, const std::vector<int>& input_shape,
+            int output_depth, int filter_size, int stride, int num_threads) {
+    const TensorData input = MakeTensor(type, input_shape);
+    const TensorData filter = MakeWeights(
+        type, {output_depth, filter_size, filter_size, input_shape[3]},
+        /*channel_index=*/0);
+    AddInput(input);
+    AddInput(filter);
+    AddInput(MakeBias(input, filter, output_depth));
+    AddOutput(MakeTensor(type, {}));
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_SAME, stride, stride,
+                                     ActivationFunctionType_NONE)
+                     .Union());
+    BuildInterpreter({}, num_threads);
+  }
+};
+
+class DepthwiseConvModel : public KernelBenchmarkModel {
+ public:
+  DepthwiseConvModel(TensorType type, const std::vector<int>& input_shape,
+                     int filter_size, int stride, int num_threads) {
+    const int depth = input_shape[3];
+    const TensorData input = MakeTensor(type, input_shape);
+    const TensorData filter =
+        MakeWeights(type, {1, filter_size, filter_size, depth},
+                    /*channel_index=*/3);
+    AddInput(input);
+    AddInput(filter);
+    AddInput(MakeBias(input, filter, depth));
+    AddOutput(MakeTensor(type, {}));
+    SetBuiltinOp(BuiltinOperator_DEPTHWISE_CONV_2D,
+                 BuiltinOptions_DepthwiseConv2DOptions,
+                 CreateDepthwiseConv2DOptions(builder_, Padding_SAME, stride,
+                                              stride, /*depth_multiplier=*/1,
+                                              ActivationFunctionType_NONE)
+                     .Union());
+    BuildInterpreter({}, num_threads);
+  }
+};
+
+class FullyConnectedModel : public KernelBenchmarkModel {
+ public:
+  // The int8 fully connected kernel takes per-tensor quantized weights.
+  FullyConnectedModel(TensorType type, int batches, int input_size,
+                      int output_size, int num_threads) {
+    const int input = AddInput(MakeTensor(type, {batches, input_size}));
+    if (type == TensorType_INT8) {
+      const int weights =
+          AddInput({type, {output_size, input_size}, -1.0f, 1.0f});
+      AddInput({TensorType_INT32,
+                {output_size},
+                /*min=*/0,
+                /*max=*/0,
+                /*scale=*/GetScale(input) * GetScale(weights)});
+    } else {
+      AddInput({type, {output_size, input_size}});
+      AddInput({type, {output_size}});
+    }
+    AddOutput(MakeTensor(type, {}));
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_NONE)
+            .Union());
+    BuildInterpreter({}, num_threads);
+  }
+};
+
+class ElementwiseModel : public KernelBenchmarkModel {
+ public:
+  ElementwiseModel(BuiltinOperator op, TensorType type,
+                   const std::vector<int>& shape, int num_threads) {
+    AddInput(MakeTensor(type, shape));
+    AddInput(MakeTensor(type, shape));
+    AddOutput(MakeTensor(type, {}));
+    if (op == BuiltinOperator_ADD) {
+      SetBuiltinOp(op, BuiltinOptions_AddOptions,
+                   CreateAddOptions(builder_).Union());
+    } else {
+      SetBuiltinOp(op, BuiltinOptions_MulOptions,
+                   CreateMulOptions(builder_).Union());
+    }
+    BuildInterpreter({}, num_threads);
+  }
+};
+
+using ModelFactory =
+    std::function<std::unique_ptr<KernelBenchmarkModel>(int num_threads)>;
+
+struct KernelBenchmark {
+  std::string name;
+  ModelFactory create_model;
+};
+
+const char* TypeName(TensorType type) {
+  switch (type) {
+    case TensorType_FLOAT32:
+      return "float32";
+    case TensorType_INT8:
+      return "int8";
+    case TensorType_INT16:
+      return "int16";
+    default:
+      return "unknown";
+  }
+}
+
+std::string ShapeName(const std::vector<int>& shape) {
+  std::string name;
+  for (size_t i = 0; i < shape.size(); ++i) {
+    if (i > 0) name += "x";
+    name += std::to_string(shape[i]);
+  }
+  return name;
+}
+
+// The sweep: shapes taken from common vision and speech models.
+std::vector<KernelBenchmark> GetKernelBenchmarks() {
+  std::vector<KernelBenchmark> benchmarks;
+  for (TensorType type : {TensorType_FLOAT32, TensorType_INT8}) {
+    struct ConvShape {
+      std::vector<int> input;
+      int output_depth, filter_size, stride;
+    };
+    for (const ConvShape& s : std::vector<ConvShape>{
+             {{1, 224, 224, 3}, 32, 3, 2},
+             {{1, 56, 56, 64}, 64, 3, 1},
+             {{1, 28, 28, 128}, 256, 1, 1},
+             {{1, 7, 7, 512}, 1024, 1, 1}}) {
+      benchmarks.push_back(
+          {std::string("CONV_2D/") + TypeName(type) + "/" +
+               ShapeName(s.input) + "/" + std::to_string(s.filter_size) + "x" +
+               std::to_string(s.filter_size) + "x" +
+               std::to_string(s.output_depth) + "/stride:" +
+               std::to_string(s.stride),
+           [type, s](int num_threads) {
+             return std::unique_ptr<KernelBenchmarkModel>(
+                 new ConvModel(type, s.input, s.output_depth, s.filter_size,
+                               s.stride, num_threads));
+           }});
+    }
+
+    struct DepthwiseShape {
+      std::vector<int> input;
+      int stride;
+    };
+    for (const DepthwiseShape& s : std::vector<DepthwiseShape>{
+             {{1, 112, 112, 32}, 1},
+             {{1, 56, 56, 128}, 2},
+             {{1, 14, 14, 512}, 1}}) {
+      benchmarks.push_back(
+          {std::string("DEPTHWISE_CONV_2D/") + TypeName(type) + "/" +
+               ShapeName(s.input) + "/3x3/stride:" + std::to_string(s.stride),
+           [type, s](int num_threads) {
+             return std::unique_ptr<KernelBenchmarkModel>(
+                 new DepthwiseConvModel(type, s.input, /*filter_size=*/3,
+                                        s.stride, num_threads));
+           }});
+    }
+
+    for (const std::vector<int>& s : std::vector<std::vector<int>>{
+             {1, 1024, 1000}, {8, 512, 512}, {32, 2048, 2048}}) {
+      benchmarks.push_back(
+          {std::string("FULLY_CONNECTED/") + TypeName(type) + "/" +
+               ShapeName(s),
+           [type, s](int num_threads) {
+             return std::unique_ptr<KernelBenchmarkModel>(
+                 new FullyConnectedModel(type, s[0], s[1], s[2], num_threads));
+           }});
+    }
+  }
+
+  for (TensorType type :
+       {TensorType_FLOAT32, TensorType_INT8, TensorType_INT16}) {
+    for (BuiltinOperator op : {BuiltinOperator_ADD, BuiltinOperator_MUL}) {
+      for (const std::vector<int>& shape : std::vector<std::vector<int>>{
+               {1, 56, 56, 64}, {1, 14, 14, 512}}) {
+        benchmarks.push_back(
+            {std::string(EnumNameBuiltinOperator(op)) + "/" + TypeName(type) +
+                 "/" + ShapeName(shape),
+             [op, type, shape](int num_threads) {
+               return std::unique_ptr<KernelBenchmarkModel>(
+                   new ElementwiseModel(op, type, shape, num_threads));
+             }});
+      }
+    }
+  }
+  return benchmarks;
+}
+
+struct BenchmarkResult {
+  std::string name;
+  int iterations;
+  // Per invocation, in microseconds.
+  double real_time;
+  double cpu_time;
+  double min_time;
+};
+
+bool RunKernelBenchmark(const KernelBenchmark& benchmark, int num_threads,
+                        int num_runs, int warmup_runs,
+                        BenchmarkResult* result) {
+  std::mt19937 random_engine(42);
+  std::unique_ptr<KernelBenchmarkModel> model =
+      benchmark.create_model(num_threads);
+  model->FillInputs(&random_engine);
+  for (int i = 0; i < warmup_runs; ++i) {
+    if (model->InvokeUnchecked() != kTfLiteOk) return false;
+  }
+
+  uint64_t min_time = std::numeric_limits<uint64_t>::max();
+  const std::clock_t cpu_start = std::clock();
+  const uint64_t start = profiling::time::NowMicros();
+  for (int i = 0; i < num_runs; ++i) {
+    const uint64_t run_start = profiling::time::NowMicros();
+    if (model->InvokeUnchecked() != kTfLiteOk) return false;
+    min_time = std::min(min_time, profiling::time::NowMicros() - run_start);
+  }
+  const uint64_t real_time = profiling::time::NowMicros() - start;
+  const double cpu_time =
+      1e6 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+  result->name = benchmark.name + "/threads:" + std::to_string(num_threads);
+  result->iterations = num_runs;
+  result->real_time = static_cast<double>(real_time) / num_runs;
+  result->cpu_time = cpu_time / num_runs;
+  result->min_time = min_time;
+  return true;
+}
+
+// Writes the results in the JSON format of the Google benchmark library.
+bool WriteJson(const std::vector<BenchmarkResult>& results,
+               const std::string& path) {
+  std::ofstream out(path);
+  if (!out) return false;
+  out << "{\n  \"context\": {\n"
+      << "    \"executable\": \"kernel_benchmark\",\n"
+      << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n"
+      << "  },\n  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& r = results[i];
+    out << "    {\n"
+        << "      \"name\": \"" << r.name << "\",\n"
+        << "      \"run_name\": \"" << r.name << "\",\n"
+        << "      \"run_type\": \"iteration\",\n"
+        << "      \"iterations\": " << r.iterations << ",\n"
+        << "      \"real_time\": " << r.real_time << ",\n"
+        << "      \"cpu_time\": " << r.cpu_time << ",\n"
+        << "      \"min_time\": " << r.min_time << ",\n"
+        << "      \"time_unit\": \"us\"\n"
+        << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+  return static_cast<bool>(out);
+}
+
+// Parses a comma-separated list of thread counts.
+bool ParseThreadCounts(const std::string& list, std::vector<int>* counts) {
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos) end = list.size();
+    const std::string item = list.substr(start, end - start);
+    char* parse_end = nullptr;
+    const long count = std::strtol(item.c_str(), &parse_end, 10);
+    if (item.empty() || *parse_end != '\0' || count < 1) return false;
+    counts->push_back(static_cast<int>(count));
+    start = end + 1;
+  }
+  return !counts->empty();
+}
+
+int Main(int argc, char** argv) {
+  std::string num_threads_list = "1";
+  std::string filter;
+  std::string output_json;
+  int num_runs = 50;
+  int warmup_runs = 5;
+  std::vector<Flag> flags = {
+      Flag::CreateFlag("num_threads", &num_threads_list,
+                       "comma-separated thread counts to run each kernel with"),
+      Flag::CreateFlag("filter", &filter,
+                       "only run the benchmarks whose name contains this"),
+      Flag::CreateFlag("num_runs", &num_runs, "timed invocations per kernel"),
+      Flag::CreateFlag("warmup_runs", &warmup_runs,
+                       "untimed invocations per kernel"),
+      Flag::CreateFlag("output_json", &output_json,
+                       "file to write the results to, in the Google benchmark "
+                       "JSON format"),
+  };
+  std::vector<int> thread_counts;
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flags) ||
+      !ParseThreadCounts(num_threads_list, &thread_counts) || num_runs < 1) {
+    fprintf(stderr, "%s", Flags::Usage(argv[0], flags).c_str());
+    return 1;
+  }
+
+  std::vector<BenchmarkResult> results;
+  bool all_ok = true;
+  printf("%-64s %12s %12s %12s\n", "Benchmark", "Time (us)", "CPU (us)",
+         "Min (us)");
+  for (const KernelBenchmark& benchmark : GetKernelBenchmarks()) {
+    if (benchmark.name.find(filter) == std::string::npos) continue;
+    for (int num_threads : thread_counts) {
+      BenchmarkResult result;
+      if (!RunKernelBenchmark(benchmark, num_threads, num_runs, warmup_runs,
+                              &result)) {
+        fprintf(stderr, "%s/threads:%d failed to run.\n",
+                benchmark.name.c_str(), num_threads);
+        all_ok = false;
+        continue;
+      }
+      printf("%-64s %12.1f %12.1f %12.1f\n", result.name.c_str(),
+             result.real_time, result.cpu_time, result.min_time);
+      results.push_back(result);
+    }
+  }
+
+  if (!output_json.empty() && !WriteJson(results, output_json)) {
+    fprintf(stderr, "Failed to write %s.\n", output_json.c_str());
+    return 1;
+  }
+  return all_ok ? 0 : 1;
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  return tflite::Main(argc, argv);
+}
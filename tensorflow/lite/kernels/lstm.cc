@@ -746,7 +746,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   if (is_hybrid_op) {
     node->temporaries = TfLiteIntArrayCreate(7);
   } else if (is_fully_quantized) {
-    node->temporaries = TfLiteIntArrayCreate(5);
+    node->temporaries = TfLiteIntArrayCreate(6);
   } else {
     node->temporaries = TfLiteIntArrayCreate(1);
   }
@@ -889,6 +889,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                                 scratch_buffer_size));
       }
     }
+
+    // Allocate a 16bit buffer for the input contributions to the four gates,
+    // which are computed with one GEMM per gate for the whole batch.
+    node->temporaries->data[5] = op_data->scratch_tensor_index + 5;
+    TfLiteTensor* input_gates = GetTemporary(context, node, /*index=*/5);
+    input_gates->type = kTfLiteInt16;
+    input_gates->allocation_type = kTfLiteArenaRw;
+    const int input_gates_dimension[2] = {n_batch, n_cell * 4};
+    if (!TfLiteIntArrayEqualsArray(input_gates->dims, 2,
+                                   input_gates_dimension)) {
+      TfLiteIntArray* input_gates_size = TfLiteIntArrayCreate(2);
+      input_gates_size->data[0] = n_batch;
+      input_gates_size->data[1] = n_cell * 4;
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_gates,
+                                                       input_gates_size));
+    }
   }
   return kTfLiteOk;
 }
@@ -983,7 +999,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           projection_bias, params, /*forward_sequence=*/true,
           /*time_major=*/true,
           /*output_offset=*/0, scratch_buffer, activation_state, cell_state,
-          output);
+          output, /*input_gates_scratch=*/nullptr,
+          CpuBackendContext::GetFromContext(context));
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
@@ -1030,6 +1047,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         TfLiteTensor* scratch2 = GetTemporary(context, node, /*index=*/2);
         TfLiteTensor* scratch3 = GetTemporary(context, node, /*index=*/3);
         TfLiteTensor* scratch4 = GetTemporary(context, node, /*index=*/4);
+        TfLiteTensor* input_gates = GetTemporary(context, node, /*index=*/5);
         return lstm_eval::EvalQuantized(
             input, input_to_input_weights, input_to_forget_weights,
             input_to_cell_weights, input_to_output_weights,
@@ -1042,7 +1060,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             cell_bias, output_gate_bias, projection_weights, projection_bias,
             params, &op_data->quantized_lstm_param, activation_state,
             cell_state, output, scratch0, scratch1, scratch2, scratch3,
-            scratch4);
+            scratch4, input_gates, CpuBackendContext::GetFromContext(context));
         return kTfLiteOk;
       }
     }
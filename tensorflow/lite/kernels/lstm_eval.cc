@@ -24,6 +24,7 @@ limitations under the License.
 #include "third_party/eigen3/Eigen/Core"
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
@@ -40,6 +41,62 @@ namespace {
 // norm lstm.
 const float kLayerNormEpsilon = 1e-8;
 
+// Computes gate_weights * input (+ gate_bias, if not null) for n_rows input
+// vectors of size n_input at once, storing the n_rows result vectors of size
+// n_cell contiguously in output. This is how the input contributions to the
+// gates are computed for a whole sequence before the recurrent steps.
+void MatrixBatchMatrixMultiply(const float* gate_weights,
+                               const float* gate_bias, int n_cell, int n_input,
+                               const float* input, int n_rows, float* output,
+                               CpuBackendContext* context) {
+  cpu_backend_gemm::MatrixParams<float> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = n_cell;
+  lhs_params.cols = n_input;
+  lhs_params.cacheable = true;
+  cpu_backend_gemm::MatrixParams<float> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = n_input;
+  rhs_params.cols = n_rows;
+  cpu_backend_gemm::MatrixParams<float> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = n_cell;
+  dst_params.cols = n_rows;
+  cpu_backend_gemm::GemmParams<float, float> gemm_params;
+  gemm_params.bias = gate_bias;
+  cpu_backend_gemm::Gemm(lhs_params, gate_weights, rhs_params, input,
+                         dst_params, output, gemm_params, context);
+}
+
+// Same as above for int8 weights and inputs, rescaling the int32 accumulators
+// by the effective scale (a, b) and saturating them to int16 as the int8 x
+// int16 MatrixBatchVectorMultiplyAccumulate does.
+void MatrixBatchMatrixMultiply(const int8_t* gate_weights, int32_t scale_a,
+                               int32_t scale_b, int n_cell, int n_input,
+                               const int8_t* input, int32_t input_zp,
+                               int n_rows, int16_t* output,
+                               CpuBackendContext* context) {
+  cpu_backend_gemm::MatrixParams<int8_t> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = n_cell;
+  lhs_params.cols = n_input;
+  lhs_params.cacheable = true;
+  cpu_backend_gemm::MatrixParams<int8_t> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = n_input;
+  rhs_params.cols = n_rows;
+  rhs_params.zero_point = input_zp;
+  cpu_backend_gemm::MatrixParams<int16_t> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = n_cell;
+  dst_params.cols = n_rows;
+  cpu_backend_gemm::GemmParams<int32_t, int16_t> gemm_params;
+  gemm_params.multiplier_fixedpoint = scale_a;
+  gemm_params.multiplier_exponent = scale_b;
+  cpu_backend_gemm::Gemm(lhs_params, gate_weights, rhs_params, input,
+                         dst_params, output, gemm_params, context);
+}
+
 // Performs an LSTM batch inference step for input specified by input_ptr_batch.
 // The LSTM cell is specified by the pointers to its weights (*_weights_ptr) and
 // biases (*_bias_ptr), and buffers (*_scratch), along with additional
@@ -98,6 +155,10 @@ const float kLayerNormEpsilon = 1e-8;
 // for bidirectional LSTMs with merge_outputs. In this case, the batched
 // operations cannot be used since they assume that the batched outputs are
 // contiguous, and we manually loop over the batched outputs.
+//
+// If input_gates_precomputed is true, the gate scratch buffers already hold
+// input_weight * input (plus the gate biases, unless this is a layer norm
+// lstm) and only the auxiliary and recurrent contributions are added here.
 inline void LstmStepWithAuxInput(
     const float* input_ptr_batch, const float* input_to_input_weights_ptr,
     const float* input_to_forget_weights_ptr,
@@ -125,7 +186,7 @@ inline void LstmStepWithAuxInput(
     int n_aux_input, int n_output, int output_batch_leading_dim,
     float* output_state_ptr, float* cell_state_ptr, float* input_gate_scratch,
     float* forget_gate_scratch, float* cell_scratch, float* output_gate_scratch,
-    float* output_ptr_batch) {
+    float* output_ptr_batch, bool input_gates_precomputed) {
 #ifdef GEMMLOWP_PROFILING
   gemmlowp::ScopedProfilingLabel label("LstmStepWithAuxInputFloat");
 #endif
@@ -136,45 +197,47 @@ inline void LstmStepWithAuxInput(
   const bool is_layer_norm_lstm =
       (forget_layer_norm_coefficients_ptr != nullptr);
 
-  // Initialize scratch buffers with bias for regular lstm or initialize with
-  // zero for layer norm lstm.
-  if (is_layer_norm_lstm) {
-    if (!use_cifg) {
-      std::fill_n(input_gate_scratch, n_cell * n_batch, 0.0f);
+  if (!input_gates_precomputed) {
+    // Initialize scratch buffers with bias for regular lstm or initialize with
+    // zero for layer norm lstm.
+    if (is_layer_norm_lstm) {
+      if (!use_cifg) {
+        std::fill_n(input_gate_scratch, n_cell * n_batch, 0.0f);
+      }
+      std::fill_n(forget_gate_scratch, n_cell * n_batch, 0.0f);
+      std::fill_n(cell_scratch, n_cell * n_batch, 0.0f);
+      std::fill_n(output_gate_scratch, n_cell * n_batch, 0.0f);
+    } else {
+      if (!use_cifg) {
+        tensor_utils::VectorBatchVectorAssign(input_gate_bias_ptr, n_cell,
+                                              n_batch, input_gate_scratch);
+      }
+      tensor_utils::VectorBatchVectorAssign(forget_gate_bias_ptr, n_cell,
+                                            n_batch, forget_gate_scratch);
+      tensor_utils::VectorBatchVectorAssign(cell_bias_ptr, n_cell, n_batch,
+                                            cell_scratch);
+      tensor_utils::VectorBatchVectorAssign(output_gate_bias_ptr, n_cell,
+                                            n_batch, output_gate_scratch);
     }
-    std::fill_n(forget_gate_scratch, n_cell * n_batch, 0.0f);
-    std::fill_n(cell_scratch, n_cell * n_batch, 0.0f);
-    std::fill_n(output_gate_scratch, n_cell * n_batch, 0.0f);
-  } else {
+
+    // For each batch and cell: compute input_weight * input.
     if (!use_cifg) {
-      tensor_utils::VectorBatchVectorAssign(input_gate_bias_ptr, n_cell,
-                                            n_batch, input_gate_scratch);
+      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+          input_to_input_weights_ptr, n_cell, n_input, input_ptr_batch,
+          n_batch, input_gate_scratch, /*result_stride=*/1);
     }
-    tensor_utils::VectorBatchVectorAssign(forget_gate_bias_ptr, n_cell, n_batch,
-                                          forget_gate_scratch);
-    tensor_utils::VectorBatchVectorAssign(cell_bias_ptr, n_cell, n_batch,
-                                          cell_scratch);
-    tensor_utils::VectorBatchVectorAssign(output_gate_bias_ptr, n_cell, n_batch,
-                                          output_gate_scratch);
-  }
 
-  // For each batch and cell: compute input_weight * input.
-  if (!use_cifg) {
     tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        input_to_input_weights_ptr, n_cell, n_input, input_ptr_batch, n_batch,
-        input_gate_scratch, /*result_stride=*/1);
+        input_to_forget_weights_ptr, n_cell, n_input, input_ptr_batch, n_batch,
+        forget_gate_scratch, /*result_stride=*/1);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_cell_weights_ptr, n_cell, n_input, input_ptr_batch, n_batch,
+        cell_scratch, /*result_stride=*/1);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_output_weights_ptr, n_cell, n_input, input_ptr_batch, n_batch,
+        output_gate_scratch, /*result_stride=*/1);
   }
 
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_to_forget_weights_ptr, n_cell, n_input, input_ptr_batch, n_batch,
-      forget_gate_scratch, /*result_stride=*/1);
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_to_cell_weights_ptr, n_cell, n_input, input_ptr_batch, n_batch,
-      cell_scratch, /*result_stride=*/1);
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_to_output_weights_ptr, n_cell, n_input, input_ptr_batch, n_batch,
-      output_gate_scratch, /*result_stride=*/1);
-
   // If auxiliary input is available then compute aux_input_weight * aux_input
   if (aux_input_ptr_batch != nullptr) {
     if (!use_cifg) {
@@ -936,18 +999,24 @@ inline void LstmStepQuantized(
     int32 n_cell, int32 n_input, int32 n_output, int32 output_batch_leading_dim,
     int8_t* activation_ptr, int32_t activation_zp, int16_t* cell_ptr,
     int8_t* output_ptr, int16_t* scratch_0_ptr, int16_t* scratch_1_ptr,
-    int16_t* scratch_2_ptr, int16_t* scratch_3_ptr, int8_t* scratch_4_ptr) {
-  // Set scratch to 0.
-  memset(scratch_0_ptr, 0, n_batch * n_cell * sizeof(int16_t));
-  memset(scratch_1_ptr, 0, n_batch * n_cell * sizeof(int16_t));
-  memset(scratch_2_ptr, 0, n_batch * n_cell * sizeof(int16_t));
-  memset(scratch_3_ptr, 0, n_batch * n_cell * sizeof(int16_t));
+    int16_t* scratch_2_ptr, int16_t* scratch_3_ptr, int8_t* scratch_4_ptr,
+    bool input_gates_precomputed) {
+  // Set scratch to 0, unless it already holds the input contributions to the
+  // gates, in which case the input matmuls below are skipped as well.
+  if (!input_gates_precomputed) {
+    memset(scratch_0_ptr, 0, n_batch * n_cell * sizeof(int16_t));
+    memset(scratch_1_ptr, 0, n_batch * n_cell * sizeof(int16_t));
+    memset(scratch_2_ptr, 0, n_batch * n_cell * sizeof(int16_t));
+    memset(scratch_3_ptr, 0, n_batch * n_cell * sizeof(int16_t));
+  }
 
   // Forget gate.
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_ptr, input_zp, input_to_forget_weight_ptr,
-      effective_input_to_forget_scale_a, effective_input_to_forget_scale_b,
-      nullptr, n_batch, n_input, n_cell, 0, scratch_1_ptr);
+  if (!input_gates_precomputed) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_ptr, input_zp, input_to_forget_weight_ptr,
+        effective_input_to_forget_scale_a, effective_input_to_forget_scale_b,
+        nullptr, n_batch, n_input, n_cell, 0, scratch_1_ptr);
+  }
 
   tensor_utils::MatrixBatchVectorMultiplyAccumulate(
       activation_ptr, activation_zp, recurrent_to_forget_weight_ptr,
@@ -963,10 +1032,12 @@ inline void LstmStepQuantized(
   tensor_utils::ApplySigmoid(scratch_1_ptr, n_batch, n_cell, scratch_1_ptr);
 
   // Modulation gate.
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_ptr, input_zp, input_to_cell_weight_ptr,
-      effective_input_to_cell_scale_a, effective_input_to_cell_scale_b, nullptr,
-      n_batch, n_input, n_cell, 0, scratch_2_ptr);
+  if (!input_gates_precomputed) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_ptr, input_zp, input_to_cell_weight_ptr,
+        effective_input_to_cell_scale_a, effective_input_to_cell_scale_b,
+        nullptr, n_batch, n_input, n_cell, 0, scratch_2_ptr);
+  }
 
   tensor_utils::MatrixBatchVectorMultiplyAccumulate(
       activation_ptr, activation_zp, recurrent_to_cell_weight_ptr,
@@ -981,10 +1052,12 @@ inline void LstmStepQuantized(
   tensor_utils::ApplyTanh3(scratch_2_ptr, n_batch, n_cell, scratch_2_ptr);
 
   // Ouptut gate.
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_ptr, input_zp, input_to_output_weight_ptr,
-      effective_input_to_output_scale_a, effective_input_to_output_scale_b,
-      nullptr, n_batch, n_input, n_cell, 0, scratch_3_ptr);
+  if (!input_gates_precomputed) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_ptr, input_zp, input_to_output_weight_ptr,
+        effective_input_to_output_scale_a, effective_input_to_output_scale_b,
+        nullptr, n_batch, n_input, n_cell, 0, scratch_3_ptr);
+  }
 
   tensor_utils::MatrixBatchVectorMultiplyAccumulate(
       activation_ptr, activation_zp, recurrent_to_output_weight_ptr,
@@ -1000,10 +1073,12 @@ inline void LstmStepQuantized(
   tensor_utils::ApplySigmoid(scratch_3_ptr, n_batch, n_cell, scratch_3_ptr);
 
   // Input gate.
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_ptr, input_zp, input_to_input_weight_ptr,
-      effective_input_to_input_scale_a, effective_input_to_input_scale_b,
-      nullptr, n_batch, n_input, n_cell, 0, scratch_0_ptr);
+  if (!input_gates_precomputed) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_ptr, input_zp, input_to_input_weight_ptr,
+        effective_input_to_input_scale_a, effective_input_to_input_scale_b,
+        nullptr, n_batch, n_input, n_cell, 0, scratch_0_ptr);
+  }
 
   tensor_utils::MatrixBatchVectorMultiplyAccumulate(
       activation_ptr, activation_zp, recurrent_to_input_weight_ptr,
@@ -1081,7 +1156,8 @@ TfLiteStatus EvalFloat(
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
     int output_offset, TfLiteTensor* scratch_buffer,
     TfLiteTensor* activation_state, TfLiteTensor* cell_state,
-    TfLiteTensor* output) {
+    TfLiteTensor* output, TfLiteTensor* input_gates_scratch,
+    CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   int max_time, n_batch;
   if (input->dims->size == 3) {
@@ -1162,6 +1238,41 @@ TfLiteStatus EvalFloat(
     aux_input_to_output_weights_ptr = aux_input_to_output_weights->data.f;
   }
 
+  // Compute the input contributions to the gates of all the time steps up
+  // front, one GEMM per gate. The gate biases are folded in unless layer norm
+  // is used, in which case they are added after the normalization. Row r of
+  // each gate block matches row r of the input, whatever the input layout.
+  const bool precompute_input_gates = (input_gates_scratch != nullptr);
+  float* input_gate_inputs = nullptr;
+  float* forget_gate_inputs = nullptr;
+  float* cell_gate_inputs = nullptr;
+  float* output_gate_inputs = nullptr;
+  if (precompute_input_gates) {
+    const int n_rows = max_time * n_batch;
+    input_gate_inputs = input_gates_scratch->data.f;
+    forget_gate_inputs = input_gate_inputs + n_rows * n_cell;
+    cell_gate_inputs = input_gate_inputs + 2 * n_rows * n_cell;
+    output_gate_inputs = input_gate_inputs + 3 * n_rows * n_cell;
+    if (!use_cifg) {
+      MatrixBatchMatrixMultiply(
+          input_to_input_weights_ptr,
+          is_layer_norm_lstm ? nullptr : input_gate_bias_ptr, n_cell, n_input,
+          input->data.f, n_rows, input_gate_inputs, context);
+    }
+    MatrixBatchMatrixMultiply(
+        input_to_forget_weights->data.f,
+        is_layer_norm_lstm ? nullptr : forget_gate_bias->data.f, n_cell,
+        n_input, input->data.f, n_rows, forget_gate_inputs, context);
+    MatrixBatchMatrixMultiply(
+        input_to_cell_weights->data.f,
+        is_layer_norm_lstm ? nullptr : cell_bias->data.f, n_cell, n_input,
+        input->data.f, n_rows, cell_gate_inputs, context);
+    MatrixBatchMatrixMultiply(
+        input_to_output_weights->data.f,
+        is_layer_norm_lstm ? nullptr : output_gate_bias->data.f, n_cell,
+        n_input, input->data.f, n_rows, output_gate_inputs, context);
+  }
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1178,6 +1289,13 @@ TfLiteStatus EvalFloat(
       }
       float* output_ptr_time =
           output->data.f + t_rel * output_step + output_offset;
+      if (precompute_input_gates) {
+        const int gates_offset = t_rel * n_batch * n_cell;
+        input_gate_scratch = input_gate_inputs + gates_offset;
+        forget_gate_scratch = forget_gate_inputs + gates_offset;
+        cell_scratch = cell_gate_inputs + gates_offset;
+        output_gate_scratch = output_gate_inputs + gates_offset;
+      }
 
       LstmStepWithAuxInput(
           input_ptr_batch, input_to_input_weights_ptr,
@@ -1196,7 +1314,8 @@ TfLiteStatus EvalFloat(
           params, n_batch, n_cell, n_input, aux_input_size, n_output,
           output_batch_leading_dim, activation_state->data.f,
           cell_state->data.f, input_gate_scratch, forget_gate_scratch,
-          cell_scratch, output_gate_scratch, output_ptr_time);
+          cell_scratch, output_gate_scratch, output_ptr_time,
+          precompute_input_gates);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
@@ -1224,6 +1343,13 @@ TfLiteStatus EvalFloat(
         float* forget_gate_scratch_ptr = forget_gate_scratch + b * n_cell;
         float* cell_scratch_ptr = cell_scratch + b * n_cell;
         float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
+        if (precompute_input_gates) {
+          const int gates_offset = time_offset * n_cell;
+          input_gate_scratch_ptr = input_gate_inputs + gates_offset;
+          forget_gate_scratch_ptr = forget_gate_inputs + gates_offset;
+          cell_scratch_ptr = cell_gate_inputs + gates_offset;
+          output_gate_scratch_ptr = output_gate_inputs + gates_offset;
+        }
 
         LstmStepWithAuxInput(
             input_ptr, input_to_input_weights_ptr,
@@ -1245,7 +1371,7 @@ TfLiteStatus EvalFloat(
             aux_input_size, n_output, output_batch_leading_dim,
             activation_state_ptr, cell_state_ptr, input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_scratch_ptr, output_gate_scratch_ptr,
-            output_ptr);
+            output_ptr, precompute_input_gates);
       }
     }
   }
@@ -1580,7 +1706,8 @@ TfLiteStatus EvalQuantized(
     const lstm_eval::QuantizedLstmParameter* quantized_lstm_param,
     TfLiteTensor* activation_state, TfLiteTensor* cell_state,
     TfLiteTensor* output, TfLiteTensor* scratch0, TfLiteTensor* scratch1,
-    TfLiteTensor* scratch2, TfLiteTensor* scratch3, TfLiteTensor* scratch4) {
+    TfLiteTensor* scratch2, TfLiteTensor* scratch3, TfLiteTensor* scratch4,
+    TfLiteTensor* input_gates_scratch, CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   const int n_input = input->dims->data[input->dims->size - 1];
   int max_time, n_batch;
@@ -1684,10 +1811,62 @@ TfLiteStatus EvalQuantized(
   const int input_step = n_batch * n_input;
   const int output_step = n_batch * output_batch_leading_dim;
 
+  // Compute the input contributions to the gates of all the time steps up
+  // front, one GEMM per gate, in the same layout as the step scratch buffers.
+  const bool precompute_input_gates = (input_gates_scratch != nullptr);
+  const int gates_step = n_batch * n_cell;
+  int16_t* input_gate_inputs = nullptr;
+  int16_t* forget_gate_inputs = nullptr;
+  int16_t* cell_gate_inputs = nullptr;
+  int16_t* output_gate_inputs = nullptr;
+  if (precompute_input_gates) {
+    const int n_rows = max_time * n_batch;
+    input_gate_inputs = input_gates_scratch->data.i16;
+    forget_gate_inputs = input_gate_inputs + n_rows * n_cell;
+    cell_gate_inputs = input_gate_inputs + 2 * n_rows * n_cell;
+    output_gate_inputs = input_gate_inputs + 3 * n_rows * n_cell;
+    if (!use_cifg) {
+      MatrixBatchMatrixMultiply(
+          input_to_input_weight_ptr,
+          quantized_lstm_param->effective_input_to_input_scale_a,
+          quantized_lstm_param->effective_input_to_input_scale_b, n_cell,
+          n_input, input->data.int8, input_zp, n_rows, input_gate_inputs,
+          context);
+    }
+    MatrixBatchMatrixMultiply(
+        input_to_forget_weight_ptr,
+        quantized_lstm_param->effective_input_to_forget_scale_a,
+        quantized_lstm_param->effective_input_to_forget_scale_b, n_cell,
+        n_input, input->data.int8, input_zp, n_rows, forget_gate_inputs,
+        context);
+    MatrixBatchMatrixMultiply(
+        input_to_cell_weight_ptr,
+        quantized_lstm_param->effective_input_to_cell_scale_a,
+        quantized_lstm_param->effective_input_to_cell_scale_b, n_cell, n_input,
+        input->data.int8, input_zp, n_rows, cell_gate_inputs, context);
+    MatrixBatchMatrixMultiply(
+        input_to_output_weight_ptr,
+        quantized_lstm_param->effective_input_to_output_scale_a,
+        quantized_lstm_param->effective_input_to_output_scale_b, n_cell,
+        n_input, input->data.int8, input_zp, n_rows, output_gate_inputs,
+        context);
+  }
+
   for (int t = 0; t < max_time; t++) {
     const int t_rel = t;
     output_ptr = output->data.int8 + t_rel * output_step;
 
+    int16_t* scratch0_ptr = scratch0->data.i16;
+    int16_t* scratch1_ptr = scratch1->data.i16;
+    int16_t* scratch2_ptr = scratch2->data.i16;
+    int16_t* scratch3_ptr = scratch3->data.i16;
+    if (precompute_input_gates) {
+      scratch0_ptr = input_gate_inputs + t_rel * gates_step;
+      scratch1_ptr = forget_gate_inputs + t_rel * gates_step;
+      scratch2_ptr = cell_gate_inputs + t_rel * gates_step;
+      scratch3_ptr = output_gate_inputs + t_rel * gates_step;
+    }
+
     // Input can be int8 asymmetric or int16 symmetric.
     const int8_t* input_ptr = input->data.int8 + t_rel * input_step;
     LstmStepQuantized(
@@ -1743,8 +1922,8 @@ TfLiteStatus EvalQuantized(
         quantized_lstm_param->quantized_proj_clip,
         quantized_lstm_param->inv_large_value.data(), n_batch, n_cell, n_input,
         n_output, output_batch_leading_dim, activation_ptr, activation_zp,
-        cell_ptr, output_ptr, scratch0->data.i16, scratch1->data.i16,
-        scratch2->data.i16, scratch3->data.i16, scratch4->data.int8);
+        cell_ptr, output_ptr, scratch0_ptr, scratch1_ptr, scratch2_ptr,
+        scratch3_ptr, scratch4->data.int8, precompute_input_gates);
   }
 
   return kTfLiteOk;
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 
 namespace tflite {
 namespace ops {
@@ -66,6 +67,11 @@ struct QuantizedLstmParameter {
   std::vector<int32_t> inv_large_value;
 };
 
+// If input_gates_scratch is not null, it must hold max_time * n_batch * n_cell
+// values for each of the four gates, and the input contributions to the gates
+// are computed for all the time steps with one GEMM per gate before the
+// recurrence runs. Otherwise they are computed one time step at a time and
+// the context is not used.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -93,7 +99,8 @@ TfLiteStatus EvalFloat(
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
     int output_offset, TfLiteTensor* scratch_buffer,
     TfLiteTensor* activation_state, TfLiteTensor* cell_state,
-    TfLiteTensor* output);
+    TfLiteTensor* output, TfLiteTensor* input_gates_scratch,
+    CpuBackendContext* context);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -127,6 +134,7 @@ TfLiteStatus EvalHybrid(
     TfLiteTensor* cell_state_quantized, TfLiteTensor* output_state,
     TfLiteTensor* cell_state, TfLiteTensor* output);
 
+// input_gates_scratch is optional as for EvalFloat, and holds int16 values.
 TfLiteStatus EvalQuantized(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -150,7 +158,8 @@ TfLiteStatus EvalQuantized(
     const lstm_eval::QuantizedLstmParameter* quantized_lstm_param,
     TfLiteTensor* activation_state, TfLiteTensor* cell_state,
     TfLiteTensor* output, TfLiteTensor* scratch0, TfLiteTensor* scratch1,
-    TfLiteTensor* scratch2, TfLiteTensor* scratch3, TfLiteTensor* scratch4);
+    TfLiteTensor* scratch2, TfLiteTensor* scratch3, TfLiteTensor* scratch4,
+    TfLiteTensor* input_gates_scratch, CpuBackendContext* context);
 
 }  // namespace lstm_eval
 }  // namespace builtin
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/c_api_internal.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/integer_ops/pooling.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/pooling.h"
@@ -115,26 +116,29 @@ TfLiteStatus AverageEvalFloat(TfLiteContext* context, TfLiteNode* node,
   float activation_min, activation_max;
   CalculateActivationRange(params->activation, &activation_min,
                            &activation_max);
-#define TF_LITE_AVERAGE_POOL(type)                                            \
-  tflite::PoolParams op_params;                                               \
-  op_params.stride_height = params->stride_height;                            \
-  op_params.stride_width = params->stride_width;                              \
-  op_params.filter_height = params->filter_height;                            \
-  op_params.filter_width = params->filter_width;                              \
-  op_params.padding_values.height = data->padding.height;                     \
-  op_params.padding_values.width = data->padding.width;                       \
-  op_params.float_activation_min = activation_min;                            \
-  op_params.float_activation_max = activation_max;                            \
-  TF_LITE_ENSURE(context, type::AveragePool(op_params, GetTensorShape(input), \
-                                            GetTensorData<float>(input),      \
-                                            GetTensorShape(output),           \
-                                            GetTensorData<float>(output)))
+  tflite::PoolParams op_params;
+  op_params.stride_height = params->stride_height;
+  op_params.stride_width = params->stride_width;
+  op_params.filter_height = params->filter_height;
+  op_params.filter_width = params->filter_width;
+  op_params.padding_values.height = data->padding.height;
+  op_params.padding_values.width = data->padding.width;
+  op_params.float_activation_min = activation_min;
+  op_params.float_activation_max = activation_max;
   if (kernel_type == kReference) {
-    TF_LITE_AVERAGE_POOL(reference_ops);
+    TF_LITE_ENSURE(context, reference_ops::AveragePool(
+                                op_params, GetTensorShape(input),
+                                GetTensorData<float>(input),
+                                GetTensorShape(output),
+                                GetTensorData<float>(output)));
   } else {
-    TF_LITE_AVERAGE_POOL(optimized_ops);
+    TF_LITE_ENSURE(context, optimized_ops::AveragePool(
+                                op_params, GetTensorShape(input),
+                                GetTensorData<float>(input),
+                                GetTensorShape(output),
+                                GetTensorData<float>(output),
+                                CpuBackendContext::GetFromContext(context)));
   }
-#undef TF_LITE_AVERAGE_POOL
   return kTfLiteOk;
 }
 
@@ -209,24 +213,25 @@ void MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
   float activation_min, activation_max;
   CalculateActivationRange(params->activation, &activation_min,
                            &activation_max);
-#define TF_LITE_MAX_POOL(type)                                                 \
-  tflite::PoolParams op_params;                                                \
-  op_params.stride_height = params->stride_height;                             \
-  op_params.stride_width = params->stride_width;                               \
-  op_params.filter_height = params->filter_height;                             \
-  op_params.filter_width = params->filter_width;                               \
-  op_params.padding_values.height = data->padding.height;                      \
-  op_params.padding_values.width = data->padding.width;                        \
-  op_params.float_activation_min = activation_min;                             \
-  op_params.float_activation_max = activation_max;                             \
-  type::MaxPool(op_params, GetTensorShape(input), GetTensorData<float>(input), \
-                GetTensorShape(output), GetTensorData<float>(output))
+  tflite::PoolParams op_params;
+  op_params.stride_height = params->stride_height;
+  op_params.stride_width = params->stride_width;
+  op_params.filter_height = params->filter_height;
+  op_params.filter_width = params->filter_width;
+  op_params.padding_values.height = data->padding.height;
+  op_params.padding_values.width = data->padding.width;
+  op_params.float_activation_min = activation_min;
+  op_params.float_activation_max = activation_max;
   if (kernel_type == kReference) {
-    TF_LITE_MAX_POOL(reference_ops);
+    reference_ops::MaxPool(op_params, GetTensorShape(input),
+                           GetTensorData<float>(input), GetTensorShape(output),
+                           GetTensorData<float>(output));
   } else {
-    TF_LITE_MAX_POOL(optimized_ops);
+    optimized_ops::MaxPool(op_params, GetTensorShape(input),
+                           GetTensorData<float>(input), GetTensorShape(output),
+                           GetTensorData<float>(output),
+                           CpuBackendContext::GetFromContext(context));
   }
-#undef TF_LITE_MAX_POOL
 }
 
 template <KernelType kernel_type>
@@ -294,24 +299,25 @@ void L2EvalFloat(TfLiteContext* context, TfLiteNode* node,
   float activation_min, activation_max;
   CalculateActivationRange(params->activation, &activation_min,
                            &activation_max);
-#define TF_LITE_L2_POOL(type)                                                 \
-  tflite::PoolParams op_params;                                               \
-  op_params.stride_height = params->stride_height;                            \
-  op_params.stride_width = params->stride_width;                              \
-  op_params.filter_height = params->filter_height;                            \
-  op_params.filter_width = params->filter_width;                              \
-  op_params.padding_values.height = data->padding.height;                     \
-  op_params.padding_values.width = data->padding.width;                       \
-  op_params.float_activation_min = activation_min;                            \
-  op_params.float_activation_max = activation_max;                            \
-  type::L2Pool(op_params, GetTensorShape(input), GetTensorData<float>(input), \
-               GetTensorShape(output), GetTensorData<float>(output))
+  tflite::PoolParams op_params;
+  op_params.stride_height = params->stride_height;
+  op_params.stride_width = params->stride_width;
+  op_params.filter_height = params->filter_height;
+  op_params.filter_width = params->filter_width;
+  op_params.padding_values.height = data->padding.height;
+  op_params.padding_values.width = data->padding.width;
+  op_params.float_activation_min = activation_min;
+  op_params.float_activation_max = activation_max;
   if (kernel_type == kReference) {
-    TF_LITE_L2_POOL(reference_ops);
+    reference_ops::L2Pool(op_params, GetTensorShape(input),
+                          GetTensorData<float>(input), GetTensorShape(output),
+                          GetTensorData<float>(output));
   } else {
-    TF_LITE_L2_POOL(optimized_ops);
+    optimized_ops::L2Pool(op_params, GetTensorShape(input),
+                          GetTensorData<float>(input), GetTensorShape(output),
+                          GetTensorData<float>(output),
+                          CpuBackendContext::GetFromContext(context));
   }
-#undef TF_LITE_L2_POOL
 }
 
 #undef TF_LITE_KERNEL_TYPE_DISPATCH
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/c_api_internal.h"
 #include "tensorflow/lite/kernels/activation_functor.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -97,7 +98,8 @@ enum TemporaryTensor {
   kScalingFactors = 4,
   kProductScalingFactors = 5,
   kRecoveredCellWeights = 6,
-  kNumTemporaryTensors = 7
+  kInputGates = 7,
+  kNumTemporaryTensors = 8
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -384,9 +386,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TfLiteIntArrayFree(node->temporaries);
   if (IsHybridOp(input, input_to_output_weights)) {
-    node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors);
+    // The hybrid kernel uses all the temporaries but the input gates buffer,
+    // which is the last one.
+    node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors - 1);
   } else {
-    node->temporaries = TfLiteIntArrayCreate(1);
+    // The float kernel uses the scratch buffer and the input gates buffer.
+    node->temporaries = TfLiteIntArrayCreate(2);
   }
   node->temporaries->data[0] = scratch_tensor_index;
 
@@ -410,6 +415,26 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
+  if (!IsHybridOp(input, input_to_output_weights)) {
+    // Allocate a buffer for the input contributions to the four gates at
+    // every time step, which are computed with one GEMM per gate before the
+    // recurrence.
+    node->temporaries->data[1] = scratch_tensor_index + kInputGates;
+    TfLiteTensor* input_gates = GetTemporary(context, node, /*index=*/1);
+    input_gates->type = input->type;
+    input_gates->allocation_type = kTfLiteArenaRw;
+    const int input_gates_dimension[2] = {NumElements(input) / n_input,
+                                          n_cell * 4};
+    if (!TfLiteIntArrayEqualsArray(input_gates->dims, 2,
+                                   input_gates_dimension)) {
+      TfLiteIntArray* input_gates_size = TfLiteIntArrayCreate(2);
+      input_gates_size->data[0] = input_gates_dimension[0];
+      input_gates_size->data[1] = input_gates_dimension[1];
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, input_gates,
+                                                       input_gates_size));
+    }
+  }
+
   if (IsHybridOp(input, input_to_output_weights)) {
     // Allocate temporary tensors to store quantized values of input,
     // activation_state and cell_state tensors.
@@ -588,6 +613,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   switch (input_to_output_weights->type) {
     case kTfLiteFloat32: {
+      TfLiteTensor* input_gates = GetTemporary(context, node, /*index=*/1);
       return lstm_eval::EvalFloat(
           input, input_to_input_weights, input_to_forget_weights,
           input_to_cell_weights, input_to_output_weights,
@@ -604,7 +630,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           forget_gate_bias, cell_bias, output_gate_bias, projection_weights,
           projection_bias, &lstm_params, /*forward_sequence=*/true, time_major,
           /*output_offset=*/0, scratch_buffer, activation_state, cell_state,
-          output);
+          output, input_gates, CpuBackendContext::GetFromContext(context));
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
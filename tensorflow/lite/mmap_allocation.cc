@@ -25,7 +25,8 @@ limitations under the License.
 namespace tflite {
 
 MMAPAllocation::MMAPAllocation(const char* filename,
-                               ErrorReporter* error_reporter)
+                               ErrorReporter* error_reporter,
+                               bool lazy_loading)
     : Allocation(error_reporter, Allocation::Type::kMMap),
       mmapped_buffer_(MAP_FAILED) {
   mmap_fd_ = open(filename, O_RDONLY);
@@ -42,6 +43,11 @@ MMAPAllocation::MMAPAllocation(const char* filename,
     error_reporter_->Report("Mmap of '%s' failed.", filename);
     return;
   }
+  if (lazy_loading) {
+    // Only a hint: the mapping works the same if it is not honored.
+    madvise(const_cast<void*>(mmapped_buffer_), buffer_size_bytes_,
+            MADV_RANDOM);
+  }
 }
 
 MMAPAllocation::~MMAPAllocation() {
@@ -20,7 +20,8 @@ limitations under the License.
 namespace tflite {
 
 MMAPAllocation::MMAPAllocation(const char* filename,
-                               ErrorReporter* error_reporter)
+                               ErrorReporter* error_reporter,
+                               bool lazy_loading)
     : Allocation(error_reporter, Allocation::Type::kMMap),
       mmapped_buffer_(nullptr) {
   // The disabled variant should never be created.
@@ -61,14 +61,17 @@ Interpreter::TfLiteDelegatePtr (*AcquireFlexDelegate)() = nullptr;
 
 #ifndef TFLITE_MCU
 // Loads a model from `filename`. If `mmap_file` is true then use mmap,
-// otherwise make a copy of the model in a buffer.
+// otherwise make a copy of the model in a buffer. `lazy_loading` only applies
+// to mmap.
 std::unique_ptr<Allocation> GetAllocationFromFile(const char* filename,
                                                   bool mmap_file,
                                                   ErrorReporter* error_reporter,
-                                                  bool use_nnapi) {
+                                                  bool use_nnapi,
+                                                  bool lazy_loading = false) {
   std::unique_ptr<Allocation> allocation;
   if (mmap_file && MMAPAllocation::IsSupported()) {
-    allocation.reset(new MMAPAllocation(filename, error_reporter));
+    allocation.reset(
+        new MMAPAllocation(filename, error_reporter, lazy_loading));
   } else {
     allocation.reset(new FileCopyAllocation(filename, error_reporter));
   }
@@ -87,6 +90,19 @@ std::unique_ptr<FlatBufferModel> FlatBufferModel::BuildFromFile(
   return model;
 }
 
+std::unique_ptr<FlatBufferModel> FlatBufferModel::BuildFromFileLazily(
+    const char* filename, ErrorReporter* error_reporter) {
+  error_reporter = ValidateErrorReporter(error_reporter);
+
+  std::unique_ptr<FlatBufferModel> model;
+  auto allocation =
+      GetAllocationFromFile(filename, /*mmap_file=*/true, error_reporter,
+                            /*use_nnapi=*/true, /*lazy_loading=*/true);
+  model.reset(new FlatBufferModel(std::move(allocation), error_reporter));
+  if (!model->initialized()) model.reset();
+  return model;
+}
+
 std::unique_ptr<FlatBufferModel> FlatBufferModel::VerifyAndBuildFromFile(
     const char* filename, TfLiteVerifier* extra_verifier,
     ErrorReporter* error_reporter) {
@@ -513,6 +529,54 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
   return status;
 }
 
+TfLiteStatus InterpreterBuilder::ParseOfflineMemoryPlans(
+    Interpreter* interpreter) {
+  if (!model_->metadata()) return kTfLiteOk;
+
+  for (const tflite::Metadata* metadata : *model_->metadata()) {
+    if (!metadata->name() ||
+        metadata->name()->str() != kOfflineMemoryAllocationMetadata) {
+      continue;
+    }
+    const auto* buffers = model_->buffers();
+    if (metadata->buffer() >= buffers->size() ||
+        !(*buffers)[metadata->buffer()]->data()) {
+      error_reporter_->Report("Missing buffer for metadata '%s'.\n",
+                              kOfflineMemoryAllocationMetadata);
+      return kTfLiteError;
+    }
+    const auto* data = (*buffers)[metadata->buffer()]->data();
+    const int num_values = data->size() / sizeof(int32_t);
+    auto value = [data](int i) {
+      return flatbuffers::ReadScalar<int32_t>(data->data() +
+                                              i * sizeof(int32_t));
+    };
+    if (data->size() % sizeof(int32_t) != 0 || num_values < 3 ||
+        value(0) != kOfflineMemoryAllocationVersion) {
+      error_reporter_->Report("Unsupported metadata '%s'.\n",
+                              kOfflineMemoryAllocationMetadata);
+      return kTfLiteError;
+    }
+    const int subgraph_index = value(1);
+    const int num_tensors = value(2);
+    Subgraph* subgraph = interpreter->subgraph(subgraph_index);
+    if (!subgraph ||
+        num_tensors != static_cast<int>(subgraph->tensors_size()) ||
+        num_values != 3 + num_tensors) {
+      error_reporter_->Report(
+          "Metadata '%s' doesn't match the tensors of subgraph %d.\n",
+          kOfflineMemoryAllocationMetadata, subgraph_index);
+      return kTfLiteError;
+    }
+    std::vector<int32_t> offsets(num_tensors);
+    for (int i = 0; i < num_tensors; ++i) {
+      offsets[i] = value(3 + i);
+    }
+    TF_LITE_ENSURE_STATUS(subgraph->SetOfflineMemoryPlan(std::move(offsets)));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::ApplyDelegates(Interpreter* interpreter) {
   // Apply Flex delegate if applicable.
   if (!has_flex_op_ || AcquireFlexDelegate == nullptr) {
@@ -625,6 +689,9 @@ TfLiteStatus InterpreterBuilder::operator()(
     modified_subgraph->SetVariables(std::move(variables));
   }
 
+  if (ParseOfflineMemoryPlans(interpreter->get()) != kTfLiteOk)
+    return cleanup_and_error();
+
   if (ApplyDelegates(interpreter->get()) != kTfLiteOk)
     return cleanup_and_error();
 
@@ -29,6 +29,15 @@ limitations under the License.
 
 namespace tflite {
 
+/// Name of the model metadata holding the arena offsets of the tensors of a
+/// subgraph, planned ahead of time. Its buffer holds little-endian int32
+/// values: the format version (currently 1), the subgraph index, the number
+/// of tensors N, and then N offsets in bytes, one per tensor, where -1 means
+/// that the tensor is planned at runtime. There may be one such metadata per
+/// subgraph.
+constexpr char kOfflineMemoryAllocationMetadata[] = "OfflineMemoryAllocation";
+constexpr int32_t kOfflineMemoryAllocationVersion = 1;
+
 /// Abstract interface that verifies whether a given model is legit.
 /// It facilitates the use-case to verify and build a model without loading it
 /// twice.
@@ -73,6 +82,18 @@ class FlatBufferModel {
       const char* filename,
       ErrorReporter* error_reporter = DefaultErrorReporter());
 
+  /// Same as BuildFromFile(), but maps the file for lazy loading: pages of the
+  /// model are only read from disk when first accessed, without read-ahead.
+  /// Since ops that transform their weights do so on their first Invoke()
+  /// rather than in AllocateTensors(), this lowers cold-start latency and keeps
+  /// the weights of unused or delegated ops out of resident memory. It works
+  /// best with models whose weight buffers are page-aligned by the converter
+  /// (see `--buffer_alignment`), so that small tensors do not share pages with
+  /// large weights. Falls back to BuildFromFile() where mmap is unsupported.
+  static std::unique_ptr<FlatBufferModel> BuildFromFileLazily(
+      const char* filename,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
   /// Verifies whether the content of the file is legit, then builds a model
   /// based on the file.
   /// The extra_verifier argument is an additional optional verifier for the
@@ -215,6 +236,7 @@ class InterpreterBuilder {
       const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
       Subgraph* subgraph);
   TfLiteStatus ApplyDelegates(Interpreter* interpreter);
+  TfLiteStatus ParseOfflineMemoryPlans(Interpreter* interpreter);
   TfLiteStatus ParseQuantization(const QuantizationParameters* src_quantization,
                                  TfLiteQuantization* quantization,
                                  const std::vector<int>& dims);
@@ -85,6 +85,17 @@ TEST(BasicFlatBufferModel, TestEmptyModelsAndNullDestination) {
   ASSERT_NE(InterpreterBuilder(*model, TrivialResolver())(nullptr), kTfLiteOk);
 }
 
+TEST(BasicFlatBufferModel, TestLazilyLoadedModel) {
+  ASSERT_TRUE(!FlatBufferModel::BuildFromFileLazily("/tmp/tflite_model_1234"));
+  auto model = FlatBufferModel::BuildFromFileLazily(
+      "tensorflow/lite/testdata/2_subgraphs.bin");
+  ASSERT_TRUE(model);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model, TrivialResolver())(&interpreter),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter->subgraphs_size(), 2);
+}
+
 // Make sure currently unsupported # of subgraphs are checked
 // TODO(aselle): Replace this test when multiple subgraphs are supported.
 TEST(BasicFlatBufferModel, TestZeroSubgraphs) {
@@ -0,0 +1,182 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/pmu_profile_summarizer.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+std::string GetOperatorName(const tflite::Interpreter& interpreter,
+                            int node_index) {
+  auto node_reg = interpreter.node_and_registration(node_index);
+  if (node_reg == nullptr) {
+    return "Unknown";
+  }
+  const int code = node_reg->second.builtin_code;
+  if (code == tflite::BuiltinOperator_CUSTOM) {
+    const char* custom_name = node_reg->second.custom_name;
+    return custom_name ? custom_name : "UnknownCustomOp";
+  }
+  return tflite::EnumNamesBuiltinOperator()[code];
+}
+
+// Escapes `str` to be used in a JSON string.
+std::string JsonEscape(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+}  // namespace
+
+void PmuProfileSummarizer::ProcessProfiles(
+    const std::vector<PmuProfileEvent>& profile_events,
+    const tflite::Interpreter& interpreter) {
+  bool has_operator_events = false;
+  for (const PmuProfileEvent& event : profile_events) {
+    if (event.event_type !=
+            PmuProfileEvent::EventType::OPERATOR_INVOKE_EVENT ||
+        event.end_timestamp_us < event.begin_timestamp_us) {
+      continue;
+    }
+    has_operator_events = true;
+    const int node_index = event.event_metadata;
+    auto inserted = operator_stats_.emplace(node_index, OperatorStats());
+    OperatorStats& stats = inserted.first->second;
+    if (inserted.second) {
+      stats.name = GetOperatorName(interpreter, node_index);
+      for (int i = 0; i < kNumPmuCounters; ++i) {
+        stats.total_counters[i] = 0;
+      }
+    }
+    stats.count++;
+    stats.total_time_us += event.end_timestamp_us - event.begin_timestamp_us;
+    for (int i = 0; i < kNumPmuCounters; ++i) {
+      if (event.counters[i] < 0 || stats.total_counters[i] < 0) {
+        stats.total_counters[i] = -1;
+      } else {
+        stats.total_counters[i] += event.counters[i];
+      }
+    }
+
+    TraceEvent trace_event;
+    trace_event.node_index = node_index;
+    trace_event.begin_timestamp_us = event.begin_timestamp_us;
+    trace_event.duration_us =
+        event.end_timestamp_us - event.begin_timestamp_us;
+    for (int i = 0; i < kNumPmuCounters; ++i) {
+      trace_event.counters[i] = event.counters[i];
+    }
+    trace_events_.push_back(trace_event);
+  }
+  if (has_operator_events) {
+    num_runs_++;
+  }
+}
+
+std::string PmuProfileSummarizer::GetOutputString() const {
+  std::stringstream stream;
+  stream << "============================== PMU counters per run "
+            "==============================\n";
+  stream << std::left << std::setw(6) << "node" << std::setw(24) << "op"
+         << std::right << std::setw(12) << "avg_us";
+  for (int i = 0; i < kNumPmuCounters; ++i) {
+    stream << std::setw(14) << GetPmuCounterName(static_cast<PmuCounter>(i));
+  }
+  stream << std::setw(8) << "ipc" << std::setw(10) << "l1d_mpki"
+         << std::setw(10) << "llc_mpki"
+         << "\n";
+  if (num_runs_ == 0) {
+    return stream.str();
+  }
+
+  stream << std::fixed;
+  for (const auto& node_and_stats : operator_stats_) {
+    const OperatorStats& stats = node_and_stats.second;
+    stream << std::left << std::setw(6) << node_and_stats.first
+           << std::setw(24) << stats.name << std::right << std::setw(12)
+           << std::setprecision(1)
+           << static_cast<double>(stats.total_time_us) / num_runs_;
+    for (int i = 0; i < kNumPmuCounters; ++i) {
+      stream << std::setw(14);
+      if (stats.total_counters[i] < 0) {
+        stream << "n/a";
+      } else {
+        stream << std::setprecision(0)
+               << static_cast<double>(stats.total_counters[i]) / num_runs_;
+      }
+    }
+    const int64_t cycles = stats.total_counters[kPmuCycles];
+    const int64_t instructions = stats.total_counters[kPmuInstructions];
+    stream << std::setw(8);
+    if (cycles > 0 && instructions >= 0) {
+      stream << std::setprecision(2)
+             << static_cast<double>(instructions) / cycles;
+    } else {
+      stream << "n/a";
+    }
+    for (PmuCounter misses : {kPmuL1DataCacheMisses,
+                              kPmuLastLevelCacheMisses}) {
+      stream << std::setw(10);
+      if (instructions > 0 && stats.total_counters[misses] >= 0) {
+        stream << std::setprecision(2)
+               << 1000.0 * stats.total_counters[misses] / instructions;
+      } else {
+        stream << "n/a";
+      }
+    }
+    stream << "\n";
+  }
+  return stream.str();
+}
+
+std::string PmuProfileSummarizer::GetChromeTrace() const {
+  std::stringstream stream;
+  stream << "{\"traceEvents\":[";
+  bool first = true;
+  for (const TraceEvent& event : trace_events_) {
+    if (!first) {
+      stream << ",";
+    }
+    first = false;
+    auto stats = operator_stats_.find(event.node_index);
+    stream << "\n{\"name\":\"" << JsonEscape(stats->second.name)
+           << "\",\"cat\":\"op\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":"
+           << event.begin_timestamp_us << ",\"dur\":" << event.duration_us
+           << ",\"args\":{\"node\":" << event.node_index;
+    for (int i = 0; i < kNumPmuCounters; ++i) {
+      if (event.counters[i] >= 0) {
+        stream << ",\"" << GetPmuCounterName(static_cast<PmuCounter>(i))
+               << "\":" << event.counters[i];
+      }
+    }
+    stream << "}}";
+  }
+  stream << "\n]}\n";
+  return stream.str();
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,75 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_PMU_PROFILE_SUMMARIZER_H_
+#define TENSORFLOW_LITE_PROFILING_PMU_PROFILE_SUMMARIZER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/pmu_profiler.h"
+
+namespace tflite {
+namespace profiling {
+
+// Creates a summary of the hardware counters of operator invocations in the
+// interpreter, as recorded by PmuProfiler.
+class PmuProfileSummarizer {
+ public:
+  // Process the events of one run to update the statistics of each operator.
+  void ProcessProfiles(const std::vector<PmuProfileEvent>& profile_events,
+                       const tflite::Interpreter& interpreter);
+
+  bool HasProfiles() const { return num_runs_ >= 1; }
+
+  // Returns a table with the average time and counters of each operator per
+  // run, along with the instructions per cycle and the cache misses per
+  // thousand instructions, which tell memory-bound operators from
+  // compute-bound ones.
+  std::string GetOutputString() const;
+
+  // Returns the operator invocations of all the processed runs in the Chrome
+  // trace event format, with their counters as arguments. The result can be
+  // loaded in chrome://tracing or Perfetto.
+  std::string GetChromeTrace() const;
+
+ private:
+  struct OperatorStats {
+    std::string name;
+    int64_t count = 0;
+    uint64_t total_time_us = 0;
+    // Totals of each counter, or -1 if the counter is not available.
+    int64_t total_counters[kNumPmuCounters];
+  };
+
+  struct TraceEvent {
+    int node_index;
+    uint64_t begin_timestamp_us;
+    uint64_t duration_us;
+    int64_t counters[kNumPmuCounters];
+  };
+
+  int num_runs_ = 0;
+  // Keyed by node index, so that operators are listed in node order.
+  std::map<int, OperatorStats> operator_stats_;
+  std::vector<TraceEvent> trace_events_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_PMU_PROFILE_SUMMARIZER_H_
@@ -0,0 +1,160 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/pmu_profiler.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+constexpr uint32_t kInvalidEventHandle = static_cast<uint32_t>(~0);
+
+#if defined(__linux__)
+// Opens a counter of the calling thread, on any CPU. Returns -1 on failure.
+int OpenCounter(uint32_t type, uint64_t config) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                 /*group_fd=*/-1, /*flags=*/0);
+}
+
+uint64_t CacheMissConfig(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+}  // namespace
+
+const char* GetPmuCounterName(PmuCounter counter) {
+  switch (counter) {
+    case kPmuCycles:
+      return "cycles";
+    case kPmuInstructions:
+      return "instructions";
+    case kPmuL1DataCacheMisses:
+      return "l1d_misses";
+    case kPmuLastLevelCacheMisses:
+      return "llc_misses";
+    case kNumPmuCounters:
+      break;
+  }
+  return "unknown";
+}
+
+PmuProfiler::PmuProfiler(uint32_t max_num_entries)
+    : max_num_entries_(max_num_entries) {
+  for (int i = 0; i < kNumPmuCounters; ++i) {
+    counter_fds_[i] = -1;
+  }
+#if defined(__linux__)
+  counter_fds_[kPmuCycles] =
+      OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  counter_fds_[kPmuInstructions] =
+      OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  counter_fds_[kPmuL1DataCacheMisses] = OpenCounter(
+      PERF_TYPE_HW_CACHE, CacheMissConfig(PERF_COUNT_HW_CACHE_L1D));
+  counter_fds_[kPmuLastLevelCacheMisses] = OpenCounter(
+      PERF_TYPE_HW_CACHE, CacheMissConfig(PERF_COUNT_HW_CACHE_LL));
+#endif
+  events_.reserve(max_num_entries_);
+}
+
+PmuProfiler::~PmuProfiler() {
+#if defined(__linux__)
+  for (int fd : counter_fds_) {
+    if (fd >= 0) close(fd);
+  }
+#endif
+}
+
+bool PmuProfiler::IsAvailable() const {
+  for (int fd : counter_fds_) {
+    if (fd >= 0) return true;
+  }
+  return false;
+}
+
+void PmuProfiler::Reset() {
+  enabled_ = false;
+  events_.clear();
+}
+
+void PmuProfiler::ReadCounters(int64_t* values) const {
+  for (int i = 0; i < kNumPmuCounters; ++i) {
+    values[i] = -1;
+#if defined(__linux__)
+    uint64_t value;
+    if (counter_fds_[i] >= 0 &&
+        read(counter_fds_[i], &value, sizeof(value)) == sizeof(value)) {
+      values[i] = static_cast<int64_t>(value);
+    }
+#endif
+  }
+}
+
+uint32_t PmuProfiler::BeginEvent(const char* tag, EventType event_type,
+                                 uint32_t event_metadata) {
+  if (!enabled_ || events_.size() >= max_num_entries_) {
+    return kInvalidEventHandle;
+  }
+  events_.emplace_back();
+  PmuProfileEvent& event = events_.back();
+  event.tag = tag;
+  event.event_type = event_type;
+  event.event_metadata = event_metadata;
+  event.end_timestamp_us = 0;
+  // The counters hold their values at the beginning of the event until it
+  // ends. Read them last, so that they count as little of the profiler
+  // itself as possible.
+  event.begin_timestamp_us = time::NowMicros();
+  ReadCounters(event.counters);
+  return events_.size() - 1;
+}
+
+void PmuProfiler::EndEvent(uint32_t event_handle) {
+  if (event_handle >= events_.size()) {
+    return;
+  }
+  int64_t end_counters[kNumPmuCounters];
+  ReadCounters(end_counters);
+  PmuProfileEvent& event = events_[event_handle];
+  event.end_timestamp_us = time::NowMicros();
+  for (int i = 0; i < kNumPmuCounters; ++i) {
+    if (event.counters[i] >= 0 && end_counters[i] >= 0) {
+      event.counters[i] = end_counters[i] - event.counters[i];
+    } else {
+      event.counters[i] = -1;
+    }
+  }
+}
+
+}  // namespace profiling
+}  // namespace tflite
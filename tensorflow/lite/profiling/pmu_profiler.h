@@ -0,0 +1,102 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_PMU_PROFILER_H_
+#define TENSORFLOW_LITE_PROFILING_PMU_PROFILER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+
+namespace tflite {
+namespace profiling {
+
+// Hardware performance counters read by PmuProfiler.
+enum PmuCounter {
+  kPmuCycles = 0,
+  kPmuInstructions,
+  kPmuL1DataCacheMisses,
+  kPmuLastLevelCacheMisses,
+  kNumPmuCounters,
+};
+
+// Returns a short name for `counter`, e.g. "cycles".
+const char* GetPmuCounterName(PmuCounter counter);
+
+// A profiling event along with the hardware counters it spanned.
+struct PmuProfileEvent {
+  using EventType = tflite::Profiler::EventType;
+
+  const char* tag;
+  EventType event_type;
+  uint32_t event_metadata;
+  // Timestamps in microseconds when the event began and ended.
+  uint64_t begin_timestamp_us;
+  uint64_t end_timestamp_us;
+  // How much each counter increased during the event, or -1 if the counter
+  // is not available.
+  int64_t counters[kNumPmuCounters];
+};
+
+// A profiler recording the hardware performance counters of the calling
+// thread, through perf_event_open on Linux and Android, around each event.
+// Only the thread invoking the interpreter is counted: work that kernels hand
+// to other threads, e.g. to the CPU backend thread pool, is not.
+//
+// Counters that can't be opened, e.g. because the platform has no PMU or
+// because /proc/sys/kernel/perf_event_paranoid forbids it, read as -1. On
+// other platforms all counters read as -1, and only timestamps are recorded.
+//
+// Like BufferedProfiler, this class is designed to be used on a single thread.
+class PmuProfiler : public tflite::Profiler {
+ public:
+  explicit PmuProfiler(uint32_t max_num_entries);
+  ~PmuProfiler() override;
+  PmuProfiler(const PmuProfiler&) = delete;
+  PmuProfiler& operator=(const PmuProfiler&) = delete;
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      uint32_t event_metadata) override;
+  void EndEvent(uint32_t event_handle) override;
+
+  // Returns whether at least one counter could be opened.
+  bool IsAvailable() const;
+
+  void StartProfiling() { enabled_ = true; }
+  void StopProfiling() { enabled_ = false; }
+  // Drops the recorded events and stops profiling.
+  void Reset();
+
+  // Returns the events recorded since the last Reset(), in the order they
+  // began. Events past the first `max_num_entries` are dropped.
+  const std::vector<PmuProfileEvent>& GetProfileEvents() const {
+    return events_;
+  }
+
+ private:
+  // Reads the current value of each counter into `values`.
+  void ReadCounters(int64_t* values) const;
+
+  // File descriptor of each counter, or -1 if it is not available.
+  int counter_fds_[kNumPmuCounters];
+  uint32_t max_num_entries_;
+  bool enabled_ = false;
+  std::vector<PmuProfileEvent> events_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_PMU_PROFILER_H_
@@ -0,0 +1,138 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/pmu_profiler.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/pmu_profile_summarizer.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(PmuProfilerTest, RecordsEventsOnlyWhenProfiling) {
+  PmuProfiler profiler(1024);
+  profiler.EndEvent(profiler.BeginEvent(
+      "Ignored", Profiler::EventType::OPERATOR_INVOKE_EVENT, 0));
+  EXPECT_TRUE(profiler.GetProfileEvents().empty());
+
+  profiler.StartProfiling();
+  const uint32_t outer = profiler.BeginEvent(
+      "Outer", Profiler::EventType::DEFAULT, 0);
+  const uint32_t inner = profiler.BeginEvent(
+      "Inner", Profiler::EventType::OPERATOR_INVOKE_EVENT, 3);
+  volatile int sum = 0;
+  for (int i = 0; i < 1000; ++i) sum += i;
+  profiler.EndEvent(inner);
+  profiler.EndEvent(outer);
+  profiler.StopProfiling();
+
+  const std::vector<PmuProfileEvent>& events = profiler.GetProfileEvents();
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_STREQ(events[0].tag, "Outer");
+  EXPECT_STREQ(events[1].tag, "Inner");
+  EXPECT_EQ(events[1].event_metadata, 3);
+  for (const PmuProfileEvent& event : events) {
+    EXPECT_GE(event.end_timestamp_us, event.begin_timestamp_us);
+    for (int i = 0; i < kNumPmuCounters; ++i) {
+      if (profiler.IsAvailable()) {
+        EXPECT_GE(event.counters[i], -1);
+      } else {
+        EXPECT_EQ(event.counters[i], -1);
+      }
+    }
+  }
+
+  profiler.Reset();
+  EXPECT_TRUE(profiler.GetProfileEvents().empty());
+}
+
+TEST(PmuProfilerTest, DropsEventsPastMaxEntries) {
+  PmuProfiler profiler(2);
+  profiler.StartProfiling();
+  for (int i = 0; i < 3; ++i) {
+    profiler.EndEvent(profiler.BeginEvent(
+        "Op", Profiler::EventType::OPERATOR_INVOKE_EVENT, i));
+  }
+  EXPECT_EQ(profiler.GetProfileEvents().size(), 2);
+}
+
+PmuProfileEvent CreateOperatorEvent(int node_index, uint64_t begin_us,
+                                    uint64_t end_us, int64_t cycles,
+                                    int64_t instructions) {
+  PmuProfileEvent event;
+  event.tag = "Op";
+  event.event_type = PmuProfileEvent::EventType::OPERATOR_INVOKE_EVENT;
+  event.event_metadata = node_index;
+  event.begin_timestamp_us = begin_us;
+  event.end_timestamp_us = end_us;
+  event.counters[kPmuCycles] = cycles;
+  event.counters[kPmuInstructions] = instructions;
+  event.counters[kPmuL1DataCacheMisses] = 10;
+  event.counters[kPmuLastLevelCacheMisses] = -1;
+  return event;
+}
+
+TEST(PmuProfileSummarizerTest, SummarizesOperators) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
+  TfLiteRegistration registration = {nullptr, nullptr, nullptr, nullptr};
+  registration.builtin_code = BuiltinOperator_ADD;
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &registration),
+            kTfLiteOk);
+
+  PmuProfileSummarizer summarizer;
+  EXPECT_FALSE(summarizer.HasProfiles());
+  summarizer.ProcessProfiles({CreateOperatorEvent(0, 10, 30, 1000, 2000)},
+                             interpreter);
+  summarizer.ProcessProfiles({CreateOperatorEvent(0, 50, 60, 3000, 2000)},
+                             interpreter);
+  ASSERT_TRUE(summarizer.HasProfiles());
+
+  // 4000 cycles and 4000 instructions over 2 runs, i.e. an IPC of 1 and 5
+  // L1 misses per thousand instructions.
+  const std::string summary = summarizer.GetOutputString();
+  EXPECT_THAT(summary, HasSubstr("ADD"));
+  EXPECT_THAT(summary, HasSubstr("2000"));
+  EXPECT_THAT(summary, HasSubstr("1.00"));
+  EXPECT_THAT(summary, HasSubstr("5.00"));
+  EXPECT_THAT(summary, HasSubstr("n/a"));
+
+  const std::string trace = summarizer.GetChromeTrace();
+  EXPECT_THAT(trace, HasSubstr("\"name\":\"ADD\""));
+  EXPECT_THAT(trace, HasSubstr("\"ts\":50,\"dur\":10"));
+  EXPECT_THAT(trace, HasSubstr("\"cycles\":3000"));
+  EXPECT_THAT(trace, Not(HasSubstr("llc_misses")));
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
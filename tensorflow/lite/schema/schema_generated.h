@@ -2438,14 +2438,18 @@ inline const char *EnumNameLSHProjectionType(LSHProjectionType e) {
 enum FullyConnectedOptionsWeightsFormat {
   FullyConnectedOptionsWeightsFormat_DEFAULT = 0,
   FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8 = 1,
+  FullyConnectedOptionsWeightsFormat_SPARSE1x4 = 2,
+  FullyConnectedOptionsWeightsFormat_PACKED_INT4 = 3,
   FullyConnectedOptionsWeightsFormat_MIN = FullyConnectedOptionsWeightsFormat_DEFAULT,
-  FullyConnectedOptionsWeightsFormat_MAX = FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8
+  FullyConnectedOptionsWeightsFormat_MAX = FullyConnectedOptionsWeightsFormat_PACKED_INT4
 };
 
-inline const FullyConnectedOptionsWeightsFormat (&EnumValuesFullyConnectedOptionsWeightsFormat())[2] {
+inline const FullyConnectedOptionsWeightsFormat (&EnumValuesFullyConnectedOptionsWeightsFormat())[4] {
   static const FullyConnectedOptionsWeightsFormat values[] = {
     FullyConnectedOptionsWeightsFormat_DEFAULT,
-    FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8
+    FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8,
+    FullyConnectedOptionsWeightsFormat_SPARSE1x4,
+    FullyConnectedOptionsWeightsFormat_PACKED_INT4
   };
   return values;
 }
@@ -2454,13 +2458,15 @@ inline const char * const *EnumNamesFullyConnectedOptionsWeightsFormat() {
   static const char * const names[] = {
     "DEFAULT",
     "SHUFFLED4x16INT8",
+    "SPARSE1x4",
+    "PACKED_INT4",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameFullyConnectedOptionsWeightsFormat(FullyConnectedOptionsWeightsFormat e) {
-  if (e < FullyConnectedOptionsWeightsFormat_DEFAULT || e > FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8) return "";
+  if (e < FullyConnectedOptionsWeightsFormat_DEFAULT || e > FullyConnectedOptionsWeightsFormat_PACKED_INT4) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesFullyConnectedOptionsWeightsFormat()[index];
 }
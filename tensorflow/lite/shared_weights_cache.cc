@@ -0,0 +1,50 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/shared_weights_cache.h"
+
+namespace tflite {
+
+SharedWeightsCache::SharedWeightsCache() {
+  this->type = kTfLiteSharedWeightsContext;
+  this->Refresh = nullptr;
+}
+
+SharedWeightsCache* SharedWeightsCache::GetFromContext(
+    TfLiteContext* context) {
+  return static_cast<SharedWeightsCache*>(
+      context->GetExternalContext(context, kTfLiteSharedWeightsContext));
+}
+
+const void* SharedWeightsCache::GetOrCreate(
+    const void* source, Tag tag, size_t size,
+    const std::function<void(void* data)>& fill) {
+  // Holding the lock while filling keeps two interpreters from deriving the
+  // same weights at once; this only happens on their first invocations.
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_ptr<char[]>& entry = entries_[Key(source, tag, size)];
+  if (!entry) {
+    entry.reset(new char[size]);
+    fill(entry.get());
+    size_in_bytes_ += size;
+  }
+  return entry.get();
+}
+
+size_t SharedWeightsCache::size_in_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_in_bytes_;
+}
+
+}  // namespace tflite
@@ -0,0 +1,79 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_SHARED_WEIGHTS_CACHE_H_
+#define TENSORFLOW_LITE_SHARED_WEIGHTS_CACHE_H_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include "tensorflow/lite/c/c_api_internal.h"
+
+namespace tflite {
+
+// The 'kTfLiteSharedWeightsContext'-typed external context. It holds weights
+// that kernels derive from read-only tensors (e.g. transposed conv filters) so
+// that interpreters built from the same FlatBufferModel compute and store them
+// only once, instead of once per interpreter:
+//
+//  SharedWeightsCache cache;
+//  interpreter1->SetExternalContext(kTfLiteSharedWeightsContext, &cache);
+//  interpreter2->SetExternalContext(kTfLiteSharedWeightsContext, &cache);
+//
+// Entries are keyed by the address of the source data, which is only stable
+// for kTfLiteMmapRo tensors, so kernels must not use the cache for anything
+// else. Unlike the cpu backend context, the cache may be used by interpreters
+// that are invoked concurrently. It must outlive all of them.
+class SharedWeightsCache : public TfLiteExternalContext {
+ public:
+  // Identifies how the cached weights are derived from their source.
+  enum Tag {
+    // Float conv filters transposed to [height, width, input_depth, count].
+    kConvHwcnWeights = 0,
+  };
+
+  SharedWeightsCache();
+  ~SharedWeightsCache() {}
+
+  // Returns the cache set on `context`, or nullptr if there is none.
+  static SharedWeightsCache* GetFromContext(TfLiteContext* context);
+
+  // Returns the `size` bytes derived from `source` by the transformation
+  // identified by `tag`. The first call for a given key allocates them and
+  // calls `fill` to initialize them; the returned data is read-only and lives
+  // as long as the cache.
+  const void* GetOrCreate(const void* source, Tag tag, size_t size,
+                          const std::function<void(void* data)>& fill);
+
+  // Returns the number of bytes held by the cache.
+  size_t size_in_bytes() const;
+
+ private:
+  using Key = std::tuple<const void*, Tag, size_t>;
+
+  mutable std::mutex mutex_;
+  std::map<Key, std::unique_ptr<char[]>> entries_;
+  size_t size_in_bytes_ = 0;
+
+  SharedWeightsCache(const SharedWeightsCache&) = delete;
+  SharedWeightsCache& operator=(const SharedWeightsCache&) = delete;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SHARED_WEIGHTS_CACHE_H_
@@ -80,6 +80,37 @@ TfLiteStatus SimpleMemoryArena::Allocate(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+bool SimpleMemoryArena::TryAllocateAt(size_t alignment, size_t offset,
+                                      size_t size, ArenaAlloc* new_alloc) {
+  if (alignment > arena_alignment_ || offset % alignment != 0) {
+    return false;
+  }
+
+  if (size == 0) {
+    new_alloc->offset = 0;
+    new_alloc->size = 0;
+    return true;
+  }
+
+  // Find the first alloc that ends after `offset`; it must also start after
+  // the new one ends.
+  auto it = allocs_.begin();
+  while (it != allocs_.end() && it->offset + it->size <= offset) {
+    ++it;
+  }
+  if (it != allocs_.end() && it->offset < offset + size) {
+    return false;
+  }
+
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+
+  new_alloc->offset = offset;
+  new_alloc->size = size;
+  allocs_.insert(it, *new_alloc);
+
+  return true;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(TfLiteContext* context,
                                            const ArenaAlloc& alloc) {
   if (alloc.size == 0) {
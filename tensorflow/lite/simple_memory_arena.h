@@ -43,6 +43,12 @@ struct ArenaAlloc {
 // zero-sized allocations are explicitly allowed, and will resolve to null.
 class SimpleMemoryArena {
  public:
+  // The allocations made in the arena, which don't depend on its buffer.
+  struct State {
+    size_t high_water_mark;
+    std::list<ArenaAlloc> allocs;
+  };
+
   explicit SimpleMemoryArena(size_t arena_alignment)
       : committed_(false),
         arena_alignment_(arena_alignment),
@@ -53,6 +59,13 @@ class SimpleMemoryArena {
   TfLiteStatus Allocate(TfLiteContext* context, size_t alignment, size_t size,
                         ArenaAlloc* new_alloc);
 
+  // Reserves `size` bytes at the given `offset`, which is how allocations
+  // planned ahead of time are replayed. Returns false, leaving the arena
+  // unchanged, if `offset` isn't a multiple of `alignment` or the bytes overlap
+  // another allocation.
+  bool TryAllocateAt(size_t alignment, size_t offset, size_t size,
+                     ArenaAlloc* new_alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context, const ArenaAlloc& alloc);
 
   inline size_t RequiredBufferSize() {
@@ -69,6 +82,14 @@ class SimpleMemoryArena {
 
   TfLiteStatus Clear();
 
+  // Saves the allocations made so far, to be restored later on instead of
+  // being made again.
+  State SaveState() const { return {high_water_mark_, allocs_}; }
+  void RestoreState(const State& state) {
+    high_water_mark_ = state.high_water_mark;
+    allocs_ = state.allocs;
+  }
+
   int64_t BasePointer() const {
     return reinterpret_cast<int64_t>(underlying_buffer_aligned_ptr_);
   }
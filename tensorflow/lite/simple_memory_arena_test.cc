@@ -43,6 +43,28 @@ TEST(SimpleMemoryArenaTest, BasicArenaOperations) {
   EXPECT_EQ(allocs[5].offset, 1024);
 }
 
+TEST(SimpleMemoryArenaTest, AllocateAtFixedOffsets) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAlloc allocs[4];
+
+  EXPECT_TRUE(arena.TryAllocateAt(32, 1024, 1024, &allocs[0]));
+  EXPECT_TRUE(arena.TryAllocateAt(32, 0, 1024, &allocs[1]));
+  // Overlaps allocs[0], and isn't aligned.
+  EXPECT_FALSE(arena.TryAllocateAt(32, 1536, 1024, &allocs[2]));
+  EXPECT_FALSE(arena.TryAllocateAt(32, 2050, 1024, &allocs[2]));
+  // Regular allocations go around the fixed ones.
+  arena.Allocate(&context, 32, 1024, &allocs[2]);
+  arena.Deallocate(&context, allocs[1]);
+  EXPECT_TRUE(arena.TryAllocateAt(32, 512, 512, &allocs[3]));
+
+  EXPECT_EQ(allocs[0].offset, 1024);
+  EXPECT_EQ(allocs[1].offset, 0);
+  EXPECT_EQ(allocs[2].offset, 2048);
+  EXPECT_EQ(allocs[3].offset, 512);
+  EXPECT_EQ(arena.RequiredBufferSize(), 64 + 3072 + 64);
+}
+
 TEST(SimpleMemoryArenaTest, BasicZeroAlloc) {
   TfLiteContext context;
   SimpleMemoryArena arena(64);
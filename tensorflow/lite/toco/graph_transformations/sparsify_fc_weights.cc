@@ -0,0 +1,86 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/lite/toco/model.h"
+#include "tensorflow/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace toco {
+
+namespace {
+
+// The fraction of all-zero 1x4 blocks above which the sparse kernel beats the
+// dense one. Below it, reading the block indices costs more than skipping the
+// zero blocks saves.
+constexpr float kMinZeroBlockFraction = 0.75f;
+
+}  // namespace
+
+::tensorflow::Status SparsifyFCWeights::Run(Model* model, std::size_t op_index,
+                                            bool* modified) {
+  *modified = false;
+  Operator* op = model->operators[op_index].get();
+  if (op->type != OperatorType::kFullyConnected) {
+    return ::tensorflow::Status::OK();
+  }
+  FullyConnectedOperator* fc_op = static_cast<FullyConnectedOperator*>(op);
+  if (fc_op->weights_format != FullyConnectedWeightsFormat::kDefault) {
+    return ::tensorflow::Status::OK();
+  }
+  // Only float weights are considered: quantized weights rarely quantize
+  // pruned values to exactly their zero point, and the runtime only has a
+  // sparse path for int8 weights with a zero point of 0.
+  const Array& weights_array = model->GetArray(fc_op->inputs[1]);
+  if (weights_array.data_type != ArrayDataType::kFloat ||
+      !weights_array.buffer || !weights_array.has_shape()) {
+    return ::tensorflow::Status::OK();
+  }
+  const Shape& weights_shape = weights_array.shape();
+  if (weights_shape.dimensions_count() != 2) {
+    return ::tensorflow::Status::OK();
+  }
+  const int rows = weights_shape.dims(0);
+  const int cols = weights_shape.dims(1);
+  if (cols % 4) {
+    return ::tensorflow::Status::OK();
+  }
+
+  const auto& weights_data =
+      weights_array.GetBuffer<ArrayDataType::kFloat>().data;
+  CHECK_EQ(rows * cols, weights_data.size());
+  int zero_blocks = 0;
+  for (int i = 0; i < rows * cols; i += 4) {
+    if (weights_data[i] == 0.f && weights_data[i + 1] == 0.f &&
+        weights_data[i + 2] == 0.f && weights_data[i + 3] == 0.f) {
+      ++zero_blocks;
+    }
+  }
+  const int num_blocks = rows * cols / 4;
+  if (zero_blocks < kMinZeroBlockFraction * num_blocks) {
+    return ::tensorflow::Status::OK();
+  }
+
+  fc_op->weights_format = FullyConnectedWeightsFormat::kSparse1x4;
+  AddMessageF("Marked the weights of %s as 1x4 block sparse, %d of %d blocks "
+              "are zero",
+              LogName(*op), zero_blocks, num_blocks);
+  *modified = true;
+  return ::tensorflow::Status::OK();
+}
+
+}  // namespace toco
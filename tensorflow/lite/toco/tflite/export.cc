@@ -212,7 +212,7 @@ Offset<Vector<Offset<Tensor>>> ExportTensors(
     const Model& model, const details::TensorsMap& tensors_map,
     FlatBufferBuilder* builder,
     std::vector<Offset<Vector<uint8_t>>>* buffers_to_write,
-    const std::set<int32_t>& variable_tensor_indices) {
+    const std::set<int32_t>& variable_tensor_indices, int buffer_alignment) {
   // In the end we will need to produce a vector sorted by the indices of the
   // tensors in the tensors_map.
   std::map<int, Offset<Tensor>> ordered_tensors;
@@ -223,7 +223,8 @@ Offset<Vector<Offset<Tensor>>> ExportTensors(
 
     int buffer_index = buffers_to_write->size();
     auto type = DataType::Serialize(array.data_type);
-    buffers_to_write->push_back(DataBuffer::Serialize(array, builder));
+    buffers_to_write->push_back(
+        DataBuffer::Serialize(array, builder, buffer_alignment));
 
     std::vector<int> shape;
     if (array.has_shape()) {
@@ -481,6 +482,13 @@ tensorflow::Status Export(
     }
   }
 
+  if (params.buffer_alignment < 0 ||
+      (params.buffer_alignment & (params.buffer_alignment - 1)) != 0) {
+    return tensorflow::errors::InvalidArgument(absl::StrCat(
+        "Buffer alignment ", params.buffer_alignment,
+        " is not a power of two."));
+  }
+
   flatbuffers::FlatBufferBuilder builder(/*initial_size=*/10240);
 
   details::TensorsMap tensors_map;
@@ -610,7 +618,8 @@ tensorflow::Status Export(
                              &builder, &variable_tensor_indices, params);
 
   auto tensors = ExportTensors(model, tensors_map, &builder, &buffers_to_write,
-                               variable_tensor_indices);
+                               variable_tensor_indices,
+                               params.buffer_alignment);
   auto inputs = ExportInputTensors(model, tensors_map, &builder);
   auto outputs = ExportOutputTensors(model, tensors_map, &builder);
 
@@ -31,6 +31,9 @@ struct ExportParams {
   bool allow_dynamic_tensors = true;
   bool enable_select_tf_ops = false;
   QuantizedBufferType quantize_weights = QuantizedBufferType::NONE;
+  // If positive, the constant buffers of at least this many bytes start at a
+  // multiple of this many bytes in the flatbuffer. Must be a power of two.
+  int buffer_alignment = 0;
 };
 
 // Transform the given tf.mini model into a TF Lite flatbuffer and deposit the
@@ -459,6 +459,14 @@ class FullyConnected
         tflite_weights_format =
             ::tflite::FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8;
         break;
+      case FullyConnectedWeightsFormat::kSparse1x4:
+        tflite_weights_format =
+            ::tflite::FullyConnectedOptionsWeightsFormat_SPARSE1x4;
+        break;
+      case FullyConnectedWeightsFormat::kPackedInt4:
+        tflite_weights_format =
+            ::tflite::FullyConnectedOptionsWeightsFormat_PACKED_INT4;
+        break;
       default:
         LOG(ERROR) << "Unhandled FC weights format";
         tflite_weights_format =
@@ -479,6 +487,12 @@ class FullyConnected
       case ::tflite::FullyConnectedOptionsWeightsFormat_SHUFFLED4x16INT8:
         op->weights_format = FullyConnectedWeightsFormat::kShuffled4x16Int8;
         break;
+      case ::tflite::FullyConnectedOptionsWeightsFormat_SPARSE1x4:
+        op->weights_format = FullyConnectedWeightsFormat::kSparse1x4;
+        break;
+      case ::tflite::FullyConnectedOptionsWeightsFormat_PACKED_INT4:
+        op->weights_format = FullyConnectedWeightsFormat::kPackedInt4;
+        break;
       default:
         LOG(ERROR) << "Unhandled FC weights format";
         op->weights_format = FullyConnectedWeightsFormat::kDefault;
@@ -493,6 +507,8 @@ class FullyConnected
   // | Hybrid          |                  3 |                        3 |
   // | Quantized Int8  |                  4 |                        4 |
   // +-----------------+--------------------+--------------------------+
+  // Weight::Sparse1x4 is version 7 regardless of the types.
+  // Weight::PackedInt4 is version 8 and only exists for hybrid.
   int GetVersion(const OperatorSignature& op_signature) const override {
     const auto& fc_op =
         static_cast<const FullyConnectedOperator&>(*op_signature.op);
@@ -502,6 +518,14 @@ class FullyConnected
     const Array& input_array = op_signature.model->GetArray(input_name);
     const Array& weights_array = op_signature.model->GetArray(weights_name);
     const Array& output_array = op_signature.model->GetArray(output_name);
+    // PackedInt4 weights are supported starting from version 8.
+    if (fc_op.weights_format == FullyConnectedWeightsFormat::kPackedInt4) {
+      return 8;
+    }
+    // Sparse1x4 weights are supported starting from version 7.
+    if (fc_op.weights_format == FullyConnectedWeightsFormat::kSparse1x4) {
+      return 7;
+    }
     // 2 inputs (no bias) use case is supported starting from version 6.
     if (op_signature.op->inputs.size() == 2) {
       return 6;
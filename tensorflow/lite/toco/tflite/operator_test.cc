@@ -235,6 +235,15 @@ TEST_F(OperatorTest, CustomFullyConnected) {
             output_toco_op->fused_activation_function);
 }
 
+TEST_F(OperatorTest, BuiltinFullyConnectedSparseWeights) {
+  FullyConnectedOperator op;
+  op.weights_format = FullyConnectedWeightsFormat::kSparse1x4;
+  auto output_toco_op = SerializeAndDeserialize(
+      GetOperator("FULLY_CONNECTED", OperatorType::kFullyConnected), op);
+  EXPECT_EQ(output_toco_op->weights_format,
+            FullyConnectedWeightsFormat::kSparse1x4);
+}
+
 TEST_F(OperatorTest, BuiltinGather) {
   GatherOperator op;
   auto output_toco_op =
@@ -1000,6 +1009,12 @@ TEST_F(OperatorTest, VersioningFullyConnectedTest) {
   OperatorSignature int8_signature = {.op = &fully_connected_op,
                                       .model = &int8_model};
   EXPECT_EQ(op->GetVersion(int8_signature), 6);
+
+  fully_connected_op.weights_format = FullyConnectedWeightsFormat::kSparse1x4;
+  EXPECT_EQ(op->GetVersion(int8_signature), 7);
+
+  fully_connected_op.weights_format = FullyConnectedWeightsFormat::kPackedInt4;
+  EXPECT_EQ(op->GetVersion(int8_signature), 8);
 }
 
 TEST_F(OperatorTest, VersioningDequantizeTest) {
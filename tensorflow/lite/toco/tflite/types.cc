@@ -48,11 +48,15 @@ DataBuffer::FlatBufferOffset CopyBoolToBuffer(
 
 template <ArrayDataType T>
 DataBuffer::FlatBufferOffset CopyBuffer(
-    const Array& array, flatbuffers::FlatBufferBuilder* builder) {
+    const Array& array, flatbuffers::FlatBufferBuilder* builder,
+    int alignment) {
   using NativeT = ::toco::DataType<T>;
   const auto& src_data = array.GetBuffer<T>().data;
   const uint8_t* dst_data = reinterpret_cast<const uint8_t*>(src_data.data());
   auto size = src_data.size() * sizeof(NativeT);
+  if (alignment > 0 && size >= static_cast<size_t>(alignment)) {
+    builder->ForceVectorAlignment(size, sizeof(uint8_t), alignment);
+  }
   return builder->CreateVector(dst_data, size);
 }
 
@@ -133,26 +137,27 @@ ArrayDataType DataType::Deserialize(int tensor_type) {
 }
 
 flatbuffers::Offset<flatbuffers::Vector<uint8_t>> DataBuffer::Serialize(
-    const Array& array, flatbuffers::FlatBufferBuilder* builder) {
+    const Array& array, flatbuffers::FlatBufferBuilder* builder,
+    int alignment) {
   if (!array.buffer) return 0;  // an empty buffer, usually an output.
 
   switch (array.data_type) {
     case ArrayDataType::kFloat:
-      return CopyBuffer<ArrayDataType::kFloat>(array, builder);
+      return CopyBuffer<ArrayDataType::kFloat>(array, builder, alignment);
     case ArrayDataType::kInt16:
-      return CopyBuffer<ArrayDataType::kInt16>(array, builder);
+      return CopyBuffer<ArrayDataType::kInt16>(array, builder, alignment);
     case ArrayDataType::kInt32:
-      return CopyBuffer<ArrayDataType::kInt32>(array, builder);
+      return CopyBuffer<ArrayDataType::kInt32>(array, builder, alignment);
     case ArrayDataType::kInt64:
-      return CopyBuffer<ArrayDataType::kInt64>(array, builder);
+      return CopyBuffer<ArrayDataType::kInt64>(array, builder, alignment);
     case ArrayDataType::kString:
       return CopyStringToBuffer(array, builder);
     case ArrayDataType::kUint8:
-      return CopyBuffer<ArrayDataType::kUint8>(array, builder);
+      return CopyBuffer<ArrayDataType::kUint8>(array, builder, alignment);
     case ArrayDataType::kBool:
       return CopyBoolToBuffer(array, builder);
     case ArrayDataType::kComplex64:
-      return CopyBuffer<ArrayDataType::kComplex64>(array, builder);
+      return CopyBuffer<ArrayDataType::kComplex64>(array, builder, alignment);
     default:
       LOG(FATAL) << "Unhandled array data type.";
   }
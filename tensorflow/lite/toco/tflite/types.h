@@ -32,9 +32,12 @@ struct DataBuffer {
 
   // Build the flatbuffer representation of a toco's Array and return the
   // corresponding offset into the flatbuffer. Note that data from the array
-  // will be copied into the flatbuffer.
+  // will be copied into the flatbuffer. If `alignment` is positive and the
+  // data has at least that many bytes, the data is aligned to `alignment`
+  // bytes, which must be a power of two.
   static FlatBufferOffset Serialize(const Array& array,
-                                    flatbuffers::FlatBufferBuilder* builder);
+                                    flatbuffers::FlatBufferBuilder* builder,
+                                    int alignment = 0);
   // Copy data from the given tensor into toco's Array.
   static void Deserialize(const ::tflite::Tensor& tensor,
                           const ::tflite::Buffer& buffer, Array* array);
@@ -182,6 +182,24 @@ TEST(DataBuffer, Complex64) {
                                      std::complex<float>(3.0f, 4.0f)));
 }
 
+TEST(DataBuffer, AlignedBuffers) {
+  Array array;
+  array.data_type = ArrayDataType::kFloat;
+  array.GetMutableBuffer<ArrayDataType::kFloat>().data.resize(100, 1.0f);
+
+  flatbuffers::FlatBufferBuilder builder;
+  // Misalign the end of the flatbuffer, where data is added first.
+  builder.CreateVector(std::vector<uint8_t>(3));
+  Offset<Vector<uint8_t>> data_buffer =
+      DataBuffer::Serialize(array, &builder, /*alignment=*/256);
+  builder.Finish(::tflite::CreateBuffer(builder, data_buffer));
+
+  auto* buffer =
+      flatbuffers::GetRoot<::tflite::Buffer>(builder.GetBufferPointer());
+  ASSERT_EQ(buffer->data()->size(), 400);
+  EXPECT_EQ((buffer->data()->data() - builder.GetBufferPointer()) % 256, 0);
+}
+
 TEST(Padding, All) {
   EXPECT_EQ(::tflite::Padding_SAME, Padding::Serialize(PaddingType::kSame));
   EXPECT_EQ(PaddingType::kSame, Padding::Deserialize(::tflite::Padding_SAME));
@@ -131,6 +131,12 @@ bool ParseTocoFlagsFromCommandLineFlags(
            "generate runtime memory offsets for activation Tensors (with 128 "
            "bits alignment) and error out on models with undetermined Tensor "
            "shape. (Default: True)"),
+      Flag("buffer_alignment", parsed_flags.buffer_alignment.bind(),
+           parsed_flags.buffer_alignment.default_value(),
+           "If positive, align the constant buffers of at least this many "
+           "bytes to this many bytes in the TF Lite flatbuffer, e.g. to the "
+           "page size so that weights can be loaded lazily. Must be a power "
+           "of two."),
       Flag(
           "drop_control_dependency",
           parsed_flags.drop_control_dependency.bind(),
@@ -282,6 +288,7 @@ void ReadTocoFlagsFromCommandLineFlags(const ParsedTocoFlags& parsed_toco_flags,
   READ_TOCO_FLAG(post_training_quantize, FlagRequirement::kNone);
   READ_TOCO_FLAG(enable_select_tf_ops, FlagRequirement::kNone);
   READ_TOCO_FLAG(force_select_tf_ops, FlagRequirement::kNone);
+  READ_TOCO_FLAG(buffer_alignment, FlagRequirement::kNone);
 
   if (parsed_toco_flags.force_select_tf_ops.value() &&
       !parsed_toco_flags.enable_select_tf_ops.value()) {
@@ -145,6 +145,8 @@ bool SupportsPreallocatedWorkspace(FileFormat format) {
 
 bool SupportsShuffledFCWeights(FileFormat format) { return format == TFLITE; }
 
+bool SupportsSparseFCWeights(FileFormat format) { return format == TFLITE; }
+
 bool IsRealValued(toco::ArrayDataType type) {
   // TODO(benoitjacob) - this is hardcoding that uint8 and int16 are only used
   // for quantized real-number values, and no other integer type is ever used
@@ -410,6 +412,11 @@ tensorflow::Status TransformWithStatus(const TocoFlags& toco_flags,
         dequantization_transformations));
   }
 
+  if (SupportsSparseFCWeights(output_format)) {
+    TF_RETURN_IF_ERROR(RunGraphTransformationsWithStatus(
+        model, "sparsification of FC weights", {new SparsifyFCWeights}));
+  }
+
   if (output_format == TENSORFLOW_GRAPHDEF) {
     EncodeConstantArraysMinMaxByWrappingThemInFakeQuantNodes(model);
   }
@@ -468,6 +475,7 @@ tensorflow::Status Export(const TocoFlags& toco_flags, const Model& model,
           toco_flags.force_select_tf_ops() || toco_flags.enable_select_tf_ops();
       params.allow_custom_ops = allow_custom_ops;
       params.allow_dynamic_tensors = toco_flags.allow_dynamic_tensors();
+      params.buffer_alignment = toco_flags.buffer_alignment();
 
       if (toco_flags.post_training_quantize()) {
         if (toco_flags.quantize_to_float16()) {
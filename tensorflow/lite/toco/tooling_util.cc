@@ -2390,7 +2390,10 @@ void UndoWeightsShuffling(Model* model) {
       continue;
     }
     const auto& fc_op = static_cast<toco::FullyConnectedOperator&>(*op);
-    if (fc_op.weights_format == FullyConnectedWeightsFormat::kDefault) {
+    // Sparse1x4 weights are stored like the default ones, only shuffled
+    // weights need undoing.
+    if (fc_op.weights_format !=
+        FullyConnectedWeightsFormat::kShuffled4x16Int8) {
       continue;
     }
     const string& weights_name = fc_op.inputs[1];
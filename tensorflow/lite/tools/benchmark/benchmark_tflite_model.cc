@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -31,10 +33,13 @@ limitations under the License.
 #include "tensorflow/lite/model.h"
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/pmu_profile_summarizer.h"
+#include "tensorflow/lite/profiling/pmu_profiler.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/logging.h"
+#include "tensorflow/lite/tools/benchmark/nnapi_partition_calibration.h"
 #include "tensorflow/lite/tools/evaluation/utils.h"
 
 #ifdef GEMMLOWP_PROFILING
@@ -77,6 +82,36 @@ class ProfilingListener : public BenchmarkListener {
   profiling::ProfileSummarizer summarizer_;
 };
 
+// Dumps the hardware performance counters of each op, and optionally writes
+// them to a Chrome trace file.
+class PmuProfilingListener : public BenchmarkListener {
+ public:
+  PmuProfilingListener(Interpreter* interpreter, uint32_t max_num_entries,
+                       const std::string& trace_file)
+      : interpreter_(interpreter),
+        profiler_(max_num_entries),
+        trace_file_(trace_file) {
+    TFLITE_BENCHMARK_CHECK(interpreter);
+    interpreter_->SetProfiler(&profiler_);
+    if (!profiler_.IsAvailable()) {
+      TFLITE_LOG(WARN) << "No PMU counters available, only op times will be "
+                          "reported.";
+    }
+  }
+
+  void OnSingleRunStart(RunType run_type) override;
+
+  void OnSingleRunEnd() override;
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+ private:
+  Interpreter* interpreter_;
+  profiling::PmuProfiler profiler_;
+  profiling::PmuProfileSummarizer summarizer_;
+  std::string trace_file_;
+};
+
 // Dumps gemmlowp profiling events if gemmlowp profiling is enabled.
 class GemmlowpProfilingListener : public BenchmarkListener {
  public:
@@ -104,6 +139,32 @@ void ProfilingListener::OnSingleRunEnd() {
   summarizer_.ProcessProfiles(profile_events, *interpreter_);
 }
 
+void PmuProfilingListener::OnSingleRunStart(RunType run_type) {
+  if (run_type == REGULAR) {
+    profiler_.Reset();
+    profiler_.StartProfiling();
+  }
+}
+
+void PmuProfilingListener::OnSingleRunEnd() {
+  profiler_.StopProfiling();
+  summarizer_.ProcessProfiles(profiler_.GetProfileEvents(), *interpreter_);
+}
+
+void PmuProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
+  if (!summarizer_.HasProfiles()) {
+    return;
+  }
+  TFLITE_LOG(INFO) << summarizer_.GetOutputString();
+  if (!trace_file_.empty()) {
+    std::ofstream trace(trace_file_);
+    trace << summarizer_.GetChromeTrace();
+    if (!trace) {
+      TFLITE_LOG(ERROR) << "Failed to write the PMU trace to " << trace_file_;
+    }
+  }
+}
+
 void GemmlowpProfilingListener::OnBenchmarkStart(
     const BenchmarkParams& params) {
 #ifdef GEMMLOWP_PROFILING
@@ -211,6 +272,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("nnapi_accelerator_name",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("nnapi_partition_plan",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("nnapi_calibrate_partitions",
+                          BenchmarkParam::Create<bool>(false));
   default_params.AddParam("use_gpu", BenchmarkParam::Create<bool>(false));
 #if defined(__ANDROID__)
   default_params.AddParam("gpu_precision_loss_allowed",
@@ -227,6 +292,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
       BenchmarkParam::Create<bool>(kOpProfilingEnabledDefault));
   default_params.AddParam("max_profiling_buffer_entries",
                           BenchmarkParam::Create<int32_t>(1024));
+  default_params.AddParam("enable_op_pmu_profiling",
+                          BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("pmu_profiling_trace_file",
+                          BenchmarkParam::Create<std::string>(""));
   return default_params;
 }
 
@@ -260,6 +329,12 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
     CreateFlag<std::string>(
         "nnapi_accelerator_name", &params_,
         "the name of the nnapi accelerator to use (requires Android Q+)"),
+    CreateFlag<std::string>(
+        "nnapi_partition_plan", &params_,
+        "file with the nodes the nnapi delegate should leave to the CPU"),
+    CreateFlag<bool>("nnapi_calibrate_partitions", &params_,
+                     "measure which nnapi partitions are faster on the CPU "
+                     "and write them to --nnapi_partition_plan"),
     CreateFlag<bool>("use_gpu", &params_, "use gpu"),
 #if defined(__ANDROID__)
     CreateFlag<bool>("gpu_precision_loss_allowed", &params_,
@@ -274,7 +349,13 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
                      "require delegate to run the entire graph"),
     CreateFlag<bool>("enable_op_profiling", &params_, "enable op profiling"),
     CreateFlag<int32_t>("max_profiling_buffer_entries", &params_,
-                        "max profiling buffer entries")
+                        "max profiling buffer entries"),
+    CreateFlag<bool>("enable_op_pmu_profiling", &params_,
+                     "enable op profiling with hardware performance counters "
+                     "(Linux and Android only)"),
+    CreateFlag<std::string>(
+        "pmu_profiling_trace_file", &params_,
+        "file to write the op PMU profiles to, in Chrome trace format")
   };
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
@@ -295,6 +376,13 @@ void BenchmarkTfLiteModel::LogParams() {
     TFLITE_LOG(INFO) << "nnapi accelerator name: ["
                      << params_.Get<string>("nnapi_accelerator_name") << "]";
   }
+  if (!params_.Get<std::string>("nnapi_partition_plan").empty()) {
+    TFLITE_LOG(INFO) << "nnapi partition plan: ["
+                     << params_.Get<std::string>("nnapi_partition_plan")
+                     << "]";
+  }
+  TFLITE_LOG(INFO) << "Calibrate nnapi partitions : ["
+                   << params_.Get<bool>("nnapi_calibrate_partitions") << "]";
   TFLITE_LOG(INFO) << "Use gpu : [" << params_.Get<bool>("use_gpu") << "]";
 #if defined(__ANDROID__)
   TFLITE_LOG(INFO) << "Allow lower precision in gpu : ["
@@ -311,6 +399,13 @@ void BenchmarkTfLiteModel::LogParams() {
   TFLITE_LOG(INFO) << "Max profiling buffer entries: ["
                    << params_.Get<int32_t>("max_profiling_buffer_entries")
                    << "]";
+  TFLITE_LOG(INFO) << "Enable op PMU profiling: ["
+                   << params_.Get<bool>("enable_op_pmu_profiling") << "]";
+  if (!params_.Get<std::string>("pmu_profiling_trace_file").empty()) {
+    TFLITE_LOG(INFO) << "PMU profiling trace file: ["
+                     << params_.Get<std::string>("pmu_profiling_trace_file")
+                     << "]";
+  }
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
@@ -484,6 +579,10 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
 
   interpreter_->UseNNAPI(params_.Get<bool>("use_legacy_nnapi"));
 
+  if (params_.Get<bool>("use_nnapi")) {
+    TF_LITE_ENSURE_STATUS(PrepareNnApiPartitionPlan(*resolver));
+  }
+
   delegates_ = GetDelegates();
   for (const auto& delegate : delegates_) {
     if (interpreter_->ModifyGraphWithDelegate(delegate.second.get()) !=
@@ -537,33 +636,87 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     }
   }
 
+  TF_LITE_ENSURE_STATUS(ResizeInputsAndAllocate(interpreter_.get()));
+
+  // Install profilers if necessary. The interpreter takes a single profiler,
+  // so PMU profiling replaces the regular op profiling.
+  if (params_.Get<bool>("enable_op_pmu_profiling")) {
+    if (params_.Get<bool>("enable_op_profiling")) {
+      TFLITE_LOG(WARN) << "Op profiling is disabled by op PMU profiling.";
+    }
+    profiling_listener_.reset(new PmuProfilingListener(
+        interpreter_.get(),
+        params_.Get<int32_t>("max_profiling_buffer_entries"),
+        params_.Get<std::string>("pmu_profiling_trace_file")));
+    AddListener(profiling_listener_.get());
+  } else if (params_.Get<bool>("enable_op_profiling")) {
+    profiling_listener_.reset(new ProfilingListener(
+        interpreter_.get(),
+        params_.Get<int32_t>("max_profiling_buffer_entries")));
+    AddListener(profiling_listener_.get());
+  }
+#ifdef GEMMLOWP_PROFILING
+  gemmlowp_profiling_listener_.reset(new GemmlowpProfilingListener());
+  AddListener(gemmlowp_profiling_listener_.get());
+#endif
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::ResizeInputsAndAllocate(
+    Interpreter* interpreter) const {
   // Resize all non-string tensors.
+  auto interpreter_inputs = interpreter->inputs();
   for (int j = 0; j < inputs_.size(); ++j) {
     const InputLayerInfo& input = inputs_[j];
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type != kTfLiteString) {
-      interpreter_->ResizeInputTensor(i, input.shape);
+      interpreter->ResizeInputTensor(i, input.shape);
     }
   }
 
-  if (interpreter_->AllocateTensors() != kTfLiteOk) {
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
     TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
     return kTfLiteError;
   }
+  return kTfLiteOk;
+}
 
-  // Install profilers if necessary.
-  if (params_.Get<bool>("enable_op_profiling")) {
-    profiling_listener_.reset(new ProfilingListener(
-        interpreter_.get(),
-        params_.Get<int32_t>("max_profiling_buffer_entries")));
-    AddListener(profiling_listener_.get());
+TfLiteStatus BenchmarkTfLiteModel::PrepareNnApiPartitionPlan(
+    const OpResolver& resolver) {
+  const std::string plan_path =
+      params_.Get<std::string>("nnapi_partition_plan");
+  if (params_.Get<bool>("nnapi_calibrate_partitions")) {
+    StatefulNnApiDelegate::Options options;
+    std::string accelerator_name =
+        params_.Get<std::string>("nnapi_accelerator_name");
+    if (!accelerator_name.empty()) {
+      options.accelerator_name = accelerator_name.c_str();
+    }
+    TFLITE_LOG(INFO) << "Calibrating NNAPI partitions.";
+    TF_LITE_ENSURE_STATUS(CalibrateNnApiPartitions(
+        *model_, resolver, params_.Get<int32_t>("num_threads"),
+        [this](Interpreter* interpreter) {
+          return ResizeInputsAndAllocate(interpreter);
+        },
+        options, std::max(params_.Get<int32_t>("num_runs"), 1),
+        &nnapi_partition_plan_));
+    if (!plan_path.empty() &&
+        !WriteNnApiPartitionPlan(nnapi_partition_plan_, plan_path)) {
+      TFLITE_LOG(ERROR) << "Failed to write NNAPI partition plan "
+                        << plan_path;
+      return kTfLiteError;
+    }
+  } else if (!plan_path.empty()) {
+    if (!ReadNnApiPartitionPlan(plan_path, &nnapi_partition_plan_)) {
+      TFLITE_LOG(ERROR) << "Failed to read NNAPI partition plan " << plan_path;
+      return kTfLiteError;
+    }
+  } else {
+    return kTfLiteOk;
   }
-#ifdef GEMMLOWP_PROFILING
-  gemmlowp_profiling_listener_.reset(new GemmlowpProfilingListener());
-  AddListener(gemmlowp_profiling_listener_.get());
-#endif
-
+  has_nnapi_partition_plan_ = true;
   return kTfLiteOk;
 }
 
@@ -620,6 +773,9 @@ BenchmarkTfLiteModel::TfLiteDelegatePtrMap BenchmarkTfLiteModel::GetDelegates()
     if (!accelerator_name.empty()) {
       options.accelerator_name = accelerator_name.c_str();
     }
+    if (has_nnapi_partition_plan_) {
+      options.partition_plan = &nnapi_partition_plan_;
+    }
     Interpreter::TfLiteDelegatePtr delegate =
         evaluation::CreateNNAPIDelegate(options);
     if (!delegate) {
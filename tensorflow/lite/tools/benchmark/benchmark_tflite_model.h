@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "tensorflow/lite/delegates/nnapi/nnapi_partition_plan.h"
 #include "tensorflow/lite/model.h"
 #include "tensorflow/lite/profiling/profiler.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -70,11 +71,19 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
     TfLitePtrUnion data;
     size_t bytes;
   };
+  // Resizes the non-string inputs to the requested shapes and allocates the
+  // tensors of 'interpreter'.
+  TfLiteStatus ResizeInputsAndAllocate(Interpreter* interpreter) const;
+  // Reads or calibrates the NNAPI partition plan, as requested by the params.
+  TfLiteStatus PrepareNnApiPartitionPlan(const OpResolver& resolver);
+
   std::vector<InputLayerInfo> inputs_;
   std::vector<InputTensorData> inputs_data_;
   std::unique_ptr<BenchmarkListener> profiling_listener_;
   std::unique_ptr<BenchmarkListener> gemmlowp_profiling_listener_;
   TfLiteDelegatePtrMap delegates_;
+  bool has_nnapi_partition_plan_ = false;
+  NnApiPartitionPlan nnapi_partition_plan_;
 };
 
 }  // namespace benchmark
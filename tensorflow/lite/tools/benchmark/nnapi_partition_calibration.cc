@@ -0,0 +1,189 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/nnapi_partition_calibration.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/context_util.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/logging.h"
+#include "tensorflow/lite/tools/evaluation/utils.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Moving partitions to the CPU rarely changes the partitioning of the rest of
+// the graph more than once or twice.
+constexpr int kMaxCalibrationRounds = 4;
+
+// Accumulates the time spent invoking each node of the execution plan.
+class NodeTimeProfiler : public Profiler {
+ public:
+  explicit NodeTimeProfiler(int num_nodes) : node_time_us_(num_nodes, 0) {}
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      uint32_t event_metadata) override {
+    if (event_type != EventType::OPERATOR_INVOKE_EVENT) return kIgnored;
+    events_.push_back({event_metadata, profiling::time::NowMicros()});
+    return events_.size() - 1;
+  }
+
+  void EndEvent(uint32_t event_handle) override {
+    if (event_handle >= events_.size()) return;
+    const Event& event = events_[event_handle];
+    if (event.node_index < node_time_us_.size()) {
+      node_time_us_[event.node_index] +=
+          profiling::time::NowMicros() - event.begin_us;
+    }
+  }
+
+  // Forgets the events of the previous invocation, keeping the totals.
+  void ClearEvents() { events_.clear(); }
+
+  uint64_t node_time_us(int node_index) const {
+    return node_index < static_cast<int>(node_time_us_.size())
+               ? node_time_us_[node_index]
+               : 0;
+  }
+
+ private:
+  static constexpr uint32_t kIgnored = ~0u;
+
+  struct Event {
+    uint32_t node_index;
+    uint64_t begin_us;
+  };
+  std::vector<Event> events_;
+  std::vector<uint64_t> node_time_us_;
+};
+
+// Builds an interpreter for 'model', applying 'delegate' if not null, and
+// returns in 'profiler' the time spent in each node over 'num_runs'
+// invocations following a warm-up one.
+TfLiteStatus ProfileNodes(const FlatBufferModel& model,
+                          const OpResolver& resolver, int num_threads,
+                          const PrepareInterpreterFn& prepare_interpreter,
+                          TfLiteDelegate* delegate, int num_runs,
+                          std::unique_ptr<Interpreter>* interpreter,
+                          std::unique_ptr<NodeTimeProfiler>* profiler) {
+  InterpreterBuilder(model, resolver)(interpreter, num_threads);
+  if (!*interpreter) {
+    TFLITE_LOG(ERROR) << "Failed to construct interpreter";
+    return kTfLiteError;
+  }
+  if (delegate && (*interpreter)->ModifyGraphWithDelegate(delegate) !=
+                      kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to apply NNAPI delegate.";
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_STATUS(prepare_interpreter(interpreter->get()));
+  for (int input : (*interpreter)->inputs()) {
+    TfLiteTensor* tensor = (*interpreter)->tensor(input);
+    if (tensor->type == kTfLiteString) {
+      TFLITE_LOG(ERROR) << "NNAPI partition calibration does not support "
+                           "string inputs.";
+      return kTfLiteError;
+    }
+    std::memset(tensor->data.raw, 0, tensor->bytes);
+  }
+
+  TF_LITE_ENSURE_STATUS((*interpreter)->Invoke());
+  profiler->reset(new NodeTimeProfiler((*interpreter)->nodes_size()));
+  (*interpreter)->SetProfiler(profiler->get());
+  for (int run = 0; run < num_runs; ++run) {
+    (*profiler)->ClearEvents();
+    TF_LITE_ENSURE_STATUS((*interpreter)->Invoke());
+  }
+  (*interpreter)->SetProfiler(nullptr);
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteStatus CalibrateNnApiPartitions(
+    const FlatBufferModel& model, const OpResolver& resolver, int num_threads,
+    const PrepareInterpreterFn& prepare_interpreter,
+    const StatefulNnApiDelegate::Options& options, int num_runs,
+    NnApiPartitionPlan* plan) {
+  std::unique_ptr<Interpreter> cpu_interpreter;
+  std::unique_ptr<NodeTimeProfiler> cpu_profiler;
+  TF_LITE_ENSURE_STATUS(ProfileNodes(model, resolver, num_threads,
+                                     prepare_interpreter, nullptr, num_runs,
+                                     &cpu_interpreter, &cpu_profiler));
+
+  plan->num_nodes = cpu_interpreter->execution_plan().size();
+  plan->cpu_nodes.clear();
+  for (int round = 0; round < kMaxCalibrationRounds; ++round) {
+    StatefulNnApiDelegate::Options round_options = options;
+    round_options.partition_plan = plan;
+    Interpreter::TfLiteDelegatePtr delegate =
+        evaluation::CreateNNAPIDelegate(round_options);
+    if (!delegate) {
+      TFLITE_LOG(ERROR) << "NNAPI acceleration is unsupported on this "
+                           "platform.";
+      return kTfLiteError;
+    }
+
+    std::unique_ptr<Interpreter> interpreter;
+    std::unique_ptr<NodeTimeProfiler> profiler;
+    TF_LITE_ENSURE_STATUS(ProfileNodes(model, resolver, num_threads,
+                                       prepare_interpreter, delegate.get(),
+                                       num_runs, &interpreter, &profiler));
+
+    std::vector<int> slower_nodes;
+    for (int node_index : interpreter->execution_plan()) {
+      const TfLiteNode& node =
+          interpreter->node_and_registration(node_index)->first;
+      if (node.delegate != delegate.get()) continue;
+      const TfLiteDelegateParams* params =
+          reinterpret_cast<const TfLiteDelegateParams*>(node.builtin_data);
+      uint64_t cpu_time_us = 0;
+      for (int replaced : TfLiteIntArrayView(params->nodes_to_replace)) {
+        cpu_time_us += cpu_profiler->node_time_us(replaced);
+      }
+      const uint64_t nnapi_time_us = profiler->node_time_us(node_index);
+      TFLITE_LOG(INFO) << "NNAPI partition of "
+                       << params->nodes_to_replace->size << " nodes: "
+                       << nnapi_time_us / num_runs << " us, on CPU: "
+                       << cpu_time_us / num_runs << " us";
+      if (nnapi_time_us >= cpu_time_us) {
+        slower_nodes.insert(slower_nodes.end(),
+                            params->nodes_to_replace->data,
+                            params->nodes_to_replace->data +
+                                params->nodes_to_replace->size);
+      }
+    }
+    if (slower_nodes.empty()) break;
+
+    plan->cpu_nodes.insert(plan->cpu_nodes.end(), slower_nodes.begin(),
+                           slower_nodes.end());
+    std::sort(plan->cpu_nodes.begin(), plan->cpu_nodes.end());
+  }
+
+  TFLITE_LOG(INFO) << "NNAPI partition calibration keeps "
+                   << plan->cpu_nodes.size() << " of " << plan->num_nodes
+                   << " nodes on the CPU.";
+  return kTfLiteOk;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,52 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_NNAPI_PARTITION_CALIBRATION_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_NNAPI_PARTITION_CALIBRATION_H_
+
+#include <functional>
+
+#include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
+#include "tensorflow/lite/delegates/nnapi/nnapi_partition_plan.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/op_resolver.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Resizes the inputs of an interpreter and allocates its tensors.
+using PrepareInterpreterFn = std::function<TfLiteStatus(Interpreter*)>;
+
+// Measures on this device which of the partitions delegated to NNAPI run
+// faster on the CPU, and lists their nodes in 'plan'.
+//
+// The model is first run on the CPU to time every node, then with the NNAPI
+// delegate created from 'options' to time every delegated partition. A
+// partition whose NNAPI time, including the transfer of its inputs and
+// outputs, is not below the CPU time of its nodes is moved to the CPU. As
+// moving nodes may change how the remaining ones are partitioned, this repeats
+// until every delegated partition pays off, for a bounded number of rounds.
+// Each measurement averages 'num_runs' invocations on zero-filled inputs.
+TfLiteStatus CalibrateNnApiPartitions(
+    const FlatBufferModel& model, const OpResolver& resolver, int num_threads,
+    const PrepareInterpreterFn& prepare_interpreter,
+    const StatefulNnApiDelegate::Options& options, int num_runs,
+    NnApiPartitionPlan* plan);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_NNAPI_PARTITION_CALIBRATION_H_
@@ -0,0 +1,254 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/plan_memory.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/arena_planner.h"
+
+namespace tflite {
+namespace optimize {
+
+namespace {
+
+// The part of the subgraph during which a tensor lives in the arena.
+struct TensorUsage {
+  int tensor;
+  int64_t size;
+  // Indices of the first and last operators using the tensor.
+  int first_op;
+  int last_op;
+};
+
+int64_t AlignTo(int64_t alignment, int64_t offset) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Returns the size in bytes of `tensor`, or -1 if it is only known at
+// runtime.
+int64_t GetTensorSize(const TensorT& tensor) {
+  int64_t size;
+  switch (tensor.type) {
+    case TensorType_BOOL:
+    case TensorType_INT8:
+    case TensorType_UINT8:
+      size = 1;
+      break;
+    case TensorType_FLOAT16:
+    case TensorType_INT16:
+      size = 2;
+      break;
+    case TensorType_FLOAT32:
+    case TensorType_INT32:
+      size = 4;
+      break;
+    case TensorType_COMPLEX64:
+    case TensorType_INT64:
+      size = 8;
+      break;
+    default:
+      return -1;
+  }
+  for (int32_t dim : tensor.shape) {
+    if (dim < 0) return -1;
+    size *= dim;
+  }
+  return size;
+}
+
+// Returns the arena tensors of `subgraph` along with when they are used,
+// following the allocation order of ArenaPlanner: the inputs of the subgraph
+// are allocated before the first operator and never released, the outputs of
+// an operator are allocated when it runs and released after their last use,
+// and the outputs of the subgraph are never released.
+std::vector<TensorUsage> GetTensorUsages(const ModelT& model,
+                                         const SubGraphT& subgraph) {
+  const int num_ops = subgraph.operators.size();
+  const int num_tensors = subgraph.tensors.size();
+  std::vector<int> first_op(num_tensors, -1);
+  std::vector<int> last_op(num_tensors, -1);
+  for (int tensor : subgraph.inputs) {
+    first_op[tensor] = 0;
+    last_op[tensor] = num_ops;
+  }
+  for (int op = 0; op < num_ops; ++op) {
+    for (int tensor : subgraph.operators[op]->inputs) {
+      if (tensor != kOptionalTensor) {
+        last_op[tensor] = std::max(last_op[tensor], op);
+      }
+    }
+    for (int tensor : subgraph.operators[op]->outputs) {
+      if (first_op[tensor] == -1) {
+        first_op[tensor] = op;
+      }
+    }
+  }
+  for (int tensor = 0; tensor < num_tensors; ++tensor) {
+    // Tensors that are never read are never released either.
+    if (last_op[tensor] < first_op[tensor]) {
+      last_op[tensor] = num_ops;
+    }
+  }
+  for (int tensor : subgraph.outputs) {
+    last_op[tensor] = num_ops;
+  }
+
+  std::vector<TensorUsage> usages;
+  for (int tensor = 0; tensor < num_tensors; ++tensor) {
+    const TensorT& tensor_t = *subgraph.tensors[tensor];
+    const bool has_data = tensor_t.buffer < model.buffers.size() &&
+                          !model.buffers[tensor_t.buffer]->data.empty();
+    if (first_op[tensor] == -1 || has_data || tensor_t.is_variable) {
+      continue;
+    }
+    const int64_t size = GetTensorSize(tensor_t);
+    if (size >= 0) {
+      usages.push_back({tensor, size, first_op[tensor], last_op[tensor]});
+    }
+  }
+  return usages;
+}
+
+// Places the tensors in the given order, each one at the lowest offset where
+// it doesn't overlap the tensors placed before it that are alive at the same
+// time. Returns the size of the arena.
+int64_t PlaceTensors(const std::vector<TensorUsage>& usages,
+                     const std::vector<int>& order,
+                     std::vector<int64_t>* offsets) {
+  offsets->assign(usages.size(), -1);
+  std::vector<int> placed;
+  int64_t arena_size = 0;
+  for (int i : order) {
+    const TensorUsage& usage = usages[i];
+    std::vector<int> conflicts;
+    for (int j : placed) {
+      if (usages[j].first_op <= usage.last_op &&
+          usage.first_op <= usages[j].last_op) {
+        conflicts.push_back(j);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [&](int a, int b) {
+      return (*offsets)[a] < (*offsets)[b];
+    });
+    int64_t offset = 0;
+    for (int j : conflicts) {
+      if (offset + usage.size <= (*offsets)[j]) break;
+      offset = std::max(offset, AlignTo(kDefaultTensorAlignment,
+                                        (*offsets)[j] + usages[j].size));
+    }
+    (*offsets)[i] = offset;
+    arena_size = std::max(arena_size, offset + usage.size);
+    placed.push_back(i);
+  }
+  return arena_size;
+}
+
+// Returns the offset of each tensor of `subgraph`, or -1 for the tensors that
+// are planned at runtime.
+std::vector<int32_t> PlanSubgraph(const ModelT& model,
+                                  const SubGraphT& subgraph,
+                                  int64_t* arena_size) {
+  const std::vector<TensorUsage> usages = GetTensorUsages(model, subgraph);
+  std::vector<int> order(usages.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  // Orders to try: chronological, as the interpreter does, largest tensors
+  // first, and longest lived tensors first.
+  std::vector<std::vector<int>> orders;
+  orders.push_back(order);
+  std::stable_sort(order.begin(), order.end(), [&usages](int a, int b) {
+    return usages[a].size > usages[b].size;
+  });
+  orders.push_back(order);
+  std::stable_sort(order.begin(), order.end(), [&usages](int a, int b) {
+    return usages[a].last_op - usages[a].first_op >
+           usages[b].last_op - usages[b].first_op;
+  });
+  orders.push_back(order);
+
+  std::vector<int64_t> best_offsets;
+  *arena_size = std::numeric_limits<int64_t>::max();
+  for (const std::vector<int>& candidate : orders) {
+    std::vector<int64_t> offsets;
+    const int64_t size = PlaceTensors(usages, candidate, &offsets);
+    if (size < *arena_size) {
+      *arena_size = size;
+      best_offsets = std::move(offsets);
+    }
+  }
+
+  std::vector<int32_t> plan(subgraph.tensors.size(), -1);
+  for (size_t i = 0; i < usages.size(); ++i) {
+    plan[usages[i].tensor] = best_offsets[i];
+  }
+  return plan;
+}
+
+}  // namespace
+
+TfLiteStatus PlanMemory(ModelT* model, ErrorReporter* error_reporter) {
+  // Drop previous plans, along with the data of their buffers.
+  auto& metadata = model->metadata;
+  for (auto it = metadata.begin(); it != metadata.end();) {
+    if ((*it)->name == kOfflineMemoryAllocationMetadata) {
+      if ((*it)->buffer < model->buffers.size()) {
+        model->buffers[(*it)->buffer]->data.clear();
+      }
+      it = metadata.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (int subgraph_index = 0; subgraph_index < model->subgraphs.size();
+       ++subgraph_index) {
+    const SubGraphT& subgraph = *model->subgraphs[subgraph_index];
+    int64_t arena_size;
+    const std::vector<int32_t> plan =
+        PlanSubgraph(*model, subgraph, &arena_size);
+    if (arena_size > std::numeric_limits<int32_t>::max()) {
+      error_reporter->Report("Arena of subgraph %d is too large to plan.",
+                             subgraph_index);
+      return kTfLiteError;
+    }
+
+    std::vector<int32_t> values = {kOfflineMemoryAllocationVersion,
+                                   subgraph_index,
+                                   static_cast<int32_t>(plan.size())};
+    values.insert(values.end(), plan.begin(), plan.end());
+    auto buffer = absl::make_unique<BufferT>();
+    buffer->data.resize(values.size() * sizeof(int32_t));
+    for (size_t i = 0; i < values.size(); ++i) {
+      flatbuffers::WriteScalar(buffer->data.data() + i * sizeof(int32_t),
+                               values[i]);
+    }
+    model->buffers.push_back(std::move(buffer));
+
+    auto plan_metadata = absl::make_unique<MetadataT>();
+    plan_metadata->name = kOfflineMemoryAllocationMetadata;
+    plan_metadata->buffer = model->buffers.size() - 1;
+    metadata.push_back(std::move(plan_metadata));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace optimize
+}  // namespace tflite
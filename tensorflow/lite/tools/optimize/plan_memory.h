@@ -0,0 +1,43 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_OPTIMIZE_PLAN_MEMORY_H_
+#define TENSORFLOW_LITE_TOOLS_OPTIMIZE_PLAN_MEMORY_H_
+
+#include "tensorflow/lite/context.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace optimize {
+
+// Plans the arena offsets of the tensors of each subgraph of `model` and
+// stores them in the model metadata (see kOfflineMemoryAllocationMetadata),
+// replacing any previous plan. The interpreter then places the tensors at
+// these offsets instead of planning them at every AllocateTensors.
+//
+// Only tensors with a static shape that the interpreter allocates in its
+// arena, i.e. the subgraph inputs and the outputs of its operators, are
+// planned. Several placement orders are tried and the plan needing the
+// smallest arena is kept, so the arena is usually smaller than the one the
+// interpreter plans on its own.
+//
+// Note: This is a private API, subject to change.
+TfLiteStatus PlanMemory(ModelT* model, ErrorReporter* error_reporter);
+
+}  // namespace optimize
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OPTIMIZE_PLAN_MEMORY_H_
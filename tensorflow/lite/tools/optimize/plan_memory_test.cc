@@ -0,0 +1,128 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/plan_memory.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/tools/optimize/test_util.h"
+
+namespace tflite {
+namespace optimize {
+namespace {
+
+using ::testing::ElementsAre;
+
+void AddTensor(ModelT* model, const std::vector<int32_t>& shape,
+               uint32_t buffer = 0) {
+  auto tensor = absl::make_unique<TensorT>();
+  tensor->shape = shape;
+  tensor->type = TensorType_FLOAT32;
+  tensor->buffer = buffer;
+  model->subgraphs[0]->tensors.push_back(std::move(tensor));
+}
+
+void AddOperator(ModelT* model, const std::vector<int32_t>& inputs,
+                 const std::vector<int32_t>& outputs) {
+  auto op = absl::make_unique<OperatorT>();
+  op->inputs = inputs;
+  op->outputs = outputs;
+  model->subgraphs[0]->operators.push_back(std::move(op));
+}
+
+// Returns the values stored in the buffer of the `index`th metadata.
+std::vector<int32_t> GetMetadataValues(const ModelT& model, int index) {
+  const std::vector<uint8_t>& data =
+      model.buffers[model.metadata[index]->buffer]->data;
+  std::vector<int32_t> values;
+  for (size_t i = 0; i < data.size(); i += sizeof(int32_t)) {
+    values.push_back(flatbuffers::ReadScalar<int32_t>(data.data() + i));
+  }
+  return values;
+}
+
+class PlanMemoryTest : public ::testing::Test {
+ protected:
+  PlanMemoryTest() {
+    model_.subgraphs.push_back(absl::make_unique<SubGraphT>());
+    model_.buffers.push_back(absl::make_unique<BufferT>());
+    model_.buffers.push_back(absl::make_unique<BufferT>());
+    model_.buffers[1]->data.resize(4 * 512 * 4);
+
+    // A chain of ops where the largest intermediate tensor, #2, lives while
+    // the input #0 is preserved. #5 holds constant weights.
+    AddTensor(&model_, {1, 256});
+    AddTensor(&model_, {1, 64});
+    AddTensor(&model_, {1, 512});
+    AddTensor(&model_, {1, 64});
+    AddTensor(&model_, {1, 16});
+    AddTensor(&model_, {4, 512}, /*buffer=*/1);
+    model_.subgraphs[0]->inputs = {0};
+    model_.subgraphs[0]->outputs = {4};
+    AddOperator(&model_, {0}, {1});
+    AddOperator(&model_, {1, 5}, {2});
+    AddOperator(&model_, {2}, {3});
+    AddOperator(&model_, {3}, {4});
+  }
+
+  ModelT model_;
+  internal::FailOnErrorReporter error_reporter_;
+};
+
+TEST_F(PlanMemoryTest, PlacesLargestTensorsFirst) {
+  ASSERT_EQ(PlanMemory(&model_, &error_reporter_), kTfLiteOk);
+
+  ASSERT_EQ(model_.metadata.size(), 1);
+  EXPECT_EQ(model_.metadata[0]->name, kOfflineMemoryAllocationMetadata);
+  // Placing the tensors in allocation order, as the interpreter does, needs
+  // 3584 bytes, while placing #2 first only needs 3328.
+  EXPECT_THAT(GetMetadataValues(model_, 0),
+              ElementsAre(kOfflineMemoryAllocationVersion, /*subgraph=*/0,
+                          /*num_tensors=*/6, 2048, 3072, 0, 3072, 0, -1));
+}
+
+TEST_F(PlanMemoryTest, ReplacesPreviousPlan) {
+  ASSERT_EQ(PlanMemory(&model_, &error_reporter_), kTfLiteOk);
+  const uint32_t previous_buffer = model_.metadata[0]->buffer;
+  ASSERT_EQ(PlanMemory(&model_, &error_reporter_), kTfLiteOk);
+
+  ASSERT_EQ(model_.metadata.size(), 1);
+  EXPECT_NE(model_.metadata[0]->buffer, previous_buffer);
+  EXPECT_TRUE(model_.buffers[previous_buffer]->data.empty());
+}
+
+TEST_F(PlanMemoryTest, SkipsTensorsWithDynamicShapes) {
+  model_.subgraphs[0]->tensors[2]->shape = {-1, 512};
+  ASSERT_EQ(PlanMemory(&model_, &error_reporter_), kTfLiteOk);
+
+  EXPECT_THAT(GetMetadataValues(model_, 0),
+              ElementsAre(kOfflineMemoryAllocationVersion, /*subgraph=*/0,
+                          /*num_tensors=*/6, 0, 1024, -1, 1024, 1280, -1));
+}
+
+}  // namespace
+}  // namespace optimize
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
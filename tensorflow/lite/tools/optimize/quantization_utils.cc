@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/tools/optimize/quantization_utils.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 
 #include "absl/memory/memory.h"
 #include "third_party/eigen3/Eigen/Core"
@@ -32,6 +34,7 @@ namespace utils {
 namespace {
 const int8_t kMinQuantizedValue = -127;
 const int8_t kMaxQuantizedValue = 127;
+const int8_t kMaxQuantizedInt4Value = 7;
 }  // namespace
 
 TfLiteStatus NumElements(const TensorT& tensor, uint64_t* num_elements) {
@@ -197,6 +200,59 @@ TfLiteStatus SymmetricQuantizeTensor(ModelT* model, TensorT* tensor) {
   return kTfLiteOk;
 }
 
+TfLiteStatus SymmetricQuantizeTensorPackedInt4(ModelT* model, TensorT* tensor) {
+  if (model == nullptr || tensor == nullptr) {
+    return kTfLiteError;
+  }
+  if (tensor->shape.size() != 2 || tensor->shape[1] % 2 != 0) {
+    return kTfLiteError;
+  }
+
+  BufferT* buffer = model->buffers[tensor->buffer].get();
+  if (buffer == nullptr) {
+    return kTfLiteError;
+  }
+  uint64_t num_elements;
+  TF_LITE_ENSURE_STATUS(NumElements(*tensor, &num_elements));
+
+  // Copy the buffer data to a float vector to guard against misalignment.
+  std::vector<float> float_vector(num_elements);
+  memcpy(float_vector.data(), buffer->data.data(),
+         num_elements * sizeof(float));
+  float max_abs = 0;
+  for (const float value : float_vector) {
+    max_abs = std::max(max_abs, std::abs(value));
+  }
+  const float scaling_factor =
+      max_abs == 0 ? 1.0f : max_abs / kMaxQuantizedInt4Value;
+
+  // Element 2k goes to the low nibble of byte k, element 2k + 1 to its high
+  // nibble.
+  std::vector<uint8_t> packed_buffer(num_elements / 2);
+  for (uint64_t i = 0; i < num_elements; ++i) {
+    const int32_t quantized_value = std::min<int32_t>(
+        kMaxQuantizedInt4Value,
+        std::max<int32_t>(-kMaxQuantizedInt4Value,
+                          TfLiteRound(float_vector[i] / scaling_factor)));
+    const uint8_t nibble = static_cast<uint8_t>(quantized_value) & 0x0f;
+    packed_buffer[i / 2] |= (i % 2 == 0) ? nibble : nibble << 4;
+  }
+
+  if (tensor->quantization == nullptr) {
+    tensor->quantization = absl::make_unique<QuantizationParametersT>();
+  }
+  tensor->quantization->scale = std::vector<float>(1, scaling_factor);
+  tensor->quantization->zero_point = std::vector<int64_t>(1, 0);
+
+  model->buffers[tensor->buffer]->data = std::move(packed_buffer);
+
+  // Update the tensor type and shape.
+  tensor->type = TensorType_INT8;
+  tensor->shape[1] /= 2;
+
+  return kTfLiteOk;
+}
+
 TfLiteStatus QuantizeTensorFloat16(ModelT* model, TensorT* tensor) {
   if (model == nullptr || tensor == nullptr) {
     return kTfLiteError;
@@ -64,6 +64,12 @@ void SymmetricPerChannelQuantizeValues(const float* const input,
 // of the tensor.
 TfLiteStatus SymmetricQuantizeTensor(ModelT* model, TensorT* tensor);
 
+// Quantizes a rank 2 tensor with an even last dimension using symmetric
+// quantization to values in [-7, 7], and packs them two per byte along the
+// last dimension, as in the PACKED_INT4 fully-connected weights format. The
+// tensor becomes INT8 with its last dimension halved.
+TfLiteStatus SymmetricQuantizeTensorPackedInt4(ModelT* model, TensorT* tensor);
+
 // Quantizes tensor to float16.
 TfLiteStatus QuantizeTensorFloat16(ModelT* model, TensorT* tensor);
 
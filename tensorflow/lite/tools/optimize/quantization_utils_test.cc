@@ -259,6 +259,35 @@ TEST(QuantizationUtilsTest, SymmetricQuantizeTensor) {
   EXPECT_EQ(quant_buffer_size * 4, float_buffer_size);
 }
 
+TEST(QuantizationUtilsTest, SymmetricQuantizeTensorPackedInt4) {
+  // Create data.
+  auto model = absl::make_unique<ModelT>();
+  auto tensor = absl::make_unique<TensorT>();
+  auto buffer = absl::make_unique<tflite::BufferT>();
+  const std::vector<float> weights = {-1.4, 0.6, 0.0, 1.4,
+                                      0.2, -0.6, 0.4, -0.2};
+  auto weights_reinterpreted_data =
+      reinterpret_cast<const unsigned char*>(weights.data());
+  buffer->data.assign(weights_reinterpreted_data,
+                      weights_reinterpreted_data + weights.size() * 4);
+  tensor->shape = {2, 4};
+  tensor->type = TensorType_FLOAT32;
+  tensor->buffer = 0;
+  model->buffers.push_back(std::move(buffer));
+
+  // Call and verify. The scale is 1.4 / 7, so the values are
+  // {-7, 3, 0, 7, 1, -3, 2, -1}, two per byte with the first in the low bits.
+  EXPECT_EQ(SymmetricQuantizeTensorPackedInt4(model.get(), tensor.get()),
+            kTfLiteOk);
+  EXPECT_EQ(tensor->type, TensorType_INT8);
+  EXPECT_THAT(tensor->shape, ElementsAreArray({2, 2}));
+  EXPECT_THAT(tensor->quantization->scale,
+              ElementsAreArray({::testing::FloatEq(0.2f)}));
+  EXPECT_THAT(tensor->quantization->zero_point, ElementsAreArray({0}));
+  EXPECT_THAT(model->buffers[0]->data,
+              ElementsAreArray({0x39, 0x70, 0xd1, 0xf2}));
+}
+
 TEST(QuantizationUtilsTest, QuantizeFloat16) {
   // Conv model has weights between 0 and 10.
   // Quantize the weights tensor.
@@ -287,6 +287,62 @@ void UpdateInt8OperatorVersions(ModelT* model) {
   }
 }
 
+// Returns true if the tensor can be stored as packed int4 weights, which is
+// the case when it is a rank 2 tensor with an even depth that is only used as
+// the weights of hybrid FULLY_CONNECTED ops with the default weights format.
+bool IsPackableInt4Weights(const ModelT* model, const SubGraphT* subgraph,
+                           int32_t tensor_idx, const TensorT* tensor) {
+  if (tensor->shape.size() != 2 || tensor->shape[1] % 2 != 0) {
+    return false;
+  }
+  if (std::find(subgraph->outputs.begin(), subgraph->outputs.end(),
+                tensor_idx) != subgraph->outputs.end()) {
+    return false;
+  }
+  const std::vector<ConsumerOpInfo> consumer_op_infos =
+      GetTensorConsumers(model, subgraph, tensor_idx);
+  if (consumer_op_infos.empty()) {
+    return false;
+  }
+  for (const ConsumerOpInfo& consumer_op_info : consumer_op_infos) {
+    const OperatorT* consumer_op = consumer_op_info.op;
+    if (model->operator_codes[consumer_op->opcode_index]->builtin_code !=
+            BuiltinOperator_FULLY_CONNECTED ||
+        consumer_op_info.op_input_idx != 1) {
+      return false;
+    }
+    const FullyConnectedOptionsT* options =
+        consumer_op->builtin_options.AsFullyConnectedOptions();
+    if (options == nullptr ||
+        options->weights_format != FullyConnectedOptionsWeightsFormat_DEFAULT) {
+      return false;
+    }
+    // The input must be float for the op to run the hybrid kernel.
+    const int32_t input_idx = consumer_op->inputs[0];
+    if (subgraph->tensors[input_idx]->type != TensorType_FLOAT32) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Quantizes the tensor to packed int4 values and marks the weights format of
+// its consumers, which IsPackableInt4Weights() checked are FULLY_CONNECTED
+// ops. Packed int4 weights need version 8 of FULLY_CONNECTED.
+TfLiteStatus PackInt4Weights(ModelT* model, SubGraphT* subgraph,
+                             int32_t tensor_idx, TensorT* tensor) {
+  TF_LITE_ENSURE_STATUS(
+      utils::SymmetricQuantizeTensorPackedInt4(model, tensor));
+  for (ConsumerOpInfo& consumer_op_info :
+       GetTensorConsumers(model, subgraph, tensor_idx)) {
+    OperatorT* consumer_op = consumer_op_info.op;
+    consumer_op->builtin_options.AsFullyConnectedOptions()->weights_format =
+        FullyConnectedOptionsWeightsFormat_PACKED_INT4;
+    model->operator_codes[consumer_op->opcode_index]->version = 8;
+  }
+  return kTfLiteOk;
+}
+
 // Returns true if the op in consumer_op_infos can pass through quantization.
 bool IsQuantizationPassThroughOps(
     const ModelT* model, const std::vector<ConsumerOpInfo>& consumer_op_infos) {
@@ -339,11 +395,14 @@ PassQuantizationAndGetConsumers(
       GetTensorConsumers(model, subgraph, output_tensor_idx));
 }
 
+// If pack_int4 is true, the weights that only feed hybrid FULLY_CONNECTED ops
+// are quantized to 4 bits and packed two per byte instead.
 TfLiteStatus QuantizeWeightsInt8(flatbuffers::FlatBufferBuilder* builder,
                                  const Model* input_model,
                                  bool use_hybrid_evaluation,
                                  uint64_t weights_min_num_elements,
-                                 const CustomOpMap& custom_op_map) {
+                                 const CustomOpMap& custom_op_map,
+                                 bool pack_int4 = false) {
   std::unique_ptr<ModelT> model;
   model.reset(input_model->UnPack());
 
@@ -366,11 +425,22 @@ TfLiteStatus QuantizeWeightsInt8(flatbuffers::FlatBufferBuilder* builder,
   // The hash map ensures that we quantize each tensor exactly once.
   // TODO(suharshs): This map key isn't sufficient when we support multiple
   // subgraphs.
+  std::vector<std::pair<int32_t, TensorT*>> int4_tensors;
   for (std::pair<int32_t, TensorT*> tensor_pair : tensor_map) {
+    if (pack_int4 && use_hybrid_evaluation &&
+        IsPackableInt4Weights(model.get(), subgraph, tensor_pair.first,
+                              tensor_pair.second)) {
+      // Packed after the operator versions are updated, which they override.
+      int4_tensors.push_back(tensor_pair);
+      continue;
+    }
     // Quantize the tensor.
     TF_LITE_ENSURE_STATUS(
         utils::SymmetricQuantizeTensor(model.get(), tensor_pair.second));
   }
+  for (const auto& tensor_pair : int4_tensors) {
+    tensor_map.erase(tensor_pair.first);
+  }
 
   // Examine the tensor consumers to determine which require dequantize ops.
   for (const auto& tensor_pair : tensor_map) {
@@ -458,6 +528,13 @@ TfLiteStatus QuantizeWeightsInt8(flatbuffers::FlatBufferBuilder* builder,
   // Update the modified operator code versions.
   UpdateInt8OperatorVersions(model.get());
 
+  // These tensors only feed hybrid ops, so they never need a dequantize op.
+  for (const auto& tensor_pair : int4_tensors) {
+    TF_LITE_ENSURE_STATUS(PackInt4Weights(model.get(), subgraph,
+                                          tensor_pair.first,
+                                          tensor_pair.second));
+  }
+
   flatbuffers::Offset<Model> output_model_location =
       Model::Pack(*builder, model.get());
   FinishModelBuffer(*builder, output_model_location);
@@ -573,6 +650,12 @@ TfLiteStatus QuantizeWeights(flatbuffers::FlatBufferBuilder* builder,
       return QuantizeWeightsInt8(builder, input_model, true,
                                  kWeightsMinNumElementsDefault, custom_op_map);
     }
+    case BufferType::QUANTIZED_INT4: {
+      CustomOpMap custom_op_map;
+      return QuantizeWeightsInt8(builder, input_model, true,
+                                 kWeightsMinNumElementsDefault, custom_op_map,
+                                 /*pack_int4=*/true);
+    }
     case BufferType::QUANTIZED_FLOAT16:
       return QuantizeWeightsFloat16(builder, input_model);
   }
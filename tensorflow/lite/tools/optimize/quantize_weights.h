@@ -26,8 +26,10 @@ limitations under the License.
 namespace tflite {
 namespace optimize {
 
-// Supported resulting types from quantization process.
-enum class BufferType { QUANTIZED_INT8, QUANTIZED_FLOAT16 };
+// Supported resulting types from quantization process. QUANTIZED_INT4 is
+// QUANTIZED_INT8, except that the weights of hybrid FULLY_CONNECTED ops are
+// quantized to 4 bits and packed two per byte, halving their size.
+enum class BufferType { QUANTIZED_INT8, QUANTIZED_FLOAT16, QUANTIZED_INT4 };
 
 // Quantizes input_model and populates the provided builder with the new model.
 // By default only weights tensors weight more than 1024 elements will be
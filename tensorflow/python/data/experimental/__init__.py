@@ -52,6 +52,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@dense_to_sparse_batch
 @@enumerate_dataset
 @@from_variant
+@@get_iterator_stats
 @@get_next_as_optional
 @@get_single_element
 @@get_structure
@@ -71,6 +72,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@sample_from_datasets
 @@scan
 @@shuffle_and_repeat
+@@shuffle_with_memory_budget
 @@take_while
 @@to_variant
 @@unbatch
@@ -120,8 +122,10 @@ from tensorflow.python.data.experimental.ops.readers import SqlDataset
 from tensorflow.python.data.experimental.ops.resampling import rejection_resample
 from tensorflow.python.data.experimental.ops.scan_ops import scan
 from tensorflow.python.data.experimental.ops.shuffle_ops import shuffle_and_repeat
+from tensorflow.python.data.experimental.ops.shuffle_ops import shuffle_with_memory_budget
 from tensorflow.python.data.experimental.ops.stats_aggregator import StatsAggregator
 from tensorflow.python.data.experimental.ops.stats_ops import bytes_produced_stats
+from tensorflow.python.data.experimental.ops.stats_ops import get_iterator_stats
 from tensorflow.python.data.experimental.ops.stats_ops import latency_stats
 from tensorflow.python.data.experimental.ops.stats_options import StatsOptions
 from tensorflow.python.data.experimental.ops.take_while_ops import take_while
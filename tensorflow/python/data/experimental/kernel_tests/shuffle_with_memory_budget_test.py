@@ -0,0 +1,83 @@
+# Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for `tf.data.experimental.shuffle_with_memory_budget()`."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.experimental.ops import shuffle_ops
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+# Each element is a vector of 1024 floats.
+_ELEMENT_BYTES = 4 * 1024
+
+
+@test_util.run_all_in_graph_and_eager_modes
+class ShuffleWithMemoryBudgetTest(test_base.DatasetTestBase):
+
+  def _build_ds(self, buffer_size, buffer_size_bytes, num_elements=50):
+    dataset = dataset_ops.Dataset.range(num_elements).map(
+        lambda x: (x, array_ops.fill([1024], math_ops.cast(x, dtypes.float32))))
+    dataset = dataset.apply(
+        shuffle_ops.shuffle_with_memory_budget(
+            buffer_size=buffer_size,
+            buffer_size_bytes=buffer_size_bytes,
+            seed=21))
+    return dataset.map(lambda x, _: x)
+
+  def _gen_outputs(self, dataset):
+    get_next = self.getNext(dataset)
+    outputs = []
+    while True:
+      try:
+        outputs.append(self.evaluate(get_next()))
+      except errors.OutOfRangeError:
+        break
+    return outputs
+
+  def testProducesAllElements(self):
+    output = self._gen_outputs(
+        self._build_ds(buffer_size=100, buffer_size_bytes=4 * _ELEMENT_BYTES))
+    self.assertCountEqual(range(50), output)
+
+  def testBudgetBoundsTheBuffer(self):
+    # The buffer never holds more than 4 elements, so no element can be
+    # produced more than 3 positions ahead of its input position.
+    output = self._gen_outputs(
+        self._build_ds(buffer_size=100, buffer_size_bytes=4 * _ELEMENT_BYTES))
+    for i, x in enumerate(output):
+      self.assertLess(x, i + 4)
+
+  def testBudgetSmallerThanOneElement(self):
+    # The buffer holds a single element, so nothing is reordered.
+    output = self._gen_outputs(
+        self._build_ds(buffer_size=100, buffer_size_bytes=1))
+    self.assertEqual(list(range(50)), output)
+
+  def testInvalidBudget(self):
+    with self.assertRaises(ValueError):
+      shuffle_ops.shuffle_with_memory_budget(
+          buffer_size=10, buffer_size_bytes=0)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -69,7 +69,9 @@ class SnapshotDatasetTest(reader_dataset_ops_test_base.TFRecordDatasetTestBase,
 
       for j in range(num_runs_per_fp):
         run_dir = os.path.join(fingerprint_dir, fingerprint_dir_list[j])
-        run_dirlist = sorted(os.listdir(run_dir))
+        # Ignore the chunk indices of the snapshot files.
+        run_dirlist = sorted(
+            f for f in os.listdir(run_dir) if not f.endswith(".index"))
         self.assertLen(run_dirlist, num_snapshot_files)
 
         file_counter = 0
@@ -258,6 +260,35 @@ class SnapshotDatasetTest(reader_dataset_ops_test_base.TFRecordDatasetTestBase,
         snapshot.snapshot(tmpdir, compression=compression))
     self.assertDatasetProduces(dataset2, expected, assert_items_equal=True)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              compression=[snapshot.COMPRESSION_NONE,
+                           snapshot.COMPRESSION_GZIP])))
+  def testWriteSnapshotWritesChunkIndex(self, compression):
+    tmpdir = self.makeSnapshotDirectory()
+
+    dataset = dataset_ops.Dataset.range(1000)
+    dataset = dataset.apply(snapshot.snapshot(tmpdir, compression=compression))
+    self.assertDatasetProduces(dataset, list(range(1000)))
+
+    fingerprint_dir = os.path.join(tmpdir, os.listdir(tmpdir)[0])
+    run_dir = [
+        os.path.join(fingerprint_dir, d)
+        for d in os.listdir(fingerprint_dir)
+        if d != "snapshot.metadata"
+    ][0]
+    self.assertEqual(
+        sorted(os.listdir(run_dir)),
+        ["00000000.snapshot", "00000000.snapshot.index"])
+
+    # Reading the snapshot back uses the index.
+    dataset2 = dataset_ops.Dataset.range(1000)
+    dataset2 = dataset2.apply(
+        snapshot.snapshot(tmpdir, compression=compression))
+    self.assertDatasetProduces(dataset2, list(range(1000)))
+
   @combinations.generate(test_base.default_test_combinations())
   def testSameFingerprintWithDifferentInitializationOrder(self):
     tmpdir = self.makeSnapshotDirectory()
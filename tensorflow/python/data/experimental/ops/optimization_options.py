@@ -107,6 +107,14 @@ class OptimizationOptions(options.OptionsBase):
       "are allowed but may result in CPU contention. If None, defaults to the "
       "number of schedulable CPU cores.")
 
+  autotune_ram_budget = options.create_option(
+      name="autotune_ram_budget",
+      ty=int,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines the number "
+      "of bytes that autotuned buffers may use. Buffers are never grown past "
+      "this limit. If None, defaults to half of the available RAM.")
+
   filter_fusion = options.create_option(
       name="filter_fusion",
       ty=bool,
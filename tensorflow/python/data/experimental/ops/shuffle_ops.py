@@ -90,3 +90,58 @@ def shuffle_and_repeat(buffer_size, count=None, seed=None):
     return _ShuffleAndRepeatDataset(dataset, buffer_size, count, seed)
 
   return _apply_fn
+
+
+@tf_export("data.experimental.shuffle_with_memory_budget")
+def shuffle_with_memory_budget(buffer_size,
+                               buffer_size_bytes,
+                               seed=None,
+                               reshuffle_each_iteration=None):
+  """Shuffles a Dataset using a buffer that is bounded in bytes.
+
+  Like `tf.data.Dataset.shuffle`, but the shuffle buffer also stops filling up
+  once the elements in it use `buffer_size_bytes` bytes. This makes it
+  possible to choose a large `buffer_size` without knowing the size of the
+  elements in advance, for example when shuffling decoded images:
+
+  ```python
+  dataset = dataset.apply(
+      tf.data.experimental.shuffle_with_memory_budget(
+          buffer_size=100000, buffer_size_bytes=4 * 1024**3))
+  ```
+
+  Since the buffer always holds at least one element, a single element larger
+  than `buffer_size_bytes` is still shuffled, but with no other elements.
+
+  Args:
+    buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the maximum
+      number of elements from which the new dataset will sample.
+    buffer_size_bytes: A positive Python integer, representing the maximum
+      number of bytes that the elements in the buffer may use.
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+      random seed that will be used to create the distribution. See
+      `tf.compat.v1.set_random_seed` for behavior.
+    reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
+      that the dataset should be pseudorandomly reshuffled each time it is
+      iterated over. (Defaults to `True`.)
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+
+  Raises:
+    ValueError: If `buffer_size_bytes` is not positive.
+  """
+  if buffer_size_bytes <= 0:
+    raise ValueError("`buffer_size_bytes` must be positive, but got: %d" %
+                     buffer_size_bytes)
+
+  def _apply_fn(dataset):  # pylint: disable=missing-docstring
+    return dataset_ops.ShuffleDataset(
+        dataset,
+        buffer_size,
+        seed=seed,
+        reshuffle_each_iteration=reshuffle_each_iteration,
+        buffer_size_bytes=buffer_size_bytes)
+
+  return _apply_fn
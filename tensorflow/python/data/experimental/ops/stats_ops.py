@@ -20,6 +20,7 @@ from __future__ import print_function
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_dataset_ops
 from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
@@ -94,6 +95,46 @@ def latency_stats(tag):
   return _apply_fn
 
 
+@tf_export("data.experimental.get_iterator_stats")
+def get_iterator_stats(iterator, name=None):
+  """Returns the runtime statistics of each dataset of a live iterator.
+
+  The statistics are taken from the performance model that tf.data maintains
+  for autotuning, so they are available without adding `StatsAggregator` ops
+  to the input pipeline. For each dataset, they report the number of elements
+  and bytes it produced, the time spent in it and in calls to it (which also
+  includes the time spent waiting for its inputs), and the occupancy of its
+  buffer.
+
+  The result is a serialized `IteratorStats` protocol buffer:
+
+  ```python
+  from tensorflow.core.protobuf.data.experimental import iterator_stats_pb2
+
+  stats = iterator_stats_pb2.IteratorStats.FromString(
+      tf.data.experimental.get_iterator_stats(iterator).numpy())
+  for node in stats.nodes:
+    print(node.name, node.num_elements, node.get_next_time_nanos)
+  ```
+
+  Counters accumulate over the lifetime of the iterator, so rates are
+  obtained by comparing two snapshots. Time and byte counters are only
+  maintained from the first call to this function onward, unless autotuning
+  already tracks them. The statistics are empty if autotuning is disabled
+  through `tf.data.Options`.
+
+  Args:
+    iterator: A `tf.compat.v1.data.Iterator` or the iterator of a
+      `tf.data.Dataset`.
+    name: (Optional.) A name for the operation.
+
+  Returns:
+    A scalar `tf.string` tensor.
+  """
+  return gen_dataset_ops.iterator_get_stats(
+      iterator._iterator_resource, name=name)  # pylint: disable=protected-access
+
+
 class _StatsDataset(dataset_ops.UnaryUnchangedStructureDataset):
   """A `Dataset` that acts as an identity, and also records statistics."""
 
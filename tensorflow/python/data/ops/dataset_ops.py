@@ -307,6 +307,7 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
     autotune = True
     algorithm = AutotuneAlgorithm.HILL_CLIMB
     cpu_budget = 0  # Indicates that all CPU cores should be used.
+    ram_budget = 0  # Indicates that the default share of RAM should be used.
     if options.experimental_optimization is not None:
       if options.experimental_optimization.autotune is False:  # pylint: disable=g-bool-id-comparison
         autotune = False
@@ -314,9 +315,11 @@ class DatasetV2(tracking_base.Trackable, composite_tensor.CompositeTensor):
         algorithm = options.experimental_optimization.autotune_algorithm
       if options.experimental_optimization.autotune_cpu_budget is not None:
         cpu_budget = options.experimental_optimization.autotune_cpu_budget
+      if options.experimental_optimization.autotune_ram_budget is not None:
+        ram_budget = options.experimental_optimization.autotune_ram_budget
 
     if autotune:
-      dataset = _ModelDataset(dataset, algorithm, cpu_budget)
+      dataset = _ModelDataset(dataset, algorithm, cpu_budget, ram_budget)
 
     if options.experimental_stats and options.experimental_stats.aggregator:  # pylint: disable=line-too-long
       dataset = _SetStatsAggregatorDataset(  # pylint: disable=protected-access
@@ -3156,7 +3159,8 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
                input_dataset,
                buffer_size,
                seed=None,
-               reshuffle_each_iteration=None):
+               reshuffle_each_iteration=None,
+               buffer_size_bytes=None):
     """Randomly shuffles the elements of this dataset.
 
     Args:
@@ -3169,6 +3173,9 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
       reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
         that the dataset should be pseudorandomly reshuffled each time it is
         iterated over. (Defaults to `True`.)
+      buffer_size_bytes: (Optional.) A Python integer. If positive, the buffer
+        stops filling up once the elements in it use this many bytes, even if
+        it holds fewer than `buffer_size` elements.
 
     Returns:
       A `Dataset`.
@@ -3186,6 +3193,12 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
     else:
       self._reshuffle_each_iteration = reshuffle_each_iteration
 
+    # The attr is only set when needed, so that graphs without a byte budget
+    # can be read by older binaries.
+    kwargs = dict(self._flat_structure)
+    if buffer_size_bytes:
+      kwargs["buffer_size_bytes"] = buffer_size_bytes
+
     if tf2.enabled() and self._reshuffle_each_iteration and (
         context.executing_eagerly() or
         ops.get_default_graph()._building_function):  # pylint: disable=protected-access
@@ -3194,7 +3207,7 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           buffer_size=self._buffer_size,
           seed_generator=self._seed_generator.handle,
-          **self._flat_structure)
+          **kwargs)
     else:
       variant_tensor = gen_dataset_ops.shuffle_dataset(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
@@ -3202,7 +3215,7 @@ class ShuffleDataset(UnaryUnchangedStructureDataset):
           seed=self._seed,
           seed2=self._seed2,
           reshuffle_each_iteration=self._reshuffle_each_iteration,
-          **self._flat_structure)
+          **kwargs)
     super(ShuffleDataset, self).__init__(input_dataset, variant_tensor)
 
 
@@ -3822,22 +3835,21 @@ class _OptionsDataset(UnaryUnchangedStructureDataset):
 class _ModelDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that acts as an identity, and models performance."""
 
-  def __init__(self, input_dataset, algorithm, cpu_budget):
+  def __init__(self, input_dataset, algorithm, cpu_budget, ram_budget=0):
     self._input_dataset = input_dataset
+    kwargs = dict(cpu_budget=cpu_budget, **self._flat_structure)
     # TODO(jsimsa): This check is introduced for forward compatibility and can
     # be removed after 7/24/2019. At that point, all servers are expected to
     # recognize the `algorithm` attribute.
     if algorithm != AutotuneAlgorithm.HILL_CLIMB:
-      variant_tensor = gen_dataset_ops.model_dataset(
-          input_dataset._variant_tensor,  # pylint: disable=protected-access
-          algorithm=algorithm,
-          cpu_budget=cpu_budget,
-          **self._flat_structure)
-    else:
-      variant_tensor = gen_dataset_ops.model_dataset(
-          input_dataset._variant_tensor,  # pylint: disable=protected-access
-          cpu_budget=cpu_budget,
-          **self._flat_structure)
+      kwargs["algorithm"] = algorithm
+    # The `ram_budget` attribute is only set when it differs from the default,
+    # so that servers that do not recognize it can still run the op.
+    if ram_budget:
+      kwargs["ram_budget"] = ram_budget
+    variant_tensor = gen_dataset_ops.model_dataset(
+        input_dataset._variant_tensor,  # pylint: disable=protected-access
+        **kwargs)
     super(_ModelDataset, self).__init__(input_dataset, variant_tensor)
 
 
@@ -216,6 +216,8 @@ def set_optimizer_experimental_options(options):
         GPUs and above. Without the use of loss scaling, this can cause
         numerical underflow (see
         `keras.mixed_precision.experimental.LossScaleOptimizer`).
+      - auto_mixed_precision_cpu: Change certain float32 ops to bfloat16 on
+        CPUs, which halves the memory traffic of the converted ops.
       - disable_meta_optimizer: Disable the entire meta optimizer.
       - min_graph_nodes: The minimum number of nodes in a graph to optimizer.
         For smaller graphs, optimization is skipped.
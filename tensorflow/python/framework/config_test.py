@@ -255,7 +255,8 @@ class ConfigTest(test.TestCase, parameterized.TestCase):
       ('DebugStripper', 'debug_stripper'),
       ('ScopedAllocatorOptimization', 'scoped_allocator_optimization'),
       ('ImplementationSelector', 'implementation_selector'),
-      ('AutoMixedPrecision', 'auto_mixed_precision'))
+      ('AutoMixedPrecision', 'auto_mixed_precision'),
+      ('AutoMixedPrecisionCpu', 'auto_mixed_precision_cpu'))
   @reset_eager
   def testOptimizerToggleOption(self, field):
     # TODO(b/128531235): Improve testing of option
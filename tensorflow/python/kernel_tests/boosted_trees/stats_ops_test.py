@@ -1212,6 +1212,29 @@ class StatsOpsTest(test_util.TensorFlowTestCase):
           ]],
           self.evaluate(result))
 
+  def testMakeStatsSummaryLargeBatch(self):
+    """Tests a batch large enough to be split into example blocks."""
+    with self.cached_session():
+      max_splits = 3
+      num_buckets = 4
+      batch_size = 50000
+      rng = np.random.RandomState(0)
+      node_ids = rng.randint(0, max_splits, size=batch_size).astype(np.int32)
+      gradients = rng.uniform(-1., 1., size=(batch_size, 1)).astype(np.float32)
+      hessians = rng.uniform(0., 1., size=(batch_size, 1)).astype(np.float32)
+      bucketized_features = [
+          rng.randint(0, num_buckets, size=batch_size).astype(np.int32)
+      ]
+      expected = np.zeros((1, max_splits, num_buckets, 2))
+      np.add.at(expected[0, :, :, 0],
+                (node_ids, bucketized_features[0]), gradients[:, 0])
+      np.add.at(expected[0, :, :, 1],
+                (node_ids, bucketized_features[0]), hessians[:, 0])
+      result = boosted_trees_ops.make_stats_summary(
+          node_ids, gradients, hessians, bucketized_features, max_splits,
+          num_buckets)
+      self.assertAllClose(expected, self.evaluate(result), rtol=1e-4)
+
   def testAggregateStatsAccumulate(self):
     """Tests that Summary actually accumulates."""
     max_splits = 3
@@ -741,6 +741,38 @@ class BinaryOpTest(test.TestCase):
   def testBCast_15D(self):
     self._testBCastD([10, 3, 1, 2], [3, 1, 2])
 
+  @test_util.run_deprecated_v1
+  def testBCast_16A(self):
+    self._testBCastA([4, 3, 40], [40])
+
+  @test_util.run_deprecated_v1
+  def testBCast_16B(self):
+    self._testBCastB([4, 3, 40], [40])
+
+  @test_util.run_deprecated_v1
+  def testBCast_16C(self):
+    self._testBCastC([4, 3, 40], [40])
+
+  @test_util.run_deprecated_v1
+  def testBCast_16D(self):
+    self._testBCastD([4, 3, 40], [40])
+
+  @test_util.run_deprecated_v1
+  def testBCast_17A(self):
+    self._testBCastA([6, 40], [6, 1])
+
+  @test_util.run_deprecated_v1
+  def testBCast_17B(self):
+    self._testBCastB([6, 40], [6, 1])
+
+  @test_util.run_deprecated_v1
+  def testBCast_17C(self):
+    self._testBCastC([6, 40], [6, 1])
+
+  @test_util.run_deprecated_v1
+  def testBCast_17D(self):
+    self._testBCastD([6, 40], [6, 1])
+
   @test_util.run_deprecated_v1
   def testMismatchedDimensions(self):
     for func in [
@@ -22,6 +22,7 @@ import gc
 import os
 import pickle
 import re
+import threading
 
 from absl.testing import parameterized
 import numpy as np
@@ -822,6 +823,45 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
     value = self.evaluate(v.sparse_read([0, 3, 1, 2]))
     self.assertAllEqual(init_value[[0, 3, 1, 2], ...], value)
 
+  @test_util.run_deprecated_v1
+  def testSparseReadDuringDenseUpdate(self):
+    # Once read sparsely, the variable is in copy-on-read mode, in which dense
+    # updates write to its buffer in place. Concurrent sparse reads must still
+    # see each update either entirely or not at all.
+    num_rows, num_cols = 64, 4096
+    num_updates = 200
+    with self.cached_session() as sess:
+      v = resource_variable_ops.ResourceVariable(
+          array_ops.zeros([num_rows, num_cols]), name="table")
+      self.evaluate(variables.global_variables_initializer())
+      gather = v.sparse_read([0, num_rows // 2, num_rows - 1])
+      self.evaluate(gather)
+      update = v.assign_add(
+          array_ops.ones([num_rows, num_cols]), read_value=False)
+
+      done = threading.Event()
+      torn_reads = []
+
+      def reader():
+        while not done.is_set():
+          rows = sess.run(gather)
+          if not (rows == rows[0, 0]).all():
+            torn_reads.append(np.unique(rows))
+
+      readers = [threading.Thread(target=reader) for _ in range(2)]
+      for t in readers:
+        t.start()
+      try:
+        for _ in range(num_updates):
+          sess.run(update)
+      finally:
+        done.set()
+        for t in readers:
+          t.join()
+      self.assertEmpty(torn_reads)
+      self.assertAllEqual(
+          self.evaluate(v), np.full([num_rows, num_cols], num_updates))
+
   @test_util.run_in_graph_and_eager_modes
   def testGatherNd(self):
     init_value = np.reshape(np.arange(np.power(4, 3)), (4, 4, 4))
@@ -18,6 +18,7 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
 import threading
 import time
 
@@ -287,6 +288,116 @@ class BatchOpsTest(test.TestCase):
       self.assertEqual(thread_results[0], [2])
       self.assertEqual(main_results[0], [3])
 
+  def testBatchFunctionOpWithDifferentInnerShapes(self):
+    """Tests that inputs of different inner shapes are batched separately."""
+    if context.executing_eagerly():
+      return
+    with self.cached_session() as sess:
+
+      @function.Defun(dtypes.int32)
+      def computation(in_t):
+        return in_t + 1
+
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[1, None])
+      result = gen_batch_ops.batch_function(
+          [inp],
+          num_batch_threads=1,
+          max_batch_size=10,
+          batch_timeout_micros=100000,
+          Tout=[dtypes.int32],
+          f=computation,
+          captured_tensors=computation.captured_inputs)
+      thread_results = []
+
+      def worker():
+        thread_results.extend(sess.run([result], feed_dict={inp: [[1, 2]]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      main_results = sess.run([result], feed_dict={inp: [[3, 4, 5]]})
+      worker_thread.join()
+      self.assertAllEqual(thread_results[0], [[2, 3]])
+      self.assertAllEqual(main_results[0], [[4, 5, 6]])
+
+  def testBatchFunctionOpWithLargeInput(self):
+    """Tests that inputs larger than max_batch_size are split across batches."""
+    if context.executing_eagerly():
+      return
+    with self.cached_session() as sess:
+
+      @function.Defun(dtypes.int32)
+      def computation(in_t):
+        return in_t + 1
+
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[None])
+      result = gen_batch_ops.batch_function(
+          [inp],
+          num_batch_threads=1,
+          max_batch_size=2,
+          batch_timeout_micros=100000,
+          Tout=[dtypes.int32],
+          f=computation,
+          captured_tensors=computation.captured_inputs)
+      main_results = sess.run([result], feed_dict={inp: [1, 2, 3, 4, 5]})
+      self.assertAllEqual(main_results[0], [2, 3, 4, 5, 6])
+
+  def testBatchFunctionOpWithDeviceBatcher(self):
+    """Tests batch_function ops sharing the batch scheduler of their device."""
+    if context.executing_eagerly():
+      return
+    os.environ["TF_BATCH_FUNCTION_DEVICE_IN_FLIGHT_BATCHES"] = "1"
+    try:
+      with self.cached_session() as sess:
+        lock = threading.Lock()
+        in_flight = [0]
+        max_in_flight = [0]
+
+        def delayed_plus1_counted(x):
+          with lock:
+            in_flight[0] += 1
+            max_in_flight[0] = max(max_in_flight[0], in_flight[0])
+          time.sleep(0.1)
+          with lock:
+            in_flight[0] -= 1
+          return x + 1
+
+        @function.Defun(dtypes.int32)
+        def computation(in_t):
+          return script_ops.py_func(delayed_plus1_counted, [in_t],
+                                    dtypes.int32)
+
+        # Two models on the same device, each with threads of its own for
+        # its batches if they didn't share the device scheduler.
+        inp = array_ops.placeholder(dtype=dtypes.int32, shape=[None])
+        results = [
+            gen_batch_ops.batch_function(
+                [inp],
+                num_batch_threads=2,
+                max_batch_size=2,
+                batch_timeout_micros=0,
+                Tout=[dtypes.int32],
+                f=computation,
+                captured_tensors=computation.captured_inputs,
+                shared_name="model_%d" % i)[0] for i in range(2)
+        ]
+        thread_results = []
+
+        def worker():
+          thread_results.extend(
+              sess.run([results[1]], feed_dict={inp: [10, 20, 30]}))
+
+        worker_thread = threading.Thread(target=worker)
+        worker_thread.start()
+        # Larger than max_batch_size, so split across batches.
+        main_results = sess.run([results[0]], feed_dict={inp: [1, 2, 3, 4, 5]})
+        worker_thread.join()
+        self.assertAllEqual(main_results[0], [2, 3, 4, 5, 6])
+        self.assertAllEqual(thread_results[0], [11, 21, 31])
+        # The device processes one batch at a time, across both models.
+        self.assertEqual(max_in_flight[0], 1)
+    finally:
+      del os.environ["TF_BATCH_FUNCTION_DEVICE_IN_FLIGHT_BATCHES"]
+
   def testBatchFunctionOpWithCapturedInput(self):
     """Tests that batch_function op works with captured input."""
     if context.executing_eagerly():
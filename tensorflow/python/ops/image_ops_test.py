@@ -3866,6 +3866,40 @@ class JpegTest(test_util.TensorFlowTestCase):
             lambda e: "Invalid JPEG data or crop window" in str(e)):
           self.evaluate(result)
 
+  def testDecodeAndResizeJpegBatch(self):
+    with self.cached_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      contents = array_ops.stack([jpeg0, jpeg0])
+
+      # A window that is not downscaled matches DecodeAndCropJpeg.
+      crop_window = [6, 5, 15, 10]
+      image1 = image_ops.decode_and_crop_jpeg(jpeg0, crop_window)
+      image2 = gen_image_ops.decode_and_resize_jpeg_batch(
+          contents, [crop_window, crop_window], [15, 10])
+      self.assertAllEqual([2, 15, 10, 3], image2.get_shape().as_list())
+      image1, image2 = self.evaluate([image1, image2])
+      self.assertAllEqual([image1, image1], image2)
+
+      # A quarter of the size is decoded with DCT scaling alone.
+      image1 = image_ops.decode_jpeg(jpeg0, ratio=4)
+      image2 = gen_image_ops.decode_and_resize_jpeg_batch(
+          contents, [[0, 0, 0, 0], [0, 0, 256, 128]], [64, 32])
+      image1, image2 = self.evaluate([image1, image2])
+      self.assertAllEqual([image1, image1], image2)
+
+  @test_util.run_deprecated_v1
+  def testDecodeAndResizeJpegBatchWithInvalidCropWindow(self):
+    with self.cached_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      result = gen_image_ops.decode_and_resize_jpeg_batch(
+          array_ops.expand_dims(jpeg0, 0), [[0, 0, 257, 128]], [16, 16])
+      with self.assertRaisesWithPredicateMatch(
+          errors.InvalidArgumentError,
+          lambda e: "Invalid crop window" in str(e)):
+        self.evaluate(result)
+
   def testSynthetic(self):
     with self.cached_session(use_gpu=True) as sess:
       # Encode it, then decode it, then encode it
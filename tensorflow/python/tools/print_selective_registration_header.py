@@ -19,6 +19,10 @@ An example of command-line usage is:
   bazel-bin/tensorflow/python/tools/print_selective_registration_header \
     --graphs=path/to/graph.pb > ops_to_register.h
 
+To generate the header from SavedModels, pass their saved_model.pb files and
+--proto_fileformat=savedmodel. The tf_selective_registration_kernels macro in
+tensorflow/tensorflow.bzl does this and builds the matching kernels.
+
 Then when compiling tensorflow, include ops_to_register.h in the include search
 path and pass -DSELECTIVE_REGISTRATION and -DSUPPORT_SELECTIVE_REGISTRATION
  - see core/framework/selective_registration.h for more details.
@@ -63,7 +67,9 @@ if __name__ == '__main__':
       '--proto_fileformat',
       type=str,
       default='rawproto',
-      help='Format of proto file, either textproto or rawproto.')
+      help='Format of proto file, either textproto, rawproto or savedmodel. '
+      'A savedmodel file is a saved_model.pb or saved_model.pbtxt; the ops '
+      'of all its MetaGraphs and their functions are registered.')
   parser.add_argument(
       '--default_ops',
       type=str,
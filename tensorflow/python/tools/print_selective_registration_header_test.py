@@ -24,6 +24,7 @@ import sys
 from google.protobuf import text_format
 
 from tensorflow.core.framework import graph_pb2
+from tensorflow.core.protobuf import saved_model_pb2
 from tensorflow.python.platform import gfile
 from tensorflow.python.platform import test
 from tensorflow.python.tools import selective_registration_header_lib
@@ -136,6 +137,31 @@ class PrintOpFilegroupTest(test.TestCase):
         ],
         ops_and_kernels)
 
+  def testGetOpsFromSavedModel(self):
+    default_ops = 'NoOp:NoOp'
+    saved_model = saved_model_pb2.SavedModel()
+    graph_def = saved_model.meta_graphs.add().graph_def
+    text_format.Parse(GRAPH_DEF_TXT_2, graph_def)
+    # Ops only used by functions of the graph are registered too.
+    function_def = graph_def.library.function.add()
+    function_def.signature.name = 'f'
+    function_body = text_format.Parse(GRAPH_DEF_TXT, graph_pb2.GraphDef())
+    function_def.node_def.extend(function_body.node[:1])
+    fname = os.path.join(self.get_temp_dir(), 'saved_model.pb')
+    with gfile.GFile(fname, 'wb') as f:
+      f.write(saved_model.SerializeToString())
+
+    ops_and_kernels = selective_registration_header_lib.get_ops_and_kernels(
+        'savedmodel', [fname], default_ops)
+    self.assertListEqual(
+        [
+            ('AccumulateNV2', None),  #
+            ('BiasAdd', 'BiasOp<CPUDevice, float>'),  #
+            ('NoOp', 'NoOp'),  #
+            ('Reshape', 'ReshapeOp'),  #
+        ],
+        ops_and_kernels)
+
   def testAll(self):
     default_ops = 'all'
     graphs = [
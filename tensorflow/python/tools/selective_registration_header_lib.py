@@ -28,6 +28,7 @@ import sys
 from google.protobuf import text_format
 
 from tensorflow.core.framework import graph_pb2
+from tensorflow.core.protobuf import saved_model_pb2
 from tensorflow.python import pywrap_tensorflow
 from tensorflow.python.platform import gfile
 from tensorflow.python.platform import tf_logging
@@ -43,22 +44,40 @@ OPS_WITHOUT_KERNEL_WHITELIST = frozenset([
 ])
 
 
+def _get_node_defs(proto_fileformat, proto_file, file_data):
+  """Yields the NodeDefs of the graphs and functions in a model file."""
+  if proto_fileformat == 'savedmodel':
+    saved_model = saved_model_pb2.SavedModel()
+    if proto_file.endswith('.pbtxt'):
+      text_format.Parse(file_data, saved_model)
+    else:
+      saved_model.ParseFromString(file_data)
+    graph_defs = [m.graph_def for m in saved_model.meta_graphs]
+  elif proto_fileformat == 'rawproto':
+    graph_defs = [graph_pb2.GraphDef.FromString(file_data)]
+  else:
+    assert proto_fileformat == 'textproto'
+    graph_defs = [text_format.Parse(file_data, graph_pb2.GraphDef())]
+
+  for graph_def in graph_defs:
+    for node_def in graph_def.node:
+      yield node_def
+    for function_def in graph_def.library.function:
+      for node_def in function_def.node_def:
+        yield node_def
+
+
 def get_ops_and_kernels(proto_fileformat, proto_files, default_ops_str):
   """Gets the ops and kernels needed from the model files."""
   ops = set()
 
   for proto_file in proto_files:
     tf_logging.info('Loading proto file %s', proto_file)
-    # Load GraphDef.
     file_data = gfile.GFile(proto_file, 'rb').read()
-    if proto_fileformat == 'rawproto':
-      graph_def = graph_pb2.GraphDef.FromString(file_data)
-    else:
-      assert proto_fileformat == 'textproto'
-      graph_def = text_format.Parse(file_data, graph_pb2.GraphDef())
 
-    # Find all ops and kernels used by the graph.
-    for node_def in graph_def.node:
+    # Find all ops and kernels used by the graphs and their functions.
+    for node_def in _get_node_defs(proto_fileformat, proto_file,
+                                   file_data):
       if not node_def.device:
         node_def.device = '/cpu:0'
       kernel_class = pywrap_tensorflow.TryFindKernelClass(
@@ -30,6 +30,7 @@ from tensorflow.python.distribute import distribution_strategy_context as distri
 from tensorflow.python.distribute import reduce_util as ds_reduce_util
 from tensorflow.python.eager import backprop
 from tensorflow.python.eager import context
+from tensorflow.python.framework import device as pydev
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import smart_cond
@@ -117,7 +118,7 @@ class _RefVariableProcessor(_OptimizableVariable):
   def target(self):
     return self._v._ref()  # pylint: disable=protected-access
 
-  def update_op(self, optimizer, g):
+  def update_op(self, optimizer, g, unique_indices=False):
     if isinstance(g, ops.Tensor):
       update_op = optimizer._apply_dense(g, self._v)  # pylint: disable=protected-access
       if self._v.constraint is not None:
@@ -132,6 +133,8 @@ class _RefVariableProcessor(_OptimizableVariable):
         raise RuntimeError(
             "Cannot use a constraint function on a sparse variable.")
       # pylint: disable=protected-access
+      if unique_indices:
+        return optimizer._apply_sparse(g, self._v)
       return optimizer._apply_sparse_duplicate_indices(g, self._v)
 
 
@@ -163,12 +166,14 @@ class _DenseResourceVariableProcessor(_OptimizableVariable):
   def target(self):
     return self._v
 
-  def update_op(self, optimizer, g):
+  def update_op(self, optimizer, g, unique_indices=False):
     # pylint: disable=protected-access
     if isinstance(g, ops.IndexedSlices):
       if self._v.constraint is not None:
         raise RuntimeError(
             "Cannot use a constraint function on a sparse variable.")
+      if unique_indices:
+        return optimizer._resource_apply_sparse(g.values, self._v, g.indices)
       return optimizer._resource_apply_sparse_duplicate_indices(
           g.values, self._v, g.indices)
     update_op = optimizer._resource_apply_dense(g, self._v)
@@ -653,8 +658,19 @@ class Optimizer(
             scope_name = ""
           else:
             scope_name = var.op.name
-          with ops.name_scope("update_" + scope_name), ops.colocate_with(var):
-            update_ops.append(processor.update_op(self, grad))
+          with ops.name_scope("update_" + scope_name):
+            if self._should_deduplicate_before_transfer(grad, var, processor):
+              with ops.colocate_with(grad.values):
+                summed_values, unique_indices = _deduplicate_indexed_slices(
+                    values=grad.values, indices=grad.indices)
+              grad = ops.IndexedSlices(summed_values, unique_indices,
+                                       grad.dense_shape)
+              with ops.colocate_with(var):
+                update_ops.append(
+                    processor.update_op(self, grad, unique_indices=True))
+            else:
+              with ops.colocate_with(var):
+                update_ops.append(processor.update_op(self, grad))
         if global_step is None:
           apply_updates = self._finish(update_ops, sname+'-apply')
         else:
@@ -1022,6 +1038,39 @@ class Optimizer(
     """
     raise NotImplementedError()
 
+  def _should_deduplicate_before_transfer(self, grad, var, processor):
+    """Returns whether to sum repeated indices of `grad` on its own device.
+
+    When `var` lives on another device than the sparse gradient, e.g. on a
+    parameter server, summing the repeated indices before the gradient is
+    transferred instead of after saves sending each repeated slice. This is
+    only done for optimizers that would sum them anyway, i.e. that do not
+    override the `_*_duplicate_indices` methods.
+
+    Args:
+      grad: The gradient for `var`, a `Tensor` or `IndexedSlices`.
+      var: The variable to be updated.
+      processor: The `_OptimizableVariable` for `var`.
+
+    Returns:
+      True if `grad` should be deduplicated before it is transferred.
+    """
+    if (context.executing_eagerly() or
+        not isinstance(grad, ops.IndexedSlices) or
+        getattr(var, "constraint", None) is not None):
+      return False
+    if not (var.device and grad.values.device and
+            pydev.canonical_name(var.device) != pydev.canonical_name(
+                grad.values.device)):
+      return False
+    if isinstance(processor, _DenseResourceVariableProcessor):
+      dedup_method = "_resource_apply_sparse_duplicate_indices"
+    elif isinstance(processor, _RefVariableProcessor):
+      dedup_method = "_apply_sparse_duplicate_indices"
+    else:
+      return False
+    return getattr(type(self), dedup_method) is getattr(Optimizer, dedup_method)
+
   def _resource_apply_sparse_duplicate_indices(self, grad, handle, indices):
     """Add ops to apply sparse gradients to `handle`, with repeated indices.
 
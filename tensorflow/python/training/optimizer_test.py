@@ -29,6 +29,7 @@ from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import state_ops
 from tensorflow.python.ops import variables
 from tensorflow.python.platform import test
+from tensorflow.python.training import adagrad
 from tensorflow.python.training import gradient_descent
 
 
@@ -269,6 +270,32 @@ class OptimizerTest(test.TestCase):
       self.assertAllClose([-0.1, -0.1], self.evaluate(var0))
       self.assertAllClose([0., 0.], self.evaluate(var1))
 
+  def _sparseUpdateUniqueOpDevices(self, optimizer, var_device):
+    with ops.Graph().as_default() as g:
+      with ops.device(var_device):
+        var = resource_variable_ops.ResourceVariable([[1.0], [2.0]])
+      with ops.device('/job:worker/task:0'):
+        grad = ops.IndexedSlices(
+            constant_op.constant([[0.1], [0.2], [0.3]]),
+            constant_op.constant([0, 1, 0]), constant_op.constant([2, 1]))
+      optimizer.apply_gradients([(grad, var)])
+      return [op.device for op in g.get_operations() if op.type == 'Unique']
+
+  def testSparseGradientDeduplicatedBeforeTransfer(self):
+    self.assertEqual(['/job:worker/task:0'],
+                     self._sparseUpdateUniqueOpDevices(
+                         adagrad.AdagradOptimizer(1.0), '/job:ps/task:0'))
+
+  def testSparseGradientOnVariableDevice(self):
+    self.assertEqual(['/job:worker/task:0'],
+                     self._sparseUpdateUniqueOpDevices(
+                         adagrad.AdagradOptimizer(1.0), '/job:worker/task:0'))
+    # Gradient descent handles repeated indices itself.
+    self.assertEqual([],
+                     self._sparseUpdateUniqueOpDevices(
+                         gradient_descent.GradientDescentOptimizer(1.0),
+                         '/job:ps/task:0'))
+
 
 if __name__ == '__main__':
   test.main()
@@ -22,6 +22,8 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_KERNEL_H_
 #define TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_KERNEL_H_
 
+#include <atomic>
+
 #include "tensorflow/stream_executor/gpu/gpu_driver.h"
 #include "tensorflow/stream_executor/kernel_cache_config.h"
 #include "tensorflow/stream_executor/platform/logging.h"
@@ -79,12 +81,25 @@ class GpuKernel : public internal::KernelInterface {
   // CUfunc_cache.
   GpuFuncCachePreference GetGpuCacheConfig() const;
 
+  // Returns true if the cache configuration preference changed since it was
+  // last applied to the function, and records it as applied, so that launches
+  // only call into the driver when it changed.
+  bool ShouldApplyCacheConfig() const {
+    const int config = static_cast<int>(preferred_cache_config_);
+    return applied_cache_config_.exchange(config, std::memory_order_relaxed) !=
+           config;
+  }
+
  private:
   GpuFunctionHandle gpu_function_;  // Wrapped CUDA kernel handle.
   unsigned arity_;  // Number of formal parameters the kernel takes.
 
   // Preferred (but not required) cache configuration for this kernel.
   KernelCacheConfig preferred_cache_config_;
+
+  // Cache configuration last applied to gpu_function_.
+  mutable std::atomic<int> applied_cache_config_{
+      static_cast<int>(KernelCacheConfig::kNoPreference)};
 };
 
 // Given a platform-independent kernel datatype, returns the (const) internal
@@ -79,6 +79,7 @@ limitations under the License.
 #include "tensorflow/stream_executor/device_memory.h"
 #include "tensorflow/stream_executor/kernel_cache_config.h"
 #include "tensorflow/stream_executor/lib/array_slice.h"
+#include "tensorflow/stream_executor/platform/logging.h"
 #include "tensorflow/stream_executor/platform/port.h"
 
 namespace stream_executor {
@@ -419,6 +420,18 @@ class KernelArgsArray : public KernelArgsArrayBase {
     ++number_of_argument_addresses_;
   }
 
+  // Replaces the device memory argument at `index`, which must have been
+  // added by add_device_memory_argument. Shared memory arguments are not
+  // counted in `index`. This allows to launch a kernel repeatedly with the
+  // same argument list, updating only the buffers that changed.
+  void update_device_memory_argument(size_t index,
+                                     const DeviceMemoryBase &arg) {
+    DCHECK_LT(index, number_of_argument_addresses_);
+    DCHECK_EQ(argument_addresses_[index],
+              &device_memory_opaque_pointers_[index]);
+    device_memory_opaque_pointers_[index] = arg.opaque();
+  }
+
   // Adds a shared memory argument to the list.
   //
   // The only significant information about a shared argument is its size, so
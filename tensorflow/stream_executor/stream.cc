@@ -363,6 +363,22 @@ Stream &Stream::ThenRecordEvent(Event *event) {
   return *this;
 }
 
+Stream &Stream::ThenLaunchPacked(ThreadDim thread_dims, BlockDim block_dims,
+                                 const KernelBase &kernel,
+                                 const KernelArgsArrayBase &args) {
+  if (ok()) {
+    DCHECK(parent_ != nullptr);
+    port::Status status =
+        parent_->Launch(this, thread_dims, block_dims, kernel, args);
+    if (!status.ok()) {
+      SetError();
+      LOG(WARNING) << "parent failed to launch kernel: " << &kernel << ": "
+                   << status.error_message();
+    }
+  }
+  return *this;
+}
+
 Stream &Stream::ThenLaunchGraph(void *exec_graph) {
   VLOG_CALL(PARAM(exec_graph));
   DCHECK(parent_ != nullptr);
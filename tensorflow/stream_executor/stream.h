@@ -173,6 +173,15 @@ class Stream {
   Stream &ThenLaunch(ThreadDim thread_dims, BlockDim block_dims,
                      const TypedKernel<Params...> &kernel, Args... args);
 
+  // Same as above, with arguments that the caller already packed into `args`.
+  // No type checking is done. A caller launching the same kernel repeatedly
+  // can keep `args` and update its device memory arguments in place (see
+  // KernelArgsArray::update_device_memory_argument) instead of packing them
+  // for every launch.
+  Stream &ThenLaunchPacked(ThreadDim thread_dims, BlockDim block_dims,
+                           const KernelBase &kernel,
+                           const KernelArgsArrayBase &args);
+
   // Launch a task graph. For CUDA backend, launch a CUDA graph.
   // See Documentation:
   // https://docs.nvidia.com/cuda/cuda-c-programming-guide/index.html#cuda-graphs
@@ -1393,6 +1393,69 @@ register_extension_info(
     label_regex_for_dep = "{extension_name}",
 )
 
+def tf_selective_registration_kernels(
+        name,
+        saved_models,
+        default_ops = "NoOp:NoOp,_Recv:RecvOp,_Send:SendOp",
+        visibility = None):
+    """Builds the portable kernels used by a list of SavedModels.
+
+    Generates ops_to_register.h from the graphs and functions of
+    `saved_models` (saved_model.pb or saved_model.pbtxt files) and compiles
+    the Android kernels with SELECTIVE_REGISTRATION, so that only the ops and
+    kernels of the models are registered and linked.
+
+    Args:
+      name: The name of the cc_library holding the kernels.
+      saved_models: The SavedModel files to register the kernels of.
+      default_ops: Comma-separated op:kernel pairs always registered.
+      visibility: The visibility of the cc_library.
+    """
+    header = name + "_ops_to_register"
+    tool = clean_dep("//tensorflow/python/tools:" +
+                     "print_selective_registration_header")
+    native.genrule(
+        name = header,
+        srcs = saved_models,
+        outs = [name + "/ops_to_register.h"],
+        cmd = ("$(location " + tool + ") --proto_fileformat=savedmodel " +
+               "--graphs=$$(echo $(SRCS) | tr ' ' ',') " +
+               "--default_ops='" + default_ops + "' > $@"),
+        tools = [tool],
+    )
+    native.cc_library(
+        name = name,
+        srcs = select({
+            clean_dep("//tensorflow:android"): [
+                clean_dep("//tensorflow/core/kernels:android_core_ops"),
+                clean_dep("//tensorflow/core/kernels:android_extended_ops"),
+            ],
+            "//conditions:default": [],
+        }),
+        hdrs = [":" + header],
+        includes = [name],
+        copts = tf_copts() + [
+            "-DSELECTIVE_REGISTRATION",
+            "-DSUPPORT_SELECTIVE_REGISTRATION",
+        ],
+        linkopts = select({
+            clean_dep("//tensorflow:android"): ["-ldl"],
+            "//conditions:default": [],
+        }),
+        tags = ["manual", "notap"],
+        visibility = visibility,
+        deps = [
+            clean_dep("//tensorflow/core:android_tensorflow_lib_lite"),
+            clean_dep("//tensorflow/core:protos_all_cc_impl"),
+            clean_dep("//third_party/eigen3"),
+            clean_dep("//third_party/fft2d:fft2d_headers"),
+            "@com_google_protobuf//:protobuf",
+            "@fft2d",
+            "@gemmlowp",
+        ],
+        alwayslink = 1,
+    )
+
 def tf_kernel_library(
         name,
         prefix = None,